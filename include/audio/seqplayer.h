@@ -146,6 +146,10 @@ typedef struct SequenceChannel {
     /* 0xD8 */ StereoData stereoData;
     /* 0xDC */ s32 startSamplePos;
     /* 0xE0 */ s32 unk_E0;
+#if SEQ_WAKE_TICKS
+    /* 0xE4 */ u16 sleepTicks; // ticks left that can only count the channel's and its layers' delays down
+    /* 0xE6 */ u16 sleptTicks; // ticks skipped so far, not yet taken off those delays
+#endif
 } SequenceChannel; // size = 0xE4
 
 // Might also be known as a Track, according to sm64 debug strings (?).
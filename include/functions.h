@@ -24,6 +24,10 @@ s32 Room_ProcessRoomRequest(PlayState* play, RoomContext* roomCtx);
 void Room_Draw(PlayState* play, Room* room, u32 flags);
 
 void Room_FinishRoomChange(PlayState* play, RoomContext* roomCtx);
+#if ROOM_PREFETCH
+void Room_PrefetchNextRoom(PlayState* play, RoomContext* roomCtx);
+void Room_FinishPrefetch(RoomContext* roomCtx);
+#endif
 
 AudioTask* AudioThread_Update(void);
 void AudioThread_QueueCmdF32(u32 opArgs, f32 data);
@@ -30,6 +30,36 @@ typedef struct GfxMasterList {
 #define GFXPOOL_HEAD_MAGIC 0x1234
 #define GFXPOOL_TAIL_MAGIC 0x5678
 
+#if GFXPOOL_SIZING
+// The buffers the platform sizes, see gGfxPoolSizes
+typedef enum GfxPoolBuffer {
+    /* 0 */ GFXPOOL_POLY_OPA,
+    /* 1 */ GFXPOOL_POLY_XLU,
+    /* 2 */ GFXPOOL_OVERLAY,
+    /* 3 */ GFXPOOL_BUFFER_MAX
+} GfxPoolBuffer;
+
+// What Graph_ExecuteAndDraw measures of the arenas of a frame, in bytes
+typedef enum GfxPoolStat {
+    /* 0 */ GFXPOOL_STAT_POLY_OPA, // head and tail of each arena
+    /* 1 */ GFXPOOL_STAT_POLY_XLU,
+    /* 2 */ GFXPOOL_STAT_OVERLAY,
+    /* 3 */ GFXPOOL_STAT_WORK,
+    /* 4 */ GFXPOOL_STAT_TAIL, // matrices and vertices, the tails of all of them
+    /* 5 */ GFXPOOL_STAT_MAX
+} GfxPoolStat;
+
+typedef struct GfxPool {
+    /* 0x00000 */ u16 headMagic; // GFXPOOL_HEAD_MAGIC
+    /* 0x00008 */ GfxMasterList master;
+    /* 0x00308 */ Gfx* polyXluBuffer;
+    /* 0x0030C */ Gfx* overlayBuffer;
+    /* 0x00310 */ Gfx workBuffer[0x40];
+    /* 0x00510 */ Gfx debugBuffer[0x40];
+    /* 0x00710 */ Gfx* polyOpaBuffer;
+    /* 0x00714 */ u16 tailMagic; // GFXPOOL_TAIL_MAGIC
+} GfxPool; // size = 0x718
+#else
 typedef struct GfxPool {
     /* 0x00000 */ u16 headMagic; // GFXPOOL_HEAD_MAGIC
     /* 0x00008 */ GfxMasterList master;
@@ -40,6 +70,7 @@ typedef struct GfxPool {
     /* 0x06708 */ Gfx polyOpaBuffer[0x3380];
     /* 0x20308 */ u16 tailMagic; // GFXPOOL_TAIL_MAGIC
 } GfxPool; // size = 0x20310
+#endif
 
 typedef struct GraphicsContext {
     /* 0x000 */ Gfx* polyOpaBuffer; // Pointer to "Zelda 0"
@@ -80,6 +111,10 @@ typedef struct GraphicsContext {
 } GraphicsContext; // size = 0x2F0
 
 // graph.c
+#if GFXPOOL_SIZING
+void Graph_AllocGfxPools(void);
+void Graph_MeasureGfxPool(GraphicsContext* gfxCtx);
+#endif
 void Graph_ThreadEntry(void* arg);
 
 Gfx* Gfx_SetFog(Gfx* gfx, s32 r, s32 g, s32 b, s32 a, s32 n, s32 f);
@@ -103,6 +138,14 @@ void Gfx_DrawDListXlu(struct PlayState* play, Gfx* dList);
 
 // graph.c
 extern struct GfxMasterList* gGfxMasterDL;
+#if GFXPOOL_SIZING
+extern size_t gGfxPoolSizes[GFXPOOL_BUFFER_MAX];
+extern u32 gGfxPoolUsed[GFXPOOL_STAT_MAX];
+extern u32 gGfxPoolPeak[GFXPOOL_STAT_MAX];
+#endif
+#if DRAW_SKIP
+extern u8 gGraphSkipDraw;
+#endif
 
 extern Gfx gEmptyDL[];
 
@@ -12,6 +12,13 @@ typedef struct ArenaNode {
     /* 0xC */ struct ArenaNode* prev;
 } ArenaNode; // size = 0x10
 
+#ifdef TARGET_NSP
+// Free block size classes of src/nspire/platform/malloc_nsp.c: one for each 16 bytes up to 512, then one for each
+// power of two
+#define ARENA_SMALL_BINS 32
+#define ARENA_NUM_BINS (ARENA_SMALL_BINS + 23)
+#endif
+
 typedef struct Arena {
     /* 0x00 */ ArenaNode* head;
     /* 0x04 */ void* start;
@@ -19,6 +26,12 @@ typedef struct Arena {
     /* 0x20 */ u8 unk20;
     /* 0x21 */ u8 isInit;
     /* 0x22 */ u8 flag;
+#ifdef TARGET_NSP
+    ArenaNode* bins[ARENA_NUM_BINS]; // free blocks of each size class, linked through their data
+    u64 binMask;                     // bit i set when bins[i] isn't empty
+    size_t freeSize;                 // the data sizes of the free blocks, added up
+    size_t allocSize;                // and of the allocated ones
+#endif
 } Arena; // size = 0x24
 
 void __osMallocInit(Arena* arena, void* heap, size_t size);
@@ -35,6 +35,18 @@ typedef struct OverlayRelocationSection {
     /* 0x14 */ u32 relocations[1]; // array count is numRelocations
 } OverlayRelocationSection; // size >= 0x18
 
+#ifdef COMPACT_RELOCS
+// Relocation section written by `fado --compact`, see Overlay_Relocate
+typedef struct OverlayCompactRelocationSection {
+    /* 0x00 */ size_t textSize;
+    /* 0x04 */ size_t dataSize;
+    /* 0x08 */ size_t rodataSize;
+    /* 0x0C */ size_t bssSize;
+    /* 0x10 */ u32 numRuns;
+    /* 0x14 */ u16 runs[1]; // numRuns runs of (3 + count) halfwords each
+} OverlayCompactRelocationSection; // size >= 0x18
+
+#endif
 // Fragment overlay load functions
 size_t Overlay_Load(uintptr_t vromStart, uintptr_t vromEnd, void* vramStart, void* vramEnd, void* allocatedRamAddr);
 void* Overlay_AllocateAndLoad(uintptr_t vromStart, uintptr_t vromEnd, void* vramStart, void* vramEnd);
@@ -10,6 +10,9 @@
 #include "z64animation.h"
 #include "z64collision_check.h"
 #include "z64item.h"
+#if LIGHTS_BIND_CACHE
+#include "z64light.h"
+#endif
 #include "unk.h"
 
 #define MASS_IMMOVABLE 0xFF // Cannot be pushed by OC collisions
@@ -153,7 +156,20 @@ typedef struct Actor {
     /* 0x138 */ ActorFunc update; // Update Routine. Called by `Actor_UpdateAll`
     /* 0x13C */ ActorFunc draw; // Draw Routine. Called by `Actor_Draw`
     /* 0x140 */ struct ActorOverlay* overlayEntry; // Pointer to the overlay table entry for this actor
-} Actor; // size = 0x144
+    // The fields below depend on the build flags, their offsets on which of them are on
+#if ACTOR_ID_INDEX
+    struct Actor* idPrev; // Previous actor of this id, in any category
+    struct Actor* idNext; // Next actor of this id, in any category
+    u8 listCategory; // Category of the actor list it is in. `category` already changes before the move
+#endif
+#if LIGHTS_BIND_CACHE
+    LightsCache lightsCache; // Lights bound by `Actor_Draw` last time, see `Lights_BindAllCached`
+#endif
+#if ACTOR_UPDATE_LOD
+    u8 updateLodSkipped; // Frames `Actor_UpdateAll` left out its update since the last one
+    u8 updateLodExact; // Set by actors that need exact timing, they update every frame wherever they are
+#endif
+} Actor; // size = 0x144 without ACTOR_ID_INDEX, LIGHTS_BIND_CACHE and ACTOR_UPDATE_LOD
 
 typedef enum {
     /* 0 */ FOOT_LEFT,
@@ -391,6 +407,15 @@ typedef struct ActorListEntry {
     /* 0x8 */ s32 categoryChanged; // at least one actor has changed categories and needs to be moved to a different list
 } ActorListEntry; // size = 0xC
 
+#if ACTOR_ID_INDEX
+// All loaded actors of one id, in the order they were added to their category. Any one category's actors of
+// that id are then in the same order as in its `ActorListEntry`, so lookups through it find the same actor
+typedef struct ActorIdListEntry {
+    /* 0x0 */ Actor* first;
+    /* 0x4 */ Actor* last;
+} ActorIdListEntry; // size = 0x8
+#endif
+
 typedef enum {
     /* 0 */ LENS_MODE_SHOW_ACTORS, // lens actors are invisible by default, and shown by using lens (for example, invisible enemies)
     /* 1 */ LENS_MODE_HIDE_ACTORS // lens actors are visible by default, and hidden by using lens (for example, fake walls)
@@ -442,6 +467,9 @@ typedef struct ActorContext {
     /* 0x268 */ u8 isOverrideInputOn;
     /* 0x269 */ UNK_TYPE1 pad269[0x3];
     /* 0x26C */ Input overrideInput;
+#if ACTOR_ID_INDEX
+    /* 0x284 */ ActorIdListEntry actorIdLists[ACTOR_ID_MAX];
+#endif
 } ActorContext; // size = 0x284
 
 typedef enum {
@@ -813,6 +841,10 @@ void Actor_SetShapeRotToWorld(Actor* actor);
 void Actor_SetScale(Actor* actor, f32 scale);
 void Actor_SetObjectDependency(struct PlayState* play, Actor* actor);
 void Actor_SetMovementScale(s32 scale);
+#if ACTOR_UPDATE_LOD
+// Distance past which NPCs, props and idle enemies update less often, 0 when they always update, see nsp_replacements.c
+f32 Actor_GetUpdateLodDist(void);
+#endif
 void Actor_UpdatePos(Actor* actor);
 void Actor_UpdateVelocityWithGravity(Actor* actor);
 void Actor_MoveWithGravity(Actor* actor);
@@ -937,6 +969,10 @@ void Actor_ChangeAnimationByInfo(SkelAnime* skelAnime, AnimationInfo* animInfo,
 void Actor_Noop(Actor* actor, struct PlayState* play);
 
 Actor* Actor_FindNearby(struct PlayState* play, Actor* inActor, s16 actorId, u8 actorCategory, f32 distance);
+#if ACTOR_ID_INDEX
+Actor* Actor_FindFirstById(ActorContext* actorCtx, s16 actorId, u8 actorCategory);
+Actor* Actor_FindNextById(Actor* actor, u8 actorCategory);
+#endif
 s32 func_800BE184(struct PlayState* play, Actor* actor, f32 xzDist, s16 arg3, s16 arg4, s16 arg5);
 u8 Actor_ApplyDamage(Actor* actor);
 void Actor_SetDropFlag(Actor* actor, ColliderElement* elem);
@@ -253,6 +253,10 @@ typedef struct AnimationSpeedInfo {
     /* 0xC */ f32 morphFrames;
 } AnimationSpeedInfo; // size = 0x10
 
+#if SKEL_LOD_FORCE
+// Camera distance past which LOD skeletons drawn near use their far display lists, 0 when they don't, see nsp_replacements.c
+f32 SkelAnime_GetLodDist(void);
+#endif
 void SkelAnime_DrawLod(struct PlayState* play, void** skeleton, Vec3s* jointTable, OverrideLimbDrawOpa overrideLimbDraw, PostLimbDrawOpa postLimbDraw, struct Actor* actor, s32 lod);
 void SkelAnime_DrawFlexLod(struct PlayState* play, void** skeleton, Vec3s* jointTable, s32 dListCount, OverrideLimbDrawFlex overrideLimbDraw, PostLimbDrawFlex postLimbDraw, struct Actor* actor, s32 lod);
 void SkelAnime_DrawOpa(struct PlayState* play, void** skeleton, Vec3s* jointTable, OverrideLimbDrawOpa overrideLimbDraw, PostLimbDrawOpa postLimbDraw, struct Actor* actor);
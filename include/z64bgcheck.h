@@ -335,6 +335,22 @@ typedef struct {
     /* 0x6 */ SSList floor;
 } DynaLookup; // size = 0x8
 
+#if DYNAPOLY_BVH
+typedef struct DynaBvhNode {
+    /* 0x0 */ Vec3s min;
+    /* 0x6 */ Vec3s max;
+    /* 0xC */ u16 start; // first of the two children, or the first `polyIds` entry of a leaf
+    /* 0xE */ u16 count; // polys of a leaf, 0 for an inner node
+} DynaBvhNode; // size = 0x10
+
+// Bounding volume hierarchy over the polys of a BgActor's CollisionHeader, in model space
+typedef struct DynaBvh {
+    /* 0x0 */ u16 numNodes;
+    /* 0x4 */ DynaBvhNode* nodes;
+    /* 0x8 */ u16* polyIds; // indices into the header's polyList, grouped by leaf
+} DynaBvh; // size = 0xC
+#endif
+
 typedef struct {
     /* 0x00 */ struct Actor* actor;
     /* 0x04 */ CollisionHeader* colHeader;
@@ -346,6 +362,10 @@ typedef struct {
     /* 0x54 */ Sphere16 boundingSphere;
     /* 0x5C */ f32 minY;
     /* 0x60 */ f32 maxY;
+#if DYNAPOLY_BVH
+    /* 0x64 */ DynaBvh* bvh; // built by `DynaPoly_SetBgActor`, NULL if there are no polys
+    /* 0x68 */ f32 bvhMtx[2][4]; // world x and z rows of the model to world transform the dyna polys were built with
+#endif
 } BgActor; // size = 0x64
 
 #define BGACTOR_IN_USE (1 << 0) // The bgActor entry is in use
@@ -365,6 +385,9 @@ typedef struct {
     /* 0x140C */ s32 polyNodesMax;
     /* 0x1410 */ s32 polyListMax;
     /* 0x1414 */ s32 vtxListMax;
+#if DYNAPOLY_BVH
+    /* 0x1418 */ u8* polyLookupType; // DYNA_RAYCAST_* list of each poly in polyList, 0 if it is in none
+#endif
 } DynaCollisionContext; // size = 0x1418
 
 typedef struct CollisionContext {
@@ -92,6 +92,10 @@ s16 EffectSs_LerpInv(s16 a, s16 b, s32 weightInv);
 s16 EffectSs_LerpS16(s16 a, s16 b, f32 weight);
 u8 EffectSs_LerpU8(u8 a, u8 b, f32 weight);
 void EffectSs_DrawGEffect(struct PlayState* play, EffectSs* this, void* texture);
+#if EFFECT_SS_BATCH
+Mtx* EffectSs_NewBillboardMtx(struct PlayState* play, Vec3f* pos, f32 sinZ, f32 cosZ, f32 scaleX, f32 scaleY, f32 scaleZ);
+s32 EffectSs_NeedsSetup(EffectSs* this);
+#endif
 void EffectSsDust_Spawn(struct PlayState* play, u16 drawFlags, Vec3f* pos, Vec3f* velocity, Vec3f* accel, Color_RGBA8* primColor, Color_RGBA8* envColor, s16 scale, s16 scaleStep, s16 life, u8 updateMode);
 void func_800B0DE0(struct PlayState* play, Vec3f* pos, Vec3f* velocity, Vec3f* accel, Color_RGBA8* primColor, Color_RGBA8* envColor, s16 scale, s16 scaleStep);
 void func_800B0E48(struct PlayState* play, Vec3f* pos, Vec3f* velocity, Vec3f* accel, Color_RGBA8* primColor, Color_RGBA8* envColor, s16 scale, s16 scaleStep);
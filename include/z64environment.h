@@ -181,6 +181,9 @@ typedef struct LightningStrike {
 
 #define ENV_FOGNEAR_MAX 996
 #define ENV_ZFAR_MAX 15000
+#if DRAW_DISTANCE
+#define ENV_FOGNEAR_DRAW_DISTANCE_MAX 970 // fogNear with a cut draw distance, so the fog hides where the scene stops
+#endif
 
 typedef struct {
     /* 0x00 */ u8 ambientColor[3];
@@ -310,6 +313,14 @@ s32 Environment_IsForcedSequenceDisabled(void);
 void Environment_PlayStormNatureAmbience(struct PlayState* play);
 void Environment_StopStormNatureAmbience(struct PlayState* play);
 void Environment_Draw(struct PlayState* play);
+#if ENV_EFFECT_BUDGET
+// Share of the N64 amounts of rain drops, stars and lens flare elements to draw, in 1/0x100ths, see gfx_nsp.c
+s32 Environment_GetEffectBudget(void);
+#endif
+#if DRAW_DISTANCE
+// Share of the scenes' draw distance kept, in 1/0x100ths, see gfx_nsp.c
+s32 Environment_GetDrawDistance(void);
+#endif
 void Environment_DrawSkyboxStars(struct PlayState* play);
 void Environment_StopTime(void);
 void Environment_StartTime(void);
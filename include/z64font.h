@@ -40,4 +40,18 @@ void Font_LoadCharNES(struct PlayState* play, u8 codePointIndex, s32 offset);
 void Font_LoadMessageBoxEndIcon(Font* font, u16 icon);
 void Font_LoadOrderedFont(Font* font);
 
+#if MESSAGE_GLYPH_ATLAS
+// The NES font kept as pages of 32 glyphs, each page a single 16x512 I4 texture filling TMEM, see z_kanfont.c
+#define FONT_GLYPH_COUNT 156 // code points ' ' to 0xBB
+#define FONT_GLYPH_NONE 0xFF
+#define FONT_GLYPH_PAGE_GLYPHS 32
+#define FONT_GLYPH_PAGE_HEIGHT (FONT_CHAR_TEX_HEIGHT * FONT_GLYPH_PAGE_GLYPHS)
+#define FONT_GLYPH_PAGE_SIZE (FONT_CHAR_TEX_SIZE * FONT_GLYPH_PAGE_GLYPHS)
+#define FONT_GLYPH_PAGES ((FONT_GLYPH_COUNT + FONT_GLYPH_PAGE_GLYPHS - 1) / FONT_GLYPH_PAGE_GLYPHS)
+
+void Font_ClearCharGlyphs(Font* font);
+s32 Font_GetCharGlyph(Font* font, void* charTex);
+void* Font_GetGlyphPage(s32 glyph);
+#endif
+
 #endif
@@ -168,6 +168,18 @@ typedef enum {
     /* 1 */ STORY_TYPE_GIANTS_LEAVING
 } StoryType;
 
+#if HUD_LAYER_CACHE
+// The parts of the HUD the renderer keeps from frame to frame, see layer_nsp.c
+typedef enum {
+    /* 0 */ HUD_LAYER_COUNTERS, // rupee and small key counters
+    /* 1 */ HUD_LAYER_MAGIC,
+    /* 2 */ HUD_LAYER_BUTTONS, // B and C buttons with their icons and ammo
+    /* 3 */ HUD_LAYER_A_BUTTON,
+    /* 4 */ HUD_LAYER_CLOCK, // face of the three-day clock
+    /* 5 */ HUD_LAYER_MINIMAP // rooms, doors and chests of the minimap
+} HudLayer;
+#endif
+
 typedef struct {
     /* 0x000 */ View view;
     /* 0x168 */ Vtx* actionVtx;
@@ -265,6 +277,9 @@ typedef struct {
     /* 0x33C */ u8* storySegment;
     /* 0x340 */ uintptr_t storyAddr;
     /* 0x344 */ size_t storySize;
+#if HUD_LAYER_CACHE
+    u32 texturesVersion; // counts the loads into doActionSegment and iconItemSegment, keys the HUD's layers
+#endif
 } InterfaceContext; // size = 0x348
 
 Gfx* Gfx_DrawTexRectRGBA16(Gfx* gfx, TexturePtr texture, s16 textureWidth, s16 textureHeight, s16 rectLeft, s16 rectTop, s16 rectWidth, s16 rectHeight, u16 dsdx, u16 dtdy);
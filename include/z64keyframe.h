@@ -162,6 +162,10 @@ void Keyframe_FlexChangeAnim(KFSkelAnimeFlex* kfSkelAnime, KeyFrameFlexSkeleton*
 void Keyframe_FlexChangeAnimQuick(KFSkelAnimeFlex* kfSkelAnime, KeyFrameAnimation* animation);
 f32 Keyframe_Interpolate(f32 t, f32 delta, f32 x0, f32 x1, f32 v0, f32 v1);
 s16 Keyframe_KeyCalc(s16 kfStart, s16 kfNum, KeyFrame* keyFrames, f32 t);
+#if KEYFRAME_FIXED
+s16 Keyframe_InterpolateFixed(s32 t, s32 delta, s32 x0, s32 x1, s32 v0, s32 v1);
+s16 Keyframe_KeyCalcFixed(s16 kfStart, s16 kfNum, KeyFrame* keyFrames, s32 t);
+#endif
 void Keyframe_MorphInterpolateRotation(f32 t, s16* out, s16 rot1, s16 rot2);
 void Keyframe_MorphInterpolateLinear(s16* jointData, s16* morphData, f32 t);
 void Keyframe_FlexMorphInterpolation(KFSkelAnimeFlex* kfSkelAnime);
@@ -71,6 +71,27 @@ typedef struct LightContext {
     /* 0xC */ s16 zFar; // draw distance. range 0 - 12800
 } LightContext; // size = 0x10
 
+#if LIGHTS_BIND_CACHE
+/**
+ * The lights an actor was bound to the last time it was drawn, and what they were bound from.
+ * `Lights_BindAllCached` copies them back instead of binding again while nothing of that changed.
+ */
+typedef struct LightsCache {
+    /* 0x00 */ u32 listGeneration; // 0 until bound once, the generations start at 1
+    /* 0x04 */ u32 viewGeneration; // only compared for microcode point lights
+    /* 0x08 */ Vec3f refPos; // only compared for the legacy point lights
+    /* 0x14 */ u8 mode; // `LightsCacheMode`
+    /* 0x15 */ u8 numLights;
+    /* 0x18 */ Light l[7];
+} LightsCache; // size = 0x88
+
+typedef enum LightsCacheMode {
+    /* 0 */ LIGHTS_CACHE_MODE_NONE, // directional lights only, the point lights are skipped
+    /* 1 */ LIGHTS_CACHE_MODE_POINT, // `Lights_BindPoint`
+    /* 2 */ LIGHTS_CACHE_MODE_LEGACY // `Lights_BindPointWithReference`
+} LightsCacheMode;
+#endif
+
 typedef enum LightType {
     /* 0 */ LIGHT_POINT_NOGLOW,
     /* 1 */ LIGHT_DIRECTIONAL,
@@ -85,6 +106,10 @@ void Lights_DirectionalSetInfo(LightInfo* info, s8 x, s8 y, s8 z, u8 r, u8 g, u8
 void Lights_Reset(Lights* lights, u8 r, u8 g, u8 b);
 void Lights_Draw(Lights* lights, struct GraphicsContext* gfxCtx);
 void Lights_BindAll(Lights* lights, LightNode* listHead, Vec3f* refPos, struct PlayState* play);
+#if LIGHTS_BIND_CACHE
+void Lights_BindAllCached(Lights* lights, LightNode* listHead, Vec3f* refPos, struct PlayState* play,
+                          LightsCache* cache);
+#endif
 void LightContext_Init(struct PlayState* play, LightContext* lightCtx);
 void LightContext_SetAmbientColor(LightContext* lightCtx, u8 r, u8 g, u8 b);
 void LightContext_SetFog(LightContext* lightCtx, u8 r, u8 g, u8 b, s16 near, s16 far);
@@ -195,8 +195,33 @@ extern Vec3s gZeroVec3s;
 #define SQXYZ(vec) ((vec.x) * (vec.x) + (vec.y) * (vec.y) + (vec.z) * (vec.z))
 #define DOTXYZ(vec1, vec2) ((vec1.x) * (vec2.x) + (vec1.y) * (vec2.y) + (vec1.z) * (vec2.z))
 
+#if TRIG_TABLE
+// One entry every 16 binang, the resolution of `sins`. Filled by `Math_InitTrigTable`, see trig_nsp.c
+#define TRIG_TABLE_SIZE 0x1000
+#define TRIG_TABLE_INDEX(angle) ((u16)(angle) >> 4)
+
+typedef struct TrigTableEntry {
+    /* 0x0 */ f32 sin; // sins(angle) * (1.0f / SHRT_MAX), same as `Math_SinS`
+    /* 0x4 */ f32 cos;
+    /* 0x8 */ s16 sinQ15; // sins(angle)
+    /* 0xA */ s16 cosQ15;
+} TrigTableEntry; // size = 0xC
+
+extern TrigTableEntry gTrigTable[TRIG_TABLE_SIZE];
+
+void Math_InitTrigTable(void);
+
+static inline f32 Math_CosS(s16 angle) {
+    return gTrigTable[TRIG_TABLE_INDEX(angle)].cos;
+}
+
+static inline f32 Math_SinS(s16 angle) {
+    return gTrigTable[TRIG_TABLE_INDEX(angle)].sin;
+}
+#else
 f32 Math_CosS(s16 angle);
 f32 Math_SinS(s16 angle);
+#endif
 s32 Math_StepToIImpl(s32 start, s32 target, s32 step);
 void Math_StepToIGet(s32* pValue, s32 target, s32 step);
 s32 Math_StepToI(s32* pValue, s32 target, s32 step);
@@ -242,8 +267,18 @@ f32 Math_Vec3f_StepTo(Vec3f* start, Vec3f* target, f32 speed);
 f32 Math_FactorialF(f32 n);
 f32 Math_Factorial(s32 n);
 f32 Math_PowF(f32 base, s32 exp);
+#if TRIG_TABLE
+static inline f32 Math_SinF(f32 rad) {
+    return gTrigTable[TRIG_TABLE_INDEX(RAD_TO_BINANG(rad))].sin;
+}
+
+static inline f32 Math_CosF(f32 rad) {
+    return gTrigTable[TRIG_TABLE_INDEX(RAD_TO_BINANG(rad))].cos;
+}
+#else
 f32 Math_SinF(f32 rad);
 f32 Math_CosF(f32 rad);
+#endif
 
 s16 Math_Atan2S(f32 y, f32 x);
 f32 Math_Atan2F(f32 y, f32 x);
@@ -62,6 +62,10 @@ typedef struct {
 typedef struct {
     /* 0x0 */ u8 index; // alternates every draw cycle
     /* 0x4 */ Vtx* buf[2]; // number of vertices in buffer determined by `totalVtxCount`
+#if SKIN_VTX_CACHE
+    /* 0xC */ u32 modifKey; // Key of the limb matrices `buf` was last computed from, see `Skin_ApplyLimbModifications`
+    /* 0x10 */ u8 numCurrent; // Buffers holding the vertices of `modifKey`, 0 until they are first computed
+#endif
 } SkinLimbVtx; // size = 0xC
 
 typedef struct {
@@ -80,6 +84,9 @@ typedef s32 (*SkinOverrideLimbDraw)(struct Actor* thisx, struct PlayState* play,
 
 
 void Skin_UpdateVertices(MtxF* mtx, SkinVertex* skinVertices, SkinLimbModif* modifEntry, Vtx* vtxBuf, Vec3f* pos);
+#if SKIN_VTX_CACHE
+u32 Skin_GetLimbModifKey(SkinLimbModif* modifications, s32 modifCount, s32 arg3);
+#endif
 void Skin_ApplyLimbModifications(struct GraphicsContext* gfxCtx, Skin* skin, s32 limbIndex, s32 arg3);
 void Skin_DrawAnimatedLimb(struct GraphicsContext* gfxCtx, Skin* skin, s32 limbIndex, s32 arg3, s32 drawFlags);
 void Skin_DrawLimb(struct GraphicsContext* gfxCtx, Skin* skin, s32 limbIndex, Gfx* dList, s32 drawFlags);
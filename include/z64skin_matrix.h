@@ -7,6 +7,9 @@
 struct GraphicsContext;
 
 void SkinMatrix_Vec3fMtxFMultXYZW(MtxF* mf, Vec3f* src, Vec3f* xyzDest, f32* wDest);
+#if ACTOR_CULL_BATCH
+void SkinMatrix_Vec3fMtxFMultXYZWBatch(MtxF* mf, Vec3f* src, Vec3f* xyzDest, f32* wDest, s32 count);
+#endif
 void SkinMatrix_Vec3fMtxFMultXYZ(MtxF* mf, Vec3f* src, Vec3f* dest);
 void SkinMatrix_MtxFMtxFMult(MtxF* mfB, MtxF* mfA, MtxF* dest);
 void SkinMatrix_GetClear(MtxF** mfp);
@@ -39,6 +39,9 @@ typedef struct SkyboxContext {
     /* 0x220 */ s16 angle;
     /* 0x222 */ Color_RGB8 prim;
     /* 0x225 */ Color_RGB8 env;
+#if SKYBOX_LAYER_CACHE
+    u32 texturesVersion; // counts the loads into staticSegments and palette, keys the sky's layer
+#endif
 } SkyboxContext; // size = 0x228
 
 void Skybox_Reload(struct PlayState* play, SkyboxContext* skyboxCtx, s16 skyboxId);
@@ -259,6 +259,80 @@ s32 AudioScript_HandleScriptFlowControl(SequencePlayer* seqPlayer, SeqScriptStat
     return 0;
 }
 
+#if SEQ_WAKE_TICKS
+/**
+ * Takes the ticks a sleeping channel skipped off its delay and those of its layers, as if they had been processed one by
+ * one. Must be called before anything outside of the channel's own processing changes it.
+ */
+void AudioScript_SeqChannelWake(SequenceChannel* channel) {
+    s32 i;
+
+    if (channel->sleptTicks != 0) {
+        if (!channel->stopScript) {
+            channel->delay -= channel->sleptTicks;
+        }
+        for (i = 0; i < ARRAY_COUNT(channel->layers); i++) {
+            if ((channel->layers[i] != NULL) && channel->layers[i]->enabled) {
+                channel->layers[i]->delay -= channel->sleptTicks;
+            }
+        }
+    }
+    channel->sleepTicks = 0;
+    channel->sleptTicks = 0;
+}
+
+/**
+ * After a tick was processed, counts how many of the next ones can only count delays down, so that they can be skipped:
+ * those before the channel's script runs again and before any of its layers runs its script or decays its note for
+ * the gate time.
+ */
+void AudioScript_SeqChannelSetSleep(SequenceChannel* channel) {
+    s32 sleep = 0xFFFF;
+    s32 i;
+
+    if (!channel->stopScript) {
+        sleep = (channel->delay >= 2) ? channel->delay - 1 : 0;
+    }
+
+    for (i = 0; (i < ARRAY_COUNT(channel->layers)) && (sleep != 0); i++) {
+        SequenceLayer* layer = channel->layers[i];
+        s32 layerSleep;
+
+        if ((layer == NULL) || !layer->enabled) {
+            continue;
+        }
+
+        if (layer->delay <= 1) {
+            layerSleep = 0;
+        } else if (layer->muted) {
+            layerSleep = layer->delay - 1;
+        } else {
+            // The note decays on the tick that counts the delay down to gateDelay
+            layerSleep = CLAMP(layer->delay - 1 - layer->gateDelay, 0, layer->delay - 1);
+        }
+        sleep = MIN(sleep, layerSleep);
+    }
+
+    channel->sleepTicks = sleep;
+}
+
+/**
+ * Skips the tick if the channel is asleep.
+ */
+s32 AudioScript_SeqChannelSleep(SequenceChannel* channel) {
+    if (channel->sleepTicks == 0) {
+        return false;
+    }
+    channel->sleepTicks--;
+    channel->sleptTicks++;
+    if (channel->sleepTicks == 0) {
+        // Due next tick, which sees the delays as they would have been
+        AudioScript_SeqChannelWake(channel);
+    }
+    return true;
+}
+#endif
+
 void AudioScript_InitSequenceChannel(SequenceChannel* channel) {
     s32 i;
 
@@ -266,6 +340,11 @@ void AudioScript_InitSequenceChannel(SequenceChannel* channel) {
         return;
     }
 
+#if SEQ_WAKE_TICKS
+    channel->sleepTicks = 0;
+    channel->sleptTicks = 0;
+#endif
+
     channel->enabled = false;
     channel->finished = false;
     channel->stopScript = false;
@@ -400,6 +479,9 @@ void AudioScript_SeqLayerFree(SequenceChannel* channel, s32 layerIndex) {
 void AudioScript_SequenceChannelDisable(SequenceChannel* channel) {
     s32 i;
 
+#if SEQ_WAKE_TICKS
+    AudioScript_SeqChannelWake(channel);
+#endif
     channel->finished = true;
 
     for (i = 0; i < 4; i++) {
@@ -441,6 +523,9 @@ void AudioScript_SequenceChannelEnable(SequencePlayer* seqPlayer, u8 channelInde
     SequenceChannel* channel = seqPlayer->channels[channelIndex];
     s32 i;
 
+#if SEQ_WAKE_TICKS
+    AudioScript_SeqChannelWake(channel);
+#endif
     channel->enabled = true;
     channel->finished = false;
     channel->scriptState.depth = 0;
@@ -1199,6 +1284,11 @@ void AudioScript_SequenceChannelProcessScript(SequenceChannel* channel) {
     SequencePlayer* seqPlayer;
 
     if (channel->stopScript) {
+#if SEQ_WAKE_TICKS
+        if (AudioScript_SeqChannelSleep(channel)) {
+            return;
+        }
+#endif
         goto exit_loop;
     }
 
@@ -1207,6 +1297,12 @@ void AudioScript_SequenceChannelProcessScript(SequenceChannel* channel) {
         return;
     }
 
+#if SEQ_WAKE_TICKS
+    if (AudioScript_SeqChannelSleep(channel)) {
+        return;
+    }
+#endif
+
     if (channel->delay >= 2) {
         channel->delay--;
         goto exit_loop;
@@ -1829,6 +1925,10 @@ exit_loop:
             AudioScript_SeqLayerProcessScript(channel->layers[i]);
         }
     }
+
+#if SEQ_WAKE_TICKS
+    AudioScript_SeqChannelSetSleep(channel);
+#endif
 }
 
 void AudioScript_SequencePlayerProcessSequence(SequencePlayer* seqPlayer) {
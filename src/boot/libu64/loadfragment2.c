@@ -12,6 +12,11 @@
 
 s32 gOverlayLogSeverity = 2;
 
+#if OVERLAY_PAGING
+// The Nspire port's overlays are ARM code from its asset pack, see overlay_nsp.c
+size_t nsp_overlay_read(void* ram, uintptr_t vromStart);
+#endif
+
 // Extract MIPS register rs from an instruction word
 #define MIPS_REG_RS(insn) (((insn) >> 0x15) & 0x1F)
 
@@ -21,6 +26,7 @@ s32 gOverlayLogSeverity = 2;
 // Extract MIPS jump target from an instruction word
 #define MIPS_JUMP_TARGET(insn) (((insn)&0x03FFFFFF) << 2)
 
+#ifndef COMPACT_RELOCS
 /**
  * Performs runtime relocation of overlay files, loadable code segments.
  *
@@ -140,6 +146,107 @@ void Overlay_Relocate(void* allocatedRamAddr, OverlayRelocationSection* ovlReloc
         }
     }
 }
+#else
+/**
+ * Overlay_Relocate for the relocation section written by `fado --compact`, enabled with COMPACT_RELOCS.
+ *
+ * The relocations are stored as runs of 16-bit values. Each run starts with one relocation in the packed 32-bit format
+ * of the original Overlay_Relocate split in two halfwords, then the number of relocations after it in the run. Each
+ * of those is given by its distance in words to the relocation before it. There are three kinds of run per section:
+ *  - R_MIPS_32 and R_MIPS_26: sorted by offset, each halfword is the unsigned distance.
+ *  - R_MIPS_HI16/R_MIPS_LO16: in the original order, for the register tracking. Each halfword is the signed distance
+ *    shifted left by 1, with bit 0 set if the relocation is a R_MIPS_LO16.
+ * Each run is applied in its own loop, so only the R_MIPS_HI16/R_MIPS_LO16 runs branch on the type per relocation.
+ *
+ * @param allocatedRamAddress Memory address the binary was loaded at.
+ * @param ovlRelocs Overlay relocation section, an OverlayCompactRelocationSection.
+ * @param vramStart Virtual RAM address that the overlay was compiled at.
+ */
+void Overlay_Relocate(void* allocatedRamAddr, OverlayRelocationSection* ovlRelocs, void* vramStart) {
+    OverlayCompactRelocationSection* compactRelocs = (OverlayCompactRelocationSection*)ovlRelocs;
+    u32 sections[RELOC_SECTION_MAX];
+    u16* runP = compactRelocs->runs;
+    u16* runEnd;
+    u32* relocDataP;
+    u32 reloc;
+    uintptr_t relocatedAddress;
+    u32 i;
+    u32* luiInstRef;
+    u32 isLo;
+    u32 isLoNeg;
+    // See the register tracking in the original Overlay_Relocate
+    u32* luiRefs[32];
+    u32 luiVals[32];
+    uintptr_t allocu32 = (uintptr_t)allocatedRamAddr;
+    uintptr_t vramu32 = (uintptr_t)vramStart;
+
+    sections[RELOC_SECTION_NULL] = 0;
+    sections[RELOC_SECTION_TEXT] = allocu32;
+    sections[RELOC_SECTION_DATA] = allocu32 + compactRelocs->textSize;
+    sections[RELOC_SECTION_RODATA] = sections[RELOC_SECTION_DATA] + compactRelocs->dataSize;
+
+    for (i = 0; i < compactRelocs->numRuns; i++) {
+        reloc = (runP[0] << 16) | runP[1];
+        runEnd = &runP[3] + runP[2];
+        runP += 3;
+        relocDataP = (u32*)(sections[RELOC_SECTION(reloc)] + RELOC_OFFSET(reloc));
+
+        switch (RELOC_TYPE_MASK(reloc)) {
+            case R_MIPS_32 << RELOC_TYPE_SHIFT:
+                while (true) {
+                    if ((*relocDataP & 0x0F000000) == 0) {
+                        *relocDataP = *relocDataP - vramu32 + allocu32;
+                    }
+                    if (runP == runEnd) {
+                        break;
+                    }
+                    relocDataP += *runP++;
+                }
+                break;
+
+            case R_MIPS_26 << RELOC_TYPE_SHIFT:
+                while (true) {
+                    *relocDataP =
+                        (*relocDataP & 0xFC000000) |
+                        (((PHYS_TO_K0(MIPS_JUMP_TARGET(*relocDataP)) - vramu32 + allocu32) & 0x0FFFFFFF) >> 2);
+                    if (runP == runEnd) {
+                        break;
+                    }
+                    relocDataP += *runP++;
+                }
+                break;
+
+            case R_MIPS_HI16 << RELOC_TYPE_SHIFT:
+            case R_MIPS_LO16 << RELOC_TYPE_SHIFT:
+                isLo = RELOC_TYPE_MASK(reloc) == (R_MIPS_LO16 << RELOC_TYPE_SHIFT);
+                while (true) {
+                    if (!isLo) {
+                        luiRefs[MIPS_REG_RT(*relocDataP)] = relocDataP;
+                        luiVals[MIPS_REG_RT(*relocDataP)] = *relocDataP;
+                    } else {
+                        luiInstRef = luiRefs[MIPS_REG_RS(*relocDataP)];
+
+                        if ((((*luiInstRef << 0x10) + (s16)*relocDataP) & 0x0F000000) == 0) {
+                            relocatedAddress = ((luiVals[MIPS_REG_RS(*relocDataP)] << 0x10) + (s16)*relocDataP) -
+                                               vramu32 + allocu32;
+                            isLoNeg = (relocatedAddress & 0x8000) ? 1 : 0;
+                            *luiInstRef =
+                                (*luiInstRef & 0xFFFF0000) | (((relocatedAddress >> 0x10) & 0xFFFF) + isLoNeg);
+                            *relocDataP = (*relocDataP & 0xFFFF0000) | (relocatedAddress & 0xFFFF);
+                        }
+                    }
+                    if (runP == runEnd) {
+                        break;
+                    }
+                    isLo = *runP & 1;
+                    relocDataP += (s16)*runP++ >> 1;
+                }
+                break;
+        }
+        runP = runEnd;
+    }
+}
+#endif
 
 size_t Overlay_Load(uintptr_t vromStart, uintptr_t vromEnd, void* vramStart, void* vramEnd, void* allocatedRamAddr) {
     s32 pad[2];
@@ -160,7 +267,12 @@ size_t Overlay_Load(uintptr_t vromStart, uintptr_t vromEnd, void* vramStart, voi
         // "TEXT,DATA,RODATA+relをＤＭＡ転送します(%08x-%08x)\n"
     }
 
+#if OVERLAY_PAGING
+    size = nsp_overlay_read(allocatedRamAddr, vromStart);
+    end = (uintptr_t)allocatedRamAddr + size;
+#else
     DmaMgr_RequestSync(allocatedRamAddr, vromStart, size);
+#endif
 
     // The overlay file is expected to contain a 32-bit offset from the end of the file to the start of the
     // relocation section.
@@ -198,6 +310,9 @@ size_t Overlay_Load(uintptr_t vromStart, uintptr_t vromEnd, void* vramStart, voi
     return size;
 }
 
+#if OVERLAY_PAGING
+// The Nspire port keeps its game state overlays linked in, and its own Overlay_AllocateAndLoad
+#else
 void* Overlay_AllocateAndLoad(uintptr_t vromStart, uintptr_t vromEnd, void* vramStart, void* vramEnd) {
     void* allocatedRamAddr = malloc_r((uintptr_t)vramEnd - (uintptr_t)vramStart);
 
@@ -207,3 +322,4 @@ void* Overlay_AllocateAndLoad(uintptr_t vromStart, uintptr_t vromEnd, void* vram
 
     return allocatedRamAddr;
 }
+#endif
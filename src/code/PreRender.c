@@ -59,6 +59,7 @@ void PreRender_Destroy(PreRender* this) {
     ListAlloc_FreeAll(&this->alloc);
 }
 
+#if !PRERENDER_NATIVE // prerender_nsp.c
 void PreRender_CopyImage(PreRender* this, Gfx** gfxP, void* img, void* imgDst, u32 useThresholdAlphaCompare) {
     Gfx* gfx = *gfxP;
     u32 flags;
@@ -79,11 +80,13 @@ void PreRender_CopyImage(PreRender* this, Gfx** gfxP, void* img, void* imgDst, u
 
     *gfxP = gfx;
 }
+#endif
 
 void PreRender_RestoreBuffer(PreRender* this, Gfx** gfxP, void* buf, void* bufSave) {
     PreRender_CopyImage(this, gfxP, buf, bufSave, false);
 }
 
+#if !PRERENDER_NATIVE // prerender_nsp.c
 void func_8016FF90(PreRender* this, Gfx** gfxP, void* buf, void* bufSave, s32 envR, s32 envG, s32 envB, s32 envA) {
     Gfx* gfx = *gfxP;
 
@@ -115,11 +118,13 @@ void func_8016FF90(PreRender* this, Gfx** gfxP, void* buf, void* bufSave, s32 en
 
     *gfxP = gfx;
 }
+#endif
 
 void func_80170200(PreRender* this, Gfx** gfxP, void* buf, void* bufSave) {
     func_8016FF90(this, gfxP, buf, bufSave, 255, 255, 255, 255);
 }
 
+#if !PRERENDER_NATIVE // prerender_nsp.c
 /**
  * Reads the coverage values stored in the RGBA16 format `img` with dimensions `this->width`, `this->height` and
  * converts it to an 8-bpp intensity image.
@@ -204,6 +209,7 @@ void PreRender_CoverageRgba16ToI8(PreRender* this, Gfx** gfxP, void* img, void*
 
     *gfxP = gfx;
 }
+#endif
 
 /**
  * Saves zbuf to zbufSave
@@ -223,6 +229,7 @@ void PreRender_SaveFramebuffer(PreRender* this, Gfx** gfxP) {
     }
 }
 
+#if !PRERENDER_NATIVE // prerender_nsp.c
 /**
  * Fetches the coverage of the current framebuffer into an image of the same format as the current color image, storing
  * it over the framebuffer in memory.
@@ -259,6 +266,7 @@ void PreRender_FetchFbufCoverage(PreRender* this, Gfx** gfxP) {
 
     *gfxP = gfx;
 }
+#endif
 
 /**
  * Draws the coverage of the current framebuffer `this->fbuf` to an I8 image at `this->cvgSave`. Overwrites
@@ -279,6 +287,7 @@ void PreRender_RestoreZBuffer(PreRender* this, Gfx** gfxP) {
     PreRender_RestoreBuffer(this, gfxP, this->zbufSave, this->zbuf);
 }
 
+#if !PRERENDER_NATIVE // prerender_nsp.c
 /**
  * Draws a full-screen image to the current framebuffer, that sources the rgb channel from `this->fbufSave` and
  * the alpha channel from `this->cvgSave` modulated by environment color.
@@ -350,6 +359,7 @@ void func_80170798(PreRender* this, Gfx** gfxP) {
         *gfxP = gfx;
     }
 }
+#endif
 
 void func_80170AE0(PreRender* this, Gfx** gfxP, s32 alpha) {
     func_8016FF90(this, gfxP, this->fbufSave, this->fbuf, 255, 255, 255, alpha);
@@ -362,6 +372,7 @@ void PreRender_RestoreFramebuffer(PreRender* this, Gfx** gfxP) {
     PreRender_RestoreBuffer(this, gfxP, this->fbufSave, this->fbuf);
 }
 
+#if !PRERENDER_NATIVE // prerender_nsp.c
 /**
  * Applies the Video Interface anti-aliasing of silhouette edges to an image.
  *
@@ -547,6 +558,7 @@ void PreRender_AntiAliasFilter(PreRender* this) {
         }
     }
 }
+#endif
 
 /**
  * Selects the median value from 9 different 5-bit pixels:
@@ -597,6 +609,7 @@ u32 PreRender_Get5bMedian9(u8* px1, u8* px2, u8* px3) {
     return pxMed;
 }
 
+#if !PRERENDER_NATIVE // prerender_nsp.c
 // Despite the name, this function doesn't seem like an hardware-accurate divot filter
 void PreRender_DivotFilter(PreRender* this) {
     u32 width = this->width;
@@ -735,6 +748,7 @@ void PreRender_ApplyFiltersSlowlyDestroy(PreRender* this) {
         sSlowlyRunning = false;
     }
 }
+#endif
 
 // Unused, likely since `PreRender_ApplyFilters` already handles NULL checks
 void func_801720C4(PreRender* this) {
@@ -840,6 +854,7 @@ void Prerender_DrawBackground2DImpl(PreRenderBackground2DParams* bg2D, Gfx** gfx
     *gfxP = gfx;
 }
 
+#if !PRERENDER_NATIVE // prerender_nsp.c
 void Prerender_DrawBackground2D(Gfx** gfxP, void* timg, void* tlut, u16 width, u16 height, u8 fmt, u8 siz, u16 tt,
                                 u16 tlutCount, f32 x, f32 y, f32 xScale, f32 yScale, u32 flags) {
     PreRenderBackground2DParams bg2D;
@@ -861,3 +876,4 @@ void Prerender_DrawBackground2D(Gfx** gfxP, void* timg, void* tlut, u16 width, u
 
     Prerender_DrawBackground2DImpl(bg2DPtr, gfxP);
 }
+#endif
@@ -397,6 +397,97 @@ s16 Keyframe_KeyCalc(s16 kfStart, s16 kfNum, KeyFrame* keyFrames, f32 t) {
     }
 }
 
+#if KEYFRAME_FIXED
+// Keyframe_KeyCalcFixed takes times in frames with 16 fractional bits
+#define KEYFRAME_FIXED_SHIFT 16
+#define KEYFRAME_TIME_FIXED(t) ((s32)((t) * (1 << KEYFRAME_FIXED_SHIFT)))
+#define KEYFRAME_FRAME_FIXED(frame) ((s32)(frame) << KEYFRAME_FIXED_SHIFT)
+
+// The key each track was found between last time, looked up by the address of the track's first key. Tracks of actors
+// sharing an animation share an entry, which only costs them the search again when they play different times.
+#define KEYFRAME_CURSOR_CACHE_SIZE 256
+
+typedef struct {
+    /* 0x0 */ KeyFrame* track;
+    /* 0x4 */ s16 kf;
+} KeyframeCursor; // size = 0x8
+
+static KeyframeCursor sKeyframeCursors[KEYFRAME_CURSOR_CACHE_SIZE];
+
+/**
+ * Keyframe_Interpolate in fixed point, rounded to the nearest integer.
+ *
+ * @param t Time along the curve in [0, 1), with 24 fractional bits
+ * @param delta Scales the rates of change v0 and v1, with 16 fractional bits
+ */
+s16 Keyframe_InterpolateFixed(s32 t, s32 delta, s32 x0, s32 x1, s32 v0, s32 v1) {
+    s64 t2 = ((s64)t * t) >> 24;
+    s64 t3 = (t2 * t) >> 24;
+    s64 px1 = 3 * t2 - 2 * t3;
+    s64 px0 = (1 << 24) - px1;
+    s64 pv0 = t3 - 2 * t2 + t;
+    s64 pv1 = t3 - t2;
+    s64 value = px0 * x0 + px1 * x1 + (((pv0 * v0 + pv1 * v1) * delta) >> 16);
+
+    return (value + (1 << 23)) >> 24;
+}
+
+/**
+ * Keyframe_KeyCalc in fixed point, for `t` from KEYFRAME_TIME_FIXED. The keys around `t` are searched from the ones the
+ * track was last sampled between, which is the same or the next pair while an animation plays, so a track costs the
+ * same however many keys it has. The results are within 1 of Keyframe_KeyCalc's.
+ */
+s16 Keyframe_KeyCalcFixed(s16 kfStart, s16 kfNum, KeyFrame* keyFrames, s32 t) {
+    KeyFrame* keyFramesOffset = &keyFrames[kfStart];
+    KeyframeCursor* cursor =
+        &sKeyframeCursors[((uintptr_t)keyFramesOffset / sizeof(KeyFrame)) % KEYFRAME_CURSOR_CACHE_SIZE];
+    s32 kf1 = 0;
+    s32 delta;
+
+    if (t <= KEYFRAME_FRAME_FIXED(keyFramesOffset->frame)) {
+        return keyFramesOffset->value;
+    }
+    if (KEYFRAME_FRAME_FIXED(keyFramesOffset[kfNum - 1].frame) <= t) {
+        return keyFramesOffset[kfNum - 1].value;
+    }
+
+    if ((cursor->track == keyFramesOffset) && (cursor->kf < kfNum - 1)) {
+        kf1 = cursor->kf;
+    }
+
+    if (t < KEYFRAME_FRAME_FIXED(keyFramesOffset[kf1].frame)) {
+        // Went back, like a loop restarting: binary search the keys before the cursor
+        s32 kf2 = kf1;
+
+        kf1 = 0;
+        while (kf2 - kf1 > 1) {
+            s32 mid = (kf1 + kf2) / 2;
+
+            if (KEYFRAME_FRAME_FIXED(keyFramesOffset[mid].frame) <= t) {
+                kf1 = mid;
+            } else {
+                kf2 = mid;
+            }
+        }
+    }
+    while (KEYFRAME_FRAME_FIXED(keyFramesOffset[kf1 + 1].frame) <= t) {
+        kf1++;
+    }
+
+    cursor->track = keyFramesOffset;
+    cursor->kf = kf1;
+
+    // The keys are ordered by frame, so kf1.frame <= t < kf2.frame leaves them apart
+    delta = keyFramesOffset[kf1 + 1].frame - keyFramesOffset[kf1].frame;
+    return Keyframe_InterpolateFixed(((u64)(u32)(t - KEYFRAME_FRAME_FIXED(keyFramesOffset[kf1].frame)) << 8) / delta,
+                                     (delta << 16) / 30, keyFramesOffset[kf1].value, keyFramesOffset[kf1 + 1].value,
+                                     keyFramesOffset[kf1].velocity, keyFramesOffset[kf1 + 1].velocity);
+}
+
+// DEG_TO_BINANG(FMOD(tenths * 0.1f, 360)) in integers, within 1 of it
+#define KEYFRAME_TENTHS_TO_BINANG(tenths) ((s16)((((tenths) % 3600) * 0x8000) / 1800))
+#endif
+
 /**
  * Morph interpolator for rotation.
  *
@@ -534,6 +625,9 @@ s32 Keyframe_UpdateFlex(KFSkelAnimeFlex* kfSkelAnime) {
     u32 bit;
     s32 i;
     s32 j;
+#if KEYFRAME_FIXED
+    s32 curTime = KEYFRAME_TIME_FIXED(kfSkelAnime->frameCtrl.curTime);
+#endif
 
     // If there are morph frames to process, use the morph table
     if (kfSkelAnime->morphFrames != 0.0f) {
@@ -576,7 +670,11 @@ s32 Keyframe_UpdateFlex(KFSkelAnimeFlex* kfSkelAnime) {
             for (j = 0; j < 3; j++) {
                 if (bitFlags[limbIndex] & bit) {
                     // If the bit is set, interpolate with keyframes
+#if KEYFRAME_FIXED
+                    *outputValues = Keyframe_KeyCalcFixed(kfStart, kfNums[kfn], keyFrames, curTime);
+#else
                     *outputValues = Keyframe_KeyCalc(kfStart, kfNums[kfn], keyFrames, kfSkelAnime->frameCtrl.curTime);
+#endif
                     kfStart += kfNums[kfn];
                     kfn++;
                 } else {
@@ -588,7 +686,11 @@ s32 Keyframe_UpdateFlex(KFSkelAnimeFlex* kfSkelAnime) {
 
                 if (i == 1) {
                     // For rotations, translate angle value from tenths of a degree to binang
+#if KEYFRAME_FIXED
+                    *outputValues = KEYFRAME_TENTHS_TO_BINANG(*outputValues);
+#else
                     *outputValues = DEG_TO_BINANG(FMOD(*outputValues * 0.1f, 360));
+#endif
                 }
                 outputValues++;
             }
@@ -1034,6 +1136,9 @@ s32 Keyframe_UpdateStandard(KFSkelAnime* kfSkelAnime) {
     KeyFrame* keyFrames;
     s16* kfNums;
     s16* outputValues;
+#if KEYFRAME_FIXED
+    s32 curTime = KEYFRAME_TIME_FIXED(kfSkelAnime->frameCtrl.curTime);
+#endif
 
     // Choose which array to update, if currently morphing update the morph table else update the joint table
     if (kfSkelAnime->morphFrames != 0.0f) {
@@ -1070,7 +1175,11 @@ s32 Keyframe_UpdateStandard(KFSkelAnime* kfSkelAnime) {
     // 3 iter (x, y, z)
     for (i = 0; i < 3; i++) {
         if (bitFlags[0] & bit) {
+#if KEYFRAME_FIXED
+            *outputValues = Keyframe_KeyCalcFixed(kfStart, kfNums[kfn], keyFrames, curTime);
+#else
             *outputValues = Keyframe_KeyCalc(kfStart, kfNums[kfn], keyFrames, kfSkelAnime->frameCtrl.curTime);
+#endif
             kfStart += kfNums[kfn++];
         } else {
             *outputValues = fixedValues[fixedValueIndex++];
@@ -1089,7 +1198,11 @@ s32 Keyframe_UpdateStandard(KFSkelAnime* kfSkelAnime) {
             s32 pad;
 
             if (bitFlags[limbIndex] & bit) {
+#if KEYFRAME_FIXED
+                *outputValues = Keyframe_KeyCalcFixed(kfStart, kfNums[kfn], keyFrames, curTime);
+#else
                 *outputValues = Keyframe_KeyCalc(kfStart, kfNums[kfn], keyFrames, kfSkelAnime->frameCtrl.curTime);
+#endif
                 kfStart += kfNums[kfn++];
             } else {
                 *outputValues = fixedValues[fixedValueIndex++];
@@ -1097,7 +1210,11 @@ s32 Keyframe_UpdateStandard(KFSkelAnime* kfSkelAnime) {
             bit >>= 1;
 
             // Translate angle value from tenths of a degree to binang
+#if KEYFRAME_FIXED
+            *outputValues = KEYFRAME_TENTHS_TO_BINANG(*outputValues);
+#else
             *outputValues = DEG_TO_BINANG(FMOD(*outputValues * 0.1f, 360));
+#endif
             outputValues++;
         }
     }
@@ -1302,7 +1419,12 @@ void Keyframe_FlexGetScale(KFSkelAnimeFlex* kfSkelAnime, s32 targetLimbIndex, Ve
                 // 3 iter (x, y, z)
                 for (j = 0; j < 3; j++) {
                     if (bitFlags[limbIndex] & bit) {
+#if KEYFRAME_FIXED
+                        *scaleArray = Keyframe_KeyCalcFixed(kfStart, kfNums[kfn], keyFrames,
+                                                            KEYFRAME_TIME_FIXED(kfSkelAnime->frameCtrl.curTime));
+#else
                         *scaleArray = Keyframe_KeyCalc(kfStart, kfNums[kfn], keyFrames, kfSkelAnime->frameCtrl.curTime);
+#endif
                         kfStart += kfNums[kfn];
                         kfn++;
                     } else {
@@ -43,6 +43,57 @@ void Graph_InitTHGA(TwoHeadGfxArena* arena, Gfx* buffer, s32 size) {
     THGA_Init(arena, buffer, size);
 }
 
+#if GFXPOOL_SIZING
+// The sizes of the buffers of both pools, which the platform may change before Graph_ThreadEntry allocates them
+size_t gGfxPoolSizes[GFXPOOL_BUFFER_MAX] = {
+    0x3380 * sizeof(Gfx), // GFXPOOL_POLY_OPA
+    0x800 * sizeof(Gfx),  // GFXPOOL_POLY_XLU
+    0x400 * sizeof(Gfx),  // GFXPOOL_OVERLAY
+};
+
+// Bytes of the arenas the last frame used, and the most any frame used since startup
+u32 gGfxPoolUsed[GFXPOOL_STAT_MAX];
+u32 gGfxPoolPeak[GFXPOOL_STAT_MAX];
+
+void Graph_AllocGfxPools(void) {
+    s32 i;
+
+    for (i = 0; i < ARRAY_COUNT(gGfxPools); i++) {
+        gGfxPools[i].polyOpaBuffer = malloc(gGfxPoolSizes[GFXPOOL_POLY_OPA]);
+        gGfxPools[i].polyXluBuffer = malloc(gGfxPoolSizes[GFXPOOL_POLY_XLU]);
+        gGfxPools[i].overlayBuffer = malloc(gGfxPoolSizes[GFXPOOL_OVERLAY]);
+    }
+}
+
+/**
+ * Measures the arenas of the frame just built. An arena that overflowed measures past its size, what it would have
+ * needed.
+ */
+void Graph_MeasureGfxPool(GraphicsContext* gfxCtx) {
+    TwoHeadGfxArena* arenas[] = { &gfxCtx->polyOpa, &gfxCtx->polyXlu, &gfxCtx->overlay, &gfxCtx->work };
+    u32 tail = 0;
+    s32 i;
+
+    for (i = 0; i < ARRAY_COUNT(arenas); i++) {
+        gGfxPoolUsed[i] = arenas[i]->size - THGA_GetRemaining(arenas[i]);
+        tail += (uintptr_t)arenas[i]->start + arenas[i]->size - (uintptr_t)arenas[i]->d;
+    }
+    gGfxPoolUsed[GFXPOOL_STAT_TAIL] = tail;
+
+    for (i = 0; i < GFXPOOL_STAT_MAX; i++) {
+        if (gGfxPoolPeak[i] < gGfxPoolUsed[i]) {
+            gGfxPoolPeak[i] = gGfxPoolUsed[i];
+        }
+    }
+}
+#endif
+
+#if DRAW_SKIP
+// Set by the platform while the frame being built is going to be dropped. The game then leaves out of it the drawing
+// that changes none of its state, see Play_DrawMain.
+u8 gGraphSkipDraw;
+#endif
+
 void Graph_SetNextGfxPool(GraphicsContext* gfxCtx) {
     GfxPool* pool = &gGfxPools[gfxCtx->gfxPoolIdx % 2];
 
@@ -52,9 +103,15 @@ void Graph_SetNextGfxPool(GraphicsContext* gfxCtx) {
     pool->headMagic = GFXPOOL_HEAD_MAGIC;
     pool->tailMagic = GFXPOOL_TAIL_MAGIC;
 
+#if GFXPOOL_SIZING
+    Graph_InitTHGA(&gfxCtx->polyOpa, pool->polyOpaBuffer, gGfxPoolSizes[GFXPOOL_POLY_OPA]);
+    Graph_InitTHGA(&gfxCtx->polyXlu, pool->polyXluBuffer, gGfxPoolSizes[GFXPOOL_POLY_XLU]);
+    Graph_InitTHGA(&gfxCtx->overlay, pool->overlayBuffer, gGfxPoolSizes[GFXPOOL_OVERLAY]);
+#else
     Graph_InitTHGA(&gfxCtx->polyOpa, pool->polyOpaBuffer, sizeof(pool->polyOpaBuffer));
     Graph_InitTHGA(&gfxCtx->polyXlu, pool->polyXluBuffer, sizeof(pool->polyXluBuffer));
     Graph_InitTHGA(&gfxCtx->overlay, pool->overlayBuffer, sizeof(pool->overlayBuffer));
+#endif
     Graph_InitTHGA(&gfxCtx->work, pool->workBuffer, sizeof(pool->workBuffer));
     Graph_InitTHGA(&gfxCtx->debug, pool->debugBuffer, sizeof(pool->debugBuffer));
 
@@ -263,6 +320,10 @@ void Graph_ExecuteAndDraw(GraphicsContext* gfxCtx, GameState* gameState) {
 
     CLOSE_DISPS(gfxCtx);
 
+#if GFXPOOL_SIZING
+    Graph_MeasureGfxPool(gfxCtx);
+#endif
+
     {
         Gfx* gfx = gGfxMasterDL->taskStart;
 
@@ -357,6 +418,9 @@ void Graph_ThreadEntry(void* arg) {
 
     SysCfb_Init();
     Fault_SetFrameBuffer(gWorkBuffer, SCREEN_WIDTH, SCREEN_HEIGHT);
+#if GFXPOOL_SIZING
+    Graph_AllocGfxPools();
+#endif
     Graph_Init(&gfxCtx);
 
     while (nextOvl) {
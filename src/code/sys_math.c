@@ -67,6 +67,7 @@ f32 Math_PowF(f32 base, s32 exp) {
     return ret;
 }
 
+#if !TRIG_TABLE // inline in z64math.h
 /**
  * Takes an angle in radians and returns the sine.
  *
@@ -84,6 +85,7 @@ f32 Math_SinF(f32 rad) {
 f32 Math_CosF(f32 rad) {
     return coss(RAD_TO_BINANG(rad)) * (1.0f / SHRT_MAX);
 }
+#endif
 
 /**
  * Returns a pseudo-random floating-point number between 0.0f and scale. Originally in z_actor in OoT.
@@ -148,6 +148,7 @@ MtxF* Matrix_GetCurrent(void) {
  *
  * @remark original name: "Matrix_mult"
  */
+#if !MATRIX_FIXED // matrix_nsp.c
 void Matrix_Mult(MtxF* mf, MatrixMode mode) {
     MtxF* cmf = Matrix_GetCurrent();
 
@@ -157,6 +158,7 @@ void Matrix_Mult(MtxF* mf, MatrixMode mode) {
         Matrix_MtxFCopy(sCurrentMatrix, mf);
     }
 }
+#endif
 
 /**
  * @brief Right-multiply current by a translation matrix T.
@@ -181,6 +183,7 @@ void Matrix_Mult(MtxF* mf, MatrixMode mode) {
  *
  * @remark original name: "Matrix_translate"
  */
+#if !MATRIX_FIXED // matrix_nsp.c
 void Matrix_Translate(f32 x, f32 y, f32 z, MatrixMode mode) {
     MtxF* cmf = sCurrentMatrix;
     f32 tempX;
@@ -203,6 +206,7 @@ void Matrix_Translate(f32 x, f32 y, f32 z, MatrixMode mode) {
         SkinMatrix_SetTranslate(cmf, x, y, z);
     }
 }
+#endif
 
 /**
  * @brief Right-multiply by the diagonal scale matrix S = diag(x,y,z,1).
@@ -893,6 +897,7 @@ void Matrix_RotateZF(f32 z, MatrixMode mode) {
  *
  * @remark original name: "Matrix_RotateXYZ", changed to reflect rotation order.
  */
+#if !MATRIX_FIXED // matrix_nsp.c
 void Matrix_RotateZYX(s16 x, s16 y, s16 z, MatrixMode mode) {
     MtxF* cmf = sCurrentMatrix;
     f32 temp1;
@@ -979,6 +984,7 @@ void Matrix_RotateZYX(s16 x, s16 y, s16 z, MatrixMode mode) {
         SkinMatrix_SetRotateRPY(cmf, x, y, z);
     }
 }
+#endif
 
 /**
  * @brief Translate and rotate using ZYX Tait-Bryan angles.
@@ -992,6 +998,7 @@ void Matrix_RotateZYX(s16 x, s16 y, s16 z, MatrixMode mode) {
  *
  * @remark original name appears to be "Matrix_softcv3_mult"
  */
+#if !MATRIX_FIXED // matrix_nsp.c
 void Matrix_TranslateRotateZYX(Vec3f* translation, Vec3s* rot) {
     MtxF* cmf = sCurrentMatrix;
     f32 sin = Math_SinS(rot->z);
@@ -1074,6 +1081,7 @@ void Matrix_TranslateRotateZYX(Vec3f* translation, Vec3s* rot) {
         cmf->wz = temp2 * cos - temp1 * sin;
     }
 }
+#endif
 
 /**
  * @brief Set current to a general translation and rotation using YXZ Tait-Bryan angles: T Ry Rx Rz -> current
@@ -1156,6 +1164,7 @@ void Matrix_SetTranslateRotateYXZ(f32 x, f32 y, f32 z, Vec3s* rot) {
  *
  * @remark original name: "_MtxF_to_Mtx"
  */
+#if !MATRIX_FIXED // matrix_nsp.c
 Mtx* Matrix_MtxFToMtx(MtxF* src, Mtx* dest) {
     s32 temp;
     u16* intPart = (u16*)&dest->m[0][0];
@@ -1228,6 +1237,7 @@ Mtx* Matrix_MtxFToMtx(MtxF* src, Mtx* dest) {
 
     return dest;
 }
+#endif
 
 /**
  * @brief Converts current to a fixed-point RSP-compatible matrix.
@@ -1311,6 +1321,7 @@ Mtx* Matrix_MtxFToNewMtx(MtxF* src, GraphicsContext* gfxCtx) {
  *
  * @remark original name: "Matrix_Position"
  */
+#if !MATRIX_FIXED // matrix_nsp.c
 void Matrix_MultVec3f(Vec3f* src, Vec3f* dest) {
     MtxF* cmf = sCurrentMatrix;
 
@@ -1318,6 +1329,7 @@ void Matrix_MultVec3f(Vec3f* src, Vec3f* dest) {
     dest->y = cmf->yw + (cmf->yx * src->x + cmf->yy * src->y + cmf->yz * src->z);
     dest->z = cmf->zw + (cmf->zx * src->x + cmf->zy * src->y + cmf->zz * src->z);
 }
+#endif
 
 /**
  * @brief Multiply the vector `(0, 0, 0, 1)` by current.
@@ -1479,6 +1491,7 @@ void Matrix_MtxFCopy(MtxF* dest, MtxF* src) {
  *
  * @remark original name: "Matrix_MtxtoMtxF"
  */
+#if !MATRIX_FIXED // matrix_nsp.c
 void Matrix_MtxToMtxF(Mtx* src, MtxF* dest) {
     u16* intPart = (u16*)&src->m[0][0];
     u16* fracPart = (u16*)&src->m[2][0];
@@ -1500,6 +1513,7 @@ void Matrix_MtxToMtxF(Mtx* src, MtxF* dest) {
     dest->zw = ((intPart[14] << 0x10) | fracPart[14]) * (1 / (f32)0x10000);
     dest->ww = ((intPart[15] << 0x10) | fracPart[15]) * (1 / (f32)0x10000);
 }
+#endif
 
 // Unused
 /**
@@ -2557,7 +2557,96 @@ typedef struct {
     /* 0x10 */ Actor* talkActor;
     /* 0x14 */ Player* player;
     /* 0x18 */ u32 updateActorFlagsMask; // Actor will update only if at least 1 actor flag is set in this bitmask
-} UpdateActor_Params;                    // size = 0x1C
+#if ACTOR_UPDATE_LOD
+    /* 0x1C */ f32 lodDist;              // `Actor_GetUpdateLodDist`
+    /* 0x20 */ u32 lodIndex;             // Spreads the actors updating every few frames over the frames
+#endif
+} UpdateActor_Params;                    // size = 0x1C, 0x24 with ACTOR_UPDATE_LOD
+
+#if ACTOR_UPDATE_LOD
+/**
+ * How many frames apart the actor updates: every frame, or every 2nd or 4th one for NPCs and props that are far away
+ * or off-screen and for enemies that are off-screen. Off-screen, actors only update with
+ * `ACTOR_FLAG_UPDATE_CULLING_DISABLED`, like the scheduled NPCs of Clock Town. Actors the player deals with, actors
+ * in cutscenes and those that set `updateLodExact` always update every frame.
+ */
+s32 Actor_GetUpdateLodPeriod(UpdateActor_Params* params, Actor* actor) {
+    Player* player = params->player;
+    s32 onScreen = actor->flags & ACTOR_FLAG_INSIDE_CULLING_VOLUME;
+    s32 isFar;
+
+    if ((params->lodDist <= 0.0f) || actor->updateLodExact || (params->play->csCtx.state != CS_STATE_IDLE) ||
+        (actor == params->talkActor) || (actor == player->focusActor) || (actor == player->heldActor) ||
+        (actor->parent == &player->actor)) {
+        return 1;
+    }
+
+    switch (actor->category) {
+        case ACTORCAT_NPC:
+        case ACTORCAT_PROP:
+            break;
+
+        case ACTORCAT_ENEMY:
+            // On screen, the player may be fighting it from any distance
+            if (onScreen) {
+                return 1;
+            }
+            break;
+
+        default:
+            return 1;
+    }
+
+    isFar = actor->xyzDistToPlayerSq > SQ(params->lodDist);
+    if ((actor->xyzDistToPlayerSq > SQ(2.0f * params->lodDist)) || (isFar && !onScreen)) {
+        return 4;
+    }
+    return (isFar || !onScreen) ? 2 : 1;
+}
+
+/**
+ * Whether the actor updates this frame. The actors updating every few frames take turns, and none goes longer than its
+ * period without updating when it changes tiers. A frame left out still counts down its color filter.
+ */
+s32 Actor_IsUpdateLodDue(UpdateActor_Params* params, Actor* actor) {
+    s32 period = Actor_GetUpdateLodPeriod(params, actor);
+
+    if ((period == 1) || (actor->updateLodSkipped + 1 >= period) ||
+        (((params->play->gameplayFrames + params->lodIndex++) & (period - 1)) == 0)) {
+        return true;
+    }
+
+    actor->updateLodSkipped++;
+    if (actor->colorFilterTimer != 0) {
+        actor->colorFilterTimer--;
+    }
+    return false;
+}
+
+/**
+ * Updates the actor for the frames since its last update. The framerate divisor is scaled by as many frames while it
+ * runs, which the actor movement, skeleton animations and the `Math_` steps already follow. Counters an actor keeps
+ * itself still count one per update.
+ */
+void Actor_UpdateLod(PlayState* play, Actor* actor) {
+    s32 frames = actor->updateLodSkipped + 1;
+    s32 divisor = play->state.framerateDivisor;
+    s32 updateRate = R_UPDATE_RATE;
+
+    if (frames == 1) {
+        actor->update(actor, play);
+        return;
+    }
+
+    actor->updateLodSkipped = 0;
+    GameState_SetFramerateDivisor(&play->state, divisor * frames);
+    Actor_SetMovementScale(divisor * frames);
+    actor->update(actor, play);
+    GameState_SetFramerateDivisor(&play->state, divisor);
+    Actor_SetMovementScale(divisor);
+    R_UPDATE_RATE = updateRate;
+}
+#endif
 
 Actor* Actor_UpdateActor(UpdateActor_Params* params) {
     PlayState* play = params->play;
@@ -2604,7 +2693,12 @@ Actor* Actor_UpdateActor(UpdateActor_Params* params) {
             actor->yawTowardsPlayer = Actor_WorldYawTowardActor(actor, &params->player->actor);
             actor->flags &= ~ACTOR_FLAG_SFX_FOR_PLAYER_BODY_HIT;
 
+#if ACTOR_UPDATE_LOD
+            if ((DECR(actor->freezeTimer) == 0) && (actor->flags & params->updateActorFlagsMask) &&
+                Actor_IsUpdateLodDue(params, actor)) {
+#else
             if ((DECR(actor->freezeTimer) == 0) && (actor->flags & params->updateActorFlagsMask)) {
+#endif
                 if (actor == params->player->focusActor) {
                     actor->isLockedOn = true;
                 } else {
@@ -2621,7 +2715,11 @@ Actor* Actor_UpdateActor(UpdateActor_Params* params) {
                     actor->colorFilterTimer--;
                 }
 
+#if ACTOR_UPDATE_LOD
+                Actor_UpdateLod(play, actor);
+#else
                 actor->update(actor, play);
+#endif
                 DynaPoly_UnsetAllInteractFlags(play, &play->colCtx.dyna, actor);
             }
 
@@ -2675,6 +2773,10 @@ void Actor_UpdateAll(PlayState* play, ActorContext* actorCtx) {
 
     params.player = player;
     params.play = play;
+#if ACTOR_UPDATE_LOD
+    params.lodDist = Actor_GetUpdateLodDist();
+    params.lodIndex = 0;
+#endif
 
     if (play->soaringCsOrSoTCsPlaying) {
         params.updateActorFlagsMask = ACTOR_FLAG_UPDATE_DURING_SOARING_AND_SOT_CS;
@@ -2775,11 +2877,19 @@ void Actor_Draw(PlayState* play, Actor* actor) {
         light->enablePosLights = true;
     }
 
+#if LIGHTS_BIND_CACHE
+    Lights_BindAllCached(light, play->lightCtx.listHead,
+                         (actor->flags & (ACTOR_FLAG_UCODE_POINT_LIGHT_ENABLED | ACTOR_FLAG_IGNORE_LEGACY_POINT_LIGHTS))
+                             ? NULL
+                             : &actor->world.pos,
+                         play, &actor->lightsCache);
+#else
     Lights_BindAll(light, play->lightCtx.listHead,
                    (actor->flags & (ACTOR_FLAG_UCODE_POINT_LIGHT_ENABLED | ACTOR_FLAG_IGNORE_LEGACY_POINT_LIGHTS))
                        ? NULL
                        : &actor->world.pos,
                    play);
+#endif
     Lights_Draw(light, play->state.gfxCtx);
 
     if (actor->flags & ACTOR_FLAG_IGNORE_QUAKE) {
@@ -3089,8 +3199,16 @@ s32 Actor_CullingCheck(PlayState* play, Actor* actor) {
  * above: https://www.desmos.com/3d/4ztkxqky2a.
  */
 s32 Actor_CullingVolumeTest(PlayState* play, Actor* actor, Vec3f* projPos, f32 projW) {
+#if DRAW_DISTANCE
+    // Actors are cut with the scene's draw distance, see z_kankyo.c
+    f32 cullingVolumeDistance = actor->cullingVolumeDistance * (Environment_GetDrawDistance() * (1.0f / 0x100));
+
+    if ((projPos->z > -actor->cullingVolumeScale) &&
+        (projPos->z < (cullingVolumeDistance + actor->cullingVolumeScale))) {
+#else
     if ((projPos->z > -actor->cullingVolumeScale) &&
         (projPos->z < (actor->cullingVolumeDistance + actor->cullingVolumeScale))) {
+#endif
         f32 invW;
         f32 cullingVolumeScaleX;
         f32 cullingVolumeScaleY;
@@ -3128,6 +3246,107 @@ s32 Actor_CullingVolumeTest(PlayState* play, Actor* actor, Vec3f* projPos, f32 p
     return false;
 }
 
+#if ACTOR_CULL_BATCH
+#define ACTOR_CULL_BATCH_MAX 256 // more than `totalLoadedActors` can count
+
+/**
+ * Positions and culling volumes of the loaded actors, in the order `Actor_DrawAll` walks them, and the projection and
+ * culling test results for them
+ */
+typedef struct ActorCullBatch {
+    /* 0x0000 */ s32 count;
+    /* 0x0004 */ Actor* actors[ACTOR_CULL_BATCH_MAX];
+    /* 0x0404 */ Vec3f worldPos[ACTOR_CULL_BATCH_MAX];
+    /* 0x1004 */ f32 cullingVolumeDistance[ACTOR_CULL_BATCH_MAX];
+    /* 0x1404 */ f32 cullingVolumeScale[ACTOR_CULL_BATCH_MAX];
+    /* 0x1804 */ f32 cullingVolumeDownward[ACTOR_CULL_BATCH_MAX];
+    /* 0x1C04 */ Vec3f projectedPos[ACTOR_CULL_BATCH_MAX];
+    /* 0x2804 */ f32 projectedW[ACTOR_CULL_BATCH_MAX];
+    /* 0x2C04 */ u8 inCullingVolume[ACTOR_CULL_BATCH_MAX];
+} ActorCullBatch; // size = 0x2D04
+
+ActorCullBatch sActorCullBatch;
+
+/**
+ * Runs the projection and culling volume test of `Actor_DrawAll` for every loaded actor up front: gathers their
+ * positions and culling volumes, projects them all with one `SkinMatrix_Vec3fMtxFMultXYZWBatch`, then tests them
+ * in one loop, the same way `Actor_CullingVolumeTest` does.
+ */
+void Actor_CullBatch(PlayState* play, ActorContext* actorCtx) {
+    ActorCullBatch* batch = &sActorCullBatch;
+    Actor* actor;
+    s32 category;
+    s32 count = 0;
+    s32 i;
+    f32 fovScaleX;
+    f32 fovScaleY;
+#if DRAW_DISTANCE
+    f32 drawDistance = Environment_GetDrawDistance() * (1.0f / 0x100);
+#endif
+
+    for (category = 0; category < ACTORCAT_MAX; category++) {
+        for (actor = actorCtx->actorLists[category].first; (actor != NULL) && (count < ACTOR_CULL_BATCH_MAX);
+             actor = actor->next) {
+            batch->actors[count] = actor;
+            batch->worldPos[count] = actor->world.pos;
+#if DRAW_DISTANCE
+            batch->cullingVolumeDistance[count] = actor->cullingVolumeDistance * drawDistance;
+#else
+            batch->cullingVolumeDistance[count] = actor->cullingVolumeDistance;
+#endif
+            batch->cullingVolumeScale[count] = actor->cullingVolumeScale;
+            batch->cullingVolumeDownward[count] = actor->cullingVolumeDownward;
+            count++;
+        }
+    }
+    batch->count = count;
+
+    SkinMatrix_Vec3fMtxFMultXYZWBatch(&play->viewProjectionMtxF, batch->worldPos, batch->projectedPos,
+                                      batch->projectedW, count);
+
+    // See `Actor_CullingVolumeTest` for the fov ratios
+    if (play->view.fovy != 60.0f) {
+        fovScaleX = play->projectionMtxFDiagonal.x * 0.76980036f;
+        fovScaleY = play->projectionMtxFDiagonal.y * 0.57735026f;
+    } else {
+        fovScaleX = fovScaleY = 1.0f;
+    }
+
+    for (i = 0; i < count; i++) {
+        Vec3f* projPos = &batch->projectedPos[i];
+        f32 invW = CLAMP_MIN(batch->projectedW[i], 1.0f);
+        f32 cullingVolumeScale = batch->cullingVolumeScale[i];
+
+        batch->inCullingVolume[i] =
+            (projPos->z > -cullingVolumeScale) &&
+            (projPos->z < (batch->cullingVolumeDistance[i] + cullingVolumeScale)) &&
+            ((fabsf(projPos->x) - (cullingVolumeScale * fovScaleX)) < invW) &&
+            (-invW < (projPos->y + (fovScaleY * batch->cullingVolumeDownward[i]))) &&
+            ((projPos->y - (cullingVolumeScale * fovScaleY)) < invW);
+    }
+}
+
+/**
+ * Sets the projected position of an actor from the batch entry at index and returns whether it is inside its culling
+ * volume. The draws of the actors before it can still move it, then it is projected and tested on its own.
+ */
+s32 Actor_CullBatchApply(PlayState* play, Actor* actor, s32 index) {
+    ActorCullBatch* batch = &sActorCullBatch;
+
+    if ((index < batch->count) && (batch->actors[index] == actor) &&
+        (batch->worldPos[index].x == actor->world.pos.x) && (batch->worldPos[index].y == actor->world.pos.y) &&
+        (batch->worldPos[index].z == actor->world.pos.z)) {
+        actor->projectedPos = batch->projectedPos[index];
+        actor->projectedW = batch->projectedW[index];
+        return batch->inCullingVolume[index];
+    }
+
+    SkinMatrix_Vec3fMtxFMultXYZW(&play->viewProjectionMtxF, &actor->world.pos, &actor->projectedPos,
+                                 &actor->projectedW);
+    return Actor_CullingCheck(play, actor);
+}
+#endif
+
 void Actor_DrawAll(PlayState* play, ActorContext* actorCtx) {
     s32 pad[2];
     Gfx* ref2;
@@ -3138,6 +3357,10 @@ void Actor_DrawAll(PlayState* play, ActorContext* actorCtx) {
     Actor* actor;
     s32 drawActorFlagsMask;
     s32 category;
+#if ACTOR_CULL_BATCH
+    s32 batchIndex = 0;
+    s32 inCullingVolume;
+#endif
 
     if (play->soaringCsOrSoTCsPlaying) {
         drawActorFlagsMask = ACTOR_FLAG_UPDATE_DURING_SOARING_AND_SOT_CS;
@@ -3153,18 +3376,30 @@ void Actor_DrawAll(PlayState* play, ActorContext* actorCtx) {
     sp58 = POLY_XLU_DISP;
     POLY_XLU_DISP = &sp58[1];
 
+#if ACTOR_CULL_BATCH
+    Actor_CullBatch(play, actorCtx);
+#endif
+
     for (category = 0, actorEntry = actorCtx->actorLists; category < ACTORCAT_MAX; category++, actorEntry++) {
         actor = actorEntry->first;
 
         while (actor != NULL) {
+#if ACTOR_CULL_BATCH
+            inCullingVolume = Actor_CullBatchApply(play, actor, batchIndex++);
+#else
             SkinMatrix_Vec3fMtxFMultXYZW(&play->viewProjectionMtxF, &actor->world.pos, &actor->projectedPos,
                                          &actor->projectedW);
+#endif
 
             if (actor->audioFlags & ACTOR_AUDIO_FLAG_ALL) {
                 Actor_UpdateFlaggedAudio(actor);
             }
 
+#if ACTOR_CULL_BATCH
+            if (inCullingVolume) {
+#else
             if (Actor_CullingCheck(play, actor)) {
+#endif
                 actor->flags |= ACTOR_FLAG_INSIDE_CULLING_VOLUME;
             } else {
                 actor->flags &= ~ACTOR_FLAG_INSIDE_CULLING_VOLUME;
@@ -3334,6 +3569,52 @@ void Actor_CleanupContext(ActorContext* actorCtx, PlayState* play) {
     ActorOverlayTable_Cleanup();
 }
 
+#if ACTOR_ID_INDEX
+/**
+ * Appends an actor to the list of its id in `actorCtx->actorIdLists`, see `Actor_FindFirstById`.
+ */
+void Actor_AddToIdList(ActorContext* actorCtx, Actor* actor) {
+    ActorIdListEntry* entry;
+
+    if ((actor->id < 0) || (actor->id >= ACTOR_ID_MAX)) {
+        return;
+    }
+
+    entry = &actorCtx->actorIdLists[actor->id];
+    actor->listCategory = actor->category;
+    actor->idPrev = entry->last;
+    actor->idNext = NULL;
+    if (entry->last != NULL) {
+        entry->last->idNext = actor;
+    } else {
+        entry->first = actor;
+    }
+    entry->last = actor;
+}
+
+void Actor_RemoveFromIdList(ActorContext* actorCtx, Actor* actor) {
+    ActorIdListEntry* entry;
+
+    if ((actor->id < 0) || (actor->id >= ACTOR_ID_MAX)) {
+        return;
+    }
+
+    entry = &actorCtx->actorIdLists[actor->id];
+    if (actor->idPrev != NULL) {
+        actor->idPrev->idNext = actor->idNext;
+    } else {
+        entry->first = actor->idNext;
+    }
+    if (actor->idNext != NULL) {
+        actor->idNext->idPrev = actor->idPrev;
+    } else {
+        entry->last = actor->idPrev;
+    }
+    actor->idPrev = NULL;
+    actor->idNext = NULL;
+}
+#endif
+
 /**
  * Adds a given actor instance at the front of the actor list of the specified category.
  * Also sets the actor instance as being of that category.
@@ -3344,6 +3625,10 @@ void Actor_AddToCategory(ActorContext* actorCtx, Actor* actor, u8 actorCategory)
 
     actor->category = actorCategory;
 
+#if ACTOR_ID_INDEX
+    Actor_AddToIdList(actorCtx, actor);
+#endif
+
     actorCtx->totalLoadedActors++;
     actorCtx->actorLists[actorCategory].length++;
     lastActor = actorCtx->actorLists[actorCategory].first;
@@ -3388,6 +3673,10 @@ Actor* Actor_RemoveFromCategory(PlayState* play, ActorContext* actorCtx, Actor*
     actorToRemove->next = NULL;
     actorToRemove->prev = NULL;
 
+#if ACTOR_ID_INDEX
+    Actor_RemoveFromIdList(actorCtx, actorToRemove);
+#endif
+
     if ((actorToRemove->room == play->roomCtx.curRoom.num) && (actorToRemove->category == ACTORCAT_ENEMY) &&
         (actorCtx->actorLists[ACTORCAT_ENEMY].length == 0)) {
         Flags_SetClearTemp(play, play->roomCtx.curRoom.num);
@@ -4853,6 +5142,19 @@ void Actor_Noop(Actor* actor, PlayState* play) {
  */
 Actor* Actor_FindNearby(PlayState* play, Actor* inActor, s16 actorId, u8 actorCategory, f32 distance) {
     Actor* actor = play->actorCtx.actorLists[actorCategory].first;
+#if ACTOR_ID_INDEX
+    Actor* idActor;
+
+    if (actorId != -1) {
+        for (idActor = Actor_FindFirstById(&play->actorCtx, actorId, actorCategory); idActor != NULL;
+             idActor = Actor_FindNextById(idActor, actorCategory)) {
+            if ((idActor != inActor) && (Actor_WorldDistXYZToActor(inActor, idActor) <= distance)) {
+                return idActor;
+            }
+        }
+        return NULL;
+    }
+#endif
 
     while (actor != NULL) {
         if ((actor == inActor) || ((actorId != -1) && (actorId != actor->id))) {
@@ -4870,6 +5172,37 @@ Actor* Actor_FindNearby(PlayState* play, Actor* inActor, s16 actorId, u8 actorCa
     return NULL;
 }
 
+#if ACTOR_ID_INDEX
+/**
+ * Finds the first actor instance of a specified Id and category, the same one a walk of the category's actor list
+ * would find, without visiting the actors of other Ids. Returns NULL if there is none.
+ */
+Actor* Actor_FindFirstById(ActorContext* actorCtx, s16 actorId, u8 actorCategory) {
+    Actor* actor;
+
+    if ((actorId < 0) || (actorId >= ACTOR_ID_MAX)) {
+        return NULL;
+    }
+
+    actor = actorCtx->actorIdLists[actorId].first;
+    while ((actor != NULL) && (actor->listCategory != actorCategory)) {
+        actor = actor->idNext;
+    }
+    return actor;
+}
+
+/**
+ * Finds the actor instance after `actor` with the same Id in the specified category, in actor list order.
+ */
+Actor* Actor_FindNextById(Actor* actor, u8 actorCategory) {
+    actor = actor->idNext;
+    while ((actor != NULL) && (actor->listCategory != actorCategory)) {
+        actor = actor->idNext;
+    }
+    return actor;
+}
+#endif
+
 s32 func_800BE184(PlayState* play, Actor* actor, f32 xzDist, s16 arg3, s16 arg4, s16 arg5) {
     Player* player = GET_PLAYER(play);
     s16 phi_v0 = BINANG_SUB(BINANG_ROT180(actor->yawTowardsPlayer), player->actor.shape.rot.y);
@@ -3,9 +3,18 @@
 #include "fault.h"
 
 // Segment and Profile declarations (also used in the table below)
+#if OVERLAY_PAGING
+// The Nspire port's paged overlays aren't linked in, their profiles come from its asset pack
+#define OVERLAY_PROFILE __attribute__((weak))
+
+#define DEFINE_ACTOR(name, _enumValue, _allocType, _debugName) \
+    extern struct ActorProfile name##_Profile OVERLAY_PROFILE; \
+    DECLARE_OVERLAY_SEGMENT(name)
+#else
 #define DEFINE_ACTOR(name, _enumValue, _allocType, _debugName) \
     extern struct ActorProfile name##_Profile;                 \
     DECLARE_OVERLAY_SEGMENT(name)
+#endif
 #define DEFINE_ACTOR_INTERNAL(name, _enumValue, _allocType, _debugName) extern struct ActorProfile name##_Profile;
 #define DEFINE_ACTOR_UNSET(_enumValue)
 
@@ -98,6 +98,52 @@ char D_801EDAA8[80];
 char D_801EDAF8[80];
 Vec3f D_801EDB48[3]; // polyVerts
 
+#if BGCHECK_FLOOR_CACHE
+#define BGCHECK_FLOOR_CACHE_SIZE 128 // power of 2
+
+/**
+ * The static half of a `BgCheck_RaycastFloorImpl` query: the inputs it depends on and what it found. The scene's
+ * static collision doesn't change until the next `BgCheck_Allocate`, so an entry stays valid until then.
+ */
+typedef struct BgFloorCacheEntry {
+    /* 0x00 */ Vec3f pos;
+    /* 0x0C */ f32 checkDist;
+    /* 0x10 */ u32 arg7;
+    /* 0x14 */ u16 xpFlags;
+    /* 0x16 */ u8 actorType; // BG_FLOOR_CACHE_ACTOR_*, all that `BgCheck_RaycastFloorStaticList` reads of the actor
+    /* 0x17 */ u8 arg9;      // only its 0x20 bit, likewise
+    /* 0x18 */ CollisionPoly* poly;
+    /* 0x1C */ f32 yIntersect;
+    /* 0x20 */ u32 polyTests; // `CollisionPoly_CheckYIntersect` calls it took
+} BgFloorCacheEntry; // size = 0x24
+
+typedef enum BgFloorCacheActor {
+    /* 0 */ BG_FLOOR_CACHE_EMPTY,
+    /* 1 */ BG_FLOOR_CACHE_ACTOR_NONE,
+    /* 2 */ BG_FLOOR_CACHE_ACTOR_PLAYER,
+    /* 3 */ BG_FLOOR_CACHE_ACTOR_OTHER
+} BgFloorCacheActor;
+
+BgFloorCacheEntry sBgFloorCache[BGCHECK_FLOOR_CACHE_SIZE];
+u32 sBgFloorPolyTests;
+
+// Read and reset by the port's frame profiling
+u32 gBgFloorCacheHits;
+u32 gBgFloorCacheSavedTests;
+#endif
+
+#if DYNAPOLY_BVH
+#define DYNA_BVH_LEAF_POLYS 4
+#define DYNA_BVH_STACK_MAX 64
+#define DYNA_BVH_CANDIDATES_MAX 64
+#define DYNA_BVH_MARGIN 2.0f // the world vertices are truncated to s16 after the transform
+
+// dyna.polyList indices of the current BgActor's polys near the floor raycast, in descending order like its lists
+s16 sDynaBvhCandidates[DYNA_BVH_CANDIDATES_MAX];
+// -1 when `BgCheck_RaycastFloorDynaList` has to walk the whole list
+s32 sDynaBvhNumCandidates = -1;
+#endif
+
 void BgCheck_GetStaticLookupIndicesFromPos(CollisionContext* colCtx, Vec3f* pos, Vec3i* sector);
 f32 BgCheck_RaycastFloorDyna(DynaRaycast* dynaRaycast);
 s32 BgCheck_SphVsDynaWall(CollisionContext* colCtx, u16 xpFlags, f32* outX, f32* outZ, Vec3f* pos, f32 radius,
@@ -578,6 +624,9 @@ f32 BgCheck_RaycastFloorStaticList(CollisionContext* colCtx, u16 xpFlags, SSList
             break;
         }
 
+#if BGCHECK_FLOOR_CACHE
+        sBgFloorPolyTests++;
+#endif
         if (CollisionPoly_CheckYIntersect(colPoly, colCtx->colHeader->vtxList, pos->x, pos->z, &yIntersect,
                                           checkDist)) {
             // if poly is closer to pos without going over
@@ -1545,6 +1594,10 @@ void BgCheck_Allocate(CollisionContext* colCtx, PlayState* play, CollisionHeader
     colCtx->colHeader = colHeader;
     colCtx->flags = 0;
 
+#if BGCHECK_FLOOR_CACHE
+    bzero(sBgFloorCache, sizeof(sBgFloorCache));
+#endif
+
     if (BgCheck_IsSmallMemScene(play)) {
         colCtx->memSize = 0xF000;
         colCtx->dyna.polyNodesMax = 1000;
@@ -1674,6 +1727,64 @@ s32 BgCheck_PosInStaticBoundingBox(CollisionContext* colCtx, Vec3f* pos) {
     return true;
 }
 
+#if BGCHECK_FLOOR_CACHE
+/**
+ * Finds the entry for a static floor query in `sBgFloorCache`. Returns true with its result in `outYIntersect` and
+ * `outPoly` if it is there, or false with `*outEntry` set up for `BgCheck_FloorCacheStore`.
+ */
+s32 BgCheck_FloorCacheFind(u16 xpFlags, Vec3f* pos, Actor* actor, u32 arg7, f32 checkDist, s32 arg9,
+                           BgFloorCacheEntry** outEntry, f32* outYIntersect, CollisionPoly** outPoly) {
+    union {
+        f32 f;
+        u32 u;
+    } bits[3];
+    BgFloorCacheEntry* entry;
+    u32 hash;
+    u8 actorType;
+
+    if (actor == NULL) {
+        actorType = BG_FLOOR_CACHE_ACTOR_NONE;
+    } else if (actor->category == ACTORCAT_PLAYER) {
+        actorType = BG_FLOOR_CACHE_ACTOR_PLAYER;
+    } else {
+        actorType = BG_FLOOR_CACHE_ACTOR_OTHER;
+    }
+    arg9 &= 0x20;
+
+    bits[0].f = pos->x;
+    bits[1].f = pos->y;
+    bits[2].f = pos->z;
+    hash = (bits[0].u * 0x9E3779B1) ^ (bits[1].u * 0x85EBCA77) ^ (bits[2].u * 0xC2B2AE3D) ^ xpFlags ^ actorType;
+    entry = &sBgFloorCache[(hash >> 16) & (BGCHECK_FLOOR_CACHE_SIZE - 1)];
+    *outEntry = entry;
+
+    if ((entry->actorType == actorType) && (entry->pos.x == pos->x) && (entry->pos.y == pos->y) &&
+        (entry->pos.z == pos->z) && (entry->xpFlags == xpFlags) && (entry->arg7 == arg7) &&
+        (entry->checkDist == checkDist) && (entry->arg9 == arg9)) {
+        gBgFloorCacheHits++;
+        gBgFloorCacheSavedTests += entry->polyTests;
+        *outYIntersect = entry->yIntersect;
+        *outPoly = entry->poly;
+        return true;
+    }
+
+    entry->actorType = actorType;
+    entry->pos = *pos;
+    entry->xpFlags = xpFlags;
+    entry->arg7 = arg7;
+    entry->checkDist = checkDist;
+    entry->arg9 = arg9;
+    sBgFloorPolyTests = 0;
+    return false;
+}
+
+void BgCheck_FloorCacheStore(BgFloorCacheEntry* entry, f32 yIntersect, CollisionPoly* poly) {
+    entry->yIntersect = yIntersect;
+    entry->poly = poly;
+    entry->polyTests = sBgFloorPolyTests;
+}
+#endif
+
 /**
  * Raycast Toward Floor
  * returns the yIntersect of the nearest poly found directly below `pos`, or BGCHECK_Y_MIN if no floor detected
@@ -1687,6 +1798,9 @@ f32 BgCheck_RaycastFloorImpl(PlayState* play, CollisionContext* colCtx, u16 xpFl
     Vec3f checkPos;
     StaticLookup* lookup;
     DynaRaycast dynaRaycast;
+#if BGCHECK_FLOOR_CACHE
+    BgFloorCacheEntry* cacheEntry;
+#endif
 
     *outBgId = BGCHECK_SCENE;
     *outPoly = NULL;
@@ -1694,6 +1808,27 @@ f32 BgCheck_RaycastFloorImpl(PlayState* play, CollisionContext* colCtx, u16 xpFl
     yIntersect = BGCHECK_Y_MIN;
     checkPos = *pos;
 
+#if BGCHECK_FLOOR_CACHE
+    if (!BgCheck_FloorCacheFind(xpFlags, pos, actor, arg7, checkDist, arg9, &cacheEntry, &yIntersect, outPoly)) {
+        while (true) {
+            if (checkPos.y < colCtx->minBounds.y) {
+                break;
+            }
+            lookup = BgCheck_GetStaticLookup(colCtx, lookupTbl, &checkPos);
+            if (lookup == NULL) {
+                checkPos.y -= colCtx->subdivLength.y;
+                continue;
+            }
+            yIntersect = BgCheck_RaycastFloorStatic(lookup, colCtx, xpFlags, outPoly, pos, arg7, checkDist,
+                                                    BGCHECK_Y_MIN, actor);
+            if (yIntersect > BGCHECK_Y_MIN) {
+                break;
+            }
+            checkPos.y -= colCtx->subdivLength.y;
+        }
+        BgCheck_FloorCacheStore(cacheEntry, yIntersect, *outPoly);
+    }
+#else
     while (true) {
         if (checkPos.y < colCtx->minBounds.y) {
             break;
@@ -1710,6 +1845,7 @@ f32 BgCheck_RaycastFloorImpl(PlayState* play, CollisionContext* colCtx, u16 xpFl
         }
         checkPos.y -= colCtx->subdivLength.y;
     }
+#endif
     if (!(arg9 & 1)) {
         dynaRaycast.play = play;
         dynaRaycast.colCtx = colCtx;
@@ -2557,6 +2693,153 @@ void DynaLookup_ResetWaterBoxStartIndex(u16* waterBoxStartIndex) {
     *waterBoxStartIndex = 0;
 }
 
+#if DYNAPOLY_BVH
+/**
+ * Sum of the three vertices of a poly along `axis`, three times its centroid
+ */
+s32 DynaBvh_PolyCentroid3(CollisionHeader* colHeader, u16 polyId, s32 axis) {
+    CollisionPoly* poly = &colHeader->polyList[polyId];
+    s16* vA = &colHeader->vtxList[COLPOLY_VTX_INDEX(poly->flags_vIA)].x;
+    s16* vB = &colHeader->vtxList[COLPOLY_VTX_INDEX(poly->flags_vIB)].x;
+    s16* vC = &colHeader->vtxList[poly->vIC].x;
+
+    return vA[axis] + vB[axis] + vC[axis];
+}
+
+/**
+ * Reorders `polyIds[0..count)` so that the first `k` have the smallest centroids along `axis`
+ */
+void DynaBvh_SelectPolys(CollisionHeader* colHeader, u16* polyIds, s32 count, s32 k, s32 axis) {
+    s32 lo = 0;
+    s32 hi = count - 1;
+
+    while (lo < hi) {
+        s32 pivot = DynaBvh_PolyCentroid3(colHeader, polyIds[(lo + hi) / 2], axis);
+        s32 i = lo;
+        s32 j = hi;
+
+        while (i <= j) {
+            while (DynaBvh_PolyCentroid3(colHeader, polyIds[i], axis) < pivot) {
+                i++;
+            }
+            while (DynaBvh_PolyCentroid3(colHeader, polyIds[j], axis) > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                u16 temp = polyIds[i];
+
+                polyIds[i] = polyIds[j];
+                polyIds[j] = temp;
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) {
+            hi = j;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+}
+
+/**
+ * Builds the subtree of `nodeIndex` over `polyIds[start..start+count)`, splitting at the median centroid of the
+ * longest axis. The median split keeps the depth at log2 of the number of polys.
+ */
+void DynaBvh_BuildNode(DynaBvh* bvh, CollisionHeader* colHeader, u16 nodeIndex, s32 start, s32 count) {
+    DynaBvhNode* node = &bvh->nodes[nodeIndex];
+    s32 centroidMin[3];
+    s32 centroidMax[3];
+    s32 axis;
+    s32 i;
+    s32 j;
+    s32 k;
+
+    node->min.x = node->min.y = node->min.z = 0x7FFF;
+    node->max.x = node->max.y = node->max.z = -0x8000;
+    for (j = 0; j < 3; j++) {
+        centroidMin[j] = 0x7FFFFFFF;
+        centroidMax[j] = -0x7FFFFFFF;
+    }
+
+    for (i = start; i < start + count; i++) {
+        CollisionPoly* poly = &colHeader->polyList[bvh->polyIds[i]];
+        s16* vtx[3];
+
+        vtx[0] = &colHeader->vtxList[COLPOLY_VTX_INDEX(poly->flags_vIA)].x;
+        vtx[1] = &colHeader->vtxList[COLPOLY_VTX_INDEX(poly->flags_vIB)].x;
+        vtx[2] = &colHeader->vtxList[poly->vIC].x;
+        for (j = 0; j < 3; j++) {
+            s32 centroid = vtx[0][j] + vtx[1][j] + vtx[2][j];
+
+            for (k = 0; k < 3; k++) {
+                (&node->min.x)[j] = MIN((&node->min.x)[j], vtx[k][j]);
+                (&node->max.x)[j] = MAX((&node->max.x)[j], vtx[k][j]);
+            }
+            centroidMin[j] = MIN(centroidMin[j], centroid);
+            centroidMax[j] = MAX(centroidMax[j], centroid);
+        }
+    }
+
+    if (count <= DYNA_BVH_LEAF_POLYS) {
+        node->start = start;
+        node->count = count;
+        return;
+    }
+
+    axis = 0;
+    for (j = 1; j < 3; j++) {
+        if ((centroidMax[j] - centroidMin[j]) > (centroidMax[axis] - centroidMin[axis])) {
+            axis = j;
+        }
+    }
+    DynaBvh_SelectPolys(colHeader, &bvh->polyIds[start], count, count / 2, axis);
+
+    node->start = bvh->numNodes;
+    node->count = 0;
+    bvh->numNodes += 2;
+    DynaBvh_BuildNode(bvh, colHeader, node->start, start, count / 2);
+    DynaBvh_BuildNode(bvh, colHeader, node->start + 1, start + count / 2, count - count / 2);
+}
+
+/**
+ * Builds the BVH of a CollisionHeader in one ZeldaArena block, NULL if it has no polys or there is no room
+ */
+DynaBvh* DynaBvh_Create(CollisionHeader* colHeader) {
+    s32 numPolys = colHeader->numPolygons;
+    DynaBvh* bvh;
+    s32 i;
+
+    if (numPolys == 0) {
+        return NULL;
+    }
+
+    // A tree with leaves of at least one poly has fewer than 2 * numPolys nodes
+    bvh = ZeldaArena_Malloc(sizeof(DynaBvh) + (2 * numPolys * sizeof(DynaBvhNode)) + (numPolys * sizeof(u16)));
+    if (bvh == NULL) {
+        return NULL;
+    }
+    bvh->nodes = (DynaBvhNode*)(bvh + 1);
+    bvh->polyIds = (u16*)&bvh->nodes[2 * numPolys];
+    for (i = 0; i < numPolys; i++) {
+        bvh->polyIds[i] = i;
+    }
+
+    bvh->numNodes = 1;
+    DynaBvh_BuildNode(bvh, colHeader, 0, 0, numPolys);
+    return bvh;
+}
+
+void DynaBvh_Destroy(BgActor* bgActor) {
+    if (bgActor->bvh != NULL) {
+        ZeldaArena_Free(bgActor->bvh);
+        bgActor->bvh = NULL;
+    }
+}
+#endif
+
 /**
  * Initialize BgActor
  */
@@ -2570,6 +2853,9 @@ void BgActor_Init(PlayState* play, BgActor* bgActor) {
     DynaLookup_ResetWaterBoxStartIndex(&bgActor->waterboxesStartIndex);
     bgActor->boundingSphere.center.x = bgActor->boundingSphere.center.y = bgActor->boundingSphere.center.z = 0;
     bgActor->boundingSphere.radius = 0;
+#if DYNAPOLY_BVH
+    DynaBvh_Destroy(bgActor);
+#endif
 }
 
 /**
@@ -2672,11 +2958,18 @@ void DynaPoly_Alloc(PlayState* play, DynaCollisionContext* dyna) {
     s32 i;
 
     for (i = 0; i < BG_ACTOR_MAX; i++) {
+#if DYNAPOLY_BVH
+        // Whatever is left over is from the previous scene's ZeldaArena
+        dyna->bgActors[i].bvh = NULL;
+#endif
         BgActor_Init(play, &dyna->bgActors[i]);
         dyna->bgActorFlags[i] = 0;
     }
     DynaPoly_NullPolyList(&dyna->polyList);
     DynaPoly_AllocPolyList(play, &dyna->polyList, dyna->polyListMax);
+#if DYNAPOLY_BVH
+    dyna->polyLookupType = THA_AllocTailAlign(&play->state.tha, dyna->polyListMax, -2);
+#endif
 
     DynaPoly_NullVtxList(&dyna->vtxList);
     DynaPoly_AllocVtxList(play, &dyna->vtxList, dyna->vtxListMax);
@@ -2709,6 +3002,10 @@ s32 DynaPoly_SetBgActor(PlayState* play, DynaCollisionContext* dyna, Actor* acto
     }
 
     BgActor_SetActor(&dyna->bgActors[bgId], actor, colHeader);
+#if DYNAPOLY_BVH
+    DynaBvh_Destroy(&dyna->bgActors[bgId]);
+    dyna->bgActors[bgId].bvh = DynaBvh_Create(colHeader);
+#endif
     dyna->bitFlag |= DYNAPOLY_INVALIDATE_LOOKUP;
 
     dyna->bgActorFlags[bgId] &= ~BGACTOR_1;
@@ -2841,6 +3138,29 @@ void BgCheck_CalcWaterboxDimensions(Vec3f* minPos, Vec3f* maxXPos, Vec3f* maxZPo
     }
 }
 
+#if DYNAPOLY_BVH
+/**
+ * Records which of the BgActor's lists each of its polys was put in, for `BgCheck_RaycastFloorDynaCandidates`
+ */
+void DynaPoly_SetPolyLookupTypes(DynaCollisionContext* dyna, BgActor* bgActor, s32 numPolys) {
+    SSList* lists[3];
+    s32 i;
+
+    bzero(&dyna->polyLookupType[bgActor->dynaLookup.polyStartIndex], numPolys);
+    lists[0] = &bgActor->dynaLookup.floor;
+    lists[1] = &bgActor->dynaLookup.wall;
+    lists[2] = &bgActor->dynaLookup.ceiling;
+
+    for (i = 0; i < ARRAY_COUNT(lists); i++) {
+        u16 nodeId;
+
+        for (nodeId = lists[i]->head; nodeId != SS_NULL; nodeId = dyna->polyNodes.tbl[nodeId].next) {
+            dyna->polyLookupType[dyna->polyNodes.tbl[nodeId].polyId] = 1 << i; // DYNA_RAYCAST_*
+        }
+    }
+}
+#endif
+
 /**
  * original name: DynaPolyInfo_expandSRT
  */
@@ -2927,6 +3247,9 @@ void DynaPoly_AddBgActorToLookup(PlayState* play, DynaCollisionContext* dyna, s3
             }
         }
 
+#if DYNAPOLY_BVH
+        DynaPoly_SetPolyLookupTypes(dyna, &dyna->bgActors[bgId], pbgdata->numPolygons);
+#endif
         *polyStartIndex += pbgdata->numPolygons;
         *vtxStartIndex += pbgdata->numVertices;
         *waterBoxStartIndex += pbgdata->numWaterBoxes;
@@ -2939,6 +3262,16 @@ void DynaPoly_AddBgActorToLookup(PlayState* play, DynaCollisionContext* dyna, s3
         dyna->bgActors[bgId].curTransform.rot.y, dyna->bgActors[bgId].curTransform.rot.z,
         dyna->bgActors[bgId].curTransform.pos.x, dyna->bgActors[bgId].curTransform.pos.y,
         dyna->bgActors[bgId].curTransform.pos.z);
+#if DYNAPOLY_BVH
+    dyna->bgActors[bgId].bvhMtx[0][0] = sModelToWorldMtxF.xx;
+    dyna->bgActors[bgId].bvhMtx[0][1] = sModelToWorldMtxF.xy;
+    dyna->bgActors[bgId].bvhMtx[0][2] = sModelToWorldMtxF.xz;
+    dyna->bgActors[bgId].bvhMtx[0][3] = sModelToWorldMtxF.xw;
+    dyna->bgActors[bgId].bvhMtx[1][0] = sModelToWorldMtxF.zx;
+    dyna->bgActors[bgId].bvhMtx[1][1] = sModelToWorldMtxF.zy;
+    dyna->bgActors[bgId].bvhMtx[1][2] = sModelToWorldMtxF.zz;
+    dyna->bgActors[bgId].bvhMtx[1][3] = sModelToWorldMtxF.zw;
+#endif
 
     if ((pbgdata->numVertices != 0) && (pbgdata->numPolygons != 0)) {
         f32 radiusSq;
@@ -3065,6 +3398,9 @@ void DynaPoly_AddBgActorToLookup(PlayState* play, DynaCollisionContext* dyna, s3
             waterBox->properties = pbgdata->waterBoxes[wi].properties;
         }
     }
+#if DYNAPOLY_BVH
+    DynaPoly_SetPolyLookupTypes(dyna, &dyna->bgActors[bgId], pbgdata->numPolygons);
+#endif
     *polyStartIndex += pbgdata->numPolygons;
     *vtxStartIndex += pbgdata->numVertices;
     *waterBoxStartIndex += pbgdata->numWaterBoxes;
@@ -3167,6 +3503,119 @@ void DynaPoly_UpdateBgActorTransforms(PlayState* play, DynaCollisionContext* dyn
     }
 }
 
+#if DYNAPOLY_BVH
+/**
+ * Fills `sDynaBvhCandidates` with the polys of `bgActor` whose leaf bounds, taken to world space, are within
+ * `checkDist` of (`x`,`z`), which are all that `CollisionPoly_CheckYIntersectApprox1` can accept. Leaves
+ * `sDynaBvhNumCandidates` at -1 if the BgActor has no BVH or there are too many of them.
+ */
+void DynaBvh_FindFloorCandidates(BgActor* bgActor, f32 x, f32 z, f32 checkDist) {
+    DynaBvh* bvh = bgActor->bvh;
+    f32(*mtx)[4] = bgActor->bvhMtx;
+    u16 stack[DYNA_BVH_STACK_MAX];
+    s32 stackCount;
+    s32 count = 0;
+    s32 i;
+    s32 j;
+
+    sDynaBvhNumCandidates = -1;
+    if (bvh == NULL) {
+        return;
+    }
+
+    checkDist += DYNA_BVH_MARGIN;
+    stack[0] = 0;
+    stackCount = 1;
+    while (stackCount != 0) {
+        DynaBvhNode* node = &bvh->nodes[stack[--stackCount]];
+        f32 centerX = (node->min.x + node->max.x) * 0.5f;
+        f32 centerY = (node->min.y + node->max.y) * 0.5f;
+        f32 centerZ = (node->min.z + node->max.z) * 0.5f;
+        f32 halfX = (node->max.x - node->min.x) * 0.5f;
+        f32 halfY = (node->max.y - node->min.y) * 0.5f;
+        f32 halfZ = (node->max.z - node->min.z) * 0.5f;
+        f32 worldCenter;
+        f32 worldHalf;
+
+        worldCenter = mtx[0][3] + (centerX * mtx[0][0]) + (centerY * mtx[0][1]) + (centerZ * mtx[0][2]);
+        worldHalf = (halfX * fabsf(mtx[0][0])) + (halfY * fabsf(mtx[0][1])) + (halfZ * fabsf(mtx[0][2])) + checkDist;
+        if ((x < (worldCenter - worldHalf)) || ((worldCenter + worldHalf) < x)) {
+            continue;
+        }
+        worldCenter = mtx[1][3] + (centerX * mtx[1][0]) + (centerY * mtx[1][1]) + (centerZ * mtx[1][2]);
+        worldHalf = (halfX * fabsf(mtx[1][0])) + (halfY * fabsf(mtx[1][1])) + (halfZ * fabsf(mtx[1][2])) + checkDist;
+        if ((z < (worldCenter - worldHalf)) || ((worldCenter + worldHalf) < z)) {
+            continue;
+        }
+
+        if (node->count == 0) {
+            // The median split keeps the tree shallow enough for the stack
+            stack[stackCount++] = node->start;
+            stack[stackCount++] = node->start + 1;
+            continue;
+        }
+        if (count + node->count > DYNA_BVH_CANDIDATES_MAX) {
+            return;
+        }
+        for (i = node->start; i < node->start + node->count; i++) {
+            s16 polyId = bgActor->dynaLookup.polyStartIndex + bvh->polyIds[i];
+
+            // The lists are walked from the highest poly index down
+            for (j = count; (j > 0) && (sDynaBvhCandidates[j - 1] < polyId); j--) {
+                sDynaBvhCandidates[j] = sDynaBvhCandidates[j - 1];
+            }
+            sDynaBvhCandidates[j] = polyId;
+            count++;
+        }
+    }
+    sDynaBvhNumCandidates = count;
+}
+
+/**
+ * `BgCheck_RaycastFloorDynaList` over the polys of `sDynaBvhCandidates` in the list, in the same order, so the
+ * same poly wins ties
+ */
+f32 BgCheck_RaycastFloorDynaCandidates(DynaRaycast* dynaRaycast, u32 listType) {
+    CollisionPoly* polyList;
+    f32 result;
+    f32 yIntersect;
+    s32 i;
+    s16 id;
+
+    result = dynaRaycast->yIntersect;
+    if (dynaRaycast->ssList->head == SS_NULL) {
+        return result;
+    }
+    polyList = dynaRaycast->dyna->polyList;
+
+    for (i = 0; i < sDynaBvhNumCandidates; i++) {
+        id = sDynaBvhCandidates[i];
+        if (dynaRaycast->dyna->polyLookupType[id] != listType) {
+            continue;
+        }
+        if (COLPOLY_VIA_FLAG_TEST(polyList[id].flags_vIA, dynaRaycast->xpFlags) ||
+            (COLPOLY_VIA_FLAG_TEST(polyList[id].flags_vIB, 4) &&
+             (((dynaRaycast->actor != NULL) && (dynaRaycast->actor->category != ACTORCAT_PLAYER)) ||
+              ((dynaRaycast->actor == NULL) && (dynaRaycast->xpFlags != COLPOLY_IGNORE_CAMERA)))) ||
+            ((dynaRaycast->unk_24 & 0x20) &&
+             SurfaceType_IsSoft(dynaRaycast->colCtx, &polyList[id], dynaRaycast->unk1C))) {
+            continue;
+        }
+        if ((listType & (DYNA_RAYCAST_WALLS | DYNA_RAYCAST_CEILINGS)) && (dynaRaycast->unk_24 & 0x10) &&
+            (COLPOLY_GET_NORMAL(polyList[id].normal.y) < 0.0f)) {
+            continue;
+        }
+        if (CollisionPoly_CheckYIntersectApprox1(&polyList[id], dynaRaycast->dyna->vtxList, dynaRaycast->pos->x,
+                                                 dynaRaycast->pos->z, &yIntersect, dynaRaycast->checkDist) &&
+            (yIntersect < dynaRaycast->pos->y) && (result < yIntersect)) {
+            result = yIntersect;
+            *dynaRaycast->resultPoly = &dynaRaycast->dyna->polyList[id];
+        }
+    }
+    return result;
+}
+#endif
+
 /**
  * Perform dyna poly raycast toward floor on a list of floor, wall, or ceiling polys
  * `listType` specifies the poly list type (e.g. DYNA_RAYCAST_FLOORS)
@@ -3178,6 +3627,11 @@ f32 BgCheck_RaycastFloorDynaList(DynaRaycast* dynaRaycast, u32 listType) {
     f32 yIntersect;
     s16 id;
 
+#if DYNAPOLY_BVH
+    if (sDynaBvhNumCandidates >= 0) {
+        return BgCheck_RaycastFloorDynaCandidates(dynaRaycast, listType);
+    }
+#endif
     result = dynaRaycast->yIntersect;
     if (dynaRaycast->ssList->head == SS_NULL) {
         return result;
@@ -3268,6 +3722,10 @@ f32 BgCheck_RaycastFloorDyna(DynaRaycast* dynaRaycast) {
 
         dynaRaycast->unk1C = i;
         dynaRaycast->dyna = &dynaRaycast->colCtx->dyna;
+#if DYNAPOLY_BVH
+        DynaBvh_FindFloorCandidates(&dynaRaycast->colCtx->dyna.bgActors[i], dynaRaycast->pos->x, dynaRaycast->pos->z,
+                                    dynaRaycast->checkDist);
+#endif
         if (dynaRaycast->unk_24 & BGCHECK_IGNORE_FLOOR) {
             dynaRaycast->ssList = &dynaRaycast->colCtx->dyna.bgActors[i].dynaLookup.floor;
             intersect2 = BgCheck_RaycastFloorDynaList(dynaRaycast, DYNA_RAYCAST_FLOORS);
@@ -3301,6 +3759,9 @@ f32 BgCheck_RaycastFloorDyna(DynaRaycast* dynaRaycast) {
             }
         }
     }
+#if DYNAPOLY_BVH
+    sDynaBvhNumCandidates = -1;
+#endif
 
     dynaActor = DynaPoly_GetActor(dynaRaycast->colCtx, *dynaRaycast->bgId);
     if ((result != BGCHECK_Y_MIN) && (dynaActor != NULL) && (dynaRaycast->play != NULL)) {
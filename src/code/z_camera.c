@@ -515,6 +515,73 @@ s32 func_800CBC30(Camera* camera, f32 waterYMax, f32 waterYMin) {
     }
 }
 
+#if CAMERA_LINE_CACHE
+/**
+ * The camera's line tests go through a small cache. The behaviors test the same segments several times a frame, and
+ * the segments between eye and at barely move while the player stands still.
+ *
+ * A segment tested again in the same frame gets the same result. A segment whose endpoints are within
+ * CAMERA_LINE_CACHE_EPSILON of one tested in the last CAMERA_LINE_REUSE_FRAMES frames reuses its result if that result
+ * didn't hit a dynapoly, since those move. So a camera at rest tests its segments again every
+ * CAMERA_LINE_REUSE_FRAMES + 1 frames, and a platform moving into a missed segment is seen that many frames late at
+ * most. CAMERA_LINE_REUSE_FRAMES 0 only reuses results within the frame.
+ */
+#define CAMERA_LINE_CACHE_SIZE 32 // power of 2
+#define CAMERA_LINE_CACHE_EPSILON 0.5f
+
+typedef struct CameraLineCacheEntry {
+    /* 0x00 */ Vec3f from;
+    /* 0x0C */ Vec3f to;
+    /* 0x18 */ Vec3f posResult;
+    /* 0x24 */ CollisionPoly* poly;
+    /* 0x28 */ u32 frame; // when it was tested, 0 for an empty entry
+    /* 0x2C */ s32 bgId;
+    /* 0x30 */ u8 flags;  // the check arguments, see Camera_LineCacheFlags
+    /* 0x31 */ u8 result;
+} CameraLineCacheEntry; // size = 0x34
+
+CameraLineCacheEntry sCameraLineCache[CAMERA_LINE_CACHE_SIZE];
+
+#define CAMERA_LINE_CACHE_CLOSE(a, b)                                                                  \
+    ((fabsf((a).x - (b).x) < CAMERA_LINE_CACHE_EPSILON) && (fabsf((a).y - (b).y) < CAMERA_LINE_CACHE_EPSILON) && \
+     (fabsf((a).z - (b).z) < CAMERA_LINE_CACHE_EPSILON))
+
+/**
+ * BgCheck_CameraLineTest1 through `sCameraLineCache`. The entry is picked by the endpoints quantized to 32 units, so
+ * a segment that moved a little usually finds the entry it was stored in.
+ */
+s32 Camera_LineTest(Camera* camera, Vec3f* from, Vec3f* to, Vec3f* posResult, CollisionPoly** outPoly, s32 checkWall,
+                    s32 checkFloor, s32 checkCeil, s32 checkOneFace, s32* bgId) {
+    u32 frame = camera->play->state.frames + 1;
+    u8 flags = (checkWall ? 1 : 0) | (checkFloor ? 2 : 0) | (checkCeil ? 4 : 0) | ((checkOneFace + 1) << 3);
+    u32 hash = ((s32)from->x >> 5) * 0x9E3779B1 ^ ((s32)from->y >> 5) * 0x85EBCA77 ^ ((s32)from->z >> 5) * 0xC2B2AE3D ^
+               ((s32)to->x >> 5) * 0x27D4EB2F ^ ((s32)to->y >> 5) * 0x165667B1 ^ ((s32)to->z >> 5) * 0xD3A2646C ^ flags;
+    CameraLineCacheEntry* entry = &sCameraLineCache[(hash >> 16) & (CAMERA_LINE_CACHE_SIZE - 1)];
+
+    if ((entry->frame != 0) && (entry->flags == flags) && (frame - entry->frame <= CAMERA_LINE_REUSE_FRAMES) &&
+        ((frame == entry->frame) || !entry->result || (entry->bgId == BGCHECK_SCENE)) &&
+        CAMERA_LINE_CACHE_CLOSE(entry->from, *from) && CAMERA_LINE_CACHE_CLOSE(entry->to, *to)) {
+        // A miss ends the segment where it ends now, not where it ended then
+        *posResult = entry->result ? entry->posResult : *to;
+        *outPoly = entry->poly;
+        *bgId = entry->bgId;
+        return entry->result;
+    }
+
+    entry->result = BgCheck_CameraLineTest1(&camera->play->colCtx, from, to, posResult, outPoly, checkWall, checkFloor,
+                                            checkCeil, checkOneFace, bgId);
+    entry->from = *from;
+    entry->to = *to;
+    entry->posResult = *posResult;
+    entry->poly = *outPoly;
+    entry->bgId = *bgId;
+    entry->flags = flags;
+    entry->frame = frame;
+
+    return entry->result;
+}
+#endif
+
 s32 func_800CBC84(Camera* camera, Vec3f* from, CameraCollision* to, s32 arg3) {
     CollisionContext* colCtx = &camera->play->colCtx;
     Vec3f toNewPos;
@@ -528,8 +595,13 @@ s32 func_800CBC84(Camera* camera, Vec3f* from, CameraCollision* to, s32 arg3) {
     toPoint.y = to->pos.y + fromToNorm.y;
     toPoint.z = to->pos.z + fromToNorm.z;
 
+#if CAMERA_LINE_CACHE
+    if (!Camera_LineTest(camera, from, &toPoint, &toNewPos, &to->poly, (arg3 & 1) ? false : true, true,
+                         (arg3 & 2) ? false : true, -1, &floorBgId)) {
+#else
     if (!BgCheck_CameraLineTest1(colCtx, from, &toPoint, &toNewPos, &to->poly, (arg3 & 1) ? false : true, true,
                                  (arg3 & 2) ? false : true, -1, &floorBgId)) {
+#endif
         toNewPos = to->pos;
         toNewPos.y += 5.0f;
 
@@ -588,8 +660,12 @@ s32 Camera_BgCheckInfo(Camera* camera, Vec3f* from, CameraCollision* to) {
     Vec3f toNewPos;
     Vec3f fromToNorm;
 
+#if CAMERA_LINE_CACHE
+    if (Camera_LineTest(camera, from, &to->pos, &toNewPos, &to->poly, true, true, true, -1, &to->bgId)) {
+#else
     if (BgCheck_CameraLineTest1(&camera->play->colCtx, from, &to->pos, &toNewPos, &to->poly, true, true, true, -1,
                                 &to->bgId)) {
+#endif
         floorPoly = to->poly;
         to->norm.x = COLPOLY_GET_NORMAL(floorPoly->normal.x);
         to->norm.y = COLPOLY_GET_NORMAL(floorPoly->normal.y);
@@ -616,7 +692,11 @@ s32 Camera_BgCheck(Camera* camera, Vec3f* from, Vec3f* to) {
     s32 bgId;
     CollisionPoly* poly = NULL;
 
+#if CAMERA_LINE_CACHE
+    if (Camera_LineTest(camera, from, to, &intersect, &poly, 1, 1, 1, -1, &bgId)) {
+#else
     if (BgCheck_CameraLineTest1(colCtx, from, to, &intersect, &poly, 1, 1, 1, -1, &bgId)) {
+#endif
         *to = intersect;
         return true;
     }
@@ -636,8 +716,13 @@ s32 Camera_CheckOOB(Camera* camera, Vec3f* from, Vec3f* to) {
     CollisionContext* colCtx = &camera->play->colCtx;
 
     poly = NULL;
+#if CAMERA_LINE_CACHE
+    if (Camera_LineTest(camera, from, to, &intersect, &poly, true, true, true, 0, &bgId) &&
+        (CollisionPoly_GetPointDistanceFromPlane(poly, from) < 0.0f)) {
+#else
     if (BgCheck_CameraLineTest1(colCtx, from, to, &intersect, &poly, true, true, true, 0, &bgId) &&
         (CollisionPoly_GetPointDistanceFromPlane(poly, from) < 0.0f)) {
+#endif
         return true;
     }
 
@@ -6918,6 +7003,10 @@ void Camera_Init(Camera* camera, View* view, CollisionContext* colCtx, PlayState
     s16 j;
 
     memset(camera, 0, sizeof(Camera));
+#if CAMERA_LINE_CACHE
+    // The frame counter starts over with every play state
+    memset(sCameraLineCache, 0, sizeof(sCameraLineCache));
+#endif
 
     camera->play = sCamPlayState = play;
     curUID = sCameraNextUID;
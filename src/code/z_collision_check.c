@@ -2945,6 +2945,241 @@ ColChkVsFunc sACVsFuncs[COLSHAPE_MAX][COLSHAPE_MAX] = {
     },
 };
 
+#if COLCHK_BROADPHASE
+/**
+ * Broadphase for the AT/AC and OC passes, only built for the Nspire port (see Makefile.nsp).
+ *
+ * Each collider of the tested list gets a world space box around all of its elements, padded so the float slack of
+ * the narrowphase stays inside, and is marked in the cells of a 16x16 grid of XZ columns that the box covers. The grid
+ * wraps around, so distant colliders can share a cell but a collider is never missing from a cell it covers. A
+ * collider is then only tested against the colliders found in its own cells whose boxes overlap its box, in ascending
+ * list order. The pairs that are tested keep the order of the full loops, and a pair whose boxes don't overlap can't
+ * touch, so the hits are the same.
+ */
+#define COLCHK_BP_CELL_SHIFT 8 // 256 units a cell
+#define COLCHK_BP_GRID 16
+#define COLCHK_BP_PAD 4
+#define COLCHK_BP_MIN_PAIRS 64 // below this the full loops cost less than building the grid
+
+typedef struct {
+    /* 0x00 */ s32 min[3];
+    /* 0x0C */ s32 max[3];
+} ColChkBounds; // size = 0x18
+
+typedef struct {
+    /* 0x0000 */ ColChkBounds bounds[64];                      // one bit a collider, colAC holds 60
+    /* 0x0600 */ u64 cells[COLCHK_BP_GRID][COLCHK_BP_GRID]; // bit i set if collider i covers the cell
+} ColChkBroadphase; // size = 0xE00
+
+static ColChkBroadphase sColChkBroadphase;
+
+static void CollisionCheck_BoundsAddSphere(ColChkBounds* bounds, s32 x, s32 y, s32 z, s32 radius) {
+    radius = ABS(radius) + COLCHK_BP_PAD;
+
+    s32 center[3];
+    s32 i;
+
+    center[0] = x;
+    center[1] = y;
+    center[2] = z;
+    for (i = 0; i < 3; i++) {
+        if (center[i] - radius < bounds->min[i]) {
+            bounds->min[i] = center[i] - radius;
+        }
+        if (center[i] + radius > bounds->max[i]) {
+            bounds->max[i] = center[i] + radius;
+        }
+    }
+}
+
+static void CollisionCheck_BoundsAddPoint(ColChkBounds* bounds, Vec3f* point) {
+    // The truncation is at most 1 unit off, which is within the pad
+    CollisionCheck_BoundsAddSphere(bounds, point->x, point->y, point->z, 1);
+}
+
+/**
+ * Computes a box holding every element of `col`. A collider without elements gets an empty box, which overlaps
+ * nothing, as its narrowphase tests can't hit anything either.
+ */
+static void CollisionCheck_GetBounds(Collider* col, ColChkBounds* bounds) {
+    s32 i;
+    s32 j;
+
+    bounds->min[0] = bounds->min[1] = bounds->min[2] = 0x3FFFFFFF;
+    bounds->max[0] = bounds->max[1] = bounds->max[2] = -0x3FFFFFFF;
+
+    switch (col->shape) {
+        case COLSHAPE_JNTSPH: {
+            ColliderJntSph* jntSph = (ColliderJntSph*)col;
+
+            if (jntSph->elements != NULL) {
+                for (i = 0; i < jntSph->count; i++) {
+                    Sphere16* sph = &jntSph->elements[i].dim.worldSphere;
+
+                    CollisionCheck_BoundsAddSphere(bounds, sph->center.x, sph->center.y, sph->center.z, sph->radius);
+                }
+            }
+            break;
+        }
+
+        case COLSHAPE_CYLINDER: {
+            Cylinder16* cyl = &((ColliderCylinder*)col)->dim;
+            s32 bottom = cyl->pos.y + cyl->yShift;
+
+            // Spheres of the cylinder's radius around both caps, as Math3D_CylTriVsIntersect ends with cap spheres
+            CollisionCheck_BoundsAddSphere(bounds, cyl->pos.x, bottom, cyl->pos.z, cyl->radius);
+            CollisionCheck_BoundsAddSphere(bounds, cyl->pos.x, bottom + cyl->height, cyl->pos.z, cyl->radius);
+            break;
+        }
+
+        case COLSHAPE_TRIS: {
+            ColliderTris* tris = (ColliderTris*)col;
+
+            if (tris->elements != NULL) {
+                for (i = 0; i < tris->count; i++) {
+                    for (j = 0; j < 3; j++) {
+                        CollisionCheck_BoundsAddPoint(bounds, &tris->elements[i].dim.vtx[j]);
+                    }
+                }
+            }
+            break;
+        }
+
+        case COLSHAPE_QUAD: {
+            ColliderQuad* quad = (ColliderQuad*)col;
+
+            for (j = 0; j < 4; j++) {
+                CollisionCheck_BoundsAddPoint(bounds, &quad->dim.quad[j]);
+            }
+            break;
+        }
+
+        case COLSHAPE_SPHERE: {
+            Sphere16* sph = &((ColliderSphere*)col)->dim.worldSphere;
+
+            CollisionCheck_BoundsAddSphere(bounds, sph->center.x, sph->center.y, sph->center.z, sph->radius);
+            break;
+        }
+
+        default:
+            // Unknown shape, overlaps everything
+            bounds->min[0] = bounds->min[1] = bounds->min[2] = -0x3FFFFFFF;
+            bounds->max[0] = bounds->max[1] = bounds->max[2] = 0x3FFFFFFF;
+            break;
+    }
+}
+
+static s32 CollisionCheck_BoundsOverlap(ColChkBounds* a, ColChkBounds* b) {
+    return (a->min[0] <= b->max[0]) && (b->min[0] <= a->max[0]) && (a->min[1] <= b->max[1]) &&
+           (b->min[1] <= a->max[1]) && (a->min[2] <= b->max[2]) && (b->min[2] <= a->max[2]);
+}
+
+/**
+ * Marks `mark` in every cell `bounds` covers, and returns the colliders found in those cells.
+ */
+static u64 CollisionCheck_BroadphaseVisit(ColChkBroadphase* bp, ColChkBounds* bounds, u64 mark) {
+    s32 x0 = bounds->min[0] >> COLCHK_BP_CELL_SHIFT;
+    s32 x1 = bounds->max[0] >> COLCHK_BP_CELL_SHIFT;
+    s32 z0 = bounds->min[2] >> COLCHK_BP_CELL_SHIFT;
+    s32 z1 = bounds->max[2] >> COLCHK_BP_CELL_SHIFT;
+    u64 found = 0;
+    s32 x;
+    s32 z;
+
+    if ((x0 > x1) || (z0 > z1)) {
+        return 0;
+    }
+    if (x1 - x0 >= COLCHK_BP_GRID) {
+        x0 = 0;
+        x1 = COLCHK_BP_GRID - 1;
+    }
+    if (z1 - z0 >= COLCHK_BP_GRID) {
+        z0 = 0;
+        z1 = COLCHK_BP_GRID - 1;
+    }
+
+    for (z = z0; z <= z1; z++) {
+        for (x = x0; x <= x1; x++) {
+            u64* cell = &bp->cells[z & (COLCHK_BP_GRID - 1)][x & (COLCHK_BP_GRID - 1)];
+
+            *cell |= mark;
+            found |= *cell;
+        }
+    }
+    return found;
+}
+
+/**
+ * Computes the boxes of the `count` colliders of `cols` and marks them in the grid. NULL colliders are left out.
+ */
+static void CollisionCheck_BroadphaseBuild(ColChkBroadphase* bp, Collider** cols, s32 count) {
+    s32 i;
+    s32 x;
+    s32 z;
+
+    for (z = 0; z < COLCHK_BP_GRID; z++) {
+        for (x = 0; x < COLCHK_BP_GRID; x++) {
+            bp->cells[z][x] = 0;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (cols[i] != NULL) {
+            CollisionCheck_GetBounds(cols[i], &bp->bounds[i]);
+            CollisionCheck_BroadphaseVisit(bp, &bp->bounds[i], (u64)1 << i);
+        }
+    }
+}
+
+/**
+ * CollisionCheck_AT's loop over the AT colliders through the broadphase. Each AT collider is tested against the AC
+ * colliders it may touch with the same checks as CollisionCheck_AC, in the same order.
+ */
+static void CollisionCheck_AT_Broadphase(struct PlayState* play, CollisionCheckContext* colChkCtx) {
+    ColChkBroadphase* bp = &sColChkBroadphase;
+    Collider** atColP;
+
+    CollisionCheck_BroadphaseBuild(bp, colChkCtx->colAC, colChkCtx->colACCount);
+
+    for (atColP = &colChkCtx->colAT[0]; atColP < &colChkCtx->colAT[colChkCtx->colATCount]; atColP++) {
+        Collider* atCol = *atColP;
+        ColChkBounds atBounds;
+        u64 candidates;
+        s32 i;
+
+        if ((atCol == NULL) || !(atCol->atFlags & AT_ON)) {
+            continue;
+        }
+        if ((atCol->actor != NULL) && (atCol->actor->update == NULL)) {
+            continue;
+        }
+
+        CollisionCheck_GetBounds(atCol, &atBounds);
+        candidates = CollisionCheck_BroadphaseVisit(bp, &atBounds, 0);
+
+        for (i = 0; candidates != 0; i++, candidates >>= 1) {
+            Collider* acCol = colChkCtx->colAC[i];
+
+            if (!(candidates & 1) || !CollisionCheck_BoundsOverlap(&atBounds, &bp->bounds[i])) {
+                continue;
+            }
+            if (!(acCol->acFlags & AC_ON)) {
+                continue;
+            }
+            if ((acCol->actor != NULL) && (acCol->actor->update == NULL)) {
+                continue;
+            }
+            if ((acCol->acFlags & atCol->atFlags & AC_TYPE_ALL) && (atCol != acCol)) {
+                if (!(atCol->atFlags & AT_SELF) && (atCol->actor != NULL) && (acCol->actor == atCol->actor)) {
+                    continue;
+                }
+                sACVsFuncs[atCol->shape][acCol->shape](play, colChkCtx, atCol, acCol);
+            }
+        }
+    }
+}
+#endif
+
 /**
  * Iterates through all AC colliders, performing AC collisions with the AT collider.
  */
@@ -2981,6 +3216,14 @@ void CollisionCheck_AT(struct PlayState* play, CollisionCheckContext* colChkCtx)
         return;
     }
 
+#if COLCHK_BROADPHASE
+    if (colChkCtx->colATCount * colChkCtx->colACCount >= COLCHK_BP_MIN_PAIRS) {
+        CollisionCheck_AT_Broadphase(play, colChkCtx);
+        CollisionCheck_SetHitEffects(play, colChkCtx);
+        return;
+    }
+#endif
+
     for (acColP = &colChkCtx->colAT[0]; acColP < &colChkCtx->colAT[colChkCtx->colATCount]; acColP++) {
         Collider* acCol = *acColP;
 
@@ -3376,6 +3619,49 @@ ColChkVsFunc sOCVsFuncs[COLSHAPE_MAX][COLSHAPE_MAX] = {
     },
 };
 
+#if COLCHK_BROADPHASE
+/**
+ * CollisionCheck_OC through the broadphase. Each OC collider is tested against the subsequent ones it may touch with
+ * the same checks, in the same order.
+ */
+static void CollisionCheck_OC_Broadphase(struct PlayState* play, CollisionCheckContext* colChkCtx) {
+    ColChkBroadphase* bp = &sColChkBroadphase;
+    s32 left;
+
+    CollisionCheck_BroadphaseBuild(bp, colChkCtx->colOC, colChkCtx->colOCCount);
+
+    for (left = 0; left < colChkCtx->colOCCount; left++) {
+        Collider* leftCol = colChkCtx->colOC[left];
+        u64 candidates;
+        s32 right;
+
+        if ((leftCol == NULL) || CollisionCheck_SkipOC(leftCol)) {
+            continue;
+        }
+
+        // Only the colliders after this one, each pair is tested once
+        candidates = CollisionCheck_BroadphaseVisit(bp, &bp->bounds[left], 0) >> (left + 1);
+
+        for (right = left + 1; candidates != 0; right++, candidates >>= 1) {
+            Collider* rightCol = colChkCtx->colOC[right];
+            ColChkVsFunc vsFunc;
+
+            if (!(candidates & 1) || !CollisionCheck_BoundsOverlap(&bp->bounds[left], &bp->bounds[right])) {
+                continue;
+            }
+            if (CollisionCheck_SkipOC(rightCol) || CollisionCheck_Incompatible(leftCol, rightCol)) {
+                continue;
+            }
+            vsFunc = sOCVsFuncs[leftCol->shape][rightCol->shape];
+            if (vsFunc == NULL) {
+                continue;
+            }
+            vsFunc(play, colChkCtx, leftCol, rightCol);
+        }
+    }
+}
+#endif
+
 /**
  * Iterates through all OC colliders and collides them with all subsequent OC colliders on the list. During an OC
  * collision, colliders with overlapping elements move away from each other so that their elements no longer overlap.
@@ -3388,6 +3674,13 @@ void CollisionCheck_OC(struct PlayState* play, CollisionCheckContext* colChkCtx)
     Collider** rightColP;
     ColChkVsFunc vsFunc;
 
+#if COLCHK_BROADPHASE
+    if (colChkCtx->colOCCount * (colChkCtx->colOCCount - 1) / 2 >= COLCHK_BP_MIN_PAIRS) {
+        CollisionCheck_OC_Broadphase(play, colChkCtx);
+        return;
+    }
+#endif
+
     for (leftColP = colChkCtx->colOC; leftColP < colChkCtx->colOC + colChkCtx->colOCCount; leftColP++) {
         if ((*leftColP == NULL) || CollisionCheck_SkipOC(*leftColP)) {
             continue;
@@ -27,6 +27,9 @@ void CutsceneHandler_StartScript(PlayState* play, CutsceneContext* csCtx);
 void CutsceneHandler_RunScript(PlayState* play, CutsceneContext* csCtx);
 void CutsceneHandler_StopScript(PlayState* play, CutsceneContext* csCtx);
 void Cutscene_SetupScripted(PlayState* play, CutsceneContext* csCtx);
+#if CUTSCENE_SCRIPT_CACHE
+void Cutscene_ClearScriptCache(void);
+#endif
 
 static s32 sPad = 0;
 u16 sCurTextId = 0;
@@ -49,6 +52,10 @@ void Cutscene_InitContext(PlayState* play, CutsceneContext* csCtx) {
 
     gDisablePlayerCsActionStartPos = false;
 
+#if CUTSCENE_SCRIPT_CACHE
+    Cutscene_ClearScriptCache();
+#endif
+
     Audio_SetCutsceneFlag(false);
 }
 
@@ -1444,12 +1451,455 @@ void Cutscene_ProcessScript(PlayState* play, CutsceneContext* csCtx, u8* script)
     }
 }
 
+#if CUTSCENE_SCRIPT_CACHE
+#define CS_SCRIPT_CACHE_MAX 1024
+
+/**
+ * A command of the running script and the frames it can do anything on, `firstFrame` to `lastFrame` inclusive. These
+ * are the frames its handler checks for, or more where the handler has a further check of its own.
+ */
+typedef struct {
+    /* 0x0 */ void* cmd;
+    /* 0x4 */ u32 cmdType; // CS_CMD_ACTOR_CUE_POST_PROCESS for an actor cue in `cueChannel`
+    /* 0x8 */ u16 firstFrame;
+    /* 0xA */ u16 lastFrame;
+    /* 0xC */ s16 cueChannel;
+} CsScriptEntry; // size = 0x10
+
+/**
+ * The commands of the running script, decoded when it starts. `byStart` has them in order of their first frame and
+ * `cursor` is the next of them to start, so a frame only looks at the commands in `active` and the ones starting on it.
+ */
+typedef struct {
+    /* 0x0000 */ u8* script; // NULL to decode the script again
+    /* 0x0004 */ s32 isCached; // false when the script has more commands than fit, it is then processed as is
+    /* 0x0008 */ s32 csFrameCount;
+    /* 0x000C */ u16 curFrame; // the frame `active` is for
+    /* 0x000E */ s16 numEntries;
+    /* 0x0010 */ s16 cursor;
+    /* 0x0012 */ s16 numActive;
+    /* 0x0014 */ CsScriptEntry entries[CS_SCRIPT_CACHE_MAX]; // in script order
+    /* 0x4014 */ s16 byStart[CS_SCRIPT_CACHE_MAX];
+    /* 0x4814 */ s16 active[CS_SCRIPT_CACHE_MAX]; // the commands covering `curFrame`, in script order
+} CsScriptCache; // size = 0x5014
+
+CsScriptCache sCsScriptCache;
+
+void Cutscene_ClearScriptCache(void) {
+    sCsScriptCache.script = NULL;
+}
+
+/**
+ * The size of a command in a list of `cmdType`, 0 for the lists `Cutscene_ProcessScript` skips
+ */
+s32 Cutscene_GetCmdSize(u32 cmdType) {
+    switch (cmdType) {
+        case CS_CMD_MISC:
+            return sizeof(CsCmdMisc);
+        case CS_CMD_LIGHT_SETTING:
+            return sizeof(CsCmdLightSetting);
+        case CS_CMD_START_SEQ:
+            return sizeof(CsCmdStartSeq);
+        case CS_CMD_STOP_SEQ:
+            return sizeof(CsCmdStopSeq);
+        case CS_CMD_FADE_OUT_SEQ:
+            return sizeof(CsCmdFadeOutSeq);
+        case CS_CMD_START_AMBIENCE:
+            return sizeof(CsCmdStartAmbience);
+        case CS_CMD_FADE_OUT_AMBIENCE:
+            return sizeof(CsCmdFadeOutAmbience);
+        case CS_CMD_SFX_REVERB_INDEX_2:
+            return sizeof(CsCmdSfxReverbIndexTo2);
+        case CS_CMD_SFX_REVERB_INDEX_1:
+            return sizeof(CsCmdSfxReverbIndexTo1);
+        case CS_CMD_MODIFY_SEQ:
+            return sizeof(CsCmdModifySeq);
+        case CS_CMD_RUMBLE:
+            return sizeof(CsCmdRumble);
+        case CS_CMD_TRANSITION_GENERAL:
+            return sizeof(CsCmdTransitionGeneral);
+        case CS_CMD_TIME:
+            return sizeof(CsCmdTime);
+        case CS_CMD_PLAYER_CUE:
+            return sizeof(CsCmdActorCue);
+        case CS_CMD_DESTINATION:
+            return sizeof(CsCmdDestination);
+        case CS_CMD_CHOOSE_CREDITS_SCENES:
+            return sizeof(CsCmdChooseCreditsScene);
+        case CS_CMD_TEXT:
+            return sizeof(CsCmdText);
+        case CS_CMD_TRANSITION:
+            return sizeof(CsCmdTransition);
+        case CS_CMD_MOTION_BLUR:
+            return sizeof(CsCmdMotionBlur);
+        case CS_CMD_GIVE_TATL:
+            return sizeof(CsCmdGiveTatl);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Adds a command to the cache with the frames its handler can act on. Every command starts with a halfword followed by
+ * its start and end frame. Returns false once the cache is full.
+ */
+s32 Cutscene_CacheCmd(CsScriptCache* cache, u32 cmdType, void* cmd, s16 cueChannel) {
+    CsCmdUnimplemented* header = (CsCmdUnimplemented*)cmd;
+    CsScriptEntry* entry;
+    s32 firstFrame = header->startFrame;
+    s32 lastFrame = header->startFrame;
+
+    switch (cmdType) {
+        case CS_CMD_MISC:
+            lastFrame = (header->endFrame == header->startFrame) ? 0xFFFF : header->endFrame - 1;
+            break;
+
+        case CS_CMD_STOP_SEQ:
+        case CS_CMD_TRANSITION_GENERAL:
+        case CS_CMD_TRANSITION:
+        case CS_CMD_MOTION_BLUR:
+            lastFrame = header->endFrame;
+            break;
+
+        case CS_CMD_RUMBLE:
+            lastFrame = MAX(header->startFrame, header->endFrame);
+            break;
+
+        case CS_CMD_CHOOSE_CREDITS_SCENES:
+            lastFrame = 0xFFFF;
+            break;
+
+        case CS_CMD_TEXT:
+            if (((CsCmdText*)cmd)->textId == 0xFFFF) {
+                return true;
+            }
+            firstFrame = header->startFrame + 1;
+            lastFrame = header->endFrame;
+            break;
+
+        case CS_CMD_PLAYER_CUE:
+        case CS_CMD_ACTOR_CUE_POST_PROCESS:
+            lastFrame = header->endFrame - 1;
+            break;
+
+        case CS_CMD_CAMERA_SPLINE:
+            // Updated every frame, `cmd` is the size of the spline data rather than a command
+            firstFrame = 0;
+            lastFrame = 0xFFFF;
+            break;
+
+        default:
+            break;
+    }
+
+    if (firstFrame > lastFrame) {
+        return true;
+    }
+    if (cache->numEntries >= CS_SCRIPT_CACHE_MAX) {
+        return false;
+    }
+
+    entry = &cache->entries[cache->numEntries++];
+    entry->cmd = cmd;
+    entry->cmdType = cmdType;
+    entry->firstFrame = firstFrame;
+    entry->lastFrame = lastFrame;
+    entry->cueChannel = cueChannel;
+    return true;
+}
+
+/**
+ * Decodes `script` into `sCsScriptCache` the way `Cutscene_ProcessScript` walks it, giving the actor cue lists their
+ * channels in `sCueTypeList` in the same order.
+ */
+void Cutscene_CacheScript(u8* script) {
+    CsScriptCache* cache = &sCsScriptCache;
+    s32 i;
+    s32 j;
+    s32 k;
+    s32 totalEntries;
+    u32 cmdType;
+    s32 cmdEntries;
+    s32 cmdSize;
+
+    cache->script = script;
+    cache->isCached = false;
+    cache->curFrame = 0;
+    cache->numEntries = 0;
+    cache->cursor = 0;
+    cache->numActive = 0;
+
+    bcopy(script, &totalEntries, sizeof(totalEntries));
+    script += sizeof(totalEntries);
+
+    bcopy(script, &cache->csFrameCount, sizeof(cache->csFrameCount));
+    script += sizeof(cache->csFrameCount);
+
+    for (i = 0; i < totalEntries; i++) {
+        bcopy(script, &cmdType, sizeof(cmdType));
+        script += sizeof(cmdType);
+
+        if (cmdType == CS_CAM_STOP) {
+            break;
+        }
+
+        if (((cmdType >= CS_CMD_ACTOR_CUE_100) && (cmdType <= CS_CMD_ACTOR_CUE_149)) ||
+            (cmdType == CS_CMD_ACTOR_CUE_201) ||
+            ((cmdType >= CS_CMD_ACTOR_CUE_450) && (cmdType <= CS_CMD_ACTOR_CUE_599))) {
+            for (j = 0; j < ARRAY_COUNT(sCueTypeList); j = (s16)(j + 1)) {
+                if ((sCueTypeList[j] == (u16)cmdType) || (sCueTypeList[j] == 0)) {
+                    sCueTypeList[j] = cmdType;
+
+                    bcopy(script, &cmdEntries, sizeof(cmdEntries));
+                    script += sizeof(cmdEntries);
+
+                    for (k = 0; k < cmdEntries; k++) {
+                        if (!Cutscene_CacheCmd(cache, CS_CMD_ACTOR_CUE_POST_PROCESS, script, j)) {
+                            return;
+                        }
+                        script += sizeof(CsCmdActorCue);
+                    }
+                    cmdType = CS_CMD_ACTOR_CUE_POST_PROCESS;
+                    break;
+                }
+            }
+        }
+
+        if (cmdType == CS_CMD_ACTOR_CUE_POST_PROCESS) {
+            continue;
+        }
+
+        if (cmdType == CS_CMD_CAMERA_SPLINE) {
+            if (!Cutscene_CacheCmd(cache, cmdType, script, 0)) {
+                return;
+            }
+            bcopy(script, &cmdEntries, sizeof(cmdEntries));
+            script += cmdEntries + sizeof(cmdEntries);
+            continue;
+        }
+
+        bcopy(script, &cmdEntries, sizeof(cmdEntries));
+        script += sizeof(cmdEntries);
+
+        cmdSize = Cutscene_GetCmdSize(cmdType);
+        if (cmdSize == 0) {
+            script += cmdEntries * sizeof(CsCmdUnimplemented);
+            continue;
+        }
+
+        for (j = 0; j < cmdEntries; j++) {
+            if (!Cutscene_CacheCmd(cache, cmdType, script, 0)) {
+                return;
+            }
+            script += cmdSize;
+        }
+    }
+
+    // Stable, so that commands starting on the same frame stay in script order
+    for (i = 0; i < cache->numEntries; i++) {
+        u16 firstFrame = cache->entries[i].firstFrame;
+
+        for (j = i; (j > 0) && (cache->entries[cache->byStart[j - 1]].firstFrame > firstFrame); j--) {
+            cache->byStart[j] = cache->byStart[j - 1];
+        }
+        cache->byStart[j] = i;
+    }
+
+    cache->isCached = true;
+}
+
+/**
+ * Brings `active` to `curFrame`: drops the commands that ended and inserts the ones that start, in script order. Going
+ * back a frame or more starts over from the first command.
+ */
+void Cutscene_UpdateActiveCmds(CsScriptCache* cache, u16 curFrame) {
+    s32 i;
+    s32 j;
+    s32 numActive = 0;
+
+    if (curFrame < cache->curFrame) {
+        cache->cursor = 0;
+        cache->numActive = 0;
+    }
+    cache->curFrame = curFrame;
+
+    for (i = 0; i < cache->numActive; i++) {
+        if (cache->entries[cache->active[i]].lastFrame >= curFrame) {
+            cache->active[numActive++] = cache->active[i];
+        }
+    }
+
+    for (; (cache->cursor < cache->numEntries) &&
+           (cache->entries[cache->byStart[cache->cursor]].firstFrame <= curFrame);
+         cache->cursor++) {
+        s16 index = cache->byStart[cache->cursor];
+
+        if (cache->entries[index].lastFrame < curFrame) {
+            continue;
+        }
+        for (j = numActive; (j > 0) && (cache->active[j - 1] > index); j--) {
+            cache->active[j] = cache->active[j - 1];
+        }
+        cache->active[j] = index;
+        numActive++;
+    }
+
+    cache->numActive = numActive;
+}
+
+void Cutscene_RunCachedCmd(PlayState* play, CutsceneContext* csCtx, CsScriptEntry* entry) {
+    switch (entry->cmdType) {
+        case CS_CMD_MISC:
+            CutsceneCmd_Misc(play, csCtx, (CsCmdMisc*)entry->cmd);
+            break;
+
+        case CS_CMD_LIGHT_SETTING:
+            CutsceneCmd_SetLightSetting(play, csCtx, (CsCmdLightSetting*)entry->cmd);
+            break;
+
+        case CS_CMD_START_SEQ:
+            CutsceneCmd_StartSequence(play, csCtx, (CsCmdStartSeq*)entry->cmd);
+            break;
+
+        case CS_CMD_STOP_SEQ:
+            CutsceneCmd_StopSequence(play, csCtx, (CsCmdStopSeq*)entry->cmd);
+            break;
+
+        case CS_CMD_FADE_OUT_SEQ:
+            CutsceneCmd_FadeOutSequence(play, csCtx, (CsCmdFadeOutSeq*)entry->cmd);
+            break;
+
+        case CS_CMD_START_AMBIENCE:
+            CutsceneCmd_StartAmbience(play, csCtx, (CsCmdStartAmbience*)entry->cmd);
+            break;
+
+        case CS_CMD_FADE_OUT_AMBIENCE:
+            CutsceneCmd_FadeOutAmbience(play, csCtx, (CsCmdFadeOutAmbience*)entry->cmd);
+            break;
+
+        case CS_CMD_SFX_REVERB_INDEX_2:
+            Cutscene_SetSfxReverbIndexTo2(play, csCtx, (CsCmdSfxReverbIndexTo2*)entry->cmd);
+            break;
+
+        case CS_CMD_SFX_REVERB_INDEX_1:
+            Cutscene_SetSfxReverbIndexTo1(play, csCtx, (CsCmdSfxReverbIndexTo1*)entry->cmd);
+            break;
+
+        case CS_CMD_MODIFY_SEQ:
+            CutsceneCmd_ModifySequence(play, csCtx, (CsCmdModifySeq*)entry->cmd);
+            break;
+
+        case CS_CMD_RUMBLE:
+            CutsceneCmd_RumbleController(play, csCtx, (CsCmdRumble*)entry->cmd);
+            break;
+
+        case CS_CMD_TRANSITION_GENERAL:
+            CutsceneCmd_TransitionGeneral(play, csCtx, (CsCmdTransitionGeneral*)entry->cmd);
+            break;
+
+        case CS_CMD_TIME:
+            CutsceneCmd_SetTime(play, csCtx, (CsCmdTime*)entry->cmd);
+            break;
+
+        case CS_CMD_PLAYER_CUE:
+            csCtx->playerCue = (CsCmdActorCue*)entry->cmd;
+            break;
+
+        case CS_CMD_ACTOR_CUE_POST_PROCESS:
+            csCtx->actorCues[entry->cueChannel] = (CsCmdActorCue*)entry->cmd;
+            break;
+
+        case CS_CMD_CAMERA_SPLINE:
+            CutsceneCmd_UpdateCamSpline(play, (u8*)entry->cmd);
+            break;
+
+        case CS_CMD_DESTINATION:
+            CutsceneCmd_Destination(play, csCtx, (CsCmdDestination*)entry->cmd);
+            break;
+
+        case CS_CMD_CHOOSE_CREDITS_SCENES:
+            CutsceneCmd_ChooseCreditsScenes(play, csCtx, (CsCmdChooseCreditsScene*)entry->cmd);
+            break;
+
+        case CS_CMD_TEXT:
+            CutsceneCmd_Text(play, csCtx, (CsCmdText*)entry->cmd);
+            break;
+
+        case CS_CMD_TRANSITION:
+            CutsceneCmd_Transition(play, csCtx, (CsCmdTransition*)entry->cmd);
+            break;
+
+        case CS_CMD_MOTION_BLUR:
+            CutsceneCmd_MotionBlur(play, csCtx, (CsCmdMotionBlur*)entry->cmd);
+            break;
+
+        case CS_CMD_GIVE_TATL:
+            CutsceneCmd_GiveTatlToPlayer(play, csCtx, (CsCmdGiveTatl*)entry->cmd);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * `Cutscene_ProcessScript` over the commands of `script` decoded when it started, running only the ones whose frames
+ * cover the current frame, in script order.
+ *
+ * The text and misc commands can move `csCtx->curFrame` while the script is processed, the commands after them then
+ * check the new frame. From such a command on, the rest of the cached commands are checked one by one against it.
+ */
+void Cutscene_ProcessCachedScript(PlayState* play, CutsceneContext* csCtx, u8* script) {
+    CsScriptCache* cache = &sCsScriptCache;
+    u16 curFrame;
+    s32 i;
+    s32 index;
+
+    if (cache->script != script) {
+        Cutscene_CacheScript(script);
+    }
+    if (!cache->isCached) {
+        Cutscene_ProcessScript(play, csCtx, script);
+        return;
+    }
+
+    if ((csCtx->curFrame > (u16)cache->csFrameCount) && (play->transitionTrigger != TRANS_TRIGGER_START) &&
+        (csCtx->state != CS_STATE_RUN_UNSTOPPABLE)) {
+        csCtx->state = CS_STATE_STOP;
+        return;
+    }
+
+    curFrame = csCtx->curFrame;
+    Cutscene_UpdateActiveCmds(cache, curFrame);
+
+    for (i = 0; i < cache->numActive; i++) {
+        index = cache->active[i];
+        Cutscene_RunCachedCmd(play, csCtx, &cache->entries[index]);
+
+        if (csCtx->curFrame != curFrame) {
+            for (index++; index < cache->numEntries; index++) {
+                CsScriptEntry* entry = &cache->entries[index];
+
+                if ((entry->firstFrame <= csCtx->curFrame) && (csCtx->curFrame <= entry->lastFrame)) {
+                    Cutscene_RunCachedCmd(play, csCtx, entry);
+                }
+            }
+            break;
+        }
+    }
+}
+#endif
+
 /* End of command handling section */
 
 void CutsceneHandler_RunScript(PlayState* play, CutsceneContext* csCtx) {
     if (gSaveContext.save.cutsceneIndex >= 0xFFF0) {
         csCtx->curFrame++;
+#if CUTSCENE_SCRIPT_CACHE
+        Cutscene_ProcessCachedScript(play, csCtx, (u8*)play->csCtx.script);
+#else
         Cutscene_ProcessScript(play, csCtx, (u8*)play->csCtx.script);
+#endif
     }
 }
 
@@ -1501,6 +1951,9 @@ void Cutscene_SetupScripted(PlayState* play, CutsceneContext* csCtx) {
             Audio_SetCutsceneFlag(true);
 
             csCtx->curFrame = 0xFFFF;
+#if CUTSCENE_SCRIPT_CACHE
+            Cutscene_ClearScriptCache();
+#endif
 
             csCtx->subCamId = CutsceneManager_GetCurrentSubCamId(CS_ID_GLOBAL_END);
             CutsceneCamera_Init(Play_GetCamera(play, csCtx->subCamId), &sCutsceneCameraInfo);
@@ -647,6 +647,240 @@ void EffectBlure_DrawElemHermiteInterpolation(EffectBlure* this, EffectBlureElem
     CLOSE_DISPS(gfxCtx);
 }
 
+#if BLURE_BATCH
+/**
+ * `EffectBlure_DrawSmooth` builds the whole blur as one strip of vertex pairs (a point of the p1 curve and one of the
+ * p2 curve), each segment between two elements starting with the last pair of the previous one. A segment is cut
+ * into as many quads as its length on screen needs, at most `BLURE_SUBDIVISIONS_MAX` as the hermite segments always
+ * were, so a trail far away or seen edge on costs less than one crossing the screen. The strip is loaded
+ * `BLURE_LOAD_PAIRS` pairs at a time, each load starting with the last pair of the previous one.
+ */
+#define BLURE_SUBDIVISIONS_MAX 7
+#define BLURE_SUBDIVISION_LENGTH 12.0f // screen pixels covered by one quad of a hermite segment
+#define BLURE_LOAD_PAIRS 16            // 32 vertices, as many as one gSPVertex loads
+#define BLURE_PAIRS_MAX (ARRAY_COUNT(((EffectBlure*)NULL)->elements) * (BLURE_SUBDIVISIONS_MAX + 1))
+
+typedef struct {
+    Vec3f pos1;
+    Vec3f pos2;
+    Color_RGBA8 color1;
+    Color_RGBA8 color2;
+    Vec3f screen1; // only x and y are set
+    Vec3f screen2;
+    s32 onScreen; // false if a point is behind the camera
+} EffectBlurePoint;
+
+// Hermite basis of t = k / n, by [n - 1][k - 1]: 2t^3 - 3t^2 + 1, 3t^2 - 2t^3, t^3 - 2t^2 + t, t^3 - t^2
+static f32 sBlureHermiteBasis[BLURE_SUBDIVISIONS_MAX][BLURE_SUBDIVISIONS_MAX][4];
+static s32 sBlureHermiteBasisSet = false;
+
+static void EffectBlure_InitHermiteBasis(void) {
+    s32 n;
+    s32 k;
+
+    for (n = 1; n <= BLURE_SUBDIVISIONS_MAX; n++) {
+        for (k = 1; k <= n; k++) {
+            f32 t = (f32)k / n;
+            f32 t2 = SQ(t);
+            f32 t3 = t2 * t;
+            f32* basis = sBlureHermiteBasis[n - 1][k - 1];
+
+            basis[0] = 2.0f * t3 - t2 * 3.0f + 1.0f;
+            basis[1] = t2 * 3.0f - 2.0f * t3;
+            basis[2] = t3 - 2.0f * t2 + t;
+            basis[3] = t3 - t2;
+        }
+    }
+
+    sBlureHermiteBasisSet = true;
+}
+
+static s32 EffectBlure_ProjectPoint(PlayState* play, Vec3f* pos, Vec3f* screen) {
+    Vec3f clip;
+    f32 w;
+
+    SkinMatrix_Vec3fMtxFMultXYZW(&play->viewProjectionMtxF, pos, &clip, &w);
+    if (w < 1.0f) {
+        return false;
+    }
+
+    screen->x = clip.x / w * (SCREEN_WIDTH / 2);
+    screen->y = clip.y / w * (SCREEN_HEIGHT / 2);
+    return true;
+}
+
+static void EffectBlure_GetPoint(EffectBlure* this, PlayState* play, s32 index, EffectBlurePoint* point) {
+    Vec3s vec1;
+    Vec3s vec2;
+
+    EffectBlure_GetComputedValues(this, index, (f32)this->elements[index].timer / (f32)this->elemDuration, &vec1,
+                                  &vec2, &point->color1, &point->color2);
+    Math_Vec3s_ToVec3f(&point->pos1, &vec1);
+    Math_Vec3s_ToVec3f(&point->pos2, &vec2);
+    point->onScreen = EffectBlure_ProjectPoint(play, &point->pos1, &point->screen1) &&
+                      EffectBlure_ProjectPoint(play, &point->pos2, &point->screen2);
+}
+
+// Quads a segment is cut into, from the longer of its two edges on screen
+static s32 EffectBlure_GetSubdivisions(EffectBlurePoint* start, EffectBlurePoint* end) {
+    f32 length1;
+    f32 length2;
+    s32 count;
+
+    if (!start->onScreen || !end->onScreen) {
+        return BLURE_SUBDIVISIONS_MAX;
+    }
+
+    length1 = sqrtf(SQ(end->screen1.x - start->screen1.x) + SQ(end->screen1.y - start->screen1.y));
+    length2 = sqrtf(SQ(end->screen2.x - start->screen2.x) + SQ(end->screen2.y - start->screen2.y));
+    count = (s32)(MAX(length1, length2) / BLURE_SUBDIVISION_LENGTH) + 1;
+
+    return CLAMP(count, 1, BLURE_SUBDIVISIONS_MAX);
+}
+
+static void EffectBlure_SetVtx(Vtx* vtx, Vec3f* pos, Vec3f* origin, Color_RGBA8* color) {
+    static Vtx_t sBaseVtx = VTX_T(0, 0, 0, 0, 0, 255, 255, 255, 255);
+
+    vtx->v = sBaseVtx;
+    vtx->v.ob[0] = Math_FNearbyIntF((pos->x - origin->x) * 10.0f);
+    vtx->v.ob[1] = Math_FNearbyIntF((pos->y - origin->y) * 10.0f);
+    vtx->v.ob[2] = Math_FNearbyIntF((pos->z - origin->z) * 10.0f);
+    vtx->v.cn[0] = color->r;
+    vtx->v.cn[1] = color->g;
+    vtx->v.cn[2] = color->b;
+    vtx->v.cn[3] = color->a;
+}
+
+static void EffectBlure_SetPair(Vtx* vtx, EffectBlurePoint* point, Vec3f* origin) {
+    EffectBlure_SetVtx(&vtx[0], &point->pos1, origin, &point->color1);
+    EffectBlure_SetVtx(&vtx[1], &point->pos2, origin, &point->color2);
+}
+
+// Tangent of both curves at the start of segment `index` if `atEnd` is false, at its end otherwise
+static void EffectBlure_GetTangents(EffectBlure* this, EffectBlurePoint* points, s32 index, s32 atEnd, Vec3f* m1,
+                                    Vec3f* m2) {
+    EffectBlurePoint* from;
+    EffectBlurePoint* to;
+
+    if ((this->elements[index + atEnd].flags & (EFFECT_BLURE_ELEMENT_FLAG_1 | EFFECT_BLURE_ELEMENT_FLAG_2)) ==
+        EFFECT_BLURE_ELEMENT_FLAG_2) {
+        from = &points[index];
+        to = &points[index + 1];
+    } else {
+        from = &points[index + atEnd - 1];
+        to = &points[index + atEnd + 1];
+    }
+
+    Math_Vec3f_Diff(&to->pos1, &from->pos1, m1);
+    Math_Vec3f_Diff(&to->pos2, &from->pos2, m2);
+    Math_Vec3f_Scale(m1, 0.5f);
+    Math_Vec3f_Scale(m2, 0.5f);
+}
+
+static void EffectBlure_DrawSmoothBatch(EffectBlure* this, GraphicsContext* gfxCtx) {
+    PlayState* play = Effect_GetPlayState();
+    EffectBlurePoint points[ARRAY_COUNT(this->elements)];
+    u8 joined[BLURE_PAIRS_MAX]; // whether a quad links a pair to the previous one
+    Vec3f origin;
+    Vtx* vtx;
+    s32 pairCount;
+    s32 i;
+    s32 k;
+
+    vtx = GRAPH_ALLOC(gfxCtx, BLURE_PAIRS_MAX * 2 * sizeof(Vtx));
+    if (vtx == NULL) {
+        return;
+    }
+
+    if (!sBlureHermiteBasisSet) {
+        EffectBlure_InitHermiteBasis();
+    }
+
+    for (i = 0; i < this->numElements; i++) {
+        EffectBlure_GetPoint(this, play, i, &points[i]);
+    }
+
+    Math_Vec3s_ToVec3f(&origin, &this->elements[0].p2);
+    pairCount = 0;
+
+    for (i = 0; i < this->numElements - 1; i++) {
+        EffectBlureElement* elem = &this->elements[i];
+        EffectBlurePoint* from = &points[i];
+        EffectBlurePoint* to = &points[i + 1];
+        Vec3f m1Start;
+        Vec3f m2Start;
+        Vec3f m1End;
+        Vec3f m2End;
+        s32 count;
+
+        if ((elem->state == 0) || ((elem + 1)->state == 0)) {
+            continue;
+        }
+
+        // The previous segment ended with this one's first pair unless it was skipped
+        if ((i == 0) || ((elem - 1)->state == 0)) {
+            EffectBlure_SetPair(&vtx[2 * pairCount], from, &origin);
+            joined[pairCount++] = false;
+        }
+
+        if (((elem->flags | (elem + 1)->flags) & EFFECT_BLURE_ELEMENT_FLAG_1) == 0) {
+            // Neither end has the curve flag, see EffectBlure_DrawElemNoInterpolation
+            EffectBlure_SetPair(&vtx[2 * pairCount], to, &origin);
+            joined[pairCount++] = true;
+            continue;
+        }
+
+        count = EffectBlure_GetSubdivisions(from, to);
+        EffectBlure_GetTangents(this, points, i, false, &m1Start, &m2Start);
+        EffectBlure_GetTangents(this, points, i, true, &m1End, &m2End);
+
+        for (k = 1; k <= count; k++) {
+            f32* basis = sBlureHermiteBasis[count - 1][k - 1];
+            f32 t = (f32)k / count;
+            EffectBlurePoint point;
+
+            // p = (2t^3 - 3t^2 + 1)p0 + (3t^2 - 2t^3)p1 + (t^3 - 2t^2 + t)m0 + (t^3 - t^2)m1
+            point.pos1.x = basis[0] * from->pos1.x + basis[1] * to->pos1.x + basis[2] * m1Start.x + basis[3] * m1End.x;
+            point.pos1.y = basis[0] * from->pos1.y + basis[1] * to->pos1.y + basis[2] * m1Start.y + basis[3] * m1End.y;
+            point.pos1.z = basis[0] * from->pos1.z + basis[1] * to->pos1.z + basis[2] * m1Start.z + basis[3] * m1End.z;
+            point.pos2.x = basis[0] * from->pos2.x + basis[1] * to->pos2.x + basis[2] * m2Start.x + basis[3] * m2End.x;
+            point.pos2.y = basis[0] * from->pos2.y + basis[1] * to->pos2.y + basis[2] * m2Start.y + basis[3] * m2End.y;
+            point.pos2.z = basis[0] * from->pos2.z + basis[1] * to->pos2.z + basis[2] * m2Start.z + basis[3] * m2End.z;
+
+            point.color1.r = EffectSs_LerpU8(from->color1.r, to->color1.r, t);
+            point.color1.g = EffectSs_LerpU8(from->color1.g, to->color1.g, t);
+            point.color1.b = EffectSs_LerpU8(from->color1.b, to->color1.b, t);
+            point.color1.a = EffectSs_LerpU8(from->color1.a, to->color1.a, t);
+            point.color2.r = EffectSs_LerpU8(from->color2.r, to->color2.r, t);
+            point.color2.g = EffectSs_LerpU8(from->color2.g, to->color2.g, t);
+            point.color2.b = EffectSs_LerpU8(from->color2.b, to->color2.b, t);
+            point.color2.a = EffectSs_LerpU8(from->color2.a, to->color2.a, t);
+
+            EffectBlure_SetPair(&vtx[2 * pairCount], &point, &origin);
+            joined[pairCount++] = true;
+        }
+    }
+
+    OPEN_DISPS(gfxCtx);
+
+    // Each load but the first starts with the last pair of the previous one, for the quad that links them
+    for (i = 0; i < pairCount - 1; i += BLURE_LOAD_PAIRS - 1) {
+        s32 loadCount = MIN(pairCount - i, BLURE_LOAD_PAIRS);
+
+        gSPVertex(POLY_XLU_DISP++, &vtx[2 * i], 2 * loadCount, 0);
+        for (k = 1; k < loadCount; k++) {
+            if (joined[i + k]) {
+                s32 v = 2 * (k - 1);
+
+                gSP2Triangles(POLY_XLU_DISP++, v, v + 1, v + 3, 0, v, v + 3, v + 2, 0);
+            }
+        }
+    }
+
+    CLOSE_DISPS(gfxCtx);
+}
+#endif
+
 void EffectBlure_DrawSmooth(EffectBlure* this2, GraphicsContext* gfxCtx) {
     EffectBlure* this = this2;
     EffectBlureElement* elem;
@@ -686,6 +920,9 @@ void EffectBlure_DrawSmooth(EffectBlure* this2, GraphicsContext* gfxCtx) {
 
     gSPMatrix(POLY_XLU_DISP++, mtx, G_MTX_NOPUSH | G_MTX_LOAD | G_MTX_MODELVIEW);
 
+#if BLURE_BATCH
+    EffectBlure_DrawSmoothBatch(this, gfxCtx);
+#else
     for (i = 0, elem = &this->elements[0]; elem < this->elements + this->numElements - 1; i++, elem++) {
         if ((elem->state == 0) || ((elem + 1)->state == 0)) {
             continue;
@@ -707,6 +944,7 @@ void EffectBlure_DrawSmooth(EffectBlure* this2, GraphicsContext* gfxCtx) {
             EffectBlure_DrawElemHermiteInterpolation(this, elem, i, gfxCtx);
         }
     }
+#endif
 
     CLOSE_DISPS(gfxCtx);
 }
@@ -752,9 +990,40 @@ SetupHandler sSetupHandlers[EFF_BLURE_DRAW_MODE_MAX] = {
     NULL,                       // EFF_BLURE_DRAW_MODE_SMOOTH
 };
 
+#if BLURE_BATCH
+// Nothing changes between the quads, so they are loaded as many at a time as gSPVertex can
+static void EffectBlure_DrawSimpleBatch(GraphicsContext* gfxCtx, EffectBlure* this, Vtx* vtx) {
+    s32 i;
+    s32 j;
+
+    OPEN_DISPS(gfxCtx);
+
+    sSetupHandlers[this->drawMode](gfxCtx, this, vtx);
+    gDPPipeSync(POLY_XLU_DISP++);
+
+    for (i = 0; i < this->numElements - 1; i += BLURE_LOAD_PAIRS / 2) {
+        s32 quadCount = MIN(this->numElements - 1 - i, BLURE_LOAD_PAIRS / 2);
+
+        gSPVertex(POLY_XLU_DISP++, &vtx[4 * i], 4 * quadCount, 0);
+        for (j = 0; j < 4 * quadCount; j += 4) {
+            gSP2Triangles(POLY_XLU_DISP++, j, j + 1, j + 3, 0, j, j + 3, j + 2, 0);
+        }
+    }
+
+    CLOSE_DISPS(gfxCtx);
+}
+#endif
+
 void EffectBlure_DrawSimpleVertices(GraphicsContext* gfxCtx, EffectBlure* this, Vtx* vtx) {
     Mtx* mtx;
 
+#if BLURE_BATCH
+    if ((this->drawMode != EFF_BLURE_DRAW_MODE_SIMPLE_ALT_COLORS) && !(this->flags & EFFECT_BLURE_FLAG_4)) {
+        EffectBlure_DrawSimpleBatch(gfxCtx, this, vtx);
+        return;
+    }
+#endif
+
     OPEN_DISPS(gfxCtx);
 
     sSetupHandlers[this->drawMode](gfxCtx, this, vtx);
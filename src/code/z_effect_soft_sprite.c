@@ -9,6 +9,20 @@ void EffectSs_Reset(EffectSs* effectSs);
 
 EffectSsInfo sEffectSsInfo = { NULL, 0, 0 };
 
+#if EFFECT_SS_BATCH
+/**
+ * `EffectSs_DrawAll` draws the live effects type after type, so that consecutive effects set up with the same
+ * material only emit it once, see `EffectSs_NeedsSetup`.
+ */
+typedef struct EffectSsDrawBatch {
+    /* 0x0 */ s16* order;                // table indices in drawing order, `tableSize` long
+    /* 0x4 */ EffectSsDrawFunc setupDraw; // draw function of the effect that last set up its material, or NULL
+    /* 0x8 */ void* setupGfx;             // that effect's display list
+} EffectSsDrawBatch; // size = 0xC
+
+EffectSsDrawBatch sEffectSsDrawBatch;
+#endif
+
 void EffectSs_InitInfo(PlayState* play, s32 tableSize) {
     u32 i;
     EffectSs* effectSs;
@@ -17,6 +31,9 @@ void EffectSs_InitInfo(PlayState* play, s32 tableSize) {
     sEffectSsInfo.table = (EffectSs*)THA_AllocTailAlign16(&play->state.tha, tableSize * sizeof(EffectSs));
     sEffectSsInfo.searchStartIndex = 0;
     sEffectSsInfo.tableSize = tableSize;
+#if EFFECT_SS_BATCH
+    sEffectSsDrawBatch.order = THA_AllocTailAlign16(&play->state.tha, tableSize * sizeof(s16));
+#endif
 
     for (effectSs = &sEffectSsInfo.table[0]; effectSs < &sEffectSsInfo.table[sEffectSsInfo.tableSize]; effectSs++) {
         EffectSs_Reset(effectSs);
@@ -38,6 +55,9 @@ void EffectSs_ClearAll(PlayState* play) {
     sEffectSsInfo.table = NULL;
     sEffectSsInfo.searchStartIndex = 0;
     sEffectSsInfo.tableSize = 0;
+#if EFFECT_SS_BATCH
+    sEffectSsDrawBatch.order = NULL;
+#endif
 
     //! @bug: Effects left in the table are not properly deleted, as dataTable was just set to NULL and size to 0
     for (effectSs = &sEffectSsInfo.table[0]; effectSs < &sEffectSsInfo.table[sEffectSsInfo.tableSize]; effectSs++) {
@@ -257,6 +277,121 @@ void EffectSs_Draw(PlayState* play, s32 index) {
     }
 }
 
+#if EFFECT_SS_BATCH
+static s32 EffectSs_IsOutOfBounds(EffectSs* effectSs) {
+    return (effectSs->pos.x > BGCHECK_Y_MAX) || (effectSs->pos.x < BGCHECK_Y_MIN) ||
+           (effectSs->pos.y > BGCHECK_Y_MAX) || (effectSs->pos.y < BGCHECK_Y_MIN) ||
+           (effectSs->pos.z > BGCHECK_Y_MAX) || (effectSs->pos.z < BGCHECK_Y_MIN);
+}
+
+/**
+ * Draws the live effects grouped by type, in table order within a type. Effects outside of the bgcheck range are
+ * deleted first, like the unbatched loop does when it reaches them.
+ */
+void EffectSs_DrawAll(PlayState* play) {
+    Lights* lights = LightContext_NewLights(&play->lightCtx, play->state.gfxCtx);
+    s16* order = sEffectSsDrawBatch.order;
+    s32 typeStart[EFFECT_SS_TYPE_MAX + 2];
+    EffectSs* effectSs;
+    s32 count;
+    s32 i;
+
+    Lights_BindAll(lights, play->lightCtx.listHead, NULL, play);
+    Lights_Draw(lights, play->state.gfxCtx);
+
+    // Count the live effects of every type, effects with an unset type go last
+    bzero(typeStart, sizeof(typeStart));
+    for (i = 0; i < sEffectSsInfo.tableSize; i++) {
+        effectSs = &sEffectSsInfo.table[i];
+
+        if (effectSs->life > -1) {
+            if (EffectSs_IsOutOfBounds(effectSs)) {
+                EffectSs_Delete(effectSs);
+            } else {
+                typeStart[CLAMP_MAX(effectSs->type, EFFECT_SS_TYPE_MAX) + 1]++;
+            }
+        }
+    }
+
+    for (i = 1; i < ARRAY_COUNT(typeStart); i++) {
+        typeStart[i] += typeStart[i - 1];
+    }
+    count = typeStart[ARRAY_COUNT(typeStart) - 1];
+
+    for (i = 0; i < sEffectSsInfo.tableSize; i++) {
+        effectSs = &sEffectSsInfo.table[i];
+
+        if (effectSs->life > -1) {
+            order[typeStart[CLAMP_MAX(effectSs->type, EFFECT_SS_TYPE_MAX)]++] = i;
+        }
+    }
+
+    sEffectSsDrawBatch.setupDraw = NULL;
+    for (i = 0; i < count; i++) {
+        effectSs = &sEffectSsInfo.table[order[i]];
+
+        // Whatever another draw function emitted may have changed the material
+        if (effectSs->draw != sEffectSsDrawBatch.setupDraw) {
+            sEffectSsDrawBatch.setupDraw = NULL;
+        }
+        EffectSs_Draw(play, order[i]);
+    }
+}
+
+/**
+ * Returns whether a batched draw has to emit its setup DL. It doesn't when the effect drawn right before it has the
+ * same draw function and display list and already did.
+ */
+s32 EffectSs_NeedsSetup(EffectSs* this) {
+    if ((sEffectSsDrawBatch.setupDraw == this->draw) && (sEffectSsDrawBatch.setupGfx == this->gfx)) {
+        return false;
+    }
+
+    sEffectSsDrawBatch.setupDraw = this->draw;
+    sEffectSsDrawBatch.setupGfx = this->gfx;
+    return true;
+}
+
+/**
+ * Builds the matrix of a billboarded sprite at `pos`, rotated around the view axis by the angle of `sinZ` and `cosZ`
+ * and scaled, into a new Mtx. This is `Translate(pos) * play->billboardMtxF * RotateZ * Scale` as the unbatched
+ * draws compute it with SkinMatrix_MtxFMtxFMult, without multiplying out the zeros of the three sparse factors, so
+ * the result is the same.
+ */
+Mtx* EffectSs_NewBillboardMtx(PlayState* play, Vec3f* pos, f32 sinZ, f32 cosZ, f32 scaleX, f32 scaleY,
+                              f32 scaleZ) {
+    MtxF* bb = &play->billboardMtxF;
+    MtxF mf;
+    f32 x0 = bb->xx + pos->x * bb->wx;
+    f32 y0 = bb->yx + pos->y * bb->wx;
+    f32 z0 = bb->zx + pos->z * bb->wx;
+    f32 x1 = bb->xy + pos->x * bb->wy;
+    f32 y1 = bb->yy + pos->y * bb->wy;
+    f32 z1 = bb->zy + pos->z * bb->wy;
+
+    mf.xx = (x0 * cosZ + x1 * sinZ) * scaleX;
+    mf.yx = (y0 * cosZ + y1 * sinZ) * scaleX;
+    mf.zx = (z0 * cosZ + z1 * sinZ) * scaleX;
+    mf.wx = (bb->wx * cosZ + bb->wy * sinZ) * scaleX;
+
+    mf.xy = (x1 * cosZ - x0 * sinZ) * scaleY;
+    mf.yy = (y1 * cosZ - y0 * sinZ) * scaleY;
+    mf.zy = (z1 * cosZ - z0 * sinZ) * scaleY;
+    mf.wy = (bb->wy * cosZ - bb->wx * sinZ) * scaleY;
+
+    mf.xz = (bb->xz + pos->x * bb->wz) * scaleZ;
+    mf.yz = (bb->yz + pos->y * bb->wz) * scaleZ;
+    mf.zz = (bb->zz + pos->z * bb->wz) * scaleZ;
+    mf.wz = bb->wz * scaleZ;
+
+    mf.xw = bb->xw + pos->x * bb->ww;
+    mf.yw = bb->yw + pos->y * bb->ww;
+    mf.zw = bb->zw + pos->z * bb->ww;
+    mf.ww = bb->ww;
+
+    return SkinMatrix_MtxFToNewMtx(play->state.gfxCtx, &mf);
+}
+#else
 void EffectSs_DrawAll(PlayState* play) {
     Lights* lights = LightContext_NewLights(&play->lightCtx, play->state.gfxCtx);
     s32 i;
@@ -277,6 +412,8 @@ void EffectSs_DrawAll(PlayState* play) {
     }
 }
 
+#endif
+
 /**
  * Lerp from `a` (weightInv == inf) to `b` (weightInv == 1 or 0).
  */
@@ -2,9 +2,18 @@
 #include "segment_symbols.h"
 
 // Profile and linker symbol declarations (used in the table below)
+#if OVERLAY_PAGING
+// The Nspire port's paged overlays aren't linked in, their profiles come from its asset pack
+#define OVERLAY_PROFILE __attribute__((weak))
+
+#define DEFINE_EFFECT_SS(name, _enumValue)                 \
+    extern EffectSsProfile name##_Profile OVERLAY_PROFILE; \
+    DECLARE_OVERLAY_SEGMENT(name)
+#else
 #define DEFINE_EFFECT_SS(name, _enumValue) \
     extern EffectSsProfile name##_Profile; \
     DECLARE_OVERLAY_SEGMENT(name)
+#endif
 
 #define DEFINE_EFFECT_SS_UNSET(_enumValue)
 
@@ -69,6 +69,16 @@ static s32 sBssPad;
 u8 sNextCutsceneList[16];
 static s32 sBssPad2;
 
+#if CUTSCENE_QUEUE_MASK
+/**
+ * Bit i is set while byte i of `sWaitingCutsceneList`, or of `sNextCutsceneList`, may have a cutscene in it. Most frames
+ * have none queued, `CutsceneManager_Update` then skips its scans of both lists at once, and the scans that are left
+ * only visit the bytes that have cutscenes in them.
+ */
+static u16 sWaitingCutsceneMask = 0;
+static u16 sNextCutsceneMask = 0;
+#endif
+
 s16 CutsceneManager_SetHudVisibility(s16 csHudVisibility) {
     u16 hudVisibility;
 
@@ -134,6 +144,10 @@ void CutsceneManager_Init(PlayState* play, CutsceneEntry* cutsceneList, s16 numE
         sWaitingCutsceneList[i] = 0;
         sNextCutsceneList[i] = 0;
     }
+#if CUTSCENE_QUEUE_MASK
+    sWaitingCutsceneMask = 0;
+    sNextCutsceneMask = 0;
+#endif
 
     sCutsceneMgr.endCsId = CS_ID_NONE;
     sCutsceneMgr.play = play;
@@ -159,6 +173,13 @@ void CutsceneManager_StoreCamera(Camera* camera) {
 void CutsceneManager_ClearWaiting(void) {
     s32 i;
 
+#if CUTSCENE_QUEUE_MASK
+    if (sWaitingCutsceneMask == 0) {
+        return;
+    }
+    sWaitingCutsceneMask = 0;
+#endif
+
     for (i = 0; i < ARRAY_COUNT(sWaitingCutsceneList); i++) {
         sWaitingCutsceneList[i] = 0;
     }
@@ -167,6 +188,13 @@ void CutsceneManager_ClearWaiting(void) {
 void CutsceneManager_ClearNextCutscenes(void) {
     s32 i;
 
+#if CUTSCENE_QUEUE_MASK
+    if (sNextCutsceneMask == 0) {
+        return;
+    }
+    sNextCutsceneMask = 0;
+#endif
+
     for (i = 0; i < ARRAY_COUNT(sNextCutsceneList); i++) {
         sNextCutsceneList[i] = 0;
     }
@@ -181,7 +209,39 @@ s16 CutsceneManager_MarkNextCutscenes(void) {
     s16 priorityMax = SHRT_MAX; // lower number means higher priority
     s16 csId;
     s16 priority;
+#if CUTSCENE_QUEUE_MASK
+    u32 rows;
+    u32 waiting;
+#endif
+
+#if CUTSCENE_QUEUE_MASK
+    // The same cutscenes in the same order as the scan below, only skipping the bytes and bits that are clear
+    for (i = 0, rows = sWaitingCutsceneMask; rows != 0; i++, rows >>= 1) {
+        if (!(rows & 1)) {
+            continue;
+        }
+        for (bit = 1, j = 0, waiting = sWaitingCutsceneList[i]; waiting != 0; j++, waiting >>= 1) {
+            if (waiting & 1) {
+                csId = (i << 3) | j;
+                priority = CutsceneManager_GetCutsceneEntryImpl(csId)->priority;
 
+                if ((priority ^ 0) == -1) {
+                    sNextCutsceneList[i] |= bit;
+                    sNextCutsceneMask |= 1 << i;
+                } else if ((priority < priorityMax) && (priority > 0)) {
+                    csIdMax = csId;
+                    priorityMax = priority;
+                }
+                count++;
+            }
+            bit <<= 1;
+        }
+    }
+    if (csIdMax != CS_ID_NONE) {
+        sNextCutsceneList[csIdMax >> 3] |= 1 << (csIdMax & 7);
+        sNextCutsceneMask |= 1 << (csIdMax >> 3);
+    }
+#else
     for (i = 0; i < ARRAY_COUNT(sNextCutsceneList); i++) {
         for (bit = 1, j = 0; j < 8; j++) {
             if (sWaitingCutsceneList[i] & bit) {
@@ -202,6 +262,7 @@ s16 CutsceneManager_MarkNextCutscenes(void) {
     if (csIdMax != CS_ID_NONE) {
         sNextCutsceneList[csIdMax >> 3] |= 1 << (csIdMax & 7);
     }
+#endif
     return count;
 }
 
@@ -325,6 +386,9 @@ s16 CutsceneManager_Update(void) {
 void CutsceneManager_Queue(s16 csId) {
     if (csId > CS_ID_NONE) {
         sWaitingCutsceneList[csId >> 3] |= 1 << (csId & 7);
+#if CUTSCENE_QUEUE_MASK
+        sWaitingCutsceneMask |= 1 << (csId >> 3);
+#endif
     }
 }
 
@@ -135,6 +135,52 @@ void TransitionCircle_LoadAndSetTexture(Gfx** gfxP, void const* texture, s32 fmt
     *gfxP = gfx;
 }
 
+#if TRANSITION_FILL
+/**
+ * Draws what TransitionCircle_Draw's combiner and TransitionCircle_LoadAndSetTexture would, as a G_NSP_FILL the
+ * renderer runs over the color buffer instead of a full screen texrect, see transition_nsp.c
+ */
+void TransitionCircle_FillMask(Gfx** gfxP, TransitionCircle* this) {
+    Gfx* gfx = *gfxP;
+    s32 width = 1 << this->masks;
+    s32 height = 1 << this->maskt;
+    f32 s;
+    f32 t;
+    s32 dtdy;
+    s32 dsdx;
+
+    s = ((1.0f - (1.0f / this->referenceRadius)) * (SCREEN_WIDTH / 2)) + 70.0f;
+    t = ((1.0f - (1.0f / this->referenceRadius)) * (SCREEN_HEIGHT / 2)) + 50.0f;
+
+    if (s < -1023.0f) {
+        s = -1023.0f;
+    }
+    if (t < -1023.0f) {
+        t = -1023.0f;
+    }
+
+    if ((s <= -1023.0f) || (t <= -1023.0f)) {
+        dsdx = 0;
+        dtdy = 0;
+    } else {
+        dsdx = ((SCREEN_WIDTH - (2.0f * s)) / gScreenWidth) * (1 << 10);
+        dtdy = ((SCREEN_HEIGHT - (2.0f * t)) / gScreenHeight) * (1 << 10);
+    }
+
+    // s and t as the texrect takes them, in 1/1024ths of a texel from the tile's origin
+    gNspFillMask(gfx++, (this->maskType != 0) ? G_NSP_FILL_INVERT : 0, this->masks, this->maskt,
+                 (this->color.r << 24) | (this->color.g << 16) | (this->color.b << 8) | this->color.a,
+                 (s32)(s * (1 << 5)) * (1 << 5) - ((SCREEN_WIDTH / 2) - width) * (1 << 10),
+                 (s32)(t * (1 << 5)) * (1 << 5) - ((SCREEN_HEIGHT / 2) - height) * (1 << 10), dsdx, dtdy,
+                 this->texture);
+
+    *gfxP = gfx;
+}
+
+void TransitionCircle_Draw(void* thisx, Gfx** gfxP) {
+    TransitionCircle_FillMask(gfxP, (TransitionCircle*)thisx);
+}
+#else
 void TransitionCircle_Draw(void* thisx, Gfx** gfxP) {
     Gfx* gfx = *gfxP;
     TransitionCircle* this = (TransitionCircle*)thisx;
@@ -155,6 +201,7 @@ void TransitionCircle_Draw(void* thisx, Gfx** gfxP) {
 
     *gfxP = gfx;
 }
+#endif
 
 s32 TransitionCircle_IsDone(void* thisx) {
     TransitionCircle* this = (TransitionCircle*)thisx;
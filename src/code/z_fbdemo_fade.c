@@ -118,9 +118,14 @@ void TransitionFade_Draw(void* thisx, Gfx** gfxP) {
 
     if (color->a != 0) {
         gfx = *gfxP;
+#if TRANSITION_FILL
+        // blended over the color buffer by the renderer, see transition_nsp.c
+        gNspFillBlend(gfx++, (color->r << 24) | (color->g << 16) | (color->b << 8) | color->a);
+#else
         gSPDisplayList(gfx++, sTransFadeSetupDL);
         gDPSetPrimColor(gfx++, 0, 0, color->r, color->g, color->b, color->a);
         gSPDisplayList(gfx++, D_0E000000.fillRect);
+#endif
         *gfxP = gfx;
     }
 }
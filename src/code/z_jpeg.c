@@ -18,6 +18,203 @@
 #define MARKER_COM 0xFE
 #define MARKER_EOI 0xD9
 
+#if JPEG_CPU_IDCT
+/**
+ * The AAN scale factors of the inverse DCT in 1.14 fixed point, in natural order. They are folded into the
+ * dequantization multipliers, which leaves the IDCT 5 multiplications per row and column.
+ */
+static const u16 sJpegAanScales[8 * 8] = {
+    16384, 22725, 21407, 19266, 16384, 12873, 8867,  4520,  //
+    22725, 31521, 29692, 26722, 22725, 17855, 12299, 6270,  //
+    21407, 29692, 27969, 25172, 21407, 16819, 11585, 5906,  //
+    19266, 26722, 25172, 22654, 19266, 15137, 10426, 5315,  //
+    16384, 22725, 21407, 19266, 16384, 12873, 8867,  4520,  //
+    12873, 17855, 16819, 15137, 12873, 10114, 6967,  3552,  //
+    8867,  12299, 11585, 10426, 8867,  6967,  4799,  2446,  //
+    4520,  6270,  5906,  5315,  4520,  3552,  2446,  1247,  //
+};
+
+/**
+ * Natural order index of each coefficient, the quantization tables and the decoded blocks are in zigzag order.
+ */
+static const u8 sJpegZigzag[8 * 8] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,  12, 19, 26, 33, 40, 48,
+    41, 34, 27, 20, 13, 6,  7,  14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23,
+    30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+// Fractional bits the first pass keeps
+#define JPEG_IDCT_PASS1_BITS 2
+// Fractional bits the dequantization multipliers keep
+#define JPEG_IDCT_MUL_BITS 8
+
+#define JPEG_IDCT_MUL(v, c) (((v) * (c)) >> 8)
+#define JPEG_IDCT_FIX_1_082392200 277
+#define JPEG_IDCT_FIX_1_414213562 362
+#define JPEG_IDCT_FIX_1_847759065 473
+#define JPEG_IDCT_FIX_2_613125930 669
+
+/**
+ * Builds the dequantization multipliers of a quantization table, with the AAN scale factors and
+ * JPEG_IDCT_PASS1_BITS folded in, in natural order. They keep JPEG_IDCT_MUL_BITS more fractional bits, the
+ * smallest scale factors are below 1 and would round the highest frequencies away at low quantizers.
+ */
+static void Jpeg_ScaleQuantizationTable(JpegQuantizationTable* qTable, s32* mul) {
+    s32 i;
+
+    for (i = 0; i < 8 * 8; i++) {
+        s32 n = sJpegZigzag[i];
+
+        mul[n] = ((s32)qTable->table[i] * sJpegAanScales[n] + (1 << (13 - JPEG_IDCT_PASS1_BITS - JPEG_IDCT_MUL_BITS))) >>
+                 (14 - JPEG_IDCT_PASS1_BITS - JPEG_IDCT_MUL_BITS);
+    }
+}
+
+/**
+ * 8-point AAN inverse DCT of v[0], v[stride] ... v[7 * stride], in place.
+ */
+static void Jpeg_Idct8(s32* v, s32 stride) {
+    s32 t0, t1, t2, t3, t4, t5, t6, t7;
+    s32 t10, t11, t12, t13;
+    s32 z5, z10, z11, z12, z13;
+
+    // Even part
+    t10 = v[0] + v[4 * stride];
+    t11 = v[0] - v[4 * stride];
+    t13 = v[2 * stride] + v[6 * stride];
+    t12 = JPEG_IDCT_MUL(v[2 * stride] - v[6 * stride], JPEG_IDCT_FIX_1_414213562) - t13;
+    t0 = t10 + t13;
+    t3 = t10 - t13;
+    t1 = t11 + t12;
+    t2 = t11 - t12;
+
+    // Odd part
+    z13 = v[5 * stride] + v[3 * stride];
+    z10 = v[5 * stride] - v[3 * stride];
+    z11 = v[1 * stride] + v[7 * stride];
+    z12 = v[1 * stride] - v[7 * stride];
+    t7 = z11 + z13;
+    t11 = JPEG_IDCT_MUL(z11 - z13, JPEG_IDCT_FIX_1_414213562);
+    z5 = JPEG_IDCT_MUL(z10 + z12, JPEG_IDCT_FIX_1_847759065);
+    t10 = JPEG_IDCT_MUL(z12, JPEG_IDCT_FIX_1_082392200) - z5;
+    t12 = z5 - JPEG_IDCT_MUL(z10, JPEG_IDCT_FIX_2_613125930);
+    t6 = t12 - t7;
+    t5 = t11 - t6;
+    t4 = t10 + t5;
+
+    v[0 * stride] = t0 + t7;
+    v[7 * stride] = t0 - t7;
+    v[1 * stride] = t1 + t6;
+    v[6 * stride] = t1 - t6;
+    v[2 * stride] = t2 + t5;
+    v[5 * stride] = t2 - t5;
+    v[4 * stride] = t3 + t4;
+    v[3 * stride] = t3 - t4;
+}
+
+/**
+ * Dequantizes and inverse transforms an 8x8 block of coefficients in zigzag order, to samples from -128 to 127.
+ */
+static void Jpeg_IdctBlock(u16* coeffs, s32* mul, s16* out) {
+    s32 ws[8 * 8];
+    s32 i;
+    s32 j;
+
+    for (i = 0; i < 8 * 8; i++) {
+        s32 n = sJpegZigzag[i];
+
+        ws[n] = ((s16)coeffs[i] * mul[n] + (1 << (JPEG_IDCT_MUL_BITS - 1))) >> JPEG_IDCT_MUL_BITS;
+    }
+
+    // Columns, most only have their DC coefficient left after quantization
+    for (i = 0; i < 8; i++) {
+        s32* col = &ws[i];
+
+        if ((col[8] | col[16] | col[24] | col[32] | col[40] | col[48] | col[56]) == 0) {
+            for (j = 8; j < 8 * 8; j += 8) {
+                col[j] = col[0];
+            }
+        } else {
+            Jpeg_Idct8(col, 8);
+        }
+    }
+
+    // Rows, rounded and scaled down by the first pass' bits and the 1/8 of the 2D transform
+    for (i = 0; i < 8 * 8; i += 8) {
+        Jpeg_Idct8(&ws[i], 1);
+
+        for (j = 0; j < 8; j++) {
+            s32 s = (ws[i + j] + (1 << (JPEG_IDCT_PASS1_BITS + 2))) >> (JPEG_IDCT_PASS1_BITS + 3);
+
+            out[i + j] = CLAMP(s, -128, 127);
+        }
+    }
+}
+
+/**
+ * Converts an MCU's Y, Cb and Cr samples to RGBA16 pixels. 4:2:0 MCUs have 4 Y blocks, 16x16 pixels in 2 rows,
+ * 4:2:2 MCUs have 2, 16x8 pixels.
+ */
+static void Jpeg_McuToRgba16(s16 (*blocks)[8 * 8], s32 rows, u16* dst) {
+    s16* cb = blocks[rows / 4];
+    s16* cr = blocks[rows / 4 + 1];
+    s32 y;
+    s32 x;
+
+    for (y = 0; y < rows; y++) {
+        s16* ySamples = &blocks[(y >> 3) * 2][(y & 7) * 8];
+        s32 cRow = ((rows == 16) ? (y >> 1) : y) * 8;
+
+        for (x = 0; x < 16; x++) {
+            s32 l = ySamples[(x >> 3) * 8 * 8 + (x & 7)] + 128;
+            s32 u = cb[cRow + (x >> 1)];
+            s32 v = cr[cRow + (x >> 1)];
+            s32 r = l + ((359 * v) >> 8);
+            s32 g = l - ((88 * u + 183 * v) >> 8);
+            s32 b = l + ((454 * u) >> 8);
+
+            r = CLAMP(r, 0, 255);
+            g = CLAMP(g, 0, 255);
+            b = CLAMP(b, 0, 255);
+            *dst++ = ((r >> 3) << 11) | ((g >> 3) << 6) | ((b >> 3) << 1) | 1;
+        }
+    }
+}
+
+/**
+ * Decodes the MCUs the Huffman decoder left in the work buffer to RGBA16 on the CPU, in place of the njpgdsp
+ * task: dequantization with an integer AAN IDCT, then the color conversion. The image is in `workBuf->data[j]`
+ * after, as the task leaves it.
+ */
+void Jpeg_ScheduleDecoderTask(JpegContext* jpegCtx) {
+    JpegWork* workBuf = jpegCtx->workBuf;
+    s32 mulY[8 * 8];
+    s32 mulU[8 * 8];
+    s32 mulV[8 * 8];
+    s16 blocks[6][8 * 8];
+    s32 yBlocks = (jpegCtx->mode == 0) ? 2 : 4;
+    s32 mcuSize = (yBlocks + 2) * 8 * 8;
+    s32 j;
+    s32 k;
+
+    Jpeg_ScaleQuantizationTable(&workBuf->qTableY, mulY);
+    Jpeg_ScaleQuantizationTable(&workBuf->qTableU, mulU);
+    Jpeg_ScaleQuantizationTable(&workBuf->qTableV, mulV);
+
+    // Backwards, the 4:2:2 MCUs are closer together than the pixels they are converted to
+    for (j = 4 - 1; j >= 0; j--) {
+        u16* mcu = (u16*)workBuf->data + j * mcuSize;
+
+        for (k = 0; k < yBlocks; k++) {
+            Jpeg_IdctBlock(&mcu[k * 8 * 8], mulY, blocks[k]);
+        }
+        Jpeg_IdctBlock(&mcu[k * 8 * 8], mulU, blocks[k]);
+        Jpeg_IdctBlock(&mcu[(k + 1) * 8 * 8], mulV, blocks[k + 1]);
+
+        Jpeg_McuToRgba16(blocks, yBlocks * 4, workBuf->data[j]);
+    }
+}
+#else
 extern u64 njpgdspMainTextStart[];
 extern u64 njpgdspMainDataStart[];
 
@@ -71,6 +268,7 @@ void Jpeg_ScheduleDecoderTask(JpegContext* jpegCtx) {
     Sched_SendNotifyMsg(&gScheduler); // osScKickEntryMsg
     osRecvMesg(&jpegCtx->mq, NULL, OS_MESG_BLOCK);
 }
+#endif
 
 /**
  * Copies a 16x16 block of decoded image data to the Z-buffer.
@@ -1,10 +1,26 @@
 #include "z64font.h"
 
 #include "segment_symbols.h"
+#if MESSAGE_GLYPH_ATLAS
+#include "string.h"
+#endif
 #include "z64message.h"
 
 #include "z64.h"
 
+#if MESSAGE_GLYPH_ATLAS
+/**
+ * Message_DrawTextChar draws the glyphs of the NES font out of these pages rather than the char buffer slots they
+ * were loaded into. A page is loaded the first time one of its glyphs is drawn and kept for the rest of the session,
+ * so a glyph has the same texture in every message and a run of characters on one page needs a single load.
+ */
+static u8 sFontGlyphPages[FONT_GLYPH_PAGES][FONT_GLYPH_PAGE_SIZE] ALIGNED(8);
+static u8 sFontGlyphPageLoaded[FONT_GLYPH_PAGES];
+
+// The glyph in each char buffer slot, FONT_GLYPH_NONE for slots not loaded by Font_LoadCharNES
+static u8 sFontCharGlyphs[2][120];
+#endif
+
 // stubbed in NTSC-U
 void Font_LoadChar(PlayState* play, u16 codePointIndex, s32 offset) {
 }
@@ -16,7 +32,47 @@ void Font_LoadCharNES(PlayState* play, u8 codePointIndex, s32 offset) {
     DmaMgr_RequestSync(&font->charBuf[font->unk_11D88][offset],
                        SEGMENT_ROM_START_OFFSET(nes_font_static, (codePointIndex - ' ') * FONT_CHAR_TEX_SIZE),
                        FONT_CHAR_TEX_SIZE);
+
+#if MESSAGE_GLYPH_ATLAS
+    sFontCharGlyphs[font->unk_11D88][offset / FONT_CHAR_TEX_SIZE] =
+        ((codePointIndex >= ' ') && (codePointIndex - ' ' < FONT_GLYPH_COUNT)) ? codePointIndex - ' '
+                                                                                : FONT_GLYPH_NONE;
+#endif
+}
+
+#if MESSAGE_GLYPH_ATLAS
+/**
+ * Forgets the glyphs of the current char buffer, called when a message starts decoding into it. Slots filled other
+ * than through Font_LoadCharNES, like the player name, are then drawn from the char buffer.
+ */
+void Font_ClearCharGlyphs(Font* font) {
+    memset(sFontCharGlyphs[font->unk_11D88], FONT_GLYPH_NONE, sizeof(sFontCharGlyphs[0]));
+}
+
+// Returns the glyph loaded into the slot at `charTex` of the current char buffer, or FONT_GLYPH_NONE
+s32 Font_GetCharGlyph(Font* font, void* charTex) {
+    uintptr_t offset = (uintptr_t)charTex - (uintptr_t)font->charBuf[font->unk_11D88];
+
+    if ((offset >= sizeof(font->charBuf[0])) || ((offset % FONT_CHAR_TEX_SIZE) != 0)) {
+        return FONT_GLYPH_NONE;
+    }
+    return sFontCharGlyphs[font->unk_11D88][offset / FONT_CHAR_TEX_SIZE];
+}
+
+// Returns the page holding `glyph`, loading it the first time
+void* Font_GetGlyphPage(s32 glyph) {
+    s32 page = glyph / FONT_GLYPH_PAGE_GLYPHS;
+
+    if (!sFontGlyphPageLoaded[page]) {
+        DmaMgr_RequestSync(sFontGlyphPages[page],
+                           SEGMENT_ROM_START_OFFSET(nes_font_static, page * FONT_GLYPH_PAGE_SIZE),
+                           MIN(FONT_GLYPH_COUNT - page * FONT_GLYPH_PAGE_GLYPHS, FONT_GLYPH_PAGE_GLYPHS) *
+                               FONT_CHAR_TEX_SIZE);
+        sFontGlyphPageLoaded[page] = true;
+    }
+    return sFontGlyphPages[page];
 }
+#endif
 
 void Font_LoadMessageBoxEndIcon(Font* font, u16 icon) {
     DmaMgr_RequestSync(&font->iconBuf, SEGMENT_ROM_START_OFFSET(message_static, 0x5000 + icon * FONT_CHAR_TEX_SIZE),
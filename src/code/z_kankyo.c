@@ -159,6 +159,39 @@ TimeBasedLightEntry sTimeBasedLightConfigs[][7] = {
     },
 };
 
+#if ENV_LIGHTS_TABLE
+/**
+ * What `Environment_UpdateLights` blends between in `LIGHT_MODE_TIME`, for every entry of the current light config
+ * and of the one it changes to: the colors of the entry's light setting and of its next one with their day and weather
+ * adjustments added and clamped as `Environment_LerpColor` clamps them, and their fog near and far. Only built again
+ * when one of the configs, the day, the weather or the scene changes, so that each frame just lerps integers.
+ */
+typedef struct {
+    /* 0x00 */ u8 colors[4][2][3]; // ambient, light 1, light 2 and fog colors, of the setting and of the next one
+    /* 0x18 */ s16 fogNear[2];
+    /* 0x1C */ s16 zFar[2];
+} EnvTimeLightsBlend; // size = 0x20
+
+typedef struct {
+    /* 0x00 */ EnvTimeLightsBlend blends[2]; // `lightConfig`, then `changeLightNextConfig`
+    /* 0x40 */ u8 lightSetting; // after the out of range fallback, for the sandstorm colors
+    /* 0x41 */ u8 nextLightSetting;
+} EnvTimeLights; // size = 0x42
+
+typedef struct {
+    /* 0x000 */ EnvLightSettings* lightSettingsList; // NULL until built
+    /* 0x004 */ s16 sceneId;
+    /* 0x006 */ u8 numLightSettings;
+    /* 0x007 */ u8 lightConfig;
+    /* 0x008 */ u8 changeLightNextConfig;
+    /* 0x009 */ u8 weatherMode;
+    /* 0x00C */ s32 day;
+    /* 0x010 */ EnvTimeLights entries[ARRAY_COUNT(sTimeBasedLightConfigs[0])];
+} EnvTimeLightsTable;
+
+EnvTimeLightsTable sEnvTimeLightsTable;
+#endif
+
 typedef struct {
     /* 0x0 */ u16 startTime;
     /* 0x2 */ u16 endTime;
@@ -837,6 +870,9 @@ void Environment_Init(PlayState* play2, EnvironmentContext* envCtx, s32 arg2) {
     sEnvSkyboxNumStars = 0;
     gSkyboxNumStars = 0;
     D_801BDBA8 = false;
+#if ENV_LIGHTS_TABLE
+    sEnvTimeLightsTable.lightSettingsList = NULL;
+#endif
     sEnvIsTimeStopped = false;
     sSunPrimAlpha = 255.0f;
 
@@ -1102,6 +1138,10 @@ void Environment_UpdateSkybox(u8 skyboxId, EnvironmentContext* envCtx, SkyboxCon
 
         if ((envCtx->skyboxDmaState == SKYBOX_DMA_TEXTURE1_START) ||
             (envCtx->skyboxDmaState == SKYBOX_DMA_TEXTURE2_START)) {
+#if SKYBOX_LAYER_CACHE
+            // the texels change until the load is done, up to the frame that sees it done
+            skyboxCtx->texturesVersion++;
+#endif
             if (osRecvMesg(&envCtx->loadQueue, NULL, 0) == 0) {
                 envCtx->skyboxDmaState = SKYBOX_DMA_INACTIVE;
             }
@@ -1288,6 +1328,133 @@ s32 Environment_IsSceneUpsideDown(PlayState* play) {
     return ret;
 }
 
+#if ENV_LIGHTS_TABLE
+void Environment_BuildTimeLightsBlend(PlayState* play, EnvTimeLightsBlend* blend, u8 lightSetting, u8 nextLightSetting,
+                                      AdjLightSettings* adj) {
+    EnvLightSettings* lightSettingsList = play->envCtx.lightSettingsList;
+    EnvLightSettings* lightSettings[2];
+    s32 k;
+    s32 j;
+
+    lightSettings[0] = &lightSettingsList[lightSetting];
+    lightSettings[1] = &lightSettingsList[nextLightSetting];
+
+    for (k = 0; k < 2; k++) {
+        for (j = 0; j < 3; j++) {
+            blend->colors[0][k][j] = CLAMP(lightSettings[k]->ambientColor[j] + adj[k].ambientColor[j], 0, 255);
+            blend->colors[1][k][j] = CLAMP(lightSettings[k]->light1Color[j] + adj[k].light1Color[j], 0, 255);
+            blend->colors[2][k][j] = CLAMP(lightSettings[k]->light2Color[j] + adj[k].light2Color[j], 0, 255);
+            blend->colors[3][k][j] = CLAMP(lightSettings[k]->fogColor[j] + adj[k].fogColor[j], 0, 255);
+        }
+        blend->fogNear[k] = ENV_LIGHT_SETTINGS_FOG_NEAR(lightSettings[k]->blendRateAndFogNear);
+        blend->zFar[k] = lightSettings[k]->zFar;
+    }
+}
+
+EnvTimeLights* Environment_GetTimeLights(PlayState* play, EnvironmentContext* envCtx, s32 index) {
+    EnvTimeLightsTable* table = &sEnvTimeLightsTable;
+    s32 i;
+
+    if ((table->lightSettingsList != envCtx->lightSettingsList) || (table->sceneId != play->sceneId) ||
+        (table->numLightSettings != envCtx->numLightSettings) || (table->lightConfig != envCtx->lightConfig) ||
+        (table->changeLightNextConfig != envCtx->changeLightNextConfig) || (table->weatherMode != gWeatherMode) ||
+        (table->day != gSaveContext.save.day)) {
+        table->lightSettingsList = envCtx->lightSettingsList;
+        table->sceneId = play->sceneId;
+        table->numLightSettings = envCtx->numLightSettings;
+        table->lightConfig = envCtx->lightConfig;
+        table->changeLightNextConfig = envCtx->changeLightNextConfig;
+        table->weatherMode = gWeatherMode;
+        table->day = gSaveContext.save.day;
+
+        for (i = 0; i < ARRAY_COUNT(table->entries); i++) {
+            EnvTimeLights* entry = &table->entries[i];
+            u8 settings[4];
+            AdjLightSettings adj[4];
+            s32 k;
+
+            settings[0] = sTimeBasedLightConfigs[envCtx->lightConfig][i].lightSetting;
+            settings[1] = sTimeBasedLightConfigs[envCtx->lightConfig][i].nextLightSetting;
+            settings[2] = sTimeBasedLightConfigs[envCtx->changeLightNextConfig][i].lightSetting;
+            settings[3] = sTimeBasedLightConfigs[envCtx->changeLightNextConfig][i].nextLightSetting;
+
+            // The adjustments are from the settings before the fallback, as in `Environment_UpdateLights`
+            memset(adj, 0, sizeof(adj));
+            for (k = 0; k < 4; k++) {
+                func_800F6CEC(play, settings[k], &adj[k], envCtx->lightSettingsList);
+            }
+
+            for (k = 0; k < 4; k++) {
+                if (settings[k] >= envCtx->numLightSettings) {
+                    settings[0] = settings[1] = settings[2] = settings[3] = 0;
+                    break;
+                }
+            }
+
+            Environment_BuildTimeLightsBlend(play, &entry->blends[0], settings[0], settings[1], &adj[0]);
+            Environment_BuildTimeLightsBlend(play, &entry->blends[1], settings[2], settings[3], &adj[2]);
+            entry->lightSetting = settings[0];
+            entry->nextLightSetting = settings[1];
+        }
+    }
+
+    return &table->entries[index];
+}
+
+/**
+ * Sets the colors and fog of `envCtx->lightSettings` at `weight` (0 to 0x100) across a time-based entry, as
+ * `Environment_LerpColor` and `S16_LERP` would. Both configs are only blended while changing between them.
+ */
+void Environment_LerpTimeLights(EnvironmentContext* envCtx, EnvTimeLights* entry, s32 weight, f32 changeLerp) {
+    u8* colors[4];
+    u8 blend8[2][4][3];
+    s16 fogNear[2];
+    s16 zFar[2];
+    s32 numBlends = (changeLerp != 0.0f) ? 2 : 1;
+    s32 b;
+    s32 c;
+    s32 j;
+
+    colors[0] = envCtx->lightSettings.ambientColor;
+    colors[1] = envCtx->lightSettings.light1Color;
+    colors[2] = envCtx->lightSettings.light2Color;
+    colors[3] = envCtx->lightSettings.fogColor;
+
+    for (b = 0; b < numBlends; b++) {
+        EnvTimeLightsBlend* blend = &entry->blends[b];
+
+        for (c = 0; c < 4; c++) {
+            for (j = 0; j < 3; j++) {
+                u8 from = blend->colors[c][0][j];
+
+                blend8[b][c][j] = from + (((blend->colors[c][1][j] - from) * weight) >> 8);
+            }
+        }
+        // Rounded toward 0 like the s16 cast of `S16_LERP`
+        fogNear[b] = blend->fogNear[0] + (blend->fogNear[1] - blend->fogNear[0]) * weight / 0x100;
+        zFar[b] = blend->zFar[0] + (blend->zFar[1] - blend->zFar[0]) * weight / 0x100;
+    }
+
+    if (numBlends == 1) {
+        for (c = 0; c < 4; c++) {
+            for (j = 0; j < 3; j++) {
+                colors[c][j] = blend8[0][c][j];
+            }
+        }
+        envCtx->lightSettings.fogNear = fogNear[0];
+        envCtx->lightSettings.zFar = zFar[0];
+    } else {
+        for (c = 0; c < 4; c++) {
+            for (j = 0; j < 3; j++) {
+                colors[c][j] = LERPIMP_ALT(blend8[0][c][j], blend8[1][c][j], changeLerp);
+            }
+        }
+        envCtx->lightSettings.fogNear = LERPIMP_ALT(fogNear[0], fogNear[1], changeLerp);
+        envCtx->lightSettings.zFar = LERPIMP_ALT(zFar[0], zFar[1], changeLerp);
+    }
+}
+#endif
+
 void Environment_UpdateLights(PlayState* play, EnvironmentContext* envCtx, LightContext* lightCtx) {
     EnvLightSettings* lightSettingsList;
     f32 var_fs3;
@@ -1335,6 +1502,25 @@ void Environment_UpdateLights(PlayState* play, EnvironmentContext* envCtx, Light
 
                 if ((gSaveContext.skyboxTime >= startTime) &&
                     ((gSaveContext.skyboxTime < endTime) || (endTime == 0xFFFF))) {
+#if ENV_LIGHTS_TABLE
+                    EnvTimeLights* timeLights = Environment_GetTimeLights(play, envCtx, i);
+                    s32 weight;
+
+                    if ((sp94 >= envCtx->numLightSettings) && !D_801BDBA8) {
+                        D_801BDBA8 = true;
+                    }
+
+                    // `Environment_LerpWeight` in 0x100ths
+                    if (endTime != startTime) {
+                        weight = ((gSaveContext.skyboxTime - startTime) << 8) / (endTime - startTime);
+                    } else {
+                        weight = 0x100;
+                    }
+
+                    sSandstormColorIndex = timeLights->lightSetting & 3;
+                    sNextSandstormColorIndex = timeLights->nextLightSetting & 3;
+                    sSandstormLerpScale = weight * (1.0f / 0x100);
+#else
                     u8 blend8[2];   // sp90
                     s16 blend16[2]; // sp8C
 
@@ -1360,6 +1546,7 @@ void Environment_UpdateLights(PlayState* play, EnvironmentContext* envCtx, Light
                     sSandstormColorIndex = sp97 & 3;
                     sNextSandstormColorIndex = sp95 & 3;
                     sSandstormLerpScale = temp_fv0;
+#endif
 
                     if (envCtx->changeLightEnabled) {
                         var_fs3 = ((f32)envCtx->changeDuration - envCtx->changeLightTimer) / envCtx->changeDuration;
@@ -1371,6 +1558,9 @@ void Environment_UpdateLights(PlayState* play, EnvironmentContext* envCtx, Light
                         }
                     }
 
+#if ENV_LIGHTS_TABLE
+                    Environment_LerpTimeLights(envCtx, timeLights, weight, var_fs3);
+#else
                     for (j = 0; j < 3; j++) {
                         arg0 = lightSettingsList[(s32)sp95].ambientColor[j] + spA4[1].ambientColor[j];
                         arg1 = lightSettingsList[(s32)sp97].ambientColor[j] + spA4[0].ambientColor[j];
@@ -1382,6 +1572,7 @@ void Environment_UpdateLights(PlayState* play, EnvironmentContext* envCtx, Light
 
                         envCtx->lightSettings.ambientColor[j] = LERPIMP_ALT(blend8[0], blend8[1], var_fs3);
                     }
+#endif
 
                     if (Environment_IsSceneUpsideDown(play)) {
                         var_v0 = CURRENT_TIME + CLOCK_TIME(12, 0);
@@ -1398,6 +1589,7 @@ void Environment_UpdateLights(PlayState* play, EnvironmentContext* envCtx, Light
                     envCtx->lightSettings.light2Dir[1] = -envCtx->lightSettings.light1Dir[1];
                     envCtx->lightSettings.light2Dir[2] = -envCtx->lightSettings.light1Dir[2];
 
+#if !ENV_LIGHTS_TABLE
                     for (j = 0; j < 3; j++) {
                         arg0 = lightSettingsList[(s32)sp95].light1Color[j] + spA4[1].light1Color[j];
                         arg1 = lightSettingsList[(s32)sp97].light1Color[j] + spA4[0].light1Color[j];
@@ -1445,6 +1637,7 @@ void Environment_UpdateLights(PlayState* play, EnvironmentContext* envCtx, Light
                     blend16[1] =
                         S16_LERP(lightSettingsList[(s32)sp96].zFar, lightSettingsList[(s32)sp94].zFar, temp_fv0);
                     envCtx->lightSettings.zFar = LERPIMP_ALT(blend16[0], blend16[1], var_fs3);
+#endif
 
                     break;
                 }
@@ -1590,6 +1783,17 @@ void Environment_UpdateLights(PlayState* play, EnvironmentContext* envCtx, Light
         lightCtx->zFar = ENV_ZFAR_MAX;
     }
 
+#if DRAW_DISTANCE
+    // The far plane, the rooms' far test and the fog, which ends at the far plane, all follow zFar
+    adjustment = Environment_GetDrawDistance();
+    if (adjustment < 0x100) {
+        lightCtx->zFar = (lightCtx->zFar * adjustment) >> 8;
+        if (lightCtx->fogNear > ENV_FOGNEAR_DRAW_DISTANCE_MAX) {
+            lightCtx->fogNear = ENV_FOGNEAR_DRAW_DISTANCE_MAX;
+        }
+    }
+#endif
+
     if ((envCtx->dirLight1.params.dir.x == 0) && (envCtx->dirLight1.params.dir.y == 0) &&
         (envCtx->dirLight1.params.dir.z == 0)) {
         envCtx->dirLight1.params.dir.x = 1;
@@ -1847,6 +2051,285 @@ static u32 sLensFlareTypes[] = {
     LENS_FLARE_CIRCLE1, LENS_FLARE_CIRCLE1, LENS_FLARE_CIRCLE1, LENS_FLARE_CIRCLE1, LENS_FLARE_CIRCLE1,
 };
 
+#if ENV_EFFECT_BUDGET
+// Vertices a single load takes, as many copies of a batched model as fit go in each load
+#define ENV_BATCH_VTX_MAX 32
+#define ENV_BATCH_TRIS_MAX 32
+#define ENV_BATCH_SETUP_MAX 32
+// Batched vertices are in quarter units from the batch's origin, so they reach 8192 units away from it
+#define ENV_BATCH_VTX_SCALE 4.0f
+
+#define ENV_STARS_CACHE_MAX 1024
+
+/**
+ * A display list made of material commands, a single vertex load and triangles, so that many copies of it can be drawn
+ * from one vertex buffer. `setup` is the material commands followed by an end, `dl` is NULL until the first draw.
+ */
+typedef struct {
+    /* 0x000 */ Gfx* dl;
+    /* 0x004 */ Vtx* vtx;
+    /* 0x008 */ u8 batchable;
+    /* 0x009 */ u8 numVtx;
+    /* 0x00A */ u8 numTris;
+    /* 0x00B */ u8 tris[ENV_BATCH_TRIS_MAX][3];
+    /* 0x070 */ Gfx setup[ENV_BATCH_SETUP_MAX];
+} EnvBatchModel; // size = 0x170
+
+/**
+ * A random skybox star relative to the eye, as `Environment_DrawSkyboxStarsImpl` computes it. `y` is kept without the
+ * 1000 units it is lowered by, so that adding the eye's height and then subtracting them rounds as the original does.
+ */
+typedef struct {
+    /* 0x0 */ f32 x;
+    /* 0x4 */ f32 y;
+    /* 0x8 */ f32 z;
+    /* 0xC */ u32 width;
+} EnvStar; // size = 0x10
+
+typedef struct {
+    /* 0x0000 */ u32 seed;    // from the player name, the stars only change with it
+    /* 0x0004 */ u32 randInt; // to generate the stars after the ones cached
+    /* 0x0008 */ s32 numStars;
+    /* 0x000C */ EnvStar stars[ENV_STARS_CACHE_MAX];
+} EnvStarsCache;
+
+EnvBatchModel sEnvRainDropModel;
+EnvBatchModel sEnvRainSplashModel;
+EnvStarsCache sEnvStarsCache;
+
+/**
+ * Scales the amount of particles of an effect by `budget`, in 1/0x100ths, rounding up.
+ */
+s32 Environment_BudgetCount(s32 count, s32 budget) {
+    return (count * budget + 0xFF) >> 8;
+}
+
+/**
+ * How much bigger the particles of an effect are drawn when its budget cuts their amount, so that they cover about as
+ * much of the screen. Limited to twice the size, past which they would stand out as blocks.
+ */
+f32 Environment_GetEffectSizeScale(s32 budget) {
+    if (budget >= 0x100) {
+        return 1.0f;
+    }
+    if (budget <= 0x40) {
+        return 2.0f;
+    }
+    return sqrtf(256.0f / budget);
+}
+
+void Environment_AddBatchModelTri(EnvBatchModel* model, u32 w) {
+    u8* tri;
+
+    if (model->numTris >= ENV_BATCH_TRIS_MAX) {
+        model->batchable = false;
+        return;
+    }
+    tri = model->tris[model->numTris++];
+    tri[0] = ((w >> 16) & 0xFF) / 2;
+    tri[1] = ((w >> 8) & 0xFF) / 2;
+    tri[2] = (w & 0xFF) / 2;
+    if ((tri[0] >= model->numVtx) || (tri[1] >= model->numVtx) || (tri[2] >= model->numVtx)) {
+        model->batchable = false;
+    }
+}
+
+void Environment_ParseBatchModel(EnvBatchModel* model, Gfx* dl) {
+    Gfx* cmd = Lib_SegmentedToVirtual(dl);
+    s32 numSetup = 0;
+    u32 w0;
+
+    model->dl = dl;
+    model->vtx = NULL;
+    model->batchable = false;
+    model->numVtx = 0;
+    model->numTris = 0;
+
+    // material commands up to the vertex load, which must fill the buffer from its start
+    for (;; cmd++) {
+        w0 = cmd->words.w0;
+
+        if ((w0 >> 24) == G_VTX) {
+            model->numVtx = (w0 >> 12) & 0xFF;
+            if ((((w0 >> 1) & 0x7F) != model->numVtx) || (model->numVtx == 0) ||
+                (model->numVtx > ENV_BATCH_VTX_MAX)) {
+                return;
+            }
+            model->vtx = Lib_SegmentedToVirtual((void*)(uintptr_t)cmd->words.w1);
+            break;
+        }
+
+        switch (w0 >> 24) {
+            case G_MTX:
+            case G_POPMTX:
+            case G_DL:
+            case G_BRANCH_Z:
+            case G_CULLDL:
+            case G_ENDDL:
+                return;
+
+            default:
+                if (numSetup >= ENV_BATCH_SETUP_MAX - 1) {
+                    return;
+                }
+                model->setup[numSetup++] = *cmd;
+                break;
+        }
+    }
+    gSPEndDisplayList(&model->setup[numSetup]);
+
+    // then only triangles
+    model->batchable = true;
+    for (cmd++; model->batchable; cmd++) {
+        w0 = cmd->words.w0;
+
+        switch (w0 >> 24) {
+            case G_TRI1:
+                Environment_AddBatchModelTri(model, w0);
+                break;
+
+            case G_TRI2:
+            case G_QUAD:
+                Environment_AddBatchModelTri(model, w0);
+                Environment_AddBatchModelTri(model, cmd->words.w1);
+                break;
+
+            case G_RDPPIPESYNC:
+                break;
+
+            case G_ENDDL:
+                return;
+
+            default:
+                model->batchable = false;
+                break;
+        }
+    }
+}
+
+/**
+ * Returns whether `dl` can be drawn with `Environment_DrawBatchModel`, parsing it on its first use.
+ */
+s32 Environment_IsBatchModel(EnvBatchModel* model, Gfx* dl) {
+    if (model->dl != dl) {
+        Environment_ParseBatchModel(model, dl);
+    }
+    return model->batchable;
+}
+
+s16 Environment_GetBatchCoord(f32 offset) {
+    offset *= ENV_BATCH_VTX_SCALE;
+    return CLAMP(offset, -0x8000, 0x7FFF);
+}
+
+/**
+ * Writes the vertices of a copy of `model` transformed by the current matrix to `vtx`, relative to `origin`. Their
+ * normals aren't rotated, the environment effects batched are unlit.
+ */
+void Environment_AddBatchModelCopy(EnvBatchModel* model, Vtx* vtx, Vec3f* origin) {
+    Vtx* src = model->vtx;
+    Vec3f pos;
+    Vec3f worldPos;
+    s32 i;
+
+    for (i = 0; i < model->numVtx; i++, src++, vtx++) {
+        pos.x = src->v.ob[0];
+        pos.y = src->v.ob[1];
+        pos.z = src->v.ob[2];
+        Matrix_MultVec3f(&pos, &worldPos);
+
+        *vtx = *src;
+        vtx->v.ob[0] = Environment_GetBatchCoord(worldPos.x - origin->x);
+        vtx->v.ob[1] = Environment_GetBatchCoord(worldPos.y - origin->y);
+        vtx->v.ob[2] = Environment_GetBatchCoord(worldPos.z - origin->z);
+    }
+}
+
+/**
+ * Draws `count` copies of `model` written by `Environment_AddBatchModelCopy`, with a single matrix and material.
+ */
+Gfx* Environment_DrawBatchModel(Gfx* gfx, GraphicsContext* gfxCtx, EnvBatchModel* model, Vtx* vtx, s32 count,
+                                Vec3f* origin) {
+    s32 copiesPerLoad = ENV_BATCH_VTX_MAX / model->numVtx;
+    s32 numCopies;
+    s32 base;
+    s32 i;
+    s32 j;
+    u8(*tris)[3] = model->tris;
+
+    Matrix_Translate(origin->x, origin->y, origin->z, MTXMODE_NEW);
+    Matrix_Scale(1.0f / ENV_BATCH_VTX_SCALE, 1.0f / ENV_BATCH_VTX_SCALE, 1.0f / ENV_BATCH_VTX_SCALE, MTXMODE_APPLY);
+    MATRIX_FINALIZE_AND_LOAD(gfx++, gfxCtx);
+    gSPDisplayList(gfx++, model->setup);
+
+    for (; count > 0; count -= numCopies, vtx += numCopies * model->numVtx) {
+        numCopies = CLAMP_MAX(count, copiesPerLoad);
+        gSPVertex(gfx++, vtx, numCopies * model->numVtx, 0);
+
+        for (i = 0; i < numCopies; i++) {
+            base = i * model->numVtx;
+            for (j = 0; j + 1 < model->numTris; j += 2) {
+                gSP2Triangles(gfx++, base + tris[j][0], base + tris[j][1], base + tris[j][2], 0,
+                              base + tris[j + 1][0], base + tris[j + 1][1], base + tris[j + 1][2], 0);
+            }
+            if (j < model->numTris) {
+                gSP1Triangle(gfx++, base + tris[j][0], base + tris[j][1], base + tris[j][2], 0);
+            }
+        }
+    }
+
+    return gfx;
+}
+
+/**
+ * Returns the first `numStars` random skybox stars for the player name hash `seed`, generating the ones not cached yet,
+ * or NULL when there are too many to cache.
+ */
+EnvStar* Environment_GetSkyboxStars(u32 seed, s32 numStars) {
+    EnvStarsCache* cache = &sEnvStarsCache;
+    EnvStar* star;
+    u32 randInt;
+    f32 temp_f4;
+    f32 temp_f20;
+    f32 temp_f2;
+
+    if (numStars > ENV_STARS_CACHE_MAX) {
+        return NULL;
+    }
+    if ((cache->numStars == 0) || (cache->seed != seed)) {
+        cache->seed = seed;
+        cache->randInt = seed;
+        cache->numStars = 0;
+    }
+
+    randInt = cache->randInt;
+    for (star = &cache->stars[cache->numStars]; cache->numStars < numStars; cache->numStars++, star++) {
+        randInt = (randInt * RAND_MULTIPLIER) + RAND_INCREMENT;
+        gRandFloat.i = (randInt >> 9) | 0x3F800000;
+        temp_f4 = gRandFloat.f - 1.0f;
+
+        randInt = (randInt * RAND_MULTIPLIER) + RAND_INCREMENT;
+        gRandFloat.i = (randInt >> 9) | 0x3F800000;
+        temp_f20 = ((gRandFloat.f - 1.0f) + temp_f4) * 0.5f;
+
+        randInt = (randInt * RAND_MULTIPLIER) + RAND_INCREMENT;
+
+        star->y = SQ(temp_f20) * SQ(128.0f);
+        star->x = Math_SinS(randInt) * (1.2f - temp_f20) * SQ(128.0f);
+        star->z = Math_CosS(randInt) * (1.2f - temp_f20) * SQ(128.0f);
+
+        randInt = (randInt * RAND_MULTIPLIER) + RAND_INCREMENT;
+        gRandFloat.i = ((randInt >> 9) | 0x3F800000);
+        temp_f2 = gRandFloat.f - 1.0f;
+
+        star->width = (u32)((SQ(temp_f2) * 8.0f) + 2.0f);
+    }
+    cache->randInt = randInt;
+
+    return cache->stars;
+}
+#endif
+
 void Environment_DrawLensFlare(PlayState* play, EnvironmentContext* envCtx, View* view, GraphicsContext* gfxCtx,
                                Vec3f pos, f32 scale, f32 colorIntensity, s16 glareStrength, u8 isSun) {
     s16 i;
@@ -1878,6 +2361,10 @@ void Environment_DrawLensFlare(PlayState* play, EnvironmentContext* envCtx, View
     f32 weight = 0.0f;
     f32 glareAlphaScale;
     Mtx* mtx;
+#if ENV_EFFECT_BUDGET
+    // the first elements are the biggest ones, those nearest the light
+    s32 numFlares = Environment_BudgetCount(ARRAY_COUNT(sLensFlareTypes), Environment_GetEffectBudget());
+#endif
 
     OPEN_DISPS(gfxCtx);
 
@@ -1974,6 +2461,12 @@ void Environment_DrawLensFlare(PlayState* play, EnvironmentContext* envCtx, View
                 Math_SmoothStepToF(&envCtx->lensFlareAlphaScale, 0.0f, 0.5f, 0.05f, 0.001f);
             }
 
+#if ENV_EFFECT_BUDGET
+            // the alpha scale still steps once per element, so that it fades at the same pace
+            if (i >= numFlares) {
+                continue;
+            }
+#endif
             POLY_XLU_DISP = Gfx_SetupDL65_NoCD(POLY_XLU_DISP++);
             gDPSetPrimColor(POLY_XLU_DISP++, 0, 0, sLensFlareColors[i].r, sLensFlareColors[i].g, sLensFlareColors[i].b,
                             alpha * envCtx->lensFlareAlphaScale);
@@ -2069,6 +2562,13 @@ void Environment_DrawRainImpl(PlayState* play, View* view, GraphicsContext* gfxC
     s16 pitch;
     s16 yaw;
     f32 scale;
+#if ENV_EFFECT_BUDGET
+    s32 budget = Environment_GetEffectBudget();
+    f32 sizeScale = Environment_GetEffectSizeScale(budget);
+    s32 numDrawn;
+    Vec3f origin;
+    Vtx* vtx;
+#endif
 
     if (play->envCtx.precipitation[PRECIP_SOS_MAX] != 0) {
         precip = play->envCtx.precipitation[PRECIP_RAIN_CUR];
@@ -2080,6 +2580,11 @@ void Environment_DrawRainImpl(PlayState* play, View* view, GraphicsContext* gfxC
             precip = 5;
         }
     }
+#if ENV_EFFECT_BUDGET
+    // the drops and splashes not drawn still take their random numbers, so that the random sequence the game shares
+    // doesn't depend on the budget
+    numDrawn = Environment_BudgetCount(precip, budget);
+#endif
 
     OPEN_DISPS(gfxCtx);
 
@@ -2114,18 +2619,57 @@ void Environment_DrawRainImpl(PlayState* play, View* view, GraphicsContext* gfxC
     pitch = 0x4000 - Math_Vec3f_Pitch(&gZeroVec3f, &spD4);
     yaw = Math_Vec3f_Yaw(&gZeroVec3f, &spD4) + 0x8000;
 
+#if ENV_EFFECT_BUDGET
+    origin.x = spF0;
+    origin.y = spEC;
+    origin.z = spE8;
+    vtx = Environment_IsBatchModel(&sEnvRainDropModel, gFallingRainDropDL)
+              ? GRAPH_ALLOC(gfxCtx, numDrawn * sEnvRainDropModel.numVtx * sizeof(Vtx))
+              : NULL;
+#endif
+
     for (i = 0; i < precip; i++) {
         Matrix_Translate(((Rand_ZeroOne() - 0.7f) * 100.0f) + spF0, ((Rand_ZeroOne() - 0.7f) * 100.0f) + spEC,
                          ((Rand_ZeroOne() - 0.7f) * 100.0f) + spE8, MTXMODE_NEW);
+#if ENV_EFFECT_BUDGET
+        if (i >= numDrawn) {
+            continue;
+        }
+        if (vtx != NULL) {
+            Matrix_RotateYS(yaw + (s16)(i << 5), MTXMODE_APPLY);
+            Matrix_RotateXS(pitch + (s16)(i << 5), MTXMODE_APPLY);
+            Matrix_Scale(0.3f * sizeScale, 1.0f, 0.3f * sizeScale, MTXMODE_APPLY);
+            Environment_AddBatchModelCopy(&sEnvRainDropModel, &vtx[i * sEnvRainDropModel.numVtx], &origin);
+            continue;
+        }
+#endif
         gSPMatrix(POLY_XLU_DISP++, &D_01000000, G_MTX_NOPUSH | G_MTX_MUL | G_MTX_MODELVIEW);
         Matrix_RotateYS(yaw + (s16)(i << 5), MTXMODE_APPLY);
         Matrix_RotateXS(pitch + (s16)(i << 5), MTXMODE_APPLY);
+#if ENV_EFFECT_BUDGET
+        Matrix_Scale(0.3f * sizeScale, 1.0f, 0.3f * sizeScale, MTXMODE_APPLY);
+#else
         Matrix_Scale(0.3f, 1.0f, 0.3f, MTXMODE_APPLY);
+#endif
         MATRIX_FINALIZE_AND_LOAD(POLY_XLU_DISP++, gfxCtx);
         gSPDisplayList(POLY_XLU_DISP++, gFallingRainDropDL);
     }
 
+#if ENV_EFFECT_BUDGET
+    if ((vtx != NULL) && (numDrawn != 0)) {
+        POLY_XLU_DISP = Environment_DrawBatchModel(POLY_XLU_DISP, gfxCtx, &sEnvRainDropModel, vtx, numDrawn, &origin);
+    }
+#endif
+
     if (player->actor.floorHeight < view->eye.y) {
+#if ENV_EFFECT_BUDGET
+        origin.x = spE4;
+        origin.y = player->actor.floorHeight + 2.0f;
+        origin.z = spE0;
+        vtx = Environment_IsBatchModel(&sEnvRainSplashModel, gEffShockwaveDL)
+                  ? GRAPH_ALLOC(gfxCtx, numDrawn * sEnvRainSplashModel.numVtx * sizeof(Vtx))
+                  : NULL;
+#endif
         materialApplied = false;
         for (i = 0; i < precip; i++) {
             if (!materialApplied) {
@@ -2137,10 +2681,28 @@ void Environment_DrawRainImpl(PlayState* play, View* view, GraphicsContext* gfxC
             Matrix_Translate((Environment_RandCentered() * 220.0f) + spE4, player->actor.floorHeight + 2.0f,
                              (Environment_RandCentered() * 220.0f) + spE0, MTXMODE_NEW);
             scale = (Rand_ZeroOne() * 0.05f) + 0.05f;
+#if ENV_EFFECT_BUDGET
+            if (i >= numDrawn) {
+                continue;
+            }
+            scale *= sizeScale;
+#endif
             Matrix_Scale(scale, scale, scale, MTXMODE_APPLY);
+#if ENV_EFFECT_BUDGET
+            if (vtx != NULL) {
+                Environment_AddBatchModelCopy(&sEnvRainSplashModel, &vtx[i * sEnvRainSplashModel.numVtx], &origin);
+                continue;
+            }
+#endif
             MATRIX_FINALIZE_AND_LOAD(POLY_XLU_DISP++, gfxCtx);
             gSPDisplayList(POLY_XLU_DISP++, gEffShockwaveDL);
         }
+#if ENV_EFFECT_BUDGET
+        if ((vtx != NULL) && (numDrawn != 0)) {
+            POLY_XLU_DISP =
+                Environment_DrawBatchModel(POLY_XLU_DISP, gfxCtx, &sEnvRainSplashModel, vtx, numDrawn, &origin);
+        }
+#endif
     }
 
     CLOSE_DISPS(gfxCtx);
@@ -3172,6 +3734,12 @@ void Environment_DrawSkyboxStarsImpl(PlayState* play, Gfx** gfxP) {
     Vec3f* posPtr;
     s32 pad[2];
     f32(*viewProjectionMtxF)[4];
+#if ENV_EFFECT_BUDGET
+    s32 budget = Environment_GetEffectBudget();
+    s32 numStars = sEnvSkyboxNumStars;
+    s32 starHeight = 4.0f * Environment_GetEffectSizeScale(budget);
+    EnvStar* stars;
+#endif
 
     gfx = *gfxP;
     negateY = Environment_IsSceneUpsideDown(play);
@@ -3204,13 +3772,34 @@ void Environment_DrawSkyboxStarsImpl(PlayState* play, Gfx** gfxP) {
     //! FAKE:
     if (play->view.viewingPtr && play->view.viewingPtr && play->view.viewingPtr) {}
 
+#if ENV_EFFECT_BUDGET
+    // the budget only cuts the random stars, the first 16 are the constellations
+    if (numStars > 16) {
+        numStars = 16 + Environment_BudgetCount(numStars - 16, budget);
+        stars = Environment_GetSkyboxStars(randInt, numStars - 16);
+    } else {
+        stars = NULL;
+    }
+
+    for (i = 0; i < numStars; i++) {
+#else
     for (i = 0; i < sEnvSkyboxNumStars; i++) {
+#endif
         if (i < 16) {
             pos.x = play->view.eye.x + (s32)D_801DD880[i].x;
             pos.y = play->view.eye.y + (s32)D_801DD880[i].y;
             pos.z = play->view.eye.z + (s32)D_801DD880[i].z;
             imgWidth = 8;
+#if ENV_EFFECT_BUDGET
+        } else if (stars != NULL) {
+            pos.y = (play->view.eye.y + stars[i - 16].y) - 1000.0f;
+            pos.x = play->view.eye.x + stars[i - 16].x;
+            pos.z = play->view.eye.z + stars[i - 16].z;
+            imgWidth = stars[i - 16].width;
+        } else {
+#else
         } else {
+#endif
             f32 temp_f22;
             f32 temp_f4;
             f32 temp_f2;
@@ -3281,7 +3870,11 @@ void Environment_DrawSkyboxStarsImpl(PlayState* play, Gfx** gfxP) {
                 imgY = (imgY * -(SCREEN_HEIGHT / 2)) + (SCREEN_HEIGHT / 2);
 
                 gfxTemp = gfx;
+#if ENV_EFFECT_BUDGET
+                Environment_DrawSkyboxStar(&gfxTemp, imgX, imgY, imgWidth * starHeight / 4, starHeight);
+#else
                 Environment_DrawSkyboxStar(&gfxTemp, imgX, imgY, imgWidth, 4);
+#endif
                 gfx = gfxTemp;
             }
             //! FAKE:
@@ -31,6 +31,7 @@ void* Lib_MemSet(void* buffer, s32 value, size_t size) {
     return buffer;
 }
 
+#if !TRIG_TABLE // inline in z64math.h
 f32 Math_CosS(s16 angle) {
     return coss(angle) * (1.0f / SHRT_MAX);
 }
@@ -38,6 +39,7 @@ f32 Math_CosS(s16 angle) {
 f32 Math_SinS(s16 angle) {
     return sins(angle) * (1.0f / SHRT_MAX);
 }
+#endif
 
 s32 Math_StepToIImpl(s32 start, s32 target, s32 step) {
     s32 ret;
@@ -9,6 +9,17 @@
 
 LightsBuffer sLightsBuffer;
 
+#if LIGHTS_BIND_CACHE
+// What the light list held the last time it was checked, a bumped generation invalidates every `LightsCache`
+u32 sLightsListGeneration = 1;
+s32 sLightsListSnapshotCount;
+LightInfo* sLightsListSnapshotInfo[LIGHTS_BUFFER_SIZE];
+LightInfo sLightsListSnapshot[LIGHTS_BUFFER_SIZE];
+// Same for the matrix `Lights_BindPoint` culls against
+u32 sLightsViewGeneration = 1;
+MtxF sLightsViewSnapshot;
+#endif
+
 void Lights_PointSetInfo(LightInfo* info, s16 x, s16 y, s16 z, u8 r, u8 g, u8 b, s16 radius, LightType type) {
     info->type = type;
     info->params.point.x = x;
@@ -233,6 +244,83 @@ void Lights_BindAll(Lights* lights, LightNode* listHead, Vec3f* refPos, PlayStat
     }
 }
 
+#if LIGHTS_BIND_CACHE
+/**
+ * Bump `sLightsListGeneration` if a light was inserted, removed or reordered, or its info changed, since the last
+ * check. Actors write their `LightInfo` directly as well as through the setters, so the list is compared instead of
+ * having the setters bump it.
+ */
+void Lights_UpdateListGeneration(LightNode* listHead) {
+    s32 count = 0;
+    s32 changed = false;
+
+    while (listHead != NULL) {
+        if (changed || (count >= sLightsListSnapshotCount) || (sLightsListSnapshotInfo[count] != listHead->info) ||
+            (bcmp(&sLightsListSnapshot[count], listHead->info, sizeof(LightInfo)) != 0)) {
+            changed = true;
+            sLightsListSnapshotInfo[count] = listHead->info;
+            sLightsListSnapshot[count] = *listHead->info;
+        }
+        listHead = listHead->next;
+        count++;
+    }
+
+    if (changed || (count != sLightsListSnapshotCount)) {
+        sLightsListSnapshotCount = count;
+        sLightsListGeneration++;
+    }
+}
+
+/**
+ * `Lights_BindAll` for an actor that is drawn every frame. If the light list, the reference position and, for
+ * microcode point lights, the view are what `cache` was bound from, its lights are copied into `lights` instead of
+ * being bound again. The ambient color is left to `lights`, as it isn't part of the binding.
+ */
+void Lights_BindAllCached(Lights* lights, LightNode* listHead, Vec3f* refPos, PlayState* play, LightsCache* cache) {
+    u8 mode;
+
+    if (lights->numLights != 0) {
+        // the cached lights are bound to a new group
+        Lights_BindAll(lights, listHead, refPos, play);
+        return;
+    }
+
+    Lights_UpdateListGeneration(listHead);
+
+    if ((refPos == NULL) && (lights->enablePosLights == 1)) {
+        mode = LIGHTS_CACHE_MODE_POINT;
+        if (bcmp(&sLightsViewSnapshot, &play->viewProjectionMtxF, sizeof(MtxF)) != 0) {
+            sLightsViewSnapshot = play->viewProjectionMtxF;
+            sLightsViewGeneration++;
+        }
+    } else if (refPos != NULL) {
+        mode = LIGHTS_CACHE_MODE_LEGACY;
+    } else {
+        mode = LIGHTS_CACHE_MODE_NONE;
+    }
+
+    if ((cache->listGeneration == sLightsListGeneration) && (cache->mode == mode) &&
+        ((mode != LIGHTS_CACHE_MODE_POINT) || (cache->viewGeneration == sLightsViewGeneration)) &&
+        ((mode != LIGHTS_CACHE_MODE_LEGACY) || ((cache->refPos.x == refPos->x) && (cache->refPos.y == refPos->y) &&
+                                                (cache->refPos.z == refPos->z)))) {
+        lights->numLights = cache->numLights;
+        bcopy(cache->l, lights->l.l, cache->numLights * sizeof(Light));
+        return;
+    }
+
+    Lights_BindAll(lights, listHead, refPos, play);
+
+    cache->listGeneration = sLightsListGeneration;
+    cache->viewGeneration = sLightsViewGeneration;
+    if (refPos != NULL) {
+        cache->refPos = *refPos;
+    }
+    cache->mode = mode;
+    cache->numLights = lights->numLights;
+    bcopy(lights->l.l, cache->l, lights->numLights * sizeof(Light));
+}
+#endif
+
 LightNode* Lights_FindBufSlot(void) {
     LightNode* ret;
 
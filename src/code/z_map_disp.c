@@ -40,6 +40,13 @@ static Color_RGBA8 sMinimapActorCategoryColors[12] = {
 TransitionActorEntry sTransitionActors[ROOM_TRANSITION_MAX];
 PauseDungeonMap sPauseDungeonMap;
 
+#if HUD_LAYER_CACHE
+// Counts the map textures loaded into texBuff0 and texBuff1, keys the minimap's layer
+static u32 sMinimapTexturesVersion = 0;
+// Whether the last actor icon drawn left the setup of the icon dots, so that a run of dots shares one setup
+static s32 sMinimapDotSetup = false;
+#endif
+
 void MapDisp_GetMapITexture(void* dst, s32 mapCompactId) {
     if (MapDisp_GetSizeOfMapITex(mapCompactId) != 0) {
         CmpDma_LoadFile(SEGMENT_ROM_START(map_i_static), mapCompactId, dst, MapDisp_GetSizeOfMapITex(mapCompactId));
@@ -297,6 +304,9 @@ void MapDisp_Minimap_DrawActorIcon(PlayState* play, Actor* actor) {
             MATRIX_FINALIZE_AND_LOAD(OVERLAY_DISP++, play->state.gfxCtx);
             gDPSetPrimColor(OVERLAY_DISP++, 0, 0, 200, 255, 0, play->interfaceCtx.minimapAlpha);
             gSPDisplayList(OVERLAY_DISP++, gCompassArrowDL);
+#if HUD_LAYER_CACHE
+            sMinimapDotSetup = false;
+#endif
         } else if ((actor->id == ACTOR_EN_BOX) && !Flags_GetTreasure(play, actor->params & 0x1F) &&
                    (MapDisp_GetStoreyY(player->actor.world.pos.y) == MapDisp_GetStoreyY(actor->world.pos.y))) {
             Gfx_SetupDL39_Overlay(play->state.gfxCtx);
@@ -312,9 +322,20 @@ void MapDisp_Minimap_DrawActorIcon(PlayState* play, Actor* actor) {
 
             gSPTextureRectangle(OVERLAY_DISP++, (posX - 4) << 2, (posY - 4) << 2, (posX + 4) << 2, (posY + 4) << 2,
                                 G_TX_RENDERTILE, 0, 0, 1 << 10, 1 << 10);
+#if HUD_LAYER_CACHE
+            sMinimapDotSetup = false;
+#endif
         } else {
+#if HUD_LAYER_CACHE
+            if (!sMinimapDotSetup) {
+                Gfx_SetupDL39_Overlay(play->state.gfxCtx);
+                gDPSetCombineMode(OVERLAY_DISP++, G_CC_MODULATEIA_PRIM, G_CC_MODULATEIA_PRIM);
+                sMinimapDotSetup = true;
+            }
+#else
             Gfx_SetupDL39_Overlay(play->state.gfxCtx);
             gDPSetCombineMode(OVERLAY_DISP++, G_CC_MODULATEIA_PRIM, G_CC_MODULATEIA_PRIM);
+#endif
             if (actor->flags & ACTOR_FLAG_MINIMAP_ICON_ENABLED) {
                 gDPSetPrimColor(OVERLAY_DISP++, 0, 0, sMinimapActorCategoryColors[actor->category].r,
                                 sMinimapActorCategoryColors[actor->category].g,
@@ -336,11 +357,20 @@ void MapDisp_Minimap_DrawActors(PlayState* play) {
 
         gDPLoadTextureBlock_4b(OVERLAY_DISP++, &sWhiteSquareTex, G_IM_FMT_I, 16, 16, 0, G_TX_NOMIRROR | G_TX_WRAP,
                                G_TX_NOMIRROR | G_TX_WRAP, G_TX_NOMASK, G_TX_NOMASK, G_TX_NOLOD, G_TX_NOLOD);
+#if HUD_LAYER_CACHE
+        sMinimapDotSetup = false;
+#endif
 
         actorCtx = &play->actorCtx;
         for (i = 0; i < ACTORCAT_MAX; i++) {
             Actor* actor = actorCtx->actorLists[i].first;
 
+#if HUD_LAYER_CACHE
+            // The chests are drawn in the minimap's layer, see MapDisp_Minimap_DrawChestActors
+            if (i == ACTORCAT_CHEST) {
+                continue;
+            }
+#endif
             while (actor != NULL) {
                 if ((actor->update != NULL) && (actor->init == NULL) &&
                     Object_IsLoaded(&play->objectCtx, actor->objectSlot) &&
@@ -357,6 +387,37 @@ void MapDisp_Minimap_DrawActors(PlayState* play) {
     }
 }
 
+#if HUD_LAYER_CACHE
+/**
+ * The chests' part of `MapDisp_Minimap_DrawActors`. They only change when one is opened or the player goes to another
+ * storey or room, so they are drawn in the minimap's layer with the rooms and doors.
+ */
+void MapDisp_Minimap_DrawChestActors(PlayState* play) {
+    Actor* actor;
+
+    if (play->roomCtx.curRoom.num != -1) {
+        OPEN_DISPS(play->state.gfxCtx);
+
+        gDPLoadTextureBlock_4b(OVERLAY_DISP++, &sWhiteSquareTex, G_IM_FMT_I, 16, 16, 0, G_TX_NOMIRROR | G_TX_WRAP,
+                               G_TX_NOMIRROR | G_TX_WRAP, G_TX_NOMASK, G_TX_NOMASK, G_TX_NOLOD, G_TX_NOLOD);
+        sMinimapDotSetup = false;
+
+        actor = play->actorCtx.actorLists[ACTORCAT_CHEST].first;
+        while (actor != NULL) {
+            if ((actor->update != NULL) && (actor->init == NULL) &&
+                Object_IsLoaded(&play->objectCtx, actor->objectSlot) &&
+                ((actor->id == ACTOR_EN_BOX) || (actor->flags & ACTOR_FLAG_MINIMAP_ICON_ENABLED)) &&
+                ((sMapDisp.curRoom == actor->room) || (actor->room == -1))) {
+                MapDisp_Minimap_DrawActorIcon(play, actor);
+            }
+            actor = actor->next;
+        }
+
+        CLOSE_DISPS(play->state.gfxCtx);
+    }
+}
+#endif
+
 void MapDisp_Minimap_DrawDoorActor(PlayState* play, Actor* actor) {
     MapDataRoom* mapDataRoom;
     s32 posX;
@@ -923,6 +984,9 @@ void MapDisp_SwapRooms(s16 nextRoom) {
                         CmpDma_LoadFile(SEGMENT_ROM_START(map_grand_static),
                                         MAPDATA_GET_MAP_GRAND_ID_FROM_MAP_ID(nextMapDataRoom->mapId),
                                         sMapDisp.minimapCurTex, MapData_GetSizeOfMapGrandTex(nextMapDataRoom->mapId));
+#if HUD_LAYER_CACHE
+                        sMinimapTexturesVersion++;
+#endif
                     }
                     break;
 
@@ -1051,6 +1115,54 @@ s32 MapDisp_AreRoomsSameStorey(s32 curRoom, s32 prevRoom) {
     return false;
 }
 
+#if HUD_LAYER_CACHE
+/**
+ * `MapDisp_DrawMinimap` with the rooms, doors and chests in an overlay layer of the HUD, drawn again only when they
+ * change. The player's and the entrance's arrows and the other actors' icons move, they are drawn over it every frame.
+ */
+void MapDisp_DrawMinimap(PlayState* play, s32 playerInitX, s32 playerInitZ, s32 playerInitDir) {
+    PauseContext* pauseCtx = &play->pauseCtx;
+    s32 showIcons;
+
+    if ((sMapDisp.mapDataScene != NULL) && ((s32)pauseCtx->state <= PAUSE_STATE_OPENING_2) && !R_MINIMAP_DISABLED &&
+        (play->interfaceCtx.minimapAlpha != 0)) {
+        if (!MapDisp_IsLocationMinimapBlocked(play) && (sSceneNumRooms != 0)) {
+            showIcons = (!Map_CurRoomHasMapI(play) || CHECK_DUNGEON_ITEM(DUNGEON_COMPASS, gSaveContext.mapIndex)) &&
+                        (Map_CurRoomHasMapI(play) || Inventory_IsMapVisible(play->sceneId));
+
+            OPEN_DISPS(play->state.gfxCtx);
+            gNspOverlayLayer(OVERLAY_DISP++, HUD_LAYER_MINIMAP, sMinimapTexturesVersion);
+            CLOSE_DISPS(play->state.gfxCtx);
+
+            if (MapDisp_CanDisplayMinimap(play)) {
+                MapDisp_DrawMinimapRoom(play, sMapDisp.minimapCurTex, sMapDisp.minimapCurX, sMapDisp.minimapCurY,
+                                        sMapDisp.curRoom, 1.0f - (sMapDisp.swapAnimTimer * 0.05f));
+                if ((sMapDisp.curRoom != sMapDisp.prevRoom) &&
+                    MapDisp_AreRoomsSameStorey(sMapDisp.curRoom, sMapDisp.prevRoom)) {
+                    MapDisp_DrawMinimapRoom(play, sMapDisp.minimapPrevTex, sMapDisp.minimapCurX + sMapDisp.minimapPrevX,
+                                            sMapDisp.minimapCurY + sMapDisp.minimapPrevY, sMapDisp.prevRoom,
+                                            sMapDisp.swapAnimTimer * 0.05f);
+                }
+                MapDisp_Minimap_DrawDoorActors(play);
+            }
+            if (showIcons) {
+                MapDisp_Minimap_DrawChestActors(play);
+            }
+
+            OPEN_DISPS(play->state.gfxCtx);
+            gNspLayer(OVERLAY_DISP++, G_NSP_LAYER_END);
+            CLOSE_DISPS(play->state.gfxCtx);
+
+            if (showIcons) {
+                if (play->interfaceCtx.minigameState == MINIGAME_STATE_NONE) {
+                    MapDisp_Minimap_DrawRedCompassIcon(play, playerInitX, playerInitZ, playerInitDir);
+                }
+                MapDisp_Minimap_DrawActors(play);
+            }
+        }
+    }
+}
+#else
 void MapDisp_DrawMinimap(PlayState* play, s32 playerInitX, s32 playerInitZ, s32 playerInitDir) {
     PauseContext* pauseCtx = &play->pauseCtx;
 
@@ -1078,6 +1190,7 @@ void MapDisp_DrawMinimap(PlayState* play, s32 playerInitX, s32 playerInitZ, s32
         }
     }
 }
+#endif
 
 void MapDisp_ResetMapI(void) {
     s32 i;
@@ -801,6 +801,56 @@ void func_801496C8(PlayState* play) {
     }
 }
 
+#if MESSAGE_GLYPH_ATLAS
+// The glyph page loaded by the last character and the end of its commands. A character whose commands start right
+// there in the same frame still has that page loaded
+static void* sGlyphPageLoaded = NULL;
+static Gfx* sGlyphPageGfxEnd = NULL;
+static u32 sGlyphPageFrame = 0;
+
+void Message_DrawTextChar(PlayState* play, TexturePtr texture, Gfx** gfxP) {
+    MessageContext* msgCtx = &play->msgCtx;
+    Gfx* gfx = *gfxP;
+    s16 x = msgCtx->textPosX;
+    s16 y = msgCtx->textPosY;
+    s32 glyph = Font_GetCharGlyph(&msgCtx->font, texture);
+    void* page = NULL;
+    s32 t = 0;
+
+    gDPPipeSync(gfx++);
+
+    if (glyph == FONT_GLYPH_NONE) {
+        gDPLoadTextureBlock_4b(gfx++, texture, G_IM_FMT_I, 16, 16, 0, G_TX_NOMIRROR | G_TX_CLAMP,
+                               G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMASK, G_TX_NOMASK, G_TX_NOLOD, G_TX_NOLOD);
+    } else {
+        page = Font_GetGlyphPage(glyph);
+        t = ((glyph % FONT_GLYPH_PAGE_GLYPHS) * FONT_CHAR_TEX_HEIGHT) << 5;
+
+        if ((page != sGlyphPageLoaded) || (*gfxP != sGlyphPageGfxEnd) || (play->state.frames != sGlyphPageFrame)) {
+            gDPLoadTextureBlock_4b(gfx++, page, G_IM_FMT_I, FONT_CHAR_TEX_WIDTH, FONT_GLYPH_PAGE_HEIGHT, 0,
+                                   G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMIRROR | G_TX_CLAMP, G_TX_NOMASK, G_TX_NOMASK,
+                                   G_TX_NOLOD, G_TX_NOLOD);
+        }
+    }
+
+    if ((msgCtx->textBoxType != TEXTBOX_TYPE_CLEAR) && (msgCtx->textBoxType != TEXTBOX_TYPE_NOTEBOOK_NOTIFICATION) &&
+        !play->pauseCtx.bombersNotebookOpen) {
+        gDPSetPrimColor(gfx++, 0, 0, 0, 0, 0, msgCtx->textColorAlpha);
+        gSPTextureRectangle(gfx++, (x + 1) << 2, (y + 1) << 2, (x + sCharTexSize + 1) << 2, (y + sCharTexSize + 1) << 2,
+                            G_TX_RENDERTILE, 0, t, sCharTexScale, sCharTexScale);
+        gDPPipeSync(gfx++);
+    }
+
+    gDPSetPrimColor(gfx++, 0, 0, msgCtx->textColorR, msgCtx->textColorG, msgCtx->textColorB, msgCtx->textColorAlpha);
+    gSPTextureRectangle(gfx++, x << 2, y << 2, (x + sCharTexSize) << 2, (y + sCharTexSize) << 2, G_TX_RENDERTILE, 0, t,
+                        sCharTexScale, sCharTexScale);
+
+    sGlyphPageLoaded = page;
+    sGlyphPageGfxEnd = gfx;
+    sGlyphPageFrame = play->state.frames;
+    *gfxP = gfx++;
+}
+#else
 void Message_DrawTextChar(PlayState* play, TexturePtr texture, Gfx** gfxP) {
     MessageContext* msgCtx = &play->msgCtx;
     Gfx* gfx = *gfxP;
@@ -825,6 +875,7 @@ void Message_DrawTextChar(PlayState* play, TexturePtr texture, Gfx** gfxP) {
                         sCharTexScale, sCharTexScale);
     *gfxP = gfx++;
 }
+#endif
 
 s16 sTextboxWidth = 256;
 s16 sTextboxHeight = 64;
@@ -2267,6 +2318,9 @@ void Message_Decode(PlayState* play) {
     msgCtx->textFade = 0;
     spC0 = 0.0f;
     font->unk_11D88 = (font->unk_11D88 ^ 1) & 1;
+#if MESSAGE_GLYPH_ATLAS
+    Font_ClearCharGlyphs(font);
+#endif
 
     if ((gSaveContext.options.language == LANGUAGE_JPN) && !msgCtx->textIsCredits) {
         lineNum = 0;
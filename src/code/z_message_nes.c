@@ -1041,6 +1041,9 @@ void Message_DecodeNES(PlayState* play) {
     msgCtx->textFade = false;
     spA4 = 0.0f;
     font->unk_11D88 = (font->unk_11D88 ^ 1) & 1;
+#if MESSAGE_GLYPH_ATLAS
+    Font_ClearCharGlyphs(font);
+#endif
     Message_DecodeHeader(play);
 
     while (true) {
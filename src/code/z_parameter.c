@@ -937,6 +937,9 @@ void Interface_NewDay(PlayState* play, s32 day) {
     // Loads day number from week_static for the three-day clock
     DmaMgr_RequestSync(play->interfaceCtx.doActionSegment + DO_ACTION_OFFSET_DAY_NUMBER,
                        SEGMENT_ROM_START(week_static) + i * WEEK_STATIC_TEX_SIZE, WEEK_STATIC_TEX_SIZE);
+#if HUD_LAYER_CACHE
+    play->interfaceCtx.texturesVersion++;
+#endif
 
     // i is used to store sceneId
     for (i = 0; i < ARRAY_COUNT(gSaveContext.save.saveInfo.permanentSceneFlags); i++) {
@@ -2496,6 +2499,9 @@ void Interface_LoadItemIconImpl(PlayState* play, u8 btn) {
 
     CmpDma_LoadFile(SEGMENT_ROM_START(icon_item_static_yar), GET_CUR_FORM_BTN_ITEM(btn),
                     &interfaceCtx->iconItemSegment[(u32)btn * ICON_ITEM_TEX_SIZE], ICON_ITEM_TEX_SIZE);
+#if HUD_LAYER_CACHE
+    interfaceCtx->texturesVersion++;
+#endif
 }
 
 void Interface_LoadItemIcon(PlayState* play, u8 btn) {
@@ -3307,6 +3313,9 @@ void Interface_LoadAButtonDoActionLabel(InterfaceContext* interfaceCtx, u16 doAc
         gSegments[0x09] = OS_K0_TO_PHYSICAL(interfaceCtx->doActionSegment);
         Interface_ClearBuffer(Lib_SegmentedToVirtual(sDoActionTextures[slot]), DO_ACTION_TEX_SIZE / sizeof(u32));
     }
+#if HUD_LAYER_CACHE
+    interfaceCtx->texturesVersion++;
+#endif
 }
 
 /**
@@ -3351,6 +3360,9 @@ void Interface_SetBButtonPlayerDoAction(PlayState* play, s16 bButtonDoAction) {
                                     SEGMENT_ROM_START(do_action_static) + bButtonDoAction * DO_ACTION_TEX_SIZE,
                                     DO_ACTION_TEX_SIZE, 0, &interfaceCtx->loadQueue, NULL);
                 osRecvMesg(&interfaceCtx->loadQueue, NULL, OS_MESG_BLOCK);
+#if HUD_LAYER_CACHE
+                interfaceCtx->texturesVersion++;
+#endif
             }
 
             interfaceCtx->bButtonPlayerDoActionActive = true;
@@ -3395,6 +3407,9 @@ void Interface_SetBButtonInterfaceDoAction(PlayState* play, s16 bButtonDoAction)
                         SEGMENT_ROM_START(do_action_static) + bButtonDoAction * DO_ACTION_TEX_SIZE, DO_ACTION_TEX_SIZE,
                         0, &interfaceCtx->loadQueue, NULL);
     osRecvMesg(&interfaceCtx->loadQueue, NULL, OS_MESG_BLOCK);
+#if HUD_LAYER_CACHE
+    interfaceCtx->texturesVersion++;
+#endif
 
     interfaceCtx->bButtonInterfaceDoActionActive = true;
 }
@@ -4620,6 +4635,10 @@ void Interface_DrawClock(PlayState* play) {
         }
 
         if (!IS_PAUSED(&play->pauseCtx)) {
+#if HUD_LAYER_CACHE
+            // The face of the clock is kept by the renderer, the sun, moon and hours move every frame
+            gNspOverlayLayer(OVERLAY_DISP++, HUD_LAYER_CLOCK, interfaceCtx->texturesVersion);
+#endif
             Gfx_SetupDL39_Overlay(play->state.gfxCtx);
 
             /**
@@ -4651,6 +4670,9 @@ void Interface_DrawClock(PlayState* play) {
 
             if (((CURRENT_DAY >= 4) || ((CURRENT_DAY == 3) && (CURRENT_TIME >= (CLOCK_TIME(0, 0) + 5)) &&
                                         (CURRENT_TIME < CLOCK_TIME(6, 0))))) {
+#if HUD_LAYER_CACHE
+                gNspLayer(OVERLAY_DISP++, G_NSP_LAYER_END);
+#endif
                 Gfx_SetupDL42_Overlay(play->state.gfxCtx);
                 gSPMatrix(OVERLAY_DISP++, &gIdentityMtx, G_MTX_NOPUSH | G_MTX_LOAD | G_MTX_MODELVIEW);
             } else {
@@ -4753,6 +4775,9 @@ void Interface_DrawClock(PlayState* play) {
                 OVERLAY_DISP = Gfx_DrawTexRectIA8(
                     OVERLAY_DISP, interfaceCtx->doActionSegment + DO_ACTION_OFFSET_DAY_NUMBER, WEEK_STATIC_TEX_WIDTH,
                     WEEK_STATIC_TEX_HEIGHT, 137, 192, WEEK_STATIC_TEX_WIDTH, WEEK_STATIC_TEX_HEIGHT, 1 << 10, 1 << 10);
+#if HUD_LAYER_CACHE
+                gNspLayer(OVERLAY_DISP++, G_NSP_LAYER_END);
+#endif
 
                 /**
                  * Section: Draw Three-Day Clock's Star (for the Minute Tracker)
@@ -6400,6 +6425,12 @@ void Interface_Draw(PlayState* play) {
 
         LifeMeter_Draw(play);
 
+#if HUD_LAYER_CACHE
+        // The renderer draws each part of the HUD from what it drew the last time while its commands stay the
+        // same. It can't see the textures loaded into the interface segments change, the key changes with them
+        gNspOverlayLayer(OVERLAY_DISP++, HUD_LAYER_COUNTERS, interfaceCtx->texturesVersion);
+#endif
+
         Gfx_SetupDL39_Overlay(play->state.gfxCtx);
 
         // Draw Rupee Icon
@@ -6580,13 +6611,23 @@ void Interface_Draw(PlayState* play) {
                                 1 << 10, 1 << 10);
         }
 
+#if HUD_LAYER_CACHE
+        gNspLayer(OVERLAY_DISP++, G_NSP_LAYER_END);
+        gNspOverlayLayer(OVERLAY_DISP++, HUD_LAYER_MAGIC, interfaceCtx->texturesVersion);
+#endif
         Magic_DrawMeter(play);
+#if HUD_LAYER_CACHE
+        gNspLayer(OVERLAY_DISP++, G_NSP_LAYER_END);
+#endif
         Map_DrawMinimap(play);
 
         if ((R_PAUSE_BG_PRERENDER_STATE != 2) && (R_PAUSE_BG_PRERENDER_STATE != 3)) {
             Attention_Draw(&play->actorCtx.attention, play);
         }
 
+#if HUD_LAYER_CACHE
+        gNspOverlayLayer(OVERLAY_DISP++, HUD_LAYER_BUTTONS, interfaceCtx->texturesVersion);
+#endif
         Gfx_SetupDL39_Overlay(play->state.gfxCtx);
 
         Interface_DrawItemButtons(play);
@@ -6596,7 +6637,14 @@ void Interface_Draw(PlayState* play) {
         }
         Interface_DrawCButtonIcons(play);
 
+#if HUD_LAYER_CACHE
+        gNspLayer(OVERLAY_DISP++, G_NSP_LAYER_END);
+        gNspOverlayLayer(OVERLAY_DISP++, HUD_LAYER_A_BUTTON, interfaceCtx->texturesVersion);
+#endif
         Interface_DrawAButton(play);
+#if HUD_LAYER_CACHE
+        gNspLayer(OVERLAY_DISP++, G_NSP_LAYER_END);
+#endif
 
         Interface_DrawPauseMenuEquippingIcons(play);
 
@@ -37,6 +37,11 @@ u8 sMotionBlurStatus;
 #include "overlays/gamestates/ovl_file_choose/z_file_select.h"
 #include "libu64/debug.h"
 
+#if INPUT_REPLAY
+// Records the seed, or returns the one recorded in its place, see replay_nsp.c
+u32 nsp_replay_seed(u32 seed);
+#endif
+
 s32 gDbgCamEnabled = false;
 u8 D_801D0D54 = false;
 
@@ -405,6 +410,9 @@ void Play_Destroy(GameState* thisx) {
     Effect_DestroyAll(this);
     EffectSs_ClearAll(this);
     CollisionCheck_DestroyContext(this, &this->colChkCtx);
+#if ROOM_PREFETCH
+    Room_FinishPrefetch(&this->roomCtx);
+#endif
 
     if (gTransitionTileState == TRANS_TILE_READY) {
         TransitionTile_Destroy(&sTransitionTile);
@@ -996,6 +1004,9 @@ void Play_UpdateMain(PlayState* this) {
                     }
                 } else {
                     Room_ProcessRoomRequest(this, &this->roomCtx);
+#if ROOM_PREFETCH
+                    Room_PrefetchNextRoom(this, &this->roomCtx);
+#endif
                     CollisionCheck_AT(this, &this->colChkCtx);
                     CollisionCheck_OC(this, &this->colChkCtx);
                     CollisionCheck_Damage(this, &this->colChkCtx);
@@ -1135,12 +1146,24 @@ void Play_DrawMain(PlayState* this) {
     Vec3f temp;
     u8 sp25B = false;
     f32 zFar;
+#if DRAW_SKIP
+    u8 skipDraw;
+#endif
 
     if (R_PAUSE_BG_PRERENDER_STATE >= PAUSE_BG_PRERENDER_UNK4) {
         PreRender_ApplyFiltersSlowlyDestroy(&this->pauseBgPreRender);
         R_PAUSE_BG_PRERENDER_STATE = PAUSE_BG_PRERENDER_OFF;
     }
 
+#if DRAW_SKIP
+    // A frame that will be dropped leaves out the sky, the rooms, the lights and the screen fills, whose drawing only
+    // builds display lists. The actors, the environment, the interface and the messages are still drawn: their draws
+    // place colliders and body parts, and step timers and fades. Frames that save or restore the color buffer are
+    // built whole.
+    skipDraw = gGraphSkipDraw && (R_PAUSE_BG_PRERENDER_STATE == PAUSE_BG_PRERENDER_OFF) &&
+               (gTransitionTileState == TRANS_TILE_OFF) && (R_PICTO_PHOTO_STATE == PICTO_PHOTO_STATE_OFF);
+
+#endif
     if ((R_PAUSE_BG_PRERENDER_STATE <= PAUSE_BG_PRERENDER_SETUP) && (gTransitionTileState <= TRANS_TILE_SETUP)) {
         if (this->skyboxCtx.shouldDraw || (this->roomCtx.curRoom.roomShape->base.type == ROOM_SHAPE_TYPE_IMAGE)) {
             func_8012CF0C(gfxCtx, false, true, 0, 0, 0);
@@ -1282,9 +1305,17 @@ void Play_DrawMain(PlayState* this) {
                     if (((u32)this->skyboxId != SKYBOX_NONE) && !this->envCtx.skyboxDisabled) {
                         if ((this->skyboxId == SKYBOX_NORMAL_SKY) || (this->skyboxId == SKYBOX_3)) {
                             Environment_UpdateSkybox(this->skyboxId, &this->envCtx, &this->skyboxCtx);
+#if DRAW_SKIP
+                            if (!skipDraw) {
+                                Skybox_Draw(&this->skyboxCtx, gfxCtx, this->skyboxId, this->envCtx.skyboxBlend,
+                                            this->view.eye.x, this->view.eye.y, this->view.eye.z);
+                            }
+                        } else if (!this->skyboxCtx.shouldDraw && !skipDraw) {
+#else
                             Skybox_Draw(&this->skyboxCtx, gfxCtx, this->skyboxId, this->envCtx.skyboxBlend,
                                         this->view.eye.x, this->view.eye.y, this->view.eye.z);
                         } else if (!this->skyboxCtx.shouldDraw) {
+#endif
                             Skybox_Draw(&this->skyboxCtx, gfxCtx, this->skyboxId, 0, this->view.eye.x, this->view.eye.y,
                                         this->view.eye.z);
                         }
@@ -1293,6 +1324,18 @@ void Play_DrawMain(PlayState* this) {
                     Environment_Draw(this);
                 }
 
+#if DRAW_SKIP
+                if (!skipDraw) {
+                    lights = LightContext_NewLights(&this->lightCtx, gfxCtx);
+
+                    if (this->roomCtx.curRoom.enablePosLights || (MREG(93) != 0)) {
+                        lights->enablePosLights = true;
+                    }
+
+                    Lights_BindAll(lights, this->lightCtx.listHead, NULL, this);
+                    Lights_Draw(lights, gfxCtx);
+                }
+#else
                 lights = LightContext_NewLights(&this->lightCtx, gfxCtx);
 
                 if (this->roomCtx.curRoom.enablePosLights || (MREG(93) != 0)) {
@@ -1301,19 +1344,42 @@ void Play_DrawMain(PlayState* this) {
 
                 Lights_BindAll(lights, this->lightCtx.listHead, NULL, this);
                 Lights_Draw(lights, gfxCtx);
+#endif
 
                 if (1) {
                     //! FAKE:
                     u32 roomDrawFlags = ((1) ? 1 : 0) | (((void)0, 1) ? 2 : 0);
 
+#if DRAW_SKIP
+                    // Scene draw configs may set collision flags, they run either way
+#endif
                     Scene_Draw(this);
                     if (this->roomCtx.unk78) {
+#if DRAW_SKIP
+                        if (!skipDraw) {
+                            Room_Draw(this, &this->roomCtx.curRoom, roomDrawFlags & 3);
+                            Room_Draw(this, &this->roomCtx.prevRoom, roomDrawFlags & 3);
+                        } else {
+                            // The segment the actors find the room in, as Room_Draw leaves it
+                            if (this->roomCtx.curRoom.segment != NULL) {
+                                gSegments[0x03] = OS_K0_TO_PHYSICAL(this->roomCtx.curRoom.segment);
+                            }
+                            if (this->roomCtx.prevRoom.segment != NULL) {
+                                gSegments[0x03] = OS_K0_TO_PHYSICAL(this->roomCtx.prevRoom.segment);
+                            }
+                        }
+#else
                         Room_Draw(this, &this->roomCtx.curRoom, roomDrawFlags & 3);
                         Room_Draw(this, &this->roomCtx.prevRoom, roomDrawFlags & 3);
+#endif
                     }
                 }
 
+#if DRAW_SKIP
+                if (this->skyboxCtx.shouldDraw && !skipDraw) {
+#else
                 if (this->skyboxCtx.shouldDraw) {
+#endif
                     Vec3f quakeOffset;
 
                     if (1) {
@@ -1323,12 +1389,20 @@ void Play_DrawMain(PlayState* this) {
                     }
                 }
 
+#if DRAW_SKIP
+                if ((this->envCtx.precipitation[PRECIP_RAIN_CUR] != 0) && !skipDraw) {
+#else
                 if (this->envCtx.precipitation[PRECIP_RAIN_CUR] != 0) {
+#endif
                     Environment_DrawRain(this, &this->view, gfxCtx);
                 }
             }
 
+#if DRAW_SKIP
+            if (!skipDraw) {
+#else
             if (1) {
+#endif
                 Environment_FillScreen(gfxCtx, 0, 0, 0, this->bgCoverAlpha, FILL_SCREEN_OPA);
             }
 
@@ -1347,7 +1421,11 @@ void Play_DrawMain(PlayState* this) {
                 Environment_DrawCustomLensFlare(this);
             }
 
+#if DRAW_SKIP
+            if (!skipDraw) {
+#else
             if (1) {
+#endif
                 if (R_PLAY_FILL_SCREEN_ON) {
                     Environment_FillScreen(gfxCtx, R_PLAY_FILL_SCREEN_R, R_PLAY_FILL_SCREEN_G, R_PLAY_FILL_SCREEN_B,
                                            R_PLAY_FILL_SCREEN_ALPHA, FILL_SCREEN_OPA | FILL_SCREEN_XLU);
@@ -1371,11 +1449,19 @@ void Play_DrawMain(PlayState* this) {
                 }
             }
 
+#if DRAW_SKIP
+            if ((this->worldCoverAlpha != 0) && !skipDraw) {
+#else
             if (this->worldCoverAlpha != 0) {
+#endif
                 Environment_FillScreen(gfxCtx, 0, 0, 0, this->worldCoverAlpha, FILL_SCREEN_OPA | FILL_SCREEN_XLU);
             }
 
+#if DRAW_SKIP
+            if (!skipDraw) {
+#else
             if (1) {
+#endif
                 DebugDisplay_DrawObjects(this);
             }
 
@@ -1436,7 +1522,11 @@ SkipPostWorldDraw:
         }
     }
 
+#if DRAW_SKIP
+    if (!sp25B && !skipDraw) {
+#else
     if (!sp25B) {
+#endif
         Environment_DrawSkyboxStars(this);
     }
 
@@ -2258,7 +2348,11 @@ void Play_Init(GameState* thisx) {
     D_801D0D54 = false;
 
     FrameAdvance_Init(&this->frameAdvCtx);
+#if INPUT_REPLAY
+    Rand_Seed(nsp_replay_seed(osGetTime()));
+#else
     Rand_Seed(osGetTime());
+#endif
     Matrix_Init(&this->state);
 
     this->state.main = Play_Main;
@@ -43,6 +43,17 @@ DistortionRequest sDistortionRequest;
 static s16 sQuakeUnused = 1;
 static s16 sQuakeRequestCount = 0;
 
+#if QUAKE_ACTIVE_MASK
+/**
+ * Bit i is set while `sQuakeRequests[i]` is in use. Unlike `sQuakeRequestCount`, which is counted up again when
+ * `Quake_RequestImpl` takes over a request still in use and then never gets back to 0, it lets `Quake_Update` return
+ * right away on every frame without quakes.
+ */
+static u8 sQuakeActiveMask = 0;
+
+#define QUAKE_ALL_ACTIVE ((1 << ARRAY_COUNT(sQuakeRequests)) - 1)
+#endif
+
 f32 Quake_Random(void) {
     return 2.0f * (Rand_ZeroOne() - 0.5f);
 }
@@ -158,6 +169,13 @@ s16 Quake_GetFreeIndex(void) {
     s32 index = 0;
     s32 timerMin = UINT16_MAX + 1; // timer is a short, so start with a value beyond its range
 
+#if QUAKE_ACTIVE_MASK
+    if (sQuakeActiveMask != QUAKE_ALL_ACTIVE) {
+        for (i = 0; sQuakeActiveMask & (1 << i); i++) {}
+        return i;
+    }
+#endif
+
     for (i = 0; i < ARRAY_COUNT(sQuakeRequests); i++) {
         if (sQuakeRequests[i].type == QUAKE_TYPE_NONE) {
             index = i;
@@ -189,6 +207,9 @@ QuakeRequest* Quake_RequestImpl(Camera* camera, u32 type) {
     req->index = index + (TRUNCF_BINANG(Rand_ZeroOne() * 0x10000) & ~3);
 
     sQuakeRequestCount++;
+#if QUAKE_ACTIVE_MASK
+    sQuakeActiveMask |= 1 << index;
+#endif
 
     return req;
 }
@@ -197,6 +218,9 @@ void Quake_Remove(QuakeRequest* req) {
     req->type = QUAKE_TYPE_NONE;
     req->timer = -1;
     sQuakeRequestCount--;
+#if QUAKE_ACTIVE_MASK
+    sQuakeActiveMask &= ~(1 << (req - sQuakeRequests));
+#endif
 }
 
 QuakeRequest* Quake_GetRequest(s16 index) {
@@ -371,6 +395,9 @@ void Quake_Init(void) {
     }
     sQuakeUnused = 1;
     sQuakeRequestCount = 0;
+#if QUAKE_ACTIVE_MASK
+    sQuakeActiveMask = 0;
+#endif
 }
 
 s16 Quake_Request(Camera* camera, u32 type) {
@@ -425,16 +452,28 @@ s16 Quake_Update(Camera* camera, ShakeInfo* camShake) {
     camShake->fovOffset = 0;
     camShake->maxOffset = 0.0f;
 
+#if QUAKE_ACTIVE_MASK
+    if (sQuakeActiveMask == 0) {
+        return 0;
+    }
+#else
     if (sQuakeRequestCount == 0) {
         return 0;
     }
+#endif
 
     numQuakesApplied = 0;
     for (index = 0; index < ARRAY_COUNT(sQuakeRequests); index++) {
         req = &sQuakeRequests[index];
+#if QUAKE_ACTIVE_MASK
+        if (!(sQuakeActiveMask & (1 << index))) {
+            continue;
+        }
+#else
         if (req->type == QUAKE_TYPE_NONE) {
             continue;
         }
+#endif
 
         if (play->cameraPtrs[req->camId] == NULL) {
             Quake_Remove(req);
@@ -557,6 +557,123 @@ size_t Room_SetupFirstRoom(PlayState* play, RoomContext* roomCtx) {
     return roomBufferSize;
 }
 
+#if ROOM_PREFETCH
+/**
+ * While the player is near a transition actor of the current room, the room on its other side is read ahead into the
+ * free page of the room buffer, at the address Room_RequestNewRoom would load it to. Requesting that room then only
+ * waits for what is left of the read, if anything. The read is queued in chunks, so that a port servicing DMAs between
+ * frames under a time budget spreads it over several frames instead of stalling the one crossing the door.
+ */
+#define ROOM_PREFETCH_RANGE 500.0f
+#define ROOM_PREFETCH_CHUNK_SIZE 0x4000
+#define ROOM_PREFETCH_MAX_CHUNKS 16
+
+static s8 sRoomPrefetchNum = -1; // room read ahead into the free page, -1 if none
+static u8 sRoomPrefetchPage;     // the value of activeBufPage it was read for
+static u8 sRoomPrefetchPending;  // its last chunk hasn't been received from sRoomPrefetchQueue yet
+static u8 sRoomPrefetchRequested; // Room_RequestNewRoom took it while pending, see Room_ProcessRoomRequest
+static DmaRequest sRoomPrefetchRequests[ROOM_PREFETCH_MAX_CHUNKS];
+static OSMesgQueue sRoomPrefetchQueue;
+static OSMesg sRoomPrefetchMsg[1];
+
+// Read and reset by the port's frame profiling
+u32 gRoomPrefetchHits;
+u32 gRoomPrefetchMisses;
+
+static void* Room_GetRequestAddr(RoomContext* roomCtx, size_t size) {
+    return (void*)(ALIGN16((uintptr_t)roomCtx->bufPtrs[roomCtx->activeBufPage] - (size + 8) * roomCtx->activeBufPage -
+                           7));
+}
+
+/**
+ * Starts reading ahead the room behind the nearest transition actor of the current room within ROOM_PREFETCH_RANGE of
+ * the player. Only done while no room request is in progress and the previous room no longer holds the free page.
+ */
+void Room_PrefetchNextRoom(PlayState* play, RoomContext* roomCtx) {
+    Player* player = GET_PLAYER(play);
+    TransitionActorEntry* transitionActor = play->transitionActors.list;
+    f32 nearestDistSq = SQ(ROOM_PREFETCH_RANGE);
+    s32 nextRoom = -1;
+    size_t size;
+    size_t chunkSize;
+    size_t offset;
+    u8* addr;
+    s32 i;
+
+    if ((roomCtx->status != 0) || (roomCtx->prevRoom.segment != NULL) || (roomCtx->curRoom.num < 0) ||
+        (player == NULL)) {
+        return;
+    }
+
+    if (sRoomPrefetchPending) {
+        if (osRecvMesg(&sRoomPrefetchQueue, NULL, OS_MESG_NOBLOCK) != 0) {
+            return;
+        }
+        sRoomPrefetchPending = false;
+    }
+
+    for (i = 0; i < play->transitionActors.count; i++, transitionActor++) {
+        s32 otherRoom;
+        f32 distSq;
+
+        if (transitionActor->sides[0].room == roomCtx->curRoom.num) {
+            otherRoom = transitionActor->sides[1].room;
+        } else if (transitionActor->sides[1].room == roomCtx->curRoom.num) {
+            otherRoom = transitionActor->sides[0].room;
+        } else {
+            continue;
+        }
+
+        if ((otherRoom < 0) || (otherRoom == roomCtx->curRoom.num)) {
+            continue;
+        }
+
+        distSq = SQ(player->actor.world.pos.x - transitionActor->pos.x) +
+                 SQ(player->actor.world.pos.y - transitionActor->pos.y) +
+                 SQ(player->actor.world.pos.z - transitionActor->pos.z);
+        if (distSq < nearestDistSq) {
+            nearestDistSq = distSq;
+            nextRoom = otherRoom;
+        }
+    }
+
+    if ((nextRoom < 0) || ((nextRoom == sRoomPrefetchNum) && (roomCtx->activeBufPage == sRoomPrefetchPage))) {
+        return;
+    }
+
+    // Room_SetupFirstRoom sized the buffer for the two rooms of any transition actor, so it fits beside this one
+    size = play->roomList.romFiles[nextRoom].vromEnd - play->roomList.romFiles[nextRoom].vromStart;
+    addr = Room_GetRequestAddr(roomCtx, size);
+    chunkSize = MAX(ROOM_PREFETCH_CHUNK_SIZE, ALIGN16((size + ROOM_PREFETCH_MAX_CHUNKS - 1) / ROOM_PREFETCH_MAX_CHUNKS));
+
+    osCreateMesgQueue(&sRoomPrefetchQueue, sRoomPrefetchMsg, ARRAY_COUNT(sRoomPrefetchMsg));
+    for (offset = 0, i = 0; offset < size; offset += chunkSize, i++) {
+        size_t curSize = MIN(chunkSize, size - offset);
+
+        // Chunks complete in order, the last one tells the whole room is in
+        DmaMgr_RequestAsync(&sRoomPrefetchRequests[i], addr + offset,
+                            play->roomList.romFiles[nextRoom].vromStart + offset, curSize, 0,
+                            (offset + curSize == size) ? &sRoomPrefetchQueue : NULL, NULL);
+    }
+
+    sRoomPrefetchNum = nextRoom;
+    sRoomPrefetchPage = roomCtx->activeBufPage;
+    sRoomPrefetchPending = true;
+}
+
+/**
+ * Waits for the read ahead to finish and forgets it, for when the room buffer is about to be freed.
+ */
+void Room_FinishPrefetch(RoomContext* roomCtx) {
+    if (sRoomPrefetchPending) {
+        osRecvMesg(&sRoomPrefetchQueue, NULL, OS_MESG_BLOCK);
+        sRoomPrefetchPending = false;
+    }
+    sRoomPrefetchNum = -1;
+    sRoomPrefetchRequested = false;
+}
+#endif
+
 /**
  * Tries to create an asynchronous request to transfer room data into memory.
  * If successful, the requested room will be loaded into memory and becomes the new current room; the room that was
@@ -587,8 +704,26 @@ s32 Room_RequestNewRoom(PlayState* play, RoomContext* roomCtx, s32 index) {
                                                    (size + 8) * roomCtx->activeBufPage - 7));
 
         osCreateMesgQueue(&roomCtx->loadQueue, roomCtx->loadMsg, ARRAY_COUNT(roomCtx->loadMsg));
+#if ROOM_PREFETCH
+        if ((index == sRoomPrefetchNum) && (roomCtx->activeBufPage == sRoomPrefetchPage)) {
+            // Already at roomRequestAddr, or on its way there
+            if (sRoomPrefetchPending) {
+                sRoomPrefetchRequested = true;
+            } else {
+                osSendMesg(&roomCtx->loadQueue, NULL, OS_MESG_NOBLOCK);
+            }
+            gRoomPrefetchHits++;
+        } else {
+            // A pending read ahead completes before this request, and is received by Room_PrefetchNextRoom
+            DmaMgr_RequestAsync(&roomCtx->dmaRequest, roomCtx->roomRequestAddr,
+                                play->roomList.romFiles[index].vromStart, size, 0, &roomCtx->loadQueue, NULL);
+            gRoomPrefetchMisses++;
+        }
+        sRoomPrefetchNum = -1;
+#else
         DmaMgr_RequestAsync(&roomCtx->dmaRequest, roomCtx->roomRequestAddr, play->roomList.romFiles[index].vromStart,
                             size, 0, &roomCtx->loadQueue, NULL);
+#endif
         roomCtx->activeBufPage ^= 1;
 
         return true;
@@ -605,6 +740,13 @@ s32 Room_RequestNewRoom(PlayState* play, RoomContext* roomCtx, s32 index) {
  */
 s32 Room_ProcessRoomRequest(PlayState* play, RoomContext* roomCtx) {
     if (roomCtx->status == 1) {
+#if ROOM_PREFETCH
+        if (sRoomPrefetchRequested && (osRecvMesg(&sRoomPrefetchQueue, NULL, OS_MESG_NOBLOCK) == 0)) {
+            sRoomPrefetchPending = false;
+            sRoomPrefetchRequested = false;
+            osSendMesg(&roomCtx->loadQueue, NULL, OS_MESG_NOBLOCK);
+        }
+#endif
         if (osRecvMesg(&roomCtx->loadQueue, NULL, OS_MESG_NOBLOCK) == 0) {
             roomCtx->status = 0;
             roomCtx->curRoom.segment = roomCtx->roomRequestAddr;
@@ -20,10 +20,37 @@ void AnimTask_Interp(struct PlayState* play, AnimTaskData* data);
 void AnimTask_CopyUsingMap(struct PlayState* play, AnimTaskData* data);
 void AnimTask_CopyUsingMapInverted(struct PlayState* play, AnimTaskData* data);
 void AnimTask_ActorMovement(struct PlayState* play, AnimTaskData* data);
+#if ANIM_FUSED // anim_nsp.c
+void SkelAnime_InterpFrameTable(s32 limbCount, Vec3s* dst, Vec3s* start, Vec3s* target, f32 weight);
+void SkelAnime_GetFrameDataInterp(AnimationHeader* animation, s32 frame, s32 nextFrame, f32 frameWeight,
+                                  Vec3s* morphTable, f32 morphWeight, s32 limbCount, Vec3s* frameTable);
+#endif
 
 s32 sCurAnimTaskGroup;
 s32 sDisabledTransformTaskGroups;
 
+#if SKEL_LOD_FORCE
+// Set while a skeleton is drawn with its far display lists by `SkelAnime_GetForcedLod`
+s32 sSkelLodForced;
+
+/**
+ * Draws the far display lists of a LOD skeleton its actor would draw near, once it is further from the camera than
+ * `SkelAnime_GetLodDist`. Limbs without a far display list keep their near one. The player picks its own LOD, and
+ * cutscenes are drawn as they are.
+ */
+s32 SkelAnime_GetForcedLod(PlayState* play, Actor* actor, s32 lod) {
+    f32 dist = SkelAnime_GetLodDist();
+
+    if ((lod != 0) || (dist <= 0.0f) || (actor == NULL) || (actor->category == ACTORCAT_PLAYER) ||
+        (play->csCtx.state != CS_STATE_IDLE) || (actor->projectedPos.z <= dist)) {
+        return lod;
+    }
+
+    sSkelLodForced = true;
+    return 1;
+}
+#endif
+
 /*
  * Draws the limb at `limbIndex` with a level of detail display lists index by `dListIndex`
  */
@@ -46,6 +73,11 @@ void SkelAnime_DrawLimbLod(PlayState* play, s32 limbIndex, void** skeleton, Vec3
     pos.z = limb->jointPos.z;
 
     dList = limb->dLists[lod];
+#if SKEL_LOD_FORCE
+    if (sSkelLodForced && (dList == NULL)) {
+        dList = limb->dLists[0];
+    }
+#endif
     if ((overrideLimbDraw == NULL) || !overrideLimbDraw(play, limbIndex, &dList, &pos, &rot, actor)) {
         Matrix_TranslateRotateZYX(&pos, &rot);
         if (dList != NULL) {
@@ -91,6 +123,10 @@ void SkelAnime_DrawLod(PlayState* play, void** skeleton, Vec3s* jointTable, Over
         return;
     }
 
+#if SKEL_LOD_FORCE
+    lod = SkelAnime_GetForcedLod(play, actor, lod);
+#endif
+
     OPEN_DISPS(play->state.gfxCtx);
 
     Matrix_Push();
@@ -102,6 +138,11 @@ void SkelAnime_DrawLod(PlayState* play, void** skeleton, Vec3s* jointTable, Over
 
     rot = jointTable[LIMB_ROOT_ROT];
     dList = rootLimb->dLists[lod];
+#if SKEL_LOD_FORCE
+    if (sSkelLodForced && (dList == NULL)) {
+        dList = rootLimb->dLists[0];
+    }
+#endif
 
     if ((overrideLimbDraw == NULL) || !overrideLimbDraw(play, 1, &dList, &pos, &rot, actor)) {
         Matrix_TranslateRotateZYX(&pos, &rot);
@@ -125,6 +166,9 @@ void SkelAnime_DrawLod(PlayState* play, void** skeleton, Vec3s* jointTable, Over
     }
 
     Matrix_Pop();
+#if SKEL_LOD_FORCE
+    sSkelLodForced = false;
+#endif
 
     CLOSE_DISPS(play->state.gfxCtx);
 }
@@ -156,6 +200,11 @@ void SkelAnime_DrawFlexLimbLod(PlayState* play, s32 limbIndex, void** skeleton,
     pos.z = limb->jointPos.z;
 
     newDList = limbDList = limb->dLists[lod];
+#if SKEL_LOD_FORCE
+    if (sSkelLodForced && (limbDList == NULL)) {
+        newDList = limbDList = limb->dLists[0];
+    }
+#endif
 
     if ((overrideLimbDraw == NULL) || !overrideLimbDraw(play, limbIndex, &newDList, &pos, &rot, actor)) {
         Matrix_TranslateRotateZYX(&pos, &rot);
@@ -209,6 +258,10 @@ void SkelAnime_DrawFlexLod(PlayState* play, void** skeleton, Vec3s* jointTable,
         return;
     }
 
+#if SKEL_LOD_FORCE
+    lod = SkelAnime_GetForcedLod(play, actor, lod);
+#endif
+
     OPEN_DISPS(play->state.gfxCtx);
 
     gSPSegment(POLY_OPA_DISP++, 0x0D, mtx);
@@ -222,6 +275,11 @@ void SkelAnime_DrawFlexLod(PlayState* play, void** skeleton, Vec3s* jointTable,
     rot = jointTable[LIMB_ROOT_ROT];
 
     newDList = limbDList = rootLimb->dLists[lod];
+#if SKEL_LOD_FORCE
+    if (sSkelLodForced && (limbDList == NULL)) {
+        newDList = limbDList = rootLimb->dLists[0];
+    }
+#endif
 
     if ((overrideLimbDraw == NULL) || !overrideLimbDraw(play, 1, &newDList, &pos, &rot, actor)) {
         Matrix_TranslateRotateZYX(&pos, &rot);
@@ -248,6 +306,9 @@ void SkelAnime_DrawFlexLod(PlayState* play, void** skeleton, Vec3s* jointTable,
     }
 
     Matrix_Pop();
+#if SKEL_LOD_FORCE
+    sSkelLodForced = false;
+#endif
 
     CLOSE_DISPS(play->state.gfxCtx);
 }
@@ -929,6 +990,7 @@ s16 Animation_GetLastFrameLegacy(LegacyAnimationHeader* animation) {
     return animHeader->frameCount - 1;
 }
 
+#if !ANIM_FUSED // anim_nsp.c
 /**
  * Linearly interpolates the start and target frame tables with the given weight, putting the result in dst
  */
@@ -957,6 +1019,7 @@ void SkelAnime_InterpFrameTable(s32 limbCount, Vec3s* dst, Vec3s* start, Vec3s*
         }
     }
 }
+#endif
 
 /**
  * Clear the current task queue. The discarded tasks will then not be processed.
@@ -1224,6 +1287,7 @@ void AnimTask_ActorMovement(PlayState* play, AnimTaskData* data) {
     actor->world.pos.z += diff.z * actor->scale.z * task->diffScale;
 }
 
+#if !ANIM_FUSED // anim_nsp.c
 typedef void (*AnimTaskFunc)(struct PlayState* play, AnimTaskData* data);
 
 /**
@@ -1246,6 +1310,7 @@ void AnimTaskQueue_Update(PlayState* play, AnimTaskQueue* animTaskQueue) {
     sCurAnimTaskGroup = 1 << 0;
     sDisabledTransformTaskGroups = 0;
 }
+#endif
 
 /**
  * Initializes a skeleton to be used with Player animations to a looping animation, dynamically allocating the frame
@@ -1725,6 +1790,32 @@ s32 SkelAnime_MorphTaper(SkelAnime* skelAnime) {
  * Gets frame data for the current frame as modified by morphTable and advances the morph
  */
 void SkelAnime_AnimateFrame(SkelAnime* skelAnime) {
+#if ANIM_FUSED
+    s32 frame = skelAnime->curFrame;
+    s32 nextFrame = -1;
+    f32 partialFrame = 0.0f;
+    Vec3s* morphTable = NULL;
+
+    if (skelAnime->mode & ANIM_INTERP) {
+        partialFrame = skelAnime->curFrame - frame;
+        nextFrame = frame + 1;
+        if (nextFrame >= (s32)skelAnime->animLength) {
+            nextFrame = 0;
+        }
+    }
+    if (skelAnime->morphWeight != 0) {
+        f32 updateRate = gFramerateDivisorThird;
+
+        skelAnime->morphWeight -= skelAnime->morphRate * updateRate;
+        if (skelAnime->morphWeight <= 0.0f) {
+            skelAnime->morphWeight = 0.0f;
+        } else {
+            morphTable = skelAnime->morphTable;
+        }
+    }
+    SkelAnime_GetFrameDataInterp(skelAnime->animation, frame, nextFrame, partialFrame, morphTable,
+                                 skelAnime->morphWeight, skelAnime->limbCount, skelAnime->jointTable);
+#else
     Vec3s nextjointTable[100];
 
     SkelAnime_GetFrameData(skelAnime->animation, skelAnime->curFrame, skelAnime->limbCount, skelAnime->jointTable);
@@ -1751,6 +1842,7 @@ void SkelAnime_AnimateFrame(SkelAnime* skelAnime) {
                                        skelAnime->morphTable, skelAnime->morphWeight);
         }
     }
+#endif
 }
 /**
  * Advances an animation that loops over its full length and updates the frame tables
@@ -3,6 +3,9 @@
 #include "stdbool.h"
 
 #include "global.h"
+#if SKIN_VTX_CACHE
+#include "string.h"
+#endif
 #include "gfx.h"
 #include "sys_matrix.h"
 #include "z64actor.h"
@@ -48,6 +51,32 @@ void Skin_UpdateVertices(MtxF* mtx, SkinVertex* skinVertices, SkinLimbModif* mod
     mtx->zw = wTemp.z;
 }
 
+#if SKIN_VTX_CACHE
+/**
+ * Hashes what the vertices of a limb are computed from: the matrices of the limbs its modifications transform them
+ * by, and `arg3`
+ */
+u32 Skin_GetLimbModifKey(SkinLimbModif* modifications, s32 modifCount, s32 arg3) {
+    SkinLimbModif* modif;
+    u32 key = 0x811C9DC5 ^ (arg3 != 0);
+
+    for (modif = modifications; modif < &modifications[modifCount]; modif++) {
+        SkinTransformation* limbTransformations = Lib_SegmentedToVirtual(modif->limbTransformations);
+        s32 i;
+
+        for (i = 0; i < modif->transformCount; i++) {
+            u32* words = (u32*)gSkinLimbMatrices[limbTransformations[i].limbIndex].mf;
+            s32 j;
+
+            for (j = 0; j < 4 * 4; j++) {
+                key = (key ^ words[j]) * 0x01000193;
+            }
+        }
+    }
+    return key;
+}
+#endif
+
 void Skin_ApplyLimbModifications(GraphicsContext* gfxCtx, Skin* skin, s32 limbIndex, s32 arg3) {
     s32 modifCount;
     SkinLimb** skeleton;
@@ -81,6 +110,25 @@ void Skin_ApplyLimbModifications(GraphicsContext* gfxCtx, Skin* skin, s32 limbIn
     vtxBuf = vtxEntry->buf[vtxEntry->index];
     modifCount = data->limbModifCount;
 
+#if SKIN_VTX_CACHE
+    {
+        u32 key = Skin_GetLimbModifKey(modifications, modifCount, arg3);
+
+        // Matrices that didn't change since the vertices were computed leave them as they are. The buffer about to
+        // be drawn only needs a copy of the other one, until both hold them
+        if ((vtxEntry->numCurrent != 0) && (vtxEntry->modifKey == key)) {
+            if (vtxEntry->numCurrent == 1) {
+                memcpy(vtxBuf, vtxEntry->buf[vtxEntry->index == 0], data->totalVtxCount * sizeof(Vtx));
+                vtxEntry->numCurrent = 2;
+            }
+            modifCount = 0;
+        } else {
+            vtxEntry->modifKey = key;
+            vtxEntry->numCurrent = 1;
+        }
+    }
+#endif
+
     for (modif = modifications; modif < &modifications[modifCount]; modif++) {
         Vec3f spAC;
         Vec3f spA0;
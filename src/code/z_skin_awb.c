@@ -67,6 +67,9 @@ void Skin_Init(GameState* gameState, Skin* skin, SkeletonHeader* skeletonHeader,
 
             vtxEntry->buf[0] = NULL;
             vtxEntry->buf[1] = NULL;
+#if SKIN_VTX_CACHE
+            vtxEntry->numCurrent = 0;
+#endif
         } else {
             SkinAnimatedLimbData* animatedLimbData =
                 Lib_SegmentedToVirtual((((SkinLimb*)Lib_SegmentedToVirtual(skeleton[i]))->segment));
@@ -76,6 +79,9 @@ void Skin_Init(GameState* gameState, Skin* skin, SkeletonHeader* skeletonHeader,
             vtxEntry->index = 0;
             vtxEntry->buf[0] = ZeldaArena_Malloc(animatedLimbData->totalVtxCount * sizeof(Vtx));
             vtxEntry->buf[1] = ZeldaArena_Malloc(animatedLimbData->totalVtxCount * sizeof(Vtx));
+#if SKIN_VTX_CACHE
+            vtxEntry->numCurrent = 0;
+#endif
 
             Skin_InitAnimatedLimb(gameState, skin, i);
         }
@@ -24,6 +24,19 @@ void SkinMatrix_Vec3fMtxFMultXYZW(MtxF* mf, Vec3f* src, Vec3f* xyzDest, f32* wDe
     *wDest = mf->ww + ((src->x * mf->wx) + (src->y * mf->wy) + (src->z * mf->wz));
 }
 
+#if ACTOR_CULL_BATCH && !MATRIX_FIXED // matrix_nsp.c
+/**
+ * `SkinMatrix_Vec3fMtxFMultXYZW` over arrays of count points.
+ */
+void SkinMatrix_Vec3fMtxFMultXYZWBatch(MtxF* mf, Vec3f* src, Vec3f* xyzDest, f32* wDest, s32 count) {
+    s32 i;
+
+    for (i = 0; i < count; i++) {
+        SkinMatrix_Vec3fMtxFMultXYZW(mf, &src[i], &xyzDest[i], &wDest[i]);
+    }
+}
+#endif
+
 /**
  * Multiplies a 4 component row vector [ src , 1 ] by the matrix mf and writes the resulting xyz components to dest.
  *
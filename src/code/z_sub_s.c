@@ -503,12 +503,27 @@ Path* SubS_GetAdditionalPath(PlayState* play, u8 pathIndex, s32 limit) {
  */
 Actor* SubS_FindNearestActor(Actor* actor, PlayState* play, u8 actorCategory, s16 actorId) {
     Actor* actorIter = NULL;
+#if !ACTOR_ID_INDEX
     Actor* actorTmp;
+#endif
     f32 dist;
     Actor* closestActor = NULL;
     f32 minDist = 99999.0f;
     s32 isSetup = false;
 
+#if ACTOR_ID_INDEX
+    for (actorIter = Actor_FindFirstById(&play->actorCtx, actorId, actorCategory); actorIter != NULL;
+         actorIter = Actor_FindNextById(actorIter, actorCategory)) {
+        if (actorIter != actor) {
+            dist = Actor_WorldDistXYZToActor(actor, actorIter);
+            if (!isSetup || dist < minDist) {
+                closestActor = actorIter;
+                minDist = dist;
+                isSetup = true;
+            }
+        }
+    }
+#else
     do {
         actorIter = SubS_FindActor(play, actorIter, actorCategory, actorId);
 
@@ -529,6 +544,7 @@ Actor* SubS_FindNearestActor(Actor* actor, PlayState* play, u8 actorCategory, s1
 
         actorIter = actorIter->next;
     } while (actorIter != NULL);
+#endif
 
     return closestActor;
 }
@@ -1190,7 +1206,11 @@ Actor* SubS_FindActor(PlayState* play, Actor* actorListStart, u8 actorCategory,
     Actor* actor = actorListStart;
 
     if (actor == NULL) {
+#if ACTOR_ID_INDEX
+        return Actor_FindFirstById(&play->actorCtx, actorId, actorCategory);
+#else
         actor = play->actorCtx.actorLists[actorCategory].first;
+#endif
     }
 
     while ((actor != NULL) && (actorId != actor->id)) {
@@ -334,6 +334,9 @@ void Skybox_Reload(PlayState* play, SkyboxContext* skyboxCtx, s16 skyboxId) {
                                 SEGMENT_ROM_START(d2_fine_pal_static), size, 0, &skyboxCtx->loadQueue, NULL);
 
             osRecvMesg(&skyboxCtx->loadQueue, NULL, OS_MESG_BLOCK);
+#if SKYBOX_LAYER_CACHE
+            skyboxCtx->texturesVersion++;
+#endif
             break;
 
         default:
@@ -346,6 +349,9 @@ void Skybox_Init(GameState* gameState, SkyboxContext* skyboxCtx, s16 skyboxId) {
     skyboxCtx->rot.x = skyboxCtx->rot.y = skyboxCtx->rot.z = 0.0f;
 
     Skybox_Setup(gameState, skyboxCtx, skyboxId);
+#if SKYBOX_LAYER_CACHE
+    skyboxCtx->texturesVersion++;
+#endif
 
     if (skyboxId != SKYBOX_NONE) {
         skyboxCtx->dListBuf = THA_AllocTailAlign16(&gameState->tha, 12 * 150 * sizeof(Gfx));
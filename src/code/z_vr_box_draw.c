@@ -23,6 +23,13 @@ void Skybox_SetColors(SkyboxContext* skyboxCtx, u8 primR, u8 primG, u8 primB, u8
 void Skybox_Draw(SkyboxContext* skyboxCtx, GraphicsContext* gfxCtx, s16 skyboxId, s16 blend, f32 x, f32 y, f32 z) {
     OPEN_DISPS(gfxCtx);
 
+#if SKYBOX_LAYER_CACHE
+    // The renderer copies the sky back from the last frame while its commands, the camera and
+    // the textures stay the same. The frontend only sees the textures' addresses, the key
+    // changes with what is loaded at them
+    gNspLayerKey(POLY_OPA_DISP++, G_NSP_LAYER_BEGIN, skyboxCtx->texturesVersion);
+#endif
+
     Gfx_SetupDL40_Opa(gfxCtx);
 
     gSPSegment(POLY_OPA_DISP++, 0x0B, skyboxCtx->palette);
@@ -69,6 +76,10 @@ void Skybox_Draw(SkyboxContext* skyboxCtx, GraphicsContext* gfxCtx, s16 skyboxId
 
     gDPPipeSync(POLY_OPA_DISP++);
 
+#if SKYBOX_LAYER_CACHE
+    gNspLayer(POLY_OPA_DISP++, G_NSP_LAYER_END);
+#endif
+
     CLOSE_DISPS(gfxCtx);
 }
 
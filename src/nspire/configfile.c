@@ -34,12 +34,37 @@ bool configFiltering = false;
 bool configEnableFog = false;
 bool config120pMode = true;
 bool config80pMode = false;
+bool configAdaptiveQuality = false; // pick resolution and frameskip from the frame times
 bool configSkipZTest = false;
 bool configAffineMode = false;
+bool configBinnedRaster = false; // draw triangles tile by tile
+bool configDlCache = true; // replay the display lists loaded from the ROM from a compiled form
+bool configPrerenderAA = false; // run the VI anti-aliasing filter over the pause menu background
 bool configOverclock = true;
+bool configProfileHud = false; // print the frame timings and counters over the game
+bool configProfileCsv = false; // append them to mm-nsp-prof.csv.tns every frame
+bool configAudio = false; // run the sequences and mix them, for builds with an audio output
+bool configGfxPoolFit = false; // size the display list buffers from this run's peaks when the game exits
+bool configInputRecord = false; // write the controller reads to mm-nsp-input.rec.tns
+bool configInputReplay = false; // play them back from it and log the frame times, see replay_nsp.c
 unsigned int configPerspSpan = 8;     // perspective correct every N pixels (0 = every pixel)
-unsigned int configFlatShadeDist = 0; // distance threshold for flat shading (0 = disabled)
+unsigned int configFlatShadeDist = 0; // distance past which textured triangles get one color (0 = disabled)
+unsigned int configLodTextureDist = 0; // distance past which textures are drawn as their average color (0 = disabled)
+unsigned int configLodCullArea = 0;   // sixteenths of a pixel under which triangles aren't drawn (0 = disabled)
+unsigned int configLodTriBudget = 0;  // triangles a frame before the LOD distances come closer (0 = no limit)
 unsigned int configFrameskip = 4;     // worst case scenario, renders 1 out of every (X + 1) frames
+unsigned int configFramePacing = 0;   // ms a game frame, drop renders only when behind (0 = fixed skip)
+unsigned int configAudioVoices = 16;  // notes mixed at once, the quietest are dropped
+unsigned int configAudioRate = 16000; // output sample rate in Hz
+unsigned int configAudioBudget = 6;   // ms of mixing a frame before voices are dropped (0 = no limit)
+unsigned int configDmaBudget = 64;    // KB of queued ROM reads a frame, object and room loads (0 = no limit)
+unsigned int configGfxPoolOpaKb = 0;  // KB of each of the two opaque display list buffers (0 = N64 size)
+unsigned int configGfxPoolXluKb = 0;  // KB of each of the two translucent display list buffers (0 = N64 size)
+unsigned int configGfxPoolOverlayKb = 0; // KB of each of the two overlay display list buffers (0 = N64 size)
+unsigned int configEnvEffectBudget = 100; // % of the N64 rain, star and lens flare amounts, halved per lower resolution
+unsigned int configActorUpdateLod = 0; // distance past which NPCs, props and idle enemies update less often (0 = disabled)
+unsigned int configSkelLodDist = 0; // camera distance past which LOD skeletons draw their far model (0 = disabled)
+unsigned int configDrawDistance = 100; // % of the scenes' draw distance, fog and actor culling distances
 
 // Keyboard mappings (scancode values)
 #ifdef TARGET_DOS
@@ -80,12 +105,37 @@ static const struct ConfigOption options[] = {
     { .name = "enable_fog", .type = CONFIG_TYPE_BOOL, .boolValue = &configEnableFog },
     { .name = "enable_120p_mode", .type = CONFIG_TYPE_BOOL, .boolValue = &config120pMode },
     { .name = "enable_80p_mode", .type = CONFIG_TYPE_BOOL, .boolValue = &config80pMode },
+    { .name = "adaptive_quality", .type = CONFIG_TYPE_BOOL, .boolValue = &configAdaptiveQuality },
     { .name = "skip_z_test", .type = CONFIG_TYPE_BOOL, .boolValue = &configSkipZTest },
     { .name = "affine_mode", .type = CONFIG_TYPE_BOOL, .boolValue = &configAffineMode },
+    { .name = "binned_raster", .type = CONFIG_TYPE_BOOL, .boolValue = &configBinnedRaster },
+    { .name = "dl_cache", .type = CONFIG_TYPE_BOOL, .boolValue = &configDlCache },
+    { .name = "prerender_aa", .type = CONFIG_TYPE_BOOL, .boolValue = &configPrerenderAA },
     { .name = "overclock", .type = CONFIG_TYPE_BOOL, .boolValue = &configOverclock },
+    { .name = "profile_hud", .type = CONFIG_TYPE_BOOL, .boolValue = &configProfileHud },
+    { .name = "profile_csv", .type = CONFIG_TYPE_BOOL, .boolValue = &configProfileCsv },
     { .name = "persp_span", .type = CONFIG_TYPE_UINT, .uintValue = &configPerspSpan },
     { .name = "flat_shade_dist", .type = CONFIG_TYPE_UINT, .uintValue = &configFlatShadeDist },
+    { .name = "lod_texture_dist", .type = CONFIG_TYPE_UINT, .uintValue = &configLodTextureDist },
+    { .name = "lod_cull_area", .type = CONFIG_TYPE_UINT, .uintValue = &configLodCullArea },
+    { .name = "lod_tri_budget", .type = CONFIG_TYPE_UINT, .uintValue = &configLodTriBudget },
     { .name = "frameskip", .type = CONFIG_TYPE_UINT, .uintValue = &configFrameskip },
+    { .name = "frame_pacing", .type = CONFIG_TYPE_UINT, .uintValue = &configFramePacing },
+    { .name = "audio", .type = CONFIG_TYPE_BOOL, .boolValue = &configAudio },
+    { .name = "audio_voices", .type = CONFIG_TYPE_UINT, .uintValue = &configAudioVoices },
+    { .name = "audio_rate", .type = CONFIG_TYPE_UINT, .uintValue = &configAudioRate },
+    { .name = "audio_budget", .type = CONFIG_TYPE_UINT, .uintValue = &configAudioBudget },
+    { .name = "dma_budget", .type = CONFIG_TYPE_UINT, .uintValue = &configDmaBudget },
+    { .name = "gfx_pool_fit", .type = CONFIG_TYPE_BOOL, .boolValue = &configGfxPoolFit },
+    { .name = "input_record", .type = CONFIG_TYPE_BOOL, .boolValue = &configInputRecord },
+    { .name = "input_replay", .type = CONFIG_TYPE_BOOL, .boolValue = &configInputReplay },
+    { .name = "gfx_pool_opa_kb", .type = CONFIG_TYPE_UINT, .uintValue = &configGfxPoolOpaKb },
+    { .name = "gfx_pool_xlu_kb", .type = CONFIG_TYPE_UINT, .uintValue = &configGfxPoolXluKb },
+    { .name = "gfx_pool_overlay_kb", .type = CONFIG_TYPE_UINT, .uintValue = &configGfxPoolOverlayKb },
+    { .name = "env_effect_budget", .type = CONFIG_TYPE_UINT, .uintValue = &configEnvEffectBudget },
+    { .name = "actor_update_lod", .type = CONFIG_TYPE_UINT, .uintValue = &configActorUpdateLod },
+    { .name = "skel_lod_dist", .type = CONFIG_TYPE_UINT, .uintValue = &configSkelLodDist },
+    { .name = "draw_distance", .type = CONFIG_TYPE_UINT, .uintValue = &configDrawDistance },
     { .name = "key_a", .type = CONFIG_TYPE_UINT, .uintValue = &configKeyA },
     { .name = "key_b", .type = CONFIG_TYPE_UINT, .uintValue = &configKeyB },
     { .name = "key_start", .type = CONFIG_TYPE_UINT, .uintValue = &configKeyStart },
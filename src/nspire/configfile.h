@@ -8,12 +8,37 @@ extern bool configFiltering;
 extern bool configEnableFog;
 extern bool config120pMode;
 extern bool config80pMode;
+extern bool configAdaptiveQuality;
 extern bool configSkipZTest;
 extern bool configAffineMode;
+extern bool configBinnedRaster;
+extern bool configDlCache;
+extern bool configPrerenderAA;
 extern bool configOverclock;
+extern bool configProfileHud;
+extern bool configProfileCsv;
+extern bool configAudio;
+extern bool configGfxPoolFit;
+extern bool configInputRecord;
+extern bool configInputReplay;
 extern unsigned int configPerspSpan;
 extern unsigned int configFlatShadeDist;
+extern unsigned int configLodTextureDist;
+extern unsigned int configLodCullArea;
+extern unsigned int configLodTriBudget;
 extern unsigned int configFrameskip;
+extern unsigned int configFramePacing;
+extern unsigned int configAudioVoices;
+extern unsigned int configAudioRate;
+extern unsigned int configAudioBudget;
+extern unsigned int configDmaBudget;
+extern unsigned int configGfxPoolOpaKb;
+extern unsigned int configGfxPoolXluKb;
+extern unsigned int configGfxPoolOverlayKb;
+extern unsigned int configEnvEffectBudget;
+extern unsigned int configActorUpdateLod;
+extern unsigned int configSkelLodDist;
+extern unsigned int configDrawDistance;
 extern unsigned int configKeyA;
 extern unsigned int configKeyB;
 extern unsigned int configKeyStart;
@@ -26,6 +26,42 @@ typedef int64_t fix64;
 
 #define FIX_INV(fix) ((1ULL << 63) / (fix) << 1) // only loses one bit of precision (?)
 
+#if defined(__arm__) && !defined(__thumb__)
+// The ARM926 has no 64x64 multiply, so GCC builds the C versions below out of several UMULL and MLA
+// plus carry handling. Every product here is 32x32 and accumulates straight into the 64-bit result
+// with UMLAL instead. The halves are multiplied unsigned, and the sign of each high word is fixed
+// up after the fact, since only the low 64 bits of the result are kept
+
+static inline fix64 fix_mult(const fix64 fix1, const fix64 fix2) { // multiply 2 fixes, return fix
+    const uint32_t f1 = (uint32_t) fix1, f2 = (uint32_t) fix2;
+    const int32_t i1 = (int32_t) (fix1 >> 32), i2 = (int32_t) (fix2 >> 32);
+    uint32_t lo, hi, tmp;
+    __asm__("umull %[tmp], %[lo], %[f1], %[f2]\n\t"
+            "mov %[hi], #0\n\t"
+            "umlal %[lo], %[hi], %[i1], %[f2]\n\t"
+            "umlal %[lo], %[hi], %[f1], %[i2]\n\t"
+            "mla %[hi], %[i1], %[i2], %[hi]"
+            : [tmp] "=&r"(tmp), [lo] "=&r"(lo), [hi] "=&r"(hi)
+            : [f1] "r"(f1), [f2] "r"(f2), [i1] "r"(i1), [i2] "r"(i2));
+    hi -= ((uint32_t) (i1 >> 31) & f2) + ((uint32_t) (i2 >> 31) & f1);
+    return (fix64) ((uint64_t) hi << 32 | lo);
+}
+
+static inline int32_t fix_mult_i64(const fix64 fix1, const fix64 fix2) { // return integer part,
+                                                                          // skips decimal * decimal
+    const uint32_t f1 = (uint32_t) fix1, f2 = (uint32_t) fix2;
+    const int32_t i1 = (int32_t) (fix1 >> 32), i2 = (int32_t) (fix2 >> 32);
+    uint32_t lo, hi;
+    __asm__("umull %[lo], %[hi], %[i1], %[f2]\n\t"
+            "umlal %[lo], %[hi], %[f1], %[i2]\n\t"
+            "mla %[hi], %[i1], %[i2], %[hi]"
+            : [lo] "=&r"(lo), [hi] "=&r"(hi)
+            : [f1] "r"(f1), [f2] "r"(f2), [i1] "r"(i1), [i2] "r"(i2));
+    return (int32_t) (hi - (((uint32_t) (i1 >> 31) & f2) + ((uint32_t) (i2 >> 31) & f1)));
+}
+
+#else
+
 static inline fix64 fix_mult(const fix64 fix1, const fix64 fix2) { // multiply 2 fixes, return fix
     fix64 i1 = GET_INT(fix1);
     fix64 f1 = GET_FRAC(fix1);
@@ -46,6 +82,8 @@ static inline int32_t fix_mult_i64(const fix64 fix1,
     return (int32_t) i1 * (int32_t) i2 + (int32_t) ((i1 * f2 + i2 * f1) >> 32);
 }
 
+#endif
+
 static inline int32_t fix_mult_i32(const fix64 fix1,
                                    const fix64 fix2) { // save more time by "casting" to 16.16 fixed
                                                        // point. Loss of precision, obviously
@@ -196,9 +234,194 @@ static inline fix64 fix_recip(const fix64 denom) {
     return neg ? -result : result;
 }
 
+// Seeds of fix_div_fast: 2 / (1 + m) in Q1.15 for the middle of each 1/256th of m in [0, 1)
+#define FIX_RECIP_SEED(i) ((uint16_t) (32768.0 * 2 / (1 + ((i) + 0.5) / 256) + 0.5))
+#define FIX_RECIP_SEED8(i)                                                                             \
+    FIX_RECIP_SEED(i), FIX_RECIP_SEED(i + 1), FIX_RECIP_SEED(i + 2), FIX_RECIP_SEED(i + 3),            \
+        FIX_RECIP_SEED(i + 4), FIX_RECIP_SEED(i + 5), FIX_RECIP_SEED(i + 6), FIX_RECIP_SEED(i + 7)
+#define FIX_RECIP_SEED64(i)                                                                            \
+    FIX_RECIP_SEED8(i), FIX_RECIP_SEED8(i + 8), FIX_RECIP_SEED8(i + 16), FIX_RECIP_SEED8(i + 24),      \
+        FIX_RECIP_SEED8(i + 32), FIX_RECIP_SEED8(i + 40), FIX_RECIP_SEED8(i + 48), FIX_RECIP_SEED8(i + 56)
+static const uint16_t fix_recip_seed[256] = {
+    FIX_RECIP_SEED64(0),
+    FIX_RECIP_SEED64(64),
+    FIX_RECIP_SEED64(128),
+    FIX_RECIP_SEED64(192),
+};
+
+// Approximate division: num / denom, both in 32.32 fixed point, to about 18 significant bits.
+// fix_div_s calls libgcc's 64-bit division and then loops over the 32 fractional bits, this takes
+// the top 32 bits of both, seeds 1/denom from a table, refines it with one Newton-Raphson step and
+// multiplies, with 32x32->64 multiplies only. fix_div_s stays for the results that have to be exact
+static inline fix64 fix_div_fast(const fix64 num, const fix64 denom) {
+    if (denom == 0)
+        return (num >= 0) ? FIX_MAX : FIX_MIN;
+    if (num == 0)
+        return 0;
+
+    int neg = 0;
+    uint64_t a = (uint64_t) num;
+    uint64_t b = (uint64_t) denom;
+    if (num < 0) {
+        a = (uint64_t) (-(int64_t) a);
+        neg ^= 1;
+    }
+    if (denom < 0) {
+        b = (uint64_t) (-(int64_t) b);
+        neg ^= 1;
+    }
+
+    // Normalize: bn is the top of b in [0.5, 1) in Q0.32, an the top of a
+    const int sb = fix_clz64(b);
+    const uint32_t bn = (uint32_t) ((b << sb) >> 32);
+    const int sa = fix_clz64(a);
+    const uint32_t an = (uint32_t) ((a << sa) >> 32);
+
+    // x is 1 / bn in Q2.30, from the seed of the 8 bits below the top one and one Newton-Raphson
+    // iteration: x = x * (2 - bn * x)
+    uint32_t x = (uint32_t) fix_recip_seed[(bn >> 23) & 0xFF] << 15;
+    const uint32_t dx = (uint32_t) (((uint64_t) bn * x) >> 32);
+    x = (uint32_t) (((uint64_t) x * (0x80000000U - dx)) >> 30);
+
+    // a is an << (32 - sa) and b is bn << (32 - sb), so (a << 32) / b is (an * x) << (sb - sa - 30)
+    const uint64_t q = (uint64_t) an * x;
+    const int e = sb - sa - 30;
+    uint64_t result;
+    if (e >= 0) {
+        if (e >= 63 || q > ((uint64_t) FIX_MAX >> e))
+            return neg ? FIX_MIN : FIX_MAX;
+        result = q << e;
+    } else {
+        result = (e <= -64) ? 0 : q >> -e;
+    }
+
+    return neg ? -(fix64) result : (fix64) result;
+}
+
 // Keep float-based division as a fallback for non-performance-critical paths
 static inline fix64 fix_div_slow(const fix64 num, const fix64 denom) {
     return (fix64) ((float) num / FIX_2_FLOAT(denom));
 }
 
+// 16.16 fixed point, for stages whose values stay within +-32767. The ARM926 has no 64-bit ALU,
+// so an add is a single instruction and a multiply a single SMULL
+typedef int32_t fix32;
+
+#define FIX32_FRAC_WIDTH 16
+
+#define FIX32_ONE (1 << FIX32_FRAC_WIDTH)
+#define FIX32_ONE_HALF (1 << (FIX32_FRAC_WIDTH - 1))
+#define FIX32_MAX INT32_MAX
+#define FIX32_MIN INT32_MIN
+
+#define FIX32_2_INT(fix) ((fix) >> FIX32_FRAC_WIDTH) // non rounding
+#define INT_2_FIX32(num) ((fix32) (num) << FIX32_FRAC_WIDTH)
+#define FIX32_2_FIX64(fix) ((fix64) (fix) << (FRAC_WIDTH - FIX32_FRAC_WIDTH))
+
+static inline fix32 fix32_from_fix64(const fix64 fix) { // rounds, saturates instead of wrapping
+    const fix64 narrow = (fix + (1LL << (FRAC_WIDTH - FIX32_FRAC_WIDTH - 1)))
+                         >> (FRAC_WIDTH - FIX32_FRAC_WIDTH);
+    return (narrow > FIX32_MAX) ? FIX32_MAX : (narrow < FIX32_MIN) ? FIX32_MIN : (fix32) narrow;
+}
+
+static inline fix32 fix32_mult(const fix32 fix1, const fix32 fix2) { // multiply 2 fixes, return fix
+    return (fix32) (((int64_t) fix1 * fix2) >> FIX32_FRAC_WIDTH);
+}
+
+static inline int32_t fix32_mult_i(const fix32 fix1, const fix32 fix2) { // return integer part,
+                                                                          // the high word of SMULL
+    return (int32_t) (((int64_t) fix1 * fix2) >> 32);
+}
+
+static inline int fix_clz32(uint32_t x) {
+    if (x == 0)
+        return 32;
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clz(x);
+#else
+    return fix_clz64(x) - 32;
+#endif
+}
+
+// Fast reciprocal: computes FIX32_ONE / x using Newton-Raphson with 32x32->64 multiplies only.
+// Two iterations are enough for the 16 fractional bits
+static inline fix32 fix32_recip(const fix32 denom) {
+    if (denom == 0)
+        return FIX32_MAX;
+
+    int neg = 0;
+    uint32_t d = (uint32_t) denom;
+    if (denom < 0) {
+        d = (uint32_t) (-(int64_t) denom);
+        neg = 1;
+    }
+
+    // Normalize: dn is d in [0.5, 1) in Q0.32
+    const int shift = fix_clz32(d);
+    const uint32_t dn = d << shift;
+
+    // Initial estimate in Q2.30: 48/17 - 32/17 * dn
+    uint32_t x = 0xB4B4B4B4U - (uint32_t) (((uint64_t) dn * 0x78787878U) >> 32);
+
+    // Newton-Raphson iteration: x = x * (2 - dn * x), all in Q2.30
+    for (int i = 0; i < 2; i++) {
+        const uint32_t dx = (uint32_t) (((uint64_t) dn * x) >> 32);
+        x = (uint32_t) (((uint64_t) x * (0x80000000U - dx)) >> 30);
+    }
+
+    // x is 2^30 / dn, and FIX32_ONE / denom is 2^32 / d = (x << shift) >> 30
+    const uint64_t result = (shift >= 30) ? ((uint64_t) x << (shift - 30)) : (x >> (30 - shift));
+    if (result > FIX32_MAX)
+        return neg ? FIX32_MIN : FIX32_MAX;
+    return neg ? -(fix32) result : (fix32) result;
+}
+
+// Precision of the screen space stages: the vertex buffer given to the rasterizer and what it steps
+// per pixel. Matrices, lighting and clipping always use fix64, and so do the per-triangle setup and
+// the edge walking of the rasterizer, which happen rarely enough and need the fractional bits.
+//
+// Building with FIX_RASTER_16_16=1 makes these fix32. The properties divided by w, and 1/w itself,
+// are then scaled by 2^FIXR_W_SHIFT to keep about 11 bits of 1/w for distant geometry, and the
+// perspective correction divides the scale back out. A color of 255 still fits at w = 1.
+#if FIX_RASTER_16_16
+
+typedef fix32 fixr;
+
+#define FIXR_ONE FIX32_ONE
+#define FIXR_ONE_HALF FIX32_ONE_HALF
+#define FIXR_W_SHIFT 7
+
+#define FIXR_2_INT(fix) FIX32_2_INT(fix)
+#define INT_2_FIXR(num) INT_2_FIX32(num)
+#define FIXR_2_FIX(fix) FIX32_2_FIX64(fix)
+#define FIXR_2_DEPTH(fix) ((fix) - ((fix) >> 16)) // [0, 1] to [0, 65535]
+
+#define fixr_from_fix fix32_from_fix64
+#define fixr_mult fix32_mult
+#define fixr_mult_i fix32_mult_i
+#define fixr_recip fix32_recip
+
+#else
+
+typedef fix64 fixr;
+
+#define FIXR_ONE FIX_ONE
+#define FIXR_ONE_HALF FIX_ONE_HALF
+#define FIXR_W_SHIFT 0
+
+#define FIXR_2_INT(fix) FIX_2_INT(fix)
+#define INT_2_FIXR(num) INT_2_FIX(num)
+#define FIXR_2_FIX(fix) (fix)
+#define FIXR_2_DEPTH(fix) FIX_2_INT((fix) * 65535) // [0, 1] to [0, 65535]
+
+#define fixr_from_fix(fix) (fix)
+#define fixr_mult fix_mult
+#define fixr_mult_i fix_mult_i32
+#define fixr_recip fix_recip
+
+#endif
+
+// w passed to the combiners when perspective correction is off
+#define FIXR_AFFINE_W (FIXR_ONE >> FIXR_W_SHIFT)
+
 #endif
\ No newline at end of file
@@ -508,6 +508,102 @@ typedef union {
         (pkt) = (Gfx*)(_g + 1);            \
     }
 
+/*
+ * Framebuffer copies, fades and coverage reads between RGBA16 images and the
+ * color buffer, done by the renderer when the DL runs, see prerender_nsp.c.
+ * Two words: the op and the images' size, src; then the env color, dst.
+ * A NULL src or dst is the color buffer. A G_NSP_FBOP_BG draws the src
+ * background, with the TLUT in dst, at the s10.2 frame offset x << 16 | y in
+ * place of the env color.
+ */
+#define G_NSP_FBOP 0xC1 /* in the RDP triangle range, never in a DL */
+#define G_NSP_FBOP_COPY 0    /* src over dst */
+#define G_NSP_FBOP_COPY_AC 1 /* src over dst, only the src pixels with alpha */
+#define G_NSP_FBOP_FADE 2    /* src times the env color over dst, blended by the env alpha */
+#define G_NSP_FBOP_CVG 3     /* the coverage of src into the I8 dst */
+#define G_NSP_FBOP_BG 4      /* the CI8 src through the RGBA16 TLUT dst, or the RGBA16 src, over the color buffer */
+
+#define gNspFramebufferOp(pkt, op, width, height, env, src, dst)                            \
+    {                                                                                        \
+        Gfx* _g = (Gfx*)(pkt);                                                               \
+        _g[0].w0 = (G_NSP_FBOP << 24) | ((op) << 20) | ((width) << 10) | (height);           \
+        _g[0].w1 = (uint32_t)(uintptr_t)(src);                                               \
+        _g[1].w0 = (env);                                                                    \
+        _g[1].w1 = (uint32_t)(uintptr_t)(dst);                                               \
+        (pkt) = (Gfx*)(_g + 2);                                                              \
+    }
+
+/*
+ * A layer: the color buffer as the commands up to the G_NSP_LAYER_END leave
+ * it. The renderer keeps it while the commands, and the data they point to,
+ * stay the same from frame to frame, and copies it back instead of drawing
+ * them, see layer_nsp.c. The key of a G_NSP_LAYER_BEGIN stands for what the
+ * renderer can't see changing, like texels loaded again at the same address.
+ *
+ * An overlay layer only keeps what its commands draw, with how much of what
+ * is under it shows through, and is drawn over whatever the frame has under
+ * it: the HUD over the 3D scene. Its id, below 8, tells the renderer which
+ * one it is from frame to frame. It ends with a G_NSP_LAYER_END too.
+ */
+#define G_NSP_LAYER 0xC2 /* in the RDP triangle range, never in a DL */
+#define G_NSP_LAYER_BEGIN 0
+#define G_NSP_LAYER_END 1
+#define G_NSP_LAYER_OVERLAY 2
+
+#define gNspLayerKey(pkt, op, key)                  \
+    {                                               \
+        Gfx* _g = (Gfx*)(pkt);                      \
+        _g->w0 = (G_NSP_LAYER << 24) | (op);        \
+        _g->w1 = (key);                             \
+        (pkt) = (Gfx*)(_g + 1);                     \
+    }
+
+#define gNspLayer(pkt, op) gNspLayerKey(pkt, op, 0)
+
+#define gNspOverlayLayer(pkt, id, key)                                    \
+    {                                                                     \
+        Gfx* _g = (Gfx*)(pkt);                                            \
+        _g->w0 = (G_NSP_LAYER << 24) | ((id) << 8) | G_NSP_LAYER_OVERLAY; \
+        _g->w1 = (key);                                                   \
+        (pkt) = (Gfx*)(_g + 1);                                           \
+    }
+
+/*
+ * Screen transition fills over the color buffer, done by the renderer when
+ * the DL runs with a span loop instead of a full screen rectangle through
+ * the rasterizer and combiner, see transition_nsp.c. Three words: the op
+ * and its params, the color; then two words each for the mask.
+ *
+ * G_NSP_FILL_BLEND draws the color over the frame at its alpha.
+ * G_NSP_FILL_MASK draws it at the alpha of an I4 mask texture times the
+ * color's alpha, or of its inverse with G_NSP_FILL_INVERT. The texture is
+ * sampled as a full screen texrect samples it: from s, t in s21.10 texels
+ * from the tile's origin, stepping by the s5.10 dsdx, dtdy per N64 pixel,
+ * through a tile 2 << masks by 2 << maskt texels, clamped and mirrored once.
+ */
+#define G_NSP_FILL 0xC3 /* in the RDP triangle range, never in a DL */
+#define G_NSP_FILL_BLEND 0
+#define G_NSP_FILL_MASK 1
+#define G_NSP_FILL_INVERT (1 << 8)
+
+#define gNspFill(pkt, op, params, color, s, t, dxdy, tex)          \
+    {                                                               \
+        Gfx* _g = (Gfx*)(pkt);                                      \
+        _g[0].w0 = (G_NSP_FILL << 24) | ((op) << 20) | (params);    \
+        _g[0].w1 = (color);                                         \
+        _g[1].w0 = (uint32_t)(s);                                   \
+        _g[1].w1 = (uint32_t)(t);                                   \
+        _g[2].w0 = (dxdy);                                          \
+        _g[2].w1 = (uint32_t)(uintptr_t)(tex);                      \
+        (pkt) = (Gfx*)(_g + 3);                                     \
+    }
+
+#define gNspFillBlend(pkt, color) gNspFill(pkt, G_NSP_FILL_BLEND, 0, color, 0, 0, 0, NULL)
+
+#define gNspFillMask(pkt, flags, masks, maskt, color, s, t, dsdx, dtdy, tex)                               \
+    gNspFill(pkt, G_NSP_FILL_MASK, (flags) | ((masks) << 4) | (maskt), color, s, t,                       \
+             ((uint32_t)(uint16_t)(dsdx) << 16) | (uint16_t)(dtdy), tex)
+
 /* Perspective normalization */
 #define gSPPerspNormalize(pkt, s) gDPNoOp(pkt)
 
@@ -0,0 +1,71 @@
+#ifndef GFX_ARM_H
+#define GFX_ARM_H
+
+#include <stdint.h>
+
+// Block store and copy helpers for the backend and the LCD upscale. On the ARM926 these burst
+// through STM/LDM four registers at a time, 32 bytes per iteration, which is one cache line and
+// what the write buffer drains best. Elsewhere they are plain loops, so a host build stays usable.
+//
+// The ARM926 runs PLD as a NOP and has none of the ARMv6 SIMD (QADD8, UQADD8...), so neither is
+// used here
+
+// stores n copies of v at dst, which must be 4 byte aligned
+static inline void arm_fill32(uint32_t *dst, const uint32_t v, int n) {
+#if defined(__arm__) && !defined(__thumb__)
+    if (n >= 8) {
+        // fixed registers so the STM lists are in ascending order
+        register uint32_t r4 __asm__("r4") = v;
+        register uint32_t r5 __asm__("r5") = v;
+        register uint32_t r6 __asm__("r6") = v;
+        register uint32_t r7 __asm__("r7") = v;
+        int blocks = n >> 3;
+        __asm__ volatile("1:\n\t"
+                         "stmia %[dst]!, {%[r4], %[r5], %[r6], %[r7]}\n\t"
+                         "stmia %[dst]!, {%[r4], %[r5], %[r6], %[r7]}\n\t"
+                         "subs %[blocks], %[blocks], #1\n\t"
+                         "bne 1b"
+                         : [dst] "+r"(dst), [blocks] "+r"(blocks)
+                         : [r4] "r"(r4), [r5] "r"(r5), [r6] "r"(r6), [r7] "r"(r7)
+                         : "cc", "memory");
+        n &= 7;
+    }
+#endif
+    while (n-- > 0)
+        *dst++ = v;
+}
+
+// stores n copies of v at dst, which must be 2 byte aligned
+static inline void arm_fill16(uint16_t *dst, const uint16_t v, int n) {
+    if (n > 0 && ((uintptr_t) dst & 2)) {
+        *dst++ = v;
+        --n;
+    }
+    arm_fill32((uint32_t *) dst, (uint32_t) v << 16 | v, n >> 1);
+    if (n & 1)
+        dst[n - 1] = v;
+}
+
+// copies n words from src to dst, both 4 byte aligned and not overlapping
+static inline void arm_copy32(uint32_t *dst, const uint32_t *src, int n) {
+#if defined(__arm__) && !defined(__thumb__)
+    if (n >= 8) {
+        int blocks = n >> 3;
+        __asm__ volatile("1:\n\t"
+                         "ldmia %[src]!, {r4, r5, r6, r7}\n\t"
+                         "stmia %[dst]!, {r4, r5, r6, r7}\n\t"
+                         "ldmia %[src]!, {r4, r5, r6, r7}\n\t"
+                         "stmia %[dst]!, {r4, r5, r6, r7}\n\t"
+                         "subs %[blocks], %[blocks], #1\n\t"
+                         "bne 1b"
+                         : [dst] "+r"(dst), [src] "+r"(src), [blocks] "+r"(blocks)
+                         :
+                         : "r4", "r5", "r6", "r7", "cc", "memory");
+        n &= 7;
+    }
+#endif
+    while (n-- > 0)
+        *dst++ = *src++;
+}
+
+#endif
@@ -15,28 +15,68 @@
 #include "gfx_frontend.h"
 #include "gfx_backend.h"
 #include "gfx_cc.h"
+#include "gfx_arm.h"
 #include "macros.h"
 
 #include "pc/fixed_pt.h"
 #include "pc/configfile.h"
+#include "pc/profiling.h"
+#if MEM_STATS
+#include "pc/memstats.h"
+#endif
 
 #define ALIGN(x, a) (((x) + (a - 1)) & ~(a - 1))
 
 #define MAX_TEXTURES 3072
 #define TEXCACHE_STEP 0x10000
 
+// binned rasterization: tile size, triangles and tile references one pass holds at most
+#define BIN_TILE_SHIFT 5
+#define BIN_TILE_SIZE (1 << BIN_TILE_SHIFT)
+#define BIN_MAX_TILES 128
+#define BIN_MAX_TRIS 256
+#define BIN_MAX_REFS 4096
+// coarse depth block size
+#define ZC_BLOCK_SHIFT 3
+#define ZC_BLOCK_SIZE (1 << ZC_BLOCK_SHIFT)
+// the texcache is carved into power of two slabs from 64 bytes to 32KB, the largest RGBA32 texture
+#define TEXCACHE_MIN_SLAB_SHIFT 6
+#define TEXCACHE_NUM_SLABS 10
+#define TEXCACHE_NONE 0xFFFFFFFF
+// box filtered levels made below a texture, and the smallest side one can have
+#define TEX_MAX_MIPS 2
+#define TEX_MIP_MIN_SIZE 4
+#define TEX_MIP_BUF_TEXELS 2048 // texels of the largest first level, a 64x128 RGBA32 texture's
+
 enum WrapType {
     WRAP_REPEAT = 0,
     WRAP_CLAMP = 1,
     WRAP_MIRROR = 2,
 };
 
+// texcache storage formats, all textures are RGBA32 unless built with TEXCACHE_16BIT=1, and CI ones
+// keep their indices and palette with TEXCACHE_CI=1
+enum TexFormat {
+    TEX_RGBA32 = 0,   // colored with translucent texels
+    TEX_RGBA5551 = 1, // colored, alpha is 0 or 255
+    TEX_IA88 = 2,     // gray, intensity in the low byte
+    TEX_I8 = 3,       // gray and opaque
+    TEX_CI4 = 4,      // two indices into 16 RGBA32 colors a byte, the first in the high nibble
+    TEX_CI8 = 5,      // indices into 256 RGBA32 colors
+};
+
 enum DrawFlags {
     DRAW_ZWRITE = 1,
     DRAW_BLEND = 2,
     DRAW_BLEND_EDGE = 4,
 };
 
+enum PerspMode {
+    PERSP_PIXEL = 0,  // perspective correct every pixel
+    PERSP_SPAN = 1,   // perspective correct every configPerspSpan pixels, lerp between
+    PERSP_AFFINE = 2, // no perspective correction
+};
+
 enum MixType {
     SH_MT_NONE = 0,
     SH_MT_COLOR = 1 << 0,
@@ -86,20 +126,22 @@ typedef union Color4 {
 } Color4;
 
 struct Tri {
-    fix64 *v0;
-    fix64 *v1;
-    fix64 *v2;
+    fixr *v0;
+    fixr *v1;
+    fixr *v2;
 };
 
 struct Texture;
 
-// texture sampling function: takes integer u,v and wraps/clamps it, samples texture, returns color
-typedef Color4 (*sample_fn_t)(const struct Texture *const, const int, const int);
 // pixel drawing function: does blending, zwriting, alpha edge checking or whatever else, then plots
 // pixel
 typedef void (*draw_fn_t)(const int idx, uint16_t uz, const Color4 src);
 // color combiner: takes float vertex properties and obtains final fragment color from them
-typedef Color4 (*combine_fn_t)(const fix64 z, const fix64 *props);
+typedef Color4 (*combine_fn_t)(const fixr z, const fixr *props);
+// scanline kernel: draws n pixels from idx on, stepping the vertex props p by dpdx
+typedef void (*scan_fn_t)(int idx, const int n, const fixr *p, const fixr *dpdx);
+// scanline kernels of one combiner for every [draw flags >> 1][z write][z test][perspective mode]
+typedef const scan_fn_t scan_tab_t[3][2][2][3];
 // rasterizer: walks the triangle and interpolates a fixed amount of vertex properties
 typedef void (*rast_fn_t)(const struct Tri tri);
 
@@ -109,8 +151,10 @@ struct ShaderProgram {
     enum MixType mix;
     uint32_t draw_flags;
     int num_props;
-    combine_fn_t combine;
+    scan_tab_t *scan; // scanline kernels with the color combiner of this shader
     rast_fn_t rast;
+    uint32_t binds; // times loaded, for the stats dumped on shutdown
+    uint32_t tris;  // triangles drawn with it
 };
 
 struct Texture {
@@ -118,13 +162,24 @@ struct Texture {
     int wrap_w, wrap_h; // size - 1 for wrapping
     bool filter;        // linear filter
     uint32_t addr;      // offset into texcache
-    sample_fn_t sample; // sampling function (does wrapping/clamping)
+    int slab;           // slab class of addr, -1 before the first upload
+    int fmt;            // storage format in texcache
+#if TEXCACHE_CI
+    uint32_t pal_addr; // offset of the palette of a CI texture into texcache, after its indices
+#endif
+    int clamp_s, clamp_t;   // ~0 if the coordinate is clamped or mirrored, 0 if it repeats
+    int mirror_s, mirror_t; // ~0 if the coordinate is mirrored
+#if TEXCACHE_MIPS
+    int mips;                           // levels below this one in the texcache
+    int mip_slab;                       // slab class of the levels, -1 if there are none
+    uint32_t mip_addr[TEX_MAX_MIPS];    // offset of every level into texcache
+#endif
 };
 
 struct Viewport {
     int x, y, w, h; // rect
-    fix64 cx, cy;   // center
-    fix64 hw, hh;   // half size
+    fixr cx, cy;    // center
+    fixr hw, hh;    // half size
     // float zn, zf, cz, hz; // FIXME: ztrick
 };
 
@@ -133,16 +188,31 @@ struct ClipRect {
     int x1, y1; // bottom right
 };
 
-uint32_t *gfx_output;
+struct TileRect {
+    uint8_t x0, y0; // first tile
+    uint8_t x1, y1; // last tile, inclusive
+};
+
+gfx_pixel_t *gfx_output;
 
-// this is set in the drawing functions
+// these are set in the drawing functions
 static draw_fn_t draw_fn;
+static scan_fn_t scan_fn;
+
+#define SHADER_POOL_SIZE 64
+#define SHADER_HASH_SIZE 128 // open addressing, kept at most half full
+#define SHADER_STATS_FILENAME "mm-nsp-shaders.csv.tns"
 
-static struct ShaderProgram shader_program_pool[0];
+static struct ShaderProgram shader_program_pool[SHADER_POOL_SIZE]; // one per color combiner at most
 static uint8_t shader_program_pool_size;
+static uint8_t shader_hash[SHADER_HASH_SIZE]; // pool index + 1, 0 for an empty slot
 static struct ShaderProgram *cur_shader = NULL;
 
 static struct Texture *cur_tex[2]; // currently selected textures for both tiles
+static struct Texture *tri_tex[2]; // what the current triangle samples, cur_tex or one of its levels
+#if TEXCACHE_MIPS
+static struct Texture tex_level[2]; // cur_tex at the level the current triangle picked
+#endif
 static struct Texture tex_hdr[MAX_TEXTURES];
 static int cur_tmu = 0; // select tile (used only for uploading)
 
@@ -150,6 +220,11 @@ static int cur_tmu = 0; // select tile (used only for uploading)
 static uint8_t *texcache;
 static uint32_t texcache_addr; // current offset into cache
 static uint32_t texcache_size; // cache capacity
+#if MEM_STATS
+static uint32_t texcache_used; // bytes of the slabs textures hold
+#endif
+// free slabs of every class, linked through their first word, TEXCACHE_NONE ends a list
+static uint32_t texcache_free[TEXCACHE_NUM_SLABS];
 
 static bool do_blend; // fragment blending toggle
 static bool do_clip;  // scissor toggle
@@ -161,21 +236,48 @@ static Color4 fog_color; // this is set by set_fog_color() calls from gfx_pc
 
 static bool z_test;    // whether to perform depth testing
 static bool z_write;   // whether to write into the Z buffer
-static fix64 z_offset; // offset for decal mode
+static int z_offset;   // depth offset for decal mode
 static uint16_t *z_buffer;
 
+// coarse depth buffer: the farthest depth of every 8x8 block of the depth buffer, so that triangles
+// and scanlines behind all of it can be rejected without walking them
+static uint16_t *zc_max;
+static uint8_t *zc_dirty;  // blocks written to since their max was last taken
+static uint16_t *zc_list;  // the dirty blocks in the order they were written to
+static int zc_list_num;
+static int zc_cols, zc_rows; // screen size in blocks
+static int zc_capacity;      // blocks the coarse depth buffers have room for
+#if DEPTH_LAZY_CLEAR
+// blocks whose depth is still what the last frame left there: the start of a frame only marks every
+// block, and a block is cleared when something first tests or writes depth in it, so the parts of
+// the screen nothing depth tested is drawn to, like the sky and the HUD, are never cleared at all
+static uint8_t *zc_stale;
+#endif
+
 static int scr_width;
 static int scr_height;
-static int scr_size; // scr_width * scr_height
+static int scr_size;     // scr_width * scr_height
+static int scr_capacity; // pixels the color and depth buffers are allocated for
 
 static int num = 0;
 
+// triangles of the current binning pass, sorted and in screen space, and the tiles they touch
+static struct Tri bin_tris[BIN_MAX_TRIS];
+static struct TileRect bin_rects[BIN_MAX_TRIS];
+static uint16_t bin_start[BIN_MAX_TILES + 1]; // where the triangles of every tile start in bin_refs
+static uint8_t bin_refs[BIN_MAX_REFS];         // indices into bin_tris, grouped by tile
+static int bin_cols, bin_rows;                 // screen size in tiles
+
 // color component interpolation table:
 // lerp(x, y, t) = x + (y - x) * t
 // the first index is x, the second is (y - x) + 256
 static uint8_t lerp_tab[256][256 * 2 + 1];
 // color component multiplication table: [x][y] = (x * y) / 256;
 static uint8_t mult_tab[256][256];
+#if TEXCACHE_16BIT
+// 5 to 8 bit color component table for RGBA5551 texels
+static uint8_t scale_5_8_tab[32];
+#endif
 // dither kernel for unreal texture filtering
 static const Vector2 dither_tab[2][2] = {
     //{ {{ 0.25f, 0.00f }}, {{ 0.50f, 0.75f }} },
@@ -192,16 +294,15 @@ static inline uint16_t u16clamp(const int v) {
     return (v < 0) ? (uint16_t) 0 : (v > 0xFFFF) ? (uint16_t) 0xFFFF : (uint16_t) v;
 }
 
-static inline int iwrap0w(const int x, const int wrap) {
-    return x & wrap;
-}
-
 static inline int iclamp0w(const int x, const int wrap) {
     return (x < 0) ? 0 : (x > wrap) ? wrap : x;
 }
 
-static inline int imirror0w(const int x, const int wrap) {
-    return iclamp0w(abs(x), wrap); // NOTE: this is not a universal solution
+// repeats (x & wrap), clamps or mirrors (clamp of abs(x), not a universal solution) x without
+// branching: the clamp is a no-op after the repeat mask and ARM does it with conditional moves
+static inline int iwrap0w(const int x, const int wrap, const int clamp, const int mirror) {
+    const int s = (x >> 31) & mirror;
+    return iclamp0w(((x ^ s) - s) & (wrap | clamp), wrap);
 }
 
 static inline fix64 fix_lerp_val(const fix64 v0, const fix64 v1, const fix64 t) {
@@ -253,6 +354,30 @@ static inline Color4 rgba_lerp(const Color4 c1, const Color4 c2, const uint8_t t
     } };
 }
 
+// packs a color into the pixel format of the color buffer
+static inline gfx_pixel_t rgba_to_pixel(const Color4 c) {
+#if OUTPUT_RGB565
+    return ((c.r & 0xF8) << 8) | ((c.g & 0xFC) << 3) | (c.b >> 3);
+#else
+    return c.c;
+#endif
+}
+
+// unpacks a pixel of the color buffer for blending
+static inline Color4 pixel_to_rgba(const gfx_pixel_t p) {
+#if OUTPUT_RGB565
+    const uint32_t r = p >> 11, g = (p >> 5) & 0x3F, b = p & 0x1F;
+    return (Color4) { {
+        .r = r << 3 | r >> 2,
+        .g = g << 2 | g >> 4,
+        .b = b << 3 | b >> 2,
+        .a = 0xFF,
+    } };
+#else
+    return (Color4) { .c = p };
+#endif
+}
+
 static inline int imin(const int a, const int b) {
     return (a < b) ? a : b;
 }
@@ -261,242 +386,247 @@ static inline int imax(const int a, const int b) {
     return (a > b) ? a : b;
 }
 
-static inline void viewport_transform(Vector4 *v) {
+static inline fix64 imax64(const fix64 a, const fix64 b) {
+    return (a > b) ? a : b;
+}
+
+static inline void viewport_transform(fixr *v) {
     // gfx_pc.c with ENABLE_SOFTRAST defined will feed us with everything already pre-multiplied by
     // inverse of w
-    v->x = fix_mult(v->x, r_view.hw) + r_view.cx + FIX_ONE_HALF;
-    v->y = fix_mult(v->y, r_view.hh) + r_view.cy + FIX_ONE_HALF;
-    // v->w is also already 1.f / v->w
+    v[0] = fixr_mult(v[0], r_view.hw) + r_view.cx + FIXR_ONE_HALF;
+    v[1] = fixr_mult(v[1], r_view.hh) + r_view.cy + FIXR_ONE_HALF;
+    // v[3] is also already 1.f / w
 }
 
 /* texture sampling functions */
 
 static inline Color4 tex_get(const struct Texture *const tex, const int x, const int y) {
+#if TEXCACHE_16BIT || TEXCACHE_CI
+    const uint8_t *texels = texcache + tex->addr;
+    const int i = y * tex->w + x;
+    switch (tex->fmt) {
+#if TEXCACHE_CI
+        case TEX_CI4: {
+            const Color4 *palette = (const Color4 *) (texcache + tex->pal_addr);
+            return palette[(texels[i >> 1] >> ((~i & 1) << 2)) & 0xF];
+        }
+        case TEX_CI8:
+            return ((const Color4 *) (texcache + tex->pal_addr))[texels[i]];
+#endif
+#if TEXCACHE_16BIT
+        case TEX_I8:
+            return (Color4) { .c = texels[i] * 0x010101u | 0xFF000000u };
+        case TEX_IA88: {
+            const uint32_t ia = ((const uint16_t *) texels)[i];
+            return (Color4) { .c = (ia & 0xFF) * 0x010101u | (ia >> 8) << 24 };
+        }
+        case TEX_RGBA5551: {
+            const uint32_t c = ((const uint16_t *) texels)[i];
+            return (Color4) { { .r = scale_5_8_tab[c >> 11],
+                                .g = scale_5_8_tab[(c >> 6) & 0x1F],
+                                .b = scale_5_8_tab[(c >> 1) & 0x1F],
+                                .a = -(c & 1) } };
+        }
+#endif
+        default:
+            return (Color4) { .c = ((const uint32_t *) texels)[i] };
+    }
+#else
     return (Color4) { .c = ((const uint32_t *) (texcache + tex->addr))[y * tex->w + x] };
+#endif
 }
 
-static Color4 tex_sample_nearest_rr(const struct Texture *const tex, const int x, const int y) {
-    return tex_get(tex, iwrap0w(x, tex->wrap_w), iwrap0w(y, tex->wrap_h));
-}
-
-static Color4 tex_sample_nearest_rc(const struct Texture *const tex, const int x, const int y) {
-    return tex_get(tex, iwrap0w(x, tex->wrap_w), iclamp0w(y, tex->wrap_h));
-}
-
-static Color4 tex_sample_nearest_rm(const struct Texture *const tex, const int x, const int y) {
-    return tex_get(tex, iwrap0w(x, tex->wrap_w), imirror0w(y, tex->wrap_h));
-}
-
-static Color4 tex_sample_nearest_cc(const struct Texture *const tex, const int x, const int y) {
-    return tex_get(tex, iclamp0w(x, tex->wrap_w), iclamp0w(y, tex->wrap_h));
-}
-
-static Color4 tex_sample_nearest_cr(const struct Texture *const tex, const int x, const int y) {
-    return tex_get(tex, iclamp0w(x, tex->wrap_w), iwrap0w(y, tex->wrap_h));
-}
-
-static Color4 tex_sample_nearest_cm(const struct Texture *const tex, const int x, const int y) {
-    return tex_get(tex, iclamp0w(x, tex->wrap_w), imirror0w(y, tex->wrap_h));
-}
-
-static Color4 tex_sample_nearest_mm(const struct Texture *const tex, const int x, const int y) {
-    return tex_get(tex, imirror0w(x, tex->wrap_w), imirror0w(y, tex->wrap_h));
-}
-
-static Color4 tex_sample_nearest_mc(const struct Texture *const tex, const int x, const int y) {
-    return tex_get(tex, imirror0w(x, tex->wrap_w), iclamp0w(y, tex->wrap_h));
-}
-
-static Color4 tex_sample_nearest_mr(const struct Texture *const tex, const int x, const int y) {
-    return tex_get(tex, imirror0w(x, tex->wrap_w), iwrap0w(y, tex->wrap_h));
+static inline Color4 tex_sample_wrap(const struct Texture *const tex, const int x, const int y) {
+    return tex_get(tex, iwrap0w(x, tex->wrap_w, tex->clamp_s, tex->mirror_s),
+                   iwrap0w(y, tex->wrap_h, tex->clamp_t, tex->mirror_t));
 }
 
-static inline Color4 tex_sample_linear(const struct Texture *const tex, const fix64 u, const fix64 v,
+static inline Color4 tex_sample_linear(const struct Texture *const tex, const fixr u, const fixr v,
                                        const Vector2 d) {
-    const int x = FIX_2_INT(d.u + u * tex->w);
-    const int y = FIX_2_INT(d.v + v * tex->h);
-    return tex->sample(tex, x, y);
+    const int x = FIXR_2_INT(fixr_from_fix(d.u) + u * tex->w);
+    const int y = FIXR_2_INT(fixr_from_fix(d.v) + v * tex->h);
+    return tex_sample_wrap(tex, x, y);
 }
 
-static inline Color4 tex_sample_nearest(const struct Texture *const tex, const fix64 u, const fix64 v) {
-    const int x = FIX_2_INT(u * tex->w);
-    const int y = FIX_2_INT(v * tex->h);
-    return tex->sample(tex, x, y);
+static inline Color4 tex_sample_nearest(const struct Texture *const tex, const fixr u, const fixr v) {
+    const int x = FIXR_2_INT(u * tex->w);
+    const int y = FIXR_2_INT(v * tex->h);
+    return tex_sample_wrap(tex, x, y);
 }
 
 /* color combiners */
 
 #define tex_sample tex_sample_nearest
 
-static Color4 combine_rgb(const fix64 z, const fix64 *props) { // 3
-    return (Color4) { { .r = fix_mult_i32(props[0], z),
-                        .g = fix_mult_i32(props[1], z),
-                        .b = fix_mult_i32(props[2], z),
+static Color4 combine_rgb(const fixr z, const fixr *props) { // 3
+    return (Color4) { { .r = fixr_mult_i(props[0], z),
+                        .g = fixr_mult_i(props[1], z),
+                        .b = fixr_mult_i(props[2], z),
                         .a = 0xFF } };
 }
 
-static Color4 combine_rgba(const fix64 z, const fix64 *props) { // 4
-    return (Color4) { { .r = fix_mult_i32(props[0], z),
-                        .g = fix_mult_i32(props[1], z),
-                        .b = fix_mult_i32(props[2], z),
-                        .a = fix_mult_i32(props[3], z) } };
+static Color4 combine_rgba(const fixr z, const fixr *props) { // 4
+    return (Color4) { { .r = fixr_mult_i(props[0], z),
+                        .g = fixr_mult_i(props[1], z),
+                        .b = fixr_mult_i(props[2], z),
+                        .a = fixr_mult_i(props[3], z) } };
 }
 
-static Color4 combine_fog_rgb(const fix64 z, const fix64 *props) { // 5
-    const uint8_t fog = fix_mult_i32(props[0], z);
-    const Color4 c = (Color4) { { .r = fix_mult_i32(props[1], z),
-                                  .g = fix_mult_i32(props[2], z),
-                                  .b = fix_mult_i32(props[3], z),
+static Color4 combine_fog_rgb(const fixr z, const fixr *props) { // 5
+    const uint8_t fog = fixr_mult_i(props[0], z);
+    const Color4 c = (Color4) { { .r = fixr_mult_i(props[1], z),
+                                  .g = fixr_mult_i(props[2], z),
+                                  .b = fixr_mult_i(props[3], z),
                                   .a = 0xFF } };
     return rgba_blend(fog_color, c, fog);
 }
 
-static Color4 combine_fog_rgba(const fix64 z, const fix64 *props) {
-    const uint8_t fog = fix_mult_i32(props[0], z);
-    const Color4 c = (Color4) { { .r = fix_mult_i32(props[1], z),
-                                  .g = fix_mult_i32(props[2], z),
-                                  .b = fix_mult_i32(props[3], z),
-                                  .a = fix_mult_i32(props[4], z) } };
+static Color4 combine_fog_rgba(const fixr z, const fixr *props) {
+    const uint8_t fog = fixr_mult_i(props[0], z);
+    const Color4 c = (Color4) { { .r = fixr_mult_i(props[1], z),
+                                  .g = fixr_mult_i(props[2], z),
+                                  .b = fixr_mult_i(props[3], z),
+                                  .a = fixr_mult_i(props[4], z) } };
     return rgba_blend(fog_color, c, fog);
 }
 
-static Color4 combine_rgba_rgba(const fix64 z, const fix64 *props) {
-    const Color4 ca = (Color4) { { .r = fix_mult_i32(props[0], z),
-                                   .g = fix_mult_i32(props[1], z),
-                                   .b = fix_mult_i32(props[2], z),
-                                   .a = fix_mult_i32(props[3], z) } };
-    const Color4 cb = (Color4) { { .r = fix_mult_i32(props[4], z),
-                                   .g = fix_mult_i32(props[5], z),
-                                   .b = fix_mult_i32(props[6], z),
-                                   .a = fix_mult_i32(props[7], z) } };
+static Color4 combine_rgba_rgba(const fixr z, const fixr *props) {
+    const Color4 ca = (Color4) { { .r = fixr_mult_i(props[0], z),
+                                   .g = fixr_mult_i(props[1], z),
+                                   .b = fixr_mult_i(props[2], z),
+                                   .a = fixr_mult_i(props[3], z) } };
+    const Color4 cb = (Color4) { { .r = fixr_mult_i(props[4], z),
+                                   .g = fixr_mult_i(props[5], z),
+                                   .b = fixr_mult_i(props[6], z),
+                                   .a = fixr_mult_i(props[7], z) } };
     return rgba_modulate(ca, cb);
 }
 
-static Color4 combine_tex(const fix64 z, const fix64 *props) {
-    return tex_sample(cur_tex[0], fix_mult(props[0], z), fix_mult(props[1], z));
+static Color4 combine_tex(const fixr z, const fixr *props) {
+    return tex_sample(tri_tex[0], fixr_mult(props[0], z), fixr_mult(props[1], z));
 }
 
-static Color4 combine_tex_fog(const fix64 z, const fix64 *props) {
-    const Color4 tc = tex_sample(cur_tex[0], fix_mult(props[0], z), fix_mult(props[1], z));
-    const uint8_t fog = fix_mult_i32(props[2], z);
+static Color4 combine_tex_fog(const fixr z, const fixr *props) {
+    const Color4 tc = tex_sample(tri_tex[0], fixr_mult(props[0], z), fixr_mult(props[1], z));
+    const uint8_t fog = fixr_mult_i(props[2], z);
     return rgba_blend(fog_color, tc, fog);
 }
 
-static Color4 combine_tex_rgb(const fix64 z, const fix64 *props) {
-    const Color4 tc = tex_sample(cur_tex[0], fix_mult(props[0], z), fix_mult(props[1], z));
-    const Color4 cc = (Color4) { { .r = fix_mult_i32(props[2], z),
-                                   .g = fix_mult_i32(props[3], z),
-                                   .b = fix_mult_i32(props[4], z),
+static Color4 combine_tex_rgb(const fixr z, const fixr *props) {
+    const Color4 tc = tex_sample(tri_tex[0], fixr_mult(props[0], z), fixr_mult(props[1], z));
+    const Color4 cc = (Color4) { { .r = fixr_mult_i(props[2], z),
+                                   .g = fixr_mult_i(props[3], z),
+                                   .b = fixr_mult_i(props[4], z),
                                    .a = 0xFF } };
     return rgba_modulate(tc, cc);
 }
 
-static Color4 combine_tex_fog_rgb(const fix64 z, const fix64 *props) {
-    const Color4 tc = tex_sample(cur_tex[0], fix_mult(props[0], z), fix_mult(props[1], z));
-    const uint8_t fog = fix_mult_i32(props[2], z);
-    const Color4 cc = (Color4) { { .r = fix_mult_i32(props[3], z),
-                                   .g = fix_mult_i32(props[4], z),
-                                   .b = fix_mult_i32(props[5], z),
+static Color4 combine_tex_fog_rgb(const fixr z, const fixr *props) {
+    const Color4 tc = tex_sample(tri_tex[0], fixr_mult(props[0], z), fixr_mult(props[1], z));
+    const uint8_t fog = fixr_mult_i(props[2], z);
+    const Color4 cc = (Color4) { { .r = fixr_mult_i(props[3], z),
+                                   .g = fixr_mult_i(props[4], z),
+                                   .b = fixr_mult_i(props[5], z),
                                    .a = 0xFF } };
     return rgba_blend(fog_color, rgba_modulate(tc, cc), fog);
 }
 
-static Color4 combine_tex_rgb_decal(const fix64 z, const fix64 *props) {
-    const Color4 tc = tex_sample(cur_tex[0], fix_mult(props[0], z), fix_mult(props[1], z));
-    const Color4 cc = (Color4) { { .r = fix_mult_i32(props[2], z),
-                                   .g = fix_mult_i32(props[3], z),
-                                   .b = fix_mult_i32(props[4], z),
+static Color4 combine_tex_rgb_decal(const fixr z, const fixr *props) {
+    const Color4 tc = tex_sample(tri_tex[0], fixr_mult(props[0], z), fixr_mult(props[1], z));
+    const Color4 cc = (Color4) { { .r = fixr_mult_i(props[2], z),
+                                   .g = fixr_mult_i(props[3], z),
+                                   .b = fixr_mult_i(props[4], z),
                                    .a = 0xFF } };
     return rgba_blend(tc, cc, tc.a);
 }
 
-static Color4 combine_tex_rgba(const fix64 z, const fix64 *props) {
-    const Color4 tc = tex_sample(cur_tex[0], fix_mult(props[0], z), fix_mult(props[1], z));
-    const Color4 cc = (Color4) { { .r = fix_mult_i32(props[2], z),
-                                   .g = fix_mult_i32(props[3], z),
-                                   .b = fix_mult_i32(props[4], z),
-                                   .a = fix_mult_i32(props[5], z) } };
+static Color4 combine_tex_rgba(const fixr z, const fixr *props) {
+    const Color4 tc = tex_sample(tri_tex[0], fixr_mult(props[0], z), fixr_mult(props[1], z));
+    const Color4 cc = (Color4) { { .r = fixr_mult_i(props[2], z),
+                                   .g = fixr_mult_i(props[3], z),
+                                   .b = fixr_mult_i(props[4], z),
+                                   .a = fixr_mult_i(props[5], z) } };
     return rgba_modulate(tc, cc);
 }
 
-static Color4 combine_tex_rgba_texa(const fix64 z, const fix64 *props) {
-    const Color4 tc = tex_sample(cur_tex[0], fix_mult(props[0], z), fix_mult(props[1], z));
-    const Color4 cc = (Color4) { { .r = fix_mult_i32(props[2], z),
-                                   .g = fix_mult_i32(props[3], z),
-                                   .b = fix_mult_i32(props[4], z),
+static Color4 combine_tex_rgba_texa(const fixr z, const fixr *props) {
+    const Color4 tc = tex_sample(tri_tex[0], fixr_mult(props[0], z), fixr_mult(props[1], z));
+    const Color4 cc = (Color4) { { .r = fixr_mult_i(props[2], z),
+                                   .g = fixr_mult_i(props[3], z),
+                                   .b = fixr_mult_i(props[4], z),
                                    .a = 0xFF } };
     return rgba_modulate(tc, cc);
 }
 
-static Color4 combine_tex_fog_rgba(const fix64 z, const fix64 *props) {
-    const Color4 tc = tex_sample(cur_tex[0], fix_mult(props[0], z), fix_mult(props[1], z));
-    const uint8_t fog = fix_mult_i32(props[2], z);
-    const Color4 cc = (Color4) { { .r = fix_mult_i32(props[3], z),
-                                   .g = fix_mult_i32(props[4], z),
-                                   .b = fix_mult_i32(props[5], z),
-                                   .a = fix_mult_i32(props[6], z) } };
+static Color4 combine_tex_fog_rgba(const fixr z, const fixr *props) {
+    const Color4 tc = tex_sample(tri_tex[0], fixr_mult(props[0], z), fixr_mult(props[1], z));
+    const uint8_t fog = fixr_mult_i(props[2], z);
+    const Color4 cc = (Color4) { { .r = fixr_mult_i(props[3], z),
+                                   .g = fixr_mult_i(props[4], z),
+                                   .b = fixr_mult_i(props[5], z),
+                                   .a = fixr_mult_i(props[6], z) } };
     return rgba_blend(fog_color, rgba_modulate(tc, cc), fog);
 }
 
-static Color4 combine_tex_rgba_decal(const fix64 z, const fix64 *props) {
-    const Color4 tc = tex_sample(cur_tex[0], fix_mult(props[0], z), fix_mult(props[1], z));
-    const Color4 cc = (Color4) { { .r = fix_mult_i32(props[2], z),
-                                   .g = fix_mult_i32(props[3], z),
-                                   .b = fix_mult_i32(props[4], z),
-                                   .a = fix_mult_i32(props[5], z) } };
+static Color4 combine_tex_rgba_decal(const fixr z, const fixr *props) {
+    const Color4 tc = tex_sample(tri_tex[0], fixr_mult(props[0], z), fixr_mult(props[1], z));
+    const Color4 cc = (Color4) { { .r = fixr_mult_i(props[2], z),
+                                   .g = fixr_mult_i(props[3], z),
+                                   .b = fixr_mult_i(props[4], z),
+                                   .a = fixr_mult_i(props[5], z) } };
     return rgba_blend(tc, cc, tc.a);
 }
 
-static Color4 combine_tex_rgb_rgb(const fix64 z, const fix64 *props) {
-    const Color4 tc = tex_sample(cur_tex[0], fix_mult(props[0], z), fix_mult(props[1], z));
-    const Color4 cc1 = (Color4) { { .r = fix_mult_i32(props[2], z),
-                                    .g = fix_mult_i32(props[3], z),
-                                    .b = fix_mult_i32(props[4], z),
+static Color4 combine_tex_rgb_rgb(const fixr z, const fixr *props) {
+    const Color4 tc = tex_sample(tri_tex[0], fixr_mult(props[0], z), fixr_mult(props[1], z));
+    const Color4 cc1 = (Color4) { { .r = fixr_mult_i(props[2], z),
+                                    .g = fixr_mult_i(props[3], z),
+                                    .b = fixr_mult_i(props[4], z),
                                     .a = 0xFF } };
-    const Color4 cc2 = (Color4) { { .r = fix_mult_i32(props[5], z),
-                                    .g = fix_mult_i32(props[6], z),
-                                    .b = fix_mult_i32(props[7], z),
+    const Color4 cc2 = (Color4) { { .r = fixr_mult_i(props[5], z),
+                                    .g = fixr_mult_i(props[6], z),
+                                    .b = fixr_mult_i(props[7], z),
                                     .a = 0xFF } };
     return rgba_lerp(cc2, cc1, tc.r);
 }
 
-static Color4 combine_tex_tex_rgba(const fix64 z, const fix64 *props) {
-    const fix64 u = fix_mult(props[0], z);
-    const fix64 v = fix_mult(props[1], z);
-    const Color4 tc1 = tex_sample(cur_tex[0], u, v);
-    const Color4 tc2 = tex_sample(cur_tex[1], u, v);
-    const uint8_t r = fix_mult_i32(props[2], z);
+static Color4 combine_tex_tex_rgba(const fixr z, const fixr *props) {
+    const fixr u = fixr_mult(props[0], z);
+    const fixr v = fixr_mult(props[1], z);
+    const Color4 tc1 = tex_sample(tri_tex[0], u, v);
+    const Color4 tc2 = tex_sample(tri_tex[1], u, v);
+    const uint8_t r = fixr_mult_i(props[2], z);
     return rgba_lerp(tc1, tc2, r);
 }
 
 /* fragment plotters */
 static void draw_pixel(const int idx, UNUSED const uint16_t z, Color4 src) {
-    gfx_output[idx] = src.c;
+    gfx_output[idx] = rgba_to_pixel(src);
 }
 
 static void draw_pixel_zwrite(const int idx, const uint16_t z, Color4 src) {
-    gfx_output[idx] = src.c;
+    gfx_output[idx] = rgba_to_pixel(src);
     z_buffer[idx] = z;
 }
 
 static void draw_pixel_blend(const int idx, UNUSED const uint16_t z, Color4 src) {
     const uint8_t a = src.a;
     const uint8_t ia = 255 - a;
-    const Color4 dst = (Color4) { .c = gfx_output[idx] };
+    const Color4 dst = pixel_to_rgba(gfx_output[idx]);
     src.r = mult_tab[src.r][a] + mult_tab[dst.r][ia];
     src.g = mult_tab[src.g][a] + mult_tab[dst.g][ia];
     src.b = mult_tab[src.b][a] + mult_tab[dst.b][ia];
-    gfx_output[idx] = src.c;
+    gfx_output[idx] = rgba_to_pixel(src);
 }
 
 static void draw_pixel_blend_zwrite(const int idx, const uint16_t z, Color4 src) {
     const uint8_t a = src.a;
     const uint8_t ia = 255 - a;
-    const Color4 dst = (Color4) { .c = gfx_output[idx] };
+    const Color4 dst = pixel_to_rgba(gfx_output[idx]);
     src.r = mult_tab[src.r][a] + mult_tab[dst.r][ia];
     src.g = mult_tab[src.g][a] + mult_tab[dst.g][ia];
     src.b = mult_tab[src.b][a] + mult_tab[dst.b][ia];
-    gfx_output[idx] = src.c;
+    gfx_output[idx] = rgba_to_pixel(src);
     z_buffer[idx] = z;
 }
 
@@ -504,11 +634,11 @@ static void draw_pixel_blend_edge(const int idx, UNUSED const uint16_t z, Color4
     if (src.a > 0x80) {
         const uint8_t a = src.a;
         const uint8_t ia = 255 - a;
-        const Color4 dst = (Color4) { .c = gfx_output[idx] };
+        const Color4 dst = pixel_to_rgba(gfx_output[idx]);
         src.r = mult_tab[src.r][a] + mult_tab[dst.r][ia];
         src.g = mult_tab[src.g][a] + mult_tab[dst.g][ia];
         src.b = mult_tab[src.b][a] + mult_tab[dst.b][ia];
-        gfx_output[idx] = src.c;
+        gfx_output[idx] = rgba_to_pixel(src);
     }
 }
 
@@ -516,85 +646,352 @@ static void draw_pixel_blend_edge_zwrite(const int idx, const uint16_t z, Color4
     if (src.a > 0x80) {
         const uint8_t a = src.a;
         const uint8_t ia = 255 - a;
-        const Color4 dst = (Color4) { .c = gfx_output[idx] };
+        const Color4 dst = pixel_to_rgba(gfx_output[idx]);
         src.r = mult_tab[src.r][a] + mult_tab[dst.r][ia];
         src.g = mult_tab[src.g][a] + mult_tab[dst.g][ia];
         src.b = mult_tab[src.b][a] + mult_tab[dst.b][ia];
 
-        gfx_output[idx] = src.c;
+        gfx_output[idx] = rgba_to_pixel(src);
         z_buffer[idx] = z;
     }
 }
 
+/* scanline kernels */
+
+// the most vertex props a combiner reads, not counting XYZW
+#define MAX_COMBINE_PROPS 8
+
+static inline void draw_pixel_flags(const int idx, const uint16_t z, const Color4 src,
+                                    const uint32_t draw_flags, const bool zwrite) {
+    if (draw_flags & DRAW_BLEND_EDGE)
+        zwrite ? draw_pixel_blend_edge_zwrite(idx, z, src) : draw_pixel_blend_edge(idx, z, src);
+    else if (draw_flags & DRAW_BLEND)
+        zwrite ? draw_pixel_blend_zwrite(idx, z, src) : draw_pixel_blend(idx, z, src);
+    else
+        zwrite ? draw_pixel_zwrite(idx, z, src) : draw_pixel(idx, z, src);
+}
+
+// everything but idx, n, p and dpdx is a constant in the kernels, so this inlines into a loop with
+// direct calls to the combiner and the plotter and no branches on the render state; only the props
+// the combiner reads are stepped, the rasterizer sets up all of them again on the next scanline
+static inline __attribute__((always_inline)) void
+scan_draw(int idx, const int n, const fixr *p_in, const fixr *dpdx, const combine_fn_t combine,
+          const int nprops, const uint32_t draw_flags, const bool zwrite, const bool ztest,
+          const int persp) {
+    const int z_ofs = z_offset;
+    const int p_end = 4 + nprops;
+    fixr p[4 + MAX_COMBINE_PROPS];
+    fixr w;
+    uint16_t uz;
+    int i, x;
+    for (i = 2; i < p_end; ++i)
+        p[i] = p_in[i];
+    if (persp == PERSP_AFFINE) {
+        /* AFFINE MODE: skip perspective correction entirely */
+        for (x = 0; x < n; ++x, ++idx) {
+            uz = u16clamp(FIXR_2_DEPTH(p[2]) + z_ofs);
+            if (!ztest || uz <= z_buffer[idx])
+                draw_pixel_flags(idx, uz, combine(FIXR_AFFINE_W, p + 4), draw_flags, zwrite);
+            for (i = 2; i < p_end; ++i)
+                p[i] += dpdx[i];
+        }
+    } else if (persp == PERSP_SPAN) {
+        /* SPAN-BASED PERSPECTIVE: correct every N pixels, lerp between */
+        const int span = (int) configPerspSpan;
+        int px_in_span = 0;
+        bool span_ready = false;
+        fixr p3_start = 0;
+        fixr w_step = 0;
+        w = FIXR_ONE;
+        for (x = 0; x < n; ++x, ++idx) {
+            if (px_in_span == 0) {
+                p3_start = p[3];
+                span_ready = false;
+            }
+            uz = u16clamp(FIXR_2_DEPTH(p[2]) + z_ofs);
+            if (!ztest || uz <= z_buffer[idx]) {
+                /* The 1/w of a span are only worked out once one of its pixels passes the depth
+                 * test, so spans behind what was drawn nearer cost no reciprocals */
+                if (!span_ready) {
+                    /* Compute exact 1/w at span start */
+                    const fixr w_start = p3_start == FIXR_ONE ? FIXR_ONE : fixr_recip(p3_start);
+                    /* Peek ahead to compute w at span end */
+                    const fixr p3_end = p3_start + dpdx[3] * span;
+                    const fixr w_end = p3_end == FIXR_ONE ? FIXR_ONE : fixr_recip(p3_end);
+                    w_step = (w_end - w_start) / span;
+                    w = w_start + w_step * px_in_span;
+                    span_ready = true;
+                }
+                draw_pixel_flags(idx, uz, combine(w, p + 4), draw_flags, zwrite);
+            }
+            w += w_step;
+            for (i = 2; i < p_end; ++i)
+                p[i] += dpdx[i];
+            if (++px_in_span >= span)
+                px_in_span = 0;
+        }
+    } else {
+        /* ORIGINAL: per-pixel perspective correction */
+        for (x = 0; x < n; ++x, ++idx) {
+            uz = u16clamp(FIXR_2_DEPTH(p[2]) + z_ofs);
+            if (!ztest || uz <= z_buffer[idx]) {
+                w = p[3] == FIXR_ONE ? FIXR_ONE : fixr_recip(p[3]);
+                draw_pixel_flags(idx, uz, combine(w, p + 4), draw_flags, zwrite);
+            }
+            for (i = 2; i < p_end; ++i)
+                p[i] += dpdx[i];
+        }
+    }
+}
+
+// define the kernels of a combiner for every draw mode, depth mode and perspective mode
+// nprops is the amount of props the combiner reads
+
+#define DEFINE_SCAN_FUNC(name, nprops, fl, zw, zt, pm)                                                 \
+    static void scan_fn_##name##_##fl##zw##zt##pm(int idx, const int n, const fixr *p,                 \
+                                                   const fixr *dpdx) {                                 \
+        scan_draw(idx, n, p, dpdx, combine_##name, nprops, (fl) << 1, zw, zt, pm);                     \
+    }
+
+#define DEFINE_SCAN_FUNCS_Z(name, nprops, fl, zw, zt)                                                  \
+    DEFINE_SCAN_FUNC(name, nprops, fl, zw, zt, 0)                                                      \
+    DEFINE_SCAN_FUNC(name, nprops, fl, zw, zt, 1)                                                      \
+    DEFINE_SCAN_FUNC(name, nprops, fl, zw, zt, 2)
+
+#define DEFINE_SCAN_FUNCS_FL(name, nprops, fl)                                                         \
+    DEFINE_SCAN_FUNCS_Z(name, nprops, fl, 0, 0)                                                        \
+    DEFINE_SCAN_FUNCS_Z(name, nprops, fl, 0, 1)                                                        \
+    DEFINE_SCAN_FUNCS_Z(name, nprops, fl, 1, 0)                                                        \
+    DEFINE_SCAN_FUNCS_Z(name, nprops, fl, 1, 1)
+
+#define SCAN_FUNCS_Z(name, fl, zw, zt)                                                                 \
+    { scan_fn_##name##_##fl##zw##zt##0, scan_fn_##name##_##fl##zw##zt##1,                              \
+      scan_fn_##name##_##fl##zw##zt##2 }
+
+#define SCAN_FUNCS_FL(name, fl)                                                                        \
+    { { SCAN_FUNCS_Z(name, fl, 0, 0), SCAN_FUNCS_Z(name, fl, 0, 1) },                                  \
+      { SCAN_FUNCS_Z(name, fl, 1, 0), SCAN_FUNCS_Z(name, fl, 1, 1) } }
+
+#define DEFINE_SCAN_FUNCS(name, nprops)                                                                \
+    DEFINE_SCAN_FUNCS_FL(name, nprops, 0)                                                              \
+    DEFINE_SCAN_FUNCS_FL(name, nprops, 1)                                                              \
+    DEFINE_SCAN_FUNCS_FL(name, nprops, 2)                                                              \
+    static scan_tab_t scan_tab_##name = { SCAN_FUNCS_FL(name, 0), SCAN_FUNCS_FL(name, 1),              \
+                                          SCAN_FUNCS_FL(name, 2) };
+
+#define GET_SCAN_FUNCS(name) (&scan_tab_##name)
+
+DEFINE_SCAN_FUNCS(rgb, 3)
+DEFINE_SCAN_FUNCS(rgba, 4)
+DEFINE_SCAN_FUNCS(fog_rgb, 4)
+DEFINE_SCAN_FUNCS(fog_rgba, 5)
+DEFINE_SCAN_FUNCS(rgba_rgba, 8)
+DEFINE_SCAN_FUNCS(tex, 2)
+DEFINE_SCAN_FUNCS(tex_fog, 3)
+DEFINE_SCAN_FUNCS(tex_rgb, 5)
+DEFINE_SCAN_FUNCS(tex_fog_rgb, 6)
+DEFINE_SCAN_FUNCS(tex_rgb_decal, 5)
+DEFINE_SCAN_FUNCS(tex_rgba, 6)
+DEFINE_SCAN_FUNCS(tex_rgba_texa, 5)
+DEFINE_SCAN_FUNCS(tex_fog_rgba, 7)
+DEFINE_SCAN_FUNCS(tex_rgba_decal, 6)
+DEFINE_SCAN_FUNCS(tex_rgb_rgb, 8)
+DEFINE_SCAN_FUNCS(tex_tex_rgba, 3)
+
+/* coarse depth */
+
+// how far below the smallest vertex depth the depth of a pixel n pixels into a scanline can be:
+// 16.16 scanlines step depth with a truncated increment that loses up to one unit per pixel
+#if FIX_RASTER_16_16
+#define ZC_TRI_SLACK(n) ((n) + 2)
+#else
+#define ZC_TRI_SLACK(n) 2
+#endif
+
+// takes the max again of every block written to since the last time, the maxes of those blocks are
+// too high until then, which only makes the rejection tests below miss some hidden geometry
+static void depth_coarse_update(void) {
+    for (int i = 0; i < zc_list_num; ++i) {
+        const int b = zc_list[i];
+        const int x0 = (b % zc_cols) << ZC_BLOCK_SHIFT;
+        const int y0 = (b / zc_cols) << ZC_BLOCK_SHIFT;
+        const int x1 = imin(x0 + ZC_BLOCK_SIZE, scr_width);
+        const int y1 = imin(y0 + ZC_BLOCK_SIZE, scr_height);
+        uint16_t z_max = 0;
+        for (int y = y0; y < y1; ++y) {
+            const uint16_t *z = z_buffer + scr_width * (scr_height - y - 1);
+            for (int x = x0; x < x1; ++x)
+                z_max = (z[x] > z_max) ? z[x] : z_max;
+        }
+        zc_max[b] = z_max;
+        zc_dirty[b] = 0;
+    }
+    zc_list_num = 0;
+}
+
+// marks the blocks a scanline from x0 to x1 on row y may have written depth to
+static inline void depth_coarse_touch(const int y, const int x0, const int x1) {
+    const int row = (y >> ZC_BLOCK_SHIFT) * zc_cols;
+    const int b_end = row + ((x1 - 1) >> ZC_BLOCK_SHIFT);
+    for (int b = row + (x0 >> ZC_BLOCK_SHIFT); b <= b_end; ++b) {
+        if (!zc_dirty[b]) {
+            zc_dirty[b] = 1;
+            zc_list[zc_list_num++] = b;
+        }
+    }
+}
+
+#if DEPTH_LAZY_CLEAR
+static void depth_block_clear(const int b) {
+    const int x0 = (b % zc_cols) << ZC_BLOCK_SHIFT;
+    const int y0 = (b / zc_cols) << ZC_BLOCK_SHIFT;
+    const int n = imin(x0 + ZC_BLOCK_SIZE, scr_width) - x0;
+    const int y1 = imin(y0 + ZC_BLOCK_SIZE, scr_height);
+    for (int y = y0; y < y1; ++y)
+        memset(z_buffer + scr_width * (scr_height - y - 1) + x0, 0xFF, n << 1);
+    zc_stale[b] = 0;
+}
+
+// clears the stale blocks a scanline from x0 to x1 on row y crosses before it reads or writes depth
+static inline void depth_stale_span(const int y, const int x0, const int x1) {
+    const int row = (y >> ZC_BLOCK_SHIFT) * zc_cols;
+    const int b_end = row + ((x1 - 1) >> ZC_BLOCK_SHIFT);
+    for (int b = row + (x0 >> ZC_BLOCK_SHIFT); b <= b_end; ++b)
+        if (zc_stale[b])
+            depth_block_clear(b);
+}
+
+// the same for the rows y0 to y1
+static void depth_stale_rect(const int x0, const int y0, const int x1, const int y1) {
+    for (int y = y0 & ~(ZC_BLOCK_SIZE - 1); y < y1; y += ZC_BLOCK_SIZE)
+        depth_stale_span(y, x0, x1);
+}
+#else
+static inline void depth_stale_span(UNUSED const int y, UNUSED const int x0, UNUSED const int x1) {
+}
+#endif
+
+// whether every pixel of a scanline from x0 to x1 on row y, with depth z stepped by dzdx, fails the
+// depth test; depth is linear along the scanline, so its smallest value is at one of the ends
+static inline bool depth_coarse_hidden_span(const int y, const int x0, const int x1, const fixr z,
+                                            const fixr dzdx) {
+    const fixr z_end = z + dzdx * (x1 - x0 - 1);
+    const uint16_t uz = u16clamp(FIXR_2_DEPTH((dzdx < 0) ? z_end : z) + z_offset);
+    const uint16_t *zc = zc_max + (y >> ZC_BLOCK_SHIFT) * zc_cols;
+    const int b_end = (x1 - 1) >> ZC_BLOCK_SHIFT;
+    for (int b = x0 >> ZC_BLOCK_SHIFT; b <= b_end; ++b)
+        if (uz <= zc[b])
+            return false;
+    return true;
+}
+
+// whether the rows y0 to y1 of a triangle are behind everything drawn so far in their blocks
+static inline bool depth_coarse_hidden_tri(const struct Tri tri, const int y0, const int y1) {
+    const fixr *v0 = tri.v0, *v1 = tri.v1, *v2 = tri.v2;
+    const int x_min = imin(FIXR_2_INT(v0[0]), imin(FIXR_2_INT(v1[0]), FIXR_2_INT(v2[0])));
+    const int x_max = imax(FIXR_2_INT(v0[0]), imax(FIXR_2_INT(v1[0]), FIXR_2_INT(v2[0])));
+    const int x0 = imax(imax(r_clip.x0, 0), x_min);
+    const int x1 = imin(imin(r_clip.x1, scr_width), x_max + 1);
+    if (x0 >= x1)
+        return true; // nothing left to draw after clipping
+    const fixr z01 = (v0[2] < v1[2]) ? v0[2] : v1[2];
+    const fixr z = (z01 < v2[2]) ? z01 : v2[2];
+    const uint16_t uz = u16clamp(FIXR_2_DEPTH(z) + z_offset - ZC_TRI_SLACK(x1 - x0));
+    const int bx0 = x0 >> ZC_BLOCK_SHIFT;
+    const int bx1 = (x1 - 1) >> ZC_BLOCK_SHIFT;
+    const int by1 = (y1 - 1) >> ZC_BLOCK_SHIFT;
+    for (int by = y0 >> ZC_BLOCK_SHIFT; by <= by1; ++by) {
+        const uint16_t *zc = zc_max + by * zc_cols;
+        for (int b = bx0; b <= bx1; ++b)
+            if (uz <= zc[b])
+                return false;
+    }
+    return true;
+}
+
+#if TEXCACHE_MIPS
+// the larger of how far u or v, times q^2, steps in a pixel along x or y, as texels are only known per
+// texture; u = p / q with p = u / w and q = 1 / w, so du = (dp * q - p * dq) / q^2
+static inline fix64 tex_footprint(const fix64 p, const fix64 q, const Vector2 dp, const Vector2 dq) {
+    const fix64 dx = llabs(fix_mult(dp.x, q) - fix_mult(p, dq.x));
+    const fix64 dy = llabs(fix_mult(dp.y, q) - fix_mult(p, dq.y));
+    return (dx > dy) ? dx : dy;
+}
+
+// points the triangle's samplers at the level of every texture it uses that is closest to one texel a
+// pixel, measured at the nearest vertex, where the texels are largest on screen
+static void tex_pick_levels(const fixr *v0, const fixr *v1, const fixr *v2, const Vector2 *dp) {
+    const fixr *vn = (v1[3] > v0[3]) ? v1 : v0;
+    vn = (v2[3] > vn[3]) ? v2 : vn;
+    const fix64 q = FIXR_2_FIX(vn[3]);
+    const fix64 q2 = fix_mult(q, q);
+    const fix64 du = tex_footprint(FIXR_2_FIX(vn[4]), q, dp[4], dp[3]);
+    const fix64 dv = tex_footprint(FIXR_2_FIX(vn[5]), q, dp[5], dp[3]);
+
+    for (int t = 0; t < 2; ++t) {
+        struct Texture *tex = cur_tex[t];
+        tri_tex[t] = tex;
+        if (!cur_shader->cc.used_textures[t] || !tex->mips)
+            continue;
+        // one more level for every doubling of the texels a pixel steps over
+        const fix64 texels = imax64(du * tex->w, dv * tex->h);
+        int level = 0;
+        while (level < tex->mips && texels >= (q2 << (level + 1)))
+            ++level;
+        if (!level)
+            continue;
+        tex_level[t] = *tex;
+        tex_level[t].w = tex->w >> level;
+        tex_level[t].h = tex->h >> level;
+        tex_level[t].wrap_w = tex_level[t].w - 1;
+        tex_level[t].wrap_h = tex_level[t].h - 1;
+        tex_level[t].addr = tex->mip_addr[level - 1];
+        tri_tex[t] = &tex_level[t];
+    }
+}
+#else
+static inline void tex_pick_levels(UNUSED const fixr *v0, UNUSED const fixr *v1, UNUSED const fixr *v2,
+                                   UNUSED const Vector2 *dp) {
+}
+#endif
+
 /* rasterizers */
 
+// The triangle setup divides once for the area, whose reciprocal every gradient shares, and once
+// per edge slope. fix_div_fast is precise enough for those, see TRI_SETUP_DIV_FAST in Makefile.nsp
+#if TRI_SETUP_DIV_FAST
+#define tri_div fix_div_fast
+#else
+#define tri_div fix_div_s
+#endif
+
 #define R_RASTERIZE_TRI_SEG(y_a, y_b, nprops)                                                          \
     register int y = y_a;                                                                              \
     register int y_end = y_b;                                                                          \
     register int x, x_end;                                                                             \
     register int idx;                                                                                  \
-    fix64 dx, w;                                                                                       \
-    uint16_t uz;                                                                                       \
+    fix64 dx;                                                                                          \
     /* draw triangle segment from y_a to y_b */                                                        \
     while (y < y_end) {                                                                                \
         /* do scissor clipping */                                                                      \
         x = imax(r_clip.x0, FIX_2_INT(x_a));                                                           \
         x_end = imin(r_clip.x1, FIX_2_INT(x_b));                                                       \
-        /* do X subpixel prestepping */                                                                \
-        dx = FIX_ONE - (x_a - INT_2_FIX(x));                                                           \
-        for (i = 2; i < nprops; ++i)                                                                   \
-            p[i] = p_a[i] + fix_mult(dx, dp[i].x);                                                     \
-        idx = scr_width * (scr_height - y - 1) + x;                                                    \
-        /* draw scanline from current x_a to current x_b */                                            \
-        if (configAffineMode) {                                                                        \
-            /* AFFINE MODE: skip perspective correction entirely */                                    \
-            while (x++ < x_end) {                                                                      \
-                uz = u16clamp(FIX_2_INT(p[2] * 65535 + z_offset));                                     \
-                if (!z_test || uz <= z_buffer[idx]) {                                                  \
-                    draw_fn(idx, uz, cur_shader->combine(FIX_ONE, p + 4));                             \
-                }                                                                                      \
-                for (i = 2; i < nprops; ++i)                                                           \
-                    p[i] += dp[i].x;                                                                   \
-                ++idx;                                                                                 \
-            }                                                                                          \
-        } else if (configPerspSpan > 1) {                                                              \
-            /* SPAN-BASED PERSPECTIVE: correct every N pixels, lerp between */                         \
-            int span = (int) configPerspSpan;                                                          \
-            int px_in_span = 0;                                                                        \
-            fix64 w_start = FIX_ONE, w_end = FIX_ONE;                                                  \
-            fix64 w_step = 0;                                                                          \
-            while (x++ < x_end) {                                                                      \
-                if (px_in_span == 0) {                                                                 \
-                    /* Compute exact 1/w at span start */                                              \
-                    w_start = p[3] == FIX_ONE ? FIX_ONE : fix_recip(p[3]);                             \
-                    /* Peek ahead to compute w at span end */                                          \
-                    fix64 p3_end = p[3] + dp[3].x * span;                                              \
-                    w_end = p3_end == FIX_ONE ? FIX_ONE : fix_recip(p3_end);                           \
-                    w_step = (w_end - w_start) / span;                                                 \
-                    w = w_start;                                                                       \
-                }                                                                                      \
-                uz = u16clamp(FIX_2_INT(p[2] * 65535 + z_offset));                                     \
-                if (!z_test || uz <= z_buffer[idx]) {                                                  \
-                    draw_fn(idx, uz, cur_shader->combine(w, p + 4));                                   \
-                }                                                                                      \
-                w += w_step;                                                                           \
-                for (i = 2; i < nprops; ++i)                                                           \
-                    p[i] += dp[i].x;                                                                   \
-                ++idx;                                                                                 \
-                if (++px_in_span >= span)                                                              \
-                    px_in_span = 0;                                                                    \
-            }                                                                                          \
-        } else {                                                                                       \
-            /* ORIGINAL: per-pixel perspective correction */                                           \
-            while (x++ < x_end) {                                                                      \
-                uz = u16clamp(FIX_2_INT(p[2] * 65535 + z_offset));                                     \
-                if (!z_test || uz <= z_buffer[idx]) {                                                  \
-                    w = p[3] == FIX_ONE ? FIX_ONE : fix_recip(p[3]);                                   \
-                    draw_fn(idx, uz, cur_shader->combine(w, p + 4));                                   \
-                }                                                                                      \
-                for (i = 2; i < nprops; ++i)                                                           \
-                    p[i] += dp[i].x;                                                                   \
-                ++idx;                                                                                 \
+        if (x < x_end) {                                                                               \
+            /* do X subpixel prestepping */                                                            \
+            dx = FIX_ONE - (x_a - INT_2_FIX(x));                                                       \
+            p[2] = fixr_from_fix(p_a[2] + fix_mult(dx, dp[2].x));                                      \
+            /* skip the scanline if it's behind everything in the blocks it crosses */                 \
+            if (!z_test || !depth_coarse_hidden_span(y, x, x_end, p[2], dpdx[2])) {                    \
+                for (i = 3; i < nprops; ++i)                                                           \
+                    p[i] = fixr_from_fix(p_a[i] + fix_mult(dx, dp[i].x));                              \
+                if (z_test || z_write)                                                                 \
+                    depth_stale_span(y, x, x_end);                                                     \
+                if (z_write)                                                                           \
+                    depth_coarse_touch(y, x, x_end);                                                   \
+                prof_frame.count[PROF_PIXELS] += x_end - x;                                            \
+                idx = scr_width * (scr_height - y - 1) + x;                                            \
+                /* draw scanline from current x_a to current x_b */                                    \
+                scan_fn(idx, x_end - x, p, dpdx);                                                      \
             }                                                                                          \
         }                                                                                              \
         /* advance scanline start and end and prop starts */                                           \
@@ -606,87 +1003,100 @@ static void draw_pixel_blend_edge_zwrite(const int idx, const uint16_t z, Color4
     }
 
 #define R_RASTERIZE(tri, nprops)                                                                       \
-    const fix64 *v0 = (fix64 *) tri.v0;                                                                \
-    const fix64 *v1 = (fix64 *) tri.v1;                                                                \
-    const fix64 *v2 = (fix64 *) tri.v2;                                                                \
-    const int y0i = imax(r_clip.y0, FIX_2_INT(v0[1]));                                                 \
-    const int y1i = imax(y0i, FIX_2_INT(v1[1]));                                                       \
-    const int y2i = imin(r_clip.y1, FIX_2_INT(v2[1]));                                                 \
+    const fixr *v0 = tri.v0;                                                                           \
+    const fixr *v1 = tri.v1;                                                                           \
+    const fixr *v2 = tri.v2;                                                                           \
+    const int y0i = imax(r_clip.y0, FIXR_2_INT(v0[1]));                                                \
+    const int y2i = imin(r_clip.y1, FIXR_2_INT(v2[1]));                                                \
+    /* B clamped into the clipped rows, so that neither segment draws past the bottom of the clip */   \
+    const int y1i = imax(y0i, imin(y2i, FIXR_2_INT(v1[1])));                                           \
     if ((y0i == y1i && y0i == y2i)                                                                     \
-        || (FIX_2_INT(v0[0]) == FIX_2_INT(v1[0]) && FIX_2_INT(v0[0]) == FIX_2_INT(v2[0])))             \
+        || (FIXR_2_INT(v0[0]) == FIXR_2_INT(v1[0]) && FIXR_2_INT(v0[0]) == FIXR_2_INT(v2[0])))         \
         return; /* triangle has zero area */                                                           \
-    const Vector4 ab = (Vector4) { { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2], v1[3] - v0[3] } };   \
-    const Vector4 ac = (Vector4) { { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2], v2[3] - v0[3] } };   \
-    const Vector2 bc = (Vector2) { { v2[0] - v1[0], v2[1] - v1[1] } };                                 \
-    const fix64 denom = fix_div_s(FIX_ONE, fix_mult(ac.x, ab.y) - fix_mult(ab.x, ac.y));               \
-    const fix64 dxdy_ab = ab.y != 0  ? fix_div_s(ab.x, ab.y)                                           \
+    if (z_test && depth_coarse_hidden_tri(tri, y0i, y2i))                                              \
+        return; /* triangle is behind everything drawn so far */                                       \
+    /* the setup and the edges are in fix64, only the scanlines step in fixr */                        \
+    const Vector4 ab = (Vector4) { { FIXR_2_FIX(v1[0] - v0[0]), FIXR_2_FIX(v1[1] - v0[1]),             \
+                                     FIXR_2_FIX(v1[2] - v0[2]), FIXR_2_FIX(v1[3] - v0[3]) } };         \
+    const Vector4 ac = (Vector4) { { FIXR_2_FIX(v2[0] - v0[0]), FIXR_2_FIX(v2[1] - v0[1]),             \
+                                     FIXR_2_FIX(v2[2] - v0[2]), FIXR_2_FIX(v2[3] - v0[3]) } };         \
+    const Vector2 bc = (Vector2) { { FIXR_2_FIX(v2[0] - v1[0]), FIXR_2_FIX(v2[1] - v1[1]) } };         \
+    const fix64 denom = tri_div(FIX_ONE, fix_mult(ac.x, ab.y) - fix_mult(ab.x, ac.y));                 \
+    const fix64 dxdy_ab = ab.y != 0  ? tri_div(ab.x, ab.y)                                             \
                           : ab.x > 0 ? FIX_MAX                                                         \
                                      : FIX_MIN; /* x increment along ab */                             \
-    const fix64 dxdy_ac = ac.y != 0  ? fix_div_s(ac.x, ac.y)                                           \
+    const fix64 dxdy_ac = ac.y != 0  ? tri_div(ac.x, ac.y)                                             \
                           : ac.x > 0 ? FIX_MAX                                                         \
                                      : FIX_MIN; /* x increment along ac */                             \
-    const fix64 dxdy_bc = bc.y != 0  ? fix_div_s(bc.x, bc.y)                                           \
+    const fix64 dxdy_bc = bc.y != 0  ? tri_div(bc.x, bc.y)                                             \
                           : bc.x > 0 ? FIX_MAX                                                         \
                                      : FIX_MIN; /* PROTECT AGAINST DIV BY ZERO HERE */                 \
     const bool side = dxdy_ac > dxdy_ab;        /* which side the longer edge (AC) is on */            \
-    const fix64 y_pre0 = FIX_ONE - (v0[1] - INT_2_FIX(y0i)); /* subpixel pre-step */                   \
+    const fix64 y_pre0 = FIX_ONE - (FIXR_2_FIX(v0[1]) - INT_2_FIX(y0i)); /* subpixel pre-step */       \
     fix64 dpdy_a[nprops]; /* vertex prop increments along left edge */                                 \
     fix64 p_a[nprops];    /* vertex leftmost points */                                                 \
-    fix64 p[nprops];      /* current vertex prop values */                                             \
+    fixr p[nprops];       /* current vertex prop values */                                             \
+    fixr dpdx[nprops];    /* X increments for vertex props */                                          \
     Vector2 dp[nprops];   /* X and Y increments for vertex props */                                    \
     register int i;                                                                                    \
     /* we'll interpolate z/w (p[2]), 1/w (p[3]) and the other properties (also divided by w) */        \
     for (i = 2; i < nprops; ++i) {                                                                     \
-        dp[i].x = fix_mult(fix_mult(v2[i] - v0[i], ab.y) - fix_mult(v1[i] - v0[i], ac.y), denom);      \
-        dp[i].y = fix_mult(fix_mult(v1[i] - v0[i], ac.x) - fix_mult(v2[i] - v0[i], ab.x), denom);      \
+        const fix64 d1 = FIXR_2_FIX(v1[i] - v0[i]);                                                    \
+        const fix64 d2 = FIXR_2_FIX(v2[i] - v0[i]);                                                    \
+        dp[i].x = fix_mult(fix_mult(d2, ab.y) - fix_mult(d1, ac.y), denom);                            \
+        dp[i].y = fix_mult(fix_mult(d1, ac.x) - fix_mult(d2, ab.x), denom);                            \
+        dpdx[i] = fixr_from_fix(dp[i].x);                                                              \
     }                                                                                                  \
+    /* u and v are props 4 and 5 whenever a texture is sampled */                                      \
+    if (TEXCACHE_MIPS && cur_shader->cc.used_textures[0])                                              \
+        tex_pick_levels(v0, v1, v2, dp);                                                               \
     if (!side) {                                                                                       \
         /* longer edge is on the left */                                                               \
         const fix64 dxdy_a = dxdy_ac;                                                                  \
         /* first column of this scanline is on AC */                                                   \
-        fix64 x_a = v0[0] + fix_mult(y_pre0, dxdy_a);                                                  \
+        fix64 x_a = FIXR_2_FIX(v0[0]) + fix_mult(y_pre0, dxdy_a);                                      \
         for (i = 2; i < nprops; ++i) {                                                                 \
             dpdy_a[i] = fix_mult(dxdy_ac, dp[i].x) + dp[i].y;                                          \
-            p_a[i] = v0[i] + fix_mult(y_pre0, dpdy_a[i]);                                              \
+            p_a[i] = FIXR_2_FIX(v0[i]) + fix_mult(y_pre0, dpdy_a[i]);                                  \
         }                                                                                              \
         if (y0i < y1i) {                                                                               \
             /* left is AC, right is AB */                                                              \
             const fix64 dxdy_b = dxdy_ab;                                                              \
             /* last column of this scanline */                                                         \
-            fix64 x_b = v0[0] + fix_mult(y_pre0, dxdy_ab);                                             \
+            fix64 x_b = FIXR_2_FIX(v0[0]) + fix_mult(y_pre0, dxdy_b);                                  \
             R_RASTERIZE_TRI_SEG(y0i, y1i, nprops);                                                     \
         }                                                                                              \
         if (y1i < y2i) {                                                                               \
             /* left is AC, right is BC */                                                              \
             const fix64 dxdy_b = dxdy_bc;                                                              \
             /* calculate prestep for vertex B */                                                       \
-            const fix64 y_pre1 = FIX_ONE - (v1[1] - INT_2_FIX(y1i));                                   \
-            fix64 x_b = v1[0] + fix_mult(y_pre1, dxdy_bc);                                             \
+            const fix64 y_pre1 = FIX_ONE - (FIXR_2_FIX(v1[1]) - INT_2_FIX(y1i));                       \
+            fix64 x_b = FIXR_2_FIX(v1[0]) + fix_mult(y_pre1, dxdy_b);                                  \
             R_RASTERIZE_TRI_SEG(y1i, y2i, nprops);                                                     \
         }                                                                                              \
     } else {                                                                                           \
         /* longer edge is on the right */                                                              \
         const fix64 dxdy_b = dxdy_ac;                                                                  \
         /* last column of this scanline is on AC */                                                    \
-        fix64 x_b = v0[0] + fix_mult(y_pre0, dxdy_ac);                                                 \
+        fix64 x_b = FIXR_2_FIX(v0[0]) + fix_mult(y_pre0, dxdy_b);                                      \
         if (y0i < y1i) {                                                                               \
             /* right is AC, left is AB */                                                              \
             const fix64 dxdy_a = dxdy_ab;                                                              \
-            fix64 x_a = v0[0] + fix_mult(y_pre0, dxdy_a);                                              \
+            fix64 x_a = FIXR_2_FIX(v0[0]) + fix_mult(y_pre0, dxdy_a);                                  \
             for (i = 2; i < nprops; ++i) {                                                             \
                 dpdy_a[i] = fix_mult(dxdy_ab, dp[i].x) + dp[i].y;                                      \
-                p_a[i] = v0[i] + fix_mult(y_pre0, dpdy_a[i]);                                          \
+                p_a[i] = FIXR_2_FIX(v0[i]) + fix_mult(y_pre0, dpdy_a[i]);                              \
             }                                                                                          \
             R_RASTERIZE_TRI_SEG(y0i, y1i, nprops);                                                     \
         }                                                                                              \
         if (y1i < y2i) {                                                                               \
             /* right is AC, left is BC */                                                              \
-            const fix64 y_pre1 = FIX_ONE - (v1[1] - INT_2_FIX(y1i));                                   \
+            const fix64 y_pre1 = FIX_ONE - (FIXR_2_FIX(v1[1]) - INT_2_FIX(y1i));                       \
             const fix64 dxdy_a = dxdy_bc;                                                              \
-            fix64 x_a = v1[0] + fix_mult(y_pre1, dxdy_a);                                              \
+            fix64 x_a = FIXR_2_FIX(v1[0]) + fix_mult(y_pre1, dxdy_a);                                  \
             for (i = 2; i < nprops; ++i) {                                                             \
                 dpdy_a[i] = fix_mult(dxdy_bc, dp[i].x) + dp[i].y;                                      \
-                p_a[i] = v1[i] + fix_mult(y_pre1, dpdy_a[i]);                                          \
+                p_a[i] = FIXR_2_FIX(v1[i]) + fix_mult(y_pre1, dpdy_a[i]);                              \
             }                                                                                          \
             R_RASTERIZE_TRI_SEG(y1i, y2i, nprops);                                                     \
         }                                                                                              \
@@ -712,11 +1122,11 @@ DEFINE_RAST_FUNC(12)
 DEFINE_RAST_FUNC(13)
 DEFINE_RAST_FUNC(14)
 
-static inline void pop_triangle(const fix64 *buf, const int stride) {
-    Vector4 *v0 = (Vector4 *) buf;
-    Vector4 *v1 = (Vector4 *) (buf + stride);
-    Vector4 *v2 = (Vector4 *) (buf + (stride << 1));
-    Vector4 *vt;
+static inline struct Tri setup_triangle(fixr *buf, const int stride) {
+    fixr *v0 = buf;
+    fixr *v1 = buf + stride;
+    fixr *v2 = buf + (stride << 1);
+    fixr *vt;
 
     // the vertices come to us in clip space, but already divided by w, still gotta transform
     viewport_transform(v0);
@@ -724,32 +1134,118 @@ static inline void pop_triangle(const fix64 *buf, const int stride) {
     viewport_transform(v2);
 
     // sort in Y order
-    if (v0->y > v1->y) {
+    if (v0[1] > v1[1]) {
         vt = v0;
         v0 = v1;
         v1 = vt;
     }
-    if (v0->y > v2->y) {
+    if (v0[1] > v2[1]) {
         vt = v0;
         v0 = v2;
         v2 = vt;
     }
-    if (v1->y > v2->y) {
+    if (v1[1] > v2[1]) {
         vt = v1;
         v1 = v2;
         v2 = vt;
     }
 
-    const struct Tri out = (struct Tri) { (fix64 *) v0, (fix64 *) v1, (fix64 *) v2 };
-    cur_shader->rast(out);
+    return (struct Tri) { v0, v1, v2 };
+}
+
+static inline void pop_triangle(fixr *buf, const int stride) {
+    cur_shader->rast(setup_triangle(buf, stride));
+}
+
+// draws the binned triangles tile by tile, so that the part of the color and depth buffers a tile
+// covers stays in the data cache while every triangle of the pass that touches it is drawn
+static void bin_draw(const int num_tris) {
+    const struct ClipRect clip = r_clip;
+    int i, t, tx, ty;
+
+    // count the triangles of every tile, then turn the counts into starts
+    memset(bin_start, 0, sizeof(bin_start));
+    for (i = 0; i < num_tris; ++i)
+        for (ty = bin_rects[i].y0; ty <= bin_rects[i].y1; ++ty)
+            for (tx = bin_rects[i].x0; tx <= bin_rects[i].x1; ++tx)
+                ++bin_start[ty * bin_cols + tx + 1];
+    for (t = 0; t < bin_cols * bin_rows; ++t)
+        bin_start[t + 1] += bin_start[t];
+
+    // fill in the triangles in submission order, this leaves every start at the end of its tile
+    for (i = 0; i < num_tris; ++i)
+        for (ty = bin_rects[i].y0; ty <= bin_rects[i].y1; ++ty)
+            for (tx = bin_rects[i].x0; tx <= bin_rects[i].x1; ++tx)
+                bin_refs[bin_start[ty * bin_cols + tx]++] = i;
+
+    for (ty = 0, t = 0; ty < bin_rows; ++ty) {
+        for (tx = 0; tx < bin_cols; ++tx, ++t) {
+            const int first = t ? bin_start[t - 1] : 0;
+            if (first == bin_start[t])
+                continue;
+            r_clip.x0 = imax(clip.x0, tx << BIN_TILE_SHIFT);
+            r_clip.y0 = imax(clip.y0, ty << BIN_TILE_SHIFT);
+            r_clip.x1 = imin(clip.x1, (tx + 1) << BIN_TILE_SHIFT);
+            r_clip.y1 = imin(clip.y1, (ty + 1) << BIN_TILE_SHIFT);
+            for (i = first; i < bin_start[t]; ++i)
+                cur_shader->rast(bin_tris[bin_refs[i]]);
+        }
+    }
+
+    r_clip = clip;
+}
+
+// sorts the triangles into screen tiles and draws them in passes of as many as the bins hold
+static void bin_triangles(fixr *buf, const int stride, const size_t num_tris) {
+    int pass_tris = 0;
+    int pass_refs = 0;
+    // tiles the scissor rect touches
+    const int clip_tx0 = imax(r_clip.x0, 0) >> BIN_TILE_SHIFT;
+    const int clip_ty0 = imax(r_clip.y0, 0) >> BIN_TILE_SHIFT;
+    const int clip_tx1 = (imin(r_clip.x1, scr_width) - 1) >> BIN_TILE_SHIFT;
+    const int clip_ty1 = (imin(r_clip.y1, scr_height) - 1) >> BIN_TILE_SHIFT;
+
+    for (size_t n = 0; n < num_tris; ++n, buf += 3 * stride) {
+        const struct Tri tri = setup_triangle(buf, stride);
+        const int x0 = FIXR_2_INT(tri.v0[0]);
+        const int x1 = FIXR_2_INT(tri.v1[0]);
+        const int x2 = FIXR_2_INT(tri.v2[0]);
+        const int x_min = imin(x0, imin(x1, x2));
+        const int x_max = imax(x0, imax(x1, x2));
+        const int tx0 = imax(clip_tx0, x_min >> BIN_TILE_SHIFT);
+        const int ty0 = imax(clip_ty0, FIXR_2_INT(tri.v0[1]) >> BIN_TILE_SHIFT);
+        const int tx1 = imin(clip_tx1, x_max >> BIN_TILE_SHIFT);
+        const int ty1 = imin(clip_ty1, FIXR_2_INT(tri.v2[1]) >> BIN_TILE_SHIFT);
+        if (tx0 > tx1 || ty0 > ty1)
+            continue; // outside of the scissor rect
+        const int refs = (tx1 - tx0 + 1) * (ty1 - ty0 + 1);
+        if (pass_tris == BIN_MAX_TRIS || pass_refs + refs > BIN_MAX_REFS) {
+            bin_draw(pass_tris);
+            pass_tris = pass_refs = 0;
+        }
+        bin_tris[pass_tris] = tri;
+        bin_rects[pass_tris] = (struct TileRect) { tx0, ty0, tx1, ty1 };
+        ++pass_tris;
+        pass_refs += refs;
+    }
+
+    if (pass_tris)
+        bin_draw(pass_tris);
 }
 
 static inline void depth_clear(void) {
+#if DEPTH_LAZY_CLEAR
+    memset(zc_stale, 1, zc_cols * zc_rows);
+#else
     memset(z_buffer, 0xFF, scr_size << 1);
+#endif
+    memset(zc_max, 0xFF, zc_cols * zc_rows * sizeof(uint16_t));
+    memset(zc_dirty, 0, zc_cols * zc_rows);
+    zc_list_num = 0;
 }
 
 static inline void color_clear(void) {
-    memset(gfx_output, 0x00, scr_size << 2);
+    memset(gfx_output, 0x00, scr_size * sizeof(gfx_pixel_t));
 }
 
 /* FIXME: ztrick fucks with sky blending
@@ -782,6 +1278,14 @@ static void gfx_soft_unload_shader(struct ShaderProgram *old_prg) {
 
 static void gfx_soft_load_shader(struct ShaderProgram *new_prg) {
     cur_shader = new_prg;
+    if (new_prg)
+        new_prg->binds++;
+}
+
+// the shader id already holds the other mode derived options (alpha, fog, texture edge, noise) in
+// its top bits, so hashing it alone tells apart every program the pool can hold
+static inline uint32_t shader_hash_slot(const uint32_t shader_id) {
+    return (shader_id * 0x9E3779B1U) >> 25; // top 7 bits, SHADER_HASH_SIZE slots
 }
 
 static struct ShaderProgram *gfx_soft_create_and_load_new_shader(uint32_t shader_id) {
@@ -802,8 +1306,23 @@ static struct ShaderProgram *gfx_soft_create_and_load_new_shader(uint32_t shader
     struct CCFeatures ccf;
     gfx_cc_get_features(shader_id, &ccf);
 
+    if (shader_program_pool_size == SHADER_POOL_SIZE) {
+        // the frontend keeps pointers to the programs, so none can be evicted. draw with the last
+        // one instead of overrunning the pool
+        printf("gfx_soft: ran out of shader programs for %08X\n", (unsigned) shader_id);
+        struct ShaderProgram *prg = &shader_program_pool[SHADER_POOL_SIZE - 1];
+        gfx_soft_load_shader(prg);
+        return prg;
+    }
+
     struct ShaderProgram *prg = &shader_program_pool[shader_program_pool_size++];
 
+    uint32_t slot = shader_hash_slot(shader_id);
+    while (shader_hash[slot])
+        slot = (slot + 1) & (SHADER_HASH_SIZE - 1);
+    shader_hash[slot] = shader_program_pool_size;
+
+    memset(prg, 0, sizeof(*prg));
     prg->shader_id = shader_id;
     prg->cc = ccf;
 
@@ -817,31 +1336,33 @@ static struct ShaderProgram *gfx_soft_create_and_load_new_shader(uint32_t shader
 
     if (ccf.used_textures[0] && ccf.used_textures[1]) {
         prg->mix = SH_MT_TEXTURE_TEXTURE;
-        prg->combine = combine_tex_tex_rgba; // only one such known shader
+        prg->scan = GET_SCAN_FUNCS(tex_tex_rgba); // only one such known shader
     } else if (ccf.used_textures[0] && ccf.num_inputs) {
         prg->mix = SH_MT_TEXTURE_COLOR;
         if (ccf.num_inputs > 1)
-            prg->combine = combine_tex_rgb_rgb; // only one such known shader
+            prg->scan = GET_SCAN_FUNCS(tex_rgb_rgb); // only one such known shader
         else if (shader_id == 0x0000038D || shader_id == 0x01200A00 || shader_id == 0x01045A00)
-            prg->combine = ccf.opt_alpha ? combine_tex_rgba_decal : combine_tex_rgb_decal;
+            prg->scan =
+                ccf.opt_alpha ? GET_SCAN_FUNCS(tex_rgba_decal) : GET_SCAN_FUNCS(tex_rgb_decal);
         else if (ccf.opt_fog)
-            prg->combine = ccf.opt_alpha ? combine_tex_fog_rgba : combine_tex_fog_rgb;
+            prg->scan = ccf.opt_alpha ? GET_SCAN_FUNCS(tex_fog_rgba) : GET_SCAN_FUNCS(tex_fog_rgb);
         else if (ccf.opt_alpha)
-            prg->combine = shader_id == 0x01A00045 ? combine_tex_rgba_texa : combine_tex_rgba;
+            prg->scan =
+                shader_id == 0x01A00045 ? GET_SCAN_FUNCS(tex_rgba_texa) : GET_SCAN_FUNCS(tex_rgba);
         else
-            prg->combine = combine_tex_rgb;
+            prg->scan = GET_SCAN_FUNCS(tex_rgb);
     } else if (ccf.used_textures[0]) {
         prg->mix = SH_MT_TEXTURE;
-        prg->combine = ccf.opt_fog ? combine_tex_fog : combine_tex;
+        prg->scan = ccf.opt_fog ? GET_SCAN_FUNCS(tex_fog) : GET_SCAN_FUNCS(tex);
     } else if (ccf.num_inputs > 1) {
         prg->mix = SH_MT_COLOR_COLOR;
-        prg->combine = combine_rgba_rgba; // only one such known shader
+        prg->scan = GET_SCAN_FUNCS(rgba_rgba); // only one such known shader
     } else if (ccf.num_inputs) {
         prg->mix = SH_MT_COLOR;
         if (ccf.opt_fog)
-            prg->combine = ccf.opt_alpha ? combine_fog_rgba : combine_fog_rgb;
+            prg->scan = ccf.opt_alpha ? GET_SCAN_FUNCS(fog_rgba) : GET_SCAN_FUNCS(fog_rgb);
         else
-            prg->combine = ccf.opt_alpha ? combine_rgba : combine_rgb;
+            prg->scan = ccf.opt_alpha ? GET_SCAN_FUNCS(rgba) : GET_SCAN_FUNCS(rgb);
     }
 
     if (ccf.opt_alpha) {
@@ -865,9 +1386,12 @@ static struct ShaderProgram *gfx_soft_create_and_load_new_shader(uint32_t shader
                          // crashes the emulator for some reason
 #pragma GCC optimize("-Og")
 static struct ShaderProgram *gfx_soft_lookup_shader(uint32_t shader_id) {
-    for (size_t i = 0; i < shader_program_pool_size; i++)
-        if (shader_program_pool[i].shader_id == shader_id)
-            return &shader_program_pool[i];
+    for (uint32_t slot = shader_hash_slot(shader_id); shader_hash[slot];
+         slot = (slot + 1) & (SHADER_HASH_SIZE - 1)) {
+        struct ShaderProgram *prg = &shader_program_pool[shader_hash[slot] - 1];
+        if (prg->shader_id == shader_id)
+            return prg;
+    }
     return NULL;
 }
 #pragma GCC pop_options
@@ -887,21 +1411,45 @@ static uint32_t gfx_soft_new_texture(void) {
         abort();
     }
 
-    tex_hdr[id].sample = tex_sample_nearest_rr;
+    tex_hdr[id].slab = -1;
+#if TEXCACHE_MIPS
+    tex_hdr[id].mip_slab = -1;
+    tex_hdr[id].mips = 0;
+#endif
+    tex_hdr[id].clamp_s = tex_hdr[id].clamp_t = 0; // repeat
+    tex_hdr[id].mirror_s = tex_hdr[id].mirror_t = 0;
 
     return id;
 }
 
 static void gfx_soft_select_texture(int tile, uint32_t texture_id) {
-    cur_tex[tile] = tex_hdr + texture_id;
+    cur_tex[tile] = tri_tex[tile] = tex_hdr + texture_id;
     cur_tmu = tile;
 }
 
-static uint32_t tex_cache_alloc(const uint32_t w, const uint32_t h) {
-    const uint32_t size = w * h * 4;
+static uint32_t tex_cache_alloc(const uint32_t size, int *slab) {
+    int cls = 0;
+    while ((1u << (cls + TEXCACHE_MIN_SLAB_SHIFT)) < size)
+        ++cls;
+    if (cls >= TEXCACHE_NUM_SLABS) {
+        printf("gfx_soft: texture of %u bytes does not fit in a slab\n", size);
+        abort();
+    }
+    *slab = cls;
+
+    // reuse a slab freed by an earlier upload if there is one
+    const uint32_t free_addr = texcache_free[cls];
+    if (free_addr != TEXCACHE_NONE) {
+        texcache_free[cls] = *(uint32_t *) (texcache + free_addr);
+#if MEM_STATS
+        texcache_used += 1u << (cls + TEXCACHE_MIN_SLAB_SHIFT);
+#endif
+        return free_addr;
+    }
 
-    if (texcache_addr + size > texcache_size) {
-        texcache_size += TEXCACHE_STEP + size;
+    const uint32_t slab_size = 1u << (cls + TEXCACHE_MIN_SLAB_SHIFT);
+    if (texcache_addr + slab_size > texcache_size) {
+        texcache_size += TEXCACHE_STEP + slab_size;
         texcache_size = ALIGN(texcache_size, TEXCACHE_STEP);
         texcache = realloc(texcache, texcache_size);
         if (!texcache) {
@@ -911,21 +1459,196 @@ static uint32_t tex_cache_alloc(const uint32_t w, const uint32_t h) {
     }
 
     uint32_t ret = texcache_addr;
-    texcache_addr += size;
+    texcache_addr += slab_size;
+#if MEM_STATS
+    texcache_used += slab_size;
+#endif
     return ret;
 }
 
+static void tex_cache_free(const uint32_t addr, const int slab) {
+    *(uint32_t *) (texcache + addr) = texcache_free[slab];
+    texcache_free[slab] = addr;
+#if MEM_STATS
+    texcache_used -= 1u << (slab + TEXCACHE_MIN_SLAB_SHIFT);
+#endif
+}
+
+#if TEXCACHE_16BIT
+
+// picks the smallest format that can store the texture, only RGBA5551 loses color precision
+static int tex_pick_format(const Color4 *texels, const int num) {
+    bool gray = true;
+    bool opaque = true;
+    bool masked = true; // alpha is 0 or 255
+    for (int i = 0; i < num; ++i) {
+        const Color4 c = texels[i];
+        gray = gray && c.r == c.g && c.r == c.b;
+        opaque = opaque && c.a == 0xFF;
+        masked = masked && (c.a == 0xFF || c.a == 0x00);
+    }
+    if (gray)
+        return opaque ? TEX_I8 : TEX_IA88;
+    return masked ? TEX_RGBA5551 : TEX_RGBA32;
+}
+
+static inline uint32_t tex_scale_8_5(const uint32_t v) {
+    return ((v + 4) * 0x1F) / 0xFF; // exact inverse of the 5 to 8 bit scale
+}
+
+static void tex_convert(uint8_t *dst, const Color4 *texels, const int num, const int fmt) {
+    switch (fmt) {
+        case TEX_I8:
+            for (int i = 0; i < num; ++i)
+                dst[i] = texels[i].r;
+            break;
+        case TEX_IA88:
+            for (int i = 0; i < num; ++i)
+                ((uint16_t *) dst)[i] = texels[i].r | texels[i].a << 8;
+            break;
+        case TEX_RGBA5551:
+            for (int i = 0; i < num; ++i)
+                ((uint16_t *) dst)[i] = tex_scale_8_5(texels[i].r) << 11
+                                        | tex_scale_8_5(texels[i].g) << 6
+                                        | tex_scale_8_5(texels[i].b) << 1 | (texels[i].a >> 7);
+            break;
+        default:
+            memcpy(dst, texels, num * 4);
+            break;
+    }
+}
+
+#endif
+
+#if TEXCACHE_MIPS
+
+// the texels of a level from the ones of the level above, w and h are the new level's size; the
+// destination may be the source, every texel is written after the ones it is made of are read
+static void tex_downsample(Color4 *dst, const Color4 *src, const int w, const int h) {
+    for (int y = 0; y < h; ++y) {
+        const Color4 *row0 = src + (y << 1) * (w << 1);
+        const Color4 *row1 = row0 + (w << 1);
+        for (int x = 0; x < w; ++x) {
+            const Color4 a = row0[x << 1], b = row0[(x << 1) + 1];
+            const Color4 c = row1[x << 1], d = row1[(x << 1) + 1];
+            dst[y * w + x] = (Color4) { { .r = (a.r + b.r + c.r + d.r + 2) >> 2,
+                                          .g = (a.g + b.g + c.g + d.g + 2) >> 2,
+                                          .b = (a.b + b.b + c.b + d.b + 2) >> 2,
+                                          .a = (a.a + b.a + c.a + d.a + 2) >> 2 } };
+        }
+    }
+}
+
+// box filters the levels below a freshly uploaded texture into a slab of their own, in its format;
+// made only while rendering below full resolution, where a triangle mostly covers fewer pixels than
+// it has texels and sampling the full texture pulls in a cache line for nearly every pixel
+static void tex_make_mips(struct Texture *tex, const Color4 *texels, const uint32_t texel_size) {
+    static Color4 buf[TEX_MIP_BUF_TEXELS];
+    uint32_t size = 0;
+    int mips = 0;
+
+    if (scr_width >= SCREEN_WIDTH || (tex->w >> 1) * (tex->h >> 1) > TEX_MIP_BUF_TEXELS)
+        return;
+    // only levels that halve evenly, and not below the smallest size
+    while (mips < TEX_MAX_MIPS && !((tex->w | tex->h) & ((2 << mips) - 1))
+           && imin(tex->w, tex->h) >> (mips + 1) >= TEX_MIP_MIN_SIZE) {
+        size += (tex->w >> (mips + 1)) * (tex->h >> (mips + 1)) * texel_size;
+        ++mips;
+    }
+    if (!mips)
+        return;
+
+    const uint32_t addr = tex_cache_alloc(size, &tex->mip_slab);
+    const Color4 *src = texels;
+    for (int level = 1, offset = 0; level <= mips; ++level) {
+        const int w = tex->w >> level;
+        const int h = tex->h >> level;
+        tex_downsample(buf, src, w, h);
+        src = buf;
+        tex->mip_addr[level - 1] = addr + offset;
+#if TEXCACHE_16BIT
+        tex_convert(texcache + addr + offset, buf, w * h, tex->fmt);
+#else
+        memcpy(texcache + addr + offset, buf, w * h * 4);
+#endif
+        offset += w * h * texel_size;
+    }
+    tex->mips = mips;
+}
+
+#endif
+
+// the frontend uploads into the textures it evicts from its cache, gives their memory back
+static void tex_release(struct Texture *tex) {
+    if (tex->slab >= 0)
+        tex_cache_free(tex->addr, tex->slab);
+    tex->slab = -1;
+#if TEXCACHE_MIPS
+    if (tex->mip_slab >= 0)
+        tex_cache_free(tex->mip_addr[0], tex->mip_slab);
+    tex->mip_slab = -1;
+    tex->mips = 0;
+#endif
+}
+
 static void gfx_soft_upload_texture(const uint8_t *rgba32_buf, int width, int height) {
-    uint32_t addr = tex_cache_alloc(width, height);
-    memcpy(texcache + addr, rgba32_buf, width * height * 4);
     struct Texture *tex = cur_tex[cur_tmu];
+    tex_release(tex);
+#if TEXCACHE_16BIT
+    static const uint32_t fmt_size[] = { 4, 2, 2, 1 }; // bytes per texel of every TexFormat
+    const Color4 *texels = (const Color4 *) rgba32_buf;
+    const int fmt = tex_pick_format(texels, width * height);
+    const uint32_t texel_size = fmt_size[fmt];
+    uint32_t addr = tex_cache_alloc(width * height * texel_size, &tex->slab);
+    tex_convert(texcache + addr, texels, width * height, fmt);
+#else
+    const int fmt = TEX_RGBA32;
+    const uint32_t texel_size = 4;
+    uint32_t addr = tex_cache_alloc(width * height * texel_size, &tex->slab);
+    memcpy(texcache + addr, rgba32_buf, width * height * texel_size);
+#endif
+    tex->fmt = fmt;
+    tex->addr = addr;
+    tex->w = width;
+    tex->h = height;
+    tex->wrap_w = width - 1;
+    tex->wrap_h = height - 1;
+#if TEXCACHE_MIPS
+    tex_make_mips(tex, (const Color4 *) rgba32_buf, texel_size);
+#endif
+}
+
+#if TEXCACHE_CI
+
+// CI4 and CI8 textures are stored as the N64 has them, with their palette in RGBA32 after them, a
+// quarter or an eighth of the size they take as RGBA32. They get no smaller levels, indices can't be
+// box filtered and a level of RGBA32 texels would take about as many cache lines as the indices
+static void gfx_soft_upload_texture_ci(const uint8_t *indices, int width, int height, int bits,
+                                       const uint8_t *rgba32_palette) {
+    struct Texture *tex = cur_tex[cur_tmu];
+    const uint32_t indices_size = (width * height * bits) >> 3;
+    const uint32_t palette_size = (bits == 4) ? 16 * 4 : 256 * 4;
+    tex_release(tex);
+    const uint32_t addr = tex_cache_alloc(ALIGN(indices_size, 4) + palette_size, &tex->slab);
+    memcpy(texcache + addr, indices, indices_size);
+    memcpy(texcache + addr + ALIGN(indices_size, 4), rgba32_palette, palette_size);
+    tex->fmt = (bits == 4) ? TEX_CI4 : TEX_CI8;
     tex->addr = addr;
+    tex->pal_addr = addr + ALIGN(indices_size, 4);
     tex->w = width;
     tex->h = height;
     tex->wrap_w = width - 1;
     tex->wrap_h = height - 1;
 }
 
+// replaces the palette of the selected CI texture, for the textures whose palette is animated
+static void gfx_soft_upload_palette(const uint8_t *rgba32_palette) {
+    const struct Texture *tex = cur_tex[cur_tmu];
+    memcpy(texcache + tex->pal_addr, rgba32_palette, (tex->fmt == TEX_CI4) ? 16 * 4 : 256 * 4);
+}
+
+#endif
+
 static inline int gfx_cm_to_local(uint32_t val) {
     if (val & G_TX_CLAMP)
         return WRAP_CLAMP;
@@ -933,25 +1656,15 @@ static inline int gfx_cm_to_local(uint32_t val) {
 }
 
 static void gfx_soft_set_sampler_parameters(int tile, bool linear_filter, uint32_t cms, uint32_t cmt) {
-    static const sample_fn_t samplers[] = {
-        tex_sample_nearest_rr, // 0000
-        tex_sample_nearest_rc, // 0001
-        tex_sample_nearest_rm, // 0010
-        NULL,
-        tex_sample_nearest_cr, // 0100
-        tex_sample_nearest_cc, // 0101
-        tex_sample_nearest_cm, // 0110
-        NULL,
-        tex_sample_nearest_mr, // 1000
-        tex_sample_nearest_mc, // 1001
-        tex_sample_nearest_mm, // 1010
-    };
-
-    cms = gfx_cm_to_local(cms) << 2;
-    cmt = gfx_cm_to_local(cmt);
-
-    cur_tex[tile]->filter = linear_filter;
-    cur_tex[tile]->sample = samplers[cms | cmt];
+    // turn the wrap modes into the masks tex_sample_wrap() applies
+    const int wrap_s = gfx_cm_to_local(cms);
+    const int wrap_t = gfx_cm_to_local(cmt);
+    struct Texture *tex = cur_tex[tile];
+    tex->filter = linear_filter;
+    tex->clamp_s = (wrap_s != WRAP_REPEAT) ? ~0 : 0;
+    tex->clamp_t = (wrap_t != WRAP_REPEAT) ? ~0 : 0;
+    tex->mirror_s = (wrap_s == WRAP_MIRROR) ? ~0 : 0;
+    tex->mirror_t = (wrap_t == WRAP_MIRROR) ? ~0 : 0;
 }
 
 static void gfx_soft_set_depth_test(bool depth_test) {
@@ -963,7 +1676,7 @@ static void gfx_soft_set_depth_mask(bool z_upd) {
 }
 
 static void gfx_soft_set_zmode_decal(bool zmode_decal) {
-    z_offset = zmode_decal ? INT_2_FIX(-32) : 0;
+    z_offset = zmode_decal ? -32 : 0;
 }
 
 static void gfx_soft_set_viewport(int x, int y, int width, int height) {
@@ -971,10 +1684,10 @@ static void gfx_soft_set_viewport(int x, int y, int width, int height) {
     r_view.y = y;
     r_view.w = width;
     r_view.h = height;
-    r_view.hw = INT_2_FIX(width >> 1);
-    r_view.hh = INT_2_FIX(height >> 1); // might as well convert now
-    r_view.cx = INT_2_FIX(x) + r_view.hw;
-    r_view.cy = INT_2_FIX(y) + r_view.hh;
+    r_view.hw = INT_2_FIXR(width >> 1);
+    r_view.hh = INT_2_FIXR(height >> 1); // might as well convert now
+    r_view.cx = INT_2_FIXR(x) + r_view.hw;
+    r_view.cy = INT_2_FIXR(y) + r_view.hh;
 }
 
 static void gfx_soft_set_scissor(int x, int y, int width, int height) {
@@ -1007,10 +1720,26 @@ static inline void gfx_soft_pick_draw_func(void) {
     draw_fn = draw_funcs[cur_shader->draw_flags | z_write];
 }
 
-static void gfx_soft_draw_triangles(fix64 buf_vbo[], size_t buf_vbo_len, size_t buf_vbo_num_tris) {
-    gfx_soft_pick_draw_func();
+static inline void gfx_soft_pick_scan_func(void) {
+    const int persp = configAffineMode ? PERSP_AFFINE
+                      : (configPerspSpan > 1) ? PERSP_SPAN
+                                              : PERSP_PIXEL;
+    scan_fn = (*cur_shader->scan)[cur_shader->draw_flags >> 1][z_write][z_test][persp];
+}
+
+static void gfx_soft_draw_triangles(fixr buf_vbo[], size_t buf_vbo_len, size_t buf_vbo_num_tris) {
+    gfx_soft_pick_scan_func();
+    cur_shader->tris += buf_vbo_num_tris;
+    // the render state is the same for the whole batch, so the coarse depth only has to be brought
+    // up to date before the batches that test against it
+    if (z_test && zc_list_num)
+        depth_coarse_update();
     const size_t num_verts = 3 * buf_vbo_num_tris;
     const size_t stride = buf_vbo_len / num_verts; // how many props per vertex
+    if (configBinnedRaster) {
+        bin_triangles(buf_vbo, stride, buf_vbo_num_tris);
+        return;
+    }
     for (size_t i = 0; i < num_verts * stride; i += 3 * stride)
         pop_triangle(buf_vbo + i, stride);
 }
@@ -1022,19 +1751,50 @@ static void gfx_soft_fill_rect(int x0, int y0, int x1, int y1, const uint8_t *rg
     y0 = imax(0, y0);
     x1 = imin(scr_width, x1);
     y1 = imin(scr_height, y1);
-    register const uint32_t color = *(uint32_t *) rgba;
-    register uint32_t *base = gfx_output + y0 * scr_width + x0;
-    register uint32_t *p;
-    register int x, y;
-    for (y = y0; y < y1; ++y, base += scr_width) {
-        p = base;
-        for (x = x0; x < x1; ++x, ++p)
-            *p = color;
+    const Color4 c = { .c = *(uint32_t *) rgba };
+    register gfx_pixel_t *base = gfx_output + y0 * scr_width + x0;
+    const int w = x1 - x0;
+    if (w <= 0)
+        return;
+    const uint32_t draw_flags = cur_shader ? cur_shader->draw_flags : 0;
+    if ((draw_flags & (DRAW_BLEND | DRAW_BLEND_EDGE)) && c.a != 0xFF) {
+        if ((draw_flags & DRAW_BLEND_EDGE) && c.a <= 0x80)
+            return;
+        // the source share of the blend is the same for the whole rect
+        const uint8_t ia = 0xFF - c.a;
+        const uint8_t sr = mult_tab[c.r][c.a], sg = mult_tab[c.g][c.a], sb = mult_tab[c.b][c.a];
+        for (int y = y0; y < y1; ++y, base += scr_width) {
+            register gfx_pixel_t *p = base;
+            for (int x = 0; x < w; ++x, ++p) {
+                const Color4 dst = pixel_to_rgba(*p);
+                *p = rgba_to_pixel((Color4) { { .r = sr + mult_tab[dst.r][ia],
+                                                .g = sg + mult_tab[dst.g][ia],
+                                                .b = sb + mult_tab[dst.b][ia],
+                                                .a = dst.a } });
+            }
+        }
+        return;
+    }
+    const gfx_pixel_t color = rgba_to_pixel(c);
+    // a whole-width rect is one contiguous run
+    int rows = y1 - y0;
+    int run = w;
+    if (w == scr_width) {
+        run *= rows;
+        rows = 1;
+    }
+    for (; rows > 0; --rows, base += scr_width) {
+#if OUTPUT_RGB565
+        arm_fill16(base, color, run);
+#else
+        arm_fill32(base, color, run);
+#endif
     }
 }
 
 static inline void gfx_soft_tex_rect_replace(int x0, int y0, int x1, int y1, const fix64 u0,
                                              const fix64 v0, const fix64 dudx, const fix64 dvdy) {
+    const struct Texture *const tex = cur_tex[0];
     register int base = y0 * scr_width + x0;
     register int idx;
     register int x, y;
@@ -1044,13 +1804,14 @@ static inline void gfx_soft_tex_rect_replace(int x0, int y0, int x1, int y1, con
         idx = base;
         u = u0;
         for (x = x0; x < x1; ++x, ++idx, u += dudx)
-            draw_fn(idx, 0, cur_tex[0]->sample(cur_tex[0], u, v));
+            draw_fn(idx, 0, tex_sample_wrap(tex, FIX_2_INT(u), FIX_2_INT(v)));
     }
 }
 
 static inline void gfx_soft_tex_rect_modulate(int x0, int y0, int x1, int y1, const fix64 u0,
                                               const fix64 v0, const fix64 dudx, const fix64 dvdy,
                                               const Color4 rgba) {
+    const struct Texture *const tex = cur_tex[0];
     register int base = y0 * scr_width + x0;
     register int idx;
     register int x, y;
@@ -1060,26 +1821,110 @@ static inline void gfx_soft_tex_rect_modulate(int x0, int y0, int x1, int y1, co
         idx = base;
         u = u0;
         for (x = x0; x < x1; ++x, ++idx, u += dudx)
-            draw_fn(idx, 0, rgba_modulate(cur_tex[0]->sample(cur_tex[0], u, v), rgba));
+            draw_fn(idx, 0, rgba_modulate(tex_sample_wrap(tex, FIX_2_INT(u), FIX_2_INT(v)), rgba));
+    }
+}
+
+// one row of a texture rect stepping a whole number of texels per pixel, which is what the HUD,
+// text and the pause menu draw: the texel index is stepped instead of u, and only rows that run
+// past the texture edge are wrapped per texel. the render state args are constants where this is
+// expanded, like in scan_draw
+static inline __attribute__((always_inline)) void
+tex_rect_span(int idx, const int n, const int tx, const int ty, const int step, const Color4 rgba,
+              const bool modulate, const uint32_t draw_flags, const bool zwrite) {
+    const struct Texture *const tex = cur_tex[0];
+    int i, t;
+    if (tx >= 0 && tx + (n - 1) * step < tex->w) {
+#if !OUTPUT_RGB565
+        if (!modulate && !draw_flags && !zwrite && step == 1 && tex->fmt == TEX_RGBA32) {
+            // opaque and unscaled: the texels are the pixels
+            arm_copy32((uint32_t *) gfx_output + idx,
+                       (const uint32_t *) (texcache + tex->addr) + ty * tex->w + tx, n);
+            return;
+        }
+#endif
+        for (i = 0, t = tx; i < n; ++i, ++idx, t += step) {
+            const Color4 c = tex_get(tex, t, ty);
+            draw_pixel_flags(idx, 0, modulate ? rgba_modulate(c, rgba) : c, draw_flags, zwrite);
+        }
+    } else {
+        for (i = 0, t = tx; i < n; ++i, ++idx, t += step) {
+            const Color4 c = tex_get(tex, iwrap0w(t, tex->wrap_w, tex->clamp_s, tex->mirror_s), ty);
+            draw_pixel_flags(idx, 0, modulate ? rgba_modulate(c, rgba) : c, draw_flags, zwrite);
+        }
+    }
+}
+
+static inline __attribute__((always_inline)) void
+tex_rect_blit(const int x0, const int y0, const int x1, const int y1, const int tx0, const int ty0,
+              const int step_x, const int step_y, const Color4 rgba, const bool modulate,
+              const uint32_t draw_flags, const bool zwrite) {
+    const struct Texture *const tex = cur_tex[0];
+    int base = y0 * scr_width + x0;
+    for (int y = y0, ty = ty0; y < y1; ++y, base += scr_width, ty += step_y) {
+        const int tyw = iwrap0w(ty, tex->wrap_h, tex->clamp_t, tex->mirror_t);
+        tex_rect_span(base, x1 - x0, tx0, tyw, step_x, rgba, modulate, draw_flags, zwrite);
     }
 }
 
+static void gfx_soft_tex_rect_blit(const int x0, const int y0, const int x1, const int y1,
+                                   const int tx0, const int ty0, const int step_x, const int step_y,
+                                   const Color4 rgba, const bool modulate) {
+#define TEX_RECT_BLIT(flags, zw) \
+    tex_rect_blit(x0, y0, x1, y1, tx0, ty0, step_x, step_y, rgba, modulate, flags, zw)
+    switch (cur_shader->draw_flags | z_write) {
+        case 0:
+            TEX_RECT_BLIT(0, false);
+            break;
+        case 1:
+            TEX_RECT_BLIT(0, true);
+            break;
+        case DRAW_BLEND:
+            TEX_RECT_BLIT(DRAW_BLEND, false);
+            break;
+        case DRAW_BLEND | 1:
+            TEX_RECT_BLIT(DRAW_BLEND, true);
+            break;
+        case DRAW_BLEND_EDGE:
+            TEX_RECT_BLIT(DRAW_BLEND_EDGE, false);
+            break;
+        default:
+            TEX_RECT_BLIT(DRAW_BLEND_EDGE, true);
+            break;
+    }
+#undef TEX_RECT_BLIT
+}
+
 static void gfx_soft_tex_rect(int x0, int y0, int x1, int y1, const float u0, const float v0,
                               const float dudx, const float dvdy, const uint8_t *rgba) {
+    // Convert float UV params to fixed-point once at entry, then use integer math in inner loops
+    const fix64 fdudx = FLOAT_2_FIX(dudx);
+    const fix64 fdvdy = FLOAT_2_FIX(dvdy);
+    // u and v are at the unclipped corner, so step them to the clipped one
+    const fix64 fu0 = FLOAT_2_FIX(u0) + (fix64) (imax(0, x0) - x0) * fdudx;
+    const fix64 fv0 = FLOAT_2_FIX(v0) + (fix64) (imax(0, y0) - y0) * fdvdy;
     x0 = imax(0, x0);
     y0 = imax(0, y0);
     x1 = imin(scr_width, x1);
     y1 = imin(scr_height, y1);
+    if (x0 >= x1 || y0 >= y1)
+        return;
     gfx_soft_pick_draw_func();
-    // Convert float UV params to fixed-point once at entry, then use integer math in inner loops
-    const fix64 fu0 = FLOAT_2_FIX(u0);
-    const fix64 fv0 = FLOAT_2_FIX(v0);
-    const fix64 fdudx = FLOAT_2_FIX(dudx);
-    const fix64 fdvdy = FLOAT_2_FIX(dvdy);
-    if (cur_shader->cc.num_inputs)
+#if DEPTH_LAZY_CLEAR
+    // the rect writes depth in rows from the top, the blocks count them from the bottom
+    if (z_write)
+        depth_stale_rect(x0, scr_height - y1, x1, scr_height - y0);
+#endif
+    const bool modulate = cur_shader->cc.num_inputs;
+    // nearest sampling at a whole texel step keeps the fraction of u0 and v0 out of every texel
+    if (!GET_FRAC(fdudx) && !GET_FRAC(fdvdy) && fdudx > 0 && fdvdy > 0) {
+        gfx_soft_tex_rect_blit(x0, y0, x1, y1, FIX_2_INT(fu0), FIX_2_INT(fv0), FIX_2_INT(fdudx),
+                               FIX_2_INT(fdvdy), *(Color4 *) rgba, modulate);
+    } else if (modulate) {
         gfx_soft_tex_rect_modulate(x0, y0, x1, y1, fu0, fv0, fdudx, fdvdy, *(Color4 *) rgba);
-    else
+    } else {
         gfx_soft_tex_rect_replace(x0, y0, x1, y1, fu0, fv0, fdudx, fdvdy);
+    }
 }
 
 static void gfx_soft_prepare_tables(void) {
@@ -1093,28 +1938,65 @@ static void gfx_soft_prepare_tables(void) {
     for (int x = 0; x < 0x100; ++x)
         for (int y = 0; y < 0x100; ++y)
             mult_tab[x][y] = (x * y) >> 8;
+
+#if TEXCACHE_16BIT
+    for (int i = 0; i < 0x20; ++i)
+        scale_5_8_tab[i] = (i * 0xFF) / 0x1F;
+#endif
 }
 
 static void gfx_soft_set_resolution(const int width, const int height) {
-    if (z_buffer)
-        free(z_buffer);
-    if (gfx_output)
-        free(gfx_output);
-
     scr_width = width;
     scr_height = height;
     scr_size = scr_width * scr_height;
 
-    z_buffer = calloc(scr_width * scr_height, sizeof(int16_t));
-    if (!z_buffer) {
-        printf("gfx_soft: could not alloc zbuffer for %dx%d\n", scr_width, scr_height);
+    bin_cols = (scr_width + BIN_TILE_SIZE - 1) >> BIN_TILE_SHIFT;
+    bin_rows = (scr_height + BIN_TILE_SIZE - 1) >> BIN_TILE_SHIFT;
+    if (bin_cols * bin_rows > BIN_MAX_TILES) {
+        printf("gfx_soft: %dx%d needs more than %d bins\n", scr_width, scr_height, BIN_MAX_TILES);
         abort();
     }
 
-    gfx_output = calloc(scr_width * scr_height, sizeof(uint32_t));
-    if (!gfx_output) {
-        printf("gfx_soft: could not alloc color buffer for %dx%d\n", scr_width, scr_height);
-        abort();
+    zc_cols = (scr_width + ZC_BLOCK_SIZE - 1) >> ZC_BLOCK_SHIFT;
+    zc_rows = (scr_height + ZC_BLOCK_SIZE - 1) >> ZC_BLOCK_SHIFT;
+
+    // the color and depth buffers are one block the size of the resolution, the 120p and 80p modes
+    // only take a quarter and a sixteenth of the full screen's. A switch between the modes, which
+    // happens between frames, allocates it again
+    if (scr_size != scr_capacity) {
+        free(gfx_output);
+        gfx_output = calloc(scr_size, sizeof(gfx_pixel_t) + sizeof(uint16_t));
+        if (!gfx_output) {
+            printf("gfx_soft: could not alloc color and depth buffers for %dx%d\n", scr_width, scr_height);
+            abort();
+        }
+        z_buffer = (uint16_t *) (gfx_output + scr_size);
+
+        scr_capacity = scr_size;
+    }
+
+    if (zc_cols * zc_rows > zc_capacity) {
+        free(zc_max);
+        free(zc_dirty);
+        free(zc_list);
+#if DEPTH_LAZY_CLEAR
+        free(zc_stale);
+        zc_stale = calloc(zc_cols * zc_rows, sizeof(uint8_t));
+#endif
+        zc_max = calloc(zc_cols * zc_rows, sizeof(uint16_t));
+        zc_dirty = calloc(zc_cols * zc_rows, sizeof(uint8_t));
+        zc_list = calloc(zc_cols * zc_rows, sizeof(uint16_t));
+        if (!zc_max || !zc_dirty || !zc_list) {
+            printf("gfx_soft: could not alloc coarse zbuffer for %dx%d\n", scr_width, scr_height);
+            abort();
+        }
+#if DEPTH_LAZY_CLEAR
+        if (!zc_stale) {
+            printf("gfx_soft: could not alloc coarse zbuffer for %dx%d\n", scr_width, scr_height);
+            abort();
+        }
+#endif
+        zc_capacity = zc_cols * zc_rows;
     }
 
     depth_clear();
@@ -1124,6 +2006,7 @@ static void gfx_soft_init(void) {
     texcache = calloc(1, TEXCACHE_STEP); // this will be realloc'd as needed
     texcache_size = TEXCACHE_STEP;
     texcache_addr = 0;
+    memset(texcache_free, 0xFF, sizeof(texcache_free)); // TEXCACHE_NONE
     if (!texcache) {
         printf("gfx_soft: could not alloc %u bytes for texture cache\n", TEXCACHE_STEP);
         abort();
@@ -1144,15 +2027,52 @@ static void gfx_soft_start_frame(void) {
     depth_clear();
 }
 
+// one line per shader program: how often it was loaded and how many triangles it drew
+static void gfx_soft_dump_shader_stats(void) {
+    FILE *f = fopen(SHADER_STATS_FILENAME, "w");
+    if (f == NULL) {
+        printf("Could not open '%s' for shader stats\n", SHADER_STATS_FILENAME);
+        return;
+    }
+    fprintf(f, "shader_id,num_props,draw_flags,binds,tris\n");
+    for (int i = 0; i < shader_program_pool_size; i++) {
+        const struct ShaderProgram *prg = &shader_program_pool[i];
+        fprintf(f, "%08lX,%d,%lu,%lu,%lu\n", (unsigned long) prg->shader_id, prg->num_props,
+                (unsigned long) prg->draw_flags, (unsigned long) prg->binds,
+                (unsigned long) prg->tris);
+    }
+    fclose(f);
+}
+
 static void gfx_soft_shutdown(void) {
-    free(z_buffer);
+    if (configProfileCsv)
+        gfx_soft_dump_shader_stats();
+    free(gfx_output); // the depth buffer is in the same block
+    free(zc_max);
+    free(zc_dirty);
+    free(zc_list);
+#if DEPTH_LAZY_CLEAR
+    free(zc_stale);
+#endif
     free(texcache);
 }
 
 static void gfx_soft_on_resize(void) {
+    gfx_soft_set_resolution(gfx_current_dimensions.width, gfx_current_dimensions.height);
 }
 
 static void gfx_soft_end_frame(void) {
+#if MEM_STATS
+    // freed slabs only take textures of their class, so the tail that was never handed out is what is free for
+    // any size
+    memstats_set(MEM_TEXCACHE, texcache_used, texcache_size, texcache_size - texcache_addr);
+    uint32_t targets = scr_capacity * (sizeof(gfx_pixel_t) + sizeof(uint16_t))
+                       + zc_capacity * (2 * sizeof(uint16_t) + sizeof(uint8_t));
+#if DEPTH_LAZY_CLEAR
+    targets += zc_capacity * sizeof(uint8_t);
+#endif
+    memstats_set(MEM_TARGETS, targets, targets, 0);
+#endif
 }
 
 static void gfx_soft_finish_render(void) {
@@ -1172,4 +2092,7 @@ struct GfxRenderingAPI gfx_soft_api = {
     gfx_soft_end_frame,        gfx_soft_finish_render,
     gfx_soft_fill_rect,        gfx_soft_tex_rect,
     gfx_soft_set_fog_color,    gfx_soft_shutdown,
+#if TEXCACHE_CI
+    gfx_soft_upload_texture_ci, gfx_soft_upload_palette,
+#endif
 };
@@ -3,7 +3,15 @@
 
 #include "gfx_rendering_api.h"
 
+#if OUTPUT_RGB565
+// the color buffer holds LCD ready RGB565 pixels
+typedef uint16_t gfx_pixel_t;
+#else
+// the color buffer holds RGBA32 pixels, converted for the LCD on swap
+typedef uint32_t gfx_pixel_t;
+#endif
+
 extern struct GfxRenderingAPI gfx_soft_api;
-extern uint32_t *gfx_output;
+extern gfx_pixel_t *gfx_output;
 
 #endif
@@ -14,14 +14,44 @@
 #include "gfx_cc.h"
 #include "gfx_window_manager_api.h"
 #include "gfx_rendering_api.h"
+#include "gfx_backend.h"
 
 #include "pc/configfile.h"
 #include "pc/timer.h"
 #include "pc/fixed_pt.h"
 #include "pc/profiling.h"
+#include "pc/nsp_pack.h"
 
 #define SUPPORT_CHECK(x) assert(x)
 
+#if PRERENDER_NATIVE
+// runs a G_NSP_FBOP on the finished part of the frame, see prerender_nsp.c
+void nsp_prerender_run_op(uint32_t op, uint32_t width, uint32_t height, uint32_t env, void *src, void *dst);
+#endif
+
+#if TRANSITION_FILL
+// runs a G_NSP_FILL on the finished part of the frame, see transition_nsp.c
+void nsp_transition_fill(uint32_t op, uint32_t params, uint32_t color, int32_t s, int32_t t, uint32_t dxdy,
+                         const void *tex);
+#endif
+
+// the sky is drawn as a layer, the HUD as overlay layers
+#define GFX_LAYERS (SKYBOX_LAYER_CACHE || HUD_LAYER_CACHE)
+
+#if GFX_LAYERS
+// the color buffers layers left, see layer_nsp.c
+bool nsp_layer_restore(uint32_t hash);
+void nsp_layer_save(uint32_t hash);
+void nsp_layer_end_frame(void);
+#endif
+
+#if HUD_LAYER_CACHE
+// what overlay layers drew, see layer_nsp.c
+bool nsp_overlay_restore(uint32_t id, uint32_t hash, bool *save);
+bool nsp_overlay_backgrounds(gfx_pixel_t **black, gfx_pixel_t **white);
+void nsp_overlay_save(uint32_t id, uint32_t hash);
+#endif
+
 // SCALE_M_N: upscale/downscale M-bit integer to N-bit
 #define SCALE_5_8(VAL_) (((VAL_) * 0xFF) / 0x1F)
 #define SCALE_8_5(VAL_) ((((VAL_) + 4) * 0x1F) / 0xFF)
@@ -45,6 +75,9 @@
 #define GFX_W_PREMULT 1
 // leave colors as 0-255 floats
 #define GFX_COLOR_ONE 255
+// how far past the screen edges, in screen sizes from the center, a vertex can be and still be
+// left to the rasterizer's scissor instead of being clipped
+#define GUARD_BAND 4
 
 enum {
     CLIP_NONE = 0,
@@ -55,6 +88,8 @@ enum {
     CLIP_RIGHT = 16,
     CLIP_LEFT = 32,
     CLIP_ALL = 63,
+    CLIP_GUARD = 64, // outside of the guard band
+    CLIP_XY = CLIP_TOP | CLIP_BOTTOM | CLIP_RIGHT | CLIP_LEFT,
 };
 
 struct RGBA {
@@ -72,30 +107,144 @@ struct LoadedVertex {
     uint8_t clip_rej;
 };
 
+#define TEXTURE_CACHE_SIZE 512
+
 struct TextureHashmapNode {
     struct TextureHashmapNode *next;
 
-    const uint8_t *texture_addr;
+    uintptr_t texture_key; // VROM address of a texture read from the ROM, RAM address of the others
+    bool from_rom;
+    const uint8_t *texture_addr; // where it was last used from
+    uint32_t src_hash; // of the N64 texels of one from the ROM, to tell the file changed in RAM
     uint8_t fmt, siz;
+    uint32_t tlut_hash; // hash of the palette of CI textures, 0 otherwise
 
     uint32_t texture_id;
     uint8_t cms, cmt;
     bool linear_filter;
+    bool referenced; // used since the clock hand last passed, spares it from eviction once
+    struct RGBA avg_color; // of its texels, what distant triangles are drawn with, see gfx_lod
 };
 static struct {
     struct TextureHashmapNode *hashmap[1024];
-    struct TextureHashmapNode pool[512];
-    uint32_t pool_pos;
+    struct TextureHashmapNode pool[TEXTURE_CACHE_SIZE];
+    uint32_t pool_pos;   // nodes in use, the pool fills up once and then recycles evicted nodes
+    uint32_t clock_hand; // next eviction candidate
 } gfx_texture_cache;
 
+struct GfxTextureCacheStats gfx_texture_cache_stats;
+
+#define VERTEX_CACHE_SIZE 1024
+#define XFORM_HISTORY_SIZE 8
+
+// transformed vertices, looked up by their address: repeated loads of the same Vtx array under
+// the same matrices and lights, like skeleton limbs, room display lists and billboards drawn more
+// than once, are copied from here instead of being transformed again
+struct VertexCacheEntry {
+    const Vtx *addr;
+    Vtx src; // what the vertex held when it was transformed
+    uint32_t xform_gen, shade_gen;
+    struct LoadedVertex vtx;
+};
+static struct VertexCacheEntry gfx_vertex_cache[VERTEX_CACHE_SIZE];
+
+// the last few distinct modelview and projection matrix pairs, so that loading matrices the game
+// loaded before (the same room or camera matrix every frame) brings back their generation
+static struct {
+    fix64 mv[4][4];
+    fix64 p[4][4];
+#if XFORM_LAZY
+    fix64 mp[4][4]; // their product, so that it isn't multiplied again either
+#endif
+    uint32_t gen;
+} gfx_xform_history[XFORM_HISTORY_SIZE];
+static uint32_t gfx_xform_history_pos;
+static uint32_t gfx_xform_gen_count;
+
+struct GfxVertexCacheStats gfx_vertex_cache_stats;
+
+#define DL_CACHE_BUCKETS 256
+#define DL_CACHE_ENTRIES 1024
+#define DL_CACHE_OPS 16384
+#define DL_CACHE_TRIS 16384
+#define DL_CACHE_RANGES 64
+
+// display lists in data loaded from the ROM (rooms, objects) are the same every frame, the first
+// run translates them into these ops with the command fields already taken apart and runs of
+// triangles gathered in one op, and the runs after replay them. The addresses of the vertex, call
+// and branch ops are kept as the commands have them, the segments they're in can move between runs
+enum DlCacheOpKind {
+    DL_OP_CMD,    // any other command, run by gfx_run_cmd from ptr
+    DL_OP_VTX,    // count vertices from address ptr to index arg
+    DL_OP_TRIS,   // count triangles with the indices from gfx_dl_cache.tris[arg]
+    DL_OP_CALL,   // the display list at address ptr
+    DL_OP_BRANCH, // the display list at address ptr, which this one ends with
+    DL_OP_CULL,   // G_CULLDL, ends the display list if the loaded vertices arg to count are all out of view
+    DL_OP_BRANCH_Z, // the G_BRANCH_Z at ptr, branches to the display list of the G_RDPHALF_1 before it
+};
+
+struct DlCacheOp {
+    uint8_t kind;
+    uint16_t count;
+    uint16_t arg;
+    const void *ptr;
+};
+
+struct DlCacheEntry {
+    struct DlCacheEntry *next;
+    const Gfx *dl;
+    uint32_t num_cmds; // Gfx words from dl to its G_ENDDL or branch
+    uint32_t hash;     // of those words when it was compiled
+    uint32_t first_op, num_ops;
+    bool compiled; // false for display lists that have to be interpreted
+};
+
+// memory the DMA layer loaded ROM data to
+struct DlCacheRange {
+    uintptr_t start;
+    uint32_t size;
+};
+
+enum DlCompileResult {
+    DL_COMPILE_OK,
+    DL_COMPILE_OUT_OF_DATA,  // the display list runs past the range it's in
+    DL_COMPILE_OUT_OF_SPACE, // the pools are full
+};
+
+static struct {
+    struct DlCacheEntry *hashmap[DL_CACHE_BUCKETS];
+    struct DlCacheEntry entries[DL_CACHE_ENTRIES];
+    struct DlCacheOp ops[DL_CACHE_OPS];
+    uint8_t tris[DL_CACHE_TRIS][3];
+    uint32_t num_entries, num_ops, num_tris;
+    struct DlCacheRange ranges[DL_CACHE_RANGES]; // oldest first
+    uint32_t num_ranges;
+    bool clear_pending; // empty the pools before the next frame
+} gfx_dl_cache;
+
+struct GfxDlCacheStats gfx_dl_cache_stats;
+
+uintptr_t gfx_segments[16];
+
+// F3DEX2 keeps the return addresses of display list calls in a stack this deep, a call past it is
+// skipped whole
+#define DL_STACK_SIZE 18
+
+static uint32_t gfx_dl_depth; // calls gfx_run_dl is inside of
+
 struct ColorCombiner {
     uint32_t cc_id;
     struct ShaderProgram *prg;
     uint8_t shader_input_mapping[2][4];
 };
 
-static struct ColorCombiner color_combiner_pool[64];
+#define CC_POOL_SIZE 64
+#define CC_HASH_SIZE 128 // open addressing, kept at most half full
+
+static struct ColorCombiner color_combiner_pool[CC_POOL_SIZE];
 static uint8_t color_combiner_pool_size;
+static uint8_t color_combiner_hash[CC_HASH_SIZE]; // pool index + 1, 0 for an empty slot
+static struct ColorCombiner *prev_combiner;
 
 static struct RSP {
     fix64 modelview_matrix_stack[11][4][4];
@@ -103,12 +252,23 @@ static struct RSP {
 
     fix64 MP_matrix[4][4];
     fix64 P_matrix[4][4];
+#if XFORM_LAZY
+    bool xform_changed; // MP_matrix and xform_gen are behind the matrices, see gfx_update_xform
+#endif
 
     Light_t current_lights[MAX_LIGHTS + 1];
     fix64 current_lights_coeffs[MAX_LIGHTS][3];
     fix64 current_lookat_coeffs[2][3]; // lookat_x, lookat_y
     uint8_t current_num_lights;        // includes ambient light
     bool lights_changed;
+#if LIGHTS_BIND_CACHE
+    bool lights_reloaded; // G_MW_NUMLIGHT since the coefficients were calculated
+    bool lights_stale;    // lights loaded since then differ from what they were calculated from
+#endif
+
+    // generations of the state vertices are transformed and shaded with, for the vertex cache
+    uint32_t xform_gen; // modelview and projection matrices
+    uint32_t shade_gen; // lights, texture scale, fog and the geometry mode bits that affect shading
 
     uint32_t geometry_mode;
     int16_t fog_mul, fog_offset;
@@ -119,6 +279,9 @@ static struct RSP {
     } texture_scaling_factor;
 
     struct LoadedVertex loaded_vertices[MAX_VERTICES + 4];
+
+    uint32_t rdphalf_1; // the display list of the next G_BRANCH_Z
+    int16_t viewport_zscale, viewport_ztrans; // take the vertices to the screen Z G_BRANCH_Z compares
 } rsp;
 
 static struct RDP {
@@ -146,11 +309,65 @@ static struct RDP {
 
     struct RGBA env_color, prim_color, fog_color, fill_color;
     struct XYWidthHeight viewport, scissor;
-    bool viewport_or_scissor_changed;
+    uint32_t state_changed; // GFX_CHANGED_* bits, what gfx_push_triangle has to look at again
     void *z_buf_address;
     void *color_image_address;
 } rdp;
 
+// the state gfx_push_triangle reconciles with the rendering API, flagged by the commands that
+// change it so that triangles drawn with the same state as the last one only test the flags
+#define GFX_CHANGED_ZMODE (1 << 0)    // depth test, depth mask and decal mode
+#define GFX_CHANGED_VIEWPORT (1 << 1) // viewport and scissor
+#define GFX_CHANGED_COMBINER (1 << 2) // combine mode and the other mode bits it is picked with
+#define GFX_CHANGED_TEXTURES (1 << 3) // loaded textures, render tile and filter
+#define GFX_CHANGED_ALL 0xF
+
+// what gfx_push_triangle picked the last time, while its GFX_CHANGED_* bits are clear
+static struct {
+    struct ColorCombiner *comb;
+    uint8_t num_inputs;
+    bool used_textures[2];
+    bool use_fog, use_alpha;
+    bool use_texture;
+    struct ShaderProgram *lod_prg; // the shade only shader distant textured triangles switch to
+    uint32_t lod_shader_id;
+    fix64 cull_cross; // twice the area in NDC under which triangles are culled, 0 to cull none
+} gfx_triangle_state;
+
+// Distance LOD for the triangles of a textured combiner, from the config:
+// - past configLodTextureDist, the textures are replaced by the average of their colors, so
+//   that the combiner can be worked out per vertex and the triangle drawn with a shade only shader
+// - past configFlatShadeDist, the triangle also gets the average color of its vertices
+// - triangles covering less than configLodCullArea sixteenths of a pixel aren't drawn at all
+// With configLodTriBudget set, frames drawing more triangles than that bring the distances closer
+// and grow the culled area, frames well under it let them go back to the config
+#define GFX_LOD_NONE 0
+#define GFX_LOD_AVERAGE 1
+#define GFX_LOD_FLAT 2
+#define GFX_LOD_FOGGED 3 // all fog, the shade only shader with whatever shade
+
+static struct {
+    bool enabled;
+    int32_t average_w3, flat_w3; // thresholds on the sum of the three w, 0 for none
+    uint32_t cull_area;          // in sixteenths of a pixel
+    uint32_t scale;              // 256 for the config's thresholds, less under a busy budget
+    uint32_t tris;               // drawn since the frame started
+} gfx_lod = { .scale = 256 };
+
+static const struct ColorCombiner gfx_lod_combiner = {
+    .shader_input_mapping = { { CC_SHADE }, { CC_SHADE } },
+};
+
+#if DRAW_SKIP_INVISIBLE
+// whether a pixel at alpha 0 leaves the color and depth buffers as they were, for the combine and
+// other modes it was worked out for, see gfx_invisible
+static struct {
+    uint32_t combine_mode, other_mode_l;
+    bool blended;
+    bool use_fog;
+} gfx_invisible_state = { .combine_mode = ~0U };
+#endif
+
 static struct RenderingState {
     bool depth_test;
     bool depth_mask;
@@ -169,19 +386,46 @@ static float inv_ratio_y = 1.f;
 
 static bool dropped_frame;
 
-static fix64 buf_vbo[MAX_BUFFERED * (26 * 3)]; // 3 vertices in a triangle and 26 floats per vtx
+#if GFX_LAYERS
+static struct {
+    bool drawing;  // its commands are drawn, the color buffer is saved at its end
+    bool skipping; // its saved color buffer was copied back, nothing is drawn until its end
+    uint32_t hash;
+} gfx_layer;
+#endif
+
+#if HUD_LAYER_CACHE
+// an overlay layer is drawn over black, then again over white, and what it drew is worked out
+// from the two, see layer_nsp.c
+static struct {
+    uint32_t pass; // 1 over black, 2 over white, 0 while no overlay is drawn twice
+    uint32_t id, hash;
+    Gfx *begin;
+    gfx_pixel_t *output, *white; // the color buffer it goes over, and its second background
+    struct RSP rsp;              // the state it started from, for the second pass
+    struct RDP rdp;
+} gfx_overlay;
+#endif
+
+static fixr buf_vbo[MAX_BUFFERED * (26 * 3)]; // 3 vertices in a triangle and 26 floats per vtx
 static size_t buf_vbo_len;
 static size_t buf_vbo_num_tris;
 
 static struct GfxWindowManagerAPI *gfx_wapi;
 static struct GfxRenderingAPI *gfx_rapi;
 
+// narrows a property that was divided by w (or 1/w itself) to the precision of the rasterizer
+static inline fixr gfx_raster_prop(const fix64 prop) {
+    return fixr_from_fix(prop * (1 << FIXR_W_SHIFT));
+}
+
 static void gfx_flush(void) {
     if (buf_vbo_len > 0) {
-        uint64_t t0 = tmr_ms();
+        const uint32_t t0 = tmr_ms();
         gfx_rapi->draw_triangles(buf_vbo, buf_vbo_len, buf_vbo_num_tris);
-        tFlushing += tmr_ms() - t0;
-        numTris += buf_vbo_num_tris;
+        prof_frame.time[PROF_RASTER] += tmr_ms() - t0;
+        prof_frame.count[PROF_TRIS] += buf_vbo_num_tris;
+        gfx_lod.tris += buf_vbo_num_tris;
 
         buf_vbo_len = 0;
         buf_vbo_num_tris = 0;
@@ -245,60 +489,418 @@ static void gfx_generate_cc(struct ColorCombiner *comb, uint32_t cc_id) {
     memcpy(comb->shader_input_mapping, shader_input_mapping, sizeof(shader_input_mapping));
 }
 
+static inline uint32_t gfx_color_combiner_slot(uint32_t cc_id) {
+    return (cc_id * 0x9E3779B1U) >> 25; // top 7 bits, CC_HASH_SIZE slots
+}
+
 static struct ColorCombiner *gfx_lookup_or_create_color_combiner(uint32_t cc_id) {
-    static struct ColorCombiner *prev_combiner;
     if (prev_combiner != NULL && prev_combiner->cc_id == cc_id) {
         return prev_combiner;
     }
 
-    for (size_t i = 0; i < color_combiner_pool_size; i++) {
-        if (color_combiner_pool[i].cc_id == cc_id) {
-            return prev_combiner = &color_combiner_pool[i];
+    uint32_t slot = gfx_color_combiner_slot(cc_id);
+    for (; color_combiner_hash[slot]; slot = (slot + 1) & (CC_HASH_SIZE - 1)) {
+        struct ColorCombiner *comb = &color_combiner_pool[color_combiner_hash[slot] - 1];
+        if (comb->cc_id == cc_id) {
+            return prev_combiner = comb;
         }
     }
     gfx_flush();
+    if (color_combiner_pool_size == CC_POOL_SIZE) {
+        // combiners are cheap to rebuild and the shader programs they point to stay cached in the
+        // backend, so start over rather than overrun the pool
+        memset(color_combiner_hash, 0, sizeof(color_combiner_hash));
+        color_combiner_pool_size = 0;
+        slot = gfx_color_combiner_slot(cc_id);
+    }
     struct ColorCombiner *comb = &color_combiner_pool[color_combiner_pool_size++];
+    color_combiner_hash[slot] = color_combiner_pool_size;
     gfx_generate_cc(comb, cc_id);
     return prev_combiner = comb;
 }
 
+static inline struct TextureHashmapNode **gfx_texture_cache_bucket(uintptr_t key) {
+    return &gfx_texture_cache.hashmap[(key >> 5) & 0x3ff];
+}
+
+static uint32_t gfx_texture_src_hash(const uint8_t *addr, uint32_t size) {
+    uint32_t hash = 0x811C9DC5;
+    for (uint32_t i = 0; i < size; i++)
+        hash = (hash ^ addr[i]) * 0x01000193;
+    return hash;
+}
+
+static uint32_t gfx_texture_tlut_hash(uint32_t fmt, uint32_t siz) {
+    if (fmt != G_IM_FMT_CI)
+        return 0;
+    // FNV-1a over the 16 or 256 big endian RGBA16 palette entries in use
+    const uint32_t size = (siz == G_IM_SIZ_4b) ? 16 * 2 : 256 * 2;
+    uint32_t hash = 0x811C9DC5;
+    for (uint32_t i = 0; i < size; i++)
+        hash = (hash ^ rdp.palette[i]) * 0x01000193;
+    return hash;
+}
+
+// picks the node to reuse with the clock algorithm: the hand skips and clears nodes used since it
+// last passed them, and never takes the textures still selected for either tile
+static struct TextureHashmapNode *gfx_texture_cache_evict(void) {
+    struct TextureHashmapNode *victim;
+    for (;;) {
+        victim = &gfx_texture_cache.pool[gfx_texture_cache.clock_hand];
+        gfx_texture_cache.clock_hand = (gfx_texture_cache.clock_hand + 1) % TEXTURE_CACHE_SIZE;
+        if (victim == rendering_state.textures[0] || victim == rendering_state.textures[1])
+            continue;
+        if (!victim->referenced)
+            break;
+        victim->referenced = false;
+    }
+    struct TextureHashmapNode **node = gfx_texture_cache_bucket(victim->texture_key);
+    while (*node != victim)
+        node = &(*node)->next;
+    *node = victim->next;
+    gfx_texture_cache_stats.evictions++;
+    return victim;
+}
+
+/**
+ * Finds the texture at orig_addr in the cache, or makes a node to import it
+ * into. Textures read from the ROM are known by their VROM address, so that
+ * they stay converted when a room or an object is read to another place:
+ * the first use from the new place checks the texels are still the ones
+ * imported, the game can change a file after reading it, then the address
+ * is trusted as for the textures from anywhere else.
+ *
+ * A CI texture drawn with another palette than the one it was cached with,
+ * as the textures whose palette is animated are, keeps its node if the
+ * backend can replace the palette alone: *palette_only is then set, and
+ * only the palette has to be uploaded.
+ */
 static bool gfx_texture_cache_lookup(int tile, struct TextureHashmapNode **n, const uint8_t *orig_addr,
-                                     uint32_t fmt, uint32_t siz) {
-    size_t hash = (uintptr_t) orig_addr;
-    hash = (hash >> 5) & 0x3ff;
-    struct TextureHashmapNode **node = &gfx_texture_cache.hashmap[hash];
-    while (*node != NULL && *node - gfx_texture_cache.pool < (int) gfx_texture_cache.pool_pos) {
-        if ((*node)->texture_addr == orig_addr && (*node)->fmt == fmt && (*node)->siz == siz) {
+                                     uint32_t size_bytes, uint32_t fmt, uint32_t siz, bool *palette_only) {
+    const uint32_t tlut_hash = gfx_texture_tlut_hash(fmt, siz);
+    struct TextureHashmapNode *palette_node = NULL;
+    *palette_only = false;
+    uintptr_t key = (uintptr_t) orig_addr;
+    bool from_rom = false;
+#if TEXCACHE_ROM_KEYS
+    uint32_t vrom;
+    if (size_bytes != 0 && nsp_pack_vrom(orig_addr, size_bytes, &vrom)) {
+        key = vrom;
+        from_rom = true;
+    }
+#endif
+    struct TextureHashmapNode *new_node = NULL;
+    struct TextureHashmapNode **node = gfx_texture_cache_bucket(key);
+    while (*node != NULL) {
+        if ((*node)->texture_key == key && (*node)->from_rom == from_rom && (*node)->fmt == fmt
+            && (*node)->siz == siz && (*node)->tlut_hash == tlut_hash) {
+            if (from_rom && (*node)->texture_addr != orig_addr) {
+                if (gfx_texture_src_hash(orig_addr, size_bytes) != (*node)->src_hash) {
+                    // changed since, imported again in the same node
+                    new_node = *node;
+                    break;
+                }
+                (*node)->texture_addr = orig_addr;
+            }
             gfx_rapi->select_texture(tile, (*node)->texture_id);
+            (*node)->referenced = true;
+            gfx_texture_cache_stats.hits++;
             *n = *node;
             return true;
         }
+        if (tlut_hash != 0 && gfx_rapi->upload_palette != NULL && (*node)->texture_key == key
+            && (*node)->from_rom == from_rom && (*node)->fmt == fmt && (*node)->siz == siz
+            && (*node)->texture_addr == orig_addr && *node != rendering_state.textures[tile ^ 1])
+            palette_node = *node;
         node = &(*node)->next;
     }
-    if (gfx_texture_cache.pool_pos
-        == sizeof(gfx_texture_cache.pool) / sizeof(struct TextureHashmapNode)) {
-        // Pool is full. We just invalidate everything and start over.
-        gfx_texture_cache.pool_pos = 0;
-        node = &gfx_texture_cache.hashmap[hash];
-        // puts("Clearing texture cache");
+    gfx_texture_cache_stats.misses++;
+    if (new_node == NULL && palette_node != NULL) {
+        gfx_rapi->select_texture(tile, palette_node->texture_id);
+        palette_node->referenced = true;
+        palette_node->tlut_hash = tlut_hash;
+        *palette_only = true;
+        *n = palette_node;
+        return false;
     }
-    *node = &gfx_texture_cache.pool[gfx_texture_cache.pool_pos++];
-    if ((*node)->texture_addr == NULL) {
-        (*node)->texture_id = gfx_rapi->new_texture();
+    if (new_node == NULL) {
+        if (gfx_texture_cache.pool_pos < TEXTURE_CACHE_SIZE) {
+            new_node = &gfx_texture_cache.pool[gfx_texture_cache.pool_pos++];
+            new_node->texture_id = gfx_rapi->new_texture();
+        } else {
+            // Pool is full, reuse the node and the backend texture of a texture not used lately.
+            // Eviction can unlink the node *node points to, so append to the bucket afterwards.
+            new_node = gfx_texture_cache_evict();
+            node = gfx_texture_cache_bucket(key);
+            while (*node != NULL)
+                node = &(*node)->next;
+        }
+        *node = new_node;
+        new_node->next = NULL;
     }
-    gfx_rapi->select_texture(tile, (*node)->texture_id);
+    gfx_rapi->select_texture(tile, new_node->texture_id);
     gfx_rapi->set_sampler_parameters(tile, false, 0, 0);
-    (*node)->cms = 0;
-    (*node)->cmt = 0;
-    (*node)->linear_filter = false;
-    (*node)->next = NULL;
-    (*node)->texture_addr = orig_addr;
-    (*node)->fmt = fmt;
-    (*node)->siz = siz;
-    *n = *node;
+    new_node->cms = 0;
+    new_node->cmt = 0;
+    new_node->linear_filter = false;
+    new_node->referenced = true;
+    new_node->texture_key = key;
+    new_node->from_rom = from_rom;
+    new_node->texture_addr = orig_addr;
+    new_node->src_hash = from_rom ? gfx_texture_src_hash(orig_addr, size_bytes) : 0;
+    new_node->fmt = fmt;
+    new_node->siz = siz;
+    new_node->tlut_hash = tlut_hash;
+    *n = new_node;
     return false;
 }
 
+// keeps the average of the colors of the texture imported for `tile` with it, weighted by alpha so
+// that the cut out parts don't darken it. 64 texels spread over it are enough at the distances it is
+// drawn at. The texels are RGBA32, or CI4 or CI8 indices into an RGBA32 palette
+static void gfx_texture_avg_color(int tile, const uint8_t *texels, uint32_t num_texels, uint32_t bits,
+                                  const uint8_t *rgba32_palette) {
+    const uint32_t step = num_texels > 64 ? num_texels / 64 : 1;
+    uint32_t r = 0, g = 0, b = 0, a = 0, n = 0;
+    for (uint32_t i = 0; i < num_texels; i += step, n++) {
+        const uint8_t *t;
+        if (bits == 4)
+            t = &rgba32_palette[4 * ((texels[i / 2] >> (4 - (i % 2) * 4)) & 0xf)];
+        else if (bits == 8)
+            t = &rgba32_palette[4 * texels[i]];
+        else
+            t = &texels[4 * i];
+        r += t[0] * t[3];
+        g += t[1] * t[3];
+        b += t[2] * t[3];
+        a += t[3];
+    }
+    struct RGBA *avg = &rendering_state.textures[tile]->avg_color;
+    avg->r = a ? r / a : 0;
+    avg->g = a ? g / a : 0;
+    avg->b = a ? b / a : 0;
+    avg->a = n ? a / n : 0;
+}
+
+// uploads the texture imported for `tile`, with the average of its colors
+static void gfx_upload_texture(int tile, const uint8_t *rgba32_buf, uint32_t width, uint32_t height) {
+    gfx_texture_avg_color(tile, rgba32_buf, width * height, 32, NULL);
+    gfx_rapi->upload_texture(rgba32_buf, width, height);
+}
+
+// the 16 or 256 RGBA16 colors of the loaded palette in RGBA32
+static void gfx_convert_palette(uint8_t *rgba32_palette, uint32_t num_colors) {
+    for (uint32_t i = 0; i < num_colors; i++) {
+        uint16_t col16 = (rdp.palette[i * 2] << 8) | rdp.palette[i * 2 + 1]; // Big endian load
+        rgba32_palette[4 * i + 0] = SCALE_5_8(col16 >> 11);
+        rgba32_palette[4 * i + 1] = SCALE_5_8((col16 >> 6) & 0x1f);
+        rgba32_palette[4 * i + 2] = SCALE_5_8((col16 >> 1) & 0x1f);
+        rgba32_palette[4 * i + 3] = (col16 & 1) ? 255 : 0;
+    }
+}
+
+// uploads the CI4 or CI8 texture loaded for `tile` as its indices and palette, for backends that
+// look texels up in the palette as they sample them
+static void gfx_upload_texture_ci(int tile, uint32_t bits, uint32_t width, uint32_t height) {
+    uint8_t rgba32_palette[256 * 4];
+    gfx_convert_palette(rgba32_palette, (bits == 4) ? 16 : 256);
+    gfx_texture_avg_color(tile, rdp.loaded_texture[tile].addr, width * height, bits, rgba32_palette);
+    gfx_rapi->upload_texture_ci(rdp.loaded_texture[tile].addr, width, height, bits, rgba32_palette);
+}
+
+// gives the CI texture cached for `tile` the palette loaded now, its indices are the same
+static void gfx_upload_palette(int tile, uint32_t siz) {
+    const uint32_t bits = (siz == G_IM_SIZ_4b) ? 4 : 8;
+    const uint32_t width = rdp.texture_tile.line_size_bytes * 8 / bits;
+    const uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
+    uint8_t rgba32_palette[256 * 4];
+    gfx_convert_palette(rgba32_palette, (bits == 4) ? 16 : 256);
+    gfx_texture_avg_color(tile, rdp.loaded_texture[tile].addr, width * height, bits, rgba32_palette);
+    gfx_rapi->upload_palette(rgba32_palette);
+}
+
+static void import_texture_rgba32(int tile) {
+    uint32_t width = rdp.texture_tile.line_size_bytes / 2;
+    uint32_t height = (rdp.loaded_texture[tile].size_bytes / 2) / rdp.texture_tile.line_size_bytes;
+    gfx_upload_texture(tile, rdp.loaded_texture[tile].addr, width, height);
+}
+
+#if TEX_IMPORT_LUT
+
+// byte n of a word loaded from a texture, in memory order. The Nspire and the host are little endian
+#define TEX_WORD_BYTE(w_, n_) (((w_) >> (8 * (n_))) & 0xff)
+
+// RGBA32 texels from the N64 formats, as the words the backend reads them as, filled by
+// gfx_texture_luts_init. They stay in the data cache while a texture converts, which a single
+// 65536 entry table for RGBA16 wouldn't, so its green, split over both bytes, has one of its own
+static uint32_t tex_lut_i4[16];         // I4, opaque
+static uint32_t tex_lut_ia4[16];        // IA4, 3-bit intensity and 1-bit alpha
+static uint32_t tex_lut_i8[256];        // I8, opaque
+static uint32_t tex_lut_ia8[256];       // IA8, 4-bit intensity and alpha
+static uint32_t tex_lut_ia16_i[256];    // IA16 intensity byte, alpha 0
+static uint32_t tex_lut_ia16_a[256];    // IA16 alpha byte, black
+static uint32_t tex_lut_rgba16_hi[256]; // RGBA16 red, from the high byte
+static uint32_t tex_lut_rgba16_lo[256]; // RGBA16 blue and alpha, from the low byte
+static uint32_t tex_lut_rgba16_g[32];   // RGBA16 green
+
+static uint32_t tex_rgba32_word(const uint8_t r, const uint8_t g, const uint8_t b, const uint8_t a) {
+    const uint8_t c[4] = { r, g, b, a };
+    uint32_t w;
+    memcpy(&w, c, sizeof(w));
+    return w;
+}
+
+static void gfx_texture_luts_init(void) {
+    for (uint32_t i = 0; i < 16; i++) {
+        tex_lut_i4[i] = tex_rgba32_word(SCALE_4_8(i), SCALE_4_8(i), SCALE_4_8(i), 255);
+        tex_lut_ia4[i] = tex_rgba32_word(SCALE_3_8(i >> 1), SCALE_3_8(i >> 1), SCALE_3_8(i >> 1),
+                                         (i & 1) ? 255 : 0);
+    }
+    for (uint32_t i = 0; i < 32; i++)
+        tex_lut_rgba16_g[i] = tex_rgba32_word(0, SCALE_5_8(i), 0, 0);
+    for (uint32_t i = 0; i < 256; i++) {
+        tex_lut_i8[i] = tex_rgba32_word(i, i, i, 255);
+        tex_lut_ia8[i] = tex_rgba32_word(SCALE_4_8(i >> 4), SCALE_4_8(i >> 4), SCALE_4_8(i >> 4),
+                                         SCALE_4_8(i & 0xf));
+        tex_lut_ia16_i[i] = tex_rgba32_word(i, i, i, 0);
+        tex_lut_ia16_a[i] = tex_rgba32_word(0, 0, 0, i);
+        tex_lut_rgba16_hi[i] = tex_rgba32_word(SCALE_5_8(i >> 3), 0, 0, 0);
+        tex_lut_rgba16_lo[i] = tex_rgba32_word(0, 0, SCALE_5_8((i >> 1) & 0x1f), (i & 1) ? 255 : 0);
+    }
+}
+
+static inline uint32_t tex_rgba16_word(const uint32_t hi, const uint32_t lo) {
+    return tex_lut_rgba16_hi[hi] | tex_lut_rgba16_g[((hi & 7) << 2) | (lo >> 6)] | tex_lut_rgba16_lo[lo];
+}
+
+// the conversions below read the texture a word at a time where it is aligned, which it is unless
+// a texture starts mid-word in its asset, and finish the bytes past the last whole word one by one
+
+// I4 or IA4, two texels a byte, with the high nibble first
+static void tex_import_4b(uint32_t *dst, const uint8_t *src, const uint32_t size, const uint32_t *lut) {
+    uint32_t i = 0;
+    if (!((uintptr_t) src & 3)) {
+        for (; i + 4 <= size; i += 4, dst += 8) {
+            const uint32_t w = *(const uint32_t *) (src + i);
+            for (int n = 0; n < 4; n++) {
+                dst[2 * n] = lut[TEX_WORD_BYTE(w, n) >> 4];
+                dst[2 * n + 1] = lut[TEX_WORD_BYTE(w, n) & 0xf];
+            }
+        }
+    }
+    for (; i < size; i++, dst += 2) {
+        dst[0] = lut[src[i] >> 4];
+        dst[1] = lut[src[i] & 0xf];
+    }
+}
+
+// I8 or IA8, a texel a byte
+static void tex_import_8b(uint32_t *dst, const uint8_t *src, const uint32_t size, const uint32_t *lut) {
+    uint32_t i = 0;
+    if (!((uintptr_t) src & 3)) {
+        for (; i + 4 <= size; i += 4) {
+            const uint32_t w = *(const uint32_t *) (src + i);
+            dst[i] = lut[TEX_WORD_BYTE(w, 0)];
+            dst[i + 1] = lut[TEX_WORD_BYTE(w, 1)];
+            dst[i + 2] = lut[TEX_WORD_BYTE(w, 2)];
+            dst[i + 3] = lut[TEX_WORD_BYTE(w, 3)];
+        }
+    }
+    for (; i < size; i++)
+        dst[i] = lut[src[i]];
+}
+
+// IA16 or RGBA16, a big endian texel every two bytes
+static void tex_import_16b(uint32_t *dst, const uint8_t *src, const uint32_t size, const bool rgba) {
+    uint32_t i = 0;
+    if (!((uintptr_t) src & 3)) {
+        for (; i + 4 <= size; i += 4, dst += 2) {
+            const uint32_t w = *(const uint32_t *) (src + i);
+            if (rgba) {
+                dst[0] = tex_rgba16_word(TEX_WORD_BYTE(w, 0), TEX_WORD_BYTE(w, 1));
+                dst[1] = tex_rgba16_word(TEX_WORD_BYTE(w, 2), TEX_WORD_BYTE(w, 3));
+            } else {
+                dst[0] = tex_lut_ia16_i[TEX_WORD_BYTE(w, 0)] | tex_lut_ia16_a[TEX_WORD_BYTE(w, 1)];
+                dst[1] = tex_lut_ia16_i[TEX_WORD_BYTE(w, 2)] | tex_lut_ia16_a[TEX_WORD_BYTE(w, 3)];
+            }
+        }
+    }
+    for (; i + 2 <= size; i += 2, dst++) {
+        if (rgba)
+            dst[0] = tex_rgba16_word(src[i], src[i + 1]);
+        else
+            dst[0] = tex_lut_ia16_i[src[i]] | tex_lut_ia16_a[src[i + 1]];
+    }
+}
+
+static void import_texture_rgba16(int tile) {
+    uint32_t rgba32_buf[2048];
+
+    tex_import_16b(rgba32_buf, rdp.loaded_texture[tile].addr, rdp.loaded_texture[tile].size_bytes, true);
+
+    uint32_t width = rdp.texture_tile.line_size_bytes / 2;
+    uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
+
+    gfx_upload_texture(tile, (const uint8_t *) rgba32_buf, width, height);
+}
+
+static void import_texture_ia4(int tile) {
+    uint32_t rgba32_buf[8192];
+
+    tex_import_4b(rgba32_buf, rdp.loaded_texture[tile].addr, rdp.loaded_texture[tile].size_bytes, tex_lut_ia4);
+
+    uint32_t width = rdp.texture_tile.line_size_bytes * 2;
+    uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
+
+    gfx_upload_texture(tile, (const uint8_t *) rgba32_buf, width, height);
+}
+
+static void import_texture_ia8(int tile) {
+    uint32_t rgba32_buf[4096];
+
+    tex_import_8b(rgba32_buf, rdp.loaded_texture[tile].addr, rdp.loaded_texture[tile].size_bytes, tex_lut_ia8);
+
+    uint32_t width = rdp.texture_tile.line_size_bytes;
+    uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
+
+    gfx_upload_texture(tile, (const uint8_t *) rgba32_buf, width, height);
+}
+
+static void import_texture_ia16(int tile) {
+    uint32_t rgba32_buf[2048];
+
+    tex_import_16b(rgba32_buf, rdp.loaded_texture[tile].addr, rdp.loaded_texture[tile].size_bytes, false);
+
+    uint32_t width = rdp.texture_tile.line_size_bytes / 2;
+    uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
+
+    gfx_upload_texture(tile, (const uint8_t *) rgba32_buf, width, height);
+}
+
+static void import_texture_i4(int tile) {
+    uint32_t rgba32_buf[8192];
+
+    tex_import_4b(rgba32_buf, rdp.loaded_texture[tile].addr, rdp.loaded_texture[tile].size_bytes, tex_lut_i4);
+
+    uint32_t width = rdp.texture_tile.line_size_bytes * 2;
+    uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
+
+    gfx_upload_texture(tile, (const uint8_t *) rgba32_buf, width, height);
+}
+
+static void import_texture_i8(int tile) {
+    uint32_t rgba32_buf[4096];
+
+    tex_import_8b(rgba32_buf, rdp.loaded_texture[tile].addr, rdp.loaded_texture[tile].size_bytes, tex_lut_i8);
+
+    uint32_t width = rdp.texture_tile.line_size_bytes;
+    uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
+
+    gfx_upload_texture(tile, (const uint8_t *) rgba32_buf, width, height);
+}
+
+#else
+
 static void import_texture_rgba16(int tile) {
     uint8_t rgba32_buf[8192];
 
@@ -318,13 +920,7 @@ static void import_texture_rgba16(int tile) {
     uint32_t width = rdp.texture_tile.line_size_bytes / 2;
     uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
-}
-
-static void import_texture_rgba32(int tile) {
-    uint32_t width = rdp.texture_tile.line_size_bytes / 2;
-    uint32_t height = (rdp.loaded_texture[tile].size_bytes / 2) / rdp.texture_tile.line_size_bytes;
-    gfx_rapi->upload_texture(rdp.loaded_texture[tile].addr, width, height);
+    gfx_upload_texture(tile, rgba32_buf, width, height);
 }
 
 static void import_texture_ia4(int tile) {
@@ -347,7 +943,7 @@ static void import_texture_ia4(int tile) {
     uint32_t width = rdp.texture_tile.line_size_bytes * 2;
     uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(tile, rgba32_buf, width, height);
 }
 
 static void import_texture_ia8(int tile) {
@@ -368,7 +964,7 @@ static void import_texture_ia8(int tile) {
     uint32_t width = rdp.texture_tile.line_size_bytes;
     uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(tile, rgba32_buf, width, height);
 }
 
 static void import_texture_ia16(int tile) {
@@ -389,7 +985,7 @@ static void import_texture_ia16(int tile) {
     uint32_t width = rdp.texture_tile.line_size_bytes / 2;
     uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(tile, rgba32_buf, width, height);
 }
 
 static void import_texture_i4(int tile) {
@@ -411,7 +1007,7 @@ static void import_texture_i4(int tile) {
     uint32_t width = rdp.texture_tile.line_size_bytes * 2;
     uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(tile, rgba32_buf, width, height);
 }
 
 static void import_texture_i8(int tile) {
@@ -431,12 +1027,20 @@ static void import_texture_i8(int tile) {
     uint32_t width = rdp.texture_tile.line_size_bytes;
     uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(tile, rgba32_buf, width, height);
 }
 
+#endif
+
 static void import_texture_ci4(int tile) {
     uint8_t rgba32_buf[32768];
 
+    if (gfx_rapi->upload_texture_ci != NULL) {
+        gfx_upload_texture_ci(tile, 4, rdp.texture_tile.line_size_bytes * 2,
+                              rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes);
+        return;
+    }
+
     for (uint32_t i = 0; i < rdp.loaded_texture[tile].size_bytes * 2; i++) {
         uint8_t byte = rdp.loaded_texture[tile].addr[i / 2];
         uint8_t idx = (byte >> (4 - (i % 2) * 4)) & 0xf;
@@ -454,12 +1058,18 @@ static void import_texture_ci4(int tile) {
     uint32_t width = rdp.texture_tile.line_size_bytes * 2;
     uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(tile, rgba32_buf, width, height);
 }
 
 static void import_texture_ci8(int tile) {
     uint8_t rgba32_buf[16384];
 
+    if (gfx_rapi->upload_texture_ci != NULL) {
+        gfx_upload_texture_ci(tile, 8, rdp.texture_tile.line_size_bytes,
+                              rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes);
+        return;
+    }
+
     for (uint32_t i = 0; i < rdp.loaded_texture[tile].size_bytes; i++) {
         uint8_t idx = rdp.loaded_texture[tile].addr[i];
         uint16_t col16 = (rdp.palette[idx * 2] << 8) | rdp.palette[idx * 2 + 1]; // Big endian load
@@ -476,18 +1086,50 @@ static void import_texture_ci8(int tile) {
     uint32_t width = rdp.texture_tile.line_size_bytes;
     uint32_t height = rdp.loaded_texture[tile].size_bytes / rdp.texture_tile.line_size_bytes;
 
-    gfx_rapi->upload_texture(rgba32_buf, width, height);
+    gfx_upload_texture(tile, rgba32_buf, width, height);
+}
+
+// textures the asset pack has decoded already, which saves the decode of a cache miss
+static bool import_texture_from_pack(int tile, uint32_t fmt, uint32_t siz) {
+    static uint8_t rgba32_buf[32768];
+    const uint32_t line_size = rdp.texture_tile.line_size_bytes;
+
+    // RGBA32 is uploaded as is, and CI textures depend on the palette loaded with them
+    if (line_size == 0 || siz == G_IM_SIZ_32b || fmt == G_IM_FMT_CI)
+        return false;
+
+    const uint32_t width = (siz == G_IM_SIZ_4b)   ? line_size * 2
+                           : (siz == G_IM_SIZ_8b) ? line_size
+                                                  : line_size / 2;
+    const uint32_t height = rdp.loaded_texture[tile].size_bytes / line_size;
+    if (!nsp_pack_texture(rdp.loaded_texture[tile].addr, rdp.loaded_texture[tile].size_bytes, fmt,
+                          siz, width, height, rgba32_buf, sizeof(rgba32_buf)))
+        return false;
+
+    gfx_upload_texture(tile, rgba32_buf, width, height);
+    return true;
 }
 
 static void import_texture(int tile) {
     uint8_t fmt = rdp.texture_tile.fmt;
     uint8_t siz = rdp.texture_tile.siz;
+    bool palette_only;
 
     if (gfx_texture_cache_lookup(tile, &rendering_state.textures[tile], rdp.loaded_texture[tile].addr,
-                                 fmt, siz)) {
+                                 rdp.loaded_texture[tile].size_bytes, fmt, siz, &palette_only)) {
         return;
     }
 
+    const uint32_t t0 = tmr_ms();
+    if (palette_only) {
+        gfx_upload_palette(tile, siz);
+        prof_frame.time[PROF_TEXTURE] += tmr_ms() - t0;
+        return;
+    }
+    if (import_texture_from_pack(tile, fmt, siz)) {
+        prof_frame.time[PROF_TEXTURE] += tmr_ms() - t0;
+        return;
+    }
     if (fmt == G_IM_FMT_RGBA) {
         if (siz == G_IM_SIZ_16b) {
             import_texture_rgba16(tile);
@@ -525,6 +1167,7 @@ static void import_texture(int tile) {
     } else {
         abort();
     }
+    prof_frame.time[PROF_TEXTURE] += tmr_ms() - t0;
 }
 
 // Fixed-point inverse square root using Newton-Raphson
@@ -590,6 +1233,46 @@ static inline void gfx_matrix_mul(fix64 (*restrict res)[4], const fix64 (*restri
     }
 }
 
+#if XFORM_LAZY
+// Brings MP_matrix and the generation up to the current matrices. G_MTX and G_POPMTX only flag
+// them as changed: skeletons and billboards push, multiply and pop several matrices per vertex
+// load, and the matrices they end on are often ones the history already multiplied
+static void gfx_update_xform(void) {
+    const fix64 (*mv)[4] = rsp.modelview_matrix_stack[rsp.modelview_matrix_stack_size - 1];
+    rsp.xform_changed = false;
+    for (int i = 0; i < XFORM_HISTORY_SIZE; i++) {
+        if (gfx_xform_history[i].gen && !memcmp(gfx_xform_history[i].mv, mv, sizeof(fix64[4][4]))
+            && !memcmp(gfx_xform_history[i].p, rsp.P_matrix, sizeof(fix64[4][4]))) {
+            memcpy(rsp.MP_matrix, gfx_xform_history[i].mp, sizeof(fix64[4][4]));
+            rsp.xform_gen = gfx_xform_history[i].gen;
+            return;
+        }
+    }
+    gfx_matrix_mul(rsp.MP_matrix, mv, rsp.P_matrix);
+    const uint32_t i = gfx_xform_history_pos++ % XFORM_HISTORY_SIZE;
+    memcpy(gfx_xform_history[i].mv, mv, sizeof(fix64[4][4]));
+    memcpy(gfx_xform_history[i].p, rsp.P_matrix, sizeof(fix64[4][4]));
+    memcpy(gfx_xform_history[i].mp, rsp.MP_matrix, sizeof(fix64[4][4]));
+    gfx_xform_history[i].gen = rsp.xform_gen = ++gfx_xform_gen_count;
+}
+#else
+// gives the current matrices the generation they had when they were current before, or a new one
+static void gfx_update_xform_gen(void) {
+    const fix64 (*mv)[4] = rsp.modelview_matrix_stack[rsp.modelview_matrix_stack_size - 1];
+    for (int i = 0; i < XFORM_HISTORY_SIZE; i++) {
+        if (gfx_xform_history[i].gen && !memcmp(gfx_xform_history[i].mv, mv, sizeof(fix64[4][4]))
+            && !memcmp(gfx_xform_history[i].p, rsp.P_matrix, sizeof(fix64[4][4]))) {
+            rsp.xform_gen = gfx_xform_history[i].gen;
+            return;
+        }
+    }
+    const uint32_t i = gfx_xform_history_pos++ % XFORM_HISTORY_SIZE;
+    memcpy(gfx_xform_history[i].mv, mv, sizeof(fix64[4][4]));
+    memcpy(gfx_xform_history[i].p, rsp.P_matrix, sizeof(fix64[4][4]));
+    gfx_xform_history[i].gen = rsp.xform_gen = ++gfx_xform_gen_count;
+}
+#endif
+
 static void gfx_sp_matrix(uint8_t parameters, const int32_t *addr) {
     fix64 matrix[4][4];
 #ifndef GBI_FLOATS
@@ -634,8 +1317,13 @@ static void gfx_sp_matrix(uint8_t parameters, const int32_t *addr) {
         }
         rsp.lights_changed = 1;
     }
+#if XFORM_LAZY
+    rsp.xform_changed = true;
+#else
     gfx_matrix_mul(rsp.MP_matrix, rsp.modelview_matrix_stack[rsp.modelview_matrix_stack_size - 1],
                    rsp.P_matrix);
+    gfx_update_xform_gen();
+#endif
 }
 
 static void gfx_sp_pop_matrix(uint32_t count) {
@@ -643,9 +1331,14 @@ static void gfx_sp_pop_matrix(uint32_t count) {
         if (rsp.modelview_matrix_stack_size > 0) {
             --rsp.modelview_matrix_stack_size;
             if (rsp.modelview_matrix_stack_size > 0) {
+#if XFORM_LAZY
+                rsp.xform_changed = true;
+#else
                 gfx_matrix_mul(rsp.MP_matrix,
                                rsp.modelview_matrix_stack[rsp.modelview_matrix_stack_size - 1],
                                rsp.P_matrix);
+                gfx_update_xform_gen();
+#endif
             }
         }
     }
@@ -655,120 +1348,184 @@ static inline float gfx_adjust_x_for_aspect_ratio(float x) {
     return x; // ASSUMES EXISTING ASPECT OF 4 / 3
 }
 
-static void gfx_sp_vertex(size_t n_vertices, size_t dest_index, const Vtx *vertices) {
-    for (size_t i = 0; i < n_vertices; i++, dest_index++) {
-        const Vtx_t *v = &vertices[i].v;
-        const Vtx_tn *vn = &vertices[i].n;
-        struct LoadedVertex *d = &rsp.loaded_vertices[dest_index];
-
-        fix64 x = v->ob[0] * rsp.MP_matrix[0][0] + v->ob[1] * rsp.MP_matrix[1][0]
-                  + v->ob[2] * rsp.MP_matrix[2][0] + rsp.MP_matrix[3][0];
-        fix64 y = v->ob[0] * rsp.MP_matrix[0][1] + v->ob[1] * rsp.MP_matrix[1][1]
-                  + v->ob[2] * rsp.MP_matrix[2][1] + rsp.MP_matrix[3][1];
-        fix64 z = v->ob[0] * rsp.MP_matrix[0][2] + v->ob[1] * rsp.MP_matrix[1][2]
-                  + v->ob[2] * rsp.MP_matrix[2][2] + rsp.MP_matrix[3][2];
-        fix64 w = v->ob[0] * rsp.MP_matrix[0][3] + v->ob[1] * rsp.MP_matrix[1][3]
-                  + v->ob[2] * rsp.MP_matrix[2][3] + rsp.MP_matrix[3][3];
-        // x = gfx_adjust_x_for_aspect_ratio(x);
-
-        short U = v->tc[0] * rsp.texture_scaling_factor.s >> 16;
-        short V = v->tc[1] * rsp.texture_scaling_factor.t >> 16;
-
-        if (rsp.geometry_mode & G_LIGHTING) {
-            if (rsp.lights_changed) {
-                for (int i = 0; i < rsp.current_num_lights - 1; i++) {
-                    calculate_normal_dir(&rsp.current_lights[i], rsp.current_lights_coeffs[i]);
-                }
-                static const Light_t lookat_x = { { 0, 0, 0 }, 0, { 0, 0, 0 }, 0, { 127, 0, 0 }, 0 };
-                static const Light_t lookat_y = { { 0, 0, 0 }, 0, { 0, 0, 0 }, 0, { 0, 127, 0 }, 0 };
-                calculate_normal_dir(&lookat_x, rsp.current_lookat_coeffs[0]);
-                calculate_normal_dir(&lookat_y, rsp.current_lookat_coeffs[1]);
-                rsp.lights_changed = false;
+// transforms, lights and clip tests one vertex; lighting is a constant in the callers, so this
+// inlines into a loop for lit vertices and a batch transform loop for unlit ones
+static inline __attribute__((always_inline)) void
+gfx_sp_vertex_one(const Vtx *vtx, struct LoadedVertex *d, const fix64 (*mp)[4], const bool lighting,
+                  const bool fog) {
+    const Vtx_t *v = &vtx->v;
+    const Vtx_tn *vn = &vtx->n;
+
+    fix64 x = v->ob[0] * mp[0][0] + v->ob[1] * mp[1][0] + v->ob[2] * mp[2][0] + mp[3][0];
+    fix64 y = v->ob[0] * mp[0][1] + v->ob[1] * mp[1][1] + v->ob[2] * mp[2][1] + mp[3][1];
+    fix64 z = v->ob[0] * mp[0][2] + v->ob[1] * mp[1][2] + v->ob[2] * mp[2][2] + mp[3][2];
+    fix64 w = v->ob[0] * mp[0][3] + v->ob[1] * mp[1][3] + v->ob[2] * mp[2][3] + mp[3][3];
+    // x = gfx_adjust_x_for_aspect_ratio(x);
+
+    short U = v->tc[0] * rsp.texture_scaling_factor.s >> 16;
+    short V = v->tc[1] * rsp.texture_scaling_factor.t >> 16;
+
+    if (lighting) {
+        int r = rsp.current_lights[rsp.current_num_lights - 1].col[0];
+        int g = rsp.current_lights[rsp.current_num_lights - 1].col[1];
+        int b = rsp.current_lights[rsp.current_num_lights - 1].col[2];
+
+        for (int i = 0; i < rsp.current_num_lights - 1; i++) {
+            fix64 intensity = 0;
+            intensity += vn->n[0] * rsp.current_lights_coeffs[i][0];
+            intensity += vn->n[1] * rsp.current_lights_coeffs[i][1];
+            intensity += vn->n[2] * rsp.current_lights_coeffs[i][2];
+            intensity /= 127;
+            if (intensity > 0) {
+                r += FIX_2_INT(intensity * rsp.current_lights[i].col[0]);
+                g += FIX_2_INT(intensity * rsp.current_lights[i].col[1]);
+                b += FIX_2_INT(intensity * rsp.current_lights[i].col[2]);
             }
+        }
 
-            int r = rsp.current_lights[rsp.current_num_lights - 1].col[0];
-            int g = rsp.current_lights[rsp.current_num_lights - 1].col[1];
-            int b = rsp.current_lights[rsp.current_num_lights - 1].col[2];
-
-            for (int i = 0; i < rsp.current_num_lights - 1; i++) {
-                fix64 intensity = 0;
-                intensity += vn->n[0] * rsp.current_lights_coeffs[i][0];
-                intensity += vn->n[1] * rsp.current_lights_coeffs[i][1];
-                intensity += vn->n[2] * rsp.current_lights_coeffs[i][2];
-                intensity /= 127;
-                if (intensity > 0) {
-                    r += FIX_2_INT(intensity * rsp.current_lights[i].col[0]);
-                    g += FIX_2_INT(intensity * rsp.current_lights[i].col[1]);
-                    b += FIX_2_INT(intensity * rsp.current_lights[i].col[2]);
-                }
-            }
+        d->color.r = r > 255 ? 255 : r; // clamp bytes
+        d->color.g = g > 255 ? 255 : g;
+        d->color.b = b > 255 ? 255 : b;
+
+        if (rsp.geometry_mode & G_TEXTURE_GEN) {
+            fix64 dotx = 0, doty = 0;
+            dotx += vn->n[0] * rsp.current_lookat_coeffs[0][0];
+            dotx += vn->n[1] * rsp.current_lookat_coeffs[0][1];
+            dotx += vn->n[2] * rsp.current_lookat_coeffs[0][2];
+            doty += vn->n[0] * rsp.current_lookat_coeffs[1][0];
+            doty += vn->n[1] * rsp.current_lookat_coeffs[1][1];
+            doty += vn->n[2] * rsp.current_lookat_coeffs[1][2];
+
+            U = FIX_2_INT(((dotx / 127 + FIX_ONE) >> 2) * rsp.texture_scaling_factor.s);
+            V = FIX_2_INT(((doty / 127 + FIX_ONE) >> 2) * rsp.texture_scaling_factor.t);
+        }
+    } else {
+        d->color.r = v->cn[0];
+        d->color.g = v->cn[1];
+        d->color.b = v->cn[2];
+    }
 
-            d->color.r = r > 255 ? 255 : r; // clamp bytes
-            d->color.g = g > 255 ? 255 : g;
-            d->color.b = b > 255 ? 255 : b;
-
-            if (rsp.geometry_mode & G_TEXTURE_GEN) {
-                fix64 dotx = 0, doty = 0;
-                dotx += vn->n[0] * rsp.current_lookat_coeffs[0][0];
-                dotx += vn->n[1] * rsp.current_lookat_coeffs[0][1];
-                dotx += vn->n[2] * rsp.current_lookat_coeffs[0][2];
-                doty += vn->n[0] * rsp.current_lookat_coeffs[1][0];
-                doty += vn->n[1] * rsp.current_lookat_coeffs[1][1];
-                doty += vn->n[2] * rsp.current_lookat_coeffs[1][2];
-
-                U = FIX_2_INT(((dotx / 127 + FIX_ONE) >> 2) * rsp.texture_scaling_factor.s);
-                V = FIX_2_INT(((doty / 127 + FIX_ONE) >> 2) * rsp.texture_scaling_factor.t);
-            }
+    d->u = INT_2_FIX(U);
+    d->v = INT_2_FIX(V);
+
+    // trivial clip rejection
+    d->clip_rej = 0;
+    if (x < -w)
+        d->clip_rej |= CLIP_LEFT;
+    if (x > w)
+        d->clip_rej |= CLIP_RIGHT;
+    if (y < -w)
+        d->clip_rej |= CLIP_BOTTOM;
+    if (y > w)
+        d->clip_rej |= CLIP_TOP;
+    if (z < -w)
+        d->clip_rej |= CLIP_FAR;
+    if (z > w)
+        d->clip_rej |= CLIP_NEAR;
+    if ((d->clip_rej & CLIP_XY) && (x < -GUARD_BAND * w || x > GUARD_BAND * w
+                                    || y < -GUARD_BAND * w || y > GUARD_BAND * w))
+        d->clip_rej |= CLIP_GUARD;
+
+    d->x = x;
+    d->y = y;
+    d->z = z;
+    d->w = w;
+
+    if (fog) {
+        // Fixed-point fog calculation — no float
+        fix64 winv;
+        if (w == 0) {
+            winv = INT_2_FIX(1000); // large value for 1/0.001
         } else {
-            d->color.r = v->cn[0];
-            d->color.g = v->cn[1];
-            d->color.b = v->cn[2];
+            winv = fix_recip(w);
+        }
+        if (winv < 0)
+            winv = INT_2_FIX(32767);
+        fix64 fog_z =
+            fix_mult(fix_mult(z, winv), INT_2_FIX(rsp.fog_mul)) + INT_2_FIX(rsp.fog_offset);
+        int32_t fog_i = FIX_2_INT(fog_z);
+        if (fog_i < 0)
+            fog_i = 0;
+        if (fog_i > 255)
+            fog_i = 255;
+        d->color.a = fog_i; // Use alpha variable to store fog factor
+    } else {
+        d->color.a = v->cn[3];
+    }
+}
+
+// loads the vertices from the vertex cache where it has them for the current transform and shading
+// state, and transforms the rest
+static inline __attribute__((always_inline)) void
+gfx_sp_vertex_run(size_t n_vertices, size_t dest_index, const Vtx *vertices, const bool lighting) {
+    // the stores into rsp.loaded_vertices could alias rsp.MP_matrix, so this keeps the matrix in a
+    // local instead of letting every vertex load it again
+    fix64 mp[4][4];
+    memcpy(mp, rsp.MP_matrix, sizeof(mp));
+    const bool fog = configEnableFog && (rsp.geometry_mode & G_FOG);
+    for (size_t i = 0; i < n_vertices; i++, dest_index++) {
+        const Vtx *vtx = &vertices[i];
+        struct LoadedVertex *d = &rsp.loaded_vertices[dest_index];
+        struct VertexCacheEntry *e =
+            &gfx_vertex_cache[((uintptr_t) vtx / sizeof(Vtx)) & (VERTEX_CACHE_SIZE - 1)];
+        if (e->addr == vtx && e->xform_gen == rsp.xform_gen && e->shade_gen == rsp.shade_gen
+            && !memcmp(&e->src, vtx, sizeof(Vtx))) {
+            *d = e->vtx;
+            gfx_vertex_cache_stats.hits++;
+            continue;
         }
+        gfx_sp_vertex_one(vtx, d, (const fix64 (*)[4]) mp, lighting, fog);
+        e->addr = vtx;
+        e->src = *vtx; // the game rewrites some vertex arrays in place
+        e->xform_gen = rsp.xform_gen;
+        e->shade_gen = rsp.shade_gen;
+        e->vtx = *d;
+        gfx_vertex_cache_stats.misses++;
+    }
+}
 
-        d->u = INT_2_FIX(U);
-        d->v = INT_2_FIX(V);
-
-        // trivial clip rejection
-        d->clip_rej = 0;
-        if (x < -w)
-            d->clip_rej |= CLIP_LEFT;
-        if (x > w)
-            d->clip_rej |= CLIP_RIGHT;
-        if (y < -w)
-            d->clip_rej |= CLIP_BOTTOM;
-        if (y > w)
-            d->clip_rej |= CLIP_TOP;
-        if (z < -w)
-            d->clip_rej |= CLIP_FAR;
-        if (z > w)
-            d->clip_rej |= CLIP_NEAR;
-
-        d->x = x;
-        d->y = y;
-        d->z = z;
-        d->w = w;
-
-        if (configEnableFog && (rsp.geometry_mode & G_FOG)) {
-            // Fixed-point fog calculation — no float
-            fix64 winv;
-            if (w == 0) {
-                winv = INT_2_FIX(1000); // large value for 1/0.001
-            } else {
-                winv = fix_recip(w);
+static void gfx_sp_vertex(size_t n_vertices, size_t dest_index, const Vtx *vertices) {
+#if GFX_LAYERS
+    if (gfx_layer.skipping)
+        return;
+#endif
+    const uint32_t t0 = tmr_ms();
+#if XFORM_LAZY
+    if (rsp.xform_changed)
+        gfx_update_xform();
+#endif
+    if (rsp.geometry_mode & G_LIGHTING) {
+        if (rsp.lights_changed) {
+            for (int i = 0; i < rsp.current_num_lights - 1; i++) {
+                calculate_normal_dir(&rsp.current_lights[i], rsp.current_lights_coeffs[i]);
             }
-            if (winv < 0)
-                winv = INT_2_FIX(32767);
-            fix64 fog_z =
-                fix_mult(fix_mult(z, winv), INT_2_FIX(rsp.fog_mul)) + INT_2_FIX(rsp.fog_offset);
-            int32_t fog_i = FIX_2_INT(fog_z);
-            if (fog_i < 0)
-                fog_i = 0;
-            if (fog_i > 255)
-                fog_i = 255;
-            d->color.a = fog_i; // Use alpha variable to store fog factor
-        } else {
-            d->color.a = v->cn[3];
+            static const Light_t lookat_x = { { 0, 0, 0 }, 0, { 0, 0, 0 }, 0, { 127, 0, 0 }, 0 };
+            static const Light_t lookat_y = { { 0, 0, 0 }, 0, { 0, 0, 0 }, 0, { 0, 127, 0 }, 0 };
+            calculate_normal_dir(&lookat_x, rsp.current_lookat_coeffs[0]);
+            calculate_normal_dir(&lookat_y, rsp.current_lookat_coeffs[1]);
+            rsp.lights_changed = false;
+#if LIGHTS_BIND_CACHE
+            rsp.lights_reloaded = false;
+            rsp.lights_stale = false;
+#endif
+            // loading lights doesn't flag them as changed, so the coefficients can be newer than
+            // the lights that were current the last time vertices were lit with these matrices
+            rsp.shade_gen++;
         }
+        gfx_sp_vertex_run(n_vertices, dest_index, vertices, true);
+    } else {
+        gfx_sp_vertex_run(n_vertices, dest_index, vertices, false);
+    }
+    prof_frame.time[PROF_TRANSFORM] += tmr_ms() - t0;
+}
+
+static inline void gfx_use_shader(struct ShaderProgram *prg) {
+    if (prg != rendering_state.shader_program) {
+        gfx_flush();
+        gfx_rapi->unload_shader(rendering_state.shader_program);
+        gfx_rapi->load_shader(prg);
+        rendering_state.shader_program = prg;
+        prof_frame.count[PROF_SHADER_SWITCHES]++;
     }
 }
 
@@ -798,13 +1555,7 @@ static inline struct ColorCombiner *gfx_pick_combiner(bool *out_use_fog, bool *o
     }
 
     struct ColorCombiner *comb = gfx_lookup_or_create_color_combiner(cc_id);
-    struct ShaderProgram *prg = comb->prg;
-    if (prg != rendering_state.shader_program) {
-        gfx_flush();
-        gfx_rapi->unload_shader(rendering_state.shader_program);
-        gfx_rapi->load_shader(prg);
-        rendering_state.shader_program = prg;
-    }
+    gfx_use_shader(comb->prg);
     if (use_alpha != rendering_state.alpha_blend) {
         gfx_flush();
         gfx_rapi->set_use_alpha(use_alpha);
@@ -842,78 +1593,296 @@ static inline bool gfx_update_textures(const bool used_textures[2], const bool l
     return used_textures[0] || used_textures[1];
 }
 
-static inline void gfx_push_triangle(const struct LoadedVertex *restrict v1,
-                                     const struct LoadedVertex *restrict v2,
-                                     const struct LoadedVertex *restrict v3) {
-    const struct LoadedVertex *v_arr[3] = { v1, v2, v3 };
+// the LOD fraction of a vertex: 0 up to 3000 units away, 255 from 6000 on
+static inline uint8_t gfx_lod_fraction(const fix64 w) {
+    fix64 dist_fix = w - INT_2_FIX(3000);
+    if (dist_fix < 0)
+        dist_fix = 0;
+    // Divide by 3000: multiply by reciprocal (1/3000 ≈ 0.000333)
+    fix64 frac_fix = fix_mult(dist_fix, FLOAT_2_FIX(1.0f / 3000.0f));
+    if (frac_fix > FIX_ONE)
+        frac_fix = FIX_ONE;
+    int32_t lod_val = FIX_2_INT(frac_fix * 255);
+    if (lod_val > 255)
+        lod_val = 255;
+    return lod_val;
+}
+
+// brings the LOD thresholds to the config and the triangles drawn in the last frame
+static void gfx_lod_update(void) {
+    const uint32_t budget = configLodTriBudget;
+    if (budget == 0) {
+        gfx_lod.scale = 256;
+    } else if (gfx_lod.tris > budget) {
+        gfx_lod.scale -= gfx_lod.scale / 8;
+        if (gfx_lod.scale < 32)
+            gfx_lod.scale = 32;
+    } else if (gfx_lod.tris < budget - budget / 4) {
+        gfx_lod.scale += gfx_lod.scale / 8 + 1;
+        if (gfx_lod.scale > 256)
+            gfx_lod.scale = 256;
+    }
+    gfx_lod.tris = 0;
+
+    const uint32_t scale = gfx_lod.scale;
+    gfx_lod.average_w3 = configLodTextureDist ? configLodTextureDist * 3 * scale / 256 + 1 : 0;
+    gfx_lod.flat_w3 = configFlatShadeDist ? configFlatShadeDist * 3 * scale / 256 + 1 : 0;
+    gfx_lod.cull_area = configLodCullArea * 256 / scale;
+    gfx_lod.enabled = gfx_lod.average_w3 || gfx_lod.flat_w3 || gfx_lod.cull_area;
+}
+
+// one channel of a combiner input, with the textures' average colors as the texels
+static inline uint8_t gfx_lod_input(uint32_t input, int channel, const struct LoadedVertex *v) {
+    const struct TextureHashmapNode *tex0 = rendering_state.textures[0];
+    const struct TextureHashmapNode *tex1 = rendering_state.textures[1];
+    switch (input) {
+        case CC_TEXEL0:
+            return tex0 ? (&tex0->avg_color.r)[channel] : 0xFF;
+        case CC_TEXEL1:
+            return tex1 ? (&tex1->avg_color.r)[channel] : 0xFF;
+        case CC_PRIM:
+            return (&rdp.prim_color.r)[channel];
+        case CC_SHADE:
+            // the alpha of a fogged vertex is its fog factor, the shaders take shade alpha as 100%
+            return (channel == 3 && gfx_triangle_state.use_fog) ? 0xFF : (&v->color.r)[channel];
+        case CC_ENV:
+            return (&rdp.env_color.r)[channel];
+        case CC_TEXEL0A:
+            return tex0 ? tex0->avg_color.a : 0xFF;
+        case CC_LOD:
+            return gfx_lod_fraction(v->w);
+        default:
+            return 0;
+    }
+}
 
-    const bool depth_test = (rsp.geometry_mode & G_ZBUFFER) == G_ZBUFFER;
-    if (depth_test != rendering_state.depth_test) {
-        gfx_flush();
-        gfx_rapi->set_depth_test(depth_test);
-        rendering_state.depth_test = depth_test;
+// works out the current combiner for the vertex like the shader would for its pixels
+static void gfx_lod_combine(const struct LoadedVertex *v, struct RGBA *out) {
+    for (int channel = 0; channel < 4; channel++) {
+        const uint32_t c = rdp.combine_mode >> (channel == 3 ? 12 : 0);
+        const int a = gfx_lod_input(c & 7, channel, v);
+        const int b = gfx_lod_input((c >> 3) & 7, channel, v);
+        const int m = gfx_lod_input((c >> 6) & 7, channel, v);
+        const int d = gfx_lod_input((c >> 9) & 7, channel, v);
+        int value = (a - b) * m / 255 + d;
+        value = value < 0 ? 0 : value > 255 ? 255 : value;
+        (&out->r)[channel] = value;
     }
+}
 
-    const bool z_upd = (rdp.other_mode_l & Z_UPD) == Z_UPD;
-    if (z_upd != rendering_state.depth_mask) {
-        gfx_flush();
-        gfx_rapi->set_depth_mask(z_upd);
-        rendering_state.depth_mask = z_upd;
+#if DRAW_SKIP_INVISIBLE
+// whether a combiner input has 0 alpha all over the triangle with the n vertices v, n is 0 for a
+// texrect, whose shade doesn't come from vertices. the texels and the LOD fraction vary over it
+static inline bool gfx_alpha_input_zero(uint32_t input, const struct LoadedVertex *const *v, int n) {
+    switch (input) {
+        case CC_0:
+            return true;
+        case CC_PRIM:
+            return rdp.prim_color.a == 0;
+        case CC_ENV:
+            return rdp.env_color.a == 0;
+        case CC_SHADE:
+            // the alpha of a fogged vertex is its fog factor, the shaders take shade alpha as 100%
+            if (gfx_invisible_state.use_fog || n == 0)
+                return false;
+            for (int i = 0; i < n; i++)
+                if (v[i]->color.a != 0)
+                    return false;
+            return true;
+        default:
+            return false;
     }
+}
 
-    const bool zmode_decal = (rdp.other_mode_l & ZMODE_DEC) == ZMODE_DEC;
-    if (zmode_decal != rendering_state.decal_mode) {
-        gfx_flush();
-        gfx_rapi->set_zmode_decal(zmode_decal);
-        rendering_state.decal_mode = zmode_decal;
+/**
+ * Whether nothing of a triangle with the vertices v reaches the screen: the
+ * combiner's alpha is 0 all over it, as for actors faded out, effects at the
+ * end of their life and HUD elements at 0 alpha, and the blender then leaves
+ * the pixels as they were. (a - b) * c + d is 0 everywhere when d is and
+ * either c is or a and b are, as the inputs are interpolated linearly.
+ * Decided on the same combine mode the shader gets, so it draws nothing of
+ * what is skipped.
+ */
+static bool gfx_invisible(const struct LoadedVertex *const *v, int n) {
+    if (rdp.combine_mode != gfx_invisible_state.combine_mode
+        || rdp.other_mode_l != gfx_invisible_state.other_mode_l) {
+        const bool use_alpha = (rdp.other_mode_l & (G_BL_A_MEM << 18)) == 0;
+        const bool texture_edge = (rdp.other_mode_l & CVG_X_ALPHA) == CVG_X_ALPHA;
+        const bool z_upd = (rdp.other_mode_l & Z_UPD) == Z_UPD;
+
+        gfx_invisible_state.combine_mode = rdp.combine_mode;
+        gfx_invisible_state.other_mode_l = rdp.other_mode_l;
+        // a blended pixel still writes its depth at alpha 0, one that fails the edge test doesn't
+        gfx_invisible_state.blended = texture_edge || (use_alpha && !z_upd);
+        gfx_invisible_state.use_fog = configEnableFog && (rdp.other_mode_l >> 30) == G_BL_CLR_FOG;
     }
+    if (!gfx_invisible_state.blended)
+        return false;
 
-    if (rdp.viewport_or_scissor_changed) {
-        if (memcmp(&rdp.viewport, &rendering_state.viewport, sizeof(rdp.viewport)) != 0) {
-            gfx_flush();
-            gfx_rapi->set_viewport(rdp.viewport.x, rdp.viewport.y, rdp.viewport.width,
-                                   rdp.viewport.height);
-            rendering_state.viewport = rdp.viewport;
+    const uint32_t c = rdp.combine_mode >> 12;
+    const uint32_t a = c & 7, b = (c >> 3) & 7, m = (c >> 6) & 7, d = (c >> 9) & 7;
+    return gfx_alpha_input_zero(d, v, n)
+           && (a == b || gfx_alpha_input_zero(m, v, n)
+               || (gfx_alpha_input_zero(a, v, n) && gfx_alpha_input_zero(b, v, n)));
+}
+#endif
+
+static inline void gfx_push_triangle(const struct LoadedVertex *restrict v1,
+                                     const struct LoadedVertex *restrict v2,
+                                     const struct LoadedVertex *restrict v3) {
+    const struct LoadedVertex *v_arr[3] = { v1, v2, v3 };
+
+    if (rdp.state_changed != 0) {
+        if (rdp.state_changed & GFX_CHANGED_ZMODE) {
+            const bool depth_test = (rsp.geometry_mode & G_ZBUFFER) == G_ZBUFFER;
+            if (depth_test != rendering_state.depth_test) {
+                gfx_flush();
+                gfx_rapi->set_depth_test(depth_test);
+                rendering_state.depth_test = depth_test;
+            }
+
+            const bool z_upd = (rdp.other_mode_l & Z_UPD) == Z_UPD;
+            if (z_upd != rendering_state.depth_mask) {
+                gfx_flush();
+                gfx_rapi->set_depth_mask(z_upd);
+                rendering_state.depth_mask = z_upd;
+            }
+
+            const bool zmode_decal = (rdp.other_mode_l & ZMODE_DEC) == ZMODE_DEC;
+            if (zmode_decal != rendering_state.decal_mode) {
+                gfx_flush();
+                gfx_rapi->set_zmode_decal(zmode_decal);
+                rendering_state.decal_mode = zmode_decal;
+            }
         }
-        if (memcmp(&rdp.scissor, &rendering_state.scissor, sizeof(rdp.scissor)) != 0) {
-            gfx_flush();
-            gfx_rapi->set_scissor(rdp.scissor.x, rdp.scissor.y, rdp.scissor.width, rdp.scissor.height);
-            rendering_state.scissor = rdp.scissor;
+
+        if (rdp.state_changed & GFX_CHANGED_VIEWPORT) {
+            if (memcmp(&rdp.viewport, &rendering_state.viewport, sizeof(rdp.viewport)) != 0) {
+                gfx_flush();
+                gfx_rapi->set_viewport(rdp.viewport.x, rdp.viewport.y, rdp.viewport.width,
+                                       rdp.viewport.height);
+                rendering_state.viewport = rdp.viewport;
+            }
+            if (memcmp(&rdp.scissor, &rendering_state.scissor, sizeof(rdp.scissor)) != 0) {
+                gfx_flush();
+                gfx_rapi->set_scissor(rdp.scissor.x, rdp.scissor.y, rdp.scissor.width, rdp.scissor.height);
+                rendering_state.scissor = rdp.scissor;
+            }
+            // a triangle covers |cross| * width * height / 8 pixels of the viewport
+            const uint32_t viewport_area = (uint32_t) rdp.viewport.width * rdp.viewport.height;
+            gfx_triangle_state.cull_cross = (gfx_lod.cull_area && viewport_area)
+                                                ? INT_2_FIX(gfx_lod.cull_area) / (2 * viewport_area)
+                                                : 0;
         }
-        rdp.viewport_or_scissor_changed = false;
+
+        if (rdp.state_changed & GFX_CHANGED_COMBINER) {
+            gfx_triangle_state.comb =
+                gfx_pick_combiner(&gfx_triangle_state.use_fog, &gfx_triangle_state.use_alpha);
+            gfx_rapi->shader_get_info(rendering_state.shader_program, &gfx_triangle_state.num_inputs,
+                                      gfx_triangle_state.used_textures);
+            // a shader that takes the shade as its one input, with the options of this one
+            const uint32_t opts = gfx_triangle_state.comb->cc_id
+                                  & (SHADER_OPT_ALPHA | SHADER_OPT_FOG | SHADER_OPT_NOISE);
+            gfx_triangle_state.lod_shader_id = opts | (SHADER_INPUT_1 << 9)
+                                               | ((opts & SHADER_OPT_ALPHA) ? SHADER_INPUT_1 << 21 : 0);
+            gfx_triangle_state.lod_prg = NULL;
+            // another shader can sample other textures
+            rdp.state_changed |= GFX_CHANGED_TEXTURES;
+        }
+        rdp.state_changed &= GFX_CHANGED_TEXTURES;
     }
 
-    uint8_t num_inputs;
-    bool used_textures[2], use_fog, use_alpha;
+    if (rdp.state_changed & GFX_CHANGED_TEXTURES) {
+        const bool linear_filter =
+            configFiltering && (rdp.other_mode_h & (3U << G_MDSFT_TEXTFILT)) != G_TF_POINT;
+        gfx_triangle_state.use_texture =
+            gfx_update_textures(gfx_triangle_state.used_textures, linear_filter);
+        rdp.state_changed = 0;
+    }
 
-    struct ColorCombiner *comb = gfx_pick_combiner(&use_fog, &use_alpha);
-    gfx_rapi->shader_get_info(rendering_state.shader_program, &num_inputs, used_textures);
+    uint8_t num_inputs = gfx_triangle_state.num_inputs;
+    const bool use_fog = gfx_triangle_state.use_fog;
+    const bool use_alpha = gfx_triangle_state.use_alpha;
+    const struct ColorCombiner *comb = gfx_triangle_state.comb;
+    bool use_texture = gfx_triangle_state.use_texture;
 
-    const bool linear_filter =
-        configFiltering && (rdp.other_mode_h & (3U << G_MDSFT_TEXTFILT)) != G_TF_POINT;
+    fix64 w_inv[3], x[3], y[3];
+    for (int i = 0; i < 3; i++) {
+        w_inv[i] = FIX_INV(v_arr[i]->w);
+        x[i] = fix_mult(v_arr[i]->x, w_inv[i]);
+        y[i] = fix_mult(v_arr[i]->y, w_inv[i]);
+    }
 
-    // Flat-shade distant triangles: skip textures if all vertices are far away
-    bool force_flat_shade = false;
-    if (configFlatShadeDist > 0) {
-        fix64 avg_w = (v1->w + v2->w + v3->w) / 3;
-        if (FIX_2_INT(avg_w) > (int) configFlatShadeDist) {
-            force_flat_shade = true;
+    struct LoadedVertex lod_vertices[3];
+    int lod = GFX_LOD_NONE;
+    if (gfx_lod.enabled) {
+        if (gfx_triangle_state.cull_cross != 0) {
+            fix64 cross = fix_mult(x[1] - x[0], y[2] - y[0]) - fix_mult(x[2] - x[0], y[1] - y[0]);
+            if (cross < 0)
+                cross = -cross;
+            if (cross < gfx_triangle_state.cull_cross)
+                return;
         }
+
+        const int32_t w3 = FIX_2_INT(v1->w + v2->w + v3->w);
+        lod = (gfx_lod.flat_w3 && w3 > gfx_lod.flat_w3)         ? GFX_LOD_FLAT
+              : (gfx_lod.average_w3 && w3 > gfx_lod.average_w3) ? GFX_LOD_AVERAGE
+                                                                : GFX_LOD_NONE;
+    }
+#if DRAW_SKIP_INVISIBLE
+    // past where the fog ends, the fog color covers what the combiner gives, and the texels of an
+    // opaque triangle aren't sampled for it
+    if (use_fog && !use_alpha && use_texture && v1->color.a == 0xFF && v2->color.a == 0xFF
+        && v3->color.a == 0xFF)
+        lod = GFX_LOD_FOGGED;
+#endif
+    if (lod != GFX_LOD_NONE && use_texture) {
+        if (gfx_triangle_state.lod_prg == NULL) {
+            // creating a shader loads it without drawing what was batched for the last one
+            gfx_flush();
+            gfx_triangle_state.lod_prg =
+                gfx_lookup_or_create_shader_program(gfx_triangle_state.lod_shader_id);
+        }
+        gfx_use_shader(gfx_triangle_state.lod_prg);
+
+        if (lod != GFX_LOD_FOGGED) {
+            for (int i = 0; i < 3; i++) {
+                lod_vertices[i] = *v_arr[i];
+                gfx_lod_combine(v_arr[i], &lod_vertices[i].color);
+            }
+            if (lod == GFX_LOD_FLAT) {
+                for (int channel = 0; channel < 4; channel++) {
+                    const int sum = (&lod_vertices[0].color.r)[channel]
+                                    + (&lod_vertices[1].color.r)[channel]
+                                    + (&lod_vertices[2].color.r)[channel];
+                    for (int i = 0; i < 3; i++)
+                        (&lod_vertices[i].color.r)[channel] = sum / 3;
+                }
+            }
+            for (int i = 0; i < 3; i++) {
+                // the fog factor goes in the alpha of the shade
+                if (use_fog)
+                    lod_vertices[i].color.a = v_arr[i]->color.a;
+                v_arr[i] = &lod_vertices[i];
+            }
+        }
+        comb = &gfx_lod_combiner;
+        num_inputs = 1;
+        use_texture = false;
+    } else if (gfx_lod.enabled || DRAW_SKIP_INVISIBLE) {
+        gfx_use_shader(comb->prg);
     }
 
-    const bool use_texture =
-        force_flat_shade ? false : gfx_update_textures(used_textures, linear_filter);
     const uint32_t tex_width = (rdp.texture_tile.lrs - rdp.texture_tile.uls + 4) / 4;
     const uint32_t tex_height = (rdp.texture_tile.lrt - rdp.texture_tile.ult + 4) / 4;
 
     for (int i = 0; i < 3; i++) {
-        const fix64 w = v_arr[i]->w;
-        const fix64 w_inv = FIX_INV(w);
-        buf_vbo[buf_vbo_len++] = fix_mult(v_arr[i]->x, w_inv);
-        buf_vbo[buf_vbo_len++] = fix_mult(v_arr[i]->y, w_inv);
-        buf_vbo[buf_vbo_len++] = fix_mult((v_arr[i]->z + w) >> 1, w_inv);
+        buf_vbo[buf_vbo_len++] = fixr_from_fix(x[i]);
+        buf_vbo[buf_vbo_len++] = fixr_from_fix(y[i]);
+        buf_vbo[buf_vbo_len++] = fixr_from_fix(fix_mult((v_arr[i]->z + v_arr[i]->w) >> 1, w_inv[i]));
 
-        buf_vbo[buf_vbo_len++] = w_inv; // store inverted W right away to save softrast the trouble
+        // store inverted W right away to save softrast the trouble
+        buf_vbo[buf_vbo_len++] = gfx_raster_prop(w_inv[i]);
 
         if (use_texture) {
             fix64 u = (v_arr[i]->u - INT_2_FIX(rdp.texture_tile.uls * 8)) >> 5;
@@ -923,12 +1892,13 @@ static inline void gfx_push_triangle(const struct LoadedVertex *restrict v1,
                 u += FIX_ONE_HALF;
                 v += FIX_ONE_HALF;
             }
-            buf_vbo[buf_vbo_len++] = fix_mult(u / tex_width, w_inv);
-            buf_vbo[buf_vbo_len++] = fix_mult(v / tex_height, w_inv);
+            buf_vbo[buf_vbo_len++] = gfx_raster_prop(fix_mult(u / tex_width, w_inv[i]));
+            buf_vbo[buf_vbo_len++] = gfx_raster_prop(fix_mult(v / tex_height, w_inv[i]));
         }
 
         if (use_fog) {
-            buf_vbo[buf_vbo_len++] = v_arr[i]->color.a * w_inv; // fog factor (not alpha)
+            // fog factor (not alpha)
+            buf_vbo[buf_vbo_len++] = gfx_raster_prop(v_arr[i]->color.a * w_inv[i]);
         }
 
         for (int j = 0; j < num_inputs; j++) {
@@ -945,38 +1915,25 @@ static inline void gfx_push_triangle(const struct LoadedVertex *restrict v1,
                     case CC_ENV:
                         color = &rdp.env_color;
                         break;
-                    case CC_LOD: {
-                        // Fixed-point LOD: distance_frac = clamp((w - 3000) / 3000, 0, 1)
-                        fix64 w_val = v1->w;
-                        fix64 dist_fix = w_val - INT_2_FIX(3000);
-                        if (dist_fix < 0)
-                            dist_fix = 0;
-                        // Divide by 3000: multiply by reciprocal (1/3000 ≈ 0.000333)
-                        fix64 frac_fix = fix_mult(dist_fix, FLOAT_2_FIX(1.0f / 3000.0f));
-                        if (frac_fix > FIX_ONE)
-                            frac_fix = FIX_ONE;
-                        int32_t lod_val = FIX_2_INT(frac_fix * 255);
-                        if (lod_val > 255)
-                            lod_val = 255;
-                        tmp.r = tmp.g = tmp.b = tmp.a = lod_val;
+                    case CC_LOD:
+                        tmp.r = tmp.g = tmp.b = tmp.a = gfx_lod_fraction(v1->w);
                         color = &tmp;
                         break;
-                    }
                     default:
                         memset(&tmp, 0, sizeof(tmp));
                         color = &tmp;
                         break;
                 }
                 if (k == 0) {
-                    buf_vbo[buf_vbo_len++] = color->r * w_inv;
-                    buf_vbo[buf_vbo_len++] = color->g * w_inv;
-                    buf_vbo[buf_vbo_len++] = color->b * w_inv;
+                    buf_vbo[buf_vbo_len++] = gfx_raster_prop(color->r * w_inv[i]);
+                    buf_vbo[buf_vbo_len++] = gfx_raster_prop(color->g * w_inv[i]);
+                    buf_vbo[buf_vbo_len++] = gfx_raster_prop(color->b * w_inv[i]);
                 } else {
                     if (use_fog && color == &v_arr[i]->color) {
                         // Shade alpha is 100% for fog
-                        buf_vbo[buf_vbo_len++] = GFX_COLOR_ONE * w_inv;
+                        buf_vbo[buf_vbo_len++] = gfx_raster_prop(GFX_COLOR_ONE * w_inv[i]);
                     } else {
-                        buf_vbo[buf_vbo_len++] = color->a * w_inv;
+                        buf_vbo[buf_vbo_len++] = gfx_raster_prop(color->a * w_inv[i]);
                     }
                 }
             }
@@ -1006,7 +1963,7 @@ static inline struct RGBA rgba_lerp(const struct RGBA c0, const struct RGBA c1,
 }
 
 static inline bool gfx_clip_triangle(struct LoadedVertex *v1, struct LoadedVertex *v2,
-                                     struct LoadedVertex *v3, const uint8_t clip_and) {
+                                     struct LoadedVertex *v3) {
     static const int c_planes[][4] = {
         { 0, 0, -1, 1 }, // near
         { 0, 0, 1, 1 },  // far
@@ -1016,17 +1973,23 @@ static inline bool gfx_clip_triangle(struct LoadedVertex *v1, struct LoadedVerte
         { 1, 0, 0, 1 },  // right
     };
 
-    const uint8_t clip_or = v1->clip_rej | v2->clip_rej | v3->clip_rej;
+    uint8_t clip_or = v1->clip_rej | v2->clip_rej | v3->clip_rej;
+
+    // the rasterizer scissors what only crosses the screen edges, that takes clipping against the
+    // near and far planes, and against the edges when a vertex is too far out for its coordinates
+    if (!(clip_or & CLIP_GUARD))
+        clip_or &= CLIP_NEAR | CLIP_FAR;
+    if (!clip_or)
+        return false;
 
-    if (!clip_or && clip_and)
-        return false; // triangle fully in frustum
+    const uint32_t t0 = tmr_ms();
 
     struct LoadedVertex v_buf[2][12] = { { *v1, *v2, *v3 } };
     int v_num[2] = { 3, 0 };
     int v_idx = 0;
 
     uint8_t plane_idx = 0;
-    for (uint8_t clip_mask = 1; clip_mask < 64; clip_mask <<= 1, ++plane_idx) {
+    for (uint8_t clip_mask = 1; clip_mask < CLIP_GUARD; clip_mask <<= 1, ++plane_idx) {
         if (!(clip_or & clip_mask))
             continue;
 
@@ -1072,13 +2035,18 @@ static inline bool gfx_clip_triangle(struct LoadedVertex *v1, struct LoadedVerte
             }
         }
 
-        if (v_num[outidx] < 3)
+        if (v_num[outidx] < 3) {
+            prof_frame.time[PROF_CLIP] += tmr_ms() - t0;
             return true; // not enough for a triangle
+        }
 
         v_idx = outidx;
         v_num[!v_idx] = 0;
     }
 
+    // the fan is left out, pushing it can flush the buffer, which counts as raster time
+    prof_frame.time[PROF_CLIP] += tmr_ms() - t0;
+
     // make a triangle fan
     const int n = v_num[v_idx] - 1;
     const struct LoadedVertex *in = v_buf[v_idx];
@@ -1089,18 +2057,28 @@ static inline bool gfx_clip_triangle(struct LoadedVertex *v1, struct LoadedVerte
 }
 
 static void gfx_sp_tri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx) {
+#if GFX_LAYERS
+    if (gfx_layer.skipping)
+        return;
+#endif
     struct LoadedVertex *v1 = &rsp.loaded_vertices[vtx1_idx];
     struct LoadedVertex *v2 = &rsp.loaded_vertices[vtx2_idx];
     struct LoadedVertex *v3 = &rsp.loaded_vertices[vtx3_idx];
 
     // if (rand()%2) return;
 
-    const uint8_t clip_and = v1->clip_rej & v2->clip_rej & v3->clip_rej;
+    const uint8_t clip_and = v1->clip_rej & v2->clip_rej & v3->clip_rej & CLIP_ALL;
     if (clip_and) {
         // The whole triangle lies outside the visible area
         return;
     }
 
+#if DRAW_SKIP_INVISIBLE
+    const struct LoadedVertex *const v_arr[3] = { v1, v2, v3 };
+    if (gfx_invisible(v_arr, 3))
+        return;
+#endif
+
     if ((rsp.geometry_mode & G_CULL_BOTH) != 0) {
         fix64 dx1 = fix_div_s(v1->x, v1->w) - fix_div_s(v2->x, v2->w);
         fix64 dy1 = fix_div_s(v1->y, v1->w) - fix_div_s(v2->y, v2->w);
@@ -1131,13 +2109,18 @@ static void gfx_sp_tri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx) {
 
     // clip the triangle and put the resulting triangles into the buffer
     // otherwise put the current triangle
-    if (!gfx_clip_triangle(v1, v2, v3, clip_and))
+    if (!(v1->clip_rej | v2->clip_rej | v3->clip_rej) || !gfx_clip_triangle(v1, v2, v3))
         gfx_push_triangle(v1, v2, v3);
 }
 
 static void gfx_sp_geometry_mode(uint32_t clear, uint32_t set) {
+    const uint32_t old_mode = rsp.geometry_mode;
     rsp.geometry_mode &= ~clear;
     rsp.geometry_mode |= set;
+    if ((old_mode ^ rsp.geometry_mode) & (G_LIGHTING | G_TEXTURE_GEN | G_FOG))
+        rsp.shade_gen++;
+    if ((old_mode ^ rsp.geometry_mode) & G_ZBUFFER)
+        rdp.state_changed |= GFX_CHANGED_ZMODE;
 }
 
 static void gfx_calc_and_set_viewport(const Vp_t *viewport) {
@@ -1156,9 +2139,31 @@ static void gfx_calc_and_set_viewport(const Vp_t *viewport) {
     rdp.viewport.y = y;
     rdp.viewport.width = width;
     rdp.viewport.height = height;
+    rsp.viewport_zscale = viewport->vscale[2];
+    rsp.viewport_ztrans = viewport->vtrans[2];
+
+    rdp.state_changed |= GFX_CHANGED_VIEWPORT;
+}
 
-    rdp.viewport_or_scissor_changed = true;
+#if LIGHTS_BIND_CACHE
+// Every actor loads its lights again, mostly the same ones as the actor before it. Those keep the
+// coefficients and the shade generation, so the lit vertices in the vertex cache stay valid.
+// Changed lights only force the recalculation a G_MW_NUMLIGHT has asked for, like before.
+static void gfx_sp_load_light(const int lightidx, const void *data) {
+    if (memcmp(rsp.current_lights + lightidx, data, sizeof(Light_t)) == 0)
+        return;
+    memcpy(rsp.current_lights + lightidx, data, sizeof(Light_t));
+    rsp.lights_stale = true;
+    if (rsp.lights_reloaded)
+        rsp.lights_changed = 1;
+    rsp.shade_gen++;
+}
+#else
+static void gfx_sp_load_light(const int lightidx, const void *data) {
+    memcpy(rsp.current_lights + lightidx, data, sizeof(Light_t));
+    rsp.shade_gen++;
 }
+#endif
 
 static void gfx_sp_movemem(uint8_t index, uint8_t offset, const void *data) {
     switch (index) {
@@ -1177,7 +2182,7 @@ static void gfx_sp_movemem(uint8_t index, uint8_t offset, const void *data) {
             int lightidx = offset / 24 - 2;
             if (lightidx >= 0 && lightidx <= MAX_LIGHTS) { // skip lookat
                 // NOTE: reads out of bounds if it is an ambient light
-                memcpy(rsp.current_lights + lightidx, data, sizeof(Light_t));
+                gfx_sp_load_light(lightidx, data);
             }
             break;
         }
@@ -1186,7 +2191,7 @@ static void gfx_sp_movemem(uint8_t index, uint8_t offset, const void *data) {
         case G_MV_L1:
         case G_MV_L2:
             // NOTE: reads out of bounds if it is an ambient light
-            memcpy(rsp.current_lights + (index - G_MV_L0) / 2, data, sizeof(Light_t));
+            gfx_sp_load_light((index - G_MV_L0) / 2, data);
             break;
 #endif
     }
@@ -1194,24 +2199,40 @@ static void gfx_sp_movemem(uint8_t index, uint8_t offset, const void *data) {
 
 static void gfx_sp_moveword(uint8_t index, uint16_t offset, uint32_t data) {
     switch (index) {
-        case G_MW_NUMLIGHT:
+        case G_MW_NUMLIGHT: {
 #ifdef F3DEX_GBI_2
-            rsp.current_num_lights = data / 24 + 1; // add ambient light
+            const uint8_t num_lights = data / 24 + 1; // add ambient light
 #else
             // Ambient light is included
             // The 31st bit is a flag that lights should be recalculated
-            rsp.current_num_lights = (data - 0x80000000U) / 32;
+            const uint8_t num_lights = (data - 0x80000000U) / 32;
+#endif
+#if LIGHTS_BIND_CACHE
+            // the recalculation only matters if it gives different coefficients, see
+            // gfx_sp_load_light()
+            rsp.lights_reloaded = true;
+            if (num_lights == rsp.current_num_lights && !rsp.lights_stale)
+                break;
 #endif
+            rsp.current_num_lights = num_lights;
             rsp.lights_changed = 1;
+            rsp.shade_gen++;
+            break;
+        }
+        case G_MW_SEGMENT:
+            gfx_segments[(offset / 4) & 0xF] = data;
             break;
         case G_MW_FOG:
             rsp.fog_mul = (int16_t) (data >> 16);
             rsp.fog_offset = (int16_t) data;
+            rsp.shade_gen++;
             break;
     }
 }
 
 static void gfx_sp_texture(uint16_t sc, uint16_t tc, uint8_t level, uint8_t tile, uint8_t on) {
+    if (sc != rsp.texture_scaling_factor.s || tc != rsp.texture_scaling_factor.t)
+        rsp.shade_gen++;
     rsp.texture_scaling_factor.s = sc;
     rsp.texture_scaling_factor.t = tc;
 }
@@ -1227,7 +2248,7 @@ static void gfx_dp_set_scissor(uint32_t mode, uint32_t ulx, uint32_t uly, uint32
     rdp.scissor.width = width;
     rdp.scissor.height = height;
 
-    rdp.viewport_or_scissor_changed = true;
+    rdp.state_changed |= GFX_CHANGED_VIEWPORT;
 }
 
 static void gfx_dp_set_texture_image(uint32_t format, uint32_t size, uint32_t width, const void *addr) {
@@ -1247,6 +2268,7 @@ static void gfx_dp_set_tile(uint8_t fmt, uint32_t siz, uint32_t line, uint32_t t
         rdp.texture_tile.line_size_bytes = line * 8;
         rdp.textures_changed[0] = true;
         rdp.textures_changed[1] = true;
+        rdp.state_changed |= GFX_CHANGED_TEXTURES;
     }
 
     if (tile == G_TX_LOADTILE) {
@@ -1254,14 +2276,17 @@ static void gfx_dp_set_tile(uint8_t fmt, uint32_t siz, uint32_t line, uint32_t t
     }
 }
 
+/* The tile size only offsets and scales the UVs gfx_sp_tri1 computes for
+ * each vertex, the texture imported for the tile doesn't depend on it. So it
+ * doesn't mark the textures changed: the scrolling materials, which set a
+ * new one every frame (see AnimatedMat_DrawTexScroll), keep drawing with the
+ * textures they have instead of flushing and looking them up again. */
 static void gfx_dp_set_tile_size(uint8_t tile, uint16_t uls, uint16_t ult, uint16_t lrs, uint16_t lrt) {
     if (tile == G_TX_RENDERTILE) {
         rdp.texture_tile.uls = uls;
         rdp.texture_tile.ult = ult;
         rdp.texture_tile.lrs = lrs;
         rdp.texture_tile.lrt = lrt;
-        rdp.textures_changed[0] = true;
-        rdp.textures_changed[1] = true;
     }
 }
 
@@ -1300,6 +2325,7 @@ static void gfx_dp_load_block(uint8_t tile, uint32_t uls, uint32_t ult, uint32_t
     rdp.loaded_texture[rdp.texture_to_load.tile_number].addr = rdp.texture_to_load.addr;
 
     rdp.textures_changed[rdp.texture_to_load.tile_number] = true;
+    rdp.state_changed |= GFX_CHANGED_TEXTURES;
 }
 
 static void gfx_dp_load_tile(uint8_t tile, uint32_t uls, uint32_t ult, uint32_t lrs, uint32_t lrt) {
@@ -1337,6 +2363,7 @@ static void gfx_dp_load_tile(uint8_t tile, uint32_t uls, uint32_t ult, uint32_t
     rdp.texture_tile.lrt = lrt;
 
     rdp.textures_changed[rdp.texture_to_load.tile_number] = true;
+    rdp.state_changed |= GFX_CHANGED_TEXTURES;
 }
 
 static uint8_t color_comb_component(uint32_t v) {
@@ -1366,7 +2393,11 @@ static inline uint32_t color_comb(uint32_t a, uint32_t b, uint32_t c, uint32_t d
 }
 
 static void gfx_dp_set_combine_mode(uint32_t rgb, uint32_t alpha) {
-    rdp.combine_mode = rgb | (alpha << 12);
+    const uint32_t combine_mode = rgb | (alpha << 12);
+    if (combine_mode != rdp.combine_mode) {
+        rdp.combine_mode = combine_mode;
+        rdp.state_changed |= GFX_CHANGED_COMBINER;
+    }
 }
 
 static void gfx_dp_set_env_color(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
@@ -1456,24 +2487,29 @@ static void gfx_draw_rectangle(int32_t ulx, int32_t uly, int32_t lrx, int32_t lr
     struct XYWidthHeight viewport_saved = rdp.viewport;
     uint32_t geometry_mode_saved = rsp.geometry_mode;
 
+    // the modes are swapped without their commands, so everything is looked at again
     rdp.viewport = default_viewport;
-    rdp.viewport_or_scissor_changed = true;
     rsp.geometry_mode = 0;
+    rdp.state_changed = GFX_CHANGED_ALL;
 
     gfx_sp_tri1(MAX_VERTICES + 0, MAX_VERTICES + 1, MAX_VERTICES + 3);
     gfx_sp_tri1(MAX_VERTICES + 1, MAX_VERTICES + 2, MAX_VERTICES + 3);
 
     rsp.geometry_mode = geometry_mode_saved;
     rdp.viewport = viewport_saved;
-    rdp.viewport_or_scissor_changed = true;
 
     if (cycle_type == G_CYC_COPY) {
         rdp.other_mode_h = saved_other_mode_h;
     }
+    rdp.state_changed = GFX_CHANGED_ALL;
 }
 
 static void gfx_dp_texture_rectangle(int32_t ulx, int32_t uly, int32_t lrx, int32_t lry, uint8_t tile,
                                      int16_t uls, int16_t ult, int16_t dsdx, int16_t dtdy, bool flip) {
+#if GFX_LAYERS
+    if (gfx_layer.skipping)
+        return;
+#endif
     uint32_t saved_combine_mode = rdp.combine_mode;
     if ((rdp.other_mode_h & (3U << G_MDSFT_CYCLETYPE)) == G_CYC_COPY) {
         // Per RDP Command Summary Set Tile's shift s and this dsdx should be set to 4 texels
@@ -1502,6 +2538,11 @@ static void gfx_dp_texture_rectangle(int32_t ulx, int32_t uly, int32_t lrx, int3
     float lrs = ((uls << 7) + dsdx * width) >> 7;
     float lrt = ((ult << 7) + dtdy * height) >> 7;
 
+#if DRAW_SKIP_INVISIBLE
+    if (gfx_rapi->tex_rect && gfx_invisible(NULL, 0)) {
+        // alpha 0 all over, nothing of it would be drawn
+    } else
+#endif
     if (gfx_rapi->tex_rect) {
         float ulxf = ulx * ratio_x;
         float ulyf = uly * ratio_y;
@@ -1541,10 +2582,16 @@ static void gfx_dp_texture_rectangle(int32_t ulx, int32_t uly, int32_t lrx, int3
         gfx_draw_rectangle(ulx, uly, lrx, lry);
     }
 
+    // the rendering API's shader, and sampler with tex_rect, were set for the rectangle
     rdp.combine_mode = saved_combine_mode;
+    rdp.state_changed = GFX_CHANGED_ALL;
 }
 
 static void gfx_dp_fill_rectangle(int32_t ulx, int32_t uly, int32_t lrx, int32_t lry) {
+#if GFX_LAYERS
+    if (gfx_layer.skipping)
+        return;
+#endif
     if (rdp.color_image_address == rdp.z_buf_address) {
         // Don't clear Z buffer here since we already did it with glClear
         return;
@@ -1570,7 +2617,11 @@ static void gfx_dp_fill_rectangle(int32_t ulx, int32_t uly, int32_t lrx, int32_t
         lrxf = HALF_SCREEN_WIDTH + gfx_adjust_x_for_aspect_ratio(lrxf / 4.0f - HALF_SCREEN_WIDTH);
         ulyf = ulyf / 4.0f;
         lryf = lryf / 4.0f;
-        gfx_rapi->fill_rect(ulxf, ulyf, lrxf, lryf, &rdp.fill_color.r);
+        // the fill cycle has no blender, its color is written as is
+        struct RGBA fill_color = rdp.fill_color;
+        if (mode == G_CYC_FILL)
+            fill_color.a = 0xFF;
+        gfx_rapi->fill_rect(ulxf, ulyf, lrxf, lryf, &fill_color.r);
     } else {
         for (int i = MAX_VERTICES; i < MAX_VERTICES + 4; i++) {
             struct LoadedVertex *v = &rsp.loaded_vertices[i];
@@ -1579,7 +2630,9 @@ static void gfx_dp_fill_rectangle(int32_t ulx, int32_t uly, int32_t lrx, int32_t
         gfx_draw_rectangle(ulx, uly, lrx, lry);
     }
 
+    // the rendering API's shader, and sampler with tex_rect, were set for the rectangle
     rdp.combine_mode = saved_combine_mode;
+    rdp.state_changed = GFX_CHANGED_ALL;
 }
 
 static void gfx_dp_set_z_image(void *z_buf_address) {
@@ -1594,227 +2647,962 @@ static void gfx_sp_set_other_mode(uint32_t shift, uint32_t num_bits, uint64_t mo
     uint64_t mask = (((uint64_t) 1 << num_bits) - 1) << shift;
     uint64_t om = rdp.other_mode_l | ((uint64_t) rdp.other_mode_h << 32);
     om = (om & ~mask) | mode;
+    if ((uint32_t) om != rdp.other_mode_l)
+        rdp.state_changed |= GFX_CHANGED_ZMODE | GFX_CHANGED_COMBINER;
+    if ((uint32_t) (om >> 32) != rdp.other_mode_h)
+        rdp.state_changed |= GFX_CHANGED_TEXTURES;
     rdp.other_mode_l = (uint32_t) om;
     rdp.other_mode_h = (uint32_t) (om >> 32);
 }
 
 static inline void *seg_addr(uintptr_t w1) {
-    return (void *) w1;
+    return nsp_segmented_to_virtual(w1);
 }
 
 #define C0(pos, width) ((cmd->words.w0 >> (pos)) & ((1U << width) - 1))
 #define C1(pos, width) ((cmd->words.w1 >> (pos)) & ((1U << width) - 1))
 
-static void gfx_run_dl(Gfx *cmd) {
-    for (;;) {
-        uint32_t opcode = cmd->words.w0 >> 24;
+#if GFX_LAYERS
+static void gfx_layer_begin(const Gfx *cmd);
+static void gfx_layer_end(void);
+#endif
+#if HUD_LAYER_CACHE
+static void gfx_overlay_begin(Gfx *cmd);
+static Gfx *gfx_overlay_end(Gfx *cmd);
+#endif
 
-        switch (opcode) {
-            // RSP commands:
-            case G_MTX:
+// handlers of the commands other than G_DL and G_ENDDL, each returns the last word of its command
+typedef Gfx *(*GfxCmdHandler)(Gfx *cmd);
+
+// RSP commands:
+static Gfx *gfx_cmd_mtx(Gfx *cmd) {
 #ifdef F3DEX_GBI_2
-                gfx_sp_matrix(C0(0, 8) ^ G_MTX_PUSH, (const int32_t *) seg_addr(cmd->words.w1));
+    gfx_sp_matrix(C0(0, 8) ^ G_MTX_PUSH, (const int32_t *) seg_addr(cmd->words.w1));
 #else
-                gfx_sp_matrix(C0(16, 8), (const int32_t *) seg_addr(cmd->words.w1));
+    gfx_sp_matrix(C0(16, 8), (const int32_t *) seg_addr(cmd->words.w1));
 #endif
-                break;
-            case (uint8_t) G_POPMTX:
+    return cmd;
+}
+
+static Gfx *gfx_cmd_popmtx(Gfx *cmd) {
 #ifdef F3DEX_GBI_2
-                gfx_sp_pop_matrix(cmd->words.w1 / 64);
+    gfx_sp_pop_matrix(cmd->words.w1 / 64);
 #else
-                gfx_sp_pop_matrix(1);
+    gfx_sp_pop_matrix(1);
 #endif
-                break;
-            case G_MOVEMEM:
+    return cmd;
+}
+
+static Gfx *gfx_cmd_movemem(Gfx *cmd) {
 #ifdef F3DEX_GBI_2
-                gfx_sp_movemem(C0(0, 8), C0(8, 8) * 8, seg_addr(cmd->words.w1));
+    gfx_sp_movemem(C0(0, 8), C0(8, 8) * 8, seg_addr(cmd->words.w1));
 #else
-                gfx_sp_movemem(C0(16, 8), 0, seg_addr(cmd->words.w1));
+    gfx_sp_movemem(C0(16, 8), 0, seg_addr(cmd->words.w1));
 #endif
-                break;
-            case (uint8_t) G_MOVEWORD:
+    return cmd;
+}
+
+static Gfx *gfx_cmd_moveword(Gfx *cmd) {
 #ifdef F3DEX_GBI_2
-                gfx_sp_moveword(C0(16, 8), C0(0, 16), cmd->words.w1);
+    gfx_sp_moveword(C0(16, 8), C0(0, 16), cmd->words.w1);
 #else
-                gfx_sp_moveword(C0(0, 8), C0(8, 16), cmd->words.w1);
+    gfx_sp_moveword(C0(0, 8), C0(8, 16), cmd->words.w1);
 #endif
-                break;
-            case (uint8_t) G_TEXTURE:
+    return cmd;
+}
+
+static Gfx *gfx_cmd_texture(Gfx *cmd) {
 #ifdef F3DEX_GBI_2
-                gfx_sp_texture(C1(16, 16), C1(0, 16), C0(11, 3), C0(8, 3), C0(1, 7));
+    gfx_sp_texture(C1(16, 16), C1(0, 16), C0(11, 3), C0(8, 3), C0(1, 7));
 #else
-                gfx_sp_texture(C1(16, 16), C1(0, 16), C0(11, 3), C0(8, 3), C0(0, 8));
+    gfx_sp_texture(C1(16, 16), C1(0, 16), C0(11, 3), C0(8, 3), C0(0, 8));
 #endif
-                break;
+    return cmd;
+}
+
+static Gfx *gfx_cmd_vtx(Gfx *cmd) {
+#ifdef F3DEX_GBI_2
+    gfx_sp_vertex(C0(12, 8), C0(1, 7) - C0(12, 8), seg_addr(cmd->words.w1));
+#elif defined(F3DEX_GBI) || defined(F3DLP_GBI)
+    gfx_sp_vertex(C0(10, 6), C0(16, 8) / 2, seg_addr(cmd->words.w1));
+#else
+    gfx_sp_vertex((C0(0, 16)) / sizeof(Vtx), C0(16, 4), seg_addr(cmd->words.w1));
+#endif
+    return cmd;
+}
+
+#ifdef F3DEX_GBI_2
+static Gfx *gfx_cmd_geometrymode(Gfx *cmd) {
+    gfx_sp_geometry_mode(~C0(0, 24), cmd->words.w1);
+    return cmd;
+}
+#else
+static Gfx *gfx_cmd_setgeometrymode(Gfx *cmd) {
+    gfx_sp_geometry_mode(0, cmd->words.w1);
+    return cmd;
+}
+
+static Gfx *gfx_cmd_cleargeometrymode(Gfx *cmd) {
+    gfx_sp_geometry_mode(cmd->words.w1, 0);
+    return cmd;
+}
+#endif
+
+static Gfx *gfx_cmd_tri1(Gfx *cmd) {
+#ifdef F3DEX_GBI_2
+    gfx_sp_tri1(C0(16, 8) / 2, C0(8, 8) / 2, C0(0, 8) / 2);
+#elif defined(F3DEX_GBI) || defined(F3DLP_GBI)
+    gfx_sp_tri1(C1(16, 8) / 2, C1(8, 8) / 2, C1(0, 8) / 2);
+#else
+    gfx_sp_tri1(C1(16, 8) / 10, C1(8, 8) / 10, C1(0, 8) / 10);
+#endif
+    return cmd;
+}
+
+#if defined(F3DEX_GBI) || defined(F3DLP_GBI)
+static Gfx *gfx_cmd_tri2(Gfx *cmd) {
+    gfx_sp_tri1(C0(16, 8) / 2, C0(8, 8) / 2, C0(0, 8) / 2);
+    gfx_sp_tri1(C1(16, 8) / 2, C1(8, 8) / 2, C1(0, 8) / 2);
+    return cmd;
+}
+#endif
+
+// G_CULLDL: whether the loaded vertices from vstart to vend are all outside the same plane of the view
+// volume. The display list ends there then, as on the RSP, without the vertices after it being
+// transformed or its triangles clipped one at a time
+static bool gfx_sp_cull_dl(uint32_t vstart, uint32_t vend) {
+    uint8_t clip_and = CLIP_ALL;
+
+#if GFX_LAYERS
+    if (gfx_layer.skipping)
+        return false; // no vertices are loaded, and the end of the layer can be after it
+#endif
+    if (vend >= MAX_VERTICES || vstart > vend)
+        return false;
+    for (uint32_t i = vstart; i <= vend && clip_and != 0; i++)
+        clip_and &= rsp.loaded_vertices[i].clip_rej;
+    return clip_and != 0;
+}
+
+static inline bool gfx_cmd_culldl(const Gfx *cmd) {
+#if defined(F3DEX_GBI) || defined(F3DLP_GBI)
+    return gfx_sp_cull_dl(C0(0, 16) / 2, C1(0, 16) / 2);
+#else
+    return gfx_sp_cull_dl(C0(0, 24) / 40, C1(0, 24) / 40 - 1);
+#endif
+}
+
+#if defined(F3DEX_GBI) || defined(F3DLP_GBI)
+// G_BRANCH_Z: whether the loaded vertex is at a screen Z up to zval, which is in 16.16 as the RSP
+// computes it with the viewport. The display list then goes on at the one of the G_RDPHALF_1 before it.
+// A vertex behind the camera is as near as it gets
+static bool gfx_sp_branch_z(uint32_t vtx, uint32_t zval) {
+    const struct LoadedVertex *v = &rsp.loaded_vertices[vtx];
+
+#if GFX_LAYERS
+    if (gfx_layer.skipping)
+        return false;
+#endif
+    if (vtx >= MAX_VERTICES)
+        return false;
+    if (v->w <= 0)
+        return true;
+    const fix64 ndc_z = fix_mult(v->z, fix_recip(v->w));
+    const int64_t sz = (ndc_z * rsp.viewport_zscale + INT_2_FIX(rsp.viewport_ztrans)) >> (FRAC_WIDTH - 16);
+    return sz <= (int64_t) zval;
+}
+
+static inline bool gfx_cmd_branch_z(const Gfx *cmd) {
+    return gfx_sp_branch_z(C0(0, 12) / 2, cmd->words.w1);
+}
+#endif
+
+static Gfx *gfx_cmd_rdphalf_1(Gfx *cmd) {
+    rsp.rdphalf_1 = cmd->words.w1;
+    return cmd;
+}
+
+static Gfx *gfx_cmd_setothermode_l(Gfx *cmd) {
+#ifdef F3DEX_GBI_2
+    gfx_sp_set_other_mode(31 - C0(8, 8) - C0(0, 8), C0(0, 8) + 1, cmd->words.w1);
+#else
+    gfx_sp_set_other_mode(C0(8, 8), C0(0, 8), cmd->words.w1);
+#endif
+    return cmd;
+}
+
+static Gfx *gfx_cmd_setothermode_h(Gfx *cmd) {
+#ifdef F3DEX_GBI_2
+    gfx_sp_set_other_mode(63 - C0(8, 8) - C0(0, 8), C0(0, 8) + 1, (uint64_t) cmd->words.w1 << 32);
+#else
+    gfx_sp_set_other_mode(C0(8, 8) + 32, C0(0, 8), (uint64_t) cmd->words.w1 << 32);
+#endif
+    return cmd;
+}
+
+// RDP Commands:
+static Gfx *gfx_cmd_settimg(Gfx *cmd) {
+    gfx_dp_set_texture_image(C0(21, 3), C0(19, 2), C0(0, 10), seg_addr(cmd->words.w1));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_loadblock(Gfx *cmd) {
+    gfx_dp_load_block(C1(24, 3), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_loadtile(Gfx *cmd) {
+    gfx_dp_load_tile(C1(24, 3), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_settile(Gfx *cmd) {
+    gfx_dp_set_tile(C0(21, 3), C0(19, 2), C0(9, 9), C0(0, 9), C1(24, 3), C1(20, 4), C1(18, 2), C1(14, 4),
+                    C1(10, 4), C1(8, 2), C1(4, 4), C1(0, 4));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_settilesize(Gfx *cmd) {
+    gfx_dp_set_tile_size(C1(24, 3), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_loadtlut(Gfx *cmd) {
+    gfx_dp_load_tlut(C1(24, 3), C1(14, 10));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_setenvcolor(Gfx *cmd) {
+    gfx_dp_set_env_color(C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_setprimcolor(Gfx *cmd) {
+    gfx_dp_set_prim_color(C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_setfogcolor(Gfx *cmd) {
+    gfx_dp_set_fog_color(C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_setfillcolor(Gfx *cmd) {
+    gfx_dp_set_fill_color(cmd->words.w1);
+    return cmd;
+}
+
+static Gfx *gfx_cmd_setcombine(Gfx *cmd) {
+    gfx_dp_set_combine_mode(color_comb(C0(20, 4), C1(28, 4), C0(15, 5), C1(15, 3)),
+                            color_comb(C0(12, 3), C1(12, 3), C0(9, 3), C1(9, 3)));
+    /*color_comb(C0(5, 4), C1(24, 4), C0(0, 5), C1(6, 3)),
+    color_comb(C1(21, 3), C1(3, 3), C1(18, 3), C1(0, 3)));*/
+    return cmd;
+}
+
+// G_SETPRIMCOLOR, G_CCMUX_PRIMITIVE, G_ACMUX_PRIMITIVE, is used by Goddard
+// G_CCMUX_TEXEL1, LOD_FRACTION is used in Bowser room 1
+static Gfx *gfx_cmd_texrect(Gfx *cmd) {
+    const bool flip = (cmd->words.w0 >> 24) == G_TEXRECTFLIP;
+    int32_t lrx, lry, tile, ulx, uly;
+    uint32_t uls, ult, dsdx, dtdy;
+#ifdef F3DEX_GBI_2E
+    lrx = (int32_t) (C0(0, 24) << 8) >> 8;
+    lry = (int32_t) (C1(0, 24) << 8) >> 8;
+    ++cmd;
+    ulx = (int32_t) (C0(0, 24) << 8) >> 8;
+    uly = (int32_t) (C1(0, 24) << 8) >> 8;
+    ++cmd;
+    uls = C0(16, 16);
+    ult = C0(0, 16);
+    dsdx = C1(16, 16);
+    dtdy = C1(0, 16);
+#else
+    lrx = C0(12, 12);
+    lry = C0(0, 12);
+    tile = C1(24, 3);
+    ulx = C1(12, 12);
+    uly = C1(0, 12);
+    ++cmd;
+    uls = C1(16, 16);
+    ult = C1(0, 16);
+    ++cmd;
+    dsdx = C1(16, 16);
+    dtdy = C1(0, 16);
+#endif
+    gfx_dp_texture_rectangle(ulx, uly, lrx, lry, tile, uls, ult, dsdx, dtdy, flip);
+    return cmd;
+}
+
+static Gfx *gfx_cmd_fillrect(Gfx *cmd) {
+#ifdef F3DEX_GBI_2E
+    int32_t lrx, lry, ulx, uly;
+    lrx = (int32_t) (C0(0, 24) << 8) >> 8;
+    lry = (int32_t) (C1(0, 24) << 8) >> 8;
+    ++cmd;
+    ulx = (int32_t) (C0(0, 24) << 8) >> 8;
+    uly = (int32_t) (C1(0, 24) << 8) >> 8;
+    gfx_dp_fill_rectangle(ulx, uly, lrx, lry);
+#else
+    gfx_dp_fill_rectangle(C1(12, 12), C1(0, 12), C0(12, 12), C0(0, 12));
+#endif
+    return cmd;
+}
+
+static Gfx *gfx_cmd_setscissor(Gfx *cmd) {
+    gfx_dp_set_scissor(C1(24, 2), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_setzimg(Gfx *cmd) {
+    gfx_dp_set_z_image(seg_addr(cmd->words.w1));
+    return cmd;
+}
+
+static Gfx *gfx_cmd_setcimg(Gfx *cmd) {
+    gfx_dp_set_color_image(C0(21, 3), C0(19, 2), C0(0, 11), seg_addr(cmd->words.w1));
+    return cmd;
+}
+
+#if PRERENDER_NATIVE
+static Gfx *gfx_cmd_nsp_fbop(Gfx *cmd) {
+    const uint32_t op = C0(20, 4), width = C0(10, 10), height = C0(0, 10);
+    void *src = seg_addr(cmd->words.w1);
+    ++cmd;
+    // the triangles before it have to be in the color buffer
+    gfx_flush();
+    nsp_prerender_run_op(op, width, height, cmd->words.w0, src, seg_addr(cmd->words.w1));
+    return cmd;
+}
+#endif
+
+#if TRANSITION_FILL
+static Gfx *gfx_cmd_nsp_fill(Gfx *cmd) {
+    const uint32_t op = C0(20, 4), params = C0(0, 20), color = cmd->words.w1;
+    // the triangles before it have to be in the color buffer
+    gfx_flush();
+    nsp_transition_fill(op, params, color, (int32_t) cmd[1].words.w0, (int32_t) cmd[1].words.w1, cmd[2].words.w0,
+                        seg_addr(cmd[2].words.w1));
+    return cmd + 2;
+}
+#endif
+
+#if GFX_LAYERS
+static Gfx *gfx_cmd_nsp_layer(Gfx *cmd) {
+    switch (C0(0, 8)) {
+        case G_NSP_LAYER_BEGIN:
+            gfx_layer_begin(cmd);
+            break;
+#if HUD_LAYER_CACHE
+        case G_NSP_LAYER_OVERLAY:
+            gfx_overlay_begin(cmd);
+            break;
+#endif
+        default:
+#if HUD_LAYER_CACHE
+            if (gfx_overlay.pass != 0)
+                return gfx_overlay_end(cmd);
+#endif
+            gfx_layer_end();
+            break;
+    }
+    return cmd;
+}
+#endif
+
+// indexed by opcode, the ones without a handler are skipped. each command costs one load and
+// one indirect call instead of the compare chain or range check of a sparse switch
+static const GfxCmdHandler gfx_cmd_handlers[256] = {
+    [G_MTX] = gfx_cmd_mtx,
+    [(uint8_t) G_POPMTX] = gfx_cmd_popmtx,
+    [G_MOVEMEM] = gfx_cmd_movemem,
+    [(uint8_t) G_MOVEWORD] = gfx_cmd_moveword,
+    [(uint8_t) G_TEXTURE] = gfx_cmd_texture,
+    [G_VTX] = gfx_cmd_vtx,
+#ifdef F3DEX_GBI_2
+    [G_GEOMETRYMODE] = gfx_cmd_geometrymode,
+#else
+    [(uint8_t) G_SETGEOMETRYMODE] = gfx_cmd_setgeometrymode,
+    [(uint8_t) G_CLEARGEOMETRYMODE] = gfx_cmd_cleargeometrymode,
+#endif
+    [(uint8_t) G_TRI1] = gfx_cmd_tri1,
+#if defined(F3DEX_GBI) || defined(F3DLP_GBI)
+    [(uint8_t) G_TRI2] = gfx_cmd_tri2,
+#endif
+    [(uint8_t) G_RDPHALF_1] = gfx_cmd_rdphalf_1,
+    [(uint8_t) G_SETOTHERMODE_L] = gfx_cmd_setothermode_l,
+    [(uint8_t) G_SETOTHERMODE_H] = gfx_cmd_setothermode_h,
+    [G_SETTIMG] = gfx_cmd_settimg,
+    [G_LOADBLOCK] = gfx_cmd_loadblock,
+    [G_LOADTILE] = gfx_cmd_loadtile,
+    [G_SETTILE] = gfx_cmd_settile,
+    [G_SETTILESIZE] = gfx_cmd_settilesize,
+    [G_LOADTLUT] = gfx_cmd_loadtlut,
+    [G_SETENVCOLOR] = gfx_cmd_setenvcolor,
+    [G_SETPRIMCOLOR] = gfx_cmd_setprimcolor,
+    [G_SETFOGCOLOR] = gfx_cmd_setfogcolor,
+    [G_SETFILLCOLOR] = gfx_cmd_setfillcolor,
+    [G_SETCOMBINE] = gfx_cmd_setcombine,
+    [G_TEXRECT] = gfx_cmd_texrect,
+    [G_TEXRECTFLIP] = gfx_cmd_texrect,
+    [G_FILLRECT] = gfx_cmd_fillrect,
+    [G_SETSCISSOR] = gfx_cmd_setscissor,
+    [G_SETZIMG] = gfx_cmd_setzimg,
+    [G_SETCIMG] = gfx_cmd_setcimg,
+#if PRERENDER_NATIVE
+    [G_NSP_FBOP] = gfx_cmd_nsp_fbop,
+#endif
+#if GFX_LAYERS
+    [G_NSP_LAYER] = gfx_cmd_nsp_layer,
+#endif
+#if TRANSITION_FILL
+    [G_NSP_FILL] = gfx_cmd_nsp_fill,
+#endif
+};
+
+#if PERF_COUNTERS
+struct GfxOpStats gfx_op_stats;
+#endif
+
+// runs a command other than G_DL and G_ENDDL, returns the last word of it
+static inline Gfx *gfx_run_cmd(Gfx *cmd) {
+    const uint32_t opcode = cmd->words.w0 >> 24;
+    const GfxCmdHandler handler = gfx_cmd_handlers[opcode];
+
+    if (handler == NULL)
+        return cmd;
+#if PERF_COUNTERS
+    const uint32_t t0 = tmr_ms();
+    cmd = handler(cmd);
+    gfx_op_stats.count[opcode]++;
+    gfx_op_stats.ms[opcode] += tmr_ms() - t0;
+    return cmd;
+#else
+    return handler(cmd);
+#endif
+}
+
+// words a command spans, gfx_run_cmd reads the ones after the first itself
+static inline uint32_t gfx_cmd_length(uint32_t opcode) {
+    if (opcode == G_TEXRECT || opcode == G_TEXRECTFLIP)
+        return 3;
+#ifdef F3DEX_GBI_2E
+    if (opcode == G_FILLRECT)
+        return 2;
+#endif
+#if PRERENDER_NATIVE
+    if (opcode == G_NSP_FBOP)
+        return 2;
+#endif
+#if TRANSITION_FILL
+    if (opcode == G_NSP_FILL)
+        return 3;
+#endif
+    return 1;
+}
+
+static inline uint32_t gfx_dl_hash(const Gfx *cmd, uint32_t num_cmds) {
+    uint32_t hash = 0x811C9DC5;
+    for (uint32_t i = 0; i < num_cmds; i++)
+        hash = ((hash ^ cmd[i].words.w0) * 0x01000193) ^ cmd[i].words.w1;
+    return hash;
+}
+
+#if GFX_LAYERS
+static inline uint32_t gfx_layer_hash_data(uint32_t hash, const void *data, uint32_t size) {
+    const uint32_t *w = data;
+    for (uint32_t i = 0; i < size / 4; i++)
+        hash = (hash ^ w[i]) * 0x01000193;
+    return hash;
+}
+
+// hashes the commands from cmd up to the end of the display list, or of the layer when
+// layer_end isn't NULL, with the vertices, matrices, memory and display lists they point to.
+// Textures only go in by address, the texture cache doesn't look at their texels either.
+// Returns false if the end wasn't found
+static bool gfx_layer_hash_dl(const Gfx *cmd, uint32_t depth, uint32_t *hash, const Gfx **layer_end) {
+    uint32_t rdphalf_1 = 0;
+
+    for (;;) {
+        const uint32_t opcode = cmd->words.w0 >> 24;
+        const uint32_t len = gfx_cmd_length(opcode);
+        uint32_t h = gfx_dl_hash(cmd, len);
+
+        switch (opcode) {
             case G_VTX:
 #ifdef F3DEX_GBI_2
-                gfx_sp_vertex(C0(12, 8), C0(1, 7) - C0(12, 8), seg_addr(cmd->words.w1));
+                h = gfx_layer_hash_data(h, seg_addr(cmd->words.w1), C0(12, 8) * sizeof(Vtx));
 #elif defined(F3DEX_GBI) || defined(F3DLP_GBI)
-                gfx_sp_vertex(C0(10, 6), C0(16, 8) / 2, seg_addr(cmd->words.w1));
+                h = gfx_layer_hash_data(h, seg_addr(cmd->words.w1), C0(10, 6) * sizeof(Vtx));
 #else
-                gfx_sp_vertex((C0(0, 16)) / sizeof(Vtx), C0(16, 4), seg_addr(cmd->words.w1));
+                h = gfx_layer_hash_data(h, seg_addr(cmd->words.w1), C0(0, 16));
 #endif
                 break;
-            case G_DL:
-                if (C0(16, 1) == 0) {
-                    // Push return address
-                    gfx_run_dl((Gfx *) seg_addr(cmd->words.w1));
-                } else {
-                    cmd = (Gfx *) seg_addr(cmd->words.w1);
-                    --cmd; // increase after break
-                }
+            case G_MTX:
+                h = gfx_layer_hash_data(h, seg_addr(cmd->words.w1), sizeof(Mtx));
                 break;
-            case (uint8_t) G_ENDDL:
-                return;
+            case G_MOVEMEM:
 #ifdef F3DEX_GBI_2
-            case G_GEOMETRYMODE:
-                gfx_sp_geometry_mode(~C0(0, 24), cmd->words.w1);
-                break;
+                h = gfx_layer_hash_data(h, seg_addr(cmd->words.w1), (C0(19, 5) + 1) * 8);
 #else
-            case (uint8_t) G_SETGEOMETRYMODE:
-                gfx_sp_geometry_mode(0, cmd->words.w1);
+                h = gfx_layer_hash_data(h, seg_addr(cmd->words.w1), C0(0, 16));
+#endif
+                break;
+            case G_DL:
+                // a display list called from a layer can't end it, a branch goes on in its target
+                if (C0(16, 1) != 0) {
+                    *hash = (*hash ^ h) * 0x01000193;
+                    cmd = seg_addr(cmd->words.w1);
+                    continue;
+                }
+                if (depth == 10 || !gfx_layer_hash_dl(seg_addr(cmd->words.w1), depth + 1, &h, NULL))
+                    return false;
                 break;
-            case (uint8_t) G_CLEARGEOMETRYMODE:
-                gfx_sp_geometry_mode(cmd->words.w1, 0);
+            case (uint8_t) G_RDPHALF_1:
+                rdphalf_1 = cmd->words.w1;
+                break;
+#if defined(F3DEX_GBI) || defined(F3DLP_GBI)
+            case (uint8_t) G_BRANCH_Z:
+                // either way can be taken, both go in like a call
+                if (depth == 10 || !gfx_layer_hash_dl(seg_addr(rdphalf_1), depth + 1, &h, NULL))
+                    return false;
                 break;
 #endif
-            case (uint8_t) G_TRI1:
+            case (uint8_t) G_ENDDL:
+                *hash = (*hash ^ h) * 0x01000193;
+                return layer_end == NULL;
+            case G_NSP_LAYER:
+                if (layer_end == NULL || C0(0, 8) != G_NSP_LAYER_END)
+                    return false;
+                *layer_end = cmd;
+                return true;
+        }
+        *hash = (*hash ^ h) * 0x01000193;
+        cmd += len;
+    }
+}
+
+// the key its caller gave a layer, and the state it starts from: the sky is drawn with the
+// projection and viewport of the camera, over the clear of the frame
+static uint32_t gfx_layer_hash_start(const Gfx *cmd) {
+    uint32_t hash = 0x811C9DC5;
+
+    hash = (hash ^ cmd->words.w1) * 0x01000193;
+    hash = gfx_layer_hash_data(hash, rsp.P_matrix, sizeof(rsp.P_matrix));
+    hash = gfx_layer_hash_data(hash, &rdp.viewport, sizeof(rdp.viewport));
+    hash = gfx_layer_hash_data(hash, &rdp.scissor, sizeof(rdp.scissor));
+    hash = gfx_layer_hash_data(hash, &rdp.fill_color, sizeof(rdp.fill_color));
+    return hash;
+}
+
+static void gfx_layer_begin(const Gfx *cmd) {
+    const Gfx *end;
+    uint32_t hash = gfx_layer_hash_start(cmd);
+
+    if (gfx_layer.drawing || gfx_layer.skipping)
+        return; // layers don't nest, this one is drawn as part of the outer one
+    if (!gfx_layer_hash_dl(cmd + 1, 0, &hash, &end))
+        return; // drawn, but not saved
+
+    // the triangles before it are in the saved color buffer, or get drawn over by it
+    gfx_flush();
+    gfx_layer.hash = hash;
+    if (nsp_layer_restore(hash)) {
+        gfx_layer.skipping = true;
+    } else {
+        gfx_layer.drawing = true;
+    }
+}
+
+static void gfx_layer_end(void) {
+    if (gfx_layer.drawing) {
+        gfx_flush();
+        nsp_layer_save(gfx_layer.hash);
+    }
+    gfx_layer.drawing = false;
+    gfx_layer.skipping = false;
+}
+#endif
+
+#if HUD_LAYER_CACHE
+// An overlay drawn the same as the last time is drawn from what it saved. One that didn't change
+// since the last frame is drawn over black and then, from the same state, over white, and saved.
+// One that changes every frame is drawn as if it weren't in a layer
+static void gfx_overlay_begin(Gfx *cmd) {
+    const Gfx *end;
+    uint32_t hash = gfx_layer_hash_start(cmd);
+    gfx_pixel_t *black;
+    bool save;
+
+    if (gfx_layer.drawing || gfx_layer.skipping || gfx_overlay.pass != 0)
+        return;
+    if (!gfx_layer_hash_dl(cmd + 1, 0, &hash, &end))
+        return;
+
+    // the triangles before it are under it
+    gfx_flush();
+    if (nsp_overlay_restore(C0(8, 8), hash, &save)) {
+        gfx_layer.skipping = true;
+        return;
+    }
+    if (!save || !nsp_overlay_backgrounds(&black, &gfx_overlay.white))
+        return;
+
+    gfx_overlay.pass = 1;
+    gfx_overlay.id = C0(8, 8);
+    gfx_overlay.hash = hash;
+    gfx_overlay.begin = cmd;
+    gfx_overlay.output = gfx_output;
+    gfx_overlay.rsp = rsp;
+    gfx_overlay.rdp = rdp;
+    gfx_output = black;
+}
+
+// returns the command the display list goes on after, the overlay's begin for its second pass
+static Gfx *gfx_overlay_end(Gfx *cmd) {
+    gfx_flush();
+    if (gfx_overlay.pass == 1) {
+        const uint32_t shade_gen = rsp.shade_gen;
+
+        rsp = gfx_overlay.rsp;
+        rdp = gfx_overlay.rdp;
+        // the generations the first pass gave out stay with the state it gave them to
+        rsp.shade_gen = shade_gen + 1;
+        rdp.state_changed = GFX_CHANGED_ALL;
+        gfx_output = gfx_overlay.white;
+        gfx_overlay.pass = 2;
+        return gfx_overlay.begin;
+    }
+
+    gfx_output = gfx_overlay.output;
+    gfx_overlay.pass = 0;
+    nsp_overlay_save(gfx_overlay.id, gfx_overlay.hash);
+    return cmd;
+}
+#endif
+
+static bool gfx_dl_cache_is_static(const Gfx *dl) {
+    const uintptr_t addr = (uintptr_t) dl;
+    for (uint32_t i = 0; i < gfx_dl_cache.num_ranges; i++) {
+        if (addr - gfx_dl_cache.ranges[i].start < gfx_dl_cache.ranges[i].size)
+            return true;
+    }
+    return false;
+}
+
+// end of the static range dl is in
+static uintptr_t gfx_dl_cache_range_end(const Gfx *dl) {
+    const uintptr_t addr = (uintptr_t) dl;
+    for (uint32_t i = 0; i < gfx_dl_cache.num_ranges; i++) {
+        if (addr - gfx_dl_cache.ranges[i].start < gfx_dl_cache.ranges[i].size)
+            return gfx_dl_cache.ranges[i].start + gfx_dl_cache.ranges[i].size;
+    }
+    return addr;
+}
+
+static inline struct DlCacheOp *gfx_dl_cache_new_op(uint8_t kind, const void *ptr) {
+    struct DlCacheOp *op = &gfx_dl_cache.ops[gfx_dl_cache.num_ops++];
+    op->kind = kind;
+    op->count = 0;
+    op->arg = 0;
+    op->ptr = ptr;
+    return op;
+}
+
+// translates the display list of e up to its end or branch into ops
+static enum DlCompileResult gfx_dl_cache_compile(struct DlCacheEntry *e) {
+    const uintptr_t range_end = gfx_dl_cache_range_end(e->dl);
+    struct DlCacheOp *tris = NULL; // the last op, if it's a DL_OP_TRIS more triangles can go in
+    Gfx *cmd = (Gfx *) e->dl;
+
+    e->first_op = gfx_dl_cache.num_ops;
+    for (;;) {
+        const uint32_t opcode = cmd->words.w0 >> 24;
+        const uint32_t len = gfx_cmd_length(opcode);
+        if ((uintptr_t) (cmd + len) > range_end)
+            return DL_COMPILE_OUT_OF_DATA;
+        if (gfx_dl_cache.num_ops == DL_CACHE_OPS || gfx_dl_cache.num_tris + 2 > DL_CACHE_TRIS)
+            return DL_COMPILE_OUT_OF_SPACE;
+
+        uint8_t *idx = gfx_dl_cache.tris[gfx_dl_cache.num_tris];
+        switch (opcode) {
+            case G_VTX: {
+                struct DlCacheOp *op = gfx_dl_cache_new_op(DL_OP_VTX, (const void *) (uintptr_t) cmd->words.w1);
 #ifdef F3DEX_GBI_2
-                gfx_sp_tri1(C0(16, 8) / 2, C0(8, 8) / 2, C0(0, 8) / 2);
+                op->count = C0(12, 8);
+                op->arg = C0(1, 7) - C0(12, 8);
 #elif defined(F3DEX_GBI) || defined(F3DLP_GBI)
-                gfx_sp_tri1(C1(16, 8) / 2, C1(8, 8) / 2, C1(0, 8) / 2);
+                op->count = C0(10, 6);
+                op->arg = C0(16, 8) / 2;
 #else
-                gfx_sp_tri1(C1(16, 8) / 10, C1(8, 8) / 10, C1(0, 8) / 10);
+                op->count = (C0(0, 16)) / sizeof(Vtx);
+                op->arg = C0(16, 4);
 #endif
+                tris = NULL;
                 break;
+            }
+            case (uint8_t) G_TRI1:
 #if defined(F3DEX_GBI) || defined(F3DLP_GBI)
             case (uint8_t) G_TRI2:
-                gfx_sp_tri1(C0(16, 8) / 2, C0(8, 8) / 2, C0(0, 8) / 2);
-                gfx_sp_tri1(C1(16, 8) / 2, C1(8, 8) / 2, C1(0, 8) / 2);
-                break;
 #endif
-            case (uint8_t) G_SETOTHERMODE_L:
+                if (tris == NULL) {
+                    tris = gfx_dl_cache_new_op(DL_OP_TRIS, NULL);
+                    tris->arg = gfx_dl_cache.num_tris;
+                }
+#if defined(F3DEX_GBI) || defined(F3DLP_GBI)
+                if (opcode == (uint8_t) G_TRI2) {
+                    idx[0] = C0(16, 8) / 2, idx[1] = C0(8, 8) / 2, idx[2] = C0(0, 8) / 2;
+                    idx[3] = C1(16, 8) / 2, idx[4] = C1(8, 8) / 2, idx[5] = C1(0, 8) / 2;
+                    tris->count += 2;
+                    gfx_dl_cache.num_tris += 2;
+                    break;
+                }
+#endif
 #ifdef F3DEX_GBI_2
-                gfx_sp_set_other_mode(31 - C0(8, 8) - C0(0, 8), C0(0, 8) + 1, cmd->words.w1);
+                idx[0] = C0(16, 8) / 2, idx[1] = C0(8, 8) / 2, idx[2] = C0(0, 8) / 2;
+#elif defined(F3DEX_GBI) || defined(F3DLP_GBI)
+                idx[0] = C1(16, 8) / 2, idx[1] = C1(8, 8) / 2, idx[2] = C1(0, 8) / 2;
 #else
-                gfx_sp_set_other_mode(C0(8, 8), C0(0, 8), cmd->words.w1);
+                idx[0] = C1(16, 8) / 10, idx[1] = C1(8, 8) / 10, idx[2] = C1(0, 8) / 10;
 #endif
+                tris->count++;
+                gfx_dl_cache.num_tris++;
                 break;
-            case (uint8_t) G_SETOTHERMODE_H:
-#ifdef F3DEX_GBI_2
-                gfx_sp_set_other_mode(63 - C0(8, 8) - C0(0, 8), C0(0, 8) + 1,
-                                      (uint64_t) cmd->words.w1 << 32);
+            case G_DL:
+                tris = NULL;
+                if (C0(16, 1) == 0) {
+                    gfx_dl_cache_new_op(DL_OP_CALL, (const void *) (uintptr_t) cmd->words.w1);
+                    break;
+                }
+                gfx_dl_cache_new_op(DL_OP_BRANCH, (const void *) (uintptr_t) cmd->words.w1);
+                goto done;
+            case (uint8_t) G_CULLDL: {
+                struct DlCacheOp *op = gfx_dl_cache_new_op(DL_OP_CULL, NULL);
+#if defined(F3DEX_GBI) || defined(F3DLP_GBI)
+                op->arg = C0(0, 16) / 2;
+                op->count = C1(0, 16) / 2;
 #else
-                gfx_sp_set_other_mode(C0(8, 8) + 32, C0(0, 8), (uint64_t) cmd->words.w1 << 32);
+                op->arg = C0(0, 24) / 40;
+                op->count = C1(0, 24) / 40 - 1;
 #endif
+                tris = NULL;
                 break;
-
-            // RDP Commands:
-            case G_SETTIMG:
-                gfx_dp_set_texture_image(C0(21, 3), C0(19, 2), C0(0, 10), seg_addr(cmd->words.w1));
-                break;
-            case G_LOADBLOCK:
-                gfx_dp_load_block(C1(24, 3), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
-                break;
-            case G_LOADTILE:
-                gfx_dp_load_tile(C1(24, 3), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
-                break;
-            case G_SETTILE:
-                gfx_dp_set_tile(C0(21, 3), C0(19, 2), C0(9, 9), C0(0, 9), C1(24, 3), C1(20, 4),
-                                C1(18, 2), C1(14, 4), C1(10, 4), C1(8, 2), C1(4, 4), C1(0, 4));
-                break;
-            case G_SETTILESIZE:
-                gfx_dp_set_tile_size(C1(24, 3), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
+            }
+#if defined(F3DEX_GBI) || defined(F3DLP_GBI)
+            case (uint8_t) G_BRANCH_Z:
+                // the G_RDPHALF_1 before it is a DL_OP_CMD, which sets the display list at replay
+                gfx_dl_cache_new_op(DL_OP_BRANCH_Z, cmd);
+                tris = NULL;
                 break;
-            case G_LOADTLUT:
-                gfx_dp_load_tlut(C1(24, 3), C1(14, 10));
+#endif
+            case (uint8_t) G_ENDDL:
+                goto done;
+            default:
+                gfx_dl_cache_new_op(DL_OP_CMD, cmd);
+                tris = NULL;
                 break;
-            case G_SETENVCOLOR:
-                gfx_dp_set_env_color(C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
+        }
+        cmd += len;
+    }
+
+done:
+    e->num_cmds = cmd + 1 - e->dl;
+    e->num_ops = gfx_dl_cache.num_ops - e->first_op;
+    e->hash = gfx_dl_hash(e->dl, e->num_cmds);
+    return DL_COMPILE_OK;
+}
+
+// the compiled form of dl, which is compiled now if it wasn't yet. NULL when it has to be
+// interpreted
+static const struct DlCacheEntry *gfx_dl_cache_get(const Gfx *dl) {
+    struct DlCacheEntry **bucket = &gfx_dl_cache.hashmap[((uintptr_t) dl >> 3) % DL_CACHE_BUCKETS];
+    struct DlCacheEntry *e;
+
+    for (e = *bucket; e != NULL; e = e->next) {
+        if (e->dl == dl)
+            break;
+    }
+    if (e != NULL) {
+        if (!e->compiled)
+            return NULL;
+        // the game can write to display lists it loaded, those are interpreted from then on
+        if (gfx_dl_hash(dl, e->num_cmds) != e->hash) {
+            e->compiled = false;
+            return NULL;
+        }
+        gfx_dl_cache_stats.replays++;
+        return e;
+    }
+
+    // the pools are only emptied between frames, the ops of the display lists being replayed
+    // around this one are still in use
+    if (gfx_dl_cache.num_entries == DL_CACHE_ENTRIES) {
+        gfx_dl_cache.clear_pending = true;
+        return NULL;
+    }
+    e = &gfx_dl_cache.entries[gfx_dl_cache.num_entries];
+    e->dl = dl;
+    const uint32_t first_tri = gfx_dl_cache.num_tris;
+    const enum DlCompileResult result = gfx_dl_cache_compile(e);
+    if (result == DL_COMPILE_OUT_OF_SPACE) {
+        gfx_dl_cache.num_ops = e->first_op;
+        gfx_dl_cache.num_tris = first_tri;
+        gfx_dl_cache.clear_pending = true;
+        return NULL;
+    }
+    e->compiled = (result == DL_COMPILE_OK);
+    if (!e->compiled) {
+        // running past the data it's in is for good, it's kept to not scan it again every frame
+        gfx_dl_cache.num_ops = e->first_op;
+        gfx_dl_cache.num_tris = first_tri;
+    }
+    gfx_dl_cache.num_entries++;
+    e->next = *bucket;
+    *bucket = e;
+    gfx_dl_cache_stats.compiles++;
+    return e->compiled ? e : NULL;
+}
+
+static void gfx_run_dl(Gfx *cmd);
+
+static void gfx_dl_cache_replay(const struct DlCacheEntry *e) {
+    const struct DlCacheOp *op = &gfx_dl_cache.ops[e->first_op];
+    const struct DlCacheOp *const end = op + e->num_ops;
+
+    for (; op != end; op++) {
+        switch (op->kind) {
+            case DL_OP_CMD:
+                gfx_run_cmd((Gfx *) op->ptr);
                 break;
-            case G_SETPRIMCOLOR:
-                gfx_dp_set_prim_color(C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
+            case DL_OP_VTX:
+                gfx_sp_vertex(op->count, op->arg, seg_addr((uintptr_t) op->ptr));
                 break;
-            case G_SETFOGCOLOR:
-                gfx_dp_set_fog_color(C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
+            case DL_OP_TRIS: {
+                const uint8_t(*idx)[3] = &gfx_dl_cache.tris[op->arg];
+                for (uint32_t i = 0; i < op->count; i++)
+                    gfx_sp_tri1(idx[i][0], idx[i][1], idx[i][2]);
                 break;
-            case G_SETFILLCOLOR:
-                gfx_dp_set_fill_color(cmd->words.w1);
+            }
+            case DL_OP_CALL:
+                gfx_run_dl((Gfx *) seg_addr((uintptr_t) op->ptr));
                 break;
-            case G_SETCOMBINE:
-                gfx_dp_set_combine_mode(color_comb(C0(20, 4), C1(28, 4), C0(15, 5), C1(15, 3)),
-                                        color_comb(C0(12, 3), C1(12, 3), C0(9, 3), C1(9, 3)));
-                /*color_comb(C0(5, 4), C1(24, 4), C0(0, 5), C1(6, 3)),
-                color_comb(C1(21, 3), C1(3, 3), C1(18, 3), C1(0, 3)));*/
+            case DL_OP_BRANCH:
+                gfx_dl_depth--;
+                gfx_run_dl((Gfx *) seg_addr((uintptr_t) op->ptr));
+                gfx_dl_depth++;
+                return;
+            case DL_OP_CULL:
+                if (gfx_sp_cull_dl(op->arg, op->count))
+                    return;
                 break;
-            // G_SETPRIMCOLOR, G_CCMUX_PRIMITIVE, G_ACMUX_PRIMITIVE, is used by Goddard
-            // G_CCMUX_TEXEL1, LOD_FRACTION is used in Bowser room 1
-            case G_TEXRECT:
-            case G_TEXRECTFLIP: {
-                int32_t lrx, lry, tile, ulx, uly;
-                uint32_t uls, ult, dsdx, dtdy;
-#ifdef F3DEX_GBI_2E
-                lrx = (int32_t) (C0(0, 24) << 8) >> 8;
-                lry = (int32_t) (C1(0, 24) << 8) >> 8;
-                ++cmd;
-                ulx = (int32_t) (C0(0, 24) << 8) >> 8;
-                uly = (int32_t) (C1(0, 24) << 8) >> 8;
-                ++cmd;
-                uls = C0(16, 16);
-                ult = C0(0, 16);
-                dsdx = C1(16, 16);
-                dtdy = C1(0, 16);
-#else
-                lrx = C0(12, 12);
-                lry = C0(0, 12);
-                tile = C1(24, 3);
-                ulx = C1(12, 12);
-                uly = C1(0, 12);
-                ++cmd;
-                uls = C1(16, 16);
-                ult = C1(0, 16);
-                ++cmd;
-                dsdx = C1(16, 16);
-                dtdy = C1(0, 16);
-#endif
-                gfx_dp_texture_rectangle(ulx, uly, lrx, lry, tile, uls, ult, dsdx, dtdy,
-                                         opcode == G_TEXRECTFLIP);
+#if defined(F3DEX_GBI) || defined(F3DLP_GBI)
+            case DL_OP_BRANCH_Z:
+                if (gfx_cmd_branch_z((const Gfx *) op->ptr)) {
+                    gfx_dl_depth--;
+                    gfx_run_dl((Gfx *) seg_addr(rsp.rdphalf_1));
+                    gfx_dl_depth++;
+                    return;
+                }
                 break;
+#endif
+        }
+    }
+}
+
+static void gfx_run_dl_from(Gfx *cmd) {
+    if (configDlCache && gfx_dl_cache_is_static(cmd)) {
+        const struct DlCacheEntry *e = gfx_dl_cache_get(cmd);
+        if (e != NULL) {
+            gfx_dl_cache_replay(e);
+            return;
+        }
+    }
+
+    for (;; ++cmd) {
+        const uint32_t opcode = cmd->words.w0 >> 24;
+        if (opcode == G_DL) {
+            if (C0(16, 1) == 0) {
+                // Push return address
+                gfx_run_dl((Gfx *) seg_addr(cmd->words.w1));
+            } else {
+                // a branch doesn't come back, the display list it goes to can be a compiled one.
+                // It takes the place of this one on the stack
+                gfx_dl_depth--;
+                gfx_run_dl((Gfx *) seg_addr(cmd->words.w1));
+                gfx_dl_depth++;
+                return;
             }
-            case G_FILLRECT:
-#ifdef F3DEX_GBI_2E
-            {
-                int32_t lrx, lry, ulx, uly;
-                lrx = (int32_t) (C0(0, 24) << 8) >> 8;
-                lry = (int32_t) (C1(0, 24) << 8) >> 8;
-                ++cmd;
-                ulx = (int32_t) (C0(0, 24) << 8) >> 8;
-                uly = (int32_t) (C1(0, 24) << 8) >> 8;
-                gfx_dp_fill_rectangle(ulx, uly, lrx, lry);
-                break;
+        } else if (opcode == (uint8_t) G_ENDDL) {
+            return;
+        } else if (opcode == (uint8_t) G_CULLDL) {
+            if (gfx_cmd_culldl(cmd))
+                return;
+#if defined(F3DEX_GBI) || defined(F3DLP_GBI)
+        } else if (opcode == (uint8_t) G_BRANCH_Z) {
+            if (gfx_cmd_branch_z(cmd)) {
+                gfx_dl_depth--;
+                gfx_run_dl((Gfx *) seg_addr(rsp.rdphalf_1));
+                gfx_dl_depth++;
+                return;
             }
-#else
-                gfx_dp_fill_rectangle(C1(12, 12), C1(0, 12), C0(12, 12), C0(0, 12));
-                break;
 #endif
-            case G_SETSCISSOR:
-                gfx_dp_set_scissor(C1(24, 2), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
-                break;
-            case G_SETZIMG:
-                gfx_dp_set_z_image(seg_addr(cmd->words.w1));
-                break;
-            case G_SETCIMG:
-                gfx_dp_set_color_image(C0(21, 3), C0(19, 2), C0(0, 11), seg_addr(cmd->words.w1));
-                break;
+        } else {
+            cmd = gfx_run_cmd(cmd);
         }
-        ++cmd;
     }
 }
 
+static void gfx_run_dl(Gfx *cmd) {
+    if (gfx_dl_depth == DL_STACK_SIZE)
+        return;
+    gfx_dl_depth++;
+    gfx_run_dl_from(cmd);
+    gfx_dl_depth--;
+}
+
+void gfx_dl_cache_add_static(const void *start, uint32_t size) {
+    const uintptr_t addr = (uintptr_t) start;
+
+    // what the ranges this overlaps held is gone, and with it what was compiled from there
+    for (uint32_t i = 0; i < gfx_dl_cache.num_ranges;) {
+        const struct DlCacheRange *r = &gfx_dl_cache.ranges[i];
+        if (r->start < addr + size && addr < r->start + r->size) {
+            memmove(&gfx_dl_cache.ranges[i], &gfx_dl_cache.ranges[i + 1],
+                    sizeof(*r) * (--gfx_dl_cache.num_ranges - i));
+            gfx_dl_cache.clear_pending = true;
+        } else {
+            i++;
+        }
+    }
+
+    // the oldest range is the likeliest to be gone already
+    if (gfx_dl_cache.num_ranges == DL_CACHE_RANGES) {
+        memmove(&gfx_dl_cache.ranges[0], &gfx_dl_cache.ranges[1],
+                sizeof(gfx_dl_cache.ranges[0]) * --gfx_dl_cache.num_ranges);
+        gfx_dl_cache.clear_pending = true;
+    }
+    gfx_dl_cache.ranges[gfx_dl_cache.num_ranges].start = addr;
+    gfx_dl_cache.ranges[gfx_dl_cache.num_ranges].size = size;
+    gfx_dl_cache.num_ranges++;
+}
+
 static void gfx_sp_reset() {
     rsp.modelview_matrix_stack_size = 1;
     rsp.current_num_lights = 2;
     rsp.lights_changed = true;
+#if LIGHTS_BIND_CACHE
+    rsp.lights_reloaded = false;
+    rsp.lights_stale = false;
+#endif
+#if XFORM_LAZY
+    // MP_matrix is brought back to the bottom of the stack with the next vertices
+    rsp.xform_changed = true;
+#else
+    // the modelview matrix is back to the bottom of the stack without MP_matrix being recomputed,
+    // neither matches a generation from before
+    rsp.xform_gen = ++gfx_xform_gen_count;
+#endif
+    rsp.shade_gen++;
 }
 
 void gfx_get_dimensions(uint32_t *width, uint32_t *height) {
@@ -1828,6 +3616,9 @@ void gfx_init(struct GfxWindowManagerAPI *wapi, struct GfxRenderingAPI *rapi, co
     gfx_wapi->init(game_name, start_in_fullscreen);
     gfx_wapi->get_dimensions(&gfx_current_dimensions.width, &gfx_current_dimensions.height);
     gfx_rapi->init();
+#if TEX_IMPORT_LUT
+    gfx_texture_luts_init();
+#endif
 
     // Used in the 120 star TAS
     static uint32_t precomp_shaders[] = { 0x01200200, 0x00000045, 0x00000200, 0x01200a00, 0x00000a00,
@@ -1855,12 +3646,17 @@ struct GfxRenderingAPI *gfx_get_current_rendering_api(void) {
 }
 
 void gfx_start_frame(void) {
+    const uint32_t old_width = gfx_current_dimensions.width;
+    const uint32_t old_height = gfx_current_dimensions.height;
     gfx_wapi->handle_events();
     gfx_wapi->get_dimensions(&gfx_current_dimensions.width, &gfx_current_dimensions.height);
     if (gfx_current_dimensions.height == 0) {
         // Avoid division by zero
         gfx_current_dimensions.height = 1;
     }
+    // the window manager can change the resolution between frames
+    if (gfx_current_dimensions.width != old_width || gfx_current_dimensions.height != old_height)
+        gfx_rapi->on_resize();
     ratio_x = (float) gfx_current_dimensions.width / (float) SCREEN_WIDTH;
     ratio_y = (float) gfx_current_dimensions.height / (float) SCREEN_HEIGHT;
     inv_ratio_x = (float) SCREEN_WIDTH / (float) gfx_current_dimensions.width;
@@ -1880,15 +3676,43 @@ void gfx_run(Gfx *commands) {
     }
     dropped_frame = false;
 
-    profiling_reset();
-    uint64_t t0 = tmr_ms();
+    memset(&gfx_texture_cache_stats, 0, sizeof(gfx_texture_cache_stats));
+    memset(&gfx_vertex_cache_stats, 0, sizeof(gfx_vertex_cache_stats));
+    memset(&gfx_dl_cache_stats, 0, sizeof(gfx_dl_cache_stats));
+    if (gfx_dl_cache.clear_pending) {
+        memset(gfx_dl_cache.hashmap, 0, sizeof(gfx_dl_cache.hashmap));
+        gfx_dl_cache.num_entries = 0;
+        gfx_dl_cache.num_ops = 0;
+        gfx_dl_cache.num_tris = 0;
+        gfx_dl_cache.clear_pending = false;
+    }
+    const uint32_t t0 = tmr_ms();
     gfx_rapi->start_frame();
+    gfx_lod_update();
+    // the config can have changed the fog, filtering and LOD since the last frame
+    rdp.state_changed = GFX_CHANGED_ALL;
+#if GFX_LAYERS
+    gfx_layer.drawing = false;
+    gfx_layer.skipping = false;
+#endif
+#if HUD_LAYER_CACHE
+    gfx_overlay.pass = 0;
+#endif
+    gfx_dl_depth = 0;
     gfx_run_dl(commands);
     gfx_flush();
+#if GFX_LAYERS
+    // what is drawn before a layer isn't in its hash, it only stays valid while every frame
+    // drawn has it
+    nsp_layer_end_frame();
+#endif
+    // the times of the work done inside the walk come off this in profiling_end_frame
+    prof_frame.time[PROF_DL_WALK] += tmr_ms() - t0;
     gfx_rapi->end_frame();
     gfx_wapi->swap_buffers_begin();
 
-    tFullRender = tmr_ms() - t0;
+    prof_frame.time[PROF_RENDER] += tmr_ms() - t0;
+    prof_frame.count[PROF_TEX_MISSES] += gfx_texture_cache_stats.misses;
 }
 
 void gfx_end_frame(void) {
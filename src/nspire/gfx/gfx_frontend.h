@@ -12,7 +12,46 @@ struct GfxDimensions {
     float aspect_ratio;
 };
 
+// texture cache activity of the current frame
+struct GfxTextureCacheStats {
+    uint32_t hits, misses, evictions;
+};
+
+// vertex cache activity of the current frame
+struct GfxVertexCacheStats {
+    uint32_t hits, misses;
+};
+
+// display list cache activity of the current frame
+struct GfxDlCacheStats {
+    uint32_t replays, compiles;
+};
+
 extern struct GfxDimensions gfx_current_dimensions;
+extern struct GfxTextureCacheStats gfx_texture_cache_stats;
+extern struct GfxVertexCacheStats gfx_vertex_cache_stats;
+extern struct GfxDlCacheStats gfx_dl_cache_stats;
+
+// the RSP's segment table, which the G_MW_SEGMENT moves of the display lists set
+extern uintptr_t gfx_segments[16];
+
+// an address of a display list command through the segment table. Segmented addresses are below
+// 0x10000000, where no memory of the calculator is, anything above is a pointer already
+static inline void *nsp_segmented_to_virtual(uintptr_t addr) {
+    if ((addr >> 28) != 0)
+        return (void *) addr;
+    return (void *) (gfx_segments[addr >> 24] + (addr & 0x00FFFFFF));
+}
+
+#if PERF_COUNTERS
+// commands run and the ms spent in them since startup, by opcode, not counting G_DL and G_ENDDL
+struct GfxOpStats {
+    uint32_t count[256];
+    uint32_t ms[256];
+};
+
+extern struct GfxOpStats gfx_op_stats;
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +63,9 @@ struct GfxRenderingAPI *gfx_get_current_rendering_api(void);
 void gfx_start_frame(void);
 void gfx_run(Gfx *commands);
 void gfx_end_frame(void);
+// size bytes at start were just read from the ROM, display lists in there get compiled on their
+// first run
+void gfx_dl_cache_add_static(const void *start, uint32_t size);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,195 @@
+/**
+ * gfx_host.c — Headless window layer for a build that runs on the PC
+ *
+ * Built in place of gfx_nsp.c with HOST=1, see Makefile.nsp. The game, the
+ * frontend and the software renderer are the same C as on the calculator,
+ * only the LCD and the Nspire's timer are left out: a frame ends in
+ * gfx_output and goes nowhere, unless it is one of the frames picked to be
+ * written out. That runs the renderer at PC speed under perf, gprof or
+ * cachegrind, and a change to the rasterizer can be checked pixel for pixel
+ * against the frames of the build before it.
+ *
+ * The frames written out, as PPM files frame-NNNNN.ppm in the working
+ * directory, are picked with MM_HOST_DUMP: a list of drawn frame numbers
+ * separated by commas, or "all". MM_HOST_FRAMES ends the run after that
+ * many drawn frames. For two builds to draw the same frames, run both from
+ * the same recording with input_replay, see replay_nsp.c, and compare the
+ * files, cmp tells whether they match.
+ *
+ * input_nsp.c builds as is, the keypad reads are left out without
+ * TARGET_NSP and the controller stays at rest unless a recording drives it.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _LANGUAGE_C
+#define _LANGUAGE_C
+#endif
+#include <PR/gbi.h>
+
+#include "gfx_window_manager_api.h"
+#include "gfx_frontend.h"
+#include "gfx_backend.h"
+#include "macros.h"
+
+#include "pc/configfile.h"
+#include "pc/timer.h"
+#include "pc/profiling.h"
+
+#define HOST_DUMP_FORMAT "frame-%05lu.ppm"
+#define HOST_DUMP_MAX 64 // frame numbers MM_HOST_DUMP can list
+
+// render resolutions, as in gfx_nsp.c
+enum HostRes {
+    HOST_RES_FULL = 0, // 320x240
+    HOST_RES_120P = 1, // 160x120
+    HOST_RES_80P = 2,  // 80x60
+};
+
+/* From main_nsp.c */
+extern void nsp_exit(void);
+
+static enum HostRes cur_res;
+static uint32_t host_frames; // frames drawn so far
+static uint32_t host_max_frames; // 0: no limit
+static bool host_dump_all;
+static uint32_t host_dump[HOST_DUMP_MAX];
+static int host_num_dump;
+
+static void host_init(UNUSED const char *game_name, UNUSED bool start_in_fullscreen) {
+    const char *dump = getenv("MM_HOST_DUMP");
+    const char *frames = getenv("MM_HOST_FRAMES");
+
+    cur_res = config80pMode ? HOST_RES_80P : config120pMode ? HOST_RES_120P : HOST_RES_FULL;
+
+    if (frames != NULL)
+        host_max_frames = strtoul(frames, NULL, 10);
+    if (dump != NULL && strcmp(dump, "all") == 0) {
+        host_dump_all = true;
+    } else {
+        for (char *end; dump != NULL && *dump != '\0' && host_num_dump < HOST_DUMP_MAX; dump = end) {
+            host_dump[host_num_dump++] = strtoul(dump, &end, 10);
+            if (end == dump)
+                break;
+            end += strspn(end, ", ");
+        }
+    }
+}
+
+// the game loop is Graph_ThreadEntry's, called from main_nsp.c, this only exists for the interface
+static void host_main_loop(void (*run_one_game_iter)(void)) {
+    while (host_max_frames == 0 || host_frames < host_max_frames)
+        run_one_game_iter();
+}
+
+static void host_get_dimensions(uint32_t *width, uint32_t *height) {
+    *width = SCREEN_WIDTH >> cur_res;
+    *height = SCREEN_HEIGHT >> cur_res;
+}
+
+static void host_handle_events(void) {
+}
+
+static bool host_start_frame(void) {
+    return true; // the frame pipeline decides the drops
+}
+
+static void host_swap_buffers_begin(void) {
+}
+
+static bool host_should_dump(const uint32_t frame) {
+    if (host_dump_all)
+        return true;
+    for (int i = 0; i < host_num_dump; i++)
+        if (host_dump[i] == frame)
+            return true;
+    return false;
+}
+
+// writes the color buffer as it is, at the resolution it was drawn at
+static void host_dump_frame(const uint32_t frame) {
+    const uint32_t width = gfx_current_dimensions.width;
+    const uint32_t height = gfx_current_dimensions.height;
+    char name[32];
+    FILE *f;
+
+    snprintf(name, sizeof(name), HOST_DUMP_FORMAT, (unsigned long) frame);
+    f = fopen(name, "wb");
+    if (f == NULL) {
+        printf("Could not open '%s' for the frame\n", name);
+        return;
+    }
+    fprintf(f, "P6\n%lu %lu\n255\n", (unsigned long) width, (unsigned long) height);
+    for (uint32_t i = 0; i < width * height; i++) {
+        const gfx_pixel_t p = gfx_output[i];
+#if OUTPUT_RGB565
+        // rrrrr gggggg bbbbb, the top bits repeated into the bottom ones
+        const uint8_t rgb[3] = { ((p >> 8) & 0xF8) | (p >> 13), ((p >> 3) & 0xFC) | ((p >> 9) & 0x3),
+                                 ((p << 3) & 0xF8) | ((p >> 2) & 0x7) };
+#else
+        // aaaaaaaa bbbbbbbb gggggggg rrrrrrrr
+        const uint8_t rgb[3] = { p & 0xFF, (p >> 8) & 0xFF, (p >> 16) & 0xFF };
+#endif
+        fwrite(rgb, 1, sizeof(rgb), f);
+    }
+    fclose(f);
+}
+
+static void host_swap_buffers_end(void) {
+    const uint32_t t0 = tmr_ms();
+
+    if (host_should_dump(host_frames))
+        host_dump_frame(host_frames);
+    prof_frame.time[PROF_BLIT] += tmr_ms() - t0;
+
+    if (++host_frames == host_max_frames)
+        nsp_exit();
+}
+
+// unimplemented windowing features
+static void host_set_keyboard_callbacks(UNUSED bool (*on_key_down)(int scancode),
+                                        UNUSED bool (*on_key_up)(int scancode),
+                                        UNUSED void (*on_all_keys_up)(void)) {
+}
+static void host_set_fullscreen_changed_callback(UNUSED void (*on_fullscreen_changed)(bool is_now_fullscreen)) {
+}
+static void host_set_fullscreen(UNUSED bool enable) {
+}
+static double host_get_time(void) {
+    return 0.0;
+}
+
+static void host_shutdown(void) {
+    profiling_close();
+}
+
+#if ENV_EFFECT_BUDGET
+// as in gfx_nsp.c, the resolution doesn't change on the host
+int32_t Environment_GetEffectBudget(void) {
+    const uint32_t budget = (configEnvEffectBudget * 256 / 100) >> cur_res;
+    return (budget > 256) ? 256 : (int32_t) budget;
+}
+#endif
+
+#if DRAW_DISTANCE
+// as in gfx_nsp.c, without adaptive quality
+int32_t Environment_GetDrawDistance(void) {
+    const uint32_t dist = configDrawDistance * 256 / 100;
+    return (dist > 256) ? 256 : (int32_t) dist;
+}
+#endif
+
+// under the name of the Nspire's, which main_nsp.c hands to the frontend
+struct GfxWindowManagerAPI gfx_nsp_api = { host_init,
+                                           host_set_keyboard_callbacks,
+                                           host_set_fullscreen_changed_callback,
+                                           host_set_fullscreen,
+                                           host_main_loop,
+                                           host_get_dimensions,
+                                           host_handle_events,
+                                           host_start_frame,
+                                           host_swap_buffers_begin,
+                                           host_swap_buffers_end,
+                                           host_get_time,
+                                           host_shutdown };
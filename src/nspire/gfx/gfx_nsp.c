@@ -1,8 +1,15 @@
 #include <libndls.h>
 #include <SDL/SDL.h>
 
+#ifndef _LANGUAGE_C
+#define _LANGUAGE_C
+#endif
+#include <PR/gbi.h>
+
 #include "gfx_window_manager_api.h"
+#include "gfx_frontend.h"
 #include "gfx_backend.h"
+#include "gfx_arm.h"
 #include "macros.h"
 #include "nspireio.h"
 
@@ -15,16 +22,111 @@
 #define HALF_WIDTH SCREEN_WIDTH / 2
 #define HALF_HEIGHT SCREEN_HEIGHT / 2
 
+#define FRAME_MS 33 // one frame every 33 milliseconds -> 30 fps
+
+// adaptive quality: rendered frames over budget in a row before the quality drops a step, and
+// rendered frames with room for the next step up in a row before it comes back
+#define ADAPT_DOWN_FRAMES 4
+#define ADAPT_UP_FRAMES 30
+// adaptive quality: steps of a quarter of draw_distance it can take off the draw distance
+#define ADAPT_DIST_STEPS 2
+
+// render resolutions, each is half the size of the previous one in both directions
+enum NspRes {
+    NSP_RES_FULL = 0, // 320x240
+    NSP_RES_120P = 1, // 160x120
+    NSP_RES_80P = 2,  // 80x60
+};
+
 static uint32_t frames_now = 0;
 static uint32_t frames_prev = 0;
 
 static bool skip_frame = false;
 
+static enum NspRes cur_res;   // resolution the frontend renders at
+static unsigned int skip_max; // most frames skipped in a row to catch up
+static int dist_step;         // quarters of draw_distance taken off the draw distance
+
+static int32_t avg_render; // smoothed render time of a frame, in 1/16 ms
+static int32_t avg_update; // smoothed game update time of a frame, in 1/16 ms
+static int adapt_down;     // rendered frames in a row that were over budget
+static int adapt_up;       // rendered frames in a row with room for a step up
+
 void nsp_init(UNUSED const char *game_name, UNUSED bool start_in_fullscreen) {
     if (configOverclock) {
         set_cpu_speed(CPU_SPEED_150MHZ);
     }
     lcd_init(SCR_320x240_565);
+
+    cur_res = config80pMode ? NSP_RES_80P : config120pMode ? NSP_RES_120P : NSP_RES_FULL;
+    skip_max = configAdaptiveQuality ? 0 : configFrameskip;
+}
+
+// lowers or raises the quality a step to hold FRAME_MS a frame, going down the resolution first,
+// then the draw distance and then skipping more frames, and coming back up in the reverse order.
+// t_chunk is the time the last frame and the iterations skipped before it took, iters the amount of
+// game iterations in it
+static void nsp_adapt_quality(const uint32_t t_chunk, const int iters) {
+    const uint32_t t_full = prof_frame.time[PROF_RENDER];
+    const uint32_t t_render = (t_full < t_chunk) ? t_full : t_chunk;
+    const uint32_t t_update = (t_chunk - t_render) / iters;
+    const int32_t budget = FRAME_MS << 4;
+
+    // moving averages over about 8 frames, so a single slow frame doesn't trigger a step
+    avg_render += ((int32_t) (t_render << 4) - avg_render) >> 3;
+    avg_update += ((int32_t) (t_update << 4) - avg_update) >> 3;
+
+    // one game iteration costs its update and its share of the rendered frame
+    if (avg_update + avg_render / (int32_t) (skip_max + 1) > budget) {
+        adapt_up = 0;
+        if (++adapt_down < ADAPT_DOWN_FRAMES)
+            return;
+        adapt_down = 0;
+        if (cur_res < NSP_RES_80P) {
+            ++cur_res;
+            avg_render >>= 2; // a quarter of the pixels
+#if DRAW_DISTANCE
+        } else if (dist_step < ADAPT_DIST_STEPS) {
+            ++dist_step;
+#endif
+        } else if (skip_max < configFrameskip) {
+            ++skip_max;
+        }
+        return;
+    }
+    adapt_down = 0;
+
+    // only step up when the step is predicted to fit with an eighth of the budget to spare, the
+    // prediction takes render time to grow with the pixel count, which overestimates it, and by a
+    // quarter for a quarter more draw distance
+    int32_t next;
+    if (skip_max > 0)
+        next = avg_update + avg_render / (int32_t) skip_max;
+#if DRAW_DISTANCE
+    else if (dist_step > 0)
+        next = avg_update + avg_render + (avg_render >> 2);
+#endif
+    else if (cur_res > NSP_RES_FULL)
+        next = avg_update + (avg_render << 2);
+    else
+        return; // best quality already
+    if (next > budget - (budget >> 3)) {
+        adapt_up = 0;
+        return;
+    }
+    if (++adapt_up < ADAPT_UP_FRAMES)
+        return;
+    adapt_up = 0;
+    if (skip_max > 0) {
+        --skip_max;
+#if DRAW_DISTANCE
+    } else if (dist_step > 0) {
+        --dist_step;
+#endif
+    } else {
+        --cur_res;
+        avg_render <<= 2;
+    }
 }
 
 void nsp_main_loop(void (*run_one_game_iter)(void)) {
@@ -61,16 +163,16 @@ void nsp_main_loop(void (*run_one_game_iter)(void)) {
     tmr_reset();
     tmr_start();
     while (true) {
-        frames_now = tmr_ms() / 33; // one frame every 33 milliseconds -> 30 fps
+        frames_now = tmr_ms() / FRAME_MS;
         uint32_t new_frames = frames_now - frames_prev;
 
         if (new_frames) {
             // printf("ideal: %lu\ncurrent: %lu\n", frames_now, frames_prev); // PRINTING TOO MUCH ON
             // HARDWARE CAUSES EXTREME TEARING
 
-            int to_skip = (new_frames > configFrameskip)
-                              ? configFrameskip
-                              : (new_frames - 1); // catch up by skipping up to configFrameskip frames
+            int to_skip = (new_frames > skip_max)
+                              ? skip_max
+                              : (new_frames - 1); // catch up by skipping up to skip_max frames
 
             uint32_t t0 = tmr_ms();
 
@@ -86,6 +188,14 @@ void nsp_main_loop(void (*run_one_game_iter)(void)) {
             }
             // printf("tFRAME: %lu\n", tmr_ms() - t0);
 
+            const uint32_t t_chunk = tmr_ms() - t0;
+            const uint32_t t_drawn = prof_frame.time[PROF_RENDER] + prof_frame.time[PROF_BLIT];
+            prof_frame.time[PROF_UPDATE] = (t_drawn < t_chunk) ? t_chunk - t_drawn : 0;
+
+            if (configAdaptiveQuality)
+                nsp_adapt_quality(t_chunk, to_skip + 1);
+            profiling_end_frame();
+
             // Status screen / debug
             if (isKeyPressed(KEY_NSPIRE_CTRL)) {
                 tmr_stop();
@@ -97,16 +207,31 @@ void nsp_main_loop(void (*run_one_game_iter)(void)) {
                 float fps = 1000.f / tDelta;
 
                 nio_printf("Total elapsed (ms): %lu\n"
-                           "Backend Gfx time: %d\n"
-                           "Front + Backend Gfx time: %d\n"
+                           "Update/render/blit (ms): %lu/%lu/%lu\n"
+                           "DL walk/transform/clip (ms): %lu/%lu/%lu\n"
+                           "Raster/texture import (ms): %lu/%lu\n"
                            "Total frame time (ms): %lu\n"
                            "FPS, physical: %f\n"
                            "FPS, virtual: %f\n"
                            "^ This includes frames skipped\n"
-                           "Tris this frame: %d\n"
-                           "Frames skipped: %d\n",
-                           tmr_ms(), tFlushing, tFullRender, tDelta, fps, fps * (to_skip + 1), numTris,
-                           to_skip);
+                           "Tris/pixels this frame: %lu/%lu\n"
+                           "Shader switches: %lu\n"
+                           "Frames skipped: %d\n"
+                           "Texture hits/misses/evictions: %lu/%lu/%lu\n"
+                           "Vertex hits/misses: %lu/%lu\n"
+                           "DL replays/compiles: %lu/%lu\n"
+                           "Resolution: %dx%d, frameskip at most %u\n",
+                           tmr_ms(), prof_last.time[PROF_UPDATE], prof_last.time[PROF_RENDER],
+                           prof_last.time[PROF_BLIT], prof_last.time[PROF_DL_WALK],
+                           prof_last.time[PROF_TRANSFORM], prof_last.time[PROF_CLIP],
+                           prof_last.time[PROF_RASTER], prof_last.time[PROF_TEXTURE], tDelta, fps,
+                           fps * (to_skip + 1), prof_last.count[PROF_TRIS],
+                           prof_last.count[PROF_PIXELS], prof_last.count[PROF_SHADER_SWITCHES],
+                           to_skip, gfx_texture_cache_stats.hits, gfx_texture_cache_stats.misses,
+                           gfx_texture_cache_stats.evictions, gfx_vertex_cache_stats.hits,
+                           gfx_vertex_cache_stats.misses, gfx_dl_cache_stats.replays,
+                           gfx_dl_cache_stats.compiles, SCREEN_WIDTH >> cur_res,
+                           SCREEN_HEIGHT >> cur_res, skip_max);
 
                 wait_key_pressed();
                 nio_free(console);
@@ -119,11 +244,29 @@ void nsp_main_loop(void (*run_one_game_iter)(void)) {
     }
 }
 
+#if ENV_EFFECT_BUDGET
+// share of the N64 environment effect particles the game draws, in 1/256ths, see z_kankyo.c. Each
+// resolution step down halves it, the game draws the particles that many times bigger in area
+int32_t Environment_GetEffectBudget(void) {
+    const uint32_t budget = (configEnvEffectBudget * 256 / 100) >> cur_res;
+    return (budget > 256) ? 256 : (int32_t) budget;
+}
+#endif
+
+#if DRAW_DISTANCE
+// share of the scenes' draw distance the game keeps, in 1/256ths, see z_kankyo.c and z_actor.c. It can
+// only be cut, past 100% the scenes' fog and geometry would end before it
+int32_t Environment_GetDrawDistance(void) {
+    const uint32_t dist = (configDrawDistance * 256 / 100) * (4 - dist_step) / 4;
+    return (dist > 256) ? 256 : (int32_t) dist;
+}
+#endif
+
 void nsp_get_dimensions(uint32_t *width, uint32_t *height) {
-    if (config80pMode) { // 1/16th the pixel resolution (80x60)
+    if (cur_res == NSP_RES_80P) { // 1/16th the pixel resolution (80x60)
         *width = SCREEN_WIDTH / 4;
         *height = SCREEN_HEIGHT / 4;
-    } else if (config120pMode) { // quarter the pixel resolution (160x120)
+    } else if (cur_res == NSP_RES_120P) { // quarter the pixel resolution (160x120)
         *width = HALF_WIDTH;
         *height = HALF_HEIGHT;
     } else {
@@ -136,18 +279,25 @@ bool nsp_start_frame(void) {
     return !skip_frame; // (current_frame % 4) == 0; //
 }
 
+#if OUTPUT_RGB565
+static inline uint16_t c4444_to_c565(uint16_t c) { // the backend already draws rrrrr gggggg bbbbb
+    return c;
+}
+#else
 static inline uint16_t
 c4444_to_c565(uint32_t c) { // aaaaaaaa bbbbbbbb gggggggg rrrrrrrr -> rrrrr gggggg bbbbb
     return ((c & 0b11111000) << 8) | ((c & 0b1111110000000000) >> 5) | ((c >> 19) & 0b11111);
 }
+#endif
 
 void nsp_swap_buffers_begin(void) {
 }
 
 void nsp_swap_buffers_end(void) {
-    static uint16_t buffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+    static uint16_t buffer[SCREEN_WIDTH * SCREEN_HEIGHT] __attribute__((aligned(32)));
+    const uint32_t t0 = tmr_ms();
 
-    if (config80pMode) {
+    if (cur_res == NSP_RES_80P) {
         // 80x60 -> 320x240: each pixel becomes a 4x4 block
         const int src_w = SCREEN_WIDTH / 4; // 80
         int img_pix = 0;
@@ -159,17 +309,16 @@ void nsp_swap_buffers_end(void) {
                 uint32_t c32 = ((uint32_t) c16 << 16) | c16;
                 int x = col * 4;
                 uint32_t *row0 = (uint32_t *) &buffer[base + x];
-                uint32_t *row1 = (uint32_t *) &buffer[base + SCREEN_WIDTH + x];
                 row0[0] = c32;
                 row0[1] = c32;
-                row1[0] = c32;
-                row1[1] = c32;
             }
-            // Copy row pair to the next two rows
-            memcpy(&buffer[base + 2 * SCREEN_WIDTH], &buffer[base], SCREEN_WIDTH * 2);
-            memcpy(&buffer[base + 3 * SCREEN_WIDTH], &buffer[base], SCREEN_WIDTH * 2);
+            // Copy the expanded row to the next three rows
+            const uint32_t *src = (const uint32_t *) &buffer[base];
+            arm_copy32((uint32_t *) &buffer[base + SCREEN_WIDTH], src, SCREEN_WIDTH / 2);
+            arm_copy32((uint32_t *) &buffer[base + 2 * SCREEN_WIDTH], src, SCREEN_WIDTH / 2);
+            arm_copy32((uint32_t *) &buffer[base + 3 * SCREEN_WIDTH], src, SCREEN_WIDTH / 2);
         }
-    } else if (config120pMode) {
+    } else if (cur_res == NSP_RES_120P) {
         // 160x120 -> 320x240: optimized with 32-bit writes
         // Process two source pixels at a time, writing four 16-bit pixels as two 32-bit values
         const int src_w = HALF_WIDTH; // 160
@@ -188,15 +337,28 @@ void nsp_swap_buffers_end(void) {
                 dst[1] = pair_b;
             }
             // Duplicate row: copy first expanded row to second
-            memcpy(&buffer[base + SCREEN_WIDTH], &buffer[base], SCREEN_WIDTH * 2);
+            arm_copy32((uint32_t *) &buffer[base + SCREEN_WIDTH], (const uint32_t *) &buffer[base],
+                       SCREEN_WIDTH / 2);
         }
     } else {
-        for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
-            buffer[i] = c4444_to_c565(gfx_output[i]);
+#if OUTPUT_RGB565
+        // full resolution RGB565 output is what the LCD takes already
+        profiling_draw_hud(gfx_output, SCREEN_WIDTH, SCREEN_HEIGHT);
+        lcd_blit(gfx_output, SCR_320x240_565);
+        prof_frame.time[PROF_BLIT] += tmr_ms() - t0;
+        return;
+#else
+        // two pixels per word store
+        uint32_t *dst = (uint32_t *) buffer;
+        for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i += 2) {
+            *dst++ = (uint32_t) c4444_to_c565(gfx_output[i + 1]) << 16 | c4444_to_c565(gfx_output[i]);
         }
+#endif
     }
 
+    profiling_draw_hud(buffer, SCREEN_WIDTH, SCREEN_HEIGHT);
     lcd_blit(buffer, SCR_320x240_565);
+    prof_frame.time[PROF_BLIT] += tmr_ms() - t0;
 }
 
 // unimplemented windowing features
@@ -215,6 +377,7 @@ double nsp_get_time(void) {
 }
 
 void nsp_shutdown(void) {
+    profiling_close();
     lcd_init(SCR_TYPE_INVALID);
     // tmr_shutdown(); // BANDAID FIX: attempting to restore old timer soft locks calc. not required but
     // could be problematic?
@@ -26,7 +26,7 @@ struct GfxRenderingAPI {
     void (*set_viewport)(int x, int y, int width, int height);
     void (*set_scissor)(int x, int y, int width, int height);
     void (*set_use_alpha)(bool use_alpha);
-    void (*draw_triangles)(fix64 buf_vbo[], size_t buf_vbo_len, size_t buf_vbo_num_tris);
+    void (*draw_triangles)(fixr buf_vbo[], size_t buf_vbo_len, size_t buf_vbo_num_tris);
     void (*init)(void);
     void (*on_resize)(void);
     void (*start_frame)(void);
@@ -36,6 +36,9 @@ struct GfxRenderingAPI {
     void (*tex_rect)(int x0, int y0, int x1, int y1, const float u0, const float v0, const float dudx, const float dvdy, const uint8_t *rgba); // optional; draw 2d rect textured with tile 0
     void (*set_fog_color)(const uint8_t *rgb); // optional; set global fog color
     void (*shutdown)(void); // optional
+    // optional; CI4 or CI8 (bits 4 or 8) texels as the N64 has them, with their 16 or 256 RGBA32 colors
+    void (*upload_texture_ci)(const uint8_t *indices, int width, int height, int bits, const uint8_t *rgba32_palette);
+    void (*upload_palette)(const uint8_t *rgba32_palette); // optional; replace the colors of the selected CI texture
 };
 
 #endif
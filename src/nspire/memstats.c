@@ -0,0 +1,28 @@
+// memstats.c - what the heaps, the arenas and the renderer's caches hold, for the HUD and crash dumps
+#include "memstats.h"
+
+struct MemStats mem_stats[MEM_NUM_POOLS];
+
+static const char *const mem_pool_names[MEM_NUM_POOLS] = {
+    "heap", "zelda_arena", "game_tha", "objects", "rooms", "gfx_pool", "texcache", "targets", "image",
+};
+
+void memstats_set(const enum MemPool pool, const uint32_t used, const uint32_t capacity, const uint32_t max_free) {
+    struct MemStats *s = &mem_stats[pool];
+
+    s->used = used;
+    s->capacity = capacity;
+    s->max_free = max_free;
+    if (s->peak < used)
+        s->peak = used;
+}
+
+void memstats_dump(FILE *f) {
+    fputs("pool,used,peak,capacity,max_free\n", f);
+    for (int i = 0; i < MEM_NUM_POOLS; i++) {
+        const struct MemStats *s = &mem_stats[i];
+
+        fprintf(f, "%s,%lu,%lu,%lu,%lu\n", mem_pool_names[i], (unsigned long) s->used, (unsigned long) s->peak,
+                (unsigned long) s->capacity, (unsigned long) s->max_free);
+    }
+}
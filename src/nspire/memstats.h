@@ -0,0 +1,35 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// the memory the port's consumers hold, each reports its own with memstats_set
+enum MemPool {
+    MEM_HEAP,        // the C heap everything else is allocated from, as mallinfo sees it
+    MEM_ZELDA_ARENA, // ZeldaArena, actors and paged overlays, see malloc_nsp.c
+    MEM_GAME_THA,    // the game state's two-head arena, which the object space and the room buffer are in
+    MEM_OBJECTS,     // the object space, up to the end of the last object loaded
+    MEM_ROOMS,       // the room buffer, reserved whole for the two largest rooms of the scene
+    MEM_GFX_POOL,    // the display list arenas of the frame, out of one of the two GfxPools
+    MEM_TEXCACHE,    // the renderer's texture slabs, see gfx_backend.c
+    MEM_TARGETS,     // the renderer's color, depth and occlusion buffers at the render resolution
+    MEM_IMAGE,       // the executable, with the overlays linked into it
+    MEM_NUM_POOLS
+};
+
+struct MemStats {
+    uint32_t used;
+    uint32_t peak;     // the most used since startup
+    uint32_t capacity; // 0 when the pool isn't set up
+    uint32_t max_free; // the largest block left, what the next allocation can have
+};
+
+extern struct MemStats mem_stats[MEM_NUM_POOLS];
+
+// updates a pool's numbers and its peak
+void memstats_set(enum MemPool pool, uint32_t used, uint32_t capacity, uint32_t max_free);
+// writes every pool, in bytes, one per line
+void memstats_dump(FILE *f);
+
+#endif
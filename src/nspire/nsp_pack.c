@@ -0,0 +1,183 @@
+// nsp_pack.c - asset pack with textures, vertices and matrices already converted for the port
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nsp_pack.h"
+
+// RAM ranges of the last files read from the ROM, to get from a texture to its VROM address
+#define PACK_REGIONS 128
+
+struct PackRegion {
+    uintptr_t ram;
+    uint32_t vrom;
+    uint32_t size; // 0 for an unused one
+};
+
+_Static_assert(sizeof(struct NspPackEntry) == 0x1C, "the directory is read as is");
+
+static FILE *pack_file;
+static struct NspPackEntry *pack_dir; // sorted by VROM address, the entries don't overlap
+static uint32_t pack_count;
+static struct PackRegion pack_regions[PACK_REGIONS];
+static uint32_t pack_region_next;
+static uint32_t pack_region_last; // the region the last lookup found, textures come in runs from one file
+
+int nsp_pack_init(const char *path) {
+    uint32_t header[4];
+
+    pack_file = fopen(path, "rb");
+    if (pack_file == NULL)
+        return -1;
+
+    if (fread(header, sizeof(header), 1, pack_file) != 1 || memcmp(header, "NSPK", 4) != 0
+        || header[1] != NSP_PACK_VERSION || header[2] == 0)
+        goto fail;
+    pack_dir = malloc(header[2] * sizeof(struct NspPackEntry));
+    if (pack_dir == NULL || fseek(pack_file, header[3], SEEK_SET) != 0
+        || fread(pack_dir, sizeof(struct NspPackEntry), header[2], pack_file) != header[2])
+        goto fail;
+    pack_count = header[2];
+    return 0;
+
+fail:
+    printf("Could not use the asset pack '%s'\n", path);
+    nsp_pack_close();
+    return -1;
+}
+
+void nsp_pack_close(void) {
+    if (pack_file != NULL) {
+        fclose(pack_file);
+        pack_file = NULL;
+    }
+    free(pack_dir);
+    pack_dir = NULL;
+    pack_count = 0;
+}
+
+static int pack_read(uint32_t offset, void *dest, uint32_t size) {
+    if (fseek(pack_file, offset, SEEK_SET) != 0 || fread(dest, 1, size, pack_file) != size)
+        return -1;
+    return 0;
+}
+
+// index of the first entry whose N64 data ends after vrom
+static uint32_t pack_find(uint32_t vrom) {
+    uint32_t lo = 0, hi = pack_count;
+
+    while (lo < hi) {
+        const uint32_t mid = (lo + hi) / 2;
+        if (pack_dir[mid].vrom + pack_dir[mid].src_size <= vrom)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void pack_region_add(uintptr_t ram, uint32_t vrom, uint32_t size) {
+    int slot = -1;
+
+    // what was loaded before where this goes is gone. a read to the same buffer over and over, as
+    // the message font's, takes the place of the one before it instead of pushing out older files
+    for (int i = 0; i < PACK_REGIONS; i++) {
+        struct PackRegion *r = &pack_regions[i];
+        if (r->size != 0 && r->ram < ram + size && ram < r->ram + r->size)
+            r->size = 0;
+        if (r->size == 0 && slot < 0)
+            slot = i;
+    }
+    if (slot < 0) {
+        slot = pack_region_next;
+        pack_region_next = (pack_region_next + 1) % PACK_REGIONS;
+    }
+    pack_regions[slot] = (struct PackRegion) { ram, vrom, size };
+}
+
+bool nsp_pack_vrom(const void *addr, uint32_t size, uint32_t *vrom) {
+    const uintptr_t a = (uintptr_t) addr;
+    const struct PackRegion *r = &pack_regions[pack_region_last];
+
+    if (r->size != 0 && a >= r->ram && a - r->ram + size <= r->size) {
+        *vrom = r->vrom + (a - r->ram);
+        return true;
+    }
+    for (uint32_t i = 0; i < PACK_REGIONS; i++) {
+        r = &pack_regions[i];
+        if (r->size != 0 && a >= r->ram && a - r->ram + size <= r->size) {
+            *vrom = r->vrom + (a - r->ram);
+            pack_region_last = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void nsp_pack_patch(uint32_t vrom, void *dest, uint32_t size) {
+    if (size == 0)
+        return;
+
+    // kept without a pack too, the texture cache knows textures by where they are in the ROM
+    pack_region_add((uintptr_t) dest, vrom, size);
+    if (pack_file == NULL)
+        return;
+
+    for (uint32_t i = pack_find(vrom); i < pack_count && pack_dir[i].vrom < vrom + size; i++) {
+        const struct NspPackEntry *e = &pack_dir[i];
+        if (e->type != NSP_PACK_VERTEX && e->type != NSP_PACK_MTX && e->type != NSP_PACK_S16)
+            continue;
+        // a partial read only gets the part of the entry it covers
+        const uint32_t start = (e->vrom > vrom) ? e->vrom : vrom;
+        const uint32_t end = (e->vrom + e->size < vrom + size) ? e->vrom + e->size : vrom + size;
+        uint8_t *out = (uint8_t *) dest + (start - vrom);
+        if (pack_read(e->offset + (start - e->vrom), out, end - start) != 0) {
+            printf("Could not read the asset pack at 0x%08lX\n", (unsigned long) e->offset);
+            return;
+        }
+    }
+}
+
+static uint32_t pack_hash(const uint8_t *data, uint32_t size) {
+    uint32_t hash = 0x811C9DC5;
+
+    for (uint32_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 0x01000193;
+    return hash;
+}
+
+bool nsp_pack_texture(const uint8_t *addr, uint32_t size_bytes, uint32_t fmt, uint32_t siz,
+                      uint32_t width, uint32_t height, uint8_t *rgba32_buf, size_t buf_size) {
+    uint32_t vrom;
+
+    if (pack_file == NULL || !nsp_pack_vrom(addr, size_bytes, &vrom))
+        return false;
+
+    const uint32_t i = pack_find(vrom);
+    if (i >= pack_count)
+        return false;
+    const struct NspPackEntry *e = &pack_dir[i];
+    if (e->vrom != vrom || e->type != NSP_PACK_TEXTURE || e->fmt != fmt || e->siz != siz
+        || e->src_size != size_bytes || e->width != width || e->height != height
+        || e->size > buf_size)
+        return false;
+
+    // the region can be stale, if something other than a ROM read wrote there since, and the game
+    // can change a texture after loading it. hashing costs less than the decode it replaces
+    if (pack_hash(addr, size_bytes) != e->src_hash)
+        return false;
+    return pack_read(e->offset, rgba32_buf, e->size) == 0;
+}
+
+bool nsp_pack_overlay(uint32_t vrom, uint32_t offset, void *dest, uint32_t size) {
+    if (pack_file == NULL)
+        return false;
+
+    const uint32_t i = pack_find(vrom);
+    if (i >= pack_count)
+        return false;
+    const struct NspPackEntry *e = &pack_dir[i];
+    if (e->vrom != vrom || e->type != NSP_PACK_OVERLAY || offset + size > e->size)
+        return false;
+    return pack_read(e->offset + offset, dest, size) == 0;
+}
@@ -0,0 +1,63 @@
+#ifndef NSP_PACK_H
+#define NSP_PACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// asset pack made by tools/mknsppack.py from the fragments of ZAPD's NSPIRE exporter set, see
+// tools/ZAPD/ExporterTest/NspireExporter.h for the layout. everything in it is little endian,
+// so the directory and the payloads are used as read
+#define NSP_PACK_VERSION 1
+
+enum NspPackEntryType {
+    NSP_PACK_TEXTURE = 1, // RGBA32 texels
+    NSP_PACK_VERTEX = 2,  // a run of Vtx, byteswapped
+    NSP_PACK_MTX = 3,     // a run of Mtx, byteswapped
+    NSP_PACK_S16 = 4,     // a run of s16, byteswapped: the frames of player animations
+    NSP_PACK_OVERLAY = 5, // an overlay compiled for the port, made by tools/mknspovl.py
+};
+
+struct NspPackEntry {
+    uint32_t vrom;
+    uint32_t offset;   // of the payload in the pack
+    uint32_t size;     // of the payload
+    uint32_t src_size; // of the N64 data the payload replaces
+    uint32_t src_hash; // FNV-1a of the N64 data, textures only
+    uint8_t type;
+    uint8_t fmt, siz; // G_IM_FMT_* and G_IM_SIZ_* of textures
+    uint8_t pad;
+    uint16_t width, height;
+};
+
+// payload of an NSP_PACK_OVERLAY: this header, then the overlay as the N64 lays one out, its text,
+// data, rodata and relocation section, then the offsets into it of the words that point into the
+// executable, see overlay_nsp.c
+struct NspPackOverlay {
+    uint32_t vram_start;     // address the overlay is linked at
+    uint32_t vram_end;       // with its bss
+    uint32_t profile;        // address of its profile, 0 if it has none
+    uint32_t image_size;     // of the overlay file that follows
+    uint32_t exe_anchor;     // address of nsp_overlay_anchor in the executable it was linked against
+    uint32_t num_exe_relocs; // offsets after the file
+};
+
+// opens the pack, no pack is not an error, the assets are then only taken from the ROM
+int nsp_pack_init(const char *path);
+void nsp_pack_close(void);
+// called on all data read from the ROM: overwrites the vertices, matrices and player animation
+// frames in it with their byteswapped versions and remembers where it went in RAM, for
+// nsp_pack_texture and nsp_pack_vrom
+void nsp_pack_patch(uint32_t vrom, void *dest, uint32_t size);
+// the VROM address the size bytes at addr were read from, if they are in one of the last files read
+// from the ROM. works without a pack
+bool nsp_pack_vrom(const void *addr, uint32_t size, uint32_t *vrom);
+// reads the decoded texels of the texture at addr into rgba32_buf, if the pack has them for the
+// same format, size and data. returns false when the texture has to be decoded
+bool nsp_pack_texture(const uint8_t *addr, uint32_t size_bytes, uint32_t fmt, uint32_t siz,
+                      uint32_t width, uint32_t height, uint8_t *rgba32_buf, size_t buf_size);
+// reads size bytes from offset into the payload of the overlay that replaces the ROM file at vrom.
+// returns false when the pack has none, the overlay is then in the executable
+bool nsp_pack_overlay(uint32_t vrom, uint32_t offset, void *dest, uint32_t size);
+
+#endif
@@ -0,0 +1,360 @@
+/**
+ * anim_nsp.c — Integer skeleton animation kernels
+ *
+ * Every joint a skeleton animates goes through SkelAnime_InterpFrameTable
+ * once or twice a frame: once between the two frames around curFrame, and
+ * once more towards morphTable while a morph runs. Each component costs an
+ * f32 multiply, which is a libgcc call on the ARM926.
+ *
+ * The lerps here do the multiply on the float's mantissa in integers, then
+ * round it to 24 bits like the FPU would and truncate it like
+ * TRUNCF_BINANG, so the results are the same as the float path's to the
+ * bit. Weights of -1 or under, which nothing passes, take the float path.
+ *
+ * SkelAnime_GetFrameDataInterp decodes the current and the next frame of an
+ * animation and lerps them, and towards morphTable, in one pass over the
+ * joints, instead of SkelAnime_AnimateFrame's two decodes into tables and
+ * two lerp passes over them.
+ *
+ * AnimTaskQueue_Update runs each stretch of Copy, Interp and CopyUsingMap
+ * tasks over tables of the same length, which is what a skeleton queues in
+ * a frame (Player queues its upper body's on top), in one pass over the
+ * joints as well. Every task only reads and writes joint i of its tables
+ * while working on joint i, so going joint by joint gives the same tables
+ * as going task by task, as long as no two tables overlap without being the
+ * same one. Stretches where some do still run task by task.
+ *
+ * The replaced functions are left out of z_skelanime.c with ANIM_FUSED.
+ */
+#include <stdbool.h>
+
+#include "z64animation.h"
+#include "z64lib.h"
+
+#include "fixed_pt.h"
+
+/* From z_skelanime.c */
+extern s32 sDisabledTransformTaskGroups;
+extern void AnimTask_LoadPlayerFrame(struct PlayState* play, AnimTaskData* data);
+extern void AnimTask_Copy(struct PlayState* play, AnimTaskData* data);
+extern void AnimTask_Interp(struct PlayState* play, AnimTaskData* data);
+extern void AnimTask_CopyUsingMap(struct PlayState* play, AnimTaskData* data);
+extern void AnimTask_CopyUsingMapInverted(struct PlayState* play, AnimTaskData* data);
+extern void AnimTask_ActorMovement(struct PlayState* play, AnimTaskData* data);
+extern s32 sCurAnimTaskGroup;
+
+/* ============================================================
+ * Lerps
+ * ============================================================ */
+
+typedef enum {
+    ANIM_WEIGHT_INT,   /* mant * 2^-shift, the lerp is integer */
+    ANIM_WEIGHT_COPY,  /* 1 or over, the lerp is a copy of the target */
+    ANIM_WEIGHT_FLOAT, /* -1 or under, the lerp is the float one */
+} AnimWeightMode;
+
+typedef struct {
+    AnimWeightMode mode;
+    u32 mant;  /* with the implicit bit, 0 for zero and denormals */
+    s32 shift; /* 24 or over */
+    u32 sign;
+    f32 weight;
+} AnimWeight;
+
+typedef union {
+    f32 f;
+    u32 u;
+} AnimWeightBits;
+
+static void anim_weight_init(AnimWeight* w, f32 weight) {
+    AnimWeightBits bits;
+    s32 exp;
+
+    w->weight = weight;
+    if (!(weight < 1.0f)) {
+        w->mode = ANIM_WEIGHT_COPY;
+        return;
+    }
+
+    bits.f = weight;
+    exp = (bits.u >> 23) & 0xFF;
+    w->mode = ANIM_WEIGHT_INT;
+    w->sign = bits.u >> 31;
+    if (exp == 0) {
+        w->mant = 0;
+        w->shift = 150;
+    } else if (exp >= 127) {
+        w->mode = ANIM_WEIGHT_FLOAT;
+    } else {
+        w->mant = (bits.u & 0x7FFFFF) | 0x800000;
+        w->shift = 150 - exp;
+    }
+}
+
+/** TRUNCF_BINANG(diff * weight), for a weight under 1 in magnitude */
+static inline s32 anim_mult_trunc(s16 diff, const AnimWeight* w) {
+    u64 mag;
+    s32 top;
+    s32 shift = w->shift;
+    s32 q;
+
+    if (diff == 0) {
+        return 0;
+    }
+    mag = (u64) ((diff < 0) ? -(s32) diff : diff) * w->mant;
+    if (mag == 0) {
+        return 0;
+    }
+
+    /* Round the product to 24 bits, to nearest even */
+    top = 63 - fix_clz64(mag);
+    if (top > 23) {
+        s32 s = top - 23;
+        u64 rem = mag & ((1ULL << s) - 1);
+        u64 half = 1ULL << (s - 1);
+
+        mag >>= s;
+        if ((rem > half) || ((rem == half) && (mag & 1))) {
+            mag++;
+        }
+        shift -= s;
+    }
+
+    /* mag is under 2^25 */
+    q = (shift >= 32) ? 0 : (s32) (mag >> shift);
+    return ((diff < 0) != w->sign) ? -q : q;
+}
+
+static inline s16 anim_lerp(s16 base, s16 target, const AnimWeight* w) {
+    s16 diff = target - base;
+
+    switch (w->mode) {
+        case ANIM_WEIGHT_INT:
+            return anim_mult_trunc(diff, w) + base;
+        case ANIM_WEIGHT_COPY:
+            return target;
+        default:
+            return TRUNCF_BINANG(diff * w->weight) + base;
+    }
+}
+
+static inline void anim_lerp_vec(Vec3s* dst, Vec3s* start, Vec3s* target, const AnimWeight* w) {
+    dst->x = anim_lerp(start->x, target->x, w);
+    dst->y = anim_lerp(start->y, target->y, w);
+    dst->z = anim_lerp(start->z, target->z, w);
+}
+
+void SkelAnime_InterpFrameTable(s32 limbCount, Vec3s* dst, Vec3s* start, Vec3s* target, f32 weight) {
+    AnimWeight w;
+    s32 i;
+
+    anim_weight_init(&w, weight);
+    for (i = 0; i < limbCount; i++) {
+        anim_lerp_vec(&dst[i], &start[i], &target[i], &w);
+    }
+}
+
+/* ============================================================
+ * Frame decode
+ * ============================================================ */
+
+static inline s16 anim_decode(s16* frameData, s16* dynamicData, u16 index, u16 staticIndexMax) {
+    return (index >= staticIndexMax) ? dynamicData[index] : frameData[index];
+}
+
+/**
+ * SkelAnime_GetFrameData of frame into frameTable, lerped with frameWeight
+ * towards nextFrame unless it is -1, then with morphWeight towards
+ * morphTable unless it is NULL.
+ */
+void SkelAnime_GetFrameDataInterp(AnimationHeader* animation, s32 frame, s32 nextFrame, f32 frameWeight,
+                                  Vec3s* morphTable, f32 morphWeight, s32 limbCount, Vec3s* frameTable) {
+    AnimationHeader* animHeader = Lib_SegmentedToVirtual(animation);
+    JointIndex* jointIndices = Lib_SegmentedToVirtual(animHeader->jointIndices);
+    s16* frameData = Lib_SegmentedToVirtual(animHeader->frameData);
+    s16* dynamicData = &frameData[frame];
+    s16* nextDynamicData = (nextFrame >= 0) ? &frameData[nextFrame] : NULL;
+    u16 staticIndexMax = animHeader->staticIndexMax;
+    AnimWeight frameW;
+    AnimWeight morphW;
+    s32 i;
+
+    anim_weight_init(&frameW, frameWeight);
+    anim_weight_init(&morphW, morphWeight);
+
+    for (i = 0; i < limbCount; i++, jointIndices++, frameTable++) {
+        Vec3s v;
+
+        v.x = anim_decode(frameData, dynamicData, jointIndices->x, staticIndexMax);
+        v.y = anim_decode(frameData, dynamicData, jointIndices->y, staticIndexMax);
+        v.z = anim_decode(frameData, dynamicData, jointIndices->z, staticIndexMax);
+        if (nextFrame >= 0) {
+            Vec3s next;
+
+            next.x = anim_decode(frameData, nextDynamicData, jointIndices->x, staticIndexMax);
+            next.y = anim_decode(frameData, nextDynamicData, jointIndices->y, staticIndexMax);
+            next.z = anim_decode(frameData, nextDynamicData, jointIndices->z, staticIndexMax);
+            anim_lerp_vec(&v, &v, &next, &frameW);
+        }
+        if (morphTable != NULL) {
+            anim_lerp_vec(&v, &v, &morphTable[i], &morphW);
+        }
+        *frameTable = v;
+    }
+}
+
+/* ============================================================
+ * Task queue
+ * ============================================================ */
+
+#define ANIM_RUN_MAX 8
+
+typedef struct {
+    u8 type;
+    Vec3s* dest;
+    Vec3s* src;
+    u8* limbCopyMap;
+    AnimWeight weight;
+} AnimRunTask;
+
+typedef struct {
+    AnimRunTask tasks[ANIM_RUN_MAX];
+    s32 count;
+    s32 vecCount;
+} AnimRun;
+
+/* Whether a and b, vecCount long, are the same table or don't overlap at all */
+static inline bool anim_tables_separate(Vec3s* a, Vec3s* b, s32 vecCount) {
+    return (a == b) || (a + vecCount <= b) || (b + vecCount <= a);
+}
+
+/**
+ * Adds task to run if it can join it: it has to be a transformative task
+ * over the run's table length, and its tables can't partly overlap any of
+ * the run's. Tasks of a disabled group do nothing, so they always join.
+ */
+static bool anim_run_add(AnimRun* run, AnimTask* task) {
+    AnimRunTask t;
+    s32 vecCount;
+    u8 group;
+
+    switch (task->type) {
+        case ANIMTASK_COPY:
+            group = task->data.copy.group;
+            vecCount = task->data.copy.vecCount;
+            t.dest = task->data.copy.dest;
+            t.src = task->data.copy.src;
+            break;
+        case ANIMTASK_INTERP:
+            group = task->data.interp.group;
+            vecCount = task->data.interp.vecCount;
+            t.dest = task->data.interp.base;
+            t.src = task->data.interp.mod;
+            anim_weight_init(&t.weight, task->data.interp.weight);
+            break;
+        case ANIMTASK_COPY_USING_MAP:
+            group = task->data.copyUsingMap.group;
+            vecCount = task->data.copyUsingMap.vecCount;
+            t.dest = task->data.copyUsingMap.dest;
+            t.src = task->data.copyUsingMap.src;
+            t.limbCopyMap = task->data.copyUsingMap.limbCopyMap;
+            break;
+        case ANIMTASK_COPY_USING_MAP_INVERTED:
+            group = task->data.copyUsingMapInverted.group;
+            vecCount = task->data.copyUsingMapInverted.vecCount;
+            t.dest = task->data.copyUsingMapInverted.dest;
+            t.src = task->data.copyUsingMapInverted.src;
+            t.limbCopyMap = task->data.copyUsingMapInverted.limbCopyMap;
+            break;
+        default:
+            return false;
+    }
+
+    if (group & sDisabledTransformTaskGroups) {
+        return true;
+    }
+    if (run->count == ANIM_RUN_MAX || (run->count != 0 && vecCount != run->vecCount) ||
+        !anim_tables_separate(t.dest, t.src, vecCount)) {
+        return false;
+    }
+    for (s32 i = 0; i < run->count; i++) {
+        if (!anim_tables_separate(t.dest, run->tasks[i].dest, vecCount) ||
+            !anim_tables_separate(t.dest, run->tasks[i].src, vecCount) ||
+            !anim_tables_separate(t.src, run->tasks[i].dest, vecCount) ||
+            !anim_tables_separate(t.src, run->tasks[i].src, vecCount)) {
+            return false;
+        }
+    }
+
+    t.type = task->type;
+    run->tasks[run->count++] = t;
+    run->vecCount = vecCount;
+    return true;
+}
+
+static void anim_run_flush(AnimRun* run) {
+    for (s32 i = 0; i < run->vecCount && run->count != 0; i++) {
+        for (s32 j = 0; j < run->count; j++) {
+            AnimRunTask* t = &run->tasks[j];
+
+            switch (t->type) {
+                case ANIMTASK_COPY:
+                    t->dest[i] = t->src[i];
+                    break;
+                case ANIMTASK_INTERP:
+                    anim_lerp_vec(&t->dest[i], &t->dest[i], &t->src[i], &t->weight);
+                    break;
+                case ANIMTASK_COPY_USING_MAP:
+                    if (t->limbCopyMap[i]) {
+                        t->dest[i] = t->src[i];
+                    }
+                    break;
+                default:
+                    if (!t->limbCopyMap[i]) {
+                        t->dest[i] = t->src[i];
+                    }
+                    break;
+            }
+        }
+    }
+    run->count = 0;
+}
+
+typedef void (*AnimTaskFunc)(struct PlayState* play, AnimTaskData* data);
+
+/**
+ * AnimTaskQueue_Update, with the transformative tasks run in stretches.
+ *
+ * The first LoadPlayerFrame task finishes every DMA queued so far, which is
+ * all of the queue's, so the ones after it have nothing left to wait for and
+ * don't end a stretch. The first one does: tasks before it see the tables
+ * from before the DMAs.
+ */
+void AnimTaskQueue_Update(struct PlayState* play, AnimTaskQueue* animTaskQueue) {
+    static AnimTaskFunc sAnimTaskFuncs[ANIMTASK_MAX] = {
+        AnimTask_LoadPlayerFrame,      AnimTask_Copy,          AnimTask_Interp, AnimTask_CopyUsingMap,
+        AnimTask_CopyUsingMapInverted, AnimTask_ActorMovement,
+    };
+    AnimTask* task = animTaskQueue->tasks;
+    AnimRun run;
+    bool loaded = false;
+
+    run.count = 0;
+    while (animTaskQueue->count != 0) {
+        if (task->type == ANIMTASK_LOAD_PLAYER_FRAME && loaded) {
+            AnimTask_LoadPlayerFrame(play, &task->data);
+        } else if (!anim_run_add(&run, task)) {
+            anim_run_flush(&run);
+            if (!anim_run_add(&run, task)) {
+                sAnimTaskFuncs[task->type](play, &task->data);
+                loaded |= (task->type == ANIMTASK_LOAD_PLAYER_FRAME);
+            }
+        }
+        task++;
+        animTaskQueue->count--;
+    }
+    anim_run_flush(&run);
+
+    sCurAnimTaskGroup = 1 << 0;
+    sDisabledTransformTaskGroups = 0;
+}
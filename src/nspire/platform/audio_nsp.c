@@ -0,0 +1,615 @@
+/**
+ * audio_nsp.c — Software audio mixer for TI-Nspire CX
+ *
+ * Replaces the RSP half of MM's audio driver. The sequence player
+ * (seqplayer.c), note playback (playback.c), envelopes (effects.c) and the
+ * sample loading (load.c) run as they are. Where synthesis.c builds an audio
+ * command list for the RSP, AudioSynth_Update here decodes and mixes the
+ * notes itself, in fixed point:
+ *   - ADPCM (4 and 2 bit), S8 and raw S16 samples are decoded a 16 sample
+ *     frame at a time, each voice keeping its last frame as the predictor
+ *     state, so a frame is never decoded twice
+ *   - resampled with linear interpolation along a 16.16 step
+ *   - mixed dry into a stereo 32 bit accumulator, with the volumes ramped to
+ *     the targets playback.c set over each update
+ * Reverb, the Haas and surround effects and the comb filter are left out.
+ *
+ * There is no audio thread: nsp_audio_update runs once per game frame and
+ * catches the audio driver up on the retraces that went by, mixing a whole
+ * game frame's worth of samples in one batch. The batch goes to
+ * nsp_audio_output. The calculator itself has no speaker, so that is left to
+ * whatever output a build has (a PWM or USB driver, a host build).
+ *
+ * The number of voices and the output rate come from the config. With
+ * audio_budget set, the mixer drops the quietest voices while it goes over
+ * that many ms a frame, so that audio can't take the frame rate with it.
+ * Dropped voices still advance through their samples, they come back in
+ * time when there is room again.
+ */
+#include "global.h"
+#include "audiomgr.h"
+
+#include "nspire/configfile.h"
+#include "nspire/profiling.h"
+
+#include "vadpcm_order2.h" /* tools/audio/sampleconv/src/codec */
+
+extern uint32_t tmr_ms(void);
+extern int nsp_rom_read(uint32_t vrom, void* dest, uint32_t size);
+
+#define NSP_AUDIO_MAX_NOTES 0x58
+#define NSP_AUDIO_MAX_VOICES 32
+#define NSP_AUDIO_MIN_VOICES 4  /* the budget mode doesn't go below, the music needs a few */
+#define NSP_AUDIO_MIN_RATE 8000
+#define NSP_AUDIO_MAX_RATE 32000
+#define NSP_AUDIO_RETRACE_HZ 60 /* the audio driver's tick on the N64 */
+#define NSP_AUDIO_MAX_TICKS 6   /* retraces caught up on in one game frame, 100ms */
+#define NSP_AUDIO_BATCH_MAX (NSP_AUDIO_MAX_TICKS * NSP_AUDIO_MAX_RATE / NSP_AUDIO_RETRACE_HZ + SAMPLES_PER_FRAME)
+#define NSP_AUDIO_CHUNK 64            /* output samples resampled from one decoded run */
+#define NSP_AUDIO_MAX_STEP (8 << 16)  /* pitches above 8x to the output rate are clamped */
+#define NSP_AUDIO_DECODE_MAX ((NSP_AUDIO_CHUNK * NSP_AUDIO_MAX_STEP >> 16) + 2)
+#define NSP_AUDIO_DMA_FRAMES 32       /* frames asked of AudioLoad_DmaSampleData at once */
+
+typedef struct {
+    s16 frame[SAMPLES_PER_FRAME]; /* decoded samples of frameIndex */
+    s32 frameIndex;               /* -1 when there is no decoded frame to follow on from */
+    s16 prev;                     /* the sample before samplePosInt, interpolated from */
+    s32 volLeft;                  /* current volumes, targetVol << 4 in 8 bits of fraction */
+    s32 volRight;
+} NspVoice;
+
+static NspVoice voices[NSP_AUDIO_MAX_NOTES];
+static s32 mix_buf[NSP_AUDIO_BATCH_MAX * 2]; /* interleaved left and right */
+static s16 out_buf[NSP_AUDIO_BATCH_MAX * 2];
+static s16 decode_buf[NSP_AUDIO_DECODE_MAX + 1];
+
+static u32 out_rate;       /* configAudioRate clamped, in Hz */
+static u32 batch_len;      /* samples mixed into mix_buf this game frame */
+static u32 pending_len;    /* samples owed by the ticks since the last synthesis */
+static u32 tick_rem;       /* remainder of out_rate / NSP_AUDIO_RETRACE_HZ carried between ticks */
+static u32 voice_limit;    /* voices mixed, lowered by the budget mode */
+static bool over_budget;   /* the rest of the frame's ticks mix no voices */
+static u32 last_update_ms;
+static u32 noise_seed = 1;
+
+/* ============================================================
+ * Decoding
+ * ============================================================ */
+
+static inline s16 clamp16(s32 v) {
+    if (v > 0x7FFF)
+        return 0x7FFF;
+    if (v < -0x8000)
+        return -0x8000;
+    return v;
+}
+
+/*
+ * Decodes one ADPCM frame, 16 samples predicted from the two before them in
+ * two groups of 8. 4 bit residuals take 8 bytes after the header byte, 2 bit
+ * ones 4 bytes. Like the RSP's aADPCMdec, only order 2 books are handled, with
+ * the unrolled decoder sampleconv uses too.
+ */
+static void NspAudio_DecodeAdpcm(const u8* in, s16* out, const s16* prevFrame, const s16* book, bool small) {
+    s32 state[SAMPLES_PER_FRAME];
+    s32 res[SAMPLES_PER_FRAME];
+    s32 i;
+
+    state[SAMPLES_PER_FRAME - 2] = prevFrame[SAMPLES_PER_FRAME - 2];
+    state[SAMPLES_PER_FRAME - 1] = prevFrame[SAMPLES_PER_FRAME - 1];
+    vadpcm_order2_decode(in, small, book, state, res, true);
+    for (i = 0; i < SAMPLES_PER_FRAME; i++)
+        out[i] = state[i];
+}
+
+/* Bytes of sample data per 16 sample frame, 0 for codecs that play as silence */
+static s32 NspAudio_FrameSize(u32 codec) {
+    switch (codec) {
+        case CODEC_ADPCM:
+            return 9;
+        case CODEC_SMALL_ADPCM:
+            return 5;
+        case CODEC_S8:
+            return 16;
+        case CODEC_UNK7:
+            return 2 * SAMPLES_PER_FRAME;
+        default:
+            return 0;
+    }
+}
+
+static void NspAudio_DecodeFrame(NspVoice* v, const Sample* sample, s32 bookOffset, const u8* in) {
+    s16 out[SAMPLES_PER_FRAME];
+    s32 i;
+
+    switch (sample->codec) {
+        case CODEC_ADPCM:
+        case CODEC_SMALL_ADPCM:
+            NspAudio_DecodeAdpcm(in, out, v->frame,
+                                 (bookOffset == 1) ? &gInvalidAdpcmCodeBook[1] : sample->book->codeBook,
+                                 sample->codec == CODEC_SMALL_ADPCM);
+            break;
+
+        case CODEC_S8:
+            for (i = 0; i < SAMPLES_PER_FRAME; i++)
+                out[i] = (s16)(in[i] << 8);
+            break;
+
+        default: /* CODEC_UNK7, big-endian s16 as is */
+            for (i = 0; i < SAMPLES_PER_FRAME; i++)
+                out[i] = (s16)((in[2 * i] << 8) | in[2 * i + 1]);
+            break;
+    }
+    memcpy(v->frame, out, sizeof(out));
+}
+
+/* Sample data of frames [first, first + count), read through the sample DMA buffers when not in RAM */
+static const u8* NspAudio_SampleData(NoteSynthesisState* synth, Sample* sample, s32 first, s32 count, s32 frameSize,
+                                     bool init) {
+    u8* addr = sample->sampleAddr + first * frameSize;
+
+    if (sample->medium == MEDIUM_RAM)
+        return addr;
+    if (sample->medium == MEDIUM_UNK)
+        return NULL;
+    return AudioLoad_DmaSampleData((uintptr_t)addr, ALIGN16(count * frameSize + SAMPLES_PER_FRAME), init,
+                                   &synth->sampleDmaIndex, sample->medium);
+}
+
+/*
+ * Handles samplePosInt reaching the end: jumps to the loop start with the
+ * loop's predictor state as the decoded frame there, or returns true if the
+ * sample is finished.
+ */
+static bool NspAudio_AtEnd(NspVoice* v, NoteSynthesisState* synth, AdpcmLoop* loop) {
+    if (loop->header.count == 0 || (loop->header.count == 2 && synth->stopLoop))
+        return true;
+    synth->samplePosInt = loop->header.start;
+    memcpy(v->frame, loop->predictorState, sizeof(v->frame));
+    v->frameIndex = loop->header.start / SAMPLES_PER_FRAME;
+    return false;
+}
+
+/*
+ * Decodes count samples from samplePosInt on into out, looping as needed.
+ * Past the end, out is filled with silence and true is returned.
+ */
+static bool NspAudio_Fetch(NspVoice* v, NoteSynthesisState* synth, NoteSampleState* state, s32 endPos, s32 count,
+                           s16* out) {
+    Sample* sample = state->tunedSample->sample;
+    const s32 frameSize = NspAudio_FrameSize(sample->codec);
+
+    while (count > 0) {
+        if (synth->samplePosInt >= endPos) {
+            if (NspAudio_AtEnd(v, synth, sample->loop)) {
+                memset(out, 0, count * sizeof(s16));
+                return true;
+            }
+            continue;
+        }
+
+        s32 pos = synth->samplePosInt;
+        s32 run = MIN(count, endPos - pos);
+
+        if (frameSize == 0) {
+            memset(out, 0, run * sizeof(s16));
+        } else {
+            s32 frame = pos / SAMPLES_PER_FRAME;
+            s32 last = (pos + run - 1) / SAMPLES_PER_FRAME;
+            s32 first = (frame == v->frameIndex) ? frame + 1 : frame;
+            const u8* data = NULL;
+
+            last = MIN(last, first + NSP_AUDIO_DMA_FRAMES - 1);
+            if (first <= last) {
+                data = NspAudio_SampleData(synth, sample, first, last - first + 1, frameSize, v->frameIndex < 0);
+                if (data == NULL) {
+                    memset(out, 0, count * sizeof(s16));
+                    return false;
+                }
+            }
+            run = MIN(run, (last + 1) * SAMPLES_PER_FRAME - pos);
+
+            for (s32 end = pos + run; pos < end;) {
+                s32 n;
+
+                frame = pos / SAMPLES_PER_FRAME;
+                if (frame != v->frameIndex) {
+                    /* A frame that doesn't follow the one decoded starts from silence, as on A_INIT */
+                    if (frame != v->frameIndex + 1)
+                        memset(v->frame, 0, sizeof(v->frame));
+                    NspAudio_DecodeFrame(v, sample, state->bitField1.bookOffset, data + (frame - first) * frameSize);
+                    v->frameIndex = frame;
+                }
+                n = MIN(end - pos, SAMPLES_PER_FRAME - pos % SAMPLES_PER_FRAME);
+                memcpy(out, &v->frame[pos % SAMPLES_PER_FRAME], n * sizeof(s16));
+                out += n;
+                pos += n;
+            }
+        }
+
+        synth->samplePosInt += run;
+        count -= run;
+    }
+    return false;
+}
+
+/* Like NspAudio_Fetch without decoding, for the voices dropped this update */
+static bool NspAudio_Skip(NspVoice* v, NoteSynthesisState* synth, NoteSampleState* state, s32 endPos, s32 count) {
+    while (count > 0) {
+        if (synth->samplePosInt >= endPos) {
+            if (NspAudio_AtEnd(v, synth, state->tunedSample->sample->loop))
+                return true;
+            continue;
+        }
+        s32 run = MIN(count, endPos - synth->samplePosInt);
+        synth->samplePosInt += run;
+        count -= run;
+        v->frameIndex = -1;
+    }
+    return false;
+}
+
+/* Keeps the phase of a synthetic wave across a change of harmonic, as AudioSynth_LoadWaveSamples does */
+static void NspAudio_WaveHarmonic(NoteSynthesisState* synth, NoteSampleState* state) {
+    static const u8 samplesPerPeriod[] = { WAVE_SAMPLE_COUNT / 1, WAVE_SAMPLE_COUNT / 2, WAVE_SAMPLE_COUNT / 4,
+                                           WAVE_SAMPLE_COUNT / 8 };
+    s32 harmonics = state->harmonicIndexCurAndPrev;
+    s32 pos = synth->samplePosInt;
+
+    if (harmonics != 0)
+        pos = (pos * samplesPerPeriod[harmonics >> 2]) / samplesPerPeriod[harmonics & 3];
+    synth->samplePosInt = (u32)pos % WAVE_SAMPLE_COUNT;
+}
+
+/* The 64 sample synthetic waves of gWaveSamples loop forever, bookOffset picks noise */
+static void NspAudio_FetchWave(NoteSynthesisState* synth, NoteSampleState* state, s32 count, s16* out) {
+    s32 pos = synth->samplePosInt;
+
+    if (state->bitField1.bookOffset != 0) {
+        for (s32 i = 0; i < count; i++) {
+            noise_seed = noise_seed * 1103515245 + 12345;
+            out[i] = (s16)(noise_seed >> 16);
+        }
+        return;
+    }
+
+    for (s32 i = 0; i < count; i++) {
+        out[i] = state->waveSampleAddr[pos];
+        pos = (pos + 1) % WAVE_SAMPLE_COUNT;
+    }
+    synth->samplePosInt = pos;
+}
+
+/* ============================================================
+ * Mixing
+ * ============================================================ */
+
+/* Mixes numSamples of a note into mix_buf from out, or only advances it when dropped */
+static void NspAudio_MixNote(s32 noteIndex, NoteSampleState* state, s32 numSamples, s32* mix, s32 updateIndex,
+                             bool dropped) {
+    Note* note = &gAudioCtx.notes[noteIndex];
+    NoteSynthesisState* synth = &note->synthesisState;
+    NspVoice* v = &voices[noteIndex];
+    AdpcmLoop* loop = NULL;
+    s32 endPos = 0;
+    u32 step;
+    s32 targetLeft;
+    s32 targetRight;
+    s32 rampLeft;
+    s32 rampRight;
+    s32 gain = state->gain;
+    bool finished = false;
+
+    if (state->bitField0.needsInit) {
+        synth->atLoopPoint = false;
+        synth->stopLoop = false;
+        synth->samplePosInt = note->playbackState.startSamplePos;
+        synth->samplePosFrac = 0;
+        note->sampleState.bitField0.finished = false;
+        memset(v->frame, 0, sizeof(v->frame));
+        v->frameIndex = synth->samplePosInt / SAMPLES_PER_FRAME - 1;
+        v->prev = 0;
+        v->volLeft = 0;
+        v->volRight = 0;
+    }
+
+    if (state->bitField1.isSyntheticWave) {
+        NspAudio_WaveHarmonic(synth, state);
+    } else {
+        loop = state->tunedSample->sample->loop;
+        if (note->playbackState.status != PLAYBACK_STATUS_0)
+            synth->stopLoop = true;
+        endPos = (loop->header.count == 2 && synth->stopLoop) ? loop->header.sampleEnd : loop->header.loopEnd;
+    }
+
+    /* frequencyFixedPoint is the pitch at the spec's rate in 1.15, made 16.16 at the output rate */
+    step = ((u32)state->frequencyFixedPoint * 2 * gAudioCtx.audioBufferParameters.samplingFreq) / out_rate;
+    if (step > NSP_AUDIO_MAX_STEP)
+        step = NSP_AUDIO_MAX_STEP;
+
+    if (dropped) {
+        u32 adv = (synth->samplePosFrac + step * numSamples) >> 16;
+
+        synth->samplePosFrac = (synth->samplePosFrac + step * numSamples) & 0xFFFF;
+        if (state->bitField1.isSyntheticWave) {
+            synth->samplePosInt = (synth->samplePosInt + adv) % WAVE_SAMPLE_COUNT;
+        } else {
+            finished = NspAudio_Skip(v, synth, state, endPos, adv);
+        }
+        v->volLeft = (state->targetVolLeft << 4) << 8;
+        v->volRight = (state->targetVolRight << 4) << 8;
+    } else {
+        /* Ramp the volumes to the targets over the whole update */
+        targetLeft = (state->targetVolLeft << 4) << 8;
+        targetRight = (state->targetVolRight << 4) << 8;
+        rampLeft = (targetLeft - v->volLeft) / numSamples;
+        rampRight = (targetRight - v->volRight) / numSamples;
+
+        if (gain != 0 && gain < 0x10)
+            gain = 0x10;
+
+        while (numSamples > 0 && !finished) {
+            s32 n = MIN(numSamples, NSP_AUDIO_CHUNK);
+            u32 q = synth->samplePosFrac;
+            u32 need = ((q + step * (n - 1)) >> 16) + 1; /* decode_buf[1..need] are read */
+            u32 adv = (q + step * n) >> 16;              /* of which these are consumed */
+            s32 volLeft = v->volLeft;
+            s32 volRight = v->volRight;
+
+            /* decode_buf[0] is the sample before the position, interpolated from */
+            decode_buf[0] = v->prev;
+            if (state->bitField1.isSyntheticWave) {
+                NspAudio_FetchWave(synth, state, MAX(need, adv), &decode_buf[1]);
+                if (need > adv)
+                    synth->samplePosInt = (synth->samplePosInt + WAVE_SAMPLE_COUNT - 1) % WAVE_SAMPLE_COUNT;
+            } else {
+                finished = NspAudio_Fetch(v, synth, state, endPos, adv, &decode_buf[1]);
+                if (need > adv) {
+                    /* Peek at the next sample without moving on to it */
+                    s32 pos = synth->samplePosInt;
+                    NspAudio_Fetch(v, synth, state, endPos, 1, &decode_buf[1 + adv]);
+                    synth->samplePosInt = pos;
+                }
+            }
+            v->prev = decode_buf[adv];
+
+            for (s32 i = 0; i < n; i++, q += step) {
+                const s16* s = &decode_buf[q >> 16];
+                s32 x = s[0] + (((s[1] - s[0]) * (s32)((q >> 1) & 0x7FFF)) >> 15);
+
+                if (gain != 0)
+                    x = clamp16((x * gain) >> 4);
+                mix[0] += (x * (volLeft >> 8)) >> 16;
+                mix[1] += (x * (volRight >> 8)) >> 16;
+                mix += 2;
+                volLeft += rampLeft;
+                volRight += rampRight;
+            }
+
+            synth->samplePosFrac = q & 0xFFFF;
+            v->volLeft = volLeft;
+            v->volRight = volRight;
+            numSamples -= n;
+        }
+        if (numSamples <= 0) {
+            v->volLeft = targetLeft;
+            v->volRight = targetRight;
+        }
+    }
+
+    if (finished) {
+        note->sampleState.bitField0.finished = true;
+        AudioSynth_DisableSampleStates(updateIndex, noteIndex);
+    }
+}
+
+/* Roughly how loud a note plays, to choose the notes to keep when dropping some */
+static u32 NspAudio_Loudness(NoteSampleState* state) {
+    u32 vol = state->targetVolLeft + state->targetVolRight;
+
+    return (state->gain != 0) ? (vol * state->gain) >> 4 : vol;
+}
+
+/* Mixes the notes enabled in one update, the loudest voice_limit of them, into mix */
+static void NspAudio_MixUpdate(s32* mix, s32 numSamples, s32 updateIndex) {
+    NoteSampleState* states = &gAudioCtx.sampleStateList[gAudioCtx.numNotes * updateIndex];
+    u8 noteIndices[0x58];
+    u32 loudness[0x58];
+    s32 noteCount = 0;
+    s32 keep;
+    s32 i;
+
+    for (i = 0; i < gAudioCtx.numNotes && noteCount < (s32)ARRAY_COUNT(noteIndices); i++) {
+        if (!states[i].bitField0.enabled)
+            continue;
+
+        /* Insertion sort, loudest first */
+        u32 l = NspAudio_Loudness(&states[i]);
+        s32 j = noteCount++;
+        while (j > 0 && loudness[j - 1] < l) {
+            noteIndices[j] = noteIndices[j - 1];
+            loudness[j] = loudness[j - 1];
+            j--;
+        }
+        noteIndices[j] = i;
+        loudness[j] = l;
+    }
+
+    keep = over_budget ? 0 : MIN(noteCount, (s32)voice_limit);
+    for (i = 0; i < noteCount; i++) {
+        NspAudio_MixNote(noteIndices[i], &states[noteIndices[i]], numSamples, mix, updateIndex, i >= keep);
+    }
+    prof_frame.count[PROF_VOICES] = MAX(prof_frame.count[PROF_VOICES], (u32)keep);
+}
+
+/* ============================================================
+ * synthesis.c replacements
+ * ============================================================ */
+
+void AudioSynth_SyncSampleStates(s32 updateIndex) {
+    NoteSampleState* noteSampleState;
+    NoteSampleState* sampleState;
+    s32 sampleStateBaseIndex = gAudioCtx.numNotes * updateIndex;
+    s32 i;
+
+    for (i = 0; i < gAudioCtx.numNotes; i++) {
+        noteSampleState = &gAudioCtx.notes[i].sampleState;
+        sampleState = &gAudioCtx.sampleStateList[sampleStateBaseIndex + i];
+        if (noteSampleState->bitField0.enabled) {
+            noteSampleState->bitField0.needsInit = false;
+        } else {
+            sampleState->bitField0.enabled = false;
+        }
+
+        noteSampleState->harmonicIndexCurAndPrev = 0;
+    }
+}
+
+void AudioSynth_DisableSampleStates(s32 updateIndex, s32 noteIndex) {
+    NoteSampleState* sampleState;
+    s32 i;
+
+    for (i = updateIndex + 1; i < gAudioCtx.audioBufferParameters.updatesPerFrame; i++) {
+        sampleState = &gAudioCtx.sampleStateList[(gAudioCtx.numNotes * i) + noteIndex];
+        if (sampleState->bitField0.needsInit) {
+            break;
+        }
+        sampleState->bitField0.enabled = false;
+    }
+}
+
+/**
+ * Runs the sequences for every update of the audio frame like the original,
+ * then mixes the samples of the ticks since the last audio frame at the output rate into the game frame's batch,
+ * split evenly over the updates. Builds no commands, aiBufStart is unused.
+ */
+Acmd* AudioSynth_Update(Acmd* abiCmdStart, s32* numAbiCmds, s16* aiBufStart, s32 numSamplesPerFrame) {
+    s32 updatesPerFrame = gAudioCtx.audioBufferParameters.updatesPerFrame;
+    s32 remaining = MIN((s32)pending_len, NSP_AUDIO_BATCH_MAX - (s32)batch_len);
+    s32* mix = &mix_buf[batch_len * 2];
+    s32 reverseUpdateIndex;
+
+    (void)aiBufStart;
+    (void)numSamplesPerFrame;
+
+    memset(mix, 0, remaining * 2 * sizeof(s32));
+    pending_len = 0;
+
+    for (reverseUpdateIndex = updatesPerFrame; reverseUpdateIndex > 0; reverseUpdateIndex--) {
+        AudioScript_ProcessSequences(reverseUpdateIndex - 1);
+        AudioSynth_SyncSampleStates(updatesPerFrame - reverseUpdateIndex);
+    }
+
+    for (reverseUpdateIndex = updatesPerFrame; reverseUpdateIndex > 0; reverseUpdateIndex--) {
+        s32 numSamples = remaining / reverseUpdateIndex;
+
+        if (numSamples > 0)
+            NspAudio_MixUpdate(mix, numSamples, updatesPerFrame - reverseUpdateIndex);
+        mix += numSamples * 2;
+        remaining -= numSamples;
+        batch_len += numSamples;
+    }
+
+    *numAbiCmds = 0;
+    return abiCmdStart;
+}
+
+/* ============================================================
+ * Audio manager replacement
+ * ============================================================ */
+
+/* Sample banks and sequences are stored uncompressed, so any part of them can be read */
+s32 DmaMgr_AudioDmaHandler(OSPiHandle* pihandle, OSIoMesg* mb, s32 direction) {
+    (void)pihandle;
+    (void)direction;
+
+    if (nsp_rom_read(mb->devAddr, mb->dramAddr, mb->size) != 0)
+        memset(mb->dramAddr, 0, mb->size);
+    if (mb->hdr.retQueue != NULL)
+        osSendMesg(mb->hdr.retQueue, mb, OS_MESG_NOBLOCK);
+    return 0;
+}
+
+/* Sets the driver up in place of AudioMgr_ThreadEntry, there is no thread to start */
+void AudioMgr_Init(AudioMgr* audioMgr, void* stack, OSPri pri, OSId id, Scheduler* sched, IrqMgr* irqMgr) {
+    (void)stack;
+    (void)pri;
+    (void)id;
+
+    bzero(audioMgr, sizeof(AudioMgr));
+    audioMgr->sched = sched;
+    audioMgr->irqMgr = irqMgr;
+
+    out_rate = CLAMP(configAudioRate, NSP_AUDIO_MIN_RATE, NSP_AUDIO_MAX_RATE);
+    voice_limit = CLAMP(configAudioVoices, 1, NSP_AUDIO_MAX_VOICES);
+    for (s32 i = 0; i < NSP_AUDIO_MAX_NOTES; i++)
+        voices[i].frameIndex = -1;
+
+    Audio_Init();
+    AudioLoad_SetDmaHandler(DmaMgr_AudioDmaHandler);
+    Audio_InitSound();
+    last_update_ms = tmr_ms();
+}
+
+void AudioMgr_Unlock(AudioMgr* audioMgr) {
+    (void)audioMgr;
+}
+
+/* Where the mixed batch goes, the calculator has no speaker */
+void __attribute__((weak)) nsp_audio_output(const s16* samples, u32 numSamples, u32 rate) {
+    (void)samples;
+    (void)numSamples;
+    (void)rate;
+}
+
+/**
+ * Runs the audio driver for the retraces since the last game frame, at most
+ * NSP_AUDIO_MAX_TICKS, and hands their samples to nsp_audio_output in one
+ * batch. Called once per game frame, skipped ones included.
+ */
+void nsp_audio_update(void) {
+    const u32 t0 = tmr_ms();
+    u32 ticks;
+
+    if (!configAudio || out_rate == 0)
+        return;
+
+    ticks = (t0 - last_update_ms) * NSP_AUDIO_RETRACE_HZ / 1000;
+    if (ticks == 0)
+        return;
+    last_update_ms += ticks * 1000 / NSP_AUDIO_RETRACE_HZ;
+    if (ticks > NSP_AUDIO_MAX_TICKS) {
+        /* A long stall, like a scene load: the music stretches out rather than the mixing */
+        ticks = NSP_AUDIO_MAX_TICKS;
+        last_update_ms = t0;
+    }
+
+    batch_len = 0;
+    over_budget = false;
+    for (u32 i = 0; i < ticks; i++) {
+        /* With specUnk4 above 1, only every few ticks synthesize, for all of them */
+        tick_rem += out_rate;
+        pending_len += tick_rem / NSP_AUDIO_RETRACE_HZ;
+        tick_rem %= NSP_AUDIO_RETRACE_HZ;
+
+        AudioThread_Update();
+
+        if (configAudioBudget != 0 && tmr_ms() - t0 > configAudioBudget)
+            over_budget = true;
+    }
+
+    for (u32 i = 0; i < batch_len * 2; i++)
+        out_buf[i] = clamp16(mix_buf[i]);
+    nsp_audio_output(out_buf, batch_len, out_rate);
+
+    /* Drop a voice while over budget, take one back well under it */
+    const u32 elapsed = tmr_ms() - t0;
+    if (configAudioBudget != 0) {
+        if (elapsed > configAudioBudget && voice_limit > NSP_AUDIO_MIN_VOICES) {
+            voice_limit--;
+        } else if (elapsed * 2 < configAudioBudget && voice_limit < MIN(configAudioVoices, NSP_AUDIO_MAX_VOICES)) {
+            voice_limit++;
+        }
+    }
+    prof_frame.time[PROF_AUDIO] += elapsed;
+}
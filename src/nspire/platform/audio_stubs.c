@@ -3,6 +3,7 @@
  *
  * The Nspire has no speaker, so all audio functions are no-ops.
  * These stubs match the function signatures in MM's audio system.
+ * Builds with AUDIO_MIXER=1 use the real audio code and audio_nsp.c instead.
  */
 #include <stdint.h>
 #include <stdbool.h>
@@ -67,6 +68,8 @@ s32 Audio_IsSeqCmdNotQueued(u32 cmd, u32 p) {
 /* Audio processing — called every frame */
 void Audio_Update(void) {
 }
+void nsp_audio_update(void) {
+}
 void Audio_ResetForPool(void) {
 }
 void Audio_PreNMI(void) {
@@ -0,0 +1,259 @@
+/**
+ * flashrom_nsp.c — The save flash, kept in RAM and written to a journal
+ *
+ * Replaces sys_flashrom.c. The game writes whole save slots, 64 or 128
+ * pages of 128 bytes each, and the new cycle saves wait for the write.
+ * Going through stdio to the calculator's flash filesystem, that stalls
+ * the game for a good part of a second, while only a few of the pages
+ * differ from what the slot held before.
+ *
+ * The whole flash lives in RAM. A write compares each page with the copy
+ * there, copies the ones that differ and marks them dirty, and returns
+ * done, so SysFlashrom_WriteSync doesn't wait and reads see the new data
+ * at once. nsp_flashrom_update, called once a frame, appends a few dirty
+ * pages to the journal, each with its page number and a checksum. The
+ * flash image file is only ever written with pages whose newest copy is
+ * already in the journal, a few a frame once no page is dirty, and the
+ * journal is emptied when the image holds all of them. Each frame's step
+ * picks up where the last one stopped, and the image stays open through a
+ * pass over it, so a frame never waits on more than its few pages: the
+ * file system's open and close cost more than the writes themselves.
+ *
+ * Loading reads the image and replays the journal over it, up to the first
+ * record whose checksum fails, which is where a write was cut off. So a
+ * save interrupted by a power loss or a reset leaves the flash as it was
+ * before the pages that didn't make it, and the game's own save checksums
+ * then pick the backup copy of a slot that is half written, as they do
+ * on the N64. A journal left over is folded into the image at load.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sys_flashrom.h"
+#include "PR/os_internal_flash.h"
+
+#if INPUT_REPLAY
+/* From replay_nsp.c */
+extern bool nsp_replay_flash(uint8_t* flash, uint32_t size);
+#endif
+
+#define FLASH_IMAGE_FILENAME "mm-nsp.sav.tns"
+#define FLASH_JOURNAL_FILENAME "mm-nsp.jnl.tns"
+
+#define FLASH_PAGES (FLASH_SIZE / FLASH_BLOCK_SIZE)
+#define FLASH_STEP_PAGES 8      /* written to either file a frame */
+#define FLASH_JOURNAL_MAX 512   /* records before the image takes them over */
+
+typedef struct {
+    uint32_t page;
+    uint32_t check;
+    uint8_t data[FLASH_BLOCK_SIZE];
+} FlashJournalRecord;
+
+static uint8_t sFlash[FLASH_SIZE];
+static uint8_t sDirty[FLASH_PAGES];     /* changed since the journal last got it */
+static uint8_t sJournaled[FLASH_PAGES]; /* newer in the journal than in the image */
+static uint32_t sJournalRecords;
+static uint32_t sJournalPage; /* where the search for dirty pages goes on from */
+static uint32_t sCompactPage; /* where the image writes go on from */
+static FILE* sJournal;
+static FILE* sImage; /* open while a pass writes journaled pages into it */
+static bool sInit;
+
+static uint32_t nsp_flash_check(uint32_t page, const uint8_t* data) {
+    uint32_t hash = (0x811C9DC5 ^ page) * 0x01000193;
+    for (uint32_t i = 0; i < FLASH_BLOCK_SIZE; i++)
+        hash = (hash ^ data[i]) * 0x01000193;
+    /* so that a record of zeroes, as a file cut off after its size was set reads, doesn't pass */
+    return hash ^ 0x5AFE5AFE;
+}
+
+static bool nsp_flash_write_image(void) {
+    FILE* f = fopen(FLASH_IMAGE_FILENAME, "wb");
+    if (f == NULL)
+        return false;
+    const bool ok = fwrite(sFlash, 1, FLASH_SIZE, f) == FLASH_SIZE;
+    return (fclose(f) == 0) && ok;
+}
+
+s32 SysFlashrom_InitFlash(void) {
+    FlashJournalRecord rec;
+    uint32_t replayed = 0;
+    bool haveImage = false;
+    FILE* f;
+
+    if (sInit)
+        return 0;
+
+    /* what the N64 flash holds when it was never written */
+    memset(sFlash, 0xFF, sizeof(sFlash));
+    f = fopen(FLASH_IMAGE_FILENAME, "rb");
+    if (f != NULL) {
+        haveImage = fread(sFlash, 1, FLASH_SIZE, f) == FLASH_SIZE;
+        fclose(f);
+    }
+
+    f = fopen(FLASH_JOURNAL_FILENAME, "rb");
+    if (f != NULL) {
+        while (fread(&rec, sizeof(rec), 1, f) == 1 && rec.page < FLASH_PAGES &&
+               rec.check == nsp_flash_check(rec.page, rec.data)) {
+            memcpy(&sFlash[rec.page * FLASH_BLOCK_SIZE], rec.data, FLASH_BLOCK_SIZE);
+            replayed++;
+        }
+        fclose(f);
+    }
+
+#if INPUT_REPLAY
+    /* a replay starts from the save its recording did, and what it saves never leaves RAM: without
+     * a journal, nsp_flashrom_update and nsp_flashrom_close write nothing */
+    if (nsp_replay_flash(sFlash, FLASH_SIZE)) {
+        memset(sDirty, 0, sizeof(sDirty));
+        memset(sJournaled, 0, sizeof(sJournaled));
+        sInit = true;
+        return 0;
+    }
+#endif
+
+    /* the records past a torn one would be replayed after the ones appended from here, so the
+     * journal starts over, once the image holds what it replayed. The image is written whole here
+     * when there is none yet, later writes to it only go to single pages */
+    if ((replayed != 0 || !haveImage) && !nsp_flash_write_image())
+        return -1;
+    sJournal = fopen(FLASH_JOURNAL_FILENAME, "wb");
+    if (sJournal == NULL)
+        return -1;
+
+    sJournalRecords = 0;
+    sCompactPage = 0;
+    memset(sDirty, 0, sizeof(sDirty));
+    memset(sJournaled, 0, sizeof(sJournaled));
+    sInit = true;
+    return 0;
+}
+
+s32 SysFlashrom_Read(void* addr, u32 pageNum, u32 pageCount) {
+    if (!sInit || pageNum + pageCount > FLASH_PAGES)
+        return -1;
+    memcpy(addr, &sFlash[pageNum * FLASH_BLOCK_SIZE], pageCount * FLASH_BLOCK_SIZE);
+    return 0;
+}
+
+void SysFlashrom_WriteAsync(void* addr, u32 pageNum, u32 pageCount) {
+    const uint8_t* src = addr;
+
+    if (!sInit || pageNum + pageCount > FLASH_PAGES)
+        return;
+
+    for (u32 i = 0; i < pageCount; i++, src += FLASH_BLOCK_SIZE) {
+        uint8_t* page = &sFlash[(pageNum + i) * FLASH_BLOCK_SIZE];
+        if (memcmp(page, src, FLASH_BLOCK_SIZE) != 0) {
+            memcpy(page, src, FLASH_BLOCK_SIZE);
+            sDirty[pageNum + i] = true;
+        }
+    }
+}
+
+/* The write is done as soon as it was issued, as far as the game can tell */
+s32 SysFlashrom_IsBusy(void) {
+    return sInit ? 1 : -1;
+}
+
+s32 SysFlashrom_AwaitResult(void) {
+    return sInit ? 0 : -1;
+}
+
+void SysFlashrom_WriteSync(void* addr, u32 pageNum, u32 pageCount) {
+    SysFlashrom_WriteAsync(addr, pageNum, pageCount);
+}
+
+/* Appends up to max dirty pages to the journal, returns how many */
+static uint32_t nsp_flash_journal_dirty(uint32_t max) {
+    FlashJournalRecord rec;
+    uint32_t written = 0;
+
+    for (uint32_t n = 0; n < FLASH_PAGES && written < max; n++) {
+        const uint32_t page = sJournalPage;
+
+        sJournalPage = (sJournalPage + 1) % FLASH_PAGES;
+        if (!sDirty[page])
+            continue;
+
+        rec.page = page;
+        memcpy(rec.data, &sFlash[page * FLASH_BLOCK_SIZE], FLASH_BLOCK_SIZE);
+        rec.check = nsp_flash_check(page, rec.data);
+        if (fwrite(&rec, sizeof(rec), 1, sJournal) != 1)
+            break;
+        sDirty[page] = false;
+        sJournaled[page] = true;
+        sJournalRecords++;
+        written++;
+    }
+    if (written != 0)
+        fflush(sJournal);
+    return written;
+}
+
+/* Writes up to max journaled pages into the image, and empties the journal once it holds none */
+static void nsp_flash_compact(uint32_t max) {
+    uint32_t written = 0;
+
+    if (sImage == NULL) {
+        sImage = fopen(FLASH_IMAGE_FILENAME, "r+b");
+        if (sImage == NULL)
+            return;
+    }
+
+    for (; sCompactPage < FLASH_PAGES && written < max; sCompactPage++) {
+        if (!sJournaled[sCompactPage])
+            continue;
+        if (fseek(sImage, sCompactPage * FLASH_BLOCK_SIZE, SEEK_SET) != 0 ||
+            fwrite(&sFlash[sCompactPage * FLASH_BLOCK_SIZE], FLASH_BLOCK_SIZE, 1, sImage) != 1)
+            break;
+        sJournaled[sCompactPage] = false;
+        written++;
+    }
+    if (sCompactPage < FLASH_PAGES)
+        return;
+
+    /* the image has to be on the flash before the journal may go */
+    const bool closed = fclose(sImage) == 0;
+    sImage = NULL;
+    if (!closed)
+        return;
+
+    /* pages journaled again behind the pass need another one */
+    sCompactPage = 0;
+    for (uint32_t page = 0; page < FLASH_PAGES; page++) {
+        if (sJournaled[page])
+            return;
+    }
+    fclose(sJournal);
+    sJournal = fopen(FLASH_JOURNAL_FILENAME, "wb");
+    sJournalRecords = 0;
+}
+
+/**
+ * The deferred step of the save writes, called once a frame: journals a few of the pages the
+ * game changed, or moves a few journaled ones into the image once the journal is long
+ */
+void nsp_flashrom_update(void) {
+    if (!sInit || sJournal == NULL)
+        return;
+    if (nsp_flash_journal_dirty(FLASH_STEP_PAGES) == 0 && sJournalRecords >= FLASH_JOURNAL_MAX)
+        nsp_flash_compact(FLASH_STEP_PAGES);
+}
+
+/* Journals every page still dirty, for when the game exits */
+void nsp_flashrom_close(void) {
+    if (!sInit || sJournal == NULL)
+        return;
+    nsp_flash_journal_dirty(FLASH_PAGES);
+    fclose(sJournal);
+    sJournal = NULL;
+    if (sImage != NULL) {
+        fclose(sImage);
+        sImage = NULL;
+    }
+}
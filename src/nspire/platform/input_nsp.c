@@ -3,6 +3,13 @@
  *
  * Maps the Nspire's keyboard/keypad to N64 controller inputs.
  * Uses the same approach as sm64-nsp.
+ *
+ * The game reads the keypad at the top of each update, but an update and
+ * its frame take up to a tenth of a second here, and a tap shorter than
+ * that would fall between two reads. The keypad is also sampled while the
+ * frame is loaded and drawn, and the presses and releases seen in between
+ * are kept until the next update takes them, as the N64's padmgr keeps
+ * the ones of its polls between two game reads.
  */
 #include <stdint.h>
 #include <stdbool.h>
@@ -45,6 +52,22 @@ typedef struct {
 /* Current controller state — read by the game each frame */
 static OSContPad nsp_controller;
 
+/* Buttons pressed and released in the samples since the game last took them */
+static u16 nsp_pressed;
+static u16 nsp_released;
+static u16 nsp_last_button;
+
+#if INPUT_LATENCY
+/* Timer, from nsp_replacements.c */
+extern uint32_t tmr_ms(void);
+
+/* The press being timed: when a sample first saw it, and when an update took it */
+static bool latency_pending;
+static bool latency_taken;
+static uint32_t latency_edge_ms;
+static uint32_t latency_take_ms;
+#endif
+
 /* Default key mappings — Nspire scancodes */
 static struct {
     u32 key;    /* Nspire scancode */
@@ -79,7 +102,7 @@ static struct {
 
 /**
  * Poll the Nspire keypad and update the N64 controller state.
- * Called once per game frame.
+ * Called by each game update, and a few times while a frame is loaded and drawn.
  */
 void input_nsp_poll(void) {
     nsp_controller.button = 0;
@@ -113,7 +136,53 @@ void input_nsp_poll(void) {
     if (nsp_controller.stick_y < -80)
         nsp_controller.stick_y = -80;
 #endif
+
+    nsp_pressed |= nsp_controller.button & ~nsp_last_button;
+    nsp_released |= nsp_last_button & ~nsp_controller.button;
+#if INPUT_LATENCY
+    if (!latency_pending && (nsp_controller.button & ~nsp_last_button) != 0) {
+        latency_pending = true;
+        latency_edge_ms = tmr_ms();
+    }
+#endif
+    nsp_last_button = nsp_controller.button;
+}
+
+/**
+ * Hands the buttons pressed and released since the last call to the game
+ * update reading the pad, taps that came and went between two updates
+ * included.
+ */
+void input_nsp_take_edges(u16* pressed, u16* released) {
+    *pressed = nsp_pressed;
+    *released = nsp_released;
+    nsp_pressed = 0;
+    nsp_released = 0;
+#if INPUT_LATENCY
+    if (latency_pending && !latency_taken && *pressed != 0) {
+        latency_taken = true;
+        latency_take_ms = tmr_ms();
+    }
+#endif
+}
+
+#if INPUT_LATENCY
+/**
+ * Called once a frame is on the LCD. Returns true when it is the first one
+ * drawn from an update that took the timed press, with the ms from the press
+ * to that update and to now.
+ */
+bool input_nsp_latency_frame(uint32_t* to_update, uint32_t* to_frame) {
+    if (!latency_taken)
+        return false;
+
+    *to_update = latency_take_ms - latency_edge_ms;
+    *to_frame = tmr_ms() - latency_edge_ms;
+    latency_pending = false;
+    latency_taken = false;
+    return true;
 }
+#endif
 
 /**
  * Get current controller state.
@@ -0,0 +1,337 @@
+/**
+ * layer_nsp.c — The color buffer of a layer, kept between frames
+ *
+ * Much of a frame is often drawn the same as in the last one. A draw that
+ * knows it may be puts its commands between the G_NSP_LAYER commands: when
+ * the frontend reaches the start of the layer, it hashes the commands up to
+ * its end along with the vertices, matrices and display lists they load. A
+ * layer hashing the same as the one saved here copies the saved color
+ * buffer back, and the frontend skips the vertices, triangles and
+ * rectangles up to its end while it still runs the state changes.
+ * Otherwise the layer is drawn and the color buffer is saved at its end.
+ *
+ * Skybox_Draw puts the sky in a layer, keyed by the loads of its
+ * textures. The frontend also hashes the projection, viewport, scissor and
+ * fill color a layer starts from, so a camera standing still, as it does
+ * through most talks and many cutscenes, gets the sky for one copy.
+ *
+ * What is drawn before a layer goes into the saved color buffer without
+ * being hashed. The clear under the sky only changes with its fill color,
+ * and a saved layer is dropped after every frame that didn't draw it.
+ * There is a slot for each kind of layer, the second one is meant for the
+ * pause menu pages once the kaleido overlay is in the port's build. The
+ * depth buffer isn't saved: nothing drawn after a layer may test against
+ * what the layer drew, and the sky doesn't write it.
+ *
+ * The HUD is drawn over a 3D scene that changes every frame, so its parts
+ * are overlay layers instead, which keep only what they drew. Such a layer
+ * is drawn into a black color buffer, then from the same state again into a
+ * white one: where both are black or white it didn't draw, and elsewhere
+ * the difference between the two is how much of what is under it shows
+ * through, the black one its color already multiplied by its coverage. The
+ * box it drew in is kept as RGBA4444 and drawn over the color buffer while
+ * the layer hashes the same. A part changing every frame, like the beating
+ * heart or the clock's sun, would be drawn twice for nothing, so a layer is
+ * only saved once it hashed the same in two frames in a row, and drawn
+ * straight into the color buffer until then. Nothing drawn in an overlay
+ * layer may use the depth buffer or blend in other ways than over what is
+ * under it, which the HUD's 2D rectangles and quads don't.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gfx_backend.h"
+#include "gfx_frontend.h"
+
+#define LAYER_SLOTS 2
+
+static struct {
+    gfx_pixel_t* pixels;
+    uint32_t width, height; /* of the color buffer it was saved from */
+    uint32_t hash;
+    bool valid;
+    bool used; /* restored or saved in this frame */
+} sLayers[LAYER_SLOTS];
+
+/**
+ * Copies the layer saved with `hash` into the color buffer. Returns false if
+ * no layer, only layers of other commands, or of another resolution are saved.
+ */
+bool nsp_layer_restore(uint32_t hash) {
+    for (uint32_t i = 0; i < LAYER_SLOTS; i++) {
+        if (!sLayers[i].valid || sLayers[i].hash != hash || sLayers[i].width != gfx_current_dimensions.width ||
+            sLayers[i].height != gfx_current_dimensions.height)
+            continue;
+
+        memcpy(gfx_output, sLayers[i].pixels, sLayers[i].width * sLayers[i].height * sizeof(gfx_pixel_t));
+        sLayers[i].used = true;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Saves the color buffer as the layer of the commands that hash to `hash`, in
+ * a slot no other layer of this frame used
+ */
+void nsp_layer_save(uint32_t hash) {
+    const uint32_t width = gfx_current_dimensions.width;
+    const uint32_t height = gfx_current_dimensions.height;
+    uint32_t i = 0;
+
+    while (i < LAYER_SLOTS && sLayers[i].used)
+        i++;
+    if (i == LAYER_SLOTS)
+        return;
+
+    if (sLayers[i].pixels == NULL || sLayers[i].width * sLayers[i].height != width * height) {
+        free(sLayers[i].pixels);
+        sLayers[i].pixels = malloc(width * height * sizeof(gfx_pixel_t));
+        if (sLayers[i].pixels == NULL) {
+            sLayers[i].valid = false;
+            return;
+        }
+    }
+
+    memcpy(sLayers[i].pixels, gfx_output, width * height * sizeof(gfx_pixel_t));
+    sLayers[i].width = width;
+    sLayers[i].height = height;
+    sLayers[i].hash = hash;
+    sLayers[i].valid = true;
+    sLayers[i].used = true;
+}
+
+#if HUD_LAYER_CACHE
+#define OVERLAY_SLOTS 8
+
+static struct {
+    uint16_t* pixels; /* RGBA4444, of the box it drew in, the color multiplied by the alpha */
+    uint32_t capacity; /* pixels it has room for */
+    uint32_t x, y, w, h;
+    uint32_t width, height; /* of the color buffer it was saved from */
+    uint32_t hash;
+    uint32_t lastHash; /* what it hashed to in the last frame, saved or not */
+    bool valid;
+    bool used; /* drawn in this frame */
+    bool usedLast;
+} sOverlays[OVERLAY_SLOTS];
+
+/* Where a layer being saved is drawn, black and white */
+static gfx_pixel_t* sOverlayBackgrounds[2];
+static uint32_t sOverlayBackgroundsSize;
+static bool sOverlayBackgroundsUsed;
+
+static inline void nsp_overlay_unpack(gfx_pixel_t p, uint32_t* r, uint32_t* g, uint32_t* b) {
+#if OUTPUT_RGB565
+    *r = (p >> 11) << 3 | p >> 13;
+    *g = ((p >> 5) & 0x3F) << 2 | ((p >> 9) & 3);
+    *b = (p & 0x1F) << 3 | ((p >> 2) & 7);
+#else
+    *r = p & 0xFF;
+    *g = (p >> 8) & 0xFF;
+    *b = (p >> 16) & 0xFF;
+#endif
+}
+
+static inline gfx_pixel_t nsp_overlay_pack(uint32_t r, uint32_t g, uint32_t b, gfx_pixel_t under) {
+#if OUTPUT_RGB565
+    (void)under;
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+#else
+    return (under & 0xFF000000) | b << 16 | g << 8 | r;
+#endif
+}
+
+/* The RGBA4444 a pixel drawn as `black` over black and as `white` over white comes to, 0 where nothing was drawn */
+static inline uint16_t nsp_overlay_matte(gfx_pixel_t black, gfx_pixel_t white) {
+    uint32_t r, g, b, wr, wg, wb;
+    int32_t through;
+
+    if (black == 0 && white == (gfx_pixel_t)~0)
+        return 0;
+
+    nsp_overlay_unpack(black, &r, &g, &b);
+    nsp_overlay_unpack(white, &wr, &wg, &wb);
+    through = ((int32_t)(wr - r) + (int32_t)(wg - g) + (int32_t)(wb - b)) / 3;
+    if (through < 0)
+        through = 0;
+
+    return ((r * 15 + 127) / 255) << 12 | ((g * 15 + 127) / 255) << 8 | ((b * 15 + 127) / 255) << 4 |
+           ((255 - through) * 15 + 127) / 255;
+}
+
+/* Draws a saved box of RGBA4444 over the color buffer */
+static void nsp_overlay_draw(const uint16_t* src, uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+    const uint32_t width = gfx_current_dimensions.width;
+
+    for (uint32_t j = 0; j < h; j++) {
+        gfx_pixel_t* out = gfx_output + (y + j) * width + x;
+
+        for (uint32_t i = 0; i < w; i++, src++, out++) {
+            const uint32_t a = *src & 0xF;
+            uint32_t r = (*src >> 12) * 0x11, g = ((*src >> 8) & 0xF) * 0x11, b = ((*src >> 4) & 0xF) * 0x11;
+            uint32_t ur, ug, ub;
+
+            if (*src == 0)
+                continue;
+            if (a != 15) {
+                /* what is under it times 1 - a / 15 */
+                nsp_overlay_unpack(*out, &ur, &ug, &ub);
+                r += (ur * (15 - a) * 0x11 + 0x80) >> 8;
+                g += (ug * (15 - a) * 0x11 + 0x80) >> 8;
+                b += (ub * (15 - a) * 0x11 + 0x80) >> 8;
+                r = r > 0xFF ? 0xFF : r;
+                g = g > 0xFF ? 0xFF : g;
+                b = b > 0xFF ? 0xFF : b;
+            }
+            *out = nsp_overlay_pack(r, g, b, *out);
+        }
+    }
+}
+
+/**
+ * Draws the overlay layer `id` saved with `hash` over the color buffer. Returns false if it was
+ * saved with another hash or resolution, or not at all, and then sets `save` if the layer hashed
+ * the same in the last frame, so that it should be saved this time.
+ */
+bool nsp_overlay_restore(uint32_t id, uint32_t hash, bool* save) {
+    *save = false;
+    if (id >= OVERLAY_SLOTS)
+        return false;
+
+    sOverlays[id].used = true;
+    if (sOverlays[id].valid && sOverlays[id].hash == hash && sOverlays[id].width == gfx_current_dimensions.width &&
+        sOverlays[id].height == gfx_current_dimensions.height) {
+        nsp_overlay_draw(sOverlays[id].pixels, sOverlays[id].x, sOverlays[id].y, sOverlays[id].w, sOverlays[id].h);
+        return true;
+    }
+
+    *save = sOverlays[id].usedLast && sOverlays[id].lastHash == hash;
+    sOverlays[id].lastHash = hash;
+    return false;
+}
+
+/* The color buffers a layer being saved is drawn into, cleared to black and white */
+bool nsp_overlay_backgrounds(gfx_pixel_t** black, gfx_pixel_t** white) {
+    const uint32_t size = gfx_current_dimensions.width * gfx_current_dimensions.height * sizeof(gfx_pixel_t);
+
+    if (sOverlayBackgroundsSize != size) {
+        free(sOverlayBackgrounds[0]);
+        free(sOverlayBackgrounds[1]);
+        sOverlayBackgrounds[0] = malloc(size);
+        sOverlayBackgrounds[1] = malloc(size);
+        sOverlayBackgroundsSize = size;
+        if (sOverlayBackgrounds[0] == NULL || sOverlayBackgrounds[1] == NULL) {
+            free(sOverlayBackgrounds[0]);
+            free(sOverlayBackgrounds[1]);
+            sOverlayBackgrounds[0] = sOverlayBackgrounds[1] = NULL;
+            sOverlayBackgroundsSize = 0;
+            return false;
+        }
+    }
+
+    memset(sOverlayBackgrounds[0], 0x00, size);
+    memset(sOverlayBackgrounds[1], 0xFF, size);
+    sOverlayBackgroundsUsed = true;
+    *black = sOverlayBackgrounds[0];
+    *white = sOverlayBackgrounds[1];
+    return true;
+}
+
+/**
+ * Saves what the overlay layer `id` drew into the backgrounds as the layer of the commands that hash to
+ * `hash`, and draws it over the color buffer
+ */
+void nsp_overlay_save(uint32_t id, uint32_t hash) {
+    const uint32_t width = gfx_current_dimensions.width;
+    const uint32_t height = gfx_current_dimensions.height;
+    const gfx_pixel_t* black = sOverlayBackgrounds[0];
+    const gfx_pixel_t* white = sOverlayBackgrounds[1];
+    uint32_t x0 = width, y0 = height, x1 = 0, y1 = 0;
+    uint16_t* pixels;
+    uint32_t size;
+
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            if (black[y * width + x] != 0 || white[y * width + x] != (gfx_pixel_t)~0) {
+                x0 = x < x0 ? x : x0;
+                x1 = x >= x1 ? x + 1 : x1;
+                y0 = y < y0 ? y : y0;
+                y1 = y + 1;
+            }
+        }
+    }
+    if (x0 >= x1) {
+        x0 = y0 = x1 = y1 = 0;
+    }
+
+    size = (x1 - x0) * (y1 - y0);
+    if (size > sOverlays[id].capacity) {
+        free(sOverlays[id].pixels);
+        sOverlays[id].pixels = malloc(size * sizeof(uint16_t));
+        sOverlays[id].capacity = sOverlays[id].pixels != NULL ? size : 0;
+        if (sOverlays[id].pixels == NULL) {
+            /* drawn without being saved */
+            sOverlays[id].valid = false;
+            for (uint32_t y = y0; y < y1; y++) {
+                for (uint32_t x = x0; x < x1; x++) {
+                    const uint16_t matte = nsp_overlay_matte(black[y * width + x], white[y * width + x]);
+                    nsp_overlay_draw(&matte, x, y, 1, 1);
+                }
+            }
+            return;
+        }
+    }
+
+    pixels = sOverlays[id].pixels;
+
+    for (uint32_t y = y0; y < y1; y++) {
+        for (uint32_t x = x0; x < x1; x++)
+            *pixels++ = nsp_overlay_matte(black[y * width + x], white[y * width + x]);
+    }
+
+    sOverlays[id].x = x0;
+    sOverlays[id].y = y0;
+    sOverlays[id].w = x1 - x0;
+    sOverlays[id].h = y1 - y0;
+    sOverlays[id].width = width;
+    sOverlays[id].height = height;
+    sOverlays[id].hash = hash;
+    sOverlays[id].valid = true;
+    nsp_overlay_draw(sOverlays[id].pixels, x0, y0, x1 - x0, y1 - y0);
+}
+#endif
+
+/* Forgets the layers this frame didn't draw and frees their pixels */
+void nsp_layer_end_frame(void) {
+    for (uint32_t i = 0; i < LAYER_SLOTS; i++) {
+        if (!sLayers[i].used && sLayers[i].pixels != NULL) {
+            free(sLayers[i].pixels);
+            sLayers[i].pixels = NULL;
+            sLayers[i].valid = false;
+        }
+        sLayers[i].used = false;
+    }
+#if HUD_LAYER_CACHE
+    for (uint32_t i = 0; i < OVERLAY_SLOTS; i++) {
+        if (!sOverlays[i].used) {
+            free(sOverlays[i].pixels);
+            sOverlays[i].pixels = NULL;
+            sOverlays[i].capacity = 0;
+            sOverlays[i].valid = false;
+        }
+        sOverlays[i].usedLast = sOverlays[i].used;
+        sOverlays[i].used = false;
+    }
+    /* the backgrounds are only kept while the HUD changes */
+    if (!sOverlayBackgroundsUsed && sOverlayBackgrounds[0] != NULL) {
+        free(sOverlayBackgrounds[0]);
+        free(sOverlayBackgrounds[1]);
+        sOverlayBackgrounds[0] = sOverlayBackgrounds[1] = NULL;
+        sOverlayBackgroundsSize = 0;
+    }
+    sOverlayBackgroundsUsed = false;
+#endif
+}
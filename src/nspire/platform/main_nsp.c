@@ -25,15 +25,19 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 /* ============================================================
  * Forward declarations for the rendering backend (from sm64-nsp)
  * ============================================================ */
 
-/* Nspire LCD + renderer */
-extern void nsp_init(const char* name, bool fullscreen);
-extern void nsp_swap_buffers_begin(void);
-extern void nsp_swap_buffers_end(void);
+/* Frontend, which walks the display lists, over the Nspire LCD and the software renderer */
+struct GfxWindowManagerAPI;
+struct GfxRenderingAPI;
+extern struct GfxWindowManagerAPI gfx_nsp_api;
+extern struct GfxRenderingAPI gfx_soft_api;
+extern void gfx_init(struct GfxWindowManagerAPI* wapi, struct GfxRenderingAPI* rapi, const char* game_name,
+                     bool start_in_fullscreen);
 
 /* Input */
 extern void input_nsp_poll(void);
@@ -43,17 +47,26 @@ extern bool input_nsp_escape_pressed(void);
 extern void configfile_load(const char* filename);
 extern void configfile_save(const char* filename);
 
-/* Timer */
-#ifdef TARGET_NSP
+/* Profiling */
+extern void profiling_close(void);
+
+/* Asset pack */
+extern int nsp_pack_init(const char* path);
+extern void nsp_pack_close(void);
+extern void nsp_pack_patch(uint32_t vrom, void* dest, uint32_t size);
+
+/* Display list cache */
+extern void gfx_dl_cache_add_static(const void* start, uint32_t size);
+
+/* Sine table, see trig_nsp.c */
+#if TRIG_TABLE
+extern void Math_InitTrigTable(void);
+#endif
+
+/* Timer, from nsp_replacements.c, which reads the host's clock in the host build */
 extern void tmr_init(void);
+extern void tmr_deinit(void);
 extern uint32_t tmr_ms(void);
-#else
-static inline void tmr_init(void) {
-}
-static inline uint32_t tmr_ms(void) {
-    return 0;
-}
-#endif
 
 /* ============================================================
  * Globals that MM's code expects to exist
@@ -64,178 +77,228 @@ static inline uint32_t tmr_ms(void) {
 /* Display list master — MM generates display lists into this */
 /* These are defined as externs in MM code; we provide the storage */
 
-/* Frame timing */
-static uint32_t nsp_frame_count = 0;
-static uint32_t nsp_last_fps_time = 0;
-uint32_t nsp_current_fps = 0;
-
-static void nsp_update_fps(void) {
-    nsp_frame_count++;
-    uint32_t now = tmr_ms();
-    if (now - nsp_last_fps_time >= 1000) {
-        nsp_current_fps = nsp_frame_count;
-        nsp_frame_count = 0;
-        nsp_last_fps_time = now;
-    }
-}
+/* Frame timing and the FPS count live in profiling.c, fed by
+ * Graph_TaskSet00_Nsp at the end of each frame */
 
 /* ============================================================
- * Display List Processing
+ * ROM File-Based Asset Loading
  *
- * This is the heart of the port. When MM calls Graph_TaskSet00(),
- * instead of sending the display list to the N64 RCP, we walk it
- * and route each command to sm64-nsp's software renderer.
+ * MM loads assets from the N64 ROM cartridge via DMA (PI interface).
+ * On the Nspire, we read from a ROM file on the filesystem. Both the
+ * decompressed ROM and the retail one, whose files are Yaz0 compressed,
+ * work: the ROM's DMA table translates VROM to ROM offsets like
+ * DmaMgr_ProcessRequest does.
  * ============================================================ */
 
-/* Segment table for segmented addressing */
-static uintptr_t nsp_segments[16];
+/* From yaz0_nsp.c */
+extern int nsp_yaz0_decompress(uint32_t rom_start, uint32_t rom_size, void* dest, uint32_t dest_size);
 
-void nsp_set_segment(uint32_t seg, void* addr) {
-    nsp_segments[seg & 0xF] = (uintptr_t)addr;
+static FILE* rom_file = NULL;
+static uint32_t rom_file_pos = 0; /* where the next fread starts, to skip redundant seeks */
+
+/*
+ * Block cache in front of the ROM file.
+ *
+ * Scene and room loads issue hundreds of small DMAs, mostly close to each
+ * other, and every fseek + fread on the flash filesystem is slow. Small reads
+ * go through 16KB blocks kept with LRU replacement, so a burst of them costs
+ * one fread per block. Reads of whole blocks bypass the cache and go straight
+ * into the destination, in one fread, so big segments don't evict everything.
+ */
+#define ROM_BLOCK_SHIFT 14
+#define ROM_BLOCK_SIZE (1 << ROM_BLOCK_SHIFT)
+#define ROM_CACHE_BLOCKS 32 /* 512KB */
+#define ROM_BLOCK_NONE 0xFFFFFFFF
+
+typedef struct {
+    uint32_t block;    /* ROM offset >> ROM_BLOCK_SHIFT, or ROM_BLOCK_NONE */
+    uint32_t size;     /* bytes read, less than a block at the end of the ROM */
+    uint32_t last_use; /* rom_cache_clock when it was last hit */
+} RomCacheBlock;
+
+static RomCacheBlock rom_cache[ROM_CACHE_BLOCKS];
+static uint8_t rom_cache_data[ROM_CACHE_BLOCKS][ROM_BLOCK_SIZE];
+static uint32_t rom_cache_clock = 0;
+
+static uint32_t rom_file_read(uint32_t rom_addr, void* dest, uint32_t size) {
+    if (rom_file_pos != rom_addr) {
+        if (fseek(rom_file, rom_addr, SEEK_SET) != 0) {
+            rom_file_pos = ROM_BLOCK_NONE;
+            return 0;
+        }
+    }
+    size_t read = fread(dest, 1, size, rom_file);
+    rom_file_pos = rom_addr + read;
+    return read;
 }
 
-void* nsp_segmented_to_virtual(uint32_t addr) {
-    uint32_t seg = (addr >> 24) & 0xF;
-    uint32_t offset = addr & 0x00FFFFFF;
-    if (nsp_segments[seg] == 0)
-        return (void*)(uintptr_t)offset;
-    return (void*)(nsp_segments[seg] + offset);
+/* Returns the cached block, reading it in place of the least recently used one on a miss */
+static RomCacheBlock* rom_cache_get(uint32_t block) {
+    RomCacheBlock* victim = &rom_cache[0];
+
+    rom_cache_clock++;
+    for (int i = 0; i < ROM_CACHE_BLOCKS; i++) {
+        RomCacheBlock* b = &rom_cache[i];
+        if (b->block == block) {
+            b->last_use = rom_cache_clock;
+            return b;
+        }
+        if (b->last_use < victim->last_use)
+            victim = b;
+    }
+
+    victim->size = rom_file_read(block << ROM_BLOCK_SHIFT, rom_cache_data[victim - rom_cache], ROM_BLOCK_SIZE);
+    if (victim->size == 0) {
+        victim->block = ROM_BLOCK_NONE;
+        victim->last_use = 0;
+        return NULL;
+    }
+    victim->block = block;
+    victim->last_use = rom_cache_clock;
+    return victim;
 }
 
 /**
- * Walk a display list and dispatch commands to the software renderer.
+ * Read data from the ROM file at a physical ROM offset.
+ * Replaces N64 PI DMA transfers (osPiStartDma).
  *
- * This is called from our replacement Graph_TaskSet00.
- * The display list pointer comes from gGfxMasterDL->taskStart,
- * which is where Graph_ExecuteAndDraw builds the master display list.
+ * @param rom_addr  Offset into the ROM file
+ * @param dest      RAM destination buffer
+ * @param size      Number of bytes to read
+ * @return          0 on success, -1 on failure
  */
-#define DL_STACK_SIZE 16
-static Gfx* dl_stack[DL_STACK_SIZE];
-static int dl_stack_top = 0;
+int nsp_rom_read_raw(uint32_t rom_addr, void* dest, uint32_t size) {
+    uint8_t* out = dest;
 
-static void dl_push(Gfx* dl) {
-    if (dl_stack_top < DL_STACK_SIZE) {
-        dl_stack[dl_stack_top++] = dl;
-    }
-}
+    if (!rom_file)
+        return -1;
+
+    while (size > 0) {
+        uint32_t offset = rom_addr & (ROM_BLOCK_SIZE - 1);
+        uint32_t n;
+
+        if (offset == 0 && size >= ROM_BLOCK_SIZE) {
+            /* Whole blocks: one read straight into the destination */
+            n = size & ~(ROM_BLOCK_SIZE - 1);
+            if (rom_file_read(rom_addr, out, n) != n)
+                return -1;
+        } else {
+            RomCacheBlock* b = rom_cache_get(rom_addr >> ROM_BLOCK_SHIFT);
+            if (b == NULL || offset >= b->size)
+                return -1;
+            n = b->size - offset;
+            if (n > size)
+                n = size;
+            memcpy(out, rom_cache_data[b - rom_cache] + offset, n);
+        }
 
-static Gfx* dl_pop(void) {
-    if (dl_stack_top > 0) {
-        return dl_stack[--dl_stack_top];
+        rom_addr += n;
+        out += n;
+        size -= n;
     }
-    return NULL;
+    return 0;
 }
 
-void nsp_process_display_list(Gfx* dl) {
-    if (!dl)
-        return;
-
-    dl_stack_top = 0;
-
-    while (1) {
-        uint32_t w0 = dl->w0;
-        uint32_t w1 = dl->w1;
-        uint8_t cmd = (w0 >> 24) & 0xFF;
-
-        switch (cmd) {
-            case G_ENDDL: {
-                /* End of this display list — pop the stack */
-                Gfx* parent = dl_pop();
-                if (parent) {
-                    dl = parent;
-                    continue;
-                }
-                return; /* No more parent DLs, we're done */
-            }
+/*
+ * The ROM's DMA table (dmadata), converted to host byte order. Laid out like
+ * MM's DmaEntry: a romEnd of 0 means the file is stored uncompressed.
+ */
+typedef struct {
+    uint32_t vromStart;
+    uint32_t vromEnd;
+    uint32_t romStart;
+    uint32_t romEnd;
+} NspDmaEntry;
 
-            case G_DL: {
-                /* Call or branch to child display list */
-                Gfx* child = (Gfx*)(uintptr_t)w1;
-                if (child) {
-                    bool is_branch = (w0 & 0x00FF0000) == 0x00010000;
-                    if (!is_branch) {
-                        /* Call: push return address */
-                        dl_push(dl + 1);
-                    }
-                    dl = child;
-                    continue;
-                }
-                break;
-            }
+#define ROM_DMADATA_SEARCH_END 0x100000 /* dmadata sits right after the boot code */
 
-            case G_MOVEMEM: {
-                /* Handle segment setting */
-                uint8_t index = (w0 >> 8) & 0xFF;
-                uint8_t offset = (w0 >> 0) & 0xFF;
-                /* Check if this is a segment command (MW_SEGMENT) */
-                if (index == G_MW_SEGMENT) {
-                    uint32_t seg_id = offset / 4;
-                    nsp_set_segment(seg_id, (void*)(uintptr_t)w1);
-                }
-                break;
-            }
+static NspDmaEntry* rom_dma_table = NULL; /* NULL: the ROM file is addressed by VROM directly */
+static uint32_t rom_dma_count = 0;
 
-            /* All graphics commands passed through to the software renderer.
-             * The sm64-nsp gfx_frontend already handles all of these GBI
-             * commands via its own display list interpreter.
-             *
-             * TODO: Route these to gfx_run_dl() once the frontend is
-             * hooked up. For now, the game state machinery runs but
-             * rendering is a no-op until the frontend glue is complete. */
-            case G_VTX:
-            case G_TRI1:
-            case G_TRI2:
-            case G_MTX:
-            case G_POPMTX:
-            case G_GEOMETRYMODE:
-            case G_TEXTURE:
-            case G_SETCOMBINE:
-            case G_SETTIMG:
-            case G_SETTILE:
-            case G_SETTILESIZE:
-            case G_LOADBLOCK:
-            case G_LOADTILE:
-            case G_LOADTLUT:
-            case G_SETSCISSOR:
-            case G_SETENVCOLOR:
-            case G_SETPRIMCOLOR:
-            case G_SETFOGCOLOR:
-            case G_SETFILLCOLOR:
-            case G_FILLRECT:
-            case G_SETCIMG:
-            case G_SETZIMG:
-            case G_RDPSETOTHERMODE:
-            case G_SETOTHERMODE_L:
-            case G_SETOTHERMODE_H:
-            case G_TEXRECT:
-                /* These would go to the software renderer */
-                break;
-
-            case G_RDPPIPESYNC:
-            case G_RDPTILESYNC:
-            case G_RDPLOADSYNC:
-            case G_RDPFULLSYNC:
-            case G_SPNOOP:
-            case G_NOOP:
-                /* Sync/NOP — no-ops for software renderer */
-                break;
-
-            default:
-                break;
+static uint32_t rom_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void rom_be_entry(NspDmaEntry* e, const uint8_t* p) {
+    e->vromStart = rom_be32(p + 0x0);
+    e->vromEnd = rom_be32(p + 0x4);
+    e->romStart = rom_be32(p + 0x8);
+    e->romEnd = rom_be32(p + 0xC);
+}
+
+/*
+ * Finds dmadata by its first two entries, the makerom header at 0-0x1060 and
+ * the boot segment right after it, and loads it up to the terminating entry.
+ * Returns the number of entries, or 0 if there is no table to be found.
+ */
+static uint32_t rom_load_dma_table(void) {
+    uint8_t raw[0x20];
+    NspDmaEntry first, second;
+    uint32_t table = 0;
+
+    for (uint32_t addr = 0x1060; addr < ROM_DMADATA_SEARCH_END; addr += 0x10) {
+        if (nsp_rom_read_raw(addr, raw, sizeof(raw)) != 0)
+            return 0;
+        rom_be_entry(&first, raw);
+        rom_be_entry(&second, raw + 0x10);
+        if (first.vromStart == 0 && first.vromEnd == 0x1060 && first.romStart == 0 && first.romEnd == 0 &&
+            second.vromStart == 0x1060) {
+            table = addr;
+            break;
         }
+    }
+    if (table == 0)
+        return 0;
+
+    uint32_t count = 0;
+    do {
+        if (nsp_rom_read_raw(table + count * 0x10, raw, 0x10) != 0)
+            return 0;
+        count++;
+    } while (rom_be32(raw + 0x4) != 0);
+    count--;
+
+    rom_dma_table = malloc(count * sizeof(NspDmaEntry));
+    if (rom_dma_table == NULL)
+        return 0;
+    for (uint32_t i = 0; i < count; i++) {
+        nsp_rom_read_raw(table + i * 0x10, raw, 0x10);
+        rom_be_entry(&rom_dma_table[i], raw);
+    }
+    return count;
+}
 
-        dl++;
+/* Replacement for DmaMgr_FindDmaEntry, the entries are sorted by VROM */
+NspDmaEntry* nsp_rom_find_entry(uint32_t vrom) {
+    uint32_t lo = 0;
+    uint32_t hi = rom_dma_count;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (vrom < rom_dma_table[mid].vromStart) {
+            hi = mid;
+        } else if (vrom >= rom_dma_table[mid].vromEnd) {
+            lo = mid + 1;
+        } else {
+            return &rom_dma_table[mid];
+        }
     }
+    return NULL;
 }
 
-/* ============================================================
- * ROM File-Based Asset Loading
- *
- * MM loads assets from the N64 ROM cartridge via DMA (PI interface).
- * On the Nspire, we read from a ROM file on the filesystem.
- * ============================================================ */
+/* Replacement for DmaMgr_TranslateVromToRom */
+int32_t nsp_rom_translate(uint32_t vrom) {
+    if (rom_dma_table == NULL)
+        return vrom;
 
-static FILE* rom_file = NULL;
+    NspDmaEntry* e = nsp_rom_find_entry(vrom);
+    if (e == NULL)
+        return -1;
+    if (e->romEnd == 0)
+        return vrom + e->romStart - e->vromStart;
+    /* Compressed files only have a ROM address as a whole */
+    return (vrom == e->vromStart) ? (int32_t)e->romStart : -1;
+}
 
 /**
  * Open the ROM file for asset reading.
@@ -243,7 +306,22 @@ static FILE* rom_file = NULL;
  */
 int nsp_rom_init(const char* rom_path) {
     rom_file = fopen(rom_path, "rb");
-    return (rom_file != NULL) ? 0 : -1;
+    rom_file_pos = 0;
+    for (int i = 0; i < ROM_CACHE_BLOCKS; i++) {
+        rom_cache[i].block = ROM_BLOCK_NONE;
+        rom_cache[i].last_use = 0;
+    }
+    if (rom_file == NULL)
+        return -1;
+
+    rom_dma_count = rom_load_dma_table();
+    if (rom_dma_count == 0) {
+        /* Without a table, VROM offsets point into the file as they are,
+         * which is all a decompressed ROM needs */
+        free(rom_dma_table);
+        rom_dma_table = NULL;
+    }
+    return 0;
 }
 
 void nsp_rom_close(void) {
@@ -251,23 +329,63 @@ void nsp_rom_close(void) {
         fclose(rom_file);
         rom_file = NULL;
     }
+    free(rom_dma_table);
+    rom_dma_table = NULL;
+    rom_dma_count = 0;
 }
 
 /**
- * Read data from the ROM file.
- * Replaces N64 PI DMA transfers (osPiStartDma).
+ * Read data from the ROM at a VROM address, like DmaMgr_ProcessRequest.
+ * Uncompressed files can be read in part, compressed ones only as a whole,
+ * and a read may cover several files in a row, as merged DMAs do. What
+ * the asset pack has converted already is then put over what was read.
  *
- * @param rom_addr  Offset into the ROM (the "VROM" address)
+ * @param vrom      VROM address of the data
  * @param dest      RAM destination buffer
  * @param size      Number of bytes to read
  * @return          0 on success, -1 on failure
  */
-int nsp_rom_read(uint32_t rom_addr, void* dest, uint32_t size) {
-    if (!rom_file)
-        return -1;
-    fseek(rom_file, rom_addr, SEEK_SET);
-    size_t read = fread(dest, 1, size, rom_file);
-    return (read == size) ? 0 : -1;
+int nsp_rom_read(uint32_t vrom, void* dest, uint32_t size) {
+    const uint32_t start = vrom;
+    const uint32_t total = size;
+    uint8_t* out = dest;
+
+    if (rom_dma_table == NULL) {
+        if (nsp_rom_read_raw(vrom, dest, size) != 0)
+            return -1;
+        nsp_pack_patch(vrom, dest, size);
+        gfx_dl_cache_add_static(dest, size);
+        return 0;
+    }
+
+    while (size > 0) {
+        NspDmaEntry* e = nsp_rom_find_entry(vrom);
+        if (e == NULL)
+            return -1;
+
+        uint32_t n = e->vromEnd - vrom;
+        if (n > size)
+            n = size;
+
+        if (e->romEnd == 0) {
+            if (nsp_rom_read_raw(e->romStart + (vrom - e->vromStart), out, n) != 0)
+                return -1;
+        } else {
+            if (vrom != e->vromStart || n != e->vromEnd - e->vromStart) {
+                printf("Read of part of compressed file 0x%08X\n", (unsigned)e->vromStart);
+                return -1;
+            }
+            if (nsp_yaz0_decompress(e->romStart, e->romEnd - e->romStart, out, n) != 0)
+                return -1;
+        }
+
+        vrom += n;
+        out += n;
+        size -= n;
+    }
+    nsp_pack_patch(start, dest, total);
+    gfx_dl_cache_add_static(dest, total);
+    return 0;
 }
 
 /* ============================================================
@@ -328,13 +446,73 @@ extern void Graph_ThreadEntry(void* arg);
 extern void SysCfb_Init(void);
 extern void Fault_Init(void);
 
+#if GFXPOOL_SIZING
+/* From nsp_replacements.c */
+extern void nsp_gfx_pool_configure(void);
+extern void nsp_gfx_pool_fit(void);
+#endif
+
+#if FLASH_JOURNAL
+/* From flashrom_nsp.c */
+extern void nsp_flashrom_close(void);
+#endif
+
+#if INPUT_REPLAY
+/* From replay_nsp.c */
+extern void nsp_replay_init(void);
+extern void nsp_replay_close(void);
+#endif
+
+#if OVERLAY_PAGING
+/* From overlay_nsp.c */
+extern void nsp_overlay_init(void);
+#endif
+
+/* Everything after the game returns, the files are closed and the config saved */
+static void nsp_shutdown(void) {
+#if GFXPOOL_SIZING
+    nsp_gfx_pool_fit();
+#endif
+#if FLASH_JOURNAL
+    nsp_flashrom_close();
+#endif
+#if INPUT_REPLAY
+    nsp_replay_close();
+#endif
+    nsp_pack_close();
+    nsp_rom_close();
+    profiling_close();
+    configfile_save("mm-nsp.cfg");
+
+#ifdef TARGET_NSP
+    lcd_init(SCR_320x240_565); /* Reset LCD */
+#endif
+    tmr_deinit();
+}
+
+/**
+ * Ends the run from inside the game loop, which never returns by itself
+ * on the title screen or in gameplay. A replay ends here when its
+ * recording runs out.
+ */
+void nsp_exit(void) {
+    nsp_shutdown();
+    exit(0);
+}
+
 int main(void) {
     /* Initialize config */
     configfile_load("mm-nsp.cfg");
+#if INPUT_REPLAY
+    nsp_replay_init();
+#endif
 
-    /* Initialize Nspire LCD */
-    nsp_init("Majora's Mask", false);
+    /* Initialize Nspire LCD and the renderer */
+    gfx_init(&gfx_nsp_api, &gfx_soft_api, "Majora's Mask", false);
     tmr_init();
+#if TRIG_TABLE
+    Math_InitTrigTable();
+#endif
 
     /* Open ROM file for asset loading */
     if (nsp_rom_init("mm-us.z64") != 0) {
@@ -343,9 +521,16 @@ int main(void) {
         /* Show error on Nspire screen */
         /* TODO: nio_printf error */
 #endif
+        tmr_deinit();
         return 1;
     }
 
+    /* Textures, vertices and matrices converted ahead of time, the game runs without them */
+    nsp_pack_init("mm-us.pak.tns");
+#if OVERLAY_PAGING
+    nsp_overlay_init();
+#endif
+
     /*
      * Call MM's Graph_ThreadEntry directly.
      *
@@ -363,15 +548,11 @@ int main(void) {
      * - All audio functions: stubbed to no-ops
      * - Overlay loading: replaced with static linking
      */
-    Graph_ThreadEntry(NULL);
-
-    /* Cleanup */
-    nsp_rom_close();
-    configfile_save("mm-nsp.cfg");
-
-#ifdef TARGET_NSP
-    lcd_init(SCR_320x240_565); /* Reset LCD */
+#if GFXPOOL_SIZING
+    nsp_gfx_pool_configure();
 #endif
+    Graph_ThreadEntry(NULL);
 
+    nsp_shutdown();
     return 0;
 }
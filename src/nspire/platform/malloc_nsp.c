@@ -0,0 +1,398 @@
+/**
+ * malloc_nsp.c — Arena allocator with segregated free lists
+ *
+ * Replaces src/boot/libc64/__osMalloc.c, which backs ZeldaArena and the
+ * other arenas. That one finds a block by walking every block of the arena
+ * from the head, so with the actor and effect churn of a busy scene each
+ * allocation walks a long list.
+ *
+ * The blocks keep the original layout: an ArenaNode header in front of
+ * the data, 16 byte aligned, chained in address order through next and
+ * prev, which is what __osFree merges with and __osCheckArena walks. On
+ * top of that, every free block is in the bin of its size class, linked
+ * through its first 8 data bytes:
+ * - bins 0-31 hold exactly 16, 32 ... 512 bytes, so a small allocation
+ *   takes the head of its bin, or of the next bin that isn't empty
+ * - the bins above hold one power of two each, searched first fit in the
+ *   bin of the request and taken from the head in the bigger ones
+ * Arena.binMask keeps the bins that aren't empty, so the search never
+ * visits an empty one. Data sizes start at 16 bytes, so any free block has
+ * room for its links.
+ *
+ * Allocations land at different addresses than with the first fit walk,
+ * __osMallocR still carves its blocks from the end of the one it finds.
+ * __osGetSizes reports from running totals instead of walking the arena.
+ * The port is single threaded, so there is no arena lock.
+ */
+#include "libc64/os_malloc.h"
+
+#include "alignment.h"
+#include "stdbool.h"
+#include "stdint.h"
+#include "string.h"
+
+#include "nspire/profiling.h"
+
+#define NODE_MAGIC (0x7373)
+#define MIN_BLOCK_SIZE 16
+
+typedef struct {
+    ArenaNode* next;
+    ArenaNode* prev;
+} ArenaFreeLink;
+
+#define FREE_LINK(node) ((ArenaFreeLink*) ((uintptr_t) (node) + sizeof(ArenaNode)))
+#define NODE_END(node) ((uintptr_t) (node) + sizeof(ArenaNode) + (node)->size)
+
+/* ============================================================
+ * Bins
+ * ============================================================ */
+
+static s32 ArenaImpl_BinIndex(size_t size) {
+    if (size <= ARENA_SMALL_BINS * 16) {
+        return (size >> 4) - 1;
+    }
+    /* 528-1023 is the first big bin */
+    return ARENA_SMALL_BINS + (31 - __builtin_clz(size)) - 9;
+}
+
+static void ArenaImpl_BinInsert(Arena* arena, ArenaNode* node) {
+    s32 bin = ArenaImpl_BinIndex(node->size);
+    ArenaFreeLink* link = FREE_LINK(node);
+
+    link->prev = NULL;
+    link->next = arena->bins[bin];
+    if (link->next != NULL) {
+        FREE_LINK(link->next)->prev = node;
+    }
+    arena->bins[bin] = node;
+    arena->binMask |= 1ULL << bin;
+    arena->freeSize += node->size;
+}
+
+static void ArenaImpl_BinRemove(Arena* arena, ArenaNode* node) {
+    s32 bin = ArenaImpl_BinIndex(node->size);
+    ArenaFreeLink* link = FREE_LINK(node);
+
+    if (link->prev != NULL) {
+        FREE_LINK(link->prev)->next = link->next;
+    } else {
+        arena->bins[bin] = link->next;
+        if (link->next == NULL) {
+            arena->binMask &= ~(1ULL << bin);
+        }
+    }
+    if (link->next != NULL) {
+        FREE_LINK(link->next)->prev = link->prev;
+    }
+    arena->freeSize -= node->size;
+}
+
+/**
+ * Finds a free block with at least size bytes of data, or NULL.
+ */
+static ArenaNode* ArenaImpl_BinFind(Arena* arena, size_t size) {
+    s32 bin = ArenaImpl_BinIndex(size);
+    u64 mask;
+
+    if (bin >= ARENA_SMALL_BINS) {
+        /* A big bin also holds blocks under size */
+        ArenaNode* iter;
+
+        for (iter = arena->bins[bin]; iter != NULL; iter = FREE_LINK(iter)->next) {
+            if (iter->size >= size) {
+                return iter;
+            }
+        }
+        bin++;
+    }
+
+    mask = arena->binMask & (~0ULL << bin);
+    if (mask == 0) {
+        return NULL;
+    }
+    return arena->bins[__builtin_ctzll(mask)];
+}
+
+/* ============================================================
+ * Arena
+ * ============================================================ */
+
+ArenaNode* ArenaImpl_GetLastBlock(Arena* arena) {
+    ArenaNode* last = arena->head;
+
+    if (last != NULL) {
+        while (last->next != NULL) {
+            last = last->next;
+        }
+    }
+    return last;
+}
+
+void __osMallocAddHeap(Arena* arena, void* heap, size_t size);
+
+void __osMallocInit(Arena* arena, void* heap, size_t size) {
+    memset(arena, 0, sizeof(Arena));
+    __osMallocAddHeap(arena, heap, size);
+    arena->isInit = true;
+}
+
+void __osMallocAddHeap(Arena* arena, void* heap, size_t size) {
+    ArenaNode* firstNode;
+    ArenaNode* lastNode;
+    s32 alignedSize;
+
+    if (heap == NULL) {
+        return;
+    }
+
+    firstNode = (ArenaNode*) ALIGN16((uintptr_t) heap);
+    alignedSize = ((s32) size - (s32) ((uintptr_t) firstNode - (uintptr_t) heap)) & ~0xF;
+    if (alignedSize < (s32) sizeof(ArenaNode) + MIN_BLOCK_SIZE) {
+        return;
+    }
+
+    firstNode->next = NULL;
+    firstNode->prev = NULL;
+    firstNode->size = alignedSize - sizeof(ArenaNode);
+    firstNode->isFree = true;
+    firstNode->magic = NODE_MAGIC;
+
+    lastNode = ArenaImpl_GetLastBlock(arena);
+    if (lastNode == NULL) {
+        arena->head = firstNode;
+        arena->start = heap;
+    } else {
+        firstNode->prev = lastNode;
+        lastNode->next = firstNode;
+    }
+    ArenaImpl_BinInsert(arena, firstNode);
+}
+
+void __osMallocCleanup(Arena* arena) {
+    memset(arena, 0, sizeof(Arena));
+}
+
+u8 __osMallocIsInitialized(Arena* arena) {
+    return arena->isInit;
+}
+
+/**
+ * Takes node out of its bin and makes it an allocated block of size bytes,
+ * giving what's left back to the bins. With fromEnd, the allocated block
+ * is carved from the end of node instead. Returns the allocated block.
+ */
+static ArenaNode* ArenaImpl_Take(Arena* arena, ArenaNode* node, size_t size, bool fromEnd) {
+    const size_t blockSize = size + sizeof(ArenaNode);
+
+    ArenaImpl_BinRemove(arena, node);
+
+    if (blockSize + MIN_BLOCK_SIZE <= node->size) {
+        ArenaNode* newNode;
+        ArenaNode* free;
+
+        if (!fromEnd) {
+            newNode = (ArenaNode*) ((uintptr_t) node + blockSize);
+            newNode->size = node->size - blockSize;
+            node->size = size;
+            free = newNode;
+        } else {
+            newNode = (ArenaNode*) ((uintptr_t) node + (node->size - size));
+            newNode->size = size;
+            node->size -= blockSize;
+            free = node;
+        }
+        newNode->magic = NODE_MAGIC;
+        newNode->next = node->next;
+        newNode->prev = node;
+        if (newNode->next != NULL) {
+            newNode->next->prev = newNode;
+        }
+        node->next = newNode;
+
+        node->isFree = fromEnd;
+        newNode->isFree = !fromEnd;
+        ArenaImpl_BinInsert(arena, free);
+        if (fromEnd) {
+            node = newNode;
+        }
+    }
+
+    node->isFree = false;
+    arena->allocSize += node->size;
+    prof_frame.count[PROF_ALLOCS]++;
+    return node;
+}
+
+static void* ArenaImpl_Malloc(Arena* arena, size_t size, bool fromEnd) {
+    ArenaNode* node;
+
+    size = ALIGN16(size);
+    if (size < MIN_BLOCK_SIZE) {
+        size = MIN_BLOCK_SIZE;
+    }
+
+    node = ArenaImpl_BinFind(arena, size);
+    if (node == NULL) {
+        return NULL;
+    }
+    node = ArenaImpl_Take(arena, node, size, fromEnd);
+    return (void*) ((uintptr_t) node + sizeof(ArenaNode));
+}
+
+void* __osMalloc(Arena* arena, size_t size) {
+    return ArenaImpl_Malloc(arena, size, false);
+}
+
+void* __osMallocR(Arena* arena, size_t size) {
+    return ArenaImpl_Malloc(arena, size, true);
+}
+
+void __osFree(Arena* arena, void* ptr) {
+    ArenaNode* node = (ArenaNode*) ((uintptr_t) ptr - sizeof(ArenaNode));
+    ArenaNode* next;
+    ArenaNode* prev;
+
+    if ((ptr == NULL) || (node->magic != NODE_MAGIC) || node->isFree) {
+        return;
+    }
+
+    node->isFree = true;
+    arena->allocSize -= node->size;
+
+    next = node->next;
+    if ((next != NULL) && next->isFree && ((uintptr_t) next == NODE_END(node))) {
+        ArenaImpl_BinRemove(arena, next);
+        node->size += next->size + sizeof(ArenaNode);
+        node->next = next->next;
+        if (node->next != NULL) {
+            node->next->prev = node;
+        }
+    }
+
+    prev = node->prev;
+    if ((prev != NULL) && prev->isFree && ((uintptr_t) node == NODE_END(prev))) {
+        ArenaImpl_BinRemove(arena, prev);
+        prev->size += node->size + sizeof(ArenaNode);
+        prev->next = node->next;
+        if (prev->next != NULL) {
+            prev->next->prev = prev;
+        }
+        node = prev;
+    }
+
+    ArenaImpl_BinInsert(arena, node);
+}
+
+/**
+ * Grows in place into a free block right after when there is one big
+ * enough, else moves the data to a new block. Unlike the original, the
+ * fallback copies from the old block to the new one, not the other way.
+ */
+void* __osRealloc(Arena* arena, void* ptr, size_t newSize) {
+    ArenaNode* node;
+    ArenaNode* next;
+
+    if (ptr == NULL) {
+        return __osMalloc(arena, newSize);
+    }
+    if (newSize == 0) {
+        __osFree(arena, ptr);
+        return NULL;
+    }
+
+    node = (ArenaNode*) ((uintptr_t) ptr - sizeof(ArenaNode));
+    newSize = ALIGN16(newSize);
+    if (newSize <= node->size) {
+        return ptr;
+    }
+
+    next = node->next;
+    if ((next != NULL) && next->isFree && ((uintptr_t) next == NODE_END(node)) &&
+        (next->size + sizeof(ArenaNode) >= newSize - node->size)) {
+        const size_t diff = newSize - node->size;
+
+        ArenaImpl_BinRemove(arena, next);
+        arena->allocSize -= node->size;
+
+        if (next->size >= diff + MIN_BLOCK_SIZE) {
+            /* Move the free block's header up by diff */
+            ArenaNode* moved = (ArenaNode*) ((uintptr_t) next + diff);
+
+            memmove(moved, next, sizeof(ArenaNode));
+            moved->size -= diff;
+            if (moved->next != NULL) {
+                moved->next->prev = moved;
+            }
+            node->next = moved;
+            node->size = newSize;
+            ArenaImpl_BinInsert(arena, moved);
+        } else {
+            /* Too little would be left for a block, take all of it */
+            node->size += next->size + sizeof(ArenaNode);
+            node->next = next->next;
+            if (node->next != NULL) {
+                node->next->prev = node;
+            }
+        }
+
+        arena->allocSize += node->size;
+        return ptr;
+    } else {
+        void* newPtr = __osMalloc(arena, newSize);
+
+        if (newPtr != NULL) {
+            memcpy(newPtr, ptr, node->size);
+            __osFree(arena, ptr);
+        }
+        return newPtr;
+    }
+}
+
+void __osGetSizes(Arena* arena, size_t* outMaxFree, size_t* outFree, size_t* outAlloc) {
+    *outMaxFree = 0;
+    *outFree = arena->freeSize;
+    *outAlloc = arena->allocSize;
+
+    /* The biggest block is in the highest bin that isn't empty */
+    if (arena->binMask != 0) {
+        ArenaNode* iter = arena->bins[63 - __builtin_clzll(arena->binMask)];
+
+        for (; iter != NULL; iter = FREE_LINK(iter)->next) {
+            if (*outMaxFree < iter->size) {
+                *outMaxFree = iter->size;
+            }
+        }
+    }
+}
+
+/**
+ * Checks every header of the arena, and that every free block is in the bin
+ * of its size. Returns 0 if everything is right, 1 otherwise.
+ */
+s32 __osCheckArena(Arena* arena) {
+    ArenaNode* iter;
+    size_t listedFree = 0;
+    size_t binnedFree = 0;
+    s32 bin;
+
+    for (iter = arena->head; iter != NULL; iter = iter->next) {
+        if (iter->magic != NODE_MAGIC) {
+            return 1;
+        }
+        if (iter->isFree) {
+            listedFree += iter->size;
+        }
+    }
+
+    for (bin = 0; bin < ARENA_NUM_BINS; bin++) {
+        for (iter = arena->bins[bin]; iter != NULL; iter = FREE_LINK(iter)->next) {
+            if (!iter->isFree || (ArenaImpl_BinIndex(iter->size) != bin)) {
+                return 1;
+            }
+            binnedFree += iter->size;
+        }
+    }
+
+    return (listedFree != binnedFree) || (binnedFree != arena->freeSize);
+}
@@ -0,0 +1,348 @@
+/**
+ * matrix_nsp.c — Fixed point backend for the hot Matrix_* functions
+ *
+ * The ARM926 has no FPU, so every f32 multiply and add in sys_matrix.c is a
+ * libgcc call. The per-limb skeleton draws go through Matrix_Push,
+ * Matrix_TranslateRotateZYX and Matrix_ToMtx for every limb of every actor,
+ * and actors add Matrix_Translate, Matrix_RotateZYX, Matrix_Mult and
+ * Matrix_MultVec3f on top.
+ *
+ * The stack itself stays MtxF: actors read and write the top in place
+ * through Matrix_GetCurrent, and pass MtxF around to the SkinMatrix_*
+ * functions. The functions here load what they need from the top with
+ * integer only float → 32.32 conversions (the renderer's fix64), do all of
+ * their math with fix_mult, and store the touched columns back. Results
+ * differ from the float path in the last bits of the mantissa only.
+ *
+ * Matrix_MtxFToMtx goes straight from the float bits to the s15.16 halves
+ * of the Mtx that gfx_sp_matrix reads, with the same truncation as the
+ * float multiply and cast it replaces, and Matrix_MtxToMtxF back.
+ *
+ * The replaced functions are left out of sys_matrix.c with MATRIX_FIXED.
+ * With ACTOR_CULL_BATCH, the batch projection of Actor_DrawAll's actor
+ * positions is here too, and left out of z_skin_matrix.c.
+ */
+#include "sys_matrix.h"
+#include "z64skin_matrix.h"
+
+#include "fixed_pt.h"
+
+/* From sys_matrix.c */
+extern MtxF* sCurrentMatrix;
+
+/* From libultra/gu */
+extern s16 sins(u16 x);
+extern s16 coss(u16 x);
+
+/* ============================================================
+ * Conversions
+ * ============================================================ */
+
+typedef union {
+    f32 f;
+    u32 u;
+} MtxFBits;
+
+/**
+ * Truncates f to a fixed point value with fracBits fraction bits, like
+ * (s64)(f * (1 << fracBits)) does. Saturates past 2^63.
+ */
+static inline s64 mtx_f2q(f32 f, s32 fracBits) {
+    MtxFBits bits;
+    s32 shift;
+    u32 mant;
+    u64 mag;
+
+    bits.f = f;
+    shift = (s32) ((bits.u >> 23) & 0xFF) - 150 + fracBits;
+    mant = (bits.u & 0x7FFFFF) | 0x800000;
+
+    if (shift <= -24) {
+        return 0; /* zero, denormals and values under one unit */
+    }
+    if (shift > 39) {
+        mag = 0x7FFFFFFFFFFFFFFFULL; /* also infinities and NaN */
+    } else if (shift < 0) {
+        mag = mant >> -shift;
+    } else {
+        mag = (u64) mant << shift;
+    }
+    return (bits.u & 0x80000000) ? -(s64) mag : (s64) mag;
+}
+
+#define MTX_F2FIX(f) ((fix64) mtx_f2q(f, 32))
+
+/** The nearest float under x, from the leading bit with CLZ */
+static inline f32 mtx_fix2f(fix64 x) {
+    MtxFBits bits;
+    u64 mag = (x < 0) ? -(u64) x : (u64) x;
+    s32 top;
+    u32 mant;
+
+    if (mag == 0) {
+        return 0.0f;
+    }
+    top = 63 - fix_clz64(mag);
+    mant = (top >= 23) ? (u32) (mag >> (top - 23)) : (u32) mag << (23 - top);
+    bits.u = ((x < 0) ? 0x80000000 : 0) | (u32) (top - 32 + 127) << 23 | (mant & 0x7FFFFF);
+    return bits.f;
+}
+
+/* sins and coss are Q15 over SHRT_MAX, Math_SinS scales them by 1 / SHRT_MAX.
+ * 2^32 / SHRT_MAX is 131076.004, close enough for 32.32 */
+#define MTX_TRIG_2_FIX(t) ((fix64) (t) * 131076)
+
+static void mtx_load(fix64 m[4][4], MtxF* mf) {
+    for (s32 i = 0; i < 4; i++) {
+        for (s32 j = 0; j < 4; j++) {
+            m[i][j] = MTX_F2FIX(mf->mf[i][j]);
+        }
+    }
+}
+
+/* Stores the columns of m set in mask */
+static void mtx_store(MtxF* mf, fix64 m[4][4], u32 mask) {
+    for (s32 i = 0; i < 4; i++) {
+        if (mask & (1 << i)) {
+            for (s32 j = 0; j < 4; j++) {
+                mf->mf[i][j] = mtx_fix2f(m[i][j]);
+            }
+        }
+    }
+}
+
+/* ============================================================
+ * Transforms, mf[i] is the column multiplying the i-th coordinate
+ * ============================================================ */
+
+/* a' = a cos + b sin, b' = b cos - a sin, for all four rows */
+static inline void mtx_rotate_cols(fix64 a[4], fix64 b[4], fix64 sin, fix64 cos) {
+    for (s32 j = 0; j < 4; j++) {
+        fix64 ta = a[j];
+        fix64 tb = b[j];
+
+        a[j] = fix_mult(ta, cos) + fix_mult(tb, sin);
+        b[j] = fix_mult(tb, cos) - fix_mult(ta, sin);
+    }
+}
+
+#if TRIG_TABLE
+/* Both from the one table entry */
+#define MTX_SIN(a) (gTrigTable[TRIG_TABLE_INDEX(a)].sinQ15)
+#define MTX_COS(a) (gTrigTable[TRIG_TABLE_INDEX(a)].cosQ15)
+#else
+#define MTX_SIN(a) sins(a)
+#define MTX_COS(a) coss(a)
+#endif
+
+static inline void mtx_rotate_z(fix64 m[4][4], s16 z) {
+    mtx_rotate_cols(m[0], m[1], MTX_TRIG_2_FIX(MTX_SIN(z)), MTX_TRIG_2_FIX(MTX_COS(z)));
+}
+
+static inline void mtx_rotate_y(fix64 m[4][4], s16 y) {
+    /* x' = x cos - z sin, z' = z cos + x sin */
+    mtx_rotate_cols(m[0], m[2], -MTX_TRIG_2_FIX(MTX_SIN(y)), MTX_TRIG_2_FIX(MTX_COS(y)));
+}
+
+static inline void mtx_rotate_x(fix64 m[4][4], s16 x) {
+    mtx_rotate_cols(m[1], m[2], MTX_TRIG_2_FIX(MTX_SIN(x)), MTX_TRIG_2_FIX(MTX_COS(x)));
+}
+
+static inline void mtx_translate(fix64 m[4][4], fix64 x, fix64 y, fix64 z) {
+    for (s32 j = 0; j < 4; j++) {
+        m[3][j] += fix_mult(m[0][j], x) + fix_mult(m[1][j], y) + fix_mult(m[2][j], z);
+    }
+}
+
+void Matrix_Mult(MtxF* mf, MatrixMode mode) {
+    fix64 a[4][4];
+    fix64 b[4][4];
+    fix64 c[4][4];
+
+    if (mode != MTXMODE_APPLY) {
+        Matrix_MtxFCopy(sCurrentMatrix, mf);
+        return;
+    }
+
+    mtx_load(a, sCurrentMatrix);
+    mtx_load(b, mf);
+    for (s32 i = 0; i < 4; i++) {
+        for (s32 j = 0; j < 4; j++) {
+            c[i][j] = fix_mult(a[0][j], b[i][0]) + fix_mult(a[1][j], b[i][1]) + fix_mult(a[2][j], b[i][2]) +
+                      fix_mult(a[3][j], b[i][3]);
+        }
+    }
+    mtx_store(sCurrentMatrix, c, 0xF);
+}
+
+void Matrix_Translate(f32 x, f32 y, f32 z, MatrixMode mode) {
+    fix64 m[4][4];
+
+    if (mode != MTXMODE_APPLY) {
+        SkinMatrix_SetTranslate(sCurrentMatrix, x, y, z);
+        return;
+    }
+
+    mtx_load(m, sCurrentMatrix);
+    mtx_translate(m, MTX_F2FIX(x), MTX_F2FIX(y), MTX_F2FIX(z));
+    mtx_store(sCurrentMatrix, m, 1 << 3);
+}
+
+void Matrix_RotateZYX(s16 x, s16 y, s16 z, MatrixMode mode) {
+    fix64 m[4][4];
+
+    if (mode != MTXMODE_APPLY) {
+        SkinMatrix_SetRotateRPY(sCurrentMatrix, x, y, z);
+        return;
+    }
+    if ((x | y | z) == 0) {
+        return;
+    }
+
+    mtx_load(m, sCurrentMatrix);
+    if (z != 0) {
+        mtx_rotate_z(m, z);
+    }
+    if (y != 0) {
+        mtx_rotate_y(m, y);
+    }
+    if (x != 0) {
+        mtx_rotate_x(m, x);
+    }
+    mtx_store(sCurrentMatrix, m, 0x7);
+}
+
+void Matrix_TranslateRotateZYX(Vec3f* translation, Vec3s* rot) {
+    fix64 m[4][4];
+
+    mtx_load(m, sCurrentMatrix);
+    mtx_translate(m, MTX_F2FIX(translation->x), MTX_F2FIX(translation->y), MTX_F2FIX(translation->z));
+    mtx_rotate_z(m, rot->z);
+    if (rot->y != 0) {
+        mtx_rotate_y(m, rot->y);
+    }
+    if (rot->x != 0) {
+        mtx_rotate_x(m, rot->x);
+    }
+    mtx_store(sCurrentMatrix, m, 0xF);
+}
+
+void Matrix_MultVec3f(Vec3f* src, Vec3f* dest) {
+    MtxF* cmf = sCurrentMatrix;
+    fix64 x = MTX_F2FIX(src->x);
+    fix64 y = MTX_F2FIX(src->y);
+    fix64 z = MTX_F2FIX(src->z);
+
+    dest->x = mtx_fix2f(MTX_F2FIX(cmf->xw) + fix_mult(MTX_F2FIX(cmf->xx), x) + fix_mult(MTX_F2FIX(cmf->xy), y) +
+                        fix_mult(MTX_F2FIX(cmf->xz), z));
+    dest->y = mtx_fix2f(MTX_F2FIX(cmf->yw) + fix_mult(MTX_F2FIX(cmf->yx), x) + fix_mult(MTX_F2FIX(cmf->yy), y) +
+                        fix_mult(MTX_F2FIX(cmf->yz), z));
+    dest->z = mtx_fix2f(MTX_F2FIX(cmf->zw) + fix_mult(MTX_F2FIX(cmf->zx), x) + fix_mult(MTX_F2FIX(cmf->zy), y) +
+                        fix_mult(MTX_F2FIX(cmf->zz), z));
+}
+
+#if ACTOR_CULL_BATCH
+
+/* ============================================================
+ * Batch projection
+ * ============================================================ */
+
+/*
+ * Positions go to Q12 and the matrix to Q20, so every product is a 32 x 32
+ * multiply accumulating into the 32.32 sum with SMLAL, and the translation
+ * row is added as fix64. Scenes stay well inside the Q12 range, a point past
+ * it, or a matrix with elements past the Q20 one, takes the float path.
+ */
+#define MTX_BATCH_POS_FRAC 12
+#define MTX_BATCH_MTX_FRAC 20 /* with the position's, 32 fraction bits */
+#define MTX_BATCH_LIMIT (1 << 30)
+
+static inline s32 mtx_batch_fits(s64 q) {
+    return (q < MTX_BATCH_LIMIT) && (q > -MTX_BATCH_LIMIT);
+}
+
+void SkinMatrix_Vec3fMtxFMultXYZWBatch(MtxF* mf, Vec3f* src, Vec3f* xyzDest, f32* wDest, s32 count) {
+    s32 m[4][3]; /* m[j][i]: the i-th coordinate's part of output j */
+    fix64 t[4];
+    s32 n;
+
+    for (s32 j = 0; j < 4; j++) {
+        for (s32 i = 0; i < 3; i++) {
+            s64 q = mtx_f2q(mf->mf[i][j], MTX_BATCH_MTX_FRAC);
+
+            if (!mtx_batch_fits(q)) {
+                for (n = 0; n < count; n++) {
+                    SkinMatrix_Vec3fMtxFMultXYZW(mf, &src[n], &xyzDest[n], &wDest[n]);
+                }
+                return;
+            }
+            m[j][i] = (s32) q;
+        }
+        t[j] = MTX_F2FIX(mf->mf[3][j]);
+    }
+
+    for (n = 0; n < count; n++) {
+        s64 qx = mtx_f2q(src[n].x, MTX_BATCH_POS_FRAC);
+        s64 qy = mtx_f2q(src[n].y, MTX_BATCH_POS_FRAC);
+        s64 qz = mtx_f2q(src[n].z, MTX_BATCH_POS_FRAC);
+        s32 x;
+        s32 y;
+        s32 z;
+
+        if (!mtx_batch_fits(qx) || !mtx_batch_fits(qy) || !mtx_batch_fits(qz)) {
+            SkinMatrix_Vec3fMtxFMultXYZW(mf, &src[n], &xyzDest[n], &wDest[n]);
+            continue;
+        }
+        x = (s32) qx;
+        y = (s32) qy;
+        z = (s32) qz;
+
+        xyzDest[n].x = mtx_fix2f(t[0] + (s64) m[0][0] * x + (s64) m[0][1] * y + (s64) m[0][2] * z);
+        xyzDest[n].y = mtx_fix2f(t[1] + (s64) m[1][0] * x + (s64) m[1][1] * y + (s64) m[1][2] * z);
+        xyzDest[n].z = mtx_fix2f(t[2] + (s64) m[2][0] * x + (s64) m[2][1] * y + (s64) m[2][2] * z);
+        wDest[n] = mtx_fix2f(t[3] + (s64) m[3][0] * x + (s64) m[3][1] * y + (s64) m[3][2] * z);
+    }
+}
+
+#endif
+
+/* ============================================================
+ * MtxF <-> Mtx
+ * ============================================================ */
+
+/*
+ * An Mtx is the integer halves of the 16 elements in MtxF order, then the
+ * fraction halves, two to a word with the first element in the high half.
+ * That's how gdSPDefMtx lays them out and what gfx_sp_matrix reads. The
+ * originals store through u16 pointers, which only gives that layout on a
+ * big endian CPU, so these go through the words.
+ */
+
+Mtx* Matrix_MtxFToMtx(MtxF* src, Mtx* dest) {
+    u32* intPart = (u32*) &dest->m[0][0];
+    u32* fracPart = (u32*) &dest->m[2][0];
+    f32* f = &src->mf[0][0];
+
+    for (s32 i = 0; i < 8; i++) {
+        u32 hi = (u32) mtx_f2q(f[2 * i], 16);
+        u32 lo = (u32) mtx_f2q(f[2 * i + 1], 16);
+
+        intPart[i] = (hi & 0xFFFF0000) | (lo >> 16);
+        fracPart[i] = (hi << 16) | (lo & 0xFFFF);
+    }
+    return dest;
+}
+
+void Matrix_MtxToMtxF(Mtx* src, MtxF* dest) {
+    u32* intPart = (u32*) &src->m[0][0];
+    u32* fracPart = (u32*) &src->m[2][0];
+    f32* f = &dest->mf[0][0];
+
+    for (s32 i = 0; i < 8; i++) {
+        s32 hi = (s32) ((intPart[i] & 0xFFFF0000) | (fracPart[i] >> 16));
+        s32 lo = (s32) ((intPart[i] << 16) | (fracPart[i] & 0xFFFF));
+
+        f[2 * i] = mtx_fix2f((fix64) hi << 16);
+        f[2 * i + 1] = mtx_fix2f((fix64) lo << 16);
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * memstats_nsp.c — What the game's heaps and arenas hold, sampled every frame
+ *
+ * The port's memory is spread over consumers that each only know their
+ * own: the C heap, ZeldaArena in it, the game state's two-head arena with
+ * the object space and the room buffer, the GfxPool display list arenas,
+ * and the renderer's texture cache and render targets. The game side is
+ * read here once a frame, from Graph_TaskSet00_Nsp, the renderer reports
+ * its own from gfx_backend.c. The numbers go to the profiling HUD, and
+ * Fault_AddHungupAndCrash writes them out before the port exits, so a run
+ * that runs out of memory says where it went.
+ */
+#include <malloc.h>
+#include <stdint.h>
+
+#include "global.h"
+#include "zelda_arena.h"
+#include "nspire/memstats.h"
+
+/* From the linker, 0 if it doesn't define them */
+extern char __executable_start[] __attribute__((weak));
+extern char _end[] __attribute__((weak));
+
+/* The object space up to the end of the last object loaded, the next one goes there */
+static void nsp_memstats_objects(ObjectContext* objectCtx) {
+    const uintptr_t start = (uintptr_t)objectCtx->spaceStart;
+    const uintptr_t end = (uintptr_t)objectCtx->spaceEnd;
+    uintptr_t next = end;
+
+    if (objectCtx->numEntries < ARRAY_COUNT(objectCtx->slots))
+        next = (uintptr_t)objectCtx->slots[objectCtx->numEntries].segment;
+    memstats_set(MEM_OBJECTS, next - start, end - start, end - next);
+}
+
+void nsp_memstats_sample(GameState* gameState) {
+    const struct mallinfo heap = mallinfo();
+    GraphicsContext* gfxCtx = gameState->gfxCtx;
+    TwoHeadGfxArena* gfxArenas[] = { &gfxCtx->polyOpa, &gfxCtx->polyXlu, &gfxCtx->overlay, &gfxCtx->work };
+    size_t maxFree, bytesFree, bytesAlloc;
+    uint32_t used = 0, capacity = 0;
+
+    /* newlib's heap has no largest block to report, its free total is an upper bound */
+    memstats_set(MEM_HEAP, heap.uordblks, heap.arena, heap.fordblks);
+
+    ZeldaArena_GetSizes(&maxFree, &bytesFree, &bytesAlloc);
+    memstats_set(MEM_ZELDA_ARENA, bytesAlloc, bytesAlloc + bytesFree, maxFree);
+
+    memstats_set(MEM_GAME_THA, gameState->tha.size - THA_GetRemaining(&gameState->tha), gameState->tha.size,
+                 THA_GetRemaining(&gameState->tha));
+
+    if (gameState->destroy == Play_Destroy) {
+        PlayState* play = (PlayState*)gameState;
+        const uint32_t roomSize =
+            (uintptr_t)play->roomCtx.bufPtrs[1] - (uintptr_t)play->roomCtx.bufPtrs[0];
+
+        nsp_memstats_objects(&play->objectCtx);
+        memstats_set(MEM_ROOMS, roomSize, roomSize, 0);
+    } else {
+        memstats_set(MEM_OBJECTS, 0, 0, 0);
+        memstats_set(MEM_ROOMS, 0, 0, 0);
+    }
+
+    /* Display lists and matrices can overflow an arena, which then measures past its size */
+    for (int i = 0; i < ARRAY_COUNT(gfxArenas); i++) {
+        used += gfxArenas[i]->size - THGA_GetRemaining(gfxArenas[i]);
+        capacity += gfxArenas[i]->size;
+    }
+    memstats_set(MEM_GFX_POOL, used, capacity, (used < capacity) ? capacity - used : 0);
+
+    if (__executable_start != NULL && _end != NULL)
+        memstats_set(MEM_IMAGE, _end - __executable_start, _end - __executable_start, 0);
+}
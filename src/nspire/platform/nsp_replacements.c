@@ -10,7 +10,7 @@
  * - PadMgr_GetInput: read from Nspire keypad
  * - Overlay_LoadGameState/Free: no-op (static linking)
  * - DMA: file-based ROM reading
- * - SysCfb: fixed framebuffer allocation
+ * - SysCfb: the game's framebuffer images, in the block Graph_ThreadEntry allocates
  * - Fault: simplified error handling
  */
 #include <stdlib.h>
@@ -21,78 +21,275 @@
 
 #ifdef TARGET_NSP
 #include <libndls.h>
+#else
+#include <time.h>
 #endif
 
 #include "nspire/platform/os_stubs.h"
 #include "nspire/gfx/gbi_nsp.h"
+#include "nspire/profiling.h"
+#if MEM_STATS
+#include "nspire/memstats.h"
+#endif
 
 /* ============================================================
  * External declarations
  * ============================================================ */
 
 /* From main_nsp.c */
-extern void nsp_process_display_list(Gfx* dl);
-extern int nsp_rom_read(uint32_t rom_addr, void* dest, uint32_t size);
+extern int nsp_rom_read(uint32_t vrom, void* dest, uint32_t size);
+extern int nsp_rom_read_raw(uint32_t rom_addr, void* dest, uint32_t size);
+extern void* nsp_rom_find_entry(uint32_t vrom);
+extern int32_t nsp_rom_translate(uint32_t vrom);
 
-/* From sm64-nsp renderer */
-extern void nsp_swap_buffers_begin(void);
-extern void nsp_swap_buffers_end(void);
+/* From gfx_frontend.c, the one display list interpreter */
+extern void gfx_start_frame(void);
+extern void gfx_run(Gfx* commands);
+extern void gfx_end_frame(void);
 
 /* From input_nsp.c */
 extern void input_nsp_poll(void);
+#if INPUT_LATENCY
+extern bool input_nsp_latency_frame(uint32_t* to_update, uint32_t* to_frame);
+#endif
+
+/* From audio_nsp.c, or audio_stubs.c without the mixer */
+extern void nsp_audio_update(void);
+
+#if FLASH_JOURNAL
+/* From flashrom_nsp.c */
+extern void nsp_flashrom_update(void);
+#endif
+
+#if INPUT_REPLAY
+/* From replay_nsp.c */
+extern bool nsp_replay_active(void);
+extern void nsp_replay_pad(u16* button, s8* stick_x, s8* stick_y, u16* press, u16* rel);
+extern void nsp_replay_frame(void);
+#endif
+
+/* From pipeline_nsp.c */
+extern void nsp_pipe_submit(void* dl);
+extern bool nsp_pipe_run(void (*draw)(void* dl));
+#if DRAW_SKIP
+extern bool nsp_pipe_plan(void);
+#endif
+
+/* Timer, defined below */
+uint32_t tmr_ms(void);
+
+/* Async DMA queue, defined below */
+#define DMA_SERVICE_BUDGET_MS 8 /* ROM reads a frame may spend on the queue */
+static void nsp_dma_service(u32 budget_ms, u32 budget_bytes);
 
 /* Config */
 extern bool configAffineMode;
-extern unsigned int configFrameskip;
+extern unsigned int configDmaBudget;
+
+/* From z_malloc.c */
+extern void ZeldaArena_GetSizes(size_t* outMaxFree, size_t* outFree, size_t* outAlloc);
+
+#if BGCHECK_FLOOR_CACHE
+/* From z_bgcheck.c */
+extern u32 gBgFloorCacheHits;
+extern u32 gBgFloorCacheSavedTests;
+#endif
+#if ROOM_PREFETCH
+/* From z_room.c */
+extern u32 gRoomPrefetchHits;
+extern u32 gRoomPrefetchMisses;
+#endif
+#if DRAW_SKIP
+/* From graph.c */
+extern u8 gGraphSkipDraw;
+#endif
+#if GFXPOOL_SIZING
+/* From graph.c, indexed by GfxPoolBuffer: the opaque, translucent and overlay buffers */
+extern size_t gGfxPoolSizes[3];
+/* Indexed by GfxPoolStat: the opaque, translucent, overlay and work arenas, then all of their tails */
+extern u32 gGfxPoolUsed[5];
+extern u32 gGfxPoolPeak[5];
+
+/* Config */
+extern bool configGfxPoolFit;
+extern unsigned int configGfxPoolOpaKb;
+extern unsigned int configGfxPoolXluKb;
+extern unsigned int configGfxPoolOverlayKb;
+#endif
+#if ACTOR_UPDATE_LOD
+extern unsigned int configActorUpdateLod;
+#endif
+#if SKEL_LOD_FORCE
+extern unsigned int configSkelLodDist;
+#endif
+#if MEM_STATS
+/* From memstats_nsp.c */
+extern void nsp_memstats_sample(void* gameState);
+#endif
 
 /* ============================================================
  * Graph_TaskSet00 Replacement
  *
  * On N64: constructs an OSTask and sends display list to RCP scheduler
- * On Nspire: processes the display list through our software renderer
- * and blits the result to the LCD
+ * On Nspire: hands the display list to the frame pipeline, whose renderer
+ * stage processes it through our software renderer and blits the result
+ * to the LCD
  * ============================================================ */
 
 /* MM's graphics master display list structure */
 /* We need the actual type from MM, but for now use the pointer */
 extern void* gGfxMasterDL;
 
-static uint32_t frameskip_counter = 0;
+/* When the last Graph_TaskSet00 returned. Everything up to the next one is
+ * Graph_Update's work: input, audio and GameState_Update building the DLs. */
+static uint32_t update_start = 0;
+
+/**
+ * The renderer stage of the frame pipeline: walks a frame the game submitted
+ * and blits it. Only called for the frames that aren't dropped.
+ */
+static void nsp_draw_frame(void* dl) {
+    size_t max_free, bytes_free, bytes_alloc;
+
+    /* The master DL, which Graph_ExecuteAndDraw builds at
+     * gGfxMasterDL->taskStart and which chains to the per-buffer display
+     * lists (POLY_OPA, POLY_XLU, OVERLAY, etc.), is walked once, by the
+     * frontend. It keeps the segment table the DLs set, and times itself. */
+    gfx_start_frame();
+    gfx_run((Gfx*)dl);
+
+    /* A tap during the walk is kept for the next update */
+    input_nsp_poll();
+
+    /* Blit to LCD */
+    gfx_end_frame();
+#if INPUT_LATENCY
+    input_nsp_latency_frame(&prof_frame.count[PROF_INPUT_WAIT], &prof_frame.count[PROF_INPUT_LATENCY]);
+#endif
+
+    /* Show and log this frame's timings, the blit included */
+    ZeldaArena_GetSizes(&max_free, &bytes_free, &bytes_alloc);
+    prof_frame.count[PROF_ARENA_FREE_KB] = bytes_free >> 10;
+#if BGCHECK_FLOOR_CACHE
+    prof_frame.count[PROF_FLOOR_HITS] = gBgFloorCacheHits;
+    prof_frame.count[PROF_FLOOR_SAVED] = gBgFloorCacheSavedTests;
+    gBgFloorCacheHits = gBgFloorCacheSavedTests = 0;
+#endif
+#if ROOM_PREFETCH
+    prof_frame.count[PROF_ROOM_HITS] = gRoomPrefetchHits;
+    prof_frame.count[PROF_ROOM_MISSES] = gRoomPrefetchMisses;
+    gRoomPrefetchHits = gRoomPrefetchMisses = 0;
+#endif
+#if GFXPOOL_SIZING
+    for (int i = 0; i < 5; i++)
+        prof_frame.count[PROF_GFX_OPA + i] = gGfxPoolUsed[i];
+#endif
+    profiling_end_frame();
+#if INPUT_REPLAY
+    nsp_replay_frame();
+#endif
+}
 
 /**
  * Replacement for Graph_TaskSet00.
  * Instead of sending the display list to the N64 RCP,
- * we process it through our software renderer.
+ * we hand it to the frame pipeline, which renders or drops it.
  *
  * This is called at the end of each frame by Graph_ExecuteAndDraw.
  */
 void Graph_TaskSet00_Nsp(void* gfxCtx, void* gameState) {
+    (void)gfxCtx;
     (void)gameState;
 
-    /* Frameskip — only render every N frames */
-    frameskip_counter++;
-    if (frameskip_counter <= configFrameskip) {
-        return;
+    /* Dropped frames add their update to the next rendered one */
+    prof_frame.time[PROF_UPDATE] += tmr_ms() - update_start;
+#if MEM_STATS
+    nsp_memstats_sample(gameState);
+#endif
+
+    /* The update is done, read what it queued while nothing waits on the ROM. A replay reads by
+     * size only, the frame a load finishes in mustn't depend on how fast the reads were */
+#if INPUT_REPLAY
+    nsp_dma_service(nsp_replay_active() ? 0 : DMA_SERVICE_BUDGET_MS, configDmaBudget * 1024);
+#else
+    nsp_dma_service(DMA_SERVICE_BUDGET_MS, configDmaBudget * 1024);
+#endif
+    input_nsp_poll();
+
+    /* The audio thread's retraces since the last frame, dropped frames included */
+    nsp_audio_update();
+#if FLASH_JOURNAL
+
+    /* A few of the pages the last saves changed go to the journal */
+    nsp_flashrom_update();
+#endif
+
+    /* The frame is complete in its GfxPool and the next update builds into
+     * the other one, so the renderer stage can have this one meanwhile */
+    nsp_pipe_submit(gGfxMasterDL);
+    nsp_pipe_run(nsp_draw_frame);
+#if DRAW_SKIP
+
+    /* The game leaves out of a frame that will be dropped what only drawing it needs */
+    gGraphSkipDraw = nsp_pipe_plan();
+#endif
+
+    update_start = tmr_ms();
+}
+
+#if GFXPOOL_SIZING
+/* ============================================================
+ * Display list buffer sizes
+ *
+ * The N64 sizes of the GfxPool buffers are more than most scenes need, and
+ * both pools are kept. gfx_pool_*_kb size them, and with gfx_pool_fit set
+ * the game writes the most a frame of this run used, plus a quarter, back
+ * to the config when it exits. A run should go through the busiest scenes
+ * before its peaks are used: a frame that needs more than its buffer holds
+ * isn't drawn.
+ * ============================================================ */
+
+/* Called before Graph_ThreadEntry allocates the pools */
+void nsp_gfx_pool_configure(void) {
+    const unsigned int kb[3] = { configGfxPoolOpaKb, configGfxPoolXluKb, configGfxPoolOverlayKb };
+
+    for (int i = 0; i < 3; i++) {
+        if (kb[i] != 0)
+            gGfxPoolSizes[i] = kb[i] * 1024;
     }
-    frameskip_counter = 0;
-
-    /* Get the master display list pointer.
-     * In MM, Graph_ExecuteAndDraw builds the master DL at
-     * gGfxMasterDL->taskStart, which chains to the per-buffer
-     * display lists (POLY_OPA, POLY_XLU, OVERLAY, etc.).
-     *
-     * The task->data_ptr field points to gGfxMasterDL,
-     * which is the root of the display list tree.
-     */
-    if (gGfxMasterDL != NULL) {
-        /* Process the display list through our renderer */
-        nsp_process_display_list((Gfx*)gGfxMasterDL);
+}
+
+/* Called before the config is saved */
+void nsp_gfx_pool_fit(void) {
+    unsigned int* kb[3] = { &configGfxPoolOpaKb, &configGfxPoolXluKb, &configGfxPoolOverlayKb };
+
+    if (!configGfxPoolFit)
+        return;
+
+    for (int i = 0; i < 3; i++) {
+        if (gGfxPoolPeak[i] != 0)
+            *kb[i] = (gGfxPoolPeak[i] + gGfxPoolPeak[i] / 4 + 1023) / 1024;
     }
+}
+#endif
 
-    /* Blit to LCD */
-    nsp_swap_buffers_begin();
-    nsp_swap_buffers_end();
+#if ACTOR_UPDATE_LOD
+/* Read by Actor_UpdateAll every frame: NPCs and props further than
+ * actor_update_lod units from the player, and off-screen ones, update every
+ * 2nd frame, past twice that every 4th, see z_actor.c */
+f32 Actor_GetUpdateLodDist(void) {
+    return (f32)configActorUpdateLod;
 }
+#endif
+
+#if SKEL_LOD_FORCE
+/* Read by SkelAnime_DrawLod and SkelAnime_DrawFlexLod: actors' LOD skeletons
+ * further than skel_lod_dist units from the camera draw their far display
+ * lists, see z_skelanime.c */
+f32 SkelAnime_GetLodDist(void) {
+    return (f32)configSkelLodDist;
+}
+#endif
 
 /* ============================================================
  * PadMgr Replacement
@@ -127,25 +324,23 @@ typedef struct {
     u8 errnum;
 } OSContPad;
 extern OSContPad* input_nsp_get_pad(void);
+extern void input_nsp_take_edges(u16* pressed, u16* released);
 
 /**
  * Replacement for PadMgr_GetInput.
  * Reads the Nspire keypad and fills MM's Input structures.
  *
- * @param input   Array of 4 Input structures (one per controller port)
- * @param lockInput  If true, clear all input (used during certain transitions)
+ * @param input        Array of 4 Input structures (one per controller port)
+ * @param gameRequest  True for the game update's read, which gets every press and release since the
+ *                     last one like padmgr's polls hand them over. Other reads compare with the state
+ *                     left in input, as PadMgr_GetInputNoLock does.
  */
-void PadMgr_GetInput_Nsp(void* input_ptr, s32 lockInput) {
+void PadMgr_GetInput_Nsp(void* input_ptr, s32 gameRequest) {
     InputCompat* input = (InputCompat*)input_ptr;
 
-    /* Poll the Nspire keypad */
+    /* Sample the keypad right as the update starts, not at the last poll */
     input_nsp_poll();
 
-    if (lockInput) {
-        memset(input, 0, sizeof(InputCompat) * 4);
-        return;
-    }
-
     /* Controller 1 */
     OSContPad* pad = input_nsp_get_pad();
 
@@ -161,8 +356,16 @@ void PadMgr_GetInput_Nsp(void* input_ptr, s32 lockInput) {
     input[0].errno_ = 0;
 
     /* Calculate press/release */
-    input[0].press_button = (input[0].cur_button ^ input[0].prev_button) & input[0].cur_button;
-    input[0].rel_button = (input[0].cur_button ^ input[0].prev_button) & input[0].prev_button;
+    if (gameRequest) {
+        input_nsp_take_edges(&input[0].press_button, &input[0].rel_button);
+    } else {
+        input[0].press_button = (input[0].cur_button ^ input[0].prev_button) & input[0].cur_button;
+        input[0].rel_button = (input[0].cur_button ^ input[0].prev_button) & input[0].prev_button;
+    }
+#if INPUT_REPLAY
+    nsp_replay_pad(&input[0].cur_button, &input[0].cur_x, &input[0].cur_y, &input[0].press_button,
+                   &input[0].rel_button);
+#endif
     input[0].press_x = input[0].cur_x - input[0].prev_x;
     input[0].press_y = input[0].cur_y - input[0].prev_y;
 
@@ -177,27 +380,155 @@ void PadMgr_GetInput_Nsp(void* input_ptr, s32 lockInput) {
  * We replace these with file reads from mm-us.z64.
  * ============================================================ */
 
+/* Async requests waiting to be read, serviced in order like the N64's DMA
+ * queue. Room transitions, object slots and mask or skybox loads go through
+ * here, so their reads land between frames instead of in the frame that
+ * issued them. */
+#define DMA_QUEUE_SIZE 32
+#define DMA_MERGE_MAX_SIZE 0x8000
+
+typedef struct {
+    void* ram;
+    u32 vrom;
+    u32 size;
+    u32 done;           /* bytes already read, when a budget split the request */
+    OSMesgQueue* queue; /* notified with msg once the data is in, if not NULL */
+    OSMesg msg;
+} NspDmaRequest;
+
+/* The start of MM's DmaRequest. Object_UpdateEntries checks vromAddr to tell
+ * whether a slot's request was made, like the N64 DmaMgr fills it in. */
+typedef struct {
+    uintptr_t vromAddr;
+    void* dramAddr;
+    size_t size;
+} NspDmaRequestHeader;
+
+static NspDmaRequest dma_queue[DMA_QUEUE_SIZE];
+static u32 dma_queue_first = 0;
+static u32 dma_queue_count = 0;
+
+/**
+ * Reads queued requests until the queue is empty, or one of the budgets that
+ * isn't 0 ran out: budget_ms of time or budget_bytes read. A request bigger
+ * than what is left of the byte budget is read in part and continued by the
+ * next call, its message is only sent once all of it is in. Requests that
+ * continue the one before them in both ROM and RAM, like a segment loaded in
+ * pieces, are merged into a single read of up to DMA_MERGE_MAX_SIZE bytes, so
+ * that a room read ahead in chunks (see z_room.c) still spreads over several
+ * frames.
+ */
+static void nsp_dma_service(u32 budget_ms, u32 budget_bytes) {
+    u32 t0 = tmr_ms();
+    u32 bytes = 0;
+
+    while (dma_queue_count > 0) {
+        NspDmaRequest* req = &dma_queue[dma_queue_first];
+        u32 vrom = req->vrom + req->done;
+        u8* ram = (u8*)req->ram + req->done;
+        u32 size = req->size - req->done;
+        u32 n = 1;
+
+        while (n < dma_queue_count) {
+            NspDmaRequest* next = &dma_queue[(dma_queue_first + n) % DMA_QUEUE_SIZE];
+            if (next->vrom != vrom + size || next->ram != ram + size || size + next->size > DMA_MERGE_MAX_SIZE)
+                break;
+            size += next->size;
+            n++;
+        }
+
+        if (budget_bytes != 0 && size > budget_bytes - bytes)
+            size = budget_bytes - bytes;
+
+        if (nsp_rom_read(vrom, ram, size) != 0)
+            printf("DMA of 0x%X bytes from ROM 0x%08X failed\n", (unsigned)size, (unsigned)vrom);
+        bytes += size;
+
+        /* Finish the requests the read covered, the last one may be left partly read */
+        for (; n > 0; n--) {
+            u32 left;
+
+            req = &dma_queue[dma_queue_first];
+            left = req->size - req->done;
+            if (left > size) {
+                req->done += size;
+                break;
+            }
+
+            size -= left;
+            if (req->queue != NULL)
+                osSendMesg(req->queue, req->msg, OS_MESG_NOBLOCK);
+            dma_queue_first = (dma_queue_first + 1) % DMA_QUEUE_SIZE;
+            dma_queue_count--;
+        }
+
+        if ((budget_ms != 0 && tmr_ms() - t0 >= budget_ms) || (budget_bytes != 0 && bytes >= budget_bytes))
+            break;
+    }
+}
+
+/* Finishes every queued request, for osRecvMesg blocking on one of them */
+void nsp_dma_flush(void) {
+    nsp_dma_service(0, 0);
+}
+
 /**
  * Replacement for DmaMgr_SendRequest / DmaRequest.
- * Reads data directly from the ROM file.
+ * Reads data directly from the ROM file, after the requests queued before it
+ * like on the N64, so that it can't be overwritten by an older one.
  */
 s32 DmaMgr_RequestSync(void* ram, u32 vrom, u32 size) {
+    nsp_dma_flush();
     return nsp_rom_read(vrom, ram, size);
 }
 
 s32 DmaMgr_RequestAsync(void* request, void* ram, u32 vrom, u32 size, u32 unk, void* queue, void* msg) {
-    (void)request;
     (void)unk;
-    (void)queue;
-    (void)msg;
-    return nsp_rom_read(vrom, ram, size);
+
+    if (request != NULL) {
+        NspDmaRequestHeader* header = request;
+        header->vromAddr = vrom;
+        header->dramAddr = ram;
+        header->size = size;
+    }
+
+    if (dma_queue_count == DMA_QUEUE_SIZE) {
+        /* Full, make room by finishing the oldest requests */
+        nsp_dma_service(1, 0);
+    }
+
+    NspDmaRequest* req = &dma_queue[(dma_queue_first + dma_queue_count) % DMA_QUEUE_SIZE];
+    req->ram = ram;
+    req->vrom = vrom;
+    req->size = size;
+    req->done = 0;
+    req->queue = queue;
+    req->msg = msg;
+    dma_queue_count++;
+    return 0;
 }
 
 /* DmaMgr_SendRequestImpl — the core DMA function in MM */
 s32 DmaMgr_SendRequestImpl(void* request, void* ram, u32 vrom, u32 size) {
+    nsp_dma_flush();
     return nsp_rom_read(vrom, ram, size);
 }
 
+/* Reads from a physical ROM offset, for callers that translated the VROM themselves */
+s32 DmaMgr_DmaRomToRam(u32 rom, void* ram, u32 size) {
+    return nsp_rom_read_raw(rom, ram, size);
+}
+
+/* The DMA table is the ROM file's own, see main_nsp.c. The entries are laid
+ * out like DmaEntry, in host byte order. */
+void* DmaMgr_FindDmaEntry(u32 vrom) {
+    return nsp_rom_find_entry(vrom);
+}
+
+s32 DmaMgr_TranslateVromToRom(u32 vrom) {
+    return nsp_rom_translate(vrom);
+}
+
 /* ============================================================
  * Overlay Loading Replacements (Static Linking)
  *
@@ -226,17 +557,18 @@ void* Overlay_AllocateAndLoad(u32 vromStart, u32 vromEnd, void* vramStart, void*
  * SysCfb — Framebuffer allocation
  * ============================================================ */
 
-/* MM's framebuffer globals */
-static uint16_t gWorkBufferStorage[SCREEN_WIDTH * SCREEN_HEIGHT] __attribute__((aligned(64)));
-static uint16_t gZBufferStorage[SCREEN_WIDTH * SCREEN_HEIGHT] __attribute__((aligned(64)));
-
-void* gWorkBuffer = gWorkBufferStorage;
+/* MM's framebuffer globals. The renderer draws into gfx_output and its own
+ * depth buffer at the render resolution, see gfx_soft_set_resolution, these
+ * are only images the game reads and writes itself: the saved frame of the
+ * pause menu and the transitions, and the picto box photo. They keep MM's
+ * 320x240 RGBA16 layout. */
+void* gWorkBuffer = NULL;
 void* gWorkBufferLoRes = NULL;
 void* gZBufferLoRes = NULL;
 
 void SysCfb_Init(void) {
-    /* Framebuffers are statically allocated above */
-    gWorkBufferLoRes = gWorkBufferStorage;
+    /* Graph_ThreadEntry allocates both in one block right before this */
+    gWorkBuffer = gWorkBufferLoRes;
 }
 
 /* ============================================================
@@ -274,9 +606,30 @@ void Fault_SetFrameBuffer(void* fb, s32 w, s32 h) {
     (void)w;
     (void)h;
 }
+
+#if MEM_STATS
+#define MEMSTATS_CRASH_FILENAME "mm-nsp-mem.csv.tns"
+
+/* Most crashes are an allocation that failed, what every pool held goes to
+ * the console and to a file next to the game */
+static void nsp_fault_dump_memory(void) {
+    FILE* f = fopen(MEMSTATS_CRASH_FILENAME, "w");
+
+    memstats_dump(stdout);
+    if (f != NULL) {
+        memstats_dump(f);
+        fclose(f);
+    }
+}
+#endif
+
 void Fault_AddHungupAndCrash(const char* file, s32 line) {
     (void)file;
     (void)line;
+#if MEM_STATS
+    printf("Crash at %s:%d\n", file, (int)line);
+    nsp_fault_dump_memory();
+#endif
     /* On Nspire: just exit */
 #ifdef TARGET_NSP
     exit(1);
@@ -285,6 +638,10 @@ void Fault_AddHungupAndCrash(const char* file, s32 line) {
 void Fault_AddHungupAndCrashImpl(const char* str1, const char* str2) {
     (void)str1;
     (void)str2;
+#if MEM_STATS
+    printf("Crash: %s %s\n", str1, str2);
+    nsp_fault_dump_memory();
+#endif
 #ifdef TARGET_NSP
     exit(1);
 #endif
@@ -478,18 +835,61 @@ void Rumble_Destroy(void) {
 }
 
 /* Timer */
+#ifdef TARGET_NSP
+/* The CX's second timer, an SP804 counting down at 32768 Hz. The OS gets its setup back in tmr_deinit */
+#define TMR_REGS ((volatile uint32_t*)0x900D0000)
+#define TMR_LOAD 0
+#define TMR_VALUE 1
+#define TMR_CONTROL 2
+#define TMR_CONTROL_RUN 0x82 /* enabled, free running, no interrupt, 32-bit */
+#define TMR_HZ_SHIFT 15      /* 32768 Hz */
+
+static uint32_t tmr_saved_load, tmr_saved_control;
+static uint32_t tmr_start_ticks;
+static bool tmr_running;
+#else
+/* The host build's, see gfx_host.c */
+static struct timespec tmr_start_time;
+#endif
+
 void tmr_init(void) {
 #ifdef TARGET_NSP
-    /* Initialize Ndless timer */
+    if (!tmr_running) {
+        tmr_saved_load = TMR_REGS[TMR_LOAD];
+        tmr_saved_control = TMR_REGS[TMR_CONTROL];
+        TMR_REGS[TMR_CONTROL] = 0;
+        TMR_REGS[TMR_LOAD] = 0xFFFFFFFF;
+        TMR_REGS[TMR_CONTROL] = TMR_CONTROL_RUN;
+        tmr_running = true;
+    }
+    tmr_start_ticks = TMR_REGS[TMR_VALUE];
+#else
+    clock_gettime(CLOCK_MONOTONIC, &tmr_start_time);
+#endif
+}
+
+void tmr_deinit(void) {
+#ifdef TARGET_NSP
+    if (tmr_running) {
+        TMR_REGS[TMR_CONTROL] = 0;
+        TMR_REGS[TMR_LOAD] = tmr_saved_load;
+        TMR_REGS[TMR_CONTROL] = tmr_saved_control;
+        tmr_running = false;
+    }
 #endif
 }
 
 uint32_t tmr_ms(void) {
 #ifdef TARGET_NSP
-    /* Return ms since timer init */
-    return 0; /* TODO: implement with Ndless timer */
+    /* Ms since tmr_init, the count wraps after a day and a half */
+    const uint32_t ticks = tmr_start_ticks - TMR_REGS[TMR_VALUE];
+
+    return (uint32_t)(((uint64_t)ticks * 1000) >> TMR_HZ_SHIFT);
 #else
-    return 0;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((now.tv_sec - tmr_start_time.tv_sec) * 1000 + (now.tv_nsec - tmr_start_time.tv_nsec) / 1000000);
 #endif
 }
 
@@ -126,6 +126,9 @@ static inline void osSetThreadPri(OSThread* thread, s32 pri) {
         thread->priority = pri;
 }
 
+/* Finishes the DMAs DmaMgr_RequestAsync queued, see nsp_replacements.c */
+extern void nsp_dma_flush(void);
+
 /* Message queue functions — simplified single-message queue */
 static inline void osCreateMesgQueue(OSMesgQueue* mq, OSMesg* msg, s32 count) {
     mq->msg = msg;
@@ -145,6 +148,10 @@ static inline s32 osSendMesg(OSMesgQueue* mq, OSMesg msg, s32 flag) {
 }
 
 static inline s32 osRecvMesg(OSMesgQueue* mq, OSMesg* msg, s32 flag) {
+    if (mq->validCount == 0 && flag == OS_MESG_BLOCK) {
+        /* The message may be a queued DMA's, which nothing else would ever finish */
+        nsp_dma_flush();
+    }
     if (mq->validCount > 0) {
         if (msg)
             *msg = mq->msg[mq->first];
@@ -198,10 +205,22 @@ static inline void osInvalDCache(void* addr, s32 len) {
     (void)addr;
     (void)len;
 }
+#if OVERLAY_PAGING && defined(TARGET_NSP)
+/* Only the overlay loaders call this, after writing code the ARM926's
+ * split caches don't see yet, see overlay_nsp.c: clean the data cache
+ * lines it went through, drain the write buffer, drop the instructions */
+static inline void osInvalICache(void* addr, s32 len) {
+    for (uintptr_t p = (uintptr_t)addr & ~31; p < (uintptr_t)addr + len; p += 32)
+        __asm__ volatile("mcr p15, 0, %0, c7, c10, 1" : : "r"(p) : "memory");
+    __asm__ volatile("mcr p15, 0, %0, c7, c10, 4" : : "r"(0) : "memory");
+    __asm__ volatile("mcr p15, 0, %0, c7, c5, 0" : : "r"(0) : "memory");
+}
+#else
 static inline void osInvalICache(void* addr, s32 len) {
     (void)addr;
     (void)len;
 }
+#endif
 static inline void osWritebackDCache(void* addr, s32 len) {
     (void)addr;
     (void)len;
@@ -257,6 +276,23 @@ static inline s32 osPiStartDma(void* ioMesg, s32 priority, s32 direction, u32 de
     return 0;
 }
 
+/* AI (Audio Interface) — audio_nsp.c hands its mixed batches on itself */
+static inline s32 osAiSetNextBuffer(void* buf, u32 size) {
+    (void)buf;
+    (void)size;
+    return 0;
+}
+
+/* What AudioThread_Update sizes its frames from: this much still playing
+ * makes it ask for numSamplesPerFrameTarget samples */
+static inline u32 osAiGetLength(void) {
+    return (9 * 16) * 4;
+}
+
+static inline s32 osAiSetFrequency(u32 freq) {
+    return freq;
+}
+
 /* Memory allocation */
 static inline void* osGetMemSize(void) {
     return (void*)0x04000000; /* 64MB */
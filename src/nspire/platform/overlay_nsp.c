@@ -0,0 +1,109 @@
+/**
+ * overlay_nsp.c — Actor and effect overlays paged in from the asset pack
+ *
+ * The port links the overlays it runs into the executable, and every one
+ * of them holds its RAM for the whole run, whether or not the scene has
+ * the actor. With OVERLAY_PAGING, the overlays in PAGED_OVERLAYS are left
+ * out of it. Each is linked on its own at the address the N64 gives its
+ * overlays, against the symbols of the executable, and stored in the asset
+ * pack in place of its ROM file by tools/mknspovl.py. It is laid out as an
+ * N64 overlay: text, data, rodata, then the relocation section fado would
+ * write. ARM's R_ARM_ABS32 has the number of R_MIPS_32, so the relocation
+ * words are the N64's.
+ *
+ * At startup nsp_overlay_init points the entries of gActorOverlayTable and
+ * gEffectSsOverlayTable that have an overlay in the pack at its addresses.
+ * From there the game pages them itself, as on the N64: the first actor of
+ * a kind to spawn allocates its overlay in the zone, Overlay_Load reads it
+ * through nsp_overlay_read and relocates it with Overlay_Relocate, and the
+ * last one to go frees it again. So the executable only holds the
+ * overlays every scene needs, and the RAM the others took stays free for
+ * the texture cache and the heaps, until a scene loads them.
+ *
+ * The words in an overlay that point into the executable were resolved
+ * against the address it was linked at, which is not where Ndless loads
+ * it. They are listed after the overlay and moved by as much as
+ * nsp_overlay_anchor was. Calls into the executable go through such words,
+ * the overlays are built with -mlong-calls as a BL doesn't reach across
+ * the RAM. The pack has to be rebuilt with the executable it goes with.
+ *
+ * Game state overlays stay in the executable: all but play are small,
+ * and play is loaded the whole time the game is.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "z64actor_dlftbls.h"
+#include "z64effect_ss.h"
+#include "nsp_pack.h"
+
+#define NSP_OVERLAY_RELOC_CHUNK 64 /* offsets of words into the executable read at a time */
+
+/* Its address in the executable as linked is in every overlay, the difference is how far the
+ * executable was moved */
+const uint32_t nsp_overlay_anchor = 0x4F564C59; /* "OVLY" */
+
+/* Points an overlay table entry at the overlay the pack has for its ROM file, if there is one */
+static bool nsp_overlay_page(const RomFile* file, void** vramStart, void** vramEnd, void** profile) {
+    struct NspPackOverlay ovl;
+
+    if (file->vromStart == 0 || !nsp_pack_overlay(file->vromStart, 0, &ovl, sizeof(ovl)))
+        return false;
+    *vramStart = (void*)(uintptr_t)ovl.vram_start;
+    *vramEnd = (void*)(uintptr_t)ovl.vram_end;
+    *profile = (void*)(uintptr_t)ovl.profile;
+    return true;
+}
+
+/* Called once the asset pack is open, before the game starts */
+void nsp_overlay_init(void) {
+    for (int i = 0; i < ACTOR_ID_MAX; i++) {
+        ActorOverlay* entry = &gActorOverlayTable[i];
+        void* profile;
+
+        if (nsp_overlay_page(&entry->file, &entry->vramStart, &entry->vramEnd, &profile))
+            entry->profile = profile;
+    }
+    for (int i = 0; i < EFFECT_SS_TYPE_MAX; i++) {
+        EffectSsOverlay* entry = &gEffectSsOverlayTable[i];
+        void* profile;
+
+        if (nsp_overlay_page(&entry->file, &entry->vramStart, &entry->vramEnd, &profile))
+            entry->profile = profile;
+    }
+}
+
+/**
+ * Reads the overlay that replaces the ROM file at vromStart to ram, where
+ * Overlay_Load allocated room for it, and moves the words that point into
+ * the executable. Returns the size of the overlay file, its relocation
+ * section ends it as on the N64.
+ */
+size_t nsp_overlay_read(void* ram, uintptr_t vromStart) {
+    const uintptr_t anchor = (uintptr_t)&nsp_overlay_anchor;
+    struct NspPackOverlay ovl;
+    uint32_t offsets[NSP_OVERLAY_RELOC_CHUNK];
+
+    if (!nsp_pack_overlay(vromStart, 0, &ovl, sizeof(ovl)) ||
+        !nsp_pack_overlay(vromStart, sizeof(ovl), ram, ovl.image_size)) {
+        printf("Could not read the overlay at 0x%08lX from the asset pack\n", (unsigned long)vromStart);
+        abort();
+    }
+
+    for (uint32_t done = 0; done < ovl.num_exe_relocs;) {
+        const uint32_t n =
+            (ovl.num_exe_relocs - done < NSP_OVERLAY_RELOC_CHUNK) ? ovl.num_exe_relocs - done : NSP_OVERLAY_RELOC_CHUNK;
+
+        if (!nsp_pack_overlay(vromStart, sizeof(ovl) + ovl.image_size + done * sizeof(uint32_t), offsets,
+                              n * sizeof(uint32_t))) {
+            printf("Could not read the overlay at 0x%08lX from the asset pack\n", (unsigned long)vromStart);
+            abort();
+        }
+        for (uint32_t i = 0; i < n; i++)
+            *(uint32_t*)((uintptr_t)ram + offsets[i]) += anchor - ovl.exe_anchor;
+        done += n;
+    }
+    return ovl.image_size;
+}
@@ -0,0 +1,218 @@
+/**
+ * pipeline_nsp.c — Two stage frame pipeline: game update → rasterization
+ *
+ * Graph_ExecuteAndDraw builds every frame into one of MM's two GfxPools and
+ * flips to the other one for the next frame, which is what let the N64 run
+ * the CPU a frame ahead of the RCP. A frame here goes through the same two
+ * stages: the producer (the game update) submits the finished master DL of
+ * its pool, and the consumer (the DL walk, the rasterizer and the blit)
+ * draws the newest submitted frame.
+ *
+ * On the single core the stages are interleaved cooperatively: the producer
+ * yields to the consumer right after every submit, and the consumer either
+ * draws the frame or drops it. Dropping only skips its rasterization, the
+ * game keeps updating every iteration. A frame is dropped when:
+ * - frame_pacing is 0: it isn't the (frameskip + 1)th in a row, as before
+ * - frame_pacing is N ms: the game is already behind its N ms a frame
+ *   schedule, and fewer than frameskip frames were dropped in a row
+ * A frame that saves the color buffer for the game to read back, the pause
+ * menu background or a picto box photo, is never dropped.
+ *
+ * With DRAW_SKIP the decision for a frame is made before the game builds
+ * it, see nsp_pipe_plan, so that the game can leave out of a frame it knows
+ * will be dropped the drawing that changes none of its state.
+ *
+ * The slots keep their state so the consumer can later run on a thread of
+ * its own: the producer then only has to wait before it reuses a pool whose
+ * frame is still drawing, see nsp_pipe_wait_pool.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "nspire/profiling.h"
+
+/* Timer, from nsp_replacements.c */
+extern uint32_t tmr_ms(void);
+
+/* Config */
+extern unsigned int configFrameskip;
+extern unsigned int configFramePacing;
+
+/* ============================================================
+ * Frame slots
+ * ============================================================ */
+
+#define NSP_PIPE_DEPTH 2 /* one frame per GfxPool */
+
+typedef enum {
+    NSP_FRAME_FREE,    /* its pool can be built into */
+    NSP_FRAME_READY,   /* built, waiting to be drawn or dropped */
+    NSP_FRAME_DRAWING, /* the consumer is reading its pool */
+} NspFrameState;
+
+typedef struct {
+    void* dl;     /* master DL, inside its GfxPool */
+    uint32_t seq; /* submission order */
+    bool keep;    /* saves the color buffer, see nsp_pipe_keep_frame */
+#if DRAW_SKIP
+    bool planned; /* drop was decided before it was built */
+    bool drop;
+#endif
+    volatile NspFrameState state;
+} NspFrame;
+
+static NspFrame nsp_frames[NSP_PIPE_DEPTH];
+static uint32_t nsp_submit_seq;
+static uint32_t nsp_dropped_in_row;
+static bool nsp_pace_started;
+static uint32_t nsp_pace_base; /* when frame nsp_pace_seq was due */
+static uint32_t nsp_pace_seq;
+static uint32_t nsp_updates_since; /* game updates since the last drawn frame */
+static bool nsp_keep_next;         /* the frame being built has to be drawn */
+#if DRAW_SKIP
+static bool nsp_planned_next; /* the frame being built has its drop decided */
+static bool nsp_drop_next;
+#endif
+
+static NspFrame* nsp_pipe_slot(void* dl) {
+    NspFrame* free_slot = NULL;
+    for (int i = 0; i < NSP_PIPE_DEPTH; i++) {
+        if (nsp_frames[i].dl == dl)
+            return &nsp_frames[i];
+        if (free_slot == NULL && nsp_frames[i].dl == NULL)
+            free_slot = &nsp_frames[i];
+    }
+    return free_slot;
+}
+
+/**
+ * Blocks until the frame built in the pool of dl isn't being read anymore.
+ * With the interleaved consumer nothing is ever drawing while the producer
+ * runs, so this returns right away.
+ */
+void nsp_pipe_wait_pool(void* dl) {
+    NspFrame* f = nsp_pipe_slot(dl);
+    while (f != NULL && f->state == NSP_FRAME_DRAWING) {
+    }
+}
+
+/* ============================================================
+ * Producer
+ * ============================================================ */
+
+/**
+ * Keeps the frame being built from being dropped: its DL copies the color
+ * buffer into an image the game reads afterwards, see prerender_nsp.c.
+ */
+void nsp_pipe_keep_frame(void) {
+    nsp_keep_next = true;
+}
+
+/**
+ * Hands over a frame the game finished building. An older frame still
+ * waiting is superseded and dropped, only the newest one is worth drawing.
+ */
+void nsp_pipe_submit(void* dl) {
+    NspFrame* f = nsp_pipe_slot(dl);
+    if (f == NULL)
+        return; /* more master DLs than pools, can't happen with MM's two */
+
+    nsp_pipe_wait_pool(dl);
+    for (int i = 0; i < NSP_PIPE_DEPTH; i++) {
+        if (&nsp_frames[i] != f && nsp_frames[i].state == NSP_FRAME_READY)
+            nsp_frames[i].state = NSP_FRAME_FREE;
+    }
+
+    f->dl = dl;
+    f->seq = nsp_submit_seq++;
+    f->keep = nsp_keep_next;
+    nsp_keep_next = false;
+#if DRAW_SKIP
+    f->planned = nsp_planned_next;
+    f->drop = nsp_drop_next;
+    nsp_planned_next = false;
+#endif
+    f->state = NSP_FRAME_READY;
+    nsp_updates_since++;
+}
+
+/* ============================================================
+ * Consumer
+ * ============================================================ */
+
+/* Whether frame seq keeps up with frameskip and frame_pacing if it's drawn */
+static bool nsp_pipe_on_schedule(uint32_t seq) {
+    if (nsp_dropped_in_row >= configFrameskip)
+        return true; /* worst case, 1 out of every (frameskip + 1) frames */
+    if (configFramePacing == 0)
+        return false;
+
+    /* Where the game should be by now at one frame every frame_pacing ms */
+    const uint32_t now = tmr_ms();
+    if (!nsp_pace_started) {
+        nsp_pace_started = true;
+        nsp_pace_base = now;
+        nsp_pace_seq = seq;
+    }
+    const uint32_t due = nsp_pace_base + (seq - nsp_pace_seq) * configFramePacing;
+    if ((int32_t) (now - due) > (int32_t) (configFramePacing * (configFrameskip + 1))) {
+        /* Too far behind to ever catch up by dropping, forget the debt */
+        nsp_pace_base = now;
+        nsp_pace_seq = seq;
+        return true;
+    }
+    return (int32_t) (now - due) <= 0;
+}
+
+static bool nsp_pipe_should_draw(const NspFrame* f) {
+    if (f->keep)
+        return true;
+#if DRAW_SKIP
+    if (f->planned)
+        return !f->drop;
+#endif
+    return nsp_pipe_on_schedule(f->seq);
+}
+
+#if DRAW_SKIP
+/**
+ * Decides whether the next frame the game builds will be dropped, before it
+ * starts building it. Called right after nsp_pipe_run, so the frames dropped
+ * in a row are up to date. A frame that turns out to save the color buffer
+ * is still drawn, the game builds those whole.
+ */
+bool nsp_pipe_plan(void) {
+    nsp_drop_next = !nsp_pipe_on_schedule(nsp_submit_seq);
+    nsp_planned_next = true;
+    return nsp_drop_next;
+}
+#endif
+
+/**
+ * Runs the consumer stage once: draws the newest ready frame with draw, or
+ * drops it when the game is behind. Returns whether it drew.
+ */
+bool nsp_pipe_run(void (*draw)(void* dl)) {
+    NspFrame* f = NULL;
+    for (int i = 0; i < NSP_PIPE_DEPTH; i++) {
+        if (nsp_frames[i].state == NSP_FRAME_READY && (f == NULL || nsp_frames[i].seq > f->seq))
+            f = &nsp_frames[i];
+    }
+    if (f == NULL)
+        return false;
+
+    if (!nsp_pipe_should_draw(f)) {
+        f->state = NSP_FRAME_FREE;
+        nsp_dropped_in_row++;
+        return false;
+    }
+
+    f->state = NSP_FRAME_DRAWING;
+    prof_frame.count[PROF_UPDATES] += nsp_updates_since;
+    nsp_updates_since = 0;
+    nsp_dropped_in_row = 0;
+    draw(f->dl);
+    f->state = NSP_FRAME_FREE;
+    return true;
+}
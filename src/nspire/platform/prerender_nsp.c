@@ -0,0 +1,700 @@
+/**
+ * prerender_nsp.c — PreRender's framebuffer copies and filters on the color buffer
+ *
+ * PreRender.c saves the frame for the pause menu background, the picto box
+ * photo, the transition tiles and motion blur with RDP copies between RGBA16
+ * images, reads the coverage back through the blender, and smooths the
+ * saved frame with the VI anti-aliasing and divot filters on the CPU. The
+ * software renderer draws everything into gfx_output at its own resolution
+ * and ignores SETCIMG, so the DLs PreRender.c builds would only draw the
+ * copies over the frame, through the slow S2DEX and texrect paths.
+ *
+ * The functions building those DLs emit a G_NSP_FBOP instead, which the
+ * frontend hands to nsp_prerender_run_op when the DL runs: a row by row blit
+ * between gfx_output and the RGBA16 image, scaled between the two
+ * resolutions, or a fade of one over the other. A frame saving the color
+ * buffer is never dropped by the pipeline, the game reads the image back
+ * over the next frames.
+ *
+ * The renderer keeps no coverage and doesn't leave partially covered edges
+ * for the VI filters to fix, so the coverage of gfx_output reads as full
+ * everywhere. The divot filter checks the coverage of a row a word at a time
+ * and only unpacks the rows it has to filter, and the AA filter only runs
+ * with prerender_aa set. Both filter partially covered pixels the same as
+ * PreRender.c, the pixels are unpacked from RGBA5551 with shifts so the
+ * saved frame stays in the layout the picto box code expects. There is no
+ * slowly thread either: the filters run right away, so the pause menu opens
+ * on the next frame instead of after the thread got through the image.
+ *
+ * Prerender_DrawBackground2D emits a G_NSP_FBOP_BG for the room images and
+ * the pages of Grandma's story, S2DEX backgrounds the frontend has no way
+ * to draw. The first frame decodes the image into the color buffer's pixel
+ * format at its resolution, the frames after it copy the rows with memcpy
+ * for as long as the same image is drawn.
+ *
+ * The functions this replaces are left out of PreRender.c with
+ * PRERENDER_NATIVE.
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "z64prerender.h"
+#include "color.h"
+#include "macros.h"
+
+#include "gfx_backend.h"
+#include "gfx_frontend.h"
+
+/* Config */
+extern bool configPrerenderAA;
+
+/* Pipeline, see pipeline_nsp.c */
+extern void nsp_pipe_keep_frame(void);
+
+/* ============================================================
+ * Display list side
+ * ============================================================ */
+
+/* A NULL image in a G_NSP_FBOP is the color buffer */
+static void* nsp_fbop_image(PreRender* this, void* img) {
+    return (img == this->fbuf) ? NULL : img;
+}
+
+static void nsp_fbop_emit(PreRender* this, Gfx** gfxP, u32 op, u32 env, void* src, void* dst) {
+    Gfx* gfx = *gfxP;
+
+    src = nsp_fbop_image(this, src);
+    dst = nsp_fbop_image(this, dst);
+    if (src == NULL && dst == NULL)
+        return; /* the color buffer over itself */
+
+    if (dst != NULL)
+        nsp_pipe_keep_frame();
+
+    gNspFramebufferOp(gfx, op, this->width, this->height, env, src, dst);
+    *gfxP = gfx;
+}
+
+void PreRender_CopyImage(PreRender* this, Gfx** gfxP, void* img, void* imgDst, u32 useThresholdAlphaCompare) {
+    nsp_fbop_emit(this, gfxP, (useThresholdAlphaCompare == true) ? G_NSP_FBOP_COPY_AC : G_NSP_FBOP_COPY, 0, img,
+                  imgDst);
+}
+
+void func_8016FF90(PreRender* this, Gfx** gfxP, void* buf, void* bufSave, s32 envR, s32 envG, s32 envB, s32 envA) {
+    if ((envR & envG & envB & envA) == 255) {
+        nsp_fbop_emit(this, gfxP, G_NSP_FBOP_COPY, 0, buf, bufSave);
+    } else {
+        nsp_fbop_emit(this, gfxP, G_NSP_FBOP_FADE, (envR << 24) | (envG << 16) | (envB << 8) | envA, buf, bufSave);
+    }
+}
+
+void PreRender_CoverageRgba16ToI8(PreRender* this, Gfx** gfxP, void* img, void* cvgDst) {
+    nsp_fbop_emit(this, gfxP, G_NSP_FBOP_CVG, 0, img, cvgDst);
+}
+
+/**
+ * The coverage is read straight from the color buffer by the G_NSP_FBOP_CVG
+ * PreRender_CoverageRgba16ToI8 emits, the frame isn't overwritten with it.
+ */
+void PreRender_FetchFbufCoverage(PreRender* this, Gfx** gfxP) {
+}
+
+/**
+ * Blending is off, coverage only ever went to the VI filters: a copy of
+ * `this->fbufSave`.
+ */
+void func_80170798(PreRender* this, Gfx** gfxP) {
+    if (this->cvgSave != NULL) {
+        nsp_fbop_emit(this, gfxP, G_NSP_FBOP_COPY, 0, this->fbufSave, this->fbuf);
+    }
+}
+
+/**
+ * The room images and Grandma's story are S2DEX backgrounds the frontend
+ * can't draw. They go in a G_NSP_FBOP_BG instead, which decodes the image
+ * into the color buffer's pixels once and copies it from then on. Only the
+ * unscaled CI8 images with an RGBA16 TLUT and RGBA16 images the game draws
+ * are supported, the others are left out as before.
+ */
+void Prerender_DrawBackground2D(Gfx** gfxP, void* timg, void* tlut, u16 width, u16 height, u8 fmt, u8 siz, u16 tt,
+                                u16 tlutCount, f32 x, f32 y, f32 xScale, f32 yScale, u32 flags) {
+    Gfx* gfx = *gfxP;
+    const bool ci8 = (fmt == G_IM_FMT_CI) && (siz == G_IM_SIZ_8b) && (tlut != NULL) && (tt == G_TT_RGBA16);
+    const bool rgba16 = (fmt == G_IM_FMT_RGBA) && (siz == G_IM_SIZ_16b);
+    const s16 frameX = x * 4;
+    const s16 frameY = y * 4;
+
+    if ((!ci8 && !rgba16) || (xScale != 1.0f) || (yScale != 1.0f) || (width >= 1 << 10) || (height >= 1 << 10))
+        return;
+
+    gNspFramebufferOp(gfx, G_NSP_FBOP_BG, width, height, ((u32)(u16)frameX << 16) | (u16)frameY, timg,
+                      ci8 ? tlut : NULL);
+    *gfxP = gfx;
+}
+
+/* ============================================================
+ * Framebuffer ops, when the DL runs
+ * ============================================================ */
+
+#define NSP_RGBA16(r, g, b) (((r) << 11) | ((g) << 6) | ((b) << 1) | 1)
+#define NSP_EXPAND_5_8(v) (((v) << 3) | ((v) >> 2))
+
+#if OUTPUT_RGB565
+static inline u16 nsp_pixel_to_rgba16(gfx_pixel_t p) {
+    return (p & 0xFFC0) | ((p & 0x1F) << 1) | 1;
+}
+
+static inline gfx_pixel_t nsp_rgba16_to_pixel(u16 p) {
+    return (p & 0xFFC0) | ((p >> 5) & 0x20) | ((p >> 1) & 0x1F);
+}
+#else
+static inline u16 nsp_pixel_to_rgba16(gfx_pixel_t p) {
+    return ((p << 8) & 0xF800) | ((p >> 5) & 0x07C0) | ((p >> 18) & 0x3E) | 1;
+}
+
+static inline gfx_pixel_t nsp_rgba16_to_pixel(u16 p) {
+    const u32 r = RGBA16_GET_R(p), g = RGBA16_GET_G(p), b = RGBA16_GET_B(p);
+    return 0xFF000000 | (NSP_EXPAND_5_8(b) << 16) | (NSP_EXPAND_5_8(g) << 8) | NSP_EXPAND_5_8(r);
+}
+#endif
+
+/* What every 5 bit channel value of the src and of the dst adds up to in a fade, in 8 bits */
+typedef struct {
+    u8 src[3][32];
+    u8 dst[32];
+} NspFadeTable;
+
+static void nsp_fade_table_init(NspFadeTable* tab, u32 env) {
+    const u32 a = env & 0xFF;
+
+    for (u32 v = 0; v < 32; v++) {
+        const u32 c = NSP_EXPAND_5_8(v);
+
+        for (u32 i = 0; i < 3; i++) {
+            const u32 envC = (env >> (24 - i * 8)) & 0xFF;
+
+            tab->src[i][v] = (c * envC / 255) * a / 255;
+        }
+        tab->dst[v] = c * (255 - a) / 255;
+    }
+}
+
+static inline u16 nsp_fade(const NspFadeTable* tab, u16 src, u16 dst) {
+    const u32 r = tab->src[0][RGBA16_GET_R(src)] + tab->dst[RGBA16_GET_R(dst)];
+    const u32 g = tab->src[1][RGBA16_GET_G(src)] + tab->dst[RGBA16_GET_G(dst)];
+    const u32 b = tab->src[2][RGBA16_GET_B(src)] + tab->dst[RGBA16_GET_B(dst)];
+
+    return NSP_RGBA16(r >> 3, g >> 3, b >> 3);
+}
+
+/* Into a width x height RGBA16 image, from another one or from the color buffer */
+static void nsp_fbop_to_image(u32 op, u32 width, u32 height, const NspFadeTable* tab, const u16* src, u16* dst) {
+    const u32 colorW = gfx_current_dimensions.width;
+    const u32 colorH = gfx_current_dimensions.height;
+    u16 row[SCREEN_WIDTH];
+    u16 colOf[SCREEN_WIDTH]; /* color buffer column of every image column */
+
+    if (src != NULL && op == G_NSP_FBOP_COPY) {
+        memcpy(dst, src, width * height * sizeof(u16));
+        return;
+    }
+    if (src == NULL) {
+        for (u32 x = 0; x < width; x++)
+            colOf[x] = x * colorW / width;
+    }
+
+    for (u32 y = 0; y < height; y++) {
+        const u16* in;
+        u16* out = dst + y * width;
+
+        if (src != NULL) {
+            in = src + y * width;
+        } else {
+            const gfx_pixel_t* line = gfx_output + (y * colorH / height) * colorW;
+
+            for (u32 x = 0; x < width; x++)
+                row[x] = nsp_pixel_to_rgba16(line[colOf[x]]);
+            in = row;
+        }
+
+        switch (op) {
+            case G_NSP_FBOP_COPY:
+                memcpy(out, in, width * sizeof(u16));
+                break;
+            case G_NSP_FBOP_COPY_AC:
+                for (u32 x = 0; x < width; x++) {
+                    if (in[x] & 1)
+                        out[x] = in[x];
+                }
+                break;
+            case G_NSP_FBOP_FADE:
+                for (u32 x = 0; x < width; x++)
+                    out[x] = nsp_fade(tab, in[x], out[x]);
+                break;
+        }
+    }
+}
+
+/* Into the color buffer from a width x height RGBA16 image */
+static void nsp_fbop_to_color(u32 op, u32 width, u32 height, const NspFadeTable* tab, const u16* src) {
+    const u32 colorW = gfx_current_dimensions.width;
+    const u32 colorH = gfx_current_dimensions.height;
+    u16 colOf[SCREEN_WIDTH]; /* image column of every color buffer column */
+
+    for (u32 x = 0; x < colorW; x++)
+        colOf[x] = x * width / colorW;
+
+    for (u32 y = 0; y < colorH; y++) {
+        const u16* in = src + (y * height / colorH) * width;
+        gfx_pixel_t* out = gfx_output + y * colorW;
+
+        switch (op) {
+            case G_NSP_FBOP_COPY:
+                for (u32 x = 0; x < colorW; x++)
+                    out[x] = nsp_rgba16_to_pixel(in[colOf[x]]);
+                break;
+            case G_NSP_FBOP_COPY_AC:
+                for (u32 x = 0; x < colorW; x++) {
+                    const u16 p = in[colOf[x]];
+
+                    if (p & 1)
+                        out[x] = nsp_rgba16_to_pixel(p);
+                }
+                break;
+            case G_NSP_FBOP_FADE:
+                for (u32 x = 0; x < colorW; x++)
+                    out[x] = nsp_rgba16_to_pixel(nsp_fade(tab, in[colOf[x]], nsp_pixel_to_rgba16(out[x])));
+                break;
+        }
+    }
+}
+
+/* The last background drawn, decoded for the color buffer */
+static struct {
+    gfx_pixel_t* pixels;
+    u8* opaque; /* whether each pixel is drawn, the texels without alpha aren't */
+    bool holes; /* some pixels aren't drawn */
+    u32 width, height; /* decoded */
+    u32 colorW, colorH; /* of the color buffer it was decoded for */
+    const u8* img;
+    u32 imgW, imgH;
+    u32 key;
+} sNspBg;
+
+/**
+ * Tells apart the backgrounds loaded over each other at the same address,
+ * like the images of the rooms and the pages of the story: their TLUT and
+ * 256 texels spread over the image. Two images of a scene differ all over.
+ */
+static u32 nsp_bg_key(const u8* img, u32 size, const u8* tlut) {
+    u32 hash = 0x811C9DC5;
+
+    if (tlut != NULL) {
+        for (u32 i = 0; i < 256 * sizeof(u16); i++)
+            hash = (hash ^ tlut[i]) * 0x01000193;
+    }
+    for (u32 i = 0; i < 256; i++)
+        hash = (hash ^ img[(size - 1) * i / 255]) * 0x01000193;
+    return hash;
+}
+
+/* Decodes the CI8 or RGBA16 image at the size it covers in the color buffer */
+static bool nsp_bg_decode(const u8* img, u32 imgW, u32 imgH, const u8* tlut, u32 key) {
+    const u32 colorW = gfx_current_dimensions.width;
+    const u32 colorH = gfx_current_dimensions.height;
+    const u32 width = imgW * colorW / SCREEN_WIDTH;
+    const u32 height = imgH * colorH / SCREEN_HEIGHT;
+    const u32 bytes = (tlut != NULL) ? 1 : 2;
+
+    sNspBg.img = NULL;
+    if (width == 0 || height == 0)
+        return false;
+
+    if (sNspBg.pixels == NULL || sNspBg.width * sNspBg.height != width * height) {
+        free(sNspBg.pixels);
+        free(sNspBg.opaque);
+        sNspBg.pixels = malloc(width * height * sizeof(gfx_pixel_t));
+        sNspBg.opaque = malloc(width * height);
+        if (sNspBg.pixels == NULL || sNspBg.opaque == NULL) {
+            free(sNspBg.pixels);
+            free(sNspBg.opaque);
+            sNspBg.pixels = NULL;
+            sNspBg.opaque = NULL;
+            return false;
+        }
+    }
+
+    sNspBg.holes = false;
+    for (u32 y = 0; y < height; y++) {
+        const u8* in = img + (y * imgH / height) * imgW * bytes;
+        gfx_pixel_t* out = sNspBg.pixels + y * width;
+        u8* opaque = sNspBg.opaque + y * width;
+
+        for (u32 x = 0; x < width; x++) {
+            const u8* texel = in + (x * imgW / width) * bytes;
+            const u8* color = (tlut != NULL) ? &tlut[*texel * 2] : texel;
+            const u16 p = (color[0] << 8) | color[1];
+
+            out[x] = nsp_rgba16_to_pixel(p);
+            opaque[x] = p & 1;
+            sNspBg.holes |= !(p & 1);
+        }
+    }
+
+    sNspBg.width = width;
+    sNspBg.height = height;
+    sNspBg.colorW = colorW;
+    sNspBg.colorH = colorH;
+    sNspBg.img = img;
+    sNspBg.imgW = imgW;
+    sNspBg.imgH = imgH;
+    sNspBg.key = key;
+    return true;
+}
+
+/**
+ * Draws the imgW x imgH background at the s10.2 frame offset, decoding it
+ * only when it isn't the one decoded last
+ */
+static void nsp_bg_draw(u32 imgW, u32 imgH, u32 frame, const u8* img, const u8* tlut) {
+    const u32 colorW = gfx_current_dimensions.width;
+    const u32 colorH = gfx_current_dimensions.height;
+    const u32 key = nsp_bg_key(img, imgW * imgH * ((tlut != NULL) ? 1 : 2), tlut);
+    s32 x0;
+    s32 y0;
+    s32 left;
+    s32 right;
+    s32 top;
+    s32 bottom;
+
+    if (sNspBg.img != img || sNspBg.imgW != imgW || sNspBg.imgH != imgH || sNspBg.colorW != colorW ||
+        sNspBg.colorH != colorH || sNspBg.key != key) {
+        if (!nsp_bg_decode(img, imgW, imgH, tlut, key))
+            return;
+    }
+
+    x0 = (s16)(frame >> 16) * (s32)colorW / (SCREEN_WIDTH * 4);
+    y0 = (s16)frame * (s32)colorH / (SCREEN_HEIGHT * 4);
+    left = (x0 > 0) ? x0 : 0;
+    top = (y0 > 0) ? y0 : 0;
+    right = (x0 + (s32)sNspBg.width < (s32)colorW) ? x0 + (s32)sNspBg.width : (s32)colorW;
+    bottom = (y0 + (s32)sNspBg.height < (s32)colorH) ? y0 + (s32)sNspBg.height : (s32)colorH;
+
+    for (s32 y = top; y < bottom; y++) {
+        const u32 offset = (y - y0) * sNspBg.width + (left - x0);
+        const gfx_pixel_t* in = sNspBg.pixels + offset;
+        gfx_pixel_t* out = gfx_output + y * colorW + left;
+
+        if (!sNspBg.holes) {
+            memcpy(out, in, (right - left) * sizeof(gfx_pixel_t));
+        } else {
+            const u8* opaque = sNspBg.opaque + offset;
+
+            for (s32 x = 0; x < right - left; x++) {
+                if (opaque[x])
+                    out[x] = in[x];
+            }
+        }
+    }
+}
+
+/**
+ * Runs a G_NSP_FBOP on the part of the frame drawn so far. `src` and `dst`
+ * are width x height images, or NULL for the color buffer.
+ */
+void nsp_prerender_run_op(u32 op, u32 width, u32 height, u32 env, void* src, void* dst) {
+    NspFadeTable tab;
+
+    if (op == G_NSP_FBOP_BG) {
+        nsp_bg_draw(width, height, env, src, dst);
+        return;
+    }
+
+    if (width > SCREEN_WIDTH || gfx_current_dimensions.width > SCREEN_WIDTH)
+        return; /* bigger than the row buffers, MM's framebuffers never are */
+
+    if (op == G_NSP_FBOP_CVG) {
+        u8* cvg = dst;
+
+        if (src == NULL) {
+            /* No coverage is kept, the renderer draws every pixel fully covered */
+            memset(cvg, 0xFF, width * height);
+        } else {
+            /* The intensity of the RGBA16 image read as IA16, see PreRender.c */
+            const u16* img = src;
+
+            for (u32 i = 0; i < width * height; i++)
+                cvg[i] = img[i] >> 8;
+        }
+        return;
+    }
+
+    if (op == G_NSP_FBOP_FADE)
+        nsp_fade_table_init(&tab, env);
+
+    if (dst != NULL) {
+        nsp_fbop_to_image(op, width, height, &tab, src, dst);
+    } else {
+        nsp_fbop_to_color(op, width, height, &tab, src);
+    }
+}
+
+/* ============================================================
+ * Filters
+ * ============================================================ */
+
+/* Whether all of the n pixels of the I8 coverage row are fully covered */
+static bool nsp_cvg_row_full(const u8* cvg, u32 n) {
+    u32 x = 0;
+
+    for (; x < n && ((uintptr_t)&cvg[x] & 3); x++) {
+        if ((cvg[x] >> 5) != 7)
+            return false;
+    }
+    for (; x + 4 <= n; x += 4) {
+        if ((*(const u32*)&cvg[x] & 0xE0E0E0E0) != 0xE0E0E0E0)
+            return false;
+    }
+    for (; x < n; x++) {
+        if ((cvg[x] >> 5) != 7)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * The VI anti-aliasing of one partially covered pixel, see
+ * PreRender_AntiAliasFilterPixel in PreRender.c.
+ */
+void PreRender_AntiAliasFilterPixel(PreRender* this, s32 x, s32 y) {
+    s32 i;
+    s32 j;
+    s32 buffCvg[3 * 5];
+    s32 buffR[3 * 5];
+    s32 buffG[3 * 5];
+    s32 buffB[3 * 5];
+    s32 invCvg;
+    s32 pmaxR;
+    s32 pmaxG;
+    s32 pmaxB;
+    s32 pminR;
+    s32 pminG;
+    s32 pminB;
+    u32 outR;
+    u32 outG;
+    u32 outB;
+
+    for (i = 0; i < 5 * 3; i++) {
+        s32 xi = CLAMP(x + (i % 5) - 2, 0, this->width - 1);
+        s32 yi = CLAMP(y + (i / 5) - 1, 0, this->height - 1);
+        u16 px = this->fbufSave[xi + yi * this->width];
+
+        buffR[i] = NSP_EXPAND_5_8(RGBA16_GET_R(px));
+        buffG[i] = NSP_EXPAND_5_8(RGBA16_GET_G(px));
+        buffB[i] = NSP_EXPAND_5_8(RGBA16_GET_B(px));
+        buffCvg[i] = this->cvgSave[xi + yi * this->width] >> 5;
+    }
+
+    pmaxR = pminR = buffR[7];
+    pmaxG = pminG = buffG[7];
+    pmaxB = pminB = buffB[7];
+
+    for (i = 1; i < 5 * 3; i += 2) {
+        if (buffCvg[i] != 7) {
+            continue;
+        }
+        for (j = 1; j < 5 * 3; j += 2) {
+            if ((i == j) || (buffCvg[j] != 7)) {
+                continue;
+            }
+            if ((pmaxR < buffR[i]) && (buffR[j] >= buffR[i])) {
+                pmaxR = buffR[i];
+            }
+            if ((pmaxG < buffG[i]) && (buffG[j] >= buffG[i])) {
+                pmaxG = buffG[i];
+            }
+            if ((pmaxB < buffB[i]) && (buffB[j] >= buffB[i])) {
+                pmaxB = buffB[i];
+            }
+            if ((pminR > buffR[i]) && (buffR[j] <= buffR[i])) {
+                pminR = buffR[i];
+            }
+            if ((pminG > buffG[i]) && (buffG[j] <= buffG[i])) {
+                pminG = buffG[i];
+            }
+            if ((pminB > buffB[i]) && (buffB[j] <= buffB[i])) {
+                pminB = buffB[i];
+            }
+        }
+    }
+
+    invCvg = 7 - buffCvg[7];
+    outR = buffR[7] + ((s32)(invCvg * (pmaxR + pminR - (buffR[7] * 2)) + 4) >> 3);
+    outG = buffG[7] + ((s32)(invCvg * (pmaxG + pminG - (buffG[7] * 2)) + 4) >> 3);
+    outB = buffB[7] + ((s32)(invCvg * (pmaxB + pminB - (buffB[7] * 2)) + 4) >> 3);
+
+    this->fbufSave[x + y * this->width] = NSP_RGBA16((outR >> 3) & 0x1F, (outG >> 3) & 0x1F, (outB >> 3) & 0x1F);
+}
+
+/**
+ * Applies the VI anti-aliasing filter to `this->fbufSave`, skipping the rows
+ * without partially covered pixels.
+ */
+void PreRender_AntiAliasFilter(PreRender* this) {
+    s32 x;
+    s32 y;
+
+    for (y = 0; y < this->height; y++) {
+        const u8* lineCvg = &this->cvgSave[y * this->width];
+
+        if (nsp_cvg_row_full(lineCvg, this->width)) {
+            continue;
+        }
+        for (x = 0; x < this->width; x++) {
+            if ((lineCvg[x] >> 5) != 7) {
+                PreRender_AntiAliasFilterPixel(this, x, y);
+            }
+        }
+    }
+}
+
+#define NSP_SORT2(a, b)        \
+    {                          \
+        if ((a) > (b)) {       \
+            const u8 _t = (a); \
+            (a) = (b);         \
+            (b) = _t;          \
+        }                      \
+    }
+
+/* The median of 9 values in 19 compare and swaps */
+static inline u8 nsp_median9(u8 p0, u8 p1, u8 p2, u8 p3, u8 p4, u8 p5, u8 p6, u8 p7, u8 p8) {
+    NSP_SORT2(p1, p2); NSP_SORT2(p4, p5); NSP_SORT2(p7, p8);
+    NSP_SORT2(p0, p1); NSP_SORT2(p3, p4); NSP_SORT2(p6, p7);
+    NSP_SORT2(p1, p2); NSP_SORT2(p4, p5); NSP_SORT2(p7, p8);
+    NSP_SORT2(p0, p3); NSP_SORT2(p5, p8); NSP_SORT2(p4, p7);
+    NSP_SORT2(p3, p6); NSP_SORT2(p1, p4); NSP_SORT2(p2, p5);
+    NSP_SORT2(p4, p7); NSP_SORT2(p4, p2); NSP_SORT2(p6, p4);
+    NSP_SORT2(p4, p2);
+    return p4;
+}
+
+static inline u8 nsp_median3(u8 p0, u8 p1, u8 p2) {
+    NSP_SORT2(p0, p1);
+    NSP_SORT2(p1, p2);
+    NSP_SORT2(p0, p1);
+    return p1;
+}
+
+/* The r, g and b rows of the divot filter */
+typedef struct {
+    u8 c[3][SCREEN_WIDTH];
+} NspDivotRow;
+
+static void nsp_divot_unpack(NspDivotRow* row, const u16* px, u32 width) {
+    for (u32 x = 0; x < width; x++) {
+        row->c[0][x] = RGBA16_GET_R(px[x]);
+        row->c[1][x] = RGBA16_GET_G(px[x]);
+        row->c[2][x] = RGBA16_GET_B(px[x]);
+    }
+}
+
+/**
+ * PreRender_DivotFilter with the same results. The original's row pointers
+ * all end up on one buffer: lines 1 and 2 take the median of the unfiltered
+ * line above once and their own line twice, the lines after that the median
+ * of their own line three times, which is the median of the three pixels.
+ * A line is only unpacked when it has partially covered pixels, and the
+ * line above only for lines 1 and 2. A line that wasn't filtered still
+ * holds its own pixels in `this->fbufSave`.
+ */
+void PreRender_DivotFilter(PreRender* this) {
+    static NspDivotRow rows[2];
+    const u32 width = this->width;
+    const u32 height = this->height;
+    NspDivotRow* prev = &rows[0];
+    NspDivotRow* cur = &rows[1];
+    bool prevUnpacked = false;
+    u32 x;
+    u32 y;
+
+    if (width > SCREEN_WIDTH) {
+        return;
+    }
+
+    for (y = 1; y < height - 1; y++) {
+        const u8* lineCvg = &this->cvgSave[width * y];
+        u16* linePx = &this->fbufSave[width * y];
+
+        if (nsp_cvg_row_full(lineCvg, width)) {
+            prevUnpacked = false;
+            continue;
+        }
+
+        if (y <= 2 && !prevUnpacked) {
+            nsp_divot_unpack(prev, linePx - width, width);
+        }
+        nsp_divot_unpack(cur, linePx, width);
+
+        for (x = 1; x < width - 1; x++) {
+            u32 c[3];
+            s32 i;
+
+            if (((lineCvg[x - 1] & lineCvg[x] & lineCvg[x + 1]) >> 5) == 7) {
+                continue;
+            }
+
+            for (i = 0; i < 3; i++) {
+                const u8* p = &prev->c[i][x - 1];
+                const u8* q = &cur->c[i][x - 1];
+
+                if (y <= 2) {
+                    c[i] = nsp_median9(p[0], p[1], p[2], q[0], q[1], q[2], q[0], q[1], q[2]);
+                } else {
+                    c[i] = nsp_median3(q[0], q[1], q[2]);
+                }
+            }
+            linePx[x] = NSP_RGBA16(c[0], c[1], c[2]);
+        }
+
+        /* The unfiltered line becomes the one above */
+        {
+            NspDivotRow* tmp = prev;
+
+            prev = cur;
+            cur = tmp;
+            prevUnpacked = true;
+        }
+    }
+}
+
+/**
+ * Applies the filters to `this->fbufSave`, the AA filter only with
+ * prerender_aa set.
+ */
+void PreRender_ApplyFilters(PreRender* this) {
+    if ((this->cvgSave == NULL) || (this->fbufSave == NULL)) {
+        this->filterState = PRERENDER_FILTER_STATE_NONE;
+    } else {
+        this->filterState = PRERENDER_FILTER_STATE_PROCESS;
+        if (configPrerenderAA) {
+            PreRender_AntiAliasFilter(this);
+        }
+        PreRender_DivotFilter(this);
+        this->filterState = PRERENDER_FILTER_STATE_DONE;
+    }
+}
+
+/**
+ * Filters right away instead of on a slowly thread, the result is ready
+ * before the next frame draws it.
+ */
+void PreRender_ApplyFiltersSlowlyInit(PreRender* this) {
+    if ((this->cvgSave != NULL) && (this->fbufSave != NULL)) {
+        PreRender_ApplyFilters(this);
+    }
+}
+
+void PreRender_ApplyFiltersSlowlyDestroy(PreRender* this) {
+}
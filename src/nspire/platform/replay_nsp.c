@@ -0,0 +1,283 @@
+/**
+ * replay_nsp.c — Recording and replaying the controller, for repeatable runs
+ *
+ * Comparing the frame times of two builds means playing the same stretch of
+ * the game on both, which a person never does the same way twice. With
+ * input_record set, every read of the controller the game makes is written
+ * to mm-nsp-input.rec.tns, along with the seeds Play_Init gives the random
+ * number generator and the save flash as the game loaded it. With
+ * input_replay set instead, the game reads all of them back from the file
+ * in the same order, and the run is the recorded one again.
+ *
+ * The game only goes the same way if every update does: a replay drops
+ * frames at the fixed frameskip rate instead of by the clock, keeps the
+ * resolution fixed, spreads the ROM reads over the frames by size only and
+ * mixes every audio voice. It starts from the recorded save, and the saves
+ * it makes stay in RAM, see flashrom_nsp.c. When the recording runs out, the
+ * frame times of the run are written to mm-nsp-replay.csv.tns, one line a
+ * drawn frame, and the game exits. They are kept in RAM until then, so that
+ * the file system doesn't add to the times being measured.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nspire/profiling.h"
+
+/* ends in .tns, so the calculator's file browser and TI Connect pick them up */
+#define REPLAY_INPUT_FILENAME "mm-nsp-input.rec.tns"
+#define REPLAY_CSV_FILENAME "mm-nsp-replay.csv.tns"
+
+#define REPLAY_MAGIC 0x50524D4D /* "MMRP" */
+#define REPLAY_VERSION 1
+#define REPLAY_FRAMES_STEP 1024 /* frame times the buffer grows by */
+
+/* Timer, from nsp_replacements.c */
+extern uint32_t tmr_ms(void);
+
+/* From main_nsp.c */
+extern void nsp_exit(void);
+
+/* Config */
+extern bool configInputRecord;
+extern bool configInputReplay;
+extern bool configAdaptiveQuality;
+extern unsigned int configFramePacing;
+extern unsigned int configAudioBudget;
+
+typedef enum {
+    NSP_REPLAY_OFF,
+    NSP_REPLAY_RECORD,
+    NSP_REPLAY_PLAY,
+} NspReplayMode;
+
+typedef enum {
+    NSP_REPLAY_PAD = 1, /* a read of the controller */
+    NSP_REPLAY_SEED,    /* a seed for the random number generator */
+    NSP_REPLAY_FLASH,   /* the save flash, followed by its bytes */
+} NspReplayKind;
+
+typedef struct {
+    uint8_t kind; /* NspReplayKind */
+    int8_t stick_x;
+    int8_t stick_y;
+    uint8_t unused;
+    uint16_t button;
+    uint16_t press;
+    uint16_t rel;
+    uint16_t unused2;
+    uint32_t value; /* the seed, or the size of the flash */
+} NspReplayRecord;
+
+typedef struct {
+    uint32_t read; /* controller reads before the frame, the same frame in every replay */
+    uint32_t ms;   /* since the last drawn frame */
+    uint32_t time[PROF_NUM_TIMES];
+} NspReplayFrame;
+
+static NspReplayMode nsp_replay_mode;
+static FILE* nsp_replay_file;
+static uint32_t nsp_replay_reads;
+
+static NspReplayFrame* nsp_replay_frames;
+static uint32_t nsp_replay_num_frames;
+static uint32_t nsp_replay_cap_frames;
+static uint32_t nsp_replay_last_ms;
+
+/* What a replay overrides, put back before the config is saved */
+static bool nsp_replay_saved_adaptive;
+static unsigned int nsp_replay_saved_pacing;
+static unsigned int nsp_replay_saved_audio_budget;
+
+/* Called after the config is loaded, before the renderer is set up */
+void nsp_replay_init(void) {
+    uint32_t header[2];
+
+    if (configInputReplay) {
+        nsp_replay_file = fopen(REPLAY_INPUT_FILENAME, "rb");
+        if (nsp_replay_file == NULL || fread(header, sizeof(header), 1, nsp_replay_file) != 1 ||
+            header[0] != REPLAY_MAGIC || header[1] != REPLAY_VERSION) {
+            printf("No recording to replay in '%s'\n", REPLAY_INPUT_FILENAME);
+            if (nsp_replay_file != NULL)
+                fclose(nsp_replay_file);
+            nsp_replay_file = NULL;
+            return;
+        }
+        nsp_replay_mode = NSP_REPLAY_PLAY;
+
+        nsp_replay_saved_adaptive = configAdaptiveQuality;
+        nsp_replay_saved_pacing = configFramePacing;
+        nsp_replay_saved_audio_budget = configAudioBudget;
+        configAdaptiveQuality = false;
+        configFramePacing = 0;
+        configAudioBudget = 0;
+    } else if (configInputRecord) {
+        header[0] = REPLAY_MAGIC;
+        header[1] = REPLAY_VERSION;
+        nsp_replay_file = fopen(REPLAY_INPUT_FILENAME, "wb");
+        if (nsp_replay_file == NULL || fwrite(header, sizeof(header), 1, nsp_replay_file) != 1) {
+            printf("Could not open '%s' for recording\n", REPLAY_INPUT_FILENAME);
+            if (nsp_replay_file != NULL)
+                fclose(nsp_replay_file);
+            nsp_replay_file = NULL;
+            return;
+        }
+        nsp_replay_mode = NSP_REPLAY_RECORD;
+    }
+}
+
+/* Whether the game runs from a recording, and has to leave out what depends on the clock */
+bool nsp_replay_active(void) {
+    return nsp_replay_mode == NSP_REPLAY_PLAY;
+}
+
+static void nsp_replay_csv_write(void) {
+    FILE* f = fopen(REPLAY_CSV_FILENAME, "w");
+    if (f == NULL) {
+        printf("Could not open '%s' for the replay times\n", REPLAY_CSV_FILENAME);
+        return;
+    }
+
+    fputs("read,frame_ms", f);
+    for (int i = 0; i < PROF_NUM_TIMES; i++)
+        fprintf(f, ",%s_ms", prof_time_names[i]);
+    fputc('\n', f);
+    for (uint32_t n = 0; n < nsp_replay_num_frames; n++) {
+        const NspReplayFrame* frame = &nsp_replay_frames[n];
+        fprintf(f, "%lu,%lu", (unsigned long) frame->read, (unsigned long) frame->ms);
+        for (int i = 0; i < PROF_NUM_TIMES; i++)
+            fprintf(f, ",%lu", (unsigned long) frame->time[i]);
+        fputc('\n', f);
+    }
+    fclose(f);
+}
+
+/* Finishes a recording, or a replay by putting the config back and writing the frame times. Called
+ * before the config is saved */
+void nsp_replay_close(void) {
+    if (nsp_replay_mode == NSP_REPLAY_PLAY) {
+        configAdaptiveQuality = nsp_replay_saved_adaptive;
+        configFramePacing = nsp_replay_saved_pacing;
+        configAudioBudget = nsp_replay_saved_audio_budget;
+        nsp_replay_csv_write();
+    }
+    if (nsp_replay_file != NULL) {
+        fclose(nsp_replay_file);
+        nsp_replay_file = NULL;
+    }
+    free(nsp_replay_frames);
+    nsp_replay_frames = NULL;
+    nsp_replay_num_frames = nsp_replay_cap_frames = 0;
+    nsp_replay_mode = NSP_REPLAY_OFF;
+}
+
+/**
+ * The next record of a replay, which has to be of the kind the game asks
+ * for. At the end of the recording, or where the game went another way than
+ * it did, the run is over.
+ */
+static void nsp_replay_next(NspReplayRecord* rec, NspReplayKind kind) {
+    if (fread(rec, sizeof(*rec), 1, nsp_replay_file) == 1 && rec->kind == kind)
+        return;
+    if (!feof(nsp_replay_file))
+        printf("Replay out of sync after %lu reads\n", (unsigned long) nsp_replay_reads);
+    nsp_exit();
+}
+
+/* Records one read of the controller, or replaces it with the recorded one */
+void nsp_replay_pad(uint16_t* button, int8_t* stick_x, int8_t* stick_y, uint16_t* press, uint16_t* rel) {
+    NspReplayRecord rec = { 0 };
+
+    switch (nsp_replay_mode) {
+        case NSP_REPLAY_RECORD:
+            rec.kind = NSP_REPLAY_PAD;
+            rec.button = *button;
+            rec.stick_x = *stick_x;
+            rec.stick_y = *stick_y;
+            rec.press = *press;
+            rec.rel = *rel;
+            fwrite(&rec, sizeof(rec), 1, nsp_replay_file);
+            break;
+        case NSP_REPLAY_PLAY:
+            nsp_replay_next(&rec, NSP_REPLAY_PAD);
+            *button = rec.button;
+            *stick_x = rec.stick_x;
+            *stick_y = rec.stick_y;
+            *press = rec.press;
+            *rel = rec.rel;
+            break;
+        default:
+            break;
+    }
+    nsp_replay_reads++;
+}
+
+/* Records a seed for the random number generator, or returns the recorded one in its place */
+uint32_t nsp_replay_seed(uint32_t seed) {
+    NspReplayRecord rec = { 0 };
+
+    switch (nsp_replay_mode) {
+        case NSP_REPLAY_RECORD:
+            rec.kind = NSP_REPLAY_SEED;
+            rec.value = seed;
+            fwrite(&rec, sizeof(rec), 1, nsp_replay_file);
+            return seed;
+        case NSP_REPLAY_PLAY:
+            nsp_replay_next(&rec, NSP_REPLAY_SEED);
+            return rec.value;
+        default:
+            return seed;
+    }
+}
+
+/**
+ * Records the save flash as the game loaded it, or puts the recorded one in
+ * its place. Returns true when replaying, the saves of the run must then not
+ * reach the files.
+ */
+bool nsp_replay_flash(uint8_t* flash, uint32_t size) {
+    NspReplayRecord rec = { 0 };
+
+    switch (nsp_replay_mode) {
+        case NSP_REPLAY_RECORD:
+            rec.kind = NSP_REPLAY_FLASH;
+            rec.value = size;
+            fwrite(&rec, sizeof(rec), 1, nsp_replay_file);
+            fwrite(flash, 1, size, nsp_replay_file);
+            return false;
+        case NSP_REPLAY_PLAY:
+            nsp_replay_next(&rec, NSP_REPLAY_FLASH);
+            if (rec.value != size || fread(flash, 1, size, nsp_replay_file) != size) {
+                printf("Replay has a save of %lu bytes\n", (unsigned long) rec.value);
+                nsp_exit();
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Called once a drawn frame is on the LCD and its times are in prof_last */
+void nsp_replay_frame(void) {
+    const uint32_t now = tmr_ms();
+
+    if (nsp_replay_mode != NSP_REPLAY_PLAY)
+        return;
+
+    if (nsp_replay_num_frames == nsp_replay_cap_frames) {
+        NspReplayFrame* frames =
+            realloc(nsp_replay_frames, (nsp_replay_cap_frames + REPLAY_FRAMES_STEP) * sizeof(NspReplayFrame));
+        if (frames == NULL)
+            return; /* the times of the rest of the run are lost, the run itself goes on */
+        nsp_replay_frames = frames;
+        nsp_replay_cap_frames += REPLAY_FRAMES_STEP;
+    }
+
+    NspReplayFrame* frame = &nsp_replay_frames[nsp_replay_num_frames++];
+    frame->read = nsp_replay_reads;
+    frame->ms = (nsp_replay_num_frames > 1) ? now - nsp_replay_last_ms : 0;
+    memcpy(frame->time, prof_last.time, sizeof(frame->time));
+    nsp_replay_last_ms = now;
+}
@@ -0,0 +1,160 @@
+/**
+ * transition_nsp.c — Screen transition fills on the color buffer
+ *
+ * TransitionFade draws its color over the whole screen as a fill rectangle
+ * and TransitionCircle as a full screen texrect of the circle texture,
+ * through the rasterizer, the combiner and the blender for every pixel.
+ * The room and scene transitions run them while the game is also loading,
+ * when the frame time has the least to spare.
+ *
+ * Both emit a G_NSP_FILL instead, which the frontend hands to
+ * nsp_transition_fill when the DL runs: a loop over the rows of gfx_output
+ * blending one color in with a shift and a multiply a pixel. The circle's
+ * mask texels are looked up for every column of the screen once, a row
+ * only reads the texels of its own texture row, and the spans where the
+ * mask is fully clear or fully set skip the blend.
+ *
+ * The fade blends as G_RM_CLD_SURF does, the circle as the threshold alpha
+ * compare and blender its setup DL picks: the texel, or its inverse, times
+ * the primitive LOD fraction.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gfx_backend.h"
+#include "gfx_frontend.h"
+
+#if OUTPUT_RGB565
+/* Alpha out of 32, the channels spread apart far enough to blend together in one multiply */
+#define NSP_FILL_ALPHA_BITS 5
+#define NSP_FILL_SPREAD_MASK 0x07E0F81F
+
+static inline uint32_t nsp_fill_spread(gfx_pixel_t p) {
+    return (p | ((uint32_t) p << 16)) & NSP_FILL_SPREAD_MASK;
+}
+
+static inline gfx_pixel_t nsp_fill_pixel(uint32_t r, uint32_t g, uint32_t b) {
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+}
+
+/* `color` over `p` at `a`, `color` spread */
+static inline gfx_pixel_t nsp_fill_blend(gfx_pixel_t p, uint32_t color, uint32_t a) {
+    const uint32_t x = ((color * a + nsp_fill_spread(p) * ((1 << NSP_FILL_ALPHA_BITS) - a)) >> NSP_FILL_ALPHA_BITS) &
+                       NSP_FILL_SPREAD_MASK;
+
+    return (gfx_pixel_t) (x | (x >> 16));
+}
+#else
+/* Alpha out of 256, red and blue blended together */
+#define NSP_FILL_ALPHA_BITS 8
+
+static inline uint32_t nsp_fill_spread(gfx_pixel_t p) {
+    return p;
+}
+
+static inline gfx_pixel_t nsp_fill_pixel(uint32_t r, uint32_t g, uint32_t b) {
+    return 0xFF000000 | (b << 16) | (g << 8) | r;
+}
+
+static inline gfx_pixel_t nsp_fill_blend(gfx_pixel_t p, uint32_t color, uint32_t a) {
+    const uint32_t ia = (1 << NSP_FILL_ALPHA_BITS) - a;
+    const uint32_t rb = (((color & 0xFF00FF) * a + (p & 0xFF00FF) * ia) >> 8) & 0xFF00FF;
+    const uint32_t g = (((color & 0xFF00) * a + (p & 0xFF00) * ia) >> 8) & 0xFF00;
+
+    return 0xFF000000 | rb | g;
+}
+#endif
+
+#define NSP_FILL_ALPHA_MAX (1 << NSP_FILL_ALPHA_BITS)
+
+/* An 8 bit alpha in the blend's steps, so that only 0 leaves the pixel as it was and 255 covers it */
+static inline uint32_t nsp_fill_alpha(uint32_t a) {
+    return (a * NSP_FILL_ALPHA_MAX + 254) / 255;
+}
+
+static void nsp_fill_blend_screen(gfx_pixel_t pixel, uint32_t a) {
+    const uint32_t count = gfx_current_dimensions.width * gfx_current_dimensions.height;
+    const uint32_t color = nsp_fill_spread(pixel);
+    gfx_pixel_t* out = gfx_output;
+
+    if (a == 0)
+        return;
+    if (a == NSP_FILL_ALPHA_MAX) {
+        for (uint32_t i = 0; i < count; i++)
+            out[i] = pixel;
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++)
+        out[i] = nsp_fill_blend(out[i], color, a);
+}
+
+/* A texel coordinate in s21.10 through a tile 2 << mask texels wide, clamped and mirrored once */
+static inline uint32_t nsp_fill_texel(int32_t st, uint32_t mask) {
+    const int32_t last = (2 << mask) - 1;
+    int32_t i = st >> 10;
+
+    i = (i < 0) ? 0 : (i > last) ? last : i;
+    return (i & (1 << mask)) ? ((1 << mask) - 1) - (i & ((1 << mask) - 1)) : (uint32_t) i;
+}
+
+/**
+ * Draws `pixel` at the alpha of the I4 mask `tex` times `scale`, sampled as
+ * a screen sized texrect from the tile's `s`, `t` with the steps in `dxdy`
+ */
+static void nsp_fill_mask_screen(gfx_pixel_t pixel, uint32_t scale, bool invert, uint32_t masks, uint32_t maskt,
+                                 int32_t s, int32_t t, uint32_t dxdy, const uint8_t* tex) {
+    const uint32_t colorW = gfx_current_dimensions.width;
+    const uint32_t colorH = gfx_current_dimensions.height;
+    const int32_t dsdx = (int16_t) (dxdy >> 16);
+    const int32_t dtdy = (int16_t) dxdy;
+    const uint32_t rowBytes = (1 << masks) / 2;
+    const uint32_t color = nsp_fill_spread(pixel);
+    uint8_t alphaOf[16];
+    uint8_t texelOf[SCREEN_WIDTH]; /* mask column of every color buffer column */
+
+    if (colorW > SCREEN_WIDTH || masks > 8 || maskt > 8)
+        return; /* bigger than the row buffer or a tile's mask can be, the circle never is */
+
+    for (uint32_t v = 0; v < 16; v++) {
+        const uint32_t texel = invert ? 255 - v * 17 : v * 17;
+
+        alphaOf[v] = nsp_fill_alpha(texel * scale / 255);
+    }
+    for (uint32_t x = 0; x < colorW; x++)
+        texelOf[x] = nsp_fill_texel(s + (int32_t) (x * SCREEN_WIDTH / colorW) * dsdx, masks);
+
+    for (uint32_t y = 0; y < colorH; y++) {
+        const uint8_t* row = tex + nsp_fill_texel(t + (int32_t) (y * SCREEN_HEIGHT / colorH) * dtdy, maskt) * rowBytes;
+        gfx_pixel_t* out = gfx_output + y * colorW;
+
+        for (uint32_t x = 0; x < colorW; x++) {
+            const uint32_t texel = texelOf[x];
+            const uint32_t a = alphaOf[(row[texel >> 1] >> ((texel & 1) ? 0 : 4)) & 0xF];
+
+            if (a == NSP_FILL_ALPHA_MAX) {
+                out[x] = pixel;
+            } else if (a != 0) {
+                out[x] = nsp_fill_blend(out[x], color, a);
+            }
+        }
+    }
+}
+
+/**
+ * Runs a G_NSP_FILL on the part of the frame drawn so far, `color` is
+ * RGBA8 and the rest as gbi_nsp.h describes them
+ */
+void nsp_transition_fill(uint32_t op, uint32_t params, uint32_t color, int32_t s, int32_t t, uint32_t dxdy,
+                         const void* tex) {
+    const gfx_pixel_t pixel = nsp_fill_pixel(color >> 24, (color >> 16) & 0xFF, (color >> 8) & 0xFF);
+
+    switch (op) {
+        case G_NSP_FILL_BLEND:
+            nsp_fill_blend_screen(pixel, nsp_fill_alpha(color & 0xFF));
+            break;
+        case G_NSP_FILL_MASK:
+            nsp_fill_mask_screen(pixel, color & 0xFF, (params & G_NSP_FILL_INVERT) != 0, (params >> 4) & 0xF,
+                                 params & 0xF, s, t, dxdy, tex);
+            break;
+    }
+}
@@ -0,0 +1,33 @@
+/**
+ * trig_nsp.c — Sine table behind Math_SinS, Math_CosS, Math_SinF and Math_CosF
+ *
+ * sins is already a table lookup, but Math_SinS turns its result into a
+ * float with an int to float conversion and a multiply, two libgcc calls on
+ * the ARM926, and every rotation builder calls it and Math_CosS back to
+ * back. The table holds those floats for all 4096 angles sins tells apart,
+ * computed the same way, so the results don't change. The sin and the cos
+ * of an angle sit in one entry next to their Q15 values for the fixed point
+ * code, one lookup for all four.
+ *
+ * The lookups are inline in z64math.h, the functions they replace are left
+ * out of z_lib.c and sys_math.c with TRIG_TABLE.
+ */
+#include "z64math.h"
+
+/* From libultra/gu */
+extern s16 sins(u16 x);
+extern s16 coss(u16 x);
+
+TrigTableEntry gTrigTable[TRIG_TABLE_SIZE];
+
+void Math_InitTrigTable(void) {
+    for (s32 i = 0; i < TRIG_TABLE_SIZE; i++) {
+        u16 angle = i << 4;
+        TrigTableEntry* entry = &gTrigTable[i];
+
+        entry->sinQ15 = sins(angle);
+        entry->cosQ15 = coss(angle);
+        entry->sin = entry->sinQ15 * (1.0f / SHRT_MAX);
+        entry->cos = entry->cosQ15 * (1.0f / SHRT_MAX);
+    }
+}
@@ -0,0 +1,117 @@
+/**
+ * yaz0_nsp.c — Yaz0 decompression straight from the ROM file
+ *
+ * The same format src/boot/yaz0.c decodes, but that version can't be used
+ * as is: it reads the big-endian header as native words, which breaks on
+ * the little-endian ARM, and refills a 0x400 buffer so often that the
+ * reads dominate room loads. This one streams the compressed file through
+ * a 16KB buffer, and copies back-references with memset or memcpy where
+ * they apply and two bytes a step otherwise, instead of one byte a step.
+ */
+#include <stdint.h>
+#include <string.h>
+
+/* From main_nsp.c */
+extern int nsp_rom_read_raw(uint32_t rom_addr, void* dest, uint32_t size);
+
+#define YAZ0_HEADER_SIZE 0x10
+#define YAZ0_BUF_SIZE 0x4000
+#define YAZ0_GROUP_MAX (1 + 8 * 3) /* a group header and 8 three-byte back-references */
+
+/* The slack after the end lets truncated data run past what was read without going out of bounds */
+static uint8_t yaz0_buf[YAZ0_BUF_SIZE + YAZ0_GROUP_MAX];
+
+static inline void yaz0_copy_back(uint8_t* out, uint32_t dist, uint32_t n) {
+    const uint8_t* back = out - dist;
+
+    if (dist == 1) {
+        /* Runs of one byte, common in padding and flat textures */
+        memset(out, *back, n);
+    } else if (dist >= n && n >= 16) {
+        /* No overlap, long enough for memcpy to be ahead */
+        memcpy(out, back, n);
+    } else {
+        /* Two bytes a step. With dist >= 2 both are behind out, so the
+         * repeating pattern of an overlapping copy still comes out right. */
+        for (; n >= 2; n -= 2) {
+            uint8_t a = back[0];
+            uint8_t b = back[1];
+            back += 2;
+            out[0] = a;
+            out[1] = b;
+            out += 2;
+        }
+        if (n != 0)
+            *out = *back;
+    }
+}
+
+/**
+ * Decompress a Yaz0 file from the ROM.
+ *
+ * @param rom_start  ROM offset of the compressed file
+ * @param rom_size   Size of the compressed file
+ * @param dest       RAM destination buffer
+ * @param dest_size  Size of the destination, the file may not decompress to more
+ * @return           0 on success, -1 on a read error or bad data
+ */
+int nsp_yaz0_decompress(uint32_t rom_start, uint32_t rom_size, void* dest, uint32_t dest_size) {
+    uint8_t* out = dest;
+    uint8_t* out_end;
+    const uint8_t* src = yaz0_buf;
+    const uint8_t* src_end;
+    uint32_t dec_size;
+    uint32_t n;
+
+    n = (rom_size < YAZ0_BUF_SIZE) ? rom_size : YAZ0_BUF_SIZE;
+    if (n < YAZ0_HEADER_SIZE || nsp_rom_read_raw(rom_start, yaz0_buf, n) != 0)
+        return -1;
+    rom_start += n;
+    rom_size -= n;
+    src_end = yaz0_buf + n;
+
+    if (memcmp(src, "Yaz0", 4) != 0)
+        return -1;
+    dec_size = ((uint32_t)src[4] << 24) | ((uint32_t)src[5] << 16) | ((uint32_t)src[6] << 8) | src[7];
+    if (dec_size > dest_size)
+        return -1;
+    src += YAZ0_HEADER_SIZE;
+    out_end = out + dec_size;
+
+    while (out < out_end) {
+        if (src_end - src < YAZ0_GROUP_MAX && rom_size != 0) {
+            /* Move what's left to the front and fill the rest of the buffer */
+            uint32_t rest = src_end - src;
+            memmove(yaz0_buf, src, rest);
+            n = YAZ0_BUF_SIZE - rest;
+            if (n > rom_size)
+                n = rom_size;
+            if (nsp_rom_read_raw(rom_start, yaz0_buf + rest, n) != 0)
+                return -1;
+            rom_start += n;
+            rom_size -= n;
+            src = yaz0_buf;
+            src_end = yaz0_buf + rest + n;
+        }
+        if (src >= src_end)
+            return -1;
+
+        uint32_t group = *src++;
+        for (int i = 0; i < 8 && out < out_end; i++, group <<= 1) {
+            if (group & 0x80) {
+                *out++ = *src++;
+            } else {
+                /* 0B BB NN or NB BB: N + 0x12 or N + 2 bytes from B + 1 back */
+                uint32_t b0 = src[0];
+                uint32_t dist = (((b0 & 0xF) << 8) | src[1]) + 1;
+                src += 2;
+                n = (b0 >> 4) != 0 ? (b0 >> 4) + 2 : *src++ + 0x12u;
+                if (dist > (uint32_t)(out - (uint8_t*)dest) || n > (uint32_t)(out_end - out))
+                    return -1;
+                yaz0_copy_back(out, dist, n);
+                out += n;
+            }
+        }
+    }
+    return 0;
+}
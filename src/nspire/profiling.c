@@ -0,0 +1,228 @@
+// profiling.c - per-frame timings and counters, shown on screen and logged to a CSV file
+#include <stdio.h>
+#include <string.h>
+
+#include "profiling.h"
+#include "gfx_frontend.h"
+#include "pc/configfile.h"
+#include "pc/timer.h"
+#if MEM_STATS
+#include "pc/memstats.h"
+#endif
+
+// ends in .tns, so the calculator's file browser and TI Connect pick it up
+#define PROF_CSV_FILENAME "mm-nsp-prof.csv.tns"
+#define PROF_OPS_FILENAME "mm-nsp-ops.csv.tns"
+
+#define HUD_GLYPH_W 3
+#define HUD_GLYPH_H 5
+#define HUD_ADVANCE (HUD_GLYPH_W + 1)
+#define HUD_LINE_H (HUD_GLYPH_H + 1)
+
+struct ProfFrame prof_frame;
+struct ProfFrame prof_last;
+uint32_t prof_fps;
+
+static uint32_t prof_frames;     // frames finished since startup
+static uint32_t prof_fps_frames; // frames finished in the current second
+static uint32_t prof_fps_start;  // when the current second started
+static FILE *prof_csv;
+static bool prof_csv_failed; // don't retry opening the file every frame
+
+const char *const prof_time_names[PROF_NUM_TIMES] = {
+    "update", "render", "dl_walk", "transform", "clip", "raster", "texture", "blit", "audio",
+};
+
+static const char *const prof_count_names[PROF_NUM_COUNTS] = {
+    "tris", "pixels", "tex_misses", "shader_switches", "voices", "updates", "allocs", "arena_free_kb",
+    "floor_hits", "floor_saved", "room_hits", "room_misses", "gfx_opa", "gfx_xlu", "gfx_overlay", "gfx_work",
+    "gfx_tail", "input_wait_ms", "input_latency_ms",
+};
+
+// 3x5 glyphs for the characters the HUD prints, rows from the top, 3 bits each
+static const char hud_chars[] = "0123456789BCDEFHILMNPRSTUXAKOVW";
+static const uint16_t hud_glyphs[] = {
+    0b111101101101111, 0b010110010010111, 0b111001111100111, 0b111001111001111, // 0-3
+    0b101101111001001, 0b111100111001111, 0b111100111101111, 0b111001001001001, // 4-7
+    0b111101111101111, 0b111101111001111, 0b110101110101110, 0b111100100100111, // 8-9, B, C
+    0b110101101101110, 0b111100110100111, 0b111100110100100, 0b101101111101101, // D, E, F, H
+    0b111010010010111, 0b100100100100111, 0b101111111101101, 0b110101101101101, // I, L, M, N
+    0b110101110100100, 0b110101110101101, 0b011100010001110, 0b111010010010010, // P, R, S, T
+    0b101101101101111, 0b101101010101101, 0b010101111101101, 0b101101110101101, // U, X, A, K
+    0b111101101101111, 0b101101101101010, 0b101101111111101,                    // O, V, W
+};
+
+void profiling_reset(void) {
+    memset(&prof_frame, 0, sizeof(prof_frame));
+}
+
+static void profiling_csv_write(void) {
+    if (prof_csv == NULL) {
+        if (prof_csv_failed)
+            return;
+        prof_csv = fopen(PROF_CSV_FILENAME, "a");
+        if (prof_csv == NULL) {
+            printf("Could not open '%s' for profiling\n", PROF_CSV_FILENAME);
+            prof_csv_failed = true;
+            return;
+        }
+        // a new file gets the header, runs appended to an old one are told apart by the frame
+        // numbers starting over
+        fseek(prof_csv, 0, SEEK_END);
+        if (ftell(prof_csv) == 0) {
+            fputs("frame,fps", prof_csv);
+            for (int i = 0; i < PROF_NUM_TIMES; i++)
+                fprintf(prof_csv, ",%s_ms", prof_time_names[i]);
+            for (int i = 0; i < PROF_NUM_COUNTS; i++)
+                fprintf(prof_csv, ",%s", prof_count_names[i]);
+            fputc('\n', prof_csv);
+        }
+    }
+
+    fprintf(prof_csv, "%lu,%lu", (unsigned long) prof_frames, (unsigned long) prof_fps);
+    for (int i = 0; i < PROF_NUM_TIMES; i++)
+        fprintf(prof_csv, ",%lu", (unsigned long) prof_last.time[i]);
+    for (int i = 0; i < PROF_NUM_COUNTS; i++)
+        fprintf(prof_csv, ",%lu", (unsigned long) prof_last.count[i]);
+    fputc('\n', prof_csv);
+}
+
+void profiling_end_frame(void) {
+    const uint32_t now = tmr_ms();
+
+    // a DL walk can't take less than what was measured inside of it, but the rounding of the inner
+    // times can make it look like it did
+    uint32_t inner = 0;
+    for (int i = PROF_TRANSFORM; i <= PROF_TEXTURE; i++)
+        inner += prof_frame.time[i];
+    prof_frame.time[PROF_DL_WALK] =
+        (prof_frame.time[PROF_DL_WALK] > inner) ? prof_frame.time[PROF_DL_WALK] - inner : 0;
+
+    prof_last = prof_frame;
+    profiling_reset();
+
+    prof_frames++;
+    prof_fps_frames++;
+    if (now - prof_fps_start >= 1000) {
+        prof_fps = prof_fps_frames;
+        prof_fps_frames = 0;
+        prof_fps_start = now;
+    }
+
+    // stdio buffers the lines, so the filesystem is only hit every few frames
+    if (configProfileCsv)
+        profiling_csv_write();
+}
+
+static void hud_draw_text(uint16_t *fb, const int width, int x, const int y, const char *str) {
+    for (; *str != '\0' && x + HUD_GLYPH_W <= width; str++, x += HUD_ADVANCE) {
+        const char *c = strchr(hud_chars, *str);
+        if (*str == ' ' || c == NULL)
+            continue;
+        const uint16_t glyph = hud_glyphs[c - hud_chars];
+        for (int row = 0; row < HUD_GLYPH_H; row++) {
+            for (int col = 0; col < HUD_GLYPH_W; col++) {
+                const int bit = (HUD_GLYPH_H - row) * HUD_GLYPH_W - col - 1;
+                if (glyph & (1 << bit))
+                    fb[(y + row) * width + x + col] = 0xFFFF;
+            }
+        }
+    }
+}
+
+#if MEM_STATS
+#define HUD_LINES 5
+#else
+#define HUD_LINES 3
+#endif
+
+// KB of a pool's bytes, rounded up so a used one never shows 0
+#define MEM_KB(pool, field) ((unsigned long) (mem_stats[pool].field + 1023) >> 10)
+
+void profiling_draw_hud(uint16_t *fb, const int width, const int height) {
+    char line[HUD_LINES][144];
+
+    if (!configProfileHud || height < HUD_LINES * HUD_LINE_H + 1)
+        return;
+
+    snprintf(line[0], sizeof(line[0]),
+             "FPS %lu UPD %lu REN %lu DL %lu XF %lu CLIP %lu RS %lu TEX %lu BLIT %lu SND %lu",
+             (unsigned long) prof_fps, (unsigned long) prof_last.time[PROF_UPDATE],
+             (unsigned long) prof_last.time[PROF_RENDER],
+             (unsigned long) prof_last.time[PROF_DL_WALK],
+             (unsigned long) prof_last.time[PROF_TRANSFORM],
+             (unsigned long) prof_last.time[PROF_CLIP],
+             (unsigned long) prof_last.time[PROF_RASTER],
+             (unsigned long) prof_last.time[PROF_TEXTURE],
+             (unsigned long) prof_last.time[PROF_BLIT],
+             (unsigned long) prof_last.time[PROF_AUDIO]);
+    snprintf(line[1], sizeof(line[1]),
+             "TRI %lu PIX %lu TEX MISS %lu SHD %lu MIX %lu UPD %lu MLC %lu FREE %lu FLR %lu RM %lu %lu",
+             (unsigned long) prof_last.count[PROF_TRIS],
+             (unsigned long) prof_last.count[PROF_PIXELS],
+             (unsigned long) prof_last.count[PROF_TEX_MISSES],
+             (unsigned long) prof_last.count[PROF_SHADER_SWITCHES],
+             (unsigned long) prof_last.count[PROF_VOICES],
+             (unsigned long) prof_last.count[PROF_UPDATES],
+             (unsigned long) prof_last.count[PROF_ALLOCS],
+             (unsigned long) prof_last.count[PROF_ARENA_FREE_KB],
+             (unsigned long) prof_last.count[PROF_FLOOR_HITS],
+             (unsigned long) prof_last.count[PROF_ROOM_HITS],
+             (unsigned long) prof_last.count[PROF_ROOM_MISSES]);
+    // display list arenas in KB, rounded up so a used one never shows 0
+    snprintf(line[2], sizeof(line[2]), "DL KB OPA %lu XLU %lu OVL %lu WORK %lu TAIL %lu IN %lu %lu",
+             (unsigned long) (prof_last.count[PROF_GFX_OPA] + 1023) >> 10,
+             (unsigned long) (prof_last.count[PROF_GFX_XLU] + 1023) >> 10,
+             (unsigned long) (prof_last.count[PROF_GFX_OVERLAY] + 1023) >> 10,
+             (unsigned long) (prof_last.count[PROF_GFX_WORK] + 1023) >> 10,
+             (unsigned long) (prof_last.count[PROF_GFX_TAIL] + 1023) >> 10,
+             (unsigned long) prof_last.count[PROF_INPUT_WAIT],
+             (unsigned long) prof_last.count[PROF_INPUT_LATENCY]);
+
+#if MEM_STATS
+    // used and capacity in KB, F is the largest free block where the pool keeps one
+    snprintf(line[3], sizeof(line[3]), "MEM KB HEAP %lu %lu AR %lu %lu F %lu THA %lu %lu OB %lu %lu F %lu RM %lu",
+             MEM_KB(MEM_HEAP, used), MEM_KB(MEM_HEAP, capacity),
+             MEM_KB(MEM_ZELDA_ARENA, used), MEM_KB(MEM_ZELDA_ARENA, capacity), MEM_KB(MEM_ZELDA_ARENA, max_free),
+             MEM_KB(MEM_GAME_THA, used), MEM_KB(MEM_GAME_THA, capacity),
+             MEM_KB(MEM_OBJECTS, used), MEM_KB(MEM_OBJECTS, capacity), MEM_KB(MEM_OBJECTS, max_free),
+             MEM_KB(MEM_ROOMS, capacity));
+    snprintf(line[4], sizeof(line[4]), "DL %lu %lu TEX %lu %lu F %lu FB %lu EXE %lu PEAK HEAP %lu AR %lu TEX %lu",
+             MEM_KB(MEM_GFX_POOL, used), MEM_KB(MEM_GFX_POOL, capacity),
+             MEM_KB(MEM_TEXCACHE, used), MEM_KB(MEM_TEXCACHE, capacity), MEM_KB(MEM_TEXCACHE, max_free),
+             MEM_KB(MEM_TARGETS, capacity), MEM_KB(MEM_IMAGE, capacity),
+             MEM_KB(MEM_HEAP, peak), MEM_KB(MEM_ZELDA_ARENA, peak), MEM_KB(MEM_TEXCACHE, peak));
+#endif
+
+    // black strip underneath, so the text reads over any scene
+    memset(fb, 0, sizeof(uint16_t) * width * (HUD_LINES * HUD_LINE_H + 1));
+    for (int i = 0; i < HUD_LINES; i++)
+        hud_draw_text(fb, width, 1, 1 + i * HUD_LINE_H, line[i]);
+}
+
+#if PERF_COUNTERS
+// the display list commands run over the whole session, one line for each opcode that ran
+static void profiling_ops_write(void) {
+    FILE *f = fopen(PROF_OPS_FILENAME, "w");
+    if (f == NULL)
+        return;
+
+    fputs("opcode,count,ms\n", f);
+    for (int i = 0; i < 256; i++) {
+        if (gfx_op_stats.count[i] != 0)
+            fprintf(f, "0x%02X,%lu,%lu\n", i, (unsigned long) gfx_op_stats.count[i],
+                    (unsigned long) gfx_op_stats.ms[i]);
+    }
+    fclose(f);
+}
+#endif
+
+void profiling_close(void) {
+#if PERF_COUNTERS
+    profiling_ops_write();
+#endif
+    if (prof_csv != NULL) {
+        fclose(prof_csv);
+        prof_csv = NULL;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef PROFILING_H
+#define PROFILING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// times taken in a frame, in ms. most of them are sums of tmr_ms deltas over many short calls,
+// which round to 0 or 1 ms each, but the rounding averages out over the hundreds of calls a frame
+enum ProfTime {
+    PROF_UPDATE,    // game update of all the iterations behind the frame, skipped ones included
+    PROF_RENDER,    // gfx_run as a whole, front and backend
+    PROF_DL_WALK,   // gfx_run_dl, less the transform, clip, raster and texture times below
+    PROF_TRANSFORM, // gSPVertex
+    PROF_CLIP,      // clipping of the triangles that cross the frustum
+    PROF_RASTER,    // draw_triangles
+    PROF_TEXTURE,   // texture import on cache misses
+    PROF_BLIT,      // upscale and lcd_blit
+    PROF_AUDIO,     // nsp_audio_update, the audio driver's ticks and the mixing
+    PROF_NUM_TIMES
+};
+
+// things counted in a frame
+enum ProfCount {
+    PROF_TRIS,            // triangles sent to the backend
+    PROF_PIXELS,          // pixels in the triangle scanlines shaded, before the depth test
+    PROF_TEX_MISSES,      // texture cache misses
+    PROF_SHADER_SWITCHES, // shader program changes
+    PROF_VOICES,          // most notes mixed in one audio update
+    PROF_UPDATES,         // game updates behind the frame, the dropped ones included
+    PROF_ALLOCS,          // arena allocations in those updates, all arenas
+    PROF_ARENA_FREE_KB,   // free space left in ZeldaArena when the frame is drawn
+    PROF_FLOOR_HITS,      // floor raycasts whose static search came from the cache, see z_bgcheck.c
+    PROF_FLOOR_SAVED,     // floor poly tests those hits skipped
+    PROF_ROOM_HITS,       // room requests that found their room read ahead, see z_room.c
+    PROF_ROOM_MISSES,     // room requests that had to read their room
+    PROF_GFX_OPA,         // bytes of the opaque display list arena the frame used, see graph.c
+    PROF_GFX_XLU,         // of the translucent one
+    PROF_GFX_OVERLAY,     // of the overlay one
+    PROF_GFX_WORK,        // of the work one
+    PROF_GFX_TAIL,        // of the matrices and vertices at the tails of all four
+    PROF_INPUT_WAIT,      // ms from a key press to the update that took it, see input_nsp.c
+    PROF_INPUT_LATENCY,   // ms from it to the end of the blit of the first frame drawn from then on
+    PROF_NUM_COUNTS
+};
+
+struct ProfFrame {
+    uint32_t time[PROF_NUM_TIMES];
+    uint32_t count[PROF_NUM_COUNTS];
+};
+
+extern struct ProfFrame prof_frame; // the frame being measured
+extern struct ProfFrame prof_last;  // the last finished frame
+extern uint32_t prof_fps;           // rendered frames in the last second
+extern const char *const prof_time_names[PROF_NUM_TIMES]; // the CSV column of each time, less "_ms"
+
+// finishes the frame being measured: keeps it in prof_last, appends it to the CSV file when
+// configProfileCsv is set and starts measuring the next one
+void profiling_end_frame(void);
+void profiling_reset(void);
+// draws prof_last over the top rows of an RGB565 frame when configProfileHud is set
+void profiling_draw_hud(uint16_t *fb, int width, int height);
+void profiling_close(void);
+
+#endif
@@ -82,6 +82,16 @@ u32 EffectSsDust_Init(PlayState* play, u32 index, EffectSs* this, void* initPara
     return 1;
 }
 
+#if EFFECT_SS_BATCH
+// The render mode depends on the draw flags, so every dust effect sets up its own material
+void EffectSsDust_Draw(PlayState* play, u32 index, EffectSs* this) {
+    GraphicsContext* gfxCtx = play->state.gfxCtx;
+    f32 scale = this->rScale * 0.0025f;
+    Mtx* mtx = EffectSs_NewBillboardMtx(play, &this->pos, 0.0f, 1.0f, scale, scale, 1.0f);
+
+    OPEN_DISPS(gfxCtx);
+
+#else
 void EffectSsDust_Draw(PlayState* play, u32 index, EffectSs* this) {
     GraphicsContext* gfxCtx = play->state.gfxCtx;
     MtxF mfTrans;
@@ -102,6 +112,7 @@ void EffectSsDust_Draw(PlayState* play, u32 index, EffectSs* this) {
     gSPMatrix(POLY_XLU_DISP++, &gIdentityMtx, G_MTX_NOPUSH | G_MTX_LOAD | G_MTX_MODELVIEW);
 
     mtx = SkinMatrix_MtxFToNewMtx(gfxCtx, &mfResult);
+#endif
 
     if (mtx != NULL) {
         gSPMatrix(POLY_XLU_DISP++, mtx, G_MTX_NOPUSH | G_MTX_LOAD | G_MTX_MODELVIEW);
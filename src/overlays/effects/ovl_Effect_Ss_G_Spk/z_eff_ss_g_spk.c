@@ -74,6 +74,28 @@ u32 EffectSsGSpk_Init(PlayState* play, u32 index, EffectSs* this, void* initPara
     return 1;
 }
 
+#if EFFECT_SS_BATCH
+void EffectSsGSpk_Draw(PlayState* play, u32 index, EffectSs* this) {
+    GraphicsContext* gfxCtx = play->state.gfxCtx;
+    f32 scale = this->rScale * 0.0025f;
+    Mtx* mtx = EffectSs_NewBillboardMtx(play, &this->pos, 0.0f, 1.0f, scale, scale, 1.0f);
+
+    OPEN_DISPS(gfxCtx);
+
+    if (mtx != NULL) {
+        gSPMatrix(POLY_XLU_DISP++, mtx, G_MTX_NOPUSH | G_MTX_LOAD | G_MTX_MODELVIEW);
+        gSPSegment(POLY_XLU_DISP++, 0x08, Lib_SegmentedToVirtual(sSparkTextures[this->rTexIndex]));
+        if (EffectSs_NeedsSetup(this)) {
+            Gfx_SetupDL60_XluNoCD(gfxCtx);
+        }
+        gDPSetPrimColor(POLY_XLU_DISP++, 0, 0, this->rPrimColorR, this->rPrimColorG, this->rPrimColorB, 255);
+        gDPSetEnvColor(POLY_XLU_DISP++, this->rEnvColorR, this->rEnvColorG, this->rEnvColorB, this->rEnvColorA);
+        gSPDisplayList(POLY_XLU_DISP++, this->gfx);
+    }
+
+    CLOSE_DISPS(gfxCtx);
+}
+#else
 void EffectSsGSpk_Draw(PlayState* play, u32 index, EffectSs* this) {
     s32 pad;
     MtxF mfTrans;
@@ -105,6 +127,7 @@ void EffectSsGSpk_Draw(PlayState* play, u32 index, EffectSs* this) {
 
     CLOSE_DISPS(gfxCtx);
 }
+#endif
 
 void EffectSsGSpk_Update(PlayState* play, u32 index, EffectSs* this) {
     this->accel.x = (Rand_ZeroOne() - 0.5f) * 3.0f;
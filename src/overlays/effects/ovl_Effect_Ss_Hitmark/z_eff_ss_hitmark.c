@@ -108,6 +108,29 @@ u32 EffectSsHitmark_Init(PlayState* play, u32 index, EffectSs* this, void* initP
     return 1;
 }
 
+#if EFFECT_SS_BATCH
+void EffectSsHitmark_Draw(PlayState* play, u32 index, EffectSs* this) {
+    GraphicsContext* gfxCtx = play->state.gfxCtx;
+    f32 scale = this->rScale / 100.0f;
+    Mtx* mtx = EffectSs_NewBillboardMtx(play, &this->pos, 0.0f, 1.0f, scale, scale, 1.0f);
+    TexturePtr tex;
+
+    OPEN_DISPS(gfxCtx);
+
+    if (mtx != NULL) {
+        gSPMatrix(POLY_XLU_DISP++, mtx, G_MTX_NOPUSH | G_MTX_LOAD | G_MTX_MODELVIEW);
+        tex = sTextures[(this->rType * 8) + (this->rTexIndex)];
+        gSPSegment(POLY_XLU_DISP++, 0x08, Lib_SegmentedToVirtual(tex));
+        if (EffectSs_NeedsSetup(this)) {
+            Gfx_SetupDL61_Xlu(gfxCtx);
+        }
+        gDPSetPrimColor(POLY_XLU_DISP++, 0, 0, this->rPrimColorR, this->rPrimColorG, this->rPrimColorB, 255);
+        gDPSetEnvColor(POLY_XLU_DISP++, this->rEnvColorR, this->rEnvColorG, this->rEnvColorB, 0);
+        gSPDisplayList(POLY_XLU_DISP++, this->gfx);
+    }
+    CLOSE_DISPS(gfxCtx);
+}
+#else
 void EffectSsHitmark_Draw(PlayState* play, u32 index, EffectSs* this) {
     GraphicsContext* gfxCtx = play->state.gfxCtx;
     MtxF mfTrans;
@@ -141,6 +164,7 @@ void EffectSsHitmark_Draw(PlayState* play, u32 index, EffectSs* this) {
     }
     CLOSE_DISPS(gfxCtx);
 }
+#endif
 
 void EffectSsHitmark_Update(PlayState* play, u32 index, EffectSs* this) {
     s32 colorIndex;
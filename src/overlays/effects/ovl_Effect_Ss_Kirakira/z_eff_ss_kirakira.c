@@ -80,6 +80,31 @@ u32 EffectSsKirakira_Init(PlayState* play, u32 index, EffectSs* this, void* init
     return 1;
 }
 
+#if EFFECT_SS_BATCH
+void EffectSsKirakira_Draw(PlayState* play, u32 index, EffectSs* this) {
+    GraphicsContext* gfxCtx = play->state.gfxCtx;
+    f32 scale = this->rScale / 10000.0f;
+    Mtx* mtx = EffectSs_NewBillboardMtx(play, &this->pos, Math_SinS(this->rYaw), Math_CosS(this->rYaw), scale, scale,
+                                        1.0f);
+
+    OPEN_DISPS(gfxCtx);
+
+    if (mtx != NULL) {
+        gSPMatrix(POLY_XLU_DISP++, mtx, G_MTX_NOPUSH | G_MTX_LOAD | G_MTX_MODELVIEW);
+        if (EffectSs_NeedsSetup(this)) {
+            Gfx_SetupDL25_Xlu(gfxCtx);
+        }
+        gDPSetPrimColor(POLY_XLU_DISP++, 0x80, 0x80, this->rPrimColorR, this->rPrimColorG, this->rPrimColorB,
+                        (((s8)((55.0f / this->rLifespan) * this->life) + 200)));
+        gDPSetEnvColor(POLY_XLU_DISP++, this->rEnvColorR, this->rEnvColorG, this->rEnvColorB, this->rEnvColorA);
+        gSPClearGeometryMode(POLY_XLU_DISP++, G_FOG | G_LIGHTING);
+        gSPDisplayList(POLY_XLU_DISP++, this->gfx);
+        gSPSetGeometryMode(POLY_XLU_DISP++, G_FOG | G_LIGHTING);
+    }
+
+    CLOSE_DISPS(gfxCtx);
+}
+#else
 void EffectSsKirakira_Draw(PlayState* play, u32 index, EffectSs* this) {
     GraphicsContext* gfxCtx;
     f32 scale = this->rScale / 10000.0f;
@@ -119,6 +144,7 @@ void EffectSsKirakira_Draw(PlayState* play, u32 index, EffectSs* this) {
 
     CLOSE_DISPS(gfxCtx);
 }
+#endif
 
 void func_80977DB4(PlayState* play, u32 index, EffectSs* this) {
     this->accel.x = (Rand_ZeroOne() * 0.4f) - 0.2f;
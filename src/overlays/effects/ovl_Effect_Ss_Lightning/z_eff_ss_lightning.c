@@ -83,6 +83,43 @@ void EffectSsLightning_NewLightning(PlayState* play, Vec3f* pos, s32 yaw, Effect
     EffectSs_Insert(play, &newLightning);
 }
 
+#if EFFECT_SS_BATCH
+void EffectSsLightning_Draw(PlayState* play, u32 index, EffectSs* this) {
+    GraphicsContext* gfxCtx = play->state.gfxCtx;
+    Mtx* mtx;
+    f32 yScale;
+    s32 texIndex;
+    f32 xzScale;
+
+    OPEN_DISPS(gfxCtx);
+
+    yScale = this->rScale * 0.01f;
+    texIndex = this->rLifespan - this->life;
+
+    if (texIndex >= ARRAY_COUNT(sLightningTextures)) {
+        texIndex = ARRAY_COUNT(sLightningTextures) - 1;
+    }
+
+    // Nothing sets this->vec, so the bolt only rolls around the view axis
+    xzScale = yScale * 0.6f;
+    mtx = EffectSs_NewBillboardMtx(play, &this->pos, Math_SinS(this->rYaw), Math_CosS(this->rYaw), xzScale, yScale,
+                                   xzScale);
+
+    if (mtx != NULL) {
+        gSPMatrix(POLY_XLU_DISP++, mtx, G_MTX_NOPUSH | G_MTX_LOAD | G_MTX_MODELVIEW);
+        if (EffectSs_NeedsSetup(this)) {
+            Gfx_SetupDL61_Xlu(gfxCtx);
+        }
+        gSPSegment(POLY_XLU_DISP++, 0x08, sLightningTextures[texIndex]);
+        gDPSetPrimColor(POLY_XLU_DISP++, 0, 0, this->rPrimColorR, this->rPrimColorG, this->rPrimColorB,
+                        this->rPrimColorA);
+        gDPSetEnvColor(POLY_XLU_DISP++, this->rEnvColorR, this->rEnvColorG, this->rEnvColorB, this->rEnvColorA);
+        gSPDisplayList(POLY_XLU_DISP++, this->gfx);
+    }
+
+    CLOSE_DISPS(gfxCtx);
+}
+#else
 void EffectSsLightning_Draw(PlayState* play, u32 index, EffectSs* this) {
     GraphicsContext* gfxCtx = play->state.gfxCtx;
     MtxF mfResult;
@@ -129,6 +166,7 @@ void EffectSsLightning_Draw(PlayState* play, u32 index, EffectSs* this) {
 
     CLOSE_DISPS(gfxCtx);
 }
+#endif
 
 void EffectSsLightning_Update(PlayState* play, u32 index, EffectSs* this) {
     s32 pad;
@@ -0,0 +1,235 @@
+#include "ArchiveExporter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Globals.h"
+#include "Utils/BitConverter.h"
+#include "Utils/File.h"
+
+#define YAZ0_HEADER_SIZE 0x10
+#define YAZ0_WINDOW_SIZE 0x1000
+#define YAZ0_MIN_MATCH 3
+#define YAZ0_MAX_MATCH (0xFF + 0x12)
+#define YAZ0_HASH_SIZE 0x1000
+
+struct ArchiveItem
+{
+	ZArchiveEntry entry;
+	std::vector<uint8_t> payload;
+};
+
+// What has been gathered of the file being extracted. Batch extraction works on several files at
+// once, one per thread.
+struct ArchiveFileState
+{
+	std::vector<ArchiveItem> items;
+};
+
+static thread_local ArchiveFileState fileState;
+static bool compressPayloads = false;
+
+static uint64_t ArchiveHash(const std::string& name)
+{
+	uint64_t hash = 0xCBF29CE484222325;
+
+	for (char c : name)
+		hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3;
+	return hash;
+}
+
+/**
+ * Compresses the data of a resource as Yaz0. Resources are small, so this is a plain greedy
+ * encoder following one hash chain, it doesn't try to match the output of Nintendo's.
+ */
+static std::vector<uint8_t> ArchiveYaz0Compress(const uint8_t* src, size_t size)
+{
+	std::vector<uint8_t> out(YAZ0_HEADER_SIZE);
+	std::vector<int32_t> head(YAZ0_HASH_SIZE, -1);
+	std::vector<int32_t> prev(size, -1);
+	size_t pos = 0;
+
+	out.reserve(YAZ0_HEADER_SIZE + size + size / 8 + 1);
+	memcpy(out.data(), "Yaz0", 4);
+	for (size_t i = 0; i < 4; i++)
+		out[4 + i] = (size >> (24 - 8 * i)) & 0xFF;
+
+	auto hash3 = [src](size_t p) {
+		return ((src[p] << 8) ^ (src[p + 1] << 4) ^ src[p + 2]) & (YAZ0_HASH_SIZE - 1);
+	};
+	auto insert = [&](size_t p) {
+		if (p + YAZ0_MIN_MATCH <= size)
+		{
+			uint32_t h = hash3(p);
+
+			prev[p] = head[h];
+			head[h] = p;
+		}
+	};
+
+	while (pos < size)
+	{
+		size_t groupPos = out.size();
+
+		out.push_back(0);
+		for (int bit = 7; bit >= 0 && pos < size; bit--)
+		{
+			size_t bestLen = 0;
+			size_t bestDist = 0;
+
+			if (pos + YAZ0_MIN_MATCH <= size)
+			{
+				size_t maxLen = std::min<size_t>(size - pos, YAZ0_MAX_MATCH);
+
+				for (int32_t cand = head[hash3(pos)]; cand >= 0 && pos - cand <= YAZ0_WINDOW_SIZE;
+				     cand = prev[cand])
+				{
+					size_t len = 0;
+
+					while (len < maxLen && src[cand + len] == src[pos + len])
+						len++;
+					if (len > bestLen)
+					{
+						bestLen = len;
+						bestDist = pos - cand;
+						if (len == maxLen)
+							break;
+					}
+				}
+			}
+
+			if (bestLen < YAZ0_MIN_MATCH)
+			{
+				out[groupPos] |= 1 << bit;
+				out.push_back(src[pos]);
+				insert(pos);
+				pos++;
+				continue;
+			}
+
+			size_t dist = bestDist - 1;
+			if (bestLen >= 0x12)
+			{
+				out.push_back(dist >> 8);
+				out.push_back(dist & 0xFF);
+				out.push_back(bestLen - 0x12);
+			}
+			else
+			{
+				out.push_back(((bestLen - 2) << 4) | (dist >> 8));
+				out.push_back(dist & 0xFF);
+			}
+			for (size_t i = 0; i < bestLen; i++)
+				insert(pos + i);
+			pos += bestLen;
+		}
+	}
+
+	return out;
+}
+
+static void ArchiveWriteU32(std::vector<uint8_t>& out, size_t pos, uint32_t value)
+{
+	for (size_t i = 0; i < 4; i++)
+		out[pos + i] = (value >> (8 * i)) & 0xFF;
+}
+
+static void ArchiveWriteU64(std::vector<uint8_t>& out, size_t pos, uint64_t value)
+{
+	ArchiveWriteU32(out, pos, value & 0xFFFFFFFF);
+	ArchiveWriteU32(out, pos + 4, value >> 32);
+}
+
+void ArchiveExporter_ParseArgs([[maybe_unused]] int argc, char* argv[], int& i)
+{
+	std::string arg = argv[i];
+
+	if (arg == "--archive-compress")
+		compressPayloads = true;
+}
+
+void ArchiveExporter_FileBegin([[maybe_unused]] ZFile* file)
+{
+	fileState = ArchiveFileState();
+}
+
+void ArchiveExporter_ResSave(ZResource* res, [[maybe_unused]] BinaryWriter& writer)
+{
+	const DataView& data = res->parent->GetRawData();
+	size_t size = res->GetRawDataSize();
+	offset_t offset = res->GetRawDataIndex();
+
+	if (size == 0 || offset + size > data.size())
+		return;
+
+	ArchiveItem item = {};
+	item.entry.nameHash = ArchiveHash(res->GetName());
+	item.entry.type = static_cast<uint32_t>(res->GetResourceType());
+	item.entry.rawSize = size;
+	item.entry.srcOffset = offset;
+
+	if (compressPayloads)
+	{
+		item.payload = ArchiveYaz0Compress(data.data() + offset, size);
+		item.entry.flags = ZARCHIVE_FLAG_YAZ0;
+	}
+	// Stored as is, when it doesn't shrink
+	if (item.payload.empty() || item.payload.size() >= size)
+	{
+		item.payload.assign(data.data() + offset, data.data() + offset + size);
+		item.entry.flags = 0;
+	}
+
+	fileState.items.push_back(std::move(item));
+}
+
+void ArchiveExporter_FileEnd(ZFile* file)
+{
+	std::vector<ArchiveItem> items = std::move(fileState.items);
+	fileState = ArchiveFileState();
+
+	if (items.empty())
+		return;
+
+	// The reader looks entries up by binary search, the same name declared twice is one entry
+	std::stable_sort(items.begin(), items.end(), [](const ArchiveItem& a, const ArchiveItem& b) {
+		return a.entry.nameHash < b.entry.nameHash;
+	});
+	items.erase(std::unique(items.begin(), items.end(),
+	                        [](const ArchiveItem& a, const ArchiveItem& b) {
+		                        return a.entry.nameHash == b.entry.nameHash;
+	                        }),
+	            items.end());
+
+	std::vector<uint8_t> out(ZARCHIVE_HEADER_SIZE + items.size() * ZARCHIVE_ENTRY_SIZE);
+
+	for (ArchiveItem& item : items)
+	{
+		out.resize(ALIGN16(out.size()));
+		item.entry.offset = out.size();
+		item.entry.size = item.payload.size();
+		out.insert(out.end(), item.payload.begin(), item.payload.end());
+	}
+	out.resize(ALIGN16(out.size()));
+
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		const ZArchiveEntry& e = items[i].entry;
+		size_t pos = ZARCHIVE_HEADER_SIZE + i * ZARCHIVE_ENTRY_SIZE;
+
+		ArchiveWriteU64(out, pos + 0x00, e.nameHash);
+		ArchiveWriteU32(out, pos + 0x08, e.type);
+		ArchiveWriteU32(out, pos + 0x0C, e.flags);
+		ArchiveWriteU32(out, pos + 0x10, e.offset);
+		ArchiveWriteU32(out, pos + 0x14, e.size);
+		ArchiveWriteU32(out, pos + 0x18, e.rawSize);
+		ArchiveWriteU32(out, pos + 0x1C, e.srcOffset);
+	}
+
+	memcpy(out.data(), "ZARC", 4);
+	ArchiveWriteU32(out, 0x4, ZARCHIVE_VERSION);
+	ArchiveWriteU32(out, 0x8, items.size());
+	ArchiveWriteU32(out, 0xC, ZARCHIVE_ALIGN);
+
+	File::WriteAllBytesIfChanged(Globals::Job->outputPath / (file->GetName() + ".zar"), out);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Utils/BinaryWriter.h"
+#include "ZFile.h"
+#include "ZResource.h"
+
+// The "ARCHIVE" exporter set writes next to every extracted file a resource archive named after
+// it, holding the raw data of every resource of the file, so a port can look them up by name
+// instead of opening one file for each. tools/mkzarchive.py merges them into the archive of a
+// whole ROM, which has the same layout, and tools/zarchive/zarchive.c reads that.
+//
+// All of it is little endian:
+//   header   "ZARC", u32 version, u32 entry count, u32 payload alignment
+//   TOC      right after the header, the entries sorted by name hash
+//   payloads each one aligned to the payload alignment, so with the archive mapped at a page
+//            boundary they can be used where they are
+//
+// Passing --archive-compress stores the payloads that shrink as Yaz0.
+#define ZARCHIVE_VERSION 1
+#define ZARCHIVE_HEADER_SIZE 0x10
+#define ZARCHIVE_ENTRY_SIZE 0x20
+#define ZARCHIVE_ALIGN 0x10
+
+#define ZARCHIVE_FLAG_YAZ0 (1 << 0)
+
+struct ZArchiveEntry
+{
+	uint64_t nameHash;  // FNV-1a of the resource name
+	uint32_t type;      // ZResourceType, the value as is
+	uint32_t flags;     // ZARCHIVE_FLAG_*
+	uint32_t offset;    // of the payload in the archive
+	uint32_t size;      // of the payload
+	uint32_t rawSize;   // of the resource, the payload decompressed
+	uint32_t srcOffset;  // of the resource in the file it comes from
+};
+
+void ArchiveExporter_ParseArgs(int argc, char* argv[], int& i);
+void ArchiveExporter_FileBegin(ZFile* file);
+void ArchiveExporter_FileEnd(ZFile* file);
+void ArchiveExporter_ResSave(ZResource* res, BinaryWriter& writer);
@@ -34,26 +34,25 @@ void ExporterExample_Collision::Save(ZResource* res, [[maybe_unused]] fs::path o
 
 	writer->Seek(col->vtxSegmentOffset, SeekOffsetType::Start);
 
-	for (uint16_t i = 0; i < col->vertices.size(); i++)
+	for (size_t i = 0; i < col->vertices.size(); i++)
 	{
-		for (uint32_t j = 0; j < col->vertices[i].dimensions; j++)
-		{
-			writer->Write(col->vertices[i].scalars[j].scalarData.s16);
-		}
+		writer->Write(col->vertices.x[i]);
+		writer->Write(col->vertices.y[i]);
+		writer->Write(col->vertices.z[i]);
 	}
 
 	writer->Seek(col->polySegmentOffset, SeekOffsetType::Start);
 
-	for (uint16_t i = 0; i < col->polygons.size(); i++)
+	for (size_t i = 0; i < col->polygons.size(); i++)
 	{
-		writer->Write(col->polygons[i].type);
-		writer->Write(col->polygons[i].vtxA);
-		writer->Write(col->polygons[i].vtxB);
-		writer->Write(col->polygons[i].vtxC);
-		writer->Write(col->polygons[i].normX);
-		writer->Write(col->polygons[i].normY);
-		writer->Write(col->polygons[i].normZ);
-		writer->Write(col->polygons[i].dist);
+		writer->Write(col->polygons.type[i]);
+		writer->Write(col->polygons.vtxA[i]);
+		writer->Write(col->polygons.vtxB[i]);
+		writer->Write(col->polygons.vtxC[i]);
+		writer->Write(col->polygons.normX[i]);
+		writer->Write(col->polygons.normY[i]);
+		writer->Write(col->polygons.normZ[i]);
+		writer->Write(col->polygons.dist[i]);
 	}
 
 	writer->Seek(col->polyTypeDefSegmentOffset, SeekOffsetType::Start);
@@ -1,5 +1,7 @@
+#include "ArchiveExporter.h"
 #include "CollisionExporter.h"
 #include "Globals.h"
+#include "NspireExporter.h"
 #include "RoomExporter.h"
 #include "TextureExporter.h"
 
@@ -72,6 +74,29 @@ static void ImportExporters()
 	exporterSet->exporters[ZResourceType::CollisionHeader] = new ExporterExample_Collision();
 
 	Globals::AddExporter("EXAMPLE", exporterSet);
+
+	// "NSPIRE" writes the pack fragments of the TI-Nspire port, see NspireExporter.h
+	ExporterSet* nspireSet = new ExporterSet();
+	nspireSet->beginFileFunc = NspireExporter_FileBegin;
+	nspireSet->endFileFunc = NspireExporter_FileEnd;
+	nspireSet->exporters[ZResourceType::Texture] = new ExporterNspire_Texture();
+	nspireSet->exporters[ZResourceType::Vertex] = new ExporterNspire_Vertex();
+	nspireSet->exporters[ZResourceType::Mtx] = new ExporterNspire_Mtx();
+	nspireSet->exporters[ZResourceType::DisplayList] = new ExporterNspire_DisplayList();
+	nspireSet->exporters[ZResourceType::Array] = new ExporterNspire_Array();
+	nspireSet->exporters[ZResourceType::PlayerAnimationData] =
+		new ExporterNspire_PlayerAnimationData();
+
+	Globals::AddExporter("NSPIRE", nspireSet);
+
+	// "ARCHIVE" writes a resource archive of every file, see ArchiveExporter.h
+	ExporterSet* archiveSet = new ExporterSet();
+	archiveSet->parseArgsFunc = ArchiveExporter_ParseArgs;
+	archiveSet->beginFileFunc = ArchiveExporter_FileBegin;
+	archiveSet->endFileFunc = ArchiveExporter_FileEnd;
+	archiveSet->resSaveFunc = ArchiveExporter_ResSave;
+
+	Globals::AddExporter("ARCHIVE", archiveSet);
 }
 
 // When ZAPD starts up, it will automatically call the below function, which in turn sets up our
@@ -0,0 +1,373 @@
+#include "NspireExporter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+
+#include "Globals.h"
+#include "Utils/BitConverter.h"
+#include "Utils/File.h"
+#include "ZFile.h"
+
+#define VTX_SIZE 0x10
+#define MTX_SIZE 0x40
+
+// Same scaling as SCALE_M_N in the port's gfx_frontend.c, the texels have to match what it would
+// decode to
+#define SCALE_5_8(v) (((v)*0xFF) / 0x1F)
+#define SCALE_4_8(v) ((v)*0x11)
+#define SCALE_3_8(v) ((v)*0x24)
+
+struct NspirePackItem
+{
+	NspPackEntry entry;
+	std::vector<uint8_t> payload;
+};
+
+// What has been gathered of the file being extracted. Batch extraction works on several files at
+// once, one per thread.
+struct NspireFileState
+{
+	std::map<offset_t, NspirePackItem> textures;
+	std::set<offset_t> vertices;
+	std::set<offset_t> matrices;
+	std::map<offset_t, size_t> s16Runs;  // sizes by offset
+};
+
+static thread_local NspireFileState fileState;
+
+static uint32_t NspireHash(const uint8_t* data, size_t size)
+{
+	uint32_t hash = 0x811C9DC5;
+
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ data[i]) * 0x01000193;
+	return hash;
+}
+
+static void NspireSetTexel(std::vector<uint8_t>& texels, size_t i, uint8_t r, uint8_t g, uint8_t b,
+                           uint8_t a)
+{
+	texels[4 * i + 0] = r;
+	texels[4 * i + 1] = g;
+	texels[4 * i + 2] = b;
+	texels[4 * i + 3] = a;
+}
+
+/**
+ * Decodes a texture the way the port's frontend would. Color indexed textures are left to runtime,
+ * the palette they're drawn with is only known then, and RGBA32 ones need no decoding at all.
+ */
+static bool NspireDecodeTexture(ZTexture* tex, const uint8_t* src, NspirePackItem& out)
+{
+	size_t numTexels = tex->GetWidth() * tex->GetHeight();
+	std::vector<uint8_t>& texels = out.payload;
+	F3DZEXTexFormats fmt;
+	F3DZEXTexSizes siz;
+
+	texels.resize(4 * numTexels);
+
+	switch (tex->GetTextureType())
+	{
+	case TextureType::RGBA16bpp:
+		fmt = F3DZEXTexFormats::G_IM_FMT_RGBA;
+		siz = F3DZEXTexSizes::G_IM_SIZ_16b;
+		for (size_t i = 0; i < numTexels; i++)
+		{
+			uint16_t col16 = (src[2 * i] << 8) | src[2 * i + 1];
+
+			NspireSetTexel(texels, i, SCALE_5_8(col16 >> 11), SCALE_5_8((col16 >> 6) & 0x1F),
+			               SCALE_5_8((col16 >> 1) & 0x1F), (col16 & 1) ? 255 : 0);
+		}
+		break;
+
+	case TextureType::GrayscaleAlpha4bpp:
+		fmt = F3DZEXTexFormats::G_IM_FMT_IA;
+		siz = F3DZEXTexSizes::G_IM_SIZ_4b;
+		for (size_t i = 0; i < numTexels; i++)
+		{
+			uint8_t part = (src[i / 2] >> (4 - (i % 2) * 4)) & 0xF;
+			uint8_t intensity = SCALE_3_8(part >> 1);
+
+			NspireSetTexel(texels, i, intensity, intensity, intensity, (part & 1) ? 255 : 0);
+		}
+		break;
+
+	case TextureType::GrayscaleAlpha8bpp:
+		fmt = F3DZEXTexFormats::G_IM_FMT_IA;
+		siz = F3DZEXTexSizes::G_IM_SIZ_8b;
+		for (size_t i = 0; i < numTexels; i++)
+		{
+			uint8_t intensity = SCALE_4_8(src[i] >> 4);
+
+			NspireSetTexel(texels, i, intensity, intensity, intensity, SCALE_4_8(src[i] & 0xF));
+		}
+		break;
+
+	case TextureType::GrayscaleAlpha16bpp:
+		fmt = F3DZEXTexFormats::G_IM_FMT_IA;
+		siz = F3DZEXTexSizes::G_IM_SIZ_16b;
+		for (size_t i = 0; i < numTexels; i++)
+			NspireSetTexel(texels, i, src[2 * i], src[2 * i], src[2 * i], src[2 * i + 1]);
+		break;
+
+	case TextureType::Grayscale4bpp:
+		fmt = F3DZEXTexFormats::G_IM_FMT_I;
+		siz = F3DZEXTexSizes::G_IM_SIZ_4b;
+		for (size_t i = 0; i < numTexels; i++)
+		{
+			uint8_t intensity = SCALE_4_8((src[i / 2] >> (4 - (i % 2) * 4)) & 0xF);
+
+			NspireSetTexel(texels, i, intensity, intensity, intensity, 255);
+		}
+		break;
+
+	case TextureType::Grayscale8bpp:
+		fmt = F3DZEXTexFormats::G_IM_FMT_I;
+		siz = F3DZEXTexSizes::G_IM_SIZ_8b;
+		for (size_t i = 0; i < numTexels; i++)
+			NspireSetTexel(texels, i, src[i], src[i], src[i], 255);
+		break;
+
+	default:
+		return false;
+	}
+
+	out.entry.type = static_cast<uint8_t>(NspPackEntryType::Texture);
+	out.entry.fmt = static_cast<uint8_t>(fmt);
+	out.entry.siz = static_cast<uint8_t>(siz);
+	out.entry.width = tex->GetWidth();
+	out.entry.height = tex->GetHeight();
+	out.entry.srcSize = tex->GetRawDataSize();
+	out.entry.srcHash = NspireHash(src, tex->GetRawDataSize());
+	return true;
+}
+
+void ExporterNspire_Texture::Save(ZResource* res, [[maybe_unused]] fs::path outPath,
+                                  [[maybe_unused]] BinaryWriter* writer)
+{
+	ZTexture* tex = (ZTexture*)res;
+	const DataView& data = tex->parent->GetRawData();
+	NspirePackItem packTex = {};
+
+	if (tex->isPalette || tex->GetRawDataIndex() + tex->GetRawDataSize() > data.size())
+		return;
+	if (fileState.textures.count(tex->GetRawDataIndex()) != 0)
+		return;
+
+	packTex.entry.address = tex->GetRawDataIndex();
+	if (NspireDecodeTexture(tex, data.data() + tex->GetRawDataIndex(), packTex))
+		fileState.textures[tex->GetRawDataIndex()] = std::move(packTex);
+}
+
+void ExporterNspire_Vertex::Save(ZResource* res, [[maybe_unused]] fs::path outPath,
+                                 [[maybe_unused]] BinaryWriter* writer)
+{
+	fileState.vertices.insert(res->GetRawDataIndex());
+}
+
+void ExporterNspire_Mtx::Save(ZResource* res, [[maybe_unused]] fs::path outPath,
+                              [[maybe_unused]] BinaryWriter* writer)
+{
+	fileState.matrices.insert(res->GetRawDataIndex());
+}
+
+void ExporterNspire_DisplayList::Save(ZResource* res, [[maybe_unused]] fs::path outPath,
+                                      [[maybe_unused]] BinaryWriter* writer)
+{
+	ZDisplayList* dlist = (ZDisplayList*)res;
+
+	for (const auto& vtxList : dlist->vertices)
+	{
+		for (size_t i = 0; i < vtxList.second.size(); i++)
+			fileState.vertices.insert(vtxList.first + i * VTX_SIZE);
+	}
+	for (const auto& mtx : dlist->mtxList)
+		fileState.matrices.insert(mtx.GetRawDataIndex());
+}
+
+void ExporterNspire_Array::Save(ZResource* res, [[maybe_unused]] fs::path outPath,
+                                [[maybe_unused]] BinaryWriter* writer)
+{
+	size_t size = res->GetRawDataSize();
+
+	if (size == 0)
+		return;
+
+	std::string type = res->GetSourceTypeName();
+	if (type == "Vtx")
+	{
+		for (size_t i = 0; i < size; i += VTX_SIZE)
+			fileState.vertices.insert(res->GetRawDataIndex() + i);
+	}
+	else if (type == "Mtx")
+	{
+		for (size_t i = 0; i < size; i += MTX_SIZE)
+			fileState.matrices.insert(res->GetRawDataIndex() + i);
+	}
+}
+
+void ExporterNspire_PlayerAnimationData::Save(ZResource* res, [[maybe_unused]] fs::path outPath,
+                                              [[maybe_unused]] BinaryWriter* writer)
+{
+	size_t& size = fileState.s16Runs[res->GetRawDataIndex()];
+
+	size = std::max(size, res->GetRawDataSize());
+}
+
+static void NspireWriteU16(std::vector<uint8_t>& out, size_t pos, uint16_t value)
+{
+	out[pos + 0] = value & 0xFF;
+	out[pos + 1] = value >> 8;
+}
+
+static void NspireWriteU32(std::vector<uint8_t>& out, size_t pos, uint32_t value)
+{
+	NspireWriteU16(out, pos, value & 0xFFFF);
+	NspireWriteU16(out, pos + 2, value >> 16);
+}
+
+/**
+ * Turns the offsets of single Vtx or Mtx into entries for runs of them, the two big endian to
+ * little endian swaps being a halfword swap of the Vtx fields before the color and a word swap of
+ * every Mtx word.
+ */
+static void NspireAddRuns(const std::set<offset_t>& offsets, NspPackEntryType type,
+                          const DataView& data, std::vector<NspirePackItem>& entries)
+{
+	size_t elemSize = (type == NspPackEntryType::Vertex) ? VTX_SIZE : MTX_SIZE;
+
+	for (auto it = offsets.begin(); it != offsets.end();)
+	{
+		offset_t start = *it;
+		offset_t end = start;
+
+		// Overlapping lists end up as one run of the vertices of all of them
+		while (it != offsets.end() && *it <= end)
+		{
+			end = std::max<offset_t>(end, *it + elemSize);
+			it++;
+		}
+		if (end > data.size())
+			continue;
+
+		NspirePackItem run = {};
+		run.entry.address = start;
+		run.entry.type = static_cast<uint8_t>(type);
+		run.entry.srcSize = end - start;
+		run.payload.assign(data.data() + start, data.data() + end);
+
+		for (size_t i = 0; i < run.payload.size(); i += 4)
+		{
+			if (type == NspPackEntryType::Vertex && (i % VTX_SIZE) == 0xC)
+				continue;  // cn, four bytes
+			if (type == NspPackEntryType::Vertex)
+			{
+				std::swap(run.payload[i + 0], run.payload[i + 1]);
+				std::swap(run.payload[i + 2], run.payload[i + 3]);
+			}
+			else
+			{
+				std::swap(run.payload[i + 0], run.payload[i + 3]);
+				std::swap(run.payload[i + 1], run.payload[i + 2]);
+			}
+		}
+		entries.push_back(std::move(run));
+	}
+}
+
+/**
+ * Turns the ranges of s16 into entries, each s16 swapped in place. Ranges that touch or overlap
+ * are merged, the frames of one animation can run straight into the next one's.
+ */
+static void NspireAddS16Runs(const std::map<offset_t, size_t>& ranges, const DataView& data,
+                             std::vector<NspirePackItem>& entries)
+{
+	for (auto it = ranges.begin(); it != ranges.end();)
+	{
+		offset_t start = it->first;
+		offset_t end = start;
+
+		while (it != ranges.end() && it->first <= end)
+		{
+			end = std::max<offset_t>(end, it->first + it->second);
+			it++;
+		}
+		if (end > data.size() || end == start)
+			continue;
+
+		NspirePackItem run = {};
+		run.entry.address = start;
+		run.entry.type = static_cast<uint8_t>(NspPackEntryType::S16);
+		run.entry.srcSize = end - start;
+		run.payload.assign(data.data() + start, data.data() + end);
+
+		for (size_t i = 0; i + 1 < run.payload.size(); i += 2)
+			std::swap(run.payload[i + 0], run.payload[i + 1]);
+		entries.push_back(std::move(run));
+	}
+}
+
+void NspireExporter_FileBegin([[maybe_unused]] ZFile* file)
+{
+	fileState = NspireFileState();
+}
+
+void NspireExporter_FileEnd(ZFile* file)
+{
+	const DataView& data = file->GetRawData();
+	std::vector<NspirePackItem> entries;
+	std::vector<uint8_t> out(0x10);
+
+	for (auto& it : fileState.textures)
+		entries.push_back(std::move(it.second));
+	NspireAddRuns(fileState.vertices, NspPackEntryType::Vertex, data, entries);
+	NspireAddRuns(fileState.matrices, NspPackEntryType::Mtx, data, entries);
+	NspireAddS16Runs(fileState.s16Runs, data, entries);
+	fileState = NspireFileState();
+
+	if (entries.empty())
+		return;
+
+	std::sort(entries.begin(), entries.end(), [](const NspirePackItem& a, const NspirePackItem& b) {
+		return a.entry.address < b.entry.address;
+	});
+
+	for (NspirePackItem& e : entries)
+	{
+		out.resize(ALIGN8(out.size()));
+		e.entry.offset = out.size();
+		e.entry.size = e.payload.size();
+		out.insert(out.end(), e.payload.begin(), e.payload.end());
+	}
+
+	out.resize(ALIGN8(out.size()));
+	size_t dirOffset = out.size();
+	out.resize(dirOffset + entries.size() * NSP_PACK_ENTRY_SIZE);
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const NspPackEntry& e = entries[i].entry;
+		size_t pos = dirOffset + i * NSP_PACK_ENTRY_SIZE;
+
+		NspireWriteU32(out, pos + 0x00, e.address);
+		NspireWriteU32(out, pos + 0x04, e.offset);
+		NspireWriteU32(out, pos + 0x08, e.size);
+		NspireWriteU32(out, pos + 0x0C, e.srcSize);
+		NspireWriteU32(out, pos + 0x10, e.srcHash);
+		out[pos + 0x14] = e.type;
+		out[pos + 0x15] = e.fmt;
+		out[pos + 0x16] = e.siz;
+		out[pos + 0x17] = 0;
+		NspireWriteU16(out, pos + 0x18, e.width);
+		NspireWriteU16(out, pos + 0x1A, e.height);
+	}
+
+	memcpy(out.data(), "NSPF", 4);
+	NspireWriteU32(out, 0x4, NSP_PACK_VERSION);
+	NspireWriteU32(out, 0x8, entries.size());
+	NspireWriteU32(out, 0xC, dirOffset);
+
+	File::WriteAllBytes(Globals::Job->outputPath / (file->GetName() + ".nsp"), out);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Utils/BinaryWriter.h"
+#include "ZArray.h"
+#include "ZDisplayList.h"
+#include "ZMtx.h"
+#include "ZPlayerAnimationData.h"
+#include "ZResource.h"
+#include "ZTexture.h"
+#include "ZVtx.h"
+
+// The "NSPIRE" exporter set writes next to every extracted file a pack fragment named after it,
+// holding the resources of the file in the form the TI-Nspire port uses them at runtime:
+// textures decoded to RGBA32 and vertices, matrices and player animation frames in little endian. tools/mknsppack.py merges
+// the fragments into the pack the port loads, keyed by VROM address instead of file offset.
+//
+// Both share this layout, all of it little endian:
+//   header     "NSPF" (fragment) or "NSPK" (pack), u32 version, u32 entry count, u32 directory
+//              offset
+//   payloads   each one 8-byte aligned
+//   directory  the entries, sorted by address
+#define NSP_PACK_VERSION 1
+#define NSP_PACK_ENTRY_SIZE 0x1C
+
+enum class NspPackEntryType
+{
+	Texture = 1,  // RGBA32 texels, decoded the way the port's import_texture_* would
+	Vertex = 2,   // a run of Vtx, fields in little endian
+	Mtx = 3,      // a run of Mtx, every word in little endian
+	S16 = 4,      // a run of s16 in little endian, the frames of player animations
+};
+
+struct NspPackEntry
+{
+	uint32_t address;  // file offset in a fragment, VROM address in a pack
+	uint32_t offset;   // of the payload in the fragment or pack
+	uint32_t size;     // of the payload
+	uint32_t srcSize;  // of the N64 data the payload replaces
+	uint32_t srcHash;  // FNV-1a of the N64 data, textures only
+	uint8_t type;
+	uint8_t fmt, siz;  // G_IM_FMT_* and G_IM_SIZ_* of textures
+	uint8_t pad;
+	uint16_t width, height;
+};
+
+class ExporterNspire_Texture : public ZResourceExporter
+{
+public:
+	void Save(ZResource* res, fs::path outPath, BinaryWriter* writer) override;
+};
+
+class ExporterNspire_Vertex : public ZResourceExporter
+{
+public:
+	void Save(ZResource* res, fs::path outPath, BinaryWriter* writer) override;
+};
+
+class ExporterNspire_Mtx : public ZResourceExporter
+{
+public:
+	void Save(ZResource* res, fs::path outPath, BinaryWriter* writer) override;
+};
+
+// Vertices and matrices only referenced by display lists aren't resources of their own
+class ExporterNspire_DisplayList : public ZResourceExporter
+{
+public:
+	void Save(ZResource* res, fs::path outPath, BinaryWriter* writer) override;
+};
+
+// Arrays of Vtx or Mtx
+class ExporterNspire_Array : public ZResourceExporter
+{
+public:
+	void Save(ZResource* res, fs::path outPath, BinaryWriter* writer) override;
+};
+
+// The frames of Player's animations, which are loaded one at a time from link_animetion
+class ExporterNspire_PlayerAnimationData : public ZResourceExporter
+{
+public:
+	void Save(ZResource* res, fs::path outPath, BinaryWriter* writer) override;
+};
+
+void NspireExporter_FileBegin(ZFile* file);
+void NspireExporter_FileEnd(ZFile* file);
@@ -0,0 +1,124 @@
+#include "AnimationDataRegistry.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <sstream>
+
+#include "Utils/File.h"
+#include "Utils/StringHelper.h"
+
+void AnimationDataRegistry::Add(const std::string& type, uint64_t hash, size_t size,
+                                const std::string& file, const std::string& symbol)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Entry& entry = entries[{type, hash}];
+
+	entry.size = size;
+	entry.occurrences.push_back({file, symbol});
+}
+
+void AnimationDataRegistry::WriteReport(const fs::path& path)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<std::pair<const std::pair<std::string, uint64_t>*, Entry*>> shared;
+	size_t sharedBytes = 0;
+
+	for (auto& entry : entries)
+	{
+		std::vector<Occurrence>& occurrences = entry.second.occurrences;
+
+		// The same file may be extracted by several jobs, and declare the same bytes twice
+		std::sort(occurrences.begin(), occurrences.end());
+		auto sameDeclaration = [](const Occurrence& a, const Occurrence& b) {
+			return a.file == b.file && a.symbol == b.symbol;
+		};
+		occurrences.erase(std::unique(occurrences.begin(), occurrences.end(), sameDeclaration),
+		                  occurrences.end());
+
+		bool inSeveralFiles = std::any_of(
+			occurrences.begin(), occurrences.end(),
+			[&](const Occurrence& occurrence) { return occurrence.file != occurrences[0].file; });
+		if (!inSeveralFiles)
+			continue;
+
+		shared.emplace_back(&entry.first, &entry.second);
+		sharedBytes += entry.second.size * (occurrences.size() - 1);
+	}
+
+	std::stable_sort(shared.begin(), shared.end(), [](const auto& a, const auto& b) {
+		return a.second->size * (a.second->occurrences.size() - 1) >
+		       b.second->size * (b.second->occurrences.size() - 1);
+	});
+
+	std::string report = StringHelper::Sprintf(
+		"# %zu animation data arrays declared by several files, %zu bytes declared again\n"
+		"# type hash size count, then file symbol for each declaration\n",
+		shared.size(), sharedBytes);
+
+	for (const auto& item : shared)
+	{
+		report += StringHelper::Sprintf("%s %016" PRIX64 " %zu %zu\n", item.first->first.c_str(),
+		                                item.first->second, item.second->size,
+		                                item.second->occurrences.size());
+		for (const Occurrence& occurrence : item.second->occurrences)
+			report += StringHelper::Sprintf("\t%s %s\n", occurrence.file.c_str(),
+			                                occurrence.symbol.c_str());
+	}
+
+	File::WriteAllTextIfChanged(path, report);
+}
+
+bool AnimationDataShares::Load(const fs::path& path)
+{
+	if (!File::Exists(path))
+		return false;
+
+	std::istringstream report(File::ReadAllText(path));
+	std::string line;
+	std::string hash;
+	Share* share = nullptr;
+
+	while (std::getline(report, line))
+	{
+		std::istringstream fields(line);
+
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		if (line[0] == '\t')
+		{
+			std::string file;
+			std::string symbol;
+
+			// Only the first declaration is kept, the others refer to it
+			if (share == nullptr || !(fields >> file >> symbol))
+				continue;
+
+			// The single definition is named after the first declaration and the hash of its
+			// bytes, since the names the files gave it aren't unique across them
+			share->symbol = StringHelper::Sprintf("%s_%s", symbol.c_str(), hash.c_str());
+			share->canonicalFile = file;
+			share->canonicalSymbol = symbol;
+			share = nullptr;
+			continue;
+		}
+
+		std::string type;
+		if (!(fields >> type >> hash))
+			return false;
+
+		share = &shares[{type, std::stoull(hash, nullptr, 16)}];
+	}
+
+	return true;
+}
+
+const AnimationDataShares::Share* AnimationDataShares::Find(const std::string& type,
+                                                            uint64_t hash) const
+{
+	auto it = shares.find({type, hash});
+
+	if (it == shares.end())
+		return nullptr;
+	return &it->second;
+}
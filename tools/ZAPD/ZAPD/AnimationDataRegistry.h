@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Utils/Directory.h"
+
+/**
+ * Animation data arrays declared by the jobs of a batch, shared by all of its worker threads.
+ *
+ * Many objects carry byte-identical frame data, joint indices and curve knots: NPCs sharing their
+ * idle animations, enemies with copied-in animations. Every array is recorded with its C type and
+ * a hash of its bytes, and the ones found in more than one file are written to the report of
+ * `--anim-dedup-report` once the batch is done.
+ */
+class AnimationDataRegistry
+{
+public:
+	AnimationDataRegistry() = default;
+	AnimationDataRegistry(const AnimationDataRegistry&) = delete;
+	AnimationDataRegistry& operator=(const AnimationDataRegistry&) = delete;
+
+	void Add(const std::string& type, uint64_t hash, size_t size, const std::string& file,
+	         const std::string& symbol);
+
+	/**
+	 * Writes the arrays declared by more than one file, largest savings first. Each one is a
+	 * `type hash size count` line followed by a tab-indented `file symbol` line per declaration,
+	 * sorted so that the first one is the same whatever the order the jobs ran in.
+	 */
+	void WriteReport(const fs::path& path);
+
+protected:
+	struct Occurrence
+	{
+		std::string file;
+		std::string symbol;
+
+		bool operator<(const Occurrence& other) const
+		{
+			return std::tie(file, symbol) < std::tie(other.file, other.symbol);
+		}
+	};
+
+	struct Entry
+	{
+		size_t size = 0;
+		std::vector<Occurrence> occurrences;
+	};
+
+	std::mutex mutex;
+	std::map<std::pair<std::string, uint64_t>, Entry> entries;
+};
+
+/**
+ * The arrays of a report written by `--anim-dedup-report`, read back by `--anim-dedup-extern`.
+ * The first declaration of an array defines it under a name of its own, the others only refer to
+ * it with an `extern`.
+ */
+class AnimationDataShares
+{
+public:
+	struct Share
+	{
+		std::string symbol;           // The name of the single definition
+		std::string canonicalFile;    // The file which defines it
+		std::string canonicalSymbol;  // The name that file declared it under
+	};
+
+	bool Load(const fs::path& path);
+
+	// Returns the array shared with other files, or `nullptr` if it isn't
+	const Share* Find(const std::string& type, uint64_t hash) const;
+
+protected:
+	std::map<std::pair<std::string, uint64_t>, Share> shares;
+};
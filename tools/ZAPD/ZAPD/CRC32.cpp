@@ -0,0 +1,74 @@
+#include "CRC32.h"
+
+#include <array>
+
+using CRCTable = std::array<uint32_t, 256>;
+
+// The CRC after processing a zero byte
+static constexpr uint32_t Advance(uint32_t crc)
+{
+	for (int32_t i = 0; i < 8; i++)
+		crc = ((crc >> 1) | (crc & 0x80000000)) ^ (0xEDB88320 & -(crc & 1));
+
+	return crc;
+}
+
+static constexpr uint32_t Advance(uint32_t crc, size_t byteCount)
+{
+	for (size_t i = 0; i < byteCount; i++)
+		crc = Advance(crc);
+
+	return crc;
+}
+
+// Every step of the CRC is linear, so it can be computed for each byte of the state separately
+template <size_t ByteCount, size_t Shift>
+static constexpr CRCTable MakeTable()
+{
+	CRCTable table{};
+
+	for (uint32_t i = 0; i < 256; i++)
+		table[i] = Advance(i << Shift, ByteCount);
+
+	return table;
+}
+
+// Contribution of each byte of the state after 8 bytes
+static constexpr CRCTable STATE_BYTE_0 = MakeTable<8, 0>();
+static constexpr CRCTable STATE_BYTE_1 = MakeTable<8, 8>();
+static constexpr CRCTable STATE_BYTE_2 = MakeTable<8, 16>();
+static constexpr CRCTable STATE_BYTE_3 = MakeTable<8, 24>();
+
+// Contribution of a byte followed by N - 1 bytes
+static constexpr CRCTable BYTE_1 = MakeTable<1, 0>();
+static constexpr CRCTable BYTE_2 = MakeTable<2, 0>();
+static constexpr CRCTable BYTE_3 = MakeTable<3, 0>();
+static constexpr CRCTable BYTE_4 = MakeTable<4, 0>();
+static constexpr CRCTable BYTE_5 = MakeTable<5, 0>();
+
+uint32_t CRC32B(const uint8_t* message, size_t size)
+{
+	uint32_t crc = 0xFFFFFFFF;
+	size_t i = 0;
+
+	for (; i + 8 <= size; i += 8)
+	{
+		// Like in the usual slice-by-8, the first bytes can be merged into the state. But the
+		// fourth one would be sign extended there, so it is looked up separately
+		uint32_t state = crc ^ (message[i] | (message[i + 1] << 8) | (message[i + 2] << 16));
+
+		crc = STATE_BYTE_0[state & 0xFF] ^ STATE_BYTE_1[(state >> 8) & 0xFF] ^
+		      STATE_BYTE_2[(state >> 16) & 0xFF] ^ STATE_BYTE_3[state >> 24] ^
+		      BYTE_5[message[i + 3]] ^ BYTE_4[message[i + 4]] ^ BYTE_3[message[i + 5]] ^
+		      BYTE_2[message[i + 6]] ^ BYTE_1[message[i + 7]];
+	}
+
+	// The other bytes of the state are just shifted, the top bit being extended
+	for (; i < size; i++)
+	{
+		uint32_t shifted = (crc >> 8) | (0 - ((crc & 0x80000000) >> 8));
+		crc = shifted ^ BYTE_1[(crc ^ message[i]) & 0xFF];
+	}
+
+	return ~crc;
+}
@@ -1,23 +1,13 @@
 #pragma once
 
-static uint32_t CRC32B(const unsigned char* message, int32_t size)
-{
-	int32_t byte, crc;
-	int32_t mask;
-
-	crc = 0xFFFFFFFF;
-
-	for (int32_t i = 0; i < size; i++)
-	{
-		byte = message[i];
-		crc = crc ^ byte;
-
-		for (int32_t j = 7; j >= 0; j--)
-		{
-			mask = -(crc & 1);
-			crc = (crc >> 1) ^ (0xEDB88320 & mask);
-		}
-	}
-
-	return ~(uint32_t)(crc);
-}
\ No newline at end of file
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Hash of `size` bytes used as the key of the texture pool.
+ *
+ * It is the bitwise CRC-32 algorithm (polynomial 0xEDB88320), except that the CRC is shifted with
+ * sign extension, so it doesn't match other CRC-32 implementations. The hashes of existing texture
+ * pools depend on it. Eight bytes are processed at a time with lookup tables.
+ */
+uint32_t CRC32B(const uint8_t* message, size_t size);
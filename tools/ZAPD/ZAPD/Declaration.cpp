@@ -1,6 +1,8 @@
 #include "Declaration.h"
 
 #include "Globals.h"
+#include "OutputFormatter.h"
+#include "Profiler.h"
 #include "Utils/StringHelper.h"
 
 Declaration::Declaration(offset_t nAddress, DeclarationAlignment nAlignment, size_t nSize,
@@ -10,6 +12,8 @@ Declaration::Declaration(offset_t nAddress, DeclarationAlignment nAlignment, siz
 	alignment = nAlignment;
 	size = nSize;
 	declBody = nBody;
+
+	Profiler::Count(ProfileCounter::Declarations);
 }
 
 Declaration* Declaration::Create(offset_t declAddr, DeclarationAlignment declAlign, size_t declSize,
@@ -79,6 +83,20 @@ Declaration* Declaration::CreatePlaceholder(offset_t declAddr, const std::string
 	return decl;
 }
 
+bool Declaration::MatchesType(std::string_view expectedType) const
+{
+	static constexpr std::string_view staticPrefix = "static ";
+
+	if (expectedType == "" || expectedType == "void*" || expectedType == declType)
+		return true;
+
+	// Same as comparing to "static " + expectedType, without building that string on every lookup
+	std::string_view type = declType;
+	return type.size() == staticPrefix.size() + expectedType.size() &&
+	       type.substr(0, staticPrefix.size()) == staticPrefix &&
+	       type.substr(staticPrefix.size()) == expectedType;
+}
+
 bool Declaration::IsStatic() const
 {
 	switch (staticConf)
@@ -96,7 +114,7 @@ bool Declaration::IsStatic() const
 	return false;
 }
 
-std::string Declaration::GetNormalDeclarationStr() const
+void Declaration::WriteNormalDeclaration(OutputFormatter& formatter) const
 {
 	std::string output;
 
@@ -105,6 +123,8 @@ std::string Declaration::GetNormalDeclarationStr() const
 		output += "static ";
 	}
 
+	bool endsInNewline;
+
 	if (isArray)
 	{
 		bool includeArraySize = (IsStatic() || forceArrayCnt);
@@ -112,35 +132,36 @@ std::string Declaration::GetNormalDeclarationStr() const
 		if (includeArraySize)
 		{
 			if (arrayItemCntStr != "")
-				output += StringHelper::Sprintf("%s %s[%s];\n", declType.c_str(), declName.c_str(),
-				                                arrayItemCntStr.c_str());
+				StringHelper::AppendSprintf(output, "%s %s[%s];\n", declType.c_str(),
+				                            declName.c_str(), arrayItemCntStr.c_str());
 			else
-				output += StringHelper::Sprintf("%s %s[%i] = {\n", declType.c_str(),
-				                                declName.c_str(), arrayItemCnt);
+				StringHelper::AppendSprintf(output, "%s %s[%i] = {\n", declType.c_str(),
+				                            declName.c_str(), arrayItemCnt);
 		}
 		else
 		{
-			output += StringHelper::Sprintf("%s %s[] = {\n", declType.c_str(), declName.c_str());
+			StringHelper::AppendSprintf(output, "%s %s[] = {\n", declType.c_str(),
+			                            declName.c_str());
 		}
 
-		output += declBody + "\n";
+		formatter.Write(output);
+		formatter.Write(declBody);
+		formatter.Write("\n");
+		endsInNewline = true;
 	}
 	else
 	{
-		output += StringHelper::Sprintf("%s %s = { ", declType.c_str(), declName.c_str());
-		output += declBody;
+		StringHelper::AppendSprintf(output, "%s %s = { ", declType.c_str(), declName.c_str());
+
+		formatter.Write(output);
+		formatter.Write(declBody);
+		endsInNewline = declBody != "" && declBody.back() == '\n';
 	}
 
-	if (output.back() == '\n')
-		output += "};";
+	if (endsInNewline)
+		formatter.Write("};\n\n");
 	else
-		output += " };";
-
-	output += "\n";
-
-	output += "\n";
-
-	return output;
+		formatter.Write(" };\n\n");
 }
 
 std::string Declaration::GetExternalDeclarationStr() const
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 // TODO: should we drop the `_t` suffix because of UNIX compliance?
@@ -10,6 +11,8 @@ typedef uint32_t offset_t;
 
 #define SEGMENTED_NULL ((segptr_t)0)
 
+class OutputFormatter;
+
 enum class DeclarationAlignment
 {
 	Align4,
@@ -80,6 +83,10 @@ public:
 	// Is this declaration a placeholder that will be replaced later?
 	bool isPlaceholder = false;
 
+	// Is this declaration defined by another file? Only an `extern` is written for it, see
+	// `--anim-dedup-extern`
+	bool isExternReference = false;
+
 	// Does this declaration come straight from the XML?
 	// If false, this means that the declaration was created by ZAPD when it was parsing the
 	// resources.
@@ -160,9 +167,13 @@ public:
 
 	bool IsStatic() const;
 
-	// Returns the declaration as C code as it would be in the code file when the body contains the
-	// needed data
-	std::string GetNormalDeclarationStr() const;
+	// Whether a pointer of type `expectedType` can point to this declaration. An empty type or
+	// `void*` matches anything, and a type also matches its static variant
+	bool MatchesType(std::string_view expectedType) const;
+
+	// Writes the declaration as C code as it would be in the code file when the body contains the
+	// needed data. The body is written straight to the formatter, it can be very long
+	void WriteNormalDeclaration(OutputFormatter& formatter) const;
 
 	// Returns the declaration as C code as it would be in the code file when the body #include's
 	// another file
@@ -0,0 +1,8 @@
+// The entry point of ZAPD.out. Everything else is also built into libzapd, see LibZapd.h
+
+int RunCommandLine(int argc, char* argv[]);
+
+int main(int argc, char* argv[])
+{
+	return RunCommandLine(argc, argv);
+}
@@ -0,0 +1,373 @@
+#include "ExternalIndex.h"
+
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "Globals.h"
+#include "ZFile.h"
+#include "ZSymbol.h"
+#include "tinyxml2.h"
+
+bool ParseExternal(const fs::path& xmlFilePath, const fs::path& basePath, const fs::path& outPath);
+
+static constexpr char INDEX_MAGIC[4] = {'Z', 'I', 'D', 'X'};
+static constexpr uint32_t INDEX_VERSION = 1;
+
+// Kinds of the records of an index, in the order of the XML elements
+enum class IndexRecord : uint32_t
+{
+	End,
+	File,
+	ExternalFile,
+};
+
+// Flags of an indexed declaration
+static constexpr uint32_t DECL_IS_EXTERNAL = 1 << 0;
+static constexpr uint32_t DECL_IS_ARRAY = 1 << 1;
+static constexpr uint32_t DECL_FORCE_ARRAY_CNT = 1 << 2;
+static constexpr uint32_t DECL_IS_UNACCOUNTED = 1 << 3;
+static constexpr uint32_t DECL_IS_PLACEHOLDER = 1 << 4;
+static constexpr uint32_t DECL_DECLARED_IN_XML = 1 << 5;
+
+/**
+ * The index is only ever read by the build that wrote it (the build hash is part of its key), so
+ * values are stored in the byte order of the host.
+ */
+class IndexWriter
+{
+public:
+	std::string data;
+
+	void WriteU32(uint32_t value) { data.append(reinterpret_cast<const char*>(&value), 4); }
+
+	void WriteString(const std::string& str)
+	{
+		WriteU32(str.size());
+		data += str;
+	}
+};
+
+class IndexReader
+{
+public:
+	// Set once a read went past the end of the index
+	bool failed = false;
+
+	IndexReader(const DataView& nView) : view(nView) {}
+
+	uint32_t ReadU32()
+	{
+		uint32_t value = 0;
+		if (!Advance(4))
+			return value;
+
+		memcpy(&value, view.data() + pos - 4, 4);
+		return value;
+	}
+
+	std::string ReadString()
+	{
+		uint32_t size = ReadU32();
+		if (!Advance(size))
+			return "";
+
+		return std::string(reinterpret_cast<const char*>(view.data()) + pos - size, size);
+	}
+
+protected:
+	DataView view;
+	size_t pos = 0;
+
+	bool Advance(size_t size)
+	{
+		if (failed || size > view.size() - pos)
+		{
+			failed = true;
+			return false;
+		}
+
+		pos += size;
+		return true;
+	}
+};
+
+// A record of the index, decoded but not registered in the job yet
+struct IndexedItem
+{
+	ZFile* file = nullptr;
+	bool changesGame = false;
+	ZGame game = ZGame::OOT_RETAIL;
+
+	fs::path externalXmlPath;
+	fs::path externalOutPath;
+};
+
+bool ExternalIndex::Load(const ExtractionCache& cache, const fs::path& xmlPath,
+                         const fs::path& basePath, const fs::path& outPath)
+{
+	std::shared_ptr<MappedFile> indexFile = cache.OpenExternalIndex();
+	if (indexFile == nullptr)
+		return false;
+
+	IndexReader reader(indexFile->GetView());
+	uint32_t magic;
+	memcpy(&magic, INDEX_MAGIC, sizeof(magic));
+	if (reader.ReadU32() != magic || reader.ReadU32() != INDEX_VERSION)
+		return false;
+
+	// Everything is decoded before registering anything, so a broken index can still fall back to
+	// parsing the XML
+	std::vector<IndexedItem> items;
+	bool valid = true;
+
+	while (valid && !reader.failed)
+	{
+		IndexRecord record = static_cast<IndexRecord>(reader.ReadU32());
+		if (record == IndexRecord::End)
+			break;
+
+		IndexedItem& item = items.emplace_back();
+
+		if (record == IndexRecord::ExternalFile)
+		{
+			item.externalXmlPath = reader.ReadString();
+			item.externalOutPath = reader.ReadString();
+			continue;
+		}
+
+		if (record != IndexRecord::File)
+		{
+			valid = false;
+			break;
+		}
+
+		ZFile* file = new ZFile();
+		item.file = file;
+
+		file->mode = ZFileMode::ExternalFile;
+		file->xmlFilePath = xmlPath;
+		file->basePath = basePath;
+		if (basePath == "")
+			file->basePath = Directory::GetCurrentDirectory();
+		file->outputPath = outPath;
+		if (outPath == "")
+			file->outputPath = Directory::GetCurrentDirectory();
+		file->name = reader.ReadString();
+		file->outName = reader.ReadString();
+		file->segment = reader.ReadU32();
+		file->baseAddress = reader.ReadU32();
+		file->rangeStart = reader.ReadU32();
+		file->rangeEnd = reader.ReadU32();
+		file->makeDefines = reader.ReadU32() != 0;
+		file->defines = reader.ReadString();
+		size_t rawDataSize = reader.ReadU32();
+		item.changesGame = reader.ReadU32() != 0;
+		item.game = static_cast<ZGame>(reader.ReadU32());
+
+		size_t declarationCount = reader.ReadU32();
+		for (size_t i = 0; i < declarationCount && !reader.failed; i++)
+		{
+			offset_t address = reader.ReadU32();
+			DeclarationAlignment alignment = static_cast<DeclarationAlignment>(reader.ReadU32());
+			size_t size = reader.ReadU32();
+			uint32_t flags = reader.ReadU32();
+			std::string declType = reader.ReadString();
+			std::string declName = reader.ReadString();
+			std::string declBody = reader.ReadString();
+
+			Declaration* decl =
+				Declaration::Create(address, alignment, size, declType, declName, declBody);
+			decl->isExternal = (flags & DECL_IS_EXTERNAL) != 0;
+			decl->isArray = (flags & DECL_IS_ARRAY) != 0;
+			decl->forceArrayCnt = (flags & DECL_FORCE_ARRAY_CNT) != 0;
+			decl->isUnaccounted = (flags & DECL_IS_UNACCOUNTED) != 0;
+			decl->isPlaceholder = (flags & DECL_IS_PLACEHOLDER) != 0;
+			decl->declaredInXml = (flags & DECL_DECLARED_IN_XML) != 0;
+			decl->staticConf = static_cast<StaticConfig>(reader.ReadU32());
+			decl->arrayItemCnt = reader.ReadU32();
+			decl->arrayItemCntStr = reader.ReadString();
+			decl->defines = reader.ReadString();
+			decl->includePath = reader.ReadString();
+
+			size_t referenceCount = reader.ReadU32();
+			for (size_t j = 0; j < referenceCount && !reader.failed; j++)
+				decl->references.push_back(reader.ReadU32());
+
+			file->declarations[address] = decl;
+		}
+
+		size_t symbolCount = reader.ReadU32();
+		for (size_t i = 0; i < symbolCount && !reader.failed; i++)
+		{
+			ZSymbol* sym = new ZSymbol(file);
+			sym->rawDataIndex = reader.ReadU32();
+			sym->name = reader.ReadString();
+			sym->outName = reader.ReadString();
+			sym->type = reader.ReadString();
+			sym->typeSize = reader.ReadU32();
+			sym->isArray = reader.ReadU32() != 0;
+			sym->count = reader.ReadU32();
+			sym->declaredInXml = true;
+			sym->staticConf = StaticConfig::Off;
+
+			file->AddSymbolResource(sym->rawDataIndex, sym);
+		}
+
+		// The contents of the binary file don't matter to an external file, but its size does
+		file->mappedFile = MappedFile::Open((file->basePath / file->name).string());
+		if (file->mappedFile == nullptr || file->mappedFile->GetView().size() != rawDataSize)
+			valid = false;
+		else
+			file->rawData = file->mappedFile->GetView();
+	}
+
+	if (!valid || reader.failed)
+	{
+		for (IndexedItem& item : items)
+			delete item.file;
+
+		return false;
+	}
+
+	// Register everything in the same order parsing the XML would have
+	for (IndexedItem& item : items)
+	{
+		if (item.file == nullptr)
+		{
+			if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
+				printf("Parsing external file: '%s'\n", item.externalXmlPath.c_str());
+
+			ParseExternal(item.externalXmlPath, basePath, item.externalOutPath);
+			continue;
+		}
+
+		if (item.changesGame)
+			Globals::Job->game = item.game;
+
+		Globals::Job->AddSegment(item.file->segment, item.file);
+		Globals::Job->AddFile(item.file);
+		Globals::Job->externalFiles.push_back(item.file);
+		item.file->isExternalFile = true;
+	}
+
+	return true;
+}
+
+void ExternalIndex::WriteFile(IndexWriter& writer, ZFile* file, tinyxml2::XMLElement* element)
+{
+	writer.WriteU32(static_cast<uint32_t>(IndexRecord::File));
+	writer.WriteString(file->GetName());
+	writer.WriteString(file->GetOutName());
+	writer.WriteU32(file->segment);
+	writer.WriteU32(file->baseAddress);
+	writer.WriteU32(file->rangeStart);
+	writer.WriteU32(file->rangeEnd);
+	writer.WriteU32(file->makeDefines);
+	writer.WriteString(file->defines);
+	writer.WriteU32(file->GetRawData().size());
+
+	ZGame game = ZGame::OOT_RETAIL;
+	const char* gameStr = element->Attribute("Game");
+	bool changesGame = gameStr != nullptr && ZFile::GetGameByName(gameStr, game);
+	writer.WriteU32(changesGame);
+	writer.WriteU32(static_cast<uint32_t>(game));
+
+	writer.WriteU32(file->declarations.size());
+	for (const auto& declPair : file->declarations)
+	{
+		const Declaration* decl = declPair.second;
+		uint32_t flags = (decl->isExternal ? DECL_IS_EXTERNAL : 0) |
+		                 (decl->isArray ? DECL_IS_ARRAY : 0) |
+		                 (decl->forceArrayCnt ? DECL_FORCE_ARRAY_CNT : 0) |
+		                 (decl->isUnaccounted ? DECL_IS_UNACCOUNTED : 0) |
+		                 (decl->isPlaceholder ? DECL_IS_PLACEHOLDER : 0) |
+		                 (decl->declaredInXml ? DECL_DECLARED_IN_XML : 0);
+
+		writer.WriteU32(declPair.first);
+		writer.WriteU32(static_cast<uint32_t>(decl->alignment));
+		writer.WriteU32(decl->size);
+		writer.WriteU32(flags);
+		writer.WriteString(decl->declType);
+		writer.WriteString(decl->declName);
+		writer.WriteString(decl->declBody);
+		writer.WriteU32(static_cast<uint32_t>(decl->staticConf));
+		writer.WriteU32(decl->arrayItemCnt);
+		writer.WriteString(decl->arrayItemCntStr);
+		writer.WriteString(decl->defines);
+		writer.WriteString(decl->includePath);
+
+		writer.WriteU32(decl->references.size());
+		for (segptr_t reference : decl->references)
+			writer.WriteU32(reference);
+	}
+
+	writer.WriteU32(file->symbolResources.size());
+	for (const auto& symPair : file->symbolResources)
+	{
+		const ZSymbol* sym = symPair.second;
+
+		writer.WriteU32(symPair.first);
+		writer.WriteString(sym->GetName());
+		writer.WriteString(sym->GetOutName());
+		writer.WriteString(sym->type);
+		writer.WriteU32(sym->typeSize);
+		writer.WriteU32(sym->isArray);
+		writer.WriteU32(sym->count);
+	}
+}
+
+void ExternalIndex::Store(const ExtractionCache& cache, const fs::path& xmlPath, size_t firstFile)
+{
+	// The job files after `firstFile` also include those of the external XMLs this one refers to
+	std::vector<ZFile*> ownFiles;
+	for (size_t i = firstFile; i < Globals::Job->files.size(); i++)
+	{
+		if (Globals::Job->files[i]->GetXmlFilePath() == xmlPath)
+			ownFiles.push_back(Globals::Job->files[i]);
+	}
+
+	// The index has to hold every declaration, not only those looked up so far
+	for (ZFile* file : ownFiles)
+		file->MaterializeResources();
+
+	tinyxml2::XMLDocument doc;
+	if (doc.LoadFile(xmlPath.string().c_str()) != tinyxml2::XML_SUCCESS)
+		return;
+
+	tinyxml2::XMLNode* root = doc.FirstChild();
+	if (root == nullptr)
+		return;
+
+	IndexWriter writer;
+	writer.data.append(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	writer.WriteU32(INDEX_VERSION);
+
+	size_t fileIndex = 0;
+	for (tinyxml2::XMLElement* child = root->FirstChildElement(); child != nullptr;
+	     child = child->NextSiblingElement())
+	{
+		std::string_view childName = child->Name();
+
+		if (childName == "File")
+		{
+			if (fileIndex >= ownFiles.size())
+				return;
+
+			WriteFile(writer, ownFiles[fileIndex++], child);
+		}
+		else if (childName == "ExternalFile")
+		{
+			writer.WriteU32(static_cast<uint32_t>(IndexRecord::ExternalFile));
+			writer.WriteString(
+				(Globals::Instance->cfg.externalXmlFolder / child->Attribute("XmlPath")).string());
+			writer.WriteString(child->Attribute("OutPath"));
+		}
+	}
+
+	if (fileIndex != ownFiles.size())
+		return;
+
+	writer.WriteU32(static_cast<uint32_t>(IndexRecord::End));
+	cache.StoreExternalIndex(writer.data);
+}
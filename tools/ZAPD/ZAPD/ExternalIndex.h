@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+#include "ExtractionCache.h"
+#include "Utils/Directory.h"
+#include "tinyxml2.h"
+
+class IndexWriter;
+
+/**
+ * What the files of an external XML expose to other files, stored in the extraction cache: the
+ * range and segment of each file, its declarations and symbols, and the external XMLs it includes
+ * itself. Every job referencing gameplay_keep or the like otherwise parses its whole XML again
+ * just to look names up in it; registering the files from the index is much cheaper.
+ *
+ * Other resources aren't part of the index, so an ExternalTlut can't refer to a file loaded from
+ * it. Warnings of the external XML are only shown when it's actually parsed.
+ */
+class ExternalIndex
+{
+public:
+	// Registers the files of the external XML from its index, including the external XMLs it
+	// refers to. Returns false if there's no usable index, in which case nothing was registered
+	static bool Load(const ExtractionCache& cache, const fs::path& xmlPath,
+	                 const fs::path& basePath, const fs::path& outPath);
+
+	// Indexes the external XML that was just parsed, whose files start at `firstFile` in the job
+	static void Store(const ExtractionCache& cache, const fs::path& xmlPath, size_t firstFile);
+
+protected:
+	static void WriteFile(IndexWriter& writer, ZFile* file, tinyxml2::XMLElement* element);
+};
@@ -0,0 +1,327 @@
+#include "ExtractionCache.h"
+
+#include <fstream>
+#include <functional>
+#include <string_view>
+#include <thread>
+
+#include "Globals.h"
+#include "Utils/File.h"
+#include "Utils/MappedFile.h"
+#include "Utils/StringHelper.h"
+#include "tinyxml2.h"
+
+extern const char gBuildHash[];
+
+// 64-bit FNV-1a
+static constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325;
+static constexpr uint64_t FNV_PRIME = 0x100000001B3;
+
+static uint64_t HashBytes(uint64_t hash, const uint8_t* data, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= data[i];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static std::string HashToString(uint64_t hash)
+{
+	return StringHelper::Sprintf("%016llX", static_cast<unsigned long long>(hash));
+}
+
+// Writes a file through a temporary, so other threads or processes never read it half written
+static void WriteFileAtomically(const fs::path& path, const std::string& data)
+{
+	size_t threadId = std::hash<std::thread::id>()(std::this_thread::get_id());
+	fs::path tempPath = path.string() + StringHelper::Sprintf(".%zX.tmp", threadId);
+
+	File::WriteAllBytes(tempPath.string(), data.c_str(), data.size());
+	fs::rename(tempPath, path);
+}
+
+ExtractionCache::~ExtractionCache()
+{
+	if (File::writeLog == &writtenFiles)
+		File::writeLog = nullptr;
+}
+
+bool ExtractionCache::ComputeKey(ZFileMode fileMode)
+{
+	if (Globals::Instance->cacheDir.empty())
+		return false;
+
+	JobContext* job = Globals::Job;
+	hash = FNV_OFFSET_BASIS;
+	visitedXmls.clear();
+
+	HashString(gBuildHash);
+	HashString(Directory::GetCurrentDirectory());
+	HashInt(static_cast<int64_t>(fileMode));
+
+	HashString(job->inputPath.string());
+	HashString(job->outputPath.string());
+	HashString(job->sourceOutputPath.string());
+	HashInt(job->baseAddress);
+	HashInt(job->startOffset);
+	HashInt(job->endOffset);
+	HashInt(job->genSourceFile);
+	HashInt(static_cast<int64_t>(job->game));
+
+	HashSettings();
+
+	const GameConfig& cfg = Globals::Instance->cfg;
+	for (const ExternalFile& extFile : cfg.externalFiles)
+		HashXml(cfg.externalXmlFolder / extFile.xmlPath, Globals::Instance->baseRomPath);
+	HashXml(job->inputPath, Globals::Instance->baseRomPath);
+
+	key = HashToString(hash);
+	return true;
+}
+
+bool ExtractionCache::ComputeExternalKey(const fs::path& xmlPath, const fs::path& basePath,
+                                         const fs::path& outPath)
+{
+	if (Globals::Instance->cacheDir.empty())
+		return false;
+
+	hash = FNV_OFFSET_BASIS;
+	visitedXmls.clear();
+
+	HashString(gBuildHash);
+	HashString(Directory::GetCurrentDirectory());
+	HashString(basePath.string());
+	HashString(outPath.string());
+	// The XML may rely on the game set by the files parsed before it
+	HashInt(static_cast<int64_t>(Globals::Job->game));
+
+	HashSettings();
+
+	// Only the sizes of the binary files matter to an external XML, those are checked by the index
+	// itself. Each external XML it refers to has an index and a key of its own
+	HashFile(xmlPath);
+
+	key = HashToString(hash);
+	return true;
+}
+
+std::shared_ptr<MappedFile> ExtractionCache::OpenExternalIndex() const
+{
+	return MappedFile::Open(GetExternalIndexPath().string());
+}
+
+void ExtractionCache::StoreExternalIndex(const std::string& data) const
+{
+	fs::path indexPath = GetExternalIndexPath();
+	if (!Directory::Exists(indexPath.parent_path()))
+		Directory::CreateDirectory(indexPath.parent_path().string());
+
+	// External files are parsed while the outputs of the job are being recorded
+	std::vector<fs::path>* writeLog = File::writeLog;
+	File::writeLog = nullptr;
+	WriteFileAtomically(indexPath, data);
+	File::writeLog = writeLog;
+}
+
+bool ExtractionCache::Restore()
+{
+	std::ifstream manifest(GetManifestPath().string());
+	if (!manifest.is_open())
+		return false;
+
+	// Each line is the hash of the content, a space and the path the content was written to
+	std::vector<std::pair<std::string, fs::path>> entries;
+	std::string line;
+	while (std::getline(manifest, line))
+	{
+		if (line.size() < 18 || line[16] != ' ')
+			return false;
+
+		entries.emplace_back(line.substr(0, 16), line.substr(17));
+	}
+
+	std::vector<std::shared_ptr<MappedFile>> objects;
+	for (const auto& entry : entries)
+	{
+		std::shared_ptr<MappedFile> object = MappedFile::Open(GetObjectPath(entry.first).string());
+		if (object == nullptr)
+			return false;
+
+		objects.push_back(object);
+	}
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const fs::path& outPath = entries[i].second;
+		DataView content = objects[i]->GetView();
+
+		if (outPath.has_parent_path() && !Directory::Exists(outPath.parent_path()))
+			Directory::CreateDirectory(outPath.parent_path().string());
+
+		File::WriteAllBytes(outPath.string(), reinterpret_cast<const char*>(content.data()),
+		                    content.size());
+	}
+
+	if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
+		printf("Restored '%s' from the extraction cache.\n", Globals::Job->inputPath.c_str());
+
+	return true;
+}
+
+void ExtractionCache::BeginRecording()
+{
+	writtenFiles.clear();
+	File::writeLog = &writtenFiles;
+}
+
+void ExtractionCache::Store()
+{
+	File::writeLog = nullptr;
+
+	fs::path objectsDir = Globals::Instance->cacheDir / "objects";
+	fs::path manifestsDir = Globals::Instance->cacheDir / "manifests";
+	if (!Directory::Exists(objectsDir))
+		Directory::CreateDirectory(objectsDir.string());
+	if (!Directory::Exists(manifestsDir))
+		Directory::CreateDirectory(manifestsDir.string());
+
+	// A file may have been written more than once, only its final content matters
+	std::unordered_set<std::string> storedPaths;
+	std::string manifest;
+
+	for (const fs::path& outPath : writtenFiles)
+	{
+		if (!storedPaths.insert(outPath.string()).second)
+			continue;
+
+		std::shared_ptr<MappedFile> outFile = MappedFile::Open(outPath.string());
+		if (outFile == nullptr)
+			return;
+
+		DataView content = outFile->GetView();
+		std::string contentHash =
+			HashToString(HashBytes(FNV_OFFSET_BASIS, content.data(), content.size()));
+
+		fs::path objectPath = GetObjectPath(contentHash);
+		if (!File::Exists(objectPath))
+			WriteFileAtomically(objectPath, std::string(content.begin(), content.end()));
+
+		manifest += contentHash + " " + outPath.string() + "\n";
+	}
+
+	WriteFileAtomically(GetManifestPath(), manifest);
+}
+
+void ExtractionCache::HashSettings()
+{
+	HashString(Globals::Instance->baseRomPath.string());
+	HashInt(Globals::Instance->useExternalResources);
+	HashInt(Globals::Instance->testMode);
+	HashInt(Globals::Instance->outputCrc);
+	HashInt(Globals::Instance->useLegacyZDList);
+	HashInt(static_cast<int64_t>(Globals::Instance->texType));
+	HashInt(static_cast<int64_t>(Globals::Instance->floatType));
+	HashInt(Globals::Instance->verboseUnaccounted);
+	HashInt(Globals::Instance->gccCompat);
+	HashInt(Globals::Instance->forceStatic);
+	HashInt(Globals::Instance->forceUnaccountedStatic);
+	HashInt(Globals::Instance->fastPng);
+	HashInt(Globals::Instance->dlBounds);
+	if (!Globals::Instance->animDedupExternPath.empty())
+		HashFile(Globals::Instance->animDedupExternPath);
+
+	const GameConfig& cfg = Globals::Instance->cfg;
+	HashFile(cfg.configFilePath);
+	for (const fs::path& inputFile : cfg.inputFiles)
+		HashFile(inputFile);
+}
+
+void ExtractionCache::HashData(const void* data, size_t size)
+{
+	hash = HashBytes(hash, static_cast<const uint8_t*>(data), size);
+}
+
+void ExtractionCache::HashString(const std::string& str)
+{
+	HashInt(str.size());
+	HashData(str.data(), str.size());
+}
+
+void ExtractionCache::HashInt(int64_t value)
+{
+	HashData(&value, sizeof(value));
+}
+
+void ExtractionCache::HashFile(const fs::path& path)
+{
+	HashString(path.string());
+
+	std::shared_ptr<MappedFile> file = MappedFile::Open(path.string());
+	if (file == nullptr)
+	{
+		// Missing files are part of the key too, so adding them later invalidates the entry
+		HashInt(-1);
+		return;
+	}
+
+	DataView content = file->GetView();
+	HashInt(content.size());
+	HashData(content.data(), content.size());
+}
+
+void ExtractionCache::HashXml(const fs::path& xmlPath, const fs::path& basePath)
+{
+	// XMLs referenced more than once only add their path again
+	if (!visitedXmls.insert(xmlPath.string()).second)
+	{
+		HashString(xmlPath.string());
+		return;
+	}
+
+	HashFile(xmlPath);
+
+	tinyxml2::XMLDocument doc;
+	if (doc.LoadFile(xmlPath.string().c_str()) != tinyxml2::XML_SUCCESS)
+		return;
+
+	tinyxml2::XMLNode* root = doc.FirstChild();
+	if (root == nullptr)
+		return;
+
+	for (tinyxml2::XMLElement* child = root->FirstChildElement(); child != nullptr;
+	     child = child->NextSiblingElement())
+	{
+		std::string_view childName = child->Name();
+
+		if (childName == "File")
+		{
+			const char* fileName = child->Attribute("Name");
+			if (fileName != nullptr)
+				HashFile(basePath / fileName);
+		}
+		else if (childName == "ExternalFile")
+		{
+			const char* externalXmlPath = child->Attribute("XmlPath");
+			if (externalXmlPath != nullptr)
+				HashXml(Globals::Instance->cfg.externalXmlFolder / externalXmlPath, basePath);
+		}
+	}
+}
+
+fs::path ExtractionCache::GetManifestPath() const
+{
+	return Globals::Instance->cacheDir / "manifests" / (key + ".txt");
+}
+
+fs::path ExtractionCache::GetObjectPath(const std::string& contentHash) const
+{
+	return Globals::Instance->cacheDir / "objects" / contentHash;
+}
+
+fs::path ExtractionCache::GetExternalIndexPath() const
+{
+	return Globals::Instance->cacheDir / "externals" / (key + ".zidx");
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "Utils/Directory.h"
+#include "Utils/MappedFile.h"
+#include "ZFile.h"
+
+/**
+ * Content-addressed cache of extraction outputs, enabled with `--cache-dir`.
+ *
+ * The key of a job hashes everything its output depends on: the ZAPD build, the settings of the
+ * job, the input XML, the config and the files it references, every external XML and the baserom
+ * files all of those XMLs point to. A manifest stored under that key lists every file the job
+ * wrote, and the contents of those files are kept in the same directory, named by their own hash.
+ * When the manifest of a job exists, its outputs are copied back instead of extracting.
+ *
+ * The cache also keeps the index of every external XML parsed, see ExternalIndex.
+ */
+class ExtractionCache
+{
+public:
+	ExtractionCache() = default;
+	ExtractionCache(const ExtractionCache&) = delete;
+	ExtractionCache& operator=(const ExtractionCache&) = delete;
+	~ExtractionCache();
+
+	// Computes the key of the current job. Returns false if caching is disabled
+	bool ComputeKey(ZFileMode fileMode);
+
+	// Writes back every output of the current job. Returns false if the job isn't cached
+	bool Restore();
+
+	// Starts logging every file the current thread writes, until Store or destruction
+	void BeginRecording();
+
+	// Stores the recorded outputs of the successful job
+	void Store();
+
+	// Computes the key of an external XML parsed by the current job. Returns false if caching is
+	// disabled
+	bool ComputeExternalKey(const fs::path& xmlPath, const fs::path& basePath,
+	                        const fs::path& outPath);
+
+	// Returns nullptr if the external XML isn't indexed
+	std::shared_ptr<MappedFile> OpenExternalIndex() const;
+	void StoreExternalIndex(const std::string& data) const;
+
+protected:
+	uint64_t hash = 0;
+	std::string key;
+	std::vector<fs::path> writtenFiles;
+	std::unordered_set<std::string> visitedXmls;
+
+	void HashSettings();
+	void HashData(const void* data, size_t size);
+	void HashString(const std::string& str);
+	void HashInt(int64_t value);
+	void HashFile(const fs::path& path);
+	void HashXml(const fs::path& xmlPath, const fs::path& basePath);
+
+	fs::path GetManifestPath() const;
+	fs::path GetObjectPath(const std::string& contentHash) const;
+	fs::path GetExternalIndexPath() const;
+};
@@ -1,5 +1,6 @@
 #include "GameConfig.h"
 
+#include <algorithm>
 #include <functional>
 #include <string_view>
 #include <unordered_map>
@@ -12,15 +13,35 @@
 
 using ConfigFunc = void (GameConfig::*)(const tinyxml2::XMLElement&);
 
-GameConfig::~GameConfig()
+void SymbolMap::Add(uint32_t address, const std::string& name)
 {
-	for (auto& declPair : segmentRefFiles)
+	symbols.emplace_back(address, name);
+}
+
+void SymbolMap::Sort()
+{
+	// Stable, so the last symbol given for an address wins like it did with a map
+	std::stable_sort(symbols.begin(), symbols.end(),
+	                 [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	std::vector<std::pair<uint32_t, std::string>> uniqueSymbols;
+	for (size_t i = 0; i < symbols.size(); i++)
 	{
-		for (auto& file : declPair.second)
-		{
-			delete file;
-		}
+		if (i + 1 == symbols.size() || symbols[i + 1].first != symbols[i].first)
+			uniqueSymbols.push_back(std::move(symbols[i]));
 	}
+	symbols = std::move(uniqueSymbols);
+}
+
+const std::string* SymbolMap::Find(uint32_t address) const
+{
+	auto it =
+		std::lower_bound(symbols.begin(), symbols.end(), address,
+	                     [](const auto& symbol, uint32_t addr) { return symbol.first < addr; });
+	if (it == symbols.end() || it->first != address)
+		return nullptr;
+
+	return &it->second;
 }
 
 void GameConfig::ReadTexturePool(const fs::path& texturePoolXmlPath)
@@ -63,10 +84,10 @@ void GameConfig::GenSymbolMap(const fs::path& symbolMapPath)
 	{
 		auto split = StringHelper::Split(symbolLine, " ");
 		uint32_t addr = strtoul(split[0].c_str(), nullptr, 16);
-		std::string symbolName = split[1];
-
-		symbolMap[addr] = std::move(symbolName);
+		symbolMap.Add(addr, split[1]);
 	}
+
+	symbolMap.Sort();
 }
 
 void GameConfig::ConfigFunc_SymbolMap(const tinyxml2::XMLElement& element)
@@ -296,6 +317,10 @@ void GameConfig::ReadConfigFile(const fs::path& argConfigFilePath)
 			continue;
 		}
 
+		const char* fileName = child->Attribute("File");
+		if (fileName != nullptr)
+			inputFiles.push_back(Path::GetDirectoryName(configFilePath) / fileName);
+
 		std::invoke(it->second, *this, *child);
 	}
 }
@@ -21,6 +21,24 @@ public:
 	ExternalFile(fs::path nXmlPath, fs::path nOutPath);
 };
 
+/**
+ * Names of fixed addresses, read from the SymbolMap file of the config. Kept as a vector sorted by
+ * address, since it's looked up far more often than it's built.
+ */
+class SymbolMap
+{
+public:
+	void Add(uint32_t address, const std::string& name);
+	// Must be called once every symbol has been added, before any lookup
+	void Sort();
+
+	// Returns nullptr if there's no symbol at `address`
+	const std::string* Find(uint32_t address) const;
+
+protected:
+	std::vector<std::pair<uint32_t, std::string>> symbols;
+};
+
 // Stores data from the XML file, the integer is the index (via ATOI) and the string is the value
 class EnumData
 {
@@ -52,14 +70,12 @@ public:
 	std::map<uint16_t, std::string> relTo;
 };
 
-class ZFile;
-
 class GameConfig
 {
 public:
 	std::string configFilePath;
-	std::map<int32_t, std::vector<ZFile*>> segmentRefFiles;
-	std::map<uint32_t, std::string> symbolMap;
+	std::vector<fs::path> inputFiles;  // Every file referenced by the config, besides itself
+	SymbolMap symbolMap;
 	std::vector<std::string> actorList;
 	std::vector<std::string> objectList;
 	std::vector<std::string> entranceList;
@@ -77,7 +93,6 @@ public:
 	std::vector<ExternalFile> externalFiles;
 
 	GameConfig() = default;
-	~GameConfig();
 
 	void ReadTexturePool(const fs::path& texturePoolXmlPath);
 	void GenSymbolMap(const fs::path& symbolMapPath);
@@ -9,19 +9,18 @@
 #include "tinyxml2.h"
 
 Globals* Globals::Instance;
+thread_local JobContext* Globals::Job;
 
 Globals::Globals()
 {
 	Instance = this;
+	Job = &mainJob;
 
-	game = ZGame::OOT_RETAIL;
-	genSourceFile = true;
 	testMode = false;
 	profile = false;
 	useLegacyZDList = false;
 	useExternalResources = true;
 	verbosity = VerbosityLevel::VERBOSITY_SILENT;
-	outputPath = Directory::GetCurrentDirectory();
 }
 
 Globals::~Globals()
@@ -34,21 +33,59 @@ Globals::~Globals()
 	}
 }
 
-void Globals::AddSegment(int32_t segment, ZFile* file)
+JobContext::JobContext()
+{
+	outputPath = Directory::GetCurrentDirectory();
+}
+
+JobContext::~JobContext()
+{
+	for (ZFile* file : files)
+		delete file;
+}
+
+void JobContext::InheritSettings(const JobContext& other)
+{
+	genSourceFile = other.genSourceFile;
+	inputPath = other.inputPath;
+	outputPath = other.outputPath;
+	sourceOutputPath = other.sourceOutputPath;
+	baseAddress = other.baseAddress;
+	startOffset = other.startOffset;
+	endOffset = other.endOffset;
+	game = other.game;
+}
+
+void JobContext::AddSegment(int32_t segment, ZFile* file)
 {
 	if (std::find(segments.begin(), segments.end(), segment) == segments.end())
 		segments.push_back(segment);
-	if (cfg.segmentRefFiles.find(segment) == cfg.segmentRefFiles.end())
-		cfg.segmentRefFiles[segment] = std::vector<ZFile*>();
+	if (segmentRefFiles.find(segment) == segmentRefFiles.end())
+		segmentRefFiles[segment] = std::vector<ZFile*>();
 
-	cfg.segmentRefFiles[segment].push_back(file);
+	segmentRefFiles[segment].push_back(file);
 }
 
-bool Globals::HasSegment(int32_t segment)
+bool JobContext::HasSegment(int32_t segment)
 {
 	return std::find(segments.begin(), segments.end(), segment) != segments.end();
 }
 
+void JobContext::AddFile(ZFile* file)
+{
+	files.push_back(file);
+	filesByName.emplace(file->GetName(), file);
+}
+
+ZFile* JobContext::GetFileByName(const std::string& name) const
+{
+	auto file = filesByName.find(name);
+	if (file == filesByName.end())
+		return nullptr;
+
+	return file->second;
+}
+
 std::map<std::string, ExporterSet*>& Globals::GetExporterMap()
 {
 	static std::map<std::string, ExporterSet*> exporters;
@@ -82,9 +119,9 @@ ExporterSet* Globals::GetExporterSet()
 		return nullptr;
 }
 
-bool Globals::GetSegmentedPtrName(segptr_t segAddress, ZFile* currentFile,
-                                  const std::string& expectedType, std::string& declName,
-                                  bool warnIfNotFound)
+bool JobContext::GetSegmentedPtrName(segptr_t segAddress, ZFile* currentFile,
+                                     const std::string& expectedType, std::string& declName,
+                                     bool warnIfNotFound)
 {
 	if (segAddress == SEGMENTED_NULL)
 	{
@@ -122,7 +159,7 @@ bool Globals::GetSegmentedPtrName(segptr_t segAddress, ZFile* currentFile,
 	}
 	else if (HasSegment(segment))
 	{
-		for (auto file : cfg.segmentRefFiles[segment])
+		for (auto file : segmentRefFiles[segment])
 		{
 			offset = Seg2Filespace(segAddress, file->baseAddress);
 
@@ -153,24 +190,24 @@ bool Globals::GetSegmentedPtrName(segptr_t segAddress, ZFile* currentFile,
 		}
 	}
 
-	const auto& symbolFromMap = Globals::Instance->cfg.symbolMap.find(segAddress);
-	if (symbolFromMap != Globals::Instance->cfg.symbolMap.end())
+	const std::string* symbolFromMap = Globals::Instance->cfg.symbolMap.Find(segAddress);
+	if (symbolFromMap != nullptr)
 	{
-		declName = "&" + symbolFromMap->second;
+		declName = "&" + *symbolFromMap;
 		return true;
 	}
 
 	declName = StringHelper::Sprintf("0x%08X", segAddress);
 	if (warnIfNotFound)
 	{
-		WarnHardcodedPointer(segAddress, currentFile, nullptr, -1);
+		Globals::Instance->WarnHardcodedPointer(segAddress, currentFile, nullptr, -1);
 	}
 	return false;
 }
 
-bool Globals::GetSegmentedArrayIndexedName(segptr_t segAddress, size_t elementSize,
-                                           ZFile* currentFile, const std::string& expectedType,
-                                           std::string& declName, bool warnIfNotFound)
+bool JobContext::GetSegmentedArrayIndexedName(segptr_t segAddress, size_t elementSize,
+                                              ZFile* currentFile, const std::string& expectedType,
+                                              std::string& declName, bool warnIfNotFound)
 {
 	if (segAddress == SEGMENTED_NULL)
 	{
@@ -189,7 +226,7 @@ bool Globals::GetSegmentedArrayIndexedName(segptr_t segAddress, size_t elementSi
 	}
 	else if (HasSegment(segment))
 	{
-		for (auto file : cfg.segmentRefFiles[segment])
+		for (auto file : segmentRefFiles[segment])
 		{
 			if (file->IsSegmentedInFilespaceRange(segAddress))
 			{
@@ -204,7 +241,7 @@ bool Globals::GetSegmentedArrayIndexedName(segptr_t segAddress, size_t elementSi
 	declName = StringHelper::Sprintf("0x%08X", segAddress);
 	if (warnIfNotFound)
 	{
-		WarnHardcodedPointer(segAddress, currentFile, nullptr, -1);
+		Globals::Instance->WarnHardcodedPointer(segAddress, currentFile, nullptr, -1);
 	}
 	return false;
 }
@@ -2,11 +2,16 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "GameConfig.h"
 #include "ZFile.h"
 #include "ExporterSet.h"
 
+class AnimationDataRegistry;
+class AnimationDataShares;
+class LimbTableRegistry;
+class TextureRegistry;
 class ZRoom;
 
 enum class VerbosityLevel
@@ -25,48 +30,41 @@ enum class CsFloatType
 	HexAndCommentedFloatRight,
 };
 
-class Globals
+/**
+ * Mutable state of a single extraction: the paths it was invoked with and every file it parsed.
+ * Each thread works on its own job, which is reachable through `Globals::Job`, so independent XMLs
+ * can be extracted at the same time.
+ */
+class JobContext
 {
 public:
-	static Globals* Instance;
-
-	bool genSourceFile;  // Used for extraction
-	bool useExternalResources;
-	bool testMode;  // Enables certain experimental features
-	bool outputCrc = false;
-	bool profile;  // Measure performance of certain operations
-	bool useLegacyZDList;
-	VerbosityLevel verbosity;  // ZAPD outputs additional information
-	ZFileMode fileMode;
-	fs::path baseRomPath, inputPath, outputPath, sourceOutputPath, cfgPath;
-	TextureType texType;
-	CsFloatType floatType = CsFloatType::FloatOnly;
+	bool genSourceFile = true;  // Used for extraction
+	fs::path inputPath, outputPath, sourceOutputPath;
 	int64_t baseAddress = -1;
 	int64_t startOffset = -1;
 	int64_t endOffset = -1;
-	ZGame game;
-	GameConfig cfg;
-	bool verboseUnaccounted = false;
-	bool gccCompat = false;
-	bool forceStatic = false;
-	bool forceUnaccountedStatic = false;
+	ZGame game = ZGame::OOT_RETAIL;
 
 	std::vector<ZFile*> files;
 	std::vector<ZFile*> externalFiles;
 	std::vector<int32_t> segments;
+	std::map<int32_t, std::vector<ZFile*>> segmentRefFiles;
+	std::unordered_map<std::string, ZFile*> filesByName;
 
-	std::string currentExporter;
-	static std::map<std::string, ExporterSet*>& GetExporterMap();
-	static void AddExporter(std::string exporterName, ExporterSet* exporterSet);
+	JobContext();
+	JobContext(const JobContext&) = delete;
+	JobContext& operator=(const JobContext&) = delete;
+	~JobContext();
 
-	Globals();
-	~Globals();
+	// Copies the settings (not the files) of another job
+	void InheritSettings(const JobContext& other);
 
 	void AddSegment(int32_t segment, ZFile* file);
 	bool HasSegment(int32_t segment);
 
-	ZResourceExporter* GetExporter(ZResourceType resType);
-	ExporterSet* GetExporterSet();
+	// Registers a parsed file. If several files share a name, the first one is found by name
+	void AddFile(ZFile* file);
+	ZFile* GetFileByName(const std::string& name) const;
 
 	/**
 	 * Search in every file (and the symbol map) for the `segAddress` passed as parameter.
@@ -83,6 +81,59 @@ public:
 	bool GetSegmentedArrayIndexedName(segptr_t segAddress, size_t elementSize, ZFile* currentFile,
 	                                  const std::string& expectedType, std::string& declName,
 	                                  bool warnIfNotFound = true);
+};
+
+/**
+ * Settings shared by every job. They are only written while parsing the command line and the
+ * config file, so worker threads can read them freely.
+ */
+class Globals
+{
+public:
+	static Globals* Instance;
+	static thread_local JobContext* Job;
+
+	bool useExternalResources;
+	bool testMode;  // Enables certain experimental features
+	bool outputCrc = false;
+	bool profile;               // Measure performance of certain operations
+	fs::path profileTracePath;  // Chrome trace written by the profiler, none if empty
+	bool useLegacyZDList;
+	VerbosityLevel verbosity;  // ZAPD outputs additional information
+	ZFileMode fileMode;
+	fs::path baseRomPath, cfgPath;
+	fs::path batchListPath;          // Job list used by the `batch` mode
+	uint32_t batchThreadCount = 1;  // Worker threads used by the `batch` mode
+	uint32_t pngThreadCount = 1;     // Threads for textures and long lists, 0 is one per core
+	fs::path cacheDir;               // Extraction cache directory, the cache is off if empty
+	bool fastPng = false;            // Compress PNGs quickly instead of well
+	bool dlBounds = false;           // Write the bounds of every display list next to the source
+	fs::path animDedupReportPath;    // Report of the animation data shared by the `batch` files
+	fs::path animDedupExternPath;    // Report whose shared animation data is only defined once
+	TextureType texType;
+	CsFloatType floatType = CsFloatType::FloatOnly;
+	GameConfig cfg;
+	TextureRegistry* textureRegistry = nullptr;      // PNGs written by the running `batch`, if any
+	LimbTableRegistry* limbTableRegistry = nullptr;  // Limb tables parsed by the running `batch`
+	AnimationDataRegistry* animationDataRegistry = nullptr;  // Animation data of `batch` files
+	const AnimationDataShares* animationDataShares = nullptr;  // Read from `animDedupExternPath`
+	bool verboseUnaccounted = false;
+	bool gccCompat = false;
+	bool forceStatic = false;
+	bool forceUnaccountedStatic = false;
+
+	// Job of the main thread, whose settings come from the command line
+	JobContext mainJob;
+
+	std::string currentExporter;
+	static std::map<std::string, ExporterSet*>& GetExporterMap();
+	static void AddExporter(std::string exporterName, ExporterSet* exporterSet);
+
+	Globals();
+	~Globals();
+
+	ZResourceExporter* GetExporter(ZResourceType resType);
+	ExporterSet* GetExporterSet();
 
 	// TODO: consider moving to another place
 	void WarnHardcodedPointer(segptr_t segAddress, ZFile* currentFile, ZResource* res,
@@ -5,6 +5,8 @@
 #include <png.h>
 #include <stdexcept>
 
+#include "Globals.h"
+#include "Utils/File.h"
 #include "Utils/StringHelper.h"
 #include "WarningHandler.h"
 
@@ -110,11 +112,7 @@ void ImageBackend::ReadPng(const char* filename)
 	png_read_update_info(png, info);
 
 	size_t rowBytes = png_get_rowbytes(png, info);
-	pixelMatrix = (uint8_t**)malloc(sizeof(uint8_t*) * height);
-	for (size_t y = 0; y < height; y++)
-	{
-		pixelMatrix[y] = (uint8_t*)malloc(rowBytes);
-	}
+	AllocateImageData(rowBytes);
 
 	png_read_image(png, pixelMatrix);
 
@@ -150,17 +148,18 @@ void ImageBackend::ReadPng(const fs::path& filename)
 	ReadPng(filename.c_str());
 }
 
+static void AppendPngData(png_structp png, png_bytep data, png_size_t length)
+{
+	auto* encoded = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png));
+	encoded->insert(encoded->end(), data, data + length);
+}
+
 void ImageBackend::WritePng(const char* filename)
 {
 	assert(hasImageData);
 
-	FILE* fp = fopen(filename, "wb");
-	if (fp == nullptr)
-	{
-		std::string errorHeader =
-			StringHelper::Sprintf("could not open file '%s' in write mode", filename);
-		HANDLE_ERROR(WarningType::InvalidPNG, errorHeader, "");
-	}
+	if (File::writeLog != nullptr)
+		File::writeLog->push_back(filename);
 
 	png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
 	if (png == nullptr)
@@ -174,13 +173,22 @@ void ImageBackend::WritePng(const char* filename)
 		HANDLE_ERROR(WarningType::InvalidPNG, "could not create png info", "");
 	}
 
+	// The PNG is encoded in memory first, so an existing file with the same content isn't touched
+	std::vector<uint8_t> encoded;
+
 	if (setjmp(png_jmpbuf(png)))
 	{
 		// TODO: better warning description
 		HANDLE_ERROR(WarningType::InvalidPNG, "setjmp(png_jmpbuf(png))", "");
 	}
 
-	png_init_io(png, fp);
+	png_set_write_fn(png, &encoded, AppendPngData, nullptr);
+
+	if (Globals::Instance->fastPng)
+	{
+		png_set_compression_level(png, 1);
+		png_set_filter(png, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
+	}
 
 	png_set_IHDR(png, info, width, height,
 	             bitDepth,   // 8,
@@ -229,9 +237,21 @@ void ImageBackend::WritePng(const char* filename)
 	png_write_image(png, pixelMatrix);
 	png_write_end(png, nullptr);
 
-	fclose(fp);
-
 	png_destroy_write_struct(&png, &info);
+
+	if (File::HasContent(filename, reinterpret_cast<const char*>(encoded.data()), encoded.size()))
+		return;
+
+	FILE* fp = fopen(filename, "wb");
+	if (fp == nullptr)
+	{
+		std::string errorHeader =
+			StringHelper::Sprintf("could not open file '%s' in write mode", filename);
+		HANDLE_ERROR(WarningType::InvalidPNG, errorHeader, "");
+	}
+
+	fwrite(encoded.data(), 1, encoded.size(), fp);
+	fclose(fp);
 }
 
 void ImageBackend::WritePng(const fs::path& filename)
@@ -254,10 +274,9 @@ void ImageBackend::SetTextureData(const std::vector<std::vector<RGBAPixel>>& tex
 
 	size_t bytePerPixel = GetBytesPerPixel();
 
-	pixelMatrix = static_cast<uint8_t**>(malloc(sizeof(uint8_t*) * height));
+	AllocateImageData(width * bytePerPixel);
 	for (size_t y = 0; y < height; y++)
 	{
-		pixelMatrix[y] = static_cast<uint8_t*>(malloc(sizeof(uint8_t*) * width * bytePerPixel));
 		for (size_t x = 0; x < width; x++)
 		{
 			pixelMatrix[y][x * bytePerPixel + 0] = texData.at(y).at(x).r;
@@ -284,11 +303,7 @@ void ImageBackend::InitEmptyRGBImage(uint32_t nWidth, uint32_t nHeight, bool alp
 
 	size_t bytePerPixel = GetBytesPerPixel();
 
-	pixelMatrix = static_cast<uint8_t**>(malloc(sizeof(uint8_t*) * height));
-	for (size_t y = 0; y < height; y++)
-	{
-		pixelMatrix[y] = static_cast<uint8_t*>(calloc(width * bytePerPixel, sizeof(uint8_t*)));
-	}
+	AllocateImageData(width * bytePerPixel);
 
 	hasImageData = true;
 }
@@ -304,11 +319,7 @@ void ImageBackend::InitEmptyPaletteImage(uint32_t nWidth, uint32_t nHeight)
 
 	size_t bytePerPixel = GetBytesPerPixel();
 
-	pixelMatrix = (uint8_t**)malloc(sizeof(uint8_t*) * height);
-	for (size_t y = 0; y < height; y++)
-	{
-		pixelMatrix[y] = static_cast<uint8_t*>(calloc(width * bytePerPixel, sizeof(uint8_t*)));
-	}
+	AllocateImageData(width * bytePerPixel);
 	colorPalette = calloc(paletteSize, sizeof(png_color));
 	alphaPalette = static_cast<uint8_t*>(calloc(paletteSize, sizeof(uint8_t)));
 
@@ -427,6 +438,37 @@ void ImageBackend::SetPalette(const ImageBackend& pal, uint32_t offset)
 	}
 }
 
+uint8_t* ImageBackend::GetRow(size_t y)
+{
+	assert(hasImageData);
+	assert(y < height);
+
+	return imageData + y * rowStride;
+}
+
+const uint8_t* ImageBackend::GetRow(size_t y) const
+{
+	assert(hasImageData);
+	assert(y < height);
+
+	return imageData + y * rowStride;
+}
+
+size_t ImageBackend::GetRowStride() const
+{
+	return rowStride;
+}
+
+bool ImageBackend::HasAlphaChannel() const
+{
+	return colorType == PNG_COLOR_TYPE_RGBA;
+}
+
+bool ImageBackend::IsColorIndexed() const
+{
+	return isColorIndexed;
+}
+
 uint32_t ImageBackend::GetWidth() const
 {
 	return width;
@@ -465,14 +507,24 @@ double ImageBackend::GetBytesPerPixel() const
 	}
 }
 
+void ImageBackend::AllocateImageData(size_t nRowStride)
+{
+	rowStride = nRowStride;
+
+	imageData = static_cast<uint8_t*>(calloc(height * rowStride, sizeof(uint8_t)));
+	pixelMatrix = static_cast<uint8_t**>(malloc(sizeof(uint8_t*) * height));
+	for (size_t y = 0; y < height; y++)
+		pixelMatrix[y] = imageData + y * rowStride;
+}
+
 void ImageBackend::FreeImageData()
 {
 	if (hasImageData)
 	{
-		for (size_t y = 0; y < height; y++)
-			free(pixelMatrix[y]);
 		free(pixelMatrix);
+		free(imageData);
 		pixelMatrix = nullptr;
+		imageData = nullptr;
 	}
 
 	if (isColorIndexed)
@@ -46,13 +46,23 @@ public:
 	void SetPaletteIndex(size_t index, uint8_t nR, uint8_t nG, uint8_t nB, uint8_t nA);
 	void SetPalette(const ImageBackend& pal, uint32_t offset = 0);
 
+	// The rows of the image are stored one after another in a single buffer, `GetRowStride()`
+	// bytes apart, so whole rows can be converted at once instead of pixel by pixel
+	uint8_t* GetRow(size_t y);
+	const uint8_t* GetRow(size_t y) const;
+	size_t GetRowStride() const;
+	bool HasAlphaChannel() const;
+	bool IsColorIndexed() const;
+
 	uint32_t GetWidth() const;
 	uint32_t GetHeight() const;
 	uint8_t GetColorType() const;
 	uint8_t GetBitDepth() const;
 
 protected:
-	uint8_t** pixelMatrix = nullptr;  // height * [width * bytePerPixel]
+	uint8_t* imageData = nullptr;     // height * rowStride
+	uint8_t** pixelMatrix = nullptr;  // Pointers to each row of imageData, as libpng wants them
+	size_t rowStride = 0;
 
 	void* colorPalette = nullptr;
 	uint8_t* alphaPalette = nullptr;
@@ -68,5 +78,6 @@ protected:
 
 	double GetBytesPerPixel() const;
 
+	void AllocateImageData(size_t nRowStride);
 	void FreeImageData();
 };
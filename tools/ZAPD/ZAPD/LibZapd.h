@@ -0,0 +1,36 @@
+#pragma once
+
+/**
+ * C API of libzapd, to run ZAPD inside another process, e.g. a Python tool loading libzapd.so with
+ * ctypes. The config, the exporter and the external XMLs the config lists are loaded once and kept
+ * across calls, instead of once per ZAPD.out process.
+ *
+ * Every function but zapd_teardown returns 0 on success. Errors and warnings are printed to stderr,
+ * as ZAPD.out prints them. The functions must not be called from several threads at once, and
+ * zapd_init only once per process.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Reads the config at `configPath`. The `argc` strings of `argv` (which may be NULL) are more
+ * arguments, as they are passed to ZAPD.out after its mode, e.g. "-se", "NSPIRE" or "-Wno-foo".
+ * Those of a single job, such as `-i` or `-o`, are given to each call instead.
+ */
+int zapd_init(const char* configPath, int argc, const char* const* argv);
+
+// Extracts an XML, like `ZAPD.out e -i xmlPath -b baseromPath -o outPath -osf sourceOutPath -gsf 1`
+int zapd_extract(const char* xmlPath, const char* baseromPath, const char* outPath,
+                 const char* sourceOutPath, int genSourceFile);
+
+// Builds the `.inc.c` of a texture named `NAME.FORMAT.png`, the way `bassets` does
+int zapd_build_texture(const char* pngPath, const char* outPath);
+
+// Frees what zapd_init and the extractions loaded
+void zapd_teardown(void);
+
+#ifdef __cplusplus
+}
+#endif
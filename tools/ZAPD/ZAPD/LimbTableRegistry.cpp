@@ -0,0 +1,18 @@
+#include "LimbTableRegistry.h"
+
+std::shared_ptr<const LimbTableRegistry::LimbList>
+LimbTableRegistry::Find(const std::string& contentKey)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = tables.find(contentKey);
+
+	if (it == tables.end())
+		return nullptr;
+	return it->second;
+}
+
+void LimbTableRegistry::Add(const std::string& contentKey, std::shared_ptr<const LimbList> limbs)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	tables.emplace(contentKey, std::move(limbs));
+}
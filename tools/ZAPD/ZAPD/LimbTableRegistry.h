@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ZLimb.h"
+
+/**
+ * Limb tables parsed by the jobs of a batch, shared by all of its worker threads.
+ *
+ * The variants of an actor kept in separate objects often have byte-identical limb tables, with
+ * the limbs at the same offsets. A table is keyed by its limb type, its own bytes and the bytes of
+ * every limb it points to in its file, so the limbs of a table already seen take the values parsed
+ * there. The limbs are still declared by every file, along with their display lists, since each
+ * object is compiled on its own.
+ */
+class LimbTableRegistry
+{
+public:
+	using LimbList = std::vector<ZLimbFields>;
+
+	LimbTableRegistry() = default;
+	LimbTableRegistry(const LimbTableRegistry&) = delete;
+	LimbTableRegistry& operator=(const LimbTableRegistry&) = delete;
+
+	// Returns the limbs parsed for a table with `contentKey`, or `nullptr` if none was added yet
+	std::shared_ptr<const LimbList> Find(const std::string& contentKey);
+
+	// The first table added for a key is kept
+	void Add(const std::string& contentKey, std::shared_ptr<const LimbList> limbs);
+
+protected:
+	std::mutex mutex;
+	std::unordered_map<std::string, std::shared_ptr<const LimbList>> tables;
+};
@@ -10,10 +10,25 @@
 #include "ZTexture.h"
 
 #include <functional>
+#include "AnimationDataRegistry.h"
 #include "CrashHandler.h"
-
+#include "ExternalIndex.h"
+#include "ExtractionCache.h"
+#include "LibZapd.h"
+#include "LimbTableRegistry.h"
+#include "Profiler.h"
+#include "TextureRegistry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <unordered_set>
 #include "tinyxml2.h"
 
 using ArgFunc = void (*)(int&, char**);
@@ -26,6 +41,7 @@ void Arg_GenerateSourceFile(int& i, char* argv[]);
 void Arg_TestMode(int& i, char* argv[]);
 void Arg_LegacyDList(int& i, char* argv[]);
 void Arg_EnableProfiling(int& i, char* argv[]);
+void Arg_SetProfileTracePath(int& i, char* argv[]);
 void Arg_UseExternalResources(int& i, char* argv[]);
 void Arg_SetTextureType(int& i, char* argv[]);
 void Arg_ReadConfigFile(int& i, char* argv[]);
@@ -40,11 +56,19 @@ void Arg_CsFloatMode(int& i, char* argv[]);
 void Arg_BaseAddress(int& i, char* argv[]);
 void Arg_StartOffset(int& i, char* argv[]);
 void Arg_EndOffset(int& i, char* argv[]);
+void Arg_SetBatchListPath(int& i, char* argv[]);
+void Arg_SetBatchThreadCount(int& i, char* argv[]);
+void Arg_SetCacheDir(int& i, char* argv[]);
+void Arg_FastPng(int& i, char* argv[]);
+void Arg_DListBounds(int& i, char* argv[]);
+void Arg_AnimDedupReport(int& i, char* argv[]);
+void Arg_AnimDedupExtern(int& i, char* argv[]);
 
-int main(int argc, char* argv[]);
+int RunCommandLine(int argc, char* argv[]);
 
 bool Parse(const fs::path& xmlFilePath, const fs::path& basePath, const fs::path& outPath,
 		   ZFileMode fileMode);
+bool ParseExternal(const fs::path& xmlFilePath, const fs::path& basePath, const fs::path& outPath);
 
 void ParseArgs(int& argc, char* argv[]);
 
@@ -53,16 +77,21 @@ void BuildAssetBackground(const fs::path& imageFilePath, const fs::path& outPath
 void BuildAssetBlob(const fs::path& blobFilePath, const fs::path& outPath);
 ZFileMode ParseFileMode(const std::string& buildMode, ExporterSet* exporterSet);
 int HandleExtract(ZFileMode fileMode, ExporterSet* exporterSet);
+int HandleBatchExtract(ExporterSet* exporterSet);
+int HandleCheck(ExporterSet* exporterSet);
+int HandleBuildAssets();
 
 extern const char gBuildHash[];
 
-int main(int argc, char* argv[])
+// Runs a ZAPD.out command line, see EntryPoint.cpp
+int RunCommandLine(int argc, char* argv[])
 {
 	int returnCode = 0;
 
 	if (argc < 2)
 	{
-		printf("ZAPD.out (%s) [mode (btex/bovl/bsf/bblb/bmdlintr/bamnintr/e)] ...\n", gBuildHash);
+		printf("ZAPD.out (%s) [mode (btex/bovl/bsf/bblb/bassets/bmdlintr/bamnintr/e/check/batch)] ...\n",
+		       gBuildHash);
 		return 1;
 	}
 
@@ -89,10 +118,14 @@ int main(int argc, char* argv[])
 
 	ParseArgs(argc, argv);
 
+	if (Globals::Instance->profile)
+		Profiler::Start();
+
 	// Parse File Mode
 	ExporterSet* exporterSet = Globals::Instance->GetExporterSet();
 	std::string buildMode = argv[1];
-	ZFileMode fileMode = ParseFileMode(buildMode, exporterSet);
+	bool batchMode = buildMode == "batch";
+	ZFileMode fileMode = batchMode ? ZFileMode::Extract : ParseFileMode(buildMode, exporterSet);
 
 	if (fileMode == ZFileMode::Invalid)
 	{
@@ -114,25 +147,95 @@ int main(int argc, char* argv[])
 	if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_DEBUG)
 		WarningHandler::PrintWarningsDebugInfo();
 
-	if (fileMode == ZFileMode::Extract || fileMode == ZFileMode::BuildSourceFile)
+	AnimationDataShares animationDataShares;
+	if (!Globals::Instance->animDedupExternPath.empty())
+	{
+		if (!animationDataShares.Load(Globals::Instance->animDedupExternPath))
+		{
+			fprintf(stderr, "Error: unable to read animation data report '%s'\n",
+			        Globals::Instance->animDedupExternPath.c_str());
+			return 1;
+		}
+		Globals::Instance->animationDataShares = &animationDataShares;
+	}
+
+	if (batchMode)
+		returnCode = HandleBatchExtract(exporterSet);
+	else if (fileMode == ZFileMode::Extract || fileMode == ZFileMode::BuildSourceFile)
+	{
+		// A single job has the cores to itself, the workers of `batch` already use them
+		Globals::Instance->pngThreadCount = Globals::Instance->batchThreadCount;
 		returnCode = HandleExtract(fileMode, exporterSet);
+	}
+	else if (fileMode == ZFileMode::Check)
+		returnCode = HandleCheck(exporterSet);
 	else if (fileMode == ZFileMode::BuildTexture)
-		BuildAssetTexture(Globals::Instance->inputPath, Globals::Instance->texType,
-						  Globals::Instance->outputPath);
+		BuildAssetTexture(Globals::Job->inputPath, Globals::Instance->texType,
+						  Globals::Job->outputPath);
 	else if (fileMode == ZFileMode::BuildBackground)
-		BuildAssetBackground(Globals::Instance->inputPath, Globals::Instance->outputPath);
+		BuildAssetBackground(Globals::Job->inputPath, Globals::Job->outputPath);
 	else if (fileMode == ZFileMode::BuildBlob)
-		BuildAssetBlob(Globals::Instance->inputPath, Globals::Instance->outputPath);
+		BuildAssetBlob(Globals::Job->inputPath, Globals::Job->outputPath);
+	else if (fileMode == ZFileMode::BuildAssets)
+		returnCode = HandleBuildAssets();
+
+	if (WarningHandler::countOnly)
+		WarningHandler::PrintWarningsDebugInfo();
+
+	if (Globals::Instance->profile)
+		Profiler::Report();
 
 	delete g;
 	return returnCode;
 }
 
+/**
+ * XMLDocuments of this thread that no Parse is using. A document keeps the memory pools of its
+ * nodes when it's cleared, so the next XML loaded into it reuses them instead of allocating every
+ * element and attribute again. Parse recurses into ExternalFile XMLs while its own document is in
+ * use, so there is one document per level of nesting.
+ */
+static thread_local std::vector<std::unique_ptr<tinyxml2::XMLDocument>> sXmlDocumentPool;
+
+class PooledXmlDocument
+{
+public:
+	PooledXmlDocument()
+	{
+		if (sXmlDocumentPool.empty())
+		{
+			doc = std::make_unique<tinyxml2::XMLDocument>();
+		}
+		else
+		{
+			doc = std::move(sXmlDocumentPool.back());
+			sXmlDocumentPool.pop_back();
+		}
+	}
+
+	~PooledXmlDocument()
+	{
+		// Frees the text of the file, the node pools stay allocated
+		doc->Clear();
+		sXmlDocumentPool.push_back(std::move(doc));
+	}
+
+	PooledXmlDocument(const PooledXmlDocument&) = delete;
+	PooledXmlDocument& operator=(const PooledXmlDocument&) = delete;
+
+	tinyxml2::XMLDocument* operator->() const { return doc.get(); }
+
+private:
+	std::unique_ptr<tinyxml2::XMLDocument> doc;
+};
+
 bool Parse(const fs::path& xmlFilePath, const fs::path& basePath, const fs::path& outPath,
 		   ZFileMode fileMode)
 {
-	tinyxml2::XMLDocument doc;
-	tinyxml2::XMLError eResult = doc.LoadFile(xmlFilePath.string().c_str());
+	ProfileScope profileScope(ProfilePhase::ExtractXml, ZResourceType::Error, xmlFilePath.string());
+
+	PooledXmlDocument doc;
+	tinyxml2::XMLError eResult = doc->LoadFile(xmlFilePath.string().c_str());
 
 	if (eResult != tinyxml2::XML_SUCCESS)
 	{
@@ -142,7 +245,7 @@ bool Parse(const fs::path& xmlFilePath, const fs::path& basePath, const fs::path
 		return false;
 	}
 
-	tinyxml2::XMLNode* root = doc.FirstChild();
+	tinyxml2::XMLNode* root = doc->FirstChild();
 
 	if (root == nullptr)
 	{
@@ -158,14 +261,14 @@ bool Parse(const fs::path& xmlFilePath, const fs::path& basePath, const fs::path
 		if (std::string_view(child->Name()) == "File")
 		{
 			ZFile* file = new ZFile(fileMode, child, basePath, outPath, "", xmlFilePath);
-			Globals::Instance->files.push_back(file);
+			Globals::Job->AddFile(file);
 			if (fileMode == ZFileMode::ExternalFile)
 			{
-				Globals::Instance->externalFiles.push_back(file);
+				Globals::Job->externalFiles.push_back(file);
 				file->isExternalFile = true;
 			}
 		}
-		else if (std::string(child->Name()) == "ExternalFile")
+		else if (std::string_view(child->Name()) == "ExternalFile")
 		{
 			const char* xmlPathValue = child->Attribute("XmlPath");
 			if (xmlPathValue == nullptr)
@@ -194,7 +297,7 @@ bool Parse(const fs::path& xmlFilePath, const fs::path& basePath, const fs::path
 			}
 
 			// Recursion. What can go wrong?
-			Parse(externalXmlFilePath, basePath, externalOutFilePath, ZFileMode::ExternalFile);
+			ParseExternal(externalXmlFilePath, basePath, externalOutFilePath);
 		}
 		else
 		{
@@ -206,14 +309,19 @@ bool Parse(const fs::path& xmlFilePath, const fs::path& basePath, const fs::path
 		}
 	}
 
-	if (fileMode != ZFileMode::ExternalFile)
+	if (fileMode == ZFileMode::Check)
+	{
+		for (ZFile* file : Globals::Job->files)
+			file->CheckResources();
+	}
+	else if (fileMode != ZFileMode::ExternalFile)
 	{
 		ExporterSet* exporterSet = Globals::Instance->GetExporterSet();
 
 		if (exporterSet != nullptr && exporterSet->beginXMLFunc != nullptr)
 			exporterSet->beginXMLFunc();
 
-		for (ZFile* file : Globals::Instance->files)
+		for (ZFile* file : Globals::Job->files)
 		{
 			if (fileMode == ZFileMode::BuildSourceFile)
 				file->BuildSourceFile();
@@ -228,6 +336,95 @@ bool Parse(const fs::path& xmlFilePath, const fs::path& basePath, const fs::path
 	return true;
 }
 
+/**
+ * In batch mode, and in libzapd, the files parsed from an ExternalFile XML are kept alive across
+ * jobs, so every job after the first one only has to register them again instead of parsing the
+ * XML and its binary once more. Otherwise this cache is never filled.
+ * Each batch worker thread has a cache of its own, so cached files are never shared by threads.
+ * An entry is parsed again when its XML was modified after it was cached.
+ */
+struct ExternalXmlCacheEntry
+{
+	std::vector<ZFile*> files;
+	bool changesGame;
+	ZGame game;
+	fs::file_time_type xmlTime;
+};
+
+static thread_local bool sUseExternalXmlCache = false;
+static thread_local std::map<std::string, ExternalXmlCacheEntry> sExternalXmlCache;
+// Files of entries parsed again, which earlier jobs and other entries may still point to
+static thread_local std::vector<ZFile*> sStaleExternalFiles;
+
+// Registers the files of an external XML from the extraction cache if it was indexed, or parses it
+static bool ParseExternalIndexed(const fs::path& xmlFilePath, const fs::path& basePath,
+                                 const fs::path& outPath)
+{
+	ExtractionCache cache;
+	bool useIndex = cache.ComputeExternalKey(xmlFilePath, basePath, outPath);
+
+	if (useIndex && ExternalIndex::Load(cache, xmlFilePath, basePath, outPath))
+		return true;
+
+	size_t firstFile = Globals::Job->files.size();
+	if (!Parse(xmlFilePath, basePath, outPath, ZFileMode::ExternalFile))
+		return false;
+
+	if (useIndex)
+		ExternalIndex::Store(cache, xmlFilePath, firstFile);
+
+	return true;
+}
+
+bool ParseExternal(const fs::path& xmlFilePath, const fs::path& basePath, const fs::path& outPath)
+{
+	if (!sUseExternalXmlCache)
+		return ParseExternalIndexed(xmlFilePath, basePath, outPath);
+
+	std::string key = xmlFilePath.string() + "\n" + basePath.string() + "\n" + outPath.string();
+	std::error_code ec;
+	fs::file_time_type xmlTime = fs::last_write_time(xmlFilePath, ec);
+	auto it = sExternalXmlCache.find(key);
+
+	if (it != sExternalXmlCache.end() && it->second.xmlTime != xmlTime)
+	{
+		sStaleExternalFiles.insert(sStaleExternalFiles.end(), it->second.files.begin(),
+		                           it->second.files.end());
+		sExternalXmlCache.erase(it);
+		it = sExternalXmlCache.end();
+	}
+
+	if (it != sExternalXmlCache.end())
+	{
+		// Register the cached files in the same order a fresh parse would have
+		for (ZFile* file : it->second.files)
+		{
+			Globals::Job->AddSegment(file->segment, file);
+			Globals::Job->AddFile(file);
+			Globals::Job->externalFiles.push_back(file);
+		}
+
+		if (it->second.changesGame)
+			Globals::Job->game = it->second.game;
+
+		return true;
+	}
+
+	size_t firstFile = Globals::Job->files.size();
+	ZGame prevGame = Globals::Job->game;
+
+	if (!ParseExternalIndexed(xmlFilePath, basePath, outPath))
+		return false;
+
+	ExternalXmlCacheEntry& entry = sExternalXmlCache[key];
+	entry.files.assign(Globals::Job->files.begin() + firstFile, Globals::Job->files.end());
+	entry.changesGame = Globals::Job->game != prevGame;
+	entry.game = Globals::Job->game;
+	entry.xmlTime = xmlTime;
+
+	return true;
+}
+
 void ParseArgs(int& argc, char* argv[])
 {
 	static const std::unordered_map<std::string, ArgFunc> ArgFuncDictionary = {
@@ -242,6 +439,7 @@ void ParseArgs(int& argc, char* argv[])
 		{"-tm", &Arg_TestMode},
 		{"-ulzdl", &Arg_LegacyDList},
 		{"-profile", &Arg_EnableProfiling},
+		{"--profile-trace", &Arg_SetProfileTracePath},
 		{"-uer", &Arg_UseExternalResources},
 		{"-tt", &Arg_SetTextureType},
 		{"-rconf", &Arg_ReadConfigFile},
@@ -260,6 +458,16 @@ void ParseArgs(int& argc, char* argv[])
 		{"--base-address", &Arg_BaseAddress},
 		{"--start-offset", &Arg_StartOffset},
 		{"--end-offset", &Arg_EndOffset},
+		{"-l", &Arg_SetBatchListPath},
+		{"--batch-list", &Arg_SetBatchListPath},
+		{"-j", &Arg_SetBatchThreadCount},
+		{"--jobs", &Arg_SetBatchThreadCount},
+		{"--cache-dir", &Arg_SetCacheDir},
+		{"-fpng", &Arg_FastPng},
+		{"--fast-png", &Arg_FastPng},
+		{"--dl-bounds", &Arg_DListBounds},
+		{"--anim-dedup-report", &Arg_AnimDedupReport},
+		{"--anim-dedup-extern", &Arg_AnimDedupExtern},
 	};
 
 	for (int32_t i = 2; i < argc; i++)
@@ -295,8 +503,12 @@ ZFileMode ParseFileMode(const std::string& buildMode, ExporterSet* exporterSet)
 		fileMode = ZFileMode::BuildSourceFile;
 	else if (buildMode == "bblb")
 		fileMode = ZFileMode::BuildBlob;
+	else if (buildMode == "bassets")
+		fileMode = ZFileMode::BuildAssets;
 	else if (buildMode == "e")
 		fileMode = ZFileMode::Extract;
+	else if (buildMode == "check")
+		fileMode = ZFileMode::Check;
 	else if (exporterSet != nullptr && exporterSet->parseFileModeFunc != nullptr)
 		exporterSet->parseFileModeFunc(buildMode, fileMode);
 
@@ -305,15 +517,15 @@ ZFileMode ParseFileMode(const std::string& buildMode, ExporterSet* exporterSet)
 
 void Arg_SetOutputPath(int& i, [[maybe_unused]] char* argv[])
 {
-	Globals::Instance->outputPath = argv[++i];
+	Globals::Job->outputPath = argv[++i];
 
-	if (Globals::Instance->sourceOutputPath == "")
-		Globals::Instance->sourceOutputPath = Globals::Instance->outputPath;
+	if (Globals::Job->sourceOutputPath == "")
+		Globals::Job->sourceOutputPath = Globals::Job->outputPath;
 }
 
 void Arg_SetInputPath(int& i, char* argv[])
 {
-	Globals::Instance->inputPath = argv[++i];
+	Globals::Job->inputPath = argv[++i];
 }
 
 void Arg_SetBaseromPath(int& i, char* argv[])
@@ -323,13 +535,13 @@ void Arg_SetBaseromPath(int& i, char* argv[])
 
 void Arg_SetSourceOutputPath(int& i, char* argv[])
 {
-	Globals::Instance->sourceOutputPath = argv[++i];
+	Globals::Job->sourceOutputPath = argv[++i];
 }
 
 void Arg_GenerateSourceFile(int& i, char* argv[])
 {
 	// Generate source file during extraction
-	Globals::Instance->genSourceFile = std::string_view(argv[++i]) == "1";
+	Globals::Job->genSourceFile = std::string_view(argv[++i]) == "1";
 }
 
 void Arg_TestMode(int& i, char* argv[])
@@ -348,6 +560,12 @@ void Arg_EnableProfiling(int& i, char* argv[])
 	Globals::Instance->profile = std::string_view(argv[++i]) == "1";
 }
 
+void Arg_SetProfileTracePath(int& i, char* argv[])
+{
+	Globals::Instance->profileTracePath = argv[++i];
+	Globals::Instance->profile = true;
+}
+
 void Arg_UseExternalResources(int& i, char* argv[])
 {
 	// Split resources into their individual components(enabled by default)
@@ -443,17 +661,53 @@ uint32_t ParseU32Hex(char* str)
 
 void Arg_BaseAddress(int& i, char* argv[])
 {
-	Globals::Instance->baseAddress = ParseU32Hex(argv[++i]);
+	Globals::Job->baseAddress = ParseU32Hex(argv[++i]);
 }
 
 void Arg_StartOffset(int& i, char* argv[])
 {
-	Globals::Instance->startOffset = ParseU32Hex(argv[++i]);
+	Globals::Job->startOffset = ParseU32Hex(argv[++i]);
 }
 
 void Arg_EndOffset(int& i, char* argv[])
 {
-	Globals::Instance->endOffset = ParseU32Hex(argv[++i]);
+	Globals::Job->endOffset = ParseU32Hex(argv[++i]);
+}
+
+void Arg_SetBatchListPath(int& i, char* argv[])
+{
+	Globals::Instance->batchListPath = argv[++i];
+}
+
+void Arg_SetBatchThreadCount(int& i, char* argv[])
+{
+	// 0 means one thread per core
+	Globals::Instance->batchThreadCount = strtoul(argv[++i], NULL, 10);
+}
+
+void Arg_SetCacheDir(int& i, char* argv[])
+{
+	Globals::Instance->cacheDir = argv[++i];
+}
+
+void Arg_FastPng([[maybe_unused]] int& i, [[maybe_unused]] char* argv[])
+{
+	Globals::Instance->fastPng = true;
+}
+
+void Arg_DListBounds([[maybe_unused]] int& i, [[maybe_unused]] char* argv[])
+{
+	Globals::Instance->dlBounds = true;
+}
+
+void Arg_AnimDedupReport(int& i, char* argv[])
+{
+	Globals::Instance->animDedupReportPath = argv[++i];
+}
+
+void Arg_AnimDedupExtern(int& i, char* argv[])
+{
+	Globals::Instance->animDedupExternPath = argv[++i];
 }
 
 int HandleExtract(ZFileMode fileMode, ExporterSet* exporterSet)
@@ -467,6 +721,19 @@ int HandleExtract(ZFileMode fileMode, ExporterSet* exporterSet)
 	{
 		bool parseSuccessful;
 
+		// Exporters may write their output without going through File, so they aren't cached.
+		// Checking has no output, and has to warn every time. The animation data report needs
+		// every file parsed
+		ExtractionCache cache;
+		bool useCache = exporterSet == nullptr && fileMode != ZFileMode::Check &&
+		                Globals::Instance->animationDataRegistry == nullptr &&
+		                cache.ComputeKey(fileMode);
+
+		if (useCache && cache.Restore())
+			return 0;
+		if (useCache)
+			cache.BeginRecording();
+
 		for (auto& extFile : Globals::Instance->cfg.externalFiles)
 		{
 			fs::path externalXmlFilePath =
@@ -475,23 +742,255 @@ int HandleExtract(ZFileMode fileMode, ExporterSet* exporterSet)
 			if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
 				printf("Parsing external file from config: '%s'\n", externalXmlFilePath.c_str());
 
-			parseSuccessful = Parse(externalXmlFilePath, Globals::Instance->baseRomPath,
-									extFile.outPath, ZFileMode::ExternalFile);
+			parseSuccessful =
+				ParseExternal(externalXmlFilePath, Globals::Instance->baseRomPath, extFile.outPath);
 
 			if (!parseSuccessful)
 				return 1;
 		}
 
-		parseSuccessful = Parse(Globals::Instance->inputPath, Globals::Instance->baseRomPath,
-								Globals::Instance->outputPath, fileMode);
+		parseSuccessful = Parse(Globals::Job->inputPath, Globals::Instance->baseRomPath,
+								Globals::Job->outputPath, fileMode);
 		if (!parseSuccessful)
 			return 1;
+
+		if (useCache)
+			cache.Store();
 	}
 
 	return 0;
 }
 
-void BuildAssetTexture(const fs::path& pngFilePath, TextureType texType, const fs::path& outPath)
+// The cached external files are owned by the cache, not by the job that registered them
+static void ReleaseCachedExternalFiles(JobContext& job)
+{
+	job.files.erase(std::remove_if(job.files.begin(), job.files.end(),
+	                               [](ZFile* file) { return file->isExternalFile; }),
+	                job.files.end());
+}
+
+// Deletes the files of the external XML cache of this thread, and stops caching
+static void ClearExternalXmlCache()
+{
+	// Entries of nested ExternalFile XMLs share their files with the entry that included them
+	std::unordered_set<ZFile*> cachedFiles;
+	for (auto& entry : sExternalXmlCache)
+		cachedFiles.insert(entry.second.files.begin(), entry.second.files.end());
+	cachedFiles.insert(sStaleExternalFiles.begin(), sStaleExternalFiles.end());
+	for (ZFile* file : cachedFiles)
+		delete file;
+	sExternalXmlCache.clear();
+	sStaleExternalFiles.clear();
+	sUseExternalXmlCache = false;
+}
+
+struct BatchState
+{
+	std::istream* list;
+	std::mutex listMutex;
+	std::atomic<bool> failed = false;
+	ExporterSet* exporterSet;
+	ZFileMode fileMode = ZFileMode::Extract;
+};
+
+/**
+ * Reads the arguments of the next job from the batch list.
+ * Returns `false` once the list is exhausted or any job has failed.
+ */
+static bool ReadBatchJob(BatchState& state, std::vector<std::string>& jobArgs)
+{
+	std::lock_guard<std::mutex> lock(state.listMutex);
+	std::string line;
+
+	while (!state.failed && std::getline(*state.list, line))
+	{
+		std::istringstream lineStream(line);
+		std::string token;
+
+		jobArgs.clear();
+		while (lineStream >> token)
+			jobArgs.push_back(token);
+
+		if (!jobArgs.empty() && jobArgs[0][0] != '#')
+			return true;
+	}
+
+	return false;
+}
+
+static void RunBatchWorker(BatchState& state)
+{
+	static const std::unordered_map<std::string, ArgFunc> JobArgFuncDictionary = {
+		{"-i", &Arg_SetInputPath},
+		{"--inputpath", &Arg_SetInputPath},
+		{"-o", &Arg_SetOutputPath},
+		{"--outputpath", &Arg_SetOutputPath},
+		{"-osf", &Arg_SetSourceOutputPath},
+		{"-gsf", &Arg_GenerateSourceFile},
+		{"--base-address", &Arg_BaseAddress},
+		{"--start-offset", &Arg_StartOffset},
+		{"--end-offset", &Arg_EndOffset},
+	};
+
+	JobContext* prevJob = Globals::Job;
+	std::vector<std::string> jobArgs;
+
+	sUseExternalXmlCache = true;
+
+	while (ReadBatchJob(state, jobArgs))
+	{
+		// Per-job settings start from whatever was passed on the command line
+		JobContext job;
+		job.InheritSettings(Globals::Instance->mainJob);
+		job.inputPath = "";
+		Globals::Job = &job;
+
+		std::vector<char*> jobArgv;
+		for (std::string& arg : jobArgs)
+			jobArgv.push_back(arg.data());
+		jobArgv.push_back(nullptr);
+
+		int jobArgc = jobArgs.size();
+		for (int i = 0; i < jobArgc; i++)
+		{
+			auto it = JobArgFuncDictionary.find(jobArgv[i]);
+			if (it == JobArgFuncDictionary.end() || i + 1 >= jobArgc)
+			{
+				fprintf(stderr, "Unsupported batch job argument: %s\n", jobArgv[i]);
+				continue;
+			}
+
+			std::invoke(it->second, i, jobArgv.data());
+		}
+
+		if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
+			printf("Batch job: '%s'\n", job.inputPath.c_str());
+
+		if (HandleExtract(state.fileMode, state.exporterSet) != 0)
+			state.failed = true;
+
+		ReleaseCachedExternalFiles(job);
+		Globals::Job = prevJob;
+	}
+
+	ClearExternalXmlCache();
+}
+
+// Runs the jobs of the list on `-j` worker threads
+static int RunBatch(BatchState& state)
+{
+	uint32_t threadCount = Globals::Instance->batchThreadCount;
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	if (threadCount == 1)
+	{
+		RunBatchWorker(state);
+	}
+	else
+	{
+		std::vector<std::thread> workers;
+		for (uint32_t i = 0; i < threadCount; i++)
+			workers.emplace_back(RunBatchWorker, std::ref(state));
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	return state.failed ? 1 : 0;
+}
+
+/**
+ * Runs every job of the batch list with the same config, on `-j` worker threads.
+ * Each non-empty line of the list (`-` for stdin) holds the per-job arguments, for example:
+ *     -i assets/xml/objects/object_am.xml -o assets/objects/object_am -gsf 1
+ * Only `-i`, `-o`, `-osf`, `-gsf`, `--base-address`, `--start-offset` and `--end-offset` are
+ * accepted there; anything else has to be passed once on the command line. Lines starting with
+ * `#` are ignored, and arguments are split on whitespace.
+ */
+int HandleBatchExtract(ExporterSet* exporterSet)
+{
+	if (Globals::Instance->batchListPath == "")
+	{
+		fprintf(stderr, "Error: batch mode requires a job list (-l PATH, or -l - for stdin)\n");
+		return 1;
+	}
+
+	std::ifstream listFile;
+	bool readStdin = Globals::Instance->batchListPath == "-";
+	if (!readStdin)
+	{
+		listFile.open(Globals::Instance->batchListPath);
+		if (!listFile.is_open())
+		{
+			fprintf(stderr, "Error: unable to open batch list '%s'\n",
+			        Globals::Instance->batchListPath.c_str());
+			return 1;
+		}
+	}
+
+	BatchState state;
+	state.list = readStdin ? &std::cin : &listFile;
+	state.exporterSet = exporterSet;
+
+	// Pooled textures shared by several jobs are only written once, and limb tables shared by
+	// several objects only parsed once
+	TextureRegistry textureRegistry;
+	LimbTableRegistry limbTableRegistry;
+	AnimationDataRegistry animationDataRegistry;
+	Globals::Instance->textureRegistry = &textureRegistry;
+	Globals::Instance->limbTableRegistry = &limbTableRegistry;
+	if (!Globals::Instance->animDedupReportPath.empty())
+		Globals::Instance->animationDataRegistry = &animationDataRegistry;
+	int returnCode = RunBatch(state);
+	Globals::Instance->textureRegistry = nullptr;
+	Globals::Instance->limbTableRegistry = nullptr;
+	Globals::Instance->animationDataRegistry = nullptr;
+
+	if (returnCode == 0 && !Globals::Instance->animDedupReportPath.empty())
+		animationDataRegistry.WriteReport(Globals::Instance->animDedupReportPath);
+
+	return returnCode;
+}
+
+/**
+ * Checks an XML, or every XML of a folder and its subfolders on `-j` worker threads like `batch`
+ * does, without writing anything: the files are parsed and go through every pass of extraction
+ * that warns, missing pointers and overlapping or unaccounted data included, but neither their
+ * source files nor their resources are saved, and the extraction cache isn't used.
+ */
+int HandleCheck(ExporterSet* exporterSet)
+{
+	const fs::path& inputPath = Globals::Job->inputPath;
+
+	if (!fs::is_directory(inputPath))
+	{
+		Globals::Instance->pngThreadCount = Globals::Instance->batchThreadCount;
+		return HandleExtract(ZFileMode::Check, exporterSet);
+	}
+
+	std::vector<std::string> xmlPaths;
+	for (const auto& entry : fs::recursive_directory_iterator(inputPath))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".xml")
+			xmlPaths.push_back(entry.path().string());
+	}
+	std::sort(xmlPaths.begin(), xmlPaths.end());
+
+	// The XMLs are checked as the jobs of a batch list, which splits its lines on whitespace
+	std::stringstream list;
+	for (const std::string& xmlPath : xmlPaths)
+		list << "-i " << xmlPath << "\n";
+
+	BatchState state;
+	state.list = &list;
+	state.exporterSet = exporterSet;
+	state.fileMode = ZFileMode::Check;
+
+	return RunBatch(state);
+}
+
+static std::string GetAssetTextureSource(const fs::path& pngFilePath, TextureType texType,
+                                         const fs::path& outPath)
 {
 	std::string name = outPath.stem().string();
 
@@ -506,27 +1005,411 @@ void BuildAssetTexture(const fs::path& pngFilePath, TextureType texType, const f
 	if (File::Exists(cfgPath))
 		name = File::ReadAllText(cfgPath);
 
-	std::string src = tex.GetBodySourceCode();
-
-	File::WriteAllText(outPath.string(), src);
+	return tex.GetBodySourceCode();
 }
 
-void BuildAssetBackground(const fs::path& imageFilePath, const fs::path& outPath)
+static std::string GetAssetBackgroundSource(const fs::path& imageFilePath)
 {
 	ZBackground background(nullptr);
 	background.ParseBinaryFile(imageFilePath.string(), false);
 
-	File::WriteAllText(outPath.string(), background.GetBodySourceCode());
+	return background.GetBodySourceCode();
+}
+
+static std::string GetAssetBlobSource(const fs::path& blobFilePath)
+{
+	std::unique_ptr<ZBlob> blob(ZBlob::FromFile(blobFilePath.string()));
+
+	return blob->GetBodySourceCode();
+}
+
+void BuildAssetTexture(const fs::path& pngFilePath, TextureType texType, const fs::path& outPath)
+{
+	File::WriteAllTextIfChanged(outPath, GetAssetTextureSource(pngFilePath, texType, outPath));
+}
+
+void BuildAssetBackground(const fs::path& imageFilePath, const fs::path& outPath)
+{
+	File::WriteAllTextIfChanged(outPath, GetAssetBackgroundSource(imageFilePath));
 }
 
 void BuildAssetBlob(const fs::path& blobFilePath, const fs::path& outPath)
 {
-	ZBlob* blob = ZBlob::FromFile(blobFilePath.string());
-	std::string name = outPath.stem().string();  // filename without extension
+	File::WriteAllTextIfChanged(outPath, GetAssetBlobSource(blobFilePath));
+}
+
+struct AssetJob
+{
+	ZFileMode fileMode;  // BuildTexture, BuildBlob or BuildBackground
+	TextureType texType;
+	fs::path inputPath, outputPath;
+};
+
+// An invalid name may be a warning escalated to an error, which is only reported here
+static TextureType GetAssetTextureType(const std::string& name)
+{
+	try
+	{
+		return ZTexture::GetTextureTypeFromString(name);
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "%s", e.what());
+		return TextureType::Error;
+	}
+}
+
+/**
+ * Reads the jobs of a `bassets` manifest. Each non-empty line holds the type of the asset, its
+ * input and its output, split on whitespace:
+ *     rgba16 assets/objects/object_am/a.rgba16.png build/assets/objects/object_am/a.rgba16.inc.c
+ * The type is either a texture format (as passed to `-tt`), `blob` or `background`. Lines starting
+ * with `#` are ignored.
+ */
+static bool ReadAssetManifest(std::istream& list, std::vector<AssetJob>& jobs)
+{
+	std::string line;
+
+	while (std::getline(list, line))
+	{
+		std::istringstream lineStream(line);
+		std::string type;
+		AssetJob job;
+
+		if (!(lineStream >> type) || type[0] == '#')
+			continue;
+
+		if (!(lineStream >> job.inputPath >> job.outputPath))
+		{
+			fprintf(stderr, "Error: invalid asset manifest line '%s'\n", line.c_str());
+			return false;
+		}
+
+		job.texType = TextureType::Error;
+		if (type == "blob")
+			job.fileMode = ZFileMode::BuildBlob;
+		else if (type == "background")
+			job.fileMode = ZFileMode::BuildBackground;
+		else
+		{
+			job.fileMode = ZFileMode::BuildTexture;
+			job.texType = GetAssetTextureType(type);
+			if (job.texType == TextureType::Error)
+			{
+				fprintf(stderr, "Error: invalid asset type '%s'\n", type.c_str());
+				return false;
+			}
+		}
+
+		jobs.push_back(job);
+	}
+
+	return true;
+}
+
+/**
+ * Lists the assets of a directory (not recursively) the same way the build names them:
+ * `NAME.FORMAT.png` is a texture of that format built to `NAME.FORMAT.inc.c`, `NAME.bin` is a blob
+ * built to `NAME.bin.inc.c` and `NAME.jpg` is a background built to `NAME.jpg.inc.c`.
+ */
+static bool ListAssetDirectory(const fs::path& inputDir, const fs::path& outputDir,
+                               std::vector<AssetJob>& jobs)
+{
+	for (const auto& entry : fs::directory_iterator(inputDir))
+	{
+		if (!entry.is_regular_file())
+			continue;
+
+		const fs::path& inputPath = entry.path();
+		std::string extension = inputPath.extension().string();
+		AssetJob job;
+
+		job.texType = TextureType::Error;
+		job.inputPath = inputPath;
+		if (extension == ".png")
+		{
+			std::string format = inputPath.stem().extension().string();
+
+			job.fileMode = ZFileMode::BuildTexture;
+			job.outputPath = outputDir / (inputPath.stem().string() + ".inc.c");
+			if (format.size() > 1)
+				job.texType = GetAssetTextureType(format.substr(1));
+			if (job.texType == TextureType::Error)
+			{
+				fprintf(stderr, "Error: no texture format in the name of '%s'\n",
+				        inputPath.c_str());
+				return false;
+			}
+		}
+		else if (extension == ".bin")
+		{
+			job.fileMode = ZFileMode::BuildBlob;
+			job.outputPath = outputDir / (inputPath.filename().string() + ".inc.c");
+		}
+		else if (extension == ".jpg")
+		{
+			job.fileMode = ZFileMode::BuildBackground;
+			job.outputPath = outputDir / (inputPath.filename().string() + ".inc.c");
+		}
+		else
+			continue;
+
+		jobs.push_back(job);
+	}
+
+	return true;
+}
+
+struct AssetBuildState
+{
+	const std::vector<AssetJob>* jobs;
+	std::atomic<size_t> nextJob = 0;
+	std::atomic<bool> failed = false;
+};
 
-	std::string src = blob->GetBodySourceCode();
+static void RunAssetWorker(AssetBuildState& state)
+{
+	JobContext* prevJob = Globals::Job;
+	JobContext workerJob;
+	workerJob.InheritSettings(Globals::Instance->mainJob);
+	Globals::Job = &workerJob;
+
+	for (size_t i = state.nextJob++; i < state.jobs->size(); i = state.nextJob++)
+	{
+		const AssetJob& job = (*state.jobs)[i];
+		workerJob.inputPath = job.inputPath;
+		workerJob.outputPath = job.outputPath;
+
+		try
+		{
+			std::string src;
+			if (job.fileMode == ZFileMode::BuildTexture)
+				src = GetAssetTextureSource(job.inputPath, job.texType, job.outputPath);
+			else if (job.fileMode == ZFileMode::BuildBackground)
+				src = GetAssetBackgroundSource(job.inputPath);
+			else
+				src = GetAssetBlobSource(job.inputPath);
+
+			if (File::WriteAllTextIfChanged(job.outputPath, src) &&
+			    Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
+				printf("Built '%s'\n", job.outputPath.c_str());
+		}
+		catch (const std::exception& e)
+		{
+			// Keep building the other assets, so a single run reports every broken one
+			fprintf(stderr, "%s: %s", job.inputPath.c_str(), e.what());
+			state.failed = true;
+		}
+	}
+
+	Globals::Job = prevJob;
+}
 
-	File::WriteAllText(outPath.string(), src);
+/**
+ * Builds many texture, blob and background assets in one run, on `-j` worker threads. The assets
+ * come either from a manifest (`-l PATH`, or `-l -` for stdin, see ReadAssetManifest) or from every
+ * asset of the `-i` directory, built to the `-o` directory (see ListAssetDirectory).
+ * Outputs whose content would not change are left untouched, so their timestamps only move when
+ * the generated source does.
+ */
+int HandleBuildAssets()
+{
+	std::vector<AssetJob> jobs;
+
+	if (Globals::Instance->batchListPath != "")
+	{
+		bool readStdin = Globals::Instance->batchListPath == "-";
+		std::ifstream listFile;
+
+		if (!readStdin)
+		{
+			listFile.open(Globals::Instance->batchListPath);
+			if (!listFile.is_open())
+			{
+				fprintf(stderr, "Error: unable to open asset manifest '%s'\n",
+				        Globals::Instance->batchListPath.c_str());
+				return 1;
+			}
+		}
+
+		if (!ReadAssetManifest(readStdin ? std::cin : listFile, jobs))
+			return 1;
+	}
+	else
+	{
+		const fs::path& inputDir = Globals::Job->inputPath;
+		const fs::path& outputDir = Globals::Job->outputPath;
+
+		if (!Directory::Exists(inputDir) || outputDir.empty())
+		{
+			fprintf(stderr, "Error: bassets mode requires an asset manifest (-l PATH) or an "
+			                "input directory (-i) and an output directory (-o)\n");
+			return 1;
+		}
+
+		if (!ListAssetDirectory(inputDir, outputDir, jobs))
+			return 1;
+
+		if (!jobs.empty() && !Directory::Exists(outputDir))
+			Directory::CreateDirectory(outputDir.string());
+	}
+
+	AssetBuildState state;
+	state.jobs = &jobs;
+
+	uint32_t threadCount = Globals::Instance->batchThreadCount;
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	threadCount = std::min<size_t>(threadCount, std::max<size_t>(jobs.size(), 1));
+
+	if (threadCount == 1)
+	{
+		RunAssetWorker(state);
+	}
+	else
+	{
+		std::vector<std::thread> workers;
+		for (uint32_t i = 0; i < threadCount; i++)
+			workers.emplace_back(RunAssetWorker, std::ref(state));
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	return state.failed ? 1 : 0;
+}
+
+/* C API of libzapd, see LibZapd.h */
+
+static Globals* sLibGlobals = nullptr;
+static bool sLibInitialized = false;
+// The arguments of zapd_init, which the exporter may keep pointers into
+static std::vector<std::string> sLibArgs;
+
+int zapd_init(const char* configPath, int argc, const char* const* argv)
+{
+	if (sLibInitialized)
+	{
+		fprintf(stderr, "Error: zapd_init can only be called once\n");
+		return 1;
+	}
+	sLibInitialized = true;
+
+	// Handled like the command line of ZAPD.out in `e` mode, with the config read last
+	sLibArgs = {"libzapd", "e"};
+	for (int i = 0; i < argc; i++)
+		sLibArgs.push_back(argv[i]);
+	sLibArgs.push_back("-rconf");
+	sLibArgs.push_back(configPath);
+
+	std::vector<char*> libArgv;
+	for (std::string& arg : sLibArgs)
+		libArgv.push_back(arg.data());
+	libArgv.push_back(nullptr);
+	int libArgc = sLibArgs.size();
+
+	try
+	{
+		sLibGlobals = new Globals();
+		WarningHandler::Init(libArgc, libArgv.data());
+		ParseArgs(libArgc, libArgv.data());
+
+		ExporterSet* exporterSet = Globals::Instance->GetExporterSet();
+		if (exporterSet != nullptr && exporterSet->parseArgsFunc != nullptr)
+		{
+			for (int32_t i = 2; i < libArgc; i++)
+				exporterSet->parseArgsFunc(libArgc, libArgv.data(), i);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "%s", e.what());
+		return 1;
+	}
+
+	// The external XMLs stay parsed from one extraction to the next
+	sUseExternalXmlCache = true;
+	return 0;
+}
+
+int zapd_extract(const char* xmlPath, const char* baseromPath, const char* outPath,
+                 const char* sourceOutPath, int genSourceFile)
+{
+	if (sLibGlobals == nullptr)
+		return 1;
+
+	JobContext* prevJob = Globals::Job;
+	JobContext job;
+	job.InheritSettings(Globals::Instance->mainJob);
+	job.inputPath = xmlPath;
+	job.outputPath = outPath;
+	job.sourceOutputPath = sourceOutPath;
+	job.genSourceFile = genSourceFile != 0;
+	Globals::Instance->baseRomPath = baseromPath;
+	Globals::Job = &job;
+
+	int returnCode;
+	try
+	{
+		returnCode = HandleExtract(ZFileMode::Extract, Globals::Instance->GetExporterSet());
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "%s: %s", job.inputPath.c_str(), e.what());
+		returnCode = 1;
+	}
+
+	ReleaseCachedExternalFiles(job);
+	Globals::Job = prevJob;
+	return returnCode;
+}
+
+int zapd_build_texture(const char* pngPath, const char* outPath)
+{
+	if (sLibGlobals == nullptr)
+		return 1;
+
+	fs::path inputPath = pngPath;
+	std::string format = inputPath.stem().extension().string();
+	TextureType texType = TextureType::Error;
+	if (format.size() > 1)
+		texType = GetAssetTextureType(format.substr(1));
+	if (texType == TextureType::Error)
+	{
+		fprintf(stderr, "Error: no texture format in the name of '%s'\n", pngPath);
+		return 1;
+	}
+
+	JobContext* prevJob = Globals::Job;
+	JobContext job;
+	job.InheritSettings(Globals::Instance->mainJob);
+	job.inputPath = inputPath;
+	job.outputPath = outPath;
+	Globals::Job = &job;
+
+	int returnCode = 0;
+	try
+	{
+		File::WriteAllTextIfChanged(outPath, GetAssetTextureSource(inputPath, texType, outPath));
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "%s: %s", pngPath, e.what());
+		returnCode = 1;
+	}
+
+	Globals::Job = prevJob;
+	return returnCode;
+}
+
+void zapd_teardown(void)
+{
+	if (sLibGlobals == nullptr)
+		return;
+
+	ClearExternalXmlCache();
+	if (WarningHandler::countOnly)
+		WarningHandler::PrintWarningsDebugInfo();
 
-	delete blob;
+	delete sLibGlobals;
+	sLibGlobals = nullptr;
 }
@@ -33,7 +33,7 @@ const std::unordered_map<CutsceneMM_CommandType, CsCommandListDescriptor> csComm
 };
 
 CutsceneMMSubCommandEntry_GenericCmd::CutsceneMMSubCommandEntry_GenericCmd(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex, CutsceneMM_CommandType cmdId)
+	const DataView& rawData, offset_t rawDataIndex, CutsceneMM_CommandType cmdId)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex), commandId(cmdId)
 {
 }
@@ -97,7 +97,7 @@ std::string CutsceneMMSubCommandEntry_GenericCmd::GetBodySourceCode() const
 	return StringHelper::Sprintf(entryFmt.c_str(), base, startFrame, endFrame, pad);
 }
 
-CutsceneMMCommand_GenericCmd::CutsceneMMCommand_GenericCmd(const std::vector<uint8_t>& rawData,
+CutsceneMMCommand_GenericCmd::CutsceneMMCommand_GenericCmd(const DataView& rawData,
                                                            offset_t rawDataIndex,
                                                            CutsceneMM_CommandType cmdId)
 	: CutsceneCommand(rawData, rawDataIndex)
@@ -130,7 +130,7 @@ std::string CutsceneMMCommand_GenericCmd::GetCommandMacro() const
 /**** CAMERA ****/
 
 CutsceneSubCommandEntry_SplineCamPoint::CutsceneSubCommandEntry_SplineCamPoint(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	interpType = BitConverter::ToUInt8BE(rawData, rawDataIndex + 0);
@@ -158,7 +158,7 @@ size_t CutsceneSubCommandEntry_SplineCamPoint::GetRawSize() const
 }
 
 CutsceneSubCommandEntry_SplineMiscPoint::CutsceneSubCommandEntry_SplineMiscPoint(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	unused0 = BitConverter::ToUInt16BE(rawData, rawDataIndex + 0);
@@ -179,7 +179,7 @@ size_t CutsceneSubCommandEntry_SplineMiscPoint::GetRawSize() const
 }
 
 CutsceneSubCommandEntry_SplineHeader::CutsceneSubCommandEntry_SplineHeader(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	numEntries = BitConverter::ToUInt16BE(rawData, rawDataIndex + 0);
@@ -200,7 +200,7 @@ size_t CutsceneSubCommandEntry_SplineHeader::GetRawSize() const
 }
 
 CutsceneSubCommandEntry_SplineFooter::CutsceneSubCommandEntry_SplineFooter(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	uint16_t firstHalfWord = BitConverter::ToUInt16BE(rawData, rawDataIndex);
@@ -225,7 +225,7 @@ size_t CutsceneSubCommandEntry_SplineFooter::GetRawSize() const
 	return 0x04;
 }
 
-CutsceneMMCommand_Spline::CutsceneMMCommand_Spline(const std::vector<uint8_t>& rawData,
+CutsceneMMCommand_Spline::CutsceneMMCommand_Spline(const DataView& rawData,
                                                    offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
@@ -289,7 +289,7 @@ size_t CutsceneMMCommand_Spline::GetCommandSize() const
 /**** TRANSITION GENERAL ****/
 
 CutsceneSubCommandEntry_TransitionGeneral::CutsceneSubCommandEntry_TransitionGeneral(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	unk_06 = BitConverter::ToUInt8BE(rawData, rawDataIndex + 0x06);
@@ -319,7 +319,7 @@ size_t CutsceneSubCommandEntry_TransitionGeneral::GetRawSize() const
 }
 
 CutsceneMMCommand_TransitionGeneral::CutsceneMMCommand_TransitionGeneral(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
 	rawDataIndex += 4;
@@ -339,7 +339,7 @@ std::string CutsceneMMCommand_TransitionGeneral::GetCommandMacro() const
 }
 
 CutsceneSubCommandEntry_FadeOutSeq::CutsceneSubCommandEntry_FadeOutSeq(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	unk_08 = BitConverter::ToUInt32BE(rawData, rawDataIndex + 8);
@@ -364,7 +364,7 @@ size_t CutsceneSubCommandEntry_FadeOutSeq::GetRawSize() const
 	return 0x0C;
 }
 
-CutsceneMMCommand_FadeOutSeq::CutsceneMMCommand_FadeOutSeq(const std::vector<uint8_t>& rawData,
+CutsceneMMCommand_FadeOutSeq::CutsceneMMCommand_FadeOutSeq(const DataView& rawData,
                                                            offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
@@ -387,13 +387,13 @@ std::string CutsceneMMCommand_FadeOutSeq::GetCommandMacro() const
 /**** NON IMPLEMENTED ****/
 
 CutsceneSubCommandEntry_NonImplemented::CutsceneSubCommandEntry_NonImplemented(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 }
 
 CutsceneMMCommand_NonImplemented::CutsceneMMCommand_NonImplemented(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
 	rawDataIndex += 4;
@@ -410,7 +410,7 @@ CutsceneMMCommand_NonImplemented::CutsceneMMCommand_NonImplemented(
 /**** RUMBLE ****/
 
 CutsceneMMSubCommandEntry_Rumble::CutsceneMMSubCommandEntry_Rumble(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	intensity = BitConverter::ToUInt8BE(rawData, rawDataIndex + 0x06);
@@ -436,7 +436,7 @@ size_t CutsceneMMSubCommandEntry_Rumble::GetRawSize() const
 	return 0x0C;
 }
 
-CutsceneMMCommand_Rumble::CutsceneMMCommand_Rumble(const std::vector<uint8_t>& rawData,
+CutsceneMMCommand_Rumble::CutsceneMMCommand_Rumble(const DataView& rawData,
                                                    offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
@@ -458,7 +458,7 @@ std::string CutsceneMMCommand_Rumble::GetCommandMacro() const
 
 /**** TEXT ****/
 
-CutsceneMMSubCommandEntry_Text::CutsceneMMSubCommandEntry_Text(const std::vector<uint8_t>& rawData,
+CutsceneMMSubCommandEntry_Text::CutsceneMMSubCommandEntry_Text(const DataView& rawData,
                                                                offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
@@ -515,7 +515,7 @@ size_t CutsceneMMSubCommandEntry_Text::GetRawSize() const
 	return 0x0C;
 }
 
-CutsceneMMCommand_Text::CutsceneMMCommand_Text(const std::vector<uint8_t>& rawData,
+CutsceneMMCommand_Text::CutsceneMMCommand_Text(const DataView& rawData,
                                                offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
@@ -538,7 +538,7 @@ std::string CutsceneMMCommand_Text::GetCommandMacro() const
 /**** ACTOR CUE ****/
 
 CutsceneMMSubCommandEntry_ActorCue::CutsceneMMSubCommandEntry_ActorCue(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	rotX = BitConverter::ToUInt16BE(rawData, rawDataIndex + 0x6);
@@ -589,7 +589,7 @@ size_t CutsceneMMSubCommandEntry_ActorCue::GetRawSize() const
 	return 0x30;
 }
 
-CutsceneMMCommand_ActorCue::CutsceneMMCommand_ActorCue(const std::vector<uint8_t>& rawData,
+CutsceneMMCommand_ActorCue::CutsceneMMCommand_ActorCue(const DataView& rawData,
                                                        offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
@@ -249,7 +249,7 @@ class CutsceneMMSubCommandEntry_GenericCmd : public CutsceneSubCommandEntry
 public:
 	CutsceneMM_CommandType commandId;
 
-	CutsceneMMSubCommandEntry_GenericCmd(const std::vector<uint8_t>& rawData, offset_t rawDataIndex,
+	CutsceneMMSubCommandEntry_GenericCmd(const DataView& rawData, offset_t rawDataIndex,
 	                                     CutsceneMM_CommandType cmdId);
 
 	std::string GetBodySourceCode() const override;
@@ -258,7 +258,7 @@ public:
 class CutsceneMMCommand_GenericCmd : public CutsceneCommand
 {
 public:
-	CutsceneMMCommand_GenericCmd(const std::vector<uint8_t>& rawData, offset_t rawDataIndex,
+	CutsceneMMCommand_GenericCmd(const DataView& rawData, offset_t rawDataIndex,
 	                             CutsceneMM_CommandType cmdId);
 
 	std::string GetCommandMacro() const override;
@@ -282,7 +282,7 @@ public:
 	uint16_t posZ;
 	uint16_t relTo;
 
-	CutsceneSubCommandEntry_SplineCamPoint(const std::vector<uint8_t>& rawData,
+	CutsceneSubCommandEntry_SplineCamPoint(const DataView& rawData,
 	                                       offset_t rawDataIndex);
 
 	std::string GetBodySourceCode() const override;
@@ -298,7 +298,7 @@ public:
 	uint16_t fov;
 	uint16_t unused1;
 
-	CutsceneSubCommandEntry_SplineMiscPoint(const std::vector<uint8_t>& rawData,
+	CutsceneSubCommandEntry_SplineMiscPoint(const DataView& rawData,
 	                                        offset_t rawDataIndex);
 
 	std::string GetBodySourceCode() const override;
@@ -309,7 +309,7 @@ public:
 class CutsceneSubCommandEntry_SplineFooter : public CutsceneSubCommandEntry
 {
 public:
-	CutsceneSubCommandEntry_SplineFooter(const std::vector<uint8_t>& rawData,
+	CutsceneSubCommandEntry_SplineFooter(const DataView& rawData,
 	                                     offset_t rawDataIndex);
 
 	std::string GetBodySourceCode() const override;
@@ -324,7 +324,7 @@ public:
 	uint16_t unused0;
 	uint16_t unused1;
 	uint16_t duration;
-	CutsceneSubCommandEntry_SplineHeader(const std::vector<uint8_t>& rawData,
+	CutsceneSubCommandEntry_SplineHeader(const DataView& rawData,
 	                                     offset_t rawDataIndex);
 
 	std::string GetBodySourceCode() const override;
@@ -337,7 +337,7 @@ class CutsceneMMCommand_Spline : public CutsceneCommand
 public:
 	uint32_t numHeaders;
 	uint32_t totalCommands;
-	CutsceneMMCommand_Spline(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneMMCommand_Spline(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetCommandMacro() const override;
 	size_t GetCommandSize() const override;
@@ -355,7 +355,7 @@ public:
 	uint8_t unk_0A;
 	uint8_t unk_0B;
 
-	CutsceneSubCommandEntry_TransitionGeneral(const std::vector<uint8_t>& rawData,
+	CutsceneSubCommandEntry_TransitionGeneral(const DataView& rawData,
 	                                          offset_t rawDataIndex);
 
 	std::string GetBodySourceCode() const override;
@@ -366,7 +366,7 @@ public:
 class CutsceneMMCommand_TransitionGeneral : public CutsceneCommand
 {
 public:
-	CutsceneMMCommand_TransitionGeneral(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneMMCommand_TransitionGeneral(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetCommandMacro() const override;
 };
@@ -378,7 +378,7 @@ class CutsceneSubCommandEntry_FadeOutSeq : public CutsceneSubCommandEntry
 public:
 	uint32_t unk_08;
 
-	CutsceneSubCommandEntry_FadeOutSeq(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneSubCommandEntry_FadeOutSeq(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetBodySourceCode() const override;
 
@@ -388,7 +388,7 @@ public:
 class CutsceneMMCommand_FadeOutSeq : public CutsceneCommand
 {
 public:
-	CutsceneMMCommand_FadeOutSeq(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneMMCommand_FadeOutSeq(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetCommandMacro() const override;
 };
@@ -398,14 +398,14 @@ public:
 class CutsceneSubCommandEntry_NonImplemented : public CutsceneSubCommandEntry
 {
 public:
-	CutsceneSubCommandEntry_NonImplemented(const std::vector<uint8_t>& rawData,
+	CutsceneSubCommandEntry_NonImplemented(const DataView& rawData,
 	                                       offset_t rawDataIndex);
 };
 
 class CutsceneMMCommand_NonImplemented : public CutsceneCommand
 {
 public:
-	CutsceneMMCommand_NonImplemented(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneMMCommand_NonImplemented(const DataView& rawData, offset_t rawDataIndex);
 };
 
 /**** RUMBLE ****/
@@ -417,7 +417,7 @@ public:
 	uint8_t decayTimer;
 	uint8_t decayStep;
 
-	CutsceneMMSubCommandEntry_Rumble(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneMMSubCommandEntry_Rumble(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetBodySourceCode() const override;
 
@@ -427,7 +427,7 @@ public:
 class CutsceneMMCommand_Rumble : public CutsceneCommand
 {
 public:
-	CutsceneMMCommand_Rumble(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneMMCommand_Rumble(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetCommandMacro() const override;
 };
@@ -441,7 +441,7 @@ public:
 	uint16_t textId1;
 	uint16_t textId2;
 
-	CutsceneMMSubCommandEntry_Text(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneMMSubCommandEntry_Text(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetBodySourceCode() const override;
 
@@ -451,7 +451,7 @@ public:
 class CutsceneMMCommand_Text : public CutsceneCommand
 {
 public:
-	CutsceneMMCommand_Text(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneMMCommand_Text(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetCommandMacro() const override;
 };
@@ -466,7 +466,7 @@ public:
 	int32_t endPosX, endPosY, endPosZ;
 	float normalX, normalY, normalZ;
 
-	CutsceneMMSubCommandEntry_ActorCue(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneMMSubCommandEntry_ActorCue(const DataView& rawData, offset_t rawDataIndex);
 	std::string GetBodySourceCode() const override;
 
 	size_t GetRawSize() const override;
@@ -475,7 +475,7 @@ public:
 class CutsceneMMCommand_ActorCue : public CutsceneCommand
 {
 public:
-	CutsceneMMCommand_ActorCue(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneMMCommand_ActorCue(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetCommandMacro() const override;
 };
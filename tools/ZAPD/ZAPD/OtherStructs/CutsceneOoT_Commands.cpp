@@ -25,7 +25,7 @@ const std::unordered_map<CutsceneOoT_CommandType, CsCommandListDescriptor> csCom
 };
 
 CutsceneOoTSubCommandEntry_GenericCmd::CutsceneOoTSubCommandEntry_GenericCmd(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex, CutsceneOoT_CommandType cmdId)
+	const DataView& rawData, offset_t rawDataIndex, CutsceneOoT_CommandType cmdId)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex), commandId(cmdId)
 {
 	word0 = BitConverter::ToUInt32BE(rawData, rawDataIndex + 0x0);
@@ -87,7 +87,7 @@ size_t CutsceneOoTSubCommandEntry_GenericCmd::GetRawSize() const
 	return 0x30;
 }
 
-CutsceneOoTCommand_GenericCmd::CutsceneOoTCommand_GenericCmd(const std::vector<uint8_t>& rawData,
+CutsceneOoTCommand_GenericCmd::CutsceneOoTCommand_GenericCmd(const DataView& rawData,
                                                              offset_t rawDataIndex,
                                                              CutsceneOoT_CommandType cmdId)
 	: CutsceneCommand(rawData, rawDataIndex)
@@ -119,7 +119,7 @@ std::string CutsceneOoTCommand_GenericCmd::GetCommandMacro() const
 
 /**** CAMERA ****/
 
-CutsceneOoTCommand_CameraPoint::CutsceneOoTCommand_CameraPoint(const std::vector<uint8_t>& rawData,
+CutsceneOoTCommand_CameraPoint::CutsceneOoTCommand_CameraPoint(const DataView& rawData,
                                                                offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
@@ -154,7 +154,7 @@ size_t CutsceneOoTCommand_CameraPoint::GetRawSize() const
 }
 
 CutsceneOoTCommand_GenericCameraCmd::CutsceneOoTCommand_GenericCameraCmd(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
 	base = BitConverter::ToUInt16BE(rawData, rawDataIndex + 0);
@@ -214,7 +214,7 @@ size_t CutsceneOoTCommand_GenericCameraCmd::GetCommandSize() const
 /**** RUMBLE ****/
 
 CutsceneOoTSubCommandEntry_Rumble::CutsceneOoTSubCommandEntry_Rumble(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	sourceStrength = BitConverter::ToUInt8BE(rawData, rawDataIndex + 0x06);
@@ -237,7 +237,7 @@ size_t CutsceneOoTSubCommandEntry_Rumble::GetRawSize() const
 	return 0x0C;
 }
 
-CutsceneOoTCommand_Rumble::CutsceneOoTCommand_Rumble(const std::vector<uint8_t>& rawData,
+CutsceneOoTCommand_Rumble::CutsceneOoTCommand_Rumble(const DataView& rawData,
                                                      offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
@@ -260,7 +260,7 @@ std::string CutsceneOoTCommand_Rumble::GetCommandMacro() const
 /**** TEXT ****/
 
 CutsceneOoTSubCommandEntry_Text::CutsceneOoTSubCommandEntry_Text(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	type = BitConverter::ToUInt16BE(rawData, rawDataIndex + 0x6);
@@ -299,7 +299,7 @@ size_t CutsceneOoTSubCommandEntry_Text::GetRawSize() const
 	return 0x0C;
 }
 
-CutsceneOoTCommand_Text::CutsceneOoTCommand_Text(const std::vector<uint8_t>& rawData,
+CutsceneOoTCommand_Text::CutsceneOoTCommand_Text(const DataView& rawData,
                                                  offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
@@ -322,7 +322,7 @@ std::string CutsceneOoTCommand_Text::GetCommandMacro() const
 /**** ACTOR CUE ****/
 
 CutsceneOoTSubCommandEntry_ActorCue::CutsceneOoTSubCommandEntry_ActorCue(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	rotX = BitConverter::ToUInt16BE(rawData, rawDataIndex + 0x6);
@@ -374,7 +374,7 @@ size_t CutsceneOoTSubCommandEntry_ActorCue::GetRawSize() const
 	return 0x30;
 }
 
-CutsceneOoTCommand_ActorCue::CutsceneOoTCommand_ActorCue(const std::vector<uint8_t>& rawData,
+CutsceneOoTCommand_ActorCue::CutsceneOoTCommand_ActorCue(const DataView& rawData,
                                                          offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
@@ -410,7 +410,7 @@ std::string CutsceneOoTCommand_ActorCue::GetCommandMacro() const
 
 /**** DESTINATION ****/
 
-CutsceneOoTCommand_Destination::CutsceneOoTCommand_Destination(const std::vector<uint8_t>& rawData,
+CutsceneOoTCommand_Destination::CutsceneOoTCommand_Destination(const DataView& rawData,
                                                                offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
@@ -442,7 +442,7 @@ size_t CutsceneOoTCommand_Destination::GetCommandSize() const
 
 /**** TRANSITION ****/
 
-CutsceneOoTCommand_Transition::CutsceneOoTCommand_Transition(const std::vector<uint8_t>& rawData,
+CutsceneOoTCommand_Transition::CutsceneOoTCommand_Transition(const DataView& rawData,
                                                              offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
@@ -1,10 +1,60 @@
 #include "Cutscene_Common.h"
+
+#include <cstddef>
+#include <stdexcept>
+
 #include "Utils/BitConverter.h"
 #include "Utils/StringHelper.h"
 
+/* CutscenePool */
+
+thread_local CutscenePool* CutscenePool::current = nullptr;
+
+CutscenePool::Scope::Scope(CutscenePool& pool) : previous(current)
+{
+	current = &pool;
+}
+
+CutscenePool::Scope::~Scope()
+{
+	current = previous;
+}
+
+void* CutscenePool::Allocate(size_t size)
+{
+	constexpr size_t align = alignof(std::max_align_t);
+
+	size = (size + align - 1) & ~(align - 1);
+
+	// Whatever doesn't fit in a block gets one of its own, the current block stays in use
+	if (size > BlockSize)
+	{
+		largeBlocks.emplace_back(new uint8_t[size]);
+		return largeBlocks.back().get();
+	}
+
+	if (blockUsed + size > BlockSize)
+	{
+		blocks.emplace_back(new uint8_t[BlockSize]);
+		blockUsed = 0;
+	}
+
+	void* ptr = blocks.back().get() + blockUsed;
+	blockUsed += size;
+	return ptr;
+}
+
+void* CutscenePool::AllocateCurrent(size_t size)
+{
+	if (current == nullptr)
+		throw std::logic_error("CutscenePool: cutscene command created without a current pool");
+
+	return current->Allocate(size);
+}
+
 /* CutsceneSubCommandEntry */
 
-CutsceneSubCommandEntry::CutsceneSubCommandEntry(const std::vector<uint8_t>& rawData,
+CutsceneSubCommandEntry::CutsceneSubCommandEntry(const DataView& rawData,
                                                  offset_t rawDataIndex)
 {
 	base = BitConverter::ToUInt16BE(rawData, rawDataIndex + 0);
@@ -26,7 +76,7 @@ size_t CutsceneSubCommandEntry::GetRawSize() const
 
 /* CutsceneCommand */
 
-CutsceneCommand::CutsceneCommand(const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+CutsceneCommand::CutsceneCommand(const DataView& rawData, offset_t rawDataIndex)
 {
 	numEntries = BitConverter::ToUInt32BE(rawData, rawDataIndex + 0);
 }
@@ -88,7 +138,7 @@ void CutsceneCommand::SetCommandID(uint32_t nCommandID)
 /*** TIME ****/
 
 CutsceneSubCommandEntry_SetTime::CutsceneSubCommandEntry_SetTime(
-	const std::vector<uint8_t>& rawData, offset_t rawDataIndex)
+	const DataView& rawData, offset_t rawDataIndex)
 	: CutsceneSubCommandEntry(rawData, rawDataIndex)
 {
 	hour = BitConverter::ToUInt8BE(rawData, rawDataIndex + 6);
@@ -107,7 +157,7 @@ size_t CutsceneSubCommandEntry_SetTime::GetRawSize() const
 	return 0x0C;
 }
 
-CutsceneCommand_Time::CutsceneCommand_Time(const std::vector<uint8_t>& rawData,
+CutsceneCommand_Time::CutsceneCommand_Time(const DataView& rawData,
                                            offset_t rawDataIndex)
 	: CutsceneCommand(rawData, rawDataIndex)
 {
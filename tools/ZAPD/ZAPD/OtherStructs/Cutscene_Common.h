@@ -1,9 +1,11 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include "Declaration.h"
+#include "Utils/DataView.h"
 
 typedef struct CsCommandListDescriptor
 {
@@ -11,6 +13,44 @@ typedef struct CsCommandListDescriptor
 	const char* args;
 } CsCommandListDescriptor;
 
+/**
+ * Memory for the commands of a cutscene and their entries, many small objects that all go away
+ * with the cutscene. While a pool is made current with a CutscenePool::Scope, `new` of a command
+ * or an entry takes memory from it instead of the heap and `delete` only runs the destructor, the
+ * memory being freed with the pool.
+ */
+class CutscenePool
+{
+public:
+	class Scope
+	{
+	public:
+		Scope(CutscenePool& pool);
+		~Scope();
+
+	private:
+		CutscenePool* previous;
+	};
+
+	CutscenePool() = default;
+	CutscenePool(const CutscenePool&) = delete;
+	CutscenePool& operator=(const CutscenePool&) = delete;
+
+	void* Allocate(size_t size);
+
+	// Allocates from the current pool, commands and entries can't be created without one
+	static void* AllocateCurrent(size_t size);
+
+private:
+	static constexpr size_t BlockSize = 0x10000;
+
+	std::vector<std::unique_ptr<uint8_t[]>> blocks;
+	std::vector<std::unique_ptr<uint8_t[]>> largeBlocks;
+	size_t blockUsed = BlockSize;
+
+	static thread_local CutscenePool* current;
+};
+
 class CutsceneSubCommandEntry
 {
 public:
@@ -21,9 +61,12 @@ public:
 
 	uint32_t commandID;
 
-	CutsceneSubCommandEntry(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneSubCommandEntry(const DataView& rawData, offset_t rawDataIndex);
 	virtual ~CutsceneSubCommandEntry() = default;
 
+	static void* operator new(size_t size) { return CutscenePool::AllocateCurrent(size); }
+	static void operator delete([[maybe_unused]] void* ptr) {}
+
 	virtual std::string GetBodySourceCode() const;
 
 	virtual size_t GetRawSize() const;
@@ -38,9 +81,12 @@ public:
 	uint32_t numEntries;
 	std::vector<CutsceneSubCommandEntry*> entries;
 
-	CutsceneCommand(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneCommand(const DataView& rawData, offset_t rawDataIndex);
 	virtual ~CutsceneCommand();
 
+	static void* operator new(size_t size) { return CutscenePool::AllocateCurrent(size); }
+	static void operator delete([[maybe_unused]] void* ptr) {}
+
 	virtual std::string GetCommandMacro() const;
 	virtual std::string GenerateSourceCode() const;
 	virtual size_t GetCommandSize() const;
@@ -56,7 +102,7 @@ public:
 	uint8_t hour;
 	uint8_t minute;
 
-	CutsceneSubCommandEntry_SetTime(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneSubCommandEntry_SetTime(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetBodySourceCode() const override;
 
@@ -66,7 +112,7 @@ public:
 class CutsceneCommand_Time : public CutsceneCommand
 {
 public:
-	CutsceneCommand_Time(const std::vector<uint8_t>& rawData, offset_t rawDataIndex);
+	CutsceneCommand_Time(const DataView& rawData, offset_t rawDataIndex);
 
 	std::string GetCommandMacro() const override;
 };
@@ -203,9 +203,9 @@ std::string SkinLimbModif::GetBodySourceCode() const
 {
 	std::string skinVertices_Str;
 	std::string unk_C_Str;
-	Globals::Instance->GetSegmentedPtrName(skinVertices, parent, "SkinVertex", skinVertices_Str);
-	Globals::Instance->GetSegmentedPtrName(limbTransformations, parent, "SkinTransformation",
-	                                       unk_C_Str);
+	Globals::Job->GetSegmentedPtrName(skinVertices, parent, "SkinVertex", skinVertices_Str);
+	Globals::Job->GetSegmentedPtrName(limbTransformations, parent, "SkinTransformation",
+	                                  unk_C_Str);
 
 	std::string entryStr = StringHelper::Sprintf("\n\t\tARRAY_COUNTU(%s), ARRAY_COUNTU(%s),\n",
 	                                             skinVertices_Str.c_str(), unk_C_Str.c_str());
@@ -307,7 +307,7 @@ void SkinAnimatedLimbData::DeclareReferences(const std::string& prefix)
 
 		int32_t dlistLength = ZDisplayList::GetDListLength(
 			parent->GetRawData(), dlist_Offset,
-			Globals::Instance->game == ZGame::OOT_SW97 ? DListType::F3DEX : DListType::F3DZEX);
+			Globals::Job->game == ZGame::OOT_SW97 ? DListType::F3DEX : DListType::F3DZEX);
 		ZDisplayList* dlist_data = new ZDisplayList(parent);
 		dlist_data->ExtractFromBinary(dlist_Offset, dlistLength);
 
@@ -324,9 +324,9 @@ std::string SkinAnimatedLimbData::GetBodySourceCode() const
 {
 	std::string limbModifications_Str;
 	std::string dlist_Str;
-	Globals::Instance->GetSegmentedPtrName(limbModifications, parent, "SkinLimbModif",
-	                                       limbModifications_Str);
-	Globals::Instance->GetSegmentedPtrName(dlist, parent, "Gfx", dlist_Str);
+	Globals::Job->GetSegmentedPtrName(limbModifications, parent, "SkinLimbModif",
+	                                  limbModifications_Str);
+	Globals::Job->GetSegmentedPtrName(dlist, parent, "Gfx", dlist_Str);
 
 	std::string entryStr = "\n";
 	entryStr += StringHelper::Sprintf("\t%i, ARRAY_COUNTU(%s),\n", totalVtxCount,
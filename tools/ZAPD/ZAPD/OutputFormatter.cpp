@@ -1,5 +1,8 @@
 #include "OutputFormatter.h"
 
+// Size of the chunks written to the stream, if there's one
+static constexpr size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
 void OutputFormatter::Flush()
 {
 	if (col > lineLimit)
@@ -23,6 +26,12 @@ void OutputFormatter::Flush()
 	str.append(word, wordP - word);
 	wordP = word;
 	wordNests = 0;
+
+	if (stream != nullptr && str.size() >= STREAM_CHUNK_SIZE)
+	{
+		stream->write(str.data(), str.size());
+		str.clear();
+	}
 }
 
 int OutputFormatter::Write(const char* buf, int count)
@@ -88,7 +97,7 @@ int OutputFormatter::Write(const std::string& buf)
 	return Write(buf.data(), buf.size());
 }
 
-OutputFormatter* OutputFormatter::Instance;
+thread_local OutputFormatter* OutputFormatter::Instance;
 
 int OutputFormatter::WriteStatic(const char* buf, int count)
 {
@@ -113,3 +122,22 @@ std::string OutputFormatter::GetOutput()
 
 	return std::move(str);
 }
+
+void OutputFormatter::Reserve(size_t size)
+{
+	str.reserve(size);
+}
+
+void OutputFormatter::SetStream(std::ostream* nStream)
+{
+	stream = nStream;
+	str.reserve(STREAM_CHUNK_SIZE + sizeof(word) + sizeof(space));
+}
+
+void OutputFormatter::Finish()
+{
+	Flush();
+
+	stream->write(str.data(), str.size());
+	str.clear();
+}
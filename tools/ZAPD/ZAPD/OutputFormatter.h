@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <map>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -23,10 +24,11 @@ private:
 	char* spaceP;
 
 	std::string str;
+	std::ostream* stream = nullptr;
 
 	void Flush();
 
-	static OutputFormatter* Instance;
+	static thread_local OutputFormatter* Instance;
 	static int WriteStatic(const char* buf, int count);
 
 public:
@@ -38,4 +40,12 @@ public:
 	int Write(const std::string& buf);
 
 	std::string GetOutput();
+
+	// Reserves room for `size` characters of output, for callers that can estimate it
+	void Reserve(size_t size);
+
+	// Sends the output to `nStream` in chunks while it's being written, instead of keeping all of
+	// it in memory. Finish must be called once everything has been written
+	void SetStream(std::ostream* nStream);
+	void Finish();
 };
@@ -0,0 +1,341 @@
+#include "Profiler.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "Utils/StringHelper.h"
+
+// Keep in sync with ZResourceType
+static const char* const RESOURCE_TYPE_NAMES[] = {
+	"-",
+	"ActorList",
+	"Animation",
+	"Array",
+	"AltHeader",
+	"Background",
+	"Blob",
+	"CollisionHeader",
+	"CollisionPoly",
+	"Cutscene",
+	"DisplayList",
+	"Limb",
+	"LimbTable",
+	"Mtx",
+	"Path",
+	"PlayerAnimationData",
+	"Pointer",
+	"Room",
+	"RoomCommand",
+	"Scalar",
+	"Scene",
+	"Skeleton",
+	"String",
+	"SurfaceType",
+	"Symbol",
+	"Texture",
+	"TextureAnimation",
+	"TextureAnimationParams",
+	"Vector",
+	"Vertex",
+	"Waterbox",
+	"KeyFrameFlexLimb",
+	"KeyFrameStandardLimb",
+	"KeyFrameSkel",
+	"KeyFrameAnimation",
+};
+
+static constexpr size_t RESOURCE_TYPE_COUNT =
+	sizeof(RESOURCE_TYPE_NAMES) / sizeof(RESOURCE_TYPE_NAMES[0]);
+static_assert(RESOURCE_TYPE_COUNT == static_cast<size_t>(ZResourceType::KeyFrameAnimation) + 1,
+              "RESOURCE_TYPE_NAMES is out of sync with ZResourceType");
+
+static const char* const PHASE_NAMES[] = {
+	"ExtractXml",
+	"ParseXML",
+	"ParseRawData",
+	"DeclareReferences",
+	"ParseRawDataLate",
+	"DeclareReferencesLate",
+	"GenerateSourceFiles",
+	"GetSourceOutputCode",
+	"ProcessDeclarations",
+	"WritePng",
+	"Disassemble",
+};
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) ==
+                  static_cast<size_t>(ProfilePhase::Count),
+              "PHASE_NAMES is out of sync with ProfilePhase");
+
+static const char* const COUNTER_NAMES[] = {
+	"Declarations",
+	"Lookups",
+	"RangedLookups",
+	"SourceBytes",
+};
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) ==
+                  static_cast<size_t>(ProfileCounter::Count),
+              "COUNTER_NAMES is out of sync with ProfileCounter");
+
+static constexpr size_t PHASE_COUNT = static_cast<size_t>(ProfilePhase::Count);
+static constexpr size_t COUNTER_COUNT = static_cast<size_t>(ProfileCounter::Count);
+
+struct PhaseStats
+{
+	uint64_t calls = 0;
+	int64_t nanoseconds = 0;
+};
+
+struct TraceEvent
+{
+	ProfilePhase phase;
+	ZResourceType resType;
+	uint32_t threadIndex;
+	int64_t start;  // In nanoseconds since the start of the trace
+	int64_t duration;
+	std::string detail;
+};
+
+struct ProfileData
+{
+	PhaseStats phases[PHASE_COUNT][RESOURCE_TYPE_COUNT];
+	uint64_t counters[COUNTER_COUNT][RESOURCE_TYPE_COUNT] = {};
+	std::vector<TraceEvent> events;
+
+	void MergeInto(ProfileData& other)
+	{
+		for (size_t i = 0; i < PHASE_COUNT; i++)
+		{
+			for (size_t j = 0; j < RESOURCE_TYPE_COUNT; j++)
+			{
+				other.phases[i][j].calls += phases[i][j].calls;
+				other.phases[i][j].nanoseconds += phases[i][j].nanoseconds;
+				phases[i][j] = PhaseStats();
+			}
+		}
+
+		for (size_t i = 0; i < COUNTER_COUNT; i++)
+		{
+			for (size_t j = 0; j < RESOURCE_TYPE_COUNT; j++)
+			{
+				other.counters[i][j] += counters[i][j];
+				counters[i][j] = 0;
+			}
+		}
+
+		other.events.insert(other.events.end(), events.begin(), events.end());
+		events.clear();
+	}
+};
+
+static std::mutex sTotalsMutex;
+static ProfileData sTotals;
+static uint32_t sThreadCount = 0;
+static const std::chrono::steady_clock::time_point sTraceStart = std::chrono::steady_clock::now();
+
+/**
+ * Statistics of a single thread, merged into the totals when the thread exits.
+ */
+struct ThreadProfile
+{
+	ProfileData data;
+	ZResourceType currentResType = ZResourceType::Error;
+	uint32_t threadIndex;
+
+	ThreadProfile()
+	{
+		std::lock_guard<std::mutex> lock(sTotalsMutex);
+		threadIndex = sThreadCount++;
+	}
+
+	~ThreadProfile()
+	{
+		std::lock_guard<std::mutex> lock(sTotalsMutex);
+		data.MergeInto(sTotals);
+	}
+};
+
+static thread_local ThreadProfile sThreadProfile;
+
+static bool sCountAllocations = false;
+static std::atomic<uint64_t> sAllocationCount = 0;
+
+// The other forms of operator new of the standard library end up calling this one
+void* operator new(size_t size)
+{
+	if (sCountAllocations)
+		sAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	void* ptr = malloc(size == 0 ? 1 : size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void Profiler::Start()
+{
+	sCountAllocations = true;
+}
+
+ZResourceType Profiler::BeginPhase(ZResourceType resType)
+{
+	ZResourceType outerResType = sThreadProfile.currentResType;
+	sThreadProfile.currentResType = resType;
+
+	return outerResType;
+}
+
+void Profiler::EndPhase(ProfilePhase phase, ZResourceType resType, ZResourceType outerResType,
+                        std::chrono::steady_clock::time_point start,
+                        std::chrono::steady_clock::time_point end, const std::string& detail)
+{
+	int64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	PhaseStats& stats =
+		sThreadProfile.data.phases[static_cast<size_t>(phase)][static_cast<size_t>(resType)];
+
+	stats.calls++;
+	stats.nanoseconds += duration;
+	sThreadProfile.currentResType = outerResType;
+
+	if (!Globals::Instance->profileTracePath.empty())
+	{
+		int64_t traceStart =
+			std::chrono::duration_cast<std::chrono::nanoseconds>(start - sTraceStart).count();
+		sThreadProfile.data.events.push_back(
+			{phase, resType, sThreadProfile.threadIndex, traceStart, duration, detail});
+	}
+}
+
+void Profiler::AddCount(ProfileCounter counter, uint64_t amount)
+{
+	size_t resType = static_cast<size_t>(sThreadProfile.currentResType);
+	sThreadProfile.data.counters[static_cast<size_t>(counter)][resType] += amount;
+}
+
+static std::string EscapeJson(const std::string& str)
+{
+	std::string escaped;
+	escaped.reserve(str.size());
+
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+
+		if (static_cast<unsigned char>(c) < 0x20)
+			StringHelper::AppendSprintf(escaped, "\\u%04X", c);
+		else
+			escaped += c;
+	}
+
+	return escaped;
+}
+
+static void WriteTrace(const fs::path& tracePath, const ProfileData& totals)
+{
+	std::ofstream trace(tracePath.string());
+	if (!trace.is_open())
+	{
+		fprintf(stderr, "Error: unable to write the profile trace '%s'\n", tracePath.c_str());
+		return;
+	}
+
+	std::string line;
+	trace << "{\"traceEvents\":[\n";
+
+	for (size_t i = 0; i < totals.events.size(); i++)
+	{
+		const TraceEvent& event = totals.events[i];
+
+		line.clear();
+		StringHelper::AppendSprintf(
+			line,
+			"{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+			"\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"detail\":\"%s\"}}%s\n",
+			PHASE_NAMES[static_cast<size_t>(event.phase)],
+			RESOURCE_TYPE_NAMES[static_cast<size_t>(event.resType)], event.threadIndex,
+			event.start / 1000.0, event.duration / 1000.0, EscapeJson(event.detail).c_str(),
+			i + 1 < totals.events.size() ? "," : "");
+		trace << line;
+	}
+
+	trace << "],\n\"otherData\":{";
+	for (size_t i = 0; i < COUNTER_COUNT; i++)
+	{
+		uint64_t total = 0;
+		for (size_t j = 0; j < RESOURCE_TYPE_COUNT; j++)
+			total += totals.counters[i][j];
+
+		trace << "\"" << COUNTER_NAMES[i] << "\":\"" << total << "\",";
+	}
+	trace << "\"Allocations\":\"" << sAllocationCount.load() << "\"}}\n";
+}
+
+void Profiler::Report()
+{
+	// Creating the profile of this thread takes the lock too, so it has to happen before
+	ProfileData& threadData = sThreadProfile.data;
+	ProfileData totals;
+	{
+		std::lock_guard<std::mutex> lock(sTotalsMutex);
+		threadData.MergeInto(sTotals);
+		sTotals.MergeInto(totals);
+	}
+
+	printf("\nPROFILE: phases (times include nested phases)\n");
+	printf("%-22s %-22s %10s %12s %10s\n", "Phase", "Resource", "Calls", "Total (ms)",
+	       "Avg (us)");
+	for (size_t i = 0; i < PHASE_COUNT; i++)
+	{
+		for (size_t j = 0; j < RESOURCE_TYPE_COUNT; j++)
+		{
+			const PhaseStats& stats = totals.phases[i][j];
+			if (stats.calls == 0)
+				continue;
+
+			printf("%-22s %-22s %10" PRIu64 " %12.3f %10.3f\n", PHASE_NAMES[i],
+			       RESOURCE_TYPE_NAMES[j], stats.calls, stats.nanoseconds / 1e6,
+			       stats.nanoseconds / 1e3 / stats.calls);
+		}
+	}
+
+	printf("\nPROFILE: counters\n");
+	printf("%-22s", "Resource");
+	for (size_t i = 0; i < COUNTER_COUNT; i++)
+		printf(" %14s", COUNTER_NAMES[i]);
+	printf("\n");
+
+	uint64_t counterTotals[COUNTER_COUNT] = {};
+	for (size_t j = 0; j < RESOURCE_TYPE_COUNT; j++)
+	{
+		bool used = false;
+		for (size_t i = 0; i < COUNTER_COUNT; i++)
+			used = used || totals.counters[i][j] != 0;
+		if (!used)
+			continue;
+
+		printf("%-22s", RESOURCE_TYPE_NAMES[j]);
+		for (size_t i = 0; i < COUNTER_COUNT; i++)
+		{
+			printf(" %14" PRIu64, totals.counters[i][j]);
+			counterTotals[i] += totals.counters[i][j];
+		}
+		printf("\n");
+	}
+
+	printf("%-22s", "Total");
+	for (size_t i = 0; i < COUNTER_COUNT; i++)
+		printf(" %14" PRIu64, counterTotals[i]);
+	printf("\n");
+
+	printf("\nPROFILE: %" PRIu64 " allocations\n", sAllocationCount.load());
+
+	if (!Globals::Instance->profileTracePath.empty())
+		WriteTrace(Globals::Instance->profileTracePath, totals);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "Globals.h"
+#include "ZResource.h"
+
+enum class ProfilePhase
+{
+	ExtractXml,
+	ParseXML,
+	ParseRawData,
+	DeclareReferences,
+	ParseRawDataLate,
+	DeclareReferencesLate,
+	GenerateSourceFiles,
+	GetSourceOutputCode,
+	ProcessDeclarations,
+	WritePng,
+	Disassemble,  // libgfxd
+	Count,
+};
+
+enum class ProfileCounter
+{
+	Declarations,
+	Lookups,
+	RangedLookups,
+	SourceBytes,
+	Count,
+};
+
+/**
+ * Instrumentation enabled with `-profile 1`.
+ *
+ * The time spent in each phase of the extraction is accumulated per resource type, together with
+ * counters of the work done there. Times are inclusive: a resource parsing its children also counts
+ * the time of their phases. Counters are attributed to the resource type of the innermost phase.
+ * Every thread keeps its own statistics, which are merged when it exits, so the summary of a batch
+ * covers all of its jobs.
+ * With `--profile-trace PATH`, every phase is also recorded as an event of a Chrome trace
+ * (chrome://tracing, Perfetto).
+ * Once started, every C++ allocation of the program is counted as well.
+ */
+class Profiler
+{
+public:
+	static bool IsEnabled() { return Globals::Instance->profile; }
+
+	static void Count(ProfileCounter counter, uint64_t amount = 1)
+	{
+		if (IsEnabled())
+			AddCount(counter, amount);
+	}
+
+	// Starts counting allocations
+	static void Start();
+
+	// Prints the summary table and writes the trace, if requested
+	static void Report();
+
+protected:
+	friend class ProfileScope;
+
+	static ZResourceType BeginPhase(ZResourceType resType);
+	static void EndPhase(ProfilePhase phase, ZResourceType resType, ZResourceType outerResType,
+	                     std::chrono::steady_clock::time_point start,
+	                     std::chrono::steady_clock::time_point end, const std::string& detail);
+	static void AddCount(ProfileCounter counter, uint64_t amount);
+};
+
+/**
+ * Measures a phase until the end of the scope. `detail` names the item in the trace.
+ */
+class ProfileScope
+{
+public:
+	ProfileScope(ProfilePhase nPhase, ZResourceType nResType = ZResourceType::Error,
+	             const std::string& nDetail = "")
+		: enabled(Profiler::IsEnabled()), phase(nPhase), resType(nResType)
+	{
+		if (enabled)
+			Begin(nDetail);
+	}
+
+	// Measures a phase of `res`. Its type and name are only looked up when profiling, and the name
+	// at the end of the phase, since parsing may set it. Some resources, like ZRoom, only know their
+	// type once their XML is parsed, so the type of ParseXML is looked up at its end too, and the
+	// counters of that phase aren't attributed to any type
+	ProfileScope(ProfilePhase nPhase, const ZResource* res)
+		: enabled(Profiler::IsEnabled()), phase(nPhase), resType(ZResourceType::Error)
+	{
+		if (enabled)
+		{
+			if (phase != ProfilePhase::ParseXML)
+				resType = res->GetResourceType();
+			resource = res;
+			Begin("");
+		}
+	}
+
+	~ProfileScope()
+	{
+		if (!enabled)
+			return;
+
+		auto end = std::chrono::steady_clock::now();
+		if (resource != nullptr)
+		{
+			if (phase == ProfilePhase::ParseXML)
+				resType = resource->GetResourceType();
+			if (IsTracing())
+				detail = resource->GetName();
+		}
+
+		Profiler::EndPhase(phase, resType, outerResType, start, end, detail);
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	bool enabled;
+	ProfilePhase phase;
+	ZResourceType resType;
+	ZResourceType outerResType = ZResourceType::Error;
+	const ZResource* resource = nullptr;
+	std::string detail;
+	std::chrono::steady_clock::time_point start;
+
+	void Begin(const std::string& nDetail)
+	{
+		// Only the trace needs the detail, copying it would add to the allocations being counted
+		if (IsTracing())
+			detail = nDetail;
+
+		outerResType = Profiler::BeginPhase(resType);
+		start = std::chrono::steady_clock::now();
+	}
+
+	static bool IsTracing() { return !Globals::Instance->profileTracePath.empty(); }
+};
@@ -0,0 +1,334 @@
+#include "TextureCodecs.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_CODECS_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define TEXTURE_CODECS_NEON
+#include <arm_neon.h>
+#endif
+
+template <size_t N, typename Func>
+static constexpr std::array<uint8_t, N> MakeTable(Func func)
+{
+	std::array<uint8_t, N> table{};
+
+	for (size_t i = 0; i < N; i++)
+		table[i] = func(i);
+
+	return table;
+}
+
+static constexpr auto EXPAND_5_TO_8 =
+	MakeTable<32>([](size_t v) { return static_cast<uint8_t>((v << 3) | (v >> 2)); });
+static constexpr auto EXPAND_4_TO_8 =
+	MakeTable<16>([](size_t v) { return static_cast<uint8_t>((v << 4) | v); });
+
+// I4 intensities aren't replicated into the low nibble
+static constexpr auto I4_TO_8 =
+	MakeTable<16>([](size_t v) { return static_cast<uint8_t>(v << 4); });
+
+static constexpr auto IA4_INTENSITY = MakeTable<16>([](size_t v) {
+	size_t intensity = v & 0b1110;
+	return static_cast<uint8_t>((intensity << 4) | (intensity << 1) | (intensity >> 2));
+});
+static constexpr auto IA4_ALPHA =
+	MakeTable<16>([](size_t v) { return static_cast<uint8_t>((v & 1) ? 255 : 0); });
+
+static uint8_t GetNibble(const uint8_t* src, size_t pixel)
+{
+	return (pixel % 2 == 0) ? (src[pixel / 2] >> 4) : (src[pixel / 2] & 0x0F);
+}
+
+static void SetNibble(uint8_t* dst, size_t pixel, uint8_t value)
+{
+	if (pixel % 2 == 0)
+		dst[pixel / 2] = value << 4;
+	else
+		dst[pixel / 2] |= value;
+}
+
+/* Decoders */
+
+void TextureCodecs::DecodeRGBA16(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	size_t i = 0;
+
+#if defined(TEXTURE_CODECS_SSE2)
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	const __m128i one = _mm_set1_epi16(1);
+
+	for (; i + 8 <= pixelCount; i += 8)
+	{
+		__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+		data = _mm_or_si128(_mm_slli_epi16(data, 8), _mm_srli_epi16(data, 8));
+
+		__m128i r = _mm_srli_epi16(data, 11);
+		__m128i g = _mm_and_si128(_mm_srli_epi16(data, 6), mask5);
+		__m128i b = _mm_and_si128(_mm_srli_epi16(data, 1), mask5);
+		__m128i a = _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(data, one));
+
+		r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+		g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+		b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+		__m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+		__m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+	}
+#elif defined(TEXTURE_CODECS_NEON)
+	const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+
+	for (; i + 8 <= pixelCount; i += 8)
+	{
+		uint16x8_t data = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(src + i * 2)));
+
+		uint16x8_t r = vshrq_n_u16(data, 11);
+		uint16x8_t g = vandq_u16(vshrq_n_u16(data, 6), mask5);
+		uint16x8_t b = vandq_u16(vshrq_n_u16(data, 1), mask5);
+
+		uint8x8x4_t pixels;
+		pixels.val[0] = vmovn_u16(vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2)));
+		pixels.val[1] = vmovn_u16(vorrq_u16(vshlq_n_u16(g, 3), vshrq_n_u16(g, 2)));
+		pixels.val[2] = vmovn_u16(vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2)));
+		pixels.val[3] = vmovn_u16(vtstq_u16(data, vdupq_n_u16(1)));
+		vst4_u8(dst + i * 4, pixels);
+	}
+#endif
+
+	for (; i < pixelCount; i++)
+	{
+		uint16_t data = (src[i * 2] << 8) | src[i * 2 + 1];
+
+		dst[i * 4 + 0] = EXPAND_5_TO_8[data >> 11];
+		dst[i * 4 + 1] = EXPAND_5_TO_8[(data >> 6) & 0x1F];
+		dst[i * 4 + 2] = EXPAND_5_TO_8[(data >> 1) & 0x1F];
+		dst[i * 4 + 3] = (data & 1) ? 255 : 0;
+	}
+}
+
+void TextureCodecs::DecodeRGBA32(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	memcpy(dst, src, pixelCount * 4);
+}
+
+void TextureCodecs::DecodeIA4(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		uint8_t data = GetNibble(src, i);
+		uint8_t intensity = IA4_INTENSITY[data];
+
+		dst[i * 4 + 0] = intensity;
+		dst[i * 4 + 1] = intensity;
+		dst[i * 4 + 2] = intensity;
+		dst[i * 4 + 3] = IA4_ALPHA[data];
+	}
+}
+
+void TextureCodecs::DecodeIA8(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		uint8_t intensity = EXPAND_4_TO_8[src[i] >> 4];
+
+		dst[i * 4 + 0] = intensity;
+		dst[i * 4 + 1] = intensity;
+		dst[i * 4 + 2] = intensity;
+		dst[i * 4 + 3] = EXPAND_4_TO_8[src[i] & 0x0F];
+	}
+}
+
+void TextureCodecs::DecodeIA16(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		dst[i * 4 + 0] = src[i * 2];
+		dst[i * 4 + 1] = src[i * 2];
+		dst[i * 4 + 2] = src[i * 2];
+		dst[i * 4 + 3] = src[i * 2 + 1];
+	}
+}
+
+void TextureCodecs::DecodeI4(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		uint8_t intensity = I4_TO_8[GetNibble(src, i)];
+
+		dst[i * 3 + 0] = intensity;
+		dst[i * 3 + 1] = intensity;
+		dst[i * 3 + 2] = intensity;
+	}
+}
+
+void TextureCodecs::DecodeI8(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		dst[i * 3 + 0] = src[i];
+		dst[i * 3 + 1] = src[i];
+		dst[i * 3 + 2] = src[i];
+	}
+}
+
+void TextureCodecs::DecodeCI4(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+		dst[i] = GetNibble(src, i);
+}
+
+void TextureCodecs::DecodeCI8(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	memcpy(dst, src, pixelCount);
+}
+
+/* Encoders */
+
+void TextureCodecs::EncodeRGBA16(const uint8_t* src, size_t pixelSize, uint8_t* dst,
+                                 size_t pixelCount)
+{
+	size_t i = 0;
+
+#if defined(TEXTURE_CODECS_SSE2)
+	if (pixelSize == 4)
+	{
+		const __m128i maskR = _mm_set1_epi32(0xF8);
+		const __m128i maskG = _mm_set1_epi32(0x07C0);
+		const __m128i maskB = _mm_set1_epi32(0x3E);
+		const __m128i maskLow = _mm_set1_epi32(0xFF);
+		const __m128i one = _mm_set1_epi32(1);
+		const __m128i bias32 = _mm_set1_epi32(0x8000);
+		const __m128i bias16 = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+
+		// Converts 4 pixels to big endian RGBA16 values, one per 32 bit lane, minus 0x8000 so
+		// they survive the signed saturation of _mm_packs_epi32
+		auto encode4 = [&](__m128i pixels) {
+			__m128i r = _mm_slli_epi32(_mm_and_si128(pixels, maskR), 8);
+			__m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 5), maskG);
+			__m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 18), maskB);
+			__m128i transparent = _mm_cmpeq_epi32(_mm_srli_epi32(pixels, 24), _mm_setzero_si128());
+			__m128i a = _mm_andnot_si128(transparent, one);
+
+			__m128i data = _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+			__m128i lowByte = _mm_and_si128(data, maskLow);
+			data = _mm_or_si128(_mm_srli_epi32(data, 8), _mm_slli_epi32(lowByte, 8));
+			return _mm_sub_epi32(data, bias32);
+		};
+
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			__m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+			__m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4 + 16));
+			__m128i packed = _mm_add_epi16(_mm_packs_epi32(encode4(low), encode4(high)), bias16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), packed);
+		}
+	}
+#elif defined(TEXTURE_CODECS_NEON)
+	if (pixelSize == 4)
+	{
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			uint8x8x4_t pixels = vld4_u8(src + i * 4);
+
+			uint16x8_t r = vshlq_n_u16(vmovl_u8(vshr_n_u8(pixels.val[0], 3)), 11);
+			uint16x8_t g = vshlq_n_u16(vmovl_u8(vshr_n_u8(pixels.val[1], 3)), 6);
+			uint16x8_t b = vshlq_n_u16(vmovl_u8(vshr_n_u8(pixels.val[2], 3)), 1);
+			uint16x8_t a = vmovl_u8(vmin_u8(pixels.val[3], vdup_n_u8(1)));
+
+			uint16x8_t data = vorrq_u16(vorrq_u16(r, g), vorrq_u16(b, a));
+			vst1q_u8(dst + i * 2, vrev16q_u8(vreinterpretq_u8_u16(data)));
+		}
+	}
+#endif
+
+	for (; i < pixelCount; i++)
+	{
+		const uint8_t* pixel = src + i * pixelSize;
+		uint8_t alphaBit = (pixelSize == 4) && pixel[3] != 0;
+		uint16_t data = ((pixel[0] >> 3) << 11) | ((pixel[1] >> 3) << 6) | ((pixel[2] >> 3) << 1) |
+		                alphaBit;
+
+		dst[i * 2 + 0] = data >> 8;
+		dst[i * 2 + 1] = data & 0xFF;
+	}
+}
+
+void TextureCodecs::EncodeRGBA32(const uint8_t* src, size_t pixelSize, uint8_t* dst,
+                                 size_t pixelCount)
+{
+	if (pixelSize == 4)
+	{
+		memcpy(dst, src, pixelCount * 4);
+		return;
+	}
+
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		dst[i * 4 + 0] = src[i * 3 + 0];
+		dst[i * 4 + 1] = src[i * 3 + 1];
+		dst[i * 4 + 2] = src[i * 3 + 2];
+		dst[i * 4 + 3] = 0;
+	}
+}
+
+void TextureCodecs::EncodeI4(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+		SetNibble(dst, i, src[i * pixelSize] >> 4);
+}
+
+void TextureCodecs::EncodeI8(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+		dst[i] = src[i * pixelSize];
+}
+
+void TextureCodecs::EncodeIA4(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		const uint8_t* pixel = src + i * pixelSize;
+		uint8_t alphaBit = (pixelSize == 4) && pixel[3] != 0;
+
+		SetNibble(dst, i, ((pixel[0] >> 5) << 1) | alphaBit);
+	}
+}
+
+void TextureCodecs::EncodeIA8(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		const uint8_t* pixel = src + i * pixelSize;
+		uint8_t alpha = (pixelSize == 4) ? pixel[3] : 0;
+
+		dst[i] = (pixel[0] & 0xF0) | (alpha >> 4);
+	}
+}
+
+void TextureCodecs::EncodeIA16(const uint8_t* src, size_t pixelSize, uint8_t* dst,
+                               size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		const uint8_t* pixel = src + i * pixelSize;
+
+		dst[i * 2 + 0] = pixel[0];
+		dst[i * 2 + 1] = (pixelSize == 4) ? pixel[3] : 0;
+	}
+}
+
+void TextureCodecs::EncodeCI4(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; i++)
+		SetNibble(dst, i, src[i]);
+}
+
+void TextureCodecs::EncodeCI8(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	memcpy(dst, src, pixelCount);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Converts runs of pixels between the N64 texture formats and the 8 bit per channel layouts used by
+ * ImageBackend: RGBA (4 bytes per pixel), RGB (3 bytes per pixel) and palette indices (1 byte per
+ * pixel). Channel expansions go through lookup tables, and RGBA16 uses SSE2 or NEON when the target
+ * has them.
+ *
+ * The 4 bit formats pack two pixels per byte, the first one in the high nibble.
+ */
+class TextureCodecs
+{
+public:
+	// N64 -> RGBA
+	static void DecodeRGBA16(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+	static void DecodeRGBA32(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+	static void DecodeIA4(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+	static void DecodeIA8(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+	static void DecodeIA16(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+
+	// N64 -> RGB
+	static void DecodeI4(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+	static void DecodeI8(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+
+	// N64 -> palette indices
+	static void DecodeCI4(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+	static void DecodeCI8(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+
+	// RGB or RGBA -> N64. `pixelSize` is 3 or 4, pixels without an alpha channel are transparent
+	static void EncodeRGBA16(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount);
+	static void EncodeRGBA32(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount);
+	static void EncodeI4(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount);
+	static void EncodeI8(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount);
+	static void EncodeIA4(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount);
+	static void EncodeIA8(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount);
+	static void EncodeIA16(const uint8_t* src, size_t pixelSize, uint8_t* dst, size_t pixelCount);
+
+	// Palette indices -> N64
+	static void EncodeCI4(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+	static void EncodeCI8(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+};
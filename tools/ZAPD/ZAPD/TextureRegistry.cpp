@@ -0,0 +1,41 @@
+#include "TextureRegistry.h"
+
+bool TextureRegistry::ClaimPng(const fs::path& path, uint64_t contentKey)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	std::string key = path.string();
+
+	while (true)
+	{
+		auto it = pngs.find(key);
+		if (it == pngs.end() || it->second.contentKey != contentKey)
+		{
+			// Different content for the same path is written again, the last one wins as before
+			pngs[key] = {contentKey, false};
+			return true;
+		}
+
+		if (it->second.written)
+			return false;
+
+		pngWritten.wait(lock);
+	}
+}
+
+void TextureRegistry::FinishPng(const fs::path& path, uint64_t contentKey, bool written)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = pngs.find(path.string());
+
+		if (it != pngs.end() && it->second.contentKey == contentKey)
+		{
+			if (written)
+				it->second.written = true;
+			else
+				pngs.erase(it);
+		}
+	}
+
+	pngWritten.notify_all();
+}
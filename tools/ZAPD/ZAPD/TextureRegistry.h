@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Utils/Directory.h"
+
+/**
+ * PNGs written by the jobs of a batch, shared by all of its worker threads.
+ *
+ * Textures of the texture pool, and the palettes they are drawn with, are referenced by many XMLs
+ * but all of them write the same PNG to the same pool path. The first texture to claim a path with
+ * some content converts and writes it, any other texture claiming it with the same content only
+ * waits for that write to finish, so the file is complete once its own job is done.
+ */
+class TextureRegistry
+{
+public:
+	TextureRegistry() = default;
+	TextureRegistry(const TextureRegistry&) = delete;
+	TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+	/**
+	 * Returns `true` if the caller has to write the PNG at `path`, and call `FinishPng` afterwards.
+	 * Returns `false` once a PNG with the same `contentKey` has been written there.
+	 */
+	bool ClaimPng(const fs::path& path, uint64_t contentKey);
+
+	// Ends a claim. If the PNG wasn't written, the next texture claiming that path writes it
+	void FinishPng(const fs::path& path, uint64_t contentKey, bool written);
+
+protected:
+	struct PngEntry
+	{
+		uint64_t contentKey;
+		bool written;
+	};
+
+	std::mutex mutex;
+	std::condition_variable pngWritten;
+	std::unordered_map<std::string, PngEntry> pngs;
+};
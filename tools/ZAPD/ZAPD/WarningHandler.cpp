@@ -22,6 +22,7 @@
  * - -Werror=foo escalates foo to behave like an error
  * - -Weverything enables all warnings
  * - -Werror escalates all enabled warnings to errors
+ * - -Wcount-only only counts the warnings that would be printed, and prints their totals at exit
  *
  * Errors do not have types, and will always throw an exception; they cannot be disabled.
  *
@@ -70,7 +71,6 @@ typedef struct
 
 typedef struct
 {
-	WarningLevel level;
 	std::string name;
 	std::string description;
 } WarningInfo;
@@ -108,16 +108,20 @@ static const std::unordered_map<std::string, WarningInfoInit> warningStringToIni
 };
 
 /**
- * Map constructed at runtime to contain the warning features as set by the user using -W flags.
+ * Names of the warning types, indexed by type. Their levels, as set by the user using -W flags, are
+ * in warningLevels.
  */
-static std::unordered_map<WarningType, WarningInfo> warningTypeToInfoMap;
+static std::array<WarningInfo, static_cast<size_t>(WarningType::Max)> warningTypeToInfo;
 
 void WarningHandler::ConstructTypeToInfoMap() {
     for (auto& entry : warningStringToInitMap) {
-        warningTypeToInfoMap[entry.second.type] = {entry.second.defaultLevel, entry.first, entry.second.description};
+        size_t index = static_cast<size_t>(entry.second.type);
+        warningTypeToInfo[index] = {entry.first, entry.second.description};
+        warningLevels[index] = entry.second.defaultLevel;
     }
-    warningTypeToInfoMap[WarningType::Always] = {WarningLevel::Warn, "always", "you shouldn't be reading this"};
-    assert(warningTypeToInfoMap.size() == static_cast<size_t>(WarningType::Max));
+    warningTypeToInfo[static_cast<size_t>(WarningType::Always)] = {"always", "you shouldn't be reading this"};
+    warningLevels[static_cast<size_t>(WarningType::Always)] = WarningLevel::Warn;
+    assert(warningStringToInitMap.size() + 1 == static_cast<size_t>(WarningType::Max));
 }
 
 /**
@@ -147,10 +151,12 @@ void WarningHandler::Init(int argc, char* argv[]) {
 
         if (currentArgv == "error") {
             werror = warningTypeOn != WarningLevel::Off;
+        } else if (currentArgv == "count-only") {
+            countOnly = warningTypeOn != WarningLevel::Off;
         } else if (currentArgv == "everything") {
-            for (auto& it: warningTypeToInfoMap) {
-                if (it.second.level <= WarningLevel::Warn) {
-                    it.second.level = warningTypeOn;
+            for (auto& level: warningLevels) {
+                if (level <= WarningLevel::Warn) {
+                    level = warningTypeOn;
                 }
             }
         } else {
@@ -163,7 +169,7 @@ void WarningHandler::Init(int argc, char* argv[]) {
 
             auto it = warningStringToInitMap.find(std::string(currentArgv));
             if (it != warningStringToInitMap.end()) {
-                warningTypeToInfoMap[it->second.type].level = warningTypeOn;
+                warningLevels[static_cast<size_t>(it->second.type)] = warningTypeOn;
             }
             else {
                 HANDLE_WARNING(WarningType::Always, StringHelper::Sprintf("unknown warning flag '%s'", argv[i]), "");
@@ -172,9 +178,9 @@ void WarningHandler::Init(int argc, char* argv[]) {
     }
 
     if (werror) {
-        for (auto& it: warningTypeToInfoMap) {
-            if (it.second.level >= WarningLevel::Warn) {
-                it.second.level = WarningLevel::Err;
+        for (auto& level: warningLevels) {
+            if (level >= WarningLevel::Warn) {
+                level = WarningLevel::Err;
             }
         }
     }
@@ -183,7 +189,7 @@ void WarningHandler::Init(int argc, char* argv[]) {
 bool WarningHandler::IsWarningEnabled(WarningType warnType) {
     assert(static_cast<size_t>(warnType) >= 0 && warnType < WarningType::Max);
 
-    return warningTypeToInfoMap.at(warnType).level != WarningLevel::Off;
+    return warningLevels[static_cast<size_t>(warnType)] != WarningLevel::Off;
 }
 
 bool WarningHandler::WasElevatedToError(WarningType warnType) {
@@ -193,7 +199,7 @@ bool WarningHandler::WasElevatedToError(WarningType warnType) {
         return false;
     }
 
-    return warningTypeToInfoMap.at(warnType).level >= WarningLevel::Err;
+    return warningLevels[static_cast<size_t>(warnType)] >= WarningLevel::Err;
 }
 
 /**
@@ -217,8 +223,8 @@ void WarningHandler::FunctionPreamble(const char* filename, int32_t line, const
  *  Print the information about the file(s) being processed (XML for extraction, png etc. for building)
  */
 void WarningHandler::ProcessedFilePreamble() {
-    if (Globals::Instance->inputPath != "") {
-        fprintf(stderr, "When processing file %s: ", Globals::Instance->inputPath.c_str());
+    if (Globals::Job->inputPath != "") {
+        fprintf(stderr, "When processing file %s: ", Globals::Job->inputPath.c_str());
     }
 }
 
@@ -272,10 +278,8 @@ void WarningHandler::PrintErrorAndThrow(const std::string& header, const std::st
 void WarningHandler::ErrorType(WarningType warnType, const std::string& header, const std::string& body) {
     std::string headerMsg = header;
 
-    for (const auto& iter: warningStringToInitMap) {
-        if (iter.second.type == warnType) {
-            headerMsg += StringHelper::Sprintf(" [%s]", iter.first.c_str());
-        }
+    if (warnType != WarningType::Always) {
+        headerMsg += StringHelper::Sprintf(" [%s]", warningTypeToInfo[static_cast<size_t>(warnType)].name.c_str());
     }
 
     PrintErrorAndThrow(headerMsg, body);
@@ -314,10 +318,8 @@ void WarningHandler::PrintWarningBody(const std::string& header, const std::stri
 void WarningHandler::WarningTypeAndChooseEscalate(WarningType warnType, const std::string& header, const std::string& body) {
     std::string headerMsg = header;
 
-    for (const auto& iter: warningStringToInitMap) {
-        if (iter.second.type == warnType) {
-            headerMsg += StringHelper::Sprintf(" [-W%s]", iter.first.c_str());
-        }
+    if (warnType != WarningType::Always) {
+        headerMsg += StringHelper::Sprintf(" [-W%s]", warningTypeToInfo[static_cast<size_t>(warnType)].name.c_str());
     }
 
     if (WasElevatedToError(warnType)) {
@@ -417,38 +419,44 @@ void WarningHandler::PrintHelp() {
     }
 
     printf("\n");
-    printf("Other\n" HELP_DT_INDT "-Weverything will enable all existing warnings.\n" HELP_DT_INDT "-Werror will promote all warnings to errors.\n");
+    printf("Other\n" HELP_DT_INDT "-Weverything will enable all existing warnings.\n" HELP_DT_INDT "-Werror will promote all warnings to errors.\n" HELP_DT_INDT "-Wcount-only will only count warnings, and print how many there were of each type at exit.\n");
 
     printf("\n");
     printf("Warnings can be disabled using -Wno-... instead of -W...; -Weverything will override any -Wno-... flags passed before it.\n");
 }
 
 /**
- * Print which warnings are currently enabled
+ * Print which warnings are currently enabled, and how many of each type were raised so far,
+ * including the ones that are off
  */
 void WarningHandler::PrintWarningsDebugInfo()
 {
     std::string dt;
 
     printf("Warnings status:\n");
-    for (auto& it: warningTypeToInfoMap) {
-        dt = it.second.name;
+    for (size_t i = 0; i < warningTypeToInfo.size(); i++) {
+        dt = warningTypeToInfo[i].name;
         dt += ": ";
 
         printf(HELP_DT_INDT "%-25s", dt.c_str());
-        switch (it.second.level)
+        switch (warningLevels[i])
         {
         case WarningLevel::Off:
-            printf(VT_FGCOL(LIGHTGRAY) "Off" VT_RST);
+            printf(VT_FGCOL(LIGHTGRAY) "Off " VT_RST);
             break;
         case WarningLevel::Warn:
             printf(VT_FGCOL(YELLOW) "Warn" VT_RST);
             break;
         case WarningLevel::Err:
-            printf(VT_FGCOL(RED) "Err" VT_RST);
+            printf(VT_FGCOL(RED) "Err " VT_RST);
             break;
 
         }
+
+        uint32_t count = warningCounts[i].load(std::memory_order_relaxed);
+        if (count != 0) {
+            printf("  %u raised", count);
+        }
         printf("\n");
     }
     printf("\n");
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -39,20 +41,31 @@
 /* Warning and error macros */
 // TODO: better names
 
+// The warning macros only evaluate their header and body, which are often built with Sprintf, when
+// the warning is printed or thrown. Every warning is counted, see WarningHandler::CountWarning
+
 // General-purpose, plain style (only prints function,file,line in the preamble)
 #define HANDLE_ERROR(warningType, header, body)                                                    \
 	WarningHandler::Error_Plain(__FILE__, __LINE__, __PRETTY_FUNCTION__, warningType, header, body)
 #define HANDLE_WARNING(warningType, header, body)                                                  \
-	WarningHandler::Warning_Plain(__FILE__, __LINE__, __PRETTY_FUNCTION__, warningType, header,    \
-	                              body)
+	do                                                                                             \
+	{                                                                                              \
+		if (WarningHandler::CountWarning(warningType))                                             \
+			WarningHandler::Warning_Plain(__FILE__, __LINE__, __PRETTY_FUNCTION__, warningType,    \
+			                              header, body);                                           \
+	} while (0)
 
 // For processing XMLs or textures/blobs (preamble contains function,file,line; processed file)
 #define HANDLE_ERROR_PROCESS(warningType, header, body)                                            \
 	WarningHandler::Error_Process(__FILE__, __LINE__, __PRETTY_FUNCTION__, warningType, header,    \
 	                              body)
 #define HANDLE_WARNING_PROCESS(warningType, header, body)                                          \
-	WarningHandler::Warning_Process(__FILE__, __LINE__, __PRETTY_FUNCTION__, warningType, header,  \
-	                                body)
+	do                                                                                             \
+	{                                                                                              \
+		if (WarningHandler::CountWarning(warningType))                                             \
+			WarningHandler::Warning_Process(__FILE__, __LINE__, __PRETTY_FUNCTION__, warningType,  \
+			                                header, body);                                         \
+	} while (0)
 
 // For ZResource-related stuff (preamble contains function,file,line; processed file; extracted file
 // and offset)
@@ -60,8 +73,12 @@
 	WarningHandler::Error_Resource(__FILE__, __LINE__, __PRETTY_FUNCTION__, warningType, parent,   \
 	                               resource, offset, header, body)
 #define HANDLE_WARNING_RESOURCE(warningType, parent, resource, offset, header, body)               \
-	WarningHandler::Warning_Resource(__FILE__, __LINE__, __PRETTY_FUNCTION__, warningType, parent, \
-	                                 resource, offset, header, body)
+	do                                                                                             \
+	{                                                                                              \
+		if (WarningHandler::CountWarning(warningType))                                             \
+			WarningHandler::Warning_Resource(__FILE__, __LINE__, __PRETTY_FUNCTION__, warningType, \
+			                                 parent, resource, offset, header, body);              \
+	} while (0)
 
 // =======================================
 
@@ -103,6 +120,19 @@ public:
 	static bool IsWarningEnabled(WarningType warnType);
 	static bool WasElevatedToError(WarningType warnType);
 
+	/**
+	 * Counts a warning of `warnType` for the summary, and returns whether its message has to be
+	 * built: false if the warning is off, or only counted because of `-Wcount-only`
+	 */
+	static inline bool CountWarning(WarningType warnType)
+	{
+		size_t index = static_cast<size_t>(warnType);
+
+		warningCounts[index].fetch_add(1, std::memory_order_relaxed);
+		return warningLevels[index] == WarningLevel::Err ||
+		       (warningLevels[index] == WarningLevel::Warn && !countOnly);
+	}
+
 	static void FunctionPreamble(const char* filename, int32_t line, const char* function);
 	static void ProcessedFilePreamble();
 	static void ExtractedFilePreamble(const ZFile* parent, const ZResource* res,
@@ -143,4 +173,13 @@ public:
 
 	static void PrintHelp();
 	static void PrintWarningsDebugInfo();
+
+	// Set by `-Wcount-only`: warnings are counted, not printed, and their totals printed at exit
+	static inline bool countOnly = false;
+
+protected:
+	// Indexed by WarningType. The levels are set by Init, before any job runs
+	static inline std::array<WarningLevel, static_cast<size_t>(WarningType::Max)> warningLevels{};
+	static inline std::array<std::atomic<uint32_t>, static_cast<size_t>(WarningType::Max)>
+		warningCounts{};
 };
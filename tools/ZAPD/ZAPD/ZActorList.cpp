@@ -120,7 +120,7 @@ size_t ZActorList::GetActorListArraySize() const
 	// Doing an else-if here so we only do the loop when the game is SW97.
 	// Actor 0x22 is removed from SW97, so we need to ensure that we don't increment the actor count
 	// for it.
-	if (Globals::Instance->game == ZGame::OOT_SW97)
+	if (Globals::Job->game == ZGame::OOT_SW97)
 	{
 		actorCount = 0;
 
@@ -138,7 +138,7 @@ size_t ZActorList::GetActorListArraySize() const
 
 /* ActorSpawnEntry */
 
-ActorSpawnEntry::ActorSpawnEntry(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex)
+ActorSpawnEntry::ActorSpawnEntry(const DataView& rawData, uint32_t rawDataIndex)
 {
 	actorNum = BitConverter::ToInt16BE(rawData, rawDataIndex + 0);
 	posX = BitConverter::ToInt16BE(rawData, rawDataIndex + 2);
@@ -159,7 +159,7 @@ std::string ActorSpawnEntry::GetBodySourceCode() const
 		StringHelper::Sprintf(actorNameFmt.c_str(), (ZNames::GetActorName(actorNum) + ",").c_str());
 
 	body += StringHelper::Sprintf("{ %6i, %6i, %6i }, ", posX, posY, posZ);
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 		body += StringHelper::Sprintf("{ SPAWN_ROT_FLAGS(%#5hX, 0x%04X)"
 		                              ", SPAWN_ROT_FLAGS(%#5hX, 0x%04X)"
 		                              ", SPAWN_ROT_FLAGS(%#5hX, 0x%04X) }, ",
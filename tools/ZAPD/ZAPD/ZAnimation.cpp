@@ -2,6 +2,7 @@
 
 #include <utility>
 
+#include "AnimationDataRegistry.h"
 #include "Globals.h"
 #include "Utils/BitConverter.h"
 #include "Utils/File.h"
@@ -31,6 +32,46 @@ ZResourceType ZAnimation::GetResourceType() const
 	return ZResourceType::Animation;
 }
 
+Declaration* ZAnimation::DeclareAnimationData(offset_t offset, size_t size, const std::string& type,
+                                              const std::string& varName, size_t count,
+                                              const std::string& body)
+{
+	AnimationDataRegistry* registry = Globals::Instance->animationDataRegistry;
+	const AnimationDataShares* shares = Globals::Instance->animationDataShares;
+	const auto& rawData = parent->GetRawData();
+
+	// External files are parsed again by every job referring to them, and declared by their own
+	if ((registry == nullptr && shares == nullptr) || parent->isExternalFile ||
+	    offset + size > rawData.size())
+		return parent->AddDeclarationArray(offset, DeclarationAlignment::Align4, size, type,
+		                                   varName, count, body);
+
+	// 64-bit FNV-1a
+	uint64_t hash = 0xCBF29CE484222325;
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ rawData[offset + i]) * 0x100000001B3;
+
+	if (registry != nullptr)
+		registry->Add(type, hash, size, parent->GetName(), varName);
+
+	const AnimationDataShares::Share* share = shares != nullptr ? shares->Find(type, hash) : nullptr;
+	if (share == nullptr)
+		return parent->AddDeclarationArray(offset, DeclarationAlignment::Align4, size, type,
+		                                   varName, count, body);
+
+	// The references of this file go through the declaration, so they take the shared name too.
+	// A declaration of the XML keeps its own name, and its definition
+	Declaration* decl = parent->AddDeclarationArray(offset, DeclarationAlignment::Align4, size,
+	                                                type, share->symbol, count, body);
+	if (decl == nullptr || decl->declName != share->symbol)
+		return decl;
+
+	decl->staticConf = StaticConfig::Off;
+	decl->isExternReference =
+		parent->GetName() != share->canonicalFile || varName != share->canonicalSymbol;
+	return decl;
+}
+
 /* ZNormalAnimation */
 
 ZNormalAnimation::ZNormalAnimation(ZFile* nParent) : ZAnimation(nParent)
@@ -104,10 +145,9 @@ void ZNormalAnimation::DeclareReferences(const std::string& prefix)
 			valuesStr += "\n    ";
 	}
 
-	parent->AddDeclarationArray(rotationValuesOffset, DeclarationAlignment::Align4,
-	                            rotationValues.size() * 2, "s16",
-	                            StringHelper::Sprintf("%sFrameData", defaultPrefix.c_str()),
-	                            rotationValues.size(), valuesStr);
+	DeclareAnimationData(rotationValuesOffset, rotationValues.size() * 2, "s16",
+	                     StringHelper::Sprintf("%sFrameData", defaultPrefix.c_str()),
+	                     rotationValues.size(), valuesStr);
 
 	for (size_t i = 0; i < rotationIndices.size(); i++)
 	{
@@ -118,19 +158,18 @@ void ZNormalAnimation::DeclareReferences(const std::string& prefix)
 			indicesStr += "\n";
 	}
 
-	parent->AddDeclarationArray(rotationIndicesOffset, DeclarationAlignment::Align4,
-	                            rotationIndices.size() * 6, "JointIndex",
-	                            StringHelper::Sprintf("%sJointIndices", defaultPrefix.c_str()),
-	                            rotationIndices.size(), indicesStr);
+	DeclareAnimationData(rotationIndicesOffset, rotationIndices.size() * 6, "JointIndex",
+	                     StringHelper::Sprintf("%sJointIndices", defaultPrefix.c_str()),
+	                     rotationIndices.size(), indicesStr);
 }
 
 std::string ZNormalAnimation::GetBodySourceCode() const
 {
 	std::string frameDataName;
-	Globals::Instance->GetSegmentedPtrName(rotationValuesSeg, parent, "s16", frameDataName);
+	Globals::Job->GetSegmentedPtrName(rotationValuesSeg, parent, "s16", frameDataName);
 	std::string jointIndicesName;
-	Globals::Instance->GetSegmentedPtrName(rotationIndicesSeg, parent, "JointIndex",
-	                                       jointIndicesName);
+	Globals::Job->GetSegmentedPtrName(rotationIndicesSeg, parent, "JointIndex",
+	                                  jointIndicesName);
 
 	std::string headerStr =
 		StringHelper::Sprintf("\n\t{ %i }, %s,\n", frameCount, frameDataName.c_str());
@@ -153,7 +192,7 @@ size_t ZLinkAnimation::GetRawDataSize() const
 
 std::string ZLinkAnimation::GetSourceTypeName() const
 {
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 		return "PlayerAnimationHeader";
 	else
 		return "LinkAnimationHeader";
@@ -170,14 +209,14 @@ void ZLinkAnimation::ParseRawData()
 std::string ZLinkAnimation::GetBodySourceCode() const
 {
 	std::string segSymbol;
-	Globals::Instance->GetSegmentedPtrName(segmentAddress, parent, "", segSymbol);
+	Globals::Job->GetSegmentedPtrName(segmentAddress, parent, "", segSymbol);
 
 	return StringHelper::Sprintf("\n\t{ %i }, %s\n", frameCount, segSymbol.c_str());
 }
 
 /* ZCurveAnimation */
 
-CurveInterpKnot::CurveInterpKnot(ZFile* parent, const std::vector<uint8_t>& rawData,
+CurveInterpKnot::CurveInterpKnot(ZFile* parent, const DataView& rawData,
                                  uint32_t fileOffset)
 	: parent(parent)
 {
@@ -188,7 +227,7 @@ CurveInterpKnot::CurveInterpKnot(ZFile* parent, const std::vector<uint8_t>& rawD
 	unk_08 = BitConverter::ToFloatBE(rawData, fileOffset + 8);
 }
 
-CurveInterpKnot::CurveInterpKnot(ZFile* parent, const std::vector<uint8_t>& rawData,
+CurveInterpKnot::CurveInterpKnot(ZFile* parent, const DataView& rawData,
                                  uint32_t fileOffset, size_t index)
 	: CurveInterpKnot(parent, rawData, fileOffset + index * GetRawDataSize())
 {
@@ -297,9 +336,8 @@ void ZCurveAnimation::DeclareReferences(const std::string& prefix)
 		Declaration* decl = parent->GetDeclaration(refIndexOffset);
 		if (decl == nullptr)
 		{
-			parent->AddDeclarationArray(refIndexOffset, DeclarationAlignment::Align4,
-			                            arrayItemCnt * 1, "u8", refIndexStr, arrayItemCnt,
-			                            entryStr);
+			DeclareAnimationData(refIndexOffset, arrayItemCnt * 1, "u8", refIndexStr, arrayItemCnt,
+			                     entryStr);
 		}
 		else
 		{
@@ -327,10 +365,10 @@ void ZCurveAnimation::DeclareReferences(const std::string& prefix)
 		Declaration* decl = parent->GetDeclaration(transformDataOffset);
 		if (decl == nullptr)
 		{
-			parent->AddDeclarationArray(transformDataOffset, DeclarationAlignment::Align4,
-			                            arrayItemCnt * transformDataArr.at(0).GetRawDataSize(),
-			                            transformDataArr.at(0).GetSourceTypeName(),
-			                            transformDataStr, arrayItemCnt, entryStr);
+			DeclareAnimationData(transformDataOffset,
+			                     arrayItemCnt * transformDataArr.at(0).GetRawDataSize(),
+			                     transformDataArr.at(0).GetSourceTypeName(), transformDataStr,
+			                     arrayItemCnt, entryStr);
 		}
 		else
 		{
@@ -356,9 +394,8 @@ void ZCurveAnimation::DeclareReferences(const std::string& prefix)
 		Declaration* decl = parent->GetDeclaration(copyValuesOffset);
 		if (decl == nullptr)
 		{
-			parent->AddDeclarationArray(copyValuesOffset, DeclarationAlignment::Align4,
-			                            arrayItemCnt * 2, "s16", copyValuesStr, arrayItemCnt,
-			                            entryStr);
+			DeclareAnimationData(copyValuesOffset, arrayItemCnt * 2, "s16", copyValuesStr,
+			                     arrayItemCnt, entryStr);
 		}
 		else
 		{
@@ -370,12 +407,12 @@ void ZCurveAnimation::DeclareReferences(const std::string& prefix)
 std::string ZCurveAnimation::GetBodySourceCode() const
 {
 	std::string refIndexStr;
-	Globals::Instance->GetSegmentedPtrName(refIndex, parent, "u8", refIndexStr);
+	Globals::Job->GetSegmentedPtrName(refIndex, parent, "u8", refIndexStr);
 	std::string transformDataStr;
-	Globals::Instance->GetSegmentedPtrName(transformData, parent, "CurveInterpKnot",
-	                                       transformDataStr);
+	Globals::Job->GetSegmentedPtrName(transformData, parent, "CurveInterpKnot",
+	                                  transformDataStr);
 	std::string copyValuesStr;
-	Globals::Instance->GetSegmentedPtrName(copyValues, parent, "s16", copyValuesStr);
+	Globals::Job->GetSegmentedPtrName(copyValues, parent, "s16", copyValuesStr);
 
 	return StringHelper::Sprintf("\n\t%s,\n\t%s,\n\t%s,\n\t%i, %i\n", refIndexStr.c_str(),
 	                             transformDataStr.c_str(), copyValuesStr.c_str(), unk_0C, unk_10);
@@ -459,9 +496,8 @@ void ZLegacyAnimation::DeclareReferences(const std::string& prefix)
 			}
 
 			std::string frameDataName = StringHelper::Sprintf("%sFrameData", varPrefix.c_str());
-			parent->AddDeclarationArray(frameDataOffset, DeclarationAlignment::Align4,
-			                            frameDataArray.size() * 2, "s16", frameDataName,
-			                            frameDataArray.size(), frameDataBody);
+			DeclareAnimationData(frameDataOffset, frameDataArray.size() * 2, "s16", frameDataName,
+			                     frameDataArray.size(), frameDataBody);
 		}
 	}
 
@@ -483,10 +519,9 @@ void ZLegacyAnimation::DeclareReferences(const std::string& prefix)
 			}
 
 			std::string jointKeyName = StringHelper::Sprintf("%sJointKey", varPrefix.c_str());
-			parent->AddDeclarationArray(jointKeyOffset, DeclarationAlignment::Align4,
-			                            jointKeyArray.size() * res.GetRawDataSize(),
-			                            res.GetSourceTypeName(), jointKeyName, jointKeyArray.size(),
-			                            jointKeyBody);
+			DeclareAnimationData(jointKeyOffset, jointKeyArray.size() * res.GetRawDataSize(),
+			                     res.GetSourceTypeName(), jointKeyName, jointKeyArray.size(),
+			                     jointKeyBody);
 		}
 	}
 }
@@ -497,8 +532,8 @@ std::string ZLegacyAnimation::GetBodySourceCode() const
 
 	std::string frameDataName;
 	std::string jointKeyName;
-	Globals::Instance->GetSegmentedPtrName(frameData, parent, "s16", frameDataName);
-	Globals::Instance->GetSegmentedPtrName(jointKey, parent, "LegacyJointKey", jointKeyName);
+	Globals::Job->GetSegmentedPtrName(frameData, parent, "s16", frameDataName);
+	Globals::Job->GetSegmentedPtrName(jointKey, parent, "LegacyJointKey", jointKeyName);
 
 	body += StringHelper::Sprintf("\t%i, %i,\n", frameCount, limbCount);
 	body += StringHelper::Sprintf("\t%s,\n", frameDataName.c_str());
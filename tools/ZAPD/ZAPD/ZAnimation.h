@@ -27,6 +27,12 @@ public:
 
 protected:
 	void ParseRawData() override;
+
+	// Declares an array of the animation's data, which other files may carry too. It's recorded for
+	// `--anim-dedup-report`, and only an `extern` of another file's with `--anim-dedup-extern`
+	Declaration* DeclareAnimationData(offset_t offset, size_t size, const std::string& type,
+	                                  const std::string& varName, size_t count,
+	                                  const std::string& body);
 };
 
 class ZNormalAnimation : public ZAnimation
@@ -85,8 +91,8 @@ protected:
 
 public:
 	CurveInterpKnot() = default;
-	CurveInterpKnot(ZFile* parent, const std::vector<uint8_t>& rawData, uint32_t fileOffset);
-	CurveInterpKnot(ZFile* parent, const std::vector<uint8_t>& rawData, uint32_t fileOffset,
+	CurveInterpKnot(ZFile* parent, const DataView& rawData, uint32_t fileOffset);
+	CurveInterpKnot(ZFile* parent, const DataView& rawData, uint32_t fileOffset,
 	                size_t index);
 
 	[[nodiscard]] std::string GetBody(const std::string& prefix) const;
@@ -6,6 +6,7 @@
 #include "Utils/StringHelper.h"
 #include "WarningHandler.h"
 #include "ZFile.h"
+#include "ZVector.h"
 
 REGISTER_ZFILENODE(Array, ZArray);
 
@@ -41,12 +42,27 @@ void ZArray::ParseXML(tinyxml2::XMLElement* reader)
 
 	childName = child->Name();
 
-	auto nodeMap = ZFile::GetNodeMap();
+	ZResourceFactoryFunc* childFactory = ZFile::FindNodeFactory(childName);
+	if (childFactory == nullptr)
+	{
+		std::string errorHeader =
+			StringHelper::Sprintf("unknown element <%s> inside an <Array>", childName.c_str());
+		HANDLE_ERROR_RESOURCE(WarningType::InvalidXML, parent, this, rawDataIndex, errorHeader, "");
+	}
+
+	if (childName == "Scalar")
+		elementKind = ElementKind::Scalar;
+	else if (childName == "Vector")
+		elementKind = ElementKind::Vector;
+	else if (childName == "Vtx")
+		elementKind = ElementKind::Vtx;
+
 	size_t childIndex = rawDataIndex;
-	resList.reserve(arrayCnt);
-	for (size_t i = 0; i < arrayCnt; i++)
+	size_t resCount = (elementKind == ElementKind::Resource) ? arrayCnt : 1;
+	resList.reserve(resCount);
+	for (size_t i = 0; i < resCount; i++)
 	{
-		ZResource* res = nodeMap->at(childName)(parent);
+		ZResource* res = childFactory(parent);
 		if (!res->DoesSupportArray())
 		{
 			std::string errorHeader = StringHelper::Sprintf(
@@ -61,6 +77,48 @@ void ZArray::ParseXML(tinyxml2::XMLElement* reader)
 		childIndex += res->GetRawDataSize();
 		resList.push_back(res);
 	}
+
+	if (elementKind != ElementKind::Resource)
+		ParseTypedElements();
+}
+
+void ZArray::ParseTypedElements()
+{
+	const DataView& rawData = parent->GetRawData();
+	bool parseRawData = parent->GetMode() != ZFileMode::ExternalFile;
+	size_t elementSize = resList.at(0)->GetRawDataSize();
+
+	if (elementKind == ElementKind::Vtx)
+	{
+		vtxElements.resize(arrayCnt);
+		if (parseRawData)
+		{
+			for (size_t i = 0; i < arrayCnt; i++)
+				vtxElements[i].ParseRawData(rawData, rawDataIndex + i * elementSize);
+		}
+		return;
+	}
+
+	if (elementKind == ElementKind::Scalar)
+	{
+		elementScalarType = static_cast<ZScalar*>(resList.at(0))->scalarType;
+		elementDimensions = 1;
+	}
+	else
+	{
+		elementScalarType = static_cast<ZVector*>(resList.at(0))->scalarType;
+		elementDimensions = static_cast<ZVector*>(resList.at(0))->dimensions;
+	}
+
+	size_t scalarSize = ZScalar::MapTypeToSize(elementScalarType);
+	size_t scalarCount = arrayCnt * elementDimensions;
+	scalarElements.resize(scalarCount);
+	if (parseRawData)
+	{
+		for (size_t i = 0; i < scalarCount; i++)
+			scalarElements[i] =
+				ZScalar::ParseScalarData(rawData, rawDataIndex + i * scalarSize, elementScalarType);
+	}
 }
 
 Declaration* ZArray::DeclareVar(const std::string& prefix, const std::string& bodyStr)
@@ -74,7 +132,7 @@ Declaration* ZArray::DeclareVar(const std::string& prefix, const std::string& bo
 	Declaration* decl;
 	if (res->IsExternalResource())
 	{
-		auto filepath = Globals::Instance->outputPath / name;
+		auto filepath = Globals::Job->outputPath / name;
 		std::string includePath = StringHelper::Sprintf("%s.%s.inc", filepath.string().c_str(),
 		                                                res->GetExternalExtension().c_str());
 		decl = parent->AddDeclarationIncludeArray(rawDataIndex, includePath, GetRawDataSize(),
@@ -97,6 +155,43 @@ std::string ZArray::GetBodySourceCode() const
 {
 	std::string output;
 
+	// Most elements take a few characters per byte of data
+	output.reserve(GetRawDataSize() * 4);
+
+	if (elementKind != ElementKind::Resource)
+	{
+		bool isExternal = resList.at(0)->IsExternalResource();
+
+		for (size_t i = 0; i < arrayCnt; i++)
+		{
+			output += "\t";
+
+			switch (elementKind)
+			{
+			case ElementKind::Scalar:
+				ZScalar::AppendBodySourceCode(output, elementScalarType, scalarElements[i]);
+				break;
+
+			case ElementKind::Vector:
+				output += "{ ";
+				ZVector::AppendBodySourceCode(output, elementScalarType,
+				                              &scalarElements[i * elementDimensions],
+				                              elementDimensions);
+				output += " }";
+				break;
+
+			default:
+				vtxElements[i].AppendBodySourceCode(output);
+				break;
+			}
+
+			if (i < arrayCnt - 1 || isExternal)
+				output += ",\n";
+		}
+
+		return output;
+	}
+
 	for (size_t i = 0; i < arrayCnt; i++)
 	{
 		const auto& res = resList[i];
@@ -114,7 +209,9 @@ std::string ZArray::GetBodySourceCode() const
 			break;
 
 		default:
-			output += StringHelper::Sprintf("{ %s }", resList.at(i)->GetBodySourceCode().c_str());
+			output += "{ ";
+			output += resList.at(i)->GetBodySourceCode();
+			output += " }";
 			break;
 		}
 
@@ -127,6 +224,9 @@ std::string ZArray::GetBodySourceCode() const
 
 size_t ZArray::GetRawDataSize() const
 {
+	if (elementKind != ElementKind::Resource)
+		return resList.at(0)->GetRawDataSize() * arrayCnt;
+
 	size_t size = 0;
 	for (const auto res : resList)
 		size += res->GetRawDataSize();
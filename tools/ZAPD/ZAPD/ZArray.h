@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include "ZResource.h"
+#include "ZScalar.h"
+#include "ZVtx.h"
 #include "tinyxml2.h"
 
 class ZArray : public ZResource
@@ -28,4 +30,23 @@ protected:
 	size_t arrayCnt;
 	std::string childName;
 	std::vector<ZResource*> resList;
+
+	// Arrays of Scalar, Vector or Vtx only extract their first element as a resource, to check it
+	// and to describe the type. All the elements are decoded to one of these instead, and
+	// formatted in a single loop
+	enum class ElementKind
+	{
+		Resource,
+		Scalar,
+		Vector,
+		Vtx
+	};
+	ElementKind elementKind = ElementKind::Resource;
+	ZScalarType elementScalarType = ZScalarType::ZSCALAR_NONE;
+	uint32_t elementDimensions = 0;
+	std::vector<ZScalarData> scalarElements;  // elementDimensions per element, 1 for Scalar
+	std::vector<VtxData> vtxElements;
+
+	void ParseTypedElements();
 };
+
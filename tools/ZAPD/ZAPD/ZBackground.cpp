@@ -1,8 +1,12 @@
 #include "ZBackground.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "Globals.h"
 #include "Utils/BitConverter.h"
 #include "Utils/File.h"
+#include "Utils/NumberFormat.h"
 #include "Utils/Path.h"
 #include "Utils/StringHelper.h"
 #include "WarningHandler.h"
@@ -22,21 +26,27 @@ void ZBackground::ParseRawData()
 {
 	ZResource::ParseRawData();
 
+	// The JPEG is saved and emitted straight from the file's data, up to its end marker
 	const auto& rawData = parent->GetRawData();
-	size_t i = 0;
+	const uint8_t* start = rawData.data() + std::min<size_t>(rawDataIndex, rawData.size());
+	const uint8_t* end = rawData.data() + rawData.size();
+	const uint8_t* marker = start;
+
 	while (true)
 	{
-		uint8_t val = rawData.at(rawDataIndex + i);
-		data.push_back(val);
-
-		if (BitConverter::ToUInt16BE(rawData, rawDataIndex + i) == MARKER_EOI)
+		marker = static_cast<const uint8_t*>(memchr(marker, 0xFF, end - marker));
+		if (marker == nullptr || marker + 1 >= end)
 		{
-			data.push_back(rawData.at(rawDataIndex + i + 1));
-			break;
+			HANDLE_ERROR_RESOURCE(WarningType::InvalidJPEG, parent, this, rawDataIndex,
+			                      "missing end of image marker", "");
 		}
 
-		i++;
+		if (marker[1] == (MARKER_EOI & 0xFF))
+			break;
+		marker++;
 	}
+
+	data = DataView(start, marker + 2 - start);
 }
 
 void ZBackground::ParseBinaryFile(const std::string& inFolder, bool appendOutName)
@@ -46,11 +56,14 @@ void ZBackground::ParseBinaryFile(const std::string& inFolder, bool appendOutNam
 	if (appendOutName)
 		filepath = filepath / (outName + "." + GetExternalExtension());
 
-	data = File::ReadAllBytes(filepath.string());
+	fileData = File::ReadAllBytes(filepath.string());
+	data = fileData;
+	CheckValidJpeg(filepath.generic_string());
 
 	// Add padding.
-	data.insert(data.end(), GetRawDataSize() - data.size(), 0x00);
-	CheckValidJpeg(filepath.generic_string());
+	if (fileData.size() < GetRawDataSize())
+		fileData.resize(GetRawDataSize(), 0x00);
+	data = fileData;
 }
 
 void ZBackground::CheckValidJpeg(const std::string& filepath)
@@ -125,7 +138,7 @@ Declaration* ZBackground::DeclareVar(const std::string& prefix,
 	if (auxOutName == "")
 		auxOutName = GetDefaultName(prefix);
 
-	auto filepath = Globals::Instance->outputPath / fs::path(auxOutName).stem();
+	auto filepath = Globals::Job->outputPath / fs::path(auxOutName).stem();
 
 	std::string incStr =
 		StringHelper::Sprintf("%s.%s.inc.c", filepath.c_str(), GetExternalExtension().c_str());
@@ -156,23 +169,36 @@ std::string ZBackground::GetExternalExtension() const
 void ZBackground::Save(const fs::path& outFolder)
 {
 	fs::path filepath = outFolder / (outName + "." + GetExternalExtension());
-	File::WriteAllBytes(filepath.string(), data);
+	File::WriteAllBytes(filepath.string(), reinterpret_cast<const char*>(data.data()),
+	                    data.size());
 }
 
 std::string ZBackground::GetBodySourceCode() const
 {
-	std::string bodyStr = "    ";
+	std::string bodyStr;
+
+	// "0x0000000000000000, " for each 8 bytes, plus the indentation of every line
+	bodyStr.resize(data.size() / 8 * 20 + (data.size() / 64 + 1) * 5 + 1);
+	char* p = bodyStr.data();
 
+	memcpy(p, "    ", 4);
+	p += 4;
 	for (size_t i = 0; i < data.size() / 8; ++i)
 	{
-		bodyStr += StringHelper::Sprintf("0x%016llX, ", BitConverter::ToUInt64BE(data, i * 8));
+		p = NumberFormat::Hex(p, BitConverter::ToUInt64BE(data, i * 8), 16);
+		*p++ = ',';
+		*p++ = ' ';
 
 		if (i % 8 == 7)
-			bodyStr += "\n    ";
+		{
+			memcpy(p, "\n    ", 5);
+			p += 5;
+		}
 	}
 
-	bodyStr += "\n";
+	*p++ = '\n';
 
+	bodyStr.resize(p - bodyStr.data());
 	return bodyStr;
 }
 
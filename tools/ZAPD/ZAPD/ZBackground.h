@@ -2,12 +2,14 @@
 
 #include <cstdint>
 #include <vector>
+#include "Utils/DataView.h"
 #include "ZResource.h"
 
 class ZBackground : public ZResource
 {
 protected:
-	std::vector<uint8_t> data;
+	DataView data;                  // the JPEG, in the file's raw data or in fileData
+	std::vector<uint8_t> fileData;  // a JPEG read by ParseBinaryFile, padded to the screen size
 
 public:
 	ZBackground(ZFile* nParent);
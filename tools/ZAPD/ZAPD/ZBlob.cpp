@@ -3,6 +3,7 @@
 #include "Globals.h"
 #include "Utils/BitConverter.h"
 #include "Utils/File.h"
+#include "Utils/NumberFormat.h"
 #include "Utils/Path.h"
 #include "Utils/StringHelper.h"
 #include "ZFile.h"
@@ -51,7 +52,7 @@ Declaration* ZBlob::DeclareVar(const std::string& prefix,
 	std::string path = Path::GetFileNameWithoutExtension(auxOutName);
 
 	std::string assetOutDir =
-		(Globals::Instance->outputPath / Path::GetFileNameWithoutExtension(GetOutName())).string();
+		(Globals::Job->outputPath / Path::GetFileNameWithoutExtension(GetOutName())).string();
 
 	std::string incStr =
 		StringHelper::Sprintf("%s.%s.inc.c", assetOutDir.c_str(), GetExternalExtension().c_str());
@@ -62,30 +63,39 @@ Declaration* ZBlob::DeclareVar(const std::string& prefix,
 
 std::string ZBlob::GetBodySourceCode() const
 {
+	size_t size = blobData.size();
 	std::string sourceOutput;
 
-	for (size_t i = 0; i < blobData.size(); i += 1)
+	// "0x00, " for each byte, plus the indentation and line feed of every 16 bytes, and the final
+	// line feed
+	sourceOutput.resize(size * 6 + (size + 15) / 16 + size / 16 + 1);
+	char* p = sourceOutput.data();
+
+	for (size_t i = 0; i < size; i++)
 	{
 		if (i % 16 == 0)
-			sourceOutput += "\t";
+			*p++ = '\t';
 
-		sourceOutput += StringHelper::Sprintf("0x%02X, ", blobData[i]);
+		p = NumberFormat::Hex(p, blobData[i], 2);
+		*p++ = ',';
+		*p++ = ' ';
 
 		if (i % 16 == 15)
-			sourceOutput += "\n";
+			*p++ = '\n';
 	}
 
 	// Ensure there's always a trailing line feed to prevent dumb warnings.
 	// Please don't remove this line, unless you somehow made a way to prevent
 	// that warning when building the OoT repo.
-	sourceOutput += "\n";
+	*p++ = '\n';
 
+	sourceOutput.resize(p - sourceOutput.data());
 	return sourceOutput;
 }
 
 void ZBlob::Save(const fs::path& outFolder)
 {
-	File::WriteAllBytes((outFolder / (name + ".bin")).string(), blobData);
+	File::WriteAllBytesIfChanged(outFolder / (name + ".bin"), blobData);
 }
 
 bool ZBlob::IsExternalResource() const
@@ -115,9 +115,9 @@ std::string ZKeyFrameSkel::GetBodySourceCode() const
 	std::string limbStr;
 
 	if (limbType == ZKeyframeSkelType::Normal)
-		Globals::Instance->GetSegmentedPtrName(limbsPtr, parent, "KeyFrameStandardLimb", limbStr);
+		Globals::Job->GetSegmentedPtrName(limbsPtr, parent, "KeyFrameStandardLimb", limbStr);
 	else
-		Globals::Instance->GetSegmentedPtrName(limbsPtr, parent, "KeyFrameFlexLimb", limbStr);
+		Globals::Job->GetSegmentedPtrName(limbsPtr, parent, "KeyFrameFlexLimb", limbStr);
 
 	return StringHelper::Sprintf("\n\t0x%02X, 0x%02X, %s\n", limbCount, dListCount,
 	                             limbStr.c_str());
@@ -240,7 +240,7 @@ std::string ZKeyFrameStandardLimb::GetBodySourceCode() const
 	std::string declaration;
 	std::string dlString;
 
-	Globals::Instance->GetSegmentedArrayIndexedName(dlist, 8, parent, "Gfx", dlString);
+	Globals::Job->GetSegmentedArrayIndexedName(dlist, 8, parent, "Gfx", dlString);
 
 	declaration +=
 		StringHelper::Sprintf("%s, 0x%02X, 0x%02X, { 0x%04X, 0x%04X, 0x%04X},", dlString.c_str(),
@@ -254,7 +254,7 @@ std::string ZKeyFrameFlexLimb::GetBodySourceCode() const
 
 	std::string dlString;
 
-	Globals::Instance->GetSegmentedArrayIndexedName(dlist, 8, parent, "Gfx", dlString);
+	Globals::Job->GetSegmentedArrayIndexedName(dlist, 8, parent, "Gfx", dlString);
 
 	declaration += StringHelper::Sprintf("%s, 0x%02X, 0x%02X, 0x%02X", dlString.c_str(),
 	                                     numChildren, flags, callbackIndex);
@@ -179,10 +179,10 @@ std::string ZKeyFrameAnim::GetBodySourceCode() const
 	std::string kfNumsStr;
 	std::string presetValuesStr;
 
-	Globals::Instance->GetSegmentedPtrName(bitFlagsAddr, parent, "", bitFlagsStr);
-	Globals::Instance->GetSegmentedPtrName(keyFramesAddr, parent, "", keyFrameStr);
-	Globals::Instance->GetSegmentedPtrName(kfNumsAddr, parent, "", kfNumsStr);
-	Globals::Instance->GetSegmentedPtrName(presentValuesAddr, parent, "", presetValuesStr);
+	Globals::Job->GetSegmentedPtrName(bitFlagsAddr, parent, "", bitFlagsStr);
+	Globals::Job->GetSegmentedPtrName(keyFramesAddr, parent, "", keyFrameStr);
+	Globals::Job->GetSegmentedPtrName(kfNumsAddr, parent, "", kfNumsStr);
+	Globals::Job->GetSegmentedPtrName(presentValuesAddr, parent, "", presetValuesStr);
 
 	return StringHelper::Sprintf("\n\t%s, %s, %s, %s, 0x%04X, 0x%04X\n", bitFlagsStr.c_str(),
 	                             keyFrameStr.c_str(), kfNumsStr.c_str(), presetValuesStr.c_str(),
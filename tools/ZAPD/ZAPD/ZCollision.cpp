@@ -1,16 +1,108 @@
 #include "ZCollision.h"
 #include "ZWaterbox.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <string>
+#include <thread>
 
 #include "Globals.h"
 #include "Utils/BitConverter.h"
+#include "Utils/NumberFormat.h"
 #include "Utils/StringHelper.h"
 
 REGISTER_ZFILENODE(Collision, ZCollisionHeader);
 
+#define COLLISION_VTX_SIZE 6
+#define COLLISION_POLY_SIZE 16
+
+// Lists shorter than this are formatted on the calling thread, splitting them costs more
+#define PARALLEL_FORMAT_MIN_LINES 0x2000
+
+/**
+ * Formats `count` lines with `appendLine(output, i)`, separated by newlines. Long lists are split
+ * in consecutive chunks formatted on `pngThreadCount` threads and joined in order, so the result
+ * is the same as formatting them one after the other. `appendLine` must only read what it formats.
+ */
+template <typename AppendLine>
+static std::string FormatLines(size_t count, size_t lineSize, AppendLine appendLine)
+{
+	uint32_t threadCount = Globals::Instance->pngThreadCount;
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	threadCount = std::min<size_t>(threadCount, count / PARALLEL_FORMAT_MIN_LINES);
+
+	auto formatChunk = [&](std::string& output, size_t start, size_t end) {
+		output.reserve((end - start) * (lineSize + 1));
+		for (size_t i = start; i < end; i++)
+		{
+			appendLine(output, i);
+			if (i + 1 < count)
+				output += '\n';
+		}
+	};
+
+	if (threadCount <= 1)
+	{
+		std::string output;
+		formatChunk(output, 0, count);
+		return output;
+	}
+
+	std::vector<std::string> chunks(threadCount);
+	std::vector<std::thread> workers;
+	size_t chunkSize = (count + threadCount - 1) / threadCount;
+
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		size_t start = std::min(count, i * chunkSize);
+		size_t end = std::min(count, start + chunkSize);
+		workers.emplace_back(formatChunk, std::ref(chunks[i]), start, end);
+	}
+	for (std::thread& worker : workers)
+		worker.join();
+
+	std::string output;
+	output.reserve(count * (lineSize + 1));
+	for (const std::string& chunk : chunks)
+		output += chunk;
+	return output;
+}
+
+// "\t{ %6i, %6i, %6i },", the way ZVector formats a Vec3s
+#define VEC3S_LINE_SIZE sizeof("\t{ -32768, -32768, -32768 },")
+
+static void AppendVec3sLine(std::string& output, int16_t x, int16_t y, int16_t z)
+{
+	char buf[VEC3S_LINE_SIZE];
+	char* p = buf;
+	int16_t coords[3] = {x, y, z};
+
+	*p++ = '\t';
+	*p++ = '{';
+	*p++ = ' ';
+	for (size_t i = 0; i < 3; i++)
+	{
+		char num[NumberFormat::MaxSize];
+		char* numEnd = NumberFormat::Dec(num, coords[i]);
+
+		// Right-aligned in 6 columns, which the widest s16 fills
+		for (ptrdiff_t len = numEnd - num; len < 6; len++)
+			*p++ = ' ';
+		p = std::copy(num, numEnd, p);
+		if (i < 2)
+		{
+			*p++ = ',';
+			*p++ = ' ';
+		}
+	}
+	*p++ = ' ';
+	*p++ = '}';
+	*p++ = ',';
+	output.append(buf, p - buf);
+}
+
 ZCollisionHeader::ZCollisionHeader(ZFile* nParent) : ZResource(nParent)
 {
 }
@@ -49,35 +141,40 @@ void ZCollisionHeader::ParseRawData()
 	camDataSegmentOffset = Seg2Filespace(camDataAddress, parent->baseAddress);
 	waterBoxSegmentOffset = Seg2Filespace(waterBoxAddress, parent->baseAddress);
 
-	vertices.reserve(numVerts);
-	polygons.reserve(numPolygons);
 	waterBoxes.reserve(numWaterBoxes);
 
-	offset_t currentPtr = vtxSegmentOffset;
-
+	// Decoded straight from the data, without a ZVector or ZCollisionPoly for each
+	vertices.x.resize(numVerts);
+	vertices.y.resize(numVerts);
+	vertices.z.resize(numVerts);
 	for (uint16_t i = 0; i < numVerts; i++)
 	{
-		ZVector vec(parent);
-		vec.ExtractFromBinary(currentPtr, ZScalarType::ZSCALAR_S16, 3);
+		offset_t vtxOffset = vtxSegmentOffset + i * COLLISION_VTX_SIZE;
 
-		currentPtr += vec.GetRawDataSize();
-		vertices.push_back(vec);
+		vertices.x[i] = BitConverter::ToInt16BE(rawData, vtxOffset + 0);
+		vertices.y[i] = BitConverter::ToInt16BE(rawData, vtxOffset + 2);
+		vertices.z[i] = BitConverter::ToInt16BE(rawData, vtxOffset + 4);
 	}
 
+	std::vector<uint16_t>* polyFields[] = {&polygons.type,  &polygons.vtxA,  &polygons.vtxB,
+	                                       &polygons.vtxC,  &polygons.normX, &polygons.normY,
+	                                       &polygons.normZ, &polygons.dist};
+	for (std::vector<uint16_t>* field : polyFields)
+		field->resize(numPolygons);
 	for (uint16_t i = 0; i < numPolygons; i++)
 	{
-		ZCollisionPoly poly(parent);
-		poly.SetRawDataIndex(polySegmentOffset + (i * 16));
-		poly.ParseRawData();
-		polygons.push_back(poly);
+		offset_t polyOffset = polySegmentOffset + i * COLLISION_POLY_SIZE;
+
+		for (size_t j = 0; j < 8; j++)
+			(*polyFields[j])[i] = BitConverter::ToUInt16BE(rawData, polyOffset + j * 2);
 	}
 
 	uint16_t highestPolyType = 0;
 
-	for (const ZCollisionPoly& poly : polygons)
+	for (uint16_t polyType : polygons.type)
 	{
-		if (poly.type > highestPolyType)
-			highestPolyType = poly.type;
+		if (polyType > highestPolyType)
+			highestPolyType = polyType;
 	}
 
 	for (uint16_t i = 0; i < highestPolyType + 1; i++)
@@ -144,7 +241,7 @@ void ZCollisionHeader::ParseRawData()
 		ZWaterbox waterbox(parent);
 
 		waterbox.SetRawDataIndex(waterBoxSegmentOffset +
-		                         (i * (Globals::Instance->game == ZGame::OOT_SW97 ? 12 : 16)));
+		                         (i * (Globals::Job->game == ZGame::OOT_SW97 ? 12 : 16)));
 		waterbox.ParseRawData();
 		waterBoxes.emplace_back(waterbox);
 	}
@@ -177,17 +274,34 @@ void ZCollisionHeader::DeclareReferences(const std::string& prefix)
 
 	if (polygons.size() > 0)
 	{
-		declaration.clear();
-
-		for (size_t i = 0; i < polygons.size(); i++)
-		{
-			declaration += StringHelper::Sprintf("\t%s,", polygons[i].GetBodySourceCode().c_str());
-			if (i + 1 < polygons.size())
-				declaration += "\n";
-		}
+		// "\t{0x%04X, 0x%04X, 0x%04X, 0x%04X, 0x%04X, 0x%04X, 0x%04X, 0x%04X},"
+		const std::vector<uint16_t>* polyFields[] = {
+			&polygons.type,  &polygons.vtxA,  &polygons.vtxB,  &polygons.vtxC,
+			&polygons.normX, &polygons.normY, &polygons.normZ, &polygons.dist};
+		size_t lineSize = sizeof("\t{0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},");
+
+		declaration = FormatLines(polygons.size(), lineSize, [&](std::string& output, size_t i) {
+			char buf[sizeof("\t{},") + 8 * (NumberFormat::MaxSize + 2)];
+			char* p = buf;
+
+			*p++ = '\t';
+			*p++ = '{';
+			for (size_t j = 0; j < 8; j++)
+			{
+				p = NumberFormat::Hex(p, (*polyFields[j])[i], 4);
+				if (j < 7)
+				{
+					*p++ = ',';
+					*p++ = ' ';
+				}
+			}
+			*p++ = '}';
+			*p++ = ',';
+			output.append(buf, p - buf);
+		});
 
 		parent->AddDeclarationArray(polySegmentOffset, DeclarationAlignment::Align4,
-		                            polygons.size() * 16, polygons[0].GetSourceTypeName().c_str(),
+		                            polygons.size() * COLLISION_POLY_SIZE, "CollisionPoly",
 		                            StringHelper::Sprintf("%sPolygons", auxName.c_str()),
 		                            polygons.size(), declaration);
 	}
@@ -209,23 +323,17 @@ void ZCollisionHeader::DeclareReferences(const std::string& prefix)
 
 	if (vertices.size() > 0)
 	{
-		declaration.clear();
+		declaration = FormatLines(vertices.size(), VEC3S_LINE_SIZE,
+		                          [this](std::string& output, size_t i) {
+									  AppendVec3sLine(output, vertices.x[i], vertices.y[i],
+			                                          vertices.z[i]);
+								  });
 
-		for (size_t i = 0; i < vertices.size(); i++)
-		{
-			declaration +=
-				StringHelper::Sprintf("\t{ %s },", vertices[i].GetBodySourceCode().c_str());
-
-			if (i < vertices.size() - 1)
-				declaration += "\n";
-		}
-
-		const auto& first = vertices.front();
 		if (vtxAddress != 0)
 			parent->AddDeclarationArray(
-				vtxSegmentOffset, first.GetDeclarationAlignment(),
-				vertices.size() * first.GetRawDataSize(), first.GetSourceTypeName(),
-				StringHelper::Sprintf("%sVertices", auxName.c_str()), vertices.size(), declaration);
+				vtxSegmentOffset, DeclarationAlignment::Align4, vertices.size() * COLLISION_VTX_SIZE,
+				"Vec3s", StringHelper::Sprintf("%sVertices", auxName.c_str()), vertices.size(),
+				declaration);
 	}
 }
 
@@ -239,7 +347,7 @@ std::string ZCollisionHeader::GetBodySourceCode() const
 	declaration += StringHelper::Sprintf("\t{ %i, %i, %i },\n", absMaxX, absMaxY, absMaxZ);
 
 	std::string vtxName;
-	Globals::Instance->GetSegmentedPtrName(vtxAddress, parent, "Vec3s", vtxName);
+	Globals::Job->GetSegmentedPtrName(vtxAddress, parent, "Vec3s", vtxName);
 
 	if (numVerts > 0)
 		declaration +=
@@ -248,7 +356,7 @@ std::string ZCollisionHeader::GetBodySourceCode() const
 		declaration += StringHelper::Sprintf("\t%i, %s,\n", numVerts, vtxName.c_str());
 
 	std::string polyName;
-	Globals::Instance->GetSegmentedPtrName(polyAddress, parent, "CollisionPoly", polyName);
+	Globals::Job->GetSegmentedPtrName(polyAddress, parent, "CollisionPoly", polyName);
 
 	if (numPolygons > 0)
 		declaration +=
@@ -257,15 +365,15 @@ std::string ZCollisionHeader::GetBodySourceCode() const
 		declaration += StringHelper::Sprintf("\t%i, %s,\n", numPolygons, polyName.c_str());
 
 	std::string surfaceName;
-	Globals::Instance->GetSegmentedPtrName(polyTypeDefAddress, parent, "SurfaceType", surfaceName);
+	Globals::Job->GetSegmentedPtrName(polyTypeDefAddress, parent, "SurfaceType", surfaceName);
 	declaration += StringHelper::Sprintf("\t%s,\n", surfaceName.c_str());
 
 	std::string camName;
-	Globals::Instance->GetSegmentedPtrName(camDataAddress, parent, "BgCamInfo", camName);
+	Globals::Job->GetSegmentedPtrName(camDataAddress, parent, "BgCamInfo", camName);
 	declaration += StringHelper::Sprintf("\t%s,\n", camName.c_str());
 
 	std::string waterBoxName;
-	Globals::Instance->GetSegmentedPtrName(waterBoxAddress, parent, "WaterBox", waterBoxName);
+	Globals::Job->GetSegmentedPtrName(waterBoxAddress, parent, "WaterBox", waterBoxName);
 
 	if (numWaterBoxes > 0)
 		declaration += StringHelper::Sprintf("\tARRAY_COUNT(%s), %s\n", waterBoxName.c_str(),
@@ -297,7 +405,7 @@ size_t ZCollisionHeader::GetRawDataSize() const
 }
 
 CameraDataList::CameraDataList(ZFile* parent, const std::string& prefix,
-                               const std::vector<uint8_t>& rawData, offset_t rawDataIndex,
+                               const DataView& rawData, offset_t rawDataIndex,
                                offset_t upperCameraBoundary)
 {
 	std::string declaration;
@@ -381,17 +489,14 @@ CameraDataList::CameraDataList(ZFile* parent, const std::string& prefix,
 
 	if (numDataTotal > 0)
 	{
-		declaration.clear();
 		cameraPositionData.reserve(numDataTotal);
 		for (uint32_t i = 0; i < numDataTotal; i++)
-		{
-			CameraPositionData data = CameraPositionData(rawData, cameraPosDataOffset + (i * 6));
+			cameraPositionData.emplace_back(rawData, cameraPosDataOffset + (i * 6));
 
-			declaration += StringHelper::Sprintf("\t{ %6i, %6i, %6i },", data.x, data.y, data.z);
-			cameraPositionData.emplace_back(data);
-			if (i + 1 < numDataTotal)
-				declaration += "\n";
-		}
+		declaration = FormatLines(numDataTotal, VEC3S_LINE_SIZE, [this](std::string& output, size_t i) {
+			const CameraPositionData& data = cameraPositionData[i];
+			AppendVec3sLine(output, data.x, data.y, data.z);
+		});
 
 		uint32_t cameraPosDataIndex = GETSEGOFFSET(cameraPosDataSeg);
 		uint32_t entrySize = numDataTotal * 0x6;
@@ -405,7 +510,7 @@ CameraDataList::~CameraDataList()
 {
 }
 
-CameraPositionData::CameraPositionData(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex)
+CameraPositionData::CameraPositionData(const DataView& rawData, uint32_t rawDataIndex)
 {
 	x = BitConverter::ToInt16BE(rawData, rawDataIndex + 0);
 	y = BitConverter::ToInt16BE(rawData, rawDataIndex + 2);
@@ -13,7 +13,7 @@ class CameraPositionData
 public:
 	int16_t x, y, z;
 
-	CameraPositionData(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex);
+	CameraPositionData(const DataView& rawData, uint32_t rawDataIndex);
 };
 
 class CameraDataEntry
@@ -30,11 +30,32 @@ public:
 	std::vector<CameraDataEntry> entries;
 	std::vector<CameraPositionData> cameraPositionData;
 
-	CameraDataList(ZFile* parent, const std::string& prefix, const std::vector<uint8_t>& rawData,
+	CameraDataList(ZFile* parent, const std::string& prefix, const DataView& rawData,
 	               offset_t rawDataIndex, offset_t upperCameraBoundary);
 	~CameraDataList();
 };
 
+// The vertices of a collision header, decoded in bulk one coordinate per array
+class CollisionVertexList
+{
+public:
+	std::vector<int16_t> x, y, z;
+
+	size_t size() const { return x.size(); }
+};
+
+// The polygons of a collision header, decoded in bulk one field per array
+class CollisionPolyList
+{
+public:
+	std::vector<uint16_t> type;
+	std::vector<uint16_t> vtxA, vtxB, vtxC;
+	std::vector<uint16_t> normX, normY, normZ;
+	std::vector<uint16_t> dist;
+
+	size_t size() const { return type.size(); }
+};
+
 class ZCollisionHeader : public ZResource
 {
 public:
@@ -53,8 +74,8 @@ public:
 	uint32_t vtxSegmentOffset, polySegmentOffset, polyTypeDefSegmentOffset, camDataSegmentOffset,
 		waterBoxSegmentOffset;
 
-	std::vector<ZVector> vertices;
-	std::vector<ZCollisionPoly> polygons;
+	CollisionVertexList vertices;
+	CollisionPolyList polygons;
 	std::vector<ZSurfaceType> polygonTypes;
 	std::vector<ZWaterbox> waterBoxes;
 	CameraDataList* camData = nullptr;
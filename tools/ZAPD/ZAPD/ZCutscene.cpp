@@ -1,9 +1,13 @@
 #include "ZCutscene.h"
 
 #include <cassert>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
 
 #include "Globals.h"
 #include "Utils/BitConverter.h"
+#include "Utils/NumberFormat.h"
 #include "Utils/StringHelper.h"
 #include "WarningHandler.h"
 #include "ZResource.h"
@@ -29,7 +33,8 @@ std::string ZCutscene::GetBodySourceCode() const
 	for (size_t i = 0; i < commands.size(); i++)
 	{
 		CutsceneCommand* cmd = commands[i];
-		output += "    " + cmd->GenerateSourceCode();
+		output += "    ";
+		output += cmd->GenerateSourceCode();
 	}
 
 	output += StringHelper::Sprintf("    CS_END(),");
@@ -52,7 +57,7 @@ size_t ZCutscene::GetRawDataSize() const
 	}
 
 	// End
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 	{
 		size += 4;
 	}
@@ -72,6 +77,7 @@ void ZCutscene::ParseRawData()
 
 	numCommands = BitConverter::ToInt32BE(rawData, rawDataIndex + 0);
 	commands = std::vector<CutsceneCommand*>();
+	CutscenePool::Scope poolScope(pool);
 
 	endFrame = BitConverter::ToInt32BE(rawData, rawDataIndex + 4);
 	offset_t currentPtr = rawDataIndex + 8;
@@ -92,7 +98,7 @@ void ZCutscene::ParseRawData()
 
 		CutsceneCommand* cmd = nullptr;
 
-		if (Globals::Instance->game == ZGame::MM_RETAIL)
+		if (Globals::Job->game == ZGame::MM_RETAIL)
 		{
 			cmd = GetCommandMM(id, currentPtr);
 		}
@@ -126,227 +132,232 @@ void ZCutscene::ParseRawData()
 	}
 }
 
-CutsceneCommand* ZCutscene::GetCommandOoT(uint32_t id, offset_t currentPtr) const
+/**
+ * The command classes of every command ID of a game, looked up in a table instead of going through
+ * a switch for every command. IDs past the end of the table or without a class of their own get
+ * `fallback`.
+ */
+class CutsceneCommandTable
 {
-	CutsceneOoT_CommandType cmdID = static_cast<CutsceneOoT_CommandType>(id);
+public:
+	typedef CutsceneCommand* (*Factory)(const DataView& rawData, offset_t rawDataIndex,
+	                                    uint32_t id);
 
-	const auto& rawData = parent->GetRawData();
+	CutsceneCommandTable(size_t size, Factory nFallback)
+		: factories(size, nFallback), fallback(nFallback)
+	{
+	}
 
-	switch (cmdID)
+	template <typename T>
+	void Set(T id, Factory factory)
 	{
-	case CutsceneOoT_CommandType::CS_CMD_PLAYER_CUE:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_0:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_0:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_1:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_1:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_2:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_3:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_2:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_0:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_0:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_0:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_0:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_4:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_3:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_1:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_1:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_1:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_5:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_4:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_2:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_2:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_2:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_0:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_6:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_3:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_5:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_0:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_3:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_3:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_1:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_4:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_4:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_1:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_2:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_3:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_1:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_8_0:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_5:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_6:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_6:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_7:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_4:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_7:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_5:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_8:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_6:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_7:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_8:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_7:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_2:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_9:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_5:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_10:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_8:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_9:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_6:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_3:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_8:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_4:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_2:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_4:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_9:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_11:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_10:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_9:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_11:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_10:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_12:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_3:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_4:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_5:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_12:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_10:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_13:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_13:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_14:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_11:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_14:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_15:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_12:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_11:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_7:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_5:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_6:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_16:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_13:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_12:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_5:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_8:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_6:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_7:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_15:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_16:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_17:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_6:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_9_0:
-	case CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_17:
-		return new CutsceneOoTCommand_ActorCue(rawData, currentPtr);
-
-	case CutsceneOoT_CommandType::CS_CMD_MISC:
-	case CutsceneOoT_CommandType::CS_CMD_LIGHT_SETTING:
-	case CutsceneOoT_CommandType::CS_CMD_START_SEQ:
-	case CutsceneOoT_CommandType::CS_CMD_STOP_SEQ:
-	case CutsceneOoT_CommandType::CS_CMD_FADE_OUT_SEQ:
-		return new CutsceneOoTCommand_GenericCmd(rawData, currentPtr, cmdID);
-
-	case CutsceneOoT_CommandType::CS_CMD_CAM_EYE_SPLINE:
-	case CutsceneOoT_CommandType::CS_CMD_CAM_AT_SPLINE:
-	case CutsceneOoT_CommandType::CS_CMD_CAM_EYE_SPLINE_REL_TO_PLAYER:
-	case CutsceneOoT_CommandType::CS_CMD_CAM_AT_SPLINE_REL_TO_PLAYER:
-		return new CutsceneOoTCommand_GenericCameraCmd(rawData, currentPtr);
-
-	case CutsceneOoT_CommandType::CS_CMD_RUMBLE_CONTROLLER:
-		return new CutsceneOoTCommand_Rumble(rawData, currentPtr);
-
-	case CutsceneOoT_CommandType::CS_CMD_TEXT:
-		return new CutsceneOoTCommand_Text(rawData, currentPtr);
-
-	case CutsceneOoT_CommandType::CS_CMD_TRANSITION:
-		return new CutsceneOoTCommand_Transition(rawData, currentPtr);
-
-	case CutsceneOoT_CommandType::CS_CMD_TIME:
-		return new CutsceneCommand_Time(rawData, currentPtr);
-
-	case CutsceneOoT_CommandType::CS_CMD_DESTINATION:
-		return new CutsceneOoTCommand_Destination(rawData, currentPtr);
-
-	case CutsceneOoT_CommandType::CS_CMD_CAM_EYE:
-	case CutsceneOoT_CommandType::CS_CMD_CAM_AT:
-		break;
+		factories.at(static_cast<size_t>(id)) = factory;
+	}
 
-	default:
-		std::string errorHeader =
-			StringHelper::Sprintf("Warning: Invalid cutscene command ID: '0x%04X'", cmdID);
-		return new CutsceneOoTCommand_GenericCmd(rawData, currentPtr, cmdID);
+	CutsceneCommand* New(const DataView& rawData, offset_t rawDataIndex, uint32_t id) const
+	{
+		Factory factory = (id < factories.size()) ? factories[id] : fallback;
+
+		return factory(rawData, rawDataIndex, id);
 	}
 
+private:
+	std::vector<Factory> factories;
+	Factory fallback;
+};
+
+template <typename T>
+static CutsceneCommand* NewCsCommand(const DataView& rawData, offset_t rawDataIndex,
+                                     [[maybe_unused]] uint32_t id)
+{
+	return new T(rawData, rawDataIndex);
+}
+
+template <typename T, typename CommandType>
+static CutsceneCommand* NewCsGenericCmd(const DataView& rawData, offset_t rawDataIndex, uint32_t id)
+{
+	return new T(rawData, rawDataIndex, static_cast<CommandType>(id));
+}
+
+// ParseRawData warns about these and reads them as CutsceneMMCommand_NonImplemented
+static CutsceneCommand* NewCsNonImplemented([[maybe_unused]] const DataView& rawData,
+                                            [[maybe_unused]] offset_t rawDataIndex,
+                                            [[maybe_unused]] uint32_t id)
+{
 	return nullptr;
 }
 
-CutsceneCommand* ZCutscene::GetCommandMM(uint32_t id, offset_t currentPtr) const
+static CutsceneCommandTable MakeCommandTableOoT()
 {
-	CutsceneMM_CommandType cmdID = static_cast<CutsceneMM_CommandType>(id);
+	CutsceneCommandTable table(
+		static_cast<size_t>(CutsceneOoT_CommandType::CS_CMD_DESTINATION) + 1,
+		NewCsGenericCmd<CutsceneOoTCommand_GenericCmd, CutsceneOoT_CommandType>);
+	static const CutsceneOoT_CommandType actorCues[] = {
+		CutsceneOoT_CommandType::CS_CMD_PLAYER_CUE,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_0,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_0,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_1,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_1,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_2,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_3,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_2,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_0,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_0,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_0,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_0,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_4,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_3,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_1,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_1,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_1,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_5,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_4,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_2,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_2,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_2,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_0,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_6,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_3,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_5,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_0,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_3,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_3,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_1,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_4,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_4,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_1,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_2,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_3,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_1,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_8_0,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_5,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_6,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_6,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_7,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_4,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_7,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_5,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_8,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_6,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_7,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_8,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_7,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_2,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_9,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_5,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_10,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_8,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_9,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_6,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_3,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_8,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_4,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_2,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_4,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_9,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_11,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_10,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_9,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_11,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_10,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_12,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_3,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_4,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_5,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_12,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_10,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_13,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_13,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_14,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_11,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_14,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_15,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_12,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_11,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_7,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_5,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_6,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_16,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_2_13,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_3_12,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_5,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_4_8,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_5_6,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_6_7,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_15,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_16,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_1_17,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_7_6,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_9_0,
+		CutsceneOoT_CommandType::CS_CMD_ACTOR_CUE_0_17,
+	};
+
+	for (CutsceneOoT_CommandType id : actorCues)
+		table.Set(id, NewCsCommand<CutsceneOoTCommand_ActorCue>);
+
+	table.Set(CutsceneOoT_CommandType::CS_CMD_CAM_EYE_SPLINE,
+	          NewCsCommand<CutsceneOoTCommand_GenericCameraCmd>);
+	table.Set(CutsceneOoT_CommandType::CS_CMD_CAM_AT_SPLINE,
+	          NewCsCommand<CutsceneOoTCommand_GenericCameraCmd>);
+	table.Set(CutsceneOoT_CommandType::CS_CMD_CAM_EYE_SPLINE_REL_TO_PLAYER,
+	          NewCsCommand<CutsceneOoTCommand_GenericCameraCmd>);
+	table.Set(CutsceneOoT_CommandType::CS_CMD_CAM_AT_SPLINE_REL_TO_PLAYER,
+	          NewCsCommand<CutsceneOoTCommand_GenericCameraCmd>);
+	table.Set(CutsceneOoT_CommandType::CS_CMD_RUMBLE_CONTROLLER,
+	          NewCsCommand<CutsceneOoTCommand_Rumble>);
+	table.Set(CutsceneOoT_CommandType::CS_CMD_TEXT, NewCsCommand<CutsceneOoTCommand_Text>);
+	table.Set(CutsceneOoT_CommandType::CS_CMD_TRANSITION,
+	          NewCsCommand<CutsceneOoTCommand_Transition>);
+	table.Set(CutsceneOoT_CommandType::CS_CMD_TIME, NewCsCommand<CutsceneCommand_Time>);
+	table.Set(CutsceneOoT_CommandType::CS_CMD_DESTINATION,
+	          NewCsCommand<CutsceneOoTCommand_Destination>);
+	table.Set(CutsceneOoT_CommandType::CS_CMD_CAM_EYE, NewCsNonImplemented);
+	table.Set(CutsceneOoT_CommandType::CS_CMD_CAM_AT, NewCsNonImplemented);
+
+	return table;
+}
 
-	const auto& rawData = parent->GetRawData();
+static CutsceneCommandTable MakeCommandTableMM()
+{
+	CutsceneCommandTable table(
+		static_cast<size_t>(CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_599) + 1,
+		NewCsGenericCmd<CutsceneMMCommand_GenericCmd, CutsceneMM_CommandType>);
+
+	for (uint32_t id = (uint32_t)CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_100;
+	     id <= (uint32_t)CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_149; id++)
+		table.Set(id, NewCsCommand<CutsceneMMCommand_ActorCue>);
+	for (uint32_t id = (uint32_t)CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_450;
+	     id <= (uint32_t)CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_599; id++)
+		table.Set(id, NewCsCommand<CutsceneMMCommand_ActorCue>);
+	table.Set(CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_201,
+	          NewCsCommand<CutsceneMMCommand_ActorCue>);
+	table.Set(CutsceneMM_CommandType::CS_CMD_PLAYER_CUE, NewCsCommand<CutsceneMMCommand_ActorCue>);
+
+	table.Set(CutsceneMM_CommandType::CS_CMD_TEXT, NewCsCommand<CutsceneMMCommand_Text>);
+	table.Set(CutsceneMM_CommandType::CS_CMD_CAMERA_SPLINE,
+	          NewCsCommand<CutsceneMMCommand_Spline>);
+	table.Set(CutsceneMM_CommandType::CS_CMD_TRANSITION_GENERAL,
+	          NewCsCommand<CutsceneMMCommand_TransitionGeneral>);
+	table.Set(CutsceneMM_CommandType::CS_CMD_FADE_OUT_SEQ,
+	          NewCsCommand<CutsceneMMCommand_FadeOutSeq>);
+	table.Set(CutsceneMM_CommandType::CS_CMD_TIME, NewCsCommand<CutsceneCommand_Time>);
+	table.Set(CutsceneMM_CommandType::CS_CMD_RUMBLE, NewCsCommand<CutsceneMMCommand_Rumble>);
+
+	return table;
+}
 
-	if (((id >= (uint32_t)CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_100) &&
-	     (id <= (uint32_t)CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_149)) ||
-	    (id == (uint32_t)CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_201) ||
-	    ((id >= (uint32_t)CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_450) &&
-	     (id <= (uint32_t)CutsceneMM_CommandType::CS_CMD_ACTOR_CUE_599)))
-	{
-		return new CutsceneMMCommand_ActorCue(rawData, currentPtr);
-	}
+CutsceneCommand* ZCutscene::GetCommandOoT(uint32_t id, offset_t currentPtr) const
+{
+	static const CutsceneCommandTable table = MakeCommandTableOoT();
 
-	switch (cmdID)
-	{
-	case CutsceneMM_CommandType::CS_CMD_MISC:
-	case CutsceneMM_CommandType::CS_CMD_LIGHT_SETTING:
-	case CutsceneMM_CommandType::CS_CMD_TRANSITION:
-	case CutsceneMM_CommandType::CS_CMD_MOTION_BLUR:
-	case CutsceneMM_CommandType::CS_CMD_GIVE_TATL:
-	case CutsceneMM_CommandType::CS_CMD_START_SEQ:
-	case CutsceneMM_CommandType::CS_CMD_SFX_REVERB_INDEX_2:
-	case CutsceneMM_CommandType::CS_CMD_SFX_REVERB_INDEX_1:
-	case CutsceneMM_CommandType::CS_CMD_MODIFY_SEQ:
-	case CutsceneMM_CommandType::CS_CMD_STOP_SEQ:
-	case CutsceneMM_CommandType::CS_CMD_START_AMBIENCE:
-	case CutsceneMM_CommandType::CS_CMD_FADE_OUT_AMBIENCE:
-	case CutsceneMM_CommandType::CS_CMD_DESTINATION:
-	case CutsceneMM_CommandType::CS_CMD_CHOOSE_CREDITS_SCENES:
-
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_FA:
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_FE:
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_FF:
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_100:
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_101:
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_102:
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_103:
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_104:
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_105:
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_108:
-	case CutsceneMM_CommandType::CS_CMD_UNK_DATA_109:
-		return new CutsceneMMCommand_GenericCmd(rawData, currentPtr, cmdID);
-
-	case CutsceneMM_CommandType::CS_CMD_TEXT:
-		return new CutsceneMMCommand_Text(rawData, currentPtr);
-
-	case CutsceneMM_CommandType::CS_CMD_CAMERA_SPLINE:
-		return new CutsceneMMCommand_Spline(rawData, currentPtr);
-
-	case CutsceneMM_CommandType::CS_CMD_TRANSITION_GENERAL:
-		return new CutsceneMMCommand_TransitionGeneral(rawData, currentPtr);
-
-	case CutsceneMM_CommandType::CS_CMD_FADE_OUT_SEQ:
-		return new CutsceneMMCommand_FadeOutSeq(rawData, currentPtr);
-
-	case CutsceneMM_CommandType::CS_CMD_TIME:
-		return new CutsceneCommand_Time(rawData, currentPtr);
-
-	case CutsceneMM_CommandType::CS_CMD_PLAYER_CUE:
-		return new CutsceneMMCommand_ActorCue(rawData, currentPtr);
-
-	case CutsceneMM_CommandType::CS_CMD_RUMBLE:
-		return new CutsceneMMCommand_Rumble(rawData, currentPtr);
+	return table.New(parent->GetRawData(), currentPtr, id);
+}
 
-	default:
-		std::string errorHeader =
-			StringHelper::Sprintf("Warning: Invalid cutscene command ID: '0x%04X'", cmdID);
-		return new CutsceneMMCommand_GenericCmd(rawData, currentPtr, cmdID);
-	}
+CutsceneCommand* ZCutscene::GetCommandMM(uint32_t id, offset_t currentPtr) const
+{
+	static const CutsceneCommandTable table = MakeCommandTableMM();
 
-	return nullptr;
+	return table.New(parent->GetRawData(), currentPtr, id);
 }
 
 Declaration* ZCutscene::DeclareVar(const std::string& prefix, const std::string& bodyStr)
@@ -378,19 +389,63 @@ std::string ZCutscene::GetCsEncodedFloat(float f, CsFloatType type, bool useSciN
 	uint32_t i;
 	std::memcpy(&i, &f, sizeof(i));
 
+	// Both representations are formatted once, into buffers, and put together in the order the
+	// type wants them. %f of FLT_MAX has 46 characters
+	char hex[NumberFormat::MaxSize];
+	size_t hexLen = NumberFormat::Hex(hex, i, 8) - hex;
+	char flt[64];
+	size_t fltLen = 0;
+	std::string output;
+
+	if (type != CsFloatType::HexOnly)
+	{
+#ifdef __cpp_lib_to_chars
+		// Same digits as printf's, several times faster
+		char* end = std::to_chars(flt, flt + sizeof(flt) - 1, f,
+		                          useSciNotation ? std::chars_format::scientific :
+		                                           std::chars_format::fixed,
+		                          useSciNotation ? 8 : 6)
+		                .ptr;
+		*end++ = 'f';
+		fltLen = end - flt;
+#else
+		fltLen = std::snprintf(flt, sizeof(flt), useSciNotation ? "%.8ef" : "%ff", f);
+#endif
+	}
+
 	switch (type)
 	{
 	default:
 	// This default case will NEVER be reached, but GCC still gives a warning.
 	case CsFloatType::HexOnly:
-		return StringHelper::Sprintf("0x%08X", i);
+		output.assign(hex, hexLen);
+		break;
 	case CsFloatType::FloatOnly:
-		return StringHelper::Sprintf(useSciNotation ? "%.8ef" : "%ff", f);
+		output.assign(flt, fltLen);
+		break;
 	case CsFloatType::HexAndFloat:
-		return StringHelper::Sprintf(useSciNotation ? "CS_FLOAT(0x%08X, %.8ef)" : "CS_FLOAT(0x%08X, %ff)", i, f);
+		output.reserve(sizeof("CS_FLOAT(, )") + hexLen + fltLen);
+		output += "CS_FLOAT(";
+		output.append(hex, hexLen);
+		output += ", ";
+		output.append(flt, fltLen);
+		output += ')';
+		break;
 	case CsFloatType::HexAndCommentedFloatLeft:
-		return StringHelper::Sprintf(useSciNotation ? "/* %.8ef */ 0x%08X" : "/* %ff */ 0x%08X", f, i);
+		output.reserve(sizeof("/*  */ ") + hexLen + fltLen);
+		output += "/* ";
+		output.append(flt, fltLen);
+		output += " */ ";
+		output.append(hex, hexLen);
+		break;
 	case CsFloatType::HexAndCommentedFloatRight:
-		return StringHelper::Sprintf(useSciNotation ? "0x%08X /* %.8ef */" : "0x%08X /* %ff */", i, f);
+		output.reserve(sizeof(" /*  */") + hexLen + fltLen);
+		output.append(hex, hexLen);
+		output += " /* ";
+		output.append(flt, fltLen);
+		output += " */";
+		break;
 	}
+
+	return output;
 }
@@ -36,6 +36,9 @@ public:
 	std::vector<CutsceneCommand*> commands;
 
 protected:
+	// Holds the commands and their entries
+	CutscenePool pool;
+
 	CutsceneCommand* GetCommandOoT(uint32_t id, offset_t currentPtr) const;
 	CutsceneCommand* GetCommandMM(uint32_t id, offset_t currentPtr) const;
 };
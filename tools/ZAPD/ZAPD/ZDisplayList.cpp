@@ -1,6 +1,7 @@
 #include "ZDisplayList.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
 #include <cinttypes>
@@ -8,6 +9,7 @@
 
 #include "Globals.h"
 #include "OutputFormatter.h"
+#include "Profiler.h"
 #include "Utils/BitConverter.h"
 #include "Utils/File.h"
 #include "Utils/Path.h"
@@ -17,6 +19,9 @@
 
 REGISTER_ZFILENODE(DList, ZDisplayList);
 
+// Usual length of a "\tVTX(...),\n" line, used to reserve vertex declarations up front
+static constexpr size_t VTX_SOURCE_SIZE_HINT = 56;
+
 ZDisplayList::ZDisplayList(ZFile* nParent) : ZResource(nParent)
 {
 	lastTexWidth = 0;
@@ -27,7 +32,7 @@ ZDisplayList::ZDisplayList(ZFile* nParent) : ZResource(nParent)
 	lastTexSizTest = F3DZEXTexSizes::G_IM_SIZ_16b;
 	lastTexLoaded = false;
 	lastTexIsPalette = false;
-	dListType = Globals::Instance->game == ZGame::OOT_SW97 ? DListType::F3DEX : DListType::F3DZEX;
+	dListType = Globals::Job->game == ZGame::OOT_SW97 ? DListType::F3DEX : DListType::F3DZEX;
 	RegisterOptionalAttribute("Ucode");
 }
 
@@ -43,11 +48,14 @@ ZDisplayList::~ZDisplayList()
 void ZDisplayList::ExtractWithXML(tinyxml2::XMLElement* reader, uint32_t nRawDataIndex)
 {
 	rawDataIndex = nRawDataIndex;
-	ParseXML(reader);
+	{
+		ProfileScope profileScope(ProfilePhase::ParseXML, this);
+		ParseXML(reader);
+	}
 	// TODO add error handling here
 	bool ucodeSet = registeredAttributes.at("Ucode").wasSet;
 	std::string ucodeValue = registeredAttributes.at("Ucode").value;
-	if ((Globals::Instance->game == ZGame::OOT_SW97) || (ucodeValue == "f3dex"))
+	if ((Globals::Job->game == ZGame::OOT_SW97) || (ucodeValue == "f3dex"))
 	{
 		dListType = DListType::F3DEX;
 	}
@@ -68,6 +76,8 @@ void ZDisplayList::ExtractWithXML(tinyxml2::XMLElement* reader, uint32_t nRawDat
 		int32_t rawDataSize =
 			ZDisplayList::GetDListLength(parent->GetRawData(), rawDataIndex, dListType);
 		numInstructions = rawDataSize / 8;
+
+		ProfileScope profileScope(ProfilePhase::ParseRawData, this);
 		ParseRawData();
 	}
 
@@ -85,6 +95,7 @@ void ZDisplayList::ExtractFromBinary(uint32_t nRawDataIndex, int32_t rawDataSize
 	if (parent->GetMode() == ZFileMode::ExternalFile)
 		return;
 
+	ProfileScope profileScope(ProfilePhase::ParseRawData, this);
 	ParseRawData();
 }
 
@@ -441,7 +452,7 @@ void ZDisplayList::ParseF3DEX(F3DEXOpcode opcode, uint64_t data, const std::stri
 	}
 }
 
-int32_t ZDisplayList::GetDListLength(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex,
+int32_t ZDisplayList::GetDListLength(const DataView& rawData, uint32_t rawDataIndex,
                                      DListType dListType)
 {
 	uint8_t endDLOpcode;
@@ -483,6 +494,162 @@ int32_t ZDisplayList::GetDListLength(const std::vector<uint8_t>& rawData, uint32
 	}
 }
 
+// The depth of the F3DZEX display list stack
+static constexpr int32_t DLIST_BOUNDS_MAX_DEPTH = 18;
+
+// Whether a triangle of the F3DZEX command word `w` draws only vertex buffer slots in `loadedSlots`
+static bool DListBounds_TriLoaded(uint32_t w, uint64_t loadedSlots)
+{
+	for (int32_t shift = 0; shift <= 16; shift += 8)
+	{
+		uint32_t slot = ((w >> shift) & 0xFF) / 2;
+
+		if (slot >= 64 || !(loadedSlots & (1ULL << slot)))
+			return false;
+	}
+	return true;
+}
+
+// Walks the display list at `offset`, adding the vertices it loads to `points`. Returns false when
+// the bounds can't be known offline
+static bool DListBounds_Walk(const ZFile* file, uint32_t offset, int32_t depth,
+                             uint64_t& loadedSlots, std::vector<std::array<int16_t, 3>>& points)
+{
+	const DataView& rawData = file->GetRawData();
+	uint32_t branchTarget = 0;
+
+	if (depth >= DLIST_BOUNDS_MAX_DEPTH)
+		return false;
+
+	for (uint32_t ptr = offset; ptr + 8 <= rawData.size(); ptr += 8)
+	{
+		uint64_t data = BitConverter::ToUInt64BE(rawData, ptr);
+		uint32_t w0 = data >> 32;
+		uint32_t w1 = data & 0xFFFFFFFF;
+
+		switch (static_cast<F3DZEXOpcode>(data >> 56))
+		{
+		case F3DZEXOpcode::G_VTX:
+		{
+			int32_t nn = (w0 >> 12) & 0xFF;
+			int32_t first = ((w0 & 0xFF) >> 1) - nn;
+			uint32_t vtxOffset = Seg2Filespace(w1, file->baseAddress);
+
+			if (GETSEGNUM(w1) != file->segment || first < 0 || first + nn > 64 ||
+			    vtxOffset + nn * 16 > rawData.size())
+				return false;
+
+			for (int32_t i = 0; i < nn; i++)
+			{
+				uint32_t vtx = vtxOffset + i * 16;
+
+				points.push_back({BitConverter::ToInt16BE(rawData, vtx + 0),
+				                  BitConverter::ToInt16BE(rawData, vtx + 2),
+				                  BitConverter::ToInt16BE(rawData, vtx + 4)});
+				loadedSlots |= 1ULL << (first + i);
+			}
+		}
+		break;
+		case F3DZEXOpcode::G_TRI1:
+			if (!DListBounds_TriLoaded(w0, loadedSlots))
+				return false;
+			break;
+		case F3DZEXOpcode::G_TRI2:
+		case F3DZEXOpcode::G_QUAD:
+			if (!DListBounds_TriLoaded(w0, loadedSlots) || !DListBounds_TriLoaded(w1, loadedSlots))
+				return false;
+			break;
+		case F3DZEXOpcode::G_DL:
+		{
+			bool branch = ((w0 >> 16) & 0xFF) != 0;
+
+			if (GETSEGNUM(w1) != file->segment ||
+			    !DListBounds_Walk(file, Seg2Filespace(w1, file->baseAddress), depth + 1,
+			                      loadedSlots, points))
+				return false;
+			if (branch)
+				return true;
+		}
+		break;
+		case F3DZEXOpcode::G_RDPHALF_1:
+			branchTarget = w1;
+			break;
+		case F3DZEXOpcode::G_BRANCH_Z:
+		{
+			// Either the branch or the rest of the list is drawn, both are bounded
+			uint64_t branchSlots = loadedSlots;
+
+			if (GETSEGNUM(branchTarget) != file->segment ||
+			    !DListBounds_Walk(file, Seg2Filespace(branchTarget, file->baseAddress), depth + 1,
+			                      branchSlots, points))
+				return false;
+		}
+		break;
+		case F3DZEXOpcode::G_MOVEWORD:
+			// G_MW_SEGMENT, the list points the segments somewhere else
+			if (((w0 >> 16) & 0xFF) == 0x06)
+				return false;
+			break;
+		case F3DZEXOpcode::G_MOVEMEM:
+			// G_MV_MMTX, G_MV_PMTX and G_MV_MATRIX load a matrix
+			if ((w0 & 0xFF) == 2 || (w0 & 0xFF) == 6 || (w0 & 0xFF) == 14)
+				return false;
+			break;
+		case F3DZEXOpcode::G_MTX:
+		case F3DZEXOpcode::G_POPMTX:
+		case F3DZEXOpcode::G_MODIFYVTX:
+			return false;
+		case F3DZEXOpcode::G_ENDDL:
+			return true;
+		default:
+			break;
+		}
+	}
+
+	return false;
+}
+
+bool ZDisplayList::GetDListBounds(const ZFile* file, uint32_t rawDataIndex, DListType dListType,
+                                  DListBounds& bounds)
+{
+	std::vector<std::array<int16_t, 3>> points;
+	uint64_t loadedSlots = 0;
+
+	// The F3DEX commands aren't walked, lists of that microcode have no bounds
+	if (dListType != DListType::F3DZEX ||
+	    !DListBounds_Walk(file, rawDataIndex, 0, loadedSlots, points) || points.empty())
+		return false;
+
+	for (int32_t axis = 0; axis < 3; axis++)
+	{
+		bounds.min[axis] = points[0][axis];
+		bounds.max[axis] = points[0][axis];
+		for (const auto& point : points)
+		{
+			bounds.min[axis] = std::min(bounds.min[axis], point[axis]);
+			bounds.max[axis] = std::max(bounds.max[axis], point[axis]);
+		}
+		bounds.center[axis] = (bounds.min[axis] + bounds.max[axis]) / 2;
+	}
+
+	// The sphere around the center of the box, which can be tighter than the box's corners
+	double maxDistSq = 0;
+	for (const auto& point : points)
+	{
+		double distSq = 0;
+
+		for (int32_t axis = 0; axis < 3; axis++)
+		{
+			double d = point[axis] - bounds.center[axis];
+			distSq += d * d;
+		}
+		maxDistSq = std::max(maxDistSq, distSq);
+	}
+	bounds.radius = static_cast<uint16_t>(std::ceil(std::sqrt(maxDistSq)));
+
+	return true;
+}
+
 bool ZDisplayList::SequenceCheck(std::vector<F3DZEXOpcode> sequence, int32_t startIndex)
 {
 	bool success = true;
@@ -553,7 +720,7 @@ int32_t ZDisplayList::OptimizationCheck_LoadTextureBlock(int32_t startIndex, std
 
 			lastTexSeg = segmentNumber;
 
-			Globals::Instance->GetSegmentedPtrName(data & 0xFFFFFFFF, parent, "", texStr);
+			Globals::Job->GetSegmentedPtrName(data & 0xFFFFFFFF, parent, "", texStr);
 		}
 
 		// gsDPSetTile
@@ -705,7 +872,7 @@ void ZDisplayList::Opcode_G_DL(uint64_t data, const std::string& prefix, char* l
 
 	if (pp != 0)
 	{
-		if (!Globals::Instance->HasSegment(segNum))
+		if (!Globals::Job->HasSegment(segNum))
 			sprintf(line, "gsSPBranchList(0x%08" PRIX64 "),", data & 0xFFFFFFFF);
 		else if (dListDecl != nullptr)
 			sprintf(line, "gsSPBranchList(%s),", dListDecl->declName.c_str());
@@ -715,7 +882,7 @@ void ZDisplayList::Opcode_G_DL(uint64_t data, const std::string& prefix, char* l
 	}
 	else
 	{
-		if (!Globals::Instance->HasSegment(segNum))
+		if (!Globals::Job->HasSegment(segNum))
 			sprintf(line, "gsSPDisplayList(0x%08" PRIX64 "),", data & 0xFFFFFFFF);
 		else if (dListDecl != nullptr)
 			sprintf(line, "gsSPDisplayList(%s),", dListDecl->declName.c_str());
@@ -726,7 +893,7 @@ void ZDisplayList::Opcode_G_DL(uint64_t data, const std::string& prefix, char* l
 
 	// if (segNum == 8 || segNum == 9 || segNum == 10 || segNum == 11 || segNum == 12 || segNum ==
 	// 13) // Used for runtime-generated display lists
-	if (!Globals::Instance->HasSegment(segNum))
+	if (!Globals::Job->HasSegment(segNum))
 	{
 		if (pp != 0)
 			sprintf(line, "gsSPBranchList(0x%08" PRIX64 "),", data & 0xFFFFFFFF);
@@ -804,9 +971,10 @@ void ZDisplayList::Opcode_G_MTX(uint64_t data, char* line)
 		pp = (data & 0x000000FF00000000) >> 32;
 
 	std::string matrixRef;
+	const std::string* matrixSymbol = Globals::Instance->cfg.symbolMap.Find(mm);
 
-	if (Globals::Instance->cfg.symbolMap.find(mm) != Globals::Instance->cfg.symbolMap.end())
-		matrixRef = StringHelper::Sprintf("&%s", Globals::Instance->cfg.symbolMap[mm].c_str());
+	if (matrixSymbol != nullptr)
+		matrixRef = StringHelper::Sprintf("&%s", matrixSymbol->c_str());
 	else
 		matrixRef = StringHelper::Sprintf("0x%08X", mm);
 
@@ -847,7 +1015,7 @@ void ZDisplayList::Opcode_G_VTX(uint64_t data, char* line)
 	}
 
 	// Hack: Don't extract vertices from a unknown segment.
-	if (!Globals::Instance->HasSegment(GETSEGNUM(data)))
+	if (!Globals::Job->HasSegment(GETSEGNUM(data)))
 	{
 		segptr_t segmented = data & 0xFFFFFFFF;
 		references.push_back(segmented);
@@ -885,19 +1053,15 @@ void ZDisplayList::Opcode_G_VTX(uint64_t data, char* line)
 
 		if (nn > 0)
 		{
-			std::vector<ZVtx> vtxList;
-			vtxList.reserve(nn);
+			std::vector<VtxData> vtxList(nn);
 
 			for (int32_t i = 0; i < nn; i++)
 			{
-				ZVtx vtx(parent);
-				vtx.ExtractFromFile(currentPtr);
-				vtxList.push_back(vtx);
-
+				vtxList[i].ParseRawData(parent->GetRawData(), currentPtr);
 				currentPtr += 16;
 			}
 
-			vertices[vtxAddr] = vtxList;
+			AddVertexList(vtxAddr, std::move(vtxList), true);
 		}
 	}
 }
@@ -951,7 +1115,7 @@ void ZDisplayList::Opcode_G_SETTIMG(uint64_t data, const std::string& prefix, ch
 
 		if (parent != nullptr)
 		{
-			if (Globals::Instance->HasSegment(segmentNumber))
+			if (Globals::Job->HasSegment(segmentNumber))
 				texDecl = parent->GetDeclaration(texAddress);
 			else
 				texDecl = parent->GetDeclaration(data);
@@ -959,7 +1123,7 @@ void ZDisplayList::Opcode_G_SETTIMG(uint64_t data, const std::string& prefix, ch
 
 		if (texDecl != nullptr)
 			sprintf(texStr, "%s", texDecl->declName.c_str());
-		else if (data != 0 && Globals::Instance->HasSegment(segmentNumber))
+		else if (data != 0 && Globals::Job->HasSegment(segmentNumber))
 			sprintf(texStr, "%sTex_%06X", prefix.c_str(), texAddress);
 		else
 		{
@@ -972,7 +1136,7 @@ void ZDisplayList::Opcode_G_SETTIMG(uint64_t data, const std::string& prefix, ch
 	else
 	{
 		std::string texName;
-		Globals::Instance->GetSegmentedPtrName(data, parent, "", texName);
+		Globals::Job->GetSegmentedPtrName(data, parent, "", texName);
 		sprintf(line, "gsDPSetTextureImage(%s, %s, %i, %s),", fmtTbl[fmt], sizTbl[siz], www + 1,
 		        texName.c_str());
 	}
@@ -1630,26 +1794,18 @@ static int32_t GfxdCallback_Vtx(uint32_t seg, int32_t count)
 
 		if (count > 0)
 		{
-			std::vector<ZVtx> vtxList;
-			vtxList.reserve(count);
+			std::vector<VtxData> vtxList(count);
 
 			uint32_t currentPtr = vtxOffset;
 			for (int32_t i = 0; i < count; i++)
 			{
-				ZVtx vtx(self->parent);
-				vtx.ExtractFromFile(currentPtr);
-
-				vtxList.push_back(vtx);
+				vtxList[i].ParseRawData(self->parent->GetRawData(), currentPtr);
 				currentPtr += 16;
 			}
 
-			bool keyAlreadyOccupied = self->vertices.find(vtxOffset) != self->vertices.end();
-
 			// In some cases a vtxList already exists at vtxOffset. Only override the existing list
 			// if the new one is bigger.
-			if (!keyAlreadyOccupied ||
-			    (keyAlreadyOccupied && vtxList.size() > self->vertices[vtxOffset].size()))
-				self->vertices[vtxOffset] = vtxList;
+			self->AddVertexList(vtxOffset, std::move(vtxList), false);
 		}
 	}
 
@@ -1677,7 +1833,7 @@ static int32_t GfxdCallback_Texture(segptr_t seg, int32_t fmt, int32_t siz, int3
 	self->TextureGenCheck();
 
 	std::string texName;
-	Globals::Instance->GetSegmentedPtrName(seg, self->parent, "", texName);
+	Globals::Job->GetSegmentedPtrName(seg, self->parent, "", texName);
 
 	gfxd_puts(texName.c_str());
 
@@ -1701,7 +1857,7 @@ static int32_t GfxdCallback_Palette(uint32_t seg, [[maybe_unused]] int32_t idx,
 	self->TextureGenCheck();
 
 	std::string palName;
-	Globals::Instance->GetSegmentedPtrName(seg, self->parent, "", palName);
+	Globals::Job->GetSegmentedPtrName(seg, self->parent, "", palName);
 
 	gfxd_puts(palName.c_str());
 
@@ -1716,7 +1872,7 @@ static int32_t GfxdCallback_DisplayList(uint32_t seg)
 
 	std::string dListName = "";
 	bool addressFound =
-		Globals::Instance->GetSegmentedPtrName(seg, self->parent, "Gfx", dListName, false);
+		Globals::Job->GetSegmentedPtrName(seg, self->parent, "Gfx", dListName, false);
 
 	if (!addressFound)
 	{
@@ -1748,7 +1904,7 @@ static int32_t GfxdCallback_Matrix(uint32_t seg)
 	ZDisplayList* self = static_cast<ZDisplayList*>(gfxd_udata_get());
 
 	bool addressFound =
-		Globals::Instance->GetSegmentedPtrName(seg, self->parent, "Mtx", mtxName, false);
+		Globals::Job->GetSegmentedPtrName(seg, self->parent, "Mtx", mtxName, false);
 
 	if (!addressFound)
 	{
@@ -1785,35 +1941,14 @@ void ZDisplayList::DeclareReferences(const std::string& prefix)
 	std::string sourceOutput;
 
 	if (Globals::Instance->useLegacyZDList)
-		sourceOutput += ProcessLegacy(prefix);
+		sourceOutput = ProcessLegacy(prefix);
 	else
-		sourceOutput += ProcessGfxDis(prefix);
+		sourceOutput = ProcessGfxDis(prefix);
 
 	// Iterate through our vertex lists, connect intersecting lists.
 	if (vertices.size() > 0)
 	{
-		std::vector<std::pair<uint32_t, std::vector<ZVtx>>> verticesSorted(vertices.begin(),
-		                                                                   vertices.end());
-
-		for (size_t i = 0; i < verticesSorted.size() - 1; i++)
-		{
-			size_t vtxSize = vertices[verticesSorted[i].first].size() * 16;
-
-			if ((verticesSorted[i].first + vtxSize) > verticesSorted[i + 1].first)
-			{
-				int32_t intersectAmt =
-					(verticesSorted[i].first + vtxSize) - verticesSorted[i + 1].first;
-				int32_t intersectIndex = intersectAmt / 16;
-
-				for (size_t j = intersectIndex; j < verticesSorted[i + 1].second.size(); j++)
-					vertices[verticesSorted[i].first].push_back(verticesSorted[i + 1].second[j]);
-
-				vertices.erase(verticesSorted[i + 1].first);
-				verticesSorted.erase(verticesSorted.begin() + i + 1);
-
-				i--;
-			}
-		}
+		MergeVertexLists(false);
 
 		// Generate Vertex Declarations
 		for (auto& item : vertices)
@@ -1821,15 +1956,19 @@ void ZDisplayList::DeclareReferences(const std::string& prefix)
 			std::string declaration = "";
 
 			offset_t curAddr = item.first;
-			auto& firstVtx = item.second.at(0);
 
-			for (auto vtx : item.second)
-				declaration += StringHelper::Sprintf("\t%s,\n", vtx.GetBodySourceCode().c_str());
+			declaration.reserve(item.second.size() * VTX_SOURCE_SIZE_HINT);
+			for (const auto& vtx : item.second)
+			{
+				declaration += "\t";
+				vtx.AppendBodySourceCode(declaration);
+				declaration += ",\n";
+			}
 
 			Declaration* decl = parent->AddDeclarationArray(
-				curAddr, firstVtx.GetDeclarationAlignment(),
-				item.second.size() * firstVtx.GetRawDataSize(), firstVtx.GetSourceTypeName(),
-				firstVtx.GetDefaultName(name), item.second.size(), declaration);
+				curAddr, DeclarationAlignment::Align8, item.second.size() * 16, "Vtx",
+				StringHelper::Sprintf("%sVtx_%06X", name.c_str(), curAddr), item.second.size(),
+				declaration);
 			decl->isExternal = true;
 		}
 	}
@@ -1840,45 +1979,22 @@ void ZDisplayList::DeclareReferences(const std::string& prefix)
 	// Iterate through our vertex lists, connect intersecting lists.
 	if (vertices.size() > 0)
 	{
-		std::vector<std::pair<uint32_t, std::vector<ZVtx>>> verticesSorted(vertices.begin(),
-		                                                                   vertices.end());
-
-		for (size_t i = 0; i < verticesSorted.size() - 1; i++)
-		{
-			// int32_t vtxSize = verticesSorted[i].second.size() * 16;
-			size_t vtxSize = vertices[verticesSorted[i].first].size() * 16;
-
-			if ((verticesSorted[i].first + vtxSize) > verticesSorted[i + 1].first)
-			{
-				int32_t intersectAmt =
-					(verticesSorted[i].first + vtxSize) - verticesSorted[i + 1].first;
-				int32_t intersectIndex = intersectAmt / 16;
-
-				for (size_t j = intersectIndex; j < verticesSorted[i + 1].second.size(); j++)
-					vertices[verticesSorted[i].first].push_back(verticesSorted[i + 1].second[j]);
-
-				vertices.erase(verticesSorted[i + 1].first);
-				verticesSorted.erase(verticesSorted.begin() + i + 1);
-
-				i--;
-			}
-		}
+		MergeVertexLists(false);
 
 		// Generate Vertex Declarations
-		std::vector<int32_t> vtxKeys;
-		vtxKeys.reserve(vertices.size());
-		for (auto& item : vertices)
-			vtxKeys.push_back(item.first);
-
-		// for (pair<int32_t, vector<Vertex>> item : vertices)
-		for (size_t i = 0; i < vtxKeys.size(); i++)
+		for (const auto& vtxPair : vertices)
 		{
-			auto& item = vertices[vtxKeys[i]];
+			const auto& item = vtxPair.second;
 
 			std::string declaration;
 
+			declaration.reserve(item.size() * VTX_SOURCE_SIZE_HINT + 1);
 			for (auto& vtx : item)
-				declaration += StringHelper::Sprintf("\t%s,\n", vtx.GetBodySourceCode().c_str());
+			{
+				declaration += "\t";
+				vtx.AppendBodySourceCode(declaration);
+				declaration += ",\n";
+			}
 
 			// Ensure there's always a trailing line feed to prevent dumb warnings.
 			// Please don't remove this line, unless you somehow made a way to prevent
@@ -1888,19 +2004,19 @@ void ZDisplayList::DeclareReferences(const std::string& prefix)
 			if (parent != nullptr)
 			{
 				std::string vtxName;
-				ZResource* vtxRes = parent->FindResource(vtxKeys[i]);
+				ZResource* vtxRes = parent->FindResource(vtxPair.first);
 
 				if (vtxRes != nullptr)
 					vtxName = vtxRes->GetName();
 				else
-					vtxName = StringHelper::Sprintf("%sVtx_%06X", prefix.c_str(), vtxKeys[i]);
+					vtxName = StringHelper::Sprintf("%sVtx_%06X", prefix.c_str(), vtxPair.first);
 
-				auto filepath = Globals::Instance->outputPath / vtxName;
+				auto filepath = Globals::Job->outputPath / vtxName;
 				std::string incStr =
 					StringHelper::Sprintf("%s.%s.inc", filepath.string().c_str(), "vtx");
 
 				Declaration* vtxDecl = parent->AddDeclarationIncludeArray(
-					vtxKeys[i], incStr, item.size() * 16, "Vtx", vtxName, item.size());
+					vtxPair.first, incStr, item.size() * 16, "Vtx", vtxName, item.size());
 				vtxDecl->isExternal = true;
 			}
 		}
@@ -1957,6 +2073,9 @@ std::string ZDisplayList::ProcessGfxDis([[maybe_unused]] const std::string& pref
 	OutputFormatter outputformatter;
 	int32_t dListSize = instructions.size() * sizeof(instructions[0]);
 
+	// A formatted macro is usually a few dozen characters long
+	outputformatter.Reserve(instructions.size() * 48);
+
 	gfxd_input_buffer(instructions.data(), dListSize);
 	gfxd_endian(gfxd_endian_little, sizeof(uint64_t));  // tell gfxdis what format the data is
 
@@ -1978,47 +2097,57 @@ std::string ZDisplayList::ProcessGfxDis([[maybe_unused]] const std::string& pref
 		gfxd_target(gfxd_f3dex);
 
 	gfxd_udata_set(this);
-	gfxd_execute();                               // generate display list
-	sourceOutput += outputformatter.GetOutput();  // write formatted display list
+	{
+		ProfileScope profileScope(ProfilePhase::Disassemble, this);
+		gfxd_execute();  // generate display list
+	}
+	sourceOutput = outputformatter.GetOutput();  // write formatted display list
 
-	MergeConnectingVertexLists();
+	MergeVertexLists(true);
 
 	return sourceOutput;
 }
 
-void ZDisplayList::MergeConnectingVertexLists()
+void ZDisplayList::AddVertexList(uint32_t offset, std::vector<VtxData>&& vtxList, bool replace)
 {
-	if (vertices.size() > 0)
-	{
-		std::vector<std::pair<uint32_t, std::vector<ZVtx>>> vertexKeys(vertices.begin(),
-		                                                               vertices.end());
-		std::pair<uint32_t, std::vector<ZVtx>> lastItem = vertexKeys.at(0);
-
-		for (size_t i = 1; i < vertexKeys.size(); i++)
-		{
-			std::pair<uint32_t, std::vector<ZVtx>> curItem = vertexKeys[i];
-
-			size_t lastItemEnd = lastItem.first + (lastItem.second.size() * 16);
-			bool lastItemIntersects = lastItemEnd >= curItem.first;
-
-			if (lastItemIntersects)
-			{
-				int intersectedVtxStart = (lastItemEnd - curItem.first) / 16;
-
-				for (size_t j = intersectedVtxStart; j < curItem.second.size(); j++)
-					vertices[lastItem.first].push_back(curItem.second[j]);
+	auto it = std::lower_bound(
+		vertices.begin(), vertices.end(), offset,
+		[](const auto& item, uint32_t itemOffset) { return item.first < itemOffset; });
+
+	if (it == vertices.end() || it->first != offset)
+		vertices.emplace(it, offset, std::move(vtxList));
+	else if (replace || vtxList.size() > it->second.size())
+		it->second = std::move(vtxList);
+}
 
-				vertices.erase(curItem.first);
-				vertexKeys.erase(vertexKeys.begin() + i);
+void ZDisplayList::MergeVertexLists(bool mergeTouching)
+{
+	if (vertices.empty())
+		return;
 
-				lastItem.second = vertices[lastItem.first];
+	// Single sweep: every list is either appended to the last merged one or moved after it
+	size_t last = 0;
+	for (size_t i = 1; i < vertices.size(); i++)
+	{
+		auto& item = vertices[last];
+		auto& nextItem = vertices[i];
+		size_t itemEnd = item.first + (item.second.size() * 16);
 
-				i--;
-			}
-			else
-				lastItem = curItem;
+		if (itemEnd < nextItem.first || (itemEnd == nextItem.first && !mergeTouching))
+		{
+			last++;
+			if (last != i)
+				vertices[last] = std::move(nextItem);
+			continue;
 		}
+
+		size_t intersectIndex = (itemEnd - nextItem.first) / 16;
+		if (intersectIndex < nextItem.second.size())
+			item.second.insert(item.second.end(), nextItem.second.begin() + intersectIndex,
+			                   nextItem.second.end());
 	}
+
+	vertices.erase(vertices.begin() + last + 1, vertices.end());
 }
 
 void ZDisplayList::TextureGenCheck()
@@ -2048,7 +2177,7 @@ bool ZDisplayList::TextureGenCheck(int32_t texWidth, int32_t texHeight, uint32_t
 		       texWidth, texHeight, texIsPalette, texAddr);
 
 	if ((texSeg != 0 || texAddr != 0) && texWidth > 0 && texHeight > 0 && texLoaded &&
-	    Globals::Instance->HasSegment(segmentNumber))
+	    Globals::Job->HasSegment(segmentNumber))
 	{
 		ZFile* auxParent = nullptr;
 		if (segmentNumber == self->parent->segment)
@@ -2059,7 +2188,7 @@ bool ZDisplayList::TextureGenCheck(int32_t texWidth, int32_t texHeight, uint32_t
 		{
 			// Try to find a non-external file (i.e., one we are actually extracting)
 			// which has the same segment number we are looking for.
-			for (auto& otherFile : Globals::Instance->cfg.segmentRefFiles[segmentNumber])
+			for (auto& otherFile : Globals::Job->segmentRefFiles[segmentNumber])
 			{
 				if (!otherFile->isExternalFile)
 				{
@@ -145,6 +145,15 @@ enum class DListType
 	F3DEX,
 };
 
+// Bounds of the vertices a display list draws, in the model space it is called in
+struct DListBounds
+{
+	int16_t min[3];
+	int16_t max[3];
+	int16_t center[3];
+	uint16_t radius;
+};
+
 enum class OoTSegments
 {
 	DirectReference = 0,
@@ -334,7 +343,8 @@ public:
 
 	DListType dListType;
 
-	std::map<uint32_t, std::vector<ZVtx>> vertices;
+	// Vertex lists used by the display list, sorted by offset
+	std::vector<std::pair<uint32_t, std::vector<VtxData>>> vertices;
 	std::vector<ZDisplayList*> otherDLists;
 
 	ZTexture* lastTexture = nullptr;
@@ -358,8 +368,13 @@ public:
 	static bool TextureGenCheck(int32_t texWidth, int32_t texHeight, uint32_t texAddr,
 	                            uint32_t texSeg, F3DZEXTexFormats texFmt, F3DZEXTexSizes texSiz,
 	                            bool texLoaded, bool texIsPalette, ZDisplayList* self);
-	static int32_t GetDListLength(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex,
+	static int32_t GetDListLength(const DataView& rawData, uint32_t rawDataIndex,
 	                              DListType dListType);
+	// Computes the bounds of the display list at `rawDataIndex` of `file`, following the lists it
+	// calls in the file's segment. Returns false if they can't be known offline: the list changes
+	// the matrix or a segment, draws vertices it didn't load or loads them from another segment
+	static bool GetDListBounds(const ZFile* file, uint32_t rawDataIndex, DListType dListType,
+	                           DListBounds& bounds);
 
 	size_t GetRawDataSize() const override;
 	DeclarationAlignment GetDeclarationAlignment() const override;
@@ -367,8 +382,11 @@ public:
 	std::string ProcessLegacy(const std::string& prefix);
 	std::string ProcessGfxDis(const std::string& prefix);
 
-	// Combines vertex lists from the vertices map which touch or intersect
-	void MergeConnectingVertexLists();
+	// Adds the vertex list at `offset`. A list already there is only replaced by a bigger one, unless
+	// `replace` is set
+	void AddVertexList(uint32_t offset, std::vector<VtxData>&& vtxList, bool replace);
+	// Combines the vertex lists which intersect, or also those which touch if `mergeTouching` is set
+	void MergeVertexLists(bool mergeTouching);
 
 	bool IsExternalResource() const override;
 	std::string GetExternalExtension() const override;
@@ -1,17 +1,23 @@
 #include "ZFile.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstring>
+#include <exception>
 #include <string_view>
+#include <thread>
 #include <unordered_set>
 
 #include "Globals.h"
 #include "OutputFormatter.h"
+#include "Profiler.h"
 #include "Utils/BinaryWriter.h"
 #include "Utils/BitConverter.h"
 #include "Utils/Directory.h"
 #include "Utils/File.h"
 #include "Utils/MemoryStream.h"
+#include "Utils/NumberFormat.h"
 #include "Utils/Path.h"
 #include "Utils/StringHelper.h"
 #include "WarningHandler.h"
@@ -32,6 +38,36 @@
 #include "ZVector.h"
 #include "ZVtx.h"
 
+// The entry for `offset` of a vector of offset and value pairs sorted by offset, or its end
+template <typename T>
+static auto FindByOffset(const std::vector<std::pair<uint32_t, T>>& entries, uint32_t offset)
+{
+	auto it = std::lower_bound(entries.begin(), entries.end(), offset,
+	                           [](const auto& entry, uint32_t off) { return entry.first < off; });
+	if (it != entries.end() && it->first != offset)
+		return entries.end();
+
+	return it;
+}
+
+// Adds or replaces the entry for `offset`, keeping the vector sorted
+template <typename T>
+static void SetByOffset(std::vector<std::pair<uint32_t, T>>& entries, uint32_t offset, T value)
+{
+	if (entries.empty() || entries.back().first < offset)
+	{
+		entries.emplace_back(offset, value);
+		return;
+	}
+
+	auto it = std::lower_bound(entries.begin(), entries.end(), offset,
+	                           [](const auto& entry, uint32_t off) { return entry.first < off; });
+	if (it->first == offset)
+		it->second = value;
+	else
+		entries.emplace(it, offset, value);
+}
+
 ZFile::ZFile()
 {
 	resources = std::vector<ZResource*>();
@@ -103,13 +139,7 @@ void ZFile::ParseXML(tinyxml2::XMLElement* reader, const std::string& filename)
 	const char* gameStr = reader->Attribute("Game");
 	if (reader->Attribute("Game") != nullptr)
 	{
-		if (std::string_view(gameStr) == "MM")
-			Globals::Instance->game = ZGame::MM_RETAIL;
-		else if (std::string_view(gameStr) == "SW97" || std::string_view(gameStr) == "OOTSW97")
-			Globals::Instance->game = ZGame::OOT_SW97;
-		else if (std::string_view(gameStr) == "OOT")
-			Globals::Instance->game = ZGame::OOT_RETAIL;
-		else
+		if (!GetGameByName(gameStr, Globals::Job->game))
 		{
 			std::string errorHeader =
 				StringHelper::Sprintf("'Game' type '%s' is not supported.", gameStr);
@@ -120,8 +150,9 @@ void ZFile::ParseXML(tinyxml2::XMLElement* reader, const std::string& filename)
 	if (reader->Attribute("BaseAddress") != nullptr)
 		baseAddress = StringHelper::StrToL(reader->Attribute("BaseAddress"), 16);
 
-	if (mode == ZFileMode::Extract && Globals::Instance->baseAddress != -1)
-		baseAddress = Globals::Instance->baseAddress;
+	if ((mode == ZFileMode::Extract || mode == ZFileMode::Check) &&
+	    Globals::Job->baseAddress != -1)
+		baseAddress = Globals::Job->baseAddress;
 
 	if (reader->Attribute("RangeStart") != nullptr)
 		rangeStart = StringHelper::StrToL(reader->Attribute("RangeStart"), 16);
@@ -170,7 +201,7 @@ void ZFile::ParseXML(tinyxml2::XMLElement* reader, const std::string& filename)
 			}
 		}
 	}
-	Globals::Instance->AddSegment(segment, this);
+	Globals::Job->AddSegment(segment, this);
 
 	if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
 	{
@@ -190,7 +221,7 @@ void ZFile::ParseXML(tinyxml2::XMLElement* reader, const std::string& filename)
 		makeDefines = true;
 	}
 
-	if (mode == ZFileMode::Extract || mode == ZFileMode::ExternalFile)
+	if (mode == ZFileMode::Extract || mode == ZFileMode::Check || mode == ZFileMode::ExternalFile)
 	{
 		if (!File::Exists((basePath / name).string()))
 		{
@@ -199,10 +230,18 @@ void ZFile::ParseXML(tinyxml2::XMLElement* reader, const std::string& filename)
 			HANDLE_ERROR_PROCESS(WarningType::Always, errorHeader, "");
 		}
 
-		rawData = File::ReadAllBytes((basePath / name).string());
-		if (mode == ZFileMode::Extract && Globals::Instance->startOffset != -1 && Globals::Instance->endOffset != -1)
-			rawData = std::vector<uint8_t>(rawData.begin() + Globals::Instance->startOffset,
-			                               rawData.begin() + Globals::Instance->endOffset);
+		mappedFile = MappedFile::Open((basePath / name).string());
+		if (mappedFile == nullptr)
+		{
+			std::string errorHeader = StringHelper::Sprintf("binary file '%s' could not be read.",
+			                                                (basePath / name).c_str());
+			HANDLE_ERROR_PROCESS(WarningType::Always, errorHeader, "");
+		}
+
+		rawData = mappedFile->GetView();
+		if ((mode == ZFileMode::Extract || mode == ZFileMode::Check) &&
+		    Globals::Job->startOffset != -1 && Globals::Job->endOffset != -1)
+			rawData = rawData.Slice(Globals::Job->startOffset, Globals::Job->endOffset);
 
 		if (reader->Attribute("RangeEnd") == nullptr)
 			rangeEnd = rawData.size();
@@ -212,7 +251,6 @@ void ZFile::ParseXML(tinyxml2::XMLElement* reader, const std::string& filename)
 	std::unordered_set<std::string> outNameSet;
 	std::unordered_set<std::string> offsetSet;
 
-	auto nodeMap = *GetNodeMap();
 	uint32_t rawDataIndex = 0;
 
 	for (tinyxml2::XMLElement* child = reader->FirstChildElement(); child != nullptr;
@@ -271,33 +309,27 @@ void ZFile::ParseXML(tinyxml2::XMLElement* reader, const std::string& filename)
 			nameSet.insert(nameXml);
 		}
 
-		std::string nodeName = std::string(child->Name());
+		std::string_view nodeName = child->Name();
 
-		if (nodeMap.find(nodeName) != nodeMap.end())
+		if (FindNodeFactory(nodeName) != nullptr)
 		{
-			ZResource* nRes = nodeMap[nodeName](this);
-
-			if (mode == ZFileMode::Extract || mode == ZFileMode::ExternalFile)
-				nRes->ExtractWithXML(child, rawDataIndex);
-
-			switch (nRes->GetResourceType())
+			// Resources of external files are only there for other files to name what they point
+			// to, so they're created on the first lookup that needs them. Not those whose size
+			// gives the offset of the next one, nor symbols, which may overlap other resources
+			tinyxml2::XMLElement* next = child->NextSiblingElement();
+			if (mode == ZFileMode::ExternalFile && nodeName != "Symbol" &&
+			    (next == nullptr || next->Attribute("Offset") != nullptr))
 			{
-			case ZResourceType::Texture:
-				AddTextureResource(rawDataIndex, static_cast<ZTexture*>(nRes));
-				break;
-
-			case ZResourceType::Symbol:
-				AddSymbolResource(rawDataIndex, static_cast<ZSymbol*>(nRes));
-				break;
-
-			default:
-				AddResource(nRes);
-				break;
+				if (lazyXml == nullptr)
+					lazyXml = std::make_unique<tinyxml2::XMLDocument>();
+				lazyNodes[rawDataIndex] = child->DeepClone(lazyXml.get())->ToElement();
+				continue;
 			}
 
+			ZResource* nRes = AddXmlResource(child, rawDataIndex);
 			rawDataIndex += nRes->GetRawDataSize();
 		}
-		else if (std::string_view(child->Name()) == "File")
+		else if (nodeName == "File")
 		{
 			std::string errorHeader = "Can't declare a <File> inside a <File>";
 			HANDLE_ERROR_PROCESS(WarningType::InvalidXML, errorHeader, "");
@@ -305,17 +337,97 @@ void ZFile::ParseXML(tinyxml2::XMLElement* reader, const std::string& filename)
 		else
 		{
 			std::string errorHeader = StringHelper::Sprintf(
-				"Unknown element found inside a <File> element: %s", nodeName.c_str());
+				"Unknown element found inside a <File> element: %s", child->Name());
 			HANDLE_ERROR_PROCESS(WarningType::InvalidXML, errorHeader, "");
 		}
 	}
+
+	lazyGame = Globals::Job->game;
+}
+
+ZResource* ZFile::AddXmlResource(tinyxml2::XMLElement* child, offset_t rawDataIndex)
+{
+	ZResource* nRes = FindNodeFactory(child->Name())(this);
+
+	if (mode == ZFileMode::Extract || mode == ZFileMode::Check || mode == ZFileMode::ExternalFile)
+		nRes->ExtractWithXML(child, rawDataIndex);
+
+	switch (nRes->GetResourceType())
+	{
+	case ZResourceType::Texture:
+		AddTextureResource(rawDataIndex, static_cast<ZTexture*>(nRes));
+		break;
+
+	case ZResourceType::Symbol:
+		AddSymbolResource(rawDataIndex, static_cast<ZSymbol*>(nRes));
+		break;
+
+	default:
+		AddResource(nRes);
+		break;
+	}
+
+	return nRes;
+}
+
+void ZFile::MaterializeResources()
+{
+	while (!lazyNodes.empty())
+		MaterializeNode(lazyNodes.begin());
+}
+
+void ZFile::MaterializeResourceAt(offset_t offset, bool ranged) const
+{
+	if (lazyNodes.empty())
+		return;
+
+	auto node = lazyNodes.upper_bound(offset);
+	if (node == lazyNodes.begin())
+		return;
+
+	node--;
+	if (ranged || node->first == offset)
+	{
+		// Creating what a lookup needs doesn't change what the file holds, so lookups stay const
+		const_cast<ZFile*>(this)->MaterializeNode(node);
+	}
+}
+
+void ZFile::MaterializeNode(std::map<offset_t, tinyxml2::XMLElement*>::const_iterator node)
+{
+	offset_t rawDataIndex = node->first;
+	tinyxml2::XMLElement* child = node->second;
+	ZGame prevGame = Globals::Job->game;
+
+	lazyNodes.erase(node);
+
+	// As it would have been parsed along with the rest of the XML
+	Globals::Job->game = lazyGame;
+	AddXmlResource(child, rawDataIndex);
+	Globals::Job->game = prevGame;
+}
+
+bool ZFile::GetGameByName(std::string_view gameName, ZGame& game)
+{
+	if (gameName == "MM")
+		game = ZGame::MM_RETAIL;
+	else if (gameName == "SW97" || gameName == "OOTSW97")
+		game = ZGame::OOT_SW97;
+	else if (gameName == "OOT")
+		game = ZGame::OOT_RETAIL;
+	else
+		return false;
+
+	return true;
 }
 
 void ZFile::DeclareResourceSubReferences()
 {
 	for (size_t i = 0; i < resources.size(); i++)
 	{
-		resources.at(i)->DeclareReferences(name);
+		ZResource* res = resources.at(i);
+		ProfileScope profileScope(ProfilePhase::DeclareReferences, res);
+		res->DeclareReferences(name);
 	}
 }
 
@@ -350,7 +462,7 @@ const fs::path& ZFile::GetXmlFilePath() const
 	return xmlFilePath;
 }
 
-const std::vector<uint8_t>& ZFile::GetRawData() const
+const DataView& ZFile::GetRawData() const
 {
 	return rawData;
 }
@@ -367,11 +479,19 @@ void ZFile::ExtractResources()
 		Directory::CreateDirectory(GetSourceOutputFolderPath().string());
 
 	for (size_t i = 0; i < resources.size(); i++)
-		resources[i]->ParseRawDataLate();
+	{
+		ZResource* res = resources[i];
+		ProfileScope profileScope(ProfilePhase::ParseRawDataLate, res);
+		res->ParseRawDataLate();
+	}
 	for (size_t i = 0; i < resources.size(); i++)
-		resources[i]->DeclareReferencesLate(name);
+	{
+		ZResource* res = resources[i];
+		ProfileScope profileScope(ProfilePhase::DeclareReferencesLate, res);
+		res->DeclareReferencesLate(name);
+	}
 
-	if (Globals::Instance->genSourceFile)
+	if (Globals::Job->genSourceFile)
 		GenerateSourceFiles();
 
 	auto memStreamFile = std::shared_ptr<MemoryStream>(new MemoryStream());
@@ -382,6 +502,8 @@ void ZFile::ExtractResources()
 	if (exporterSet != nullptr && exporterSet->beginFileFunc != nullptr)
 		exporterSet->beginFileFunc(this);
 
+	bool texturesSaved = SaveTexturesInParallel();
+
 	for (ZResource* res : resources)
 	{
 		auto memStreamRes = std::shared_ptr<MemoryStream>(new MemoryStream());
@@ -390,14 +512,15 @@ void ZFile::ExtractResources()
 		if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
 			printf("Saving resource %s\n", res->GetName().c_str());
 
-		res->Save(outputPath);
+		if (!texturesSaved || res->GetResourceType() != ZResourceType::Texture)
+			res->Save(outputPath);
 
 		// Check if we have an exporter "registered" for this resource type
 		ZResourceExporter* exporter = Globals::Instance->GetExporter(res->GetResourceType());
 		if (exporter != nullptr)
 		{
-			// exporter->Save(res, Globals::Instance->outputPath.string(), &writerFile);
-			exporter->Save(res, Globals::Instance->outputPath.string(), &writerRes);
+			// exporter->Save(res, Globals::Job->outputPath.string(), &writerFile);
+			exporter->Save(res, Globals::Job->outputPath.string(), &writerRes);
 		}
 
 		if (exporterSet != nullptr && exporterSet->resSaveFunc != nullptr)
@@ -406,10 +529,10 @@ void ZFile::ExtractResources()
 
 	if (memStreamFile->GetLength() > 0)
 	{
-		File::WriteAllBytes(StringHelper::Sprintf("%s%s.bin",
-		                                          Globals::Instance->outputPath.string().c_str(),
-		                                          GetName().c_str()),
-		                    memStreamFile->ToVector());
+		File::WriteAllBytesIfChanged(StringHelper::Sprintf("%s%s.bin",
+		                                                   Globals::Job->outputPath.string().c_str(),
+		                                                   GetName().c_str()),
+		                             memStreamFile->ToVector());
 	}
 
 	writerFile.Close();
@@ -418,6 +541,102 @@ void ZFile::ExtractResources()
 		exporterSet->endFileFunc(this);
 }
 
+/**
+ * Runs every pass extraction does with the resources and their declarations, so it warns the same
+ * way, without writing anything: neither the source files nor the resources are saved.
+ */
+void ZFile::CheckResources()
+{
+	if (mode == ZFileMode::ExternalFile)
+		return;
+
+	for (size_t i = 0; i < resources.size(); i++)
+	{
+		ZResource* res = resources[i];
+		ProfileScope profileScope(ProfilePhase::ParseRawDataLate, res);
+		res->ParseRawDataLate();
+	}
+	for (size_t i = 0; i < resources.size(); i++)
+	{
+		ZResource* res = resources[i];
+		ProfileScope profileScope(ProfilePhase::DeclareReferencesLate, res);
+		res->DeclareReferencesLate(name);
+	}
+
+	GeneratePlaceholderDeclarations();
+
+	// The bodies are where the pointers of the resources get resolved to declarations
+	for (size_t i = 0; i < resources.size(); i++)
+	{
+		ZResource* res = resources.at(i);
+		ProfileScope resProfileScope(ProfilePhase::GetSourceOutputCode, res);
+		res->GetSourceOutputCode(name);
+	}
+
+	ProfileScope profileScope(ProfilePhase::ProcessDeclarations);
+
+	if (declarations.size() != 0)
+		ResolveDeclarations();
+}
+
+bool ZFile::SaveTexturesInParallel()
+{
+	uint32_t threadCount = Globals::Instance->pngThreadCount;
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<ZResource*> textures;
+	for (ZResource* res : resources)
+	{
+		if (res->GetResourceType() == ZResourceType::Texture)
+			textures.push_back(res);
+	}
+
+	threadCount = std::min<size_t>(threadCount, textures.size());
+	if (threadCount <= 1)
+		return false;
+
+	// Every texture logs its writes separately, so the log keeps the order of a sequential save
+	std::vector<std::vector<fs::path>> writeLogs(textures.size());
+	std::vector<std::exception_ptr> errors(textures.size());
+	std::atomic<size_t> nextTexture = 0;
+	std::vector<fs::path>* writeLog = File::writeLog;
+	JobContext* job = Globals::Job;
+
+	auto saveTextures = [&]() {
+		Globals::Job = job;
+		for (size_t i = nextTexture++; i < textures.size(); i = nextTexture++)
+		{
+			File::writeLog = writeLog != nullptr ? &writeLogs[i] : nullptr;
+			try
+			{
+				textures[i]->Save(outputPath);
+			}
+			catch (...)
+			{
+				errors[i] = std::current_exception();
+			}
+		}
+		File::writeLog = nullptr;
+	};
+
+	std::vector<std::thread> workers;
+	for (uint32_t i = 0; i < threadCount; i++)
+		workers.emplace_back(saveTextures);
+	for (std::thread& worker : workers)
+		worker.join();
+
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		if (errors[i] != nullptr)
+			std::rethrow_exception(errors[i]);
+		if (writeLog != nullptr)
+			writeLog->insert(writeLog->end(), writeLogs[i].begin(), writeLogs[i].end());
+	}
+
+	return true;
+}
+
 void ZFile::AddResource(ZResource* res)
 {
 	resources.push_back(res);
@@ -425,27 +644,34 @@ void ZFile::AddResource(ZResource* res)
 
 ZResource* ZFile::FindResource(offset_t rawDataIndex)
 {
-	for (ZResource* res : resources)
+	MaterializeResourceAt(rawDataIndex, false);
+
+	// Some resources are pushed directly into `resources`, or get their offset after being added,
+	// so they are indexed lazily. The first resource at an offset wins, like a linear search.
+	for (; indexedResourceCount < resources.size(); indexedResourceCount++)
 	{
-		if (res->GetRawDataIndex() == rawDataIndex)
-			return res;
+		ZResource* res = resources[indexedResourceCount];
+		resourcesByOffset.emplace(res->GetRawDataIndex(), res);
 	}
 
-	return nullptr;
+	auto res = resourcesByOffset.find(rawDataIndex);
+	if (res == resourcesByOffset.end())
+		return nullptr;
+
+	return res->second;
 }
 
-std::vector<ZResource*> ZFile::GetResourcesOfType(ZResourceType resType)
+const std::vector<ZResource*>& ZFile::GetResourcesOfType(ZResourceType resType)
 {
-	std::vector<ZResource*> resList;
-	resList.reserve(resources.size());
+	MaterializeResources();
 
-	for (ZResource* res : resources)
+	for (; typedResourceCount < resources.size(); typedResourceCount++)
 	{
-		if (res->GetResourceType() == resType)
-			resList.push_back(res);
+		ZResource* res = resources[typedResourceCount];
+		resourcesByType[res->GetResourceType()].push_back(res);
 	}
 
-	return resList;
+	return resourcesByType[resType];
 }
 
 Declaration* ZFile::AddDeclaration(offset_t address, DeclarationAlignment alignment, size_t size,
@@ -705,13 +931,10 @@ bool ZFile::GetDeclarationPtrName(segptr_t segAddress, const std::string& expect
 		return false;
 	}
 
-	if (expectedType != "" && expectedType != "void*")
+	if (!decl->MatchesType(expectedType))
 	{
-		if (expectedType != decl->declType && "static " + expectedType != decl->declType)
-		{
-			declName = StringHelper::Sprintf("0x%08X", segAddress);
-			return false;
-		}
+		declName = StringHelper::Sprintf("0x%08X", segAddress);
+		return false;
 	}
 
 	if (!decl->isArray)
@@ -739,13 +962,10 @@ bool ZFile::GetDeclarationArrayIndexedName(segptr_t segAddress, size_t elementSi
 		return false;
 	}
 
-	if (expectedType != "" && expectedType != "void*")
+	if (!decl->MatchesType(expectedType))
 	{
-		if (expectedType != decl->declType && "static " + expectedType != decl->declType)
-		{
-			declName = StringHelper::Sprintf("0x%08X", segAddress);
-			return false;
-		}
+		declName = StringHelper::Sprintf("0x%08X", segAddress);
+		return false;
 	}
 
 	if (decl->address == address)
@@ -767,6 +987,9 @@ bool ZFile::GetDeclarationArrayIndexedName(segptr_t segAddress, size_t elementSi
 
 Declaration* ZFile::GetDeclaration(offset_t address) const
 {
+	Profiler::Count(ProfileCounter::Lookups);
+	MaterializeResourceAt(address, false);
+
 	if (declarations.find(address) != declarations.end())
 		return declarations.at(address);
 
@@ -775,11 +998,17 @@ Declaration* ZFile::GetDeclaration(offset_t address) const
 
 Declaration* ZFile::GetDeclarationRanged(offset_t address) const
 {
-	for (const auto decl : declarations)
-	{
-		if (address >= decl.first && address < decl.first + decl.second->size)
-			return decl.second;
-	}
+	Profiler::Count(ProfileCounter::RangedLookups);
+	MaterializeResourceAt(address, true);
+
+	// Declarations don't overlap, so the only candidate is the last one starting before address
+	auto decl = declarations.upper_bound(address);
+	if (decl == declarations.begin())
+		return nullptr;
+
+	decl--;
+	if (address < decl->first + decl->second->size)
+		return decl->second;
 
 	return nullptr;
 }
@@ -787,11 +1016,14 @@ Declaration* ZFile::GetDeclarationRanged(offset_t address) const
 bool ZFile::HasDeclaration(offset_t address)
 {
 	assert(GETSEGNUM(address) == 0);
+	MaterializeResourceAt(address, false);
 	return declarations.find(address) != declarations.end();
 }
 
 size_t ZFile::GetDeclarationSizeFromNeighbor(uint32_t declarationAddress)
 {
+	MaterializeResources();
+
 	auto currentDecl = declarations.find(declarationAddress);
 	if (currentDecl == declarations.end())
 		return 0;
@@ -806,12 +1038,22 @@ size_t ZFile::GetDeclarationSizeFromNeighbor(uint32_t declarationAddress)
 
 void ZFile::GenerateSourceFiles()
 {
-	std::string sourceOutput;
+	fs::path outPath = GetSourceOutputFolderPath() / outName.stem().concat(".c");
+	ProfileScope profileScope(ProfilePhase::GenerateSourceFiles, ZResourceType::Error,
+	                          outPath.string());
 
-	sourceOutput += "#include \"ultra64.h\"\n";
-	sourceOutput += "#include \"z64.h\"\n";
-	sourceOutput += "#include \"macros.h\"\n";
-	sourceOutput += GetHeaderInclude();
+	if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
+		printf("Writing C file: %s\n", outPath.c_str());
+
+	// The source of big files can take many megabytes, so it's formatted straight into the file
+	std::unique_ptr<std::ostream> outFile = File::OpenForWritingIfChanged(outPath);
+	OutputFormatter formatter;
+	formatter.SetStream(outFile.get());
+
+	formatter.Write("#include \"ultra64.h\"\n");
+	formatter.Write("#include \"z64.h\"\n");
+	formatter.Write("#include \"macros.h\"\n");
+	formatter.Write(GetHeaderInclude());
 
 	bool hasZRoom = false;
 	for (const auto& res : resources)
@@ -827,10 +1069,10 @@ void ZFile::GenerateSourceFiles()
 
 	if (hasZRoom)
 	{
-		sourceOutput += GetZRoomHeaderInclude();
+		formatter.Write(GetZRoomHeaderInclude());
 	}
 
-	sourceOutput += GetExternalFileHeaderInclude();
+	formatter.Write(GetExternalFileHeaderInclude());
 
 	GeneratePlaceholderDeclarations();
 
@@ -838,27 +1080,32 @@ void ZFile::GenerateSourceFiles()
 	for (size_t i = 0; i < resources.size(); i++)
 	{
 		ZResource* res = resources.at(i);
+		ProfileScope resProfileScope(ProfilePhase::GetSourceOutputCode, res);
 		res->GetSourceOutputCode(name);
 	}
 
-	sourceOutput += ProcessDeclarations();
-
-	fs::path outPath = GetSourceOutputFolderPath() / outName.stem().concat(".c");
-
-	if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
-		printf("Writing C file: %s\n", outPath.c_str());
-
-	OutputFormatter formatter;
-	formatter.Write(sourceOutput);
+	ProcessDeclarations(formatter);
 
-	File::WriteAllText(outPath, formatter.GetOutput());
+	formatter.Finish();
+	Profiler::Count(ProfileCounter::SourceBytes, outFile->tellp());
+	outFile.reset();
 
 	GenerateSourceHeaderFiles();
+
+	if (Globals::Instance->dlBounds)
+		GenerateDListBoundsFile();
 }
 
 void ZFile::GenerateSourceHeaderFiles()
 {
+	fs::path headerFilename = GetSourceOutputFolderPath() / outName.stem().concat(".h");
+
+	if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
+		printf("Writing H file: %s\n", headerFilename.c_str());
+
+	std::unique_ptr<std::ostream> headerFile = File::OpenForWritingIfChanged(headerFilename);
 	OutputFormatter formatter;
+	formatter.SetStream(headerFile.get());
 
 	std::string guard = StringHelper::ToUpper(outName.stem().string());
 
@@ -883,12 +1130,43 @@ void ZFile::GenerateSourceHeaderFiles()
 
 	formatter.Write("#endif\n");
 
-	fs::path headerFilename = GetSourceOutputFolderPath() / outName.stem().concat(".h");
+	formatter.Finish();
+	Profiler::Count(ProfileCounter::SourceBytes, headerFile->tellp());
+}
+
+void ZFile::GenerateDListBoundsFile()
+{
+	fs::path boundsFilename = GetSourceOutputFolderPath() / outName.stem().concat(".dlbounds.inc");
+	DListType dListType =
+		Globals::Job->game == ZGame::OOT_SW97 ? DListType::F3DEX : DListType::F3DZEX;
 
 	if (Globals::Instance->verbosity >= VerbosityLevel::VERBOSITY_INFO)
-		printf("Writing H file: %s\n", headerFilename.c_str());
+		printf("Writing display list bounds: %s\n", boundsFilename.c_str());
 
-	File::WriteAllText(headerFilename, formatter.GetOutput());
+	std::unique_ptr<std::ostream> boundsFile = File::OpenForWritingIfChanged(boundsFilename);
+	OutputFormatter formatter;
+	formatter.SetStream(boundsFile.get());
+
+	// An X macro list, for ports which reject the lists outside of the view before drawing them
+	formatter.Write("// DL_BOUNDS(name, centerX, centerY, centerZ, radius, minX, minY, minZ, maxX, "
+	                "maxY, maxZ)\n");
+
+	for (const auto& declPair : declarations)
+	{
+		Declaration* decl = declPair.second;
+		DListBounds bounds;
+
+		if (decl->declType != "Gfx" || decl->declName.empty() || decl->isPlaceholder ||
+		    !ZDisplayList::GetDListBounds(this, decl->address, dListType, bounds))
+			continue;
+
+		formatter.Write(StringHelper::Sprintf(
+			"DL_BOUNDS(%s, %i, %i, %i, %i, %i, %i, %i, %i, %i, %i)\n", decl->declName.c_str(),
+			bounds.center[0], bounds.center[1], bounds.center[2], bounds.radius, bounds.min[0],
+			bounds.min[1], bounds.min[2], bounds.max[0], bounds.max[1], bounds.max[2]));
+	}
+
+	formatter.Finish();
 }
 
 std::string ZFile::GetHeaderInclude() const
@@ -913,7 +1191,7 @@ std::string ZFile::GetExternalFileHeaderInclude() const
 {
 	std::string externalFilesIncludes = "";
 
-	for (ZFile* externalFile : Globals::Instance->files)
+	for (ZFile* externalFile : Globals::Job->files)
 	{
 		if (externalFile != this)
 		{
@@ -952,16 +1230,17 @@ void ZFile::GeneratePlaceholderDeclarations()
 
 void ZFile::AddTextureResource(uint32_t offset, ZTexture* tex)
 {
-	for (auto res : resources)
-		assert(res->GetRawDataIndex() != offset);
+	assert(FindResource(offset) == nullptr);
 
 	resources.push_back(tex);
-	texturesResources[offset] = tex;
+	SetByOffset(texturesResources, offset, tex);
 }
 
 ZTexture* ZFile::GetTextureResource(uint32_t offset) const
 {
-	auto tex = texturesResources.find(offset);
+	MaterializeResourceAt(offset, false);
+
+	auto tex = FindByOffset(texturesResources, offset);
 	if (tex != texturesResources.end())
 		return tex->second;
 
@@ -970,12 +1249,12 @@ ZTexture* ZFile::GetTextureResource(uint32_t offset) const
 
 void ZFile::AddSymbolResource(uint32_t offset, ZSymbol* sym)
 {
-	symbolResources[offset] = sym;
+	SetByOffset(symbolResources, offset, sym);
 }
 
 ZSymbol* ZFile::GetSymbolResource(uint32_t offset) const
 {
-	auto sym = symbolResources.find(offset);
+	auto sym = FindByOffset(symbolResources, offset);
 	if (sym != symbolResources.end())
 		return sym->second;
 
@@ -984,11 +1263,16 @@ ZSymbol* ZFile::GetSymbolResource(uint32_t offset) const
 
 ZSymbol* ZFile::GetSymbolResourceRanged(uint32_t offset) const
 {
-	for (const auto decl : symbolResources)
-	{
-		if (offset >= decl.first && offset < decl.first + decl.second->GetRawDataSize())
-			return decl.second;
-	}
+	Profiler::Count(ProfileCounter::RangedLookups);
+
+	auto sym = std::upper_bound(symbolResources.begin(), symbolResources.end(), offset,
+	                            [](uint32_t off, const auto& entry) { return off < entry.first; });
+	if (sym == symbolResources.begin())
+		return nullptr;
+
+	sym--;
+	if (offset < sym->first + sym->second->GetRawDataSize())
+		return sym->second;
 
 	return nullptr;
 }
@@ -1016,25 +1300,53 @@ bool ZFile::IsSegmentedInFilespaceRange(segptr_t segAddress) const
 	return IsOffsetInFileRange(offset);
 }
 
-std::map<std::string, ZResourceFactoryFunc*>* ZFile::GetNodeMap()
+// Filled by REGISTER_ZFILENODE during static initialization, with the string literals of the names
+static std::vector<std::pair<std::string_view, ZResourceFactoryFunc*>>& GetNodeRegistrations()
 {
-	static std::map<std::string, ZResourceFactoryFunc*> nodeMap;
-	return &nodeMap;
+	static std::vector<std::pair<std::string_view, ZResourceFactoryFunc*>> registrations;
+	return registrations;
 }
 
-void ZFile::RegisterNode(std::string nodeName, ZResourceFactoryFunc* nodeFunc)
+void ZFile::RegisterNode(std::string_view nodeName, ZResourceFactoryFunc* nodeFunc)
 {
-	std::map<std::string, ZResourceFactoryFunc*>* nodeMap = GetNodeMap();
-	(*nodeMap)[nodeName] = nodeFunc;
+	GetNodeRegistrations().emplace_back(nodeName, nodeFunc);
 }
 
-std::string ZFile::ProcessDeclarations()
+ZResourceFactoryFunc* ZFile::FindNodeFactory(std::string_view nodeName)
 {
-	std::string output;
+	// Sorted by name on the first lookup, once every node has registered, and never changed after,
+	// so the worker threads of a batch share it without locking
+	static const std::vector<std::pair<std::string_view, ZResourceFactoryFunc*>> nodeTable = [] {
+		auto registrations = GetNodeRegistrations();
+		std::stable_sort(registrations.begin(), registrations.end(),
+		                 [](const auto& a, const auto& b) { return a.first < b.first; });
+
+		// A name registered twice keeps its last factory
+		std::vector<std::pair<std::string_view, ZResourceFactoryFunc*>> table;
+		for (size_t i = 0; i < registrations.size(); i++)
+		{
+			if (i + 1 == registrations.size() || registrations[i + 1].first != registrations[i].first)
+				table.push_back(registrations[i]);
+		}
+		return table;
+	}();
 
-	if (declarations.size() == 0)
-		return output;
+	auto it = std::lower_bound(
+		nodeTable.begin(), nodeTable.end(), nodeName,
+		[](const auto& node, std::string_view name) { return node.first < name; });
+	if (it == nodeTable.end() || it->first != nodeName)
+		return nullptr;
+
+	return it->second;
+}
 
+/**
+ * The passes over the declarations that come before writing them: texture intersections, merging
+ * neighbours, and accounting for the data no declaration covers, which is what warns about
+ * overlapping resources and unaccounted data.
+ */
+void ZFile::ResolveDeclarations()
+{
 	defines += ProcessTextureIntersections(name);
 
 	// printf("RANGE START: 0x%06X - RANGE END: 0x%06X\n", rangeStart, rangeEnd);
@@ -1051,15 +1363,25 @@ std::string ZFile::ProcessDeclarations()
 	}
 
 	HandleUnaccountedData();
+}
+
+void ZFile::ProcessDeclarations(OutputFormatter& formatter)
+{
+	ProfileScope profileScope(ProfilePhase::ProcessDeclarations);
+
+	if (declarations.size() == 0)
+		return;
+
+	ResolveDeclarations();
 
 	// Go through include declarations
 	// First, handle the prototypes (static only for now)
 	for (std::pair<uint32_t, Declaration*> item : declarations)
 	{
-		output += item.second->GetStaticForwardDeclarationStr();
+		formatter.Write(item.second->GetStaticForwardDeclarationStr());
 	}
 
-	output += "\n";
+	formatter.Write("\n");
 
 	// Next, output the actual declarations
 	for (const auto& item : declarations)
@@ -1080,63 +1402,53 @@ std::string ZFile::ProcessDeclarations()
 					extType = "vtx";
 
 				auto filepath = outputPath / item.second->declName;
-				File::WriteAllText(
+				File::WriteAllTextIfChanged(
 					StringHelper::Sprintf("%s.%s.inc", filepath.string().c_str(), extType.c_str()),
 					item.second->declBody);
 			}
 
-			output += item.second->GetExternalDeclarationStr();
+			formatter.Write(item.second->GetExternalDeclarationStr());
+		}
+		else if (item.second->isExternReference)
+		{
+			formatter.Write(item.second->GetExternStr());
+			formatter.Write("\n");
 		}
 		else if (item.second->declType != "")
 		{
-			output += item.second->GetNormalDeclarationStr();
+			item.second->WriteNormalDeclaration(formatter);
 		}
 	}
-
-	return output;
 }
 
 void ZFile::MergeNeighboringDeclarations()
 {
 	// Optimization: See if there are any arrays side by side that can be merged...
-	std::vector<std::pair<int32_t, Declaration*>> declarationKeys(declarations.begin(),
-	                                                              declarations.end());
-
-	std::pair<int32_t, Declaration*> lastItem = declarationKeys.at(0);
+	auto lastItem = declarations.begin();
+	if (lastItem == declarations.end())
+		return;
 
-	for (size_t i = 1; i < declarationKeys.size(); i++)
+	for (auto curItem = std::next(lastItem); curItem != declarations.end();)
 	{
-		std::pair<int32_t, Declaration*> curItem = declarationKeys[i];
-
-		if (curItem.second->isArray && lastItem.second->isArray)
+		Declaration* lastDecl = lastItem->second;
+		Declaration* curDecl = curItem->second;
+
+		// TEST: For now just do Vtx declarations...
+		// Make sure there isn't an unaccounted inbetween these two
+		if (curDecl->isArray && lastDecl->isArray && lastDecl->declType == "Vtx" &&
+		    curDecl->declType == lastDecl->declType && !curDecl->declaredInXml &&
+		    !lastDecl->declaredInXml && curItem->first == lastItem->first + lastDecl->size)
 		{
-			if (curItem.second->declType == lastItem.second->declType)
-			{
-				if (!curItem.second->declaredInXml && !lastItem.second->declaredInXml)
-				{
-					// TEST: For now just do Vtx declarations...
-					if (lastItem.second->declType == "Vtx")
-					{
-						int32_t sizeDiff = curItem.first - (lastItem.first + lastItem.second->size);
-
-						// Make sure there isn't an unaccounted inbetween these two
-						if (sizeDiff == 0)
-						{
-							lastItem.second->size += curItem.second->size;
-							lastItem.second->arrayItemCnt += curItem.second->arrayItemCnt;
-							lastItem.second->declBody += "\n" + curItem.second->declBody;
-							declarations.erase(curItem.first);
-							declarationKeys.erase(declarationKeys.begin() + i);
-							delete curItem.second;
-							i--;
-							continue;
-						}
-					}
-				}
-			}
+			lastDecl->size += curDecl->size;
+			lastDecl->arrayItemCnt += curDecl->arrayItemCnt;
+			lastDecl->declBody += '\n';
+			lastDecl->declBody += curDecl->declBody;
+			delete curDecl;
+			curItem = declarations.erase(curItem);
+			continue;
 		}
 
-		lastItem = curItem;
+		lastItem = curItem++;
 	}
 }
 
@@ -1155,8 +1467,8 @@ void ZFile::ProcessDeclarationText(Declaration* decl)
 		if (c == '@' && c2 == 'r')
 		{
 			std::string vtxName;
-			Globals::Instance->GetSegmentedArrayIndexedName(decl->references[refIndex], 0x10, this,
-			                                                "Vtx", vtxName);
+			Globals::Job->GetSegmentedArrayIndexedName(decl->references[refIndex], 0x10, this,
+			                                           "Vtx", vtxName);
 			decl->declBody.replace(i, 2, vtxName);
 
 			refIndex++;
@@ -1206,23 +1518,19 @@ std::string ZFile::ProcessTextureIntersections([[maybe_unused]] const std::strin
 		return "";
 
 	std::string defines;
-	std::vector<std::pair<uint32_t, ZTexture*>> texturesSorted(texturesResources.begin(),
-	                                                           texturesResources.end());
 
-	for (size_t i = 0; i < texturesSorted.size() - 1; i++)
+	// The textures merged into the one before them are dropped, by moving the ones kept down to
+	// `kept`. The last one kept is compared with each of the next ones in turn
+	size_t kept = 0;
+	for (size_t i = 1; i < texturesResources.size(); i++)
 	{
-		uint32_t currentOffset = texturesSorted[i].first;
-		uint32_t nextOffset = texturesSorted[i + 1].first;
-		auto& currentTex = texturesResources.at(currentOffset);
+		uint32_t currentOffset = texturesResources[kept].first;
+		ZTexture* currentTex = texturesResources[kept].second;
+		uint32_t nextOffset = texturesResources[i].first;
 		int texSize = currentTex->GetRawDataSize();
 
-		if (currentTex->WasDeclaredInXml())
-		{
-			// We believe the user is right.
-			continue;
-		}
-
-		if ((currentOffset + texSize) > nextOffset)
+		// We believe the user is right if it was declared in the XML
+		if (!currentTex->WasDeclaredInXml() && (currentOffset + texSize) > nextOffset)
 		{
 			uint32_t offsetDiff = nextOffset - currentOffset;
 			if (currentTex->isPalette)
@@ -1240,7 +1548,7 @@ std::string ZFile::ProcessTextureIntersections([[maybe_unused]] const std::strin
 
 				Declaration* nextDecl = GetDeclaration(nextOffset);
 				if (nextDecl == nullptr)
-					texNextName = texturesResources.at(nextOffset)->GetName();
+					texNextName = texturesResources[i].second->GetName();
 				else
 					texNextName = nextDecl->declName;
 
@@ -1249,31 +1557,27 @@ std::string ZFile::ProcessTextureIntersections([[maybe_unused]] const std::strin
 
 				delete declarations[nextOffset];
 				declarations.erase(nextOffset);
-				texturesResources.erase(nextOffset);
-				texturesSorted.erase(texturesSorted.begin() + i + 1);
-
-				i--;
+				continue;
 			}
 		}
+
+		texturesResources[++kept] = texturesResources[i];
 	}
+	texturesResources.resize(kept + 1);
 
 	return defines;
 }
 
 void ZFile::HandleUnaccountedData()
 {
-	uint32_t lastAddr = 0;
+	offset_t lastAddr = 0;
 	uint32_t lastSize = 0;
-	std::vector<offset_t> declsAddresses;
-
-	declsAddresses.reserve(declarations.size());
-	for (const auto& item : declarations)
-	{
-		declsAddresses.push_back(item.first);
-	}
+	Declaration* lastDecl = nullptr;
 
+	// The declarations of unaccounted data are only ever added in the gap before the current
+	// declaration, so the sweep never comes across them
 	bool breakLoop = false;
-	for (offset_t currentAddress : declsAddresses)
+	for (const auto& [currentAddress, currentDecl] : declarations)
 	{
 		if (currentAddress >= rangeEnd)
 		{
@@ -1284,29 +1588,92 @@ void ZFile::HandleUnaccountedData()
 		if (currentAddress < rangeStart)
 		{
 			lastAddr = currentAddress;
+			lastDecl = currentDecl;
 			continue;
 		}
 
-		breakLoop = HandleUnaccountedAddress(currentAddress, lastAddr, lastSize);
+		breakLoop = HandleUnaccountedAddress(currentAddress, lastAddr, lastDecl, lastSize);
 		if (breakLoop)
 			break;
 
 		lastAddr = currentAddress;
+		lastDecl = currentDecl;
 	}
 
 	if (!breakLoop)
 	{
 		// TODO: change rawData.size() to rangeEnd
-		// HandleUnaccountedAddress(rangeEnd, lastAddr, lastSize);
-		HandleUnaccountedAddress(rawData.size(), lastAddr, lastSize);
+		// HandleUnaccountedAddress(rangeEnd, lastAddr, lastDecl, lastSize);
+		HandleUnaccountedAddress(rawData.size(), lastAddr, lastDecl, lastSize);
+	}
+}
+
+static bool IsZeroFilled(const uint8_t* data, size_t size)
+{
+	uint64_t bits = 0;
+	size_t i = 0;
+
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(word));
+		bits |= word;
+	}
+	for (; i < size; i++)
+		bits |= data[i];
+
+	return bits == 0;
+}
+
+// The body of the u8 array of an unaccounted block, 16 bytes a line, or 4 with their offsets if
+// `verbose`
+static std::string GetUnaccountedBody(const uint8_t* data, size_t size, offset_t address,
+                                      bool verbose)
+{
+	std::string src;
+
+	// "0x00, " for each byte, and at most a line feed, an indentation and an offset comment for
+	// every 4 bytes
+	src.resize(4 + size * 6 + (size / 4 + 1) * (sizeof(" // \n\t") + NumberFormat::MaxSize));
+	char* p = src.data();
+
+	memcpy(p, "    ", 4);
+	p += 4;
+	for (size_t i = 0; i < size; i++)
+	{
+		p = NumberFormat::Hex(p, data[i], 2);
+		*p++ = ',';
+		*p++ = ' ';
+
+		if (verbose)
+		{
+			if (i % 4 == 3)
+			{
+				memcpy(p, " // ", 4);
+				p = NumberFormat::Hex(p + 4, address + i - 3, 6);
+				if (i != size - 1)
+				{
+					*p++ = '\n';
+					*p++ = '\t';
+				}
+			}
+		}
+		else if (i % 16 == 15 && i != size - 1)
+		{
+			memcpy(p, "\n    ", 5);
+			p += 5;
+		}
 	}
+
+	src.resize(p - src.data());
+	return src;
 }
 
-bool ZFile::HandleUnaccountedAddress(offset_t currentAddress, offset_t lastAddr, uint32_t& lastSize)
+bool ZFile::HandleUnaccountedAddress(offset_t currentAddress, offset_t lastAddr,
+                                     Declaration* lastDecl, uint32_t& lastSize)
 {
-	if (currentAddress != lastAddr && declarations.find(lastAddr) != declarations.end())
+	if (currentAddress != lastAddr && lastDecl != nullptr)
 	{
-		Declaration* lastDecl = declarations.at(lastAddr);
 		lastSize = lastDecl->size;
 
 		if (lastAddr + lastSize > currentAddress)
@@ -1328,9 +1695,6 @@ bool ZFile::HandleUnaccountedAddress(offset_t currentAddress, offset_t lastAddr,
 	    unaccountedAddress < rangeEnd)
 	{
 		int diff = currentAddress - unaccountedAddress;
-		bool nonZeroUnaccounted = false;
-
-		std::string src = "    ";
 
 		if (currentAddress > rawData.size())
 		{
@@ -1365,35 +1729,14 @@ bool ZFile::HandleUnaccountedAddress(offset_t currentAddress, offset_t lastAddr,
 			}
 		}
 
-		for (int i = 0; i < diff; i++)
-		{
-			uint8_t val = rawData.at(unaccountedAddress + i);
-			src += StringHelper::Sprintf("0x%02X, ", val);
-			if (val != 0x00)
-			{
-				nonZeroUnaccounted = true;
-			}
-
-			if (Globals::Instance->verboseUnaccounted)
-			{
-				if ((i % 4 == 3))
-				{
-					src += StringHelper::Sprintf(" // 0x%06X", unaccountedAddress + i - 3);
-					if (i != (diff - 1))
-					{
-						src += "\n\t";
-					}
-				}
-			}
-			else
-			{
-				if ((i % 16 == 15) && (i != (diff - 1)))
-					src += "\n    ";
-			}
-		}
+		// With no size the gap starts at the last declaration itself, otherwise it's between
+		// two neighbours of the sweep and nothing is declared there
+		bool isDeclared = lastSize == 0 && lastDecl != nullptr;
 
-		if (declarations.find(unaccountedAddress) == declarations.end() && diff > 0)
+		if (!isDeclared && diff > 0)
 		{
+			const uint8_t* data = rawData.data() + unaccountedAddress;
+			bool nonZeroUnaccounted = !IsZeroFilled(data, diff);
 			std::string unaccountedPrefix = "unaccounted";
 
 			if (diff < 16 && !nonZeroUnaccounted)
@@ -1409,7 +1752,9 @@ bool ZFile::HandleUnaccountedAddress(offset_t currentAddress, offset_t lastAddr,
 				unaccountedAddress, DeclarationAlignment::Align4, diff, "u8",
 				StringHelper::Sprintf("%s_%s_%06X", name.c_str(), unaccountedPrefix.c_str(),
 			                          unaccountedAddress),
-				diff, src);
+				diff,
+				GetUnaccountedBody(data, diff, unaccountedAddress,
+			                       Globals::Instance->verboseUnaccounted));
 
 			decl->isUnaccounted = true;
 			if (Globals::Instance->forceUnaccountedStatic)
@@ -1,12 +1,19 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "Utils/DataView.h"
+#include "Utils/MappedFile.h"
 #include "ZSymbol.h"
 #include "ZTexture.h"
 #include "tinyxml2.h"
 
+class OutputFormatter;
+
 enum class ZFileMode
 {
 	BuildTexture,
@@ -14,8 +21,10 @@ enum class ZFileMode
 	BuildBlob,
 	BuildSourceFile,
 	BuildBackground,
+	BuildAssets,
 	Extract,
 	ExternalFile,
+	Check,
 	Invalid,
 	Custom = 1000,  // Used for exporter file modes
 };
@@ -50,12 +59,17 @@ public:
 	std::string GetOutName() const;
 	ZFileMode GetMode() const;
 	const fs::path& GetXmlFilePath() const;
-	const std::vector<uint8_t>& GetRawData() const;
+	const DataView& GetRawData() const;
 	void ExtractResources();
 	void BuildSourceFile();
+	void CheckResources();
 	void AddResource(ZResource* res);
 	ZResource* FindResource(offset_t rawDataIndex);
-	std::vector<ZResource*> GetResourcesOfType(ZResourceType resType);
+	// The resources of a type, in the order they were added. Adding a resource of that type may
+	// invalidate the reference
+	const std::vector<ZResource*>& GetResourcesOfType(ZResourceType resType);
+	// Creates the resources of an external file no lookup has needed yet
+	void MaterializeResources();
 
 	Declaration* AddDeclaration(offset_t address, DeclarationAlignment alignment, size_t size,
 	                            const std::string& varType, const std::string& varName,
@@ -109,11 +123,19 @@ public:
 	bool IsOffsetInFileRange(uint32_t offset) const;
 	bool IsSegmentedInFilespaceRange(segptr_t segAddress) const;
 
-	static std::map<std::string, ZResourceFactoryFunc*>* GetNodeMap();
-	static void RegisterNode(std::string nodeName, ZResourceFactoryFunc* nodeFunc);
+	// Reads the value of the `Game` attribute of a File. Returns false if the game is unknown
+	static bool GetGameByName(std::string_view gameName, ZGame& game);
+
+	// The factory of the resources of an XML element name, nullptr if no resource has that name
+	static ZResourceFactoryFunc* FindNodeFactory(std::string_view nodeName);
+	static void RegisterNode(std::string_view nodeName, ZResourceFactoryFunc* nodeFunc);
 
 protected:
-	std::vector<uint8_t> rawData;
+	friend class ExternalIndex;
+
+	// View of the mapped binary file, narrowed to the start/end offsets if those were given
+	DataView rawData;
+	std::shared_ptr<MappedFile> mappedFile;
 	std::string name;
 	fs::path outName = "";
 	fs::path basePath;
@@ -123,22 +145,53 @@ protected:
 	// Keep track of every texture of this ZFile.
 	// The pointers declared here are "borrowed" (somebody else is the owner),
 	// so ZFile shouldn't delete/free those textures.
-	std::map<uint32_t, ZTexture*> texturesResources;
-	std::map<uint32_t, ZSymbol*> symbolResources;
+	// Both are sorted by offset, with a single entry per offset. They're looked up far more often
+	// than added to, and nearly always added to at the end.
+	std::vector<std::pair<uint32_t, ZTexture*>> texturesResources;
+	std::vector<std::pair<uint32_t, ZSymbol*>> symbolResources;
 	ZFileMode mode = ZFileMode::Invalid;
 
+	// Index of `resources` by offset, used by FindResource. Only the first `indexedResourceCount`
+	// resources are in it, the rest get added the next time FindResource is called.
+	std::unordered_map<offset_t, ZResource*> resourcesByOffset;
+	size_t indexedResourceCount = 0;
+
+	// Index of `resources` by type, used by GetResourcesOfType and caught up with `resources` the
+	// same way
+	std::map<ZResourceType, std::vector<ZResource*>> resourcesByType;
+	size_t typedResourceCount = 0;
+
+	// Resources of an external file no lookup has needed yet, by offset. Only a copy of their XML
+	// is kept, along with the game it was parsed for
+	std::map<offset_t, tinyxml2::XMLElement*> lazyNodes;
+	std::unique_ptr<tinyxml2::XMLDocument> lazyXml;
+	ZGame lazyGame = ZGame::OOT_RETAIL;
+
 	ZFile();
 	void ParseXML(tinyxml2::XMLElement* reader, const std::string& filename);
+	ZResource* AddXmlResource(tinyxml2::XMLElement* child, offset_t rawDataIndex);
+	// Creates the resource at `offset`, or with `ranged` the last one starting before it, if
+	// that's still waiting in lazyNodes
+	void MaterializeResourceAt(offset_t offset, bool ranged) const;
+	void MaterializeNode(std::map<offset_t, tinyxml2::XMLElement*>::const_iterator node);
 	void DeclareResourceSubReferences();
 	void GenerateSourceFiles();
+
+	// Saves the textures of the file on `pngThreadCount` threads, since encoding their PNGs is
+	// most of the time spent saving. Returns false if they're left to be saved one by one
+	bool SaveTexturesInParallel();
+
 	void GenerateSourceHeaderFiles();
+	void GenerateDListBoundsFile();
 	bool DeclarationSanityChecks(uint32_t address, const std::string& varName);
-	std::string ProcessDeclarations();
+	void ResolveDeclarations();
+	void ProcessDeclarations(OutputFormatter& formatter);
 	void MergeNeighboringDeclarations();
 	void ProcessDeclarationText(Declaration* decl);
 	std::string ProcessExterns();
 
 	std::string ProcessTextureIntersections(const std::string& prefix);
 	void HandleUnaccountedData();
-	bool HandleUnaccountedAddress(offset_t currentAddress, offset_t lastAddr, uint32_t& lastSize);
+	bool HandleUnaccountedAddress(offset_t currentAddress, offset_t lastAddr, Declaration* lastDecl,
+	                              uint32_t& lastSize);
 };
@@ -29,6 +29,70 @@ void ZLimb::ExtractFromBinary(uint32_t nRawDataIndex, ZLimbType nType)
 	ParseRawData();
 }
 
+void ZLimb::ExtractFromFields(uint32_t nRawDataIndex, ZLimbType nType, const ZLimbFields& fields)
+{
+	assert(nType != ZLimbType::Skin);
+
+	rawDataIndex = nRawDataIndex;
+	type = nType;
+
+	legTransX = fields.legTransX;
+	legTransY = fields.legTransY;
+	legTransZ = fields.legTransZ;
+	rotX = fields.rotX;
+	rotY = fields.rotY;
+	rotZ = fields.rotZ;
+	childPtr = fields.childPtr;
+	siblingPtr = fields.siblingPtr;
+	dListPtr = fields.dListPtr;
+	dList2Ptr = fields.dList2Ptr;
+	transX = fields.transX;
+	transY = fields.transY;
+	transZ = fields.transZ;
+	childIndex = fields.childIndex;
+	siblingIndex = fields.siblingIndex;
+}
+
+ZLimbFields ZLimb::GetFields() const
+{
+	ZLimbFields fields;
+
+	// Only what ParseRawData read for this type is set
+	switch (type)
+	{
+	case ZLimbType::Legacy:
+		fields.legTransX = legTransX;
+		fields.legTransY = legTransY;
+		fields.legTransZ = legTransZ;
+		fields.rotX = rotX;
+		fields.rotY = rotY;
+		fields.rotZ = rotZ;
+		fields.childPtr = childPtr;
+		fields.siblingPtr = siblingPtr;
+		fields.dListPtr = dListPtr;
+		break;
+
+	case ZLimbType::Curve:
+		fields.childIndex = childIndex;
+		fields.siblingIndex = siblingIndex;
+		fields.dListPtr = dListPtr;
+		fields.dList2Ptr = dList2Ptr;
+		break;
+
+	default:
+		fields.transX = transX;
+		fields.transY = transY;
+		fields.transZ = transZ;
+		fields.childIndex = childIndex;
+		fields.siblingIndex = siblingIndex;
+		fields.dListPtr = dListPtr;
+		fields.dList2Ptr = dList2Ptr;
+		break;
+	}
+
+	return fields;
+}
+
 void ZLimb::ParseXML(tinyxml2::XMLElement* reader)
 {
 	ZResource::ParseXML(reader);
@@ -205,7 +269,12 @@ void ZLimb::DeclareReferences(const std::string& prefix)
 
 size_t ZLimb::GetRawDataSize() const
 {
-	switch (type)
+	return GetRawDataSize(type);
+}
+
+size_t ZLimb::GetRawDataSize(ZLimbType limbType)
+{
+	switch (limbType)
 	{
 	case ZLimbType::Standard:
 	case ZLimbType::Curve:
@@ -229,16 +298,16 @@ std::string ZLimb::GetBodySourceCode() const
 {
 	std::string dListStr;
 	std::string dListStr2;
-	Globals::Instance->GetSegmentedArrayIndexedName(dListPtr, 8, parent, "Gfx", dListStr);
-	Globals::Instance->GetSegmentedArrayIndexedName(dList2Ptr, 8, parent, "Gfx", dListStr2);
+	Globals::Job->GetSegmentedArrayIndexedName(dListPtr, 8, parent, "Gfx", dListStr);
+	Globals::Job->GetSegmentedArrayIndexedName(dList2Ptr, 8, parent, "Gfx", dListStr2);
 
 	std::string entryStr = "\n\t";
 	if (type == ZLimbType::Legacy)
 	{
 		std::string childName;
 		std::string siblingName;
-		Globals::Instance->GetSegmentedPtrName(childPtr, parent, "LegacyLimb", childName);
-		Globals::Instance->GetSegmentedPtrName(siblingPtr, parent, "LegacyLimb", siblingName);
+		Globals::Job->GetSegmentedPtrName(childPtr, parent, "LegacyLimb", childName);
+		Globals::Job->GetSegmentedPtrName(siblingPtr, parent, "LegacyLimb", siblingName);
 
 		entryStr += StringHelper::Sprintf("%s,\n", dListStr.c_str());
 		entryStr +=
@@ -283,7 +352,7 @@ std::string ZLimb::GetBodySourceCode() const
 		case ZLimbType::Skin:
 		{
 			std::string skinSegmentStr;
-			Globals::Instance->GetSegmentedPtrName(skinSegment, parent, "", skinSegmentStr);
+			Globals::Job->GetSegmentedPtrName(skinSegment, parent, "", skinSegmentStr);
 			entryStr +=
 				StringHelper::Sprintf("\t0x%02X, %s\n", skinSegmentType, skinSegmentStr.c_str());
 		}
@@ -393,14 +462,14 @@ void ZLimb::DeclareDList(segptr_t dListSegmentedPtr, const std::string& prefix,
 		return;
 
 	std::string dlistName;
-	bool declFound = Globals::Instance->GetSegmentedArrayIndexedName(dListSegmentedPtr, 8, parent,
-	                                                                 "Gfx", dlistName, false);
+	bool declFound = Globals::Job->GetSegmentedArrayIndexedName(dListSegmentedPtr, 8, parent,
+	                                                            "Gfx", dlistName, false);
 	if (declFound)
 		return;
 
 	int32_t dlistLength = ZDisplayList::GetDListLength(
 		parent->GetRawData(), dlistOffset,
-		Globals::Instance->game == ZGame::OOT_SW97 ? DListType::F3DEX : DListType::F3DZEX);
+		Globals::Job->game == ZGame::OOT_SW97 ? DListType::F3DEX : DListType::F3DZEX);
 	ZDisplayList* dlist = new ZDisplayList(parent);
 	dlist->ExtractFromBinary(dlistOffset, dlistLength);
 
@@ -20,6 +20,17 @@ enum class ZLimbType
 
 class ZLimbTable;
 
+// What ParseRawData reads from a limb that has no skin data
+struct ZLimbFields
+{
+	float legTransX = 0, legTransY = 0, legTransZ = 0;
+	uint16_t rotX = 0, rotY = 0, rotZ = 0;
+	segptr_t childPtr = 0, siblingPtr = 0;
+	segptr_t dListPtr = 0, dList2Ptr = 0;
+	int16_t transX = 0, transY = 0, transZ = 0;
+	uint8_t childIndex = 0, siblingIndex = 0;
+};
+
 class ZLimb : public ZResource
 {
 public:
@@ -49,6 +60,9 @@ public:
 	ZLimb(ZFile* nParent);
 
 	void ExtractFromBinary(uint32_t nRawDataIndex, ZLimbType nType);
+	// Takes the values parsed from an identical limb instead of reading them, not for skin limbs
+	void ExtractFromFields(uint32_t nRawDataIndex, ZLimbType nType, const ZLimbFields& fields);
+	ZLimbFields GetFields() const;
 
 	void ParseXML(tinyxml2::XMLElement* reader) override;
 	void ParseRawData() override;
@@ -61,6 +75,8 @@ public:
 	std::string GetSourceTypeName() const override;
 	ZResourceType GetResourceType() const override;
 
+	static size_t GetRawDataSize(ZLimbType limbType);
+
 	ZLimbType GetLimbType();
 	void SetLimbType(ZLimbType value);
 	static const char* GetSourceTypeName(ZLimbType limbType);
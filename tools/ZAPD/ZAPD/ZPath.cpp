@@ -145,8 +145,8 @@ void PathwayEntry::DeclareReferences(const std::string& prefix)
 		return;
 
 	std::string pointsName;
-	bool addressFound = Globals::Instance->GetSegmentedPtrName(listSegmentAddress, parent, "Vec3s",
-	                                                           pointsName, false);
+	bool addressFound = Globals::Job->GetSegmentedPtrName(listSegmentAddress, parent, "Vec3s",
+	                                                      pointsName, false);
 	if (addressFound)
 		return;
 
@@ -180,9 +180,9 @@ std::string PathwayEntry::GetBodySourceCode() const
 {
 	std::string declaration;
 	std::string listName;
-	Globals::Instance->GetSegmentedPtrName(listSegmentAddress, parent, "Vec3s", listName);
+	Globals::Job->GetSegmentedPtrName(listSegmentAddress, parent, "Vec3s", listName);
 
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 		declaration +=
 			StringHelper::Sprintf("%i, %i, %i, %s", numPoints, unk1, unk2, listName.c_str());
 	else
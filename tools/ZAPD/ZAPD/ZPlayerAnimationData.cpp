@@ -1,7 +1,8 @@
 #include "ZPlayerAnimationData.h"
 
-#include "Utils/BitConverter.h"
+#include "Utils/NumberFormat.h"
 #include "Utils/StringHelper.h"
+#include "WarningHandler.h"
 #include "ZFile.h"
 
 REGISTER_ZFILENODE(PlayerAnimationData, ZPlayerAnimationData);
@@ -24,15 +25,17 @@ void ZPlayerAnimationData::ParseRawData()
 {
 	ZResource::ParseRawData();
 
+	// The values are formatted straight from the file's data when the source is written, the
+	// frames of the largest animations would otherwise be held twice
 	const auto& rawData = parent->GetRawData();
 
-	size_t totalSize = GetRawDataSize();
-	// Divided by 2 because each value is an s16
-	limbRotData.reserve(totalSize * frameCount / 2);
-
-	for (size_t i = 0; i < totalSize; i += 2)
+	if (rawDataIndex + GetRawDataSize() > rawData.size())
 	{
-		limbRotData.push_back(BitConverter::ToInt16BE(rawData, rawDataIndex + i));
+		HANDLE_ERROR_RESOURCE(
+			WarningType::InvalidExtractedData, parent, this, rawDataIndex,
+			StringHelper::Sprintf("animation data goes past the end of the file (0x%zX bytes)",
+		                          rawData.size()),
+			"");
 	}
 }
 
@@ -45,40 +48,45 @@ Declaration* ZPlayerAnimationData::DeclareVar(const std::string& prefix, const s
 
 	Declaration* decl =
 		parent->AddDeclarationArray(rawDataIndex, GetDeclarationAlignment(), GetRawDataSize(),
-	                                GetSourceTypeName(), name, limbRotData.size(), bodyStr);
+	                                GetSourceTypeName(), name, GetValueCount(), bodyStr);
 	decl->staticConf = staticConf;
 	return decl;
 }
 
 std::string ZPlayerAnimationData::GetBodySourceCode() const
 {
-	std::string declaration = "";
+	const uint8_t* data = parent->GetRawData().data() + rawDataIndex;
+	size_t count = GetValueCount();
+	std::string declaration;
+
+	// "-0x0000, " at most for each value, plus the indentation and line feed of every 8 values
+	declaration.resize(count * 9 + 2 * ((count + 7) / 8));
+	char* p = declaration.data();
 
-	size_t index = 0;
-	for (const auto entry : limbRotData)
+	for (size_t i = 0; i < count; i++)
 	{
-		if (index % 8 == 0)
-		{
-			declaration += "\t";
-		}
+		int16_t value = static_cast<int16_t>((data[2 * i] << 8) | data[2 * i + 1]);
+
+		if (i % 8 == 0)
+			*p++ = '\t';
 
-		if (entry < 0)
+		if (value < 0)
 		{
-			declaration += StringHelper::Sprintf("-0x%04X, ", -entry);
+			*p++ = '-';
+			p = NumberFormat::Hex(p, -value, 4);
 		}
 		else
 		{
-			declaration += StringHelper::Sprintf("0x%04X, ", entry);
+			p = NumberFormat::Hex(p, value, 4);
 		}
+		*p++ = ',';
+		*p++ = ' ';
 
-		if ((index + 1) % 8 == 0)
-		{
-			declaration += "\n";
-		}
-
-		index++;
+		if (i % 8 == 7)
+			*p++ = '\n';
 	}
 
+	declaration.resize(p - declaration.data());
 	return declaration;
 }
 
@@ -102,3 +110,8 @@ size_t ZPlayerAnimationData::GetRawDataSize() const
 	// (sizeof(Vec3s) * limbCount + 2) * frameCount
 	return (6 * 22 + 2) * frameCount;
 }
+
+size_t ZPlayerAnimationData::GetValueCount() const
+{
+	return GetRawDataSize() / 2;
+}
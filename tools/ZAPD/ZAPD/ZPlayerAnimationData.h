@@ -1,7 +1,6 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
 
 #include "ZResource.h"
 
@@ -9,7 +8,6 @@ class ZPlayerAnimationData : public ZResource
 {
 public:
 	int16_t frameCount = 0;
-	std::vector<int16_t> limbRotData;
 
 	ZPlayerAnimationData(ZFile* nParent);
 
@@ -25,4 +23,7 @@ public:
 	ZResourceType GetResourceType() const override;
 
 	size_t GetRawDataSize() const override;
+
+	// Number of s16 of the frames, the joint rotations and the face of each
+	size_t GetValueCount() const;
 };
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <regex>
 
+#include "Profiler.h"
 #include "Utils/StringHelper.h"
 #include "WarningHandler.h"
 #include "ZFile.h"
@@ -30,11 +31,15 @@ void ZResource::ExtractWithXML(tinyxml2::XMLElement* reader, offset_t nRawDataIn
 	declaredInXml = true;
 
 	if (reader != nullptr)
+	{
+		ProfileScope profileScope(ProfilePhase::ParseXML, this);
 		ParseXML(reader);
+	}
 
 	// Don't parse raw data of external files
 	if (parent->GetMode() != ZFileMode::ExternalFile)
 	{
+		ProfileScope profileScope(ProfilePhase::ParseRawData, this);
 		ParseRawData();
 		CalcHash();
 	}
@@ -58,6 +63,7 @@ void ZResource::ExtractFromFile(offset_t nRawDataIndex)
 	if (parent->GetMode() == ZFileMode::ExternalFile)
 		return;
 
+	ProfileScope profileScope(ProfilePhase::ParseRawData, this);
 	ParseRawData();
 	CalcHash();
 }
@@ -274,7 +280,7 @@ void ZResource::GetSourceOutputCode([[maybe_unused]] const std::string& prefix)
 		if (decl == nullptr || decl->isPlaceholder)
 			decl = DeclareVar(prefix, bodyStr);
 		else
-			decl->declBody = bodyStr;
+			decl->declBody = std::move(bodyStr);
 
 		decl->staticConf = staticConf;
 	}
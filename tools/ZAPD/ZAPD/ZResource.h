@@ -7,6 +7,7 @@
 #include <vector>
 #include "Declaration.h"
 #include "Utils/BinaryWriter.h"
+#include "Utils/DataView.h"
 #include "Utils/Directory.h"
 #include "tinyxml2.h"
 
@@ -42,7 +42,7 @@ void SetActorList::DeclareReferences(const std::string& prefix)
 std::string SetActorList::GetBodySourceCode() const
 {
 	std::string listName;
-	Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "ActorEntry", listName);
+	Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "ActorEntry", listName);
 
 	return StringHelper::Sprintf("SCENE_CMD_ACTOR_LIST(%i, %s)", numActors, listName.c_str());
 }
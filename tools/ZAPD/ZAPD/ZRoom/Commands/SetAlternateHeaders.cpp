@@ -49,7 +49,7 @@ void SetAlternateHeaders::DeclareReferencesLate(const std::string& prefix)
 		for (size_t i = 0; i < headers.size(); i++)
 		{
 			std::string altHeaderName;
-			Globals::Instance->GetSegmentedPtrName(headers.at(i), parent, "", altHeaderName);
+			Globals::Job->GetSegmentedPtrName(headers.at(i), parent, "", altHeaderName);
 
 			declaration += StringHelper::Sprintf("\t%s,", altHeaderName.c_str());
 
@@ -67,7 +67,7 @@ void SetAlternateHeaders::DeclareReferencesLate(const std::string& prefix)
 std::string SetAlternateHeaders::GetBodySourceCode() const
 {
 	std::string listName;
-	Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "SceneCmd*", listName);
+	Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "SceneCmd*", listName);
 	return StringHelper::Sprintf("SCENE_CMD_ALTERNATE_HEADER_LIST(%s)", listName.c_str());
 }
 
@@ -17,7 +17,7 @@ void SetCameraSettings::ParseRawData()
 
 std::string SetCameraSettings::GetBodySourceCode() const
 {
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 		return StringHelper::Sprintf("SCENE_CMD_SET_REGION_VISITED(0x%02X, 0x%08X)", cameraMovement,
 		                             mapHighlight);
 	else
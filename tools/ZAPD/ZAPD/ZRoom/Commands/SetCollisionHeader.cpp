@@ -29,7 +29,7 @@ void SetCollisionHeader::DeclareReferences(const std::string& prefix)
 std::string SetCollisionHeader::GetBodySourceCode() const
 {
 	std::string listName;
-	Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "CollisionHeader", listName);
+	Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "CollisionHeader", listName);
 	return StringHelper::Sprintf("SCENE_CMD_COL_HEADER(%s)", listName.c_str());
 }
 
@@ -6,7 +6,7 @@
 class ActorCsCamInfo
 {
 public:
-	ActorCsCamInfo(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex);
+	ActorCsCamInfo(const DataView& rawData, uint32_t rawDataIndex);
 
 	std::string GetSourceTypeName() const;
 	int32_t GetRawDataSize() const;
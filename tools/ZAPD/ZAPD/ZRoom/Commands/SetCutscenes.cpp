@@ -16,7 +16,7 @@ void SetCutscenes::ParseRawData()
 
 	numCutscenes = cmdArg1;
 
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 	{
 		int32_t currentPtr = segmentOffset;
 
@@ -37,7 +37,7 @@ void SetCutscenes::DeclareReferences(const std::string& prefix)
 	if (varPrefix == "")
 		varPrefix = prefix;
 
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 	{
 		std::string declaration;
 		size_t i = 0;
@@ -60,8 +60,8 @@ void SetCutscenes::DeclareReferences(const std::string& prefix)
 			}
 
 			std::string csName;
-			Globals::Instance->GetSegmentedPtrName(entry.segmentPtr, parent, "CutsceneData",
-			                                       csName);
+			Globals::Job->GetSegmentedPtrName(entry.segmentPtr, parent, "CutsceneData",
+			                                  csName);
 
 			if (enumData->spawnFlag.find(entry.flag) != enumData->spawnFlag.end())
 				declaration += StringHelper::Sprintf("    { %s, 0x%04X, 0x%02X, %s },",
@@ -105,14 +105,14 @@ std::string SetCutscenes::GetBodySourceCode() const
 {
 	std::string listName;
 
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 	{
-		Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "CutsceneScriptEntry", listName);
+		Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "CutsceneScriptEntry", listName);
 		return StringHelper::Sprintf("SCENE_CMD_CUTSCENE_SCRIPT_LIST(%i, %s)", numCutscenes,
 		                             listName.c_str());
 	}
 
-	Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "CutsceneData", listName);
+	Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "CutsceneData", listName);
 	return StringHelper::Sprintf("SCENE_CMD_CUTSCENE_DATA(%s)", listName.c_str());
 }
 
@@ -126,7 +126,7 @@ RoomCommand SetCutscenes::GetRoomCommand() const
 	return RoomCommand::SetCutscenes;
 }
 
-CutsceneScriptEntry::CutsceneScriptEntry(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex)
+CutsceneScriptEntry::CutsceneScriptEntry(const DataView& rawData, uint32_t rawDataIndex)
 	: segmentPtr(BitConverter::ToInt32BE(rawData, rawDataIndex + 0)),
 	  exit(BitConverter::ToInt16BE(rawData, rawDataIndex + 4)), entrance(rawData[rawDataIndex + 6]),
 	  flag(rawData[rawDataIndex + 7])
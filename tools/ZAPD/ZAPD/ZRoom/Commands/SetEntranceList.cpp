@@ -56,7 +56,7 @@ void SetEntranceList::DeclareReferencesLate([[maybe_unused]] const std::string&
 		std::string varName =
 			StringHelper::Sprintf("%sEntranceList0x%06X", prefix.c_str(), segmentOffset);
 
-		if (Globals::Instance->game != ZGame::MM_RETAIL)
+		if (Globals::Job->game != ZGame::MM_RETAIL)
 			parent->AddDeclarationArray(segmentOffset, DeclarationAlignment::Align4,
 			                            entrances.size() * 2, "Spawn", varName, entrances.size(),
 			                            declaration);
@@ -70,10 +70,10 @@ void SetEntranceList::DeclareReferencesLate([[maybe_unused]] const std::string&
 std::string SetEntranceList::GetBodySourceCode() const
 {
 	std::string listName;
-	if (Globals::Instance->game != ZGame::MM_RETAIL)
-		Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "Spawn", listName);
+	if (Globals::Job->game != ZGame::MM_RETAIL)
+		Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "Spawn", listName);
 	else
-		Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "EntranceEntry", listName);
+		Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "EntranceEntry", listName);
 	return StringHelper::Sprintf("SCENE_CMD_ENTRANCE_LIST(%s)", listName.c_str());
 }
 
@@ -87,7 +87,7 @@ RoomCommand SetEntranceList::GetRoomCommand() const
 	return RoomCommand::SetEntranceList;
 }
 
-Spawn::Spawn(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex)
+Spawn::Spawn(const DataView& rawData, uint32_t rawDataIndex)
 {
 	startPositionIndex = rawData.at(rawDataIndex + 0);
 	roomToLoad = rawData.at(rawDataIndex + 1);
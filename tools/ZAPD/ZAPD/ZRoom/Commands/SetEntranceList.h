@@ -8,7 +8,7 @@ public:
 	uint8_t startPositionIndex;
 	uint8_t roomToLoad;
 
-	Spawn(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex);
+	Spawn(const DataView& rawData, uint32_t rawDataIndex);
 
 	std::string GetBodySourceCode() const;
 };
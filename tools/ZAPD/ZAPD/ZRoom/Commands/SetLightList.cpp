@@ -54,7 +54,7 @@ void SetLightList::DeclareReferences(const std::string& prefix)
 std::string SetLightList::GetBodySourceCode() const
 {
 	std::string listName;
-	Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "LightInfo", listName);
+	Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "LightInfo", listName);
 	return StringHelper::Sprintf("SCENE_CMD_LIGHT_LIST(%i, %s)", numLights, listName.c_str());
 }
 
@@ -68,7 +68,7 @@ RoomCommand SetLightList::GetRoomCommand() const
 	return RoomCommand::SetLightList;
 }
 
-LightInfo::LightInfo(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex)
+LightInfo::LightInfo(const DataView& rawData, uint32_t rawDataIndex)
 {
 	type = BitConverter::ToUInt8BE(rawData, rawDataIndex + 0);
 	x = BitConverter::ToInt16BE(rawData, rawDataIndex + 2);
@@ -34,7 +34,7 @@ void SetLightingSettings::DeclareReferences(const std::string& prefix)
 				declaration += "\n";
 		}
 
-		if (Globals::Instance->game != ZGame::MM_RETAIL)
+		if (Globals::Job->game != ZGame::MM_RETAIL)
 			parent->AddDeclarationArray(
 				segmentOffset, DeclarationAlignment::Align4,
 				settings.size() * settings.front().GetRawDataSize(), "EnvLightSettings",
@@ -52,10 +52,10 @@ void SetLightingSettings::DeclareReferences(const std::string& prefix)
 std::string SetLightingSettings::GetBodySourceCode() const
 {
 	std::string listName;
-	if (Globals::Instance->game != ZGame::MM_RETAIL)
-		Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "EnvLightSettings", listName);
+	if (Globals::Job->game != ZGame::MM_RETAIL)
+		Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "EnvLightSettings", listName);
 	else
-		Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "LightSettings", listName);
+		Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "LightSettings", listName);
 	return StringHelper::Sprintf("SCENE_CMD_ENV_LIGHT_SETTINGS(%i, %s)", settings.size(),
 	                             listName.c_str());
 }
@@ -70,7 +70,7 @@ RoomCommand SetLightingSettings::GetRoomCommand() const
 	return RoomCommand::SetLightingSettings;
 }
 
-LightingSettings::LightingSettings(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex)
+LightingSettings::LightingSettings(const DataView& rawData, uint32_t rawDataIndex)
 {
 	ambientClrR = rawData.at(rawDataIndex + 0);
 	ambientClrG = rawData.at(rawDataIndex + 1);
@@ -18,6 +18,18 @@ SetMesh::SetMesh(ZFile* nParent) : ZRoomCommand(nParent)
 void SetMesh::ParseRawData()
 {
 	ZRoomCommand::ParseRawData();
+
+	// The alternate headers of a room usually point to its mesh too. Its display lists are then
+	// only parsed and declared by the first header, instead of once more for every other one
+	const SetMesh* parsedMesh = FindParsedMesh();
+	if (parsedMesh != nullptr)
+	{
+		meshHeaderType = parsedMesh->meshHeaderType;
+		polyType = parsedMesh->polyType;
+		sharesMesh = true;
+		return;
+	}
+
 	auto& parentRawData = parent->GetRawData();
 	meshHeaderType = parentRawData.at(segmentOffset);
 
@@ -45,6 +57,9 @@ void SetMesh::ParseRawData()
 
 void SetMesh::DeclareReferences(const std::string& prefix)
 {
+	if (sharesMesh)
+		return;
+
 	polyType->SetName(polyType->GetDefaultName(prefix));
 	polyType->DeclareReferences(prefix);
 	polyType->DeclareAndGenerateOutputCode(prefix);
@@ -62,6 +77,25 @@ void GenDListDeclarations(ZRoom* zRoom, ZFile* parent, ZDisplayList* dList)
 		GenDListDeclarations(zRoom, parent, otherDList);
 }
 
+const SetMesh* SetMesh::FindParsedMesh() const
+{
+	for (ZResourceType roomType : {ZResourceType::Room, ZResourceType::AltHeader})
+	{
+		for (ZResource* res : parent->GetResourcesOfType(roomType))
+		{
+			ZRoom* room = static_cast<ZRoom*>(res);
+			for (const ZRoomCommand* cmd : room->commands)
+			{
+				if (cmd != this && cmd->GetRoomCommand() == RoomCommand::SetMesh &&
+				    cmd->segmentOffset == segmentOffset)
+					return static_cast<const SetMesh*>(cmd);
+			}
+		}
+	}
+
+	return nullptr;
+}
+
 std::string SetMesh::GenDListExterns(ZDisplayList* dList)
 {
 	std::string sourceOutput;
@@ -78,7 +112,7 @@ std::string SetMesh::GenDListExterns(ZDisplayList* dList)
 std::string SetMesh::GetBodySourceCode() const
 {
 	std::string list;
-	Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "", list);
+	Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "", list);
 	return StringHelper::Sprintf("SCENE_CMD_ROOM_SHAPE(%s)", list.c_str());
 }
 
@@ -129,8 +163,8 @@ std::string RoomShapeDListsEntry::GetBodySourceCode() const
 	std::string bodyStr;
 	std::string opaStr;
 	std::string xluStr;
-	Globals::Instance->GetSegmentedPtrName(opa, parent, "Gfx", opaStr);
-	Globals::Instance->GetSegmentedPtrName(xlu, parent, "Gfx", xluStr);
+	Globals::Job->GetSegmentedPtrName(opa, parent, "Gfx", opaStr);
+	Globals::Job->GetSegmentedPtrName(xlu, parent, "Gfx", xluStr);
 
 	if (polyType == 2)
 	{
@@ -201,7 +235,7 @@ ZDisplayList* RoomShapeDListsEntry::MakeDlist(segptr_t ptr,
 
 	int32_t dlistLength = ZDisplayList::GetDListLength(
 		parent->GetRawData(), dlistAddress,
-		Globals::Instance->game == ZGame::OOT_SW97 ? DListType::F3DEX : DListType::F3DZEX);
+		Globals::Job->game == ZGame::OOT_SW97 ? DListType::F3DEX : DListType::F3DZEX);
 	ZDisplayList* dlist = new ZDisplayList(parent);
 	parent->AddResource(dlist);
 	dlist->ExtractFromBinary(dlistAddress, dlistLength);
@@ -295,7 +329,7 @@ std::string RoomShapeImageMultiBgEntry::GetBodySourceCode() const
 	}
 
 	std::string backgroundName;
-	Globals::Instance->GetSegmentedPtrName(source, parent, "", backgroundName);
+	Globals::Job->GetSegmentedPtrName(source, parent, "", backgroundName);
 	bodyStr += StringHelper::Sprintf("%s, ", backgroundName.c_str());
 	bodyStr += "\n    ";
 	if (!isSubStruct)
@@ -496,7 +530,7 @@ std::string PolygonType1::GetBodySourceCode() const
 	bodyStr += StringHelper::Sprintf("%i, %i, ", type, format);
 
 	std::string dlistStr;
-	Globals::Instance->GetSegmentedPtrName(dlist, parent, "", dlistStr);
+	Globals::Job->GetSegmentedPtrName(dlist, parent, "", dlistStr);
 
 	bodyStr += StringHelper::Sprintf("%s, ", dlistStr.c_str());
 	bodyStr += "}, \n";
@@ -508,7 +542,7 @@ std::string PolygonType1::GetBodySourceCode() const
 		bodyStr += single.GetBodySourceCode();
 		break;
 	case 2:
-		Globals::Instance->GetSegmentedPtrName(list, parent, "RoomShapeImageMultiBgEntry", listStr);
+		Globals::Job->GetSegmentedPtrName(list, parent, "RoomShapeImageMultiBgEntry", listStr);
 		bodyStr += StringHelper::Sprintf("    %i, %s, \n", count, listStr.c_str());
 		break;
 
@@ -597,7 +631,7 @@ void RoomShapeCullable::DeclareReferences(const std::string& prefix)
 std::string RoomShapeCullable::GetBodySourceCode() const
 {
 	std::string listName;
-	Globals::Instance->GetSegmentedPtrName(start, parent, "", listName);
+	Globals::Job->GetSegmentedPtrName(start, parent, "", listName);
 
 	std::string body = StringHelper::Sprintf("\n    %i, %i,\n", type, polyDLists.size());
 	body += StringHelper::Sprintf("    %s,\n", listName.c_str());
@@ -144,6 +144,8 @@ public:
 	uint8_t data;
 	uint8_t meshHeaderType;
 	std::shared_ptr<PolygonTypeBase> polyType;
+	// Whether `polyType` is the one parsed by the SetMesh of another header of the file
+	bool sharesMesh = false;
 
 	SetMesh(ZFile* nParent);
 
@@ -156,5 +158,7 @@ public:
 	std::string GetCommandCName() const override;
 
 private:
+	// The SetMesh of another header already parsed that points to the same mesh, if any
+	const SetMesh* FindParsedMesh() const;
 	std::string GenDListExterns(ZDisplayList* dList);
 };
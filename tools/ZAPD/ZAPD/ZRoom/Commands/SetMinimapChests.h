@@ -5,7 +5,7 @@
 class MinimapChest
 {
 public:
-	MinimapChest(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex);
+	MinimapChest(const DataView& rawData, uint32_t rawDataIndex);
 
 	std::string GetBodySourceCode() const;
 
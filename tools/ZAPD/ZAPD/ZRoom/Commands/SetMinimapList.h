@@ -5,7 +5,7 @@
 class MinimapEntry
 {
 public:
-	MinimapEntry(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex);
+	MinimapEntry(const DataView& rawData, uint32_t rawDataIndex);
 
 	std::string GetBodySourceCode() const;
 
@@ -22,7 +22,7 @@ void SetPathways::DeclareReferences([[maybe_unused]] const std::string& prefix)
 
 void SetPathways::ParseRawDataLate()
 {
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 	{
 		auto numPaths = zRoom->parent->GetDeclarationSizeFromNeighbor(segmentOffset) / 8;
 		pathwayList.SetNumPaths(numPaths);
@@ -42,7 +42,7 @@ void SetPathways::DeclareReferencesLate(const std::string& prefix)
 std::string SetPathways::GetBodySourceCode() const
 {
 	std::string listName;
-	Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "Path", listName);
+	Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "Path", listName);
 	return StringHelper::Sprintf("SCENE_CMD_PATH_LIST(%s)", listName.c_str());
 }
 
@@ -26,7 +26,7 @@ void SetRoomBehavior::ParseRawData()
 
 std::string SetRoomBehavior::GetBodySourceCode() const
 {
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 	{
 		std::string enableLights = StringHelper::BoolStr(enablePosLights);
 		return StringHelper::Sprintf("SCENE_CMD_ROOM_BEHAVIOR(0x%02X, 0x%02X, %i, %i, %s, %i)",
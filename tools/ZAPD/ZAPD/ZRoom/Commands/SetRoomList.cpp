@@ -34,7 +34,7 @@ void SetRoomList::DeclareReferences(const std::string& prefix)
 std::string SetRoomList::GetBodySourceCode() const
 {
 	std::string listName;
-	Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "RomFile", listName);
+	Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "RomFile", listName);
 	return StringHelper::Sprintf("SCENE_CMD_ROOM_LIST(%i, %s)", romfile->rooms.size(),
 	                             listName.c_str());
 }
@@ -95,8 +95,9 @@ std::string RomFile::GetBodySourceCode() const
 	std::string declaration;
 	bool isFirst = true;
 
-	for (ZFile* file : Globals::Instance->files)
+	for (ZFile* file : Globals::Job->files)
 	{
+		file->MaterializeResources();
 		for (ZResource* res : file->resources)
 		{
 			if (res->GetResourceType() == ZResourceType::Room)
@@ -143,7 +144,7 @@ RoomEntry::RoomEntry(uint32_t nVAS, uint32_t nVAE)
 	virtualAddressEnd = nVAE;
 }
 
-RoomEntry::RoomEntry(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex)
+RoomEntry::RoomEntry(const DataView& rawData, uint32_t rawDataIndex)
 	: RoomEntry(BitConverter::ToInt32BE(rawData, rawDataIndex + 0),
                 BitConverter::ToInt32BE(rawData, rawDataIndex + 4))
 {
@@ -9,7 +9,7 @@ public:
 	int32_t virtualAddressEnd;
 
 	RoomEntry(uint32_t nVAS, uint32_t nVAE);
-	RoomEntry(const std::vector<uint8_t>& rawData, uint32_t rawDataIndex);
+	RoomEntry(const DataView& rawData, uint32_t rawDataIndex);
 
 	size_t GetRawDataSize() const;
 };
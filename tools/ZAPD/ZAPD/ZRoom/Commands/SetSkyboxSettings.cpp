@@ -18,7 +18,7 @@ void SetSkyboxSettings::ParseRawData()
 std::string SetSkyboxSettings::GetBodySourceCode() const
 {
 	std::string indoors = StringHelper::BoolStr(isIndoors);
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 		return StringHelper::Sprintf("SCENE_CMD_SKYBOX_SETTINGS(0x%02X, %i, %i, %s)", unk1,
 		                             skyboxNumber, cloudsType, indoors.c_str());
 	return StringHelper::Sprintf("SCENE_CMD_SKYBOX_SETTINGS(%i, %i, %s)", skyboxNumber, cloudsType,
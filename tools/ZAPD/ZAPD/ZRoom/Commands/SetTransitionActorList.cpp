@@ -53,7 +53,7 @@ void SetTransitionActorList::DeclareReferences(const std::string& prefix)
 std::string SetTransitionActorList::GetBodySourceCode() const
 {
 	std::string listName;
-	Globals::Instance->GetSegmentedPtrName(cmdArg2, parent, "TransitionActorEntry", listName);
+	Globals::Job->GetSegmentedPtrName(cmdArg2, parent, "TransitionActorEntry", listName);
 	return StringHelper::Sprintf("SCENE_CMD_TRANSITION_ACTOR_LIST(%i, %s)", transitionActors.size(),
 	                             listName.c_str());
 }
@@ -68,7 +68,7 @@ RoomCommand SetTransitionActorList::GetRoomCommand() const
 	return RoomCommand::SetTransitionActorList;
 }
 
-TransitionActorEntry::TransitionActorEntry(const std::vector<uint8_t>& rawData, int rawDataIndex)
+TransitionActorEntry::TransitionActorEntry(const DataView& rawData, int rawDataIndex)
 {
 	frontObjectRoom = rawData[rawDataIndex + 0];
 	frontTransitionReaction = rawData[rawDataIndex + 1];
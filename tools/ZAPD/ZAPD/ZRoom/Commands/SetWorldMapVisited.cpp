@@ -9,7 +9,7 @@ SetWorldMapVisited::SetWorldMapVisited(ZFile* nParent) : ZRoomCommand(nParent)
 
 std::string SetWorldMapVisited::GetBodySourceCode() const
 {
-	if (Globals::Instance->game == ZGame::MM_RETAIL)
+	if (Globals::Job->game == ZGame::MM_RETAIL)
 		return "SCENE_CMD_SET_REGION_VISITED()";
 	else
 		return "SCENE_CMD_MISC_SETTINGS()";
@@ -17,7 +17,7 @@ public:
 
 	static std::string GetActorName(uint16_t id)
 	{
-		switch (Globals::Instance->game)
+		switch (Globals::Job->game)
 		{
 		case ZGame::OOT_RETAIL:
 		case ZGame::OOT_SW97:
@@ -227,7 +227,7 @@ void ZRoom::ParseRawData()
 			cmd = new SetAlternateHeaders(parent);
 			break;  // 0x18
 		case RoomCommand::SetCameraSettings:
-			if (Globals::Instance->game == ZGame::MM_RETAIL)
+			if (Globals::Job->game == ZGame::MM_RETAIL)
 				cmd = new SetWorldMapVisited(parent);
 			else
 				cmd = new SetCameraSettings(parent);
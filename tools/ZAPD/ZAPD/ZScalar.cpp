@@ -1,8 +1,11 @@
 #include "ZScalar.h"
 
+#include <cstdio>
+
 #include "Globals.h"
 #include "Utils/BitConverter.h"
 #include "Utils/File.h"
+#include "Utils/NumberFormat.h"
 #include "Utils/StringHelper.h"
 #include "WarningHandler.h"
 #include "ZFile.h"
@@ -168,50 +171,64 @@ size_t ZScalar::GetRawDataSize() const
 	return ZScalar::MapTypeToSize(scalarType);
 }
 
-void ZScalar::ParseRawData()
+ZScalarData ZScalar::ParseScalarData(const DataView& rawData, offset_t offset,
+                                     ZScalarType scalarType)
 {
-	const auto& rawData = parent->GetRawData();
+	ZScalarData data;
+
+	memset(&data, 0, sizeof(ZScalarData));
 	switch (scalarType)
 	{
 	case ZScalarType::ZSCALAR_S8:
-		scalarData.s8 = BitConverter::ToInt8BE(rawData, rawDataIndex);
+		data.s8 = BitConverter::ToInt8BE(rawData, offset);
 		break;
 	case ZScalarType::ZSCALAR_U8:
 	case ZScalarType::ZSCALAR_X8:
-		scalarData.u8 = BitConverter::ToUInt8BE(rawData, rawDataIndex);
+		data.u8 = BitConverter::ToUInt8BE(rawData, offset);
 		break;
 	case ZScalarType::ZSCALAR_S16:
-		scalarData.s16 = BitConverter::ToInt16BE(rawData, rawDataIndex);
+		data.s16 = BitConverter::ToInt16BE(rawData, offset);
 		break;
 	case ZScalarType::ZSCALAR_U16:
 	case ZScalarType::ZSCALAR_X16:
-		scalarData.u16 = BitConverter::ToUInt16BE(rawData, rawDataIndex);
+		data.u16 = BitConverter::ToUInt16BE(rawData, offset);
 		break;
 	case ZScalarType::ZSCALAR_S32:
-		scalarData.s32 = BitConverter::ToInt32BE(rawData, rawDataIndex);
+		data.s32 = BitConverter::ToInt32BE(rawData, offset);
 		break;
 	case ZScalarType::ZSCALAR_U32:
 	case ZScalarType::ZSCALAR_X32:
-		scalarData.u32 = BitConverter::ToUInt32BE(rawData, rawDataIndex);
+		data.u32 = BitConverter::ToUInt32BE(rawData, offset);
 		break;
 	case ZScalarType::ZSCALAR_S64:
-		scalarData.s64 = BitConverter::ToInt64BE(rawData, rawDataIndex);
+		data.s64 = BitConverter::ToInt64BE(rawData, offset);
 		break;
 	case ZScalarType::ZSCALAR_U64:
 	case ZScalarType::ZSCALAR_X64:
-		scalarData.u64 = BitConverter::ToUInt64BE(rawData, rawDataIndex);
+		data.u64 = BitConverter::ToUInt64BE(rawData, offset);
 		break;
 	case ZScalarType::ZSCALAR_F32:
-		scalarData.f32 = BitConverter::ToFloatBE(rawData, rawDataIndex);
+		data.f32 = BitConverter::ToFloatBE(rawData, offset);
 		break;
 	case ZScalarType::ZSCALAR_F64:
-		scalarData.f64 = BitConverter::ToDoubleBE(rawData, rawDataIndex);
+		data.f64 = BitConverter::ToDoubleBE(rawData, offset);
 		break;
 	case ZScalarType::ZSCALAR_NONE:
+		break;
+	}
+
+	return data;
+}
+
+void ZScalar::ParseRawData()
+{
+	if (scalarType == ZScalarType::ZSCALAR_NONE)
+	{
 		HANDLE_ERROR_RESOURCE(WarningType::InvalidAttributeValue, parent, this, rawDataIndex,
 		                      "invalid value found for 'Type' attribute", "Defaulting to ''");
-		break;
 	}
+
+	scalarData = ParseScalarData(parent->GetRawData(), rawDataIndex, scalarType);
 }
 
 std::string ZScalar::GetSourceTypeName() const
@@ -219,41 +236,70 @@ std::string ZScalar::GetSourceTypeName() const
 	return ZScalar::MapScalarTypeToOutputType(scalarType);
 }
 
-std::string ZScalar::GetBodySourceCode() const
+void ZScalar::AppendBodySourceCode(std::string& output, ZScalarType scalarType,
+                                   const ZScalarData& data)
 {
+	char buf[512];
+	char* end = buf;
+
 	switch (scalarType)
 	{
 	case ZScalarType::ZSCALAR_S8:
-		return StringHelper::Sprintf("%hhd", scalarData.s8);
+		end = NumberFormat::Dec(buf, data.s8);
+		break;
 	case ZScalarType::ZSCALAR_U8:
-		return StringHelper::Sprintf("%hhu", scalarData.u8);
+		end = NumberFormat::UDec(buf, data.u8);
+		break;
 	case ZScalarType::ZSCALAR_X8:
-		return StringHelper::Sprintf("0x%02X", scalarData.u8);
+		end = NumberFormat::Hex(buf, data.u8, 2);
+		break;
 	case ZScalarType::ZSCALAR_S16:
-		return StringHelper::Sprintf("%hd", scalarData.s16);
+		end = NumberFormat::Dec(buf, data.s16);
+		break;
 	case ZScalarType::ZSCALAR_U16:
-		return StringHelper::Sprintf("%hu", scalarData.u16);
+		end = NumberFormat::UDec(buf, data.u16);
+		break;
 	case ZScalarType::ZSCALAR_X16:
-		return StringHelper::Sprintf("0x%04X", scalarData.u16);
+		end = NumberFormat::Hex(buf, data.u16, 4);
+		break;
 	case ZScalarType::ZSCALAR_S32:
-		return StringHelper::Sprintf("%d", scalarData.s32);
+		end = NumberFormat::Dec(buf, data.s32);
+		break;
 	case ZScalarType::ZSCALAR_U32:
-		return StringHelper::Sprintf("%u", scalarData.u32);
+		end = NumberFormat::UDec(buf, data.u32);
+		break;
 	case ZScalarType::ZSCALAR_X32:
-		return StringHelper::Sprintf("0x%08X", scalarData.u32);
+		end = NumberFormat::Hex(buf, data.u32, 8);
+		break;
 	case ZScalarType::ZSCALAR_S64:
-		return StringHelper::Sprintf("%lld", scalarData.s64);
+		end = NumberFormat::Dec(buf, data.s64);
+		break;
 	case ZScalarType::ZSCALAR_U64:
-		return StringHelper::Sprintf("%llu", scalarData.u64);
+		end = NumberFormat::UDec(buf, data.u64);
+		break;
 	case ZScalarType::ZSCALAR_X64:
-		return StringHelper::Sprintf("0x%016X", scalarData.u64);
+		// Only the low word has ever been written, as "%016X"
+		end = NumberFormat::Hex(buf, static_cast<uint32_t>(data.u64), 16);
+		break;
 	case ZScalarType::ZSCALAR_F32:
-		return StringHelper::Sprintf("%f", scalarData.f32);
+		end = buf + snprintf(buf, sizeof(buf), "%f", data.f32);
+		break;
 	case ZScalarType::ZSCALAR_F64:
-		return StringHelper::Sprintf("%lf", scalarData.f64);
+		end = buf + snprintf(buf, sizeof(buf), "%lf", data.f64);
+		break;
 	default:
-		return "SCALAR_ERROR";
+		output += "SCALAR_ERROR";
+		return;
 	}
+
+	output.append(buf, end - buf);
+}
+
+std::string ZScalar::GetBodySourceCode() const
+{
+	std::string output;
+	AppendBodySourceCode(output, scalarType, scalarData);
+	return output;
 }
 
 ZResourceType ZScalar::GetResourceType() const
@@ -62,6 +62,13 @@ public:
 	size_t GetRawDataSize() const override;
 	DeclarationAlignment GetDeclarationAlignment() const override;
 
+	// Decodes a scalar of type `scalarType` from `rawData` at `offset`
+	static ZScalarData ParseScalarData(const DataView& rawData, offset_t offset,
+	                                   ZScalarType scalarType);
+	// Formats `data` the way GetBodySourceCode does, at the end of `output`
+	static void AppendBodySourceCode(std::string& output, ZScalarType scalarType,
+	                                 const ZScalarData& data);
+
 	static size_t MapTypeToSize(const ZScalarType scalarType);
 	static ZScalarType MapOutputTypeToScalarType(const std::string& type);
 	static std::string MapScalarTypeToOutputType(const ZScalarType scalarType);
@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "Globals.h"
+#include "LimbTableRegistry.h"
 #include "Utils/BitConverter.h"
 #include "Utils/StringHelper.h"
 #include "WarningHandler.h"
@@ -138,7 +139,7 @@ void ZSkeleton::DeclareReferences(const std::string& prefix)
 std::string ZSkeleton::GetBodySourceCode() const
 {
 	std::string limbArrayName;
-	Globals::Instance->GetSegmentedPtrName(limbsArrayAddress, parent, "", limbArrayName);
+	Globals::Job->GetSegmentedPtrName(limbsArrayAddress, parent, "", limbArrayName);
 
 	std::string countStr;
 	assert(limbsTable != nullptr);
@@ -303,6 +304,24 @@ void ZLimbTable::DeclareReferences(const std::string& prefix)
 		varPrefix = prefix;
 
 	ZResource::DeclareReferences(varPrefix);
+
+	// An identical table already parsed by another job of the batch gives the values of the limbs
+	LimbTableRegistry* registry = Globals::Instance->limbTableRegistry;
+	std::string contentKey;
+	std::shared_ptr<const LimbTableRegistry::LimbList> knownLimbs;
+	if (registry != nullptr && limbType != ZLimbType::Skin &&
+	    parent->GetMode() != ZFileMode::ExternalFile)
+	{
+		contentKey = GetLimbsContentKey();
+		if (contentKey != "")
+			knownLimbs = registry->Find(contentKey);
+	}
+
+	bool shareLimbs = contentKey != "" && knownLimbs == nullptr;
+	std::shared_ptr<LimbTableRegistry::LimbList> parsedLimbs;
+	if (shareLimbs)
+		parsedLimbs = std::make_shared<LimbTableRegistry::LimbList>(count);
+
 	limbsReferences.reserve(count);
 	for (size_t i = 0; i < count; i++)
 	{
@@ -316,7 +335,10 @@ void ZLimbTable::DeclareReferences(const std::string& prefix)
 			if (!parent->HasDeclaration(limbOffset))
 			{
 				limb = new ZLimb(parent);
-				limb->ExtractFromBinary(limbOffset, limbType);
+				if (knownLimbs != nullptr)
+					limb->ExtractFromFields(limbOffset, limbType, knownLimbs->at(i));
+				else
+					limb->ExtractFromBinary(limbOffset, limbType);
 				limb->SetName(limb->GetDefaultName(varPrefix));
 				limb->DeclareVar(varPrefix, "");
 				limb->DeclareReferences(varPrefix);
@@ -327,14 +349,53 @@ void ZLimbTable::DeclareReferences(const std::string& prefix)
 				limb = static_cast<ZLimb*>(parent->FindResource(limbOffset));
 				assert(limb != nullptr);
 				assert(limb->GetResourceType() == ZResourceType::Limb);
+
+				// A <Limb> of another type read these bytes differently
+				if (limb->GetLimbType() != limbType)
+					shareLimbs = false;
 			}
 
 			limb->limbsTable = this;
 			limb->SetLimbIndex(i + 1);
 
 			limbsReferences.push_back(limb);
+
+			if (shareLimbs)
+				parsedLimbs->at(i) = limb->GetFields();
 		}
 	}
+
+	if (shareLimbs)
+		registry->Add(contentKey, std::move(parsedLimbs));
+}
+
+/**
+ * The bytes the limbs of this table are parsed from: the limb type, the segment, the table itself
+ * and every limb of the file it points to, in order. Empty if a limb lies outside of the file.
+ */
+std::string ZLimbTable::GetLimbsContentKey() const
+{
+	const auto& rawData = parent->GetRawData();
+	size_t limbSize = ZLimb::GetRawDataSize(limbType);
+	std::string key;
+
+	key.push_back(static_cast<char>(limbType));
+	key.push_back(static_cast<char>(parent->segment));
+	key.append(reinterpret_cast<const char*>(rawData.data() + rawDataIndex), 4 * count);
+
+	for (segptr_t limbAddress : limbsAddresses)
+	{
+		if (limbAddress == 0 || GETSEGNUM(limbAddress) != parent->segment)
+			continue;
+
+		uint32_t limbOffset = Seg2Filespace(limbAddress, parent->baseAddress);
+		if (limbOffset + limbSize > rawData.size())
+			return "";
+
+		key.append(reinterpret_cast<const char*>(rawData.data() + limbOffset), limbSize);
+	}
+
+	return key;
 }
 
 Declaration* ZLimbTable::DeclareVar(const std::string& prefix, const std::string& bodyStr)
@@ -358,7 +419,7 @@ std::string ZLimbTable::GetBodySourceCode() const
 	for (size_t i = 0; i < count; i++)
 	{
 		std::string limbName;
-		Globals::Instance->GetSegmentedPtrName(limbsAddresses[i], parent, "", limbName);
+		Globals::Job->GetSegmentedPtrName(limbsAddresses[i], parent, "", limbName);
 		body += StringHelper::Sprintf("\t%s,", limbName.c_str());
 
 		auto& limb = limbsReferences.at(i);
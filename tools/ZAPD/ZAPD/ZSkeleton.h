@@ -49,6 +49,9 @@ public:
 	size_t GetRawDataSize() const override;
 
 	std::string GetLimbEnumName(uint8_t limbIndex) const;
+
+protected:
+	std::string GetLimbsContentKey() const;
 };
 
 class ZSkeleton : public ZResource
@@ -6,6 +6,8 @@
 class ZSymbol : public ZResource
 {
 protected:
+	friend class ExternalIndex;
+
 	std::string type;
 	size_t typeSize;
 	bool isArray = false;
@@ -4,9 +4,13 @@
 
 #include "CRC32.h"
 #include "Globals.h"
+#include "Profiler.h"
+#include "TextureCodecs.h"
+#include "TextureRegistry.h"
 #include "Utils/BitConverter.h"
 #include "Utils/Directory.h"
 #include "Utils/File.h"
+#include "Utils/NumberFormat.h"
 #include "Utils/Path.h"
 #include "WarningHandler.h"
 
@@ -176,226 +180,160 @@ void ZTexture::ParseRawDataLate()
 	if (registeredAttributes["ExternalTlut"].wasSet)
 	{
 		const std::string externPalette = registeredAttributes["ExternalTlut"].value;
-		for (const auto& file : Globals::Instance->files)
+		ZFile* file = Globals::Job->GetFileByName(externPalette);
+		if (file != nullptr)
 		{
-			if (file->GetName() == externPalette)
+			offset_t palOffset = 0;
+			if (registeredAttributes["ExternalTlutOffset"].wasSet)
 			{
-				offset_t palOffset = 0;
-				if (registeredAttributes["ExternalTlutOffset"].wasSet)
+				palOffset =
+					StringHelper::StrToL(registeredAttributes["ExternalTlutOffset"].value, 16);
+			}
+			else
+			{
+				HANDLE_WARNING_RESOURCE(
+					WarningType::MissingOffsets, parent, this, rawDataIndex,
+					StringHelper::Sprintf("No ExternalTlutOffset Given. Assuming offset of 0x0"),
+					"");
+			}
+
+			ZResource* res = file->FindResource(palOffset);
+			if (res != nullptr)
+			{
+				ZTexture* palette = (ZTexture*)res;
+
+				// A palette declared as RGBA16 is already decoded the way its TLUT would be, so
+				// every texture sharing it takes the colors from there instead of decoding again
+				if (palette->format == TextureType::RGBA16bpp &&
+				    palette->rawDataIndex == palOffset)
 				{
-					palOffset =
-						StringHelper::StrToL(registeredAttributes["ExternalTlutOffset"].value, 16);
+					tlut = palette;
+					textureData.SetPalette(tlut->textureData, splitTlut ? 128 : 0);
 				}
 				else
 				{
-					HANDLE_WARNING_RESOURCE(
-						WarningType::MissingOffsets, parent, this, rawDataIndex,
-						StringHelper::Sprintf(
-							"No ExternalTlutOffset Given. Assuming offset of 0x0"),
-						"");
-				}
-				for (const auto& res : file->resources)
-				{
-					if (res->GetRawDataIndex() == palOffset)
-					{
-						ZTexture* palette = (ZTexture*)res;
-						ZTexture tlutTemp(file);
-
-						tlut = &tlutTemp;
-						tlut->ExtractFromBinary(palOffset, palette->width, palette->height,
-						                        TextureType::RGBA16bpp, true);
-						SetTlut(tlut);
-					}
+					externalTlut = std::make_unique<ZTexture>(file);
+					externalTlut->ExtractFromBinary(palOffset, palette->width, palette->height,
+					                                TextureType::RGBA16bpp, true);
+					SetTlut(externalTlut.get());
 				}
 			}
 		}
 	}
 }
 
-void ZTexture::ConvertN64ToBitmap_RGBA16()
+const uint8_t* ZTexture::GetN64Data() const
 {
-	textureData.InitEmptyRGBImage(width, height, true);
-	const auto& parentRawData = parent->GetRawData();
+	const DataView& parentRawData = parent->GetRawData();
+
+	if (rawDataIndex + GetRawDataSize() > parentRawData.size())
+	{
+		HANDLE_ERROR_RESOURCE(
+			WarningType::InvalidExtractedData, parent, this, rawDataIndex,
+			StringHelper::Sprintf("texture data goes past the end of the file (0x%zX bytes)",
+			                      parentRawData.size()),
+			"");
+	}
+
+	return parentRawData.data() + rawDataIndex;
+}
+
+void ZTexture::SetGrayscalePalette(uint8_t step)
+{
+	// Every index in use gets a gray color, so the PNG is viewable if no TLUT gets set later
+	bool usedIndices[256] = {};
+
 	for (size_t y = 0; y < height; y++)
 	{
+		const uint8_t* row = textureData.GetRow(y);
 		for (size_t x = 0; x < width; x++)
+			usedIndices[row[x]] = true;
+	}
+
+	for (size_t i = 0; i < 256; i++)
+	{
+		if (usedIndices[i])
 		{
-			int32_t pos = rawDataIndex + ((y * width) + x) * 2;
-			uint16_t data = parentRawData.at(pos + 1) | (parentRawData.at(pos) << 8);
-			uint8_t r = (data & 0xF800) >> 11;
-			uint8_t g = (data & 0x07C0) >> 6;
-			uint8_t b = (data & 0x003E) >> 1;
-			uint8_t alpha = data & 0x01;
-
-			textureData.SetRGBPixel(y, x, (r << 3) | (r >> 2), (g << 3) | (g >> 2),
-			                        (b << 3) | (b >> 2), alpha * 255);
+			uint8_t grayscale = i * step;
+			textureData.SetPaletteIndex(i, grayscale, grayscale, grayscale, 255);
 		}
 	}
 }
 
-void ZTexture::ConvertN64ToBitmap_RGBA32()
+void ZTexture::ConvertN64ToBitmap_RGBA16()
 {
 	textureData.InitEmptyRGBImage(width, height, true);
-	const auto& parentRawData = parent->GetRawData();
+	const uint8_t* n64Data = GetN64Data();
 	for (size_t y = 0; y < height; y++)
-	{
-		for (size_t x = 0; x < width; x++)
-		{
-			size_t pos = rawDataIndex + ((y * width) + x) * 4;
-			uint8_t r = parentRawData.at(pos + 0);
-			uint8_t g = parentRawData.at(pos + 1);
-			uint8_t b = parentRawData.at(pos + 2);
-			uint8_t alpha = parentRawData.at(pos + 3);
+		TextureCodecs::DecodeRGBA16(n64Data + y * width * 2, textureData.GetRow(y), width);
+}
 
-			textureData.SetRGBPixel(y, x, r, g, b, alpha);
-		}
-	}
+void ZTexture::ConvertN64ToBitmap_RGBA32()
+{
+	textureData.InitEmptyRGBImage(width, height, true);
+	const uint8_t* n64Data = GetN64Data();
+	for (size_t y = 0; y < height; y++)
+		TextureCodecs::DecodeRGBA32(n64Data + y * width * 4, textureData.GetRow(y), width);
 }
 
 void ZTexture::ConvertN64ToBitmap_Grayscale4()
 {
 	textureData.InitEmptyRGBImage(width, height, false);
-	const auto& parentRawData = parent->GetRawData();
+	const uint8_t* n64Data = GetN64Data();
 	for (size_t y = 0; y < height; y++)
-	{
-		for (size_t x = 0; x < width; x += 2)
-		{
-			for (uint8_t i = 0; i < 2; i++)
-			{
-				size_t pos = rawDataIndex + ((y * width) + x) / 2;
-				uint8_t grayscale = 0;
-
-				if (i == 0)
-					grayscale = parentRawData.at(pos) & 0xF0;
-				else
-					grayscale = (parentRawData.at(pos) & 0x0F) << 4;
-
-				textureData.SetGrayscalePixel(y, x + i, (grayscale << 4) | grayscale);
-			}
-		}
-	}
+		TextureCodecs::DecodeI4(n64Data + y * width / 2, textureData.GetRow(y), width);
 }
 
 void ZTexture::ConvertN64ToBitmap_Grayscale8()
 {
 	textureData.InitEmptyRGBImage(width, height, false);
-	const auto& parentRawData = parent->GetRawData();
+	const uint8_t* n64Data = GetN64Data();
 	for (size_t y = 0; y < height; y++)
-	{
-		for (size_t x = 0; x < width; x++)
-		{
-			size_t pos = rawDataIndex + ((y * width) + x) * 1;
-
-			textureData.SetGrayscalePixel(y, x, parentRawData.at(pos));
-		}
-	}
+		TextureCodecs::DecodeI8(n64Data + y * width, textureData.GetRow(y), width);
 }
 
 void ZTexture::ConvertN64ToBitmap_GrayscaleAlpha4()
 {
 	textureData.InitEmptyRGBImage(width, height, true);
-	const auto& parentRawData = parent->GetRawData();
+	const uint8_t* n64Data = GetN64Data();
 	for (size_t y = 0; y < height; y++)
-	{
-		for (size_t x = 0; x < width; x += 2)
-		{
-			for (uint16_t i = 0; i < 2; i++)
-			{
-				size_t pos = rawDataIndex + ((y * width) + x) / 2;
-				uint8_t data = 0;
-
-				if (i == 0)
-					data = (parentRawData.at(pos) & 0xF0) >> 4;
-				else
-					data = parentRawData.at(pos) & 0x0F;
-
-				uint8_t grayscale = data & 0b1110;
-				grayscale = (grayscale << 4) | (grayscale << 1) | (grayscale >> 2);
-				uint8_t alpha = (data & 0x01) ? 255 : 0;
-
-				textureData.SetGrayscalePixel(y, x + i, grayscale, alpha);
-			}
-		}
-	}
+		TextureCodecs::DecodeIA4(n64Data + y * width / 2, textureData.GetRow(y), width);
 }
 
 void ZTexture::ConvertN64ToBitmap_GrayscaleAlpha8()
 {
 	textureData.InitEmptyRGBImage(width, height, true);
-	const auto& parentRawData = parent->GetRawData();
+	const uint8_t* n64Data = GetN64Data();
 	for (size_t y = 0; y < height; y++)
-	{
-		for (size_t x = 0; x < width; x++)
-		{
-			size_t pos = rawDataIndex + ((y * width) + x) * 1;
-			uint8_t pixel = parentRawData.at(pos);
-			uint8_t data = (pixel >> 4) & 0xF;
-
-			data = (data << 4) | data;
-			uint8_t grayscale = data;
-			uint8_t alpha = (pixel & 0xF);
-			alpha = (alpha << 4) | alpha;
-
-			textureData.SetGrayscalePixel(y, x, grayscale, alpha);
-		}
-	}
+		TextureCodecs::DecodeIA8(n64Data + y * width, textureData.GetRow(y), width);
 }
 
 void ZTexture::ConvertN64ToBitmap_GrayscaleAlpha16()
 {
 	textureData.InitEmptyRGBImage(width, height, true);
-	const auto& parentRawData = parent->GetRawData();
+	const uint8_t* n64Data = GetN64Data();
 	for (size_t y = 0; y < height; y++)
-	{
-		for (size_t x = 0; x < width; x++)
-		{
-			size_t pos = rawDataIndex + ((y * width) + x) * 2;
-			uint8_t grayscale = parentRawData.at(pos + 0);
-			uint8_t alpha = parentRawData.at(pos + 1);
-
-			textureData.SetGrayscalePixel(y, x, grayscale, alpha);
-		}
-	}
+		TextureCodecs::DecodeIA16(n64Data + y * width * 2, textureData.GetRow(y), width);
 }
 
 void ZTexture::ConvertN64ToBitmap_Palette4()
 {
 	textureData.InitEmptyPaletteImage(width, height);
-	const auto& parentRawData = parent->GetRawData();
+	const uint8_t* n64Data = GetN64Data();
 	for (size_t y = 0; y < height; y++)
-	{
-		for (size_t x = 0; x < width; x += 2)
-		{
-			for (uint16_t i = 0; i < 2; i++)
-			{
-				size_t pos = rawDataIndex + ((y * width) + x) / 2;
-				uint8_t paletteIndex = 0;
+		TextureCodecs::DecodeCI4(n64Data + y * width / 2, textureData.GetRow(y), width);
 
-				if (i == 0)
-					paletteIndex = (parentRawData.at(pos) & 0xF0) >> 4;
-				else
-					paletteIndex = (parentRawData.at(pos) & 0x0F);
-
-				textureData.SetIndexedPixel(y, x + i, paletteIndex, paletteIndex * 16);
-			}
-		}
-	}
+	SetGrayscalePalette(16);
 }
 
 void ZTexture::ConvertN64ToBitmap_Palette8()
 {
 	textureData.InitEmptyPaletteImage(width, height);
-	const auto& parentRawData = parent->GetRawData();
+	const uint8_t* n64Data = GetN64Data();
 	for (size_t y = 0; y < height; y++)
-	{
-		for (size_t x = 0; x < width; x++)
-		{
-			size_t pos = rawDataIndex + ((y * width) + x) * 1;
-			uint8_t grayscale = parentRawData.at(pos);
+		TextureCodecs::DecodeCI8(n64Data + y * width, textureData.GetRow(y), width);
 
-			textureData.SetIndexedPixel(y, x, grayscale, grayscale);
-		}
-	}
+	SetGrayscalePalette(1);
 }
 
 void ZTexture::DeclareReferences([[maybe_unused]] const std::string& prefix)
@@ -429,6 +367,17 @@ void ZTexture::PrepareRawDataFromFile(const fs::path& pngFilePath)
 	width = textureData.GetWidth();
 	height = textureData.GetHeight();
 
+	bool isPaletteFormat =
+		(format == TextureType::Palette4bpp) || (format == TextureType::Palette8bpp);
+	if (textureData.IsColorIndexed() != isPaletteFormat)
+	{
+		HANDLE_ERROR_PROCESS(WarningType::InvalidPNG,
+		                     StringHelper::Sprintf("the PNG file '%s' must %sbe color indexed",
+		                                           pngFilePath.string().c_str(),
+		                                           isPaletteFormat ? "" : "not "),
+		                     "");
+	}
+
 	textureDataRaw.clear();
 	textureDataRaw.resize(ALIGN8(GetRawDataSize()));
 
@@ -469,161 +418,87 @@ void ZTexture::PrepareRawDataFromFile(const fs::path& pngFilePath)
 
 void ZTexture::ConvertBitmapToN64_RGBA16()
 {
-	for (uint16_t y = 0; y < height; y++)
+	size_t pixelSize = textureData.HasAlphaChannel() ? 4 : 3;
+	for (size_t y = 0; y < height; y++)
 	{
-		for (uint16_t x = 0; x < width; x++)
-		{
-			size_t pos = ((y * width) + x) * 2;
-			RGBAPixel pixel = textureData.GetPixel(y, x);
-
-			uint8_t r = pixel.r >> 3;
-			uint8_t g = pixel.g >> 3;
-			uint8_t b = pixel.b >> 3;
-
-			uint8_t alphaBit = pixel.a != 0;
-
-			uint16_t data = (r << 11) | (g << 6) | (b << 1) | alphaBit;
-
-			textureDataRaw[pos + 0] = (data & 0xFF00) >> 8;
-			textureDataRaw[pos + 1] = (data & 0x00FF);
-		}
+		TextureCodecs::EncodeRGBA16(textureData.GetRow(y), pixelSize,
+		                            textureDataRaw.data() + y * width * 2, width);
 	}
 }
 
 void ZTexture::ConvertBitmapToN64_RGBA32()
 {
-	for (uint16_t y = 0; y < height; y++)
+	size_t pixelSize = textureData.HasAlphaChannel() ? 4 : 3;
+	for (size_t y = 0; y < height; y++)
 	{
-		for (uint16_t x = 0; x < width; x++)
-		{
-			size_t pos = ((y * width) + x) * 4;
-			RGBAPixel pixel = textureData.GetPixel(y, x);
-
-			textureDataRaw[pos + 0] = pixel.r;
-			textureDataRaw[pos + 1] = pixel.g;
-			textureDataRaw[pos + 2] = pixel.b;
-			textureDataRaw[pos + 3] = pixel.a;
-		}
+		TextureCodecs::EncodeRGBA32(textureData.GetRow(y), pixelSize,
+		                            textureDataRaw.data() + y * width * 4, width);
 	}
 }
 
 void ZTexture::ConvertBitmapToN64_Grayscale4()
 {
-	for (uint16_t y = 0; y < height; y++)
+	size_t pixelSize = textureData.HasAlphaChannel() ? 4 : 3;
+	for (size_t y = 0; y < height; y++)
 	{
-		for (uint16_t x = 0; x < width; x += 2)
-		{
-			size_t pos = ((y * width) + x) / 2;
-			uint8_t r1 = textureData.GetPixel(y, x).r;
-			uint8_t r2 = textureData.GetPixel(y, x + 1).r;
-
-			textureDataRaw[pos] = (uint8_t)(((r1 / 16) << 4) + (r2 / 16));
-		}
+		TextureCodecs::EncodeI4(textureData.GetRow(y), pixelSize,
+		                        textureDataRaw.data() + y * width / 2, width);
 	}
 }
 
 void ZTexture::ConvertBitmapToN64_Grayscale8()
 {
-	for (uint16_t y = 0; y < height; y++)
+	size_t pixelSize = textureData.HasAlphaChannel() ? 4 : 3;
+	for (size_t y = 0; y < height; y++)
 	{
-		for (uint16_t x = 0; x < width; x++)
-		{
-			size_t pos = (y * width) + x;
-			RGBAPixel pixel = textureData.GetPixel(y, x);
-			textureDataRaw[pos] = pixel.r;
-		}
+		TextureCodecs::EncodeI8(textureData.GetRow(y), pixelSize,
+		                        textureDataRaw.data() + y * width, width);
 	}
 }
 
 void ZTexture::ConvertBitmapToN64_GrayscaleAlpha4()
 {
-	for (uint16_t y = 0; y < height; y++)
+	size_t pixelSize = textureData.HasAlphaChannel() ? 4 : 3;
+	for (size_t y = 0; y < height; y++)
 	{
-		for (uint16_t x = 0; x < width; x += 2)
-		{
-			size_t pos = ((y * width) + x) / 2;
-			uint8_t data = 0;
-
-			for (uint16_t i = 0; i < 2; i++)
-			{
-				RGBAPixel pixel = textureData.GetPixel(y, x + i);
-				uint8_t cR = pixel.r;
-				uint8_t alphaBit = pixel.a != 0;
-
-				if (i == 0)
-					data = (((cR >> 5) << 1) | alphaBit) << 4;
-				else
-					data |= ((cR >> 5) << 1) | alphaBit;
-			}
-
-			textureDataRaw[pos] = data;
-		}
+		TextureCodecs::EncodeIA4(textureData.GetRow(y), pixelSize,
+		                         textureDataRaw.data() + y * width / 2, width);
 	}
 }
 
 void ZTexture::ConvertBitmapToN64_GrayscaleAlpha8()
 {
-	for (uint16_t y = 0; y < height; y++)
+	size_t pixelSize = textureData.HasAlphaChannel() ? 4 : 3;
+	for (size_t y = 0; y < height; y++)
 	{
-		for (uint16_t x = 0; x < width; x++)
-		{
-			size_t pos = ((y * width) + x) * 1;
-			RGBAPixel pixel = textureData.GetPixel(y, x);
-
-			uint8_t r = (pixel.r >> 4) & 0xF;
-			uint8_t a = (pixel.a >> 4) & 0xF;
-
-			textureDataRaw[pos] = (r << 4) | a;
-		}
+		TextureCodecs::EncodeIA8(textureData.GetRow(y), pixelSize,
+		                         textureDataRaw.data() + y * width, width);
 	}
 }
 
 void ZTexture::ConvertBitmapToN64_GrayscaleAlpha16()
 {
-	for (uint16_t y = 0; y < height; y++)
+	size_t pixelSize = textureData.HasAlphaChannel() ? 4 : 3;
+	for (size_t y = 0; y < height; y++)
 	{
-		for (uint16_t x = 0; x < width; x++)
-		{
-			size_t pos = ((y * width) + x) * 2;
-			RGBAPixel pixel = textureData.GetPixel(y, x);
-
-			uint8_t cR = pixel.r;
-			uint8_t aR = pixel.a;
-
-			textureDataRaw[pos + 0] = cR;
-			textureDataRaw[pos + 1] = aR;
-		}
+		TextureCodecs::EncodeIA16(textureData.GetRow(y), pixelSize,
+		                          textureDataRaw.data() + y * width * 2, width);
 	}
 }
 
 void ZTexture::ConvertBitmapToN64_Palette4()
 {
-	for (uint16_t y = 0; y < height; y++)
+	for (size_t y = 0; y < height; y++)
 	{
-		for (uint16_t x = 0; x < width; x += 2)
-		{
-			size_t pos = ((y * width) + x) / 2;
-
-			uint8_t cR1 = textureData.GetIndexedPixel(y, x);
-			uint8_t cR2 = textureData.GetIndexedPixel(y, x + 1);
-
-			textureDataRaw[pos] = (cR1 << 4) | (cR2);
-		}
+		TextureCodecs::EncodeCI4(textureData.GetRow(y), textureDataRaw.data() + y * width / 2,
+		                         width);
 	}
 }
 
 void ZTexture::ConvertBitmapToN64_Palette8()
 {
-	for (uint16_t y = 0; y < height; y++)
-	{
-		for (uint16_t x = 0; x < width; x++)
-		{
-			size_t pos = ((y * width) + x);
-			uint8_t cR = textureData.GetIndexedPixel(y, x);
-
-			textureDataRaw[pos] = cR;
-		}
-	}
+	for (size_t y = 0; y < height; y++)
+		TextureCodecs::EncodeCI8(textureData.GetRow(y), textureDataRaw.data() + y * width, width);
 }
 
 float ZTexture::GetPixelMultiplyer() const
@@ -732,7 +607,7 @@ void ZTexture::Save(const fs::path& outFolder)
 	// process for generating the Texture Pool XML.
 	if (Globals::Instance->outputCrc)
 	{
-		File::WriteAllText((Globals::Instance->outputPath / (outName + ".txt")).string(),
+		File::WriteAllText((Globals::Job->outputPath / (outName + ".txt")).string(),
 		                   StringHelper::Sprintf("%08lX", hash));
 	}
 
@@ -755,7 +630,34 @@ void ZTexture::Save(const fs::path& outFolder)
 		printf("\t TLUT name: %s\n", tlut->name.c_str());
 #endif
 
-	textureData.WritePng(outFileName);
+	TextureRegistry* registry = Globals::Instance->textureRegistry;
+	uint64_t contentKey = 0;
+
+	if (registry != nullptr)
+	{
+		contentKey = GetPngContentKey();
+		if (!registry->ClaimPng(outFileName, contentKey))
+		{
+			if (File::writeLog != nullptr)
+				File::writeLog->push_back(outFileName);
+			return;
+		}
+	}
+
+	try
+	{
+		ProfileScope profileScope(ProfilePhase::WritePng, this);
+		textureData.WritePng(outFileName);
+	}
+	catch (...)
+	{
+		if (registry != nullptr)
+			registry->FinishPng(outFileName, contentKey, false);
+		throw;
+	}
+
+	if (registry != nullptr)
+		registry->FinishPng(outFileName, contentKey, true);
 
 #ifdef TEXTURE_DEBUG
 	printf("\n");
@@ -774,7 +676,7 @@ Declaration* ZTexture::DeclareVar(const std::string& prefix,
 	if (auxOutName == "")
 		auxOutName = GetDefaultName(prefix);
 
-	auto filepath = Globals::Instance->outputPath / fs::path(auxOutName).stem();
+	auto filepath = Globals::Job->outputPath / fs::path(auxOutName).stem();
 
 	if (dWordAligned)
 		incStr = StringHelper::Sprintf("%s.%s.inc.c", filepath.string().c_str(),
@@ -788,16 +690,13 @@ Declaration* ZTexture::DeclareVar(const std::string& prefix,
 		CalcHash();
 
 		// TEXTURE POOL CHECK
-		const auto& poolEntry = Globals::Instance->cfg.texturePool.find(hash);
-		if (poolEntry != Globals::Instance->cfg.texturePool.end())
+		if (poolEntry != nullptr)
 		{
 			if (dWordAligned)
-				incStr =
-					StringHelper::Sprintf("%s.%s.inc.c", poolEntry->second.path.string().c_str(),
-				                          GetExternalExtension().c_str());
+				incStr = StringHelper::Sprintf("%s.%s.inc.c", poolEntry->path.string().c_str(),
+				                               GetExternalExtension().c_str());
 			else
-				incStr = StringHelper::Sprintf("%s.u32.%s.inc.c",
-				                               poolEntry->second.path.string().c_str(),
+				incStr = StringHelper::Sprintf("%s.u32.%s.inc.c", poolEntry->path.string().c_str(),
 				                               GetExternalExtension().c_str());
 		}
 	}
@@ -825,25 +724,42 @@ std::string ZTexture::GetBodySourceCode() const
 {
 	std::string sourceOutput;
 	size_t texSizeInc = (dWordAligned) ? 8 : 4;
+	int hexDigits = (dWordAligned) ? 16 : 8;
+	size_t steps = (textureDataRaw.size() + texSizeInc - 1) / texSizeInc;
+
+	// "0x%016llX, " or "0x%08X, " per step, and per line of 32 bytes the indentation and an offset
+	// comment of at most " // 0x" with 8 digits and " \n"
+	sourceOutput.resize(steps * (2 + hexDigits + 2) + (textureDataRaw.size() / 32 + 1) * 20 + 1);
+	char* p = sourceOutput.data();
+
 	for (size_t i = 0; i < textureDataRaw.size(); i += texSizeInc)
 	{
 		if (i % 32 == 0)
-			sourceOutput += "    ";
+		{
+			memcpy(p, "    ", 4);
+			p += 4;
+		}
 		if (dWordAligned)
-			sourceOutput +=
-				StringHelper::Sprintf("0x%016llX, ", BitConverter::ToUInt64BE(textureDataRaw, i));
+			p = NumberFormat::Hex(p, BitConverter::ToUInt64BE(textureDataRaw, i), 16);
 		else
-			sourceOutput +=
-				StringHelper::Sprintf("0x%08llX, ", BitConverter::ToUInt32BE(textureDataRaw, i));
+			p = NumberFormat::Hex(p, BitConverter::ToUInt32BE(textureDataRaw, i), 8);
+		*p++ = ',';
+		*p++ = ' ';
 		if (i % 32 == 24)
-			sourceOutput += StringHelper::Sprintf(" // 0x%06X \n", rawDataIndex + ((i / 32) * 32));
+		{
+			memcpy(p, " // ", 4);
+			p = NumberFormat::Hex(p + 4, static_cast<uint32_t>(rawDataIndex + ((i / 32) * 32)), 6);
+			*p++ = ' ';
+			*p++ = '\n';
+		}
 	}
 
 	// Ensure there's always a trailing line feed to prevent dumb warnings.
 	// Please don't remove this line, unless you somehow made a way to prevent
 	// that warning when building the OoT repo.
-	sourceOutput += "\n";
+	*p++ = '\n';
 
+	sourceOutput.resize(p - sourceOutput.data());
 	return sourceOutput;
 }
 
@@ -875,8 +791,38 @@ std::string ZTexture::GetSourceTypeName() const
 
 void ZTexture::CalcHash()
 {
+	size_t size = GetRawDataSize();
+	if (hashCalculated && hashedDataIndex == rawDataIndex && hashedSize == size)
+		return;
+
 	const auto& parentRawData = parent->GetRawData();
-	hash = CRC32B(parentRawData.data() + rawDataIndex, GetRawDataSize());
+	hash = CRC32B(parentRawData.data() + rawDataIndex, size);
+	hashCalculated = true;
+	hashedDataIndex = rawDataIndex;
+	hashedSize = size;
+
+	const auto& texturePool = Globals::Instance->cfg.texturePool;
+	const auto poolIt = texturePool.find(hash);
+	poolEntry = poolIt != texturePool.end() ? &poolIt->second : nullptr;
+}
+
+uint64_t ZTexture::GetPngContentKey()
+{
+	CalcHash();
+
+	// The PNG is made of the data of this texture, read with its format and size, and the colors
+	// of its TLUT. CI textures without a TLUT get a palette that only depends on their data
+	uint64_t key = hash;
+	key = key * 0x100000001B3 ^ static_cast<uint64_t>(format);
+	key = key * 0x100000001B3 ^ (static_cast<uint64_t>(width) << 32 | height);
+	if (tlut != nullptr)
+	{
+		key = key * 0x100000001B3 ^ tlut->hash;
+		key = key * 0x100000001B3 ^ (static_cast<uint64_t>(tlut->width) << 32 | tlut->height);
+		key = key * 0x100000001B3 ^ splitTlut;
+	}
+
+	return key;
 }
 
 std::string ZTexture::GetExternalExtension() const
@@ -908,8 +854,8 @@ std::string ZTexture::GetExternalExtension() const
 
 fs::path ZTexture::GetPoolOutPath(const fs::path& defaultValue)
 {
-	if (Globals::Instance->cfg.texturePool.find(hash) != Globals::Instance->cfg.texturePool.end())
-		return Path::GetDirectoryName(Globals::Instance->cfg.texturePool[hash].path.string());
+	if (poolEntry != nullptr)
+		return Path::GetDirectoryName(poolEntry->path.string());
 
 	return defaultValue;
 }
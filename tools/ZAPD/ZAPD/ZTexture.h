@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "ImageBackend.h"
 #include "ZResource.h"
 #include "tinyxml2.h"
@@ -18,6 +20,8 @@ enum class TextureType
 	GrayscaleAlpha16bpp,
 };
 
+struct TexturePoolEntry;
+
 class ZTexture : public ZResource
 {
 protected:
@@ -28,8 +32,21 @@ protected:
 	std::vector<uint8_t> textureDataRaw;  // When reading from a PNG file.
 	uint32_t tlutOffset = static_cast<uint32_t>(-1);
 	ZTexture* tlut = nullptr;
+	std::unique_ptr<ZTexture> externalTlut;  // Owned copy of an ExternalTlut that isn't RGBA16
 	bool splitTlut;
 
+	// Data that `hash` was calculated from, it is only calculated again if the texture changes
+	bool hashCalculated = false;
+	offset_t hashedDataIndex = 0;
+	size_t hashedSize = 0;
+	const TexturePoolEntry* poolEntry = nullptr;  // Entry of `hash` in the texture pool, if any
+
+	// Returns the N64 data of this texture inside of the parent file
+	const uint8_t* GetN64Data() const;
+	// Identifies the content of the PNG of this texture, so identical PNGs are only written once
+	uint64_t GetPngContentKey();
+	void SetGrayscalePalette(uint8_t step);
+
 	// The following functions convert from N64 binary data to a bitmap to be saved to a PNG.
 	void ConvertN64ToBitmap_RGBA16();
 	void ConvertN64ToBitmap_RGBA32();
@@ -72,7 +89,8 @@ public:
 	std::string GetBodySourceCode() const override;
 
 	/// <summary>
-	/// Calculates the hash of this texture, for use with the texture pool.
+	/// Calculates the hash of this texture and looks it up in the texture pool. Does nothing if it
+	/// was already calculated for the current offset and size.
 	/// </summary>
 	void CalcHash() override;
 
@@ -77,11 +77,13 @@
 #include "ZTextureAnimation.h"
 
 #include <cassert>
+#include <initializer_list>
 #include <memory>
 #include <vector>
 
 #include "Globals.h"
 #include "Utils/BitConverter.h"
+#include "Utils/NumberFormat.h"
 #include "WarningHandler.h"
 #include "ZFile.h"
 #include "ZResource.h"
@@ -106,6 +108,44 @@ TextureCyclingParams::TextureCyclingParams(ZFile* parent)
 {
 }
 
+/* Helpers */
+
+/**
+ * The `size` bytes of a params list at `address`, viewed in the file's data rather than copied.
+ * Empty if the pointer is NULL.
+ */
+static DataView GetParamsList(ZFile* parent, ZResource* params, segptr_t address, size_t size)
+{
+	if (address == 0)  // NULL
+		return DataView();
+
+	const auto& rawData = parent->GetRawData();
+	uint32_t offset = Seg2Filespace(address, parent->baseAddress);
+
+	if (offset > rawData.size() || size > rawData.size() - offset)
+	{
+		HANDLE_ERROR_RESOURCE(
+			WarningType::Always, parent, params, params->GetRawDataIndex(),
+			StringHelper::Sprintf("params list at address 0x%08X goes past the end of the file",
+		                          address),
+			StringHelper::Sprintf("The list is 0x%zX bytes long.", size));
+	}
+
+	return rawData.Slice(offset, offset + size);
+}
+
+// Appends a row of the form "\t{ 1, 2, 3 },\n"
+static void AppendDecRow(std::string& bodyStr, std::initializer_list<int> values)
+{
+	bodyStr += "\t{ ";
+	for (int value : values)
+	{
+		NumberFormat::AppendDec(bodyStr, value);
+		bodyStr += ", ";
+	}
+	bodyStr.replace(bodyStr.size() - 2, 2, " },\n");
+}
+
 /* TextureAnimationParams */
 /* This class only implements the functions common to all or most its inheritors */
 
@@ -192,8 +232,15 @@ std::string TextureScrollingParams::GetBodySourceCode() const
 
 	for (int i = 0; i < count; i++)
 	{
-		bodyStr += StringHelper::Sprintf("\t{ %d, %d, 0x%02X, 0x%02X },\n", rows[i].xStep,
-		                                 rows[i].yStep, rows[i].width, rows[i].height);
+		bodyStr += "\t{ ";
+		NumberFormat::AppendDec(bodyStr, rows[i].xStep);
+		bodyStr += ", ";
+		NumberFormat::AppendDec(bodyStr, rows[i].yStep);
+		bodyStr += ", ";
+		NumberFormat::AppendHex(bodyStr, rows[i].width, 2);
+		bodyStr += ", ";
+		NumberFormat::AppendHex(bodyStr, rows[i].height, 2);
+		bodyStr += " },\n";
 	}
 
 	bodyStr.pop_back();
@@ -214,8 +261,7 @@ void TextureColorChangingParams::ParseRawData()
 	colorListCount = BitConverter::ToUInt16BE(rawData, rawDataIndex + 2);
 
 	// Handle type 2 separately
-	uint16_t listLength =
-		((type == TextureAnimationParamsType::ColorChange) ? animLength : colorListCount);
+	listLength = ((type == TextureAnimationParamsType::ColorChange) ? animLength : colorListCount);
 
 	if (listLength == 0)
 		HANDLE_ERROR_RESOURCE(WarningType::Always, parent, this, rawDataIndex,
@@ -225,45 +271,26 @@ void TextureColorChangingParams::ParseRawData()
 	envColorListAddress = BitConverter::ToUInt32BE(rawData, rawDataIndex + 8);
 	frameDataListAddress = BitConverter::ToUInt32BE(rawData, rawDataIndex + 0xC);
 
-	uint32_t primColorListOffset = Seg2Filespace(primColorListAddress, parent->baseAddress);
-	uint32_t envColorListOffset = Seg2Filespace(envColorListAddress, parent->baseAddress);
-	uint32_t frameDataListOffset = Seg2Filespace(frameDataListAddress, parent->baseAddress);
-
-	uint32_t currentPtr;
-
-	F3DPrimColor currentPrimColor;
-
-	for (currentPtr = primColorListOffset; currentPtr < primColorListOffset + 5 * listLength;
-	     currentPtr += 5)
-	{
-		currentPrimColor = {BitConverter::ToUInt8BE(rawData, currentPtr),
-		                    BitConverter::ToUInt8BE(rawData, currentPtr + 1),
-		                    BitConverter::ToUInt8BE(rawData, currentPtr + 2),
-		                    BitConverter::ToUInt8BE(rawData, currentPtr + 3),
-		                    BitConverter::ToUInt8BE(rawData, currentPtr + 4)};
-		primColorList.push_back(currentPrimColor);
-	}
-
-	F3DEnvColor currentEnvColor;
+	primColorData = GetParamsList(parent, this, primColorListAddress, 5 * listLength);
+	envColorData = GetParamsList(parent, this, envColorListAddress, 4 * listLength);
+	frameData = GetParamsList(parent, this, frameDataListAddress, 2 * listLength);
+}
 
-	for (currentPtr = envColorListOffset; currentPtr < envColorListOffset + 4 * listLength;
-	     currentPtr += 4)
-	{
-		currentEnvColor = {BitConverter::ToUInt8BE(rawData, currentPtr),
-		                   BitConverter::ToUInt8BE(rawData, currentPtr + 1),
-		                   BitConverter::ToUInt8BE(rawData, currentPtr + 2),
-		                   BitConverter::ToUInt8BE(rawData, currentPtr + 3)};
-		envColorList.push_back(currentEnvColor);
-	}
+F3DPrimColor TextureColorChangingParams::GetPrimColor(size_t index) const
+{
+	const uint8_t* color = &primColorData.at(5 * index);
+	return {color[0], color[1], color[2], color[3], color[4]};
+}
 
-	uint16_t currentFrameData;
+F3DEnvColor TextureColorChangingParams::GetEnvColor(size_t index) const
+{
+	const uint8_t* color = &envColorData.at(4 * index);
+	return {color[0], color[1], color[2], color[3]};
+}
 
-	for (currentPtr = frameDataListOffset; currentPtr < frameDataListOffset + 2 * listLength;
-	     currentPtr += 2)
-	{
-		currentFrameData = BitConverter::ToUInt16BE(rawData, currentPtr);
-		frameDataList.push_back(currentFrameData);
-	}
+uint16_t TextureColorChangingParams::GetFrameData(size_t index) const
+{
+	return BitConverter::ToUInt16BE(frameData, 2 * index);
 }
 
 std::string TextureColorChangingParams::GetSourceTypeName() const
@@ -287,59 +314,60 @@ void TextureColorChangingParams::DeclareReferences([[maybe_unused]] const std::s
 	{
 		std::string primColorBodyStr;
 
-		for (const auto& color : primColorList)
+		for (size_t i = 0; i < listLength; i++)
 		{
-			primColorBodyStr += StringHelper::Sprintf("\t{ %d, %d, %d, %d, %d },\n", color.r,
-			                                          color.g, color.b, color.a, color.lodFrac);
+			F3DPrimColor color = GetPrimColor(i);
+			AppendDecRow(primColorBodyStr, {color.r, color.g, color.b, color.a, color.lodFrac});
 		}
 
 		primColorBodyStr.pop_back();
 
 		parent->AddDeclarationArray(
 			Seg2Filespace(primColorListAddress, parent->baseAddress), DeclarationAlignment::Align4,
-			primColorList.size() * 5, "F3DPrimColor",
+			primColorData.size(), "F3DPrimColor",
 			StringHelper::Sprintf("%sTexColorChangingPrimColors_%06X", parent->GetName().c_str(),
 		                          Seg2Filespace(primColorListAddress, parent->baseAddress)),
-			primColorList.size(), primColorBodyStr);
+			listLength, primColorBodyStr);
 	}
 
 	if (envColorListAddress != 0)  // NULL
 	{
 		std::string envColorBodyStr;
 
-		for (const auto& color : envColorList)
+		for (size_t i = 0; i < listLength; i++)
 		{
-			envColorBodyStr += StringHelper::Sprintf("\t{ %d, %d, %d, %d },\n", color.r, color.g,
-			                                         color.b, color.a);
+			F3DEnvColor color = GetEnvColor(i);
+			AppendDecRow(envColorBodyStr, {color.r, color.g, color.b, color.a});
 		}
 
 		envColorBodyStr.pop_back();
 
 		parent->AddDeclarationArray(
 			Seg2Filespace(envColorListAddress, parent->baseAddress), DeclarationAlignment::Align4,
-			envColorList.size() * 4, "F3DEnvColor",
+			envColorData.size(), "F3DEnvColor",
 			StringHelper::Sprintf("%sTexColorChangingEnvColors_%06X", parent->GetName().c_str(),
 		                          Seg2Filespace(envColorListAddress, parent->baseAddress)),
-			envColorList.size(), envColorBodyStr);
+			listLength, envColorBodyStr);
 	}
 
 	if (frameDataListAddress != 0)  // NULL
 	{
 		std::string frameDataBodyStr = "\t";
 
-		for (const auto& frame : frameDataList)
+		for (size_t i = 0; i < listLength; i++)
 		{
-			frameDataBodyStr += StringHelper::Sprintf("%d, ", frame);
+			NumberFormat::AppendUDec(frameDataBodyStr, GetFrameData(i));
+			frameDataBodyStr += ", ";
 		}
 
 		frameDataBodyStr.pop_back();
 
 		parent->AddDeclarationArray(
 			Seg2Filespace(frameDataListAddress, parent->baseAddress), DeclarationAlignment::Align4,
-			frameDataList.size() * 2, "u16",
+			frameData.size(), "u16",
 			StringHelper::Sprintf("%sTexColorChangingFrameData_%06X", parent->GetName().c_str(),
 		                          Seg2Filespace(frameDataListAddress, parent->baseAddress)),
-			frameDataList.size(), frameDataBodyStr);
+			listLength, frameDataBodyStr);
 	}
 }
 
@@ -349,9 +377,9 @@ std::string TextureColorChangingParams::GetBodySourceCode() const
 	std::string envColorListName;
 	std::string frameDataListName;
 
-	Globals::Instance->GetSegmentedPtrName(primColorListAddress, parent, "", primColorListName);
-	Globals::Instance->GetSegmentedPtrName(envColorListAddress, parent, "", envColorListName);
-	Globals::Instance->GetSegmentedPtrName(frameDataListAddress, parent, "", frameDataListName);
+	Globals::Job->GetSegmentedPtrName(primColorListAddress, parent, "", primColorListName);
+	Globals::Job->GetSegmentedPtrName(envColorListAddress, parent, "", envColorListName);
+	Globals::Job->GetSegmentedPtrName(frameDataListAddress, parent, "", frameDataListName);
 
 	std::string bodyStr = StringHelper::Sprintf(
 		"\n    %d, %d, %s, %s, %s,\n", animLength, colorListCount, primColorListName.c_str(),
@@ -374,28 +402,23 @@ void TextureCyclingParams::ParseRawData()
 	textureListAddress = BitConverter::ToUInt32BE(rawData, rawDataIndex + 4);
 	textureIndexListAddress = BitConverter::ToUInt32BE(rawData, rawDataIndex + 8);
 
-	uint32_t textureListOffset = Seg2Filespace(textureListAddress, parent->baseAddress);
-	uint32_t textureIndexListOffset = Seg2Filespace(textureIndexListAddress, parent->baseAddress);
-
-	uint32_t currentPtr;
-
-	uint8_t currentIndex;
-	uint8_t maxIndex = 0;  // To find the length of the texture list
+	textureIndexData = GetParamsList(parent, this, textureIndexListAddress, cycleLength);
 
-	for (currentPtr = textureIndexListOffset; currentPtr < textureIndexListOffset + cycleLength;
-	     currentPtr++)
+	// The highest index gives the length of the texture list
+	uint8_t maxIndex = 0;
+	for (uint8_t index : textureIndexData)
 	{
-		currentIndex = BitConverter::ToUInt8BE(rawData, currentPtr);
-		textureIndexList.push_back(currentIndex);
-		if (currentIndex > maxIndex)
-			maxIndex = currentIndex;
+		if (index > maxIndex)
+			maxIndex = index;
 	}
 
-	for (currentPtr = textureListOffset; currentPtr <= textureListOffset + 4 * maxIndex;
-	     currentPtr += 4)
-	{
-		textureList.push_back(BitConverter::ToUInt32BE(rawData, currentPtr));
-	}
+	textureCount = maxIndex + 1;
+	textureData = GetParamsList(parent, this, textureListAddress, 4 * textureCount);
+}
+
+segptr_t TextureCyclingParams::GetTexture(size_t index) const
+{
+	return BitConverter::ToUInt32BE(textureData, 4 * index);
 }
 
 std::string TextureCyclingParams::GetSourceTypeName() const
@@ -421,9 +444,10 @@ void TextureCyclingParams::DeclareReferences([[maybe_unused]] const std::string&
 		std::string texName;
 		std::string comment;
 
-		for (const auto& tex : textureList)
+		for (size_t i = 0; i < textureCount; i++)
 		{
-			bool texFound = Globals::Instance->GetSegmentedPtrName(tex, parent, "", texName);
+			segptr_t tex = GetTexture(i);
+			bool texFound = Globals::Job->GetSegmentedPtrName(tex, parent, "", texName);
 
 			// texName is a raw segmented pointer. This occurs if the texture is not declared
 			// separately since we cannot read the format. In theory we could scan DLists for the
@@ -446,29 +470,30 @@ void TextureCyclingParams::DeclareReferences([[maybe_unused]] const std::string&
 
 		parent->AddDeclarationArray(
 			Seg2Filespace(textureListAddress, parent->baseAddress), DeclarationAlignment::Align4,
-			textureList.size() * 4, "TexturePtr",
+			textureData.size(), "TexturePtr",
 			StringHelper::Sprintf("%sTexCycleTexPtrs_%06X", parent->GetName().c_str(),
 		                          Seg2Filespace(textureListAddress, parent->baseAddress)),
-			textureList.size(), texturesBodyStr);
+			textureCount, texturesBodyStr);
 	}
 
 	if (textureIndexListAddress != 0)  // NULL
 	{
 		std::string indicesBodyStr = "\t";
 
-		for (uint8_t index : textureIndexList)
+		for (uint8_t index : textureIndexData)
 		{
-			indicesBodyStr += StringHelper::Sprintf("%d, ", index);
+			NumberFormat::AppendUDec(indicesBodyStr, index);
+			indicesBodyStr += ", ";
 		}
 
 		indicesBodyStr.pop_back();
 
 		parent->AddDeclarationArray(
 			Seg2Filespace(textureIndexListAddress, parent->baseAddress),
-			DeclarationAlignment::Align4, textureIndexList.size(), "u8",
+			DeclarationAlignment::Align4, textureIndexData.size(), "u8",
 			StringHelper::Sprintf("%sTexCycleTexIndices_%06X", parent->GetName().c_str(),
 		                          Seg2Filespace(textureIndexListAddress, parent->baseAddress)),
-			textureIndexList.size(), indicesBodyStr);
+			textureIndexData.size(), indicesBodyStr);
 	}
 }
 
@@ -477,9 +502,9 @@ std::string TextureCyclingParams::GetBodySourceCode() const
 	std::string textureListName;
 	std::string textureIndexListName;
 
-	Globals::Instance->GetSegmentedPtrName(textureListAddress, parent, "", textureListName);
-	Globals::Instance->GetSegmentedPtrName(textureIndexListAddress, parent, "",
-	                                       textureIndexListName);
+	Globals::Job->GetSegmentedPtrName(textureListAddress, parent, "", textureListName);
+	Globals::Job->GetSegmentedPtrName(textureIndexListAddress, parent, "",
+	                                  textureIndexListName);
 
 	std::string bodyStr = StringHelper::Sprintf(
 		"\n    %d, %s, %s,\n", cycleLength, textureListName.c_str(), textureIndexListName.c_str());
@@ -654,7 +679,7 @@ std::string ZTextureAnimation::GetBodySourceCode() const
 	for (const auto& entry : entries)
 	{
 		std::string paramName;
-		Globals::Instance->GetSegmentedPtrName(entry.paramsPtr, parent, "", paramName);
+		Globals::Job->GetSegmentedPtrName(entry.paramsPtr, parent, "", paramName);
 
 		bodyStr += StringHelper::Sprintf("\t{ %d, %d, %s },\n", entry.segment, entry.type,
 		                                 paramName.c_str());
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include "Utils/DataView.h"
 #include "ZResource.h"
 
 enum class TextureAnimationParamsType
@@ -91,14 +92,21 @@ public:
 
 	std::string GetBodySourceCode() const override;
 
+	F3DPrimColor GetPrimColor(size_t index) const;
+	F3DEnvColor GetEnvColor(size_t index) const;
+	uint16_t GetFrameData(size_t index) const;
+
 	uint16_t animLength;  // size of list for type 2
 	uint16_t colorListCount;
 	segptr_t primColorListAddress;
 	segptr_t envColorListAddress;
 	segptr_t frameDataListAddress;
-	std::vector<F3DPrimColor> primColorList;
-	std::vector<F3DEnvColor> envColorList;
-	std::vector<uint16_t> frameDataList;
+	uint16_t listLength = 0;
+
+	// The lists, viewed in the file's data. Empty for a NULL pointer
+	DataView primColorData;  // 5 bytes per color
+	DataView envColorData;   // 4 bytes per color
+	DataView frameData;      // u16
 };
 
 class TextureCyclingParams : public ZTextureAnimationParams
@@ -116,11 +124,16 @@ public:
 
 	std::string GetBodySourceCode() const override;
 
+	segptr_t GetTexture(size_t index) const;
+
 	uint16_t cycleLength;
 	segptr_t textureListAddress;
 	segptr_t textureIndexListAddress;
-	std::vector<segptr_t> textureList;
-	std::vector<uint8_t> textureIndexList;
+	size_t textureCount = 0;  // the highest index, plus one
+
+	// The lists, viewed in the file's data. Empty for a NULL pointer
+	DataView textureData;       // segmented pointers
+	DataView textureIndexData;  // u8, `cycleLength` of them
 };
 
 struct TextureAnimationEntry
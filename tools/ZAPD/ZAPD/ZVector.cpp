@@ -96,18 +96,35 @@ std::string ZVector::GetSourceTypeName() const
 	}
 }
 
-std::string ZVector::GetBodySourceCode() const
+void ZVector::AppendBodySourceCode(std::string& output, ZScalarType scalarType,
+                                   const ZScalarData* data, uint32_t dimensions)
 {
-	std::string body = "";
-
-	for (size_t i = 0; i < scalars.size(); i++)
+	for (uint32_t i = 0; i < dimensions; i++)
 	{
-		body += StringHelper::Sprintf("%6s", scalars[i].GetBodySourceCode().c_str());
+		size_t start = output.size();
+
+		ZScalar::AppendBodySourceCode(output, scalarType, data[i]);
+
+		// Right-aligned in 6 columns
+		size_t len = output.size() - start;
+		if (len < 6)
+			output.insert(start, 6 - len, ' ');
 
-		if (i + 1 < scalars.size())
-			body += ", ";
+		if (i + 1 < dimensions)
+			output += ", ";
 	}
+}
+
+std::string ZVector::GetBodySourceCode() const
+{
+	std::vector<ZScalarData> data;
+	std::string body;
+
+	data.reserve(scalars.size());
+	for (const auto& scalar : scalars)
+		data.push_back(scalar.scalarData);
 
+	AppendBodySourceCode(body, scalarType, data.data(), data.size());
 	return body;
 }
 
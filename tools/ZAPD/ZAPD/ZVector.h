@@ -22,6 +22,10 @@ public:
 	void ParseRawData() override;
 
 	std::string GetBodySourceCode() const override;
+	// Formats the `dimensions` scalars at `data` the way GetBodySourceCode does, at the end of
+	// `output`
+	static void AppendBodySourceCode(std::string& output, ZScalarType scalarType,
+	                                 const ZScalarData* data, uint32_t dimensions);
 
 	bool DoesSupportArray() const override;
 	std::string GetSourceTypeName() const override;
@@ -7,14 +7,24 @@
 #include "ZScalar.h"
 #include "tinyxml2.h"
 
-class ZVtx : public ZResource
+/**
+ * The fields of a Vtx, for resources holding many vertices without a whole ZVtx for each.
+ */
+struct VtxData
 {
-public:
-	int16_t x, y, z;
-	uint16_t flag;
-	int16_t s, t;
-	uint8_t r, g, b, a;
+	int16_t x = 0, y = 0, z = 0;
+	uint16_t flag = 0;
+	int16_t s = 0, t = 0;
+	uint8_t r = 0, g = 0, b = 0, a = 0;
+
+	void ParseRawData(const DataView& rawData, offset_t offset);
+	// Formats the vertex the way GetBodySourceCode does, at the end of `output`
+	void AppendBodySourceCode(std::string& output) const;
+};
 
+class ZVtx : public ZResource, public VtxData
+{
+public:
 	ZVtx(ZFile* nParent);
 
 	void ParseRawData() override;
@@ -24,7 +24,7 @@ void ZWaterbox::ParseRawData()
 	xLength = BitConverter::ToInt16BE(rawData, rawDataIndex + 6);
 	zLength = BitConverter::ToInt16BE(rawData, rawDataIndex + 8);
 
-	if (Globals::Instance->game == ZGame::OOT_SW97)
+	if (Globals::Job->game == ZGame::OOT_SW97)
 		properties = BitConverter::ToInt16BE(rawData, rawDataIndex + 10);
 	else
 		properties = BitConverter::ToInt32BE(rawData, rawDataIndex + 12);
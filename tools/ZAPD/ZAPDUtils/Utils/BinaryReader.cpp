@@ -1,5 +1,6 @@
 #include "BinaryReader.h"
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 #include "Stream.h"
 
@@ -23,9 +24,63 @@ uint32_t BinaryReader::GetBaseAddress()
 	return stream->GetBaseAddress();
 }
 
-void BinaryReader::Read([[maybe_unused]] char* buffer, int32_t length)
+void BinaryReader::SetEndianess(Endianess nEndianess)
 {
-	stream->Read(length);
+	endianess = nEndianess;
+}
+
+// Unsigned integer with the same size as a scalar, used to assemble it byte by byte
+template <size_t Size>
+struct UnsignedOfSize;
+template <>
+struct UnsignedOfSize<1>
+{
+	using Type = uint8_t;
+};
+template <>
+struct UnsignedOfSize<2>
+{
+	using Type = uint16_t;
+};
+template <>
+struct UnsignedOfSize<4>
+{
+	using Type = uint32_t;
+};
+template <>
+struct UnsignedOfSize<8>
+{
+	using Type = uint64_t;
+};
+
+template <typename T>
+T BinaryReader::ReadScalar()
+{
+	using UnsignedT = typename UnsignedOfSize<sizeof(T)>::Type;
+
+	DataView bytes = stream->ReadView(sizeof(T));
+	UnsignedT value = 0;
+
+	// Compilers turn these loops into a single (byte swapped) load
+	if (endianess == Endianess::Big)
+	{
+		for (size_t i = 0; i < sizeof(T); i++)
+			value = (value << 8) | bytes[i];
+	}
+	else
+	{
+		for (size_t i = 0; i < sizeof(T); i++)
+			value |= static_cast<UnsignedT>(bytes[i]) << (i * 8);
+	}
+
+	T result;
+	std::memcpy(&result, &value, sizeof(T));
+	return result;
+}
+
+void BinaryReader::Read(char* buffer, int32_t length)
+{
+	stream->Read(buffer, length);
 }
 
 char BinaryReader::ReadChar()
@@ -45,49 +100,32 @@ uint8_t BinaryReader::ReadUByte()
 
 int16_t BinaryReader::ReadInt16()
 {
-	int16_t result = 0;
-
-	stream->Read((char*)&result, sizeof(int16_t));
-	return result;
+	return ReadScalar<int16_t>();
 }
 
 int32_t BinaryReader::ReadInt32()
 {
-	int32_t result = 0;
-
-	stream->Read((char*)&result, sizeof(int32_t));
-	return result;
+	return ReadScalar<int32_t>();
 }
 
 uint16_t BinaryReader::ReadUInt16()
 {
-	uint16_t result = 0;
-
-	stream->Read((char*)&result, sizeof(uint16_t));
-	return result;
+	return ReadScalar<uint16_t>();
 }
 
 uint32_t BinaryReader::ReadUInt32()
 {
-	uint32_t result = 0;
-
-	stream->Read((char*)&result, sizeof(uint32_t));
-	return result;
+	return ReadScalar<uint32_t>();
 }
 
 uint64_t BinaryReader::ReadUInt64()
 {
-	uint64_t result = 0;
-
-	stream->Read((char*)&result, sizeof(uint64_t));
-	return result;
+	return ReadScalar<uint64_t>();
 }
 
 float BinaryReader::ReadSingle()
 {
-	float result = NAN;
-
-	stream->Read((char*)&result, sizeof(float));
+	float result = ReadScalar<float>();
 
 	if (std::isnan(result))
 		throw std::runtime_error("BinaryReader::ReadSingle(): Error reading stream");
@@ -97,9 +135,8 @@ float BinaryReader::ReadSingle()
 
 double BinaryReader::ReadDouble()
 {
-	double result = NAN;
+	double result = ReadScalar<double>();
 
-	stream->Read((char*)&result, sizeof(double));
 	if (std::isnan(result))
 		throw std::runtime_error("BinaryReader::ReadDouble(): Error reading stream");
 
@@ -108,27 +145,46 @@ double BinaryReader::ReadDouble()
 
 Vec3f BinaryReader::ReadVec3f()
 {
-	return Vec3f();
+	float x = ReadSingle();
+	float y = ReadSingle();
+	float z = ReadSingle();
+
+	return Vec3f(x, y, z);
 }
 
 Vec3s BinaryReader::ReadVec3s()
 {
-	return Vec3s(0, 0, 0);
+	int16_t x = ReadInt16();
+	int16_t y = ReadInt16();
+	int16_t z = ReadInt16();
+
+	return Vec3s(x, y, z);
 }
 
 Vec3s BinaryReader::ReadVec3b()
 {
-	return Vec3s(0, 0, 0);
+	int8_t x = ReadByte();
+	int8_t y = ReadByte();
+	int8_t z = ReadByte();
+
+	return Vec3s(x, y, z);
 }
 
 Vec2f BinaryReader::ReadVec2f()
 {
-	return Vec2f();
+	float x = ReadSingle();
+	float y = ReadSingle();
+
+	return Vec2f(x, y);
 }
 
 Color3b BinaryReader::ReadColor3b()
 {
-	return Color3b();
+	uint8_t r = ReadUByte();
+	uint8_t g = ReadUByte();
+	uint8_t b = ReadUByte();
+
+	return Color3b(r, g, b);
 }
 
 std::string BinaryReader::ReadString()
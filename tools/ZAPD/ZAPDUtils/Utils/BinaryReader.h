@@ -17,6 +17,9 @@ public:
 
 	void Close();
 
+	// Byte order of the multi-byte values read from now on. Defaults to little endian
+	void SetEndianess(Endianess nEndianess);
+
 	void Seek(uint32_t offset, SeekOffsetType seekType);
 	uint32_t GetBaseAddress();
 
@@ -40,4 +43,8 @@ public:
 
 protected:
 	std::shared_ptr<Stream> stream;
+	Endianess endianess = Endianess::Little;
+
+	template <typename T>
+	T ReadScalar();
 };
\ No newline at end of file
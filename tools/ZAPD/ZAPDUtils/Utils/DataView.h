@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Read-only, non-owning view of a contiguous byte buffer, in the spirit of
+ * `std::span<const uint8_t>`. Whoever created the viewed buffer must keep it alive.
+ * A `std::vector<uint8_t>` converts implicitly, so functions taking a `const DataView&` accept
+ * both plain vectors and memory-mapped files without copying.
+ */
+class DataView
+{
+public:
+	typedef const uint8_t* const_iterator;
+
+	DataView() = default;
+	DataView(const uint8_t* nData, size_t nSize) : viewData(nData), viewSize(nSize) {}
+	DataView(const std::vector<uint8_t>& vector) : viewData(vector.data()), viewSize(vector.size())
+	{
+	}
+
+	const uint8_t* data() const { return viewData; }
+	size_t size() const { return viewSize; }
+	bool empty() const { return viewSize == 0; }
+
+	const_iterator begin() const { return viewData; }
+	const_iterator end() const { return viewData + viewSize; }
+
+	const uint8_t& operator[](size_t index) const { return viewData[index]; }
+
+	const uint8_t& at(size_t index) const
+	{
+		if (!(index < viewSize))
+			throw std::out_of_range("DataView::at: index out of range");
+
+		return viewData[index];
+	}
+
+	// Returns the bytes in [start, end), clamped to the size of this view
+	DataView Slice(size_t start, size_t end) const
+	{
+		if (end > viewSize)
+			end = viewSize;
+		if (start > end)
+			start = end;
+
+		return DataView(viewData + start, end - start);
+	}
+
+protected:
+	const uint8_t* viewData = nullptr;
+	size_t viewSize = 0;
+};
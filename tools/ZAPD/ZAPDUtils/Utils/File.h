@@ -6,6 +6,9 @@
 #include <fstream>
 #endif
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
 #include <string>
 #include <vector>
 #include "Directory.h"
@@ -21,7 +24,35 @@ class File
 	typedef std::ofstream ofstream;
 #endif
 
+	// Writes to a temporary file, which replaces the real one when destroyed if their contents
+	// differ
+	class ReplacingStream : public ofstream
+	{
+	public:
+		ReplacingStream(const fs::path& nFilePath)
+			: ofstream(fs::path(nFilePath).concat(".tmp"), std::ios::out), filePath(nFilePath)
+		{
+		}
+
+		~ReplacingStream()
+		{
+			fs::path tempPath = fs::path(filePath).concat(".tmp");
+			close();
+
+			if (HaveSameContent(tempPath, filePath))
+				fs::remove(tempPath);
+			else
+				fs::rename(tempPath, filePath);
+		}
+
+	protected:
+		fs::path filePath;
+	};
+
 public:
+	// When set, the path of every file written through this class is appended to it
+	static inline thread_local std::vector<fs::path>* writeLog = nullptr;
+
 	static bool Exists(const fs::path& filePath)
 	{
 		ifstream file(filePath, std::ios::in | std::ios::binary | std::ios::ate);
@@ -69,6 +100,9 @@ public:
 
 	static void WriteAllBytes(const fs::path& filePath, const std::vector<uint8_t>& data)
 	{
+		if (writeLog != nullptr)
+			writeLog->push_back(filePath);
+
 		ofstream file(filePath, std::ios::binary);
 		file.write((char*)data.data(), data.size());
 		file.close();
@@ -76,6 +110,9 @@ public:
 
 	static void WriteAllBytes(const std::string& filePath, const std::vector<char>& data)
 	{
+		if (writeLog != nullptr)
+			writeLog->push_back(filePath);
+
 		ofstream file(filePath, std::ios::binary);
 		file.write((char*)data.data(), data.size());
 		file.close();
@@ -83,15 +120,128 @@ public:
 
 	static void WriteAllBytes(const std::string& filePath, const char* data, int dataSize)
 	{
+		if (writeLog != nullptr)
+			writeLog->push_back(filePath);
+
 		ofstream file(filePath, std::ios::binary);
 		file.write((char*)data, dataSize);
 		file.close();
 	};
 
+	// Like WriteAllBytes, but leaves the file (and its timestamp) alone if it already holds `data`.
+	// Returns whether the file was written
+	static bool WriteAllBytesIfChanged(const fs::path& filePath, const char* data, size_t dataSize)
+	{
+		if (HasContent(filePath, data, dataSize))
+		{
+			if (writeLog != nullptr)
+				writeLog->push_back(filePath);
+			return false;
+		}
+
+		WriteAllBytes(filePath.string(), data, dataSize);
+		return true;
+	}
+
+	static bool WriteAllBytesIfChanged(const fs::path& filePath, const std::vector<uint8_t>& data)
+	{
+		return WriteAllBytesIfChanged(filePath, reinterpret_cast<const char*>(data.data()),
+		                              data.size());
+	}
+
+	static bool WriteAllBytesIfChanged(const fs::path& filePath, const std::vector<char>& data)
+	{
+		return WriteAllBytesIfChanged(filePath, data.data(), data.size());
+	}
+
+	// Creates a file to be written in pieces, logged like the other Write functions
+	static std::unique_ptr<std::ostream> OpenForWriting(const fs::path& filePath)
+	{
+		if (writeLog != nullptr)
+			writeLog->push_back(filePath);
+
+		return std::make_unique<ofstream>(filePath, std::ios::out);
+	}
+
+	// Like OpenForWriting, but leaves the file (and its timestamp) alone if it ends up with the same
+	// content. What is written goes to a temporary file until the stream is destroyed
+	static std::unique_ptr<std::ostream> OpenForWritingIfChanged(const fs::path& filePath)
+	{
+		if (writeLog != nullptr)
+			writeLog->push_back(filePath);
+
+		return std::make_unique<ReplacingStream>(filePath);
+	}
+
 	static void WriteAllText(const fs::path& filePath, const std::string& text)
 	{
+		if (writeLog != nullptr)
+			writeLog->push_back(filePath);
+
 		ofstream file(filePath, std::ios::out);
 		file.write(text.c_str(), text.size());
 		file.close();
 	}
+
+	// Like WriteAllText, but leaves the file (and its timestamp) alone if it already holds `text`.
+	// Returns whether the file was written
+	static bool WriteAllTextIfChanged(const fs::path& filePath, const std::string& text)
+	{
+		if (HasContent(filePath, text.data(), text.size()))
+		{
+			if (writeLog != nullptr)
+				writeLog->push_back(filePath);
+			return false;
+		}
+
+		WriteAllText(filePath, text);
+		return true;
+	}
+
+	// Whether both files have the same content
+	static bool HaveSameContent(const fs::path& filePathA, const fs::path& filePathB)
+	{
+		ifstream fileA(filePathA, std::ios::in | std::ios::binary | std::ios::ate);
+		ifstream fileB(filePathB, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!fileA.is_open() || !fileB.is_open() || fileA.tellg() != fileB.tellg())
+			return false;
+
+		fileA.seekg(0);
+		fileB.seekg(0);
+
+		std::vector<char> bufferA(0x10000);
+		std::vector<char> bufferB(0x10000);
+		while (fileA && fileB)
+		{
+			fileA.read(bufferA.data(), bufferA.size());
+			fileB.read(bufferB.data(), bufferB.size());
+			if (fileA.gcount() != fileB.gcount() ||
+			    memcmp(bufferA.data(), bufferB.data(), fileA.gcount()) != 0)
+				return false;
+		}
+
+		return true;
+	}
+
+	// Whether the file holds exactly the `size` bytes of `data`. The sizes are compared first, then
+	// the file is read back in chunks
+	static bool HasContent(const fs::path& filePath, const char* data, size_t size)
+	{
+		ifstream existing(filePath, std::ios::in | std::ios::binary | std::ios::ate);
+		if (!existing.is_open() || static_cast<size_t>(existing.tellg()) != size)
+			return false;
+
+		existing.seekg(0);
+
+		std::vector<char> buffer(std::min<size_t>(size, 0x10000));
+		for (size_t offset = 0; offset < size; offset += buffer.size())
+		{
+			size_t chunkSize = std::min(buffer.size(), size - offset);
+			existing.read(buffer.data(), chunkSize);
+			if (!existing || memcmp(buffer.data(), data + offset, chunkSize) != 0)
+				return false;
+		}
+
+		return true;
+	}
 };
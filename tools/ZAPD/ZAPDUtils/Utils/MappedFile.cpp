@@ -0,0 +1,69 @@
+#include "MappedFile.h"
+
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+	if (mappedData != nullptr)
+		munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+#endif
+}
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& filePath)
+{
+	std::shared_ptr<MappedFile> file(new MappedFile());
+
+#ifndef _WIN32
+	int fd = open(filePath.c_str(), O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0)
+	{
+		close(fd);
+		return nullptr;
+	}
+
+	// mmap rejects empty mappings, an empty file just gets an empty view
+	if (fileStat.st_size > 0)
+	{
+		void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED)
+		{
+			file->mappedData = static_cast<const uint8_t*>(data);
+			file->mappedSize = fileStat.st_size;
+		}
+	}
+	close(fd);
+
+	if (file->mappedData != nullptr || fileStat.st_size == 0)
+		return file;
+#endif
+
+	std::ifstream stream(filePath, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!stream.is_open())
+		return nullptr;
+
+	file->fallbackData.resize(stream.tellg());
+	stream.seekg(0);
+	stream.read(reinterpret_cast<char*>(file->fallbackData.data()), file->fallbackData.size());
+
+	return file;
+}
+
+DataView MappedFile::GetView() const
+{
+	if (mappedData != nullptr)
+		return DataView(mappedData, mappedSize);
+
+	return DataView(fallbackData);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataView.h"
+
+/**
+ * A whole file mapped read-only into memory. The pages are shared with the OS page cache, so
+ * many threads (or processes) reading the same baserom file don't each keep a private copy.
+ * On platforms without mmap the file is read into a buffer owned by this object instead.
+ */
+class MappedFile
+{
+public:
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Returns nullptr if the file can't be opened
+	static std::shared_ptr<MappedFile> Open(const std::string& filePath);
+
+	DataView GetView() const;
+
+protected:
+	const uint8_t* mappedData = nullptr;
+	size_t mappedSize = 0;
+	std::vector<uint8_t> fallbackData;
+
+	MappedFile() = default;
+};
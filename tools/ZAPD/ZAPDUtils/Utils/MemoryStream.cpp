@@ -1,5 +1,6 @@
 #include "MemoryStream.h"
 #include <cstring>
+#include <stdexcept>
 
 #ifndef _MSC_VER
 #define memcpy_s(dest, destSize, source, sourceSize) memcpy(dest, source, destSize)
@@ -54,6 +55,17 @@ void MemoryStream::Read(const char* dest, size_t length)
 	baseAddress += length;
 }
 
+DataView MemoryStream::ReadView(size_t length)
+{
+	if (baseAddress + length > buffer.size())
+		throw std::out_of_range("MemoryStream::ReadView: reading past the end of the stream");
+
+	DataView view(reinterpret_cast<const uint8_t*>(buffer.data()) + baseAddress, length);
+	baseAddress += length;
+
+	return view;
+}
+
 int8_t MemoryStream::ReadByte()
 {
 	return buffer[baseAddress++];
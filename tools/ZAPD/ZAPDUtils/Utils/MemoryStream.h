@@ -17,6 +17,7 @@ public:
 
 	std::unique_ptr<char[]> Read(size_t length) override;
 	void Read(const char* dest, size_t length) override;
+	DataView ReadView(size_t length) override;
 	int8_t ReadByte() override;
 
 	void Write(char* srcBuffer, size_t length) override;
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Digit pairs for NumberFormat
+struct NumberFormatTables
+{
+	char hexPairs[2 * 256];
+	char decPairs[2 * 100];
+
+	constexpr NumberFormatTables() : hexPairs(), decPairs()
+	{
+		const char* hexDigits = "0123456789ABCDEF";
+
+		for (int i = 0; i < 256; i++)
+		{
+			hexPairs[2 * i] = hexDigits[i >> 4];
+			hexPairs[2 * i + 1] = hexDigits[i & 0xF];
+		}
+		for (int i = 0; i < 100; i++)
+		{
+			decPairs[2 * i] = static_cast<char>('0' + i / 10);
+			decPairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+		}
+	}
+};
+
+inline constexpr NumberFormatTables numberFormatTables{};
+
+/**
+ * Writes integers the way the printf formats used in generated sources do, straight into a
+ * caller's buffer. Digits are produced two at a time from lookup tables, which is several times
+ * faster than going through Sprintf for the many values of textures, blobs and scalar arrays
+ */
+class NumberFormat
+{
+public:
+	// Enough for any single value written by the functions below, "0x" and 16 digits or a sign
+	// and 20 digits
+	static constexpr size_t MaxSize = 24;
+
+	// Like "0x%0*llX" with `minDigits` digits at least. Returns the end of what was written
+	static inline char* Hex(char* p, uint64_t value, int minDigits)
+	{
+		int digits = 1;
+		while (digits < 16 && (value >> (4 * digits)) != 0)
+			digits++;
+		if (digits < minDigits)
+			digits = minDigits;
+
+		p[0] = '0';
+		p[1] = 'x';
+		char* end = p + 2 + digits;
+		char* q = end;
+
+		// Past the 16 digits of the value, the pairs are all zeros
+		for (; digits >= 2; digits -= 2)
+		{
+			q -= 2;
+			const char* pair = &numberFormatTables.hexPairs[2 * (value & 0xFF)];
+			q[0] = pair[0];
+			q[1] = pair[1];
+			value >>= 8;
+		}
+		if (digits != 0)
+			q[-1] = numberFormatTables.hexPairs[2 * (value & 0xF) + 1];
+		return end;
+	}
+
+	// Like "%llu". Returns the end of what was written
+	static inline char* UDec(char* p, uint64_t value)
+	{
+		char buf[20];
+		char* q = buf + sizeof(buf);
+
+		while (value >= 100)
+		{
+			q -= 2;
+			const char* pair = &numberFormatTables.decPairs[2 * (value % 100)];
+			q[0] = pair[0];
+			q[1] = pair[1];
+			value /= 100;
+		}
+		if (value >= 10)
+		{
+			q -= 2;
+			q[0] = numberFormatTables.decPairs[2 * value];
+			q[1] = numberFormatTables.decPairs[2 * value + 1];
+		}
+		else
+		{
+			*--q = static_cast<char>('0' + value);
+		}
+
+		size_t len = buf + sizeof(buf) - q;
+		for (size_t i = 0; i < len; i++)
+			p[i] = q[i];
+		return p + len;
+	}
+
+	// Like "%lld". Returns the end of what was written
+	static inline char* Dec(char* p, int64_t value)
+	{
+		uint64_t magnitude = static_cast<uint64_t>(value);
+
+		if (value < 0)
+		{
+			*p++ = '-';
+			magnitude = 0 - magnitude;
+		}
+		return UDec(p, magnitude);
+	}
+
+	static inline void AppendHex(std::string& output, uint64_t value, int minDigits)
+	{
+		char buf[MaxSize];
+		output.append(buf, Hex(buf, value, minDigits) - buf);
+	}
+
+	static inline void AppendUDec(std::string& output, uint64_t value)
+	{
+		char buf[MaxSize];
+		output.append(buf, UDec(buf, value) - buf);
+	}
+
+	static inline void AppendDec(std::string& output, int64_t value)
+	{
+		char buf[MaxSize];
+		output.append(buf, Dec(buf, value) - buf);
+	}
+};
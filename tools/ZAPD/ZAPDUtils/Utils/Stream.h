@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <memory>
+#include "DataView.h"
 
 enum class SeekOffsetType
 {
@@ -28,6 +29,8 @@ public:
 
 	virtual std::unique_ptr<char[]> Read(size_t length) = 0;
 	virtual void Read(const char* dest, size_t length) = 0;
+	// Returns the next `length` bytes without copying them. The view is valid until the next write
+	virtual DataView ReadView(size_t length) = 0;
 	virtual int8_t ReadByte() = 0;
 
 	virtual void Write(char* destBuffer, size_t length) = 0;
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cstdarg>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <numeric>
 #include <string>
@@ -88,19 +90,49 @@ public:
 
 	static std::string Sprintf(const char* format, ...)
 	{
-		char buffer[32768];
-		// char buffer[2048];
 		std::string output;
 		va_list va;
 
 		va_start(va, format);
-		vsprintf(buffer, format, va);
+		AppendSprintfV(output, format, va);
 		va_end(va);
 
-		output = buffer;
 		return output;
 	}
 
+	// Formats directly at the end of `output`, without going through a temporary string
+	static void AppendSprintf(std::string& output, const char* format, ...)
+	{
+		va_list va;
+
+		va_start(va, format);
+		AppendSprintfV(output, format, va);
+		va_end(va);
+	}
+
+	static void AppendSprintfV(std::string& output, const char* format, va_list va)
+	{
+		size_t oldSize = output.size();
+		size_t available = std::max<size_t>(output.capacity() - oldSize, 64);
+
+		va_list vaRetry;
+		va_copy(vaRetry, va);
+
+		// Most calls fit in the capacity the string already has, only longer ones format twice
+		output.resize(oldSize + available);
+		int32_t length = vsnprintf(&output[oldSize], available, format, va);
+		if (length < 0)
+			length = 0;
+		else if (static_cast<size_t>(length) >= available)
+		{
+			output.resize(oldSize + length + 1);
+			vsnprintf(&output[oldSize], length + 1, format, vaRetry);
+		}
+		va_end(vaRetry);
+
+		output.resize(oldSize + length);
+	}
+
 	static std::string Implode(std::vector<std::string>& elements, const char* const separator)
 	{
 		return std::accumulate(std::begin(elements), std::end(elements), std::string(),
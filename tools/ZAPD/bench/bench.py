@@ -0,0 +1,633 @@
+#!/usr/bin/env python3
+
+# Runs ZAPD on fixed workloads and reports the wall time, peak RSS and allocations of each one.
+#
+# A baserom can't be shipped, so the inputs are synthetic: random data laid out like the real
+# assets, generated from a fixed seed. The same inputs are produced on every machine, so results
+# of different ZAPD builds can be compared directly.
+
+import argparse
+import json
+import os
+import random
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import time
+import xml.etree.ElementTree as ET
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+ZAPD_DIR = os.path.dirname(SCRIPT_DIR)
+
+SEED = 0x5A415044
+TEXTURE_COUNT = 450
+DLIST_COUNT = 250
+ROOM_COUNT = 8
+ROOM_DLIST_COUNT = 60
+ROOM_ACTOR_COUNT = 40
+PLAYER_ANIM_COUNT = 200
+BTEX_PNG_COUNT = 300
+CUTSCENE_COUNT = 300
+POOL_JOB_COUNT = 24
+POOL_TEXTURE_COUNT = 60
+
+ALLOC_RE = re.compile(r"^PROFILE: (\d+) allocations$", re.MULTILINE)
+
+
+class Object:
+    """A baserom file under construction, with the XML elements that describe it."""
+
+    def __init__(self, name, segment):
+        self.name = name
+        self.segment = segment
+        self.data = bytearray()
+        self.elements = []
+
+    def align(self, alignment):
+        self.data += bytes(-len(self.data) % alignment)
+
+    def add(self, data, alignment=8):
+        self.align(alignment)
+        offset = len(self.data)
+        self.data += data
+        return offset
+
+    def segmented(self, offset):
+        return (self.segment << 24) | offset
+
+
+def random_bytes(rng, size):
+    return bytes(rng.getrandbits(8) for _ in range(size))
+
+
+def write_xml(path, objects):
+    root = ET.Element("Root")
+    for obj in objects:
+        file = ET.SubElement(root, "File", Name=obj.name, Segment=str(obj.segment), Game="MM")
+        for tag, attrs in obj.elements:
+            ET.SubElement(file, tag, attrs)
+
+    ET.indent(root)
+    ET.ElementTree(root).write(path)
+
+
+# F3DZEX2 display list commands
+
+
+def gfx(w0, w1):
+    return struct.pack(">II", w0, w1)
+
+
+def gfx_load_texture_32x32_rgba16(address):
+    texels = 32 * 32
+    line = (32 * 2 + 7) >> 3
+    dxt = (2048 + (32 * 2 // 8) - 1) // (32 * 2 // 8)
+    mask = (5 << 14) | (5 << 4)
+
+    return b"".join(
+        [
+            gfx(0xFD100000, address),  # G_SETTIMG, RGBA 16b
+            gfx(0xF5100000, 0x07000000 | mask),  # G_SETTILE, G_TX_LOADTILE
+            gfx(0xE6000000, 0),  # G_RDPLOADSYNC
+            gfx(0xF3000000, 0x07000000 | ((texels - 1) << 12) | dxt),  # G_LOADBLOCK
+            gfx(0xE7000000, 0),  # G_RDPPIPESYNC
+            gfx(0xF5100000 | (line << 9), mask),  # G_SETTILE, G_TX_RENDERTILE
+            gfx(0xF2000000, (31 << 14) | (31 << 2)),  # G_SETTILESIZE
+        ]
+    )
+
+
+def gfx_vtx(address, count, v0=0):
+    return gfx(0x01000000 | (count << 12) | ((v0 + count) << 1), address)
+
+
+def gfx_tri2(rng, vertexCount):
+    v = [rng.randrange(vertexCount) * 2 for _ in range(6)]
+    return gfx(0x06000000 | (v[0] << 16) | (v[1] << 8) | v[2], (v[3] << 16) | (v[4] << 8) | v[5])
+
+
+def gfx_enddl():
+    return gfx(0xDF000000, 0)
+
+
+def random_vertices(rng, count):
+    return b"".join(
+        struct.pack(
+            ">hhhHhhBBBB",
+            rng.randrange(-4000, 4000),
+            rng.randrange(-4000, 4000),
+            rng.randrange(-4000, 4000),
+            0,
+            rng.randrange(-1024, 1024),
+            rng.randrange(-1024, 1024),
+            rng.getrandbits(8),
+            rng.getrandbits(8),
+            rng.getrandbits(8),
+            0xFF,
+        )
+        for _ in range(count)
+    )
+
+
+def add_textured_dlists(rng, obj, count, prefix=None):
+    """Adds display lists that each load a texture and draw two batches of triangles."""
+    offsets = []
+
+    for i in range(count):
+        texture = obj.add(random_bytes(rng, 32 * 32 * 2))
+        vertices = obj.add(random_vertices(rng, 64))
+
+        dlist = gfx_load_texture_32x32_rgba16(obj.segmented(texture))
+        for batch in range(2):
+            dlist += gfx_vtx(obj.segmented(vertices + batch * 32 * 16), 32)
+            dlist += b"".join(gfx_tri2(rng, 32) for _ in range(12))
+        dlist += gfx_enddl()
+
+        offset = obj.add(dlist)
+        offsets.append(offset)
+        if prefix is not None:
+            obj.elements.append(("DList", {"Name": f"{prefix}{i:04}DL", "Offset": f"0x{offset:X}"}))
+
+    return offsets
+
+
+# Workload inputs
+
+
+def gen_textures(rng):
+    obj = Object("bench_textures", 6)
+    formats = [
+        ("rgba16", 16),
+        ("rgba32", 32),
+        ("i4", 4),
+        ("i8", 8),
+        ("ia4", 4),
+        ("ia8", 8),
+        ("ia16", 16),
+        ("ci4", 4),
+        ("ci8", 8),
+    ]
+    sizes = [(32, 32), (64, 32), (64, 64)]
+
+    tluts = {}
+    for fmt, colors in [("ci4", 16), ("ci8", 256)]:
+        tluts[fmt] = obj.add(random_bytes(rng, colors * 2))
+        obj.elements.append(
+            (
+                "Texture",
+                {
+                    "Name": f"benchTlut_{fmt}",
+                    "OutName": f"tlut_{fmt}",
+                    "Format": "rgba16",
+                    "Width": str(colors),
+                    "Height": "1",
+                    "Offset": f"0x{tluts[fmt]:X}",
+                },
+            )
+        )
+
+    for i in range(TEXTURE_COUNT):
+        fmt, bpp = formats[i % len(formats)]
+        width, height = sizes[(i // len(formats)) % len(sizes)]
+        offset = obj.add(random_bytes(rng, width * height * bpp // 8))
+
+        attrs = {
+            "Name": f"benchTex_{i:04}",
+            "OutName": f"tex_{i:04}",
+            "Format": fmt,
+            "Width": str(width),
+            "Height": str(height),
+            "Offset": f"0x{offset:X}",
+        }
+        if fmt in tluts:
+            attrs["TlutOffset"] = f"0x{tluts[fmt]:X}"
+        obj.elements.append(("Texture", attrs))
+
+    return [obj]
+
+
+def gen_dlists(rng):
+    obj = Object("bench_dlists", 6)
+    add_textured_dlists(rng, obj, DLIST_COUNT, "benchObj_")
+    return [obj]
+
+
+def gen_scene(rng):
+    scene = Object("bench_scene", 2)
+    rooms = [Object(f"bench_scene_room_{i:02}", 3) for i in range(ROOM_COUNT)]
+
+    # Room list: vrom start and end of each room, not looked at by ZAPD
+    scene.add(bytes(3 * 8))
+    roomList = scene.add(
+        b"".join(struct.pack(">II", i * 0x10000, i * 0x10000 + 0x8000) for i in range(ROOM_COUNT))
+    )
+
+    header = bytearray()
+    header += struct.pack(">BBxxxxBB", 0x15, 0, 0x13, 0x1E)  # SCENE_CMD_SOUND_SETTINGS
+    # SCENE_CMD_ROOM_LIST
+    header += struct.pack(">BBxxI", 0x04, ROOM_COUNT, scene.segmented(roomList))
+    header += struct.pack(">Bxxxxxxx", 0x14)  # SCENE_CMD_END
+    scene.data[0 : len(header)] = header
+    scene.elements.append(("Scene", {"Name": scene.name, "Offset": "0x0"}))
+
+    for room in rooms:
+        # The commands are filled in once the offsets of what they point to are known
+        room.add(bytes(4 * 8))
+
+        actors = room.add(
+            b"".join(
+                struct.pack(
+                    ">hhhhhhhH",
+                    rng.randrange(0x100),
+                    *(rng.randrange(-2000, 2000) for _ in range(3)),
+                    *(rng.randrange(0x10000) - 0x8000 for _ in range(3)),
+                    rng.getrandbits(16),
+                )
+                for _ in range(ROOM_ACTOR_COUNT)
+            )
+        )
+
+        dlists = add_textured_dlists(rng, room, ROOM_DLIST_COUNT)
+        entries = room.add(b"".join(struct.pack(">II", room.segmented(dl), 0) for dl in dlists))
+        mesh = room.add(
+            struct.pack(
+                ">BBxxII",
+                0,
+                len(dlists),
+                room.segmented(entries),
+                room.segmented(entries + 8 * len(dlists)),
+            )
+        )
+
+        header = bytearray()
+        header += struct.pack(">BxxxxxxB", 0x16, 0)  # SCENE_CMD_ECHO_SETTINGS
+        # SCENE_CMD_ACTOR_LIST
+        header += struct.pack(">BBxxI", 0x01, ROOM_ACTOR_COUNT, room.segmented(actors))
+        header += struct.pack(">BxxxI", 0x0A, room.segmented(mesh))  # SCENE_CMD_MESH
+        header += struct.pack(">Bxxxxxxx", 0x14)  # SCENE_CMD_END
+        room.data[0 : len(header)] = header
+        room.elements.append(("Room", {"Name": room.name, "Offset": "0x0"}))
+
+    return [scene] + rooms
+
+
+def gen_player_anims(rng):
+    obj = Object("bench_link_animetion", 7)
+
+    for i in range(PLAYER_ANIM_COUNT):
+        frameCount = rng.randrange(10, 80)
+        # (sizeof(Vec3s) * limbCount + 2) * frameCount
+        offset = obj.add(random_bytes(rng, (6 * 22 + 2) * frameCount), 4)
+        obj.elements.append(
+            (
+                "PlayerAnimationData",
+                {
+                    "Name": f"benchPlayerAnim_{i:04}Data",
+                    "FrameCount": str(frameCount),
+                    "Offset": f"0x{offset:X}",
+                },
+            )
+        )
+
+    return [obj]
+
+
+def gen_cutscenes(rng):
+    obj = Object("bench_cutscenes", 2)
+
+    def cs_entries(count, extra):
+        return b"".join(
+            struct.pack(">HHH", rng.randrange(1, 0x20), frame, frame + rng.randrange(1, 60))
+            + extra()
+            for frame in range(0, count * 10, 10)
+        )
+
+    def actor_cue():
+        return struct.pack(
+            ">HHH6i3f",
+            *(rng.getrandbits(16) for _ in range(3)),
+            *(rng.randrange(-4000, 4000) for _ in range(6)),
+            *(rng.uniform(-1, 1) for _ in range(3)),
+        )
+
+    def text():
+        return struct.pack(
+            ">HHH", rng.choice([0, 1, 3, 4, 5, 0xFFFF]), rng.getrandbits(16), rng.getrandbits(16)
+        )
+
+    # Command id and the bytes of an entry past its base and frames. Without a config there are
+    # no enums, so only commands that can do without them are used
+    commands = [
+        (0x097, lambda: struct.pack(">H", 0)),  # CS_CMD_LIGHT_SETTING
+        (0x09A, lambda: struct.pack(">H", 0)),  # CS_CMD_GIVE_TATL
+        (0x12E, lambda: struct.pack(">H", 0)),  # CS_CMD_START_AMBIENCE
+        (0x09B, lambda: bytes(rng.randrange(4) for _ in range(6))),  # CS_CMD_TRANSITION_GENERAL
+        (0x09C, lambda: struct.pack(">HI", 0, 0)),  # CS_CMD_FADE_OUT_SEQ
+        (0x09D, lambda: struct.pack(">BBI", rng.randrange(24), rng.randrange(60), 0)),  # TIME
+        (0x00A, text),  # CS_CMD_TEXT
+        (0x190, lambda: struct.pack(">BBBxxx", *(rng.randrange(0x100) for _ in range(3)))),
+    ]
+
+    for i in range(CUTSCENE_COUNT):
+        body = bytearray()
+        numCommands = rng.randrange(20, 40)
+
+        for _ in range(numCommands):
+            if rng.random() < 0.6:
+                cmdId = rng.choice([rng.randrange(100, 150), rng.randrange(450, 600)])
+                extra = actor_cue
+            else:
+                cmdId, extra = rng.choice(commands)
+            count = rng.randrange(1, 12)
+            body += struct.pack(">II", cmdId, count) + cs_entries(count, extra)
+
+        offset = obj.add(
+            struct.pack(">ii", numCommands, rng.randrange(100, 2000)) + body + b"\xFF" * 4, 4
+        )
+        obj.elements.append(("Cutscene", {"Name": f"benchCs_{i:03}", "Offset": f"0x{offset:X}"}))
+
+    return [obj]
+
+
+def texture_crc(data):
+    """The hash the texture pool is keyed by. ZAPD's CRC shifts its register arithmetically."""
+    crc = 0xFFFFFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            lsb = crc & 1
+            crc = (crc >> 1) | (crc & 0x80000000)
+            if lsb:
+                crc ^= 0xEDB88320
+    return crc ^ 0xFFFFFFFF
+
+
+def gen_pool_batch(rng, workDir, zapd, baseromDir):
+    """
+    Writes a batch of objects that all hold the same textures, drawn with the same external
+    palette, as the texture pool lists them. Returns the command extracting the batch.
+    """
+    poolDir = os.path.join("out", "pool_batch", "pool")
+    palette = Object("bench_pool_pal", 5)
+    paletteData = random_bytes(rng, 256 * 2)
+    palette.add(paletteData)
+    palette.elements.append(
+        (
+            "Texture",
+            {
+                "Name": "benchPoolTlut",
+                "OutName": "pool_tlut",
+                "Format": "rgba16",
+                "Width": "16",
+                "Height": "16",
+                "Offset": "0x0",
+            },
+        )
+    )
+
+    pool = ET.Element("Root")
+    ET.SubElement(
+        pool, "Texture", CRC=f"{texture_crc(paletteData):08X}", Path=f"{poolDir}/pool_tlut"
+    )
+
+    formats = [("rgba16", 16), ("ia8", 8), ("ci8", 8)]
+    textures = []
+    for i in range(POOL_TEXTURE_COUNT):
+        fmt, bpp = formats[i % len(formats)]
+        data = random_bytes(rng, 64 * 32 * bpp // 8)
+        attrs = {
+            "Name": f"benchPoolTex_{i:04}",
+            "OutName": f"pool_tex_{i:04}",
+            "Format": fmt,
+            "Width": "64",
+            "Height": "32",
+        }
+        if fmt == "ci8":
+            attrs["ExternalTlut"] = palette.name
+            attrs["ExternalTlutOffset"] = "0x0"
+        textures.append((data, attrs))
+        ET.SubElement(
+            pool, "Texture", CRC=f"{texture_crc(data):08X}", Path=f"{poolDir}/pool_tex_{i:04}"
+        )
+
+    objects = [palette]
+    for job in range(POOL_JOB_COUNT):
+        obj = Object(f"bench_pool_{job:02}", 6)
+        for data, attrs in textures:
+            obj.elements.append(("Texture", dict(attrs, Offset=f"0x{obj.add(data):X}")))
+        objects.append(obj)
+
+    for obj in objects:
+        obj.align(16)
+        with open(os.path.join(baseromDir, obj.name), "wb") as f:
+            f.write(obj.data)
+
+    batchDir = os.path.join(workDir, "pool_batch")
+    os.makedirs(batchDir)
+    ET.ElementTree(pool).write(os.path.join(batchDir, "TexturePool.xml"))
+    config = ET.Element("Root")
+    ET.SubElement(config, "TexturePool", File="TexturePool.xml")
+    ET.ElementTree(config).write(os.path.join(batchDir, "Config.xml"))
+
+    with open(os.path.join(batchDir, "list.txt"), "w") as f:
+        for obj in objects[1:]:
+            xmlPath = os.path.join(batchDir, f"{obj.name}.xml")
+            write_xml(xmlPath, [obj, palette])
+            out = os.path.join("out", "pool_batch", obj.name)
+            f.write(f"-i {xmlPath} -o {out} -osf {out} -gsf 1\n")
+
+    listPath = os.path.join(batchDir, "list.txt")
+    configPath = os.path.join(batchDir, "Config.xml")
+    return [zapd, "batch", "-eh", "-l", listPath, "-b", baseromDir, "-rconf", configPath, "-j", "4"]
+
+
+EXTRACT_WORKLOADS = [
+    ("textures", gen_textures),
+    ("dlists", gen_dlists),
+    ("scene", gen_scene),
+    ("player_anims", gen_player_anims),
+    ("cutscenes", gen_cutscenes),
+]
+
+# Arguments only some workloads are extracted with
+WORKLOAD_ARGS = {
+    "cutscenes": ["--cs-float", "both"],
+}
+
+
+def write_extract_inputs(rng, baseromDir, xmlDir):
+    """
+    Writes the baserom files and the XML of every extraction workload, returns the names of the
+    workloads with the paths of their XMLs. Also used by regress.py as its synthetic corpus.
+    """
+    inputs = []
+
+    for name, gen in EXTRACT_WORKLOADS:
+        objects = gen(rng)
+        for obj in objects:
+            # Like real files. ZAPD rounds sizes up to 4 bytes and would read past the end otherwise
+            obj.align(16)
+            with open(os.path.join(baseromDir, obj.name), "wb") as f:
+                f.write(obj.data)
+
+        xmlPath = os.path.join(xmlDir, f"{name}.xml")
+        write_xml(xmlPath, objects)
+        inputs.append((name, xmlPath))
+
+    return inputs
+
+
+# Measurements
+
+
+class Measurement:
+    def __init__(self):
+        self.wall = 0.0
+        self.maxRss = 0  # In KiB
+        self.allocations = 0
+
+    def add(self, other):
+        self.wall += other.wall
+        self.maxRss = max(self.maxRss, other.maxRss)
+        self.allocations += other.allocations
+
+
+def run(args, cwd, profile=False):
+    """Runs ZAPD once and measures it."""
+    if profile:
+        args = args + ["-profile", "1"]
+
+    start = time.perf_counter()
+    process = subprocess.Popen(
+        args, cwd=cwd, stdout=subprocess.PIPE if profile else subprocess.DEVNULL
+    )
+    output = process.stdout.read().decode() if profile else ""
+    _, status, usage = os.wait4(process.pid, 0)
+    end = time.perf_counter()
+
+    # Popen would otherwise try to reap the process again
+    process.returncode = os.waitstatus_to_exitcode(status)
+    if process.returncode != 0:
+        sys.exit(f"Error: '{' '.join(args)}' failed with code {process.returncode}")
+
+    result = Measurement()
+    result.wall = end - start
+    result.maxRss = usage.ru_maxrss
+
+    if profile:
+        match = ALLOC_RE.search(output)
+        if match is None:
+            sys.exit("Error: ZAPD did not report its allocations, is it too old for -profile?")
+        result.allocations = int(match.group(1))
+
+    return result
+
+
+def measure(commands, cwd, runs):
+    """
+    Runs a workload, a list of ZAPD commands, `runs` times and keeps the fastest run. Allocations
+    come from one more run with profiling enabled, since profiling slows ZAPD down.
+    """
+    best = None
+
+    for _ in range(runs):
+        total = Measurement()
+        for args in commands:
+            total.add(run(args, cwd))
+
+        if best is None or total.wall < best.wall:
+            best = total
+
+    for args in commands:
+        best.allocations += run(args, cwd, profile=True).allocations
+
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark ZAPD on synthetic workloads")
+    parser.add_argument(
+        "--zapd", default=os.path.join(ZAPD_DIR, "ZAPD.out"), help="ZAPD binary to benchmark"
+    )
+    parser.add_argument(
+        "--work-dir",
+        default=os.path.join(ZAPD_DIR, "build", "bench"),
+        help="where the inputs and outputs are kept",
+    )
+    parser.add_argument(
+        "--runs", type=int, default=3, help="runs of each workload, the fastest one is kept"
+    )
+    parser.add_argument("--json", help="also write the results to this file")
+    parser.add_argument("workloads", nargs="*", help="only run these workloads")
+    args = parser.parse_args()
+
+    zapd = os.path.abspath(args.zapd)
+    workDir = os.path.abspath(args.work_dir)
+    baseromDir = os.path.join(workDir, "baserom")
+    xmlDir = os.path.join(workDir, "xml")
+    outDir = os.path.join(workDir, "out")
+
+    if os.path.exists(workDir):
+        shutil.rmtree(workDir)
+    os.makedirs(baseromDir)
+    os.makedirs(xmlDir)
+
+    rng = random.Random(SEED)
+    workloads = []
+
+    for name, xmlPath in write_extract_inputs(rng, baseromDir, xmlDir):
+        out = os.path.join(outDir, name)
+        command = [zapd, "e", "-eh", "-i", xmlPath, "-b", baseromDir, "-o", out, "-osf", out]
+        command += ["-gsf", "1"] + WORKLOAD_ARGS.get(name, [])
+        workloads.append((name, [command]))
+
+    # The build modes take the PNGs extracted by the textures workload
+    pngDir = os.path.join(workDir, "png")
+    subprocess.run(workloads[0][1][0], check=True, stdout=subprocess.DEVNULL)
+    os.makedirs(pngDir)
+    pngs = sorted(f for f in os.listdir(os.path.join(outDir, "textures")) if f.endswith(".png"))
+    for png in pngs[:BTEX_PNG_COUNT]:
+        shutil.copy(os.path.join(outDir, "textures", png), pngDir)
+    pngs = sorted(os.listdir(pngDir))
+
+    btexDir = os.path.join(outDir, "btex")
+    os.makedirs(btexDir)
+    btexCommands = []
+    for png in pngs:
+        texType = png.split(".")[-2]
+        btexCommands.append(
+            [zapd, "btex", "-eh", "-tt", texType]
+            + ["-i", os.path.join(pngDir, png)]
+            + ["-o", os.path.join(btexDir, png[: -len(".png")] + ".inc.c")]
+        )
+    workloads.append((f"btex_x{len(pngs)}", btexCommands))
+    bassetsCommand = [zapd, "bassets", "-eh", "-i", pngDir, "-o", os.path.join(outDir, "bassets")]
+    workloads.append(("bassets", [bassetsCommand]))
+    workloads.append(("pool_batch", [gen_pool_batch(rng, workDir, zapd, baseromDir)]))
+
+    if args.workloads:
+        workloads = [w for w in workloads if w[0] in args.workloads]
+
+    print(f"{'Workload':<16} {'Wall (s)':>10} {'Peak RSS (MiB)':>15} {'Allocations':>12}")
+    results = {}
+
+    for name, commands in workloads:
+        result = measure(commands, workDir, args.runs)
+        results[name] = {
+            "wall": result.wall,
+            "max_rss_kib": result.maxRss,
+            "allocations": result.allocations,
+        }
+        rss = result.maxRss / 1024
+        print(f"{name:<16} {result.wall:>10.3f} {rss:>15.1f} {result.allocations:>12}")
+
+    if args.json is not None:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=4)
+            f.write("\n")
+
+
+if __name__ == "__main__":
+    main()
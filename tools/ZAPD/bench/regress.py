@@ -0,0 +1,319 @@
+#!/usr/bin/env python3
+
+# Extracts a set of XMLs with ZAPD and compares the output byte for byte with a stored golden copy,
+# so that changes meant to make ZAPD faster can be checked to not change what it extracts.
+#
+# The golden copy is either a directory holding the output of every XML, or a JSON manifest with
+# the hash of every file and of every declaration of the C files, which is much smaller but can't
+# show what changed inside a declaration. Run with --update and a known good ZAPD to write it.
+#
+# Without XMLs, the synthetic inputs of bench.py are used, so no baserom is needed.
+
+import argparse
+import concurrent.futures
+import difflib
+import hashlib
+import json
+import os
+import random
+import re
+import shutil
+import subprocess
+import sys
+
+import bench
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+ZAPD_DIR = os.path.dirname(SCRIPT_DIR)
+
+SOURCE_EXTENSIONS = (".c", ".h")
+
+# A line that starts a declaration of the generated sources, the symbol is the first group.
+# `#include` and `#if` lines, which may be within a declaration, don't match
+DECL_RE = re.compile(
+    r"^(?:#define\s+(\w+)"
+    r"|(?:(?:extern|static|const)\s+)*[A-Za-z_][\w \*]*?\b([A-Za-z_]\w*)\s*(?:\[[^\]]*\])*\s*[=;])"
+)
+
+
+class Job:
+    """An XML to extract. `name` is where its output goes, relative to the output directory."""
+
+    def __init__(self, name, xmlPath, args=None):
+        self.name = name
+        self.xmlPath = xmlPath
+        self.args = args or []
+
+
+class FileSummary:
+    """The hash of a file and, for C sources, of each of its declarations in order."""
+
+    def __init__(self, sha1, symbols=None, texts=None):
+        self.sha1 = sha1
+        self.symbols = symbols
+        # The text of each declaration, only known when read from a directory
+        self.texts = texts
+
+
+def split_declarations(text):
+    """Returns the declarations of a generated source file, as a dict from symbol to text."""
+    declarations = {"<preamble>": []}
+    current = declarations["<preamble>"]
+
+    for line in text.splitlines(keepends=True):
+        match = DECL_RE.match(line)
+        if match is not None:
+            symbol = match.group(1) or match.group(2)
+            # A symbol declared twice, e.g. a forward declaration, keeps both texts
+            current = declarations.setdefault(symbol, [])
+        current.append(line)
+
+    return {symbol: "".join(lines) for symbol, lines in declarations.items()}
+
+
+def summarize_file(path, keepTexts):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    summary = FileSummary(hashlib.sha1(data).hexdigest())
+    if path.endswith(SOURCE_EXTENSIONS):
+        texts = split_declarations(data.decode(errors="replace"))
+        summary.symbols = {
+            symbol: hashlib.sha1(text.encode()).hexdigest() for symbol, text in texts.items()
+        }
+        if keepTexts:
+            summary.texts = texts
+
+    return summary
+
+
+def summarize_dir(root, keepTexts=False):
+    """Returns the summary of every file under `root`, keyed by its path relative to it."""
+    files = {}
+
+    for dirPath, _, fileNames in os.walk(root):
+        for fileName in fileNames:
+            path = os.path.join(dirPath, fileName)
+            files[os.path.relpath(path, root)] = summarize_file(path, keepTexts)
+
+    return files
+
+
+def read_manifest(path):
+    with open(path) as f:
+        manifest = json.load(f)
+    return {
+        relPath: FileSummary(entry["sha1"], entry.get("symbols"))
+        for relPath, entry in manifest.items()
+    }
+
+
+def write_manifest(path, files):
+    manifest = {}
+    for relPath in sorted(files):
+        summary = files[relPath]
+        manifest[relPath] = {"sha1": summary.sha1}
+        if summary.symbols is not None:
+            manifest[relPath]["symbols"] = summary.symbols
+
+    os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+    with open(path, "w") as f:
+        json.dump(manifest, f, indent=1)
+        f.write("\n")
+
+
+def compare_file(relPath, golden, output, verbose):
+    """Returns the lines reporting how a file differs from its golden copy."""
+    if golden.symbols is None or output.symbols is None:
+        return [f"{relPath}: differs"]
+
+    report = []
+    for symbol, sha1 in golden.symbols.items():
+        if symbol not in output.symbols:
+            report.append(f"{relPath}: {symbol} is missing")
+        elif output.symbols[symbol] != sha1:
+            report.append(f"{relPath}: {symbol} differs")
+            if verbose and golden.texts is not None:
+                diff = difflib.unified_diff(
+                    golden.texts[symbol].splitlines(keepends=True),
+                    output.texts[symbol].splitlines(keepends=True),
+                    "golden",
+                    "output",
+                )
+                report.extend("    " + line.rstrip("\n") for line in diff)
+
+    for symbol in output.symbols:
+        if symbol not in golden.symbols:
+            report.append(f"{relPath}: {symbol} is new")
+
+    if not report:
+        report.append(f"{relPath}: declarations are in a different order")
+    return report
+
+
+def compare(golden, output, verbose):
+    report = []
+
+    for relPath in sorted(golden.keys() | output.keys()):
+        if relPath not in output:
+            report.append(f"{relPath}: is missing")
+        elif relPath not in golden:
+            report.append(f"{relPath}: is new")
+        elif golden[relPath].sha1 != output[relPath].sha1:
+            report += compare_file(relPath, golden[relPath], output[relPath], verbose)
+
+    return report
+
+
+def find_xmls(paths):
+    """Returns the XMLs given, searching directories recursively, named after their paths."""
+    xmls = []
+    for path in paths:
+        if os.path.isdir(path):
+            for dirPath, _, fileNames in os.walk(path):
+                xmls += [os.path.join(dirPath, f) for f in fileNames if f.endswith(".xml")]
+        else:
+            xmls.append(path)
+
+    xmls = sorted(os.path.abspath(xml) for xml in xmls)
+    if not xmls:
+        return []
+
+    base = os.path.commonpath([os.path.dirname(xml) for xml in xmls])
+    return [Job(os.path.relpath(xml, base)[: -len(".xml")], xml) for xml in xmls]
+
+
+def synthetic_jobs(workDir):
+    """Writes the inputs of bench.py to `workDir`, returns their jobs and the baserom directory."""
+    baseromDir = os.path.join(workDir, "baserom")
+    xmlDir = os.path.join(workDir, "xml")
+    os.makedirs(baseromDir)
+    os.makedirs(xmlDir)
+
+    inputs = bench.write_extract_inputs(random.Random(bench.SEED), baseromDir, xmlDir)
+    jobs = [Job(name, xmlPath, bench.WORKLOAD_ARGS.get(name, [])) for name, xmlPath in inputs]
+    return jobs, baseromDir
+
+
+def extract(zapd, job, baseromDir, outDir, zapdArgs):
+    """Extracts a job to its own directory, returns ZAPD's output if it failed."""
+    out = os.path.join(outDir, job.name)
+    os.makedirs(out)
+
+    command = [zapd, "e", "-i", job.xmlPath, "-b", baseromDir, "-o", out, "-osf", out]
+    command += ["-gsf", "1"] + job.args + zapdArgs
+    process = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    if process.returncode != 0:
+        return process.stdout.decode(errors="replace")
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare the output of ZAPD on a set of XMLs with a golden copy"
+    )
+    parser.add_argument(
+        "--zapd", default=os.path.join(ZAPD_DIR, "ZAPD.out"), help="ZAPD binary to test"
+    )
+    parser.add_argument(
+        "--work-dir",
+        default=os.path.join(ZAPD_DIR, "build", "regress"),
+        help="where the synthetic inputs and the output are kept",
+    )
+    parser.add_argument(
+        "-b", "--baserom", help="baserom files directory, the synthetic inputs are used if not set"
+    )
+    parser.add_argument(
+        "--golden",
+        help="golden directory, or manifest if it ends with .json. "
+        "Defaults to golden.json in the work directory",
+    )
+    parser.add_argument(
+        "--update", action="store_true", help="write the golden copy instead of comparing with it"
+    )
+    parser.add_argument(
+        "-j", "--jobs", type=int, default=os.cpu_count(), help="XMLs extracted at once"
+    )
+    parser.add_argument(
+        "-v",
+        "--verbose",
+        action="store_true",
+        help="show how declarations differ, needs a golden directory",
+    )
+    parser.add_argument(
+        "-Z",
+        help="pass the argument on to ZAPD, without the leading dash, e.g. `-Zrconf=Config.xml`. "
+        "A value goes after an `=`",
+        metavar="ZAPD_ARG",
+        action="append",
+        default=[],
+    )
+    parser.add_argument("xmls", nargs="*", help="XMLs, or directories to search for them")
+    args = parser.parse_args()
+
+    zapd = os.path.abspath(args.zapd)
+    workDir = os.path.abspath(args.work_dir)
+    outDir = os.path.join(workDir, "out")
+    golden = args.golden or os.path.join(workDir, "golden.json")
+    zapdArgs = []
+    for arg in args.Z:
+        name, sep, value = arg.partition("=")
+        zapdArgs += ["-" + name] + ([value] if sep else [])
+
+    if bool(args.baserom) != bool(args.xmls):
+        sys.exit("Error: XMLs and a baserom are only given together")
+
+    # The golden copy may be in there, only what this script writes is removed
+    for name in ("baserom", "xml", "out"):
+        shutil.rmtree(os.path.join(workDir, name), ignore_errors=True)
+    os.makedirs(outDir)
+
+    if args.xmls:
+        jobs = find_xmls(args.xmls)
+        baseromDir = os.path.abspath(args.baserom)
+    else:
+        jobs, baseromDir = synthetic_jobs(workDir)
+
+    if not jobs:
+        sys.exit("Error: no XMLs found")
+
+    failed = 0
+    with concurrent.futures.ThreadPoolExecutor(args.jobs) as pool:
+        futures = {
+            pool.submit(extract, zapd, job, baseromDir, outDir, zapdArgs): job for job in jobs
+        }
+        for future in concurrent.futures.as_completed(futures):
+            error = future.result()
+            if error is not None:
+                failed += 1
+                print(f"{futures[future].name}: extraction failed\n{error}", file=sys.stderr)
+
+    if failed != 0:
+        sys.exit(f"Error: {failed} of {len(jobs)} XMLs failed to extract")
+
+    isManifest = golden.endswith(".json")
+    if args.update:
+        if isManifest:
+            write_manifest(golden, summarize_dir(outDir))
+        else:
+            shutil.rmtree(golden, ignore_errors=True)
+            shutil.copytree(outDir, golden)
+        print(f"Wrote the golden copy of {len(jobs)} XMLs to {golden}")
+        return
+
+    if not os.path.exists(golden):
+        sys.exit(f"Error: no golden copy at {golden}, write one with --update")
+
+    keepTexts = args.verbose and not isManifest
+    goldenFiles = read_manifest(golden) if isManifest else summarize_dir(golden, keepTexts)
+    report = compare(goldenFiles, summarize_dir(outDir, keepTexts), args.verbose)
+
+    for line in report:
+        print(line)
+    if report:
+        sys.exit(f"Error: the output of {len(jobs)} XMLs differs from {golden}")
+    print(f"The output of {len(jobs)} XMLs matches {golden}")
+
+
+if __name__ == "__main__":
+    main()
@@ -7,6 +7,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include <assert.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -539,6 +540,45 @@ aifc_read(aifc_data *af, const char *path, uint8_t *match_buf, size_t *match_buf
     fclose(in);
 }
 
+typedef struct aifc_cache_entry {
+    const char *path;
+    aifc_data af;
+    struct aifc_cache_entry *next;
+} aifc_cache_entry;
+
+static aifc_cache_entry *aifc_cache;
+static pthread_mutex_t aifc_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Like aifc_read without a match buffer, but every file is only read once per process. The result shares its
+ * allocations with every other read of the same file, so it must not be modified or passed to aifc_dispose.
+ */
+void
+aifc_read_cached(aifc_data *af, const char *path)
+{
+    pthread_mutex_lock(&aifc_cache_lock);
+
+    LL_FOREACH(aifc_cache_entry *, entry, aifc_cache) {
+        if (strequ(entry->path, path)) {
+            *af = entry->af;
+            pthread_mutex_unlock(&aifc_cache_lock);
+            return;
+        }
+    }
+
+    aifc_cache_entry *entry = malloc(sizeof(aifc_cache_entry));
+    if (entry == NULL)
+        error("Could not allocate aifc cache entry");
+
+    entry->path = strdup(path);
+    aifc_read(&entry->af, entry->path, NULL, NULL);
+    entry->next = aifc_cache;
+    aifc_cache = entry;
+    *af = entry->af;
+
+    pthread_mutex_unlock(&aifc_cache_lock);
+}
+
 void
 aifc_dispose(aifc_data *af)
 {
@@ -66,6 +66,9 @@ typedef struct {
 void
 aifc_read(aifc_data *af, const char *path, uint8_t *match_buf, size_t *match_buf_pos);
 
+void
+aifc_read_cached(aifc_data *af, const char *path);
+
 void
 aifc_dispose(aifc_data *af);
 
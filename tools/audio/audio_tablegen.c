@@ -21,12 +21,101 @@
 #include "elf32.h"
 #include "util.h"
 
+/* Table info */
+
+// sbc and sfc run with --table-info write a .tblinfo file next to their outputs that holds, on one line separated by
+// whitespace, what the tables need from that samplebank or soundfont:
+//     samplebank <name> <index> <medium> <cache policy> [<pointer index>...]
+//     soundfont <name> <index> <medium> <cache policy> <normal samplebank index> <dd samplebank index>
+// Given these instead of the xmls, the tables are generated without parsing every samplebank and soundfont again
+// whenever a single one of them changes.
+
+/**
+ * Splits the table info file at `path` into its fields, checking that it describes a `kind` and has between
+ * `min_fields` and `max_fields` fields after that. Like the xml documents, the fields and the file contents they point
+ * into are never freed.
+ */
+static char **
+table_info_read(const char *path, const char *kind, size_t min_fields, size_t max_fields, size_t *num_fields_out)
+{
+    size_t data_size;
+    char *data = util_read_whole_file(path, &data_size);
+
+    // Worst case every other character begins a field
+    char **fields = malloc((data_size / 2 + 1) * sizeof(char *));
+    size_t num_fields = 0;
+
+    char *p = data;
+    while (true) {
+        while (isspace((unsigned char)*p))
+            p++;
+        if (*p == '\0')
+            break;
+
+        fields[num_fields++] = p;
+        while (*p != '\0' && !isspace((unsigned char)*p))
+            p++;
+        if (*p != '\0')
+            *p++ = '\0';
+    }
+
+    if (num_fields == 0 || !strequ(fields[0], kind))
+        error("Table info file \"%s\" does not describe a %s", path, kind);
+    if (num_fields - 1 < min_fields || num_fields - 1 > max_fields)
+        error("Malformed table info file \"%s\"", path);
+
+    *num_fields_out = num_fields - 1;
+    return &fields[1];
+}
+
+static int
+table_info_int(const char *path, const char *field)
+{
+    char *end;
+    long value = strtol(field, &end, 10);
+
+    if (end == field || *end != '\0' || value < 0 || value > 255)
+        error("Malformed table info file \"%s\", bad index \"%s\"", path, field);
+    return value;
+}
+
+static void
+read_samplebank_table_info(samplebank *sb, const char *path)
+{
+    size_t num_fields;
+    char **fields = table_info_read(path, "samplebank", 4, SIZE_MAX, &num_fields);
+
+    sb->name = fields[0];
+    sb->index = table_info_int(path, fields[1]);
+    sb->medium = fields[2];
+    sb->cache_policy = fields[3];
+
+    sb->num_pointers = num_fields - 4;
+    sb->pointer_indices = malloc(sb->num_pointers * sizeof(int));
+    for (size_t i = 0; i < sb->num_pointers; i++)
+        sb->pointer_indices[i] = table_info_int(path, fields[4 + i]);
+}
+
+static void
+read_soundfont_table_info(soundfont *sf, int *normal_idx, int *dd_idx, const char *path)
+{
+    size_t num_fields;
+    char **fields = table_info_read(path, "soundfont", 6, 6, &num_fields);
+
+    sf->info.name = fields[0];
+    sf->info.index = table_info_int(path, fields[1]);
+    sf->info.medium = fields[2];
+    sf->info.cache_policy = fields[3];
+    *normal_idx = table_info_int(path, fields[4]);
+    *dd_idx = table_info_int(path, fields[5]);
+}
+
 /* Samplebanks */
 
 static int
 tablegen_samplebanks(const char *sb_hdr_out, const char **samplebanks_paths, int num_samplebank_files)
 {
-    // Read in all samplebank xml files
+    // Read in all samplebank xml or table info files
 
     samplebank *samplebanks = malloc(num_samplebank_files * sizeof(samplebank));
 
@@ -34,8 +123,13 @@ tablegen_samplebanks(const char *sb_hdr_out, const char **samplebanks_paths, int
         const char *path = samplebanks_paths[i];
         size_t pathlen = strlen(path);
 
+        if (str_endswith(path, pathlen, ".tblinfo")) {
+            read_samplebank_table_info(&samplebanks[i], path);
+            continue;
+        }
+
         if (!str_endswith(path, pathlen, ".xml"))
-            error("Not an xml file? (\"%s\")", path);
+            error("Not an xml or tblinfo file? (\"%s\")", path);
 
         xmlDocPtr document = xmlReadFile(path, NULL, XML_PARSE_NONET);
         if (document == NULL)
@@ -115,9 +209,7 @@ tablegen_samplebanks(const char *sb_hdr_out, const char **samplebanks_paths, int
 
     // Emit the table
 
-    FILE *out = fopen(sb_hdr_out, "w");
-    if (out == NULL)
-        error("Failed to open samplebank header output");
+    FILE *out = util_open_output(sb_hdr_out, "w");
 
     fprintf(out,
             // clang-format off
@@ -144,7 +236,7 @@ tablegen_samplebanks(const char *sb_hdr_out, const char **samplebanks_paths, int
         }
     }
 
-    fclose(out);
+    util_close_output(out, sb_hdr_out);
 
     free(index_info);
     free(samplebanks);
@@ -154,40 +246,32 @@ tablegen_samplebanks(const char *sb_hdr_out, const char **samplebanks_paths, int
 
 /* Soundfonts */
 
-static int
-validate_samplebank_index(soundfont *sf, samplebank *sb, int ptr_idx)
-{
-    if (ptr_idx != -1) {
-        // Validate pointer index
-        bool found = false;
-
-        for (size_t i = 0; i < sb->num_pointers; i++) {
-            if (ptr_idx == sb->pointer_indices[i]) {
-                found = true;
-                break;
-            }
-        }
-        if (!found)
-            warning("In Soundfont %s: Invalid pointer indirect %d for samplebank %s", sf->info.name, ptr_idx, sb->name);
-
-        return ptr_idx;
-    } else {
-        return sb->index;
-    }
-}
-
 static int
 tablegen_soundfonts(const char *sf_hdr_out, char **soundfonts_paths, int num_soundfont_files)
 {
     soundfont *soundfonts = malloc(num_soundfont_files * sizeof(soundfont));
+    int *normal_bank_indices = malloc(num_soundfont_files * sizeof(int));
+    int *dd_bank_indices = malloc(num_soundfont_files * sizeof(int));
     int max_index = 0;
 
     for (int i = 0; i < num_soundfont_files; i++) {
         char *path = soundfonts_paths[i];
         size_t pathlen = strlen(path);
+        soundfont *sf = &soundfonts[i];
+
+        if (str_endswith(path, pathlen, ".tblinfo")) {
+            read_soundfont_table_info(sf, &normal_bank_indices[i], &dd_bank_indices[i], path);
+
+            // Written next to the header, so the same replacement .tblinfo -> .h forms its include path
+            strcpy(&path[pathlen - 7], "h");
+
+            if (max_index < sf->info.index)
+                max_index = sf->info.index;
+            continue;
+        }
 
         if (!str_endswith(path, pathlen, ".xml"))
-            error("Not an xml file? (\"%s\")", path);
+            error("Not an xml or tblinfo file? (\"%s\")", path);
 
         xmlDocPtr document = xmlReadFile(path, NULL, XML_PARSE_NONET);
         if (document == NULL)
@@ -197,8 +281,6 @@ tablegen_soundfonts(const char *sf_hdr_out, char **soundfonts_paths, int num_sou
         if (!strequ(XMLSTR_TO_STR(root->name), "Soundfont"))
             error("Root node must be <Soundfont>");
 
-        soundfont *sf = &soundfonts[i];
-
         // Transform the xml path into a header include path
         // Assumption: replacing .xml -> .h forms a valid header include path
         path[pathlen - 3] = 'h';
@@ -206,6 +288,14 @@ tablegen_soundfonts(const char *sf_hdr_out, char **soundfonts_paths, int num_sou
 
         read_soundfont_info(sf, root);
 
+        // Resolve samplebank indices
+
+        normal_bank_indices[i] = sf_samplebank_index(sf, &sf->sb, sf->info.pointer_index);
+
+        dd_bank_indices[i] = 255;
+        if (sf->info.bank_path_dd != NULL)
+            dd_bank_indices[i] = sf_samplebank_index(sf, &sf->sbdd, sf->info.pointer_index_dd);
+
         if (max_index < sf->info.index)
             max_index = sf->info.index;
     }
@@ -221,22 +311,14 @@ tablegen_soundfonts(const char *sf_hdr_out, char **soundfonts_paths, int num_sou
     for (int i = 0; i < num_soundfont_files; i++) {
         soundfont *sf = &soundfonts[i];
 
-        // Resolve samplebank indices
-
-        int normal_idx = validate_samplebank_index(sf, &sf->sb, sf->info.pointer_index);
-
-        int dd_idx = 255;
-        if (sf->info.bank_path_dd != NULL)
-            dd_idx = validate_samplebank_index(sf, &sf->sbdd, sf->info.pointer_index_dd);
-
         // Add info
 
         if (finfo[sf->info.index].soundfont != NULL)
             error("Overlapping soundfont indices, saw index %u more than once", sf->info.index);
 
         finfo[sf->info.index].soundfont = &soundfonts[i];
-        finfo[sf->info.index].normal_bank_index = normal_idx;
-        finfo[sf->info.index].dd_bank_index = dd_idx;
+        finfo[sf->info.index].normal_bank_index = normal_bank_indices[i];
+        finfo[sf->info.index].dd_bank_index = dd_bank_indices[i];
         finfo[sf->info.index].name = soundfonts_paths[i];
     }
 
@@ -246,7 +328,7 @@ tablegen_soundfonts(const char *sf_hdr_out, char **soundfonts_paths, int num_sou
             error("No soundfont for index %d", i);
     }
 
-    FILE *out = fopen(sf_hdr_out, "w");
+    FILE *out = util_open_output(sf_hdr_out, "w");
 
     fprintf(out,
             // clang-format off
@@ -269,9 +351,11 @@ tablegen_soundfonts(const char *sf_hdr_out, char **soundfonts_paths, int num_sou
                 finfo[i].dd_bank_index, sf->info.index, sf->info.index, sf->info.index);
     }
 
-    fclose(out);
+    util_close_output(out, sf_hdr_out);
 
     free(soundfonts);
+    free(normal_bank_indices);
+    free(dd_bank_indices);
     free(finfo);
 
     return EXIT_SUCCESS;
@@ -554,9 +638,7 @@ tablegen_sequences(const char *seq_font_tbl_out, const char *seq_order_path, con
 
     // Write the sequence font table out
 
-    FILE *out = fopen(seq_font_tbl_out, "w");
-    if (out == NULL)
-        error("Failed to open output file \"%s\" for writing", seq_font_tbl_out);
+    FILE *out = util_open_output(seq_font_tbl_out, "w");
 
     fprintf(out,
             // clang-format off
@@ -588,7 +670,7 @@ tablegen_sequences(const char *seq_font_tbl_out, const char *seq_order_path, con
     }
     fprintf(out, ".balign 16\n");
 
-    fclose(out);
+    util_close_output(out, seq_font_tbl_out);
     free(final_seqdata);
     for (int i = 0; i < num_sequence_files; i++) {
         free(file_data[i].name);
@@ -609,8 +691,8 @@ usage(const char *progname)
             // clang-format off
            "%s: Generate code tables for audio data"                                                "\n"
            "Usage:"                                                                                 "\n"
-           "    %s --banks      <samplebank_table.h> <samplebank xml files...>"                     "\n"
-           "    %s --fonts      <soundfont_table.h> <soundfont xml files...>"                       "\n"
+           "    %s --banks      <samplebank_table.h> <samplebank xml or tblinfo files...>"          "\n"
+           "    %s --fonts      <soundfont_table.h> <soundfont xml or tblinfo files...>"            "\n"
            "    %s --sequences  <seq_font_table.s> <sequence_order.in> <sequence object files...>"  "\n",
             // clang-format on
             progname, progname, progname, progname);
@@ -0,0 +1,197 @@
+/* SPDX-FileCopyrightText: Copyright (C) 2024 ZeldaRET */
+/* SPDX-License-Identifier: CC0-1.0 */
+#include <ctype.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "util.h"
+
+typedef struct {
+    int argc;
+    char **argv; // argv[0] is the program name, like for main
+} batch_job;
+
+typedef struct {
+    batch_job *jobs;
+    size_t num_jobs;
+    size_t next_job;
+    int failed;
+    batch_main_func job_main;
+} batch_state;
+
+static char *
+batch_read_file(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        error("failed to open manifest '%s' for reading", path);
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *data = malloc(size + 1);
+    if (data == NULL)
+        error("could not allocate buffer for manifest '%s'", path);
+    if (size != 0 && fread(data, size, 1, file) != 1)
+        error("error reading from manifest '%s'", path);
+    data[size] = '\0';
+
+    fclose(file);
+    return data;
+}
+
+static batch_job *
+batch_read_manifest(const char *progname, const char *path, size_t *num_jobs_out)
+{
+    // The manifest buffer is never freed, the job arguments point into it
+    char *data = batch_read_file(path);
+    size_t jobs_cap = 64;
+    size_t num_jobs = 0;
+    batch_job *jobs = malloc(jobs_cap * sizeof(batch_job));
+
+    if (jobs == NULL)
+        error("could not allocate jobs for manifest '%s'", path);
+
+    char *line = data;
+    while (line != NULL && *line != '\0') {
+        char *line_end = strchr(line, '\n');
+        if (line_end != NULL)
+            *line_end++ = '\0';
+
+        // split the line at whitespace, one more argument for the NULL at the end of argv
+        size_t args_cap = 8;
+        int argc = 0;
+        char **argv = malloc(args_cap * sizeof(char *));
+        if (argv == NULL)
+            error("could not allocate arguments for manifest '%s'", path);
+        argv[argc++] = (char *)progname;
+
+        char *arg = line;
+        while (true) {
+            while (isspace((unsigned char)*arg))
+                arg++;
+            if (*arg == '\0' || (argc == 1 && *arg == '#'))
+                break;
+
+            if ((size_t)argc + 1 == args_cap) {
+                args_cap *= 2;
+                argv = realloc(argv, args_cap * sizeof(char *));
+                if (argv == NULL)
+                    error("could not allocate arguments for manifest '%s'", path);
+            }
+            argv[argc++] = arg;
+
+            while (*arg != '\0' && !isspace((unsigned char)*arg))
+                arg++;
+            if (*arg != '\0')
+                *arg++ = '\0';
+        }
+        argv[argc] = NULL;
+
+        if (argc > 1) {
+            if (num_jobs == jobs_cap) {
+                jobs_cap *= 2;
+                jobs = realloc(jobs, jobs_cap * sizeof(batch_job));
+                if (jobs == NULL)
+                    error("could not allocate jobs for manifest '%s'", path);
+            }
+            jobs[num_jobs].argc = argc;
+            jobs[num_jobs].argv = argv;
+            num_jobs++;
+        } else {
+            free(argv);
+        }
+
+        line = line_end;
+    }
+
+    *num_jobs_out = num_jobs;
+    return jobs;
+}
+
+static void *
+batch_worker(void *arg)
+{
+    batch_state *state = arg;
+
+    while (true) {
+        size_t job = __atomic_fetch_add(&state->next_job, 1, __ATOMIC_RELAXED);
+        if (job >= state->num_jobs)
+            break;
+
+        if (state->job_main(state->jobs[job].argc, state->jobs[job].argv) != EXIT_SUCCESS)
+            __atomic_store_n(&state->failed, 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+NORETURN static void
+batch_usage(const char *progname)
+{
+    fprintf(stderr, "Usage: %s --batch <manifest> [--jobs <n>]\n", progname);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Runs `job_main` for every job in the manifest named on the command line, see batch.h. Returns EXIT_FAILURE if any
+ * of the jobs did. A job that calls error() still ends the whole process, as it would end the make run anyway.
+ */
+int
+batch_main(int argc, char **argv, batch_main_func job_main)
+{
+    const char *manifest_path = NULL;
+    long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; i++) {
+        if (strequ(argv[i], "--batch") && i + 1 < argc && manifest_path == NULL) {
+            manifest_path = argv[++i];
+        } else if (strequ(argv[i], "--jobs") && i + 1 < argc) {
+            char *end;
+            num_threads = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || num_threads < 1) {
+                fprintf(stderr, "Bad job count \"%s\"\n", argv[i]);
+                batch_usage(argv[0]);
+            }
+        } else {
+            fprintf(stderr, "Unknown batch argument \"%s\"\n", argv[i]);
+            batch_usage(argv[0]);
+        }
+    }
+    if (manifest_path == NULL)
+        batch_usage(argv[0]);
+
+    batch_state state = { 0 };
+    state.jobs = batch_read_manifest(argv[0], manifest_path, &state.num_jobs);
+    state.job_main = job_main;
+
+    if (num_threads < 1)
+        num_threads = 1;
+    if ((size_t)num_threads > state.num_jobs)
+        num_threads = (state.num_jobs != 0) ? state.num_jobs : 1;
+
+    // the calling thread is one of the workers
+    pthread_t *threads = malloc((num_threads - 1) * sizeof(pthread_t) + 1);
+    if (threads == NULL)
+        error("could not allocate %ld threads", num_threads);
+
+    for (long i = 0; i < num_threads - 1; i++) {
+        if (pthread_create(&threads[i], NULL, batch_worker, &state) != 0)
+            error("could not start batch thread %ld", i);
+    }
+    batch_worker(&state);
+    for (long i = 0; i < num_threads - 1; i++)
+        pthread_join(threads[i], NULL);
+
+    free(threads);
+    for (size_t i = 0; i < state.num_jobs; i++)
+        free(state.jobs[i].argv);
+    free(state.jobs);
+
+    return state.failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
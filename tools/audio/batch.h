@@ -0,0 +1,19 @@
+/* SPDX-FileCopyrightText: Copyright (C) 2024 ZeldaRET */
+/* SPDX-License-Identifier: CC0-1.0 */
+#ifndef BATCH_H_
+#define BATCH_H_
+
+// Batch mode: one process runs the jobs listed in a manifest file, one job per line. Each line holds the arguments of
+// a single invocation of the tool, separated by whitespace, options such as --makedepend included. Empty lines and
+// lines starting with # are skipped.
+//
+//     <tool> --batch <manifest> [--jobs <n>]
+//
+// The jobs run on a pool of <n> threads, by default as many as there are CPUs.
+
+typedef int (*batch_main_func)(int argc, char **argv);
+
+int
+batch_main(int argc, char **argv, batch_main_func job_main);
+
+#endif
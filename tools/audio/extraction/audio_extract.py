@@ -4,7 +4,7 @@
 #   Extract audio files
 #
 
-import os, shutil, time
+import hashlib, multiprocessing, os, shutil, time
 from dataclasses import dataclass
 from multiprocessing.pool import ThreadPool
 from typing import Dict, List, Tuple, Union
@@ -14,7 +14,7 @@ from .audiotable import AudioTableData, AudioTableFile, AudioTableSample
 from .audiobank_file import AudiobankFile
 from .disassemble_sequence import CMD_SPEC, SequenceDisassembler, SequenceTableSpec, MMLVersion
 from .extraction_xml import ExtractionDescription, SampleBankExtractionDescription, SoundFontExtractionDescription, SequenceExtractionDescription
-from .util import align, incbin, program_get, XMLWriter
+from .util import align, incbin, program_get, write_if_changed, XMLWriter
 
 @dataclass
 class GameVersionInfo:
@@ -43,6 +43,10 @@ class GameVersionInfo:
 
 SAMPLECONV_PATH = f"{os.path.dirname(os.path.realpath(__file__))}/../sampleconv/sampleconv"
 
+# Per samplebank, the hash of the input of each decoded sample. Samples whose aifc and sampleconv binary are the same as
+# in the last extraction are not decoded and rewritten again.
+SAMPLE_HASHES_FILENAME = ".sample_hashes"
+
 BASEROM_DEBUG = False
 
 # ======================================================================================================================
@@ -114,15 +118,25 @@ def collect_soundfonts(audiobank_seg : memoryview, output_dir : str, version_inf
 
     return soundfonts
 
+def sample_decode_hash(sampleconv_hash, aifc_path : str):
+    with open(aifc_path, "rb") as infile:
+        return hashlib.sha1(sampleconv_hash + infile.read()).hexdigest()
+
+def read_sample_hashes(base_path : str) -> Dict[str, str]:
+    try:
+        with open(f"{base_path}/{SAMPLE_HASHES_FILENAME}", "r") as infile:
+            return dict(line.split() for line in infile if line.strip() != "")
+    except FileNotFoundError:
+        return {}
+
 def aifc_extract_one_sample(base_path : str, sample : AudioTableSample):
     aifc_path = f"{base_path}/aifc/{sample.filename}"
     ext_compressed = sample.codec_file_extension_compressed()
     ext_decompressed = sample.codec_file_extension_decompressed()
     wav_path = f"{base_path}/{sample.filename.replace(ext_compressed, ext_decompressed)}"
-    # export to AIFC
+    # export to AIFC, decoding to AIFF/WAV is left to the batch
     sample.to_file(aifc_path)
-    # decode to AIFF/WAV
-    program_get(f"{SAMPLECONV_PATH} --matching pcm16 {aifc_path} {wav_path}")
+    return aifc_path, wav_path
 
 def aifc_extract_one_bin(base_path : str, sample : AudioTableData):
     # export to BIN
@@ -134,7 +148,7 @@ def aifc_extract_one_bin(base_path : str, sample : AudioTableData):
         sample.to_file(f"{base_path}/{sample.filename}")
 
 def extract_samplebank(pool : ThreadPool, output_dir : str, sample_banks : List[Union[AudioTableFile, int]],
-                       bank : AudioTableFile, write_xml : bool):
+                       bank : AudioTableFile, write_xml : bool, sampleconv_hash : bytes):
     # deal with remaining gaps, have to blob them unless we can find an exact match in another bank
     bank.finalize_coverage(sample_banks)
     # assign names
@@ -143,8 +157,8 @@ def extract_samplebank(pool : ThreadPool, output_dir : str, sample_banks : List[
     base_path = f"{output_dir}/assets/audio/samples/{bank.name}"
 
     # write xml
-    with open(f"{output_dir}/assets/audio/samplebanks/{bank.file_name}.xml", "w") as outfile:
-        outfile.write(bank.to_xml(f"assets/audio/samples/{bank.name}"))
+    write_if_changed(f"{output_dir}/assets/audio/samplebanks/{bank.file_name}.xml",
+                     bank.to_xml(f"assets/audio/samples/{bank.name}"))
 
     # write the extraction xml if specified
     if write_xml:
@@ -163,18 +177,48 @@ def extract_samplebank(pool : ThreadPool, output_dir : str, sample_banks : List[
     for sample in bin_samples:
         aifc_extract_one_bin(base_path, sample)
 
-    # multiprocess aifc extraction + decompression
+    # multiprocess aifc extraction
     async_results = [pool.apply_async(aifc_extract_one_sample, args=(base_path, sample)) for sample in aifc_samples]
     # block until done
-    [res.get() for res in async_results]
+    paths = [res.get() for res in async_results]
+
+    # decode all samples that changed since the last extraction in a single sampleconv process, which spreads them
+    # over every core by itself
+    old_hashes = read_sample_hashes(base_path)
+    new_hashes = {}
+    manifest = []
+    for aifc_path, wav_path in paths:
+        wav_name = os.path.basename(wav_path)
+        new_hashes[wav_name] = sample_decode_hash(sampleconv_hash, aifc_path)
+        if old_hashes.get(wav_name) != new_hashes[wav_name] or not os.path.isfile(wav_path):
+            # the batch manifest is split on whitespace
+            assert not any(c.isspace() for c in aifc_path + wav_path), f"Whitespace in sample path {wav_path}"
+            manifest.append(f"--matching pcm16 {aifc_path} {wav_path}\n")
+
+    if len(manifest) != 0:
+        manifest_path = f"{base_path}/aifc/sampleconv_batch.txt"
+        with open(manifest_path, "w") as outfile:
+            outfile.writelines(manifest)
+        program_get(f"{SAMPLECONV_PATH} --batch {manifest_path} --jobs {os.cpu_count()}")
+
+    write_if_changed(f"{base_path}/{SAMPLE_HASHES_FILENAME}",
+                     "".join(f"{name} {digest}\n" for name,digest in sorted(new_hashes.items())))
 
     dt = time.time() - t_start
-    print(f"Samplebank {bank.name} extraction took {dt:.3f}s")
+    print(f"Samplebank {bank.name} extraction took {dt:.3f}s ({len(manifest)}/{len(paths)} samples decoded)")
 
     # drop aifc dir if not in debug mode
     if not BASEROM_DEBUG:
         shutil.rmtree(f"{base_path}/aifc")
 
+# What the sequence disassembly workers need, set before they are forked so that they inherit it instead of it being
+# pickled (the soundfonts can't be)
+disassembly_context = None
+
+def disassemble_sequence_job(index : int):
+    output_dir, version_info, soundfonts, enum_names, jobs = disassembly_context
+    disassemble_one_sequence(output_dir, version_info, soundfonts, enum_names, *jobs[index])
+
 def disassemble_one_sequence(output_dir : str, version_info : GameVersionInfo, soundfonts : List[AudiobankFile],
                              enum_names : List[str], id : int, data : bytes, name : str, filename : str,
                              fonts : memoryview):
@@ -188,6 +232,7 @@ def disassemble_one_sequence(output_dir : str, version_info : GameVersionInfo, s
 def extract_sequences(audioseq_seg : memoryview, output_dir : str, version_info : GameVersionInfo, write_xml : bool,
                       sequence_table : AudioCodeTable, sequence_font_table : memoryview,
                       sequence_descs : Dict[int, SequenceExtractionDescription], soundfonts : List[AudiobankFile]):
+    global disassembly_context
 
     sequence_font_table_cvg = [0] * len(sequence_font_table)
 
@@ -298,10 +343,16 @@ def extract_sequences(audioseq_seg : memoryview, output_dir : str, version_info
             assert fonts == fonts2, \
                    f"Font mismatch: Pointer {i} against Real {j}. This is a limitation of the build process."
 
-    # Disassemble to text
+    # Disassemble to text, the disassembler is pure python so only separate processes run it in parallel
 
-    for job in disas_jobs:
-        disassemble_one_sequence(output_dir, version_info, soundfonts, seq_enum_names, *job)
+    if len(disas_jobs) > 1 and "fork" in multiprocessing.get_all_start_methods():
+        disassembly_context = (output_dir, version_info, soundfonts, seq_enum_names, disas_jobs)
+        with multiprocessing.get_context("fork").Pool(processes=os.cpu_count()) as pool:
+            pool.map(disassemble_sequence_job, range(len(disas_jobs)))
+        disassembly_context = None
+    else:
+        for job in disas_jobs:
+            disassemble_one_sequence(output_dir, version_info, soundfonts, seq_enum_names, *job)
 
     dt = time.time() - t
     print(f"Sequences extraction took {dt:.3f}s")
@@ -417,10 +468,13 @@ def extract_audio_for_version(version_info : GameVersionInfo, output_dir : str,
     if write_xml:
         os.makedirs(f"assets/xml/audio/samplebanks", exist_ok=True)
 
+    with open(SAMPLECONV_PATH, "rb") as infile:
+        sampleconv_hash = hashlib.sha1(infile.read()).digest()
+
     with ThreadPool(processes=os.cpu_count()) as pool:
         for bank in sample_banks:
             if isinstance(bank, AudioTableFile):
-                extract_samplebank(pool, output_dir, sample_banks, bank, write_xml)
+                extract_samplebank(pool, output_dir, sample_banks, bank, write_xml, sampleconv_hash)
 
     # ==================================================================================================================
     # Extract soundfonts
@@ -441,8 +495,8 @@ def extract_audio_for_version(version_info : GameVersionInfo, output_dir : str,
         sf.finalize()
 
         # write the soundfont xml itself
-        with open(f"{output_dir}/assets/audio/soundfonts/{sf.file_name}.xml", "w") as outfile:
-            outfile.write(sf.to_xml(f"Soundfont_{i}", "assets/audio/samplebanks"))
+        write_if_changed(f"{output_dir}/assets/audio/soundfonts/{sf.file_name}.xml",
+                         sf.to_xml(f"Soundfont_{i}", "assets/audio/samplebanks"))
 
         # write the extraction xml if specified
         if write_xml:
@@ -46,12 +46,14 @@ OR any ldseq is an array and an array of 0 is a buffer (?)
 detect section overlaps and mark them as bugged in the output
 """
 
+import io
 from dataclasses import dataclass
 from enum import Enum, auto
 from typing import Callable, Dict, List, Optional, Tuple
 
 from .audiobank_file import AudiobankFile
 from .tuning import pitch_names
+from .util import write_if_changed
 
 #
 #   VERSIONS
@@ -1235,7 +1237,7 @@ class SequenceDisassembler:
     #
 
     def emit(self):
-        with open(self.outpath, "w") as outfile:
+        with io.StringIO() as outfile:
             # emit header
             outfile.write("#include \"aseq.h\"\n")
 
@@ -1266,6 +1268,8 @@ class SequenceDisassembler:
 
             outfile.write(f".endseq {self.seq_name}\n")
 
+            write_if_changed(self.outpath, outfile.getvalue())
+
 if __name__ == '__main__':
     import argparse
     parser = argparse.ArgumentParser(description="Disassemble a Zelda 64 sequence binary")
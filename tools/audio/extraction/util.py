@@ -89,6 +89,21 @@ def program_call(cmd):
 def program_get(cmd):
     return subprocess.check_output(cmd, shell=True).decode("ascii")
 
+def write_if_changed(path, contents):
+    """
+    Write contents (str or bytes) to path, unless the file already holds exactly that. Leaving unchanged files alone
+    keeps their timestamps, so re-extracting doesn't make everything that is built from them look out of date.
+    """
+    mode = "b" if isinstance(contents, (bytes, bytearray)) else ""
+    try:
+        with open(path, "r" + mode) as infile:
+            if infile.read() == contents:
+                return
+    except (FileNotFoundError, UnicodeDecodeError):
+        pass
+    with open(path, "w" + mode) as outfile:
+        outfile.write(contents)
+
 class XMLWriter:
     """
     Simple XML builder for writing with desired formatting characteristics (no tabs, 4 space indent)
@@ -7,7 +7,12 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "xml.h"
 #include "samplebank.h"
@@ -18,11 +23,7 @@ samplebank_path_forname(samplebank *sb, const char *name)
 {
     assert(name != NULL);
 
-    for (size_t i = 0; i < sb->num_samples; i++) {
-        if (strequ(sb->sample_names[i], name))
-            return sb->sample_paths[i];
-    }
-    return NULL;
+    return str_map_get(&sb->paths_by_name, name);
 }
 
 typedef struct {
@@ -122,4 +123,277 @@ read_samplebank_xml(samplebank *sb, xmlDocPtr doc)
 
     sb->num_samples = entries_len;
     sb->num_pointers = pointers_len;
+
+    // Names are looked up for every sample of every soundfont that uses the bank. If a name appears more than once the
+    // first entry wins, as it did when the arrays were searched in order.
+    str_map_init(&sb->paths_by_name);
+    for (size_t i = 0; i < sb->num_samples; i++)
+        str_map_insert(&sb->paths_by_name, sb->sample_names[i], (void *)sb->sample_paths[i]);
+}
+
+// Manifest
+
+// A samplebank as read from its xml, written by sbc --manifest next to its output so that sfc and atblgen don't parse
+// the xml again for every soundfont that uses the bank. It is only read by tools built on the same machine, so it is
+// in host byte order. The header is followed by the pointer indices, the entries and the strings, which are all NUL
+// terminated and referred to by their offset.
+
+#define SAMPLEBANK_MANIFEST_MAGIC   0x4D425353 // "SSBM"
+#define SAMPLEBANK_MANIFEST_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t xml_hash; // of the xml the manifest was written for, a manifest for another xml is not used
+    int32_t index;
+    uint32_t buffer_bug;
+    uint32_t name;
+    uint32_t medium;
+    uint32_t cache_policy;
+    uint32_t num_pointers;
+    uint32_t num_samples;
+    uint32_t strings_size;
+} samplebank_manifest_header;
+
+typedef struct {
+    uint32_t name;
+    uint32_t path;
+    uint32_t is_sample;
+} samplebank_manifest_entry;
+
+// FNV-1a
+static uint64_t
+samplebank_xml_hash(const void *data, size_t size)
+{
+    const uint8_t *bytes = data;
+    uint64_t hash = 0xCBF29CE484222325;
+
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 0x100000001B3;
+    return hash;
+}
+
+/**
+ * Where sbc writes the manifest of the samplebank xml at `xml_path` for the other tools to find: next to it, with the
+ * extension .sbm in place of .xml. Returns a malloc'd string.
+ */
+char *
+samplebank_manifest_path(const char *xml_path)
+{
+    size_t len = strlen(xml_path);
+    char *path = malloc(len + sizeof(".sbm"));
+
+    if (path == NULL)
+        error("out of memory");
+    strcpy(path, xml_path);
+    if (str_endswith(path, len, ".xml"))
+        path[len - 4] = '\0';
+    strcat(path, ".sbm");
+    return path;
+}
+
+static uint32_t
+manifest_add_string(char **strings, size_t *size, size_t *cap, const char *str)
+{
+    size_t len = strlen(str) + 1;
+    uint32_t offset = *size;
+
+    while (*size + len > *cap) {
+        *cap *= 2;
+        *strings = realloc(*strings, *cap);
+        if (*strings == NULL)
+            error("out of memory");
+    }
+    memcpy(*strings + offset, str, len);
+    *size += len;
+    return offset;
+}
+
+/**
+ * Writes the manifest of `sb`, as read from the xml file contents `xml_data`, to `path`. The file is left untouched if
+ * it already holds the same manifest.
+ */
+void
+write_samplebank_manifest(samplebank *sb, const char *path, const void *xml_data, size_t xml_size)
+{
+    samplebank_manifest_header header;
+    samplebank_manifest_entry *entries = malloc(sb->num_samples * sizeof(samplebank_manifest_entry) + 1);
+    size_t strings_cap = 4096;
+    size_t strings_size = 0;
+    char *strings = malloc(strings_cap);
+
+    if (entries == NULL || strings == NULL)
+        error("out of memory");
+
+    header.magic = SAMPLEBANK_MANIFEST_MAGIC;
+    header.version = SAMPLEBANK_MANIFEST_VERSION;
+    header.xml_hash = samplebank_xml_hash(xml_data, xml_size);
+    header.index = sb->index;
+    header.buffer_bug = sb->buffer_bug;
+    header.name = manifest_add_string(&strings, &strings_size, &strings_cap, sb->name);
+    header.medium = manifest_add_string(&strings, &strings_size, &strings_cap, sb->medium);
+    header.cache_policy = manifest_add_string(&strings, &strings_size, &strings_cap, sb->cache_policy);
+    header.num_pointers = sb->num_pointers;
+    header.num_samples = sb->num_samples;
+
+    for (size_t i = 0; i < sb->num_samples; i++) {
+        entries[i].name = manifest_add_string(&strings, &strings_size, &strings_cap, sb->sample_names[i]);
+        entries[i].path = manifest_add_string(&strings, &strings_size, &strings_cap, sb->sample_paths[i]);
+        entries[i].is_sample = sb->is_sample[i];
+    }
+    header.strings_size = strings_size;
+
+    FILE *out = util_open_output(path, "wb");
+    fwrite(&header, sizeof(header), 1, out);
+    for (size_t i = 0; i < sb->num_pointers; i++) {
+        int32_t ptr_index = sb->pointer_indices[i];
+        fwrite(&ptr_index, sizeof(ptr_index), 1, out);
+    }
+    fwrite(entries, sizeof(samplebank_manifest_entry), sb->num_samples, out);
+    fwrite(strings, 1, strings_size, out);
+    util_close_output(out, path);
+
+    free(entries);
+    free(strings);
+}
+
+/**
+ * Reads `sb` from the manifest at `path` instead of parsing its xml, whose contents are `xml_data`. Returns false if
+ * there is no manifest, or it is not one for this xml. The manifest is mapped for as long as the process runs, the
+ * strings of `sb` point into it.
+ */
+bool
+read_samplebank_manifest(samplebank *sb, const char *path, const void *xml_data, size_t xml_size)
+{
+    FILE *in = fopen(path, "rb");
+    struct stat st;
+    const samplebank_manifest_header *header;
+    const samplebank_manifest_entry *entries;
+    const int32_t *pointers;
+    const char *strings;
+    size_t size;
+
+    if (in == NULL)
+        return false;
+    if (fstat(fileno(in), &st) != 0 || (size_t)st.st_size < sizeof(samplebank_manifest_header)) {
+        fclose(in);
+        return false;
+    }
+    size = st.st_size;
+
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(in), 0);
+    fclose(in);
+    if (map == MAP_FAILED)
+        return false;
+
+    header = map;
+    pointers = (const int32_t *)(header + 1);
+    entries = (const samplebank_manifest_entry *)(pointers + header->num_pointers);
+    strings = (const char *)(entries + header->num_samples);
+
+    // Anything else is from another version of sbc, or for another xml, and the xml is parsed instead
+    if (header->magic != SAMPLEBANK_MANIFEST_MAGIC || header->version != SAMPLEBANK_MANIFEST_VERSION ||
+        header->xml_hash != samplebank_xml_hash(xml_data, xml_size) || header->strings_size == 0 ||
+        size != sizeof(*header) + header->num_pointers * sizeof(int32_t) +
+                    header->num_samples * sizeof(samplebank_manifest_entry) + header->strings_size ||
+        strings[header->strings_size - 1] != '\0') {
+        munmap(map, size);
+        return false;
+    }
+
+    sb->name = &strings[header->name];
+    sb->index = header->index;
+    sb->medium = &strings[header->medium];
+    sb->cache_policy = &strings[header->cache_policy];
+    sb->buffer_bug = header->buffer_bug;
+
+    sb->num_pointers = header->num_pointers;
+    sb->pointer_indices = malloc(sb->num_pointers * sizeof(int) + 1);
+    for (size_t i = 0; i < sb->num_pointers; i++)
+        sb->pointer_indices[i] = pointers[i];
+
+    sb->num_samples = header->num_samples;
+    sb->sample_names = malloc(sb->num_samples * sizeof(const char *) + 1);
+    sb->sample_paths = malloc(sb->num_samples * sizeof(const char *) + 1);
+    sb->is_sample = malloc(sb->num_samples * sizeof(bool) + 1);
+    if (sb->pointer_indices == NULL || sb->sample_names == NULL || sb->sample_paths == NULL || sb->is_sample == NULL)
+        error("out of memory");
+
+    str_map_init(&sb->paths_by_name);
+    for (size_t i = 0; i < sb->num_samples; i++) {
+        sb->sample_names[i] = &strings[entries[i].name];
+        sb->sample_paths[i] = &strings[entries[i].path];
+        sb->is_sample[i] = entries[i].is_sample;
+        // the first entry wins, as in read_samplebank_xml
+        str_map_insert(&sb->paths_by_name, sb->sample_names[i], (void *)sb->sample_paths[i]);
+    }
+    return true;
+}
+
+typedef struct samplebank_cache_entry {
+    const char *path;
+    samplebank sb;
+    struct samplebank_cache_entry *next;
+} samplebank_cache_entry;
+
+static samplebank_cache_entry *samplebank_cache;
+static pthread_mutex_t samplebank_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Like read_samplebank_xml for the xml file at `path`, but every file is only read and parsed once per process.
+ * Returns false if the file could not be read. In batch mode, sfc reads the same few samplebanks for every soundfont.
+ * If sbc wrote a manifest for the xml as it is, the samplebank is read from that and the xml is not parsed at all.
+ */
+bool
+read_samplebank_xml_cached(samplebank *sb, const char *path)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&samplebank_cache_lock);
+
+    LL_FOREACH(samplebank_cache_entry *, entry, samplebank_cache) {
+        if (strequ(entry->path, path)) {
+            *sb = entry->sb;
+            found = true;
+            break;
+        }
+    }
+
+    if (!found && access(path, R_OK) == 0) {
+        size_t xml_size;
+        void *xml_data = util_read_whole_file(path, &xml_size);
+        char *manifest_path = samplebank_manifest_path(path);
+        samplebank_cache_entry *entry = malloc(sizeof(samplebank_cache_entry));
+        if (entry == NULL)
+            error("Could not allocate samplebank cache entry");
+
+        if (read_samplebank_manifest(&entry->sb, manifest_path, xml_data, xml_size)) {
+            entry->sb.path = manifest_path;
+            found = true;
+        } else {
+            free(manifest_path);
+
+            // The document is kept for as long as the process runs, like in the single file case
+            xmlDocPtr doc = xmlReadMemory(xml_data, xml_size, path, NULL, XML_PARSE_NONET);
+            if (doc != NULL) {
+                read_samplebank_xml(&entry->sb, doc);
+                entry->sb.path = strdup(path);
+                found = true;
+            }
+        }
+        free(xml_data);
+
+        if (found) {
+            entry->path = strdup(path);
+            entry->next = samplebank_cache;
+            samplebank_cache = entry;
+
+            *sb = entry->sb;
+        } else {
+            free(entry);
+        }
+    }
+
+    pthread_mutex_unlock(&samplebank_cache_lock);
+    return found;
 }
@@ -10,6 +10,7 @@
 #define SAMPLEBANK_H_
 
 #include "xml.h"
+#include "util.h"
 
 typedef struct {
     const char *name;
@@ -22,9 +23,13 @@ typedef struct {
     const char **sample_paths;
     const char **sample_names;
     bool *is_sample;
+    str_map paths_by_name;
 
     size_t num_pointers;
     int *pointer_indices;
+
+    // The file read_samplebank_xml_cached read the samplebank from, its xml or the manifest sbc wrote for it
+    const char *path;
 } samplebank;
 
 const char *
@@ -33,4 +38,16 @@ samplebank_path_forname(samplebank *sb, const char *name);
 void
 read_samplebank_xml(samplebank *sb, xmlDocPtr doc);
 
+bool
+read_samplebank_xml_cached(samplebank *sb, const char *path);
+
+char *
+samplebank_manifest_path(const char *xml_path);
+
+void
+write_samplebank_manifest(samplebank *sb, const char *path, const void *xml_data, size_t xml_size);
+
+bool
+read_samplebank_manifest(samplebank *sb, const char *path, const void *xml_data, size_t xml_size);
+
 #endif
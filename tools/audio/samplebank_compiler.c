@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "batch.h"
 #include "xml.h"
 #include "aifc.h"
 #include "samplebank.h"
@@ -19,19 +20,26 @@
 NORETURN static void
 usage(const char *progname)
 {
-    fprintf(stderr, "Usage: %s [--matching] [--makedepend <out.d>] <in.xml> <out.s>\n", progname);
+    fprintf(stderr,
+            "Usage: %s [--matching] [--makedepend <out.d>] [--table-info <out.tblinfo>] [--manifest <out.sbm>] "
+            "<in.xml> <out.s>\n",
+            progname);
+    fprintf(stderr, "       %s --batch <manifest> [--jobs <n>]\n", progname);
     exit(EXIT_FAILURE);
 }
 
-int
-main(int argc, char **argv)
+static int
+sbc_main(int argc, char **argv)
 {
-    static uint8_t match_buf[BUG_BUF_SIZE];
     const char *filename = NULL;
     xmlDocPtr document;
     const char *outfilename = NULL;
     const char *mdfilename = NULL;
-    FILE *mdfile;
+    FILE *mdfile = NULL;
+    const char *infofilename = NULL;
+    const char *manifestfilename = NULL;
+    void *xml_data;
+    size_t xml_size;
     FILE *outf;
     samplebank sb;
     uint8_t *match_buf_ptr;
@@ -67,6 +75,24 @@ main(int argc, char **argv)
                 mdfilename = argv[++i];
                 continue;
             }
+            if (strequ(argv[i], "--table-info")) {
+                if (infofilename != NULL)
+                    arg_error("Received --table-info option twice");
+                if (i + 1 == argc)
+                    arg_error("--table-info missing required argument");
+
+                infofilename = argv[++i];
+                continue;
+            }
+            if (strequ(argv[i], "--manifest")) {
+                if (manifestfilename != NULL)
+                    arg_error("Received --manifest option twice");
+                if (i + 1 == argc)
+                    arg_error("--manifest missing required argument");
+
+                manifestfilename = argv[++i];
+                continue;
+            }
             arg_error("Unknown option \"%s\"", argv[i]);
         } else {
             // Required args
@@ -90,8 +116,9 @@ main(int argc, char **argv)
 
 #undef arg_error
 
-    // open xml
-    document = xmlReadFile(filename, NULL, XML_PARSE_NONET);
+    // open xml, the manifest is tied to its contents
+    xml_data = util_read_whole_file(filename, &xml_size);
+    document = xmlReadMemory(xml_data, xml_size, filename, NULL, XML_PARSE_NONET);
     if (document == NULL)
         return EXIT_FAILURE;
 
@@ -109,9 +136,31 @@ main(int argc, char **argv)
         if (mdfile == NULL)
             error("Unable to open dependency file [%s] for writing", mdfilename);
 
-        fprintf(mdfile, "%s: \\\n    %s", outfilename, filename);
+        fputs(outfilename, mdfile);
+        if (infofilename != NULL)
+            fprintf(mdfile, " %s", infofilename);
+        if (manifestfilename != NULL)
+            fprintf(mdfile, " %s", manifestfilename);
+        fprintf(mdfile, ": \\\n    %s", filename);
     }
 
+    // write the summary atblgen builds the samplebank table from, so that it does not need to parse the xml
+    if (infofilename != NULL) {
+        FILE *infof = fopen(infofilename, "w");
+        if (infof == NULL)
+            error("Unable to open table info file [%s] for writing", infofilename);
+
+        fprintf(infof, "samplebank %s %d %s %s", sb.name, sb.index, sb.medium, sb.cache_policy);
+        for (size_t i = 0; i < sb.num_pointers; i++)
+            fprintf(infof, " %d", sb.pointer_indices[i]);
+        fputs("\n", infof);
+        fclose(infof);
+    }
+
+    // write the samplebank as read from the xml for sfc and atblgen, see samplebank_manifest_path
+    if (manifestfilename != NULL)
+        write_samplebank_manifest(&sb, manifestfilename, xml_data, xml_size);
+
     // write output
 
     fprintf(outf,
@@ -125,8 +174,11 @@ main(int argc, char **argv)
             // clang-format on
             sb.name, sb.name);
 
-    // original tool appears to have a buffer clearing bug involving a buffer sized BUG_BUF_SIZE
-    match_buf_ptr = (matching && sb.buffer_bug) ? match_buf : NULL;
+    // original tool appears to have a buffer clearing bug involving a buffer sized BUG_BUF_SIZE, every samplebank
+    // starts out with a clear one
+    match_buf_ptr = (matching && sb.buffer_bug) ? calloc(BUG_BUF_SIZE, 1) : NULL;
+    if (matching && sb.buffer_bug && match_buf_ptr == NULL)
+        error("Unable to allocate match buffer");
     match_buf_pos = 0;
 
     for (size_t i = 0; i < sb.num_samples; i++) {
@@ -199,6 +251,18 @@ main(int argc, char **argv)
             sb.name, sb.name);
 
     fclose(outf);
+    free(match_buf_ptr);
     xmlFreeDoc(document);
+    free(xml_data);
     return EXIT_SUCCESS;
 }
+
+int
+main(int argc, char **argv)
+{
+    xmlInitParser();
+
+    if (argc > 1 && strequ(argv[1], "--batch"))
+        return batch_main(argc, argv, sbc_main);
+    return sbc_main(argc, argv);
+}
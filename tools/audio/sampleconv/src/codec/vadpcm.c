@@ -13,6 +13,7 @@
 #include "../util.h"
 
 #include "codec.h"
+#include "vadpcm_order2.h"
 
 /**
  * Creates FIR filter matrices for each page of the prediction codebook.
@@ -103,13 +104,102 @@ destroy_expanded_codebook(int32_t ***table, int npredictors)
     return 0;
 }
 
+/**
+ * The predictor search evaluates PREDICTOR_LANES codebook pages at once, in the lanes of a vector. gcc and clang lower
+ * these to SSE2 or NEON, or to scalar code where neither is available.
+ */
+#define PREDICTOR_LANES       4
+#define VADPCM_MAX_PREDICTORS 16 // the frame header has 4 bits for the predictor
+
+typedef int32_t v4i32 __attribute__((vector_size(PREDICTOR_LANES * sizeof(int32_t))));
+typedef float v4f32 __attribute__((vector_size(PREDICTOR_LANES * sizeof(float))));
+
+typedef struct {
+    int32_t order;
+    int32_t npredictors;
+    // coef[g][i][j] holds coef_tbl[PREDICTOR_LANES * g + lane][i][j] in each lane, zero past `order + i` and for the
+    // lanes past `npredictors`
+    v4i32 coef[VADPCM_MAX_PREDICTORS / PREDICTOR_LANES][8][16];
+} predictor_lanes;
+
+/**
+ * Transposes the FIR filter matrices created by expand_codebook so that the same coefficient of consecutive pages is
+ * adjacent, for predictor_errors.
+ */
+static void
+expand_predictor_lanes(predictor_lanes *lanes, int32_t ***coef_tbl, int32_t order, int32_t npredictors)
+{
+    if (npredictors > VADPCM_MAX_PREDICTORS)
+        error("Too many predictors: %d, at most %d are supported", npredictors, VADPCM_MAX_PREDICTORS);
+    if (order + 8 > 16)
+        error("Predictor order too high: %d, at most 8 is supported", order);
+
+    memset(lanes, 0, sizeof(*lanes));
+    lanes->order = order;
+    lanes->npredictors = npredictors;
+
+    for (int32_t k = 0; k < npredictors; k++) {
+        for (int32_t i = 0; i < 8; i++) {
+            for (int32_t j = 0; j < order + i; j++)
+                lanes->coef[k / PREDICTOR_LANES][i][j][k % PREDICTOR_LANES] = coef_tbl[k][i][j];
+        }
+    }
+}
+
+/**
+ * The predictor search of the encoders: predicts the 16 samples in `in_buf` with every codebook page from the last
+ * `order` samples of `state` and the unquantized errors so far, and stores the sum of the squared errors for each page
+ * to `se_out`. Gives the same results as running inner_product for one page after the other.
+ */
+static void
+predictor_errors(const predictor_lanes *lanes, const int32_t *state, const int32_t *in_buf, float *se_out)
+{
+    int32_t order = lanes->order;
+
+    for (int32_t g = 0; g * PREDICTOR_LANES < lanes->npredictors; g++) {
+        v4i32 in_vec[16];
+        v4f32 se = { 0 };
+
+        for (int32_t j = 0; j < 2; j++) {
+            // Copy over the last 'order' samples from the previous output, or from the first 8 input samples.
+            for (int32_t i = 0; i < order; i++)
+                in_vec[i] = (v4i32){ 0 } + ((j == 0) ? state[16 - order + i] : in_buf[8 - order + i]);
+
+            for (int32_t i = 0; i < 8; i++) {
+                const v4i32 *coef = lanes->coef[g][i];
+                v4i32 out = { 0 };
+
+                for (int32_t m = 0; m < order + i; m++)
+                    out += coef[m] * in_vec[m];
+
+                // "out / 2^11" rounded down, like inner_product
+                in_vec[i + order] = in_buf[j * 8 + i] - (out >> 11);
+
+                v4f32 e = __builtin_convertvector(in_vec[i + order], v4f32);
+                se += e * e;
+            }
+        }
+
+        for (int32_t lane = 0; lane < PREDICTOR_LANES && g * PREDICTOR_LANES + lane < lanes->npredictors; lane++)
+            se_out[g * PREDICTOR_LANES + lane] = se[lane];
+    }
+}
+
+// Per thread and restarted for every sample, so that batch mode decodes every sample like a process of its own would
+static _Thread_local uint64_t myrand_state;
+
+static void
+myrand_reset(void)
+{
+    myrand_state = 1619236481962341ull;
+}
+
 static uint32_t
 myrand(void)
 {
-    static uint64_t state = 1619236481962341ull;
-    state *= 3123692312237ull;
-    state++;
-    return state >> 33;
+    myrand_state *= 3123692312237ull;
+    myrand_state++;
+    return myrand_state >> 33;
 }
 
 static int16_t
@@ -252,7 +342,7 @@ vdecodeframe(uint8_t *frame, int32_t *prescaled, int32_t *state, int32_t order,
  */
 static void
 my_encodeframe(uint8_t *out, int16_t *in_buf, int32_t *orig_state, int32_t ***coef_tbl, int32_t order,
-               int32_t npredictors, int frame_size)
+               const predictor_lanes *lanes, int frame_size)
 {
     int16_t ix[16];
     int32_t prediction[16];
@@ -264,39 +354,22 @@ my_encodeframe(uint8_t *out, int16_t *in_buf, int32_t *orig_state, int32_t ***co
     int32_t ulevel = -llevel - 1;
     int32_t ie[16];
     float e[16];
+    float errs[VADPCM_MAX_PREDICTORS];
 
     // Determine the best-fitting predictor.
     float min = 1e30;
     int32_t scale_factor = 16 - encBits;
 
-    for (int32_t k = 0; k < npredictors; k++) {
-        for (int32_t j = 0; j < 2; j++) {
-            // Copy over the last 'order' samples from the previous output.
-            for (int32_t i = 0; i < order; i++)
-                in_vec[i] = (j == 0) ? orig_state[16 - order + i] : in_buf[8 - order + i];
-
-            // For 8 samples...
-            for (int32_t i = 0; i < 8; i++) {
-                // Compute a prediction based on 'order' values from the old state,
-                // plus previous errors in this chunk, as an inner product with the
-                // coefficient table.
-                prediction[j * 8 + i] = inner_product(order + i, coef_tbl[k][i], in_vec);
-                // Record the error in in_vec (thus, its first 'order' samples
-                // will contain actual values, the rest will be error terms), and
-                // in floating point form in e (for no particularly good reason).
-                in_vec[i + order] = in_buf[j * 8 + i] - prediction[j * 8 + i];
-                e[j * 8 + i] = (float)in_vec[i + order];
-            }
-        }
+    for (int32_t i = 0; i < 16; i++)
+        in_vec[i] = in_buf[i];
 
-        // Compute the L2 norm of the errors; the lowest norm decides which
-        // predictor to use.
-        float se = 0.0f;
-        for (int32_t j = 0; j < 16; j++)
-            se += e[j] * e[j];
+    // Compute the L2 norm of the errors for every predictor; the lowest norm
+    // decides which predictor to use.
+    predictor_errors(lanes, orig_state, in_vec, errs);
 
-        if (se < min) {
-            min = se;
+    for (int32_t k = 0; k < lanes->npredictors; k++) {
+        if (errs[k] < min) {
+            min = errs[k];
             optimalp = k;
         }
     }
@@ -451,8 +524,8 @@ permute(int32_t *out, int32_t *in, int32_t *prescaled, int32_t scale, int frame_
  * Like vencodeframe/my_encodeframe but assigns a score to the output for informing brute-force decoding
  */
 static int64_t
-scored_encode(int32_t *in_buf, int32_t *orig_state, int32_t ***coef_tbl, int32_t order, int32_t npredictors,
-              int32_t wanted_predictor, int32_t wanted_scale, int32_t wanted_ix[16], int frame_size)
+scored_encode(int32_t *in_buf, int32_t *orig_state, int32_t ***coef_tbl, int32_t order,
+              const predictor_lanes *lanes, int32_t wanted_predictor, int32_t wanted_scale, int32_t wanted_ix[16], int frame_size)
 {
     int32_t prediction[16];
     int32_t in_vec[16];
@@ -463,7 +536,7 @@ scored_encode(int32_t *in_buf, int32_t *orig_state, int32_t ***coef_tbl, int32_t
     int32_t ulevel = -llevel - 1;
     int32_t ie[16];
     float e[16];
-    float errs[4];
+    float errs[VADPCM_MAX_PREDICTORS];
 
     // Determine the best-fitting predictor.
     float min = 1e30;
@@ -471,41 +544,18 @@ scored_encode(int32_t *in_buf, int32_t *orig_state, int32_t ***coef_tbl, int32_t
 
     int64_t scoreA = 0, scoreB = 0, scoreC = 0;
 
-    for (int32_t k = 0; k < npredictors; k++) {
-        for (int32_t j = 0; j < 2; j++) {
-            // Copy over the last 'order' samples from the previous output.
-            for (int32_t i = 0; i < order; i++)
-                in_vec[i] = (j == 0) ? orig_state[16 - order + i] : in_buf[8 - order + i];
-
-            // For 8 samples...
-            for (int32_t i = 0; i < 8; i++) {
-                // Compute a prediction based on 'order' values from the old state,
-                // plus previous errors in this chunk, as an inner product with the
-                // coefficient table.
-                prediction[j * 8 + i] = inner_product(order + i, coef_tbl[k][i], in_vec);
-                // Record the error in in_vec (thus, its first 'order' samples
-                // will contain actual values, the rest will be error terms), and
-                // in floating point form in e (for no particularly good reason).
-                in_vec[i + order] = in_buf[j * 8 + i] - prediction[j * 8 + i];
-                e[j * 8 + i] = (float)in_vec[i + order];
-            }
-        }
-
-        // Compute the L2 norm of the errors; the lowest norm decides which
-        // predictor to use.
-        float se = 0.0f;
-        for (int32_t j = 0; j < 16; j++)
-            se += e[j] * e[j];
-
-        errs[k] = se;
+    // Compute the L2 norm of the errors for every predictor; the lowest norm
+    // decides which predictor to use.
+    predictor_errors(lanes, orig_state, in_buf, errs);
 
-        if (se < min) {
-            min = se;
+    for (int32_t k = 0; k < lanes->npredictors; k++) {
+        if (errs[k] < min) {
+            min = errs[k];
             optimalp = k;
         }
     }
 
-    for (int32_t k = 0; k < npredictors; k++) {
+    for (int32_t k = 0; k < lanes->npredictors; k++) {
         if (errs[k] < errs[wanted_predictor])
             scoreA += (int64_t)(errs[wanted_predictor] - errs[k]);
     }
@@ -656,12 +706,12 @@ scored_encode(int32_t *in_buf, int32_t *orig_state, int32_t ***coef_tbl, int32_t
 
 static bool
 descent(int32_t guess[16], int32_t min_vals[16], int32_t max_vals[16], int32_t prev_state[16], int32_t ***coef_tbl,
-        int32_t order, int32_t npredictors, int32_t wanted_predictor, int32_t wanted_scale, int32_t wanted_ix[16],
+        int32_t order, const predictor_lanes *lanes, int32_t wanted_predictor, int32_t wanted_scale, int32_t wanted_ix[16],
         int frame_size)
 {
     const double inf = 1e100;
 
-    int64_t curScore = scored_encode(guess, prev_state, coef_tbl, order, npredictors, wanted_predictor, wanted_scale,
+    int64_t curScore = scored_encode(guess, prev_state, coef_tbl, order, lanes, wanted_predictor, wanted_scale,
                                      wanted_ix, frame_size);
 
     while (true) {
@@ -674,10 +724,10 @@ descent(int32_t guess[16], int32_t min_vals[16], int32_t max_vals[16], int32_t p
         double maxMove = inf;
         for (int32_t i = 0; i < 16; i++) {
             guess[i]++;
-            int64_t scoreUp = scored_encode(guess, prev_state, coef_tbl, order, npredictors, wanted_predictor,
+            int64_t scoreUp = scored_encode(guess, prev_state, coef_tbl, order, lanes, wanted_predictor,
                                             wanted_scale, wanted_ix, frame_size);
             guess[i] -= 2;
-            int64_t scoreDown = scored_encode(guess, prev_state, coef_tbl, order, npredictors, wanted_predictor,
+            int64_t scoreDown = scored_encode(guess, prev_state, coef_tbl, order, lanes, wanted_predictor,
                                               wanted_scale, wanted_ix, frame_size);
             guess[i]++;
 
@@ -718,7 +768,7 @@ descent(int32_t guess[16], int32_t min_vals[16], int32_t max_vals[16], int32_t p
             if (!changed)
                 break;
 
-            int64_t score = scored_encode(nguess, prev_state, coef_tbl, order, npredictors, wanted_predictor,
+            int64_t score = scored_encode(nguess, prev_state, coef_tbl, order, lanes, wanted_predictor,
                                           wanted_scale, wanted_ix, frame_size);
             if (score < bestScore) {
                 bestScore = score;
@@ -766,7 +816,7 @@ get_bounds(int32_t *in, int32_t *prescaled, int32_t scale, int32_t *min_vals, in
 
 static int32_t
 bruteforce(int32_t guess[16], uint8_t input[9], int32_t decoded[16], int32_t prescaled[16], int32_t prev_state[16],
-           int32_t ***coef_tbl, int32_t order, int32_t npredictors, int frame_size)
+           int32_t ***coef_tbl, int32_t order, const predictor_lanes *lanes, int frame_size)
 {
     int32_t scale = (input[0] >> 4) & 0xF;
     int32_t predictor = (input[0] >> 0) & 0xF;
@@ -784,7 +834,7 @@ bruteforce(int32_t guess[16], uint8_t input[9], int32_t decoded[16], int32_t pre
             permute(guess, decoded, prescaled, 1 << scale, frame_size);
 
             int64_t score =
-                scored_encode(guess, prev_state, coef_tbl, order, npredictors, predictor, scale, prescaled, frame_size);
+                scored_encode(guess, prev_state, coef_tbl, order, lanes, predictor, scale, prescaled, frame_size);
             if (score == 0)
                 return true;
 
@@ -796,7 +846,7 @@ bruteforce(int32_t guess[16], uint8_t input[9], int32_t decoded[16], int32_t pre
 
         memcpy(guess, bestGuess, sizeof(bestGuess));
 
-        if (descent(guess, min_vals, max_vals, prev_state, coef_tbl, order, npredictors, predictor, scale, prescaled,
+        if (descent(guess, min_vals, max_vals, prev_state, coef_tbl, order, lanes, predictor, scale, prescaled,
                     frame_size))
             return true;
 
@@ -810,61 +860,32 @@ bruteforce(int32_t guess[16], uint8_t input[9], int32_t decoded[16], int32_t pre
  * vadpcm encoder used when encoding data
  */
 static void
-vencodeframe(uint8_t *out_buf, int16_t *in_buf, int32_t *state, int32_t ***coef_tbl, int32_t order, int32_t npredictors,
-             int frame_size)
+vencodeframe(uint8_t *out_buf, int16_t *in_buf, int32_t *state, int32_t ***coef_tbl, int32_t order,
+             const predictor_lanes *lanes, int frame_size)
 {
     int32_t in_vec[16];
     int32_t prediction[16];
     int32_t optimalp;
     float e[16];
+    float errs[VADPCM_MAX_PREDICTORS];
     float se;
     float min = 1e30;
     int32_t i;
-    int32_t j;
     int32_t k;
 
     // Determine the best-fitting predictor.
 
-    optimalp = 0;
-    for (k = 0; k < npredictors; k++) {
-        // Copy over the last 'order' samples from the previous output.
-        for (i = 0; i < order; i++)
-            in_vec[i] = state[16 - order + i];
-
-        // For 8 samples...
-        for (i = 0; i < 8; i++) {
-            // Compute a prediction based on 'order' values from the old state,
-            // plus previous *quantized* errors in this chunk (because that's
-            // all the decoder will have available).
-            prediction[i] = inner_product(order + i, coef_tbl[k][i], in_vec);
-
-            // Record the error in in_vec (thus, its first 'order' samples
-            // will contain actual values, the rest will be error terms), and
-            // in floating point form in e (for no particularly good reason).
-            in_vec[i + order] = in_buf[i] - prediction[i];
-            e[i] = (float)in_vec[i + order];
-        }
-
-        // For the next 8 samples, start with 'order' values from the end of
-        // the previous 8-sample chunk of in_buf. (The code is equivalent to
-        // in_vec[i] = in_buf[8 - order + i].)
-        for (i = 0; i < order; i++)
-            in_vec[i] = prediction[8 - order + i] + in_vec[8 + i];
-
-        // ... and do the same thing as before to get predictions.
-        for (i = 0; i < 8; i++) {
-            prediction[8 + i] = inner_product(order + i, coef_tbl[k][i], in_vec);
-            in_vec[i + order] = in_buf[8 + i] - prediction[8 + i];
-            e[8 + i] = (float)in_vec[i + order];
-        }
-
-        // Compute the L2 norm of the errors; the lowest norm decides which predictor to use.
-        se = 0.0f;
-        for (j = 0; j < 16; j++)
-            se += e[j] * e[j];
+    // Predict in_buf from 'order' values from the old state plus the errors
+    // so far with every predictor; the lowest L2 norm of the errors decides
+    // which predictor to use.
+    for (i = 0; i < 16; i++)
+        in_vec[i] = in_buf[i];
+    predictor_errors(lanes, state, in_vec, errs);
 
-        if (se < min) {
-            min = se;
+    optimalp = 0;
+    for (k = 0; k < lanes->npredictors; k++) {
+        if (errs[k] < min) {
+            min = errs[k];
             optimalp = k;
         }
     }
@@ -1068,6 +1089,9 @@ vadpcm_enc(container_data *ctnr, const codec_spec *codec, const enc_dec_opts *op
     expand_codebook(ctnr->vadpcm.book_data, &coef_tbl, ctnr->vadpcm.book_header.order,
                     ctnr->vadpcm.book_header.npredictors);
 
+    predictor_lanes lanes;
+    expand_predictor_lanes(&lanes, coef_tbl, order, npredictors);
+
     int16_t in_buf[16];
 
     uint16_t *indata = ctnr->data;
@@ -1094,7 +1118,7 @@ vadpcm_enc(container_data *ctnr, const codec_spec *codec, const enc_dec_opts *op
             memcpy(in_buf, &indata[currentPos], sizeof(in_buf));
             currentPos += 16;
 
-            vencodeframe(&outdata[nBytes], in_buf, state, coef_tbl, order, npredictors, frame_size);
+            vencodeframe(&outdata[nBytes], in_buf, state, coef_tbl, order, &lanes, frame_size);
             nBytes += frame_size;
         }
 
@@ -1120,7 +1144,7 @@ vadpcm_enc(container_data *ctnr, const codec_spec *codec, const enc_dec_opts *op
                 memcpy(in_buf, &indata[currentPos], sizeof(in_buf));
                 currentPos += 16;
 
-                vencodeframe(&outdata[nBytes], in_buf, state, coef_tbl, order, npredictors, frame_size);
+                vencodeframe(&outdata[nBytes], in_buf, state, coef_tbl, order, &lanes, frame_size);
                 nBytes += frame_size;
             }
 
@@ -1135,7 +1159,7 @@ vadpcm_enc(container_data *ctnr, const codec_spec *codec, const enc_dec_opts *op
 
             memcpy(in_buf + left, &indata[currentPos], (16 - left) * sizeof(int16_t));
 
-            vencodeframe(&outdata[nBytes], in_buf, state, coef_tbl, order, npredictors, frame_size);
+            vencodeframe(&outdata[nBytes], in_buf, state, coef_tbl, order, &lanes, frame_size);
             nBytes += frame_size;
 
             // Return to loop start
@@ -1161,7 +1185,7 @@ vadpcm_enc(container_data *ctnr, const codec_spec *codec, const enc_dec_opts *op
 
         memset(in_buf, 0, (16 - nsam) * sizeof(int16_t));
 
-        vencodeframe(&outdata[nBytes], in_buf, state, coef_tbl, order, npredictors, frame_size);
+        vencodeframe(&outdata[nBytes], in_buf, state, coef_tbl, order, &lanes, frame_size);
         nBytes += frame_size;
     }
 
@@ -1178,10 +1202,7 @@ vadpcm_enc(container_data *ctnr, const codec_spec *codec, const enc_dec_opts *op
         free(ctnr->loops);
     ctnr->loops = NULL;
 
-    free(ctnr->data);
-
-    ctnr->data = outdata;
-    ctnr->data_size = nBytes;
+    container_set_data(ctnr, outdata, nBytes);
     ctnr->data_type = (frame_size == 5) ? SAMPLE_TYPE_VADPCM_HALF : SAMPLE_TYPE_VADPCM;
 
     destroy_expanded_codebook(coef_tbl, npredictors);
@@ -1209,9 +1230,14 @@ vadpcm_dec(container_data *ctnr, UNUSED const codec_spec *codec, const enc_dec_o
 
     ALADPCMloop *aloops = ctnr->vadpcm.loops;
 
+    myrand_reset();
+
     int32_t ***coef_tbl = NULL;
     expand_codebook(ctnr->vadpcm.book_data, &coef_tbl, order, npredictors);
 
+    predictor_lanes lanes;
+    expand_predictor_lanes(&lanes, coef_tbl, order, npredictors);
+
     int32_t state[16];
     int32_t prescaled[16];
     int32_t in_pos = 0;
@@ -1245,8 +1271,11 @@ vadpcm_dec(container_data *ctnr, UNUSED const codec_spec *codec, const enc_dec_o
         memcpy(input, &input_buf[in_pos], frame_size);
         in_pos += frame_size;
 
-        // Initial decode using the standard decoder
-        vdecodeframe(input, prescaled, state, order, coef_tbl, frame_size);
+        // Initial decode using the standard decoder, unrolled for the usual order 2
+        if (order == 2)
+            vadpcm_order2_decode(input, frame_size == 5, ctnr->vadpcm.book_data, state, prescaled, false);
+        else
+            vdecodeframe(input, prescaled, state, order, coef_tbl, frame_size);
 
         // Create a guess from that, by clamping to 16 bits
         for (int32_t i = 0; i < 16; i++)
@@ -1258,20 +1287,19 @@ vadpcm_dec(container_data *ctnr, UNUSED const codec_spec *codec, const enc_dec_o
             memcpy(origGuess, guess, sizeof(guess));
 
             // Encode the guess
-            my_encodeframe(encoded, guess, prev_state, coef_tbl, order, npredictors, frame_size);
+            my_encodeframe(encoded, guess, prev_state, coef_tbl, order, &lanes, frame_size);
 
             if (memcmp(input, encoded, frame_size) != 0) {
                 // If it doesn't match, bruteforce the matching.
 
                 int32_t guess32[16];
-                if (bruteforce(guess32, input, decoded, prescaled, prev_state, coef_tbl, order, npredictors,
-                               frame_size)) {
+                if (bruteforce(guess32, input, decoded, prescaled, prev_state, coef_tbl, order, &lanes, frame_size)) {
                     for (int i = 0; i < 16; i++) {
                         assert(-0x8000 <= guess32[i] && guess32[i] <= 0x7fff);
                         guess[i] = guess32[i];
                     }
 
-                    my_encodeframe(encoded, guess, prev_state, coef_tbl, order, npredictors, frame_size);
+                    my_encodeframe(encoded, guess, prev_state, coef_tbl, order, &lanes, frame_size);
                     assert(memcmp(input, encoded, frame_size) == 0);
                 } else {
                     fails++;
@@ -1292,7 +1320,7 @@ vadpcm_dec(container_data *ctnr, UNUSED const codec_spec *codec, const enc_dec_o
                     if (myrand() % 2)
                         guess[ind] += (old - origGuess[ind]) / 2;
 
-                    my_encodeframe(encoded, guess, prev_state, coef_tbl, order, npredictors, frame_size);
+                    my_encodeframe(encoded, guess, prev_state, coef_tbl, order, &lanes, frame_size);
 
                     if (memcmp(input, encoded, frame_size) == 0)
                         failures = -1;
@@ -1331,9 +1359,7 @@ vadpcm_dec(container_data *ctnr, UNUSED const codec_spec *codec, const enc_dec_o
 
     // Assign new data
 
-    free(ctnr->data);
-    ctnr->data = output_buf;
-    ctnr->data_size = output_size;
+    container_set_data(ctnr, output_buf, output_size);
     ctnr->data_type = SAMPLE_TYPE_PCM16;
     ctnr->num_samples = nSamples;
 
@@ -0,0 +1,120 @@
+/**
+ * SPDX-FileCopyrightText: Copyright (C) 2024 ZeldaRET
+ * SPDX-License-Identifier: CC0-1.0
+ */
+#ifndef CODEC_VADPCM_ORDER2_H
+#define CODEC_VADPCM_ORDER2_H
+
+/**
+ * VADPCM frame decoder specialized for order 2 codebooks, the only order the audio driver's microcode decodes and the
+ * one every vanilla sample uses. It is header-only and depends on nothing but the standard integer types, so that
+ * sampleconv and the software mixer of the Nspire port share it.
+ *
+ * Each half of a frame is 8 samples predicted from the 2 samples before it. Written out, sample j of a half is
+ *
+ *     floor((c0[j] * prev2 + c1[j] * prev1 + sum_{k < j} (c1[j - k - 1] * r[k]) * scale) / 2^11) + r[j] * scale
+ *
+ * with c0 and c1 the two 8-entry columns of the codebook page and r the residuals. All residuals of a frame share the
+ * same scale, so the triangular sum is taken over the small unscaled residuals and scaled once, and it is unrolled so
+ * that every coefficient stays in a register. The result is the same as the generic matrix form in vadpcm.c.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+static inline int32_t
+vadpcm_order2_clamp16(int32_t x)
+{
+    if (x > 0x7FFF)
+        return 0x7FFF;
+    if (x < -0x8000)
+        return -0x8000;
+    return x;
+}
+
+/**
+ * Unpacks the 16 residuals of a 9-byte (4-bit) or 5-byte (2-bit) frame, sign-extended but not yet scaled.
+ */
+static inline void
+vadpcm_order2_unpack(const uint8_t *frame, bool small, int32_t res[16])
+{
+    const uint8_t *in = frame + 1;
+
+    if (small) {
+        for (int i = 0; i < 16; i += 4, in++) {
+            res[i + 0] = (int32_t)((uint32_t)*in << 24) >> 30;
+            res[i + 1] = (int32_t)((uint32_t)*in << 26) >> 30;
+            res[i + 2] = (int32_t)((uint32_t)*in << 28) >> 30;
+            res[i + 3] = (int32_t)((uint32_t)*in << 30) >> 30;
+        }
+    } else {
+        for (int i = 0; i < 16; i += 2, in++) {
+            res[i + 0] = (int32_t)((uint32_t)*in << 24) >> 28;
+            res[i + 1] = (int32_t)((uint32_t)*in << 28) >> 28;
+        }
+    }
+}
+
+/**
+ * Predicts 8 samples from `prev2`, `prev1` and the unscaled residuals `r`.
+ */
+static inline void
+vadpcm_order2_half(int32_t out[8], const int16_t *page, int32_t prev2, int32_t prev1, const int32_t r[8],
+                   int32_t scale, bool saturate)
+{
+    const int32_t d0 = page[8 + 0];
+    const int32_t d1 = page[8 + 1];
+    const int32_t d2 = page[8 + 2];
+    const int32_t d3 = page[8 + 3];
+    const int32_t d4 = page[8 + 4];
+    const int32_t d5 = page[8 + 5];
+    const int32_t d6 = page[8 + 6];
+    const int32_t d7 = page[8 + 7];
+
+    // The earlier residuals' contribution to each sample
+    int32_t acc[8];
+    acc[0] = 0;
+    acc[1] = d0 * r[0];
+    acc[2] = d1 * r[0] + d0 * r[1];
+    acc[3] = d2 * r[0] + d1 * r[1] + d0 * r[2];
+    acc[4] = d3 * r[0] + d2 * r[1] + d1 * r[2] + d0 * r[3];
+    acc[5] = d4 * r[0] + d3 * r[1] + d2 * r[2] + d1 * r[3] + d0 * r[4];
+    acc[6] = d5 * r[0] + d4 * r[1] + d3 * r[2] + d2 * r[3] + d1 * r[4] + d0 * r[5];
+    acc[7] = d6 * r[0] + d5 * r[1] + d4 * r[2] + d3 * r[3] + d2 * r[4] + d1 * r[5] + d0 * r[6];
+
+    // Then the two samples of history. The arithmetic shift rounds down like the microcode does, the sample's own
+    // residual is added after it as in the generic decoder, so that the two agree even where the sums overflow.
+    out[0] = ((page[0] * prev2 + d0 * prev1 + acc[0] * scale) >> 11) + r[0] * scale;
+    out[1] = ((page[1] * prev2 + d1 * prev1 + acc[1] * scale) >> 11) + r[1] * scale;
+    out[2] = ((page[2] * prev2 + d2 * prev1 + acc[2] * scale) >> 11) + r[2] * scale;
+    out[3] = ((page[3] * prev2 + d3 * prev1 + acc[3] * scale) >> 11) + r[3] * scale;
+    out[4] = ((page[4] * prev2 + d4 * prev1 + acc[4] * scale) >> 11) + r[4] * scale;
+    out[5] = ((page[5] * prev2 + d5 * prev1 + acc[5] * scale) >> 11) + r[5] * scale;
+    out[6] = ((page[6] * prev2 + d6 * prev1 + acc[6] * scale) >> 11) + r[6] * scale;
+    out[7] = ((page[7] * prev2 + d7 * prev1 + acc[7] * scale) >> 11) + r[7] * scale;
+
+    if (saturate) {
+        for (int i = 0; i < 8; i++)
+            out[i] = vadpcm_order2_clamp16(out[i]);
+    }
+}
+
+/**
+ * Decodes one frame. `book` holds the codebook pages of 16 coefficients each, `state` the previous frame on entry,
+ * of which only the last 2 samples are used, and the decoded frame on return. With `saturate` the samples are clamped
+ * to 16 bits as they are decoded, as the microcode does, otherwise they are kept as they are like the original
+ * tools do. `res` receives the unscaled residuals.
+ */
+static inline void
+vadpcm_order2_decode(const uint8_t *frame, bool small, const int16_t *book, int32_t state[16], int32_t res[16],
+                     bool saturate)
+{
+    const int16_t *page = book + (frame[0] & 0xF) * 16;
+    const int32_t scale = 1 << (frame[0] >> 4);
+
+    vadpcm_order2_unpack(frame, small, res);
+    vadpcm_order2_half(&state[0], page, state[14], state[15], &res[0], scale, saturate);
+    vadpcm_order2_half(&state[8], page, state[6], state[7], &res[8], scale, saturate);
+}
+
+#endif
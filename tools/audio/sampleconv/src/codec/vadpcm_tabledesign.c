@@ -2,14 +2,19 @@
  * SPDX-FileCopyrightText: Copyright (C) 2024 ZeldaRET
  * SPDX-License-Identifier: CC0-1.0
  */
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <math.h>
 
 #include "../util.h"
 #include "vadpcm.h"
 
+// Frames are only analysed on worker threads when each thread gets at least this many of them
+#define MIN_FRAMES_PER_THREAD 2048
+
 // Levinson-Durbin algorithm for iteratively solving for prediction and reflection coefficients, given autocorrelation
 // https://en.wikipedia.org/wiki/Levinson_recursion
 static int
@@ -143,23 +148,27 @@ rfroma(double *in, int n, double *out)
     }
 }
 
-static double
-model_dist(double *mean_predictors, double *frame_predictors, int order)
+// autocorrelation from current mean predictors (?)
+static void
+mean_autocorrelation(double *mean_predictors, int order, double *out)
 {
-    double autocorrelation_frame_predictors[order + 1];
-    double autocorrelation_mean_predictors[order + 1];
-    double ret;
     int i, j;
 
-    // autocorrelation from frame predictors
-    rfroma(frame_predictors, order, autocorrelation_frame_predictors);
-
-    // autocorrelation from current mean predictors (?)
     for (i = 0; i <= order; i++) {
-        autocorrelation_mean_predictors[i] = 0.0;
+        out[i] = 0.0;
         for (j = 0; j <= order - i; j++)
-            autocorrelation_mean_predictors[i] += mean_predictors[j] * mean_predictors[i + j];
+            out[i] += mean_predictors[j] * mean_predictors[i + j];
     }
+}
+
+// Takes the autocorrelation from the frame predictors (rfroma) and from the mean predictors (mean_autocorrelation).
+// Each only depends on one side so refine works them out once per frame and once per cluster and iteration, rather
+// than for every pair.
+static double
+model_dist(double *autocorrelation_mean_predictors, double *autocorrelation_frame_predictors, int order)
+{
+    double ret;
+    int i;
 
     // compute "model distance" (scaled L2 norm: 2 * inner(ac1, ac2) )
     // this compares how good the mean predictors are to the optimal predictors for this frame
@@ -170,37 +179,61 @@ model_dist(double *mean_predictors, double *frame_predictors, int order)
     return ret;
 }
 
+// Computes the lag products SUM(j, x[j - i] * x[j]) for i in [0, order] in integers.
+// A product of two samples fits in an int and a sum of fewer than 2^23 of them is exact both in an int64 and once
+// converted to a double, so everything derived from these gives the same values as summing the products in double
+// precision one by one. Summing integers lets the compiler vectorize the loop, which it can't do for the double sums
+// without reordering them.
+static void
+aclags(const int16_t *x, int order, int xlen, int64_t *lags)
+{
+    int i, j;
+
+    for (i = 0; i <= order; i++) {
+        int64_t sum = 0;
+        for (j = 0; j < xlen; j++) {
+            sum += x[j - i] * x[j];
+        }
+        lags[i] = sum;
+    }
+}
+
 // Calculate the autocorrelation matrix of two vectors at x and x - xlen
 // https://en.wikipedia.org/wiki/Autocorrelation
 static void
-acmat(int16_t *x, int order, int xlen, double **ac)
+acmat(const int16_t *x, const int64_t *lags, int order, int xlen, double **ac)
 {
-    int i, j, k;
+    int i, j;
+    int64_t r[order + 1][order + 1];
 
-    for (i = 1; i <= order; i++) {
-        for (j = 1; j <= order; j++) {
-            // R{xx}[i,j] = E[X[i] * X[j]]
+    // R{xx}[i,j] = E[X[i] * X[j]] = SUM(k, x[k - i] * x[k - j])
+    // The first row is the lag products moved back by one sample, every other entry is the one up and to the left
+    // moved back by one more sample. The matrix is symmetric.
+    for (j = 1; j <= order; j++) {
+        r[1][j] = lags[j - 1] + x[-1] * x[-j] - x[xlen - 1] * x[xlen - j];
+    }
+    for (i = 1; i < order; i++) {
+        for (j = i; j < order; j++) {
+            r[i + 1][j + 1] = r[i][j] + x[-1 - i] * x[-1 - j] - x[xlen - 1 - i] * x[xlen - 1 - j];
+        }
+    }
 
-            ac[i][j] = 0.0;
-            for (k = 0; k < xlen; k++) {
-                ac[i][j] += x[k - i] * x[k - j];
-            }
+    for (i = 1; i <= order; i++) {
+        for (j = i; j <= order; j++) {
+            ac[i][j] = ac[j][i] = r[i][j];
         }
     }
 }
 
 // Computes the autocorrelation vector of two vectors at x and x - xlen
 static void
-acvect(int16_t *x, int order, int xlen, double *ac)
+acvect(const int64_t *lags, int order, double *ac)
 {
-    int i, j;
+    int i;
 
+    // r{xx} = E(x(m)x) = SUM(j, x[j - i] * x[j])
     for (i = 0; i <= order; i++) {
-        ac[i] = 0.0;
-        // r{xx} = E(x(m)x) = SUM(j, x[j - i] * x[j])
-        for (j = 0; j < xlen; j++) {
-            ac[i] -= x[j - i] * x[j];
-        }
+        ac[i] = -lags[i];
     }
 }
 
@@ -362,35 +395,43 @@ split(double **predictors, double *delta, int order, int npredictors, double sca
 }
 
 static void
-refine(double **predictors, int order, int npredictors, double *all_frame_predictors, int num_frame_predictors,
+refine(double **predictors, int order, int npredictors, double *all_frame_autocorrelations, int num_frame_predictors,
        int refine_iters)
 {
     int iter;
-    double dist;
     double dummy;
-    double best_value;
-    int best_index;
     int i, j;
 
     double rsums[npredictors][order + 1];
     int counts[npredictors];
     double vec[order + 1];
+    double mean_acs[npredictors][order + 1];
+
+    // The predictor each frame was binned with in the last iteration
+    int *best_indices =
+        MALLOC_CHECKED_INFO(num_frame_predictors * sizeof(int), "num_frame_predictors=%d", num_frame_predictors);
 
     // For some number of refinement iterations
     for (iter = 0; iter < refine_iters; iter++) {
+        bool changed = false;
+
+        for (i = 0; i < npredictors; i++)
+            mean_autocorrelation(predictors[i], order, mean_acs[i]);
+
         // Initialize average autocorrelations
         memset(counts, 0, npredictors * sizeof(int));
         memset(rsums, 0, npredictors * (order + 1) * sizeof(double));
 
         // Sum autocorrelations for averaging for each frame, binning them based on best fitting predictor set
         for (i = 0; i < num_frame_predictors; i++) {
-            best_value = 1e30;
-            best_index = 0;
+            double *frame_ac = &all_frame_autocorrelations[(order + 1) * i];
+            double best_value = 1e30;
+            int best_index = 0;
 
             // Find the choice of predictor that minimizes the "model distance" for this frame
             for (j = 0; j < npredictors; j++) {
                 // Compare with current mean predictors, the distance metric is based on autocorrelations
-                dist = model_dist(predictors[j], &all_frame_predictors[(order + 1) * i], order);
+                double dist = model_dist(mean_acs[j], frame_ac, order);
 
                 if (dist < best_value) {
                     // Record the new best predictors
@@ -399,16 +440,23 @@ refine(double **predictors, int order, int npredictors, double *all_frame_predic
                 }
             }
 
-            // Compute autocorrelation from optimal predictor
-            rfroma(&all_frame_predictors[(order + 1) * i], order, vec);
+            if (iter == 0 || best_index != best_indices[i])
+                changed = true;
+            best_indices[i] = best_index;
+
             // Add to average autocorrelation for the best predictor choice
             for (j = 0; j <= order; j++)
-                rsums[best_index][j] += vec[j];
+                rsums[best_index][j] += frame_ac[j];
 
             // Update the counter of how many frames we've summed for this predictor
             counts[best_index]++;
         }
 
+        // With every frame binned the same as in the last iteration, the averages and so the predictors would come
+        // out the same as they are, and so would every remaining iteration
+        if (!changed)
+            break;
+
         // Finalize average autocorrelations
         for (i = 0; i < npredictors; i++) {
             if (counts[i] > 1) {
@@ -436,6 +484,8 @@ refine(double **predictors, int order, int npredictors, double *all_frame_predic
             afromk(vec, predictors[i], order);
         }
     }
+
+    free(best_indices);
 }
 
 static int
@@ -516,6 +566,107 @@ read_row(int16_t *out, double *predictors, int order)
     return overflows;
 }
 
+typedef struct {
+    const table_design_spec *design;
+    int16_t *samples;
+    size_t first_frame;
+    size_t end_frame;
+    // The autocorrelations from the predictors of the frames that got any, stored from the slot of first_frame on
+    double *frame_autocorrelations;
+    size_t num_valid;
+} frame_analysis;
+
+// Compute the optimal set of predictors for each frame in [first_frame, end_frame), where optimal here means the
+// predictors that minimize the mean-square error between the predicted signal and the true signal. Frames don't depend
+// on each other's results, so ranges of them can be analysed concurrently.
+static void *
+analyse_frames(void *arg)
+{
+    frame_analysis *fa = arg;
+    const table_design_spec *design = fa->design;
+    int order = design->order;
+    int num_order = order + 1;
+    unsigned int frame_size = design->frame_size;
+
+    double vec[num_order];
+    int perm[num_order];
+    double reflection_coeffs[num_order];
+    double predictors[num_order];
+    int64_t lags[num_order];
+
+    double autocorrelation_rows[num_order][num_order];
+    double *autocorrelation_matrix[num_order];
+    for (int i = 0; i < num_order; i++)
+        autocorrelation_matrix[i] = autocorrelation_rows[i];
+
+    // The analysis of a frame also looks at the frame before it, the first frame is preceded by silence
+    int16_t first_buffer[2 * frame_size];
+    memset(first_buffer, 0, frame_size * sizeof(*first_buffer));
+
+    for (size_t frame = fa->first_frame; frame < fa->end_frame; frame++) {
+        int16_t *x = &fa->samples[frame * frame_size];
+
+        if (frame == 0) {
+            memcpy(&first_buffer[frame_size], x, frame_size * sizeof(*first_buffer));
+            x = &first_buffer[frame_size];
+        }
+
+        // Compute autocorrelation vector of the two vectors in the buffer
+        aclags(x, order, frame_size, lags);
+        acvect(lags, order, vec);
+
+        // First element of autocorrelation has the largest magnitude
+        if (fabs(vec[0]) <= design->thresh)
+            continue;
+        // Over threshold
+
+        // Computes the autocorrelation matrix of the two vectors in the buffer
+        acmat(x, lags, order, frame_size, autocorrelation_matrix);
+
+        // Compute the LUP decomposition of the autocorrelation matrix
+        int perm_det;
+        if (lud(autocorrelation_matrix, order, perm, &perm_det) != 0) // Continue only if numerically stable
+            continue;
+
+        // Back-substitution to solve the linear equation Ra = r
+        // where
+        //  R = autocorrelation matrix
+        //  r = autocorrelation vector
+        //  a = linear prediction coefficients
+        // After this vec contains the prediction coefficients that minimize the mean-square error.
+        lubksb(autocorrelation_matrix, order, perm, vec);
+        vec[0] = 1.0;
+
+        // Compute reflection coefficients from prediction coefficients
+        if (kfroma(vec, reflection_coeffs, order) != 0) // Continue only if numerically stable
+            continue;
+
+        predictors[0] = 1.0;
+
+        // Clamp the reflection coefficients. Reflection coefficients are clamped rather than the predictors
+        // themselves as the reflection coefficients have a direct relationship with the stability of the model. If
+        // the reflection coefficients are outside of the interval (-1,1) the model is unstable as the associated
+        // transfer function will contain poles outside the complex unit disk. If the reflection coefficients are all
+        // inside the interval (-1,1) there are no poles outside of the unit disk, guaranteeing the stability of the
+        // model.
+        for (int i = 1; i < num_order; i++) {
+            if (reflection_coeffs[i] >= 1.0)
+                reflection_coeffs[i] = 0.9999999999;
+            if (reflection_coeffs[i] <= -1.0)
+                reflection_coeffs[i] = -0.9999999999;
+        }
+
+        // Compute prediction coefficients from clamped reflection coefficients
+        afromk(reflection_coeffs, predictors, order);
+
+        // Compute autocorrelation from predictors, equivalent to computing the autocorrelation on the signal produced
+        // by following the prediction model exactly. Both the average below and the clustering only need this.
+        rfroma(predictors, order, &fa->frame_autocorrelations[(fa->first_frame + fa->num_valid) * num_order]);
+        fa->num_valid++;
+    }
+    return NULL;
+}
+
 int
 tabledesign_run(int16_t *order_out, int16_t *npredictors_out, int16_t **book_data_out, void *sample_data,
                 size_t num_samples, const table_design_spec *design)
@@ -538,87 +689,57 @@ tabledesign_run(int16_t *order_out, int16_t *npredictors_out, int16_t **book_dat
     int num_order = order + 1;
 
     double vec[num_order];
-    int perm[num_order];
     double reflection_coeffs[num_order];
 
-    int16_t *buffer = MALLOC_CHECKED_INFO(2 * frame_size * sizeof(int16_t), "frame_size=%u", frame_size);
-
     double **predictors = MALLOC_CHECKED_INFO(npredictors * sizeof(double *), "npredictors=%d", npredictors);
     for (int i = 0; i < npredictors; i++)
         predictors[i] = MALLOC_CHECKED_INFO(num_order * sizeof(double), "npredictors=%d", npredictors);
 
-    double **autocorrelation_matrix = MALLOC_CHECKED_INFO(num_order * sizeof(double *), "num_order=%d", num_order);
-    for (int i = 0; i < num_order; i++)
-        autocorrelation_matrix[i] = MALLOC_CHECKED_INFO(num_order * sizeof(double), "num_order=%d", num_order);
-
     // (back-)align to a multiple of the frame size
-    size_t nframes = num_samples - (num_samples % frame_size);
+    size_t nframes = num_samples / frame_size;
 
-    double *all_frame_predictors =
+    double *all_frame_autocorrelations =
         MALLOC_CHECKED_INFO(nframes * num_order * sizeof(double), "nframes=%lu, num_order=%d", nframes, num_order);
     uint32_t num_frame_predictors = 0;
 
-    int16_t *sample = sample_data;
-    int16_t *sample_end = sample + nframes;
-
-    memset(buffer, 0, frame_size * sizeof(*buffer));
-
-    // First, compute the optimal set of predictors for every complete frame in the signal, where optimal here means
-    // the predictors that minimize the mean-square error between the predicted signal and the true signal.
-
-    for (; sample < sample_end; sample += frame_size) {
-        // Copy sample data into second half of buffer, during the first iteration the first half is 0 while in
-        // later iterations the second half of the previous iteration is shifted into the first half.
-        memcpy(&buffer[frame_size], sample, frame_size * sizeof(*buffer));
-
-        // Compute autocorrelation vector of the two vectors in the buffer
-        acvect(&buffer[frame_size], order, frame_size, vec);
-
-        // First element of autocorrelation has the largest magnitude
-        if (fabs(vec[0]) > design->thresh) {
-            // Over threshold
-
-            // Computes the autocorrelation matrix of the two vectors in the buffer
-            acmat(&buffer[frame_size], order, frame_size, autocorrelation_matrix);
-
-            // Compute the LUP decomposition of the autocorrelation matrix
-            int perm_det;
-            if (lud(autocorrelation_matrix, order, perm, &perm_det) == 0) { // Continue only if numerically stable
-                // Back-substitution to solve the linear equation Ra = r
-                // where
-                //  R = autocorrelation matrix
-                //  r = autocorrelation vector
-                //  a = linear prediction coefficients
-                // After this vec contains the prediction coefficients that minimize the mean-square error.
-                lubksb(autocorrelation_matrix, order, perm, vec);
-                vec[0] = 1.0;
-
-                // Compute reflection coefficients from prediction coefficients
-                if (kfroma(vec, reflection_coeffs, order) == 0) { // Continue only if numerically stable
-                    all_frame_predictors[num_frame_predictors * num_order] = 1.0;
-
-                    // Clamp the reflection coefficients. Reflection coefficients are clamped rather than the
-                    // predictors themselves as the reflection coefficients have a direct relationship with the
-                    // stability of the model. If the reflection coefficients are outside of the interval (-1,1)
-                    // the model is unstable as the associated transfer function will contain poles outside the
-                    // complex unit disk. If the reflection coefficients are all inside the interval (-1,1) there
-                    // are no poles outside of the unit disk, guaranteeing the stability of the model.
-                    for (int i = 1; i < num_order; i++) {
-                        if (reflection_coeffs[i] >= 1.0)
-                            reflection_coeffs[i] = 0.9999999999;
-                        if (reflection_coeffs[i] <= -1.0)
-                            reflection_coeffs[i] = -0.9999999999;
-                    }
-
-                    // Compute prediction coefficients from clamped reflection coefficients
-                    afromk(reflection_coeffs, &all_frame_predictors[num_frame_predictors * num_order], order);
-                    num_frame_predictors++;
-                }
-            }
-        }
+    // First, compute the optimal set of predictors for every complete frame in the signal. Long samples are split
+    // into a contiguous range of frames per thread.
+    long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads > (long)(nframes / MIN_FRAMES_PER_THREAD))
+        nthreads = nframes / MIN_FRAMES_PER_THREAD;
+    if (nthreads < 1)
+        nthreads = 1;
+
+    frame_analysis analyses[nthreads];
+    pthread_t threads[nthreads];
+    for (long i = 0; i < nthreads; i++) {
+        analyses[i] = (frame_analysis){
+            .design = design,
+            .samples = sample_data,
+            .first_frame = nframes * i / nthreads,
+            .end_frame = nframes * (i + 1) / nthreads,
+            .frame_autocorrelations = all_frame_autocorrelations,
+            .num_valid = 0,
+        };
+    }
+    // The calling thread takes the first range, if a thread can't be started it takes that range as well
+    bool started[nthreads];
+    for (long i = 1; i < nthreads; i++)
+        started[i] = pthread_create(&threads[i], NULL, analyse_frames, &analyses[i]) == 0;
+    analyse_frames(&analyses[0]);
+    for (long i = 1; i < nthreads; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            analyse_frames(&analyses[i]);
+    }
 
-        // Move second vector to first vector
-        memcpy(&buffer[0], &buffer[frame_size], frame_size * sizeof(*buffer));
+    // Close the gaps between the ranges
+    for (long i = 0; i < nthreads; i++) {
+        memmove(&all_frame_autocorrelations[num_frame_predictors * num_order],
+                &all_frame_autocorrelations[analyses[i].first_frame * num_order],
+                analyses[i].num_valid * num_order * sizeof(double));
+        num_frame_predictors += analyses[i].num_valid;
     }
 
     // Now that predictors for every frame have been found, they need to be reduced to a manageable quantity
@@ -631,12 +752,8 @@ tabledesign_run(int16_t *order_out, int16_t *npredictors_out, int16_t **book_dat
         vec[i] = 0.0;
 
     for (uint32_t i = 0; i < num_frame_predictors; i++) {
-        // Compute autocorrelation from predictors, equivalent to computing the autocorrelation on the signal produced
-        // by following the prediction model exactly.
-        rfroma(&all_frame_predictors[i * num_order], order, predictors[0]);
-
         for (int k = 1; k < num_order; k++)
-            vec[k] += predictors[0][k];
+            vec[k] += all_frame_autocorrelations[i * num_order + k];
     }
 
     for (int i = 1; i < num_order; i++)
@@ -672,7 +789,7 @@ tabledesign_run(int16_t *order_out, int16_t *npredictors_out, int16_t **book_dat
         split(predictors, split_delta, order, 1 << cur_bits, 0.01);
 
         // Update the values of each half to the means of the halves
-        refine(predictors, order, 1 << (1 + cur_bits), all_frame_predictors, num_frame_predictors,
+        refine(predictors, order, 1 << (1 + cur_bits), all_frame_autocorrelations, num_frame_predictors,
                design->refine_iters);
     }
 
@@ -696,12 +813,7 @@ tabledesign_run(int16_t *order_out, int16_t *npredictors_out, int16_t **book_dat
 
     *book_data_out = book_data;
 
-    free(buffer);
-    free(all_frame_predictors);
-
-    for (int i = 0; i < num_order; i++)
-        free(autocorrelation_matrix[i]);
-    free(autocorrelation_matrix);
+    free(all_frame_autocorrelations);
 
     for (int i = 0; i < npredictors; i++)
         free(predictors[i]);
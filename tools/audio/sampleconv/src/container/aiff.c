@@ -474,16 +474,10 @@ aiff_aifc_common_read(container_data *out, FILE *in, UNUSED bool matching, uint3
                 ssnd.offset = be32toh(ssnd.offset);
                 ssnd.blockSize = be32toh(ssnd.blockSize);
 
-                size_t data_size = chunk_size - sizeof(ssnd);
-
-                void *data = MALLOC_CHECKED_INFO(data_size, "SSND chunk size = %lu", data_size);
-                FREAD(in, data, data_size);
-
                 if (ssnd.offset != 0 || ssnd.blockSize != 0)
                     error("Bad SSND chunk in aiff/aifc, offset/blockSize != 0");
 
-                out->data = data;
-                out->data_size = data_size;
+                container_read_data(out, in, chunk_size - sizeof(ssnd));
 
                 has_ssnd = true;
             } break;
@@ -524,8 +518,11 @@ aiff_aifc_common_read(container_data *out, FILE *in, UNUSED bool matching, uint3
         assert(out->data_size % 2 == 0);
         assert(out->bit_depth == 16);
 
-        for (size_t i = 0; i < out->data_size / 2; i++)
-            ((uint16_t *)(out->data))[i] = be16toh(((uint16_t *)(out->data))[i]);
+        // Skipped on big-endian hosts, where it would only dirty the pages of a mapped input
+        if (be16toh(1) != 1) {
+            for (size_t i = 0; i < out->data_size / 2; i++)
+                ((uint16_t *)(out->data))[i] = be16toh(((uint16_t *)(out->data))[i]);
+        }
     }
 
     for (size_t i = 0; i < out->num_loops; i++) {
@@ -818,22 +815,13 @@ aiff_aifc_common_write(container_data *in, const char *path, bool aifc, bool mat
         }
     }
 
-    if (in->data_type == SAMPLE_TYPE_PCM16) {
-        assert(in->data_size % 2 == 0);
-        assert(in->bit_depth == 16);
-
-        for (size_t i = 0; i < in->data_size / 2; i++) {
-            ((uint16_t *)in->data)[i] = htobe16(((uint16_t *)in->data)[i]);
-        }
-    }
-
     aiff_SSND ssnd = {
         .offset = 0,
         .blockSize = 0,
     };
     CHUNK_BEGIN(out, "SSND", &chunk_start);
     CHUNK_WRITE(out, &ssnd);
-    CHUNK_WRITE_RAW(out, in->data, in->data_size);
+    container_write_data(in, out, true);
     CHUNK_END(out, chunk_start, htobe32);
 
     uint32_t size = htobe32(ftell(out) - 8);
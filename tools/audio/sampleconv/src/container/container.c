@@ -6,15 +6,35 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
+#include <assert.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include "../util.h"
 #include "container.h"
 
+// Samples are byteswapped for output through a buffer of this many samples
+#define WRITE_BUFFER_SAMPLES 2048
+
+static void
+container_release_data(container_data *ctnr)
+{
+    if (ctnr->data_map != NULL)
+        munmap(ctnr->data_map, ctnr->data_map_size);
+    else if (ctnr->data != NULL)
+        free(ctnr->data);
+
+    ctnr->data = NULL;
+    ctnr->data_map = NULL;
+    ctnr->data_map_size = 0;
+}
+
 int
 container_destroy(container_data *data)
 {
-    if (data->data != NULL)
-        free(data->data);
+    container_release_data(data);
     if (data->loops != NULL)
         free(data->loops);
     if (data->vadpcm.book_data != NULL)
@@ -23,3 +43,79 @@ container_destroy(container_data *data)
         free(data->vadpcm.loops);
     return 0;
 }
+
+/**
+ * Reads the next `size` bytes of `in` as the sample data. Where possible the file is mapped rather than read, so it is
+ * only paged in as the codecs get to it and its pages stay clean page cache that can be dropped again. The mapping is
+ * private, byteswapping the samples in place copies only the pages that are written to.
+ */
+void
+container_read_data(container_data *out, FILE *in, size_t size)
+{
+    long offset = ftell(in);
+    struct stat st;
+
+    if (size != 0 && offset >= 0 && fstat(fileno(in), &st) == 0 && (size_t)st.st_size >= offset + size) {
+        // mmap wants an offset that is a multiple of the page size
+        size_t page_offset = offset % sysconf(_SC_PAGESIZE);
+        size_t map_size = page_offset + size;
+        void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(in), offset - page_offset);
+
+        if (map != MAP_FAILED) {
+            madvise(map, map_size, MADV_SEQUENTIAL);
+
+            out->data = (uint8_t *)map + page_offset;
+            out->data_size = size;
+            out->data_map = map;
+            out->data_map_size = map_size;
+
+            fseek(in, size, SEEK_CUR);
+            return;
+        }
+    }
+
+    void *data = MALLOC_CHECKED_INFO(size, "data size = %lu", size);
+    FREAD(in, data, size);
+    container_set_data(out, data, size);
+}
+
+/**
+ * Replaces the sample data with `data`, an allocation that the container takes ownership of.
+ */
+void
+container_set_data(container_data *ctnr, void *data, size_t size)
+{
+    container_release_data(ctnr);
+
+    ctnr->data = data;
+    ctnr->data_size = size;
+}
+
+/**
+ * Writes the sample data to `out`. pcm16 samples are written in the given byte order, they are byteswapped through a
+ * small buffer rather than in place so that a mapped input doesn't get copied only to be written out.
+ */
+void
+container_write_data(container_data *in, FILE *out, bool big_endian)
+{
+    if (in->data_type != SAMPLE_TYPE_PCM16) {
+        FWRITE(out, in->data, in->data_size);
+        return;
+    }
+
+    assert(in->bit_depth == 16);
+    assert(in->data_size % 2 == 0);
+
+    const uint16_t *samples = in->data;
+    size_t num_samples = in->data_size / 2;
+    uint16_t buffer[WRITE_BUFFER_SAMPLES];
+
+    for (size_t i = 0; i < num_samples; i += WRITE_BUFFER_SAMPLES) {
+        size_t n = MIN(num_samples - i, WRITE_BUFFER_SAMPLES);
+
+        for (size_t j = 0; j < n; j++)
+            buffer[j] = (big_endian) ? htobe16(samples[i + j]) : htole16(samples[i + j]);
+
+        FWRITE(out, buffer, n * sizeof(uint16_t));
+    }
+}
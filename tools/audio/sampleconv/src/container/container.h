@@ -10,7 +10,9 @@
 #define CONTAINER_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "../codec/vadpcm.h"
 
@@ -74,6 +76,9 @@ typedef struct container_data {
     sample_data_type data_type;
     void *data;
     size_t data_size;
+    // When not NULL, data points into this private mapping of the input file instead of being its own allocation
+    void *data_map;
+    size_t data_map_size;
 
     unsigned num_loops;
     container_loop *loops;
@@ -96,4 +101,13 @@ typedef struct container_data {
 int
 container_destroy(container_data *data);
 
+void
+container_read_data(container_data *out, FILE *in, size_t size);
+
+void
+container_set_data(container_data *ctnr, void *data, size_t size);
+
+void
+container_write_data(container_data *in, FILE *out, bool big_endian);
+
 #endif
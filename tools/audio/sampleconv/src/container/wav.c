@@ -185,11 +185,7 @@ wav_read(container_data *out, const char *path, UNUSED bool matching)
             } break;
 
             case CC4('d', 'a', 't', 'a'): {
-                void *data = MALLOC_CHECKED_INFO(chunk_size, "data size = %u", chunk_size);
-                FREAD(in, data, chunk_size);
-
-                out->data = data;
-                out->data_size = chunk_size;
+                container_read_data(out, in, chunk_size);
 
                 has_data = true;
             } break;
@@ -379,8 +375,11 @@ wav_read(container_data *out, const char *path, UNUSED bool matching)
         if (out->data_size % 2 != 0)
             error("wav data size is not a multiple of 2 despite being pcm16-formatted?");
 
-        for (size_t i = 0; i < out->data_size / 2; i++)
-            ((uint16_t *)(out->data))[i] = le16toh(((uint16_t *)(out->data))[i]);
+        // Skipped on little-endian hosts, where it would only dirty the pages of a mapped input
+        if (le16toh(1) != 1) {
+            for (size_t i = 0; i < out->data_size / 2; i++)
+                ((uint16_t *)(out->data))[i] = le16toh(((uint16_t *)(out->data))[i]);
+        }
     }
 
     fclose(in);
@@ -425,17 +424,8 @@ wav_write(container_data *in, const char *path, bool matching)
     CHUNK_WRITE(out, &fact);
     CHUNK_END(out, chunk_start, htole32);
 
-    if (in->data_type == SAMPLE_TYPE_PCM16) {
-        assert(in->bit_depth == 16);
-        assert(in->data_size % 2 == 0);
-
-        for (size_t i = 0; i < in->data_size / 2; i++) {
-            ((uint16_t *)in->data)[i] = htole16(((uint16_t *)in->data)[i]);
-        }
-    }
-
     CHUNK_BEGIN(out, "data", &chunk_start);
-    CHUNK_WRITE_RAW(out, in->data, in->data_size);
+    container_write_data(in, out, false);
     CHUNK_END(out, chunk_start, htole32);
 
     wav_inst inst = {
@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <stdarg.h>
 
+#include "../../batch.h"
 #include "util.h"
 
 #include "codec/codec.h"
@@ -52,6 +53,7 @@ NORETURN static void
 help(const char *progname)
 {
     fprintf(stderr, "%s [--matching] out_codec_name in_path out_path\n", progname);
+    fprintf(stderr, "%s --batch manifest [--jobs n]\n", progname);
     fprintf(stderr, "Supported codecs:\n");
     fprintf(stderr, "    pcm16\n");
     fprintf(stderr, "    vadpcm\n");
@@ -67,6 +69,7 @@ NORETURN static void
 usage(const char *progname)
 {
     fprintf(stderr, "%s [--matching] out_codec_name in_path out_path\n", progname);
+    fprintf(stderr, "%s --batch manifest [--jobs n]\n", progname);
     exit(EXIT_FAILURE);
 }
 
@@ -100,8 +103,8 @@ container_from_name(const char *name)
     return NULL;
 }
 
-int
-main(int argc, char **argv)
+static int
+sampleconv_main(int argc, char **argv)
 {
     const char *progname = argv[0];
     // Required arguments
@@ -207,3 +210,11 @@ main(int argc, char **argv)
     container_destroy(&ctnr);
     return EXIT_SUCCESS;
 }
+
+int
+main(int argc, char **argv)
+{
+    if (argc > 1 && strequ(argv[1], "--batch"))
+        return batch_main(argc, argv, sampleconv_main);
+    return sampleconv_main(argc, argv);
+}
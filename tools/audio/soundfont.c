@@ -13,21 +13,14 @@
 envelope_data *
 sf_get_envelope(soundfont *sf, const char *name)
 {
-    LL_FOREACH(envelope_data *, env, sf->envelopes) {
-        if (env->points != NULL && strequ(name, env->name))
-            return env;
-    }
-    return NULL;
+    // Only named envelopes with points are in the map, the empty ones have no name
+    return str_map_get(&sf->envelopes_by_name, name);
 }
 
 sample_data *
 sample_data_forname(soundfont *sf, const char *name)
 {
-    LL_FOREACH(sample_data *, sample, sf->samples) {
-        if (strequ(sample->name, name))
-            return sample;
-    }
-    return NULL;
+    return str_map_get(&sf->samples_by_name, name);
 }
 
 void
@@ -56,15 +49,37 @@ read_soundfont_info(soundfont *sf, xmlNodePtr node)
     sf->info.pad_to_size = 0;
     xml_parse_node_by_spec(sf, node, spec, ARRAY_COUNT(spec));
 
-    xmlDocPtr sb_doc = xmlReadFile(sf->info.bank_path, NULL, XML_PARSE_NONET);
-    if (sb_doc == NULL)
+    if (!read_samplebank_xml_cached(&sf->sb, sf->info.bank_path))
         error("Failed to read sample bank xml file \"%s\"", sf->info.bank_path);
-    read_samplebank_xml(&sf->sb, sb_doc);
 
     if (sf->info.bank_path_dd != NULL) {
-        xmlDocPtr sbdd_doc = xmlReadFile(sf->info.bank_path_dd, NULL, XML_PARSE_NONET);
-        if (sbdd_doc == NULL)
+        if (!read_samplebank_xml_cached(&sf->sbdd, sf->info.bank_path_dd))
             error("Failed to read sample bank xml file \"%s\"", sf->info.bank_path);
-        read_samplebank_xml(&sf->sbdd, sbdd_doc);
+    }
+}
+
+/**
+ * Returns the samplebank table index a soundfont refers to its samplebank `sb` by: the pointer index `ptr_idx` if it
+ * uses one, otherwise the index of the bank itself.
+ */
+int
+sf_samplebank_index(soundfont *sf, samplebank *sb, int ptr_idx)
+{
+    if (ptr_idx != -1) {
+        // Validate pointer index
+        bool found = false;
+
+        for (size_t i = 0; i < sb->num_pointers; i++) {
+            if (ptr_idx == sb->pointer_indices[i]) {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            warning("In Soundfont %s: Invalid pointer indirect %d for samplebank %s", sf->info.name, ptr_idx, sb->name);
+
+        return ptr_idx;
+    } else {
+        return sb->index;
     }
 }
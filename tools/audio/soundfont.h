@@ -135,12 +135,14 @@ typedef struct {
 
     envelope_data *envelopes;
     envelope_data *envelope_last;
+    str_map envelopes_by_name;
 
     samplebank sb;
     samplebank sbdd;
 
     sample_data *samples;
     sample_data *sample_last;
+    str_map samples_by_name;
 
     instr_data *instruments;
     instr_data *instrument_last;
@@ -167,4 +169,7 @@ sample_data_forname(soundfont *sf, const char *name);
 void
 read_soundfont_info(soundfont *sf, xmlNodePtr node);
 
+int
+sf_samplebank_index(soundfont *sf, samplebank *sb, int ptr_idx);
+
 #endif
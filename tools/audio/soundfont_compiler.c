@@ -15,6 +15,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "batch.h"
 #include "xml.h"
 #include "aifc.h"
 #include "samplebank.h"
@@ -244,10 +245,8 @@ read_envelopes_info(soundfont *sf, xmlNodePtr envelopes)
             xml_parse_node_by_spec(envdata, env, spec_env, ARRAY_COUNT(spec_env));
 
             // Ensure name is unique
-            LL_FOREACH(envelope_data *, envdata2, sf->envelopes) {
-                if (envdata2->name != NULL && strequ(envdata->name, envdata2->name))
-                    error("Duplicate envelope name %s (second occurrence on line %d)", envdata->name, env->line);
-            }
+            if (str_map_get(&sf->envelopes_by_name, envdata->name) != NULL)
+                error("Duplicate envelope name %s (second occurrence on line %d)", envdata->name, env->line);
 
             envelope_point *pts = (envelope_point *)(envdata + 1);
 
@@ -290,6 +289,9 @@ read_envelopes_info(soundfont *sf, xmlNodePtr envelopes)
             }
             envdata->points = pts;
             envdata->n_points = points_num;
+
+            // Added only now, the realloc above may have moved it
+            str_map_insert(&sf->envelopes_by_name, envdata->name, envdata);
         }
 
         envdata->used = false;
@@ -728,7 +730,7 @@ read_samples_info(soundfont *sf, xmlNodePtr samples)
         if (sample_path == NULL)
             error("Bad sample name %s, does it exist in the samplebank? (line %d)", sample->name, sample_node->line);
 
-        aifc_read(&sample->aifc, sample_path, NULL, NULL);
+        aifc_read_cached(&sample->aifc, sample_path);
 
         if (sample->sample_rate == -1.0)
             sample->sample_rate = sample->aifc.sample_rate;
@@ -743,6 +745,9 @@ read_samples_info(soundfont *sf, xmlNodePtr samples)
         if (!sample->aifc.has_book)
             error("No vadpcm codebook for sample %s (line %d)", sample->name, sample_node->line);
 
+        // A repeated name still refers to its first definition
+        str_map_insert(&sf->samples_by_name, sample->name, sample);
+
         // link
         if (sf->samples == NULL) {
             sf->samples = sample;
@@ -979,14 +984,33 @@ samples_books_equal(sample_data *s1, sample_data *s2)
 {
     int32_t s1_order = s1->aifc.book.order;
     int32_t s1_npredictors = s1->aifc.book.npredictors;
-    int32_t s2_order = s1->aifc.book.order;
-    int32_t s2_npredictors = s1->aifc.book.npredictors;
+    int32_t s2_order = s2->aifc.book.order;
+    int32_t s2_npredictors = s2->aifc.book.npredictors;
 
     if (s1_order != s2_order || s1_npredictors != s2_npredictors)
         return false;
     return !memcmp(*s1->aifc.book_state, *s2->aifc.book_state, 8 * (unsigned)s1_order * (unsigned)s1_npredictors);
 }
 
+/**
+ * Hash of the codebook of a sample, consistent with samples_books_equal.
+ */
+static uint32_t
+sample_book_hash(sample_data *s)
+{
+    // The same bytes that samples_books_equal compares
+    const uint8_t *data = (const uint8_t *)*s->aifc.book_state;
+    size_t size = 8 * (unsigned)s->aifc.book.order * (unsigned)s->aifc.book.npredictors;
+
+    // FNV-1a
+    uint32_t hash = 0x811C9DC5;
+    hash = (hash ^ (uint32_t)s->aifc.book.order) * 0x01000193;
+    hash = (hash ^ (uint32_t)s->aifc.book.npredictors) * 0x01000193;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 0x01000193;
+    return hash;
+}
+
 /**
  * Writes all samples, their codebooks and their loops to C structures.
  */
@@ -998,6 +1022,18 @@ emit_c_samples(FILE *out, soundfont *sf)
     if (sf->samples == NULL)
         return size;
 
+    // Open addressing table of the first sample to use each distinct book, at most half full
+    size_t num_samples = 0;
+    LL_FOREACH(sample_data *, sample, sf->samples) {
+        num_samples++;
+    }
+    size_t books_cap = 16;
+    while (books_cap < 2 * num_samples)
+        books_cap *= 2;
+    sample_data **books = calloc(books_cap, sizeof(sample_data *));
+    if (books == NULL)
+        error("Could not allocate codebook table");
+
     int i = 0;
     LL_FOREACH(sample_data *, sample, sf->samples) {
         // Determine if we need to write a new book structure. If we've already emitted a book structure with the
@@ -1006,17 +1042,19 @@ emit_c_samples(FILE *out, soundfont *sf)
         bool new_book = true;
         const char *bookname = sample->name;
 
-        LL_FOREACH(sample_data *, sample2, sf->samples) {
-            if (sample2 == sample)
-                // Caught up to our current position, we need to write a new book.
+        for (size_t j = sample_book_hash(sample) & (books_cap - 1);; j = (j + 1) & (books_cap - 1)) {
+            if (books[j] == NULL) {
+                // Not seen before, we need to write a new book.
+                books[j] = sample;
                 break;
+            }
 
-            if (samples_books_equal(sample, sample2)) {
-                // A book that we've already seen is the same as this one. Since the book we are comparing to here is
-                // the first such book, this is guaranteed to have already been written and we move the reference to
+            if (samples_books_equal(sample, books[j])) {
+                // A book that we've already seen is the same as this one. Since only the first sample with a given
+                // book is in the table, this is guaranteed to have already been written and we move the reference to
                 // this one.
                 new_book = false;
-                bookname = sample2->name;
+                bookname = books[j]->name;
                 break;
             }
         }
@@ -1196,6 +1234,7 @@ emit_c_samples(FILE *out, soundfont *sf)
         }
         i++;
     }
+    free(books);
     return size;
 }
 
@@ -1591,12 +1630,16 @@ emit_h_effects(FILE *out, soundfont *sf)
 NORETURN static void
 usage(const char *progname)
 {
-    fprintf(stderr, "Usage: %s [--matching] <filename.xml> <out.c> <out.h> <out.name>\n", progname);
+    fprintf(stderr,
+            "Usage: %s [--matching] [--makedepend <out.d>] [--table-info <out.tblinfo>] <filename.xml> <out.c> <out.h> "
+            "<out.name>\n",
+            progname);
+    fprintf(stderr, "       %s --batch <manifest> [--jobs <n>]\n", progname);
     exit(EXIT_FAILURE);
 }
 
-int
-main(int argc, char **argv)
+static int
+sfc_main(int argc, char **argv)
 {
     char *filename_in = NULL;
     char *filename_out_c = NULL;
@@ -1604,6 +1647,7 @@ main(int argc, char **argv)
     char *filename_out_name = NULL;
     const char *mdfilename = NULL;
     FILE *mdfile;
+    const char *infofilename = NULL;
     xmlDocPtr document;
     soundfont sf;
 
@@ -1638,6 +1682,15 @@ main(int argc, char **argv)
                 mdfilename = argv[++i];
                 continue;
             }
+            if (strequ(argv[i], "--table-info")) {
+                if (infofilename != NULL)
+                    arg_error("Received --table-info option twice");
+                if (i + 1 == argc)
+                    arg_error("--table-info missing required argument");
+
+                infofilename = argv[++i];
+                continue;
+            }
             arg_error("Unknown option \"%s\"", argv[i]);
         } else {
             // Required args
@@ -1677,6 +1730,7 @@ main(int argc, char **argv)
     read_soundfont_info(&sf, root);
 
     sf.envelopes = sf.envelope_last = NULL;
+    str_map_init(&sf.envelopes_by_name);
 
     // read all envelopes first irrespective of their positioning in the xml
     LL_FOREACH(xmlNodePtr, node, root->children) {
@@ -1688,6 +1742,7 @@ main(int argc, char **argv)
 
     // read all samples
     sf.samples = NULL;
+    str_map_init(&sf.samples_by_name);
     LL_FOREACH(xmlNodePtr, node, root->children) {
         const char *name = XMLSTR_TO_STR(node->name);
 
@@ -1722,7 +1777,7 @@ main(int argc, char **argv)
 
     // emit C source
 
-    FILE *out_c = fopen(filename_out_c, "w");
+    FILE *out_c = util_open_output(filename_out_c, "w");
     fprintf(out_c, "#include \"soundfont_file.h\"\n\n");
 
     size_t size = 0;
@@ -1734,11 +1789,11 @@ main(int argc, char **argv)
     size += emit_c_effects(out_c, &sf);
     emit_c_match_padding(out_c, &sf, size);
 
-    fclose(out_c);
+    util_close_output(out_c, filename_out_c);
 
     // emit C header
 
-    FILE *out_h = fopen(filename_out_h, "w");
+    FILE *out_h = util_open_output(filename_out_h, "w");
     fprintf(out_h,
             // clang-format off
            "#ifndef SOUNDFONT_%d_H_"            "\n"
@@ -1775,16 +1830,32 @@ main(int argc, char **argv)
     emit_h_effects(out_h, &sf);
 
     fprintf(out_h, "#endif\n");
-    fclose(out_h);
+    util_close_output(out_h, filename_out_h);
 
     // emit name marker
 
-    FILE *out_name = fopen(filename_out_name, "wb");
+    FILE *out_name = util_open_output(filename_out_name, "wb");
     // We need to emit an explicit null terminator so that we can run objcopy --add-section to include the name
     // in a .note.name section in the compiled object file. This is so that the string that ends up in the .note.name
     // section is null-terminated, its length may be verified by any tools that read the name out of this section.
     fprintf(out_name, "%s%c", sf.info.name, '\0');
-    fclose(out_name);
+    util_close_output(out_name, filename_out_name);
+
+    // emit the summary atblgen builds the soundfont table from, with the samplebank indices already resolved, so that
+    // it does not need to parse the soundfont and samplebank xmls
+
+    if (infofilename != NULL) {
+        FILE *out_info = util_open_output(infofilename, "w");
+
+        int normal_idx = sf_samplebank_index(&sf, &sf.sb, sf.info.pointer_index);
+        int dd_idx = 255;
+        if (sf.info.bank_path_dd != NULL)
+            dd_idx = sf_samplebank_index(&sf, &sf.sbdd, sf.info.pointer_index_dd);
+
+        fprintf(out_info, "soundfont %s %d %s %s %d %d\n", sf.info.name, sf.info.index, sf.info.medium,
+                sf.info.cache_policy, normal_idx, dd_idx);
+        util_close_output(out_info, infofilename);
+    }
 
     // emit dependency file if wanted
 
@@ -1794,13 +1865,16 @@ main(int argc, char **argv)
             error("Unable to open dependency file [%s] for writing", mdfilename);
 
         // Begin rule + depend on the soundfont xml input
-        fprintf(mdfile, "%s %s %s: \\\n    %s", filename_out_c, filename_out_h, filename_out_name, filename_in);
+        fprintf(mdfile, "%s %s %s", filename_out_c, filename_out_h, filename_out_name);
+        if (infofilename != NULL)
+            fprintf(mdfile, " %s", infofilename);
+        fprintf(mdfile, ": \\\n    %s", filename_in);
 
-        // Depend on the referenced samplebank xmls
+        // Depend on the referenced samplebanks, their manifests if they were read from those
         if (sf.info.bank_path != NULL)
-            fprintf(mdfile, " \\\n    %s", sf.info.bank_path);
+            fprintf(mdfile, " \\\n    %s", sf.sb.path);
         if (sf.info.bank_path_dd != NULL)
-            fprintf(mdfile, " \\\n    %s", sf.info.bank_path_dd);
+            fprintf(mdfile, " \\\n    %s", sf.sbdd.path);
 
         // Depend on the aifc files used by this soundfont
         LL_FOREACH(sample_data *, sample, sf.samples) {
@@ -1813,6 +1887,18 @@ main(int argc, char **argv)
 
     // done
 
+    str_map_free(&sf.envelopes_by_name);
+    str_map_free(&sf.samples_by_name);
     xmlFreeDoc(document);
     return EXIT_SUCCESS;
 }
+
+int
+main(int argc, char **argv)
+{
+    xmlInitParser();
+
+    if (argc > 1 && strequ(argv[1], "--batch"))
+        return batch_main(argc, argv, sfc_main);
+    return sfc_main(argc, argv);
+}
@@ -3,6 +3,7 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
@@ -92,6 +93,138 @@ util_write_whole_file(const char *filename, const void *data, size_t size)
     fclose(file);
 }
 
+#define COMPARE_CHUNK 0x10000
+
+static long
+file_size(FILE *file)
+{
+    long size;
+
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    return size;
+}
+
+/**
+ * Whether `filename` exists and holds exactly the `size` bytes of `data`. The sizes are compared first, the contents
+ * are then read back in chunks.
+ */
+bool
+util_file_has_content(const char *filename, const void *data, size_t size)
+{
+    FILE *file = fopen(filename, "rb");
+    const uint8_t *expected = data;
+    uint8_t buffer[COMPARE_CHUNK];
+    bool same;
+
+    if (file == NULL)
+        return false;
+
+    same = (size_t)file_size(file) == size;
+    while (same && size != 0) {
+        size_t chunk = (size < sizeof(buffer)) ? size : sizeof(buffer);
+
+        same = fread(buffer, chunk, 1, file) == 1 && memcmp(buffer, expected, chunk) == 0;
+        expected += chunk;
+        size -= chunk;
+    }
+    fclose(file);
+    return same;
+}
+
+/**
+ * Writes `data` to `filename` only if it doesn't already hold exactly that, so that its timestamp is kept and make
+ * doesn't rebuild what depends on it. Returns whether the file was written.
+ */
+bool
+util_write_whole_file_if_changed(const char *filename, const void *data, size_t size)
+{
+    if (util_file_has_content(filename, data, size))
+        return false;
+
+    util_write_whole_file(filename, data, size);
+    return true;
+}
+
+static char *
+output_tmp_name(const char *filename)
+{
+    char *tmp_name = malloc(strlen(filename) + sizeof(".tmp"));
+
+    if (tmp_name == NULL)
+        error("out of memory");
+    strcpy(tmp_name, filename);
+    strcat(tmp_name, ".tmp");
+    return tmp_name;
+}
+
+static bool
+files_equal(const char *filename_a, const char *filename_b)
+{
+    FILE *file_a = fopen(filename_a, "rb");
+    FILE *file_b = fopen(filename_b, "rb");
+    uint8_t buffer_a[COMPARE_CHUNK];
+    uint8_t buffer_b[COMPARE_CHUNK];
+    bool same = file_a != NULL && file_b != NULL && file_size(file_a) == file_size(file_b);
+
+    while (same) {
+        size_t read_a = fread(buffer_a, 1, sizeof(buffer_a), file_a);
+        size_t read_b = fread(buffer_b, 1, sizeof(buffer_b), file_b);
+
+        same = read_a == read_b && memcmp(buffer_a, buffer_b, read_a) == 0;
+        if (read_a < sizeof(buffer_a))
+            break;
+    }
+
+    if (file_a != NULL)
+        fclose(file_a);
+    if (file_b != NULL)
+        fclose(file_b);
+    return same;
+}
+
+/**
+ * Opens a temporary file next to `filename` to write its new contents to, see util_close_output.
+ */
+FILE *
+util_open_output(const char *filename, const char *mode)
+{
+    char *tmp_name = output_tmp_name(filename);
+    FILE *file = fopen(tmp_name, mode);
+
+    if (file == NULL)
+        error("failed to open file '%s' for writing: %s", tmp_name, strerror(errno));
+    free(tmp_name);
+    return file;
+}
+
+/**
+ * Closes a file opened with util_open_output and moves it over `filename`, unless `filename` already had the same
+ * contents. Returns whether `filename` was written.
+ */
+bool
+util_close_output(FILE *file, const char *filename)
+{
+    char *tmp_name = output_tmp_name(filename);
+    bool written;
+
+    if (ferror(file) || fclose(file) != 0)
+        error("error writing to file '%s'", tmp_name);
+
+    written = !files_equal(tmp_name, filename);
+    if (!written) {
+        remove(tmp_name);
+    } else {
+        remove(filename);
+        if (rename(tmp_name, filename) != 0)
+            error("failed to replace file '%s': %s", filename, strerror(errno));
+    }
+
+    free(tmp_name);
+    return written;
+}
+
 bool
 str_is_c_identifier(const char *str)
 {
@@ -141,3 +274,92 @@ str_is_c_identifier(const char *str)
     }
     return true;
 }
+
+static size_t
+str_hash(const char *str)
+{
+    // FNV-1a
+    uint32_t hash = 0x811C9DC5;
+
+    for (; *str != '\0'; str++) {
+        hash ^= (uint8_t)*str;
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+void
+str_map_init(str_map *map)
+{
+    map->keys = NULL;
+    map->values = NULL;
+    map->num = 0;
+    map->cap = 0;
+}
+
+void *
+str_map_get(const str_map *map, const char *key)
+{
+    if (map->cap == 0)
+        return NULL;
+
+    for (size_t i = str_hash(key) & (map->cap - 1);; i = (i + 1) & (map->cap - 1)) {
+        if (map->keys[i] == NULL)
+            return NULL;
+        if (strequ(map->keys[i], key))
+            return map->values[i];
+    }
+}
+
+static void
+str_map_put(str_map *map, const char *key, void *value)
+{
+    size_t i = str_hash(key) & (map->cap - 1);
+
+    while (map->keys[i] != NULL)
+        i = (i + 1) & (map->cap - 1);
+
+    map->keys[i] = key;
+    map->values[i] = value;
+    map->num++;
+}
+
+/**
+ * Adds `key` to the map if it is not already in it. Returns false and leaves the map as it was if it is, so that
+ * lookups keep finding the first value added for a key.
+ */
+bool
+str_map_insert(str_map *map, const char *key, void *value)
+{
+    if (str_map_get(map, key) != NULL)
+        return false;
+
+    // Keep the load factor at or below 1/2 so that probe sequences stay short
+    if (2 * (map->num + 1) > map->cap) {
+        str_map old = *map;
+
+        map->cap = (old.cap == 0) ? 16 : 2 * old.cap;
+        map->num = 0;
+        map->keys = calloc(map->cap, sizeof(const char *));
+        map->values = malloc(map->cap * sizeof(void *));
+        if (map->keys == NULL || map->values == NULL)
+            error("Could not allocate %lu entries for string map", map->cap);
+
+        for (size_t i = 0; i < old.cap; i++) {
+            if (old.keys[i] != NULL)
+                str_map_put(map, old.keys[i], old.values[i]);
+        }
+        str_map_free(&old);
+    }
+
+    str_map_put(map, key, value);
+    return true;
+}
+
+void
+str_map_free(str_map *map)
+{
+    free(map->keys);
+    free(map->values);
+    str_map_init(map);
+}
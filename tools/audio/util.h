@@ -5,6 +5,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
 // Endian
@@ -65,8 +66,35 @@ void *
 util_read_whole_file(const char *filename, size_t *size_out);
 void
 util_write_whole_file(const char *filename, const void *data, size_t size);
+bool
+util_file_has_content(const char *filename, const void *data, size_t size);
+bool
+util_write_whole_file_if_changed(const char *filename, const void *data, size_t size);
+FILE *
+util_open_output(const char *filename, const char *mode);
+bool
+util_close_output(FILE *file, const char *filename);
 
 bool
 str_is_c_identifier(const char *str);
 
+// String-keyed hash map, open addressing with linear probing. Keys are not copied and must outlive the map, values
+// must not be NULL.
+
+typedef struct {
+    const char **keys;
+    void **values;
+    size_t num;
+    size_t cap; // 0 or a power of 2
+} str_map;
+
+void
+str_map_init(str_map *map);
+void *
+str_map_get(const str_map *map, const char *key);
+bool
+str_map_insert(str_map *map, const char *key, void *value);
+void
+str_map_free(str_map *map);
+
 #endif
@@ -0,0 +1,201 @@
+
+// SPDX-FileCopyrightText: © 2024 ZeldaRET
+// SPDX-License-Identifier: CC0-1.0
+
+// Usage: ccwrap [flags] -- [compile command minus input file...] [single input file]
+// Flags:
+//    -v VERSION (required)
+// Compiles a C file as tools/buildtools/preprocess.sh does, after:
+// * Re-encoding it from UTF-8 to EUC-JP
+//   (the repo uses UTF-8 for text encoding, but the strings in the ROM are encoded in EUC-JP)
+// * Replacing `#pragma increment_block_number` (see preprocess_pragmas.c)
+// Both are done in this process with iconv(3), instead of with a shell, preprocess_pragmas and iconv for every
+// file. Most files are ASCII and have no such pragma, those are compiled from where they are and ccwrap is only
+// replaced by the compiler. The others are compiled from a temporary file, IDO can't read its input from a pipe.
+
+#define _XOPEN_SOURCE 700
+
+#include <dirent.h>
+#include <errno.h>
+#include <iconv.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "preprocess_pragmas.h"
+#include "util.h"
+
+static const char str_pragma[] = "#pragma increment_block_number";
+
+static void usage(void) {
+    fprintf(stderr, "Usage: ccwrap -v VERSION -- [compile command...] [source file]\n");
+    exit(EXIT_FAILURE);
+}
+
+// Whether the source can't be compiled as it is: it has text other than ASCII or a pragma to replace
+static bool needs_preprocessing(const char* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if ((unsigned char)data[i] >= 0x80)
+            return true;
+    }
+    for (const char* p = data; (p = strstr(p, str_pragma)) != NULL; p++) {
+        if (p == data || p[-1] == '\n')
+            return true;
+    }
+    return false;
+}
+
+// Re-encodes UTF-8 to EUC-JP, returns a malloc'd buffer
+static char* to_euc_jp(const char* filename, char* in, size_t in_size, size_t* out_size) {
+    iconv_t cd = iconv_open("EUC-JP", "UTF-8");
+    // no character is more than 1.5 times as long in EUC-JP
+    size_t out_cap = in_size * 2;
+    char* out = malloc(out_cap);
+    char* inp = in;
+    char* outp = out;
+    size_t in_left = in_size;
+    size_t out_left = out_cap;
+
+    if (cd == (iconv_t)-1)
+        util_fatal_error("iconv can't convert from UTF-8 to EUC-JP: %s", strerror(errno));
+    if (iconv(cd, &inp, &in_left, &outp, &out_left) == (size_t)-1)
+        util_fatal_error("can't convert '%s' to EUC-JP at byte %lu of the preprocessed source: %s", filename,
+                         (unsigned long)(inp - in), strerror(errno));
+    iconv_close(cd);
+
+    *out_size = outp - out;
+    return out;
+}
+
+// Runs the command and returns its exit status
+static int run(char** argv) {
+    pid_t pid = fork();
+    int status;
+
+    if (pid < 0)
+        util_fatal_error("fork failed: %s", strerror(errno));
+    if (pid == 0) {
+        execvp(argv[0], argv);
+        fprintf(stderr, "Failed to run '%s': %s\n", argv[0], strerror(errno));
+        _exit(127);
+    }
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR)
+            util_fatal_error("waitpid failed: %s", strerror(errno));
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : EXIT_FAILURE;
+}
+
+// Removes the temporary directory with everything the compiler left in it
+static void remove_dir(const char* dirname) {
+    DIR* dir = opendir(dirname);
+    struct dirent* entry;
+
+    if (dir != NULL) {
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+                char path[strlen(dirname) + strlen(entry->d_name) + 2];
+
+                sprintf(path, "%s/%s", dirname, entry->d_name);
+                remove(path);
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(dirname);
+}
+
+int main(int argc, char** argv) {
+    const char* version = NULL;
+    int sep = 1;
+
+    for (; sep < argc && strcmp(argv[sep], "--") != 0; sep++) {
+        if (strcmp(argv[sep], "-v") == 0 && sep + 1 < argc && strcmp(argv[sep + 1], "--") != 0) {
+            version = argv[++sep];
+        } else {
+            fprintf(stderr, "Error: Bad flag '%s'\n", argv[sep]);
+            usage();
+        }
+    }
+    if (version == NULL) {
+        fprintf(stderr, "Missing -v\n");
+        usage();
+    }
+    // at least the compiler and the source file after --
+    if (argc - sep < 3)
+        usage();
+
+    char** compilecmd = &argv[sep + 1];
+    const int compilecmd_len = argc - sep - 2;
+    const char* srcfile = argv[argc - 1];
+
+    // Also include the source file's directory to have the include path as if the original source was compiled,
+    // wherever it is compiled from
+    char* srcdir = strdup(srcfile);
+    char* slash = strrchr(srcdir, '/');
+    if (slash == NULL)
+        strcpy(srcdir, ".");
+    else if (slash == srcdir)
+        slash[1] = '\0';
+    else
+        *slash = '\0';
+    const char* basename = strrchr(srcfile, '/') != NULL ? strrchr(srcfile, '/') + 1 : srcfile;
+
+    // the compile command, -I, the directory, the file and the NULL
+    char** cmd = malloc((compilecmd_len + 4) * sizeof(char*));
+    memcpy(cmd, compilecmd, compilecmd_len * sizeof(char*));
+    cmd[compilecmd_len + 0] = "-I";
+    cmd[compilecmd_len + 1] = srcdir;
+    cmd[compilecmd_len + 3] = NULL;
+
+    size_t size;
+    char* data = util_read_whole_file(srcfile, &size);
+
+    if (getenv("VERBOSE") != NULL) {
+        fprintf(stderr, "ccwrap: version=%s srcfile=%s compilecmd=", version, srcfile);
+        for (int i = 0; i < compilecmd_len; i++)
+            fprintf(stderr, "%s%s", i ? " " : "", compilecmd[i]);
+        fputc('\n', stderr);
+    }
+
+    if (!needs_preprocessing(data, size)) {
+        cmd[compilecmd_len + 2] = (char*)srcfile;
+        execvp(cmd[0], cmd);
+        util_fatal_error("failed to run '%s': %s", cmd[0], strerror(errno));
+    }
+
+    // Preprocess pragmas and re-encode from UTF-8 to EUC-JP
+    char* pre;
+    size_t pre_size;
+    FILE* in = fmemopen(data, size, "r");
+    FILE* out = open_memstream(&pre, &pre_size);
+    if (in == NULL || out == NULL)
+        util_fatal_error("can't open the buffers for '%s': %s", srcfile, strerror(errno));
+    fprintf(out, "#line 1 \"%s\"\n", srcfile); // linemarker
+    if (preprocess_pragmas(version, srcfile, in, out) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    fclose(in);
+    fclose(out);
+
+    size_t euc_size;
+    char* euc = to_euc_jp(srcfile, pre, pre_size, &euc_size);
+
+    // Write it to a temporary directory, in a file named like the original one: ido_block_numbers.py and
+    // fix_bss.py need the symbol table .T file from IDO, which is always named like the input file
+    const char* tmpdir = getenv("TMPDIR") != NULL ? getenv("TMPDIR") : "/tmp";
+    char tempdir[strlen(tmpdir) + sizeof("/ccwrap.XXXXXX")];
+    sprintf(tempdir, "%s/ccwrap.XXXXXX", tmpdir);
+    if (mkdtemp(tempdir) == NULL)
+        util_fatal_error("failed to create a temporary directory in '%s': %s", tmpdir, strerror(errno));
+    char tempfile[strlen(tempdir) + strlen(basename) + 2];
+    sprintf(tempfile, "%s/%s", tempdir, basename);
+    util_write_whole_file(tempfile, euc, euc_size);
+
+    cmd[compilecmd_len + 2] = tempfile;
+    const int status = run(cmd);
+    remove_dir(tempdir);
+    return status;
+}
@@ -7,6 +7,8 @@ from __future__ import annotations
 
 import argparse
 import ipl3checksum
+import mmap
+import os
 from pathlib import Path
 import struct
 from typing import BinaryIO
@@ -17,20 +19,26 @@ def round_up(n: int, shift: int) -> int:
     return (n + mod - 1) >> shift << shift
 
 
-def pad_rom(f: BinaryIO, rom_len: int):
+def pad_rom(f: BinaryIO, rom_len: int) -> int:
+    """
+    Pads the open rom file with 0x00 to a multiple of 4 KiB, then with 0xFF to a multiple of 128 KiB, and returns the
+    padded size. Growing the file with ftruncate fills it with 0x00, only the 0xFF part is written.
+    """
     fill_00 = round_up(rom_len, 12)
     fill_FF = round_up(fill_00, 17)
 
-    f.seek(rom_len)
-
-    if fill_00 > rom_len:
-        f.write(b"\0" * (fill_00 - rom_len))
+    if fill_FF > rom_len:
+        os.ftruncate(f.fileno(), fill_FF)
     if fill_FF > fill_00:
+        f.seek(fill_00)
         f.write(b"\xFF" * (fill_FF - fill_00))
+    return fill_FF
 
 
-def update_checksum(f: BinaryIO, detect: bool):
-    rom_bytes = f.read(0x101000)
+def update_checksum(rom: bytearray | memoryview | mmap.mmap, detect: bool):
+    """Writes the checksum of the rom to its header, in the writable buffer"""
+    # The checksum only covers the first MiB after the IPL3, that's all that is read
+    rom_bytes = bytes(rom[:0x101000])
     assert len(rom_bytes) == 0x101000, "Small ROM?"
 
     # Detect CIC
@@ -47,9 +55,7 @@ def update_checksum(f: BinaryIO, detect: bool):
     assert calculatedChecksum is not None, "Not able to calculate checksum"
 
     # Write checksum
-    checksum_bytes = struct.pack(f">II", calculatedChecksum[0], calculatedChecksum[1])
-    f.seek(0x10)
-    f.write(checksum_bytes)
+    struct.pack_into(f">II", rom, 0x10, calculatedChecksum[0], calculatedChecksum[1])
 
 
 def checksummer_main():
@@ -72,7 +78,9 @@ def checksummer_main():
     rom_len = rom_path.stat().st_size
 
     with rom_path.open("rb+") as f:
-        update_checksum(f, detect)
+        # Only the checksummed part is read and only the header and the padding are written, not the whole rom
+        with mmap.mmap(f.fileno(), 0) as rom:
+            update_checksum(rom, detect)
         pad_rom(f, rom_len)
 
 
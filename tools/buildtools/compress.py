@@ -8,12 +8,18 @@ from __future__ import annotations
 import argparse
 from pathlib import Path
 import dataclasses
+import hashlib
+import importlib.metadata
+import os
+import subprocess
+import threading
 import time
 import multiprocessing
 import multiprocessing.pool
 
 import crunch64
 
+from checksummer import update_checksum
 import dmadata
 
 
@@ -30,12 +36,65 @@ class RomSegment:
     is_syms: bool
     data: memoryview | None
     data_async: multiprocessing.pool.AsyncResult | None
+    cache_key: str | None = None
 
     @property
     def uncompressed_size(self):
         return self.vrom_end - self.vrom_start
 
 
+class CompressionCache:
+    """
+    Yaz0 output of previous runs, one file per segment named after the hash of
+    its uncompressed data, so that only segments that changed are compressed again.
+    """
+
+    def __init__(self, path: Path, yaz0_tool: str | None = None):
+        self.path = path
+        self.path.mkdir(parents=True, exist_ok=True)
+        self.used_keys: set[str] = set()
+
+        # Output may change with the compressor version
+        if yaz0_tool is not None:
+            self.compressor_version = (
+                "yaz0 " + hashlib.sha256(Path(yaz0_tool).read_bytes()).hexdigest()
+            )
+        else:
+            try:
+                self.compressor_version = importlib.metadata.version("crunch64")
+            except importlib.metadata.PackageNotFoundError:
+                self.compressor_version = "unknown"
+
+    def key(self, data: bytes | memoryview):
+        h = hashlib.sha256(self.compressor_version.encode())
+        h.update(data)
+        return h.hexdigest()
+
+    def _file(self, key: str):
+        return self.path / f"{key}.yaz0"
+
+    def get(self, key: str):
+        self.used_keys.add(key)
+        try:
+            return self._file(key).read_bytes()
+        except FileNotFoundError:
+            return None
+
+    def put(self, key: str, data: bytes):
+        self.used_keys.add(key)
+        # Write to a temporary file first so that an interrupted run can't leave a truncated entry.
+        # It is named after the writer too, makeyar.py runs may put the same entry at the same time
+        tmp = self.path / f"{key}.{os.getpid()}.{threading.get_ident()}.tmp"
+        tmp.write_bytes(data)
+        os.replace(tmp, self._file(key))
+
+    def prune(self):
+        """Remove the entries that were not used by this run"""
+        for p in self.path.iterdir():
+            if p.suffix in {".yaz0", ".tmp"} and p.stem not in self.used_keys:
+                p.unlink()
+
+
 # Make interrupting the compression with ^C less jank
 # https://stackoverflow.com/questions/72967793/keyboardinterrupt-with-python-multiprocessing-pool
 def set_sigint_ignored():
@@ -44,17 +103,31 @@ def set_sigint_ignored():
     signal.signal(signal.SIGINT, signal.SIG_IGN)
 
 
+def compress_yaz0_native(yaz0_tool: str, n_threads: int, data: bytes):
+    """Compress with the native compressor built from yaz0.c, which produces the same output as crunch64"""
+    return subprocess.run(
+        [yaz0_tool, "-j", str(n_threads), "-", "-"],
+        input=data,
+        stdout=subprocess.PIPE,
+        check=True,
+    ).stdout
+
+
 def compress_rom(
     rom_data: memoryview,
     dmadata_start: int,
     compress_entries_indices: set[int],
     n_threads: int = None,
+    cache: CompressionCache | None = None,
+    yaz0_tool: str | None = None,
 ):
     """
     rom_data: the uncompressed rom data
     dmadata_start: the offset in the rom where the dmadata starts
     compress_entries_indices: the indices in the dmadata of the segments that should be compressed
     n_threads: how many cores to use for compression
+    cache: if given, where to reuse the compressed data of unchanged segments from
+    yaz0_tool: if given, the native compressor to use instead of crunch64
     """
 
     # Segments of the compressed rom (not all are compressed)
@@ -75,13 +148,27 @@ def compress_rom(
             segment_data_uncompressed = rom_data[segment_rom_start:segment_rom_end]
 
             is_compressed = entry_index in compress_entries_indices
+            cache_key = None
 
             if is_compressed:
                 segment_data = None
-                segment_data_async = p.apply_async(
-                    crunch64.yaz0.compress,
-                    (bytes(segment_data_uncompressed),),
-                )
+                segment_data_async = None
+                if cache is not None:
+                    cache_key = cache.key(segment_data_uncompressed)
+                    cached_data = cache.get(cache_key)
+                    if cached_data is not None:
+                        segment_data = memoryview(cached_data)
+                if segment_data is None and yaz0_tool is not None:
+                    # Segments large enough are also split across threads by the compressor itself
+                    segment_data_async = p.apply_async(
+                        compress_yaz0_native,
+                        (yaz0_tool, n_threads or 1, bytes(segment_data_uncompressed)),
+                    )
+                elif segment_data is None:
+                    segment_data_async = p.apply_async(
+                        crunch64.yaz0.compress,
+                        (bytes(segment_data_uncompressed),),
+                    )
             else:
                 segment_data = segment_data_uncompressed
                 segment_data_async = None
@@ -94,13 +181,24 @@ def compress_rom(
                     dma_entry.is_syms(),
                     segment_data,
                     segment_data_async,
+                    cache_key,
                 )
             )
 
-        # Wait on compression of all compressed segments
+        # Wait on compression of all compressed segments that were not in the cache
         waiting_on_segments = [
-            segment for segment in compressed_rom_segments if segment.is_compressed
+            segment
+            for segment in compressed_rom_segments
+            if segment.data_async is not None
         ]
+        if cache is not None:
+            n_compressed = sum(
+                segment.is_compressed for segment in compressed_rom_segments
+            )
+            print(
+                f"Reusing {n_compressed - len(waiting_on_segments)} cached segments,"
+                f" compressing {len(waiting_on_segments)}"
+            )
         total_uncompressed_size_of_data_to_compress = sum(
             segment.uncompressed_size for segment in waiting_on_segments
         )
@@ -130,6 +228,8 @@ def compress_rom(
                     # Compression finished!
                     assert isinstance(compressed_data, bytes)
                     segment.data = memoryview(compressed_data)
+                    if cache is not None:
+                        cache.put(segment.cache_key, compressed_data)
                     uncompressed_size_of_data_compressed_so_far += (
                         segment.uncompressed_size
                     )
@@ -142,6 +242,9 @@ def compress_rom(
 
             waiting_on_segments = still_waiting_on_segments
 
+    if cache is not None:
+        cache.prune()
+
     print("Putting together the compressed rom...")
 
     # Put together the compressed rom
@@ -239,6 +342,26 @@ def main():
         default=1,
         help="how many cores to use for parallel compression",
     )
+    parser.add_argument(
+        "--cache",
+        dest="cache_dir",
+        default=None,
+        help=(
+            "directory to keep the compressed data of each segment in, to reuse"
+            " it for segments that are unchanged in later runs"
+        ),
+    )
+    parser.add_argument(
+        "--checksum",
+        action="store_true",
+        help="update the header checksum of the compressed rom (for the 6105 CIC) before writing it",
+    )
+    parser.add_argument(
+        "--yaz0",
+        dest="yaz0_tool",
+        default=None,
+        help="path to the native yaz0 compressor to use instead of crunch64",
+    )
     args = parser.parse_args()
 
     in_rom_p = Path(args.in_rom)
@@ -270,13 +393,24 @@ def main():
 
     n_threads = args.n_threads
 
+    cache = (
+        CompressionCache(Path(args.cache_dir), args.yaz0_tool)
+        if args.cache_dir
+        else None
+    )
+
     in_rom_data = in_rom_p.read_bytes()
     out_rom_data = compress_rom(
         memoryview(in_rom_data),
         dmadata_start,
         compress_entries_indices,
         n_threads,
+        cache,
+        args.yaz0_tool,
     )
+    if args.checksum:
+        # Here rather than with ipl3checksum afterwards, which reads and writes the whole rom again
+        update_checksum(out_rom_data, False)
     out_rom_p.write_bytes(out_rom_data)
 
 
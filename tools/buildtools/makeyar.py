@@ -27,6 +27,12 @@
 # its own Yaz0 compressed file, appending them in order for the generated
 # archive. Other elf sections are ignored for the resulting yar file.
 #
+# Each symbol is compressed on its own, so they are compressed on as many
+# threads as --threads gives (crunch64 doesn't hold the GIL while it works).
+# With --cache, the compressed symbols are kept in the same kind of cache
+# compress.py keeps the ROM's segments in, keyed by their uncompressed bytes,
+# and a texture that didn't change is not compressed again.
+#
 # The program also outputs an elf file that's identical to the elf input,
 # but with its .data section zero'ed out completely. This "symbols" elf can be
 # used for referencing each symbol as the whole file were completely
@@ -35,13 +41,13 @@
 from __future__ import annotations
 
 import argparse
+from concurrent.futures import ThreadPoolExecutor
 import dataclasses
 from pathlib import Path
 import struct
 import crunch64
 
-from elftools.elf.elffile import ELFFile
-from elftools.elf.sections import SymbolTableSection
+from compress import CompressionCache
 
 
 def write_word_as_bytes(buff: bytearray, offset: int, word: int):
@@ -55,29 +61,71 @@ class Symbol:
     size: int
 
 
-def get_data_from_elf(elf_path: Path) -> tuple[bytearray, list[Symbol], int]:
+# Only the parts of ELF32 that are read here
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHN_UNDEF = 0
+STT_OBJECT = 1
+
+
+@dataclasses.dataclass
+class Section:
+    name: str
+    type: int
+    offset: int
+    size: int
+    link: int
+
+
+def read_sections(elf: bytes) -> tuple[str, list[Section]]:
+    """Returns the struct byte order of the elf and its section headers"""
+    assert elf[:4] == b"\x7fELF" and elf[4] == 1, "not an ELF32 file"
+    endian = ">" if elf[5] == 2 else "<"
+    shoff = struct.unpack_from(f"{endian}I", elf, 0x20)[0]
+    shentsize, shnum, shstrndx = struct.unpack_from(f"{endian}HHH", elf, 0x2E)
+
+    headers = [
+        struct.unpack_from(f"{endian}IIIIIIIIII", elf, shoff + i * shentsize)
+        for i in range(shnum)
+    ]
+    shstrtab_offset = headers[shstrndx][4]
+    sections = []
+    for sh_name, sh_type, _, _, sh_offset, sh_size, sh_link, _, _, _ in headers:
+        name_end = elf.index(b"\0", shstrtab_offset + sh_name)
+        name = elf[shstrtab_offset + sh_name : name_end].decode()
+        sections.append(Section(name, sh_type, sh_offset, sh_size, sh_link))
+    return endian, sections
+
+
+def get_data_from_elf(elf: bytes) -> tuple[bytearray, list[Symbol], int]:
     uncompressed_data = bytearray()
     symbol_list: list[Symbol] = []
     data_offset = -1
 
-    with elf_path.open("rb") as elfFile:
-        elf = ELFFile(elfFile)
-        for section in elf.iter_sections():
-            if section.name == ".data":
-                assert len(uncompressed_data) == 0
-                uncompressed_data.extend(section.data())
-                assert len(uncompressed_data) == section["sh_size"]
-                data_offset = section["sh_offset"]
-            elif section.name == ".symtab":
-                assert isinstance(section, SymbolTableSection)
-                for sym in section.iter_symbols():
-                    if sym["st_shndx"] == "SHN_UNDEF":
-                        continue
-                    if sym["st_info"]["type"] != "STT_OBJECT":
-                        continue
-                    symbol_list.append(
-                        Symbol(sym.name, sym["st_value"], sym["st_size"])
-                    )
+    endian, sections = read_sections(elf)
+    for section in sections:
+        if section.name == ".data":
+            assert len(uncompressed_data) == 0
+            assert section.type != SHT_NOBITS
+            uncompressed_data.extend(
+                elf[section.offset : section.offset + section.size]
+            )
+            assert len(uncompressed_data) == section.size
+            data_offset = section.offset
+        elif section.name == ".symtab":
+            assert section.type == SHT_SYMTAB
+            strtab = sections[section.link]
+            for offset in range(section.offset, section.offset + section.size, 0x10):
+                st_name, st_value, st_size, st_info, _, st_shndx = struct.unpack_from(
+                    f"{endian}IIIBBH", elf, offset
+                )
+                if st_shndx == SHN_UNDEF:
+                    continue
+                if st_info & 0xF != STT_OBJECT:
+                    continue
+                name_end = elf.index(b"\0", strtab.offset + st_name)
+                name = elf[strtab.offset + st_name : name_end].decode()
+                symbol_list.append(Symbol(name, st_value, st_size))
     return uncompressed_data, symbol_list, data_offset
 
 
@@ -85,8 +133,22 @@ def align_16(val: int) -> int:
     return (val + 0xF) & ~0xF
 
 
+def compress_symbol(data: bytes, cache: CompressionCache | None) -> bytes:
+    if cache is None:
+        return crunch64.yaz0.compress(data)
+    key = cache.key(data)
+    compressed = cache.get(key)
+    if compressed is None:
+        compressed = crunch64.yaz0.compress(data)
+        cache.put(key, compressed)
+    return compressed
+
+
 def create_archive(
-    uncompressed_data: bytearray, symbol_list: list[Symbol]
+    uncompressed_data: bytearray,
+    symbol_list: list[Symbol],
+    n_threads: int = 1,
+    cache: CompressionCache | None = None,
 ) -> bytearray:
     archive = bytearray()
 
@@ -99,7 +161,7 @@ def create_archive(
 
     offset = first_entry_offset
 
-    i = 0
+    inputs = []
     for sym in symbol_list:
         uncompressed_size = sym.size
         uncompressed_size_aligned = align_16(uncompressed_size)
@@ -108,22 +170,29 @@ def create_archive(
         # Make sure to pad each entry to a 0x10 boundary
         if uncompressed_size_aligned > uncompressed_size:
             input_buf.extend([0x00] * (uncompressed_size_aligned - uncompressed_size))
+        inputs.append(bytes(input_buf))
+
+    i = 0
+    with ThreadPoolExecutor(n_threads) as executor:
+        # map keeps the order of the symbols
+        compressed_list = executor.map(lambda data: compress_symbol(data, cache), inputs)
 
-        compressed = bytearray(crunch64.yaz0.compress(input_buf))
-        compressed_size = len(compressed)
+        for compressed in compressed_list:
+            compressed = bytearray(compressed)
+            compressed_size = len(compressed)
 
-        # Pad to 0x10
-        compressed_size_aligned = align_16(compressed_size)
-        if compressed_size_aligned > compressed_size:
-            compressed.extend([0xFF] * (compressed_size_aligned - compressed_size))
+            # Pad to 0x10
+            compressed_size_aligned = align_16(compressed_size)
+            if compressed_size_aligned > compressed_size:
+                compressed.extend([0xFF] * (compressed_size_aligned - compressed_size))
 
-        archive.extend(compressed)
+            archive.extend(compressed)
 
-        if i > 0:
-            write_word_as_bytes(archive, i * 4, offset - first_entry_offset)
+            if i > 0:
+                write_word_as_bytes(archive, i * 4, offset - first_entry_offset)
 
-        i += 1
-        offset += len(compressed)
+            i += 1
+            offset += len(compressed)
 
     write_word_as_bytes(archive, i * 4, offset - first_entry_offset)
 
@@ -144,6 +213,22 @@ def main():
         "out_bin", help="Output path for the generated compressed yar binary"
     )
     parser.add_argument("out_sym", help="Output path for the generated syms elf file")
+    parser.add_argument(
+        "--threads",
+        dest="n_threads",
+        type=int,
+        default=1,
+        help="how many threads to compress the symbols on",
+    )
+    parser.add_argument(
+        "--cache",
+        dest="cache_dir",
+        default=None,
+        help=(
+            "directory to keep the compressed data of each symbol in, to reuse"
+            " it for symbols that are unchanged in later runs"
+        ),
+    )
 
     args = parser.parse_args()
 
@@ -157,12 +242,15 @@ def main():
 
     elf_bytes = bytearray(in_path.read_bytes())
 
-    uncompressed_data, symbol_list, data_offset = get_data_from_elf(in_path)
+    uncompressed_data, symbol_list, data_offset = get_data_from_elf(elf_bytes)
     assert len(uncompressed_data) > 0
     assert len(symbol_list) > 0
     assert data_offset > 0
 
-    archive = create_archive(uncompressed_data, symbol_list)
+    # Not pruned: every run only sees the symbols of one archive
+    cache = CompressionCache(Path(args.cache_dir)) if args.cache_dir else None
+
+    archive = create_archive(uncompressed_data, symbol_list, args.n_threads, cache)
 
     # Write the compressed archive file as a raw binary
     out_bin_path.write_bytes(archive)
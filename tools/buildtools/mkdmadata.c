@@ -73,7 +73,7 @@ static void usage(const char *execname)
 {
     fprintf(stderr, "zelda64 dmadata generation tool v0.01\n"
                     "usage: %s SPEC_FILE DMADATA_TABLE COMPRESS_RANGES\n"
-                    "SPEC_FILE       file describing the organization of object files into segments\n"
+                    "SPEC_FILE       file describing the organization of object files into segments, or the table from mkspectable\n"
                     "DMADATA_TABLE   filename of output dmadata table header\n"
                     "COMPRESS_RANGES filename to write which files are compressed (e.g. 0-5,7,10-20)\n",
                     execname);
@@ -84,7 +84,6 @@ int main(int argc, char **argv)
     FILE *dmaout;
     FILE *compress_ranges_out;
     void *spec;
-    size_t size;
 
     if (argc != 4)
     {
@@ -92,20 +91,16 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    spec = util_read_whole_file(argv[1], &size);
-    parse_rom_spec(spec, &g_segments, &g_segmentsCount);
+    spec = load_rom_spec(argv[1], &g_segments, &g_segmentsCount);
 
-    dmaout = fopen(argv[2], "w");
-    if (dmaout == NULL)
-        util_fatal_error("failed to open file '%s' for writing", argv[2]);
+    // Both are left untouched if unchanged, so that what includes them isn't rebuilt
+    dmaout = util_open_output(argv[2]);
     write_dmadata_table(dmaout);
-    fclose(dmaout);
+    util_close_output(dmaout, argv[2]);
 
-    compress_ranges_out = fopen(argv[3], "w");
-    if (compress_ranges_out == NULL)
-        util_fatal_error("failed to open file '%s' for writing", argv[3]);
+    compress_ranges_out = util_open_output(argv[3]);
     write_compress_ranges(compress_ranges_out);
-    fclose(compress_ranges_out);
+    util_close_output(compress_ranges_out, argv[3]);
 
     free_rom_spec(g_segments, g_segmentsCount);
     free(spec);
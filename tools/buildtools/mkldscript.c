@@ -21,6 +21,9 @@
 struct Segment *g_segments;
 int g_segmentsCount;
 
+// The paths of the partial objects replacing the includes of overlay segments, malloc'd, NULL for other segments
+char **g_partialObjPaths;
+
 static void write_ld_script(FILE *fout)
 {
     int i;
@@ -228,12 +231,150 @@ static void write_ld_script(FILE *fout)
     fputs("}\n", fout);
 }
 
+// Whether the segment is an overlay, i.e. its last include is its own "<name>_reloc.o". In partial mode those are
+// linked on their own with `ld -r` first, see write_partial_ld_script.
+static bool is_overlay_segment(const struct Segment *seg)
+{
+    const char *fpath;
+    size_t nameLen = strlen(seg->name);
+    size_t pathLen;
+
+    if (seg->includesCount == 0)
+        return false;
+
+    fpath = seg->includes[seg->includesCount - 1].fpath;
+    pathLen = strlen(fpath);
+    if (pathLen < nameLen + strlen("_reloc.o"))
+        return false;
+
+    fpath += pathLen - nameLen - strlen("_reloc.o");
+    return (fpath == seg->includes[seg->includesCount - 1].fpath || fpath[-1] == '/') &&
+           strncmp(fpath, seg->name, nameLen) == 0 && strcmp(fpath + nameLen, "_reloc.o") == 0;
+}
+
+// Script for `ld -r` linking the includes of an overlay segment into one object. Each output section holds what
+// write_ld_script places in the matching part of the segment, in the same order and with the same alignment and
+// padding, so that the final link lays out the partial object exactly as it would the files it was made from.
+// Sections not listed (relocations, .mdebug, ...) are kept by `ld -r` for the final link to handle as before.
+static void write_partial_ld_script(FILE *fout, const struct Segment *seg)
+{
+    int j;
+
+    // Commons are allocated here, since the final link would otherwise place them after all of the .bss
+    fputs("OUTPUT_ARCH (mips)\n\n"
+          "FORCE_COMMON_ALLOCATION\n\n"
+          "SECTIONS {\n"
+          "    .text 0 :\n    {\n",
+          fout);
+    for (j = 0; j < seg->includesCount; j++)
+    {
+        fprintf(fout, "            %s (.text)\n", seg->includes[j].fpath);
+        if (seg->includes[j].linkerPadding != 0)
+            fprintf(fout, "            . += 0x%X;\n", seg->includes[j].linkerPadding);
+        fprintf(fout, "        . = ALIGN(0x10);\n");
+    }
+
+    fputs("    }\n    .data 0 :\n    {\n", fout);
+    for (j = 0; j < seg->includesCount; j++)
+        fprintf(fout, "            %s (.data)\n"
+                      "        . = ALIGN(0x10);\n", seg->includes[j].fpath);
+
+    // .rodata first for each file, see write_ld_script
+    fputs("    }\n    .rodata 0 :\n    {\n", fout);
+    for (j = 0; j < seg->includesCount; j++)
+        fprintf(fout, "            %s (.rodata)\n"
+                      "            %s (.rodata.str*)\n"
+                      "            %s (.rodata.cst*)\n"
+                      "        . = ALIGN(0x10);\n",
+                seg->includes[j].fpath, seg->includes[j].fpath, seg->includes[j].fpath);
+
+    fputs("    }\n    .sdata 0 :\n    {\n", fout);
+    for (j = 0; j < seg->includesCount; j++)
+        fprintf(fout, "            %s (.sdata)\n"
+                      "        . = ALIGN(0x10);\n", seg->includes[j].fpath);
+
+    fputs("    }\n    .ovl 0 :\n    {\n", fout);
+    for (j = 0; j < seg->includesCount; j++)
+        fprintf(fout, "            %s (.ovl)\n", seg->includes[j].fpath);
+
+    // All of the uninitialized data in one section, in the order the final link would place it
+    fputs("    }\n    .bss 0 (NOLOAD) :\n    {\n", fout);
+    for (j = 0; j < seg->includesCount; j++)
+        fprintf(fout, "            %s (.sbss)\n"
+                      "        . = ALIGN(0x10);\n", seg->includes[j].fpath);
+    for (j = 0; j < seg->includesCount; j++)
+        fprintf(fout, "            %s (.scommon)\n"
+                      "        . = ALIGN(0x10);\n", seg->includes[j].fpath);
+    for (j = 0; j < seg->includesCount; j++)
+        fprintf(fout, "            %s (.bss)\n"
+                      "        . = ALIGN(0x10);\n", seg->includes[j].fpath);
+    for (j = 0; j < seg->includesCount; j++)
+        fprintf(fout, "            %s (COMMON)\n"
+                      "        . = ALIGN(0x10);\n", seg->includes[j].fpath);
+    fputs("    }\n}\n", fout);
+}
+
+// Writes the partial link script and dependency file of each overlay segment to partialDir, and makes the segment
+// include the partial object alone, for write_ld_script to lay out in place of its files
+static void write_partial_ld_scripts(const char *partialDir)
+{
+    int i;
+    int j;
+
+    g_partialObjPaths = calloc(g_segmentsCount + 1, sizeof(char *));
+    if (g_partialObjPaths == NULL)
+        util_fatal_error("out of memory");
+
+    for (i = 0; i < g_segmentsCount; i++)
+    {
+        struct Segment *seg = &g_segments[i];
+        size_t pathSize;
+        char *path;
+        char *objPath;
+        FILE *fout;
+
+        if (!is_overlay_segment(seg))
+            continue;
+
+        pathSize = strlen(partialDir) + 1 + strlen(seg->name) + sizeof(".ld");
+        path = malloc(pathSize);
+        objPath = malloc(pathSize);
+        if (path == NULL || objPath == NULL)
+            util_fatal_error("out of memory");
+        snprintf(objPath, pathSize, "%s/%s.o", partialDir, seg->name);
+
+        snprintf(path, pathSize, "%s/%s.ld", partialDir, seg->name);
+        fout = util_open_output(path);
+        write_partial_ld_script(fout, seg);
+        util_close_output(fout, path);
+
+        // The files the partial object is linked from, for make
+        snprintf(path, pathSize, "%s/%s.d", partialDir, seg->name);
+        fout = util_open_output(path);
+        fprintf(fout, "%s:", objPath);
+        for (j = 0; j < seg->includesCount; j++)
+            fprintf(fout, " \\\n    %s", seg->includes[j].fpath);
+        fputs("\n", fout);
+        util_close_output(fout, path);
+
+        free(path);
+
+        g_partialObjPaths[i] = objPath;
+        seg->includesCount = 1;
+        seg->includes[0].fpath = objPath;
+        seg->includes[0].linkerPadding = 0;
+    }
+}
+
 static void usage(const char *execname)
 {
-    fprintf(stderr, "Nintendo 64 linker script generation tool v0.03\n"
-                    "usage: %s SPEC_FILE LD_SCRIPT\n"
-                    "SPEC_FILE  file describing the organization of object files into segments\n"
-                    "LD_SCRIPT  filename of output linker script\n",
+    fprintf(stderr, "Nintendo 64 linker script generation tool v0.04\n"
+                    "usage: %s [--partial PARTIAL_DIR] SPEC_FILE LD_SCRIPT\n"
+                    "SPEC_FILE    file describing the organization of object files into segments, or the table from mkspectable\n"
+                    "LD_SCRIPT    filename of output linker script\n"
+                    "PARTIAL_DIR  if given, also write PARTIAL_DIR/<segment>.ld for each overlay segment, to link its files\n"
+                    "             into PARTIAL_DIR/<segment>.o with `ld -r`, and PARTIAL_DIR/<segment>.d listing them.\n"
+                    "             LD_SCRIPT then lays out those objects in place of the files.\n",
                     execname);
 }
 
@@ -241,23 +382,37 @@ int main(int argc, char **argv)
 {
     FILE *ldout;
     void *spec;
-    size_t size;
+    const char *partialDir = NULL;
+    int argi = 1;
+    int i;
 
-    if (argc != 3)
+    if (argc == 5 && strcmp(argv[1], "--partial") == 0)
+    {
+        partialDir = argv[2];
+        argi += 2;
+    }
+    if (argc - argi != 2)
     {
         usage(argv[0]);
         return 1;
     }
 
-    spec = util_read_whole_file(argv[1], &size);
-    parse_rom_spec(spec, &g_segments, &g_segmentsCount);
+    spec = load_rom_spec(argv[argi], &g_segments, &g_segmentsCount);
+
+    if (partialDir != NULL)
+        write_partial_ld_scripts(partialDir);
 
-    ldout = fopen(argv[2], "w");
-    if (ldout == NULL)
-        util_fatal_error("failed to open file '%s' for writing", argv[2]);
+    // Left untouched if unchanged, so that a spec change that doesn't affect the linker script doesn't relink
+    ldout = util_open_output(argv[argi + 1]);
     write_ld_script(ldout);
-    fclose(ldout);
+    util_close_output(ldout, argv[argi + 1]);
 
+    if (g_partialObjPaths != NULL)
+    {
+        for (i = 0; i < g_segmentsCount; i++)
+            free(g_partialObjPaths[i]);
+        free(g_partialObjPaths);
+    }
     free_rom_spec(g_segments, g_segmentsCount);
     free(spec);
 
@@ -0,0 +1,39 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "spec.h"
+#include "util.h"
+
+static void usage(const char *execname)
+{
+    fprintf(stderr, "zelda64 spec segment table generation tool\n"
+                    "usage: %s SPEC_FILE SPEC_TABLE\n"
+                    "SPEC_FILE   preprocessed file describing the organization of object files into segments\n"
+                    "SPEC_TABLE  filename of output segment table, read by mkldscript, mkdmadata and reloc_prereq\n"
+                    "            in place of SPEC_FILE. It is left untouched if the segments did not change.\n",
+                    execname);
+}
+
+int main(int argc, char **argv)
+{
+    struct Segment *segments = NULL;
+    int segmentsCount = 0;
+    void *spec;
+    size_t size;
+
+    if (argc != 3)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    spec = util_read_whole_file(argv[1], &size);
+    parse_rom_spec(spec, &segments, &segmentsCount);
+
+    write_rom_spec_table(argv[2], segments, segmentsCount);
+
+    free_rom_spec(segments, segmentsCount);
+    free(spec);
+
+    return 0;
+}
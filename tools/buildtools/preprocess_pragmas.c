@@ -16,16 +16,11 @@
 #include <stdlib.h>
 #include <string.h>
 
-const char str_pragma_increment_block_number[] = "#pragma increment_block_number";
+#include "preprocess_pragmas.h"
 
-int main(int argc, char** argv) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: preprocess_pragmas VERSION filename < source.c\n");
-        return EXIT_FAILURE;
-    }
-    char* const version = argv[1];
-    char* const filename = argv[2];
+const char str_pragma_increment_block_number[] = "#pragma increment_block_number";
 
+int preprocess_pragmas(const char* version, const char* filename, FILE* in, FILE* out) {
     const size_t len_version = strlen(version);
     char version_needle[len_version + 2];
     memcpy(version_needle, version, len_version);
@@ -46,12 +41,12 @@ int main(int argc, char** argv) {
     int n_fake_structs;
 
     while (cont) {
-        size_t nread = fread(bufp, 1, bufend - bufp, stdin);
+        size_t nread = fread(bufp, 1, bufend - bufp, in);
         bufp += nread;
         if (nread == 0) {
-            if (!feof(stdin)) {
+            if (!feof(in)) {
                 perror("fread");
-                fprintf(stderr, "Failed to read from stdin\n");
+                fprintf(stderr, "Failed to read the source\n");
                 return EXIT_FAILURE;
             }
             cont = false;
@@ -111,9 +106,9 @@ int main(int argc, char** argv) {
                 char* p = line;
                 size_t sz = line_end + 1 - line;
                 while (sz != 0) {
-                    size_t nwritten = fwrite(p, 1, sz, stdout);
+                    size_t nwritten = fwrite(p, 1, sz, out);
                     if (nwritten == 0) {
-                        fprintf(stderr, "Failed to write to stdout\n");
+                        fprintf(stderr, "Failed to write the output\n");
                         return EXIT_FAILURE;
                     }
                     p += nwritten;
@@ -133,8 +128,8 @@ int main(int argc, char** argv) {
                 // pragma_line_number is used for symbol uniqueness,
                 // and also by fix_bss.py to locate the pragma these symbols originate from.
                 for (int i = 0; i < n_fake_structs; i++)
-                    fprintf(stdout, "struct increment_block_number_%05d_%03d;\n", pragma_line_number, i);
-                fprintf(stdout, "#line %d \"%s\"\n", line_num + 1, filename);
+                    fprintf(out, "struct increment_block_number_%05d_%03d;\n", pragma_line_number, i);
+                fprintf(out, "#line %d \"%s\"\n", line_num + 1, filename);
             }
             line_num++;
             if (line_end == last_newline)
@@ -152,3 +147,13 @@ int main(int argc, char** argv) {
 
     return EXIT_SUCCESS;
 }
+
+#ifndef PREPROCESS_PRAGMAS_NO_MAIN
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: preprocess_pragmas VERSION filename < source.c\n");
+        return EXIT_FAILURE;
+    }
+    return preprocess_pragmas(argv[1], argv[2], stdin, stdout);
+}
+#endif
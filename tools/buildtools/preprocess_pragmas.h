@@ -0,0 +1,11 @@
+#ifndef PREPROCESS_PRAGMAS_H
+#define PREPROCESS_PRAGMAS_H
+
+#include <stdio.h>
+
+// Copies the C source from `in` to `out`, replacing `#pragma increment_block_number` with the fake structs
+// for the amount given for VERSION. The filename is only used for linemarkers.
+// Returns EXIT_SUCCESS, or EXIT_FAILURE after printing the error.
+int preprocess_pragmas(const char* version, const char* filename, FILE* in, FILE* out);
+
+#endif
@@ -6,25 +6,117 @@
 #include "spec.h"
 #include "util.h"
 
+static const char reloc_suffix[] = "_reloc.o";
+
 void print_usage(char* prog_name) {
     printf("USAGE: %s SPEC OVERLAY_SEGMENT_NAME\n"
-           "Search the preprocessed SPEC for an overlay segment name, \n"
+           "       %s --make SPEC OUTPUT_MAKEFILE\n"
+           "Search the preprocessed SPEC, or the table from mkspectable, for an overlay segment name, \n"
            "e.g. \"ovl_En_Firefly\", and return a space-separated list of the files it\n"
            "includes. The relocation file must be the last include in the segment\n"
            "OVERLAY_SEGMENT_NAME, and have the filename \"OVERLAY_SEGMENT_NAME_reloc.o\",\n"
-           "but can be in a different directory from the other files.\n",
-           prog_name);
+           "but can be in a different directory from the other files.\n"
+           "With --make, the lists of every overlay segment in SPEC, the segments whose last include\n"
+           "is a relocation file, are written to OUTPUT_MAKEFILE for the Makefile to include, as\n"
+           "RELOC_PREREQ_<OVERLAY_SEGMENT_NAME> variables. The file is left untouched if they did\n"
+           "not change.\n",
+           prog_name, prog_name);
+}
+
+/* Checks that the relocation file is the last include of the overlay segment, named after it */
+static bool check_overlay(const Segment* segment) {
+    size_t overlay_name_length;
+    char* expected_filename;
+    bool ok;
+
+    /* Relocation file must be the last `include` (so .ovl section is linked last) */
+    if (segment->includesCount == 0 ||
+        strstr(segment->includes[segment->includesCount - 1].fpath, reloc_suffix) == NULL) {
+        fprintf(stderr, ERRMSG_START "last include in overlay segment \"%s\" is not a `%s` file\n" ERRMSG_END,
+                segment->name, reloc_suffix);
+        return false;
+    }
+
+    overlay_name_length = strlen(segment->name);
+    expected_filename = malloc(overlay_name_length + strlen(reloc_suffix) + 1);
+    strcpy(expected_filename, segment->name);
+    strcat(expected_filename, reloc_suffix);
+
+    ok = strstr(segment->includes[segment->includesCount - 1].fpath, expected_filename) != NULL;
+    if (!ok) {
+        fprintf(stderr, ERRMSG_START "Relocation file \"%s\" should have filename \"%s\"\n" ERRMSG_END,
+                segment->includes[segment->includesCount - 1].fpath, expected_filename);
+    }
+    free(expected_filename);
+    return ok;
+}
+
+/* Writes the includes of the overlay segment but its `_reloc.o` include, space-separated */
+static void print_overlay_includes(FILE* out, const Segment* segment) {
+    int i;
+
+    for (i = 0; i < segment->includesCount - 1; i++) {
+        fprintf(out, "%s ", segment->includes[i].fpath);
+    }
+    putc('\n', out);
+}
+
+/* Whether the segment is an overlay, the segments that aren't have no relocation file */
+static bool is_overlay(const Segment* segment) {
+    return segment->includesCount != 0 &&
+           strstr(segment->includes[segment->includesCount - 1].fpath, reloc_suffix) != NULL;
+}
+
+/* The lists of all overlays from one read of the spec, instead of one process and spec read per overlay */
+static int write_makefile(const char* spec_path, const char* out_path) {
+    void* spec;
+    Segment* segments;
+    int segmentsCount;
+    FILE* out;
+    int i;
+    int exit_status = 0;
+
+    spec = load_rom_spec(spec_path, &segments, &segmentsCount);
+
+    for (i = 0; i < segmentsCount; i++) {
+        if (is_overlay(&segments[i]) && !check_overlay(&segments[i])) {
+            exit_status = 1;
+        }
+    }
+
+    if (exit_status == 0) {
+        out = util_open_output(out_path);
+        fprintf(out, "# The inputs of every overlay's relocation file, written by reloc_prereq from %s\n", spec_path);
+        for (i = 0; i < segmentsCount; i++) {
+            if (is_overlay(&segments[i])) {
+                fprintf(out, "RELOC_PREREQ_%s := ", segments[i].name);
+                print_overlay_includes(out, &segments[i]);
+            }
+        }
+        util_close_output(out, out_path);
+    }
+
+    free_rom_spec(segments, segmentsCount);
+    free(spec);
+
+    return exit_status;
 }
 
 int main(int argc, char** argv) {
     char* spec_path;
     char* overlay_name;
-    char* spec;
-    size_t size;
+    void* spec;
+    Segment* segments;
+    int segmentsCount;
     Segment segment;
+    int i;
     int exit_status = 0;
     bool segmentFound = false;
 
+    if (argc == 4 && strcmp(argv[1], "--make") == 0) {
+        return write_makefile(argv[2], argv[3]);
+    }
+
     if (argc != 3) {
         print_usage(argv[0]);
         return 1;
@@ -36,53 +128,32 @@ int main(int argc, char** argv) {
     // printf("spec path: %s\n", spec_path);
     // printf("overlay name: %s\n", overlay_name);
 
-    spec = util_read_whole_file(spec_path, &size);
-    segmentFound = get_single_segment_by_name(&segment, spec, overlay_name);
+    spec = load_rom_spec(spec_path, &segments, &segmentsCount);
+    for (i = 0; i < segmentsCount; i++) {
+        if (strcmp(segments[i].name, overlay_name) == 0) {
+            segment = segments[i];
+            segmentFound = true;
+            break;
+        }
+    }
 
     if (!segmentFound) {
         fprintf(stderr, ERRMSG_START "no segment \"%s\" found\n" ERRMSG_END, overlay_name);
         goto error_out;
     }
 
-    {
-        size_t overlay_name_length;
-        const char* reloc_suffix = "_reloc.o";
-        char* expected_filename;
-
-        /* Relocation file must be the last `include` (so .ovl section is linked last) */
-        if (strstr(segment.includes[segment.includesCount - 1].fpath, reloc_suffix) == NULL) {
-            fprintf(stderr, ERRMSG_START "last include in overlay segment \"%s\" is not a `%s` file\n" ERRMSG_END,
-                    overlay_name, reloc_suffix);
-            goto error_out;
-        }
-
-        overlay_name_length = strlen(overlay_name);
-        expected_filename = malloc(overlay_name_length + strlen(reloc_suffix) + 1);
-        strcpy(expected_filename, overlay_name);
-        strcat(expected_filename, reloc_suffix);
-
-        if (strstr(segment.includes[segment.includesCount - 1].fpath, expected_filename) == NULL) {
-            fprintf(stderr, ERRMSG_START "Relocation file \"%s\" should have filename \"%s\"\n" ERRMSG_END,
-                    segment.includes[segment.includesCount - 1].fpath, expected_filename);
-            goto error_out;
-        }
-        free(expected_filename);
-    }
-    {
-        int i;
-        /* Skip `_reloc.o` include */
-        for (i = 0; i < segment.includesCount - 1; i++) {
-            printf("%s ", segment.includes[i].fpath);
-        }
-        putchar('\n');
+    if (!check_overlay(&segment)) {
+        goto error_out;
     }
+    /* Skip `_reloc.o` include */
+    print_overlay_includes(stdout, &segment);
 
     if (0) {
     error_out:
         exit_status = 1;
     }
 
-    free_single_segment_elements(&segment);
+    free_rom_spec(segments, segmentsCount);
     free(spec);
 
     return exit_status;
@@ -11,6 +11,14 @@
 
 #define ARRAY_COUNT(arr) (sizeof(arr) / sizeof(arr[0]))
 
+// Binary segment table written by mkspectable, see write_rom_spec_table
+#define SPEC_TABLE_MAGIC "SPECTBL1"
+#define SPEC_TABLE_MAGIC_SIZE 8
+#define SPEC_TABLE_HEADER_SIZE (SPEC_TABLE_MAGIC_SIZE + 3 * 4)
+#define SPEC_TABLE_SEGMENT_SIZE (14 * 4)
+#define SPEC_TABLE_INCLUDE_SIZE (2 * 4)
+#define SPEC_TABLE_NO_STRING 0xFFFFFFFF
+
 static struct Segment* add_segment(struct Segment** segments, int* segments_count) {
     struct Segment* seg;
 
@@ -361,3 +369,187 @@ void free_rom_spec(struct Segment* segments, int segment_count) {
     }
     free(segments);
 }
+
+static uint32_t add_table_string(char** strings, uint32_t* stringsSize, const char* str) {
+    uint32_t offset = *stringsSize;
+    size_t len;
+
+    if (str == NULL)
+        return SPEC_TABLE_NO_STRING;
+
+    len = strlen(str) + 1;
+    *strings = realloc(*strings, *stringsSize + len);
+    if (*strings == NULL)
+        util_fatal_error("out of memory");
+    memcpy(*strings + offset, str, len);
+    *stringsSize += len;
+    return offset;
+}
+
+/**
+ * Writes the parsed segments to `filename` as a binary table that `load_rom_spec` reads back without parsing the text
+ * again. The file is only written if its contents change, so that what is built from it is not rebuilt for a spec
+ * change that doesn't change any segment. Returns whether the file was written.
+ *
+ * The table is big-endian words: a header of the magic, the number of segments, the number of includes and the size
+ * of the string table, then the segments, the includes of all segments in order and the strings. Strings are offsets
+ * into the string table.
+ */
+bool write_rom_spec_table(const char* filename, struct Segment* segments, int segment_count) {
+    char* strings = NULL;
+    uint32_t stringsSize = 0;
+    uint32_t includesCount = 0;
+    uint32_t includeIndex = 0;
+    uint8_t* table;
+    uint8_t* segPtr;
+    uint8_t* incPtr;
+    size_t tableSize;
+    bool written;
+    int i;
+    int j;
+
+    for (i = 0; i < segment_count; i++)
+        includesCount += segments[i].includesCount;
+
+    table = calloc(1, SPEC_TABLE_HEADER_SIZE + segment_count * SPEC_TABLE_SEGMENT_SIZE +
+                          includesCount * SPEC_TABLE_INCLUDE_SIZE);
+    if (table == NULL)
+        util_fatal_error("out of memory");
+    segPtr = table + SPEC_TABLE_HEADER_SIZE;
+    incPtr = segPtr + segment_count * SPEC_TABLE_SEGMENT_SIZE;
+
+    for (i = 0; i < segment_count; i++, segPtr += SPEC_TABLE_SEGMENT_SIZE) {
+        struct Segment* seg = &segments[i];
+
+        util_write_uint32_be(&segPtr[0x00], seg->fields);
+        util_write_uint32_be(&segPtr[0x04], add_table_string(&strings, &stringsSize, seg->name));
+        util_write_uint32_be(&segPtr[0x08], add_table_string(&strings, &stringsSize, seg->after));
+        util_write_uint32_be(&segPtr[0x0C], seg->flags);
+        util_write_uint32_be(&segPtr[0x10], seg->address);
+        util_write_uint32_be(&segPtr[0x14], seg->stack);
+        util_write_uint32_be(&segPtr[0x18], seg->align);
+        util_write_uint32_be(&segPtr[0x1C], seg->romalign);
+        util_write_uint32_be(&segPtr[0x20], seg->increment);
+        util_write_uint32_be(&segPtr[0x24], seg->entry);
+        util_write_uint32_be(&segPtr[0x28], seg->number);
+        util_write_uint32_be(&segPtr[0x2C], includeIndex);
+        util_write_uint32_be(&segPtr[0x30], seg->includesCount);
+        util_write_uint32_be(&segPtr[0x34], seg->compress);
+
+        for (j = 0; j < seg->includesCount; j++, incPtr += SPEC_TABLE_INCLUDE_SIZE) {
+            util_write_uint32_be(&incPtr[0x00], add_table_string(&strings, &stringsSize, seg->includes[j].fpath));
+            util_write_uint32_be(&incPtr[0x04], seg->includes[j].linkerPadding);
+        }
+        includeIndex += seg->includesCount;
+    }
+
+    memcpy(table, SPEC_TABLE_MAGIC, SPEC_TABLE_MAGIC_SIZE);
+    util_write_uint32_be(&table[SPEC_TABLE_MAGIC_SIZE + 0], segment_count);
+    util_write_uint32_be(&table[SPEC_TABLE_MAGIC_SIZE + 4], includesCount);
+    util_write_uint32_be(&table[SPEC_TABLE_MAGIC_SIZE + 8], stringsSize);
+
+    tableSize = incPtr - table;
+    table = realloc(table, tableSize + stringsSize);
+    if (table == NULL)
+        util_fatal_error("out of memory");
+    if (stringsSize != 0)
+        memcpy(table + tableSize, strings, stringsSize);
+    tableSize += stringsSize;
+
+    written = util_write_whole_file_if_changed(filename, table, tableSize);
+
+    free(table);
+    free(strings);
+    return written;
+}
+
+static char* get_table_string(const char* filename, char* strings, uint32_t stringsSize, uint32_t offset) {
+    if (offset == SPEC_TABLE_NO_STRING)
+        return NULL;
+    if (offset >= stringsSize || memchr(strings + offset, 0, stringsSize - offset) == NULL)
+        util_fatal_error("'%s': bad string offset in segment table", filename);
+    return strings + offset;
+}
+
+static void load_rom_spec_table(const char* filename, uint8_t* table, size_t size, struct Segment** segments,
+                                int* segment_count) {
+    uint32_t segmentsCount;
+    uint32_t includesCount;
+    uint32_t stringsSize;
+    const uint8_t* segPtr;
+    const uint8_t* incBase;
+    char* strings;
+    uint32_t i;
+    uint32_t j;
+
+    if (size < SPEC_TABLE_HEADER_SIZE)
+        util_fatal_error("'%s': truncated segment table", filename);
+    segmentsCount = util_read_uint32_be(&table[SPEC_TABLE_MAGIC_SIZE + 0]);
+    includesCount = util_read_uint32_be(&table[SPEC_TABLE_MAGIC_SIZE + 4]);
+    stringsSize = util_read_uint32_be(&table[SPEC_TABLE_MAGIC_SIZE + 8]);
+    if ((uint64_t)SPEC_TABLE_HEADER_SIZE + (uint64_t)segmentsCount * SPEC_TABLE_SEGMENT_SIZE +
+            (uint64_t)includesCount * SPEC_TABLE_INCLUDE_SIZE + stringsSize !=
+        size)
+        util_fatal_error("'%s': truncated segment table", filename);
+
+    segPtr = table + SPEC_TABLE_HEADER_SIZE;
+    incBase = segPtr + segmentsCount * SPEC_TABLE_SEGMENT_SIZE;
+    strings = (char*)(incBase + includesCount * SPEC_TABLE_INCLUDE_SIZE);
+
+    *segments = calloc(segmentsCount != 0 ? segmentsCount : 1, sizeof(**segments));
+    if (*segments == NULL)
+        util_fatal_error("out of memory");
+    *segment_count = segmentsCount;
+
+    for (i = 0; i < segmentsCount; i++, segPtr += SPEC_TABLE_SEGMENT_SIZE) {
+        struct Segment* seg = &(*segments)[i];
+        uint32_t firstInclude = util_read_uint32_be(&segPtr[0x2C]);
+
+        seg->fields = util_read_uint32_be(&segPtr[0x00]);
+        seg->name = get_table_string(filename, strings, stringsSize, util_read_uint32_be(&segPtr[0x04]));
+        seg->after = get_table_string(filename, strings, stringsSize, util_read_uint32_be(&segPtr[0x08]));
+        seg->flags = util_read_uint32_be(&segPtr[0x0C]);
+        seg->address = util_read_uint32_be(&segPtr[0x10]);
+        seg->stack = util_read_uint32_be(&segPtr[0x14]);
+        seg->align = util_read_uint32_be(&segPtr[0x18]);
+        seg->romalign = util_read_uint32_be(&segPtr[0x1C]);
+        seg->increment = util_read_uint32_be(&segPtr[0x20]);
+        seg->entry = util_read_uint32_be(&segPtr[0x24]);
+        seg->number = util_read_uint32_be(&segPtr[0x28]);
+        seg->includesCount = util_read_uint32_be(&segPtr[0x30]);
+        seg->compress = util_read_uint32_be(&segPtr[0x34]) != 0;
+
+        if ((uint64_t)firstInclude + seg->includesCount > includesCount)
+            util_fatal_error("'%s': bad include range in segment table", filename);
+
+        seg->includes = malloc((seg->includesCount != 0 ? seg->includesCount : 1) * sizeof(*seg->includes));
+        if (seg->includes == NULL)
+            util_fatal_error("out of memory");
+        for (j = 0; j < (uint32_t)seg->includesCount; j++) {
+            const uint8_t* incPtr = incBase + (firstInclude + j) * SPEC_TABLE_INCLUDE_SIZE;
+
+            seg->includes[j].fpath =
+                get_table_string(filename, strings, stringsSize, util_read_uint32_be(&incPtr[0x00]));
+            seg->includes[j].linkerPadding = util_read_uint32_be(&incPtr[0x04]);
+        }
+    }
+}
+
+/**
+ * Loads the segments from either a segment table written by `write_rom_spec_table` or a preprocessed spec, which is
+ * parsed with `parse_rom_spec`. Returns the file's contents, which the strings in `segments` point into, to be freed
+ * after `free_rom_spec`.
+ */
+void* load_rom_spec(const char* filename, struct Segment** segments, int* segment_count) {
+    size_t size;
+    uint8_t* data = util_read_whole_file(filename, &size);
+
+    if (size >= SPEC_TABLE_MAGIC_SIZE && memcmp(data, SPEC_TABLE_MAGIC, SPEC_TABLE_MAGIC_SIZE) == 0) {
+        load_rom_spec_table(filename, data, size, segments, segment_count);
+    } else {
+        *segments = NULL;
+        *segment_count = 0;
+        parse_rom_spec((char*)data, segments, segment_count);
+    }
+    return data;
+}
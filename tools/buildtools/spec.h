@@ -54,6 +54,10 @@ typedef struct Segment {
 
 void parse_rom_spec(char* spec, struct Segment** segments, int* segment_count);
 
+bool write_rom_spec_table(const char* filename, struct Segment* segments, int segment_count);
+
+void* load_rom_spec(const char* filename, struct Segment** segments, int* segment_count);
+
 bool get_single_segment_by_name(struct Segment* dstSegment, char* spec, const char* segmentName);
 
 void free_single_segment_elements(struct Segment* segment);
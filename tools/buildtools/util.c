@@ -40,7 +40,7 @@ void* util_read_whole_file(const char* filename, size_t* pSize) {
 
     // read file
     fseek(file, 0, SEEK_SET);
-    if (fread(buffer, size, 1, file) != 1)
+    if (size != 0 && fread(buffer, size, 1, file) != 1)
         util_fatal_error("error reading from file '%s': %s", filename, strerror(errno));
 
     // null-terminate the buffer (in case of text files)
@@ -66,6 +66,120 @@ void util_write_whole_file(const char* filename, const void* data, size_t size)
     fclose(file);
 }
 
+// the name of the temporary file util_open_output writes to, malloc'd
+static char* util_output_tmp_name(const char* filename) {
+    char* tmpName = malloc(strlen(filename) + sizeof(".tmp"));
+
+    if (tmpName == NULL)
+        util_fatal_error("out of memory");
+    strcpy(tmpName, filename);
+    strcat(tmpName, ".tmp");
+    return tmpName;
+}
+
+#define UTIL_COMPARE_CHUNK 0x10000
+
+// the size of an open file, leaving its position at the start
+static long util_file_size(FILE* file) {
+    long size;
+
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    return size;
+}
+
+// whether filename exists and holds exactly the size bytes of data. Sizes are compared first, the contents are then
+// read back in chunks so the file is never loaded whole.
+bool util_file_has_content(const char* filename, const void* data, size_t size) {
+    FILE* file = fopen(filename, "rb");
+    const uint8_t* expected = data;
+    uint8_t buffer[UTIL_COMPARE_CHUNK];
+    bool same;
+
+    if (file == NULL)
+        return false;
+
+    same = (size_t)util_file_size(file) == size;
+    while (same && size != 0) {
+        size_t chunk = size < sizeof(buffer) ? size : sizeof(buffer);
+
+        same = fread(buffer, chunk, 1, file) == 1 && memcmp(buffer, expected, chunk) == 0;
+        expected += chunk;
+        size -= chunk;
+    }
+    fclose(file);
+    return same;
+}
+
+// whether both files exist and have the same contents, compared in chunks
+static bool util_files_equal(const char* filenameA, const char* filenameB) {
+    FILE* fileA = fopen(filenameA, "rb");
+    FILE* fileB = fopen(filenameB, "rb");
+    uint8_t bufferA[UTIL_COMPARE_CHUNK];
+    uint8_t bufferB[UTIL_COMPARE_CHUNK];
+    bool same = fileA != NULL && fileB != NULL && util_file_size(fileA) == util_file_size(fileB);
+
+    while (same) {
+        size_t readA = fread(bufferA, 1, sizeof(bufferA), fileA);
+        size_t readB = fread(bufferB, 1, sizeof(bufferB), fileB);
+
+        same = readA == readB && memcmp(bufferA, bufferB, readA) == 0;
+        if (readA < sizeof(bufferA))
+            break;
+    }
+
+    if (fileA != NULL)
+        fclose(fileA);
+    if (fileB != NULL)
+        fclose(fileB);
+    return same;
+}
+
+// writes data to file only if the file doesn't already hold exactly that, so that its timestamp is kept and make
+// doesn't rebuild what depends on it. Returns whether the file was written.
+bool util_write_whole_file_if_changed(const char* filename, const void* data, size_t size) {
+    if (util_file_has_content(filename, data, size))
+        return false;
+
+    util_write_whole_file(filename, data, size);
+    return true;
+}
+
+// opens a temporary file next to filename to write its new contents to, see util_close_output
+FILE* util_open_output(const char* filename) {
+    char* tmpName = util_output_tmp_name(filename);
+    FILE* file = fopen(tmpName, "wb");
+
+    if (file == NULL)
+        util_fatal_error("failed to open file '%s' for writing: %s", tmpName, strerror(errno));
+    free(tmpName);
+    return file;
+}
+
+// closes a file opened with util_open_output, and replaces filename with it only if the contents changed. Returns
+// whether filename was written.
+bool util_close_output(FILE* file, const char* filename) {
+    char* tmpName = util_output_tmp_name(filename);
+    bool written;
+
+    if (ferror(file) || fclose(file) != 0)
+        util_fatal_error("error writing to file '%s'", tmpName);
+
+    written = !util_files_equal(tmpName, filename);
+    if (!written) {
+        remove(tmpName);
+    } else {
+        // rename doesn't replace an existing file everywhere
+        remove(filename);
+        if (rename(tmpName, filename) != 0)
+            util_fatal_error("failed to replace file '%s': %s", filename, strerror(errno));
+    }
+
+    free(tmpName);
+    return written;
+}
+
 uint32_t util_read_uint32_be(const uint8_t* data) {
     return data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3] << 0;
 }
@@ -1,6 +1,7 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -17,6 +18,14 @@ void* util_read_whole_file(const char* filename, size_t* pSize);
 
 void util_write_whole_file(const char* filename, const void* data, size_t size);
 
+bool util_file_has_content(const char* filename, const void* data, size_t size);
+
+bool util_write_whole_file_if_changed(const char* filename, const void* data, size_t size);
+
+FILE* util_open_output(const char* filename);
+
+bool util_close_output(FILE* file, const char* filename);
+
 uint32_t util_read_uint32_be(const uint8_t* data);
 
 void util_write_uint32_be(uint8_t* data, uint32_t val);
@@ -0,0 +1,343 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+
+// Yaz0 compressor producing the same output as Nintendo's encoder (and crunch64, which reproduces it): at each
+// position, the longest match in the previous 0x1000 bytes is taken, the earliest one if several are as long, unless
+// the match starting one byte later is at least 2 bytes longer, in which case a literal byte and that match are
+// emitted instead.
+//
+// The longest match only depends on the input, so it is found for every position up front, which is the slow part and
+// is split across threads for large inputs. Emitting the groups from that is then a quick sequential pass.
+
+#define YAZ0_HEADER_SIZE 0x10
+#define YAZ0_WINDOW_SIZE 0x1000
+#define YAZ0_MIN_MATCH 3
+#define YAZ0_MAX_MATCH (0xFF + 0x12)
+
+#define HASH_BITS 16
+#define HASH_SIZE (1 << HASH_BITS)
+
+// Inputs are only split across threads in chunks of at least this many positions
+#define MIN_CHUNK_SIZE 0x40000
+
+struct MatchFinder {
+    const uint8_t* src;
+    size_t size;
+    // Positions of each hash bucket, in ascending order, bucket h being chain[bucketStart[h]] to chain[bucketStart[h + 1]]
+    uint32_t* bucketStart;
+    uint32_t* chain;
+    // Index of each position in chain
+    uint32_t* rank;
+    // The longest match at each position, 0 if shorter than YAZ0_MIN_MATCH
+    uint16_t* matchLen;
+    uint16_t* matchDist;
+};
+
+struct MatchJob {
+    struct MatchFinder* mf;
+    size_t start;
+    size_t end;
+};
+
+static uint32_t hash3(const uint8_t* p) {
+    uint32_t v = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void* xmalloc(size_t size) {
+    void* p = malloc(size != 0 ? size : 1);
+
+    if (p == NULL)
+        util_fatal_error("out of memory");
+    return p;
+}
+
+static void build_chains(struct MatchFinder* mf) {
+    size_t nHashed = (mf->size >= YAZ0_MIN_MATCH) ? mf->size - YAZ0_MIN_MATCH + 1 : 0;
+    uint32_t* fill;
+    size_t p;
+    uint32_t h;
+
+    mf->bucketStart = calloc(HASH_SIZE + 1, sizeof(uint32_t));
+    mf->chain = xmalloc(nHashed * sizeof(uint32_t));
+    mf->rank = xmalloc(nHashed * sizeof(uint32_t));
+    fill = xmalloc(HASH_SIZE * sizeof(uint32_t));
+    if (mf->bucketStart == NULL)
+        util_fatal_error("out of memory");
+
+    for (p = 0; p < nHashed; p++)
+        mf->bucketStart[hash3(&mf->src[p]) + 1]++;
+    for (h = 0; h < HASH_SIZE; h++) {
+        mf->bucketStart[h + 1] += mf->bucketStart[h];
+        fill[h] = mf->bucketStart[h];
+    }
+    for (p = 0; p < nHashed; p++) {
+        h = hash3(&mf->src[p]);
+        mf->rank[p] = fill[h];
+        mf->chain[fill[h]++] = p;
+    }
+
+    free(fill);
+}
+
+static void find_match(struct MatchFinder* mf, size_t pos) {
+    const uint8_t* src = mf->src;
+    size_t maxLen = mf->size - pos;
+    size_t windowStart = (pos > YAZ0_WINDOW_SIZE) ? pos - YAZ0_WINDOW_SIZE : 0;
+    size_t bestLen = YAZ0_MIN_MATCH - 1;
+    size_t bestPos = 0;
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t i;
+
+    mf->matchLen[pos] = 0;
+    mf->matchDist[pos] = 0;
+    if (maxLen < YAZ0_MIN_MATCH)
+        return;
+    if (maxLen > YAZ0_MAX_MATCH)
+        maxLen = YAZ0_MAX_MATCH;
+
+    // Earlier positions with the same hash, the first one inside the window found by bisection
+    lo = mf->bucketStart[hash3(&src[pos])];
+    hi = mf->rank[pos];
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+
+        if (mf->chain[mid] < windowStart) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // Going from the oldest position, only a strictly longer match replaces the current one, and the search can stop
+    // as soon as one is as long as possible
+    for (i = lo; i < mf->rank[pos]; i++) {
+        const uint8_t* cand = &src[mf->chain[i]];
+        size_t len;
+
+        // A longer match has to agree on the byte after the current best
+        if (cand[bestLen] != src[pos + bestLen])
+            continue;
+
+        for (len = 0; len < maxLen && cand[len] == src[pos + len]; len++) {}
+
+        if (len > bestLen) {
+            bestLen = len;
+            bestPos = mf->chain[i];
+            if (bestLen == maxLen)
+                break;
+        }
+    }
+
+    if (bestLen >= YAZ0_MIN_MATCH) {
+        mf->matchLen[pos] = bestLen;
+        mf->matchDist[pos] = pos - bestPos - 1;
+    }
+}
+
+static void* find_matches(void* arg) {
+    struct MatchJob* job = arg;
+    size_t pos;
+
+    for (pos = job->start; pos < job->end; pos++)
+        find_match(job->mf, pos);
+
+    return NULL;
+}
+
+static void find_all_matches(struct MatchFinder* mf, int nThreads) {
+    struct MatchJob* jobs;
+    pthread_t* threads;
+    size_t chunkSize;
+    int i;
+
+    if ((size_t)nThreads > mf->size / MIN_CHUNK_SIZE)
+        nThreads = mf->size / MIN_CHUNK_SIZE;
+    if (nThreads < 1)
+        nThreads = 1;
+
+    jobs = xmalloc(nThreads * sizeof(struct MatchJob));
+    threads = xmalloc(nThreads * sizeof(pthread_t));
+    chunkSize = (mf->size + nThreads - 1) / nThreads;
+
+    for (i = 0; i < nThreads; i++) {
+        jobs[i].mf = mf;
+        jobs[i].start = i * chunkSize;
+        jobs[i].end = (i == nThreads - 1) ? mf->size : (i + 1) * chunkSize;
+    }
+
+    if (nThreads == 1) {
+        find_matches(&jobs[0]);
+    } else {
+        for (i = 0; i < nThreads; i++) {
+            if (pthread_create(&threads[i], NULL, find_matches, &jobs[i]) != 0)
+                util_fatal_error("failed to create a thread");
+        }
+        for (i = 0; i < nThreads; i++)
+            pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+    free(jobs);
+}
+
+// Compresses src, returning a malloc'd buffer holding the Yaz0 file
+static uint8_t* yaz0_compress(const uint8_t* src, size_t size, int nThreads, size_t* pOutSize) {
+    struct MatchFinder mf;
+    // The header, then at worst every byte a literal and a group header every 8 of them
+    uint8_t* out = xmalloc(YAZ0_HEADER_SIZE + size + (size + 7) / 8);
+    size_t outPos = YAZ0_HEADER_SIZE;
+    size_t groupPos = 0;
+    int groupCount = 0;
+    size_t pos = 0;
+
+    if (size > UINT32_MAX)
+        util_fatal_error("input too large");
+
+    mf.src = src;
+    mf.size = size;
+    mf.matchLen = xmalloc(size * sizeof(uint16_t));
+    mf.matchDist = xmalloc(size * sizeof(uint16_t));
+    build_chains(&mf);
+    find_all_matches(&mf, nThreads);
+
+    memcpy(out, "Yaz0", 4);
+    util_write_uint32_be(&out[4], size);
+    memset(&out[8], 0, 8);
+
+    while (pos < size) {
+        size_t len = mf.matchLen[pos];
+        size_t dist = mf.matchDist[pos];
+
+        if (len != 0 && pos + 1 < size && mf.matchLen[pos + 1] >= len + 2) {
+            // Better to copy this byte and take the match after it, which is emitted next without looking further
+            if (groupCount == 0) {
+                groupPos = outPos++;
+                out[groupPos] = 0;
+            }
+            out[groupPos] |= 0x80 >> groupCount;
+            out[outPos++] = src[pos++];
+            groupCount = (groupCount + 1) % 8;
+
+            len = mf.matchLen[pos];
+            dist = mf.matchDist[pos];
+        }
+
+        if (groupCount == 0) {
+            groupPos = outPos++;
+            out[groupPos] = 0;
+        }
+
+        if (len == 0) {
+            out[groupPos] |= 0x80 >> groupCount;
+            out[outPos++] = src[pos++];
+        } else if (len >= 0x12) {
+            out[outPos++] = dist >> 8;
+            out[outPos++] = dist & 0xFF;
+            out[outPos++] = len - 0x12;
+            pos += len;
+        } else {
+            out[outPos++] = ((len - 2) << 4) | (dist >> 8);
+            out[outPos++] = dist & 0xFF;
+            pos += len;
+        }
+        groupCount = (groupCount + 1) % 8;
+    }
+
+    free(mf.bucketStart);
+    free(mf.chain);
+    free(mf.rank);
+    free(mf.matchLen);
+    free(mf.matchDist);
+
+    *pOutSize = outPos;
+    return out;
+}
+
+// reads all of stdin into memory
+static void* read_stdin(size_t* pSize) {
+    size_t capacity = 0x10000;
+    size_t size = 0;
+    uint8_t* buffer = xmalloc(capacity);
+    size_t n;
+
+    while ((n = fread(&buffer[size], 1, capacity - size, stdin)) != 0) {
+        size += n;
+        if (size == capacity) {
+            capacity *= 2;
+            buffer = realloc(buffer, capacity);
+            if (buffer == NULL)
+                util_fatal_error("out of memory");
+        }
+    }
+    if (ferror(stdin))
+        util_fatal_error("error reading from stdin: %s", strerror(errno));
+
+    *pSize = size;
+    return buffer;
+}
+
+static void usage(const char* execname) {
+    fprintf(stderr,
+            "Yaz0 compressor\n"
+            "usage: %s [-j THREADS] INPUT OUTPUT\n"
+            "INPUT or OUTPUT may be - for stdin or stdout\n",
+            execname);
+}
+
+int main(int argc, char** argv) {
+    const char* inPath = NULL;
+    const char* outPath = NULL;
+    int nThreads = 1;
+    uint8_t* data;
+    size_t size;
+    uint8_t* compressed;
+    size_t compressedSize;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            nThreads = atoi(argv[++i]);
+            if (nThreads < 1) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (inPath == NULL) {
+            inPath = argv[i];
+        } else if (outPath == NULL) {
+            outPath = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (outPath == NULL) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    data = (strcmp(inPath, "-") == 0) ? read_stdin(&size) : util_read_whole_file(inPath, &size);
+    compressed = yaz0_compress(data, size, nThreads, &compressedSize);
+
+    if (strcmp(outPath, "-") == 0) {
+        if (fwrite(compressed, compressedSize, 1, stdout) != 1 && compressedSize != 0)
+            util_fatal_error("error writing to stdout: %s", strerror(errno));
+    } else {
+        util_write_whole_file(outPath, compressed, compressedSize);
+    }
+
+    free(compressed);
+    free(data);
+    return 0;
+}
@@ -7,7 +7,7 @@ from __future__ import annotations
 
 import argparse
 import hashlib
-import io
+import multiprocessing
 from pathlib import Path
 import struct
 import sys
@@ -41,60 +41,77 @@ def round_up(n, shift):
     return (n + mod - 1) >> shift << shift
 
 
-def update_crc(decompressed: io.BytesIO) -> io.BytesIO:
+def update_crc(decompressed: bytearray) -> bytearray:
     print("Recalculating crc...")
     calculated_checksum = ipl3checksum.CICKind.CIC_X105.calculateChecksum(
-        bytes(decompressed.getbuffer())
+        bytes(decompressed)
     )
-    new_crc = struct.pack(f">II", calculated_checksum[0], calculated_checksum[1])
-
-    decompressed.seek(0x10)
-    decompressed.write(new_crc)
+    struct.pack_into(f">II", decompressed, 0x10, *calculated_checksum)
     return decompressed
 
 
+# Make interrupting the decompression with ^C less jank, as in compress.py
+def set_sigint_ignored():
+    import signal
+
+    signal.signal(signal.SIGINT, signal.SIG_IGN)
+
+
 def decompress_rom(
     file_content: bytearray,
     dmadata_start: int,
     dma_entries: list[dmadata.DmaEntry],
     is_zlib_compressed: bool,
+    n_threads: int | None = None,
 ) -> bytearray:
-    rom_segments = {}  # vrom start : data s.t. len(data) == vrom_end - vrom_start
     new_dmadata = []  # new dmadata: list[dmadata.Entry]
 
-    decompressed = io.BytesIO(b"")
-
-    for dma_entry in dma_entries:
-        v_start = dma_entry.vrom_start
-        v_end = dma_entry.vrom_end
-        p_start = dma_entry.rom_start
-        p_end = dma_entry.rom_end
-        if dma_entry.is_syms():
-            new_dmadata.append(dma_entry)
-            continue
-        if dma_entry.is_compressed():
-            new_contents = decompress(file_content[p_start:p_end], is_zlib_compressed)
-            rom_segments[v_start] = new_contents
-        else:
-            rom_segments[v_start] = file_content[p_start : p_start + v_end - v_start]
-        new_dmadata.append(dmadata.DmaEntry(v_start, v_end, v_start, 0))
-
-    # write rom segments to vaddrs
-    for vrom_st, data in rom_segments.items():
-        decompressed.seek(vrom_st)
-        decompressed.write(data)
+    # Every segment goes at its vrom address, the rom is padded to a multiple of
+    # 128 KiB after the last one
+    rom_size = max(
+        round_up(dma_entries[-1].vrom_end, 17),
+        max(dma_entry.vrom_end for dma_entry in dma_entries),
+    )
+    decompressed = bytearray(rom_size)
+
+    with multiprocessing.Pool(n_threads, initializer=set_sigint_ignored) as p:
+        pending = []  # (vrom start, result of the decompression)
+
+        for dma_entry in dma_entries:
+            v_start = dma_entry.vrom_start
+            v_end = dma_entry.vrom_end
+            p_start = dma_entry.rom_start
+            p_end = dma_entry.rom_end
+            if dma_entry.is_syms():
+                new_dmadata.append(dma_entry)
+                continue
+            if dma_entry.is_compressed():
+                pending.append(
+                    (
+                        v_start,
+                        p.apply_async(
+                            decompress,
+                            (bytes(file_content[p_start:p_end]), is_zlib_compressed),
+                        ),
+                    )
+                )
+            else:
+                data = file_content[p_start : p_start + v_end - v_start]
+                decompressed[v_start : v_start + len(data)] = data
+            new_dmadata.append(dmadata.DmaEntry(v_start, v_end, v_start, 0))
+
+        # write the decompressed segments to their vaddrs
+        for v_start, result in pending:
+            data = result.get()
+            decompressed[v_start : v_start + len(data)] = data
+
     # write new dmadata
-    decompressed.seek(dmadata_start)
+    offset = dmadata_start
     for dma_entry in new_dmadata:
-        entry_data = bytearray(dmadata.DmaEntry.SIZE_BYTES)
-        dma_entry.to_bin(entry_data)
-        decompressed.write(entry_data)
-    # pad to size
-    padding_end = round_up(dma_entries[-1].vrom_end, 17)
-    decompressed.seek(padding_end - 1)
-    decompressed.write(bytearray([0]))
+        dma_entry.to_bin(memoryview(decompressed)[offset:])
+        offset += dmadata.DmaEntry.SIZE_BYTES
     # re-calculate crc
-    return bytearray(update_crc(decompressed).getbuffer())
+    return update_crc(decompressed)
 
 
 def get_str_hash(byte_array):
@@ -163,6 +180,14 @@ def main():
         help="Version of the game to decompress.",
         default="n64-us",
     )
+    parser.add_argument(
+        "-j",
+        "--threads",
+        dest="n_threads",
+        type=int,
+        default=None,
+        help="How many processes to decompress the segments on (default: all cores).",
+    )
 
     args = parser.parse_args()
 
@@ -222,7 +247,11 @@ def main():
         print("Decompressing rom...")
         is_zlib_compressed = version in {"ique-cn", "ique-zh"}
         file_content = decompress_rom(
-            file_content, dmadata_start, dma_entries, is_zlib_compressed
+            file_content,
+            dmadata_start,
+            dma_entries,
+            is_zlib_compressed,
+            args.n_threads,
         )
 
     file_content = pad_rom(file_content, dma_entries)
@@ -7,13 +7,19 @@ from __future__ import annotations
 
 import argparse
 import colorama
+import hashlib
+import multiprocessing
+import os
 from pathlib import Path
+import pickle
+import sys
 from typing import BinaryIO
 
 import spimdisasm
 
 from file_addresses import DmaFile, parse_file_addresses, get_z_name_for_overlay
 
+
 def load_file_splits(
     context: spimdisasm.common.Context,
     config_dir: Path,
@@ -66,7 +72,109 @@ def load_file_splits(
     )
 
 
+def context_cache_key(rom: Path, config_dir: Path) -> str:
+    """
+    Hash of everything the analyzed context depends on: the ROM, the files in the config directory (file addresses,
+    splits and symbols), the arguments, and the spimdisasm version.
+    """
+    h = hashlib.sha256()
+    h.update(spimdisasm.__version__.encode())
+    h.update(Path(__file__).read_bytes())
+    # --only and --jobs don't change the context
+    argv = []
+    skip = False
+    for arg in sys.argv[1:]:
+        if skip:
+            skip = False
+        elif arg in {"--only", "--jobs"}:
+            skip = True
+        elif not arg.startswith(("--only=", "--jobs=")):
+            argv.append(arg)
+    h.update("\0".join(argv).encode())
+    h.update(rom.read_bytes())
+    for path in sorted(config_dir.rglob("*")):
+        if path.is_file():
+            h.update(str(path.relative_to(config_dir)).encode())
+            h.update(path.read_bytes())
+    return h.hexdigest()
+
+
+def load_context_cache(path: Path, key: str) -> spimdisasm.common.Context | None:
+    try:
+        with path.open("rb") as f:
+            cached_key, context = pickle.load(f)
+    except Exception:
+        return None
+    return context if cached_key == key else None
+
+
+def save_context_cache(path: Path, key: str, context: spimdisasm.common.Context):
+    tmp = path.with_suffix(".tmp")
+    try:
+        with tmp.open("wb") as f:
+            pickle.dump((key, context), f, protocol=pickle.HIGHEST_PROTOCOL)
+        os.replace(tmp, path)
+    except Exception as e:
+        tmp.unlink(missing_ok=True)
+        print(f"Warning: could not cache the context: {e}")
+
+
+def write_file_splits(
+    file_splits: spimdisasm.mips.FileSplits,
+    output_dir: Path,
+    split_functions: Path | None,
+):
+    for sectDict in file_splits.sectionsDict.values():
+        for name, section in sectDict.items():
+            basepath = output_dir / name
+            basepath.parent.mkdir(parents=True, exist_ok=True)
+            if section.sectionType == spimdisasm.common.FileSectionType.Reloc:
+                # basepath is like
+                # .../ovl_Overlay_Name/z_overlay_name
+                # and we want to write relocs to
+                # .../ovl_Overlay_Name/ovl_Overlay_Name_reloc.s
+                path = basepath.parent / f"{basepath.parent.name}_reloc.s"
+                with path.open("w", encoding="UTF-8") as f:
+                    section.disassembleToFile(f)
+            else:
+                section.saveToFile(str(basepath))
+
+    if split_functions is None:
+        return
+
+    for section_name, text_section in file_splits.sectionsDict[
+        spimdisasm.common.FileSectionType.Text
+    ].items():
+        rodata_section = file_splits.sectionsDict[
+            spimdisasm.common.FileSectionType.Rodata
+        ].get(section_name)
+        # FunctionRodataEntry represents a function,
+        # plus any associated rodata (strings, floats, jump tables...)
+        # It can also be rodata that hasn't been associated to any function
+        for (
+            func_rodata_entry
+        ) in spimdisasm.mips.FunctionRodataEntry.getAllEntriesFromSections(
+            text_section, rodata_section
+        ):
+            path = split_functions / section_name / f"{func_rodata_entry.getName()}.s"
+            path.parent.mkdir(parents=True, exist_ok=True)
+            with path.open("w", encoding="UTF-8") as f:
+                func_rodata_entry.writeToFile(f, writeFunction=True)
+
+
+# What the write workers need, inherited from the parent process when they are forked after the analysis
+write_state: tuple[list[spimdisasm.mips.FileSplits], Path, Path | None] | None = None
+
+
+def write_file_splits_worker(i: int) -> str:
+    all_file_splits, output_dir, split_functions = write_state
+    write_file_splits(all_file_splits[i], output_dir, split_functions)
+    return all_file_splits[i].name
+
+
 def main():
+    global write_state
+
     parser = argparse.ArgumentParser(description="Disassemble a ROM.")
     parser.add_argument("rom", type=Path, help="Input ROM")
     parser.add_argument(
@@ -78,6 +186,19 @@ def main():
     parser.add_argument(
         "--split-functions", help="Write functions into separate files", type=Path
     )
+    parser.add_argument(
+        "--only",
+        help=(
+            "Comma-separated names of the files (as in file_addresses.csv) to write, the symbols of the others are"
+            " still known. With the context cached by a previous run, only these files are analyzed again"
+        ),
+    )
+    parser.add_argument(
+        "--jobs",
+        help="Number of processes writing the disassembly (default: all cores)",
+        type=int,
+        default=os.cpu_count(),
+    )
 
     spimdisasm.common.Context.addParametersToArgParse(parser)
     spimdisasm.common.GlobalConfig.addParametersToArgParse(parser)
@@ -91,13 +212,6 @@ def main():
         print("Hint: run `make setup` to update the venv.")
         exit(1)
 
-    context = spimdisasm.common.Context()
-    context.parseArgs(args)
-    context.changeGlobalSegmentRanges(0x00000000, 0x01000000, 0x8000000, 0x81000000)
-    context.addBannedSymbolRange(0x0000F000, 0x00010100)
-    context.addBannedSymbolRange(0x10000000, 0x80000300)
-    context.addBannedSymbolRange(0xA0000000, 0xFFFFFFFF)
-
     spimdisasm.mips.InstructionConfig.parseArgs(args)
     spimdisasm.common.GlobalConfig.parseArgs(args)
 
@@ -106,6 +220,34 @@ def main():
 
     dma_files = parse_file_addresses(args.config_dir / "file_addresses.csv")
 
+    only = set(args.only.split(",")) if args.only else None
+    if only is not None:
+        unknown = only - {dma_file.name for dma_file in dma_files}
+        if unknown:
+            print(f"Error: unknown files {', '.join(sorted(unknown))}")
+            exit(1)
+
+    output_dir: Path = args.output_dir
+    output_dir.mkdir(parents=True, exist_ok=True)
+
+    # The context once every file was analyzed. Analyzing a file adds the symbols it references to the context the
+    # other files are disassembled with, so the analysis has to see all of them, in one process. With a context from
+    # a previous run that had the same inputs, the files that are written are enough.
+    context_cache_path = output_dir / "context.pickle"
+    cache_key = context_cache_key(args.rom, args.config_dir)
+    context = load_context_cache(context_cache_path, cache_key) if only else None
+    analyze_all = context is None
+    if not analyze_all:
+        print("Using the cached context")
+        dma_files = [dma_file for dma_file in dma_files if dma_file.name in only]
+    else:
+        context = spimdisasm.common.Context()
+        context.parseArgs(args)
+        context.changeGlobalSegmentRanges(0x00000000, 0x01000000, 0x8000000, 0x81000000)
+        context.addBannedSymbolRange(0x0000F000, 0x00010100)
+        context.addBannedSymbolRange(0x10000000, 0x80000300)
+        context.addBannedSymbolRange(0xA0000000, 0xFFFFFFFF)
+
     print("Loading disasm info...")
     all_file_splits: list[spimdisasm.mips.FileSplits] = []
     with open(args.rom, "rb") as f:
@@ -123,65 +265,38 @@ def main():
     print()
     print("Analyzing done.")
 
-    output_dir: Path = args.output_dir
-    output_dir.mkdir(parents=True, exist_ok=True)
-
+    if analyze_all:
+        save_context_cache(context_cache_path, cache_key, context)
     context.saveContextToFile(output_dir / "context.csv")
 
-    print("Writing disassembled sections...")
-    for i, file_splits in enumerate(all_file_splits):
-        f = i / len(all_file_splits)
+    if only is not None:
+        all_file_splits = [
+            file_splits
+            for file_splits, dma_file in zip(all_file_splits, dma_files)
+            if dma_file.name in only
+        ]
 
-        spimdisasm.common.Utils.printQuietless(f'{colorama.ansi.clear_line()}{f*100:3.0f}% Writing {file_splits.name}\r', end="", flush=True)
-
-        for sectDict in file_splits.sectionsDict.values():
-            for name, section in sectDict.items():
-                basepath = output_dir / name
-                basepath.parent.mkdir(parents=True, exist_ok=True)
-                if section.sectionType == spimdisasm.common.FileSectionType.Reloc:
-                    # basepath is like
-                    # .../ovl_Overlay_Name/z_overlay_name
-                    # and we want to write relocs to
-                    # .../ovl_Overlay_Name/ovl_Overlay_Name_reloc.s
-                    path = basepath.parent / f"{basepath.parent.name}_reloc.s"
-                    with path.open("w", encoding="UTF-8") as f:
-                        section.disassembleToFile(f)
-                else:
-                    section.saveToFile(str(basepath))
-    print()
-    print("Writing sections done.")
+    print("Writing disassembled sections...")
+    # Writing only reads what the analysis found, the workers are forked with it instead of being sent it. Where
+    # processes can't be forked, the files are written in this one.
+    write_state = (all_file_splits, output_dir, args.split_functions)
+    jobs = args.jobs if "fork" in multiprocessing.get_all_start_methods() else 1
+    if jobs > 1 and len(all_file_splits) > 1:
+        with multiprocessing.get_context("fork").Pool(jobs) as pool:
+            names = pool.imap_unordered(write_file_splits_worker, range(len(all_file_splits)))
+            for i, name in enumerate(names):
+                f = (i + 1) / len(all_file_splits)
 
-    if args.split_functions is not None:
-        print("Writing disassembled functions individually...")
+                spimdisasm.common.Utils.printQuietless(f'{colorama.ansi.clear_line()}{f*100:3.0f}% Wrote {name}\r', end="", flush=True)
+    else:
         for i, file_splits in enumerate(all_file_splits):
             f = i / len(all_file_splits)
 
             spimdisasm.common.Utils.printQuietless(f'{colorama.ansi.clear_line()}{f*100:3.0f}% Writing {file_splits.name}\r', end="", flush=True)
 
-            for section_name, text_section in file_splits.sectionsDict[
-                spimdisasm.common.FileSectionType.Text
-            ].items():
-                rodata_section = file_splits.sectionsDict[
-                    spimdisasm.common.FileSectionType.Rodata
-                ].get(section_name)
-                # FunctionRodataEntry represents a function,
-                # plus any associated rodata (strings, floats, jump tables...)
-                # It can also be rodata that hasn't been associated to any function
-                for (
-                    func_rodata_entry
-                ) in spimdisasm.mips.FunctionRodataEntry.getAllEntriesFromSections(
-                    text_section, rodata_section
-                ):
-                    output_dir = (
-                        args.split_functions
-                        / section_name
-                        / f"{func_rodata_entry.getName()}.s"
-                    )
-                    output_dir.parent.mkdir(parents=True, exist_ok=True)
-                    with output_dir.open("w", encoding="UTF-8") as f:
-                        func_rodata_entry.writeToFile(f, writeFunction=True)
-        print()
-        print("Writing functions done.")
+            write_file_splits(file_splits, output_dir, args.split_functions)
+    print()
+    print("Writing done.")
 
 
 if __name__ == "__main__":
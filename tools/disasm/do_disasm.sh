@@ -15,6 +15,11 @@ DISASM_FLAGS="--custom-suffix _unknown --sequential-label-names --no-use-fpccsr
 DISASM_FLAGS="$DISASM_FLAGS --config-dir $DISASM_DATA_DIR --symbol-addrs $DISASM_DATA_DIR/functions.txt --symbol-addrs $DISASM_DATA_DIR/variables.txt"
 
 echo Disassembling...
+# DISASM_ONLY: comma-separated names of the files to disassemble again, see --only in disasm.py
+if [ "${DISASM_ONLY-}" ]
+then
+DISASM_FLAGS="$DISASM_FLAGS --only $DISASM_ONLY"
+fi
 cmd="$PYTHON tools/disasm/disasm.py $DISASM_FLAGS $DISASM_BASEROM -o $DISASM_DIR --split-functions $DISASM_DIR/functions"
 echo "$cmd"
 $cmd || (
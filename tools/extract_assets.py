@@ -1,6 +1,6 @@
 #!/usr/bin/env python3
 
-import argparse, json, os, signal, time, colorama, multiprocessing
+import argparse, json, os, signal, subprocess, time, colorama, multiprocessing
 from pathlib import Path
 
 colorama.init()
@@ -15,22 +15,30 @@ def SignalHandler(sig, frame):
     mainAbort.set()
     # Don't exit immediately to update the extracted assets file.
 
-def ExtractFile(xmlPath, outputPath, outputSourcePath):
-    if globalAbort.is_set():
-        # Don't extract if another file wasn't extracted properly.
-        return
-
-    generateSourceFile = "1"
+def GenerateSourceFileFlag(xmlPath):
     for name in dontGenerateCFilesList:
         if name in xmlPath:
-            generateSourceFile = "0"
-            break
+            return "0"
+    return "1"
 
-    execStr = f"tools/ZAPD/ZAPD.out e -eh -i {xmlPath} -b {globalBaseromSegmentsDir} -o {outputPath} -osf {outputSourcePath} -gsf {generateSourceFile} -rconf tools/ZAPDConfigs/MM/Config.xml --cs-float both {ZAPDArgs}"
+def ZAPDCommonArgs():
+    execStr = f"-eh -b {globalBaseromSegmentsDir} -rconf tools/ZAPDConfigs/MM/Config.xml --cs-float both {ZAPDArgs}"
 
     if globalUnaccounted:
         execStr += " -Wunaccounted"
 
+    if ZAPDCacheDir is not None:
+        execStr += f" --cache-dir {ZAPDCacheDir}"
+
+    return execStr
+
+def ExtractFile(xmlPath, outputPath, outputSourcePath):
+    if globalAbort.is_set():
+        # Don't extract if another file wasn't extracted properly.
+        return
+
+    execStr = f"tools/ZAPD/ZAPD.out e -i {xmlPath} -o {outputPath} -osf {outputSourcePath} -gsf {GenerateSourceFileFlag(xmlPath)} {ZAPDCommonArgs()}"
+
     print(execStr)
     exitValue = os.system(execStr)
     if exitValue != 0:
@@ -40,7 +48,29 @@ def ExtractFile(xmlPath, outputPath, outputSourcePath):
         print("Aborting...", file=os.sys.stderr)
         print("\n")
 
-def ExtractFunc(fullPath):
+def ExtractBatch(jobs):
+    """Extracts several XMLs with a single ZAPD process, so the config and the external files are only loaded once."""
+    if globalAbort.is_set():
+        # Don't extract if another file wasn't extracted properly.
+        return
+
+    jobList = ""
+    for xmlPath, outputPath, outputSourcePath in jobs:
+        print(xmlPath)
+        jobList += f"-i {xmlPath} -o {outputPath} -osf {outputSourcePath} -gsf {GenerateSourceFileFlag(xmlPath)}\n"
+
+    execStr = f"tools/ZAPD/ZAPD.out batch -l - -j {globalZAPDThreads} {ZAPDCommonArgs()}"
+
+    print(execStr)
+    exitValue = subprocess.run(execStr, shell=True, input=jobList, text=True).returncode
+    if exitValue != 0:
+        globalAbort.set()
+        print("\n")
+        print("Error when extracting from files " + ", ".join(job[0] for job in jobs), file=os.sys.stderr)
+        print("Aborting...", file=os.sys.stderr)
+        print("\n")
+
+def GetOutputPaths(fullPath):
     *pathList, xmlName = fullPath.split(os.sep)
     objectName = os.path.splitext(xmlName)[0]
 
@@ -50,36 +80,66 @@ def ExtractFunc(fullPath):
         outPath = os.path.join(globalOutputDir, *pathList[2:], objectName)
     outSourcePath = outPath
 
+    return outPath, outSourcePath
+
+def IsUpToDate(fullPath):
+    if ZAPDCacheDir is not None:
+        # ZAPD's cache knows whether any input changed, the XML timestamp alone doesn't.
+        return False
     if fullPath in globalExtractedAssetsTracker:
         timestamp = globalExtractedAssetsTracker[fullPath]["timestamp"]
         modificationTime = int(os.path.getmtime(fullPath))
         if modificationTime < timestamp:
             # XML has not been modified since last extraction.
-            return
+            return True
+    return False
+
+def UpdateTimestamp(fullPath, currentTimeStamp):
+    # Only update timestamp on successful extractions
+    if fullPath not in globalExtractedAssetsTracker:
+        globalExtractedAssetsTracker[fullPath] = globalManager.dict()
+    globalExtractedAssetsTracker[fullPath]["timestamp"] = currentTimeStamp
+
+def ExtractFunc(fullPath):
+    if IsUpToDate(fullPath):
+        return
 
+    outPath, outSourcePath = GetOutputPaths(fullPath)
     currentTimeStamp = int(time.time())
 
     ExtractFile(fullPath, outPath, outSourcePath)
 
     if not globalAbort.is_set():
-        # Only update timestamp on successful extractions
-        if fullPath not in globalExtractedAssetsTracker:
-            globalExtractedAssetsTracker[fullPath] = globalManager.dict()
-        globalExtractedAssetsTracker[fullPath]["timestamp"] = currentTimeStamp
+        UpdateTimestamp(fullPath, currentTimeStamp)
+
+def ExtractBatchFunc(fullPaths):
+    pendingPaths = [fullPath for fullPath in fullPaths if not IsUpToDate(fullPath)]
+    if len(pendingPaths) == 0:
+        return
+
+    currentTimeStamp = int(time.time())
+
+    ExtractBatch([(fullPath, *GetOutputPaths(fullPath)) for fullPath in pendingPaths])
+
+    if not globalAbort.is_set():
+        for fullPath in pendingPaths:
+            UpdateTimestamp(fullPath, currentTimeStamp)
 
-def initializeWorker(abort, unaccounted: bool, extractedAssetsTracker: dict, manager, baseromSegmentsDir: Path, outputDir: Path):
+def initializeWorker(abort, unaccounted: bool, extractedAssetsTracker: dict, manager, baseromSegmentsDir: Path, outputDir: Path, ZAPDThreads: int = 1):
     global globalAbort
     global globalUnaccounted
     global globalExtractedAssetsTracker
     global globalManager
     global globalBaseromSegmentsDir
     global globalOutputDir
+    global globalZAPDThreads
     globalAbort = abort
     globalUnaccounted = unaccounted
     globalExtractedAssetsTracker = extractedAssetsTracker
     globalManager = manager
     globalBaseromSegmentsDir = baseromSegmentsDir
     globalOutputDir = outputDir
+    globalZAPDThreads = ZAPDThreads
 
 def main():
     parser = argparse.ArgumentParser(description="baserom asset extractor")
@@ -98,6 +158,7 @@ def main():
     parser.add_argument("-f", "--force", help="Force the extraction of every xml instead of checking the touched ones.", action="store_true")
     parser.add_argument("-j", "--jobs", help="Number of cpu cores to extract with.")
     parser.add_argument("-u", "--unaccounted", help="Enables ZAPD unaccounted detector warning system.", action="store_true")
+    parser.add_argument("-c", "--cache-dir", help="Keep a ZAPD extraction cache in this directory. Every XML is handed to ZAPD, which restores the ones whose inputs didn't change from the cache.", type=Path)
     parser.add_argument("-Z", help="Pass the argument on to ZAPD, e.g. `-ZWunaccounted` to warn about unaccounted blocks in XMLs. Each argument should be passed separately, *without* the leading dash.", metavar="ZAPD_ARG", action="append")
     args = parser.parse_args()
 
@@ -106,6 +167,9 @@ def main():
 
     args.output_dir.mkdir(parents=True, exist_ok=True)
 
+    global ZAPDCacheDir
+    ZAPDCacheDir = args.cache_dir
+
     global ZAPDArgs
     ZAPDArgs = ""
     if args.Z is not None:
@@ -156,20 +220,16 @@ def main():
                 if file.endswith(".xml") and (fullPath.find("audio") == -1):
                     xmlFiles.append(fullPath)
 
-        try:
-            numCores = int(args.jobs or 0)
-            if numCores <= 0:
-                numCores = 1
-            print("Extracting assets with " + str(numCores) + " CPU core" + ("s" if numCores > 1 else "") + ".")
-            with multiprocessing.get_context("fork").Pool(numCores,  initializer=initializeWorker, initargs=(mainAbort, args.unaccounted, extractedAssetsTracker, manager, baseromSegmentsDir, outputDir)) as p:
-                p.map(ExtractFunc, xmlFiles)
-        except (multiprocessing.ProcessError, TypeError):
-            print("Warning: Multiprocessing exception occurred.", file=os.sys.stderr)
-            print("Disabling mutliprocessing.", file=os.sys.stderr)
-
-            initializeWorker(mainAbort, args.unaccounted, extractedAssetsTracker, manager, baseromSegmentsDir, outputDir)
-            for singlePath in xmlFiles:
-                ExtractFunc(singlePath)
+        numCores = int(args.jobs or 0)
+        if numCores <= 0:
+            numCores = 1
+        print("Extracting assets with " + str(numCores) + " CPU core" + ("s" if numCores > 1 else "") + ".")
+
+        # A single ZAPD process extracts everything on `numCores` threads.
+        # Start with the biggest XMLs so they don't end up being the last ones running.
+        xmlFiles.sort(key=os.path.getsize, reverse=True)
+        initializeWorker(mainAbort, args.unaccounted, extractedAssetsTracker, manager, baseromSegmentsDir, outputDir, numCores)
+        ExtractBatchFunc(xmlFiles)
 
     with extractedAssetsFile.open('w', encoding='utf-8') as f:
         serializableDict = dict()
@@ -2,7 +2,8 @@
 /* SPDX-License-Identifier: AGPL-3.0-only */
 #pragma once
 
+#include <stdbool.h>
 #include <stdio.h>
 
-void Fado_Relocs(FILE* outputFile, int inputFilesCount, FILE** inputFiles, const char* ovlName);
+void Fado_Relocs(FILE* outputFile, int inputFilesCount, FILE** inputFiles, const char* ovlName, bool compact);
 // void Fado_WriteRelocFile(FILE* outputFile, FILE** inputFiles, int inputFilesCount);
@@ -3,6 +3,9 @@
  */
 /* Copyright (C) 2021 Elliptic Ellipsis */
 /* SPDX-License-Identifier: AGPL-3.0-only */
+/* For fileno */
+#define _POSIX_C_SOURCE 200809L
+
 #include "fairy.h"
 
 #include <assert.h>
@@ -13,6 +16,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if !defined _WIN32 || defined __CYGWIN__
+#define FAIRY_USE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "vc_vector/vc_vector.h"
 #include "macros.h"
 
@@ -103,10 +112,8 @@ bool Fairy_StartsWith(const char* string, const char* initial) {
  * - The rest of the arguments are important information about the struct it is reading (offset and size, usually)
  */
 
-FairyFileHeader* Fairy_ReadFileHeader(FairyFileHeader* header, FILE* file) {
-    fseek(file, 0, SEEK_SET);
-    assert(fread(header, sizeof(char), 0x34, file) == 0x34);
-
+/* Checks and reends a file header that has been copied from the file as it is */
+static FairyFileHeader* Fairy_DecodeFileHeader(FairyFileHeader* header) {
     if (!Fairy_VerifyMagic(header->e_ident)) {
         fprintf(stderr, "Not a valid ELF file.\n");
         return NULL;
@@ -144,6 +151,13 @@ FairyFileHeader* Fairy_ReadFileHeader(FairyFileHeader* header, FILE* file) {
     return header;
 }
 
+FairyFileHeader* Fairy_ReadFileHeader(FairyFileHeader* header, FILE* file) {
+    fseek(file, 0, SEEK_SET);
+    assert(fread(header, sizeof(char), 0x34, file) == 0x34);
+
+    return Fairy_DecodeFileHeader(header);
+}
+
 /* tableOffset and number should be obtained from the file header */
 FairySecHeader* Fairy_ReadSectionTable(FairySecHeader* sectionTable, FILE* file, size_t tableOffset, size_t number) {
     size_t entrySize = sizeof(FairySecHeader);
@@ -251,6 +265,127 @@ size_t Fairy_ReadRelocs(FairyRela** relocsOut, FILE* file, int type, size_t offs
     return finalSize / sizeof(FairyRela);
 }
 
+/* Zero-copy reading functions */
+
+/**
+ * Makes the whole of file available as a view, by mapping it if possible and reading it otherwise. The view must be
+ * released with Fairy_UnmapFile.
+ */
+bool Fairy_MapFile(FairyElfView* view, FILE* file) {
+    long size;
+    uint8_t* data;
+
+    view->data = NULL;
+    view->size = 0;
+    view->mapped = false;
+
+#ifdef FAIRY_USE_MMAP
+    {
+        struct stat fileStat;
+
+        if ((fstat(fileno(file), &fileStat) == 0) && S_ISREG(fileStat.st_mode) && (fileStat.st_size > 0)) {
+            void* map = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+
+            if (map != MAP_FAILED) {
+                view->data = map;
+                view->size = fileStat.st_size;
+                view->mapped = true;
+                return true;
+            }
+        }
+    }
+#endif
+
+    /* Fall back to reading it all at once */
+    if ((fseek(file, 0, SEEK_END) != 0) || ((size = ftell(file)) < 0) || (fseek(file, 0, SEEK_SET) != 0)) {
+        return false;
+    }
+    data = malloc((size != 0) ? size : 1);
+    if (data == NULL) {
+        return false;
+    }
+    if (fread(data, sizeof(char), size, file) != (size_t)size) {
+        free(data);
+        return false;
+    }
+    view->data = data;
+    view->size = size;
+    return true;
+}
+
+void Fairy_UnmapFile(FairyElfView* view) {
+#ifdef FAIRY_USE_MMAP
+    if (view->mapped) {
+        munmap((void*)view->data, view->size);
+    } else
+#endif
+    {
+        free((void*)view->data);
+    }
+    view->data = NULL;
+    view->size = 0;
+}
+
+/* Returns the size bytes at offset in the file, which must be within it */
+const uint8_t* Fairy_ViewData(const FairyElfView* view, size_t offset, size_t size) {
+    assert((offset <= view->size) && (size <= view->size - offset));
+    return &view->data[offset];
+}
+
+FairyFileHeader* Fairy_ViewFileHeader(FairyFileHeader* header, const FairyElfView* view) {
+    memcpy(header, Fairy_ViewData(view, 0, 0x34), 0x34);
+    return Fairy_DecodeFileHeader(header);
+}
+
+/* Reads section index of the section table described by fileHeader */
+FairySecHeader* Fairy_ViewSectionHeader(FairySecHeader* sectionHeader, const FairyElfView* view,
+                                        const FairyFileHeader* fileHeader, size_t index) {
+    const uint8_t* data;
+
+    assert(index < fileHeader->e_shnum);
+    data = Fairy_ViewData(view, fileHeader->e_shoff + index * fileHeader->e_shentsize, 0x28);
+
+    sectionHeader->sh_name = Fairy_ReadWord(&data[0x00]);
+    sectionHeader->sh_type = Fairy_ReadWord(&data[0x04]);
+    sectionHeader->sh_flags = Fairy_ReadWord(&data[0x08]);
+    sectionHeader->sh_addr = Fairy_ReadWord(&data[0x0C]);
+    sectionHeader->sh_offset = Fairy_ReadWord(&data[0x10]);
+    sectionHeader->sh_size = Fairy_ReadWord(&data[0x14]);
+    sectionHeader->sh_link = Fairy_ReadWord(&data[0x18]);
+    sectionHeader->sh_info = Fairy_ReadWord(&data[0x1C]);
+    sectionHeader->sh_addralign = Fairy_ReadWord(&data[0x20]);
+    sectionHeader->sh_entsize = Fairy_ReadWord(&data[0x24]);
+
+    return sectionHeader;
+}
+
+/* symbolTable points to the contents of a symbol table section */
+FairySym Fairy_ViewSymbol(const uint8_t* symbolTable, size_t index) {
+    const uint8_t* data = &symbolTable[index * 0x10];
+    FairySym symbol;
+
+    symbol.st_name = Fairy_ReadWord(&data[0x0]);
+    symbol.st_value = Fairy_ReadWord(&data[0x4]);
+    symbol.st_size = Fairy_ReadWord(&data[0x8]);
+    symbol.st_info = data[0xC];
+    symbol.st_other = data[0xD];
+    symbol.st_shndx = Fairy_ReadHalf(&data[0xE]);
+
+    return symbol;
+}
+
+/* relocs points to the contents of a relocation section of the given type, SHT_REL relocations get an addend of 0 */
+FairyRela Fairy_ViewReloc(const uint8_t* relocs, int type, size_t index) {
+    const uint8_t* data = &relocs[index * ((type == SHT_REL) ? 0x8 : 0xC)];
+    FairyRela reloc;
+
+    reloc.r_offset = Fairy_ReadWord(&data[0x0]);
+    reloc.r_info = Fairy_ReadWord(&data[0x4]);
+    reloc.r_addend = (type == SHT_REL) ? 0 : (Elf32_Sword)Fairy_ReadWord(&data[0x8]);
+
+    return reloc;
+}
+
 char* Fairy_GetSectionName(FairySecHeader* sectionTable, char* shstrtab, size_t index) {
     return &shstrtab[sectionTable[index].sh_name];
 }
@@ -262,10 +397,14 @@ char* Fairy_GetSymbolName(FairySym* symtab, char* strtab, size_t index) {
 
 /* FairyFileInfo functions */
 
+/**
+ * Reads the parts of the file needed for relocating. The file is mapped rather than read section by section, and only
+ * the symbol and relocation tables are copied out of it, to be reended.
+ */
 void Fairy_InitFile(FairyFileInfo* fileInfo, FILE* file) {
     FairyFileHeader fileHeader;
-    FairySecHeader* sectionTable;
-    char* shstrtab;
+    FairySecHeader shstrtabHeader;
+    const char* shstrtab;
     int i;
 
     assert(fileInfo != NULL);
@@ -275,15 +414,13 @@ void Fairy_InitFile(FairyFileInfo* fileInfo, FILE* file) {
     for (i = 0; i < 3; i++) {
         fileInfo->progBitsSizes[i] = 0;
     }
-    Fairy_ReadFileHeader(&fileHeader, file);
-
-    sectionTable = malloc(fileHeader.e_shnum * fileHeader.e_shentsize);
-    Fairy_ReadSectionTable(sectionTable, file, fileHeader.e_shoff, fileHeader.e_shnum);
+    fileInfo->strtab = NULL;
+    assert(Fairy_MapFile(&fileInfo->view, file));
+    Fairy_ViewFileHeader(&fileHeader, &fileInfo->view);
 
-    shstrtab = malloc(sectionTable[fileHeader.e_shstrndx].sh_size * sizeof(char));
-    fseek(file, sectionTable[fileHeader.e_shstrndx].sh_offset, SEEK_SET);
-    assert(fread(shstrtab, sizeof(char), sectionTable[fileHeader.e_shstrndx].sh_size, file) ==
-           sectionTable[fileHeader.e_shstrndx].sh_size);
+    Fairy_ViewSectionHeader(&shstrtabHeader, &fileInfo->view, &fileHeader, fileHeader.e_shstrndx);
+    shstrtab =
+        (const char*)Fairy_ViewData(&fileInfo->view, shstrtabHeader.sh_offset, shstrtabHeader.sh_size);
 
     /* Search for the sections we need */
     {
@@ -296,7 +433,7 @@ void Fairy_InitFile(FairyFileInfo* fileInfo, FILE* file) {
         for (currentIndex = 0; currentIndex < fileHeader.e_shnum; currentIndex++) {
             size_t off = 0;
 
-            currentSection = sectionTable[currentIndex];
+            Fairy_ViewSectionHeader(&currentSection, &fileInfo->view, &fileHeader, currentIndex);
 
             switch (currentSection.sh_type) {
                 case SHT_PROGBITS:
@@ -344,19 +481,30 @@ void Fairy_InitFile(FairyFileInfo* fileInfo, FILE* file) {
 
                 case SHT_SYMTAB:
                     if (strcmp(&shstrtab[currentSection.sh_name + 1], "symtab") == 0) {
+                        const uint8_t* data = Fairy_ViewData(&fileInfo->view, currentSection.sh_offset,
+                                                             currentSection.sh_size);
+                        size_t number = currentSection.sh_size / sizeof(FairySym);
+                        FairySym* symbolTable = malloc(number * sizeof(FairySym));
+                        size_t j;
+
+                        assert(symbolTable != NULL);
+                        for (j = 0; j < number; j++) {
+                            symbolTable[j] = Fairy_ViewSymbol(data, j);
+                        }
+
                         fileInfo->symtabInfo.sectionType = SHT_SYMTAB;
                         fileInfo->symtabInfo.sectionEntrySize = sizeof(FairySym);
-                        fileInfo->symtabInfo.sectionEntryCount =
-                            Fairy_ReadSymbolTable((FairySym**)&fileInfo->symtabInfo.sectionData, file,
-                                                  currentSection.sh_offset, currentSection.sh_size);
+                        fileInfo->symtabInfo.sectionEntryCount = number;
+                        fileInfo->symtabInfo.sectionData = symbolTable;
                     }
                     break;
 
                 case SHT_STRTAB:
                     if (strcmp(&shstrtab[currentSection.sh_name + 1], "strtab") == 0) {
                         FAIRY_DEBUG_PRINTF("%s", "strtab found\n");
-                        fileInfo->strtab = malloc(currentSection.sh_size);
-                        Fairy_ReadStringTable(fileInfo->strtab, file, currentSection.sh_offset, currentSection.sh_size);
+                        /* Used in place */
+                        fileInfo->strtab = (char*)Fairy_ViewData(&fileInfo->view, currentSection.sh_offset,
+                                                                 currentSection.sh_size);
                     }
                     break;
 
@@ -381,11 +529,25 @@ void Fairy_InitFile(FairyFileInfo* fileInfo, FILE* file) {
                         }
                         FAIRY_DEBUG_PRINTF("Found %s section\n", &shstrtab[currentSection.sh_name]);
 
-                        fileInfo->relocTablesInfo[relocSection].sectionType = SHT_RELA;
-                        fileInfo->relocTablesInfo[relocSection].sectionEntrySize = sizeof(FairyRela);
-                        fileInfo->relocTablesInfo[relocSection].sectionEntryCount =
-                            Fairy_ReadRelocs((FairyRela**)&fileInfo->relocTablesInfo[relocSection].sectionData, file,
-                                             currentSection.sh_type, currentSection.sh_offset, currentSection.sh_size);
+                        {
+                            const uint8_t* data = Fairy_ViewData(&fileInfo->view, currentSection.sh_offset,
+                                                                 currentSection.sh_size);
+                            size_t number = currentSection.sh_size / ((currentSection.sh_type == SHT_REL)
+                                                                          ? sizeof(FairyRel)
+                                                                          : sizeof(FairyRela));
+                            FairyRela* relocTable = malloc(number * sizeof(FairyRela));
+                            size_t j;
+
+                            assert(relocTable != NULL);
+                            for (j = 0; j < number; j++) {
+                                relocTable[j] = Fairy_ViewReloc(data, currentSection.sh_type, j);
+                            }
+
+                            fileInfo->relocTablesInfo[relocSection].sectionType = SHT_RELA;
+                            fileInfo->relocTablesInfo[relocSection].sectionEntrySize = sizeof(FairyRela);
+                            fileInfo->relocTablesInfo[relocSection].sectionEntryCount = number;
+                            fileInfo->relocTablesInfo[relocSection].sectionData = relocTable;
+                        }
                     }
                     break;
 
@@ -395,8 +557,6 @@ void Fairy_InitFile(FairyFileInfo* fileInfo, FILE* file) {
         }
     }
 
-    free(sectionTable);
-    free(shstrtab);
 }
 
 void Fairy_DestroyFile(FairyFileInfo* fileInfo) {
@@ -413,6 +573,6 @@ void Fairy_DestroyFile(FairyFileInfo* fileInfo) {
     FAIRY_DEBUG_PRINTF("%s", "Freeing symtab data\n");
     free(fileInfo->symtabInfo.sectionData);
 
-    FAIRY_DEBUG_PRINTF("%s", "Freeing strtab data\n");
-    free(fileInfo->strtab);
+    FAIRY_DEBUG_PRINTF("%s", "Unmapping file\n");
+    Fairy_UnmapFile(&fileInfo->view);
 }
@@ -2,7 +2,9 @@
 /* SPDX-License-Identifier: AGPL-3.0-only */
 #pragma once
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include "mips_elf.h"
 
@@ -38,12 +40,21 @@ typedef struct {
     size_t sectionEntrySize;
 } FairySectionInfo;
 
+/* A whole ELF file, read-only and mapped into memory where possible. Its fields are big-endian and are loaded from it on
+ * access by the Fairy_View* functions. */
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    bool mapped; /* Otherwise data was read into an allocated buffer */
+} FairyElfView;
+
 typedef struct {
     FairySectionInfo symtabInfo;
-    char* strtab;
+    char* strtab; /* Points into view, read-only */
     Elf32_Word progBitsSizes[3];
     vc_vector* progBitsSections;
     FairySectionInfo relocTablesInfo[3];
+    FairyElfView view;
 } FairyFileInfo;
 
 typedef enum {
@@ -67,6 +78,15 @@ char* Fairy_ReadStringTable(char* stringTable, FILE* file, size_t tableOffset, s
 size_t Fairy_ReadSymbolTable(FairySym** symbolTableOut, FILE* file, size_t tableOffset, size_t tableSize);
 size_t Fairy_ReadRelocs(FairyRela** relocsOut, FILE* file, int type, size_t offset, size_t size);
 
+bool Fairy_MapFile(FairyElfView* view, FILE* file);
+void Fairy_UnmapFile(FairyElfView* view);
+const uint8_t* Fairy_ViewData(const FairyElfView* view, size_t offset, size_t size);
+FairyFileHeader* Fairy_ViewFileHeader(FairyFileHeader* header, const FairyElfView* view);
+FairySecHeader* Fairy_ViewSectionHeader(FairySecHeader* sectionHeader, const FairyElfView* view,
+                                        const FairyFileHeader* fileHeader, size_t index);
+FairySym Fairy_ViewSymbol(const uint8_t* symbolTable, size_t index);
+FairyRela Fairy_ViewReloc(const uint8_t* relocs, int type, size_t index);
+
 char* Fairy_GetSectionName(FairySecHeader* sectionTable, char* shstrtab, size_t index);
 char* Fairy_GetSymbolName(FairySym* symtab, char* strtab, size_t index);
 
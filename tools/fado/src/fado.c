@@ -27,55 +27,95 @@ bool Fado_CheckInProgBitsSections(Elf32_Section section, vc_vector* progBitsSect
     return false;
 }
 
+/* Defining file of a symbol name defined in more than one input file */
+#define FADO_SYMBOL_FILE_MULTIPLE (-1)
+
+typedef struct {
+    const char* name; /* NULL for an empty slot */
+    int file;         /* The file defining the name, or FADO_SYMBOL_FILE_MULTIPLE */
+} FadoSymbolEntry;
+
+/* Open addressing hash table of the names of the symbols defined in the input files */
+typedef struct {
+    FadoSymbolEntry* entries;
+    size_t capacity; /* Power of 2 */
+} FadoSymbolTable;
+
+/* FNV-1a */
+static uint32_t Fado_HashSymbolName(const char* name) {
+    uint32_t hash = 0x811C9DC5;
+
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+static FadoSymbolEntry* Fado_FindSymbolEntry(const FadoSymbolTable* symbolTable, const char* name) {
+    size_t mask = symbolTable->capacity - 1;
+    size_t i = Fado_HashSymbolName(name) & mask;
+
+    while ((symbolTable->entries[i].name != NULL) && (strcmp(symbolTable->entries[i].name, name) != 0)) {
+        i = (i + 1) & mask;
+    }
+    return &symbolTable->entries[i];
+}
+
 /**
- * For each input file, construct a vector of pointers to the starts of the strings defined in that file.
+ * Construct a table of the names of the symbols defined in the input files, and which file defines each of them.
  */
-void Fado_ConstructStringVectors(vc_vector** stringVectors, FairyFileInfo* fileInfo, int numFiles) {
+void Fado_ConstructSymbolTable(FadoSymbolTable* symbolTable, FairyFileInfo* fileInfo, int numFiles) {
+    size_t symbolCount = 0;
     int currentFile;
     size_t currentSym;
 
     for (currentFile = 0; currentFile < numFiles; currentFile++) {
-        FairySym* symtab = fileInfo[currentFile].symtabInfo.sectionData;
+        symbolCount += fileInfo[currentFile].symtabInfo.sectionEntryCount;
+    }
 
-        stringVectors[currentFile] = vc_vector_create(0x40, sizeof(char**), NULL);
+    /* Keep the table at most half full */
+    symbolTable->capacity = 16;
+    while (symbolTable->capacity < 2 * symbolCount) {
+        symbolTable->capacity *= 2;
+    }
+    symbolTable->entries = calloc(symbolTable->capacity, sizeof(FadoSymbolEntry));
+    assert(symbolTable->entries != NULL);
+
+    for (currentFile = 0; currentFile < numFiles; currentFile++) {
+        FairySym* symtab = fileInfo[currentFile].symtabInfo.sectionData;
 
-        /* Build a vector of pointers to defined symbols' names */
         for (currentSym = 0; currentSym < fileInfo[currentFile].symtabInfo.sectionEntryCount; currentSym++) {
             if ((symtab[currentSym].st_shndx != STN_UNDEF) &&
                 Fado_CheckInProgBitsSections(symtab[currentSym].st_shndx, fileInfo[currentFile].progBitsSections)) {
-                /* Have to pass a double pointer so it copies the pointer instead of the start of the string */
-                char* stringPtr = &fileInfo[currentFile].strtab[symtab[currentSym].st_name];
-                assert(vc_vector_push_back(stringVectors[currentFile], &stringPtr));
+                const char* name = &fileInfo[currentFile].strtab[symtab[currentSym].st_name];
+                FadoSymbolEntry* entry = Fado_FindSymbolEntry(symbolTable, name);
+
+                if (entry->name == NULL) {
+                    entry->name = name;
+                    entry->file = currentFile;
+                } else if (entry->file != currentFile) {
+                    entry->file = FADO_SYMBOL_FILE_MULTIPLE;
+                }
             }
         }
     }
 }
 
-bool Fado_FindSymbolNameInOtherFiles(const char* name, int thisFile, vc_vector** stringVectors, int numFiles) {
-    int currentFile;
-    char** currentString;
+bool Fado_FindSymbolNameInOtherFiles(const char* name, int thisFile, const FadoSymbolTable* symbolTable) {
+    const FadoSymbolEntry* entry = Fado_FindSymbolEntry(symbolTable, name);
 
-    for (currentFile = 0; currentFile < numFiles; currentFile++) {
-        if (currentFile == thisFile) {
-            continue;
-        }
-        VC_FOREACH(currentString, stringVectors[currentFile]) {
-            if (strcmp(name, *currentString) == 0) {
-                FAIRY_DEBUG_PRINTF("Match found for %s\n", name);
-                return true;
-            }
-        }
+    /* Defined in some file that is not this one */
+    if ((entry->name != NULL) && (entry->file != thisFile)) {
+        FAIRY_DEBUG_PRINTF("Match found for %s\n", name);
+        return true;
     }
     FAIRY_DEBUG_PRINTF("No match found for %s\n", name);
     return false;
 }
 
-void Fado_DestroyStringVectors(vc_vector** stringVectors, int numFiles) {
-    int currentFile;
-    for (currentFile = 0; currentFile < numFiles; currentFile++) {
-        vc_vector_release(stringVectors[currentFile]);
-    }
-    free(stringVectors);
+void Fado_DestroySymbolTable(FadoSymbolTable* symbolTable) {
+    free(symbolTable->entries);
 }
 
 typedef struct {
@@ -178,19 +218,176 @@ static const FairyDefineString relTypeNames[] = {
     FAIRY_DEF_STRING(, R_MIPS_NUM),
 };
 
+/* Compact relocation format, see z64_relocation_section_format.md */
+
+/* Most relocations of a R_MIPS_32 or R_MIPS_26 run after the first, limited by the u16 count */
+#define FADO_COMPACT_RUN_MAX 0xFFFF
+
+/* Range of the signed word delta of a HI16/LO16 run entry, which keeps the type in bit 0 */
+#define FADO_COMPACT_HILO_DELTA_MIN (-0x4000)
+#define FADO_COMPACT_HILO_DELTA_MAX 0x3FFF
+
+static int Fado_CompareRelocOffsets(const void* a, const void* b) {
+    uint32_t offsetA = ((const FadoRelocInfo*)a)->relocWord & 0xFFFFFF;
+    uint32_t offsetB = ((const FadoRelocInfo*)b)->relocWord & 0xFFFFFF;
+
+    return (offsetA > offsetB) - (offsetA < offsetB);
+}
+
+static void Fado_PrintCompactComment(FILE* outputFile, const FadoRelocInfo* reloc, FairySym** symtabs,
+                                     FairyFileInfo* fileInfos) {
+    fprintf(outputFile, " # %-11s 0x%06X %s\n", Fairy_StringFromDefine(relTypeNames, (reloc->relocWord >> 0x18) & 0x3F),
+            reloc->relocWord & 0xFFFFFF,
+            Fairy_GetSymbolName(symtabs[reloc->file], fileInfos[reloc->file].strtab, reloc->symbolIndex));
+}
+
+/**
+ * Writes the relocs as runs: a run starts with its first reloc word as two halfwords and the number of relocs that
+ * follow, then one halfword per following reloc. R_MIPS_32 and R_MIPS_26 relocs are sorted and give the unsigned word
+ * distance from the previous one, HI16/LO16 relocs keep their order (see the Overlay_Relocate register tracking) and
+ * give the signed word distance shifted left by one, with bit 0 set for a LO16. Returns the number of halfwords
+ * written, and the number of runs in numRunsOut.
+ */
+static uint32_t Fado_WriteCompactRuns(FILE* outputFile, FadoRelocInfo* relocs, size_t count, bool isHiLo,
+                                      FairySym** symtabs, FairyFileInfo* fileInfos, uint32_t* numRunsOut) {
+    uint32_t halfCount = 0;
+    size_t runStart = 0;
+
+    while (runStart < count) {
+        size_t runEnd = runStart + 1;
+        size_t i;
+
+        /* Extend the run while the distance to the next reloc can be encoded */
+        while ((runEnd < count) && (runEnd - runStart <= FADO_COMPACT_RUN_MAX)) {
+            int32_t delta = (int32_t)((relocs[runEnd].relocWord & 0xFFFFFF) >> 2) -
+                            (int32_t)((relocs[runEnd - 1].relocWord & 0xFFFFFF) >> 2);
+
+            if (isHiLo ? ((delta < FADO_COMPACT_HILO_DELTA_MIN) || (delta > FADO_COMPACT_HILO_DELTA_MAX))
+                       : (delta > 0xFFFF)) {
+                break;
+            }
+            runEnd++;
+        }
+
+        fprintf(outputFile, ".half 0x%04X, 0x%04X, %u", relocs[runStart].relocWord >> 0x10,
+                relocs[runStart].relocWord & 0xFFFF, (unsigned)(runEnd - runStart - 1));
+        Fado_PrintCompactComment(outputFile, &relocs[runStart], symtabs, fileInfos);
+
+        for (i = runStart + 1; i < runEnd; i++) {
+            int32_t delta = (int32_t)((relocs[i].relocWord & 0xFFFFFF) >> 2) -
+                            (int32_t)((relocs[i - 1].relocWord & 0xFFFFFF) >> 2);
+            uint32_t entry;
+
+            if (isHiLo) {
+                entry = (((uint32_t)delta << 1) | (((relocs[i].relocWord >> 0x18) & 0x3F) == R_MIPS_LO16)) & 0xFFFF;
+            } else {
+                entry = delta;
+            }
+            fprintf(outputFile, ".half 0x%04X", entry);
+            Fado_PrintCompactComment(outputFile, &relocs[i], symtabs, fileInfos);
+        }
+
+        halfCount += 3 + (runEnd - runStart - 1);
+        (*numRunsOut)++;
+        runStart = runEnd;
+    }
+
+    return halfCount;
+}
+
+/**
+ * Writes the compact .ovl section: the usual section sizes, the number of runs, then for each section its R_MIPS_32,
+ * R_MIPS_26 and HI16/LO16 runs. Relocs of other types are not applied by Overlay_Relocate and are left out.
+ */
+static void Fado_WriteCompactRelocs(FILE* outputFile, vc_vector** relocList, FairySym** symtabs,
+                                    FairyFileInfo* fileInfos, const char* ovlName) {
+    static const uint32_t groupTypes[] = { R_MIPS_32, R_MIPS_26, R_MIPS_HI16 };
+    FairySection section;
+    uint32_t numRuns = 0;
+    uint32_t halfCount = 0;
+    size_t maxCount = 0;
+    FadoRelocInfo* group;
+    uint32_t totalSize;
+
+    for (section = FAIRY_SECTION_TEXT; section < FAIRY_SECTION_OTHER; section++) {
+        if (vc_vector_count(relocList[section]) > maxCount) {
+            maxCount = vc_vector_count(relocList[section]);
+        }
+    }
+    group = malloc(((maxCount != 0) ? maxCount : 1) * sizeof(FadoRelocInfo));
+    assert(group != NULL);
+
+    fprintf(outputFile, ".section .ovl\n");
+    fprintf(outputFile, "# %sOverlayInfo\n", ovlName);
+    fprintf(outputFile, ".L%sOverlayInfo:\n", ovlName);
+    fprintf(outputFile, ".word _%sSegmentTextSize\n", ovlName);
+    fprintf(outputFile, ".word _%sSegmentDataSize\n", ovlName);
+    fprintf(outputFile, ".word _%sSegmentRoDataSize\n", ovlName);
+    fprintf(outputFile, ".word _%sSegmentBssSize\n", ovlName);
+    fprintf(outputFile, "\n.word %sRelocRunCount\n", ovlName);
+
+    for (section = FAIRY_SECTION_TEXT; section < FAIRY_SECTION_OTHER; section++) {
+        size_t g;
+
+        for (g = 0; g < ARRAY_COUNTU(groupTypes); g++) {
+            bool isHiLo = groupTypes[g] == R_MIPS_HI16;
+            size_t groupCount = 0;
+            FadoRelocInfo* currentReloc;
+
+            VC_FOREACH(currentReloc, relocList[section]) {
+                uint32_t type = (currentReloc->relocWord >> 0x18) & 0x3F;
+
+                if (isHiLo ? ((type == R_MIPS_HI16) || (type == R_MIPS_LO16)) : (type == groupTypes[g])) {
+                    group[groupCount++] = *currentReloc;
+                }
+            }
+            if (groupCount == 0) {
+                continue;
+            }
+
+            if (!isHiLo) {
+                qsort(group, groupCount, sizeof(FadoRelocInfo), Fado_CompareRelocOffsets);
+            }
+
+            fprintf(outputFile, "\n# %s %s RELOCS\n", Fairy_StringFromDefine(relSectionNames, section),
+                    isHiLo ? "R_MIPS_HI16/LO16" : Fairy_StringFromDefine(relTypeNames, groupTypes[g]));
+            halfCount += Fado_WriteCompactRuns(outputFile, group, groupCount, isHiLo, symtabs, fileInfos, &numRuns);
+        }
+    }
+
+    fprintf(outputFile, "\n.set %sRelocRunCount, %u\n", ovlName, numRuns);
+
+    /* Pad so that the section, including the offset word, is a multiple of 0x10 bytes. The header is the four section
+     * sizes and the number of runs */
+    totalSize = 5 * 4 + 2 * halfCount;
+    for (; ((totalSize + 4) & 0xF) != 0; totalSize += 2) {
+        fprintf(outputFile, ".half 0\n");
+    }
+    fprintf(outputFile, "\n.word 0x%08X # %sOverlayInfoOffset\n", totalSize + 4, ovlName);
+
+    /* Overlay_Load finds the section from the offset word, have the assembler check it against the section written */
+    fprintf(outputFile, ".L%sOverlayInfoEnd:\n", ovlName);
+    fprintf(outputFile, ".if (.L%sOverlayInfoEnd - .L%sOverlayInfo) != 0x%08X\n", ovlName, ovlName, totalSize + 4);
+    fprintf(outputFile, ".error \"%s: compact relocation section size does not match its OverlayInfoOffset\"\n",
+            ovlName);
+    fprintf(outputFile, ".endif\n");
+
+    free(group);
+}
+
 /**
  * Find all the necessary relocations to retain (those defined in any input file), and print them in the appropriate
- * format.
+ * format, the compact one if compact is set.
  */
-void Fado_Relocs(FILE* outputFile, int inputFilesCount, FILE** inputFiles, const char* ovlName) {
+void Fado_Relocs(FILE* outputFile, int inputFilesCount, FILE** inputFiles, const char* ovlName, bool compact) {
     /* General information structs */
     FairyFileInfo* fileInfos = malloc(inputFilesCount * sizeof(FairyFileInfo));
 
     /* Symbol tables for each file */
     FairySym** symtabs = malloc(inputFilesCount * sizeof(FairySym*));
 
-    /* Lists of names of symbols defined in files of the overlay */
-    vc_vector** stringVectors = malloc(inputFilesCount * sizeof(vc_vector*));
+    /* Names of symbols defined in files of the overlay */
+    FadoSymbolTable symbolTable;
 
     /* The relocs in the format we will print */
     vc_vector* relocList[FAIRY_SECTION_OTHER]; /* Maximum number of reloc sections */
@@ -214,7 +411,7 @@ void Fado_Relocs(FILE* outputFile, int inputFilesCount, FILE** inputFiles, const
         symtabs[currentFile] = fileInfos[currentFile].symtabInfo.sectionData;
     }
 
-    Fado_ConstructStringVectors(stringVectors, fileInfos, inputFilesCount);
+    Fado_ConstructSymbolTable(&symbolTable, fileInfos, inputFilesCount);
     FAIRY_INFO_PRINTF("%s", "symtabs set\n");
 
     /* Construct relocList of all relevant relocs */
@@ -232,7 +429,7 @@ void Fado_Relocs(FILE* outputFile, int inputFilesCount, FILE** inputFiles, const
                     if ((symtabs[currentFile][currentReloc.symbolIndex].st_shndx != STN_UNDEF) ||
                         Fado_FindSymbolNameInOtherFiles(
                             &fileInfos[currentFile].strtab[symtabs[currentFile][currentReloc.symbolIndex].st_name],
-                            currentFile, stringVectors, inputFilesCount)) {
+                            currentFile, &symbolTable)) {
 
                         currentReloc.relocWord += sectionOffset[section];
                         FAIRY_DEBUG_PRINTF("current section offset: %d\n", sectionOffset[section]);
@@ -249,7 +446,9 @@ void Fado_Relocs(FILE* outputFile, int inputFilesCount, FILE** inputFiles, const
         }
     }
 
-    {
+    if (compact) {
+        Fado_WriteCompactRelocs(outputFile, relocList, symtabs, fileInfos, ovlName);
+    } else {
         /* Write header */
         fprintf(outputFile, ".section .ovl\n");
         fprintf(outputFile, "# %sOverlayInfo\n", ovlName);
@@ -300,8 +499,8 @@ void Fado_Relocs(FILE* outputFile, int inputFilesCount, FILE** inputFiles, const
         FAIRY_INFO_PRINTF("Freed relocList[%d]\n", section);
     }
 
-    Fado_DestroyStringVectors(stringVectors, inputFilesCount);
-    FAIRY_INFO_PRINTF("%s", "Freed string vectors\n");
+    Fado_DestroySymbolTable(&symbolTable);
+    FAIRY_INFO_PRINTF("%s", "Freed symbol table\n");
     free(symtabs);
     FAIRY_INFO_PRINTF("%s", "Freed symtabs\n");
     free(fileInfos);
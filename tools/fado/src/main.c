@@ -1,10 +1,16 @@
 /* Copyright (C) 2021 Elliptic Ellipsis */
 /* SPDX-License-Identifier: AGPL-3.0-only */
+/* For sysconf and optreset */
+#define _DEFAULT_SOURCE
+
+#include <ctype.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
+#include <unistd.h>
 
 #include "macros.h"
 #include "fairy/fairy.h"
@@ -55,8 +61,10 @@ char* GetOverlayNameFromFilename(const char* src) {
     return ret;
 }
 
-#define OPTSTR "M:n:o:v:ahV"
-#define USAGE_STRING "Usage: %s [-hV] [-n name] [-o output_file] [-v level] input_files ...\n"
+#define OPTSTR "M:n:o:v:cab:j:hV"
+#define USAGE_STRING                                                                    \
+    "Usage: %s [-chV] [-n name] [-o output_file] [-v level] input_files ...\n"          \
+    "       %s [-v level] -b manifest [-j jobs]\n"
 
 #define HELP_PROLOGUE                                            \
     "Fado (Fairy-Assisted relocations for Decompiled Overlays\n" \
@@ -74,6 +82,10 @@ static const OptInfo optInfo[] = {
     { { "name", required_argument, NULL, 'n' }, "NAME", "Use NAME as the overlay name. Will use the deepest folder name in the input file's path if not specified" },
     { { "output-file", required_argument, NULL, 'o' }, "FILE", "Output to FILE. Will use stdout if none is specified" },
     { { "verbosity", required_argument, NULL, 'v' }, "N", "Verbosity level, one of 0 (None, default), 1 (Info), 2 (Debug)" },
+    { { "compact", no_argument, NULL, 'c' }, NULL, "Write the relocations in the compact format, as runs of 16-bit distances grouped by section and type. It needs an Overlay_Relocate built with COMPACT_RELOCS, and does not match the original game" },
+
+    { { "batch", required_argument, NULL, 'b' }, "FILE", "Run the jobs listed in FILE, one per line. Each line holds the options and input files of a single invocation, which must give an output file. Empty lines and lines starting with # are skipped. Output files are only written when their contents change" },
+    { { "jobs", required_argument, NULL, 'j' }, "N", "Run the jobs of a batch on N threads, by default as many as there are CPUs" },
 
     { { "alignment", no_argument, NULL, 'a' }, NULL, "Experimental. Use the alignment declared by each section in the elf file instead of padding to 0x10 bytes. NOTE: It has not been properly tested because the tools we currently have are not compatible non 0x10 alignment" },
 
@@ -96,22 +108,45 @@ void ConstructLongOpts(void) {
     }
 }
 
-int main(int argc, char** argv) {
-    int opt;
+/* The arguments of a single invocation */
+typedef struct {
+    char* ovlName; /* NULL to take it from the first input file's path */
+    char* outputFileName; /* NULL for stdout */
+    char* dependencyFileName;
+    bool compactRelocs;
     int inputFilesCount;
-    FILE** inputFiles;
-    FILE* outputFile = stdout;
-    char* outputFileName;
-    char* dependencyFileName = NULL;
-    char* ovlName = NULL;
+    char** inputFileNames;
+    char** argv; /* The job's arguments for batch jobs, to be freed */
+} FadoJob;
 
-    ConstructLongOpts();
+/* The batch options, only accepted on the command line */
+typedef struct {
+    char* manifestFileName;
+    long numThreads;
+} FadoBatchArgs;
 
-    if (argc < 2) {
-        printf(USAGE_STRING, argv[0]);
-        fprintf(stderr, "No input file specified\n");
-        return EXIT_FAILURE;
-    }
+#define PARSE_ARGS_OK (-1)
+
+/**
+ * Parses the arguments of one invocation into job. batchArgs receives the batch options, if it is NULL they are
+ * rejected. Returns PARSE_ARGS_OK, or the exit code if the process should end.
+ */
+int ParseArgs(int argc, char** argv, FadoJob* job, FadoBatchArgs* batchArgs) {
+    int opt;
+
+    job->ovlName = NULL;
+    job->outputFileName = NULL;
+    job->dependencyFileName = NULL;
+    job->compactRelocs = false;
+    job->argv = NULL;
+
+    /* Reset getopt, the manifest's lines are parsed in turn after the command line */
+#ifdef __GLIBC__
+    optind = 0;
+#else
+    optind = 1;
+    optreset = 1;
+#endif
 
     while (true) {
         int optionIndex = 0;
@@ -122,20 +157,15 @@ int main(int argc, char** argv) {
 
         switch (opt) {
             case 'M':
-                dependencyFileName = optarg;
+                job->dependencyFileName = optarg;
                 break;
 
             case 'n':
-                ovlName = optarg;
+                job->ovlName = optarg;
                 break;
 
             case 'o':
-                outputFileName = optarg;
-                outputFile = fopen(optarg, "wb");
-                if (outputFile == NULL) {
-                    fprintf(stderr, "error: unable to open output file '%s' for writing\n", optarg);
-                    return EXIT_FAILURE;
-                }
+                job->outputFileName = optarg;
                 break;
 
             case 'v':
@@ -145,6 +175,10 @@ int main(int argc, char** argv) {
                 }
                 break;
 
+            case 'c':
+                job->compactRelocs = true;
+                break;
+
             case 'a':
 #ifndef EXPERIMENTAL
                 goto not_experimental_err;
@@ -152,8 +186,27 @@ int main(int argc, char** argv) {
                 gUseElfAlignment = true;
                 break;
 
+            case 'b':
+            case 'j':
+                if (batchArgs == NULL) {
+                    fprintf(stderr, "error: option '-%c' is not allowed in a batch manifest\n", opt);
+                    return EXIT_FAILURE;
+                }
+                if (opt == 'b') {
+                    batchArgs->manifestFileName = optarg;
+                } else {
+                    char* end;
+
+                    batchArgs->numThreads = strtol(optarg, &end, 10);
+                    if ((*end != '\0') || (batchArgs->numThreads < 1)) {
+                        fprintf(stderr, "error: job count '%s' should be a positive decimal integer\n", optarg);
+                        return EXIT_FAILURE;
+                    }
+                }
+                break;
+
             case 'h':
-                printf(USAGE_STRING, argv[0]);
+                printf(USAGE_STRING, argv[0], argv[0]);
                 Help_PrintHelp(HELP_PROLOGUE, posArgCount, posArgInfo, optCount, optInfo, HELP_EPILOGUE);
                 return EXIT_FAILURE;
 
@@ -167,81 +220,389 @@ int main(int argc, char** argv) {
         }
     }
 
-    FAIRY_INFO_PRINTF("%s", "Options processed\n");
+    job->inputFilesCount = argc - optind;
+    job->inputFileNames = &argv[optind];
+    return PARSE_ARGS_OK;
+
+    goto not_experimental_err; // silences a warning
+not_experimental_err:
+    fprintf(
+        stderr,
+        "Experimental option '-%c' passed in a non-EXPERIMENTAL build. Rebuild with 'make EXPERIMENTAL=1' to enable.\n",
+        opt);
+    return EXIT_FAILURE;
+}
 
-    {
-        int i;
+/* Output files are written to a temporary file first, which only replaces them if the contents differ */
 
-        inputFilesCount = argc - optind;
-        if (inputFilesCount == 0) {
-            fprintf(stderr, "No input files specified. Exiting.\n");
-            return EXIT_FAILURE;
-        }
+char* ReadWholeFile(const char* fileName, size_t* sizeOut) {
+    FILE* file = fopen(fileName, "rb");
+    char* data;
+    long size;
 
-        inputFiles = malloc(inputFilesCount * sizeof(FILE*));
-        for (i = 0; i < inputFilesCount; i++) {
-            FAIRY_INFO_PRINTF("Using input file %s\n", argv[optind + i]);
-            inputFiles[i] = fopen(argv[optind + i], "rb");
-            if (inputFiles[i] == NULL) {
-                fprintf(stderr, "error: unable to open input file '%s' for reading\n", argv[optind + i]);
-                return EXIT_FAILURE;
+    if (file == NULL) {
+        return NULL;
+    }
+    if ((fseek(file, 0, SEEK_END) != 0) || ((size = ftell(file)) < 0) || (fseek(file, 0, SEEK_SET) != 0)) {
+        fclose(file);
+        return NULL;
+    }
+    data = malloc((size != 0) ? size : 1);
+    if ((data != NULL) && (fread(data, sizeof(char), size, file) != (size_t)size)) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+
+    *sizeOut = size;
+    return data;
+}
+
+FILE* OpenOutputFile(const char* fileName, char** tempFileNameOut) {
+    char* tempFileName = malloc(strlen(fileName) + sizeof(".tmp"));
+    FILE* file;
+
+    strcpy(tempFileName, fileName);
+    strcat(tempFileName, ".tmp");
+
+    file = fopen(tempFileName, "wb");
+    if (file == NULL) {
+        free(tempFileName);
+        return NULL;
+    }
+    *tempFileNameOut = tempFileName;
+    return file;
+}
+
+/* Closes a file from OpenOutputFile and puts it in place of fileName, unless that file already holds the same bytes */
+bool CloseOutputFile(FILE* file, const char* fileName, char* tempFileName) {
+    bool success = (fclose(file) == 0);
+    size_t newSize;
+    size_t oldSize;
+    char* newData;
+    char* oldData;
+
+    if (!success) {
+        remove(tempFileName);
+        free(tempFileName);
+        return false;
+    }
+
+    newData = ReadWholeFile(tempFileName, &newSize);
+    oldData = ReadWholeFile(fileName, &oldSize);
+
+    if ((newData != NULL) && (oldData != NULL) && (newSize == oldSize) && (memcmp(newData, oldData, newSize) == 0)) {
+        FAIRY_INFO_PRINTF("%s is unchanged\n", fileName);
+        remove(tempFileName);
+    } else {
+#if defined _WIN32 && !defined __CYGWIN__
+        /* rename does not replace existing files here */
+        remove(fileName);
+#endif
+        success = (rename(tempFileName, fileName) == 0);
+    }
+
+    free(newData);
+    free(oldData);
+    free(tempFileName);
+    return success;
+}
+
+/* Runs one invocation. Returns the exit code. */
+int RunJob(const FadoJob* job) {
+    int inputFilesCount = job->inputFilesCount;
+    FILE** inputFiles;
+    FILE* outputFile = stdout;
+    char* tempFileName = NULL;
+    int i;
+
+    if (inputFilesCount == 0) {
+        fprintf(stderr, "No input files specified. Exiting.\n");
+        return EXIT_FAILURE;
+    }
+
+    inputFiles = malloc(inputFilesCount * sizeof(FILE*));
+    for (i = 0; i < inputFilesCount; i++) {
+        FAIRY_INFO_PRINTF("Using input file %s\n", job->inputFileNames[i]);
+        inputFiles[i] = fopen(job->inputFileNames[i], "rb");
+        if (inputFiles[i] == NULL) {
+            fprintf(stderr, "error: unable to open input file '%s' for reading\n", job->inputFileNames[i]);
+            while (i-- > 0) {
+                fclose(inputFiles[i]);
             }
+            free(inputFiles);
+            return EXIT_FAILURE;
         }
+    }
 
-        FAIRY_INFO_PRINTF("Found %d input file%s\n", inputFilesCount, (inputFilesCount == 1 ? "" : "s"));
+    FAIRY_INFO_PRINTF("Found %d input file%s\n", inputFilesCount, (inputFilesCount == 1 ? "" : "s"));
 
-        if (ovlName == NULL) { // If a name has not been set using an arg
-            ovlName = GetOverlayNameFromFilename(argv[optind]);
-            Fado_Relocs(outputFile, inputFilesCount, inputFiles, ovlName);
-            free(ovlName);
-        } else {
-            Fado_Relocs(outputFile, inputFilesCount, inputFiles, ovlName);
+    if (job->outputFileName != NULL) {
+        outputFile = OpenOutputFile(job->outputFileName, &tempFileName);
+        if (outputFile == NULL) {
+            fprintf(stderr, "error: unable to open output file '%s' for writing\n", job->outputFileName);
+            for (i = 0; i < inputFilesCount; i++) {
+                fclose(inputFiles[i]);
+            }
+            free(inputFiles);
+            return EXIT_FAILURE;
         }
+    }
 
-        for (i = 0; i < inputFilesCount; i++) {
-            fclose(inputFiles[i]);
-        }
-        free(inputFiles);
-        if (outputFile != stdout) {
-            fclose(outputFile);
+    if (job->ovlName == NULL) { // If a name has not been set using an arg
+        char* ovlName = GetOverlayNameFromFilename(job->inputFileNames[0]);
+        Fado_Relocs(outputFile, inputFilesCount, inputFiles, ovlName, job->compactRelocs);
+        free(ovlName);
+    } else {
+        Fado_Relocs(outputFile, inputFilesCount, inputFiles, job->ovlName, job->compactRelocs);
+    }
+
+    for (i = 0; i < inputFilesCount; i++) {
+        fclose(inputFiles[i]);
+    }
+    free(inputFiles);
+    if (outputFile != stdout) {
+        if (!CloseOutputFile(outputFile, job->outputFileName, tempFileName)) {
+            fprintf(stderr, "error: unable to write output file '%s'\n", job->outputFileName);
+            return EXIT_FAILURE;
         }
     }
 
-    if (dependencyFileName != NULL) {
-        int fileNameLength = strlen(outputFileName);
-        char* objectFile = malloc((strlen(outputFileName) + 1) * sizeof(char));
-        vc_vector* inputFilesVector = vc_vector_create(inputFilesCount, sizeof(char*), NULL);
+    if (job->dependencyFileName != NULL) {
+        int fileNameLength;
+        char* objectFile;
+        vc_vector* inputFilesVector;
         char* extensionStart;
-        FILE* dependencyFile = fopen(dependencyFileName, "w");
+        FILE* dependencyFile;
 
+        if (job->outputFileName == NULL) {
+            fprintf(stderr, "error: a dependency file needs an output file\n");
+            return EXIT_FAILURE;
+        }
+
+        dependencyFile = OpenOutputFile(job->dependencyFileName, &tempFileName);
         if (dependencyFile == NULL) {
-            fprintf(stderr, "error: unable to open dependency file '%s' for writing\n", dependencyFileName);
+            fprintf(stderr, "error: unable to open dependency file '%s' for writing\n", job->dependencyFileName);
             return EXIT_FAILURE;
         }
 
-        strcpy(objectFile, outputFileName);
+        fileNameLength = strlen(job->outputFileName);
+        objectFile = malloc((fileNameLength + 1 + sizeof(".o")) * sizeof(char));
+        strcpy(objectFile, job->outputFileName);
         extensionStart = strrchr(objectFile, '.');
         if (extensionStart == objectFile + fileNameLength) {
             fprintf(stderr, "error: file name should not end in a '.'\n");
+            fclose(dependencyFile);
+            remove(tempFileName);
+            free(tempFileName);
+            free(objectFile);
             return EXIT_FAILURE;
         }
+        if (extensionStart == NULL) {
+            extensionStart = objectFile + fileNameLength;
+        }
         strcpy(extensionStart, ".o");
-        vc_vector_append(inputFilesVector, &argv[optind], inputFilesCount);
+
+        inputFilesVector = vc_vector_create(inputFilesCount, sizeof(char*), NULL);
+        vc_vector_append(inputFilesVector, job->inputFileNames, inputFilesCount);
 
         Mido_WriteDependencyFile(dependencyFile, objectFile, inputFilesVector);
 
         free(objectFile);
         vc_vector_release(inputFilesVector);
-        fclose(dependencyFile);
+        if (!CloseOutputFile(dependencyFile, job->dependencyFileName, tempFileName)) {
+            fprintf(stderr, "error: unable to write dependency file '%s'\n", job->dependencyFileName);
+            return EXIT_FAILURE;
+        }
     }
 
     return EXIT_SUCCESS;
+}
 
-    goto not_experimental_err; // silences a warning
-not_experimental_err:
-    fprintf(
-        stderr,
-        "Experimental option '-%c' passed in a non-EXPERIMENTAL build. Rebuild with 'make EXPERIMENTAL=1' to enable.\n",
-        opt);
-    return EXIT_FAILURE;
+/* Batch mode */
+
+typedef struct {
+    FadoJob* jobs;
+    size_t jobsCount;
+    size_t nextJob;
+    int failed;
+} FadoBatchState;
+
+/**
+ * Reads the manifest into jobs, each line is split at whitespace into the arguments of one invocation. The jobs point
+ * into the manifest's contents, which are returned in manifestOut.
+ */
+FadoJob* ReadManifest(const char* progName, const char* manifestFileName, size_t* jobsCountOut, char** manifestOut) {
+    size_t manifestSize;
+    char* manifest = ReadWholeFile(manifestFileName, &manifestSize);
+    size_t jobsCapacity = 64;
+    size_t jobsCount = 0;
+    FadoJob* jobs;
+    char* line;
+
+    if (manifest == NULL) {
+        fprintf(stderr, "error: unable to read manifest '%s'\n", manifestFileName);
+        return NULL;
+    }
+    manifest = realloc(manifest, manifestSize + 1);
+    manifest[manifestSize] = '\0';
+    jobs = malloc(jobsCapacity * sizeof(FadoJob));
+
+    for (line = manifest; line != NULL; ) {
+        char* lineEnd = strchr(line, '\n');
+        size_t argsCapacity = 8;
+        int argc = 0;
+        char** argv = malloc(argsCapacity * sizeof(char*));
+        char* arg = line;
+
+        if (lineEnd != NULL) {
+            *lineEnd++ = '\0';
+        }
+
+        argv[argc++] = (char*)progName;
+        while (true) {
+            while (isspace((unsigned char)*arg)) {
+                arg++;
+            }
+            if ((*arg == '\0') || ((argc == 1) && (*arg == '#'))) {
+                break;
+            }
+            /* One more argument for the NULL at the end of argv */
+            if ((size_t)argc + 1 == argsCapacity) {
+                argsCapacity *= 2;
+                argv = realloc(argv, argsCapacity * sizeof(char*));
+            }
+            argv[argc++] = arg;
+            while ((*arg != '\0') && !isspace((unsigned char)*arg)) {
+                arg++;
+            }
+            if (*arg != '\0') {
+                *arg++ = '\0';
+            }
+        }
+        argv[argc] = NULL;
+
+        if (argc > 1) {
+            if (jobsCount == jobsCapacity) {
+                jobsCapacity *= 2;
+                jobs = realloc(jobs, jobsCapacity * sizeof(FadoJob));
+            }
+            if (ParseArgs(argc, argv, &jobs[jobsCount], NULL) != PARSE_ARGS_OK) {
+                fprintf(stderr, "error: in manifest '%s', job %zu\n", manifestFileName, jobsCount + 1);
+                return NULL;
+            }
+            if (jobs[jobsCount].outputFileName == NULL) {
+                fprintf(stderr, "error: in manifest '%s', job %zu has no output file\n", manifestFileName,
+                        jobsCount + 1);
+                return NULL;
+            }
+            /* argv is kept for the input file names */
+            jobs[jobsCount].argv = argv;
+            jobsCount++;
+        } else {
+            free(argv);
+        }
+
+        line = lineEnd;
+    }
+
+    *jobsCountOut = jobsCount;
+    *manifestOut = manifest;
+    return jobs;
+}
+
+void* BatchWorker(void* arg) {
+    FadoBatchState* state = arg;
+
+    while (true) {
+        size_t job = __atomic_fetch_add(&state->nextJob, 1, __ATOMIC_RELAXED);
+
+        if (job >= state->jobsCount) {
+            break;
+        }
+        if (RunJob(&state->jobs[job]) != EXIT_SUCCESS) {
+            __atomic_store_n(&state->failed, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+/* Runs every job of the manifest, on a pool of numThreads threads. Returns EXIT_FAILURE if any of them failed. */
+int RunBatch(const char* progName, const FadoBatchArgs* batchArgs) {
+    FadoBatchState state = { 0 };
+    long numThreads = batchArgs->numThreads;
+    pthread_t* threads;
+    char* manifest;
+    long i;
+
+    state.jobs = ReadManifest(progName, batchArgs->manifestFileName, &state.jobsCount, &manifest);
+    if (state.jobs == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    if (numThreads < 1) {
+        numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if ((size_t)numThreads > state.jobsCount) {
+        numThreads = state.jobsCount;
+    }
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    FAIRY_INFO_PRINTF("Running %zu jobs on %ld threads\n", state.jobsCount, numThreads);
+
+    /* The calling thread is one of the workers */
+    threads = malloc((numThreads - 1) * sizeof(pthread_t) + 1);
+    for (i = 0; i < numThreads - 1; i++) {
+        if (pthread_create(&threads[i], NULL, BatchWorker, &state) != 0) {
+            fprintf(stderr, "error: unable to start batch thread %ld\n", i);
+            numThreads = i + 1;
+            break;
+        }
+    }
+    BatchWorker(&state);
+    for (i = 0; i < numThreads - 1; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    for (i = 0; (size_t)i < state.jobsCount; i++) {
+        free(state.jobs[i].argv);
+    }
+    free(state.jobs);
+    free(manifest);
+
+    return state.failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv) {
+    FadoJob job;
+    FadoBatchArgs batchArgs = { NULL, 0 };
+    int status;
+
+    ConstructLongOpts();
+
+    if (argc < 2) {
+        printf(USAGE_STRING, argv[0], argv[0]);
+        fprintf(stderr, "No input file specified\n");
+        return EXIT_FAILURE;
+    }
+
+    status = ParseArgs(argc, argv, &job, &batchArgs);
+    if (status != PARSE_ARGS_OK) {
+        return status;
+    }
+
+    FAIRY_INFO_PRINTF("%s", "Options processed\n");
+
+    if (batchArgs.manifestFileName != NULL) {
+        if ((job.inputFilesCount != 0) || (job.outputFileName != NULL) || (job.dependencyFileName != NULL) ||
+            (job.ovlName != NULL) || job.compactRelocs) {
+            fprintf(stderr, "error: the jobs of a batch are given in its manifest only\n");
+            return EXIT_FAILURE;
+        }
+        return RunBatch(argv[0], &batchArgs);
+    }
+
+    return RunJob(&job);
 }
@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText: © 2024 ZeldaRET
+# SPDX-License-Identifier: CC0-1.0
+
+"""
+Builds the overlays the TI-Nspire port pages in from its asset pack instead of
+linking them into the executable, see src/nspire/platform/overlay_nsp.c and
+OVERLAY_PAGING in Makefile.nsp. It runs twice per overlay, as fado does for the
+N64 build:
+
+    mknspovl.py reloc build.nsp/ovl/ovl_En_Test_partial.o build.nsp/ovl/ovl_En_Test_reloc.s
+
+writes the relocation section of the overlay's objects, linked together with
+ld -r, in the layout Overlay_Relocate reads. It is assembled and linked in
+after the overlay's rodata. Then
+
+    mknspovl.py pack build.nsp/ovl/ovl_En_Test.elf build.nsp/mm-nsp.elf build.nsp/ovl/ovl_En_Test.nsp
+
+turns the linked overlay into a pack fragment for tools/mknsppack.py --overlays,
+named after the ROM file it stands in for. Besides the overlay as the N64 lays
+one out, the fragment lists the words that point into the executable, which the
+port moves to where Ndless loaded it.
+
+ARM's R_ARM_ABS32 has the number of R_MIPS_32, so the relocation words are the
+ones fado writes. The other relocations an ARM overlay has are relative to the
+place they are applied at and need nothing when the overlay moves.
+"""
+
+from __future__ import annotations
+
+import argparse
+from pathlib import Path
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+
+PACK_VERSION = 1
+PACK_OVERLAY = 5
+HEADER = struct.Struct("<4sIII")
+ENTRY = struct.Struct("<IIIIIBBBBHH")
+# struct NspPackOverlay in src/nspire/nsp_pack.h
+OVERLAY = struct.Struct("<IIIIII")
+
+SECTIONS = {".text": 1, ".data": 2, ".rodata": 3}  # RelocSectionId
+SECTION_ALIGN = 8  # the alignment overlay_nsp.ld gives every section
+
+R_ARM_ABS32 = 2
+# relative to where they are applied, the same wherever the overlay is loaded
+R_ARM_RELATIVE_TYPES = {
+    1,  # R_ARM_PC24
+    3,  # R_ARM_REL32
+    28,  # R_ARM_CALL
+    29,  # R_ARM_JUMP24
+    40,  # R_ARM_V4BX
+    42,  # R_ARM_PREL31
+}
+
+ANCHOR_SYMBOL = "nsp_overlay_anchor"
+
+
+def align(n: int, a: int) -> int:
+    return (n + a - 1) & ~(a - 1)
+
+
+def section_size(elf: ELFFile, name: str) -> int:
+    section = elf.get_section_by_name(name)
+    return section["sh_size"] if section is not None else 0
+
+
+def iter_relocs(elf: ELFFile):
+    """Yields the section id, offset, type and symbol of every relocation in text, data and rodata"""
+    symtab = elf.get_section_by_name(".symtab")
+    for name, section_id in SECTIONS.items():
+        rel = elf.get_section_by_name(".rel" + name)
+        if rel is None:
+            continue
+        for reloc in rel.iter_relocations():
+            symbol = symtab.get_symbol(reloc.entry["r_info_sym"])
+            yield section_id, reloc.entry["r_offset"], reloc.entry["r_info_type"], symbol
+
+
+def fail(path: Path, message: str):
+    print(f"Error: {path}: {message}", file=sys.stderr)
+    exit(1)
+
+
+def write_reloc(obj_path: Path, out_path: Path):
+    with obj_path.open("rb") as f:
+        elf = ELFFile(f)
+        relocs = []
+        for section_id, offset, reloc_type, symbol in iter_relocs(elf):
+            if symbol["st_shndx"] == "SHN_UNDEF":
+                # in the executable, these go in the list after the overlay instead
+                continue
+            if reloc_type == R_ARM_ABS32:
+                relocs.append((section_id << 30) | (R_ARM_ABS32 << 24) | offset)
+            elif reloc_type not in R_ARM_RELATIVE_TYPES:
+                fail(obj_path, f"relocation type {reloc_type} at 0x{offset:X} can't be moved at runtime")
+        sizes = [align(section_size(elf, name), SECTION_ALIGN) for name in SECTIONS]
+        bss_size = section_size(elf, ".bss")
+
+    words = sizes + [bss_size, len(relocs)] + relocs
+    # the last word is the size of the section, from the end of the file back to its start, which
+    # is padded to 16 bytes like fado's
+    while (len(words) + 1) % 4 != 0:
+        words.append(0)
+    words.append((len(words) + 1) * 4)
+
+    lines = [
+        f"# Relocation section of {obj_path.stem}, written by tools/mknspovl.py",
+        '.section .ovl, "a"',
+        ".balign 4",
+    ]
+    lines += [f".word 0x{w:08X}" for w in words]
+    out_path.write_text("\n".join(lines) + "\n")
+
+
+def write_pack(elf_path: Path, exe_path: Path, out_path: Path):
+    with exe_path.open("rb") as f:
+        exe = ELFFile(f)
+        anchor = exe.get_section_by_name(".symtab").get_symbol_by_name(ANCHOR_SYMBOL)
+        if not anchor:
+            fail(exe_path, f"no {ANCHOR_SYMBOL}, the executable is built without OVERLAY_PAGING")
+        exe_anchor = anchor[0]["st_value"]
+
+    with elf_path.open("rb") as f:
+        elf = ELFFile(f)
+        text = elf.get_section_by_name(".text")
+        ovl = elf.get_section_by_name(".ovl")
+        if text is None or ovl is None:
+            fail(elf_path, "not linked with overlay_nsp.ld and its relocation section")
+        vram = text["sh_addr"]
+        image_end = ovl["sh_addr"] + ovl["sh_size"]
+
+        image = bytearray(image_end - vram)
+        for name in list(SECTIONS) + [".ovl"]:
+            section = elf.get_section_by_name(name)
+            if section is None or section["sh_type"] == "SHT_NOBITS":
+                continue
+            start = section["sh_addr"] - vram
+            image[start : start + section["sh_size"]] = section.data()
+        bss = elf.get_section_by_name(".bss")
+        vram_end = bss["sh_addr"] + bss["sh_size"] if bss is not None and bss["sh_size"] else image_end
+
+        # the relocation section has to describe the layout the overlay was linked with
+        ovl_data = ovl.data()
+        text_size, data_size, rodata_size, bss_size, num_relocs = struct.unpack_from("<5I", ovl_data)
+        starts = [vram, vram + text_size, vram + text_size + data_size]
+        for (name, _), start in zip(SECTIONS.items(), starts):
+            section = elf.get_section_by_name(name)
+            if section is not None and section["sh_size"] and section["sh_addr"] != start:
+                fail(elf_path, f"{name} is at 0x{section['sh_addr']:08X} instead of 0x{start:08X}")
+        if ovl["sh_addr"] != starts[2] + rodata_size or (bss_size and bss["sh_addr"] != image_end):
+            fail(elf_path, "the relocation section or bss is not where Overlay_Load expects it")
+        linked_relocs = set(struct.unpack_from(f"<{num_relocs}I", ovl_data, 0x14))
+
+        relocs = set()
+        exe_relocs = []
+        for section_id, offset, reloc_type, symbol in iter_relocs(elf):
+            # the final link's offsets are addresses
+            section_offset = offset - starts[section_id - 1]
+            if symbol["st_shndx"] == "SHN_ABS":
+                if reloc_type != R_ARM_ABS32:
+                    fail(elf_path, f"{symbol.name} is in the executable and not reached through a "
+                                   "pointer, build the overlay with -mlong-calls")
+                exe_relocs.append(offset - vram)
+            elif reloc_type == R_ARM_ABS32:
+                relocs.add((section_id << 30) | (R_ARM_ABS32 << 24) | section_offset)
+        if relocs != linked_relocs:
+            fail(elf_path, "the relocation section doesn't match the overlay, something was linked in "
+                           "after it was written")
+
+        profile = 0
+        profile_symbols = elf.get_section_by_name(".symtab").get_symbol_by_name(
+            elf_path.stem.removeprefix("ovl_") + "_Profile"
+        )
+        if profile_symbols:
+            profile = profile_symbols[0]["st_value"]
+
+    payload = OVERLAY.pack(vram, vram_end, profile, len(image), exe_anchor, len(exe_relocs))
+    payload += image
+    payload += struct.pack(f"<{len(exe_relocs)}I", *exe_relocs)
+
+    out = bytearray(HEADER.size)
+    out += payload
+    out += bytes(align(len(out), 8) - len(out))
+    dir_offset = len(out)
+    out += ENTRY.pack(0, HEADER.size, len(payload), 0, 0, PACK_OVERLAY, 0, 0, 0, 0, 0)
+    HEADER.pack_into(out, 0, b"NSPF", PACK_VERSION, 1, dir_offset)
+    out_path.write_bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the overlays the Nspire port pages in.")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+
+    reloc = subparsers.add_parser("reloc", help="Write the relocation section of an overlay")
+    reloc.add_argument("object", type=Path, help="The overlay's objects, linked with ld -r")
+    reloc.add_argument("output", type=Path, help="Assembly file to write")
+
+    pack = subparsers.add_parser("pack", help="Write the pack fragment of a linked overlay")
+    pack.add_argument("elf", type=Path, help="The overlay, linked with its relocation section")
+    pack.add_argument("exe", type=Path, help="The executable it was linked against")
+    pack.add_argument("output", type=Path, help="Fragment to write")
+
+    args = parser.parse_args()
+
+    if args.command == "reloc":
+        write_reloc(args.object, args.output)
+    else:
+        write_pack(args.elf, args.exe, args.output)
+
+
+if __name__ == "__main__":
+    main()
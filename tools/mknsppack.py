@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText: © 2024 ZeldaRET
+# SPDX-License-Identifier: CC0-1.0
+
+"""
+Merges the pack fragments ZAPD's NSPIRE exporter set writes (see
+tools/ZAPD/ExporterTest/NspireExporter.h) into the asset pack the TI-Nspire port
+loads, which keys them by VROM address instead of file offset. The fragments
+come from extracting with the exporter set, e.g.
+
+    tools/ZAPD/ZAPD.out e -i assets/xml/objects/gameplay_keep.xml \\
+        -b extracted/n64-us/baserom -o extracted/n64-us/assets/objects/gameplay_keep/ \\
+        -osf extracted/n64-us/assets/objects/gameplay_keep/ -se NSPIRE \\
+        -rconf tools/ZAPDConfigs/MM/Config.xml
+
+The overlays the port pages in instead of linking them, see OVERLAY_PAGING in
+Makefile.nsp, come as fragments from tools/mknspovl.py and are merged from
+--overlays.
+"""
+
+from __future__ import annotations
+
+import argparse
+from pathlib import Path
+import struct
+import sys
+
+from buildtools import dmadata
+from version import version_config
+
+
+PACK_VERSION = 1
+PACK_OVERLAY = 5
+HEADER = struct.Struct("<4sIII")
+ENTRY = struct.Struct("<IIIIIBBBBHH")
+
+
+def align8(n: int) -> int:
+    return (n + 7) & ~7
+
+
+def read_fragment(path: Path) -> list[tuple[tuple, bytes]]:
+    data = path.read_bytes()
+    magic, version, count, dir_offset = HEADER.unpack_from(data)
+    if magic != b"NSPF" or version != PACK_VERSION:
+        print(f"Error: {path} is not a version {PACK_VERSION} pack fragment", file=sys.stderr)
+        exit(1)
+
+    result = []
+    for i in range(count):
+        entry = ENTRY.unpack_from(data, dir_offset + i * ENTRY.size)
+        offset, size = entry[1], entry[2]
+        result.append((entry, data[offset : offset + size]))
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Merge ZAPD's Nspire pack fragments into an asset pack."
+    )
+    parser.add_argument(
+        "rom", metavar="ROM", type=Path, help="Path to uncompressed ROM, for the dmadata"
+    )
+    parser.add_argument(
+        "fragments_dir",
+        type=Path,
+        help="Directory searched for the .nsp fragments, e.g. extracted/n64-us/assets",
+    )
+    parser.add_argument("output", type=Path, help="Path of the pack to write")
+    parser.add_argument(
+        "--overlays",
+        type=Path,
+        help="Directory searched for the overlay fragments, e.g. build.nsp/ovl",
+    )
+    parser.add_argument(
+        "-v",
+        "--version",
+        help="version to process",
+        default="n64-us",
+    )
+
+    args = parser.parse_args()
+
+    rom_data = memoryview(args.rom.read_bytes())
+
+    config = version_config.load_version_config(args.version)
+    dma_names = config.dmadata_segments.keys()
+    dma_entries = dmadata.read_dmadata(rom_data, config.dmadata_start)
+    if len(dma_names) != len(dma_entries):
+        print(
+            f"Error: expected {len(dma_names)} DMA entries but found {len(dma_entries)} in ROM",
+            file=sys.stderr,
+        )
+        exit(1)
+    vrom_of = {name: e.vrom_start for name, e in zip(dma_names, dma_entries)}
+    size_of = {name: e.vrom_end - e.vrom_start for name, e in zip(dma_names, dma_entries)}
+
+    entries = []
+    paths = sorted(args.fragments_dir.rglob("*.nsp"))
+    if args.overlays is not None:
+        paths += sorted(args.overlays.glob("*.nsp"))
+    for path in paths:
+        if path.stem not in vrom_of:
+            print(f"Warning: {path} isn't named after a ROM file, skipping it", file=sys.stderr)
+            continue
+        vrom = vrom_of[path.stem]
+        for entry, payload in read_fragment(path):
+            if entry[5] == PACK_OVERLAY:
+                # An overlay stands in for the whole ROM file, which mknspovl.py doesn't know the size of
+                entry = entry[:3] + (size_of[path.stem],) + entry[4:]
+            entries.append(((vrom + entry[0],) + entry[1:], payload))
+
+    # The port looks entries up by binary search
+    entries.sort(key=lambda e: e[0][0])
+
+    out = bytearray(HEADER.size)
+    directory = bytearray()
+    for entry, payload in entries:
+        out += bytes(align8(len(out)) - len(out))
+        directory += ENTRY.pack(entry[0], len(out), *entry[2:])
+        out += payload
+    out += bytes(align8(len(out)) - len(out))
+
+    HEADER.pack_into(out, 0, b"NSPK", PACK_VERSION, len(entries), len(out))
+    out += directory
+    args.output.write_bytes(out)
+
+    print(f"Wrote {len(entries)} entries to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText: © 2024 ZeldaRET
+# SPDX-License-Identifier: CC0-1.0
+
+"""
+Merges the resource archives ZAPD's ARCHIVE exporter set writes for every file
+(see tools/ZAPD/ExporterTest/ArchiveExporter.h) into one archive of the same
+layout, for a port to read with tools/zarchive/zarchive.c. The archives of the
+files come from extracting with the exporter set, e.g.
+
+    tools/ZAPD/ZAPD.out e -i assets/xml/objects/gameplay_keep.xml \\
+        -b extracted/n64-us/baserom -o extracted/n64-us/assets/objects/gameplay_keep/ \\
+        -osf extracted/n64-us/assets/objects/gameplay_keep/ -se ARCHIVE \\
+        -rconf tools/ZAPDConfigs/MM/Config.xml
+"""
+
+from __future__ import annotations
+
+import argparse
+from pathlib import Path
+import struct
+import sys
+
+
+ARCHIVE_VERSION = 1
+HEADER = struct.Struct("<4sIII")
+ENTRY = struct.Struct("<QIIIIII")
+
+
+def align(n: int, alignment: int) -> int:
+    return (n + alignment - 1) & ~(alignment - 1)
+
+
+def read_archive(path: Path) -> tuple[int, list[tuple[tuple, bytes]]]:
+    data = path.read_bytes()
+    magic, version, count, alignment = HEADER.unpack_from(data)
+    if magic != b"ZARC" or version != ARCHIVE_VERSION:
+        print(f"Error: {path} is not a version {ARCHIVE_VERSION} archive", file=sys.stderr)
+        exit(1)
+
+    result = []
+    for i in range(count):
+        entry = ENTRY.unpack_from(data, HEADER.size + i * ENTRY.size)
+        offset, size = entry[3], entry[4]
+        result.append((entry, data[offset : offset + size]))
+    return alignment, result
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Merge the resource archives of ZAPD's ARCHIVE exporter set into one."
+    )
+    parser.add_argument(
+        "archives_dir",
+        type=Path,
+        help="Directory searched for the .zar archives, e.g. extracted/n64-us/assets",
+    )
+    parser.add_argument("output", type=Path, help="Path of the archive to write")
+
+    args = parser.parse_args()
+
+    alignment = 0x10
+    entries = {}
+    for path in sorted(args.archives_dir.rglob("*.zar")):
+        if path.resolve() == args.output.resolve():
+            continue
+        file_alignment, file_entries = read_archive(path)
+        alignment = max(alignment, file_alignment)
+        for entry, payload in file_entries:
+            if entry[0] in entries:
+                print(
+                    f"Warning: {path} has a resource of the same name as another file, skipping it",
+                    file=sys.stderr,
+                )
+                continue
+            entries[entry[0]] = (entry, payload)
+
+    # The reader looks entries up by binary search
+    sorted_entries = [entries[h] for h in sorted(entries)]
+
+    out = bytearray(HEADER.size + len(sorted_entries) * ENTRY.size)
+    for i, (entry, payload) in enumerate(sorted_entries):
+        out += bytes(align(len(out), alignment) - len(out))
+        ENTRY.pack_into(
+            out,
+            HEADER.size + i * ENTRY.size,
+            entry[0],
+            entry[1],
+            entry[2],
+            len(out),
+            len(payload),
+            entry[5],
+            entry[6],
+        )
+        out += payload
+    out += bytes(align(len(out), alignment) - len(out))
+
+    HEADER.pack_into(out, 0, b"ZARC", ARCHIVE_VERSION, len(sorted_entries), alignment)
+    args.output.write_bytes(out)
+
+    print(f"Wrote {len(sorted_entries)} entries to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,5 +1,5 @@
 #!/usr/bin/env python3
-import argparse, csv, os, re, sys
+import argparse, csv, json, os, re, sys
 
 parser = argparse.ArgumentParser()
 
@@ -12,6 +12,13 @@ args = parser.parse_args()
 NON_MATCHING_PATTERN = r'#ifdef\s+NON_MATCHING.*?#pragma\s+GLOBAL_ASM\s*\(\s*"(.*?)"\s*\).*?#endif'
 NOT_ATTEMPTED_PATTERN = r'#pragma\s+GLOBAL_ASM\s*\(\s*"(.*?)"\s*\)'
 
+# The pieces of both patterns, to find the matches of both in one pass over a file
+SCAN_PATTERN = re.compile(r'(?P<ifdef>#ifdef\s+NON_MATCHING)|#pragma\s+GLOBAL_ASM\s*\(\s*"(?P<asm>.*?)"\s*\)|(?P<endif>#endif)', re.DOTALL)
+
+# Per-file results of the scan, reused while the file's mtime and size stay the same
+SCAN_CACHE_PATH = "build/n64-us/progress_cache.json"
+SCAN_CACHE_VERSION = 1
+
 # This is the format ZAPD uses to autogenerate variable names
 # It should not be used for properly documented variables
 AUTOGENERATED_ASSET_NAME = re.compile(r".+0[0-9A-Fa-f]{5}")
@@ -24,14 +31,63 @@ GAME_VERSION = "n64-us"
 def eprint(*args, **kwargs):
     print(*args, file=sys.stderr, **kwargs)
 
-def GetFunctionsByPattern(pattern, files):
-    functions = []
-
+def ScanFunctions(text):
+    """
+    Returns what re.findall gives for NON_MATCHING_PATTERN and NOT_ATTEMPTED_PATTERN in text, from a single scan.
+    Every GLOBAL_ASM is not attempted. A non-matching one is the first GLOBAL_ASM after an #ifdef NON_MATCHING,
+    if an #endif follows it, and the next one is searched for after that #endif, as findall does.
+    """
+    non_matching = []
+    not_attempted = []
+    in_ifdef = False
+    pending = None
+
+    for m in SCAN_PATTERN.finditer(text):
+        if m.group("ifdef") is not None:
+            in_ifdef = True
+        elif m.group("endif") is not None:
+            if pending is not None:
+                non_matching.append(pending)
+                in_ifdef = False
+                pending = None
+        else:
+            not_attempted.append(m.group("asm"))
+            if in_ifdef and pending is None:
+                pending = m.group("asm")
+
+    return non_matching, not_attempted
+
+def GetFunctionsByPatterns(files):
+    try:
+        with open(SCAN_CACHE_PATH) as f:
+            cache = json.load(f)
+        if cache.get("version") != SCAN_CACHE_VERSION:
+            cache = {}
+    except (OSError, ValueError):
+        cache = {}
+    cachedFiles = cache.get("files", {})
+    newFiles = dict()
+
+    non_matching = []
+    not_attempted = []
     for file in files:
-        with open(file) as f:
-            functions += re.findall(pattern, f.read(), re.DOTALL)
-
-    return functions
+        st = os.stat(file)
+        entry = cachedFiles.get(file)
+        if entry is None or entry[0] != st.st_mtime_ns or entry[1] != st.st_size:
+            with open(file) as f:
+                entry = [st.st_mtime_ns, st.st_size, *ScanFunctions(f.read())]
+        newFiles[file] = entry
+        non_matching += entry[2]
+        not_attempted += entry[3]
+
+    try:
+        os.makedirs(os.path.dirname(SCAN_CACHE_PATH), exist_ok=True)
+        with open(SCAN_CACHE_PATH, "w") as f:
+            json.dump({"version": SCAN_CACHE_VERSION, "files": newFiles}, f)
+    except OSError:
+        pass
+
+    return non_matching, not_attempted
 
 def ReadAllLines(fileName):
     line_list = list()
@@ -64,68 +120,47 @@ def GetRemovableSize(functionSizes, functions_to_count):
 
     return size
 
-def CalculateMapSizes(mapFileList):
-    for mapFile in mapFileList:
-        accumulatedSize = 0
-
-        symbolCount = len(mapFile["symbols"])
-        if symbolCount == 0:
-            continue
-
-        # Calculate size of each symbol
-        for index in range(symbolCount - 1):
-            symbol = mapFile["symbols"][index]
-            nextSymbol = mapFile["symbols"][index+1]
-
-            size = nextSymbol["vram"] - symbol["vram"]
-            accumulatedSize += size
-
-            mapFile["symbols"][index]["size"] = size
-
-        # Calculate size of last symbol of the file
-        symbol = mapFile["symbols"][-1]
-        size = mapFile["size"] - accumulatedSize
-        mapFile["symbols"][-1]["size"] = size
-    return mapFileList
-
-def GetFunctionSizes(mapFileList):
+def CalculateSymbolSizes(mapFileList, assetsTracker):
+    """
+    Sizes every symbol of the map, in a single pass over it. Returns the size of every function, the autogenerated
+    asset names are added to the removable size of their category on the way.
+    """
     functionSizes = dict()
 
     for mapFile in mapFileList:
-        if mapFile["section"] != ".text":
+        symbols = mapFile["symbols"]
+        if len(symbols) == 0:
             continue
 
-        for symbol in mapFile["symbols"]:
-            symbolName = symbol["name"]
-            functionSizes[symbolName] = symbol["size"]
-
-    return functionSizes
-
-def CalculateNonNamedAssets(mapFileList, assetsTracker):
-    for mapFile in mapFileList:
-        if mapFile["section"] != ".data" and mapFile["section"] != ".rodata":
-            continue
-        if not mapFile["name"].startswith("build/n64-us/assets/"):
-            continue
+        isText = mapFile["section"] == ".text"
+        assetCat = None
+        if (mapFile["section"] == ".data" or mapFile["section"] == ".rodata") and mapFile["name"].startswith("build/n64-us/assets/"):
+            assetCat = mapFile["name"].split("/")[3]
+            if assetCat not in assetsTracker:
+                assetCat = None
 
-        assetCat = mapFile["name"].split("/")[3]
+        # Each symbol goes up to the next, the last one to the end of the file
+        accumulatedSize = 0
+        for index, symbol in enumerate(symbols):
+            if index + 1 < len(symbols):
+                size = symbols[index + 1]["vram"] - symbol["vram"]
+            else:
+                size = mapFile["size"] - accumulatedSize
+            accumulatedSize += size
+            symbol["size"] = size
 
-        for symbol in mapFile["symbols"]:
-            symbolName = symbol["name"]
-            if AUTOGENERATED_ASSET_NAME.search(symbolName) is not None:
-                if assetCat in assetsTracker:
-                    assetsTracker[assetCat]["removableSize"] += symbol["size"]
-    return assetsTracker
+            if isText:
+                functionSizes[symbol["name"]] = size
+            elif assetCat is not None and AUTOGENERATED_ASSET_NAME.search(symbol["name"]) is not None:
+                assetsTracker[assetCat]["removableSize"] += size
 
+    return functionSizes
 
 map_file = ReadAllLines('build/n64-us/mm-n64-us.map')
 
-# Get list of Non-Matchings
+# Get list of Non-Matchings and functions not attempted.
 all_files = GetFiles("src", ".c")
-non_matching_functions = GetFunctionsByPattern(NON_MATCHING_PATTERN, all_files)
-
-# Get list of functions not attempted.
-not_attempted_functions = GetFunctionsByPattern(NOT_ATTEMPTED_PATTERN, all_files)
+non_matching_functions, not_attempted_functions = GetFunctionsByPatterns(all_files)
 not_attempted_functions = list(set(not_attempted_functions).difference(non_matching_functions))
 
 # If we are looking for a count that includes non-matchings, then we want to set non matching functions list to empty.
@@ -256,10 +291,7 @@ for line in map_file:
         symbolData = {"name": varName, "vram": varVram, "size": 0}
         mapFileList[-1]["symbols"].append(symbolData)
 
-mapFileList = CalculateMapSizes(mapFileList)
-functionSizes = GetFunctionSizes(mapFileList)
-
-assetsTracker = CalculateNonNamedAssets(mapFileList, assetsTracker)
+functionSizes = CalculateSymbolSizes(mapFileList, assetsTracker)
 
 
 # Add libultra to boot.
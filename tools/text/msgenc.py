@@ -4,7 +4,7 @@
 #
 
 import argparse, ast, re, sys
-from typing import Dict, Optional
+from typing import Dict, List, Optional, Tuple
 
 def read_charmap(path : str, wchar : bool, index : int) -> Dict[str,str]:
     with open(path) as infile:
@@ -30,6 +30,15 @@ def read_charmap(path : str, wchar : bool, index : int) -> Dict[str,str]:
 
     return out_charmap
 
+def index_charmap(charmap : Dict[str,str]) -> Tuple[Dict[str, List[Tuple[str,str]]], re.Pattern]:
+    # Group the entries by their first character, in charmap order so that the first one that matches
+    # still wins, and find where an entry or an escape sequence can start with one pattern
+    by_first : Dict[str, List[Tuple[str,str]]] = {}
+    for k,v in charmap.items():
+        by_first.setdefault(k[0], []).append((k, v))
+    special = re.compile("[" + re.escape("".join(by_first.keys()) + "\\") + "]")
+    return by_first, special
+
 # From https://stackoverflow.com/questions/241327/remove-c-and-c-comments-using-python
 def remove_comments(text : str) -> str:
     def replacer(match : re.Match) -> str:
@@ -45,6 +54,8 @@ def remove_comments(text : str) -> str:
     return re.sub(pattern, replacer, text)
 
 def convert_text(text : str, encoding : str, charmap : Dict[str, str]) -> str:
+    by_first, special = index_charmap(charmap)
+
     def cvt_str(match : re.Match) -> str:
         string : str = match.group(0)
 
@@ -76,11 +87,19 @@ def convert_text(text : str, encoding : str, charmap : Dict[str, str]) -> str:
 
         i = 0
         while i != len(string):
+            # skip the text up to where a charmap entry or an escape sequence can start, it is
+            # encoded as one run
+            m = special.search(string, i)
+            if m is None:
+                i = len(string)
+                break
+            i = m.start()
+
             # check charmap
-            for k in charmap.keys():
+            for k,v in by_first.get(string[i], ()):
                 if string.startswith(k, i):
                     # is in charmap, emit the mapped sequence
-                    emit(charmap[k], len(k))
+                    emit(v, len(k))
                     break
             else:
                 if string[i] == "\\" and string[i + 1] != "\\":
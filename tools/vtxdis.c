@@ -1,3 +1,5 @@
+#define _DEFAULT_SOURCE
+
 #include <stdlib.h>
 #include <stdint.h>
 #include <getopt.h>
@@ -7,10 +9,15 @@
 #include <sys/stat.h>
 #include <errno.h>
 
-#define VTXDIS_VER "0.1"
+#include "vtxfmt.h"
+
+#define VTXDIS_VER "0.2"
 
 #define SWAP16(x) (((x & 0xFF00) >> 8) | ((x & 0x00FF) << 8))
 
+/* Output is gathered in a buffer of this size before being written out */
+#define OUT_BUF_SIZE 0x10000
+
 typedef struct {
     int16_t pos[3];     /* 0x00 */
     int16_t flag;       /* 0x06 */
@@ -18,16 +25,31 @@ typedef struct {
     uint8_t cn[4];      /* 0x0C */
 } Vtx;                  /* 0x10 */
 
-static char *filename = NULL;
-static char *data = NULL;
-static int offset = 0;
-static int data_len = 0;
-static int count = 0;
+/* One extraction, as given on the command line or by a line of a batch manifest */
+typedef struct {
+    char *filename;
+    char *output;
+    int offset;
+    int data_len;
+    int count;
+    int nspire;
+} VtxdisJob;
+
+/* The last file read, kept for the next jobs of a batch extracting from the same file */
+static char *cached_filename = NULL;
+static char *cached_data = NULL;
+static size_t cached_size = 0;
+
+static char out_buf[OUT_BUF_SIZE];
+static size_t out_len = 0;
 
 const struct option cmdline_opts[] = {
     { "offset", required_argument, NULL, 'o', },
     { "length", required_argument, NULL, 'l', },
     { "file" , required_argument, NULL, 'f', },
+    { "output", required_argument, NULL, 'O', },
+    { "nspire", no_argument, NULL, 'n', },
+    { "batch", required_argument, NULL, 'b', },
     { "version", no_argument, NULL, '~', },
     { "help", no_argument, NULL, '?', },
     { "count", required_argument, NULL, 'c', },
@@ -55,6 +77,7 @@ static void print_usage(void)
     puts("vtxdis version " VTXDIS_VER "\n"
     "Usage:\n"
     "  vtxdis -f/--file FILE [options]\n"
+    "  vtxdis -b/--batch MANIFEST\n"
     "  vtxdis -?/--help\n"
     "  vtxdis --version\n"
     "Options:\n"
@@ -62,6 +85,12 @@ static void print_usage(void)
     "  -c, --count      The number of vertices to extract.\n"
     "  -l, --length     The amount of data to extract vertices from.\n"
     "  -o, --offset     The offset into file to start reading vertex data.\n"
+    "  -O, --output     The file to write to instead of stdout.\n"
+    "  -n, --nspire     Write the vertices as packed binary Vtx in the layout of the TI-Nspire\n"
+    "                   asset pack, little endian, instead of C.\n"
+    "  -b, --batch      Run the extractions listed in MANIFEST, one per line, each line holding\n"
+    "                   the options of one invocation. Empty lines and lines starting with # are\n"
+    "                   skipped.\n"
     "  -?, --help       Prints this help message\n"
     "  --version        Prints the current version\n"
     );
@@ -71,96 +100,163 @@ static void print_version(void){
     puts("Version: " VTXDIS_VER);
 }
 
-static void print_vtx_data(Vtx *vtx, int vtx_cnt)
+static void out_flush(FILE *out)
+{
+    if(out_len != 0 && fwrite(out_buf, out_len, 1, out) != 1){
+        perror("Could not write output");
+        exit(1);
+    }
+    out_len = 0;
+}
+
+static void out_write(FILE *out, const void *buf, size_t len)
+{
+    if(out_len + len > OUT_BUF_SIZE)
+        out_flush(out);
+    memcpy(&out_buf[out_len], buf, len);
+    out_len += len;
+}
+
+static void print_vtx_data(FILE *out, Vtx *vtx, int vtx_cnt)
 {
-    printf("{\n");
+    char line[4 + VTXFMT_MAX_SIZE + 2];
+
+    out_write(out, "{\n", 2);
     for(int i = 0; i < vtx_cnt; i++)
     {
         Vtx *v = &vtx[i];
+        size_t len;
 
-        printf("    VTX(%d, %d, %d, %d, %d, 0x%02X, 0x%02X, 0x%02X, 0x%02X),\n", v->pos[0], v->pos[1], v->pos[2], v->tpos[0], v->tpos[1], v->cn[0], v->cn[1], v->cn[2], v->cn[3]);
+        memcpy(line, "    ", 4);
+        len = 4 + vtxfmt_vtx(&line[4], v->pos[0], v->pos[1], v->pos[2], v->tpos[0], v->tpos[1], v->cn,
+                             VTXFMT_HEX_COLOR);
+        line[len++] = ',';
+        line[len++] = '\n';
+        out_write(out, line, len);
     }
-    printf("}\n");
+    out_write(out, "}\n", 2);
 }
 
-static void parse_file(void)
+/* The layout of NSP_PACK_VERTEX runs in src/nspire/nsp_pack.h: the fields before the color little endian */
+static void write_vtx_nspire(FILE *out, Vtx *vtx, int vtx_cnt)
+{
+    for(int i = 0; i < vtx_cnt; i++)
+    {
+        Vtx *v = &vtx[i];
+        uint16_t fields[6] = {
+            (uint16_t)v->pos[0], (uint16_t)v->pos[1], (uint16_t)v->pos[2],
+            (uint16_t)v->flag, (uint16_t)v->tpos[0], (uint16_t)v->tpos[1],
+        };
+        uint8_t packed[sizeof(Vtx)];
+
+        for(int j = 0; j < 6; j++)
+        {
+            packed[j * 2 + 0] = fields[j] & 0xFF;
+            packed[j * 2 + 1] = fields[j] >> 8;
+        }
+        memcpy(&packed[12], v->cn, 4);
+        out_write(out, packed, sizeof(packed));
+    }
+}
+
+/* Reads the whole of filename, or reuses it if it was the last file read */
+static int read_file_cached(const char *filename)
 {
-    int alloc_size = 0;
     struct stat sbuffer;
-    stat(filename, &sbuffer);
-    if(errno != 0){
+    FILE *file;
+
+    if(cached_filename != NULL && strcmp(cached_filename, filename) == 0)
+        return 0;
+
+    free(cached_filename);
+    free(cached_data);
+    cached_filename = NULL;
+    cached_data = NULL;
+
+    if(stat(filename, &sbuffer) != 0){
         perror("Count not stat file.");
-        exit(1);
+        return -1;
+    }
+
+    file = fopen(filename, "rb");
+    if(!file){
+        perror("Could not open file");
+        return -1;
+    }
+
+    cached_size = sbuffer.st_size;
+    cached_data = malloc(cached_size != 0 ? cached_size : 1);
+    if(!cached_data){
+        fclose(file);
+        perror("Could not allocate vtx data");
+        return -1;
+    }
+
+    if(cached_size != 0 && !fread(cached_data, cached_size, 1, file)){
+        perror("Could not read from file");
+        fclose(file);
+        free(cached_data);
+        cached_data = NULL;
+        return -1;
     }
+    fclose(file);
+
+    cached_filename = strdup(filename);
+    return 0;
+}
+
+static int parse_file(const VtxdisJob *job)
+{
+    int alloc_size = 0;
+    int offset = job->offset;
+    FILE *out = stdout;
+
+    if(read_file_cached(job->filename) != 0)
+        return -1;
 
     /* sanity checks */
-    if(count > 0)
+    if(job->count > 0)
     {
-        alloc_size = sizeof(Vtx) * count;
-        if((offset > 0 && (offset + alloc_size) > sbuffer.st_size) || alloc_size > sbuffer.st_size)
+        alloc_size = sizeof(Vtx) * job->count;
+        if((offset > 0 && (size_t)(offset + alloc_size) > cached_size) || (size_t)alloc_size > cached_size)
         {
             printf("Requested data is beyond file boundaries.");
-            exit(1);
+            return -1;
         }
     }
-    else if(data_len > 0)
+    else if(job->data_len > 0)
     {
-        alloc_size = data_len;
+        alloc_size = job->data_len;
 
-        if((offset > 0 && (offset + alloc_size) > sbuffer.st_size) || alloc_size > sbuffer.st_size)
+        if((offset > 0 && (size_t)(offset + alloc_size) > cached_size) || (size_t)alloc_size > cached_size)
         {
             printf("Requested data is beyond file boundaries.");
-            exit(1);
+            return -1;
         }
     }
     else
     {
-        if (offset > 0)
-        {
-            alloc_size = sbuffer.st_size - offset;
-        }
-        else
+        if ((size_t)offset > cached_size)
         {
-            alloc_size = sbuffer.st_size;
+            printf("Requested data is beyond file boundaries.");
+            return -1;
         }
+        alloc_size = cached_size - offset;
     }
 
     if(alloc_size % sizeof(Vtx) != 0)
     {
         printf("Requested data size is not a multiple of sizeof(Vtx).  Requested size is %8x", alloc_size);
-        exit(1);
-    }
-
-    FILE *file = fopen(filename, "rb");
-    if(!file){
-        perror("Could not open file");
-        exit(1);
-    }
-
-    if(offset > 0){
-        if(fseek(file, offset, SEEK_SET)){
-            perror("Could not seek file");
-            fclose(file);
-            exit(1);
-        }
+        return -1;
     }
 
     Vtx *data = NULL;
-    data = malloc(alloc_size);
+    data = malloc(alloc_size != 0 ? alloc_size : 1);
     if(!data){
-        fclose(file);
         perror("Could not allocate vtx data");
-        exit(1);
-    }
-
-    if(!fread(data, alloc_size, 1, file)){
-        perror("Could not read from file");
-        fclose(file);
-        free(data);
-        exit(1);
+        return -1;
     }
-
-    fclose(file);
+    memcpy(data, &cached_data[offset], alloc_size);
 
     int vtx_cnt = alloc_size / sizeof(Vtx);
     for(int i = 0; i < vtx_cnt; i++){
@@ -174,84 +270,189 @@ static void parse_file(void)
         v->tpos[1] = SWAP16(v->tpos[1]);
     }
 
-    print_vtx_data(data, vtx_cnt);
+    if(job->output != NULL)
+    {
+        out = fopen(job->output, job->nspire ? "wb" : "w");
+        if(!out){
+            perror("Could not open output file");
+            free(data);
+            return -1;
+        }
+    }
+
+    if(job->nspire)
+        write_vtx_nspire(out, data, vtx_cnt);
+    else
+        print_vtx_data(out, data, vtx_cnt);
+    out_flush(out);
+
+    if(out != stdout)
+        fclose(out);
     free(data);
+    return 0;
 }
 
-int main(int argc, char **argv)
+/*
+ * Fills job from the options in argv. Returns 1 if the program should exit with status 0 (--help, --version), -1 on
+ * invalid options and 0 otherwise. batch receives the manifest of --batch, if given.
+ */
+static int parse_args(int argc, char **argv, VtxdisJob *job, char **batch)
 {
     int opt;
-    int argv_idx = 0;
+
+    memset(job, 0, sizeof(*job));
+    *batch = NULL;
+
+    /* getopt is run once per line of a batch manifest */
+#ifdef __GLIBC__
+    optind = 0;
+#else
+    optind = 1;
+    optreset = 1;
+#endif
+
     while(1){
-        argv_idx++;
-        opt = getopt_long(argc, argv, "o:l:f:c:v?", cmdline_opts, NULL);
+        opt = getopt_long(argc, argv, "o:l:f:c:O:nb:v?", cmdline_opts, NULL);
         if(opt == -1){
             break;
         }
         switch(opt){
-            case 'd':
-                data = optarg;
-                break;
             case '~':
                 print_version();
-                return 0;
+                return 1;
             case '?':
                 print_usage();
-                return 0;
+                return 1;
             case 'l':
-                data_len = parse_int(optarg);
+                job->data_len = parse_int(optarg);
                 break;
             case 'o':
-                offset = parse_int(optarg);
+                job->offset = parse_int(optarg);
                 break;
             case 'f':
-                filename = optarg;
+                job->filename = optarg;
                 break;
             case 'c':
-                count = parse_int(optarg);
+                job->count = parse_int(optarg);
+                break;
+            case 'O':
+                job->output = optarg;
+                break;
+            case 'n':
+                job->nspire = 1;
+                break;
+            case 'b':
+                *batch = optarg;
                 break;
         }
     }
 
-    if (filename == NULL && data == NULL)
+    if (*batch != NULL)
     {
-        printf("Must specify -f or -d\n");
+        return 0;
+    }
+
+    if (job->filename == NULL)
+    {
+        printf("Must specify -f\n");
         print_usage();
-        exit(1);
+        return -1;
     }
 
-    if(data_len < 0)
+    if(job->data_len < 0)
     {
         printf("Invalid -l/--length parameter passed.");
         print_usage();
-        exit(1);
+        return -1;
     }
 
-    if(offset < 0)
+    if(job->offset < 0)
     {
         printf("Invalid -o/--offset parameter passed.");
         print_usage();
-        exit(1);
+        return -1;
     }
 
-    if(count < 0)
+    if(job->count < 0)
     {
         printf("Invalid -c/--count parameter passed.");
         print_usage();
-        exit(1);
+        return -1;
     }
 
-    if(count > 0 && data_len > 0)
+    if(job->count > 0 && job->data_len > 0)
     {
         printf("Cannot specify both -c/--count and -l/--length.");
         print_usage();
-        exit(1);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Runs each line of the manifest as the options of one invocation, returning the number of lines that failed */
+static int run_batch(const char *manifest)
+{
+    FILE *file = fopen(manifest, "r");
+    char line[4096];
+    int line_num = 0;
+    int failed = 0;
+
+    if(!file){
+        perror("Could not open batch manifest");
+        return 1;
     }
 
-    if(filename != NULL)
+    while(fgets(line, sizeof(line), file) != NULL)
     {
-        parse_file();
+        char *argv[64];
+        int argc = 0;
+        char *batch;
+        VtxdisJob job;
+        char *tok;
+
+        line_num++;
+        argv[argc++] = "vtxdis";
+        for(tok = strtok(line, " \t\r\n"); tok != NULL && argc < 63; tok = strtok(NULL, " \t\r\n"))
+            argv[argc++] = tok;
+        argv[argc] = NULL;
+
+        if(argc == 1 || argv[1][0] == '#')
+            continue;
+
+        if(parse_args(argc, argv, &job, &batch) != 0 || batch != NULL || parse_file(&job) != 0)
+        {
+            fprintf(stderr, "%s:%d: extraction failed\n", manifest, line_num);
+            failed++;
+        }
     }
 
-    return 0;
+    fclose(file);
+    return failed;
+}
+
+int main(int argc, char **argv)
+{
+    VtxdisJob job;
+    char *batch;
+    int ret;
+
+    ret = parse_args(argc, argv, &job, &batch);
+    if(ret != 0)
+    {
+        return ret > 0 ? 0 : 1;
+    }
+
+    if(batch != NULL)
+    {
+        ret = run_batch(batch) != 0;
+    }
+    else
+    {
+        ret = parse_file(&job) != 0;
+    }
+
+    free(cached_filename);
+    free(cached_data);
+    return ret;
 }
@@ -0,0 +1,116 @@
+#ifndef VTXFMT_H
+#define VTXFMT_H
+
+/*
+ * Formats a Vtx as a VTX() macro invocation, shared by vtxdis and ZAPD's ZVtx. It writes to a caller's buffer without
+ * allocating, and converts the numbers two digits at a time from a table, which is a lot faster than snprintf for
+ * the hundreds of thousands of vertices of room geometry. Header-only C, usable from C++.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Colors as 0x%02X like vtxdis, instead of decimal like ZAPD */
+#define VTXFMT_HEX_COLOR (1 << 0)
+
+/* Size of the longest VTX() vtxfmt_vtx writes, with the terminator */
+#define VTXFMT_MAX_SIZE sizeof("VTX(-32768, -32768, -32768, -32768, -32768, 0xFF, 0xFF, 0xFF, 0xFF)")
+
+static const char vtxfmt_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static inline char *vtxfmt_pair(char *p, uint32_t n)
+{
+    p[0] = vtxfmt_digit_pairs[2 * n];
+    p[1] = vtxfmt_digit_pairs[2 * n + 1];
+    return p + 2;
+}
+
+/* Writes v in decimal like %d, for -99999 <= v <= 99999, returning the end */
+static inline char *vtxfmt_dec(char *p, int32_t v)
+{
+    uint32_t u = (uint32_t)v;
+
+    if (v < 0) {
+        *p++ = '-';
+        u = 0u - u;
+    }
+
+    if (u >= 10000) {
+        *p++ = (char)('0' + u / 10000);
+        u %= 10000;
+        p = vtxfmt_pair(p, u / 100);
+        p = vtxfmt_pair(p, u % 100);
+    } else if (u >= 1000) {
+        p = vtxfmt_pair(p, u / 100);
+        p = vtxfmt_pair(p, u % 100);
+    } else if (u >= 100) {
+        *p++ = (char)('0' + u / 100);
+        p = vtxfmt_pair(p, u % 100);
+    } else if (u >= 10) {
+        p = vtxfmt_pair(p, u);
+    } else {
+        *p++ = (char)('0' + u);
+    }
+    return p;
+}
+
+/* Writes v like 0x%02X, returning the end */
+static inline char *vtxfmt_hex8(char *p, uint8_t v)
+{
+    static const char digits[] = "0123456789ABCDEF";
+
+    p[0] = '0';
+    p[1] = 'x';
+    p[2] = digits[v >> 4];
+    p[3] = digits[v & 0xF];
+    return p + 4;
+}
+
+/*
+ * Writes "VTX(x, y, z, s, t, r, g, b, a)" to out, which must hold VTXFMT_MAX_SIZE, and terminates it. Returns the
+ * length.
+ */
+static inline size_t vtxfmt_vtx(char *out, int16_t x, int16_t y, int16_t z, int16_t s, int16_t t, const uint8_t cn[4],
+                                unsigned int flags)
+{
+    char *p = out;
+    int i;
+
+    *p++ = 'V';
+    *p++ = 'T';
+    *p++ = 'X';
+    *p++ = '(';
+    p = vtxfmt_dec(p, x);
+    *p++ = ',';
+    *p++ = ' ';
+    p = vtxfmt_dec(p, y);
+    *p++ = ',';
+    *p++ = ' ';
+    p = vtxfmt_dec(p, z);
+    *p++ = ',';
+    *p++ = ' ';
+    p = vtxfmt_dec(p, s);
+    *p++ = ',';
+    *p++ = ' ';
+    p = vtxfmt_dec(p, t);
+    for (i = 0; i < 4; i++) {
+        *p++ = ',';
+        *p++ = ' ';
+        p = (flags & VTXFMT_HEX_COLOR) ? vtxfmt_hex8(p, cn[i]) : vtxfmt_dec(p, cn[i]);
+    }
+    *p++ = ')';
+    *p = '\0';
+    return (size_t)(p - out);
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include "zarchive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ZARCHIVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define YAZ0_HEADER_SIZE 0x10
+
+static uint32_t read_u32_le(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t read_u32_be(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+int zarchive_open_memory(ZArchive* ar, const void* data, size_t size) {
+    const uint8_t* p = data;
+    const uint16_t endian_check = 1;
+    uint32_t count;
+    uint32_t i;
+
+    memset(ar, 0, sizeof(*ar));
+
+    // The table of contents is used as it is in the archive
+    if (*(const uint8_t*)&endian_check != 1 || sizeof(ZArchiveEntry) != ZARCHIVE_ENTRY_SIZE) {
+        return -1;
+    }
+    if (size < ZARCHIVE_HEADER_SIZE || memcmp(p, "ZARC", 4) != 0 || read_u32_le(p + 4) != ZARCHIVE_VERSION) {
+        return -1;
+    }
+    count = read_u32_le(p + 8);
+    if (count > (size - ZARCHIVE_HEADER_SIZE) / ZARCHIVE_ENTRY_SIZE) {
+        return -1;
+    }
+
+    ar->data = p;
+    ar->size = size;
+    ar->toc = (const ZArchiveEntry*)(p + ZARCHIVE_HEADER_SIZE);
+    ar->count = count;
+
+    for (i = 0; i < count; i++) {
+        const ZArchiveEntry* e = &ar->toc[i];
+
+        if (e->offset > size || e->size > size - e->offset) {
+            memset(ar, 0, sizeof(*ar));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int zarchive_open(ZArchive* ar, const char* path) {
+    uint8_t* data;
+    size_t size;
+    FILE* f;
+    long end;
+
+#ifdef ZARCHIVE_MMAP
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    if (fd >= 0) {
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            close(fd);
+            if (map == MAP_FAILED) {
+                return -1;
+            }
+            if (zarchive_open_memory(ar, map, st.st_size) != 0) {
+                munmap(map, st.st_size);
+                return -1;
+            }
+            ar->mapped = 1;
+            return 0;
+        }
+        close(fd);
+    }
+#endif
+
+    // Read as a whole where it can't be mapped, malloc's alignment is enough for the payloads
+    f = fopen(path, "rb");
+    if (f == NULL) {
+        return -1;
+    }
+    if (fseek(f, 0, SEEK_END) != 0 || (end = ftell(f)) <= 0 || fseek(f, 0, SEEK_SET) != 0) {
+        fclose(f);
+        return -1;
+    }
+    size = end;
+    data = malloc(size);
+    if (data == NULL || fread(data, 1, size, f) != size) {
+        free(data);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    if (zarchive_open_memory(ar, data, size) != 0) {
+        free(data);
+        return -1;
+    }
+    ar->mapped = 0;
+    return 0;
+}
+
+void zarchive_close(ZArchive* ar) {
+    if (ar->data != NULL) {
+#ifdef ZARCHIVE_MMAP
+        if (ar->mapped) {
+            munmap((void*)ar->data, ar->size);
+        }
+#endif
+        if (!ar->mapped) {
+            free((void*)ar->data);
+        }
+    }
+    memset(ar, 0, sizeof(*ar));
+}
+
+uint64_t zarchive_hash(const char* name) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    for (; *name != '\0'; name++) {
+        hash = (hash ^ (uint8_t)*name) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+const ZArchiveEntry* zarchive_find_hash(const ZArchive* ar, uint64_t name_hash) {
+    uint32_t lo = 0;
+    uint32_t hi = ar->count;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+
+        if (ar->toc[mid].name_hash < name_hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < ar->count && ar->toc[lo].name_hash == name_hash) {
+        return &ar->toc[lo];
+    }
+    return NULL;
+}
+
+const ZArchiveEntry* zarchive_find(const ZArchive* ar, const char* name) {
+    return zarchive_find_hash(ar, zarchive_hash(name));
+}
+
+const void* zarchive_data(const ZArchive* ar, const ZArchiveEntry* entry) {
+    if (entry->flags & ZARCHIVE_FLAG_YAZ0) {
+        return NULL;
+    }
+    return ar->data + entry->offset;
+}
+
+static int yaz0_decompress(const uint8_t* src, size_t src_size, uint8_t* dest, size_t dest_size) {
+    const uint8_t* src_end = src + src_size;
+    uint8_t* out = dest;
+    uint8_t* out_end;
+
+    if (src_size < YAZ0_HEADER_SIZE || memcmp(src, "Yaz0", 4) != 0 || read_u32_be(src + 4) != dest_size) {
+        return -1;
+    }
+    src += YAZ0_HEADER_SIZE;
+    out_end = dest + dest_size;
+
+    while (out < out_end) {
+        uint8_t group;
+        int bit;
+
+        if (src >= src_end) {
+            return -1;
+        }
+        group = *src++;
+
+        for (bit = 7; bit >= 0 && out < out_end; bit--) {
+            if (group & (1 << bit)) {
+                if (src >= src_end) {
+                    return -1;
+                }
+                *out++ = *src++;
+            } else {
+                uint32_t dist;
+                uint32_t n;
+                const uint8_t* back;
+
+                if (src_end - src < 2) {
+                    return -1;
+                }
+                dist = (((src[0] & 0xF) << 8) | src[1]) + 1;
+                n = src[0] >> 4;
+                src += 2;
+                if (n == 0) {
+                    if (src >= src_end) {
+                        return -1;
+                    }
+                    n = *src++ + 0x12;
+                } else {
+                    n += 2;
+                }
+                if (dist > (uint32_t)(out - dest) || n > (uint32_t)(out_end - out)) {
+                    return -1;
+                }
+                // Byte by byte, the copy can overlap what it writes
+                for (back = out - dist; n != 0; n--) {
+                    *out++ = *back++;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int zarchive_read(const ZArchive* ar, const ZArchiveEntry* entry, void* dest) {
+    const uint8_t* payload = ar->data + entry->offset;
+
+    if (entry->flags & ZARCHIVE_FLAG_YAZ0) {
+        return yaz0_decompress(payload, entry->size, dest, entry->raw_size);
+    }
+    if (entry->size != entry->raw_size) {
+        return -1;
+    }
+    memcpy(dest, payload, entry->size);
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef ZARCHIVE_H
+#define ZARCHIVE_H
+
+/*
+ * Reader of the resource archives ZAPD's ARCHIVE exporter set writes and tools/mkzarchive.py merges, see
+ * tools/ZAPD/ExporterTest/ArchiveExporter.h for the layout. The archive is mapped instead of read where the platform
+ * can, and the table of contents and the uncompressed payloads are used straight from the mapping, so opening one
+ * costs the same whatever the number of resources in it. Plain C99, meant to be copied into ports as is.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ZARCHIVE_VERSION 1
+#define ZARCHIVE_HEADER_SIZE 0x10
+#define ZARCHIVE_ENTRY_SIZE 0x20
+
+#define ZARCHIVE_FLAG_YAZ0 (1 << 0)
+
+typedef struct ZArchiveEntry {
+    uint64_t name_hash; /* FNV-1a of the resource name, see zarchive_hash */
+    uint32_t type;      /* ZResourceType of ZAPD's ZResource.h */
+    uint32_t flags;     /* ZARCHIVE_FLAG_* */
+    uint32_t offset;    /* of the payload in the archive */
+    uint32_t size;      /* of the payload */
+    uint32_t raw_size;  /* of the resource, the payload decompressed */
+    uint32_t src_offset; /* of the resource in the file it comes from */
+} ZArchiveEntry;
+
+typedef struct ZArchive {
+    const uint8_t* data;
+    size_t size;
+    const ZArchiveEntry* toc; /* sorted by name hash */
+    uint32_t count;
+    int mapped; /* data is a mapping rather than a malloc'd copy */
+} ZArchive;
+
+/* Opens the archive at path. Returns 0 on success, -1 if it can't be read or isn't an archive of this version */
+int zarchive_open(ZArchive* ar, const char* path);
+/* Uses an archive already in memory, which has to stay there and be 16-byte aligned until zarchive_close */
+int zarchive_open_memory(ZArchive* ar, const void* data, size_t size);
+void zarchive_close(ZArchive* ar);
+
+uint64_t zarchive_hash(const char* name);
+/* The entry of the resource named name, NULL if there is none */
+const ZArchiveEntry* zarchive_find(const ZArchive* ar, const char* name);
+const ZArchiveEntry* zarchive_find_hash(const ZArchive* ar, uint64_t name_hash);
+
+/* The payload of an uncompressed entry where it is in the archive, NULL for a compressed one */
+const void* zarchive_data(const ZArchive* ar, const ZArchiveEntry* entry);
+/* Copies or decompresses the resource to dest, which has room for entry->raw_size bytes. Returns 0 on success */
+int zarchive_read(const ZArchive* ar, const ZArchiveEntry* entry, void* dest);
+
+#endif